@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <napa/module.h>
+#include <napa/async.h>
+#include <napa/v8-helpers.h>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace napa {
+namespace benchmark {
+
+using namespace v8;
+
+namespace {
+
+    /// <summary> Calls a JS callback without arguments, once its work completed. </summary>
+    void CallBack(Local<Function> jsCallback, void*) {
+        auto isolate = Isolate::GetCurrent();
+        jsCallback->Call(isolate->GetCurrentContext()->Global(), 0, nullptr);
+    }
+
+    /// <summary> Keeps the thread busy for a duration, as computation would. </summary>
+    void Spin(std::chrono::microseconds duration) {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end) {
+        }
+    }
+
+    /// <summary> Reads a field of /proc/self/status, e.g. 'Threads', -1 if it's not there. </summary>
+    double ReadProcessStatus(const std::string& field) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, field.size() + 1, field + ":") == 0) {
+                return std::stod(line.substr(field.size() + 1));
+            }
+        }
+        return -1;
+    }
+}
+
+/// <summary> Posts work that spins for a number of microseconds to the CPU pool, then calls back. </summary>
+void PostCpuWork(const FunctionCallbackInfo<Value>& args) {
+    auto isolate = args.GetIsolate();
+
+    CHECK_ARG(isolate,
+        args.Length() == 2 && args[0]->IsUint32() && args[1]->IsFunction(),
+        "It requires cost in microseconds and callback as arguments");
+
+    auto cost = std::chrono::microseconds(args[0]->Uint32Value());
+    napa::zone::PostAsyncWork(Local<Function>::Cast(args[1]),
+        [cost]() {
+            Spin(cost);
+            return nullptr;
+        },
+        CallBack,
+        napa::zone::AsyncWorkPool::CPU);
+}
+
+/// <summary> Posts work that sleeps for a number of microseconds to the I/O pool, as blocking I/O would, then calls back. </summary>
+void PostIoWork(const FunctionCallbackInfo<Value>& args) {
+    auto isolate = args.GetIsolate();
+
+    CHECK_ARG(isolate,
+        args.Length() == 2 && args[0]->IsUint32() && args[1]->IsFunction(),
+        "It requires cost in microseconds and callback as arguments");
+
+    auto cost = std::chrono::microseconds(args[0]->Uint32Value());
+    napa::zone::PostAsyncWork(Local<Function>::Cast(args[1]),
+        [cost]() {
+            std::this_thread::sleep_for(cost);
+            return nullptr;
+        },
+        CallBack,
+        napa::zone::AsyncWorkPool::IO);
+}
+
+/// <summary> Completes work on the calling thread, so only the completion path is measured. </summary>
+void CompleteInline(const FunctionCallbackInfo<Value>& args) {
+    auto isolate = args.GetIsolate();
+
+    CHECK_ARG(isolate,
+        args.Length() == 1 && args[0]->IsFunction(),
+        "It requires callback as argument");
+
+    napa::zone::DoAsyncWork(Local<Function>::Cast(args[0]),
+        [](auto complete) {
+            complete(nullptr);
+        },
+        CallBack);
+}
+
+/// <summary> Gets the number of threads and the resident memory in KB of the process, -1 where it's unknown. </summary>
+/// <remarks> Read from /proc, thus only known on Linux. </remarks>
+void GetProcessStats(const FunctionCallbackInfo<Value>& args) {
+    auto isolate = args.GetIsolate();
+    HandleScope scope(isolate);
+
+    auto context = isolate->GetCurrentContext();
+    auto stats = Object::New(isolate);
+    stats->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "threads"), Number::New(isolate, ReadProcessStatus("Threads")));
+    stats->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "rss"), Number::New(isolate, ReadProcessStatus("VmRSS")));
+    args.GetReturnValue().Set(stats);
+}
+
+void Init(Local<Object> exports) {
+    NAPA_SET_METHOD(exports, "postCpuWork", PostCpuWork);
+    NAPA_SET_METHOD(exports, "postIoWork", PostIoWork);
+    NAPA_SET_METHOD(exports, "completeInline", CompleteInline);
+    NAPA_SET_METHOD(exports, "getProcessStats", GetProcessStats);
+}
+
+NAPA_MODULE(addon, Init)
+
+}  // namespace benchmark
+}  // namespace napa
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as mdTable from 'markdown-table';
+import { timeDiffInMs, formatTimeDiff } from './bench-utils';
+import { record } from './bench-results';
+
+const ALLOCATORS = ['crtAllocator', 'threadCachingAllocator'];
+const SIZES = [16, 256, 4096, 65536];
+
+/// <summary> Allocates blocks and returns their handles, called in zone workers. </summary>
+export function allocateBlocks(allocatorName: string, size: number, count: number): napa.memory.Handle[] {
+    let allocator: napa.memory.Allocator = (<any>napa.memory)[allocatorName];
+    let handles: napa.memory.Handle[] = [];
+    for (let i = 0; i < count; ++i) {
+        handles.push(allocator.allocate(size));
+    }
+    return handles;
+}
+
+function benchSameThread(allocator: napa.memory.Allocator, size: number): number {
+    const REPEAT = 100;
+    const BLOCKS = 1000;
+
+    let handles: napa.memory.Handle[] = new Array(BLOCKS);
+    let start = process.hrtime();
+    for (let i = 0; i < REPEAT; ++i) {
+        for (let j = 0; j < BLOCKS; ++j) {
+            handles[j] = allocator.allocate(size);
+        }
+        for (let j = 0; j < BLOCKS; ++j) {
+            allocator.deallocate(handles[j], size);
+        }
+    }
+    return timeDiffInMs(process.hrtime(start));
+}
+
+async function benchCrossThread(zone: napa.zone.Zone, workers: number, allocatorName: string, size: number): Promise<number> {
+    const REPEAT = 20;
+    const BLOCKS = 1000;
+
+    let allocator: napa.memory.Allocator = (<any>napa.memory)[allocatorName];
+    let start = process.hrtime();
+    for (let i = 0; i < REPEAT; ++i) {
+        // Blocks are allocated by zone workers and released by node, like transported objects are.
+        let calls: Promise<napa.zone.Result>[] = [];
+        for (let w = 0; w < workers; ++w) {
+            calls.push(zone.execute(__filename, 'allocateBlocks', [allocatorName, size, BLOCKS]));
+        }
+        for (let result of await Promise.all(calls)) {
+            for (let handle of <napa.memory.Handle[]>result.value) {
+                allocator.deallocate(handle, size);
+            }
+        }
+    }
+    return timeDiffInMs(process.hrtime(start));
+}
+
+export async function bench(zone: napa.zone.Zone, workers: number): Promise<void> {
+    console.log("Benchmarking allocator overhead...");
+
+    // Warm-up.
+    for (let name of ALLOCATORS) {
+        benchSameThread((<any>napa.memory)[name], 16);
+        await benchCrossThread(zone, workers, name, 16);
+    }
+
+    let table = [];
+    table.push(["size", "crt - same thread (ms)", "threadCaching - same thread (ms)", "crt - cross thread (ms)", "threadCaching - cross thread (ms)"]);
+    for (let size of SIZES) {
+        let row: any[] = [size];
+        for (let name of ALLOCATORS) {
+            let time = benchSameThread((<any>napa.memory)[name], size);
+            record('allocator-overhead', `${name} - same thread - ${size}`, time);
+            row.push(formatTimeDiff(time));
+        }
+        for (let name of ALLOCATORS) {
+            let time = await benchCrossThread(zone, workers, name, size);
+            record('allocator-overhead', `${name} - cross thread - ${size}`, time);
+            row.push(formatTimeDiff(time));
+        }
+        table.push(row);
+    }
+
+    console.log("## Allocator overhead\n")
+    console.log(mdTable(table));
+    console.log('');
+}
@@ -0,0 +1,228 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as fs from 'fs';
+import * as path from 'path';
+import * as mdTable from 'markdown-table';
+import { HdrHistogram } from './hdr-histogram';
+import { record } from './bench-results';
+
+/// <summary> Options of the async work benchmark. </summary>
+export interface AsyncWorkOptions {
+    /// <summary> Work items completed by each run. </summary>
+    count: number;
+
+    /// <summary> Work items pending at a time, a completion issues the next one. </summary>
+    inFlight: number[];
+
+    /// <summary> Microseconds each item of 'cpu' and 'io' work takes. </summary>
+    costs: number[];
+
+    /// <summary> Kinds of work to run, all by default. </summary>
+    kinds?: string[];
+}
+
+export const DEFAULT_ASYNC_WORK_OPTIONS: AsyncWorkOptions = {
+    count: 20000,
+    inFlight: [1, 64, 1024],
+    costs: [0, 100, 1000]
+};
+
+/// <summary>
+///     Kinds of work of the addon, by function: 'cpu' spins in the CPU pool, 'io' sleeps in the I/O pool,
+///     'inline' completes on the calling thread, which measures the completion path alone.
+/// </summary>
+const KINDS: { [kind: string]: string } = {
+    cpu: 'postCpuWork',
+    io: 'postIoWork',
+    inline: 'completeInline'
+};
+
+/// <summary> Directory of the addon built by 'npm run asyncbenchmark', as async-work.napa and async-work.node. </summary>
+const ADDON_DIR = path.resolve(__dirname, '../bin');
+
+/// <summary> What a run measured where it ran, times in milliseconds, latencies in microseconds. </summary>
+export interface AsyncWorkStep {
+    elapsed: number;
+    latencies: Float64Array;
+
+    /// <summary> Threads and resident KB of the process, before and at most during the run, -1 where unknown. </summary>
+    threads: { before: number, peak: number };
+    rss: { before: number, peak: number };
+}
+
+/// <summary> Result of a kind of work on a runner. </summary>
+export interface AsyncWorkRun {
+    runner: string;
+    kind: string;
+    cost: number;
+    inFlight: number;
+    throughput: number;
+    latency: HdrHistogram;
+    threadsAdded: number;
+    rssAdded: number;
+}
+
+/// <summary>
+///     Completes work items of the addon, keeping a number of them in flight, in the calling thread's loop.
+///     It runs both in a zone worker and in Node.js, thus refers to nothing outside of itself.
+/// </summary>
+function measureAsyncWork(addonPath: string, functionName: string, cost: number, count: number, inFlight: number): Promise<AsyncWorkStep> {
+    var addon = require(addonPath);
+    var performance = require('perf_hooks').performance;
+    var work: (callback: () => void) => void = functionName === 'completeInline'
+        ? function (callback) { addon.completeInline(callback); }
+        : function (callback) { addon[functionName](cost, callback); };
+
+    var latencies = new Float64Array(count);
+    var before = addon.getProcessStats();
+    var threadsPeak = before.threads;
+    var rssPeak = before.rss;
+    var issued = 0;
+    var completed = 0;
+    var start = performance.now();
+
+    return new Promise<AsyncWorkStep>(function (resolve) {
+        function issue() {
+            var index = issued++;
+            var issuedAt = performance.now();
+            work(function () {
+                latencies[index] = (performance.now() - issuedAt) * 1000;
+                // Pools start threads on demand, peaks are sampled as completions go.
+                if (++completed % 256 === 0 || completed === count) {
+                    var stats = addon.getProcessStats();
+                    threadsPeak = Math.max(threadsPeak, stats.threads);
+                    rssPeak = Math.max(rssPeak, stats.rss);
+                }
+                if (completed === count) {
+                    resolve({
+                        elapsed: performance.now() - start,
+                        latencies: latencies,
+                        threads: { before: before.threads, peak: threadsPeak },
+                        rss: { before: before.rss, peak: rssPeak }
+                    });
+                } else if (issued < count) {
+                    issue();
+                }
+            });
+        }
+        for (var i = 0; i < Math.min(inFlight, count); ++i) {
+            issue();
+        }
+    });
+}
+
+/// <summary> Turns what a run measured into its result. </summary>
+function toRun(runner: string, kind: string, cost: number, inFlight: number, step: AsyncWorkStep): AsyncWorkRun {
+    let latency = new HdrHistogram();
+    for (let i = 0; i < step.latencies.length; ++i) {
+        latency.record(step.latencies[i]);
+    }
+    let added = (stats: { before: number, peak: number }) => stats.before < 0 ? NaN : stats.peak - stats.before;
+    return {
+        runner: runner,
+        kind: kind,
+        cost: cost,
+        inFlight: inFlight,
+        throughput: step.latencies.length / step.elapsed * 1000,
+        latency: latency,
+        threadsAdded: added(step.threads),
+        rssAdded: added(step.rss)
+    };
+}
+
+/// <summary> Runs a kind of work on the napa runner, in a zone worker, and on the node runner, in the main thread. </summary>
+export async function runKind(zone: napa.zone.Zone, kind: string, cost: number, inFlight: number, count: number): Promise<AsyncWorkRun[]> {
+    let napaAddon = path.join(ADDON_DIR, 'async-work.napa');
+    let nodeAddon = path.join(ADDON_DIR, 'async-work.node');
+    let args = [KINDS[kind], cost, count, inFlight];
+
+    let napaResult = await zone.execute(measureAsyncWork, [napaAddon].concat(<any[]>args));
+    let nodeStep = await measureAsyncWork.apply(undefined, [nodeAddon].concat(<any[]>args));
+    return [
+        toRun('napa', kind, cost, inFlight, napaResult.value),
+        toRun('node', kind, cost, inFlight, nodeStep)
+    ];
+}
+
+export async function run(zone: napa.zone.Zone, options: AsyncWorkOptions = DEFAULT_ASYNC_WORK_OPTIONS): Promise<AsyncWorkRun[]> {
+    let kinds = Object.keys(KINDS).filter(kind => options.kinds === undefined || options.kinds.indexOf(kind) >= 0);
+
+    // Warm-up, which also starts the threads pools keep.
+    for (let kind of kinds) {
+        await runKind(zone, kind, 0, 64, Math.min(options.count, 1000));
+    }
+
+    let runs: AsyncWorkRun[] = [];
+    for (let kind of kinds) {
+        for (let cost of kind === 'inline' ? [0] : options.costs) {
+            for (let inFlight of options.inFlight) {
+                runs = runs.concat(await runKind(zone, kind, cost, inFlight, options.count));
+            }
+        }
+    }
+    return runs;
+}
+
+/// <summary>
+///     Compares async work of native addons between napa-async-runner.h, in a zone worker, and node-async-runner.h, in
+///     the Node.js main thread, with the same addon built for both. Skipped unless the addon is built.
+/// </summary>
+export async function bench(options: AsyncWorkOptions = DEFAULT_ASYNC_WORK_OPTIONS): Promise<void> {
+    if (!fs.existsSync(path.join(ADDON_DIR, 'async-work.napa')) || !fs.existsSync(path.join(ADDON_DIR, 'async-work.node'))) {
+        console.log("Skipping async work benchmark, its addon isn't built, see 'npm run asyncbenchmark'.\n");
+        return;
+    }
+    console.log("Benchmarking async work of native addons...");
+
+    let zone = napa.zone.create('async-work-zone', { workers: 1 });
+    let runs = await run(zone, options);
+
+    let ms = (us: number) => (us / 1000).toFixed(3);
+    let orNa = (value: number, digits: number) => isNaN(value) ? 'n/a' : value.toFixed(digits);
+    let table = [["runner", "work", "cost (us)", "in flight", "completions/s", "p50 (ms)", "p99 (ms)", "max (ms)", "threads added", "RSS added (MB)"]];
+    for (let run of runs) {
+        let name = `${run.kind} ${run.cost}us x${run.inFlight} - ${run.runner}`;
+        record('async-work', `${name} - throughput`, run.throughput, 'completions/s', 'higher');
+        record('async-work', `${name} - p99`, run.latency.valueAtPercentile(99) / 1000);
+
+        table.push([
+            run.runner,
+            run.kind,
+            run.cost.toString(),
+            run.inFlight.toString(),
+            run.throughput.toFixed(0),
+            ms(run.latency.valueAtPercentile(50)),
+            ms(run.latency.valueAtPercentile(99)),
+            ms(run.latency.max),
+            orNa(run.threadsAdded, 0),
+            orNa(run.rssAdded / 1024, 1)
+        ]);
+    }
+
+    console.log(`## Async work of ${options.count} items per run\n`);
+    console.log(mdTable(table));
+    console.log('');
+}
+
+/// <summary>
+///     Runs on its own, once the addon is built:
+///     node async-work.js --count 100000 --in-flight 1,64,1024 --costs 0,100,1000 [--kinds cpu,io,inline]
+/// </summary>
+if (require.main === module) {
+    let options: AsyncWorkOptions = Object.assign({}, DEFAULT_ASYNC_WORK_OPTIONS);
+    let argv = process.argv.slice(2);
+    for (let i = 0; i + 1 < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--count': options.count = parseInt(value); break;
+            case '--in-flight': options.inFlight = value.split(',').map(n => parseInt(n)); break;
+            case '--costs': options.costs = value.split(',').map(n => parseInt(n)); break;
+            case '--kinds': options.kinds = value.split(','); break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+
+    bench(options).then(() => process.exit(0));
+}
@@ -0,0 +1,205 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import * as childProcess from 'child_process';
+
+/// <summary> Which direction of a metric is an improvement. </summary>
+export type Better = 'lower' | 'higher';
+
+/// <summary> Statistics of the samples of a metric, one sample per run. </summary>
+export interface MetricStats {
+    /// <summary> Benchmark the metric belongs to, e.g. 'transport-overhead'. </summary>
+    suite: string;
+
+    /// <summary> Name of the metric, unique within the suite. </summary>
+    name: string;
+
+    /// <summary> Unit of samples, e.g. 'ms', 'us', 'calls/s' or 'bytes'. </summary>
+    unit: string;
+
+    better: Better;
+
+    samples: number[];
+    mean: number;
+    median: number;
+    min: number;
+    max: number;
+
+    /// <summary> Sample standard deviation, 0 for a single sample. </summary>
+    stddev: number;
+}
+
+/// <summary> Host a results file was recorded on. </summary>
+export interface MachineInfo {
+    hostname: string;
+    platform: string;
+    arch: string;
+    cpu: string;
+    cpus: number;
+    memory: number;
+    node: string;
+    v8: string;
+}
+
+/// <summary> Content of a results file. </summary>
+export interface BenchmarkResults {
+    version: number;
+    date: string;
+
+    /// <summary> Commit of the tree that was benchmarked, empty if unknown. </summary>
+    gitSha: string;
+
+    machine: MachineInfo;
+    metrics: MetricStats[];
+}
+
+const RESULTS_VERSION = 1;
+
+let _metrics = new Map<string, { suite: string, name: string, unit: string, better: Better, samples: number[] }>();
+
+/// <summary> Records a sample of a metric. Metrics recorded again, e.g. by another run, collect samples to measure their variance. </summary>
+/// <param name="suite"> Benchmark the metric belongs to. </param>
+/// <param name="name"> Name of the metric, unique within the suite. </param>
+/// <param name="value"> Sample value. </param>
+/// <param name="unit"> Unit of the value, 'ms' by default. </param>
+/// <param name="better"> 'lower' (default) if smaller values are better, as for times, 'higher' otherwise, as for throughput. </param>
+export function record(suite: string, name: string, value: number, unit: string = 'ms', better: Better = 'lower'): void {
+    let key = suite + '/' + name;
+    let metric = _metrics.get(key);
+    if (metric === undefined) {
+        metric = { suite: suite, name: name, unit: unit, better: better, samples: [] };
+        _metrics.set(key, metric);
+    }
+    if (isFinite(value)) {
+        metric.samples.push(value);
+    }
+}
+
+/// <summary> Drops recorded metrics. </summary>
+export function clear(): void {
+    _metrics.clear();
+}
+
+/// <summary> Returns recorded metrics with their statistics, and what they were recorded on. </summary>
+export function getResults(): BenchmarkResults {
+    let metrics: MetricStats[] = [];
+    _metrics.forEach(metric => {
+        if (metric.samples.length > 0) {
+            metrics.push(summarize(metric.suite, metric.name, metric.unit, metric.better, metric.samples));
+        }
+    });
+    return {
+        version: RESULTS_VERSION,
+        date: new Date().toISOString(),
+        gitSha: getGitSha(),
+        machine: getMachineInfo(),
+        metrics: metrics
+    };
+}
+
+/// <summary> Writes recorded metrics to a JSON file. </summary>
+export function writeResults(filePath: string): void {
+    fs.writeFileSync(filePath, JSON.stringify(getResults(), null, 2));
+}
+
+/// <summary> Reads a results file written by writeResults, or by the native micro-benchmarks (Google Benchmark JSON). </summary>
+export function readResults(filePath: string): BenchmarkResults {
+    let content = JSON.parse(fs.readFileSync(filePath, 'utf8'));
+    if (Array.isArray(content.benchmarks)) {
+        return fromGoogleBenchmark(content);
+    }
+    if (content.version !== RESULTS_VERSION || !Array.isArray(content.metrics)) {
+        throw new Error(`"${filePath}" is not a benchmark results file.`);
+    }
+    return content;
+}
+
+/// <summary> Computes statistics of samples. </summary>
+export function summarize(suite: string, name: string, unit: string, better: Better, samples: number[]): MetricStats {
+    let sorted = samples.slice().sort((a, b) => a - b);
+    let n = sorted.length;
+    let mean = sorted.reduce((sum, x) => sum + x, 0) / n;
+    let variance = n > 1 ? sorted.reduce((sum, x) => sum + (x - mean) * (x - mean), 0) / (n - 1) : 0;
+    return {
+        suite: suite,
+        name: name,
+        unit: unit,
+        better: better,
+        samples: samples,
+        mean: mean,
+        median: n % 2 === 1 ? sorted[(n - 1) / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2,
+        min: sorted[0],
+        max: sorted[n - 1],
+        stddev: Math.sqrt(variance)
+    };
+}
+
+/// <summary> Converts Google Benchmark JSON, whose iterations of a benchmark are repetitions, e.g. of --benchmark_repetitions=5. </summary>
+function fromGoogleBenchmark(content: any): BenchmarkResults {
+    let samples = new Map<string, { unit: string, values: number[] }>();
+    for (let benchmark of content.benchmarks) {
+        // Aggregates (mean, median, stddev) of repetitions are recomputed from the repetitions.
+        if (benchmark.run_type === 'aggregate' || benchmark.error_occurred) {
+            continue;
+        }
+        let name = benchmark.run_name || benchmark.name;
+        let entry = samples.get(name);
+        if (entry === undefined) {
+            entry = { unit: benchmark.time_unit || 'ns', values: [] };
+            samples.set(name, entry);
+        }
+        entry.values.push(benchmark.real_time);
+    }
+
+    let context = content.context || {};
+    let metrics: MetricStats[] = [];
+    samples.forEach((entry, name) => {
+        metrics.push(summarize('native', name, entry.unit, 'lower', entry.values));
+    });
+    return {
+        version: RESULTS_VERSION,
+        date: context.date || '',
+        gitSha: context.git_sha || '',
+        machine: {
+            hostname: context.host_name || '',
+            platform: '',
+            arch: '',
+            cpu: context.mhz_per_cpu ? `${context.mhz_per_cpu} MHz` : '',
+            cpus: context.num_cpus || 0,
+            memory: 0,
+            node: '',
+            v8: ''
+        },
+        metrics: metrics
+    };
+}
+
+/// <summary> Returns the commit of the working tree, empty if it's not a git repository. </summary>
+export function getGitSha(): string {
+    try {
+        return childProcess.execSync('git rev-parse HEAD', {
+            cwd: path.resolve(__dirname, '..'),
+            stdio: ['ignore', 'pipe', 'ignore']
+        }).toString().trim();
+    }
+    catch (error) {
+        return '';
+    }
+}
+
+export function getMachineInfo(): MachineInfo {
+    let cpus = os.cpus();
+    return {
+        hostname: os.hostname(),
+        platform: `${os.type()} ${os.release()}`,
+        arch: os.arch(),
+        cpu: cpus.length > 0 ? cpus[0].model : '',
+        cpus: cpus.length,
+        memory: os.totalmem(),
+        node: process.versions.node,
+        v8: process.versions.v8
+    };
+}
@@ -5,21 +5,82 @@ import * as napa from '../lib/index';
 import * as nodeNapaPerfComp from './node-napa-perf-comparison';
 import * as executeOverhead from './execute-overhead';
 import * as executeScalability from './execute-scalability';
+import * as executeLatency from './execute-latency';
 import * as transportOverhead from './transport-overhead';
 import * as storeOverhead from './store-overhead';
+import * as payloadSweep from './payload-sweep';
+import * as storeContention from './store-contention';
+import * as allocatorOverhead from './allocator-overhead';
+import * as zoneStartup from './zone-startup';
+import * as broadcastFanout from './broadcast-fanout';
+import * as workerThreadsComparison from './worker-threads-comparison';
+import * as gcLatency from './gc-latency';
+import * as asyncWork from './async-work';
+import * as results from './bench-results';
+
+let singleWorkerZone: napa.zone.Zone = undefined;
+let multiWorkerZone: napa.zone.Zone = undefined;
 
 export function bench(): Promise<void> {
     // Non-zone related benchmarks.
     transportOverhead.bench();
     storeOverhead.bench();
 
-    // Create zones for execute related benchmark.
-    let singleWorkerZone = napa.zone.create('single-worker-zone', { workers: 1});
-    let multiWorkerZone = napa.zone.create('multi-worker-zone', { workers: 8 });
+    // Sizes up to 1MB only, the full sweep up to 100MB is run on its own.
+    payloadSweep.bench(Object.assign({}, payloadSweep.DEFAULT_SWEEP_OPTIONS, { sizes: [1e2, 1e3, 1e4, 1e5, 1e6], minTime: 100 }));
+
+    // Create zones for execute related benchmark, once for all runs.
+    if (singleWorkerZone === undefined) {
+        singleWorkerZone = napa.zone.create('single-worker-zone', { workers: 1});
+        multiWorkerZone = napa.zone.create('multi-worker-zone', { workers: 8 });
+    }
 
     return nodeNapaPerfComp.bench(singleWorkerZone)
         .then(() => { return executeOverhead.bench(singleWorkerZone); })
-        .then(() => { return executeScalability.bench(multiWorkerZone);});
+        .then(() => { return executeScalability.bench(multiWorkerZone);})
+        .then(() => { return executeLatency.bench(multiWorkerZone);})
+        .then(() => { return workerThreadsComparison.bench(multiWorkerZone);})
+        .then(() => { return gcLatency.bench(Object.assign({}, gcLatency.DEFAULT_GC_LATENCY_OPTIONS, { duration: 2 }));})
+        .then(() => { return asyncWork.bench(Object.assign({}, asyncWork.DEFAULT_ASYNC_WORK_OPTIONS, { count: 5000 }));})
+        .then(() => { return allocatorOverhead.bench(multiWorkerZone, 8);})
+        .then(() => { return storeContention.bench(Object.assign({}, storeContention.DEFAULT_CONTENTION_OPTIONS, { perWorker: false }));})
+        .then(() => { return broadcastFanout.bench(Object.assign({}, broadcastFanout.DEFAULT_FANOUT_OPTIONS, { fanouts: [10000, 100000] }));})
+        .then(() => { return zoneStartup.bench(Object.assign({}, zoneStartup.DEFAULT_STARTUP_OPTIONS, { workers: [1, 2, 4, 8] }));});
 }
 
-bench();
\ No newline at end of file
+/// <summary>
+///     Runs benchmarks, repeatedly to measure the variance of each metric, and optionally writes metrics to a JSON file
+///     for compare-results.js to tell regressions from noise:
+///     node bench.js [--runs 5] [--json results.json]
+/// </summary>
+async function main(): Promise<void> {
+    let runs = 1;
+    let jsonPath: string = undefined;
+    let argv = process.argv.slice(2);
+    for (let i = 0; i + 1 < argv.length; i += 2) {
+        switch (argv[i]) {
+            case '--runs': runs = parseInt(argv[i + 1]); break;
+            case '--json': jsonPath = argv[i + 1]; break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+
+    for (let run = 1; run <= runs; ++run) {
+        if (runs > 1) {
+            console.log(`# Run ${run} of ${runs}\n`);
+        }
+        await bench();
+    }
+
+    if (jsonPath !== undefined) {
+        results.writeResults(jsonPath);
+        console.log(`Results of ${runs} run(s) are written to ${jsonPath}.`);
+    }
+}
+
+if (require.main === module) {
+    main().then(() => process.exit(0), (error) => {
+        console.error(error);
+        process.exit(1);
+    });
+}
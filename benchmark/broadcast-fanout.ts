@@ -0,0 +1,223 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as mdTable from 'markdown-table';
+import { generateString, timeDiffInMs, formatTimeDiff } from './bench-utils';
+import { record } from './bench-results';
+
+/// <summary> Options of the broadcast and fan-out benchmark. </summary>
+export interface FanoutOptions {
+    /// <summary> Worker counts of the zones broadcast to. </summary>
+    broadcastWorkers: number[];
+
+    /// <summary> Lengths of the broadcast sources. </summary>
+    sourceSizes: number[];
+
+    /// <summary> Broadcasts timed per worker count and source size. </summary>
+    broadcastRepeat: number;
+
+    /// <summary> Workers of the zone executes fan out to. </summary>
+    fanoutWorkers: number;
+
+    /// <summary> Numbers of calls issued at once. </summary>
+    fanouts: number[];
+
+    /// <summary> Calls per executeBatch, for the batch API. </summary>
+    batchSize: number;
+}
+
+export const DEFAULT_FANOUT_OPTIONS: FanoutOptions = {
+    broadcastWorkers: [1, 2, 4, 8, 16],
+    sourceSizes: [100, 10000, 1000000],
+    broadcastRepeat: 10,
+    fanoutWorkers: 8,
+    fanouts: [10000, 100000, 1000000],
+    batchSize: 1000
+};
+
+/// <summary> A fan-out of calls. Times are in milliseconds, memory in bytes. </summary>
+export interface Fanout {
+    mode: 'execute' | 'executeBatch';
+    calls: number;
+
+    /// <summary> Time to issue all calls, which returns before they run. </summary>
+    issue: number;
+
+    /// <summary> Time until all calls completed. </summary>
+    total: number;
+
+    /// <summary> CPU time of all calls on their workers, by Result.cpuTime. </summary>
+    cpuTime: number;
+
+    /// <summary> Highest number of calls waiting for a worker, NaN without the 'in-process' metric provider. </summary>
+    maxQueueDepth: number;
+
+    /// <summary> Highest growth of Node heap and of the process resident set over the start of the fan-out. </summary>
+    peakHeap: number;
+    peakRss: number;
+}
+
+/// <summary> The function fanned out to, which does nothing but return its argument. </summary>
+function fanoutTest(i: number): number {
+    return i;
+}
+
+/// <summary> Returns the calls queued in a zone over all priorities, NaN without the 'in-process' metric provider. </summary>
+function getQueueDepth(zoneId: string): number {
+    let snapshots: napa.metric.MetricSnapshot[];
+    try {
+        snapshots = napa.metric.snapshot([]);
+    }
+    catch (error) {
+        return NaN;
+    }
+
+    let depth = NaN;
+    for (let snapshot of snapshots) {
+        if (snapshot.section === 'Zone' && snapshot.name === 'QueueDepth') {
+            for (let series of snapshot.series) {
+                if (series.dimensions[0] === zoneId) {
+                    depth = (isNaN(depth) ? 0 : depth) + series.value;
+                }
+            }
+        }
+    }
+    return depth;
+}
+
+/// <summary> Times broadcasts of a source to a zone, returning milliseconds per broadcast. </summary>
+export async function measureBroadcast(zone: napa.zone.Zone, sourceSize: number, repeat: number): Promise<number> {
+    // Each source assigns a different global, so none is compacted away from the broadcast log.
+    let value = generateString(Math.max(sourceSize - 32, 1));
+    let time = 0;
+    for (let i = 0; i < repeat; ++i) {
+        let source = `var broadcastValue${i} = '${value}';`;
+        let start = process.hrtime();
+        await zone.broadcast(source);
+        time += timeDiffInMs(process.hrtime(start));
+    }
+    return time / repeat;
+}
+
+/// <summary> Issues calls at once, with execute per call or executeBatch per batchSize calls, and waits for all of them. </summary>
+export async function measureFanout(zone: napa.zone.Zone, mode: 'execute' | 'executeBatch', calls: number, batchSize: number): Promise<Fanout> {
+    let fanout: Fanout = {
+        mode: mode, calls: calls, issue: 0, total: 0, cpuTime: 0, maxQueueDepth: NaN, peakHeap: 0, peakRss: 0
+    };
+
+    let baseline = process.memoryUsage();
+    let sample = () => {
+        let usage = process.memoryUsage();
+        fanout.peakHeap = Math.max(fanout.peakHeap, usage.heapUsed - baseline.heapUsed);
+        fanout.peakRss = Math.max(fanout.peakRss, usage.rss - baseline.rss);
+        let depth = getQueueDepth(zone.id);
+        if (!isNaN(depth)) {
+            fanout.maxQueueDepth = isNaN(fanout.maxQueueDepth) ? depth : Math.max(fanout.maxQueueDepth, depth);
+        }
+    };
+
+    let addCpuTime = (result: napa.zone.Result) => { fanout.cpuTime += result.cpuTime / 1e6; };
+    let pending: Promise<void>[] = [];
+    let start = process.hrtime();
+    if (mode === 'execute') {
+        for (let i = 0; i < calls; ++i) {
+            pending.push(zone.execute('', 'fanoutTest', [i]).then(addCpuTime));
+        }
+    } else {
+        for (let i = 0; i < calls; i += batchSize) {
+            let argsArray: any[][] = [];
+            for (let j = i; j < Math.min(i + batchSize, calls); ++j) {
+                argsArray.push([j]);
+            }
+            pending.push(zone.executeBatch('', 'fanoutTest', argsArray).then(results => results.forEach(addCpuTime)));
+        }
+    }
+    fanout.issue = timeDiffInMs(process.hrtime(start));
+
+    // The queue is deepest once all calls are issued, later samples see it drain.
+    sample();
+    let sampler = setInterval(sample, 10);
+    await Promise.all(pending);
+    clearInterval(sampler);
+    fanout.total = timeDiffInMs(process.hrtime(start));
+    return fanout;
+}
+
+export async function bench(options: FanoutOptions = DEFAULT_FANOUT_OPTIONS): Promise<void> {
+    console.log("Benchmarking broadcast and fan-out...");
+
+    let broadcastTable = [["workers"].concat(options.sourceSizes.map(size => `${size} bytes (ms)`))];
+    for (let workers of options.broadcastWorkers) {
+        let zone = napa.zone.create(`broadcast-${workers}`, { workers: workers });
+        await measureBroadcast(zone, options.sourceSizes[0], 1);
+
+        let row = [workers.toString()];
+        for (let size of options.sourceSizes) {
+            let time = await measureBroadcast(zone, size, options.broadcastRepeat);
+            record('broadcast-fanout', `broadcast - ${workers} workers - ${size} bytes`, time);
+            row.push(formatTimeDiff(time));
+        }
+        broadcastTable.push(row);
+    }
+    console.log("## Broadcast latency\n");
+    console.log(mdTable(broadcastTable));
+    console.log('');
+
+    let zone = napa.zone.create('fanout', { workers: options.fanoutWorkers });
+    await zone.broadcast(fanoutTest.toString());
+    await measureFanout(zone, 'execute', 1000, options.batchSize);
+
+    let mb = (bytes: number) => (bytes / (1024 * 1024)).toFixed(1);
+    let fanoutTable = [["API", "calls", "issue (ms)", "total (ms)", "calls/s", "worker CPU (ms)", "total / (CPU / workers)",
+        "max queue depth", "peak heap (MB)", "peak RSS (MB)"]];
+    for (let calls of options.fanouts) {
+        for (let mode of <('execute' | 'executeBatch')[]>['execute', 'executeBatch']) {
+            let fanout = await measureFanout(zone, mode, calls, options.batchSize);
+            let name = `${mode} - ${calls} calls`;
+            record('broadcast-fanout', `${name} - total`, fanout.total);
+            record('broadcast-fanout', `${name} - peak RSS`, fanout.peakRss, 'bytes');
+
+            fanoutTable.push([
+                mode === 'execute' ? 'execute' : `executeBatch of ${options.batchSize}`,
+                calls.toString(),
+                formatTimeDiff(fanout.issue),
+                formatTimeDiff(fanout.total),
+                (calls * 1000 / fanout.total).toFixed(0),
+                formatTimeDiff(fanout.cpuTime),
+                (fanout.total / (fanout.cpuTime / options.fanoutWorkers)).toFixed(1) + 'x',
+                isNaN(fanout.maxQueueDepth) ? '-' : fanout.maxQueueDepth.toString(),
+                mb(fanout.peakHeap),
+                mb(fanout.peakRss)
+            ]);
+        }
+    }
+    console.log(`## Fan-out of an empty function to ${options.fanoutWorkers} workers\n`);
+    console.log(mdTable(fanoutTable));
+    console.log('');
+}
+
+/// <summary>
+///     Runs on its own with the 'in-process' metric provider, which reports queue depths:
+///     node --max-old-space-size=8192 broadcast-fanout.js --workers 1,4,16 --sources 100,1000000 --repeat 10 --fanout-workers 8 --fanouts 10000,1000000 --batch 1000
+/// </summary>
+if (require.main === module) {
+    let options: FanoutOptions = Object.assign({}, DEFAULT_FANOUT_OPTIONS);
+    let argv = process.argv.slice(2);
+    for (let i = 0; i + 1 < argv.length; i += 2) {
+        let value = argv[i + 1];
+        let list = () => value.split(',').map(n => parseInt(n));
+        switch (argv[i]) {
+            case '--workers': options.broadcastWorkers = list(); break;
+            case '--sources': options.sourceSizes = list(); break;
+            case '--repeat': options.broadcastRepeat = parseInt(value); break;
+            case '--fanout-workers': options.fanoutWorkers = parseInt(value); break;
+            case '--fanouts': options.fanouts = list(); break;
+            case '--batch': options.batchSize = parseInt(value); break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+    napa.runtime.setPlatformSettings({ metricProvider: 'in-process' });
+
+    bench(options).then(() => process.exit(0));
+}
@@ -0,0 +1,241 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as mdTable from 'markdown-table';
+import { MetricStats, BenchmarkResults, readResults } from './bench-results';
+
+/// <summary> Options of comparing two results files. </summary>
+export interface CompareOptions {
+    /// <summary> Changes smaller than this fraction of the base mean are ignored, however significant. </summary>
+    threshold: number;
+
+    /// <summary> Significance level of the Welch t-test. A change is significant if its p-value is below it. </summary>
+    alpha: number;
+}
+
+export const DEFAULT_COMPARE_OPTIONS: CompareOptions = {
+    threshold: 0.05,
+    alpha: 0.05
+};
+
+export type Verdict =
+    'regression' |
+    'improvement' |
+    'unchanged' |
+    'added' |       // Only in the new results.
+    'removed';      // Only in the base results.
+
+export interface Comparison {
+    suite: string;
+    name: string;
+    unit: string;
+    base: MetricStats;
+    head: MetricStats;
+
+    /// <summary> Change of the mean relative to the base mean, positive if the value grew. </summary>
+    change: number;
+
+    /// <summary> Two-sided p-value of the change, NaN if either side has a single sample. </summary>
+    pValue: number;
+
+    verdict: Verdict;
+}
+
+/// <summary> Natural log of the gamma function, by the Lanczos approximation. </summary>
+function logGamma(x: number): number {
+    const COEFFICIENTS = [
+        676.5203681218851, -1259.1392167224028, 771.32342877765313, -176.61502916214059,
+        12.507343278686905, -0.13857109526572012, 9.9843695780195716e-6, 1.5056327351493116e-7];
+    if (x < 0.5) {
+        return Math.log(Math.PI / Math.abs(Math.sin(Math.PI * x))) - logGamma(1 - x);
+    }
+    x -= 1;
+    let a = 0.99999999999980993;
+    let t = x + 7.5;
+    for (let i = 0; i < COEFFICIENTS.length; ++i) {
+        a += COEFFICIENTS[i] / (x + i + 1);
+    }
+    return 0.5 * Math.log(2 * Math.PI) + (x + 0.5) * Math.log(t) - t + Math.log(a);
+}
+
+/// <summary> Continued fraction of the incomplete beta function, by the modified Lentz method. </summary>
+function betaContinuedFraction(x: number, a: number, b: number): number {
+    const EPSILON = 1e-14;
+    const TINY = 1e-300;
+    let c = 1;
+    let d = 1 - (a + b) * x / (a + 1);
+    d = Math.abs(d) < TINY ? 1 / TINY : 1 / d;
+    let h = d;
+    for (let m = 1; m <= 300; ++m) {
+        let m2 = 2 * m;
+        let numerator = m * (b - m) * x / ((a + m2 - 1) * (a + m2));
+        d = 1 + numerator * d;
+        d = Math.abs(d) < TINY ? 1 / TINY : 1 / d;
+        c = 1 + numerator / c;
+        c = Math.abs(c) < TINY ? TINY : c;
+        h *= d * c;
+
+        numerator = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1));
+        d = 1 + numerator * d;
+        d = Math.abs(d) < TINY ? 1 / TINY : 1 / d;
+        c = 1 + numerator / c;
+        c = Math.abs(c) < TINY ? TINY : c;
+        let delta = d * c;
+        h *= delta;
+        if (Math.abs(delta - 1) < EPSILON) {
+            break;
+        }
+    }
+    return h;
+}
+
+/// <summary> Regularized incomplete beta function I_x(a, b). </summary>
+export function incompleteBeta(x: number, a: number, b: number): number {
+    if (x <= 0) {
+        return 0;
+    }
+    if (x >= 1) {
+        return 1;
+    }
+    let front = Math.exp(logGamma(a + b) - logGamma(a) - logGamma(b) + a * Math.log(x) + b * Math.log(1 - x));
+    // The continued fraction converges fast for x below the mean of the distribution, the symmetry covers the rest.
+    if (x < (a + 1) / (a + b + 2)) {
+        return front * betaContinuedFraction(x, a, b) / a;
+    }
+    return 1 - front * betaContinuedFraction(1 - x, b, a) / b;
+}
+
+/// <summary> Two-sided p-value of Welch's t-test, whether two sets of samples have different means without assuming equal variances. </summary>
+/// <returns> NaN if either set has a single sample. </returns>
+export function welchTest(base: MetricStats, head: MetricStats): number {
+    let n1 = base.samples.length;
+    let n2 = head.samples.length;
+    if (n1 < 2 || n2 < 2) {
+        return NaN;
+    }
+    let v1 = base.stddev * base.stddev / n1;
+    let v2 = head.stddev * head.stddev / n2;
+    if (v1 + v2 === 0) {
+        return base.mean === head.mean ? 1 : 0;
+    }
+    let t = (head.mean - base.mean) / Math.sqrt(v1 + v2);
+
+    // Welch-Satterthwaite degrees of freedom.
+    let df = (v1 + v2) * (v1 + v2) / (v1 * v1 / (n1 - 1) + v2 * v2 / (n2 - 1));
+    return incompleteBeta(df / (df + t * t), df / 2, 0.5);
+}
+
+/// <summary> Compares metrics of two results, matched by suite and name. </summary>
+/// <remarks>
+///     A change is a regression or an improvement when it exceeds the threshold and, if both sides have repeated samples, is significant.
+///     Metrics of a single sample have no variance to judge noise by, hence are judged by the threshold only.
+/// </remarks>
+export function compare(base: BenchmarkResults, head: BenchmarkResults, options: CompareOptions = DEFAULT_COMPARE_OPTIONS): Comparison[] {
+    let key = (metric: MetricStats) => metric.suite + '/' + metric.name;
+    let baseMetrics = new Map<string, MetricStats>();
+    for (let metric of base.metrics) {
+        baseMetrics.set(key(metric), metric);
+    }
+
+    let comparisons: Comparison[] = [];
+    for (let metric of head.metrics) {
+        let baseMetric = baseMetrics.get(key(metric));
+        baseMetrics.delete(key(metric));
+        if (baseMetric === undefined) {
+            comparisons.push({ suite: metric.suite, name: metric.name, unit: metric.unit, base: undefined, head: metric, change: NaN, pValue: NaN, verdict: 'added' });
+            continue;
+        }
+
+        let change = baseMetric.mean !== 0 ? (metric.mean - baseMetric.mean) / Math.abs(baseMetric.mean) : 0;
+        let pValue = welchTest(baseMetric, metric);
+        let verdict: Verdict = 'unchanged';
+        if (Math.abs(change) > options.threshold && !(pValue >= options.alpha)) {
+            let worse = metric.better === 'lower' ? change > 0 : change < 0;
+            verdict = worse ? 'regression' : 'improvement';
+        }
+        comparisons.push({ suite: metric.suite, name: metric.name, unit: metric.unit, base: baseMetric, head: metric, change: change, pValue: pValue, verdict: verdict });
+    }
+    baseMetrics.forEach(metric => {
+        comparisons.push({ suite: metric.suite, name: metric.name, unit: metric.unit, base: metric, head: undefined, change: NaN, pValue: NaN, verdict: 'removed' });
+    });
+    return comparisons;
+}
+
+function formatStats(stats: MetricStats): string {
+    if (stats === undefined) {
+        return '-';
+    }
+    let digits = Math.abs(stats.mean) >= 100 ? 0 : 3;
+    return stats.samples.length > 1 ?
+        `${stats.mean.toFixed(digits)} ± ${stats.stddev.toFixed(digits)}` :
+        stats.mean.toFixed(digits);
+}
+
+function describe(results: BenchmarkResults): string {
+    let machine = results.machine;
+    return `${results.gitSha ? results.gitSha.substring(0, 10) : '(unknown commit)'} on ${machine.hostname} ` +
+        `(${machine.cpu}, ${machine.cpus} CPUs${machine.node ? ', node ' + machine.node : ''}), ${results.date}`;
+}
+
+/// <summary> Prints comparisons as a markdown table, only changed ones unless all is true. </summary>
+export function report(base: BenchmarkResults, head: BenchmarkResults, comparisons: Comparison[], all: boolean = false): void {
+    console.log(`Base: ${describe(base)}`);
+    console.log(`Head: ${describe(head)}\n`);
+
+    let table = [["suite", "metric", "unit", "base", "head", "change", "p-value", "verdict"]];
+    for (let comparison of comparisons) {
+        if (!all && comparison.verdict === 'unchanged') {
+            continue;
+        }
+        table.push([
+            comparison.suite,
+            comparison.name,
+            comparison.unit,
+            formatStats(comparison.base),
+            formatStats(comparison.head),
+            isNaN(comparison.change) ? '-' : (comparison.change > 0 ? '+' : '') + (comparison.change * 100).toFixed(1) + '%',
+            isNaN(comparison.pValue) ? '-' : comparison.pValue.toFixed(3),
+            comparison.verdict
+        ]);
+    }
+    if (table.length > 1) {
+        console.log(mdTable(table));
+    }
+
+    let count = (verdict: Verdict) => comparisons.filter(c => c.verdict === verdict).length;
+    console.log(`\n${count('regression')} regressions, ${count('improvement')} improvements, ${count('unchanged')} unchanged, ` +
+        `${count('added')} added, ${count('removed')} removed.`);
+}
+
+/// <summary>
+///     Compares two results files, written by bench.js --json or by the native micro-benchmarks, and exits with 1 on regressions:
+///     node compare-results.js base.json head.json [--threshold 0.05] [--alpha 0.05] [--all]
+/// </summary>
+if (require.main === module) {
+    let options: CompareOptions = Object.assign({}, DEFAULT_COMPARE_OPTIONS);
+    let files: string[] = [];
+    let all = false;
+    let argv = process.argv.slice(2);
+    for (let i = 0; i < argv.length; ++i) {
+        switch (argv[i]) {
+            case '--threshold': options.threshold = parseFloat(argv[++i]); break;
+            case '--alpha': options.alpha = parseFloat(argv[++i]); break;
+            case '--all': all = true; break;
+            default:
+                if (argv[i].startsWith('--')) {
+                    throw new Error(`Unknown option "${argv[i]}".`);
+                }
+                files.push(argv[i]);
+        }
+    }
+    if (files.length !== 2) {
+        console.log('Usage: node compare-results.js <base.json> <head.json> [--threshold 0.05] [--alpha 0.05] [--all]');
+        process.exit(2);
+    }
+
+    let base = readResults(files[0]);
+    let head = readResults(files[1]);
+    let comparisons = compare(base, head, options);
+    report(base, head, comparisons, all);
+    process.exit(comparisons.some(c => c.verdict === 'regression') ? 1 : 0);
+}
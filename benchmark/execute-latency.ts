@@ -0,0 +1,229 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as mdTable from 'markdown-table';
+import { generateString } from './bench-utils';
+import { HdrHistogram } from './hdr-histogram';
+import { record } from './bench-results';
+
+/// <summary> Options of the open-loop latency benchmark. </summary>
+export interface LatencyOptions {
+    /// <summary> Target rates in calls per second, run in order. </summary>
+    rates: number[];
+
+    /// <summary> Seconds each rate is held for. </summary>
+    duration: number;
+
+    /// <summary> Length of the string argument of each call. </summary>
+    payloadSize: number;
+
+    /// <summary> Length of the string each call returns. </summary>
+    resultSize: number;
+
+    /// <summary> Microseconds the called function spins for. </summary>
+    functionCost: number;
+
+    /// <summary> p99 latency in milliseconds beyond which the zone is saturated, and higher rates are skipped. </summary>
+    latencyLimit: number;
+}
+
+export const DEFAULT_LATENCY_OPTIONS: LatencyOptions = {
+    rates: [500, 1000, 2000, 4000, 8000, 16000, 32000],
+    duration: 2,
+    payloadSize: 64,
+    resultSize: 64,
+    functionCost: 100,
+    latencyLimit: 20
+};
+
+/// <summary> Latencies of a rate, in microseconds. </summary>
+export interface LatencyStep {
+    /// <summary> Target rate in calls per second. </summary>
+    rate: number;
+
+    /// <summary> Calls completed per second, from the first call till the last completion. </summary>
+    throughput: number;
+
+    /// <summary> Calls that failed. </summary>
+    failures: number;
+
+    latency: HdrHistogram;
+}
+
+function now(): number {
+    let time = process.hrtime();
+    return time[0] * 1e6 + time[1] / 1e3;
+}
+
+/// <summary> Measures how many loop iterations the worker runs per microsecond, for latencyTest to spin without allocating. </summary>
+function latencyCalibrate(): void {
+    let start = Date.now();
+    let loops = 0;
+    let sum = 0;
+    while (Date.now() - start < 100) {
+        for (let i = 0; i < 10000; ++i) {
+            sum += i;
+        }
+        loops += 10000;
+    }
+    latencySink = sum;
+    latencyLoopsPerUs = loops / ((Date.now() - start) * 1000);
+}
+
+/// <summary> The function under load, it spins for a cost in microseconds then returns a string of the result size. </summary>
+function latencyTest(cost: number, payload: string): string {
+    let sum = 0;
+    for (let i = 0, loops = cost * latencyLoopsPerUs; i < loops; ++i) {
+        sum += i;
+    }
+    latencySink = sum;
+    return latencyResult;
+}
+declare var latencyLoopsPerUs: number;
+declare var latencySink: number;
+declare var latencyResult: string;
+
+/// <summary>
+///     Issues calls at a fixed rate regardless of how fast they complete, i.e. open-loop.
+///     Latency of a call is measured from when it was meant to be issued, so falling behind the schedule
+///     is counted as latency instead of lowering the load (no coordinated omission).
+/// </summary>
+export function runStep(zone: napa.zone.Zone, rate: number, options: LatencyOptions): Promise<LatencyStep> {
+    let payload = generateString(options.payloadSize + 1);
+    return runOpenLoop(rate, options.duration, () => zone.execute('', 'latencyTest', [options.functionCost, payload]));
+}
+
+/// <summary> Makes calls at a fixed rate for a duration in seconds, see runStep. </summary>
+export function runOpenLoop(rate: number, duration: number, call: () => Promise<any>): Promise<LatencyStep> {
+    let total = Math.max(Math.round(rate * duration), 1);
+    let interval = 1e6 / rate;
+    let step: LatencyStep = { rate: rate, throughput: 0, failures: 0, latency: new HdrHistogram() };
+
+    return new Promise<LatencyStep>((resolve) => {
+        let start = now();
+        let issued = 0;
+        let completed = 0;
+        let complete = (scheduled: number, failed: boolean) => {
+            step.latency.record(now() - scheduled);
+            if (failed) {
+                step.failures++;
+            }
+            if (++completed === total) {
+                step.throughput = total * 1e6 / (now() - start);
+                resolve(step);
+            }
+        };
+
+        let issue = () => {
+            let time = now();
+            while (issued < total && start + issued * interval <= time) {
+                let scheduled = start + issued * interval;
+                ++issued;
+                call().then(() => complete(scheduled, false), () => complete(scheduled, true));
+            }
+
+            if (issued < total) {
+                // Timers don't fire sooner than a millisecond, closer calls are waited for by yielding to I/O only.
+                let wait = start + issued * interval - now();
+                if (wait >= 1000) {
+                    setTimeout(issue, Math.floor(wait / 1000));
+                } else {
+                    setImmediate(issue);
+                }
+            }
+        };
+        issue();
+    });
+}
+
+/// <summary> Runs the rates in order, stopping after the first one the zone can't sustain. </summary>
+export async function run(zone: napa.zone.Zone, options: LatencyOptions = DEFAULT_LATENCY_OPTIONS): Promise<LatencyStep[]> {
+    await zone.broadcast(latencyCalibrate.toString());
+    await zone.broadcast(latencyTest.toString());
+    await zone.broadcast('latencyCalibrate();');
+    await zone.broadcast(`var latencyResult = '${generateString(options.resultSize + 1)}';`);
+
+    // Warm-up.
+    await runStep(zone, options.rates[0], Object.assign({}, options, { duration: Math.min(options.duration, 1) }));
+
+    let steps: LatencyStep[] = [];
+    for (let rate of options.rates) {
+        let step = await runStep(zone, rate, options);
+        steps.push(step);
+        if (isSaturated(step, options)) {
+            break;
+        }
+    }
+    return steps;
+}
+
+/// <summary> Whether a zone falls apart at the rate of a step: its p99 exceeds the limit, or it completes calls slower than they come. </summary>
+export function isSaturated(step: LatencyStep, options: LatencyOptions): boolean {
+    return step.latency.valueAtPercentile(99) > options.latencyLimit * 1000 || step.throughput < step.rate * 0.95;
+}
+
+export async function bench(zone: napa.zone.Zone, options: LatencyOptions = DEFAULT_LATENCY_OPTIONS): Promise<void> {
+    console.log("Benchmarking execute latency under open-loop load...");
+
+    let steps = await run(zone, options);
+
+    let ms = (us: number) => (us / 1000).toFixed(2);
+    let table = [["rate (calls/s)", "throughput (calls/s)", "p50 (ms)", "p90 (ms)", "p99 (ms)", "p99.9 (ms)", "max (ms)", "failures"]];
+    for (let step of steps) {
+        let name = `${step.rate} calls/s`;
+        record('execute-latency', `${name} - throughput`, step.throughput, 'calls/s', 'higher');
+        record('execute-latency', `${name} - p50`, step.latency.valueAtPercentile(50) / 1000);
+        record('execute-latency', `${name} - p99`, step.latency.valueAtPercentile(99) / 1000);
+
+        table.push([
+            step.rate.toString(),
+            step.throughput.toFixed(0),
+            ms(step.latency.valueAtPercentile(50)),
+            ms(step.latency.valueAtPercentile(90)),
+            ms(step.latency.valueAtPercentile(99)),
+            ms(step.latency.valueAtPercentile(99.9)),
+            ms(step.latency.max),
+            step.failures.toString()
+        ]);
+    }
+
+    console.log(`## Execute latency of a ${options.functionCost}us function with ${options.payloadSize} bytes in and ${options.resultSize} bytes out\n`);
+    console.log(mdTable(table));
+
+    let sustained = steps.filter(step => !isSaturated(step, options));
+    record('execute-latency', 'sustained rate', sustained.length > 0 ? sustained[sustained.length - 1].rate : 0, 'calls/s', 'higher');
+    if (sustained.length === steps.length) {
+        console.log(`\nThe zone sustained all rates, up to ${steps[steps.length - 1].rate} calls/s.\n`);
+    } else if (sustained.length === 0) {
+        console.log(`\nThe zone was saturated at the lowest rate, ${steps[0].rate} calls/s.\n`);
+    } else {
+        console.log(`\nThe zone sustains ${sustained[sustained.length - 1].rate} calls/s, latency falls apart at ${steps[steps.length - 1].rate} calls/s (p99 > ${options.latencyLimit}ms or throughput < 95% of rate).\n`);
+    }
+}
+
+/// <summary>
+///     Runs on its own, e.g. to size a zone:
+///     node execute-latency.js --workers 4 --rates 1000,2000,4000 --duration 5 --payload 1024 --result 64 --cost 200 --limit 10
+/// </summary>
+if (require.main === module) {
+    let options: LatencyOptions = Object.assign({}, DEFAULT_LATENCY_OPTIONS);
+    let workers = 4;
+    let argv = process.argv.slice(2);
+    for (let i = 0; i + 1 < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--workers': workers = parseInt(value); break;
+            case '--rates': options.rates = value.split(',').map(rate => parseFloat(rate)); break;
+            case '--duration': options.duration = parseFloat(value); break;
+            case '--payload': options.payloadSize = parseInt(value); break;
+            case '--result': options.resultSize = parseInt(value); break;
+            case '--cost': options.functionCost = parseFloat(value); break;
+            case '--limit': options.latencyLimit = parseFloat(value); break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+
+    bench(napa.zone.create('latency-zone', { workers: workers }), options)
+        .then(() => process.exit(0));
+}
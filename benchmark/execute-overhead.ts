@@ -2,8 +2,10 @@
 // Licensed under the MIT license.
 
 import * as napa from '../lib/index';
+import * as path from 'path';
 import * as mdTable from 'markdown-table';
-import { formatTimeDiff } from './bench-utils';
+import { formatTimeDiff, timeDiffInMs } from './bench-utils';
+import { record } from './bench-results';
 
 function batchExecuteOnNamedFunction(
     zone: napa.zone.Zone, 
@@ -43,6 +45,41 @@ function batchExecuteOnAnonymousFunction(
     });
 }
 
+/// <summary> Queues calls behind a blocking one, then times how long the worker takes to drain them. </summary>
+async function drainQueuedCalls(
+    zone: napa.zone.Zone,
+    repeat: number,
+    args: any[]): Promise<number> {
+
+    // Long enough for all calls to be queued before the worker is free again.
+    let blocker = zone.execute(() => {
+        let end = Date.now() + 500;
+        while (Date.now() < end) {}
+    }, []);
+
+    let calls: Promise<napa.zone.Result>[] = [];
+    for (let i = 0; i < repeat; ++i) {
+        calls.push(zone.execute("", "test", args));
+    }
+
+    await blocker;
+    let start = process.hrtime();
+    await Promise.all(calls);
+    return timeDiffInMs(process.hrtime(start));
+}
+
+/// <summary> Times calls made one after another on the calling side, which is where resolving module names costs. </summary>
+async function executeInSequence(repeat: number, execute: () => Promise<any>): Promise<number> {
+    let calls: Promise<any>[] = [];
+    let start = process.hrtime();
+    for (let i = 0; i < repeat; ++i) {
+        calls.push(execute());
+    }
+    let issueTime = timeDiffInMs(process.hrtime(start));
+    await Promise.all(calls);
+    return issueTime;
+}
+
 export async function bench(zone: napa.zone.Zone): Promise<void> {
     console.log("Benchmarking execute overhead...");
 
@@ -59,7 +96,11 @@ export async function bench(zone: napa.zone.Zone): Promise<void> {
     for (let i = 0; i < WARMUP_REPEAT; ++i) {
         let start = process.hrtime();
         await zone.execute("", "test", ARGS);
-        warmupTable.push([i.toString(), formatTimeDiff(process.hrtime(start))]);
+        let time = timeDiffInMs(process.hrtime(start));
+        warmupTable.push([i.toString(), formatTimeDiff(time)]);
+        if (i === 0) {
+            record('execute-overhead', 'first call', time);
+        }
     }
     console.log(mdTable(warmupTable));
 
@@ -68,12 +109,39 @@ export async function bench(zone: napa.zone.Zone): Promise<void> {
     console.log("## `zone.execute` overhead (use function name)\n");
     let start = process.hrtime();
     await batchExecuteOnNamedFunction(zone, REPEAT, ARGS);
-    console.log(`Elapse of running empty function by name for ${REPEAT} times: ${formatTimeDiff(process.hrtime(start), true)}\n`);
+    let namedTime = timeDiffInMs(process.hrtime(start));
+    console.log(`Elapse of running empty function by name for ${REPEAT} times: ${formatTimeDiff(namedTime, true)}\n`);
+    record('execute-overhead', `named function x ${REPEAT}`, namedTime);
 
     console.log("## `zone.execute` overhead (use anonymous function)\n");
     start = process.hrtime();
     await batchExecuteOnAnonymousFunction(zone, REPEAT, ARGS);
-    console.log(`Elapse of running empty anonymous function for ${REPEAT} times: ${formatTimeDiff(process.hrtime(start), true)}\n`);
+    let anonymousTime = timeDiffInMs(process.hrtime(start));
+    console.log(`Elapse of running empty anonymous function for ${REPEAT} times: ${formatTimeDiff(anonymousTime, true)}\n`);
+    record('execute-overhead', `anonymous function x ${REPEAT}`, anonymousTime);
+
+    // A relative module name is resolved against the file of the caller, absolute names and prepared functions skip the stack.
+    console.log("## `zone.execute` issue time by how the module is named\n");
+    let moduleTable = [];
+    moduleTable.push(["module name", "issue time (ms)"]);
+    let prepared = zone.prepare('./bench-utils', 'generateString');
+    let modules: [string, () => Promise<any>][] = [
+        ["relative", () => zone.execute('./bench-utils', 'generateString', [1])],
+        ["absolute", () => zone.execute(path.resolve(__dirname, 'bench-utils'), 'generateString', [1])],
+        ["prepared", () => prepared.execute([1])]
+    ];
+    for (let [name, execute] of modules) {
+        let issueTime = await executeInSequence(REPEAT, execute);
+        moduleTable.push([name, formatTimeDiff(issueTime)]);
+        record('execute-overhead', `${name} module name issue x ${REPEAT}`, issueTime);
+    }
+    console.log(mdTable(moduleTable));
+
+    // Workers take queued calls in batches, this is where it shows compared to calls arriving one at a time.
+    console.log("## `zone.execute` overhead (calls queued on a busy worker)\n");
+    let drainTime = await drainQueuedCalls(zone, REPEAT, ARGS);
+    console.log(`Elapse of draining ${REPEAT} queued calls of empty function: ${formatTimeDiff(drainTime, true)}\n`);
+    record('execute-overhead', `queued calls x ${REPEAT}`, drainTime);
 
     return;
 }
\ No newline at end of file
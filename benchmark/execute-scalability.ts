@@ -4,7 +4,8 @@
 import * as napa from '../lib/index';
 import * as assert from 'assert';
 import * as mdTable from 'markdown-table';
-import { formatTimeDiff } from './bench-utils';
+import { formatTimeDiff, timeDiffInMs } from './bench-utils';
+import { record } from './bench-results';
 
 function makeCRCTable(){
     var c;
@@ -56,7 +57,8 @@ export async function bench(zone: napa.zone.Zone): Promise<void> {
     // Execute in Node with 1 thread.
     let start = process.hrtime();
     assert(testCrc() === crcResult);
-    let nodeTime = formatTimeDiff(process.hrtime(start));
+    let nodeTime = timeDiffInMs(process.hrtime(start));
+    record('execute-scalability', 'node', nodeTime);
 
     let executeTime = {};
     let scalabilityTest = function(workers: number): Promise<void> {
@@ -69,7 +71,9 @@ export async function bench(zone: napa.zone.Zone): Promise<void> {
                     assert(crcResult === result.value);
                     ++finished;
                     if (finished === workers) {
-                        executeTime[workers] = formatTimeDiff(process.hrtime(start))
+                        let time = timeDiffInMs(process.hrtime(start));
+                        executeTime[workers] = formatTimeDiff(time);
+                        record('execute-scalability', `napa - ${workers} workers`, time);
                         resolve();
                     }
                 });
@@ -85,7 +89,7 @@ export async function bench(zone: napa.zone.Zone): Promise<void> {
     console.log("## Execute scalability\n")
     console.log(mdTable([
         ["node", "napa - 1 worker", "napa - 2 workers", "napa - 4 workers", "napa - 8 workers"],
-        [nodeTime, executeTime[1], executeTime[2], executeTime[4], executeTime[8]]
+        [formatTimeDiff(nodeTime), executeTime[1], executeTime[2], executeTime[4], executeTime[8]]
     ]));
     console.log('');
 }
\ No newline at end of file
@@ -0,0 +1,280 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as mdTable from 'markdown-table';
+import { runOpenLoop, LatencyStep } from './execute-latency';
+import { record } from './bench-results';
+
+/// <summary> Options of the GC latency benchmark. </summary>
+export interface GcLatencyOptions {
+    /// <summary> Workers of each zone. </summary>
+    workers: number;
+
+    /// <summary> Calls per second, held for the duration of each run. </summary>
+    rate: number;
+
+    /// <summary> Seconds each run is held for. </summary>
+    duration: number;
+
+    /// <summary> Objects each objectChurn call allocates. </summary>
+    objects: number;
+
+    /// <summary> Elements of the array each largeArray call builds. </summary>
+    arrayLength: number;
+
+    /// <summary> Pieces each stringBuilding call joins. </summary>
+    pieces: number;
+
+    /// <summary> Results each worker retains in a ring, so some survive scavenges and fill the old space. </summary>
+    retained: number;
+
+    /// <summary> Names of the variants to run, all by default. </summary>
+    variants?: string[];
+}
+
+export const DEFAULT_GC_LATENCY_OPTIONS: GcLatencyOptions = {
+    workers: 2,
+    rate: 500,
+    duration: 5,
+    objects: 2000,
+    arrayLength: 100000,
+    pieces: 2000,
+    retained: 64
+};
+
+/// <summary> Zone settings compared, each run on zones of its own. </summary>
+export interface GcVariant {
+    name: string;
+    settings: napa.zone.ZoneSettings;
+}
+
+export const GC_VARIANTS: GcVariant[] = [
+    { name: 'default', settings: {} },
+    { name: 'semi-space 16MB', settings: <napa.zone.ZoneSettings>{ maxSemiSpaceSize: 16 } },
+    { name: 'semi-space 64MB', settings: <napa.zone.ZoneSettings>{ maxSemiSpaceSize: 64 } },
+    { name: 'idle GC', settings: { idleGcTime: 2, idleGcFullTime: 100 } },
+    { name: 'recycle every 10000 calls', settings: { recycleTaskCount: 10000 } }
+];
+
+/// <summary> Allocation heavy functions called by the benchmark, by name. </summary>
+const WORKLOADS = ['objectChurn', 'largeArray', 'stringBuilding'];
+
+/// <summary> Keeps a result, dropping the oldest one beyond the ring size. </summary>
+function gcRetain(value: any): void {
+    gcRetained[gcRetainedNext] = value;
+    gcRetainedNext = (gcRetainedNext + 1) % gcRetainedSize;
+}
+
+/// <summary> Allocates short lived objects, with a few nested ones each. </summary>
+function objectChurn(count: number): number {
+    let objects: any[] = [];
+    for (let i = 0; i < count; ++i) {
+        objects.push({ id: i, name: 'object' + i, tags: [i, i + 1], position: { x: i, y: -i } });
+    }
+    gcRetain(objects[count - 1]);
+    return objects.length;
+}
+
+/// <summary> Builds an array of boxed numbers, which lands in the old space once it's large. </summary>
+function largeArray(length: number): number {
+    let array = new Array(length);
+    for (let i = 0; i < length; ++i) {
+        array[i] = i * 0.5;
+    }
+    gcRetain(array.slice(0, 16));
+    return array.length;
+}
+
+/// <summary> Concatenates pieces into a string, then flattens it. </summary>
+function stringBuilding(pieces: number): number {
+    let text = '';
+    for (let i = 0; i < pieces; ++i) {
+        text += 'piece ' + i + ';';
+    }
+    let flat = text.split(';').join(',');
+    gcRetain(flat.substr(0, 64));
+    return flat.length;
+}
+declare var gcRetained: any[];
+declare var gcRetainedNext: number;
+declare var gcRetainedSize: number;
+
+/// <summary> GC metrics of a zone, times in microseconds, NaN without the 'in-process' metric provider. </summary>
+export interface GcStats {
+    /// <summary> Pauses by GC type, e.g. 'Scavenge'. </summary>
+    pauses: { [type: string]: { count: number, p50: number, p99: number, max: number } };
+
+    /// <summary> GC time spent between calls by each worker. </summary>
+    idleGcTime: number[];
+
+    isolateRecycles: number;
+}
+
+/// <summary> Result of a workload under a variant. </summary>
+export interface GcRun {
+    variant: string;
+    workload: string;
+    step: LatencyStep;
+    gc: GcStats;
+}
+
+/// <summary> Reads GC metrics of a zone from the metric snapshot. </summary>
+function getGcStats(zoneId: string): GcStats {
+    let stats: GcStats = { pauses: {}, idleGcTime: [], isolateRecycles: NaN };
+
+    let snapshots: napa.metric.MetricSnapshot[];
+    try {
+        snapshots = napa.metric.snapshot([50, 99]);
+    }
+    catch (error) {
+        return stats;
+    }
+
+    stats.isolateRecycles = 0;
+    for (let snapshot of snapshots) {
+        if (snapshot.section !== 'Zone') {
+            continue;
+        }
+        for (let series of snapshot.series) {
+            if (series.dimensions[0] !== zoneId) {
+                continue;
+            }
+            switch (snapshot.name) {
+                case 'GcPauseTime':
+                    stats.pauses[series.dimensions[1]] = {
+                        count: series.count,
+                        p50: series.percentiles['50'],
+                        p99: series.percentiles['99'],
+                        max: series.max
+                    };
+                    break;
+                case 'IdleGcTime':
+                    stats.idleGcTime[parseInt(series.dimensions[1])] = series.value;
+                    break;
+                case 'IsolateRecycles':
+                    stats.isolateRecycles += series.value;
+                    break;
+            }
+        }
+    }
+    return stats;
+}
+
+let _zoneCount = 0;
+
+/// <summary> Runs a workload at the rate on a new zone of the variant, so its GC metrics are its own. </summary>
+export async function runWorkload(variant: GcVariant, workload: string, options: GcLatencyOptions): Promise<GcRun> {
+    let zoneId = `gc-latency-${_zoneCount++}`;
+    let zone = napa.zone.create(zoneId, Object.assign({ workers: options.workers }, variant.settings));
+
+    await zone.broadcast(`var gcRetainedSize = ${options.retained}, gcRetainedNext = 0, gcRetained = [];`);
+    await zone.broadcast(gcRetain.toString());
+    await zone.broadcast(objectChurn.toString());
+    await zone.broadcast(largeArray.toString());
+    await zone.broadcast(stringBuilding.toString());
+
+    let size = workload === 'objectChurn' ? options.objects : workload === 'largeArray' ? options.arrayLength : options.pieces;
+    let call = () => zone.execute('', workload, [size]);
+
+    // Warm-up, GCs it causes are counted in the metrics as well.
+    await runOpenLoop(options.rate, Math.min(options.duration, 1), call);
+
+    let step = await runOpenLoop(options.rate, options.duration, call);
+    return { variant: variant.name, workload: workload, step: step, gc: getGcStats(zoneId) };
+}
+
+export async function run(options: GcLatencyOptions = DEFAULT_GC_LATENCY_OPTIONS): Promise<GcRun[]> {
+    let variants = GC_VARIANTS.filter(variant => options.variants === undefined || options.variants.indexOf(variant.name) >= 0);
+
+    let runs: GcRun[] = [];
+    for (let variant of variants) {
+        for (let workload of WORKLOADS) {
+            runs.push(await runWorkload(variant, workload, options));
+        }
+    }
+    return runs;
+}
+
+export async function bench(options: GcLatencyOptions = DEFAULT_GC_LATENCY_OPTIONS): Promise<void> {
+    console.log("Benchmarking execute latency under GC pressure...");
+
+    let runs = await run(options);
+
+    let ms = (us: number) => isNaN(us) ? 'n/a' : (us / 1000).toFixed(2);
+    let latencyTable = [["variant", "workload", "p50 (ms)", "p90 (ms)", "p99 (ms)", "p99.9 (ms)", "max (ms)", "failures"]];
+    let gcTable = [["variant", "workload", "GC type", "pauses", "p50 (ms)", "p99 (ms)", "max (ms)"]];
+    let workerTable = [["variant", "workload", "idle GC per worker (ms)", "isolate recycles"]];
+
+    for (let run of runs) {
+        let name = `${run.variant} - ${run.workload}`;
+        let latency = run.step.latency;
+        record('gc-latency', `${name} - p50`, latency.valueAtPercentile(50) / 1000);
+        record('gc-latency', `${name} - p99`, latency.valueAtPercentile(99) / 1000);
+        record('gc-latency', `${name} - max`, latency.max / 1000);
+
+        latencyTable.push([
+            run.variant,
+            run.workload,
+            ms(latency.valueAtPercentile(50)),
+            ms(latency.valueAtPercentile(90)),
+            ms(latency.valueAtPercentile(99)),
+            ms(latency.valueAtPercentile(99.9)),
+            ms(latency.max),
+            run.step.failures.toString()
+        ]);
+
+        let types = Object.keys(run.gc.pauses).sort();
+        if (types.length === 0) {
+            gcTable.push([run.variant, run.workload, 'n/a', 'n/a', 'n/a', 'n/a', 'n/a']);
+        }
+        for (let type of types) {
+            let pause = run.gc.pauses[type];
+            record('gc-latency', `${name} - ${type} pause p99`, pause.p99 / 1000);
+            gcTable.push([run.variant, run.workload, type, pause.count.toString(), ms(pause.p50), ms(pause.p99), ms(pause.max)]);
+        }
+
+        let idleGcTime = run.gc.idleGcTime.length > 0
+            ? run.gc.idleGcTime.map(time => ms(time || 0)).join(' / ')
+            : 'n/a';
+        workerTable.push([run.variant, run.workload, idleGcTime, isNaN(run.gc.isolateRecycles) ? 'n/a' : run.gc.isolateRecycles.toString()]);
+    }
+
+    console.log(`## Execute latency of allocation heavy functions at ${options.rate} calls/s on ${options.workers} workers\n`);
+    console.log(mdTable(latencyTable));
+    console.log('');
+
+    console.log(`## GC pauses by type\n`);
+    console.log(mdTable(gcTable));
+    console.log('');
+
+    console.log(`## GC between calls and isolate recycles\n`);
+    console.log(mdTable(workerTable));
+    console.log('');
+}
+
+/// <summary>
+///     Runs on its own with the 'in-process' metric provider, which reports GC pauses:
+///     node gc-latency.js --workers 4 --rate 1000 --duration 10 --objects 5000 --array 200000 --pieces 5000 --retained 256 [--variants default,"idle GC"]
+/// </summary>
+if (require.main === module) {
+    let options: GcLatencyOptions = Object.assign({}, DEFAULT_GC_LATENCY_OPTIONS);
+    let argv = process.argv.slice(2);
+    for (let i = 0; i + 1 < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--workers': options.workers = parseInt(value); break;
+            case '--rate': options.rate = parseFloat(value); break;
+            case '--duration': options.duration = parseFloat(value); break;
+            case '--objects': options.objects = parseInt(value); break;
+            case '--array': options.arrayLength = parseInt(value); break;
+            case '--pieces': options.pieces = parseInt(value); break;
+            case '--retained': options.retained = parseInt(value); break;
+            case '--variants': options.variants = value.split(','); break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+    napa.runtime.setPlatformSettings({ metricProvider: 'in-process' });
+
+    bench(options).then(() => process.exit(0));
+}
@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+/// <summary> Number of bits of a value kept by its bucket. </summary>
+const SUB_BUCKET_BITS = 7;
+const SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+const SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT >> 1;
+
+/// <summary> Number of buckets covering all safe integers. </summary>
+const BUCKET_COUNT = (53 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF_COUNT + SUB_BUCKET_COUNT;
+
+/// <summary> 
+///     A high dynamic range histogram of non-negative integers, the same as the one of napa metrics:
+///     128 buckets of width 1 for values below 128, then 64 buckets per power of two,
+///     so a value is known within 1/64th of it (about 1.6%).
+/// </summary>
+export class HdrHistogram {
+    private _counts: number[];
+    private _count: number;
+    private _sum: number;
+    private _min: number;
+    private _max: number;
+
+    constructor() {
+        this._counts = new Array(BUCKET_COUNT);
+        for (let i = 0; i < BUCKET_COUNT; ++i) {
+            this._counts[i] = 0;
+        }
+        this._count = 0;
+        this._sum = 0;
+        this._min = Number.MAX_VALUE;
+        this._max = 0;
+    }
+
+    /// <summary> Counts a value, which is rounded down to an integer, negative values are counted as 0. </summary>
+    record(value: number): void {
+        value = Math.min(Math.max(Math.floor(value), 0), Number.MAX_SAFE_INTEGER);
+        this._counts[getBucket(value)]++;
+        this._count++;
+        this._sum += value;
+        this._min = Math.min(this._min, value);
+        this._max = Math.max(this._max, value);
+    }
+
+    /// <summary> Gets the value at a percentile in [0, 100], 0 if there are no values. </summary>
+    /// <returns> The highest value of the bucket at the percentile, bounded by the min and max values. </returns>
+    valueAtPercentile(percentile: number): number {
+        if (this._count === 0) {
+            return 0;
+        }
+
+        percentile = Math.min(Math.max(percentile, 0), 100);
+        let rank = Math.min(Math.max(Math.ceil(percentile / 100 * this._count), 1), this._count);
+
+        let counted = 0;
+        for (let i = 0; i < BUCKET_COUNT; ++i) {
+            counted += this._counts[i];
+            if (counted >= rank) {
+                return Math.max(Math.min(getHighestValue(i), this._max), this._min);
+            }
+        }
+        return this._max;
+    }
+
+    /// <summary> Adds the values of another histogram. </summary>
+    add(other: HdrHistogram): void {
+        for (let i = 0; i < BUCKET_COUNT; ++i) {
+            this._counts[i] += other._counts[i];
+        }
+        this._count += other._count;
+        this._sum += other._sum;
+        this._min = Math.min(this._min, other._min);
+        this._max = Math.max(this._max, other._max);
+    }
+
+    /// <summary> Restores a histogram transported from a zone worker, which arrives as a plain object of its fields. </summary>
+    static from(fields: any): HdrHistogram {
+        return Object.assign(new HdrHistogram(), fields);
+    }
+
+    get count(): number {
+        return this._count;
+    }
+
+    get mean(): number {
+        return this._count === 0 ? 0 : this._sum / this._count;
+    }
+
+    /// <summary> Gets the min value, 0 if there are no values. </summary>
+    get min(): number {
+        return this._count === 0 ? 0 : this._min;
+    }
+
+    /// <summary> Gets the max value, 0 if there are no values. </summary>
+    get max(): number {
+        return this._max;
+    }
+}
+
+/// <summary> Gets the index of the most significant bit of a positive integer. </summary>
+function getMostSignificantBit(value: number): number {
+    // Values beyond 32 bits don't fit bitwise operators, Math.log2 is only off by one near powers of two.
+    let bit = Math.floor(Math.log2(value));
+    if (Math.pow(2, bit) > value) {
+        --bit;
+    } else if (Math.pow(2, bit + 1) <= value) {
+        ++bit;
+    }
+    return bit;
+}
+
+function getBucket(value: number): number {
+    if (value < SUB_BUCKET_COUNT) {
+        return value;
+    }
+
+    // Values of [2^n, 2^(n+1)) keep their top SUB_BUCKET_BITS bits, their shifted value is in the upper half of sub buckets.
+    let shift = getMostSignificantBit(value) - (SUB_BUCKET_BITS - 1);
+    return shift * SUB_BUCKET_HALF_COUNT + Math.floor(value / Math.pow(2, shift));
+}
+
+function getHighestValue(bucket: number): number {
+    if (bucket < SUB_BUCKET_COUNT) {
+        return bucket;
+    }
+
+    let shift = Math.floor(bucket / SUB_BUCKET_HALF_COUNT) - 1;
+    let lowest = (bucket - shift * SUB_BUCKET_HALF_COUNT) * Math.pow(2, shift);
+    return lowest + Math.pow(2, shift) - 1;
+}
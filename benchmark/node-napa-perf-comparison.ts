@@ -3,7 +3,8 @@
 
 import * as napa from '../lib/index';
 import * as mdTable from 'markdown-table';
-import { formatTimeDiff } from './bench-utils';
+import { formatTimeDiff, timeDiffInMs } from './bench-utils';
+import { record } from './bench-results';
 
 export function timeIt(func: () => void): [number, number] {
     let start = process.hrtime();
@@ -32,9 +33,11 @@ export async function bench(zone: napa.zone.Zone): Promise<void> {
     // Actual test.
     let table = [];
     table.push(["node time", "napa time"]);
-    let nodeTime = formatTimeDiff(test1());
-    let napaTime = formatTimeDiff((await zone.execute('', 'test1', [])).value);
-    table.push([nodeTime, napaTime]);
+    let nodeTime = timeDiffInMs(test1());
+    let napaTime = timeDiffInMs((await zone.execute('', 'test1', [])).value);
+    table.push([formatTimeDiff(nodeTime), formatTimeDiff(napaTime)]);
+    record('node-napa-perf-comparison', 'node', nodeTime);
+    record('node-napa-perf-comparison', 'napa', napaTime);
         
     console.log("## Node vs Napa JavaScript execution performance\n");
     console.log(mdTable(table));
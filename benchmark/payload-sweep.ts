@@ -0,0 +1,354 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as mdTable from 'markdown-table';
+import { generateString, timeDiffInMs, formatTimeDiff } from './bench-utils';
+import { record } from './bench-results';
+
+/// <summary> How a payload is transported. </summary>
+export type SweepMode =
+    'json' |        // JSON.stringify/JSON.parse, the baseline without transportables.
+    'native' |      // transport.marshall/unmarshall, stores of TransportOption.AUTO.
+    'binary';       // transport.marshallBinary/unmarshallBinary, stores of TransportOption.BINARY.
+
+/// <summary> Shape of a payload, each fills the size with a different kind of value. </summary>
+export type SweepShape =
+    'flat' |            // Object of string properties.
+    'nested' |          // Tree of objects, 4 children per level, with string leaves.
+    'numbers' |         // Array of doubles.
+    'float64array' |    // Float64Array, only transported as is by binary.
+    'string' |          // A single string.
+    'transportable' |   // Array of AutoTransportable objects.
+    'shareable';        // Array of ShareableWraps, only carried by the transport context.
+
+/// <summary> Options of the payload sweep. </summary>
+export interface SweepOptions {
+    /// <summary> Payload sizes in bytes, as their JSON length approximately. </summary>
+    sizes: number[];
+
+    shapes: SweepShape[];
+
+    modes: SweepMode[];
+
+    /// <summary> Milliseconds each operation is repeated for, at least once. </summary>
+    minTime: number;
+
+    /// <summary> Whether to time store.set followed by store.get of the payload, for native and binary modes. </summary>
+    store: boolean;
+}
+
+export const DEFAULT_SWEEP_OPTIONS: SweepOptions = {
+    sizes: [1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8],
+    shapes: ['flat', 'nested', 'numbers', 'float64array', 'string', 'transportable', 'shareable'],
+    modes: ['json', 'native', 'binary'],
+    minTime: 200,
+    store: true
+};
+
+/// <summary> Measures of a shape, size and mode. Times are in milliseconds per operation. </summary>
+export interface SweepResult {
+    shape: SweepShape;
+    size: number;
+    mode: SweepMode;
+
+    /// <summary> Bytes of the marshalled payload. </summary>
+    payloadSize: number;
+
+    marshall: number;
+    unmarshall: number;
+
+    /// <summary> Marshall then unmarshall into a new transport context, as a value crossing isolates does. </summary>
+    roundTrip: number;
+
+    /// <summary> store.set then store.get, NaN if not timed. </summary>
+    store: number;
+
+    /// <summary> Growth of heap and external memory by a round trip, while the payload and its copy are alive, in bytes. </summary>
+    peakMemory: number;
+}
+
+/// <summary> Transportable of the 'transportable' shape. </summary>
+export class SweepPoint extends napa.transport.AutoTransportable {
+    x: number;
+    y: number;
+    label: string;
+
+    constructor(x: number = 0, y: number = 0, label: string = '') {
+        super();
+        this.x = x;
+        this.y = y;
+        this.label = label;
+    }
+}
+napa.transport.cid(module.id)(SweepPoint);
+
+/// <summary> Approximate JSON length of a leaf string and its key. </summary>
+const STRING_LENGTH = 16;
+const ENTRY_SIZE = STRING_LENGTH + 12;
+
+function generateNested(leaves: number, depth: number): any {
+    let object: any = {};
+    if (leaves <= 4 || depth === 0) {
+        for (let i = 0; i < Math.max(leaves, 1); ++i) {
+            object[`key${i}`] = generateString(STRING_LENGTH - 3) + i;
+        }
+        return object;
+    }
+    let quarter = Math.ceil(leaves / 4);
+    for (let i = 0; i < 4 && leaves > 0; ++i) {
+        object[`key${i}`] = generateNested(Math.min(quarter, leaves), depth - 1);
+        leaves -= quarter;
+    }
+    return object;
+}
+
+/// <summary> Generates a payload of a shape and approximate size, undefined if the mode can't carry the shape. </summary>
+export function generatePayload(shape: SweepShape, size: number, mode: SweepMode): any {
+    let entries = Math.max(Math.round(size / ENTRY_SIZE), 1);
+    switch (shape) {
+        case 'flat': {
+            let object: any = {};
+            for (let i = 0; i < entries; ++i) {
+                object[`key${i}`] = generateString(STRING_LENGTH - 6) + i;
+            }
+            return object;
+        }
+        case 'nested':
+            return generateNested(entries, 32);
+
+        case 'numbers': {
+            // Doubles of 17 significant digits take about 20 bytes as JSON.
+            let array = new Array<number>(Math.max(Math.round(size / 20), 1));
+            for (let i = 0; i < array.length; ++i) {
+                array[i] = Math.random();
+            }
+            return array;
+        }
+        case 'float64array': {
+            if (mode !== 'binary') {
+                return undefined;
+            }
+            let array = new Float64Array(Math.max(Math.round(size / 8), 1));
+            for (let i = 0; i < array.length; ++i) {
+                array[i] = Math.random();
+            }
+            return array;
+        }
+        case 'string':
+            return generateString(size + 1);
+
+        case 'transportable': {
+            if (mode === 'json') {
+                return undefined;
+            }
+            // A marshalled point takes about 70 bytes.
+            let points: SweepPoint[] = [];
+            for (let i = 0, count = Math.max(Math.round(size / 70), 1); i < count; ++i) {
+                points.push(new SweepPoint(i, i * 2, 'p' + i));
+            }
+            return points;
+        }
+        case 'shareable': {
+            if (mode === 'json') {
+                return undefined;
+            }
+            // Each marshalled allocator takes about 60 bytes, and a shared pointer in the transport context.
+            let shareables: napa.memory.Allocator[] = [];
+            for (let i = 0, count = Math.max(Math.round(size / 60), 1); i < count; ++i) {
+                shareables.push(napa.memory.crtAllocator);
+            }
+            return shareables;
+        }
+    }
+    return undefined;
+}
+
+interface Codec {
+    marshall(value: any, context: napa.transport.TransportContext): string | ArrayBuffer;
+    unmarshall(payload: string | ArrayBuffer, context: napa.transport.TransportContext): any;
+}
+
+const CODECS: { [mode: string]: Codec } = {
+    json: {
+        marshall: (value, context) => JSON.stringify(value),
+        unmarshall: (payload, context) => JSON.parse(<string>payload)
+    },
+    native: {
+        marshall: (value, context) => napa.transport.marshall(value, context),
+        unmarshall: (payload, context) => napa.transport.unmarshall(<string>payload, context)
+    },
+    binary: {
+        marshall: (value, context) => napa.transport.marshallBinary(value, context),
+        unmarshall: (payload, context) => napa.transport.unmarshallBinary(<ArrayBuffer>payload, context)
+    }
+};
+
+/// <summary> Repeats an operation for at least minTime milliseconds, returning milliseconds per operation. </summary>
+function time(operation: () => void, minTime: number): number {
+    let repeat = 0;
+    let start = process.hrtime();
+    let elapsed = 0;
+    do {
+        operation();
+        ++repeat;
+        elapsed = timeDiffInMs(process.hrtime(start));
+    } while (elapsed < minTime);
+    return elapsed / repeat;
+}
+
+function memoryInUse(): number {
+    let usage = process.memoryUsage();
+    return usage.heapUsed + usage.external;
+}
+
+function collectGarbage(): void {
+    let gc = (<any>global).gc;
+    if (typeof gc === 'function') {
+        gc();
+    }
+}
+
+/// <summary> Measures a shape, size and mode, undefined if the mode can't carry the shape. </summary>
+export function measure(
+    shape: SweepShape,
+    size: number,
+    mode: SweepMode,
+    options: SweepOptions,
+    stores: { [mode: string]: napa.store.Store }): SweepResult {
+
+    let value = generatePayload(shape, size, mode);
+    if (value === undefined) {
+        return undefined;
+    }
+    let codec = CODECS[mode];
+
+    // Contexts of shareables hold a shared pointer per marshall, thus each operation takes a new one.
+    let payload = codec.marshall(value, napa.transport.createTransportContext());
+    let payloadSize = typeof payload === 'string' ? payload.length : payload.byteLength;
+    let context = napa.transport.createTransportContext();
+    codec.marshall(value, context);
+
+    let result: SweepResult = {
+        shape: shape,
+        size: size,
+        mode: mode,
+        payloadSize: payloadSize,
+        marshall: time(() => codec.marshall(value, napa.transport.createTransportContext()), options.minTime),
+        unmarshall: time(() => codec.unmarshall(payload, context), options.minTime),
+        roundTrip: 0,
+        store: NaN,
+        peakMemory: 0
+    };
+
+    result.roundTrip = time(() => {
+        let roundTripContext = napa.transport.createTransportContext();
+        codec.unmarshall(codec.marshall(value, roundTripContext), roundTripContext);
+    }, options.minTime);
+
+    // Sampled while the payload and its copy are both alive. Without --expose-gc it includes garbage of earlier operations.
+    collectGarbage();
+    let baseline = memoryInUse();
+    let peakContext = napa.transport.createTransportContext();
+    let marshalled = codec.marshall(value, peakContext);
+    let peak = memoryInUse();
+    let copy = codec.unmarshall(marshalled, peakContext);
+    result.peakMemory = Math.max(peak, memoryInUse()) - baseline;
+
+    let store = stores[mode];
+    if (options.store && store !== undefined) {
+        result.store = time(() => {
+            store.set('payload', value);
+            store.get('payload');
+        }, options.minTime);
+        store.delete('payload');
+    }
+    return result;
+}
+
+/// <summary> Runs the sweep, shapes and sizes in order, skipping combinations a mode can't carry. </summary>
+export function run(options: SweepOptions = DEFAULT_SWEEP_OPTIONS): SweepResult[] {
+    let stores: { [mode: string]: napa.store.Store } = {
+        native: napa.store.getOrCreate('payload-sweep-native', { transport: napa.zone.TransportOption.AUTO }),
+        binary: napa.store.getOrCreate('payload-sweep-binary', { transport: napa.zone.TransportOption.BINARY })
+    };
+
+    let results: SweepResult[] = [];
+    for (let shape of options.shapes) {
+        for (let size of options.sizes) {
+            for (let mode of options.modes) {
+                let result = measure(shape, size, mode, options, stores);
+                if (result !== undefined) {
+                    results.push(result);
+                }
+                collectGarbage();
+            }
+        }
+    }
+    return results;
+}
+
+function formatSize(bytes: number): string {
+    if (bytes >= 1e6) {
+        return (bytes / 1e6).toFixed(bytes >= 1e7 ? 0 : 1) + 'MB';
+    }
+    if (bytes >= 1e3) {
+        return (bytes / 1e3).toFixed(bytes >= 1e4 ? 0 : 1) + 'KB';
+    }
+    return bytes.toFixed(0) + 'B';
+}
+
+export function bench(options: SweepOptions = DEFAULT_SWEEP_OPTIONS): void {
+    console.log("Benchmarking transport and store over payload sizes...");
+
+    let results = run(options);
+
+    let table = [["shape", "size", "mode", "payload", "marshall (ms)", "unmarshall (ms)", "round trip (ms)", "store set + get (ms)", "peak memory"]];
+    for (let result of results) {
+        let name = `${result.shape} - ${formatSize(result.size)} - ${result.mode}`;
+        record('payload-sweep', `${name} - marshall`, result.marshall);
+        record('payload-sweep', `${name} - unmarshall`, result.unmarshall);
+        record('payload-sweep', `${name} - round trip`, result.roundTrip);
+        record('payload-sweep', `${name} - store set + get`, result.store);
+        record('payload-sweep', `${name} - peak memory`, result.peakMemory, 'bytes');
+
+        table.push([
+            result.shape,
+            formatSize(result.size),
+            result.mode,
+            formatSize(result.payloadSize),
+            formatTimeDiff(result.marshall),
+            formatTimeDiff(result.unmarshall),
+            formatTimeDiff(result.roundTrip),
+            isNaN(result.store) ? '-' : formatTimeDiff(result.store),
+            formatSize(result.peakMemory)
+        ]);
+    }
+
+    console.log("## Transport and store over payload sizes\n");
+    console.log(mdTable(table));
+    console.log();
+}
+
+/// <summary>
+///     Runs on its own, e.g. to see where a payload gets expensive:
+///     node --expose-gc --max-old-space-size=4096 payload-sweep.js --sizes 1000,1000000 --shapes flat,string --modes native,binary --time 500 --no-store
+/// </summary>
+if (require.main === module) {
+    let options: SweepOptions = Object.assign({}, DEFAULT_SWEEP_OPTIONS);
+    let argv = process.argv.slice(2);
+    for (let i = 0; i < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--sizes': options.sizes = value.split(',').map(size => parseFloat(size)); break;
+            case '--shapes': options.shapes = <SweepShape[]>value.split(','); break;
+            case '--modes': options.modes = <SweepMode[]>value.split(','); break;
+            case '--time': options.minTime = parseFloat(value); break;
+            case '--no-store': options.store = false; --i; break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+
+    bench(options);
+    process.exit(0);
+}
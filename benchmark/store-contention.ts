@@ -0,0 +1,297 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as mdTable from 'markdown-table';
+import { generateString } from './bench-utils';
+import { HdrHistogram } from './hdr-histogram';
+import { record } from './bench-results';
+
+/// <summary> A store configuration under test. </summary>
+export interface StoreVariant {
+    label: string;
+    options: napa.store.StoreOptions;
+}
+
+/// <summary> Options of the store contention benchmark. </summary>
+export interface ContentionOptions {
+    /// <summary> Zones accessing the store at once, and workers of each. </summary>
+    zones: number;
+    workers: number;
+
+    /// <summary> Fractions of operations that are gets, the rest are sets, each run in order. </summary>
+    readRatios: number[];
+
+    /// <summary> Number of keys, all set before the run. </summary>
+    keys: number;
+
+    /// <summary> Skew of the Zipfian key distribution, 0 for uniform. 0.99 is that of the YCSB benchmark. </summary>
+    zipfTheta: number;
+
+    /// <summary> Length of the string values. </summary>
+    valueSize: number;
+
+    /// <summary> Operations run by each worker. </summary>
+    operations: number;
+
+    variants: StoreVariant[];
+
+    /// <summary> Whether to print ops/sec and latency of each worker, besides the totals. </summary>
+    perWorker: boolean;
+}
+
+export const DEFAULT_CONTENTION_OPTIONS: ContentionOptions = {
+    zones: 2,
+    workers: 4,
+    readRatios: [0.5, 0.95],
+    keys: 10000,
+    zipfTheta: 0.99,
+    valueSize: 100,
+    operations: 20000,
+    variants: [
+        { label: 'default', options: {} },
+        { label: 'shards: 16', options: { shards: 16 } },
+        { label: 'read optimized', options: { readOptimized: true } },
+        { label: 'shards: 16, read optimized', options: { shards: 16, readOptimized: true } }
+    ],
+    perWorker: true
+};
+
+/// <summary> Operations of a worker, as returned by storeContentionRun. Latencies are in nanoseconds. </summary>
+export interface WorkerContention {
+    zone: number;
+    worker: number;
+    operations: number;
+
+    /// <summary> Milliseconds the worker took for its operations. </summary>
+    elapsed: number;
+
+    latency: HdrHistogram;
+}
+
+/// <summary> A run of a variant and read ratio. </summary>
+export interface ContentionRun {
+    variant: string;
+    readRatio: number;
+
+    /// <summary> Operations per second of all workers, from the first call until the last one returned. </summary>
+    throughput: number;
+
+    workers: WorkerContention[];
+
+    /// <summary> Latencies of all workers. </summary>
+    latency: HdrHistogram;
+}
+
+/// <summary> Cumulative probabilities of Zipfian ranks, rank i having a weight of 1 / (i + 1)^theta. </summary>
+export function zipfDistribution(keys: number, theta: number): Float64Array {
+    let cdf = new Float64Array(keys);
+    let sum = 0;
+    for (let i = 0; i < keys; ++i) {
+        sum += 1 / Math.pow(i + 1, theta);
+        cdf[i] = sum;
+    }
+    for (let i = 0; i < keys; ++i) {
+        cdf[i] /= sum;
+    }
+    return cdf;
+}
+
+/// <summary> Runs gets and sets of Zipfian keys on a store, called in zone workers. </summary>
+/// <param name="seed"> Seed of the key sequence, which differs by worker. </param>
+/// <returns> Milliseconds taken, and fields of a histogram of operation latencies in nanoseconds, as class instances are not transportable. </returns>
+export function storeContentionRun(
+    storeId: string,
+    operations: number,
+    readRatio: number,
+    keys: number,
+    theta: number,
+    valueSize: number,
+    seed: number): [number, any] {
+
+    let store = napa.store.get(storeId);
+    let cdf = zipfDistribution(keys, theta);
+    let value = generateString(valueSize + 1);
+    let latency = new HdrHistogram();
+
+    // Xorshift, which unlike Math.random is reproducible by seed and doesn't share state.
+    let state = (seed * 2654435761) >>> 0 || 1;
+    let random = () => {
+        state ^= state << 13;
+        state ^= state >>> 17;
+        state ^= state << 5;
+        return (state >>> 0) / 4294967296;
+    };
+    let pickKey = () => {
+        let p = random();
+        let low = 0;
+        let high = keys - 1;
+        while (low < high) {
+            let middle = (low + high) >>> 1;
+            if (cdf[middle] < p) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return 'key' + low;
+    };
+
+    let start = Date.now();
+    for (let i = 0; i < operations; ++i) {
+        let key = pickKey();
+        let read = random() < readRatio;
+        let opStart = process.hrtime();
+        if (read) {
+            store.get(key);
+        } else {
+            store.set(key, value);
+        }
+        let diff = process.hrtime(opStart);
+        latency.record(diff[0] * 1e9 + diff[1]);
+    }
+    return [Date.now() - start, Object.assign({}, latency)];
+}
+
+/// <summary> Runs a variant at a read ratio, from all workers of all zones at once. </summary>
+export async function runContention(zones: napa.zone.Zone[], variant: StoreVariant, readRatio: number, options: ContentionOptions): Promise<ContentionRun> {
+    let storeId = `store-contention-${variant.label}-${readRatio}`;
+    let store = napa.store.getOrCreate(storeId, variant.options);
+    let value = generateString(options.valueSize + 1);
+    for (let i = 0; i < options.keys; ++i) {
+        store.set('key' + i, value);
+    }
+
+    // Each call runs on its own worker, as a zone has as many workers as calls and every call is long.
+    let calls: Promise<napa.zone.Result>[] = [];
+    let start = Date.now();
+    for (let z = 0; z < zones.length; ++z) {
+        for (let w = 0; w < options.workers; ++w) {
+            calls.push(zones[z].execute(__filename, 'storeContentionRun',
+                [storeId, options.operations, readRatio, options.keys, options.zipfTheta, options.valueSize, z * options.workers + w + 1]));
+        }
+    }
+    let results = await Promise.all(calls);
+    let elapsed = Date.now() - start;
+
+    let run: ContentionRun = {
+        variant: variant.label,
+        readRatio: readRatio,
+        throughput: results.length * options.operations * 1000 / elapsed,
+        workers: [],
+        latency: new HdrHistogram()
+    };
+    for (let i = 0; i < results.length; ++i) {
+        let [workerElapsed, fields] = results[i].value;
+        let latency = HdrHistogram.from(fields);
+        run.latency.add(latency);
+        run.workers.push({
+            zone: Math.floor(i / options.workers),
+            worker: i % options.workers,
+            operations: options.operations,
+            elapsed: workerElapsed,
+            latency: latency
+        });
+    }
+    return run;
+}
+
+export async function run(options: ContentionOptions = DEFAULT_CONTENTION_OPTIONS): Promise<ContentionRun[]> {
+    let zones: napa.zone.Zone[] = [];
+    for (let z = 0; z < options.zones; ++z) {
+        zones.push(napa.zone.create(`store-contention-${z}`, { workers: options.workers }));
+    }
+
+    // Warm-up, which loads this module into every worker.
+    await runContention(zones, options.variants[0], options.readRatios[0],
+        Object.assign({}, options, { operations: Math.min(options.operations, 1000) }));
+
+    let runs: ContentionRun[] = [];
+    for (let variant of options.variants) {
+        for (let readRatio of options.readRatios) {
+            runs.push(await runContention(zones, variant, readRatio, options));
+        }
+    }
+    return runs;
+}
+
+export async function bench(options: ContentionOptions = DEFAULT_CONTENTION_OPTIONS): Promise<void> {
+    console.log("Benchmarking store contention...");
+
+    let runs = await run(options);
+
+    let us = (ns: number) => (ns / 1000).toFixed(1);
+    let table = [["store", "reads", "ops/s", "min worker ops/s", "p50 (us)", "p99 (us)", "p99.9 (us)", "max (us)", "worst worker p99 (us)"]];
+    for (let run of runs) {
+        let workerThroughputs = run.workers.map(worker => worker.operations * 1000 / Math.max(worker.elapsed, 1));
+        let worstP99 = Math.max(...run.workers.map(worker => worker.latency.valueAtPercentile(99)));
+
+        let name = `${run.variant} - ${run.readRatio * 100}% reads`;
+        record('store-contention', `${name} - throughput`, run.throughput, 'ops/s', 'higher');
+        record('store-contention', `${name} - p99`, run.latency.valueAtPercentile(99) / 1000, 'us');
+
+        table.push([
+            run.variant,
+            `${run.readRatio * 100}%`,
+            run.throughput.toFixed(0),
+            Math.min(...workerThroughputs).toFixed(0),
+            us(run.latency.valueAtPercentile(50)),
+            us(run.latency.valueAtPercentile(99)),
+            us(run.latency.valueAtPercentile(99.9)),
+            us(run.latency.max),
+            us(worstP99)
+        ]);
+    }
+
+    console.log(`## Store contention of ${options.zones} zones x ${options.workers} workers, ` +
+        `${options.keys} keys (Zipfian theta ${options.zipfTheta}), ${options.valueSize} bytes values\n`);
+    console.log(mdTable(table));
+    console.log('');
+
+    if (options.perWorker) {
+        let workerTable = [["store", "reads", "zone", "worker", "ops/s", "p50 (us)", "p99 (us)", "p99.9 (us)", "max (us)"]];
+        for (let run of runs) {
+            for (let worker of run.workers) {
+                workerTable.push([
+                    run.variant,
+                    `${run.readRatio * 100}%`,
+                    worker.zone.toString(),
+                    worker.worker.toString(),
+                    (worker.operations * 1000 / Math.max(worker.elapsed, 1)).toFixed(0),
+                    us(worker.latency.valueAtPercentile(50)),
+                    us(worker.latency.valueAtPercentile(99)),
+                    us(worker.latency.valueAtPercentile(99.9)),
+                    us(worker.latency.max)
+                ]);
+            }
+        }
+        console.log("## Store contention per worker\n");
+        console.log(mdTable(workerTable));
+        console.log('');
+    }
+}
+
+/// <summary>
+///     Runs on its own, e.g. to size shards for a workload:
+///     node store-contention.js --zones 2 --workers 4 --reads 0.5,0.95 --keys 10000 --theta 0.99 --value 100 --operations 20000 [--summary]
+/// </summary>
+if (require.main === module) {
+    let options: ContentionOptions = Object.assign({}, DEFAULT_CONTENTION_OPTIONS);
+    let argv = process.argv.slice(2);
+    for (let i = 0; i < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--zones': options.zones = parseInt(value); break;
+            case '--workers': options.workers = parseInt(value); break;
+            case '--reads': options.readRatios = value.split(',').map(ratio => parseFloat(ratio)); break;
+            case '--keys': options.keys = parseInt(value); break;
+            case '--theta': options.zipfTheta = parseFloat(value); break;
+            case '--value': options.valueSize = parseInt(value); break;
+            case '--operations': options.operations = parseInt(value); break;
+            case '--summary': options.perWorker = false; --i; break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+
+    bench(options).then(() => process.exit(0));
+}
@@ -4,7 +4,8 @@
 import * as napa from '../lib/index';
 import * as assert from 'assert';
 import * as mdTable from 'markdown-table';
-import { generateObject, formatTimeDiff } from './bench-utils';
+import { generateObject, timeDiffInMs, formatTimeDiff } from './bench-utils';
+import { record } from './bench-results';
 
 type BenchmarkSettings = [
     string,     // label
@@ -34,7 +35,7 @@ export function bench() {
         ["1 level - 10 strings - length 100", 10, 1, "string", 100],
         ["1 level - 100 strings - length 100", 100, 1, "string", 100],
         ["2 level - 10 strings - length 100", 10, 2, "string", 100],
-        ["3 level - 5 integers", 5, 3, "string", 100],
+        ["3 level - 5 strings - length 100", 5, 3, "string", 100],
 
         // Boolean
         ["1 level - 10 booleans", 10, 1, "boolean", 0],
@@ -43,7 +44,7 @@ export function bench() {
         ["3 level - 5 booleans", 5, 3, "boolean", 0],
     ];
 
-    let store = napa.store.create('store');
+    let store = napa.store.getOrCreate('store');
     let table = [];
     table.push(["payload type", "size", "transport.marshall (ms)", "store.save (ms)", "transport.unmarshall (ms)", "store.get (ms)"]);
 
@@ -58,14 +59,14 @@ export function bench() {
         for (let i = 0; i < REPEAT; ++i) {
             napa.transport.marshall(object, null);
         }
-        let marshallTime = formatTimeDiff(process.hrtime(start));
+        let marshallTime = timeDiffInMs(process.hrtime(start));
 
         // store.set
         start = process.hrtime();
         for (let i = 0; i < REPEAT; ++i) {
             store.set('key', object);
         }
-        let storeSetTime = formatTimeDiff(process.hrtime(start));
+        let storeSetTime = timeDiffInMs(process.hrtime(start));
 
         assert.deepEqual(object, store.get('key'));
 
@@ -74,16 +75,20 @@ export function bench() {
         for (let i = 0; i < REPEAT; ++i) {
             napa.transport.unmarshall(payload, null);
         }
-        let unmarshallTime = formatTimeDiff(process.hrtime(start));
+        let unmarshallTime = timeDiffInMs(process.hrtime(start));
 
         // store.get
         start = process.hrtime();
         for (let i = 0; i < REPEAT; ++i) {
             store.get('key');
         }
-        let storeGetTime = formatTimeDiff(process.hrtime(start));
+        let storeGetTime = timeDiffInMs(process.hrtime(start));
 
-        table.push([s[0], size, marshallTime, storeSetTime, unmarshallTime, storeGetTime]);
+        table.push([s[0], size, formatTimeDiff(marshallTime), formatTimeDiff(storeSetTime), formatTimeDiff(unmarshallTime), formatTimeDiff(storeGetTime)]);
+        record('store-overhead', `${s[0]} - transport.marshall`, marshallTime);
+        record('store-overhead', `${s[0]} - store.set`, storeSetTime);
+        record('store-overhead', `${s[0]} - transport.unmarshall`, unmarshallTime);
+        record('store-overhead', `${s[0]} - store.get`, storeGetTime);
     }
     console.log("## Store access overhead\n");
     console.log(mdTable(table));
@@ -0,0 +1,301 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as fs from 'fs';
+import * as napa from '../lib/index';
+import * as mdTable from 'markdown-table';
+import { generateString } from './bench-utils';
+import { HdrHistogram } from './hdr-histogram';
+import { record } from './bench-results';
+
+/// <summary> A call of a capture written by napa.tracing.startCapture. </summary>
+export interface CapturedCall {
+    zoneId: string;
+    module: string;
+    function: string;
+
+    /// <summary> Time the call was issued, in nanoseconds since the capture started. </summary>
+    arrival: number;
+
+    /// <summary> Size in bytes of the marshalled arguments. </summary>
+    payloadSize: number;
+
+    /// <summary> Time the call ran on a worker, in nanoseconds. </summary>
+    executionTime: number;
+}
+
+/// <summary> Options of the replay. </summary>
+export interface ReplayOptions {
+    /// <summary> Rate of the replay relative to the capture, e.g. 2 issues calls twice as fast. </summary>
+    speed: number;
+
+    /// <summary> Only replays calls of the zone with this id, all calls if empty. </summary>
+    zoneId: string;
+}
+
+export const DEFAULT_REPLAY_OPTIONS: ReplayOptions = {
+    speed: 1,
+    zoneId: ''
+};
+
+/// <summary> Latencies of a replay, in microseconds. </summary>
+export interface ReplayResult {
+    calls: number;
+    failures: number;
+
+    /// <summary> Calls completed per second, from the first call till the last completion. </summary>
+    throughput: number;
+
+    /// <summary> From when a call was meant to be issued until it completed. </summary>
+    latency: HdrHistogram;
+
+    /// <summary> Latency beyond the recorded execution time of a call, i.e. what queuing and the transport added. </summary>
+    overhead: HdrHistogram;
+
+    /// <summary> Latencies by 'module:function'. </summary>
+    latencyByFunction: { [name: string]: HdrHistogram };
+}
+
+const HEADER = 'NAPACAP1';
+
+/// <summary> Reads the calls of a capture, in arrival order. See CallRecorder in src/zone/call-recorder.h for the format. </summary>
+export function loadCapture(path: string): CapturedCall[] {
+    let data = fs.readFileSync(path);
+    if (data.length < HEADER.length || data.toString('latin1', 0, HEADER.length) !== HEADER) {
+        throw new Error(`"${path}" is not a call capture.`);
+    }
+
+    let offset = HEADER.length;
+    let readVarint = (): number => {
+        let value = 0;
+        let scale = 1;
+        while (offset < data.length) {
+            let byte = data[offset++];
+            value += (byte & 0x7f) * scale;
+            if ((byte & 0x80) === 0) {
+                return value;
+            }
+            scale *= 128;
+        }
+        return -1;
+    };
+
+    let names: string[] = [];
+    let calls: CapturedCall[] = [];
+    while (offset < data.length) {
+        let tag = String.fromCharCode(data[offset++]);
+        if (tag === 'N') {
+            let id = readVarint();
+            let length = readVarint();
+            if (id < 0 || length < 0 || offset + length > data.length) {
+                break;
+            }
+            names[id] = data.toString('utf8', offset, offset + length);
+            offset += length;
+        } else if (tag === 'C') {
+            let fields: number[] = [];
+            for (let i = 0; i < 6; ++i) {
+                fields.push(readVarint());
+            }
+            if (fields[5] < 0) {
+                break;
+            }
+            calls.push({
+                arrival: fields[0],
+                zoneId: names[fields[1]],
+                module: names[fields[2]],
+                function: names[fields[3]],
+                payloadSize: fields[4],
+                executionTime: fields[5]
+            });
+        } else {
+            throw new Error(`Unknown record '${tag}' at offset ${offset - 1} of "${path}".`);
+        }
+    }
+
+    // Calls are written as they finish.
+    return calls.sort((left, right) => left.arrival - right.arrival);
+}
+
+function now(): number {
+    let time = process.hrtime();
+    return time[0] * 1e6 + time[1] / 1e3;
+}
+
+/// <summary> Measures how many loop iterations the worker runs per microsecond, for replayCall to spin without allocating. </summary>
+function replayCalibrate(): void {
+    let start = Date.now();
+    let loops = 0;
+    let sum = 0;
+    while (Date.now() - start < 100) {
+        for (let i = 0; i < 10000; ++i) {
+            sum += i;
+        }
+        loops += 10000;
+    }
+    replaySink = sum;
+    replayLoopsPerUs = loops / ((Date.now() - start) * 1000);
+}
+
+/// <summary> Stands in for a captured call, it spins for the cost in microseconds the call took. </summary>
+function replayCall(cost: number, payload: string): void {
+    let sum = 0;
+    for (let i = 0, loops = cost * replayLoopsPerUs; i < loops; ++i) {
+        sum += i;
+    }
+    replaySink = sum;
+}
+declare var replayLoopsPerUs: number;
+declare var replaySink: number;
+
+/// <summary>
+///     Issues the calls at their captured times scaled by the speed, whether or not earlier calls completed, i.e. open-loop.
+///     Latency of a call is measured from when it was meant to be issued, as execute-latency does.
+/// </summary>
+export async function replay(zone: napa.zone.Zone, calls: CapturedCall[], options: ReplayOptions = DEFAULT_REPLAY_OPTIONS): Promise<ReplayResult> {
+    await zone.broadcast(replayCalibrate.toString());
+    await zone.broadcast(replayCall.toString());
+    await zone.broadcast('replayCalibrate();');
+
+    if (options.zoneId) {
+        calls = calls.filter(call => call.zoneId === options.zoneId);
+    }
+
+    let result: ReplayResult = {
+        calls: calls.length,
+        failures: 0,
+        throughput: 0,
+        latency: new HdrHistogram(),
+        overhead: new HdrHistogram(),
+        latencyByFunction: {}
+    };
+    if (calls.length === 0) {
+        return result;
+    }
+
+    // Payloads of a size are shared by calls, they only have to be as large as the captured ones.
+    let payloads: { [size: number]: string } = {};
+    let payloadOf = (size: number) => {
+        if (payloads[size] === undefined) {
+            payloads[size] = generateString(size + 1);
+        }
+        return payloads[size];
+    };
+
+    let first = calls[0].arrival;
+    return new Promise<ReplayResult>((resolve) => {
+        let start = now();
+        let issued = 0;
+        let completed = 0;
+        let complete = (call: CapturedCall, scheduled: number, failed: boolean) => {
+            let latency = now() - scheduled;
+            result.latency.record(latency);
+            result.overhead.record(Math.max(latency - call.executionTime / 1000, 0));
+
+            let name = `${call.module}:${call.function}`;
+            let byFunction = result.latencyByFunction[name];
+            if (byFunction === undefined) {
+                byFunction = result.latencyByFunction[name] = new HdrHistogram();
+            }
+            byFunction.record(latency);
+
+            if (failed) {
+                result.failures++;
+            }
+            if (++completed === calls.length) {
+                result.throughput = calls.length * 1e6 / (now() - start);
+                resolve(result);
+            }
+        };
+
+        let scheduleOf = (call: CapturedCall) => start + (call.arrival - first) / 1000 / options.speed;
+        let issue = () => {
+            let time = now();
+            while (issued < calls.length && scheduleOf(calls[issued]) <= time) {
+                let call = calls[issued++];
+                let scheduled = scheduleOf(call);
+                zone.execute('', 'replayCall', [call.executionTime / 1000, payloadOf(call.payloadSize)])
+                    .then(() => complete(call, scheduled, false), () => complete(call, scheduled, true));
+            }
+
+            if (issued < calls.length) {
+                // Timers don't fire sooner than a millisecond, closer calls are waited for by yielding to I/O only.
+                let wait = scheduleOf(calls[issued]) - now();
+                if (wait >= 1000) {
+                    setTimeout(issue, Math.floor(wait / 1000));
+                } else {
+                    setImmediate(issue);
+                }
+            }
+        };
+        issue();
+    });
+}
+
+/// <summary> Number of functions with the most calls that get a row of their own in the report. </summary>
+const TOP_FUNCTIONS = 5;
+
+export async function bench(zone: napa.zone.Zone, calls: CapturedCall[], options: ReplayOptions = DEFAULT_REPLAY_OPTIONS): Promise<void> {
+    console.log(`Replaying ${calls.length} captured calls at ${options.speed}x speed...`);
+
+    let result = await replay(zone, calls, options);
+
+    let ms = (us: number) => (us / 1000).toFixed(2);
+    let row = (name: string, histogram: HdrHistogram) => [
+        name,
+        histogram.count.toString(),
+        ms(histogram.valueAtPercentile(50)),
+        ms(histogram.valueAtPercentile(90)),
+        ms(histogram.valueAtPercentile(99)),
+        ms(histogram.valueAtPercentile(99.9)),
+        ms(histogram.max)
+    ];
+
+    let table = [["calls", "count", "p50 (ms)", "p90 (ms)", "p99 (ms)", "p99.9 (ms)", "max (ms)"]];
+    table.push(row('all - latency', result.latency));
+    table.push(row('all - overhead', result.overhead));
+    let functions = Object.keys(result.latencyByFunction)
+        .sort((left, right) => result.latencyByFunction[right].count - result.latencyByFunction[left].count);
+    for (let name of functions.slice(0, TOP_FUNCTIONS)) {
+        table.push(row(name, result.latencyByFunction[name]));
+    }
+
+    record('trace-replay', 'throughput', result.throughput, 'calls/s', 'higher');
+    record('trace-replay', 'p50', result.latency.valueAtPercentile(50) / 1000);
+    record('trace-replay', 'p99', result.latency.valueAtPercentile(99) / 1000);
+    record('trace-replay', 'overhead p99', result.overhead.valueAtPercentile(99) / 1000);
+
+    console.log(`## Replay of ${result.calls} calls, ${result.throughput.toFixed(0)} calls/s, ${result.failures} failures\n`);
+    console.log(mdTable(table));
+    console.log('');
+}
+
+/// <summary>
+///     Replays a capture against a new zone, with zone settings given as options to compare them, e.g.:
+///     node trace-replay.js calls.napacap --workers 4 --scheduler workStealing --speed 2 --zone frontend
+///     Options other than --speed and --zone are zone settings, numbers are passed as numbers.
+/// </summary>
+if (require.main === module) {
+    let argv = process.argv.slice(2);
+    if (argv.length === 0) {
+        throw new Error('Usage: node trace-replay.js <capture> [--speed 1] [--zone id] [--<zone setting> value]...');
+    }
+
+    let options: ReplayOptions = Object.assign({}, DEFAULT_REPLAY_OPTIONS);
+    let settings: { [name: string]: any } = { workers: 4 };
+    for (let i = 1; i + 1 < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--speed': options.speed = parseFloat(value); break;
+            case '--zone': options.zoneId = value; break;
+            default:
+                if (argv[i].indexOf('--') !== 0) {
+                    throw new Error(`Unknown option "${argv[i]}".`);
+                }
+                settings[argv[i].substring(2)] = isNaN(Number(value)) ? value : Number(value);
+        }
+    }
+
+    bench(napa.zone.create('replay-zone', settings), loadCapture(argv[0]), options)
+        .then(() => process.exit(0));
+}
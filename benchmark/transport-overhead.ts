@@ -5,6 +5,7 @@ import * as napa from '../lib/index';
 import * as assert from 'assert';
 import * as mdTable from 'markdown-table';
 import { generateObject, timeDiffInMs, formatTimeDiff, formatRatio } from './bench-utils';
+import { record } from './bench-results';
 
 type BenchmarkSettings = [
     string,     // label
@@ -33,7 +34,7 @@ export function bench() {
         ["1 level - 10 strings - length 100", 10, 1, "string", 100],
         ["1 level - 100 strings - length 100", 100, 1, "string", 100],
         ["2 level - 10 strings - length 100", 10, 2, "string", 100],
-        ["3 level - 5 integers", 5, 3, "string", 100],
+        ["3 level - 5 strings - length 100", 5, 3, "string", 100],
 
         // Boolean
         ["1 level - 10 booleans", 10, 1, "boolean", 0],
@@ -85,6 +86,10 @@ export function bench() {
         let unmarshallTimeText = formatTimeDiff(unmarshallTime) + " " + formatRatio(unmarshallTime, parseTime);
 
         table.push([s[0], size, stringifyTimeText, marshallTimeText, parseTimeText, unmarshallTimeText]);
+        record('transport-overhead', `${s[0]} - JSON.stringify`, stringifyTime);
+        record('transport-overhead', `${s[0]} - transport.marshall`, marshallTime);
+        record('transport-overhead', `${s[0]} - JSON.parse`, parseTime);
+        record('transport-overhead', `${s[0]} - transport.unmarshall`, unmarshallTime);
     }
     console.log("## Transport overhead\n");
     console.log(mdTable(table));
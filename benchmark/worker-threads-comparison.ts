@@ -0,0 +1,350 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as assert from 'assert';
+import * as mdTable from 'markdown-table';
+import { generateObject, formatTimeDiff } from './bench-utils';
+import { HdrHistogram } from './hdr-histogram';
+import { record } from './bench-results';
+
+/// <summary> Options of the napa vs. worker_threads comparison. </summary>
+export interface ComparisonOptions {
+    /// <summary> Calls of each call overhead and transport run. </summary>
+    calls: number;
+
+    /// <summary> Calls kept in flight at once, as a server would have. </summary>
+    inFlight: number;
+
+    /// <summary> CRC32 computations of a 1KB string in each call of the scalability run. </summary>
+    crcRepeat: number;
+
+    /// <summary> Approximate JSON sizes in bytes of the objects echoed by the transport runs. </summary>
+    payloadSizes: number[];
+
+    /// <summary> Increments of a shared counter by each worker. </summary>
+    sharedOperations: number;
+}
+
+export const DEFAULT_COMPARISON_OPTIONS: ComparisonOptions = {
+    calls: 10000,
+    inFlight: 64,
+    crcRepeat: 100000,
+    payloadSizes: [1e2, 1e4, 1e6],
+    sharedOperations: 100000
+};
+
+/// <summary> Calls of a run, latencies are in microseconds from issue to completion on the calling thread. </summary>
+export interface CallRun {
+    /// <summary> Calls completed per second. </summary>
+    throughput: number;
+
+    latency: HdrHistogram;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Workloads, run as they are by napa workers and by worker_threads.
+// They are sent by source, so they only use what both have in common.
+
+export function emptyCall(): void {
+}
+
+export function echo(payload: any): any {
+    return payload;
+}
+
+export function crcRun(repeat: number): number {
+    var crcTable: number[] = [];
+    for (var n = 0; n < 256; n++) {
+        var c = n;
+        for (var k = 0; k < 8; k++) {
+            c = ((c & 1) ? (0xEDB88320 ^ (c >>> 1)) : (c >>> 1));
+        }
+        crcTable[n] = c;
+    }
+
+    var key = Array(1024).join('x');
+    var result = 0;
+    for (var r = 0; r < repeat; ++r) {
+        var crc = 0 ^ (-1);
+        for (var i = 0; i < key.length; i++) {
+            crc = (crc >>> 8) ^ crcTable[(crc ^ key.charCodeAt(i)) & 0xFF];
+        }
+        result = result ^ ((crc ^ (-1)) >>> 0);
+    }
+    return result;
+}
+
+/// <summary> Increments the counter shared by worker_threads, returning the milliseconds taken. </summary>
+export function atomicIncrementRun(operations: number): number {
+    var start = Date.now();
+    for (var i = 0; i < operations; ++i) {
+        Atomics.add(sharedCounter, 0, 1);
+    }
+    return Date.now() - start;
+}
+declare var Atomics: any;
+declare var SharedArrayBuffer: any;
+declare var sharedCounter: Int32Array;
+
+/// <summary> Increments the counter of a store shared by napa workers, returning the milliseconds taken. </summary>
+export function storeIncrementRun(storeId: string, operations: number): number {
+    let store = napa.store.get(storeId);
+    let start = Date.now();
+    for (let i = 0; i < operations; ++i) {
+        store.increment('counter');
+    }
+    return Date.now() - start;
+}
+
+const WORKLOADS: ((...args: any[]) => any)[] = [emptyCall, echo, crcRun, atomicIncrementRun];
+
+////////////////////////////////////////////////////////////////////////
+// worker_threads side.
+
+/// <summary> Workers of worker_threads that run workloads by name, posting each call to the next worker in turn. </summary>
+class WorkerThreadsPool {
+    private _workers: any[] = [];
+    private _pending = new Map<number, { resolve: (value: any) => void, reject: (error: any) => void }>();
+    private _nextId = 0;
+    private _nextWorker = 0;
+
+    constructor(workers: number, counter: any) {
+        // Required here, so that napa workers can load this module for storeIncrementRun.
+        let Worker = require('worker_threads').Worker;
+        let source = [
+            "var workerThreads = require('worker_threads');",
+            "var sharedCounter = new Int32Array(workerThreads.workerData.counter);"
+        ].concat(WORKLOADS.map(workload => workload.toString())).concat([
+            `var workloads = { ${WORKLOADS.map(workload => `${workload.name}: ${workload.name}`).join(', ')} };`,
+            "workerThreads.parentPort.on('message', function (message) {",
+            "    try {",
+            "        var value = workloads[message.workload].apply(undefined, message.args);",
+            "        workerThreads.parentPort.postMessage({ id: message.id, value: value });",
+            "    } catch (error) {",
+            "        workerThreads.parentPort.postMessage({ id: message.id, error: String(error) });",
+            "    }",
+            "});"
+        ]).join('\n');
+
+        for (let i = 0; i < workers; ++i) {
+            let worker = new Worker(source, { eval: true, workerData: { counter: counter } });
+            worker.on('message', (message: any) => {
+                let pending = this._pending.get(message.id);
+                this._pending.delete(message.id);
+                if (message.error !== undefined) {
+                    pending.reject(message.error);
+                } else {
+                    pending.resolve(message.value);
+                }
+            });
+            worker.unref();
+            this._workers.push(worker);
+        }
+    }
+
+    execute(workload: string, args: any[]): Promise<any> {
+        return new Promise<any>((resolve, reject) => {
+            let id = this._nextId++;
+            this._pending.set(id, { resolve: resolve, reject: reject });
+            this._workers[this._nextWorker].postMessage({ id: id, workload: workload, args: args });
+            this._nextWorker = (this._nextWorker + 1) % this._workers.length;
+        });
+    }
+
+    terminate(): Promise<void> {
+        return Promise.all(this._workers.map(worker => worker.terminate())).then(() => {});
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+// Runs.
+
+function now(): number {
+    let time = process.hrtime();
+    return time[0] * 1e6 + time[1] / 1e3;
+}
+
+/// <summary> Makes calls keeping a number of them in flight, i.e. closed-loop. </summary>
+export function runCalls(calls: number, inFlight: number, call: () => Promise<any>): Promise<CallRun> {
+    return new Promise<CallRun>((resolve, reject) => {
+        let run: CallRun = { throughput: 0, latency: new HdrHistogram() };
+        let start = now();
+        let issued = 0;
+        let completed = 0;
+
+        let issue = () => {
+            let issuedAt = now();
+            ++issued;
+            call().then(() => {
+                run.latency.record(now() - issuedAt);
+                if (++completed === calls) {
+                    run.throughput = calls * 1e6 / (now() - start);
+                    resolve(run);
+                } else if (issued < calls) {
+                    issue();
+                }
+            }, reject);
+        };
+
+        for (let i = 0; i < Math.min(inFlight, calls); ++i) {
+            issue();
+        }
+    });
+}
+
+/// <summary> Runs one call on each of a number of workers at once, returning the milliseconds until all completed. </summary>
+async function runScalability(workers: number, expected: number, call: () => Promise<any>): Promise<number> {
+    let start = now();
+    let calls: Promise<any>[] = [];
+    for (let i = 0; i < workers; ++i) {
+        calls.push(call());
+    }
+    for (let value of await Promise.all(calls)) {
+        assert(value === expected);
+    }
+    return (now() - start) / 1000;
+}
+
+/// <summary> Adds rows of the napa and worker_threads runs of a workload, and records their metrics. </summary>
+function addCallRuns(table: string[][], workload: string, napaRun: CallRun, threadsRun: CallRun): void {
+    let ms = (us: number) => (us / 1000).toFixed(3);
+    for (let [runtime, run] of [['napa', napaRun], ['worker_threads', threadsRun]] as [string, CallRun][]) {
+        record('worker-threads-comparison', `${workload} - ${runtime} - throughput`, run.throughput, 'calls/s', 'higher');
+        record('worker-threads-comparison', `${workload} - ${runtime} - p50`, run.latency.valueAtPercentile(50) / 1000);
+        record('worker-threads-comparison', `${workload} - ${runtime} - p99`, run.latency.valueAtPercentile(99) / 1000);
+
+        table.push([
+            workload,
+            runtime,
+            run.throughput.toFixed(0),
+            ms(run.latency.valueAtPercentile(50)),
+            ms(run.latency.valueAtPercentile(90)),
+            ms(run.latency.valueAtPercentile(99)),
+            ms(run.latency.valueAtPercentile(99.9)),
+            ms(run.latency.max)
+        ]);
+    }
+}
+
+/// <summary>
+///     Runs the same workloads on the workers of a zone and on as many worker_threads: call overhead, CRC scalability,
+///     transport of objects and shared state. Napa calls go through zone.execute and its scheduler, which picks the least
+///     busy worker; worker_threads calls go through postMessage to workers in turn. Shared state is a store counter for
+///     napa, and a SharedArrayBuffer counter with Atomics for worker_threads. Skipped where worker_threads isn't available.
+/// </summary>
+export async function bench(zone: napa.zone.Zone, options: ComparisonOptions = DEFAULT_COMPARISON_OPTIONS): Promise<void> {
+    try {
+        require('worker_threads');
+    } catch (error) {
+        console.log("Skipping napa vs. worker_threads comparison, worker_threads isn't available in this Node.js.\n");
+        return;
+    }
+    console.log("Benchmarking napa vs. worker_threads...");
+
+    let workers = zone.workers;
+    let counter = new SharedArrayBuffer(4);
+    let pool = new WorkerThreadsPool(workers, counter);
+    for (let workload of WORKLOADS) {
+        await zone.broadcast(workload.toString());
+    }
+
+    // Warm-up.
+    await runCalls(Math.min(options.calls, 1000), options.inFlight, () => zone.execute('', 'emptyCall', []));
+    await runCalls(Math.min(options.calls, 1000), options.inFlight, () => pool.execute('emptyCall', []));
+
+    let callTable = [["workload", "runtime", "calls/s", "p50 (ms)", "p90 (ms)", "p99 (ms)", "p99.9 (ms)", "max (ms)"]];
+    addCallRuns(callTable, 'empty call',
+        await runCalls(options.calls, options.inFlight, () => zone.execute('', 'emptyCall', [])),
+        await runCalls(options.calls, options.inFlight, () => pool.execute('emptyCall', [])));
+
+    for (let size of options.payloadSizes) {
+        // Keys of about 100 bytes of JSON each, like rows of a table.
+        let payload = generateObject(Math.max(Math.round(size / 110), 1), 1, 'string', 100);
+        let calls = Math.max(Math.min(options.calls, Math.round(options.calls * 1e3 / size)), 100);
+        addCallRuns(callTable, `echo ${size} bytes`,
+            await runCalls(calls, options.inFlight, () => zone.execute('', 'echo', [payload])),
+            await runCalls(calls, options.inFlight, () => pool.execute('echo', [payload])));
+    }
+
+    console.log(`## Call overhead and transport, ${workers} workers, ${options.inFlight} calls in flight\n`);
+    console.log(mdTable(callTable));
+    console.log('');
+
+    let expected = crcRun(options.crcRepeat);
+    let scalabilityTable = [["runtime"]];
+    let napaRow = ['napa'];
+    let threadsRow = ['worker_threads'];
+    for (let w = 1; w <= workers; w *= 2) {
+        let napaTime = await runScalability(w, expected, () => zone.execute('', 'crcRun', [options.crcRepeat]).then(result => result.value));
+        let threadsTime = await runScalability(w, expected, () => pool.execute('crcRun', [options.crcRepeat]));
+        record('worker-threads-comparison', `crc - napa - ${w} workers`, napaTime);
+        record('worker-threads-comparison', `crc - worker_threads - ${w} workers`, threadsTime);
+
+        scalabilityTable[0].push(`${w} worker(s) (ms)`);
+        napaRow.push(formatTimeDiff(napaTime));
+        threadsRow.push(formatTimeDiff(threadsTime));
+    }
+    scalabilityTable.push(napaRow, threadsRow);
+
+    console.log(`## CRC scalability, ${options.crcRepeat} CRC32 of a 1KB string per worker\n`);
+    console.log(mdTable(scalabilityTable));
+    console.log('');
+
+    let storeId = 'worker-threads-comparison';
+    napa.store.getOrCreate(storeId).set('counter', 0);
+    let sharedCalls: Promise<number>[] = [];
+    for (let i = 0; i < workers; ++i) {
+        sharedCalls.push(zone.execute(__filename, 'storeIncrementRun', [storeId, options.sharedOperations]).then(result => result.value));
+    }
+    let napaElapsed = Math.max(...await Promise.all(sharedCalls));
+    assert(napa.store.get(storeId).get('counter') === workers * options.sharedOperations);
+
+    sharedCalls = [];
+    for (let i = 0; i < workers; ++i) {
+        sharedCalls.push(pool.execute('atomicIncrementRun', [options.sharedOperations]));
+    }
+    let threadsElapsed = Math.max(...await Promise.all(sharedCalls));
+    assert(new Int32Array(counter)[0] === workers * options.sharedOperations);
+
+    let operations = workers * options.sharedOperations;
+    let napaRate = operations * 1000 / Math.max(napaElapsed, 1);
+    let threadsRate = operations * 1000 / Math.max(threadsElapsed, 1);
+    record('worker-threads-comparison', 'shared counter - napa', napaRate, 'ops/s', 'higher');
+    record('worker-threads-comparison', 'shared counter - worker_threads', threadsRate, 'ops/s', 'higher');
+
+    console.log(`## Shared state, ${workers} workers incrementing one counter ${options.sharedOperations} times each\n`);
+    console.log(mdTable([
+        ["runtime", "shared state", "ops/s"],
+        ["napa", "store.increment", napaRate.toFixed(0)],
+        ["worker_threads", "Atomics.add on a SharedArrayBuffer", threadsRate.toFixed(0)]
+    ]));
+    console.log('');
+
+    await pool.terminate();
+}
+
+/// <summary>
+///     Runs on its own:
+///     node worker-threads-comparison.js --workers 4 --calls 10000 --in-flight 64 --crc 100000 --payloads 100,10000,1000000 --shared 100000
+/// </summary>
+if (require.main === module) {
+    let options: ComparisonOptions = Object.assign({}, DEFAULT_COMPARISON_OPTIONS);
+    let workers = 4;
+    let argv = process.argv.slice(2);
+    for (let i = 0; i + 1 < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--workers': workers = parseInt(value); break;
+            case '--calls': options.calls = parseInt(value); break;
+            case '--in-flight': options.inFlight = parseInt(value); break;
+            case '--crc': options.crcRepeat = parseInt(value); break;
+            case '--payloads': options.payloadSizes = value.split(',').map(size => parseInt(size)); break;
+            case '--shared': options.sharedOperations = parseInt(value); break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+
+    bench(napa.zone.create('worker-threads-comparison', { workers: workers }), options)
+        .then(() => process.exit(0));
+}
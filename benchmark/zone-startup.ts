@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from '../lib/index';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import * as mdTable from 'markdown-table';
+import { timeDiffInMs, formatTimeDiff } from './bench-utils';
+import { record } from './bench-results';
+
+/// <summary> Options of the zone startup benchmark. </summary>
+export interface StartupOptions {
+    /// <summary> Worker counts of the zones created, in order. </summary>
+    workers: number[];
+
+    /// <summary> Modules each module of the synthetic tree requires, and levels of the tree below its root. </summary>
+    fanout: number;
+    depth: number;
+
+    /// <summary> Functions defined by each module, to give V8 code to compile. </summary>
+    functions: number;
+}
+
+export const DEFAULT_STARTUP_OPTIONS: StartupOptions = {
+    workers: [1, 2, 4, 8, 16, 32],
+    fanout: 4,
+    depth: 4,
+    functions: 20
+};
+
+/// <summary> Startup of a zone. Times are in milliseconds, memory in bytes. </summary>
+export interface ZoneStartup {
+    workers: number;
+
+    /// <summary> Time napa.zone.create took, which returns once all workers are bootstrapped. </summary>
+    create: number;
+
+    /// <summary> Time from the start of napa.zone.createAsync until its promise is fulfilled, created again with the same workers. </summary>
+    createAsync: number;
+
+    /// <summary> Time of the first call after the zone was created. </summary>
+    firstCall: number;
+
+    /// <summary> Mean and max time workers spent bootstrapping their module loader, NaN without the 'in-process' metric provider. </summary>
+    bootstrapMean: number;
+    bootstrapMax: number;
+
+    /// <summary> Growth of the process resident set by the zone, per worker. </summary>
+    rssPerWorker: number;
+
+    /// <summary> Mean V8 heap of idle workers, used and committed. </summary>
+    usedHeapPerWorker: number;
+    totalHeapPerWorker: number;
+}
+
+/// <summary> Time of requiring the synthetic module tree, in milliseconds. </summary>
+export interface RequireCost {
+    modules: number;
+
+    /// <summary> First require in a worker. </summary>
+    cold: number;
+
+    /// <summary> First require in a worker of another zone, whose module resolutions are cached by the process. </summary>
+    coldResolved: number;
+
+    /// <summary> Require again in the same worker, from the module cache. </summary>
+    cached: number;
+
+    /// <summary> The same in Node, for reference. </summary>
+    nodeCold: number;
+    nodeCached: number;
+}
+
+let _zoneCount = 0;
+
+function createZoneId(workers: number): string {
+    return `startup-${workers}-${_zoneCount++}`;
+}
+
+/// <summary> Returns mean and max time of the bootstrap metric of a zone's workers, in milliseconds. </summary>
+function getBootstrapTimes(zoneId: string): [number, number] {
+    let snapshots: napa.metric.MetricSnapshot[];
+    try {
+        snapshots = napa.metric.snapshot([100]);
+    }
+    catch (error) {
+        return [NaN, NaN];
+    }
+
+    let sum = 0;
+    let count = 0;
+    let max = 0;
+    for (let snapshot of snapshots) {
+        if (snapshot.section !== 'Zone' || snapshot.name !== 'WorkerBootstrapTime') {
+            continue;
+        }
+        for (let series of snapshot.series) {
+            if (series.dimensions[0] === zoneId && series.count > 0) {
+                sum += series.value;
+                count += series.count;
+                max = Math.max(max, series.max);
+            }
+        }
+    }
+    return count > 0 ? [sum / count / 1000, max / 1000] : [NaN, NaN];
+}
+
+export async function measureStartup(workers: number): Promise<ZoneStartup> {
+    let rssBefore = process.memoryUsage().rss;
+    let zoneId = createZoneId(workers);
+    let start = process.hrtime();
+    let zone = napa.zone.create(zoneId, { workers: workers });
+    let create = timeDiffInMs(process.hrtime(start));
+    let rssAfter = process.memoryUsage().rss;
+
+    start = process.hrtime();
+    await zone.execute(() => 0, []);
+    let firstCall = timeDiffInMs(process.hrtime(start));
+
+    let usage = await zone.memoryUsage();
+    let bootstrap = getBootstrapTimes(zoneId);
+
+    start = process.hrtime();
+    await napa.zone.createAsync(createZoneId(workers), { workers: workers });
+    let createAsync = timeDiffInMs(process.hrtime(start));
+
+    return {
+        workers: workers,
+        create: create,
+        createAsync: createAsync,
+        firstCall: firstCall,
+        bootstrapMean: bootstrap[0],
+        bootstrapMax: bootstrap[1],
+        rssPerWorker: (rssAfter - rssBefore) / workers,
+        usedHeapPerWorker: usage.reduce((sum, worker) => sum + worker.usedHeapSize, 0) / usage.length,
+        totalHeapPerWorker: usage.reduce((sum, worker) => sum + worker.totalHeapSize, 0) / usage.length
+    };
+}
+
+/// <summary> Writes a tree of modules that require their children, returning the path of its root and the number of modules. </summary>
+export function writeModuleTree(directory: string, options: StartupOptions): [string, number] {
+    let count = 0;
+    let write = (name: string, level: number) => {
+        let lines: string[] = [];
+        if (level < options.depth) {
+            for (let i = 0; i < options.fanout; ++i) {
+                let child = `${name}-${i}`;
+                write(child, level + 1);
+                lines.push(`var child${i} = require('./${child}');`);
+            }
+        }
+        for (let i = 0; i < options.functions; ++i) {
+            lines.push(`exports.f${i} = function (a, b) { var s = '${name}' + a; for (var j = 0; j < b; ++j) { s += j % ${i + 2}; } return s.length; };`);
+        }
+        fs.writeFileSync(path.join(directory, name + '.js'), lines.join('\n'));
+        ++count;
+    };
+    write('m', 0);
+    return [path.join(directory, 'm.js'), count];
+}
+
+/// <summary> Requires a module twice, returning milliseconds of both, called in zone workers. </summary>
+function timeRequire(modulePath: string): number[] {
+    let times: number[] = [];
+    for (let i = 0; i < 2; ++i) {
+        let start = process.hrtime();
+        require(modulePath);
+        let diff = process.hrtime(start);
+        times.push((diff[0] * 1e9 + diff[1]) / 1e6);
+    }
+    return times;
+}
+
+export async function measureRequire(options: StartupOptions): Promise<RequireCost> {
+    let directory = fs.mkdtempSync(path.join(os.tmpdir(), 'napa-startup-'));
+    try {
+        let [root, modules] = writeModuleTree(directory, options);
+
+        let first = napa.zone.create(createZoneId(1), { workers: 1 });
+        let cold = <number[]>(await first.execute(timeRequire, [root])).value;
+        let second = napa.zone.create(createZoneId(1), { workers: 1 });
+        let coldResolved = <number[]>(await second.execute(timeRequire, [root])).value;
+        let node = timeRequire(root);
+
+        return {
+            modules: modules,
+            cold: cold[0],
+            coldResolved: coldResolved[0],
+            cached: cold[1],
+            nodeCold: node[0],
+            nodeCached: node[1]
+        };
+    }
+    finally {
+        for (let file of fs.readdirSync(directory)) {
+            fs.unlinkSync(path.join(directory, file));
+        }
+        fs.rmdirSync(directory);
+    }
+}
+
+function formatMB(bytes: number): string {
+    return (bytes / (1024 * 1024)).toFixed(2);
+}
+
+export async function bench(options: StartupOptions = DEFAULT_STARTUP_OPTIONS): Promise<void> {
+    console.log("Benchmarking zone startup...");
+
+    // Warm-up, e.g. of loading napajs in node.
+    await measureStartup(1);
+
+    let table = [["workers", "create (ms)", "createAsync (ms)", "first call (ms)", "bootstrap mean (ms)", "bootstrap max (ms)",
+        "RSS per worker (MB)", "used heap per worker (MB)", "total heap per worker (MB)"]];
+    for (let workers of options.workers) {
+        let startup = await measureStartup(workers);
+        let name = `${workers} workers`;
+        record('zone-startup', `${name} - create`, startup.create);
+        record('zone-startup', `${name} - createAsync`, startup.createAsync);
+        record('zone-startup', `${name} - first call`, startup.firstCall);
+        record('zone-startup', `${name} - bootstrap mean`, startup.bootstrapMean);
+        record('zone-startup', `${name} - RSS per worker`, startup.rssPerWorker, 'bytes');
+        record('zone-startup', `${name} - used heap per worker`, startup.usedHeapPerWorker, 'bytes');
+
+        table.push([
+            workers.toString(),
+            formatTimeDiff(startup.create),
+            formatTimeDiff(startup.createAsync),
+            formatTimeDiff(startup.firstCall),
+            isNaN(startup.bootstrapMean) ? '-' : formatTimeDiff(startup.bootstrapMean),
+            isNaN(startup.bootstrapMax) ? '-' : formatTimeDiff(startup.bootstrapMax),
+            formatMB(startup.rssPerWorker),
+            formatMB(startup.usedHeapPerWorker),
+            formatMB(startup.totalHeapPerWorker)
+        ]);
+    }
+    console.log("## Zone startup\n");
+    console.log(mdTable(table));
+    console.log('');
+
+    let cost = await measureRequire(options);
+    record('zone-startup', 'require - cold', cost.cold);
+    record('zone-startup', 'require - cold, resolutions cached', cost.coldResolved);
+    record('zone-startup', 'require - cached', cost.cached);
+
+    console.log(`## Require of ${cost.modules} modules (${options.fanout} children per module, ${options.depth} levels)\n`);
+    console.log(mdTable([
+        ["", "cold (ms)", "cold, resolutions cached (ms)", "cached (ms)"],
+        ["napa", formatTimeDiff(cost.cold), formatTimeDiff(cost.coldResolved), formatTimeDiff(cost.cached)],
+        ["node", formatTimeDiff(cost.nodeCold), "-", formatTimeDiff(cost.nodeCached)]
+    ]));
+    console.log('');
+}
+
+/// <summary>
+///     Runs on its own with the 'in-process' metric provider, which reports bootstrap times:
+///     node zone-startup.js --workers 1,4,16 --fanout 4 --depth 4 --functions 20 [--spare-isolates 4] [--snapshot napa.snapshot.bin]
+/// </summary>
+if (require.main === module) {
+    let options: StartupOptions = Object.assign({}, DEFAULT_STARTUP_OPTIONS);
+    let settings: napa.runtime.PlatformSettings = { metricProvider: 'in-process' };
+    let argv = process.argv.slice(2);
+    for (let i = 0; i + 1 < argv.length; i += 2) {
+        let value = argv[i + 1];
+        switch (argv[i]) {
+            case '--workers': options.workers = value.split(',').map(workers => parseInt(workers)); break;
+            case '--fanout': options.fanout = parseInt(value); break;
+            case '--depth': options.depth = parseInt(value); break;
+            case '--functions': options.functions = parseInt(value); break;
+            case '--spare-isolates': settings.spareIsolates = parseInt(value); break;
+            case '--snapshot': settings.snapshotBlob = value; break;
+            default: throw new Error(`Unknown option "${argv[i]}".`);
+        }
+    }
+    napa.runtime.setPlatformSettings(settings);
+
+    bench(options).then(() => process.exit(0));
+}
@@ -9,3 +9,4 @@
 #include "napa/zone/node-async-runner.h"
 #endif
 
+#include "napa/zone/async-task.h"
@@ -31,6 +31,31 @@ EXTERN_C NAPA_API napa_zone_handle napa_zone_get(napa_string_ref id);
 /// </remarks>
 EXTERN_C NAPA_API napa_zone_handle napa_zone_get_current();
 
+/// <summary> Connects to a zone served by another process, on this host or another, see napa_zone_serve. </summary>
+/// <param name="address"> The "host:port" address the zone is served on. </param>
+/// <returns> The zone handle, whose id is the id of the zone on its host. Null if the zone can't be reached. </returns>
+/// <remarks>
+///     This function returns a handle that must be release when it's no longer needed.
+///     The connection is closed when all handles have been released, calls that are still pending then fail.
+/// </remarks>
+EXTERN_C NAPA_API napa_zone_handle napa_zone_connect(napa_string_ref address);
+
+/// <summary> Groups zones, local or connected, into a zone that routes each call to the least loaded of them. </summary>
+/// <param name="id"> The id of the group, which isn't registered, so napa_zone_get doesn't find it. </param>
+/// <param name="members"> Handles of the initialized zones to group, which may be released after. </param>
+/// <param name="count"> Number of members, at least one. </param>
+/// <param name="local_payload_size"> Calls whose arguments take up to this many bytes prefer local members, 0 not to. </param>
+/// <returns> The zone handle, null if there are no members or some aren't initialized. </returns>
+/// <remarks>
+///     This function returns a handle that must be release when it's no longer needed.
+///     The group keeps its members until all its handles have been released.
+/// </remarks>
+EXTERN_C NAPA_API napa_zone_handle napa_zone_group(
+    napa_string_ref id,
+    const napa_zone_handle* members,
+    size_t count,
+    uint32_t local_payload_size);
+
 /// <summary> Releases the zone handle. When all handles for a zone are released the zone is destroyed. </summary>
 /// <param name="handle"> The zone handle. </param>
 EXTERN_C NAPA_API napa_result_code napa_zone_release(napa_zone_handle handle);
@@ -50,6 +75,19 @@ EXTERN_C NAPA_API napa_result_code napa_zone_init(
 /// <param name="handle"> The zone handle. </param>
 EXTERN_C NAPA_API napa_string_ref napa_zone_get_id(napa_zone_handle handle);
 
+/// <summary> Serves the zone to other processes, which connect to it with napa_zone_connect. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="address"> The "host:port" address to listen on, port 0 for any free port. </param>
+/// <param name="port"> Receives the port the zone is served on. Optional. </param>
+/// <remarks>
+///     The zone is served, and kept alive, until napa shuts down. Clients aren't authenticated and run any code,
+///     so zones should only be served on trusted networks, e.g. on "127.0.0.1" for processes of the host.
+/// </remarks>
+EXTERN_C NAPA_API napa_result_code napa_zone_serve(
+    napa_zone_handle handle,
+    napa_string_ref address,
+    uint16_t* port);
+
 /// <summary> Compiles and run the provided source code on all zone workers. </summary>
 /// <param name="handle"> The zone handle. </param>
 /// <param name="source"> The JavaScript source code. </param>
@@ -72,6 +110,188 @@ EXTERN_C NAPA_API void napa_zone_execute(
     napa_zone_execute_callback callback,
     void* context);
 
+/// <summary> Executes a batch of pre-loaded functions asynchronously, each in a single zone worker. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="specs"> The function specs to call. </param>
+/// <param name="specs_count"> The number of function specs. </param>
+/// <param name="callback"> A callback that is triggered with results in order of specs, when all executions are done. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+EXTERN_C NAPA_API void napa_zone_execute_batch(
+    napa_zone_handle handle,
+    const napa_zone_function_spec* specs,
+    size_t specs_count,
+    napa_zone_execute_batch_callback callback,
+    void* context);
+
+/// <summary> Executes a batch of pre-loaded functions asynchronously, into results and an arena owned by the caller. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="specs"> The function specs to call. </param>
+/// <param name="specs_count"> The number of function specs. </param>
+/// <param name="results"> Array of specs_count results to fill in order of specs, which must outlive the batch. </param>
+/// <param name="arena"> Buffer that error messages and return values are copied into, which must outlive the batch. </param>
+/// <param name="callback"> A callback that is triggered with 'results' once all executions are done. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks> 
+///     Unlike napa_zone_execute_batch, results don't refer to memory owned by napa, and may be kept after the callback.
+///     A result that doesn't fit in the arena has code NAPA_RESULT_RESULT_ARENA_EXHAUSTED, the call was executed nevertheless.
+///     Transport contexts of results are owned by the caller as with napa_zone_execute.
+/// </remarks>
+EXTERN_C NAPA_API void napa_zone_execute_many(
+    napa_zone_handle handle,
+    const napa_zone_function_spec* specs,
+    size_t specs_count,
+    napa_zone_result* results,
+    napa_result_arena* arena,
+    napa_zone_execute_batch_callback callback,
+    void* context);
+
+/// <summary> Retrieves the load of pending calls relative to the zone limits. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <returns> 0 when idle or unlimited, calls are rejected with NAPA_RESULT_ZONE_OVERLOADED at 1. </returns>
+EXTERN_C NAPA_API float napa_zone_get_pressure(napa_zone_handle handle);
+
+/// <summary> Retrieves the number of running workers of the zone, which changes with resizing and autoscaling. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <returns> The number of workers, 1 for the Node zone. </returns>
+EXTERN_C NAPA_API uint32_t napa_zone_get_workers(napa_zone_handle handle);
+
+/// <summary> Changes the number of zone workers asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="workers"> The new number of workers, between 1 and the maxWorkers zone setting. </param>
+/// <param name="callback"> A callback that is triggered when new workers are started, or removed workers are shut down. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+EXTERN_C NAPA_API void napa_zone_resize(
+    napa_zone_handle handle,
+    uint32_t workers,
+    napa_zone_resize_callback callback,
+    void* context);
+
+/// <summary> Waits asynchronously for the calls of a zone to finish, cancelling calls still queued at a deadline. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="timeout"> Milliseconds after which calls waiting for a worker are cancelled, 0 to wait for all calls. </param>
+/// <param name="callback">
+///     A callback that is triggered with NAPA_RESULT_SUCCESS once no call is queued or running, or with NAPA_RESULT_TIMEOUT
+///     and the number of calls cancelled with NAPA_RESULT_CANCELLED at the deadline. Calls already running are not interrupted.
+/// </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks> The zone keeps taking calls while it drains, calls made meanwhile are waited for too. </remarks>
+EXTERN_C NAPA_API void napa_zone_drain(
+    napa_zone_handle handle,
+    uint32_t timeout,
+    napa_zone_drain_callback callback,
+    void* context);
+
+/// <summary> Collects memory usage of each zone worker asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="callback"> A callback that is triggered with the usage of each worker in order of worker ids, once all workers reported. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks> Each worker reports between two tasks, so it waits for the calls being run by the workers. </remarks>
+EXTERN_C NAPA_API void napa_zone_get_memory_usage(
+    napa_zone_handle handle,
+    napa_zone_memory_usage_callback callback,
+    void* context);
+
+/// <summary> Starts the V8 CPU profiler on each zone worker asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="sampling_interval"> Sampling interval in microseconds, 0 for the V8 default. </param>
+/// <param name="callback"> A callback that is triggered once all workers started profiling. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks>
+///     Each worker starts between two tasks, on its own thread. The callback gets NAPA_RESULT_PROFILING_ERROR
+///     if any worker was profiling already. Workers added by a later resize are not profiled.
+/// </remarks>
+EXTERN_C NAPA_API void napa_zone_start_profiling(
+    napa_zone_handle handle,
+    uint32_t sampling_interval,
+    napa_zone_profiling_callback callback,
+    void* context);
+
+/// <summary> Stops the V8 CPU profiler on each zone worker asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="callback">
+///     A callback that is triggered with the profile of each worker in order of worker ids, in the .cpuprofile JSON format.
+///     Profiles of workers which were not profiling are empty.
+/// </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+EXTERN_C NAPA_API void napa_zone_stop_profiling(
+    napa_zone_handle handle,
+    napa_zone_cpu_profile_callback callback,
+    void* context);
+
+/// <summary> Starts the V8 sampling heap profiler on each zone worker asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="sampling_interval"> Average number of bytes allocated between two samples, 0 for the V8 default of 512KB. </param>
+/// <param name="callback"> A callback that is triggered once all workers started profiling. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks>
+///     Each worker starts between two tasks. The callback gets NAPA_RESULT_PROFILING_ERROR if any worker was
+///     profiling allocations already, or if the workers of the zone share threads. Workers added by a later resize are not profiled.
+/// </remarks>
+EXTERN_C NAPA_API void napa_zone_start_allocation_profiling(
+    napa_zone_handle handle,
+    uint32_t sampling_interval,
+    napa_zone_profiling_callback callback,
+    void* context);
+
+/// <summary> Stops the V8 sampling heap profiler on each zone worker asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="callback">
+///     A callback that is triggered with the profiles of all workers merged into one, in the .heapprofile JSON format.
+///     The profile is empty if no worker was profiling.
+/// </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+EXTERN_C NAPA_API void napa_zone_stop_allocation_profiling(
+    napa_zone_handle handle,
+    napa_zone_allocation_profile_callback callback,
+    void* context);
+
+/// <summary> Collects V8 heap statistics, with the statistics of each heap space, of each zone worker asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="callback"> A callback that is triggered with the statistics of each worker in order of worker ids, once all workers reported. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks> Each worker reports between two tasks, so it waits for the calls being run by the workers. </remarks>
+EXTERN_C NAPA_API void napa_zone_get_heap_statistics(
+    napa_zone_handle handle,
+    napa_zone_heap_statistics_callback callback,
+    void* context);
+
+/// <summary> Writes a V8 heap snapshot of a zone worker to a file asynchronously. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="worker_id"> The id of the worker. </param>
+/// <param name="path"> Path of the file, in the .heapsnapshot format of Chrome DevTools. </param>
+/// <param name="callback"> A callback that is triggered once the snapshot is written. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks>
+///     The worker takes the snapshot between two tasks and streams it to the file in chunks.
+///     The callback gets NAPA_RESULT_HEAP_SNAPSHOT_ERROR if the worker doesn't exist or the file can't be written.
+/// </remarks>
+EXTERN_C NAPA_API void napa_zone_write_heap_snapshot(
+    napa_zone_handle handle,
+    uint32_t worker_id,
+    napa_string_ref path,
+    napa_zone_heap_snapshot_callback callback,
+    void* context);
+
+/// <summary> Gets the calls kept by the slow-call log of a zone, oldest first. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="callback"> A callback that is triggered with the calls before the function returns. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks> The log is empty unless the zone settings slowCallThreshold or slowCallSampleRate are set. </remarks>
+EXTERN_C NAPA_API void napa_zone_get_slow_calls(
+    napa_zone_handle handle,
+    napa_zone_slow_calls_callback callback,
+    void* context);
+
+/// <summary> Gets the execution statistics of each function a zone ran, in no particular order. </summary>
+/// <param name="handle"> The zone handle. </param>
+/// <param name="callback"> A callback that is triggered with the statistics before the function returns. </param>
+/// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+/// <remarks> Only zones with workers of their own keep statistics, others report none. </remarks>
+EXTERN_C NAPA_API void napa_zone_get_function_stats(
+    napa_zone_handle handle,
+    napa_zone_function_stats_callback callback,
+    void* context);
+
 /// <summary>
 ///     Global napa initialization. Invokes initialization steps that are cross zones.
 ///     The settings passed represent the defaults for all the zones
@@ -90,15 +310,33 @@ EXTERN_C NAPA_API napa_result_code napa_initialize_from_console(
     int argc,
     const char* argv[]);
 
+/// <summary>
+///     Creates a V8 startup snapshot with the globals defined by a script, to be loaded by setting 'snapshotBlob'
+///     at initialization. The script can't use native bindings like require. Not supported when napa runs in node.
+/// </summary>
+/// <param name="source"> The script to run in the snapshot context. </param>
+/// <param name="path"> The path of the snapshot blob file to create. </param>
+EXTERN_C NAPA_API napa_result_code napa_create_snapshot(napa_string_ref source, napa_string_ref path);
+
 /// <summary> Invokes napa shutdown steps. All non released zones will be destroyed. </summary>
 EXTERN_C NAPA_API napa_result_code napa_shutdown();
 
+/// <summary>
+///     Notifies isolates of all workers of all zones of memory pressure, e.g. when the host approaches its memory limit.
+///     Workers running JavaScript are interrupted, idle ones run the notification ahead of queued calls.
+///     At the critical level, napa allocator caches are released as well. It returns without waiting for workers.
+/// </summary>
+/// <param name="level"> The memory pressure level, which stays in effect until another level is notified. </param>
+/// <remarks> The isolate of Node, if any, is not a worker. napa.memoryPressure() in JavaScript notifies the calling isolate too. </remarks>
+EXTERN_C NAPA_API void napa_memory_pressure(napa_memory_pressure_level level);
+
 /// <summary> Convert the napa result code to its string representation. </summary>
 /// <param name="code"> The result code. </param>
 EXTERN_C NAPA_API const char* napa_result_code_to_string(napa_result_code code);
 
 /// <summary> Set customized allocator, which will be used for napa_allocate and napa_deallocate.
-/// If user doesn't call napa_allocator_set, C runtime malloc/free from napa.dll will be used. </summary>
+/// If user doesn't call napa_allocator_set, C runtime malloc/free from napa.dll will be used,
+/// or napa::memory::GetThreadCachingAllocator() if platform setting 'allocator' is 'threadCaching'. </summary>
 /// <param name="allocate_callback"> Function pointer for allocating memory, which should be valid during the entire process. </param>
 /// <param name="deallocate_callback"> Function pointer for deallocating memory, which should be valid during the entire process. </param>
 EXTERN_C NAPA_API void napa_allocator_set(
@@ -124,3 +362,72 @@ EXTERN_C NAPA_API void* napa_malloc(size_t size);
 /// <param name="pointer"> Pointer to memory to be freed. </param>
 /// <param name="size_hint"> Hint of size to deallocate. </param>
 EXTERN_C NAPA_API void napa_free(void* pointer, size_t size_hint);
+
+/// <summary> Allocates a shared buffer, which zones see as an external ArrayBuffer over its memory, without copying. </summary>
+/// <param name="size"> Size of the buffer in bytes, whose content is undefined. </param>
+/// <returns> The buffer handle, null if size is 0 or the allocation failed. </returns>
+/// <remarks>
+///     Memory comes from the ArrayBuffer pool of napa, see platform setting 'arrayBufferPoolSize', or from ::malloc.
+///     This function returns a handle that must be released when it's no longer needed. The memory is freed once all
+///     handles are released and all ArrayBuffers over it are garbage collected.
+/// </remarks>
+EXTERN_C NAPA_API napa_buffer_handle napa_buffer_allocate(size_t size);
+
+/// <summary> Retrieves the memory of a shared buffer, which may be written in place. </summary>
+/// <param name="handle"> The buffer handle. </param>
+EXTERN_C NAPA_API void* napa_buffer_get_data(napa_buffer_handle handle);
+
+/// <summary> Retrieves the size of a shared buffer in bytes. </summary>
+/// <param name="handle"> The buffer handle. </param>
+EXTERN_C NAPA_API size_t napa_buffer_get_size(napa_buffer_handle handle);
+
+/// <summary> Releases the buffer handle. </summary>
+/// <param name="handle"> The buffer handle. </param>
+EXTERN_C NAPA_API void napa_buffer_release(napa_buffer_handle handle);
+
+/// <summary> Creates an empty transport context, e.g. for napa_zone_function_spec.transport_context. </summary>
+/// <remarks> The context must be released, unless it's passed to an execute function, which takes its ownership. </remarks>
+EXTERN_C NAPA_API void* napa_transport_context_create();
+
+/// <summary> Releases a transport context, e.g. of napa_zone_result, with the buffers and objects it holds. </summary>
+/// <param name="transport_context"> The transport context, may be null. </param>
+EXTERN_C NAPA_API void napa_transport_context_release(void* transport_context);
+
+/// <summary> Saves a shared buffer into a transport context, as an argument that the called function receives as an ArrayBuffer. </summary>
+/// <param name="transport_context"> The transport context of the function spec. </param>
+/// <param name="buffer"> The buffer handle, which may be released after. </param>
+/// <param name="payload"> Char array of NAPA_BUFFER_PAYLOAD_MAX_SIZE that receives the argument, null terminated. </param>
+/// <returns> The argument over payload, e.g. '{"_cid":"ArrayBuffer","handle":[...]}', to put in napa_zone_function_spec.arguments. </returns>
+/// <remarks>
+///     The ArrayBuffer is over the memory of the buffer, so writes on either side are seen by the other. Arguments must use
+///     the default JSON transport, and can't be passed to zones of napa_zone_connect, which run in another process.
+/// </remarks>
+EXTERN_C NAPA_API napa_string_ref napa_transport_context_save_buffer(
+    void* transport_context,
+    napa_buffer_handle buffer,
+    char* payload);
+
+/// <summary> Loads a shared buffer from a transport context, e.g. an ArrayBuffer returned by a call, without copying. </summary>
+/// <param name="transport_context"> The transport context of the result. </param>
+/// <param name="payload"> The JSON payload of an ArrayBuffer or one of its views, e.g. return_value of the result. </param>
+/// <returns> The buffer handle over the whole ArrayBuffer, null if payload isn't one of the context. </returns>
+/// <remarks>
+///     This function returns a handle that must be released when it's no longer needed.
+///     An ArrayBuffer over shared memory, e.g. an argument of napa_transport_context_save_buffer, is loaded over the same
+///     memory. Other ArrayBuffers, which were copied or transferred when returned, are taken over by the first load.
+/// </remarks>
+EXTERN_C NAPA_API napa_buffer_handle napa_transport_context_load_buffer(
+    void* transport_context,
+    napa_string_ref payload);
+
+#ifdef __cplusplus
+
+#include <string>
+
+/// <summary> Moves the return value of a result into a string, without copying it if napa owns it. </summary>
+/// <param name="result"> A result passed to an execute callback, whose return_value is invalid afterwards. </param>
+/// <param name="return_value"> The string to move the return value into. </param>
+/// <remarks> For C++ callers built with the standard library of napa, e.g. napa/zone.h. Only valid within the callback. </remarks>
+NAPA_API void napa_zone_result_take_return_value(const napa_zone_result& result, std::string& return_value);
+
+#endif // __cplusplus
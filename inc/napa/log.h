@@ -8,6 +8,11 @@
 
 #include <stdarg.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
 #define UNUSED(var) (void)(var)
 
 /// <summary> The maximum string length of a single log call. Anything over will be truncated. </summary>
@@ -32,46 +37,265 @@ inline void LogFormattedMessage(
     logger.LogMessage(section, level, traceId, file, line, message);
 }
 
+namespace napa {
+namespace providers {
+namespace logging_detail {
+
+    /// <summary> How an argument is passed to a DeferredLoggingProvider, Supported is false for types printf doesn't take. </summary>
+    template <typename T, typename = void>
+    struct ArgumentTraits {
+        static constexpr bool Supported = false;
+    };
+
+    template <typename T>
+    struct ArgumentTraits<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+        static constexpr bool Supported = true;
+
+        static LogArgument Make(T value) {
+            LogArgument argument;
+            if (std::is_signed<typename std::conditional<std::is_enum<T>::value, int, T>::type>::value) {
+                argument.type = LogArgument::Type::SIGNED;
+                argument.signedValue = static_cast<int64_t>(value);
+            } else {
+                argument.type = LogArgument::Type::UNSIGNED;
+                argument.unsignedValue = static_cast<uint64_t>(value);
+            }
+            return argument;
+        }
+    };
+
+    template <typename T>
+    struct ArgumentTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+        static constexpr bool Supported = true;
+
+        static LogArgument Make(T value) {
+            LogArgument argument;
+            argument.type = LogArgument::Type::DOUBLE;
+            argument.doubleValue = static_cast<double>(value);
+            return argument;
+        }
+    };
+
+    template <typename T>
+    struct ArgumentTraits<T*, void> {
+        static constexpr bool Supported = true;
+
+        static LogArgument Make(const T* value) {
+            LogArgument argument;
+            argument.type = std::is_same<typename std::remove_cv<T>::type, char>::value ?
+                LogArgument::Type::STRING : LogArgument::Type::POINTER;
+            argument.pointerValue = value;
+            return argument;
+        }
+    };
+
+    template <>
+    struct ArgumentTraits<std::nullptr_t, void> {
+        static constexpr bool Supported = true;
+
+        static LogArgument Make(std::nullptr_t) {
+            LogArgument argument;
+            argument.type = LogArgument::Type::POINTER;
+            argument.pointerValue = nullptr;
+            return argument;
+        }
+    };
+
+    template <typename... Args>
+    struct AllSupported : std::true_type {};
+
+    template <typename Arg, typename... Args>
+    struct AllSupported<Arg, Args...> : std::integral_constant<bool,
+        ArgumentTraits<typename std::decay<Arg>::type>::Supported && AllSupported<Args...>::value> {};
+
+    template <typename Arg>
+    LogArgument MakeArgument(const Arg& value) {
+        return ArgumentTraits<typename std::decay<Arg>::type>::Make(value);
+    }
+
+    template <typename... Args>
+    void LogMessage(
+        LoggingProvider& logger,
+        const char* section,
+        LoggingProvider::Verboseness level,
+        const char* traceId,
+        const char* file,
+        int line,
+        const char* format,
+        std::true_type,
+        const Args&... args) {
+
+        auto deferred = GetDeferredLoggingProvider();
+        if (deferred == nullptr) {
+            LogFormattedMessage(logger, section, level, traceId, file, line, format, args...);
+            return;
+        }
+
+        // One more element, as arrays can't be empty.
+        LogArgument arguments[sizeof...(Args) + 1] = { MakeArgument(args)... };
+        deferred->LogDeferred(section, level, traceId, file, line, format, arguments, sizeof...(Args));
+    }
+
+    template <typename... Args>
+    void LogMessage(
+        LoggingProvider& logger,
+        const char* section,
+        LoggingProvider::Verboseness level,
+        const char* traceId,
+        const char* file,
+        int line,
+        const char* format,
+        std::false_type,
+        const Args&... args) {
+        LogFormattedMessage(logger, section, level, traceId, file, line, format, args...);
+    }
+}
+}
+}
+
+/// <summary>
+///     Logs a message, whose formatting is deferred when the format is a string literal, all arguments are
+///     numbers, pointers or strings, and the logging provider supports it. Otherwise it's formatted right away.
+/// </summary>
+template <typename Format, typename... Args>
+inline void LogDeferrableMessage(
+    napa::providers::LoggingProvider& logger,
+    const char* section,
+    napa::providers::LoggingProvider::Verboseness level,
+    const char* traceId,
+    const char* file,
+    int line,
+    const Format& format,
+    const Args&... args) {
+
+    using Deferrable = std::integral_constant<bool,
+        std::is_array<Format>::value && napa::providers::logging_detail::AllSupported<Args...>::value>;
+    napa::providers::logging_detail::LogMessage(logger, section, level, traceId, file, line, format, Deferrable(), args...);
+}
+
+/// <summary> Verboseness levels for NAPA_LOG_MAX_LEVEL, as of napa::providers::LoggingProvider::Verboseness. </summary>
+#define NAPA_LOG_LEVEL_ERROR 0
+#define NAPA_LOG_LEVEL_WARNING 1
+#define NAPA_LOG_LEVEL_INFO 2
+#define NAPA_LOG_LEVEL_DEBUG 3
+
+/// <summary>
+///     The most verbose level compiled in, LOG macros of more verbose levels compile to nothing.
+///     Release builds compile out info and debug logs, unless it's defined before including this header.
+/// </summary>
+#ifndef NAPA_LOG_MAX_LEVEL
+#ifdef NDEBUG
+#define NAPA_LOG_MAX_LEVEL NAPA_LOG_LEVEL_WARNING
+#else
+#define NAPA_LOG_MAX_LEVEL NAPA_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+namespace napa {
+namespace providers {
+namespace logging_detail {
+
+    /// <summary> Gets the level of a section that is a string literal, which the call site keeps. nullptr for other sections. </summary>
+    template <typename Section>
+    std::atomic<int>* GetCallSiteLogLevel(const Section& section) {
+        return std::is_array<Section>::value ? &GetLogLevel(section) : nullptr;
+    }
+
+    /// <summary> Whether a level of a section is logged, looking the section up unless the call site kept its level. </summary>
+    inline bool IsLogLevelEnabled(std::atomic<int>* callSiteLevel, const char* section, LoggingProvider::Verboseness level) {
+        auto& sectionLevel = callSiteLevel != nullptr ? *callSiteLevel : GetLogLevel(section);
+        return static_cast<int>(level) <= sectionLevel.load(std::memory_order_relaxed);
+    }
+}
+}
+}
+
 #ifndef NAPA_LOG_DISABLED
 
-#define LOG(section, level, traceId, format, ...) do {                                                   \
-    auto& logger = napa::providers::GetLoggingProvider();                                                \
-    if (logger.IsLogEnabled(section, level)) {                                                           \
-        LogFormattedMessage(logger, section, level, traceId, __FILE__, __LINE__, format, ##__VA_ARGS__); \
-    }                                                                                                    \
+#define LOG(section, level, traceId, format, ...) do {                                                         \
+    static auto napaLogLevel = napa::providers::logging_detail::GetCallSiteLogLevel(section);                  \
+    if (napa::providers::logging_detail::IsLogLevelEnabled(napaLogLevel, section, level)) {                    \
+        auto& logger = napa::providers::GetLoggingProvider();                                                  \
+        if (logger.IsLogEnabled(section, level)) {                                                             \
+            LogDeferrableMessage(logger, section, level, traceId, __FILE__, __LINE__, format, ##__VA_ARGS__);  \
+        }                                                                                                      \
+    }                                                                                                          \
 } while (false)
 
 #else
 
+/// <summary> Takes the arguments of a disabled LOG call, any number of them. </summary>
+template <typename... Args>
+inline void LogDisabled(Args&&...) {}
+
 #define LOG(section, level, traceId, format, ...) \
-    UNUSED(section);                              \
-    UNUSED(level);                                \
-    UNUSED(traceId);                              \
-    UNUSED(format);                               \
-    UNUSED(__VA_ARGS__);
+    LogDisabled(section, level, traceId, format, ##__VA_ARGS__)
 
 #endif
 
+/// <summary> A LOG call of a level that isn't compiled in, which is type checked but never runs. </summary>
+#define NAPA_LOG_COMPILED_OUT(section, level, traceId, format, ...) do { \
+    if (false) {                                                         \
+        LOG(section, level, traceId, format, ##__VA_ARGS__);             \
+    }                                                                    \
+} while (false)
+
 #define LOG_ERROR(section, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Error, "", format, ##__VA_ARGS__)
 
 #define LOG_ERROR_WITH_TRACEID(section, traceId, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Error, traceId, format, ##__VA_ARGS__)
 
+#if NAPA_LOG_MAX_LEVEL >= NAPA_LOG_LEVEL_WARNING
+
 #define LOG_WARNING(section, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Warning, "", format, ##__VA_ARGS__)
 
 #define LOG_WARNING_WITH_TRACEID(section, traceId, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Warning, traceId, format, ##__VA_ARGS__)
 
+#else
+
+#define LOG_WARNING(section, format, ...) \
+    NAPA_LOG_COMPILED_OUT(section, napa::providers::LoggingProvider::Verboseness::Warning, "", format, ##__VA_ARGS__)
+
+#define LOG_WARNING_WITH_TRACEID(section, traceId, format, ...) \
+    NAPA_LOG_COMPILED_OUT(section, napa::providers::LoggingProvider::Verboseness::Warning, traceId, format, ##__VA_ARGS__)
+
+#endif
+
+#if NAPA_LOG_MAX_LEVEL >= NAPA_LOG_LEVEL_INFO
+
 #define LOG_INFO(section, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Info, "", format, ##__VA_ARGS__)
 
 #define LOG_INFO_WITH_TRACEID(section, traceId, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Info, traceId, format, ##__VA_ARGS__)
 
+#else
+
+#define LOG_INFO(section, format, ...) \
+    NAPA_LOG_COMPILED_OUT(section, napa::providers::LoggingProvider::Verboseness::Info, "", format, ##__VA_ARGS__)
+
+#define LOG_INFO_WITH_TRACEID(section, traceId, format, ...) \
+    NAPA_LOG_COMPILED_OUT(section, napa::providers::LoggingProvider::Verboseness::Info, traceId, format, ##__VA_ARGS__)
+
+#endif
+
+#if NAPA_LOG_MAX_LEVEL >= NAPA_LOG_LEVEL_DEBUG
+
 #define LOG_DEBUG(section, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Debug, "", format, ##__VA_ARGS__)
 
 #define LOG_DEBUG_WITH_TRACEID(section, traceId, format, ...) \
     LOG(section, napa::providers::LoggingProvider::Verboseness::Debug, traceId, format, ##__VA_ARGS__)
+
+#else
+
+#define LOG_DEBUG(section, format, ...) \
+    NAPA_LOG_COMPILED_OUT(section, napa::providers::LoggingProvider::Verboseness::Debug, "", format, ##__VA_ARGS__)
+
+#define LOG_DEBUG_WITH_TRACEID(section, traceId, format, ...) \
+    NAPA_LOG_COMPILED_OUT(section, napa::providers::LoggingProvider::Verboseness::Debug, traceId, format, ##__VA_ARGS__)
+
+#endif
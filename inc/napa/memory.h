@@ -5,14 +5,17 @@
 
 #include <napa/capi.h>
 #include <napa/memory/allocator.h>
+#include <napa/memory/arena-allocator.h>
 #include <napa/memory/common.h>
+#include <napa/memory/histogram-allocator-debugger.h>
 
 #define NAPA_MALLOC(size) ::napa_malloc(size)
 #define NAPA_FREE(pointer, sizeHint) ::napa_free(pointer, sizeHint)
 
 #define NAPA_SET_DEFAULT_ALLOCATOR(malloc, free) ::napa_allocator_set(malloc, free)
 #define NAPA_RESET_DEFAULT_ALLOCATOR() ::napa_allocator_set(napa_malloc, napa_free)
-#define NAPA_ALLOCATE(size) ::napa_allocate(size)
+#define NAPA_ALLOCATE(size) ::napa::memory::AllocateAt(size, __FILE__, __LINE__)
+#define NAPA_ALLOCATE_FROM(allocator, size) ::napa::memory::AllocateAt(allocator, size, __FILE__, __LINE__)
 #define NAPA_DEALLOCATE(pointer, sizeHint) ::napa_deallocate(pointer, sizeHint)
 
 #define NAPA_DEFAULT_ALLOCATOR napa::memory::GetDefaultAllocator()
@@ -5,7 +5,8 @@
 
 #include <napa/memory/allocator.h>
 
-#include <atomic>
+#include <atomic>
+#include <cstring>
 #include <memory>
 #include <sstream>
 
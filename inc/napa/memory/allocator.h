@@ -38,5 +38,9 @@ namespace memory {
 
     /// <summary> Get a long living default allocator for convenience. User can create their own as well.</summary>
     NAPA_API Allocator& GetDefaultAllocator();
+
+    /// <summary> Get a long living size-class allocator caching free blocks per thread, which napa_allocate uses
+    /// if platform setting 'allocator' is 'threadCaching'. Memory may be released on any thread. </summary>
+    NAPA_API Allocator& GetThreadCachingAllocator();
 }
 }
\ No newline at end of file
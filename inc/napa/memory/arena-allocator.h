@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/memory/allocator.h>
+
+#include <cstddef>
+
+namespace napa {
+namespace memory {
+
+    /// <summary> Allocator that bumps a pointer within chunks, and frees all its memory at once. </summary>
+    /// <remarks>
+    ///     Deallocate is a no-op, memory is reclaimed by Reset or destruction only. Thus it suits many small
+    ///     allocations that die together, e.g. those of a zone call, which has an arena of its own (see GetCallArena).
+    ///     Not thread-safe.
+    /// </remarks>
+    class NAPA_API ArenaAllocator : public Allocator {
+    public:
+        /// <summary> Size of the first chunk, later chunks double up to MAX_CHUNK_SIZE. </summary>
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 4 * 1024;
+        static constexpr size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+        /// <summary> Constructor, which allocates nothing until the first allocation. </summary>
+        /// <param name="allocator"> Allocator of chunks. </param>
+        /// <param name="chunkSize"> Size of the first chunk. </param>
+        explicit ArenaAllocator(Allocator& allocator = GetCrtAllocator(), size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+        /// <summary> Frees all chunks. </summary>
+        ~ArenaAllocator();
+
+        /// <summary> Non-copyable. </summary>
+        ArenaAllocator(const ArenaAllocator&) = delete;
+        ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+        /// <summary> Allocate memory of given size, aligned for any type. </summary>
+        void* Allocate(size_t size) override;
+
+        /// <summary> No-op, memory is freed by Reset or destruction. </summary>
+        void Deallocate(void* memory, size_t sizeHint) override;
+
+        /// <summary> Get allocator type for better debuggability. </summary>
+        const char* GetType() const override;
+
+        /// <summary> Only the same arena can deallocate its memory. </summary>
+        bool operator==(const Allocator& other) const override;
+
+        /// <summary> Frees all memory allocated, keeping the latest chunk for reuse. </summary>
+        void Reset();
+
+        /// <summary> Get bytes allocated since construction or the last reset. </summary>
+        size_t GetAllocatedSize() const {
+            return _allocatedSize;
+        }
+
+    private:
+        struct Chunk;
+
+        /// <summary> Allocates a chunk with room for at least size bytes. </summary>
+        void* AllocateChunk(size_t size);
+
+        /// <summary> Frees a list of chunks. </summary>
+        void FreeChunks(Chunk* chunks);
+
+        Allocator& _allocator;
+        size_t _chunkSize;
+        size_t _nextChunkSize;
+
+        /// <summary> Chunks from the latest, which is bumped, to the earliest. </summary>
+        Chunk* _chunks = nullptr;
+        char* _position = nullptr;
+        char* _end = nullptr;
+
+        size_t _allocatedSize = 0;
+    };
+
+    /// <summary> Get the arena of the zone call that the current thread is executing. </summary>
+    /// <returns> The arena, or nullptr outside of a call of a Napa zone, including functions executed in the Node zone. </returns>
+    /// <remarks>
+    ///     Memory of the arena is freed in bulk once the call completes and its context is released, so it's valid for
+    ///     asynchronous work of the call too. Worker threads run one call at a time, thus the arena needs no locking.
+    /// </remarks>
+    NAPA_API ArenaAllocator* GetCallArena();
+}
+}
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/memory/allocator-debugger.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace memory {
+
+    /// <summary> Allocates from an allocator, attributing the allocation to a call site for allocator debuggers. </summary>
+    /// <remarks> It's what NAPA_ALLOCATE_FROM expands to. </remarks>
+    NAPA_API void* AllocateAt(Allocator& allocator, size_t size, const char* file, int line);
+
+    /// <summary> Allocates from napa_allocate, attributing the allocation to a call site for allocator debuggers. </summary>
+    /// <remarks> It's what NAPA_ALLOCATE expands to. </remarks>
+    inline void* AllocateAt(size_t size, const char* file, int line) {
+        return AllocateAt(GetDefaultAllocator(), size, file, line);
+    }
+
+    /// <summary> Allocator debugger that reports a histogram of sizes, live and peak live bytes, and live bytes by call site. </summary>
+    /// <remarks>
+    ///     Each allocation is prefixed by a 16-byte header, recording its size and call site, so deallocations are accounted
+    ///     without size hints. Call sites are known for allocations made through NAPA_ALLOCATE or NAPA_ALLOCATE_FROM, others are
+    ///     reported under an unknown site. Counters are atomics and call sites are found in a lock-free table, so it's cheap
+    ///     enough to stay enabled in production; only sampled allocations, one out of sampleRate, take a lock and capture a stack.
+    ///     Sampled allocations still alive are reported with their stacks, to attribute leaks.
+    /// </remarks>
+    class NAPA_API HistogramAllocatorDebugger : public AllocatorDebugger {
+    public:
+        /// <summary> Number of power-of-two size buckets, the last one holds all larger sizes. </summary>
+        static constexpr size_t BUCKET_COUNT = 40;
+
+        /// <summary> Number of distinct call sites tracked, later ones count as unknown. </summary>
+        static constexpr size_t MAX_SITES = 1024;
+
+        /// <summary> Maximum number of frames of a sampled stack. </summary>
+        static constexpr size_t MAX_FRAMES = 16;
+
+        /// <summary> Constructor. </summary>
+        /// <param name="allocator"> Actual allocator to allocate/deallocate memory. </param>
+        /// <param name="sampleRate"> Captures the stack of one allocation out of this many, 0 to disable sampling. </param>
+        explicit HistogramAllocatorDebugger(std::shared_ptr<Allocator> allocator, uint32_t sampleRate = 0);
+
+        /// <summary> Non-copyable. </summary>
+        HistogramAllocatorDebugger(const HistogramAllocatorDebugger&) = delete;
+        HistogramAllocatorDebugger& operator=(const HistogramAllocatorDebugger&) = delete;
+
+        void* Allocate(size_t size) override;
+        void Deallocate(void* memory, size_t sizeHint) override;
+        const char* GetType() const override;
+        bool operator==(const Allocator& other) const override;
+
+        /// <summary> Get allocator debug information in JSON, with totals, live and peak live size, histogram, call sites and live samples. </summary>
+        std::string GetDebugInfo() const override;
+
+        /// <summary> Gets the total size of allocations not yet deallocated. </summary>
+        size_t GetLiveSize() const;
+
+        /// <summary> Gets the highest live size so far. </summary>
+        size_t GetPeakLiveSize() const;
+
+    private:
+        /// <summary> Counters of a call site. </summary>
+        struct Site {
+            /// <summary> File of the site, nullptr while the slot is free. </summary>
+            std::atomic<const char*> file { nullptr };
+            std::atomic<int> line { 0 };
+            std::atomic<uint64_t> allocateCount { 0 };
+            std::atomic<int64_t> liveSize { 0 };
+        };
+
+        /// <summary> A sampled allocation still alive. </summary>
+        struct Sample {
+            size_t size;
+            uint32_t site;
+            std::vector<void*> frames;
+        };
+
+        /// <summary> Gets the slot of a call site, 0 for unknown sites. </summary>
+        uint32_t FindSite(const char* file, int line);
+
+        /// <summary> Records a sampled allocation. </summary>
+        void AddSample(void* memory, size_t size, uint32_t site);
+
+        std::shared_ptr<Allocator> _allocator;
+        std::string _typeName;
+        uint32_t _sampleRate;
+
+        std::atomic<uint64_t> _allocateCount;
+        std::atomic<uint64_t> _deallocateCount;
+        std::atomic<uint64_t> _allocatedSize;
+        std::atomic<uint64_t> _deallocatedSize;
+        std::atomic<int64_t> _liveSize;
+        std::atomic<int64_t> _peakLiveSize;
+        std::atomic<uint64_t> _histogram[BUCKET_COUNT];
+
+        /// <summary> Open addressing table of call sites, slot 0 is the unknown site. </summary>
+        std::unique_ptr<Site[]> _sites;
+
+        std::unordered_map<void*, Sample> _samples;
+        mutable std::mutex _samplesLock;
+    };
+}
+}
@@ -32,6 +32,22 @@ namespace binding {
         return scope.Escape(v8::Local<v8::Object>::Cast(binding));
     }
 
+    /// <summary> Get a wrap type constructor exported from napa binding, resolved once per isolate. </summary>
+    /// <param name="wrapType"> Name of the wrap type. </param>
+    /// <returns> The constructor, or an empty handle with exception thrown. </returns>
+    NAPA_BINDING_API v8::MaybeLocal<v8::Function> GetWrapConstructor(const char* wrapType);
+
+    /// <summary> Get a function exported from a module, resolved once per isolate, with the module it was exported from. </summary>
+    /// <param name="moduleName"> Module name in node 'require' convention, with 'napajs/bin' as base directory. </param>
+    /// <param name="functionName"> Function from module. </param>
+    /// <param name="module"> Receives the module. </param>
+    /// <returns> The function, or an empty handle with exception thrown. </returns>
+    /// <remarks> Later assignments to the module's property are not seen, as the function is looked up only the first time. </remarks>
+    NAPA_BINDING_API v8::MaybeLocal<v8::Function> GetModuleFunction(
+        const char* moduleName,
+        const char* functionName,
+        v8::Local<v8::Object>& module);
+
     /// <summary> It calls 'module.require' from context of napa binding in C++. </summary> 
     /// <param name="moduleName"> Module name in node 'require' convention. </summary>
     /// <returns> Object if success, or an empty handle with exception thrown. </summary>
@@ -58,17 +74,13 @@ namespace binding {
         auto isolate = v8::Isolate::GetCurrent();
         v8::EscapableHandleScope scope(isolate);
 
-        auto binding = GetBinding();
-        auto constructor = binding->Get(napa::v8_helpers::MakeV8String(isolate, wrapType));
-        JS_ENSURE_WITH_RETURN(
-            isolate, 
-            !constructor.IsEmpty() && constructor->IsFunction(), 
-            v8::MaybeLocal<v8::Object>(), 
-            "Wrap type \"%s\" is not found in napa binding.",
-            wrapType);
+        v8::Local<v8::Function> constructor;
+        if (!GetWrapConstructor(wrapType).ToLocal(&constructor)) {
+            return v8::MaybeLocal<v8::Object>();
+        }
 
         return scope.Escape(
-            v8::Local<v8::Function>::Cast(constructor)->NewInstance(isolate->GetCurrentContext(), argc, argv)
+            constructor->NewInstance(isolate->GetCurrentContext(), argc, argv)
                 .FromMaybe(v8::Local<v8::Object>()));
     }
 
@@ -89,20 +101,11 @@ namespace binding {
         auto context = isolate->GetCurrentContext();
         v8::EscapableHandleScope scope(isolate);
 
-        auto moduleHandle = Require(moduleName);
-        RETURN_VALUE_ON_PENDING_EXCEPTION(moduleHandle, v8::MaybeLocal<v8::Object>());
-        
-        auto module = moduleHandle.ToLocalChecked();
-        auto constructor = v8::Local<v8::Function>::Cast(
-            module->Get(v8_helpers::MakeV8String(isolate, className)));
-
-        JS_ENSURE_WITH_RETURN(
-            isolate,
-            !constructor.IsEmpty(),
-            v8::MaybeLocal<v8::Object>(),
-            "Class \"%s\" is not found in \"%s\".",
-            className,
-            moduleName);
+        v8::Local<v8::Object> module;
+        v8::Local<v8::Function> constructor;
+        if (!GetModuleFunction(moduleName, className, module).ToLocal(&constructor)) {
+            return v8::MaybeLocal<v8::Object>();
+        }
 
         return scope.Escape(
             constructor->NewInstance(context, argc, argv)
@@ -126,22 +129,14 @@ namespace binding {
         auto context = isolate->GetCurrentContext();
         v8::EscapableHandleScope scope(isolate);
 
-        auto moduleHandle = Require(moduleName);
-        RETURN_VALUE_ON_PENDING_EXCEPTION(moduleHandle, v8::MaybeLocal<v8::Value>());
-
-        auto module = moduleHandle.ToLocalChecked();
-        auto function = module->Get(v8_helpers::MakeV8String(isolate, functionName));
-
-        JS_ENSURE_WITH_RETURN(
-            isolate,
-            !function.IsEmpty() && function->IsFunction(),
-            v8::MaybeLocal<v8::Value>(),
-            "Function \"%s\" is not found in module \"%s\".",
-            functionName,
-            moduleName);
+        v8::Local<v8::Object> module;
+        v8::Local<v8::Function> function;
+        if (!GetModuleFunction(moduleName, functionName, module).ToLocal(&function)) {
+            return v8::MaybeLocal<v8::Value>();
+        }
 
         return scope.Escape(
-            v8::Local<v8::Function>::Cast(function)->Call(context, module, argc, argv)
+            function->Call(context, module, argc, argv)
                 .FromMaybe(v8::Local<v8::Value>()));
     }
 }
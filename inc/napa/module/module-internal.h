@@ -90,6 +90,9 @@ namespace module {
     /// <param name="name"> Unique constructor name given at SetPersistentConstructor() call. </param>
     /// <returns> V8 local function object. </returns>
     NAPA_API v8::Local<v8::Function> GetPersistentConstructor(const char* name);
+
+    /// <summary> It releases all persistent constructors of the current V8 isolate, before the isolate is disposed. </summary>
+    NAPA_API void ReleasePersistentConstructors();
     
 }   // End of namespace module.
 }   // End of namespace napa.
\ No newline at end of file
@@ -5,6 +5,10 @@
 
 #include <napa/exports.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
 namespace napa {
 namespace providers {
 
@@ -56,9 +60,76 @@ namespace providers {
         virtual ~LoggingProvider() = default;
     };
 
+    /// <summary> An argument of a log message whose formatting is deferred. </summary>
+    struct LogArgument {
+
+        /// <summary> Type of the argument, integers are widened to 64 bits, strings are null-terminated char pointers. </summary>
+        enum class Type : uint8_t {
+            SIGNED = 1,
+            UNSIGNED,
+            DOUBLE,
+            POINTER,
+            STRING
+        };
+
+        Type type;
+
+        union {
+            int64_t signedValue;
+            uint64_t unsignedValue;
+            double doubleValue;
+            const void* pointerValue;
+        };
+    };
+
+    /// <summary> Interface of logging providers that format messages later, off the logging thread. </summary>
+    /// <remarks>
+    ///     The LOG macros pass messages with a string literal format this way, when the logging provider supports it.
+    ///     The format and file must outlive the provider, strings among the arguments are copied.
+    ///     The provider is owned by the logging provider implementing it.
+    /// </remarks>
+    class DeferredLoggingProvider {
+    public:
+
+        /// <summary> Logs a message, to be formatted by printf rules later. </summary>
+        /// <param name="section"> Logging section. </param>
+        /// <param name="level"> Logging verboseness level. </param>
+        /// <param name="traceId"> Trace ID. </param>
+        /// <param name="file"> The source file this log message originated from, which must outlive the provider. </param>
+        /// <param name="line"> The source line this log message originated from. </param>
+        /// <param name="format"> The printf format of the message, which must outlive the provider. </param>
+        /// <param name="arguments"> The arguments of the format. </param>
+        /// <param name="count"> The number of arguments. </param>
+        virtual void LogDeferred(
+            const char* section,
+            LoggingProvider::Verboseness level,
+            const char* traceId,
+            const char* file,
+            int line,
+            const char* format,
+            const LogArgument* arguments,
+            size_t count) = 0;
+
+    protected:
+        virtual ~DeferredLoggingProvider() = default;
+    };
+
     /// <summary> Exports a getter function for retrieves the configured logging provider. </summary>
     NAPA_API LoggingProvider& GetLoggingProvider();
 
+    /// <summary> Gets the configured logging provider as a DeferredLoggingProvider, nullptr if it formats messages itself. </summary>
+    NAPA_API DeferredLoggingProvider* GetDeferredLoggingProvider();
+
+    /// <summary> Gets the most verbose level logged for a section, as an int of LoggingProvider::Verboseness. </summary>
+    /// <param name="section"> The section, nullptr or "" for messages without a section. </param>
+    /// <remarks> The returned atomic is kept for the lifetime of the process, and reflects later calls to SetLogLevel. </remarks>
+    NAPA_API std::atomic<int>& GetLogLevel(const char* section);
+
+    /// <summary> Sets the most verbose level logged for a section, messages of more verbose levels are discarded. </summary>
+    /// <param name="section"> The section, nullptr for all sections that weren't given a level of their own. </param>
+    /// <param name="level"> The level, all levels are logged by default. </param>
+    NAPA_API void SetLogLevel(const char* section, LoggingProvider::Verboseness level);
+
     /// <summary> Singnature  of the logging provider factory method. </summary>
     typedef LoggingProvider* (*CreateLoggingProvider)();
 }
@@ -6,7 +6,10 @@
 #include <napa/exports.h>
 
 #include <cstddef>
+#include <memory>
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 namespace napa {
 namespace providers {
@@ -18,6 +21,32 @@ namespace providers {
         Percentile,
     };
 
+    /// <summary> Interface of a metric with all its dimension values bound, so updates don't pass or look them up. </summary>
+    /// <remarks> Bound metrics are created by Metric::Bind, and must be destroyed before their metric. </remarks>
+    class BoundMetric {
+    public:
+
+        /// <summary> Sets the metric value. </summary>
+        /// <returns> Success/Fail. </returns>
+        virtual bool Set(int64_t value) = 0;
+
+        /// <summary> Increments the metric value. </summary>
+        /// <returns> Success/Fail. </returns>
+        virtual bool Increment(uint64_t value) = 0;
+
+        /// <summary> Decrements the metric value. </summary>
+        /// <returns> Success/Fail. </returns>
+        virtual bool Decrement(uint64_t value) = 0;
+
+        /// <summary> Explicitly destroys the bound metric, which callers must do when they no longer use it. </summary>
+        virtual void Destroy() = 0;
+
+    protected:
+
+        ///<summary> Prevent calling delete on the interface. Must use Destroy! </summary>
+        virtual ~BoundMetric() = default;
+    };
+
     /// <summary> Interface to represents a multi-dimensional metric with a maximum dimensionality of 64. </summary>
     class Metric {
     public:
@@ -61,6 +90,16 @@ namespace providers {
         /// </remarks>
         virtual bool Decrement(uint64_t value, size_t numberOfDimensions, const char* dimensionValues[]) = 0;
 
+        /// <summary> Binds dimension values once, for metrics which are updated often with the same values. </summary>
+        /// <param name="numberOfDimensions"> Number of dimensions being bound. </param>
+        /// <param name="dimensionValues"> Array of dimension value names, which are copied if needed. </param>
+        /// <returns> The bound metric, or nullptr if the dimension values don't match the metric. </returns>
+        /// <remarks>
+        ///     Providers should override it to resolve the dimension values once. The default implementation keeps
+        ///     a copy of the dimension values and passes them to Set, Increment and Decrement.
+        /// </remarks>
+        virtual BoundMetric* Bind(size_t numberOfDimensions, const char* dimensionValues[]);
+
         /// <summary> Explicitly destroys the Metric. </summary>
         /// <remarks>
         ///     Consumers are not required to call this.
@@ -75,6 +114,63 @@ namespace providers {
     };
 
 
+    /// <summary> A bound metric which passes the dimension values it keeps to its metric. </summary>
+    class DimensionsBoundMetric : public BoundMetric {
+    public:
+
+        DimensionsBoundMetric(Metric* metric, size_t numberOfDimensions, const char* dimensionValues[]) :
+            _metric(metric),
+            _dimensionStrings(dimensionValues, dimensionValues + numberOfDimensions) {
+            for (const auto& value : _dimensionStrings) {
+                _dimensionValues.push_back(value.c_str());
+            }
+        }
+
+        bool Set(int64_t value) override {
+            return _metric->Set(value, _dimensionValues.size(), _dimensionValues.data());
+        }
+
+        bool Increment(uint64_t value) override {
+            return _metric->Increment(value, _dimensionValues.size(), _dimensionValues.data());
+        }
+
+        bool Decrement(uint64_t value) override {
+            return _metric->Decrement(value, _dimensionValues.size(), _dimensionValues.data());
+        }
+
+        void Destroy() override {
+            delete this;
+        }
+
+    private:
+        Metric* _metric;
+        std::vector<std::string> _dimensionStrings;
+        std::vector<const char*> _dimensionValues;
+    };
+
+    inline BoundMetric* Metric::Bind(size_t numberOfDimensions, const char* dimensionValues[]) {
+        for (size_t i = 0; i < numberOfDimensions; ++i) {
+            if (dimensionValues[i] == nullptr) {
+                return nullptr;
+            }
+        }
+        return new DimensionsBoundMetric(this, numberOfDimensions, dimensionValues);
+    }
+
+    /// <summary> Destroys a bound metric when it goes out of scope. </summary>
+    struct BoundMetricDeleter {
+        void operator()(BoundMetric* boundMetric) const {
+            boundMetric->Destroy();
+        }
+    };
+
+    typedef std::unique_ptr<BoundMetric, BoundMetricDeleter> BoundMetricPtr;
+
+    /// <summary> Binds dimension values of a metric, which may be nullptr, as providers may not return metrics. </summary>
+    inline BoundMetricPtr BindMetric(Metric* metric, size_t numberOfDimensions, const char* dimensionValues[]) {
+        return BoundMetricPtr(metric != nullptr ? metric->Bind(numberOfDimensions, dimensionValues) : nullptr);
+    }
+
     /// <summary> Interface for a generic metric provider. </summary>
     /// <remarks> 
     ///     Ownership of this metric provider belongs to the shared library which created it. Hence the explicit
@@ -116,9 +212,50 @@ namespace providers {
         virtual ~MetricProvider() = default;
     };
 
+    /// <summary> The values of a metric for one combination of dimension values. </summary>
+    struct MetricSeriesSnapshot {
+        std::vector<std::string> dimensionValues;
+
+        /// <summary> The value of a Number or Rate metric, the sum of the values set on a Percentile metric. </summary>
+        int64_t value;
+
+        /// <summary> The number of values set on a Percentile metric, and their min and max. </summary>
+        uint64_t count;
+        int64_t min;
+        int64_t max;
+
+        /// <summary> The values of a Percentile metric at the requested percentiles, in their order. </summary>
+        std::vector<int64_t> percentiles;
+    };
+
+    /// <summary> The values of a metric, for each combination of dimension values set so far. </summary>
+    struct MetricSnapshot {
+        std::string section;
+        std::string name;
+        MetricType type;
+        std::vector<std::string> dimensionNames;
+        std::vector<MetricSeriesSnapshot> series;
+    };
+
+    /// <summary> Interface of metric providers which keep metric values in process and can report them. </summary>
+    class MetricSnapshotProvider {
+    public:
+
+        /// <summary> Gets the values of all metrics, in the order they were created. </summary>
+        /// <param name="percentiles"> Percentiles in [0, 100] to report for Percentile metrics. </param>
+        virtual std::vector<MetricSnapshot> GetSnapshots(const std::vector<double>& percentiles) = 0;
+
+    protected:
+
+        virtual ~MetricSnapshotProvider() = default;
+    };
+
     /// <summary> Exports a getter function for retrieves the configured metric provider. </summary>
     NAPA_API MetricProvider& GetMetricProvider();
 
+    /// <summary> Gets the configured metric provider if it reports metric values, nullptr otherwise. </summary>
+    NAPA_API MetricSnapshotProvider* GetMetricSnapshotProvider();
+
     typedef MetricProvider* (*CreateMetricProvider)();
 }
 }
@@ -4,11 +4,17 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
 #include <deque>
 
 namespace napa {
     namespace stl {
         template <typename T>
         using Deque = std::deque<T, napa::stl::Allocator<T>>;
+
+        namespace pmr {
+            template <typename T>
+            using Deque = std::deque<T, napa::stl::PolymorphicAllocator<T>>;
+        }
     }
 }
@@ -4,12 +4,18 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
 #include <list>
 
 namespace napa {
     namespace stl {
         template <typename T>
         using List = std::list<T, napa::stl::Allocator<T>>;
+
+        namespace pmr {
+            template <typename T>
+            using List = std::list<T, napa::stl::PolymorphicAllocator<T>>;
+        }
     }
 }
 
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
 #include <map>
 
 namespace napa {
@@ -13,5 +14,13 @@ namespace napa {
         
         template <typename Key, typename T, typename Compare = std::less<Key>>
         using MultiMap = std::multimap<Key, T, Compare, napa::stl::Allocator<std::pair<const Key, T>>>;
+
+        namespace pmr {
+            template <typename Key, typename T, typename Compare = std::less<Key>>
+            using Map = std::map<Key, T, Compare, napa::stl::PolymorphicAllocator<std::pair<const Key, T>>>;
+
+            template <typename Key, typename T, typename Compare = std::less<Key>>
+            using MultiMap = std::multimap<Key, T, Compare, napa::stl::PolymorphicAllocator<std::pair<const Key, T>>>;
+        }
     }
 }
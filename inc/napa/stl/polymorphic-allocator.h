@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/memory/allocator.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace napa {
+namespace stl {
+
+    /// <summary> Allocator carrying a napa::memory::Allocator, which it passes on to the elements it constructs, like std::pmr::polymorphic_allocator.
+    /// Containers of napa::stl::pmr use it, so a container and the containers nested in it allocate from the same arena or pool.
+    /// </summary>
+    /// <remarks>
+    ///     Elements that use a compatible allocator, e.g. napa::stl::pmr containers, are constructed with it, and so are both
+    ///     members of pairs, i.e. the keys and values of maps. The allocator doesn't propagate on container assignment or swap,
+    ///     and a copy of a container gets the default allocator, as a copy may outlive the allocator of the original.
+    ///     The napa::memory::Allocator must outlive all containers using it.
+    /// </remarks>
+    template <typename T> class PolymorphicAllocator {
+    public:
+        typedef T value_type;
+
+        /// <summary> Constructor that uses NAPA_DEFAULT_ALLOCATOR. </summary>
+        PolymorphicAllocator() noexcept : _allocator(&napa::memory::GetDefaultAllocator()) {
+        }
+
+        /// <summary> Constructor that accepts a custom allocator, implicit so containers can be constructed from one. </summary>
+        PolymorphicAllocator(napa::memory::Allocator& allocator) noexcept : _allocator(&allocator) {
+        }
+
+        PolymorphicAllocator(const PolymorphicAllocator& other) = default;
+
+        template <typename U>
+        PolymorphicAllocator(const PolymorphicAllocator<U>& other) noexcept : _allocator(&other.GetAllocator()) {
+        }
+
+        /// <summary> Not assignable, the allocator of a container is fixed once it's constructed. </summary>
+        PolymorphicAllocator& operator=(const PolymorphicAllocator&) = delete;
+
+        T* allocate(size_t count) {
+            return static_cast<T*>(_allocator->Allocate(sizeof(T) * count));
+        }
+
+        void deallocate(T* p, size_t count) {
+            _allocator->Deallocate(p, sizeof(T) * count);
+        }
+
+        /// <summary> Constructs an element, passing this allocator on if the element uses a compatible one. </summary>
+        template <typename U, typename... Args>
+        void construct(U* p, Args&&... args) {
+            Construct(p, IsPair<U>(), std::forward<Args>(args)...);
+        }
+
+        template <typename U>
+        void destroy(U* p) {
+            p->~U();
+        }
+
+        /// <summary> A copy of a container gets the default allocator, as std::pmr containers do. </summary>
+        PolymorphicAllocator select_on_container_copy_construction() const {
+            return PolymorphicAllocator();
+        }
+
+        /// <summary> Gets the napa::memory::Allocator allocations come from. </summary>
+        napa::memory::Allocator& GetAllocator() const {
+            return *_allocator;
+        }
+
+    private:
+        template <typename U>
+        struct IsPair : std::false_type {};
+
+        template <typename T1, typename T2>
+        struct IsPair<std::pair<T1, T2>> : std::true_type {};
+
+        /// <summary> How an element is constructed with the allocator: 0 without it, 1 with it last, 2 with allocator_arg first. </summary>
+        template <typename U, typename... Args>
+        using UsesAllocator = std::integral_constant<int,
+            !std::uses_allocator<U, PolymorphicAllocator>::value ? 0 :
+            std::is_constructible<U, std::allocator_arg_t, const PolymorphicAllocator&, Args...>::value ? 2 :
+            std::is_constructible<U, Args..., const PolymorphicAllocator&>::value ? 1 : 0>;
+
+        template <typename U, typename... Args>
+        void Construct(U* p, std::false_type, Args&&... args) {
+            ConstructWith(UsesAllocator<U, Args...>(), p, std::forward<Args>(args)...);
+        }
+
+        template <typename U, typename... Args>
+        void ConstructWith(std::integral_constant<int, 0>, U* p, Args&&... args) {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        template <typename U, typename... Args>
+        void ConstructWith(std::integral_constant<int, 1>, U* p, Args&&... args) {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)..., *this);
+        }
+
+        template <typename U, typename... Args>
+        void ConstructWith(std::integral_constant<int, 2>, U* p, Args&&... args) {
+            ::new (static_cast<void*>(p)) U(std::allocator_arg, *this, std::forward<Args>(args)...);
+        }
+
+        /// <summary> Pairs are constructed piecewise, so each member gets the allocator if it uses one. </summary>
+        template <typename T1, typename T2, typename... Args1, typename... Args2>
+        void Construct(std::pair<T1, T2>* p, std::true_type, std::piecewise_construct_t, std::tuple<Args1...> first, std::tuple<Args2...> second) {
+            ::new (static_cast<void*>(p)) std::pair<T1, T2>(std::piecewise_construct,
+                WithAllocator<T1>(UsesAllocator<T1, Args1...>(), std::move(first)),
+                WithAllocator<T2>(UsesAllocator<T2, Args2...>(), std::move(second)));
+        }
+
+        template <typename T1, typename T2>
+        void Construct(std::pair<T1, T2>* p, std::true_type) {
+            Construct(p, std::true_type(), std::piecewise_construct, std::tuple<>(), std::tuple<>());
+        }
+
+        template <typename T1, typename T2, typename U1, typename U2>
+        void Construct(std::pair<T1, T2>* p, std::true_type, U1&& first, U2&& second) {
+            Construct(p, std::true_type(), std::piecewise_construct,
+                std::forward_as_tuple(std::forward<U1>(first)),
+                std::forward_as_tuple(std::forward<U2>(second)));
+        }
+
+        template <typename T1, typename T2, typename U1, typename U2>
+        void Construct(std::pair<T1, T2>* p, std::true_type, const std::pair<U1, U2>& other) {
+            Construct(p, std::true_type(), std::piecewise_construct,
+                std::forward_as_tuple(other.first),
+                std::forward_as_tuple(other.second));
+        }
+
+        template <typename T1, typename T2, typename U1, typename U2>
+        void Construct(std::pair<T1, T2>* p, std::true_type, std::pair<U1, U2>&& other) {
+            Construct(p, std::true_type(), std::piecewise_construct,
+                std::forward_as_tuple(std::forward<U1>(other.first)),
+                std::forward_as_tuple(std::forward<U2>(other.second)));
+        }
+
+        template <typename U, typename... Args>
+        std::tuple<Args...> WithAllocator(std::integral_constant<int, 0>, std::tuple<Args...>&& args) {
+            return std::move(args);
+        }
+
+        template <typename U, typename... Args>
+        std::tuple<Args..., const PolymorphicAllocator&> WithAllocator(std::integral_constant<int, 1>, std::tuple<Args...>&& args) {
+            return std::tuple_cat(std::move(args), std::tuple<const PolymorphicAllocator&>(*this));
+        }
+
+        template <typename U, typename... Args>
+        std::tuple<std::allocator_arg_t, const PolymorphicAllocator&, Args...> WithAllocator(std::integral_constant<int, 2>, std::tuple<Args...>&& args) {
+            return std::tuple_cat(std::tuple<std::allocator_arg_t, const PolymorphicAllocator&>(std::allocator_arg, *this), std::move(args));
+        }
+
+        napa::memory::Allocator* _allocator;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const PolymorphicAllocator<T>& left, const PolymorphicAllocator<U>& right) {
+        return left.GetAllocator() == right.GetAllocator();
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const PolymorphicAllocator<T>& left, const PolymorphicAllocator<U>& right) {
+        return !(left == right);
+    }
+}
+}
@@ -4,7 +4,10 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
+#include <deque>
 #include <queue>
+#include <vector>
 
 namespace napa {
     namespace stl {
@@ -13,5 +16,13 @@ namespace napa {
 
         template <typename T>
         using PriorityQueue = std::priority_queue<T, std::vector<T, napa::stl::Allocator<T>>>;
+
+        namespace pmr {
+            template <typename T>
+            using Queue = std::queue<T, std::deque<T, napa::stl::PolymorphicAllocator<T>>>;
+
+            template <typename T>
+            using PriorityQueue = std::priority_queue<T, std::vector<T, napa::stl::PolymorphicAllocator<T>>>;
+        }
     }
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
 #include <set>
 
 namespace napa {
@@ -13,5 +14,13 @@ namespace napa {
 
         template <typename Key, typename Compare = std::less<Key>>
         using MultiSet = std::multiset<Key, Compare, napa::stl::Allocator<Key>>;
+
+        namespace pmr {
+            template <typename Key, typename Compare = std::less<Key>>
+            using Set = std::set<Key, Compare, napa::stl::PolymorphicAllocator<Key>>;
+
+            template <typename Key, typename Compare = std::less<Key>>
+            using MultiSet = std::multiset<Key, Compare, napa::stl::PolymorphicAllocator<Key>>;
+        }
     }
 }
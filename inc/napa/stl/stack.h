@@ -4,11 +4,18 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
+#include <deque>
 #include <stack>
 
 namespace napa {
     namespace stl {
         template <typename T>
-        using Stack = std::priority_queue<T, std::deque<T, napa::stl::Allocator<T>>>;
+        using Stack = std::stack<T, std::deque<T, napa::stl::Allocator<T>>>;
+
+        namespace pmr {
+            template <typename T>
+            using Stack = std::stack<T, std::deque<T, napa::stl::PolymorphicAllocator<T>>>;
+        }
     }
 }
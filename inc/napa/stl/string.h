@@ -4,6 +4,7 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
 #include <string>
 
 namespace napa {
@@ -12,6 +13,13 @@ namespace napa {
         using BasicString = std::basic_string<CharT, Traits, napa::stl::Allocator<CharT>>;
 
         typedef BasicString<char> String;
+
+        namespace pmr {
+            template <typename CharT, typename Traits = std::char_traits<CharT>>
+            using BasicString = std::basic_string<CharT, Traits, napa::stl::PolymorphicAllocator<CharT>>;
+
+            typedef BasicString<char> String;
+        }
     }
 }
 
@@ -29,6 +37,18 @@ namespace std {
     template<>
     struct __is_fast_hash<hash<napa::stl::String>> : std::false_type {
     };
+
+    // std::hash specialization for napa::stl::pmr::String.
+    template<>
+    struct hash<napa::stl::pmr::String> : public __hash_base<size_t, napa::stl::pmr::String> {
+        size_t operator()(const napa::stl::pmr::String& s) const noexcept {
+            return std::_Hash_impl::hash(s.data(), s.length());
+        }
+    };
+
+    template<>
+    struct __is_fast_hash<hash<napa::stl::pmr::String>> : std::false_type {
+    };
 }
 
 #endif
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
 #include <unordered_set>
 
 namespace napa {
@@ -11,15 +12,31 @@ namespace napa {
         template <
             typename Key, 
             typename Hash = std::hash<Key>,
-            typename KeyEqual = std::equal_to<Key>,
+            typename KeyEqual = std::equal_to<Key>
         >
         using UnorderedSet = std::unordered_set<Key, Hash, KeyEqual, napa::stl::Allocator<Key>>;
 
         template <
             typename Key, 
             typename Hash = std::hash<Key>,
-            typename KeyEqual = std::equal_to<Key>,
+            typename KeyEqual = std::equal_to<Key>
         >
         using UnorderedMultiSet = std::unordered_multiset<Key, Hash, KeyEqual, napa::stl::Allocator<Key>>;
+
+        namespace pmr {
+            template <
+                typename Key, 
+                typename Hash = std::hash<Key>,
+                typename KeyEqual = std::equal_to<Key>
+            >
+            using UnorderedSet = std::unordered_set<Key, Hash, KeyEqual, napa::stl::PolymorphicAllocator<Key>>;
+
+            template <
+                typename Key, 
+                typename Hash = std::hash<Key>,
+                typename KeyEqual = std::equal_to<Key>
+            >
+            using UnorderedMultiSet = std::unordered_multiset<Key, Hash, KeyEqual, napa::stl::PolymorphicAllocator<Key>>;
+        }
     }
 }
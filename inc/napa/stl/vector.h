@@ -4,11 +4,17 @@
 #pragma once
 
 #include <napa/stl/allocator.h>
+#include <napa/stl/polymorphic-allocator.h>
 #include <vector>
 
 namespace napa {
     namespace stl {
         template <typename T>
         using Vector = std::vector<T, napa::stl::Allocator<T>>;
+
+        namespace pmr {
+            template <typename T>
+            using Vector = std::vector<T, napa::stl::PolymorphicAllocator<T>>;
+        }
     }
 }
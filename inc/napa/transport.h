@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <napa/transport/codec.h>
 #include <napa/transport/transport-context.h>
 #include <napa/transport/transportable.h>
 #include <napa/transport/transport.h>
+#include <napa/transport/v8-codec.h>
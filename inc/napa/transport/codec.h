@@ -0,0 +1,700 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// <summary>
+///     Lists the fields of a struct for napa::transport::Codec, at global scope after the struct is defined, e.g.
+///     NAPA_CODEC(Point, x, y, label). Fields are any codec type: bool, numbers, std::string, std::vector and other
+///     structs listed by NAPA_CODEC, up to 16 fields per struct.
+/// </summary>
+#define NAPA_CODEC(Type, ...)                                                                        \
+    namespace napa {                                                                                 \
+    namespace transport {                                                                            \
+        template <>                                                                                  \
+        struct CodecFields<Type> {                                                                   \
+            static constexpr bool REFLECTED = true;                                                  \
+            template <typename Value, typename Visitor>                                              \
+            static bool Visit(Value& value, Visitor&& visitor) {                                     \
+                return NAPA_CODEC_FOR_EACH(NAPA_CODEC_VISIT_FIELD, __VA_ARGS__) true;                \
+            }                                                                                        \
+        };                                                                                           \
+    }                                                                                                \
+    }
+
+#define NAPA_CODEC_VISIT_FIELD(field) visitor(#field, value.field) &&
+
+#define NAPA_CODEC_EXPAND(x) x
+#define NAPA_CODEC_FOR_EACH_1(macro, field) macro(field)
+#define NAPA_CODEC_FOR_EACH_2(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_1(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_3(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_2(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_4(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_3(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_5(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_4(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_6(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_5(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_7(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_6(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_8(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_7(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_9(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_8(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_10(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_9(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_11(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_10(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_12(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_11(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_13(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_12(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_14(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_13(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_15(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_14(macro, __VA_ARGS__))
+#define NAPA_CODEC_FOR_EACH_16(macro, field, ...) macro(field) NAPA_CODEC_EXPAND(NAPA_CODEC_FOR_EACH_15(macro, __VA_ARGS__))
+#define NAPA_CODEC_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, name, ...) name
+#define NAPA_CODEC_FOR_EACH(macro, ...) \
+    NAPA_CODEC_EXPAND(NAPA_CODEC_PICK(__VA_ARGS__, NAPA_CODEC_FOR_EACH_16, NAPA_CODEC_FOR_EACH_15, NAPA_CODEC_FOR_EACH_14, NAPA_CODEC_FOR_EACH_13, NAPA_CODEC_FOR_EACH_12, NAPA_CODEC_FOR_EACH_11, NAPA_CODEC_FOR_EACH_10, NAPA_CODEC_FOR_EACH_9, NAPA_CODEC_FOR_EACH_8, NAPA_CODEC_FOR_EACH_7, NAPA_CODEC_FOR_EACH_6, NAPA_CODEC_FOR_EACH_5, NAPA_CODEC_FOR_EACH_4, NAPA_CODEC_FOR_EACH_3, NAPA_CODEC_FOR_EACH_2, NAPA_CODEC_FOR_EACH_1)(macro, __VA_ARGS__))
+
+namespace napa {
+namespace transport {
+
+    /// <summary> Fields of a struct, listed by NAPA_CODEC. </summary>
+    template <typename T>
+    struct CodecFields {
+        static constexpr bool REFLECTED = false;
+    };
+
+    /// <summary> Why a value doesn't match a codec type, and where. </summary>
+    struct CodecError {
+        /// <summary> What was expected, e.g. "Expected a number". </summary>
+        std::string reason;
+
+        /// <summary> Path of the mismatched member from the root value, e.g. "points[2].x", empty for the root. </summary>
+        std::string path;
+
+        /// <summary> Adds the field name or the "[index]" of the containing value in front of the path. </summary>
+        void AddParent(std::string segment) {
+            if (!path.empty() && path[0] != '[') {
+                segment += '.';
+            }
+            path = segment + path;
+        }
+
+        std::string Message() const {
+            return path.empty() ? reason : reason + " at '" + path + "'";
+        }
+    };
+
+    /// <summary>
+    ///     Writes values in V8 structured clone format, the binary transport format, without V8.
+    ///     Only the subset codec types need is written: booleans, numbers, strings, dense arrays and plain objects.
+    /// </summary>
+    class BinaryWriter {
+    public:
+        /// <summary> Structured clone format version written, which V8 6.x and later read. </summary>
+        static constexpr uint32_t FORMAT_VERSION = 13;
+
+        explicit BinaryWriter(std::string& buffer) : _buffer(buffer) {}
+
+        /// <summary> Writes the header of a binary payload: the format version, then payload flags. </summary>
+        void WriteHeader(uint32_t flags) {
+            _buffer.push_back(static_cast<char>(0xFF));
+            WriteVarint(FORMAT_VERSION);
+            WriteVarint(flags);
+        }
+
+        void WriteBoolean(bool value) {
+            _buffer.push_back(value ? 'T' : 'F');
+        }
+
+        /// <summary> Writes a number, as a small integer like V8 writes Smis when it's one. </summary>
+        void WriteNumber(double value) {
+            if (value >= -2147483648.0 && value <= 2147483647.0 && std::floor(value) == value
+                && !(value == 0 && std::signbit(value))) {
+                auto integer = static_cast<int32_t>(value);
+                _buffer.push_back('I');
+                WriteVarint((static_cast<uint32_t>(integer) << 1) ^ static_cast<uint32_t>(integer >> 31));
+                return;
+            }
+            char bytes[sizeof(double)];
+            std::memcpy(bytes, &value, sizeof(double));
+            _buffer.push_back('N');
+            _buffer.append(bytes, sizeof(double));
+        }
+
+        /// <summary> Writes a UTF-8 string, ASCII ones as one-byte strings like V8 does. </summary>
+        void WriteString(const char* data, size_t length) {
+            bool ascii = true;
+            for (size_t i = 0; i < length && ascii; ++i) {
+                ascii = static_cast<unsigned char>(data[i]) < 0x80;
+            }
+            _buffer.push_back(ascii ? '"' : 'S');
+            WriteVarint(length);
+            _buffer.append(data, length);
+        }
+
+        void BeginObject() {
+            _buffer.push_back('o');
+        }
+
+        void EndObject(uint32_t properties) {
+            _buffer.push_back('{');
+            WriteVarint(properties);
+        }
+
+        void BeginArray(uint32_t length) {
+            _buffer.push_back('A');
+            WriteVarint(length);
+        }
+
+        void EndArray(uint32_t length) {
+            _buffer.push_back('$');
+            WriteVarint(0);
+            WriteVarint(length);
+        }
+
+    private:
+        void WriteVarint(uint64_t value) {
+            do {
+                auto byte = static_cast<uint8_t>(value & 0x7F);
+                value >>= 7;
+                _buffer.push_back(static_cast<char>(value != 0 ? (byte | 0x80) : byte));
+            } while (value != 0);
+        }
+
+        std::string& _buffer;
+    };
+
+    /// <summary>
+    ///     Reads values in V8 structured clone format without V8, as written by v8::ValueSerializer or BinaryWriter.
+    ///     Values outside the subset of BinaryWriter, e.g. Maps, typed arrays and references, fail to read.
+    /// </summary>
+    class BinaryReader {
+    public:
+        BinaryReader(const uint8_t* data, size_t size) : _position(data), _end(data + size) {}
+
+        /// <summary> Reads the header of a binary payload. </summary>
+        bool ReadHeader(uint32_t& flags) {
+            uint64_t version = 0;
+            uint64_t value = 0;
+            if (_position == _end || *_position++ != 0xFF || !ReadVarint(version) || !ReadVarint(value)) {
+                return false;
+            }
+            flags = static_cast<uint32_t>(value);
+            return true;
+        }
+
+        bool AtEnd() const {
+            return _position == _end;
+        }
+
+        /// <summary> Gets the tag of the next value without reading it, skipping padding. </summary>
+        bool PeekTag(char& tag) {
+            while (_position != _end) {
+                if (*_position == '\0') {
+                    // Padding, which V8 writes to align two-byte strings.
+                    ++_position;
+                } else if (*_position == '?') {
+                    // Object count verification, written by older V8 and ignored.
+                    uint64_t count = 0;
+                    ++_position;
+                    if (!ReadVarint(count)) {
+                        return false;
+                    }
+                } else {
+                    tag = static_cast<char>(*_position);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool ReadTag(char& tag) {
+            if (!PeekTag(tag)) {
+                return false;
+            }
+            ++_position;
+            return true;
+        }
+
+        bool ReadBoolean(bool& value) {
+            char tag = 0;
+            if (!PeekTag(tag) || (tag != 'T' && tag != 'F')) {
+                return false;
+            }
+            ++_position;
+            value = tag == 'T';
+            return true;
+        }
+
+        /// <summary> Reads a number written as an int32, a uint32 or a double. </summary>
+        bool ReadNumber(double& value) {
+            char tag = 0;
+            if (!PeekTag(tag) || (tag != 'I' && tag != 'U' && tag != 'N')) {
+                return false;
+            }
+            ++_position;
+
+            if (tag == 'N') {
+                if (static_cast<size_t>(_end - _position) < sizeof(double)) {
+                    return false;
+                }
+                std::memcpy(&value, _position, sizeof(double));
+                _position += sizeof(double);
+                return true;
+            }
+
+            uint64_t varint = 0;
+            if (!ReadVarint(varint)) {
+                return false;
+            }
+            auto bits = static_cast<uint32_t>(varint);
+            value = tag == 'U'
+                ? static_cast<double>(bits)
+                : static_cast<double>(static_cast<int32_t>((bits >> 1) ^ (0 - (bits & 1))));
+            return true;
+        }
+
+        /// <summary> Reads a one-byte, two-byte or UTF-8 string into UTF-8. </summary>
+        bool ReadString(std::string& value) {
+            char tag = 0;
+            if (!PeekTag(tag) || (tag != '"' && tag != 'c' && tag != 'S')) {
+                return false;
+            }
+            ++_position;
+
+            uint64_t length = 0;
+            if (!ReadVarint(length) || length > static_cast<uint64_t>(_end - _position)) {
+                return false;
+            }
+            auto data = _position;
+            _position += length;
+
+            value.clear();
+            if (tag == 'S') {
+                value.assign(reinterpret_cast<const char*>(data), static_cast<size_t>(length));
+            } else if (tag == '"') {
+                // Latin-1.
+                value.reserve(static_cast<size_t>(length));
+                for (uint64_t i = 0; i < length; ++i) {
+                    AppendUtf8(value, data[i]);
+                }
+            } else {
+                // UTF-16, little-endian.
+                if (length % 2 != 0) {
+                    return false;
+                }
+                value.reserve(static_cast<size_t>(length));
+                for (uint64_t i = 0; i < length; i += 2) {
+                    uint32_t unit = data[i] | (data[i + 1] << 8);
+                    if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < length) {
+                        uint32_t low = data[i + 2] | (data[i + 3] << 8);
+                        if (low >= 0xDC00 && low < 0xE000) {
+                            unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                            i += 2;
+                        }
+                    }
+                    AppendUtf8(value, unit);
+                }
+            }
+            return true;
+        }
+
+        /// <summary> Reads a property key, integer keys in decimal like JavaScript names them. </summary>
+        bool ReadKey(std::string& key) {
+            char tag = 0;
+            if (!PeekTag(tag)) {
+                return false;
+            }
+            if (tag == 'I' || tag == 'U' || tag == 'N') {
+                double number = 0;
+                if (!ReadNumber(number) || std::floor(number) != number || number < 0 || number >= 9007199254740992.0) {
+                    return false;
+                }
+                key = std::to_string(static_cast<uint64_t>(number));
+                return true;
+            }
+            return ReadString(key);
+        }
+
+        /// <summary> Reads the end of an object, if it's next. </summary>
+        bool TryReadObjectEnd(bool& end) {
+            char tag = 0;
+            if (!PeekTag(tag)) {
+                return false;
+            }
+            end = tag == '{';
+            if (end) {
+                uint64_t properties = 0;
+                ++_position;
+                return ReadVarint(properties);
+            }
+            return true;
+        }
+
+        /// <summary> Reads the beginning of an array, dense or sparse. </summary>
+        bool ReadArrayBegin(uint32_t& length, bool& dense) {
+            char tag = 0;
+            uint64_t value = 0;
+            if (!PeekTag(tag) || (tag != 'A' && tag != 'a')) {
+                return false;
+            }
+            ++_position;
+            if (!ReadVarint(value) || value > std::numeric_limits<uint32_t>::max()) {
+                return false;
+            }
+            length = static_cast<uint32_t>(value);
+            dense = tag == 'A';
+            return true;
+        }
+
+        /// <summary>
+        ///     Reads the end of an array, if it's next. Properties other than elements, and elements of sparse arrays,
+        ///     come before it as key and value pairs.
+        /// </summary>
+        bool TryReadArrayEnd(bool dense, bool& end) {
+            char tag = 0;
+            if (!PeekTag(tag)) {
+                return false;
+            }
+            end = tag == (dense ? '$' : '@');
+            if (end) {
+                uint64_t properties = 0;
+                uint64_t length = 0;
+                ++_position;
+                return ReadVarint(properties) && ReadVarint(length);
+            }
+            return true;
+        }
+
+        /// <summary> Skips a value, e.g. of a property no field is listed for. </summary>
+        bool SkipValue() {
+            char tag = 0;
+            if (!PeekTag(tag)) {
+                return false;
+            }
+            switch (tag) {
+                case '_': case '0': case 'T': case 'F': case '-': {
+                    ++_position;
+                    return true;
+                }
+                case 'I': case 'U': case 'N': {
+                    double number = 0;
+                    return ReadNumber(number);
+                }
+                case '"': case 'c': case 'S': {
+                    std::string string;
+                    return ReadString(string);
+                }
+                case 'o': {
+                    ++_position;
+                    for (bool end = false; ; ) {
+                        if (!TryReadObjectEnd(end)) {
+                            return false;
+                        }
+                        if (end) {
+                            return true;
+                        }
+                        if (!SkipValue() || !SkipValue()) {
+                            return false;
+                        }
+                    }
+                }
+                case 'A': case 'a': {
+                    uint32_t length = 0;
+                    bool dense = false;
+                    if (!ReadArrayBegin(length, dense)) {
+                        return false;
+                    }
+                    for (uint32_t i = 0; dense && i < length; ++i) {
+                        if (!SkipValue()) {
+                            return false;
+                        }
+                    }
+                    for (bool end = false; ; ) {
+                        if (!TryReadArrayEnd(dense, end)) {
+                            return false;
+                        }
+                        if (end) {
+                            return true;
+                        }
+                        if (!SkipValue() || !SkipValue()) {
+                            return false;
+                        }
+                    }
+                }
+                default:
+                    return false;
+            }
+        }
+
+        /// <summary> Number of bytes left, which bounds the elements an array can have. </summary>
+        size_t Remaining() const {
+            return static_cast<size_t>(_end - _position);
+        }
+
+    private:
+        bool ReadVarint(uint64_t& value) {
+            value = 0;
+            for (uint32_t shift = 0; _position != _end && shift < 64; shift += 7) {
+                auto byte = *_position++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static void AppendUtf8(std::string& target, uint32_t codePoint) {
+            if (codePoint < 0x80) {
+                target.push_back(static_cast<char>(codePoint));
+            } else if (codePoint < 0x800) {
+                target.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                target.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            } else if (codePoint < 0x10000) {
+                target.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                target.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                target.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            } else {
+                target.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                target.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                target.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                target.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        const uint8_t* _position;
+        const uint8_t* _end;
+    };
+
+    namespace detail {
+
+        /// <summary> Converts a JavaScript number to an arithmetic type, integers only if the number is one in range. </summary>
+        template <typename T>
+        inline bool NumberTo(double number, T& value, CodecError& error) {
+            if (std::is_floating_point<T>::value) {
+                value = static_cast<T>(number);
+                return true;
+            }
+            // Bounds are powers of 2, which doubles hold exactly, unlike the max of 64-bit integers.
+            auto upper = std::ldexp(1.0, std::numeric_limits<T>::digits);
+            auto lower = std::is_signed<T>::value ? -upper : 0.0;
+            if (!(std::floor(number) == number && number >= lower && number < upper)) {
+                error.reason = "Expected an integer in range of the field";
+                return false;
+            }
+            value = static_cast<T>(number);
+            return true;
+        }
+
+        inline bool Fail(CodecError& error, const char* reason) {
+            error.reason = reason;
+            return false;
+        }
+    }
+
+    /// <summary>
+    ///     Encodes and decodes a C++ type in binary transport format, generated at compile time from the type.
+    ///     The primary template handles structs listed by NAPA_CODEC, as JavaScript objects of their fields.
+    /// </summary>
+    template <typename T, typename Enable = void>
+    struct Codec {
+        static_assert(CodecFields<T>::REFLECTED, "List the fields of the type with NAPA_CODEC(Type, fields...)");
+
+        static void Write(BinaryWriter& writer, const T& value) {
+            uint32_t properties = 0;
+            writer.BeginObject();
+            CodecFields<T>::Visit(value, [&](const char* name, const auto& field) {
+                writer.WriteString(name, std::strlen(name));
+                Codec<typename std::decay<decltype(field)>::type>::Write(writer, field);
+                ++properties;
+                return true;
+            });
+            writer.EndObject(properties);
+        }
+
+        /// <summary> Reads the fields of an object, properties of no field are skipped and missing fields are kept. </summary>
+        static bool Read(BinaryReader& reader, T& value, CodecError& error) {
+            char tag = 0;
+            if (!reader.ReadTag(tag) || tag != 'o') {
+                return detail::Fail(error, "Expected an object");
+            }
+            std::string key;
+            for (bool end = false; ; ) {
+                if (!reader.TryReadObjectEnd(end) || (!end && !reader.ReadKey(key))) {
+                    return detail::Fail(error, "Invalid binary payload");
+                }
+                if (end) {
+                    return true;
+                }
+
+                bool found = false;
+                bool read = true;
+                CodecFields<T>::Visit(value, [&](const char* name, auto& field) {
+                    if (key != name) {
+                        return true;
+                    }
+                    found = true;
+                    read = Codec<typename std::decay<decltype(field)>::type>::Read(reader, field, error);
+                    if (!read) {
+                        error.AddParent(name);
+                    }
+                    return false;
+                });
+                if (!read) {
+                    return false;
+                }
+                if (!found && !reader.SkipValue()) {
+                    return detail::Fail(error, "Invalid binary payload");
+                }
+            }
+        }
+    };
+
+    template <>
+    struct Codec<bool> {
+        static void Write(BinaryWriter& writer, bool value) {
+            writer.WriteBoolean(value);
+        }
+
+        static bool Read(BinaryReader& reader, bool& value, CodecError& error) {
+            return reader.ReadBoolean(value) || detail::Fail(error, "Expected a boolean");
+        }
+    };
+
+    /// <summary> Numbers, which JavaScript holds as doubles, thus 64-bit integers beyond 2^53 lose precision. </summary>
+    template <typename T>
+    struct Codec<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type> {
+        static void Write(BinaryWriter& writer, T value) {
+            writer.WriteNumber(static_cast<double>(value));
+        }
+
+        static bool Read(BinaryReader& reader, T& value, CodecError& error) {
+            double number = 0;
+            if (!reader.ReadNumber(number)) {
+                return detail::Fail(error, "Expected a number");
+            }
+            return detail::NumberTo(number, value, error);
+        }
+    };
+
+    template <>
+    struct Codec<std::string> {
+        static void Write(BinaryWriter& writer, const std::string& value) {
+            writer.WriteString(value.data(), value.size());
+        }
+
+        static bool Read(BinaryReader& reader, std::string& value, CodecError& error) {
+            return reader.ReadString(value) || detail::Fail(error, "Expected a string");
+        }
+    };
+
+    /// <summary> Arrays, whose elements must all be present when read. </summary>
+    template <typename T>
+    struct Codec<std::vector<T>> {
+        static void Write(BinaryWriter& writer, const std::vector<T>& value) {
+            auto length = static_cast<uint32_t>(value.size());
+            writer.BeginArray(length);
+            for (const auto& element : value) {
+                Codec<T>::Write(writer, element);
+            }
+            writer.EndArray(length);
+        }
+
+        static bool Read(BinaryReader& reader, std::vector<T>& value, CodecError& error) {
+            uint32_t length = 0;
+            bool dense = false;
+            if (!reader.ReadArrayBegin(length, dense)) {
+                return detail::Fail(error, "Expected an array");
+            }
+            // Each element takes a byte at least, which stops a corrupted length from allocating.
+            if (length > reader.Remaining()) {
+                return detail::Fail(error, "Invalid binary payload");
+            }
+            value.clear();
+            value.resize(length);
+
+            // Sparse arrays, which V8 writes for arrays that had holes, list elements as index and value pairs.
+            uint32_t elements = 0;
+            std::string key;
+            for (bool end = false; ; ) {
+                uint32_t index = elements;
+                if (dense && elements < length) {
+                    ++elements;
+                } else {
+                    if (!reader.TryReadArrayEnd(dense, end) || (!end && !reader.ReadKey(key))) {
+                        return detail::Fail(error, "Invalid binary payload");
+                    }
+                    if (end) {
+                        break;
+                    }
+                    char* keyEnd = nullptr;
+                    auto parsed = std::strtoull(key.c_str(), &keyEnd, 10);
+                    if (dense || key.empty() || *keyEnd != '\0' || parsed >= length) {
+                        // Not an element, e.g. a property set on the array.
+                        if (!reader.SkipValue()) {
+                            return detail::Fail(error, "Invalid binary payload");
+                        }
+                        continue;
+                    }
+                    index = static_cast<uint32_t>(parsed);
+                    ++elements;
+                }
+
+                // Elements are read through a local, which std::vector<bool> needs.
+                T element = T();
+                if (!Codec<T>::Read(reader, element, error)) {
+                    error.AddParent("[" + std::to_string(index) + "]");
+                    return false;
+                }
+                value[index] = std::move(element);
+            }
+            if (elements != length) {
+                return detail::Fail(error, "Expected an array without holes");
+            }
+            return true;
+        }
+    };
+
+    /// <summary> Encodes a value into a binary payload, as TransportOption.BINARY passes arguments and results. </summary>
+    template <typename T>
+    inline void EncodeBinary(const T& value, std::string& payload) {
+        payload.clear();
+        BinaryWriter writer(payload);
+        writer.WriteHeader(0);
+        Codec<T>::Write(writer, value);
+    }
+
+    template <typename T>
+    inline std::string EncodeBinary(const T& value) {
+        std::string payload;
+        EncodeBinary(value, payload);
+        return payload;
+    }
+
+    /// <summary> Decodes a value from a binary payload, e.g. a result of a call with TransportOption.BINARY. </summary>
+    /// <returns> False with the error if the payload doesn't hold a value of the type. </returns>
+    template <typename T>
+    inline bool DecodeBinary(const uint8_t* data, size_t size, T& value, CodecError& error) {
+        error = CodecError();
+        BinaryReader reader(data, size);
+        uint32_t flags = 0;
+        if (!reader.ReadHeader(flags)) {
+            error.reason = "Invalid binary payload";
+            return false;
+        }
+        if (flags != 0) {
+            // Transportable objects were replaced by payloads only transport in JavaScript revives.
+            error.reason = "Binary payload has transportable objects";
+            return false;
+        }
+        return Codec<T>::Read(reader, value, error);
+    }
+
+    template <typename T>
+    inline bool DecodeBinary(const std::string& payload, T& value, CodecError& error) {
+        return DecodeBinary(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), value, error);
+    }
+}
+}
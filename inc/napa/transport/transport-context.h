@@ -18,20 +18,37 @@ namespace transport {
     ///
     /// At this time, only transport std::shared_ptr is supported of transfering ownership. 
     /// </summary>
+    /// <remarks>
+    ///     Most calls carry none or few shared pointers, which are kept inline without any allocation.
+    ///     The context switches to a hash map only beyond INLINE_CAPACITY entries, which may come from a given allocator.
+    /// </remarks>
     class TransportContext {
 
     public:
+        /// <summary> Number of shared pointers kept inline before switching to a hash map. </summary>
+        static constexpr size_t INLINE_CAPACITY = 4;
+
         /// <summary> Default constructor. </summary>
-        TransportContext() = default;
+        TransportContext() : _inlineCount(0) {
+        }
+
+        /// <summary> Constructor whose hash map allocates from an allocator, e.g. the call arena. </summary>
+        /// <remarks> The allocator must outlive the context. Moving to another context moves entries into the allocator of the latter. </remarks>
+        explicit TransportContext(napa::memory::Allocator& allocator) : _inlineCount(0), _sharedDepot(allocator) {
+        }
 
         /// <summary> Move constructor. </summary>
         TransportContext(TransportContext&& other) 
-            : _sharedDepot(std::move(other._sharedDepot)) {
+            : _inlineCount(0) {
+            MoveFrom(other);
         }
 
         /// <summary> Move assignment. </summary>
         TransportContext& operator=(TransportContext&& other) {
-            _sharedDepot = std::move(other._sharedDepot);
+            if (this != &other) {
+                Clear();
+                MoveFrom(other);
+            }
             return *this;
         }
 
@@ -43,7 +60,22 @@ namespace transport {
         /// <param name="pointer"> Shared pointer to transfer ownership to another isolate. </param>
         template <typename T>
         void SaveShared(std::shared_ptr<T> pointer) {
-            _sharedDepot[reinterpret_cast<uintptr_t>(pointer.get())] = std::move(pointer);
+            auto handle = reinterpret_cast<uintptr_t>(pointer.get());
+            Save(handle, std::move(pointer));
+        }
+
+        /// <summary> It saves all shared pointers of another context, e.g. to forward a payload marshalled with it. </summary>
+        /// <param name="other"> Transport context to save shared pointers from, which keeps them as well. </param>
+        void SaveAll(const TransportContext& other) {
+            if (&other == this) {
+                return;
+            }
+            for (size_t i = 0; i < other._inlineCount; ++i) {
+                Save(other._inlineDepot[i].first, other._inlineDepot[i].second);
+            }
+            for (auto& entry : other._sharedDepot) {
+                Save(entry.first, entry.second);
+            }
         }
 
         /// <summary> It loads a previously saved shared pointer. </summary>
@@ -51,23 +83,82 @@ namespace transport {
         /// <returns> shared_ptr for requested handle, or empty shared_ptr if not found. </returns>
         template <typename T>
         std::shared_ptr<T> LoadShared(uintptr_t handle) {
-            auto it = _sharedDepot.find(handle);
-            if (it != _sharedDepot.end()) {
-                return std::static_pointer_cast<T>(it->second);
+            for (size_t i = 0; i < _inlineCount; ++i) {
+                if (_inlineDepot[i].first == handle) {
+                    return std::static_pointer_cast<T>(_inlineDepot[i].second);
+                }
+            }
+
+            if (!_sharedDepot.empty()) {
+                auto it = _sharedDepot.find(handle);
+                if (it != _sharedDepot.end()) {
+                    return std::static_pointer_cast<T>(it->second);
+                }
             }
             return std::shared_ptr<T>();
         }
 
         /// <summary> Get count of saved shared_ptr. </summary> 
-        uint32_t GetSharedCount() {
-            return static_cast<uint32_t>(_sharedDepot.size());
+        uint32_t GetSharedCount() const {
+            return static_cast<uint32_t>(_inlineCount + _sharedDepot.size());
         }
 
     private:
+        /// <summary> Saves a shared pointer by its handle, replacing the pointer saved with the same handle if any. </summary>
+        void Save(uintptr_t handle, std::shared_ptr<void> pointer) {
+            if (_sharedDepot.empty()) {
+                for (size_t i = 0; i < _inlineCount; ++i) {
+                    if (_inlineDepot[i].first == handle) {
+                        _inlineDepot[i].second = std::move(pointer);
+                        return;
+                    }
+                }
+                if (_inlineCount < INLINE_CAPACITY) {
+                    _inlineDepot[_inlineCount].first = handle;
+                    _inlineDepot[_inlineCount].second = std::move(pointer);
+                    ++_inlineCount;
+                    return;
+                }
+
+                // Spill inline entries, the hash map keeps all entries from now on.
+                for (size_t i = 0; i < _inlineCount; ++i) {
+                    _sharedDepot[_inlineDepot[i].first] = std::move(_inlineDepot[i].second);
+                }
+                _inlineCount = 0;
+            }
+            _sharedDepot[handle] = std::move(pointer);
+        }
+
+        /// <summary> Releases all shared pointers. </summary>
+        void Clear() {
+            for (size_t i = 0; i < _inlineCount; ++i) {
+                _inlineDepot[i].second.reset();
+            }
+            _inlineCount = 0;
+            _sharedDepot.clear();
+        }
+
+        /// <summary> Takes over the shared pointers of another context, which is left empty. </summary>
+        void MoveFrom(TransportContext& other) {
+            for (size_t i = 0; i < other._inlineCount; ++i) {
+                _inlineDepot[i].first = other._inlineDepot[i].first;
+                _inlineDepot[i].second = std::move(other._inlineDepot[i].second);
+            }
+            _inlineCount = other._inlineCount;
+            other._inlineCount = 0;
+
+            _sharedDepot = std::move(other._sharedDepot);
+            other._sharedDepot.clear();
+        }
+
+        /// <summary> Inline shared_ptr depot, of which the first _inlineCount entries are in use. </summary>
+        std::pair<uintptr_t, std::shared_ptr<void>> _inlineDepot[INLINE_CAPACITY];
+
+        /// <summary> Number of entries in inline depot. </summary>
+        size_t _inlineCount;
 
-        /// <summary> shared_ptr depot. </summary>
-        napa::stl::UnorderedMap<uintptr_t, std::shared_ptr<void>> _sharedDepot;
+        /// <summary> shared_ptr depot beyond inline capacity. Empty as long as entries fit inline. </summary>
+        napa::stl::pmr::UnorderedMap<uintptr_t, std::shared_ptr<void>> _sharedDepot;
     };
 }
 }
-    
\ No newline at end of file
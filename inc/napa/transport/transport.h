@@ -7,9 +7,145 @@
 #include <napa/transport/transport-context.h>
 #include <napa/v8-helpers.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace napa {
 namespace transport {
 
+    /// <summary>
+    ///     Max number of objects and members of values marshalled without calling into JavaScript transport.
+    ///     Walking values through V8 API costs more per member than JSON.stringify with the transport replacer,
+    ///     which only pays off for small values that would otherwise pay for calling into JavaScript.
+    /// </summary>
+    constexpr uint32_t MAX_PLAIN_VALUE_NODES = 64;
+
+    /// <summary> Whether a value only consists of built-in JavaScript types, which JSON handles the same way as transport. </summary>
+    /// <param name="context"> Current context. </param>
+    /// <param name="value"> Value to check. </param>
+    /// <param name="plainPrototype"> In and out, the last prototype of plain objects found, to spare constructor name lookups. </param>
+    /// <param name="nodes"> In and out, number of objects and members left to check, larger values are not considered plain. </param>
+    inline bool IsPlainValue(v8::Local<v8::Context> context,
+                             v8::Local<v8::Value> value,
+                             v8::Local<v8::Value>& plainPrototype,
+                             uint32_t& nodes) {
+        // Members that are functions are dropped by JSON, as they are by transport.
+        if (!value->IsObject() || value->IsFunction()) {
+#if (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 7) || V8_MAJOR_VERSION > 6
+            if (value->IsBigInt()) {
+                return false;
+            }
+#endif
+            return !value->IsSymbol();
+        }
+
+        if (nodes == 0 || value->IsProxy()) {
+            return false;
+        }
+        nodes--;
+
+        if (value->IsArray()) {
+            auto array = v8::Local<v8::Array>::Cast(value);
+            if (array->Length() > nodes) {
+                return false;
+            }
+            nodes -= array->Length();
+            for (uint32_t i = 0; i < array->Length(); ++i) {
+                v8::Local<v8::Value> element;
+                if (!array->Get(context, i).ToLocal(&element) || !IsPlainValue(context, element, plainPrototype, nodes)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Same test as transport, objects created in other contexts have other prototypes.
+        auto object = v8::Local<v8::Object>::Cast(value);
+        auto prototype = object->GetPrototype();
+        if (plainPrototype.IsEmpty() || !prototype->StrictEquals(plainPrototype)) {
+            if (!object->GetConstructorName()->StrictEquals(v8_helpers::MakeV8String(context->GetIsolate(), "Object"))) {
+                return false;
+            }
+            plainPrototype = prototype;
+        }
+
+        v8::Local<v8::Array> names;
+        if (!object->GetOwnPropertyNames(context).ToLocal(&names) || names->Length() > nodes) {
+            return false;
+        }
+        nodes -= names->Length();
+        for (uint32_t i = 0; i < names->Length(); ++i) {
+            v8::Local<v8::Value> name;
+            v8::Local<v8::Value> property;
+            if (!names->Get(context, i).ToLocal(&name)
+                || !object->Get(context, name).ToLocal(&property)
+                || !IsPlainValue(context, property, plainPrototype, nodes)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// <summary> Marshall a value of built-in JavaScript types natively, without calling into JavaScript transport. </summary>
+    /// <param name="object"> Object to marshall. </param>
+    /// <returns> Payload in V8 string of marshalled object, or empty if the object needs JavaScript transport. </returns>
+    inline v8::MaybeLocal<v8::String> MarshallPlain(v8::Local<v8::Value> object) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::EscapableHandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        // Functions are transported by hash at the root, undefined has no JSON.
+        v8::Local<v8::Value> plainPrototype;
+        auto nodes = MAX_PLAIN_VALUE_NODES;
+        if (object->IsFunction() || object->IsUndefined() || !IsPlainValue(context, object, plainPrototype, nodes)) {
+            return v8::MaybeLocal<v8::String>();
+        }
+
+        // E.g. circular references. JavaScript transport throws the same error again.
+        v8::TryCatch tryCatch(isolate);
+        v8::Local<v8::String> payload;
+        if (!v8::JSON::Stringify(context, object).ToLocal(&payload)) {
+            return v8::MaybeLocal<v8::String>();
+        }
+        return scope.Escape(payload);
+    }
+
+    /// <summary> Unmarshall a payload without Transportable objects natively, without calling into JavaScript transport. </summary>
+    /// <param name="payload"> Payload to unmarshall. </param>
+    /// <returns> Unmarshalled V8 value from payload, or empty if the payload needs JavaScript transport. </returns>
+    inline v8::MaybeLocal<v8::Value> UnmarshallPlain(v8::Local<v8::Value> payload) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::EscapableHandleScope scope(isolate);
+
+        if (!payload->IsString()) {
+            return v8::MaybeLocal<v8::Value>();
+        }
+
+        // Transportable objects and functions are marshalled with a "_cid" key, JSON escapes quotes within strings.
+        auto json = v8::Local<v8::String>::Cast(payload);
+        const char* cidKey = "\"_cid\"";
+        if (json->IsExternalOneByte()) {
+            auto resource = json->GetExternalOneByteStringResource();
+            auto end = resource->data() + resource->length();
+            if (std::search(resource->data(), end, cidKey, cidKey + std::strlen(cidKey)) != end
+                || std::strncmp(resource->data(), "undefined", resource->length()) == 0) {
+                return v8::MaybeLocal<v8::Value>();
+            }
+        } else {
+            v8::String::Utf8Value utf8(json);
+            if (*utf8 == nullptr || std::strstr(*utf8, cidKey) != nullptr || std::strcmp(*utf8, "undefined") == 0) {
+                return v8::MaybeLocal<v8::Value>();
+            }
+        }
+
+        v8::TryCatch tryCatch(isolate);
+        v8::Local<v8::Value> value;
+        if (!v8::JSON::Parse(isolate->GetCurrentContext(), json).ToLocal(&value)) {
+            return v8::MaybeLocal<v8::Value>();
+        }
+        return scope.Escape(value);
+    }
+
     /// <summary> Register a Transportable object wrap with transport. </summary>
     /// <param name="constructor"> Constructor of wrap type. </param>
     /// <remarks> 'napajs/lib/transport/transport' is required instead of 'napajs/lib/transport' to avoid circular dependency on addon. </remarks>
@@ -24,6 +160,11 @@ namespace transport {
     /// <returns> Payload in V8 string of marshalled object. </summary>
     /// <remarks> 'napajs/lib/transport/transport' is required instead of 'napajs/lib/transport' to avoid circular dependency on addon. </remarks>
     inline v8::MaybeLocal<v8::String> Marshall(v8::Local<v8::Value> object, v8::Local<v8::Object> transportContextWrap) {
+        auto payload = MarshallPlain(object);
+        if (!payload.IsEmpty()) {
+            return payload;
+        }
+
         v8::Local<v8::Value> argv[] = { object, transportContextWrap };
         return v8_helpers::MaybeCast<v8::String>(napa::module::binding::Call(
             "../lib/transport/transport", 
@@ -38,10 +179,16 @@ namespace transport {
     /// <returns> Payload in V8 string of marshalled object. </summary>
     /// <remarks> 'napajs/lib/transport/transport' is required instead of 'napajs/lib/transport' to avoid circular dependency on addon. </remarks>
     inline v8::MaybeLocal<v8::String> Marshall(v8::Local<v8::Value> object, napa::transport::TransportContext* transportContext) {
+        // Plain values don't need a transport context wrap.
+        auto payload = MarshallPlain(object);
+        if (!payload.IsEmpty()) {
+            return payload;
+        }
+
         auto isolate = v8::Isolate::GetCurrent();
         v8::Local<v8::Value> argv[] = { 
             v8::Boolean::New(isolate, false),                           // Not owning since wrap is temporary.
-            v8_helpers::PtrToV8Uint32Array(isolate, transportContext) 
+            v8::External::New(isolate, const_cast<napa::transport::TransportContext*>(transportContext))
         };
         auto transportContextWrap = napa::module::binding::NewInstance(
             "TransportContextWrap", 
@@ -57,6 +204,11 @@ namespace transport {
     /// <returns> Unmarshalled V8 value from payload. </summary>
     /// <remarks> 'napajs/lib/transport/transport' is required instead of 'napajs/lib/transport' to avoid circular dependency on addon. </remarks>
     inline v8::MaybeLocal<v8::Value> Unmarshall(v8::Local<v8::Value> payload, v8::Local<v8::Object> transportContextWrap) {
+        auto value = UnmarshallPlain(payload);
+        if (!value.IsEmpty()) {
+            return value;
+        }
+
         v8::Local<v8::Value> argv[] = { payload, transportContextWrap };
         return napa::module::binding::Call("../lib/transport/transport", "unmarshall", sizeof(argv) / sizeof(v8::Local<v8::Value>), argv);
     }
@@ -67,10 +219,15 @@ namespace transport {
     /// <returns> Unmarshalled V8 value from payload. </summary>
     /// <remarks> 'napajs/lib/transport/transport' is required instead of 'napajs/lib/transport' to avoid circular dependency on addon. </remarks>
     inline v8::MaybeLocal<v8::Value> Unmarshall(v8::Local<v8::Value> payload, const napa::transport::TransportContext* transportContext) {
+        auto value = UnmarshallPlain(payload);
+        if (!value.IsEmpty()) {
+            return value;
+        }
+
         auto isolate = v8::Isolate::GetCurrent();
         v8::Local<v8::Value> argv[] = { 
             v8::Boolean::New(isolate, false),                           // Not owning since wrap is temporary.
-            v8_helpers::PtrToV8Uint32Array(isolate, transportContext) 
+            v8::External::New(isolate, const_cast<napa::transport::TransportContext*>(transportContext))
         };
         auto transportContextWrap = napa::module::binding::NewInstance(
             "TransportContextWrap", 
@@ -0,0 +1,179 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/transport/codec.h>
+#include <napa/v8-helpers/string.h>
+
+#include <v8.h>
+
+namespace napa {
+namespace transport {
+
+    namespace detail {
+
+        /// <summary> Names of fields are internalized, so V8 looks up properties by them as fast as by literals. </summary>
+        inline v8::Local<v8::String> MakeFieldName(v8::Isolate* isolate, const char* name) {
+            return v8::String::NewFromOneByte(
+                isolate, reinterpret_cast<const uint8_t*>(name), v8::NewStringType::kInternalized).ToLocalChecked();
+        }
+    }
+
+    /// <summary>
+    ///     Constructs and extracts JavaScript values of a C++ type, generated at compile time from the type like Codec.
+    ///     It's apart from Codec, which doesn't need V8 for the binary transport format.
+    ///     The primary template handles structs listed by NAPA_CODEC, as plain objects of their fields.
+    /// </summary>
+    template <typename T, typename Enable = void>
+    struct V8Codec {
+        static_assert(CodecFields<T>::REFLECTED, "List the fields of the type with NAPA_CODEC(Type, fields...)");
+
+        static v8::Local<v8::Value> ToV8(v8::Isolate* isolate, const T& value) {
+            auto context = isolate->GetCurrentContext();
+            auto object = v8::Object::New(isolate);
+            CodecFields<T>::Visit(value, [&](const char* name, const auto& field) {
+                auto member = V8Codec<typename std::decay<decltype(field)>::type>::ToV8(isolate, field);
+                return object->CreateDataProperty(context, detail::MakeFieldName(isolate, name), member).FromMaybe(false);
+            });
+            return object;
+        }
+
+        /// <summary> Extracts the fields of an object, fields whose properties are undefined are kept. </summary>
+        static bool FromV8(v8::Local<v8::Context> context, v8::Local<v8::Value> value, T& result, CodecError& error) {
+            if (!value->IsObject()) {
+                return detail::Fail(error, "Expected an object");
+            }
+            auto isolate = context->GetIsolate();
+            auto object = v8::Local<v8::Object>::Cast(value);
+            return CodecFields<T>::Visit(result, [&](const char* name, auto& field) {
+                v8::Local<v8::Value> member;
+                if (!object->Get(context, detail::MakeFieldName(isolate, name)).ToLocal(&member)) {
+                    error.reason = "Failed to get property";
+                    error.AddParent(name);
+                    return false;
+                }
+                if (member->IsUndefined()) {
+                    return true;
+                }
+                if (!V8Codec<typename std::decay<decltype(field)>::type>::FromV8(context, member, field, error)) {
+                    error.AddParent(name);
+                    return false;
+                }
+                return true;
+            });
+        }
+    };
+
+    template <>
+    struct V8Codec<bool> {
+        static v8::Local<v8::Value> ToV8(v8::Isolate* isolate, bool value) {
+            return v8::Boolean::New(isolate, value);
+        }
+
+        static bool FromV8(v8::Local<v8::Context>, v8::Local<v8::Value> value, bool& result, CodecError& error) {
+            if (!value->IsBoolean()) {
+                return detail::Fail(error, "Expected a boolean");
+            }
+            result = v8::Local<v8::Boolean>::Cast(value)->Value();
+            return true;
+        }
+    };
+
+    /// <summary> Numbers, integers of 32 bits become V8 integers, which V8 keeps as small integers when they fit. </summary>
+    template <typename T>
+    struct V8Codec<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type> {
+        static v8::Local<v8::Value> ToV8(v8::Isolate* isolate, T value) {
+            if (std::is_integral<T>::value && sizeof(T) <= sizeof(int32_t)) {
+                return std::is_signed<T>::value || sizeof(T) < sizeof(int32_t)
+                    ? v8::Integer::New(isolate, static_cast<int32_t>(value))
+                    : v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(value));
+            }
+            return v8::Number::New(isolate, static_cast<double>(value));
+        }
+
+        static bool FromV8(v8::Local<v8::Context>, v8::Local<v8::Value> value, T& result, CodecError& error) {
+            if (!value->IsNumber()) {
+                return detail::Fail(error, "Expected a number");
+            }
+            return detail::NumberTo(v8::Local<v8::Number>::Cast(value)->Value(), result, error);
+        }
+    };
+
+    template <>
+    struct V8Codec<std::string> {
+        static v8::Local<v8::Value> ToV8(v8::Isolate* isolate, const std::string& value) {
+            return v8_helpers::MakeV8String(isolate, value);
+        }
+
+        static bool FromV8(v8::Local<v8::Context>, v8::Local<v8::Value> value, std::string& result, CodecError& error) {
+            if (!value->IsString()) {
+                return detail::Fail(error, "Expected a string");
+            }
+            v8_helpers::WriteUtf8(v8::Local<v8::String>::Cast(value), result);
+            return true;
+        }
+    };
+
+    template <typename T>
+    struct V8Codec<std::vector<T>> {
+        static v8::Local<v8::Value> ToV8(v8::Isolate* isolate, const std::vector<T>& value) {
+            auto context = isolate->GetCurrentContext();
+            auto array = v8::Array::New(isolate, static_cast<int>(value.size()));
+            for (uint32_t i = 0; i < value.size(); ++i) {
+                array->Set(context, i, V8Codec<T>::ToV8(isolate, value[i])).FromMaybe(false);
+            }
+            return array;
+        }
+
+        static bool FromV8(v8::Local<v8::Context> context, v8::Local<v8::Value> value, std::vector<T>& result, CodecError& error) {
+            if (!value->IsArray()) {
+                return detail::Fail(error, "Expected an array");
+            }
+            auto array = v8::Local<v8::Array>::Cast(value);
+            auto length = array->Length();
+            result.clear();
+            result.resize(length);
+            for (uint32_t i = 0; i < length; ++i) {
+                v8::Local<v8::Value> element;
+                T converted = T();
+                if (!array->Get(context, i).ToLocal(&element) || !V8Codec<T>::FromV8(context, element, converted, error)) {
+                    if (error.reason.empty()) {
+                        error.reason = "Failed to get element";
+                    }
+                    error.AddParent("[" + std::to_string(i) + "]");
+                    return false;
+                }
+                result[i] = std::move(converted);
+            }
+            return true;
+        }
+    };
+
+    /// <summary> Constructs the JavaScript value of a C++ value. </summary>
+    template <typename T>
+    inline v8::Local<v8::Value> ToV8(v8::Isolate* isolate, const T& value) {
+        v8::EscapableHandleScope scope(isolate);
+        return scope.Escape(V8Codec<T>::ToV8(isolate, value));
+    }
+
+    /// <summary> Extracts a C++ value from a JavaScript value. </summary>
+    /// <returns> False with a pending JS exception, a TypeError telling the mismatched member if it doesn't match. </returns>
+    template <typename T>
+    inline bool FromV8(v8::Local<v8::Context> context, v8::Local<v8::Value> value, T& result) {
+        auto isolate = context->GetIsolate();
+        v8::TryCatch tryCatch(isolate);
+        CodecError error;
+        if (V8Codec<T>::FromV8(context, value, result, error)) {
+            return true;
+        }
+        if (tryCatch.HasCaught()) {
+            // A getter threw.
+            tryCatch.ReThrow();
+        } else {
+            isolate->ThrowException(v8::Exception::TypeError(v8_helpers::MakeV8String(isolate, error.Message())));
+        }
+        return false;
+    }
+}
+}
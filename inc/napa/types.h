@@ -59,6 +59,12 @@ typedef enum {
 
     /// <summary> transport.marshall/unmarshall will be done by user manually. </summary>
     MANUAL,
+
+    /// <summary>
+    ///     Values are transported in V8 structured clone format (v8::ValueSerializer), which keeps
+    ///     typed arrays, Map, Set, Date, RegExp and circular references. Transportables still apply.
+    /// </summary>
+    BINARY,
 } napa_transport_option;
 
 #ifdef __cplusplus
@@ -69,6 +75,48 @@ namespace napa {
 
 #endif // __cplusplus
 
+/// <summary> Represents the priority of a call, calls with higher priority are served first. </summary>
+typedef enum {
+
+    /// <summary> Latency sensitive calls, e.g. interactive requests. </summary>
+    HIGH,
+
+    /// <summary> Default priority. </summary>
+    NORMAL,
+
+    /// <summary> Calls that can wait, e.g. batch jobs. </summary>
+    BACKGROUND,
+} napa_call_priority;
+
+#ifdef __cplusplus
+
+namespace napa {
+    typedef napa_call_priority CallPriority;
+}
+
+#endif // __cplusplus
+
+/// <summary> Represents how close the host is to running out of memory, in the order of v8::MemoryPressureLevel. </summary>
+typedef enum {
+
+    /// <summary> Memory pressure is gone, isolates grow their heaps as usual again. </summary>
+    MEMORY_PRESSURE_NONE,
+
+    /// <summary> Isolates collect garbage more eagerly. </summary>
+    MEMORY_PRESSURE_MODERATE,
+
+    /// <summary> Isolates collect garbage right away and shrink their heaps, napa allocator caches are released. </summary>
+    MEMORY_PRESSURE_CRITICAL,
+} napa_memory_pressure_level;
+
+#ifdef __cplusplus
+
+namespace napa {
+    typedef napa_memory_pressure_level MemoryPressureLevel;
+}
+
+#endif // __cplusplus
+
 /// <summary> Represents options for calling a function. </summary>
 typedef struct {
 
@@ -77,6 +125,61 @@ typedef struct {
 
     /// <summary> Arguments transport option. Default is AUTO. </summary>
     napa_transport_option transport;
+
+    /// <summary> Call priority. Default is NORMAL. </summary>
+    napa_call_priority priority;
+
+    /// <summary>
+    ///     Optional routing key, calls with the same key prefer the same worker. Empty for no affinity.
+    ///     The key is only read while the call is being scheduled.
+    /// </summary>
+    napa_string_ref affinity_key;
+
+    /// <summary>
+    ///     Optional trace id of the call, which its trace events and logs carry. Empty for none.
+    ///     It's copied when the call is scheduled, at most 31 characters are kept in traces.
+    /// </summary>
+    napa_string_ref trace_id;
+
+    /// <summary>
+    ///     Optional napa::zone::CancellationToken which cancels the call, null for none. The call keeps
+    ///     a reference to the token, which must be owned by a std::shared_ptr while the call is being scheduled.
+    /// </summary>
+    void* cancellation_token;
+
+    /// <summary>
+    ///     Optional name of the worker class of the zone to run the call on, see ZoneSettings. Empty for any worker.
+    ///     The call goes to the worker of the class with the fewest pending calls, ignoring affinity_key.
+    ///     The name is only read while the call is being scheduled.
+    /// </summary>
+    napa_string_ref worker_class;
+
+    /// <summary>
+    ///     Optional name of the tenant the call is issued for, empty for none. With the synchronized scheduler,
+    ///     queued calls of different tenants share workers by the weights and caps of tenants in ZoneSettings.
+    ///     Tenants that aren't in zone settings have a weight of 1 and no cap. The name is only read while the call is being scheduled.
+    /// </summary>
+    napa_string_ref tenant;
+
+    /// <summary>
+    ///     Delay in milliseconds after which a call that hasn't finished is started again on another worker,
+    ///     the first result wins and the other attempt is cancelled. Use 0 (default) for no hedging.
+    ///     Only idempotent functions should be hedged, as both attempts may run.
+    /// </summary>
+    uint32_t hedge_after;
+
+    /// <summary>
+    ///     Non-zero to attach the call to an identical one in flight, with the same module, function, transport
+    ///     option and arguments, instead of running it again. Attached calls get the result of the first call,
+    ///     including its errors. Use 0 (default) to always run the call.
+    /// </summary>
+    uint8_t coalesce;
+
+    /// <summary>
+    ///     CPU time in milliseconds the call may consume on its worker thread before it's terminated, independent of
+    ///     the wall clock timeout. Time the call waits in queue, is preempted or blocks doesn't count. Use 0 for infinite.
+    /// </summary>
+    uint32_t cpu_timeout;
 } napa_zone_call_options;
 
 #ifdef __cplusplus
@@ -87,6 +190,9 @@ namespace napa {
 
 #endif // __cplusplus
 
+/// <summary> Releases the memory of arguments that a call took over, see napa_zone_function_spec.arguments_release. </summary>
+typedef void(*napa_zone_arguments_release_callback)(void* context);
+
 /// <summary> Represents a function to run within a zone, with binded arguments . </summary>
 typedef struct {
 
@@ -107,11 +213,23 @@ typedef struct {
 
     /// <summary> A context used for transporting handles across zones/workers. </summary>
     void* transport_context;
+
+    /// <summary> Optional callback to take over the memory of arguments, which are then used without copying. </summary>
+    /// <remarks> 
+    ///     Arguments must stay valid until it's called, once with arguments_release_context, from any thread.
+    ///     V8 strings may refer to arguments beyond the call, until they are garbage collected.
+    ///     Without it, arguments are copied and may be freed as soon as the execute function returns.
+    /// </remarks>
+    napa_zone_arguments_release_callback arguments_release;
+
+    /// <summary> An opaque pointer that is passed to arguments_release. </summary>
+    void* arguments_release_context;
 } napa_zone_function_spec;
 
 #ifdef __cplusplus
 
 #include <napa/transport/transport-context.h>
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -130,10 +248,14 @@ namespace napa {
         std::vector<StringRef> arguments;
 
         /// <summary> Execute options. </summary>
-        CallOptions options = { 0, AUTO };
+        CallOptions options = { 0, AUTO, NORMAL, EMPTY_NAPA_STRING_REF, EMPTY_NAPA_STRING_REF, nullptr, EMPTY_NAPA_STRING_REF, EMPTY_NAPA_STRING_REF, 0, 0, 0 };
 
         /// <summary> Used for transporting shared_ptr and unique_ptr across zones/workers. </summary>
         mutable std::unique_ptr<napa::transport::TransportContext> transportContext;
+
+        /// <summary> Optional owner of the memory of arguments, which are then used without copying. </summary>
+        /// <remarks> Calls and V8 strings over arguments keep a reference, so it may be released after the call. </remarks>
+        std::shared_ptr<const void> argumentsOwner;
     };
 }
 
@@ -153,6 +275,15 @@ typedef struct {
 
     /// <summary> A context used for transporting handles across zones/workers. </summary>
     void* transport_context;
+
+    /// <summary> CPU time the call consumed while it executed, in nano-seconds. </summary>
+    uint64_t cpu_time;
+
+    /// <summary> An estimate of bytes the call allocated on the V8 heap while it executed. </summary>
+    uint64_t allocated_bytes;
+
+    /// <summary> Napa's owner of return_value, which napa_zone_result_take_return_value moves from. Null if there is none. </summary>
+    void* return_value_owner;
 } napa_zone_result;
 
 #ifdef __cplusplus
@@ -172,6 +303,210 @@ namespace napa {
 
         /// <summary> Used for transporting shared_ptr and unique_ptr across zones/workers. </summary>
         mutable std::unique_ptr<napa::transport::TransportContext> transportContext;
+
+        /// <summary> CPU time the call consumed while it executed, in nano-seconds. </summary>
+        uint64_t cpuTime = 0;
+
+        /// <summary> An estimate of bytes the call allocated on the V8 heap while it executed. </summary>
+        uint64_t allocatedBytes = 0;
+    };
+}
+
+#endif // __cplusplus
+
+/// <summary> Memory usage of a zone worker. </summary>
+typedef struct {
+
+    /// <summary> The worker id. </summary>
+    uint32_t worker_id;
+
+    /// <summary> V8 heap statistics of the worker isolate, see v8::HeapStatistics. </summary>
+    size_t used_heap_size;
+    size_t total_heap_size;
+    size_t total_physical_size;
+    size_t heap_size_limit;
+    size_t malloced_memory;
+    size_t peak_malloced_memory;
+
+    /// <summary> Memory held by JS objects of the isolate outside of the V8 heap, mostly ArrayBuffer contents. </summary>
+    size_t external_memory;
+
+    /// <summary> Number and total size of napa_allocate calls made by the worker thread since it started. </summary>
+    uint64_t native_allocate_count;
+    uint64_t native_allocated_size;
+
+    /// <summary> Number and total size hints of napa_deallocate calls made by the worker thread since it started. </summary>
+    uint64_t native_deallocate_count;
+    uint64_t native_deallocated_size;
+} napa_worker_memory_usage;
+
+#ifdef __cplusplus
+
+namespace napa {
+    typedef napa_worker_memory_usage WorkerMemoryUsage;
+}
+
+#endif // __cplusplus
+
+/// <summary> Statistics of a V8 heap space, see v8::HeapSpaceStatistics. </summary>
+typedef struct {
+    napa_string_ref space_name;
+    size_t space_size;
+    size_t space_used_size;
+    size_t space_available_size;
+    size_t physical_space_size;
+} napa_heap_space_statistics;
+
+/// <summary> V8 heap statistics of a zone worker, see v8::HeapStatistics. </summary>
+typedef struct {
+
+    /// <summary> The worker id. </summary>
+    uint32_t worker_id;
+
+    size_t total_heap_size;
+    size_t total_heap_size_executable;
+    size_t total_physical_size;
+    size_t total_available_size;
+    size_t used_heap_size;
+    size_t heap_size_limit;
+    size_t malloced_memory;
+    size_t peak_malloced_memory;
+    size_t number_of_native_contexts;
+    size_t number_of_detached_contexts;
+
+    /// <summary> Statistics of each heap space, valid during the callback they are passed to. </summary>
+    const napa_heap_space_statistics* spaces;
+    size_t spaces_count;
+} napa_worker_heap_statistics;
+
+/// <summary> A call kept by the slow-call log of a zone, see ZoneSettings::slowCallThreshold. </summary>
+typedef struct {
+    napa_string_ref module;
+    napa_string_ref function;
+
+    /// <summary> The id of the worker which ran the call, or UINT32_MAX if it never ran. </summary>
+    uint32_t worker_id;
+
+    /// <summary> The result code of the call. </summary>
+    napa_result_code code;
+
+    /// <summary> Whether the call was kept as 1 of every N calls rather than for its duration. </summary>
+    uint8_t sampled;
+
+    /// <summary> Time the call was created, in microseconds since the Unix epoch. </summary>
+    uint64_t start_time;
+
+    /// <summary> Time in nano-seconds spent in each phase, which add up to the duration of the call. </summary>
+    uint64_t queue_time;
+    uint64_t unmarshall_time;
+    uint64_t execution_time;
+    uint64_t marshall_time;
+    uint64_t completion_time;
+
+    /// <summary>
+    ///     Sizes of the marshalled arguments, and the prefix of each that was kept, valid during the callback.
+    ///     Prefixes have null data when the zone keeps no bytes of arguments.
+    /// </summary>
+    const size_t* argument_sizes;
+    const napa_string_ref* arguments;
+    size_t arguments_count;
+} napa_slow_call;
+
+/// <summary> Number of buckets of the latency histogram of napa_function_stats. </summary>
+#define NAPA_FUNCTION_STATS_BUCKETS 7
+
+/// <summary> Execution statistics of a function of a zone, over all its workers. </summary>
+typedef struct {
+    napa_string_ref module;
+    napa_string_ref function;
+
+    /// <summary> Number of calls that ran on a worker. </summary>
+    uint64_t calls;
+
+    /// <summary> Calls that ran and failed, timeouts aside, and calls that ran and timed out. </summary>
+    uint64_t errors;
+    uint64_t timeouts;
+
+    /// <summary> Total and max time in nano-seconds calls ran on a worker, until the function returned. </summary>
+    uint64_t total_time;
+    uint64_t max_time;
+
+    /// <summary>
+    ///     Calls by execution time, bucket i counts calls that ran less than 10^(i+1) micro-seconds and not less
+    ///     than the bound of bucket i-1, i.e. 10us, 100us, 1ms, 10ms, 100ms and 1s. The last bucket counts the rest.
+    /// </summary>
+    uint64_t histogram[NAPA_FUNCTION_STATS_BUCKETS];
+} napa_function_stats;
+
+/// <summary> Caller-owned buffer that napa_zone_execute_many copies the strings of results into. </summary>
+typedef struct {
+
+    /// <summary> Start of the buffer. </summary>
+    char* data;
+
+    /// <summary> Size of the buffer in bytes. </summary>
+    size_t capacity;
+
+    /// <summary> Bytes taken by results, set before the batch callback is triggered. </summary>
+    size_t used;
+} napa_result_arena;
+
+#ifdef __cplusplus
+
+namespace napa {
+
+    /// <summary> Statistics of a V8 heap space, see v8::HeapSpaceStatistics. </summary>
+    struct HeapSpaceStatistics {
+        std::string name;
+        size_t size;
+        size_t usedSize;
+        size_t availableSize;
+        size_t physicalSize;
+    };
+
+    /// <summary> V8 heap statistics of a zone worker, see v8::HeapStatistics. </summary>
+    struct WorkerHeapStatistics {
+        uint32_t workerId;
+        size_t totalHeapSize;
+        size_t totalHeapSizeExecutable;
+        size_t totalPhysicalSize;
+        size_t totalAvailableSize;
+        size_t usedHeapSize;
+        size_t heapSizeLimit;
+        size_t mallocedMemory;
+        size_t peakMallocedMemory;
+        size_t numberOfNativeContexts;
+        size_t numberOfDetachedContexts;
+        std::vector<HeapSpaceStatistics> spaces;
+    };
+
+    /// <summary> A call kept by the slow-call log of a zone, see napa_slow_call. </summary>
+    struct SlowCall {
+        std::string module;
+        std::string function;
+        uint32_t workerId;
+        ResultCode code;
+        bool sampled;
+        uint64_t startTime;
+        uint64_t queueTime;
+        uint64_t unmarshallTime;
+        uint64_t executionTime;
+        uint64_t marshallTime;
+        uint64_t completionTime;
+        std::vector<size_t> argumentSizes;
+        std::vector<std::string> arguments;
+    };
+
+    /// <summary> Execution statistics of a function of a zone, see napa_function_stats. </summary>
+    struct FunctionStats {
+        std::string module;
+        std::string function;
+        uint64_t calls;
+        uint64_t errors;
+        uint64_t timeouts;
+        uint64_t totalTime;
+        uint64_t maxTime;
+        std::array<uint64_t, NAPA_FUNCTION_STATS_BUCKETS> histogram;
     };
 }
 
@@ -180,6 +515,17 @@ namespace napa {
 /// <summary> Callback signatures. </summary>
 typedef void(*napa_zone_broadcast_callback)(napa_result_code code, void* context);
 typedef void(*napa_zone_execute_callback)(napa_zone_result result, void* context);
+typedef void(*napa_zone_execute_batch_callback)(const napa_zone_result* results, size_t results_count, void* context);
+typedef void(*napa_zone_resize_callback)(napa_result_code code, void* context);
+typedef void(*napa_zone_drain_callback)(napa_result_code code, size_t cancelled, void* context);
+typedef void(*napa_zone_memory_usage_callback)(const napa_worker_memory_usage* usages, size_t usages_count, void* context);
+typedef void(*napa_zone_profiling_callback)(napa_result_code code, void* context);
+typedef void(*napa_zone_cpu_profile_callback)(const napa_string_ref* profiles, size_t profiles_count, void* context);
+typedef void(*napa_zone_allocation_profile_callback)(napa_string_ref profile, void* context);
+typedef void(*napa_zone_heap_statistics_callback)(const napa_worker_heap_statistics* statistics, size_t statistics_count, void* context);
+typedef void(*napa_zone_heap_snapshot_callback)(napa_result_code code, void* context);
+typedef void(*napa_zone_slow_calls_callback)(const napa_slow_call* calls, size_t calls_count, void* context);
+typedef void(*napa_zone_function_stats_callback)(const napa_function_stats* stats, size_t stats_count, void* context);
 
 #ifdef __cplusplus
 
@@ -188,6 +534,15 @@ typedef void(*napa_zone_execute_callback)(napa_zone_result result, void* context
 namespace napa {
     typedef std::function<void(ResultCode)> BroadcastCallback;
     typedef std::function<void(Result)> ExecuteCallback;
+    typedef std::function<void(std::vector<Result>)> ExecuteBatchCallback;
+    typedef std::function<void(ResultCode)> ResizeCallback;
+    typedef std::function<void(ResultCode, size_t)> DrainCallback;
+    typedef std::function<void(std::vector<WorkerMemoryUsage>)> MemoryUsageCallback;
+    typedef std::function<void(ResultCode)> ProfilingCallback;
+    typedef std::function<void(std::vector<std::string>)> CpuProfileCallback;
+    typedef std::function<void(std::string)> AllocationProfileCallback;
+    typedef std::function<void(std::vector<WorkerHeapStatistics>)> HeapStatisticsCallback;
+    typedef std::function<void(ResultCode)> HeapSnapshotCallback;
 }
 
 #endif // __cplusplus
@@ -195,6 +550,12 @@ namespace napa {
 /// <summary> Zone handle type. </summary>
 typedef struct napa_zone *napa_zone_handle;
 
+/// <summary> Shared buffer handle type, see napa_buffer_allocate. </summary>
+typedef struct napa_buffer *napa_buffer_handle;
+
+/// <summary> Size of a char array that holds any argument payload of a shared buffer, see napa_transport_context_save_buffer. </summary>
+#define NAPA_BUFFER_PAYLOAD_MAX_SIZE 64
+
 /// <summary> Callback for customized memory allocator. </summary>
 typedef void* (*napa_allocate_callback)(size_t);
 typedef void (*napa_deallocate_callback)(void*, size_t);
@@ -16,8 +16,14 @@ namespace v8_helpers {
     }
 
     /// <summary> Convert a v8 value to std::string. </summary>
+    /// <remarks> Strings are written into the result directly, ASCII ones without transcoding. </remarks>
     template <>
     inline std::string V8ValueTo(const v8::Local<v8::Value>& value) {
+        if (!value.IsEmpty() && value->IsString()) {
+            std::string result;
+            WriteUtf8(value.As<v8::String>(), result);
+            return result;
+        }
         v8::String::Utf8Value utf8Value(value);
         return std::string(*utf8Value);
     }
@@ -25,6 +31,11 @@ namespace v8_helpers {
     /// <summary> Convert a v8 value to napa::stl::String. </summary>
     template <>
     inline napa::stl::String V8ValueTo(const v8::Local<v8::Value>& value) {
+        if (!value.IsEmpty() && value->IsString()) {
+            napa::stl::String result;
+            WriteUtf8(value.As<v8::String>(), result);
+            return result;
+        }
         v8::String::Utf8Value utf8Value(value);
         return napa::stl::String(*utf8Value);
     }
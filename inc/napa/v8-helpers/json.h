@@ -28,7 +28,8 @@ namespace v8_helpers {
 
         /// <summary> JSON.parse </summary>
         inline v8::MaybeLocal<v8::Value> Parse(const v8::Local<v8::String>& jsonString) {
-            return v8::JSON::Parse(jsonString);
+            auto isolate = v8::Isolate::GetCurrent();
+            return v8::JSON::Parse(isolate->GetCurrentContext(), jsonString);
         }
     }
 }
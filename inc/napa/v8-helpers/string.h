@@ -6,6 +6,7 @@
 #include <v8.h>
 #include <napa/stl/string.h>
 #include <cstring>
+#include <string>
 
 namespace napa {
 namespace v8_helpers {
@@ -26,17 +27,22 @@ namespace v8_helpers {
     }
 
     /// <summary> Make a V8 string from external const char*. </summary>
-    inline v8::Local<v8::String> MakeExternalV8String(v8::Isolate *isolate, const char* data) {
+    /// <remarks> One-byte strings are Latin-1, thus UTF-8 data other than ASCII is copied. </remarks>
+    inline v8::Local<v8::String> MakeExternalV8String(v8::Isolate *isolate, const char* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            if ((data[i] & 0x80) != 0) {
+                return MakeV8String(isolate, data, static_cast<int>(length));
+            }
+        }
+
         // V8 garbage collection frees ExternalOneByteStringResourceImpl.
-        auto externalResource = new v8::ExternalOneByteStringResourceImpl(data, std::strlen(data));
+        auto externalResource = new v8::ExternalOneByteStringResourceImpl(data, length);
         return v8::String::NewExternalOneByte(isolate, externalResource).ToLocalChecked();
     }
 
     /// <summary> Make a V8 string from external const char*. </summary>
-    inline v8::Local<v8::String> MakeExternalV8String(v8::Isolate *isolate, const char* data, size_t length) {
-        // V8 garbage collection frees ExternalOneByteStringResourceImpl.
-        auto externalResource = new v8::ExternalOneByteStringResourceImpl(data, length);
-        return v8::String::NewExternalOneByte(isolate, externalResource).ToLocalChecked();
+    inline v8::Local<v8::String> MakeExternalV8String(v8::Isolate *isolate, const char* data) {
+        return MakeExternalV8String(isolate, data, std::strlen(data));
     }
 
     /// <summary> Make a V8 string from external std::string. </sumary>
@@ -44,15 +50,105 @@ namespace v8_helpers {
         return MakeExternalV8String(isolate, str.data(), str.length());
     }
 
+    /// <summary> One-byte string resource which owns its bytes, released by V8 garbage collection. </summary>
+    class OwnedOneByteStringResource : public v8::String::ExternalOneByteStringResource {
+    public:
+        explicit OwnedOneByteStringResource(std::string str) : _str(std::move(str)) {
+        }
+
+        const char* data() const override {
+            return _str.data();
+        }
+
+        size_t length() const override {
+            return _str.size();
+        }
+
+    private:
+        std::string _str;
+    };
+
+    /// <summary> Strings shorter than this are copied by MakeOwnedV8String, an external string costs more for them. </summary>
+    constexpr size_t MIN_OWNED_EXTERNAL_STRING_LENGTH = 1024;
+
+    /// <summary> Make a V8 string that takes over a std::string, which backs the V8 string as is if it's ASCII. </summary>
+    /// <remarks> Short strings and strings other than ASCII are copied, the latter are transcoded from UTF-8. </remarks>
+    inline v8::Local<v8::String> MakeOwnedV8String(v8::Isolate *isolate, std::string&& str) {
+        if (str.size() < MIN_OWNED_EXTERNAL_STRING_LENGTH) {
+            return MakeV8String(isolate, str);
+        }
+        for (auto c : str) {
+            if ((c & 0x80) != 0) {
+                return MakeV8String(isolate, str);
+            }
+        }
+        return v8::String::NewExternalOneByte(isolate, new OwnedOneByteStringResource(std::move(str))).ToLocalChecked();
+    }
+
+    /// <summary> Whether bytes are ASCII, which are the same in Latin-1 and UTF-8. </summary>
+    inline bool IsAscii(const char* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            if ((data[i] & 0x80) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// <summary> Writes an ASCII V8 string into a buffer of str->Length() bytes, skipping UTF-8 transcoding. </summary>
+    /// <returns> True if the string is ASCII, otherwise false and the buffer content is undefined. </returns>
+    /// <remarks>
+    ///     Only strings stored as one byte per character are tried. External ones are copied from their resource,
+    ///     others are written as Latin-1, and in both cases the bytes are checked to be ASCII.
+    /// </remarks>
+    inline bool TryWriteAscii(v8::Local<v8::String> str, char* buffer) {
+        if (!str->IsOneByte()) {
+            return false;
+        }
+
+        auto length = static_cast<size_t>(str->Length());
+        if (str->IsExternalOneByte()) {
+            auto resource = str->GetExternalOneByteStringResource();
+            if (resource != nullptr && resource->length() == length) {
+                std::memcpy(buffer, resource->data(), length);
+                return IsAscii(buffer, length);
+            }
+        }
+
+        str->WriteOneByte(v8::Isolate::GetCurrent(),
+                          reinterpret_cast<uint8_t*>(buffer),
+                          0,
+                          static_cast<int>(length),
+                          v8::String::NO_NULL_TERMINATION);
+        return IsAscii(buffer, length);
+    }
+
+    /// <summary> Writes a V8 string as UTF-8 into a std::string or a napa::stl::String, without an intermediate copy. </summary>
+    /// <remarks> ASCII strings are written as is, and short ones fit in the small string buffer of the target. </remarks>
+    template <typename StringType>
+    inline void WriteUtf8(v8::Local<v8::String> str, StringType& target) {
+        target.resize(static_cast<size_t>(str->Length()));
+        if (target.empty() || TryWriteAscii(str, &target[0])) {
+            return;
+        }
+
+        target.resize(static_cast<size_t>(str->Utf8Length()));
+        str->WriteUtf8(&target[0], static_cast<int>(target.size()), nullptr, v8::String::NO_NULL_TERMINATION);
+    }
+
      /// <summary> Make a V8 string from external napa::stl::String. </sumary>
     inline v8::Local<v8::String> MakeExternalV8String(v8::Isolate *isolate, const napa::stl::String& str) {
         return MakeExternalV8String(isolate, str.data(), str.length());
     }
 
     /// <summary> Converts a V8 string object to a movable Utf8String which supports an allocator. </summary>
+    /// <remarks> Strings shorter than INLINE_CAPACITY bytes, like keys and names, are held in the object without allocating. </remarks>
     template <typename Alloc>
     class Utf8StringWithAllocator {
     public:
+        /// <summary> Size of the buffer for short strings, including the terminating null. </summary>
+        static constexpr size_t INLINE_CAPACITY = 32;
+
         Utf8StringWithAllocator()
             : _data(nullptr), _length(0) {
         }
@@ -60,28 +156,37 @@ namespace v8_helpers {
         Utf8StringWithAllocator(
             const v8::Local<v8::Value>& val, 
             const Alloc& alloc = Alloc()) 
-            : _alloc(alloc),
-              _data(nullptr),
-              _length(0) {
+            : _data(nullptr),
+              _length(0),
+              _alloc(alloc) {
 
             if (val.IsEmpty()) {
                 return;
             }
-            auto isolate = v8::Isolate::GetCurrent();
-            auto context = isolate->GetCurrentContext();
             v8::Local<v8::String> str;
-            if (!val->ToString(context).ToLocal(&str)) {
+            if (val->IsString()) {
+                str = val.As<v8::String>();
+            } else if (!val->ToString(v8::Isolate::GetCurrent()->GetCurrentContext()).ToLocal(&str)) {
+                return;
+            }
+
+            // ASCII strings have as many UTF-8 bytes as characters.
+            _length = static_cast<size_t>(str->Length());
+            _data = Allocate(_length);
+            if (TryWriteAscii(str, _data)) {
+                _data[_length] = '\0';
                 return;
             }
-            _length = str->Length();
-            _data = _alloc.allocate(_length + 1);
-            str->WriteUtf8(_data);
+            Deallocate();
+
+            // Length in UTF-8 bytes, which is larger than the string length for characters beyond ASCII.
+            _length = static_cast<size_t>(str->Utf8Length());
+            _data = Allocate(_length);
+            str->WriteUtf8(_data, static_cast<int>(_length + 1));
         }
 
         ~Utf8StringWithAllocator() {
-            if (_data != nullptr) {
-                _alloc.deallocate(_data, _length);
-            }
+            Deallocate();
         }
 
         const char* Data() const {
@@ -98,29 +203,54 @@ namespace v8_helpers {
 
         /// <summary> Move constructor. </summary>
         Utf8StringWithAllocator(Utf8StringWithAllocator&& rhs) :
-                                _data(rhs._data),
-                                _length(rhs._length),
+                                _data(nullptr),
+                                _length(0),
                                 _alloc(std::move(rhs._alloc)) {
-            rhs._data = nullptr;
-            rhs._length = 0;
+            MoveFrom(rhs);
         }
 
         /// <summary> Move assignment. </summary>
         Utf8StringWithAllocator& operator=(Utf8StringWithAllocator&& rhs) {
-            _data = rhs._data;
-            _length = rhs._length;
-            _alloc = std::move(rhs._alloc);
+            if (this != &rhs) {
+                Deallocate();
+                _alloc = std::move(rhs._alloc);
+                MoveFrom(rhs);
+            }
+            return *this;
+        }
+
+    private:
+        /// <summary> Gets a buffer for a string of length bytes and its terminating null. </summary>
+        char* Allocate(size_t length) {
+            return length < INLINE_CAPACITY ? _buffer : _alloc.allocate(length + 1);
+        }
 
+        /// <summary> Releases the string buffer if it was allocated. </summary>
+        void Deallocate() {
+            if (_data != nullptr && _data != _buffer) {
+                _alloc.deallocate(_data, _length + 1);
+            }
+            _data = nullptr;
+            _length = 0;
+        }
+
+        /// <summary> Takes over the string of rhs, copying it if it's inline. </summary>
+        void MoveFrom(Utf8StringWithAllocator& rhs) {
+            _length = rhs._length;
+            if (rhs._data == rhs._buffer) {
+                std::memcpy(_buffer, rhs._buffer, _length + 1);
+                _data = _buffer;
+            } else {
+                _data = rhs._data;
+            }
             rhs._data = nullptr;
             rhs._length = 0;
-
-            return *this;
         }
 
-    private:
         char* _data;
         size_t _length;
         Alloc _alloc;
+        char _buffer[INLINE_CAPACITY];
     };
 
     /// <summary> Utf8String in C++. </summary>
@@ -5,6 +5,7 @@
 
 #include "napa/capi.h"
 
+#include <algorithm>
 #include <functional>
 #include <future>
 
@@ -20,11 +21,21 @@ namespace napa {
         return napa_initialize_from_console(argc, argv);
     }
 
+    /// <summary> Creates a V8 startup snapshot from a script, see napa_create_snapshot. </summary>
+    inline ResultCode CreateSnapshot(const std::string& source, const std::string& path) {
+        return napa_create_snapshot(STD_STRING_TO_NAPA_STRING_REF(source), STD_STRING_TO_NAPA_STRING_REF(path));
+    }
+
     /// <summary> Shut down napa. </summary>
     inline ResultCode Shutdown() {
         return napa_shutdown();
     }
 
+    /// <summary> Notifies all zones of memory pressure, see napa_memory_pressure. </summary>
+    inline void NotifyMemoryPressure(MemoryPressureLevel level) {
+        napa_memory_pressure(level);
+    }
+
     /// <summary> C++ proxy around napa Zone C APIs. </summary>
     class Zone {
     public:
@@ -99,6 +110,7 @@ namespace napa {
 
             // Release ownership of transport context
             req.transport_context = reinterpret_cast<void*>(spec.transportContext.release());
+            SetArgumentsRelease(spec, req);
 
             napa_zone_execute(_handle, req, [](napa_zone_result result, void* context) {
                 // Ensures the context is deleted when this scope ends.
@@ -107,12 +119,280 @@ namespace napa {
                 Result res;
                 res.code = result.code;
                 res.errorMessage = NAPA_STRING_REF_TO_STD_STRING(result.error_message);
-                res.returnValue = NAPA_STRING_REF_TO_STD_STRING(result.return_value);
+                napa_zone_result_take_return_value(result, res.returnValue);
 
                 // Assume ownership of transport context
                 res.transportContext.reset(
                     reinterpret_cast<napa::transport::TransportContext*>(result.transport_context));
 
+                res.cpuTime = result.cpu_time;
+                res.allocatedBytes = result.allocated_bytes;
+
+                (*callback)(std::move(res));
+            }, context);
+        }
+
+        /// <summary> Gets the load of pending calls relative to the zone limits, calls are rejected at 1. </summary>
+        float GetPressure() const {
+            return napa_zone_get_pressure(_handle);
+        }
+
+        /// <summary> Gets the number of running workers, which changes with resizing and autoscaling. </summary>
+        uint32_t GetWorkers() const {
+            return napa_zone_get_workers(_handle);
+        }
+
+        /// <summary> Changes the number of zone workers asynchronously. </summary>
+        /// <param name="workers"> The new number of workers. </param>
+        /// <param name="callback"> A callback that is triggered when resizing is done. </param>
+        void Resize(uint32_t workers, ResizeCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new ResizeCallback(std::move(callback));
+
+            napa_zone_resize(_handle, workers, [](napa_result_code code, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<ResizeCallback> callback(reinterpret_cast<ResizeCallback*>(context));
+
+                (*callback)(code);
+            }, context);
+        }
+
+        /// <summary> Waits asynchronously for the calls of the zone to finish, cancelling calls still queued at a deadline. </summary>
+        /// <param name="timeout"> Milliseconds after which queued calls are cancelled, 0 to wait for all calls. </param>
+        /// <param name="callback"> A callback that is triggered with the result code and the number of calls cancelled. </param>
+        void Drain(uint32_t timeout, DrainCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new DrainCallback(std::move(callback));
+
+            napa_zone_drain(_handle, timeout, [](napa_result_code code, size_t cancelled, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<DrainCallback> callback(reinterpret_cast<DrainCallback*>(context));
+
+                (*callback)(code, cancelled);
+            }, context);
+        }
+
+        /// <summary> Collects memory usage of each zone worker asynchronously. </summary>
+        /// <param name="callback"> A callback that is triggered with the usage of each worker, in order of worker ids. </param>
+        void GetMemoryUsage(MemoryUsageCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new MemoryUsageCallback(std::move(callback));
+
+            napa_zone_get_memory_usage(_handle, [](const napa_worker_memory_usage* usages, size_t usagesCount, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<MemoryUsageCallback> callback(reinterpret_cast<MemoryUsageCallback*>(context));
+
+                (*callback)(std::vector<WorkerMemoryUsage>(usages, usages + usagesCount));
+            }, context);
+        }
+
+        /// <summary> Starts the V8 CPU profiler on each zone worker asynchronously. </summary>
+        /// <param name="samplingInterval"> Sampling interval in microseconds, 0 for the V8 default. </param>
+        /// <param name="callback"> A callback that is triggered once all workers started profiling. </param>
+        void StartProfiling(uint32_t samplingInterval, ProfilingCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new ProfilingCallback(std::move(callback));
+
+            napa_zone_start_profiling(_handle, samplingInterval, [](napa_result_code code, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<ProfilingCallback> callback(reinterpret_cast<ProfilingCallback*>(context));
+
+                (*callback)(code);
+            }, context);
+        }
+
+        /// <summary> Stops the V8 CPU profiler on each zone worker asynchronously. </summary>
+        /// <param name="callback"> A callback that is triggered with the .cpuprofile JSON of each worker, in order of worker ids. </param>
+        void StopProfiling(CpuProfileCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new CpuProfileCallback(std::move(callback));
+
+            napa_zone_stop_profiling(_handle, [](const napa_string_ref* profiles, size_t profilesCount, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<CpuProfileCallback> callback(reinterpret_cast<CpuProfileCallback*>(context));
+
+                std::vector<std::string> copies;
+                copies.reserve(profilesCount);
+                for (size_t i = 0; i < profilesCount; ++i) {
+                    copies.push_back(NAPA_STRING_REF_TO_STD_STRING(profiles[i]));
+                }
+                (*callback)(std::move(copies));
+            }, context);
+        }
+
+        /// <summary> Starts the V8 sampling heap profiler on each zone worker asynchronously. </summary>
+        /// <param name="samplingInterval"> Average number of bytes allocated between two samples, 0 for the V8 default. </param>
+        /// <param name="callback"> A callback that is triggered once all workers started profiling. </param>
+        void StartAllocationProfiling(uint32_t samplingInterval, ProfilingCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new ProfilingCallback(std::move(callback));
+
+            napa_zone_start_allocation_profiling(_handle, samplingInterval, [](napa_result_code code, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<ProfilingCallback> callback(reinterpret_cast<ProfilingCallback*>(context));
+
+                (*callback)(code);
+            }, context);
+        }
+
+        /// <summary> Stops the V8 sampling heap profiler on each zone worker asynchronously. </summary>
+        /// <param name="callback"> A callback that is triggered with the merged .heapprofile JSON of all workers, empty if none was profiling. </param>
+        void StopAllocationProfiling(AllocationProfileCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new AllocationProfileCallback(std::move(callback));
+
+            napa_zone_stop_allocation_profiling(_handle, [](napa_string_ref profile, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<AllocationProfileCallback> callback(reinterpret_cast<AllocationProfileCallback*>(context));
+
+                (*callback)(NAPA_STRING_REF_TO_STD_STRING(profile));
+            }, context);
+        }
+
+        /// <summary> Collects V8 heap statistics, with the statistics of each heap space, of each zone worker asynchronously. </summary>
+        /// <param name="callback"> A callback that is triggered with the statistics of each worker, in order of worker ids. </param>
+        void GetHeapStatistics(HeapStatisticsCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new HeapStatisticsCallback(std::move(callback));
+
+            napa_zone_get_heap_statistics(_handle, [](const napa_worker_heap_statistics* statistics, size_t statisticsCount, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<HeapStatisticsCallback> callback(reinterpret_cast<HeapStatisticsCallback*>(context));
+
+                std::vector<WorkerHeapStatistics> copies(statisticsCount);
+                for (size_t i = 0; i < statisticsCount; ++i) {
+                    const auto& worker = statistics[i];
+                    copies[i] = {
+                        worker.worker_id,
+                        worker.total_heap_size,
+                        worker.total_heap_size_executable,
+                        worker.total_physical_size,
+                        worker.total_available_size,
+                        worker.used_heap_size,
+                        worker.heap_size_limit,
+                        worker.malloced_memory,
+                        worker.peak_malloced_memory,
+                        worker.number_of_native_contexts,
+                        worker.number_of_detached_contexts,
+                        {} };
+                    for (size_t j = 0; j < worker.spaces_count; ++j) {
+                        const auto& space = worker.spaces[j];
+                        copies[i].spaces.push_back({ NAPA_STRING_REF_TO_STD_STRING(space.space_name),
+                            space.space_size, space.space_used_size, space.space_available_size, space.physical_space_size });
+                    }
+                }
+                (*callback)(std::move(copies));
+            }, context);
+        }
+
+        /// <summary> Writes a V8 heap snapshot of a zone worker to a file asynchronously. </summary>
+        /// <param name="workerId"> The id of the worker. </param>
+        /// <param name="path"> Path of the file, in the .heapsnapshot format of Chrome DevTools. </param>
+        /// <param name="callback"> A callback that is triggered once the snapshot is written. </param>
+        void WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new HeapSnapshotCallback(std::move(callback));
+
+            napa_zone_write_heap_snapshot(_handle, workerId, STD_STRING_TO_NAPA_STRING_REF(path), [](napa_result_code code, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<HeapSnapshotCallback> callback(reinterpret_cast<HeapSnapshotCallback*>(context));
+
+                (*callback)(code);
+            }, context);
+        }
+
+        /// <summary> Gets the calls kept by the slow-call log of the zone, oldest first. </summary>
+        std::vector<SlowCall> GetSlowCalls() const {
+            std::vector<SlowCall> copies;
+            napa_zone_get_slow_calls(_handle, [](const napa_slow_call* calls, size_t callsCount, void* context) {
+                auto& copies = *reinterpret_cast<std::vector<SlowCall>*>(context);
+                copies.resize(callsCount);
+                for (size_t i = 0; i < callsCount; ++i) {
+                    const auto& call = calls[i];
+                    auto& copy = copies[i];
+                    copy.module = NAPA_STRING_REF_TO_STD_STRING(call.module);
+                    copy.function = NAPA_STRING_REF_TO_STD_STRING(call.function);
+                    copy.workerId = call.worker_id;
+                    copy.code = call.code;
+                    copy.sampled = call.sampled != 0;
+                    copy.startTime = call.start_time;
+                    copy.queueTime = call.queue_time;
+                    copy.unmarshallTime = call.unmarshall_time;
+                    copy.executionTime = call.execution_time;
+                    copy.marshallTime = call.marshall_time;
+                    copy.completionTime = call.completion_time;
+                    copy.argumentSizes.assign(call.argument_sizes, call.argument_sizes + call.arguments_count);
+                    for (size_t j = 0; j < call.arguments_count && call.arguments[j].data != nullptr; ++j) {
+                        copy.arguments.push_back(NAPA_STRING_REF_TO_STD_STRING(call.arguments[j]));
+                    }
+                }
+            }, &copies);
+            return copies;
+        }
+
+        /// <summary> Gets the execution statistics of each function the zone ran. </summary>
+        std::vector<FunctionStats> GetFunctionStats() const {
+            std::vector<FunctionStats> copies;
+            napa_zone_get_function_stats(_handle, [](const napa_function_stats* stats, size_t statsCount, void* context) {
+                auto& copies = *reinterpret_cast<std::vector<FunctionStats>*>(context);
+                copies.resize(statsCount);
+                for (size_t i = 0; i < statsCount; ++i) {
+                    const auto& function = stats[i];
+                    auto& copy = copies[i];
+                    copy.module = NAPA_STRING_REF_TO_STD_STRING(function.module);
+                    copy.function = NAPA_STRING_REF_TO_STD_STRING(function.function);
+                    copy.calls = function.calls;
+                    copy.errors = function.errors;
+                    copy.timeouts = function.timeouts;
+                    copy.totalTime = function.total_time;
+                    copy.maxTime = function.max_time;
+                    std::copy(function.histogram, function.histogram + NAPA_FUNCTION_STATS_BUCKETS, copy.histogram.begin());
+                }
+            }, &copies);
+            return copies;
+        }
+
+        /// <summary> Executes a batch of pre-loaded JS functions asynchronously. </summary>
+        /// <param name="specs"> Function specs to call. </param>
+        /// <param name="callback"> A callback that is triggered with results in order of specs, when all executions are done. </param>
+        void ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) {
+            // Will be deleted on when the callback scope ends.
+            auto context = new ExecuteBatchCallback(std::move(callback));
+
+            std::vector<napa_zone_function_spec> reqs(specs.size());
+            for (size_t i = 0; i < specs.size(); i++) {
+                const auto& spec = specs[i];
+                auto& req = reqs[i];
+
+                req.module = spec.module;
+                req.function = spec.function;
+                req.arguments = spec.arguments.data();
+                req.arguments_count = spec.arguments.size();
+                req.options = spec.options;
+
+                // Release ownership of transport context
+                req.transport_context = reinterpret_cast<void*>(spec.transportContext.release());
+                SetArgumentsRelease(spec, req);
+            }
+
+            napa_zone_execute_batch(_handle, reqs.data(), reqs.size(), [](const napa_zone_result* results, size_t count, void* context) {
+                // Ensures the context is deleted when this scope ends.
+                std::unique_ptr<ExecuteBatchCallback> callback(reinterpret_cast<ExecuteBatchCallback*>(context));
+
+                std::vector<Result> res(count);
+                for (size_t i = 0; i < count; i++) {
+                    res[i].code = results[i].code;
+                    res[i].errorMessage = NAPA_STRING_REF_TO_STD_STRING(results[i].error_message);
+                    napa_zone_result_take_return_value(results[i], res[i].returnValue);
+
+                    // Assume ownership of transport context
+                    res[i].transportContext.reset(
+                        reinterpret_cast<napa::transport::TransportContext*>(results[i].transport_context));
+
+                    res[i].cpuTime = results[i].cpu_time;
+                    res[i].allocatedBytes = results[i].allocated_bytes;
+                }
+
                 (*callback)(std::move(res));
             }, context);
         }
@@ -140,6 +420,49 @@ namespace napa {
             return std::unique_ptr<Zone>(new Zone(id, handle));
         }
 
+        /// <summary> Connects to a zone served by another process, throws if the zone can't be reached. </summary>
+        /// <param name="address"> The "host:port" address the zone is served on. </param>
+        static std::unique_ptr<Zone> Connect(const std::string& address) {
+            auto handle = napa_zone_connect(STD_STRING_TO_NAPA_STRING_REF(address));
+            if (!handle) {
+                throw std::runtime_error("Failed to connect to a zone at '" + address + "'");
+            }
+
+            auto zoneId = NAPA_STRING_REF_TO_STD_STRING(napa_zone_get_id(handle));
+            return std::unique_ptr<Zone>(new Zone(std::move(zoneId), handle));
+        }
+
+        /// <summary> Groups zones into a zone routing each call to the least loaded of them, see napa_zone_group. Throws on failure. </summary>
+        /// <param name="id"> The id of the group. </param>
+        /// <param name="members"> The zones to group, which the group keeps. </param>
+        /// <param name="localPayloadSize"> Calls whose arguments take up to this many bytes prefer local members, 0 not to. </param>
+        static std::unique_ptr<Zone> Group(const std::string& id, const std::vector<const Zone*>& members, uint32_t localPayloadSize) {
+            std::vector<napa_zone_handle> handles;
+            handles.reserve(members.size());
+            for (auto member : members) {
+                handles.push_back(member->_handle);
+            }
+
+            auto handle = napa_zone_group(STD_STRING_TO_NAPA_STRING_REF(id), handles.data(), handles.size(), localPayloadSize);
+            if (!handle) {
+                throw std::runtime_error("Failed to group zones into '" + id + "'");
+            }
+
+            return std::unique_ptr<Zone>(new Zone(id, handle));
+        }
+
+        /// <summary> Serves the zone to other processes until napa shuts down, see napa_zone_serve. Throws on failure. </summary>
+        /// <param name="address"> The "host:port" address to listen on, port 0 for any free port. </param>
+        /// <returns> The port the zone is served on. </returns>
+        uint16_t Serve(const std::string& address) {
+            uint16_t port = 0;
+            auto res = napa_zone_serve(_handle, STD_STRING_TO_NAPA_STRING_REF(address), &port);
+            if (res != NAPA_RESULT_SUCCESS) {
+                throw std::runtime_error(napa_result_code_to_string(res));
+            }
+            return port;
+        }
+
         /// <summary> Creates a proxy to the current zone, throws if non is associated with this thread. </summary>
         static std::unique_ptr<Zone> GetCurrent() {
             auto handle = napa_zone_get_current();
@@ -153,6 +476,19 @@ namespace napa {
 
     private:
 
+        /// <summary> Passes the owner of arguments of a spec, if any, as release callback of a C spec. </summary>
+        static void SetArgumentsRelease(const FunctionSpec& spec, napa_zone_function_spec& req) {
+            if (spec.argumentsOwner == nullptr) {
+                req.arguments_release = nullptr;
+                req.arguments_release_context = nullptr;
+                return;
+            }
+            req.arguments_release = [](void* context) {
+                delete reinterpret_cast<std::shared_ptr<const void>*>(context);
+            };
+            req.arguments_release_context = new std::shared_ptr<const void>(spec.argumentsOwner);
+        }
+
         /// <summary> Private constructor to create a C++ zone proxy from a C handle. </summary>
         explicit Zone(const std::string& id, napa_zone_handle handle) : _zoneId(id), _handle(handle) {}
 
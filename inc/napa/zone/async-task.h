@@ -0,0 +1,264 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+// Included by napa/async.h, after the async runner of the build declared PostAsyncWork, DoAsyncWork and PostDelayedCompletion.
+
+#include <napa/zone/async-work-pool.h>
+
+#include <v8.h>
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Result of an asynchronous task, either a value or the exception a step threw. </summary>
+    template <typename T>
+    class AsyncResult {
+    public:
+
+        /// <summary> Constructs a result holding a value. </summary>
+        explicit AsyncResult(T value) : _value(std::make_unique<T>(std::move(value))) {}
+
+        /// <summary> Constructs a result holding an exception. </summary>
+        explicit AsyncResult(std::exception_ptr error) : _error(std::move(error)) {}
+
+        /// <summary> Whether a step threw. </summary>
+        bool HasError() const {
+            return _error != nullptr;
+        }
+
+        /// <summary> Gets the exception a step threw, nullptr if none. </summary>
+        const std::exception_ptr& GetError() const {
+            return _error;
+        }
+
+        /// <summary> Gets the value, rethrows the exception if a step threw. </summary>
+        T& Get() {
+            if (_error != nullptr) {
+                std::rethrow_exception(_error);
+            }
+            return *_value;
+        }
+
+    private:
+        std::unique_ptr<T> _value;
+        std::exception_ptr _error;
+    };
+
+    namespace async_task_detail {
+
+        /// <summary> Whether a step takes the result of the previous step, or no argument. </summary>
+        template <typename F, typename T, typename = void>
+        struct TakesValue : std::false_type {};
+
+        template <typename F, typename T>
+        struct TakesValue<F, T, decltype(void(std::declval<F&>()(std::declval<T>())))> : std::true_type {};
+
+        template <typename F, typename T>
+        auto InvokeRaw(F& f, T&& value, std::true_type) -> decltype(f(std::move(value))) {
+            return f(std::move(value));
+        }
+
+        template <typename F, typename T>
+        auto InvokeRaw(F& f, T&&, std::false_type) -> decltype(f()) {
+            return f();
+        }
+
+        template <typename F, typename T>
+        using RawResult = decltype(InvokeRaw(std::declval<F&>(), std::declval<T>(), TakesValue<F, T>()));
+
+        /// <summary> Type of the result of a step, std::nullptr_t for steps returning void. </summary>
+        template <typename F, typename T>
+        using StepResult = typename std::conditional<std::is_void<RawResult<F, T>>::value,
+                                                     std::nullptr_t,
+                                                     typename std::decay<RawResult<F, T>>::type>::type;
+
+        template <typename F, typename T>
+        std::nullptr_t InvokeStep(F& f, T&& value, std::true_type) {
+            InvokeRaw(f, std::move(value), TakesValue<F, T>());
+            return nullptr;
+        }
+
+        template <typename F, typename T>
+        StepResult<F, T> InvokeStep(F& f, T&& value, std::false_type) {
+            return InvokeRaw(f, std::move(value), TakesValue<F, T>());
+        }
+
+        /// <summary> Runs a step with the result of the previous step, wrapping its result or exception. </summary>
+        template <typename F, typename T>
+        AsyncResult<StepResult<F, T>> Run(F& f, AsyncResult<T>& input) {
+            using R = StepResult<F, T>;
+            try {
+                return AsyncResult<R>(InvokeStep(f, std::move(input.Get()), std::is_void<RawResult<F, T>>()));
+            } catch (...) {
+                return AsyncResult<R>(std::current_exception());
+            }
+        }
+
+        /// <summary> Starts an operation that calls back, with the result of the previous step unless it takes none. </summary>
+        template <typename F, typename T, typename Complete>
+        auto StartRaw(F& f, T&& value, Complete complete, int) -> decltype(f(std::move(value), std::move(complete))) {
+            return f(std::move(value), std::move(complete));
+        }
+
+        template <typename F, typename T, typename Complete>
+        auto StartRaw(F& f, T&&, Complete complete, long) -> decltype(f(std::move(complete))) {
+            return f(std::move(complete));
+        }
+    }
+
+    /// <summary> A chain of asynchronous steps with typed results, which resumes on the worker that started it. </summary>
+    /// <remarks>
+    ///     It's the C++14 counterpart of awaiting in a coroutine, in place of callback-driven state machines on top of
+    ///     PostAsyncWork and DoAsyncWork: each step runs with the result of the previous one, on the worker (Then), on a
+    ///     thread of an async work pool (Post), after a delay (Delay), or when a callback-based operation completes (Await).
+    ///     Steps may take the previous result or no argument, and steps returning void produce std::nullptr_t.
+    ///     An exception thrown by a step skips the steps after it, up to Finally.
+    ///     Building a chain doesn't run anything, Finally starts it on the calling worker, or the Node event loop.
+    ///     Like PostAsyncWork, a chain keeps its napa worker from being removed or recycled until it completed.
+    /// </remarks>
+    template <typename T>
+    class AsyncTask {
+    public:
+
+        /// <summary> Function that continues the chain with the result of a step, on the worker. </summary>
+        using Resume = std::function<void(v8::Local<v8::Function>, AsyncResult<T>)>;
+
+        /// <summary> Function that runs the chain up to this task, then resumes with its result. </summary>
+        using Start = std::function<void(v8::Local<v8::Function>, Resume)>;
+
+        /// <summary> Constructs a task from the function starting it, see MakeAsyncTask for the first task of a chain. </summary>
+        explicit AsyncTask(Start start) : _start(std::move(start)) {}
+
+        /// <summary> Adds a step that runs on the worker. </summary>
+        /// <param name="step"> Function taking the previous result, or nothing, and returning the next result. </param>
+        template <typename F>
+        AsyncTask<async_task_detail::StepResult<F, T>> Then(F step) const {
+            using R = async_task_detail::StepResult<F, T>;
+
+            auto start = _start;
+            return AsyncTask<R>([start, step](v8::Local<v8::Function> jsCallback, typename AsyncTask<R>::Resume resume) {
+                start(jsCallback, [step, resume](v8::Local<v8::Function> jsCallback, AsyncResult<T> input) mutable {
+                    resume(jsCallback, async_task_detail::Run(step, input));
+                });
+            });
+        }
+
+        /// <summary> Adds a step that runs on a thread of an async work pool, then resumes on the worker. </summary>
+        /// <param name="step"> Function taking the previous result, or nothing, and returning the next result. </param>
+        /// <param name="pool"> The pool to run the step in, IO by default for work that may block. </param>
+        template <typename F>
+        AsyncTask<async_task_detail::StepResult<F, T>> Post(F step, AsyncWorkPool pool = AsyncWorkPool::IO) const {
+            using R = async_task_detail::StepResult<F, T>;
+
+            auto start = _start;
+            return AsyncTask<R>([start, step, pool](v8::Local<v8::Function> jsCallback, typename AsyncTask<R>::Resume resume) {
+                start(jsCallback, [step, pool, resume](v8::Local<v8::Function> jsCallback, AsyncResult<T> input) {
+                    if (input.HasError()) {
+                        resume(jsCallback, AsyncResult<R>(input.GetError()));
+                        return;
+                    }
+
+                    // The input is shared, as the work given to PostAsyncWork must be copyable.
+                    auto shared = std::make_shared<AsyncResult<T>>(std::move(input));
+                    PostAsyncWork(jsCallback,
+                        [step, shared]() mutable -> void* {
+                            return new AsyncResult<R>(async_task_detail::Run(step, *shared));
+                        },
+                        [resume](v8::Local<v8::Function> jsCallback, void* result) {
+                            std::unique_ptr<AsyncResult<R>> output(static_cast<AsyncResult<R>*>(result));
+                            resume(jsCallback, std::move(*output));
+                        },
+                        pool);
+                });
+            });
+        }
+
+        /// <summary> Adds a step that starts a callback-based operation on the worker, and resumes once it completes. </summary>
+        /// <param name="operation">
+        ///     Function taking the previous result, unless it takes only the completion, and a std::function&lt;void(R)&gt;
+        ///     that it must call once with the result. The completion can be called from any thread.
+        /// </param>
+        template <typename R, typename F>
+        AsyncTask<R> Await(F operation) const {
+            auto start = _start;
+            return AsyncTask<R>([start, operation](v8::Local<v8::Function> jsCallback, typename AsyncTask<R>::Resume resume) {
+                start(jsCallback, [operation, resume](v8::Local<v8::Function> jsCallback, AsyncResult<T> input) mutable {
+                    if (input.HasError()) {
+                        resume(jsCallback, AsyncResult<R>(input.GetError()));
+                        return;
+                    }
+
+                    DoAsyncWork(jsCallback,
+                        [&operation, &input](std::function<void(void*)> complete) {
+                            try {
+                                async_task_detail::StartRaw(operation, std::move(input.Get()), std::function<void(R)>([complete](R value) {
+                                    complete(new AsyncResult<R>(std::move(value)));
+                                }), 0);
+                            } catch (...) {
+                                complete(new AsyncResult<R>(std::current_exception()));
+                            }
+                        },
+                        [resume](v8::Local<v8::Function> jsCallback, void* result) {
+                            std::unique_ptr<AsyncResult<R>> output(static_cast<AsyncResult<R>*>(result));
+                            resume(jsCallback, std::move(*output));
+                        });
+                });
+            });
+        }
+
+        /// <summary> Adds a delay, after which the chain resumes on the worker with the same result. </summary>
+        AsyncTask<T> Delay(std::chrono::milliseconds delay) const {
+            auto start = _start;
+            return AsyncTask<T>([start, delay](v8::Local<v8::Function> jsCallback, Resume resume) {
+                start(jsCallback, [delay, resume](v8::Local<v8::Function> jsCallback, AsyncResult<T> input) {
+                    auto shared = std::make_shared<AsyncResult<T>>(std::move(input));
+                    PostDelayedCompletion(jsCallback, delay, [resume, shared](v8::Local<v8::Function> jsCallback, void*) {
+                        resume(jsCallback, std::move(*shared));
+                    });
+                });
+            });
+        }
+
+        /// <summary> Starts the chain on the calling worker, and calls a function with the result of its last step. </summary>
+        /// <param name="jsCallback"> Javascript callback, passed on to each step and to 'complete'. </param>
+        /// <param name="complete">
+        ///     Function called on the worker with the Javascript callback and the AsyncResult&lt;T&gt;, inside a v8::HandleScope.
+        /// </param>
+        /// <remarks> Steps that complete synchronously, e.g. Then steps at the start of the chain, run before it returns. </remarks>
+        template <typename F>
+        void Finally(v8::Local<v8::Function> jsCallback, F complete) const {
+            _start(jsCallback, [complete](v8::Local<v8::Function> jsCallback, AsyncResult<T> result) mutable {
+                complete(jsCallback, result);
+            });
+        }
+
+    private:
+        Start _start;
+    };
+
+    /// <summary> Makes the first task of a chain, which has the given result. </summary>
+    template <typename T>
+    AsyncTask<typename std::decay<T>::type> MakeAsyncTask(T&& value) {
+        using V = typename std::decay<T>::type;
+        return AsyncTask<V>([value = V(std::forward<T>(value))](v8::Local<v8::Function> jsCallback, typename AsyncTask<V>::Resume resume) {
+            resume(jsCallback, AsyncResult<V>(value));
+        });
+    }
+
+    /// <summary> Makes the first task of a chain, which has no result. </summary>
+    inline AsyncTask<std::nullptr_t> MakeAsyncTask() {
+        return MakeAsyncTask(nullptr);
+    }
+
+}   // End of namespace zone.
+}   // End of namespace napa.
@@ -0,0 +1,19 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Pools of threads that run asynchronous work. </summary>
+    enum class AsyncWorkPool {
+        /// <summary> For computation, with as many threads as processors by default. </summary>
+        CPU,
+
+        /// <summary> For work that blocks on I/O or other threads, with more threads than processors by default. </summary>
+        IO
+    };
+
+}   // End of namespace zone.
+}   // End of namespace napa.
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Lock-free inbox that any thread pushes items to, and a single consumer takes them all from at once. </summary>
+    /// <remarks>
+    ///     Items are linked through their 'nextCompletion' member, so pushing doesn't allocate.
+    ///     The inbox doesn't own its items.
+    /// </remarks>
+    template <typename T>
+    class CompletionInbox {
+    public:
+
+        CompletionInbox() : _head(nullptr) {}
+
+        CompletionInbox(const CompletionInbox&) = delete;
+        CompletionInbox& operator=(const CompletionInbox&) = delete;
+
+        /// <summary> Pushes an item. Called from any thread. </summary>
+        /// <returns> True if the inbox was empty, i.e. the consumer needs to be notified. </returns>
+        bool Push(T* item) {
+            auto head = _head.load(std::memory_order_relaxed);
+            do {
+                item->nextCompletion = head;
+            } while (!_head.compare_exchange_weak(head, item, std::memory_order_release, std::memory_order_relaxed));
+
+            return head == nullptr;
+        }
+
+        /// <summary> Takes all items. Called from the consumer. </summary>
+        /// <returns> The items linked in the order they were pushed, or nullptr if the inbox is empty. </returns>
+        T* TakeAll() {
+            auto head = _head.exchange(nullptr, std::memory_order_acquire);
+
+            // Items are pushed to the front, the list is reversed for the oldest one to come first.
+            T* first = nullptr;
+            while (head != nullptr) {
+                auto next = head->nextCompletion;
+                head->nextCompletion = first;
+                first = head;
+                head = next;
+            }
+            return first;
+        }
+
+        /// <summary> Whether the inbox is empty. </summary>
+        bool IsEmpty() const {
+            return _head.load(std::memory_order_acquire) == nullptr;
+        }
+
+    private:
+        std::atomic<T*> _head;
+    };
+}
+}
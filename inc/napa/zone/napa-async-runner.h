@@ -4,11 +4,15 @@
 #pragma once
 
 #include <napa/exports.h>
+#include <napa/zone/async-work-pool.h>
 
 #include <v8.h>
 
+#include <chrono>
 #include <functional>
 
+struct uv_loop_s;
+
 namespace napa {
 namespace zone {
 
@@ -33,9 +37,11 @@ namespace zone {
     /// <param name="jsCallback"> Javascript callback. </summary>
     /// <param name="asyncWork"> Function to run asynchronously in separate thread. </param>
     /// <param name="asyncCompleteCallback"> Callback running in V8 isolate after asynchronous callback completes. </param>
+    /// <param name="pool"> The process-wide pool whose threads run 'asyncWork', IO by default for work that may block. </param>
     NAPA_API void PostAsyncWork(v8::Local<v8::Function> jsCallback,
                                 AsyncWork asyncWork,
-                                AsyncCompleteCallback asyncCompleteCallback);
+                                AsyncCompleteCallback asyncCompleteCallback,
+                                AsyncWorkPool pool = AsyncWorkPool::IO);
 
     /// <summary> It runs an asynchronous function and post a completion into the current V8 execution loop. </summary>
     /// <param name="jsCallback"> Javascript callback. </summary>
@@ -45,5 +51,18 @@ namespace zone {
                               const CompletionWork& asyncWork,
                               AsyncCompleteCallback asyncCompleteCallback);
 
+    /// <summary> It posts a completion into the current V8 execution loop after a delay. </summary>
+    /// <param name="jsCallback"> Javascript callback. </summary>
+    /// <param name="delay"> Delay after which the completion is posted. </param>
+    /// <param name="asyncCompleteCallback"> Callback running in V8 isolate after the delay, with a null result. </param>
+    NAPA_API void PostDelayedCompletion(v8::Local<v8::Function> jsCallback,
+                                        std::chrono::milliseconds delay,
+                                        AsyncCompleteCallback asyncCompleteCallback);
+
+    /// <summary> It gets the libuv loop of the calling worker, to open libuv handles on. </summary>
+    /// <returns> The loop, or nullptr if the calling thread isn't a worker of a zone with the 'eventLoop' setting. </returns>
+    /// <remarks> Handles must be used on the worker only, handles left open are closed before its isolate is recycled. </remarks>
+    NAPA_API uv_loop_s* GetEventLoop();
+
 }   // End of namespace module.
 }   // End of namespace napa.
\ No newline at end of file
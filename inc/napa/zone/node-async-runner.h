@@ -6,6 +6,10 @@
 #include <node.h>
 #include <uv.h>
 
+#include <napa/zone/async-work-pool.h>
+#include <napa/zone/completion-inbox.h>
+
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -48,11 +52,8 @@ namespace zone {
         AsyncCompleteCallback asyncCompleteCallback;
     };
 
-    /// <summary> Class holding completion callback and libuv request. </summary>
+    /// <summary> Class holding a completion callback until it's run by NodeCompletions. </summary>
     struct CompletionContext {
-        /// <summary> libuv request. </summary>
-        uv_async_t work;
-
         /// <summary> Javascript callback. </summary>
         v8::Persistent<v8::Function> jsCallback;
 
@@ -61,6 +62,103 @@ namespace zone {
 
         /// <summary> Callback running in V8 isolate after asynchronous callback completes. </summary>
         AsyncCompleteCallback asyncCompleteCallback;
+
+        /// <summary> Next completion in the inbox. </summary>
+        CompletionContext* nextCompletion = nullptr;
+    };
+
+    /// <summary> Completions of asynchronous work started from node, which run in the node event loop. </summary>
+    /// <remarks>
+    ///     All completions share one libuv async handle. They accumulate in a lock-free inbox and only the first one
+    ///     into an empty inbox wakes up the loop, which then runs all completions in the inbox by then, so a burst of
+    ///     calls completing together costs a single wakeup, HandleScope and microtask checkpoint.
+    ///     The handle keeps the loop alive only while completions are pending.
+    /// </remarks>
+    class NodeCompletions {
+    public:
+
+        /// <summary> Gets the completions of the node event loop, creating them on first use from the loop thread. </summary>
+        static NodeCompletions& Get() {
+            // Never destroyed, as the handle lives as long as the loop.
+            static auto completions = new NodeCompletions();
+            return *completions;
+        }
+
+        NodeCompletions(const NodeCompletions&) = delete;
+        NodeCompletions& operator=(const NodeCompletions&) = delete;
+
+        /// <summary> Registers a completion to be posted later. Called from the loop thread. </summary>
+        void Expect() {
+            if (_pending++ == 0) {
+                uv_ref(reinterpret_cast<uv_handle_t*>(&_async));
+            }
+        }
+
+        /// <summary> Posts a completion registered with Expect. Called from any thread. </summary>
+        void Post(CompletionContext* context) {
+            if (_inbox.Push(context)) {
+                uv_async_send(&_async);
+            }
+        }
+
+    private:
+
+        NodeCompletions() {
+            _async.data = this;
+            uv_async_init(uv_default_loop(), &_async, Drain);
+            uv_unref(reinterpret_cast<uv_handle_t*>(&_async));
+        }
+
+        /// <summary> Runs the completions in the inbox, in the order they were posted. </summary>
+        static void Drain(uv_async_t* async) {
+            auto completions = static_cast<NodeCompletions*>(async->data);
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+
+            auto context = completions->_inbox.TakeAll();
+            if (context == nullptr) {
+                return;
+            }
+
+            {
+                // Run microtasks and next ticks queued by the callbacks once they return, e.g. continuations of promises they resolved.
+                node::CallbackScope callbackScope(isolate, v8::Object::New(isolate), { 0, 0 });
+
+                while (context != nullptr) {
+                    std::unique_ptr<CompletionContext> completion(context);
+                    context = context->nextCompletion;
+
+                    auto jsCallback = v8::Local<v8::Function>::New(isolate, completion->jsCallback);
+                    completion->asyncCompleteCallback(jsCallback, completion->result);
+                    completion->jsCallback.Reset();
+
+                    --completions->_pending;
+                }
+            }
+
+            if (completions->_pending == 0) {
+                uv_unref(reinterpret_cast<uv_handle_t*>(&completions->_async));
+            }
+        }
+
+        uv_async_t _async;
+
+        /// <summary> Completions expected and not run yet, only accessed from the loop thread. </summary>
+        size_t _pending = 0;
+
+        CompletionInbox<CompletionContext> _inbox;
+    };
+
+    /// <summary> Class holding a delayed completion callback and libuv timer. </summary>
+    struct DelayedCompletionContext {
+        /// <summary> libuv timer. </summary>
+        uv_timer_t timer;
+
+        /// <summary> Javascript callback. </summary>
+        v8::Persistent<v8::Function> jsCallback;
+
+        /// <summary> Callback running in V8 isolate after the delay. </summary>
+        AsyncCompleteCallback asyncCompleteCallback;
     };
 
     /// <summary> Callback run asynchronously in separate thread. </summary>
@@ -88,23 +186,31 @@ namespace zone {
             return;
         }
 
+        // Run microtasks and next ticks queued by the callback once it returns, e.g. continuations of promises it resolved.
+        node::CallbackScope callbackScope(isolate, v8::Object::New(isolate), { 0, 0 });
+
         auto jsCallback = v8::Local<v8::Function>::New(isolate, context->jsCallback);
         context->asyncCompleteCallback(jsCallback, context->result);
     }
 
-    /// <summary> Callback run in node event loop. </summary>
-    /// <param name="work"> libuv request holding asynchronous callbacks. </summary>
-    inline void RunCompletionCallback(uv_async_t* work) {
+    /// <summary> Callback run in node event loop once a delay elapsed. </summary>
+    /// <param name="timer"> libuv timer holding the completion callback. </summary>
+    inline void RunDelayedCompletionCallback(uv_timer_t* timer) {
         auto isolate = v8::Isolate::GetCurrent();
         v8::HandleScope scope(isolate);
 
-        auto context = static_cast<CompletionContext*>(work->data);
+        auto context = static_cast<DelayedCompletionContext*>(timer->data);
 
-        auto jsCallback = v8::Local<v8::Function>::New(isolate, context->jsCallback);
-        context->asyncCompleteCallback(jsCallback, context->result);
+        {
+            // Run microtasks and next ticks queued by the callback once it returns, e.g. continuations of promises it resolved.
+            node::CallbackScope callbackScope(isolate, v8::Object::New(isolate), { 0, 0 });
+
+            auto jsCallback = v8::Local<v8::Function>::New(isolate, context->jsCallback);
+            context->asyncCompleteCallback(jsCallback, nullptr);
+        }
 
-        uv_close(reinterpret_cast<uv_handle_t*>(work), [](auto work) {
-            auto context = static_cast<CompletionContext*>(work->data);
+        uv_close(reinterpret_cast<uv_handle_t*>(timer), [](auto timer) {
+            auto context = static_cast<DelayedCompletionContext*>(timer->data);
             context->jsCallback.Reset();
             delete context;
         });
@@ -114,10 +220,12 @@ namespace zone {
     /// <param name="jsCallback"> Javascript callback. </summary>
     /// <param name="asyncWork"> Function to run asynchronously in separate thread. </param>
     /// <param name="asyncCompleteCallback"> Callback running in V8 isolate after asynchronous callback completes. </param>
+    /// <param name="pool"> Unused, node runs all asynchronous work in the libuv thread pool. </param>
     /// <remarks> Return value from 'asyncWork' will be the input to 'asyncCompleteCallback'. </remarks>
     inline void PostAsyncWork(v8::Local<v8::Function> jsCallback,
                               AsyncWork asyncWork,
-                              AsyncCompleteCallback asyncCompleteCallback) {
+                              AsyncCompleteCallback asyncCompleteCallback,
+                              AsyncWorkPool pool = AsyncWorkPool::IO) {
         auto isolate = v8::Isolate::GetCurrent();
         v8::HandleScope scope(isolate);
 
@@ -144,18 +252,44 @@ namespace zone {
 
         auto context = new CompletionContext();
 
-        context->work.data = context;
         context->jsCallback.Reset(isolate, jsCallback);
         context->asyncCompleteCallback = std::move(asyncCompleteCallback);
 
-        uv_async_init(uv_default_loop(), &context->work, RunCompletionCallback);
+        auto& completions = NodeCompletions::Get();
+        completions.Expect();
 
-        asyncWork([context](void* result) {
+        asyncWork([context, &completions](void* result) {
             context->result = result;
 
-            uv_async_send(&context->work);
+            completions.Post(context);
         });
     }
 
+    /// <summary> It posts a completion into the current V8 execution loop after a delay. </summary>
+    /// <param name="jsCallback"> Javascript callback. </summary>
+    /// <param name="delay"> Delay after which the completion is posted. </param>
+    /// <param name="asyncCompleteCallback"> Callback running in V8 isolate after the delay, with a null result. </param>
+    inline void PostDelayedCompletion(v8::Local<v8::Function> jsCallback,
+                                      std::chrono::milliseconds delay,
+                                      AsyncCompleteCallback asyncCompleteCallback) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        auto context = new DelayedCompletionContext();
+
+        context->timer.data = context;
+        context->jsCallback.Reset(isolate, jsCallback);
+        context->asyncCompleteCallback = std::move(asyncCompleteCallback);
+
+        uv_timer_init(uv_default_loop(), &context->timer);
+        uv_timer_start(&context->timer, RunDelayedCompletionCallback, static_cast<uint64_t>(delay.count()), 0);
+    }
+
+    /// <summary> It gets the libuv loop of the calling thread, to open libuv handles on. </summary>
+    /// <returns> The node event loop. </returns>
+    inline uv_loop_t* GetEventLoop() {
+        return uv_default_loop();
+    }
+
 }   // End of namespace module.
 }   // End of namespace napa.
@@ -0,0 +1,165 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as transport from './transport';
+
+let binding = require('./binding');
+
+/// <summary> Status of a MessageChannelWrap.send. Reference: napa::zone::MessageChannel::SendStatus. </summary>
+const SEND_SENT = 0;
+const SEND_FULL = 1;
+
+/// <summary> Number of messages a channel queues by default. </summary>
+export const DEFAULT_CAPACITY: number = 1024;
+
+/// <summary> Options of a channel. </summary>
+export interface ChannelOptions {
+    /// <summary> Number of messages that can be queued before senders wait, rounded up to a power of two. </summary>
+    capacity?: number;
+
+    /// <summary> Whether messages are marshalled by V8 ValueSerializer instead of JSON, see transport.marshallBinary. </summary>
+    binary?: boolean;
+}
+
+/// <summary>
+///     Bounded queue of messages between workers of any zones and Node.js.
+///     A channel is transportable: passed to zone.execute, or sent over another channel, it refers to the same queue.
+///     Messages are marshalled on send and unmarshalled on receive, thus values are copied, except shared objects.
+/// </summary>
+export class Channel extends transport.AutoTransportable {
+    private _channel: any;
+    private _binary: boolean;
+    private _receiving: Promise<any>;
+
+    constructor(channel?: any, binary: boolean = false) {
+        super();
+        this._channel = channel;
+        this._binary = binary;
+    }
+
+    /// <summary> Whether the channel accepts no more messages. </summary>
+    get closed(): boolean {
+        return this._channel.closed;
+    }
+
+    /// <summary> Number of queued messages. </summary>
+    get size(): number {
+        return this._channel.size;
+    }
+
+    /// <summary> Number of messages that can be queued. </summary>
+    get capacity(): number {
+        return this._channel.capacity;
+    }
+
+    /// <summary> Sends a message, waiting for room while the channel is full. </summary>
+    /// <returns> A promise of true once the message is queued, false if the channel is closed. </returns>
+    send(value: any): Promise<boolean> {
+        let context = transport.createTransportContext(true);
+        let payload = this.marshall(value, context);
+
+        let send = (): Promise<boolean> => {
+            // A message that isn't queued is left to the sender, the same payload and context are sent again.
+            let status = this._channel.send(payload, context);
+            if (status !== SEND_FULL) {
+                return Promise.resolve(status === SEND_SENT);
+            }
+            return new Promise<boolean>(resolve => {
+                this._channel.waitWritable(resolve);
+            }).then(open => open ? send() : false);
+        };
+        return send();
+    }
+
+    /// <summary> Sends a message without waiting. </summary>
+    /// <returns> True if the message is queued, false if the channel is full or closed. </returns>
+    trySend(value: any): boolean {
+        let context = transport.createTransportContext(true);
+        return this._channel.send(this.marshall(value, context), context) === SEND_SENT;
+    }
+
+    /// <summary> Receives the next message, waiting for one while the channel is empty. </summary>
+    /// <returns> A promise of the message, or of done once the channel is closed and drained. </returns>
+    receive(): Promise<IteratorResult<any>> {
+        // Receives of a channel object complete in the order they are called.
+        if (this._receiving == null) {
+            this._receiving = Promise.resolve();
+        }
+        let receive = this._receiving.then(() => new Promise<IteratorResult<any>>((resolve, reject) => {
+            this._channel.receive((payload: string | ArrayBuffer, context: transport.TransportContext) => {
+                if (payload === undefined) {
+                    resolve({ done: true, value: undefined });
+                    return;
+                }
+                try {
+                    resolve({ done: false, value: this.unmarshall(payload, context) });
+                } catch (e) {
+                    reject(e);
+                }
+            });
+        }));
+        this._receiving = receive.catch(() => {});
+        return receive;
+    }
+
+    /// <summary> Receives the next message without waiting. </summary>
+    /// <returns> The message, done if the channel is closed and drained, or undefined if it's empty but open. </returns>
+    tryReceive(): IteratorResult<any> | undefined {
+        let received = this._channel.tryReceive();
+        if (received === undefined) {
+            // A message may be queued between an empty receive and a close, the closed channel is checked again.
+            if (!this._channel.closed) {
+                return undefined;
+            }
+            received = this._channel.tryReceive();
+            if (received === undefined) {
+                return { done: true, value: undefined };
+            }
+        }
+        return { done: false, value: this.unmarshall(received[0], received[1]) };
+    }
+
+    /// <summary> Closes the channel. Later sends are dropped, queued messages are still received. </summary>
+    close(): void {
+        this._channel.close();
+    }
+
+    /// <summary> Saves the native channel and the message format, receives in progress stay with this object. </summary>
+    save(payload: object, context: transport.TransportContext) {
+        (<any>payload)['_channel'] = transport.marshallTransform(this._channel, context);
+        (<any>payload)['_binary'] = this._binary;
+    }
+
+    /// <summary> Same as receive, so a channel is an async iterator of its messages. </summary>
+    next(): Promise<IteratorResult<any>> {
+        return this.receive();
+    }
+
+    private marshall(value: any, context: transport.TransportContext): string | ArrayBuffer {
+        return this._binary ? transport.marshallBinary(value, context) : transport.marshall(value, context);
+    }
+
+    private unmarshall(payload: string | ArrayBuffer, context: transport.TransportContext): any {
+        return typeof payload === 'string' ?
+            transport.unmarshall(payload, context) :
+            transport.unmarshallBinary(payload, context);
+    }
+}
+
+transport.cid(module.id)(Channel);
+
+// Make Channel usable in for-await loops where async iteration is supported.
+let asyncIterator = (<any>Symbol).asyncIterator;
+if (asyncIterator !== undefined) {
+    (<any>Channel.prototype)[asyncIterator] = function() { return this; };
+}
+
+/// <summary> Creates a channel, which can be transported to workers of any zones. </summary>
+/// <param name="options"> Options of the channel, DEFAULT_CAPACITY and JSON messages by default. </param>
+export function create(options: ChannelOptions = {}): Channel {
+    let capacity = options.capacity !== undefined ? options.capacity : DEFAULT_CAPACITY;
+    if (!(capacity > 0) || Math.floor(capacity) !== capacity) {
+        throw new Error(`Channel capacity must be a positive integer, but got ${capacity}.`);
+    }
+    return new Channel(binding.createMessageChannel(capacity), !!options.binary);
+}
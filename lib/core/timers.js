@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// Timers of zone workers, which have no event loop of their own. Callbacks run as tasks on the worker
+// that set them, between other tasks of the worker. Pending timers keep the worker from being removed
+// or recycled until they fire or are cleared.
+
+var binding = process.binding('timer_wrap');
+var timers = exports;
+
+// Same limit as node.js, larger delays are set to 1.
+var TIMEOUT_MAX = 2147483647;
+
+var pending = {};
+var nextId = 1;
+
+function Timeout(callback, args, delay, repeat) {
+    this._id = nextId++;
+    this._callback = callback;
+    this._args = args;
+    this._delay = delay;
+    this._repeat = repeat;
+}
+
+// 'ref' and 'unref' are kept for compatibility, workers have no event loop to keep alive.
+Timeout.prototype.ref = function() {
+    return this;
+}
+
+Timeout.prototype.unref = function() {
+    return this;
+}
+
+Timeout.prototype.hasRef = function() {
+    return true;
+}
+
+Timeout.prototype.refresh = function() {
+    if (pending[this._id] === this) {
+        binding.start(this._id, this._delay);
+    }
+    return this;
+}
+
+Timeout.prototype[Symbol.toPrimitive] = function() {
+    return this._id;
+}
+
+function Immediate(callback, args) {
+    Timeout.call(this, callback, args, 0, false);
+}
+
+Immediate.prototype = Object.create(Timeout.prototype);
+
+function dispatch(id) {
+    var timeout = pending[id];
+    if (timeout === undefined) {
+        return;
+    }
+
+    // Re-arm intervals before the callback, so it can clear them.
+    if (timeout._repeat) {
+        binding.start(id, timeout._delay);
+    } else {
+        delete pending[id];
+    }
+
+    timeout._callback.apply(undefined, timeout._args);
+}
+
+// The dispatcher is set on first use, the module may be loaded before the isolate is bound to a worker.
+var dispatcherSet = false;
+
+function getArgs(args, start) {
+    return args.length > start ? Array.prototype.slice.call(args, start) : [];
+}
+
+function getDelay(delay) {
+    delay = Number(delay);
+    return delay >= 1 && delay <= TIMEOUT_MAX ? Math.floor(delay) : 1;
+}
+
+function start(timeout) {
+    if (!dispatcherSet) {
+        binding.setDispatcher(dispatch);
+        dispatcherSet = true;
+    }
+
+    pending[timeout._id] = timeout;
+    binding.start(timeout._id, timeout._delay);
+    return timeout;
+}
+
+function clear(timeout) {
+    if (timeout === undefined || timeout === null) {
+        return;
+    }
+
+    var id = typeof timeout === 'number' ? timeout : timeout._id;
+    if (pending[id] !== undefined) {
+        delete pending[id];
+        binding.cancel(id);
+    }
+}
+
+function checkCallback(callback) {
+    if (typeof callback !== 'function') {
+        throw new TypeError('"callback" argument must be a function');
+    }
+}
+
+timers.setTimeout = function(callback, delay) {
+    checkCallback(callback);
+    return start(new Timeout(callback, getArgs(arguments, 2), getDelay(delay), false));
+}
+
+timers.setInterval = function(callback, delay) {
+    checkCallback(callback);
+    return start(new Timeout(callback, getArgs(arguments, 2), getDelay(delay), true));
+}
+
+timers.setImmediate = function(callback) {
+    checkCallback(callback);
+    return start(new Immediate(callback, getArgs(arguments, 1)));
+}
+
+timers.clearTimeout = clear;
+timers.clearInterval = clear;
+timers.clearImmediate = clear;
@@ -1,20 +1,32 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+import * as channel from './channel';
+import * as kernels from './kernels';
 import { log } from './log';
 import * as memory from './memory';
 import * as metric from './metric';
 import * as runtime from './runtime';
 import * as store from './store';
+import * as tracing from './tracing';
 import * as transport from './transport';
 import * as v8 from './v8';
 import * as zone from './zone';
 
-export { log, memory, metric, runtime, store, transport, v8, zone };
+export { channel, kernels, log, memory, metric, runtime, store, tracing, transport, v8, zone };
 
-// Add execute proxy to global context.
-import { call } from './zone/function-call';
+// Memory pressure concerns all zones, thus it's exported at the top level as well.
+export { memoryPressure, MemoryPressureLevel } from './memory';
+
+// Add execute proxies to global context.
+import { call, resolve, finish } from './zone/function-call';
 (<any>(global))["__napa_zone_call__"] = call;
+(<any>(global))["__napa_zone_resolve__"] = resolve;
+(<any>(global))["__napa_zone_finish__"] = finish;
+
+// Let worker caches release entries on memory pressure.
+import { onMemoryPressure } from './zone/worker-cache';
+(<any>(global))["__napa_memory_pressure__"] = onMemoryPressure;
 
 // Export 'napa' in global for all isolates that require napajs.
 (<any>(global))["napa"] = exports;
\ No newline at end of file
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import { Zone, Result } from './zone';
+
+let binding = require('./binding');
+
+/// <summary> Typed arrays kernels run over, read and written in place. </summary>
+export type FloatArray = Float32Array | Float64Array;
+
+/// <summary> Instruction set kernels of Float32Array use on this CPU, i.e. 'avx2', 'sse2', 'neon' or 'scalar'. </summary>
+export const simdLevel: string = binding.kernels.simdLevel;
+
+/// <summary> Sums values of x. </summary>
+export function sum(x: FloatArray): number {
+    return binding.kernels.sum(x);
+}
+
+/// <summary> Dot product of x and y, which are of the same type and length. </summary>
+export function dot(x: FloatArray, y: FloatArray): number {
+    return binding.kernels.dot(x, y);
+}
+
+/// <summary> Adds a times x to y in place, i.e. y[i] += a * x[i]. </summary>
+/// <returns> y. </returns>
+export function axpy<T extends FloatArray>(a: number, x: T, y: T): T {
+    return binding.kernels.axpy(a, x, y);
+}
+
+/// <summary> Gets the index of the first largest value, NaNs skipped. </summary>
+/// <returns> The index, -1 if x is empty or only has NaNs. </returns>
+export function argmax(x: FloatArray): number {
+    return binding.kernels.argmax(x);
+}
+
+/// <summary> Gets indices of the k largest values, NaNs skipped, in descending order of values, then ascending order of indices. </summary>
+export function topK(x: FloatArray, k: number): Uint32Array {
+    return binding.kernels.topK(x, k);
+}
+
+/// <summary> Counts values of x into bins of equal width over [min, max]. Out of range values and NaNs are not counted. </summary>
+/// <param name="counts"> Counts to add to, e.g. of other parts of the input. By default new counts are returned. </param>
+export function histogram(x: FloatArray, min: number, max: number, bins: number, counts?: Uint32Array): Uint32Array {
+    return binding.kernels.histogram(x, min, max, bins, counts);
+}
+
+/// <summary> Sorts x in ascending order in place, NaNs last. </summary>
+/// <returns> x. </returns>
+export function sort<T extends FloatArray>(x: T): T {
+    return binding.kernels.sort(x);
+}
+
+/// <summary> Splits [0, length) into up to 'parts' ranges of about equal length. </summary>
+/// <returns> Ranges as [begin, end) pairs, none if length is 0. </returns>
+export function split(length: number, parts: number): [number, number][] {
+    parts = Math.max(1, Math.min(Math.floor(parts), length));
+    let ranges: [number, number][] = [];
+    for (let i = 0; i < parts && length > 0; ++i) {
+        ranges.push([Math.floor(length * i / parts), Math.floor(length * (i + 1) / parts)]);
+    }
+    return ranges;
+}
+
+function ensureShared(x: FloatArray) {
+    if (!(x.buffer instanceof SharedArrayBuffer)) {
+        throw new TypeError('Parallel kernels take typed arrays over a SharedArrayBuffer.');
+    }
+}
+
+/// <summary>
+///     Sums x over a SharedArrayBuffer with workers of a zone, each summing a part of it in place.
+///     Worth it for inputs of megabytes, below that a call costs more than the kernel.
+/// </summary>
+/// <param name="parts"> Number of parts, by default the number of workers of the zone. </param>
+export function parallelSum(zone: Zone, x: FloatArray, parts?: number): Promise<number> {
+    ensureShared(x);
+    let calls = split(x.length, parts || zone.workers).map(([begin, end]) =>
+        zone.execute((x: FloatArray, begin: number, end: number) => {
+            return (<any>global).napa.kernels.sum(x.subarray(begin, end));
+        }, [x, begin, end]));
+
+    return Promise.all(calls).then((results: Result[]) =>
+        results.reduce((total: number, result: Result) => total + result.value, 0));
+}
+
+/// <summary> Dot product of x and y over SharedArrayBuffers with workers of a zone, each on a part of them. </summary>
+/// <param name="parts"> Number of parts, by default the number of workers of the zone. </param>
+export function parallelDot(zone: Zone, x: FloatArray, y: FloatArray, parts?: number): Promise<number> {
+    ensureShared(x);
+    ensureShared(y);
+    if (x.length !== y.length) {
+        throw new RangeError('Arguments x and y must be of the same length.');
+    }
+    let calls = split(x.length, parts || zone.workers).map(([begin, end]) =>
+        zone.execute((x: FloatArray, y: FloatArray, begin: number, end: number) => {
+            return (<any>global).napa.kernels.dot(x.subarray(begin, end), y.subarray(begin, end));
+        }, [x, y, begin, end]));
+
+    return Promise.all(calls).then((results: Result[]) =>
+        results.reduce((total: number, result: Result) => total + result.value, 0));
+}
+
+/// <summary> Histogram of x over a SharedArrayBuffer with workers of a zone, counts of the parts summed up. </summary>
+/// <param name="parts"> Number of parts, by default the number of workers of the zone. </param>
+export function parallelHistogram(zone: Zone, x: FloatArray, min: number, max: number, bins: number, parts?: number): Promise<Uint32Array> {
+    ensureShared(x);
+    let calls = split(x.length, parts || zone.workers).map(([begin, end]) =>
+        zone.execute((x: FloatArray, min: number, max: number, bins: number, begin: number, end: number) => {
+            return (<any>global).napa.kernels.histogram(x.subarray(begin, end), min, max, bins);
+        }, [x, min, max, bins, begin, end]));
+
+    return Promise.all(calls).then((results: Result[]) => {
+        let counts = new Uint32Array(bins);
+        for (let result of results) {
+            for (let i = 0; i < bins; ++i) {
+                counts[i] += result.value[i];
+            }
+        }
+        return counts;
+    });
+}
@@ -25,6 +25,10 @@ export interface Log extends LogFunction {
     debug(message: string): void;
     debug(section: string, message: string): void;
     debug(section: string, traceId: string, message: string): void;
+
+    /// <summary> Sets the most verbose level logged, for a section or for sections without a level of their own. </summary>
+    /// <param name="level"> One of 'error', 'warn', 'info' and 'debug'. </param>
+    setLevel(level: string, section?: string): void;
 }
 
 export let log: Log = createLogObject();
@@ -36,6 +40,13 @@ enum LogLevel {
     Debug = 3,
 }
 
+const LOG_LEVELS: { [name: string]: LogLevel } = {
+    'error': LogLevel.Error,
+    'warn': LogLevel.Warning,
+    'info': LogLevel.Info,
+    'debug': LogLevel.Debug,
+};
+
 function dispatchLog(level: LogLevel, arg1: string, arg2?: string, arg3?: string) {
     if (arg3 != undefined) {
         binding.log(level, arg1, arg2, arg3);
@@ -74,5 +85,14 @@ function createLogObject() : Log {
         dispatchLog(LogLevel.Debug, arg1, arg2, arg3);
     }
 
+    // napa.log.setLevel()
+    logObj.setLevel = function(level: string, section?: string) {
+        let value = LOG_LEVELS[level];
+        if (value === undefined) {
+            throw new Error(`Unknown log level '${level}', expected one of ${Object.keys(LOG_LEVELS).join(', ')}.`);
+        }
+        binding.setLogLevel(value, section);
+    }
+
     return logObj;
 }
\ No newline at end of file
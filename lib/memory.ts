@@ -3,4 +3,5 @@
 
 export * from './memory/allocator';
 export * from './memory/handle';
+export * from './memory/pressure';
 export * from './memory/shareable';
@@ -12,6 +12,15 @@ export interface Allocator extends Shareable {
     /// <param name="size"> Size in bytes to allocate. </param>
     allocate(size: number): Handle;
 
+    /// <summary> Allocate memory of requested size in bytes as an ArrayBuffer, which JS reads and writes in place. </summary>
+    /// <param name="size"> Size in bytes to allocate. </param>
+    /// <remarks>
+    ///     The memory is deallocated through the allocator once the buffer is garbage collected in all isolates it was
+    ///     passed to. Passing the buffer to other isolates, e.g. as an argument of zone.execute or a store value,
+    ///     shares the memory instead of copying it, thus writes are seen by all of them.
+    /// </remarks>
+    allocateBuffer(size: number): ArrayBuffer;
+
     /// <summary> Deallocate memory of requested handle. </summary>
     /// <param name="handle"> Handle of memory to deallocate. </param>
     /// <param name="sizeHint"> Hint for the size of memory to deallocate. Pass 0 if unknown. </param>
@@ -35,8 +44,24 @@ export let crtAllocator: Allocator = binding.getCrtAllocator();
 /// <summary> Export default allocator from napa.dll. </summary>
 export let defaultAllocator: Allocator = binding.getDefaultAllocator();
 
+/// <summary> Export size-class allocator with per thread caches from napa.dll, whose memory can be released on any thread. </summary>
+export let threadCachingAllocator: Allocator = binding.getThreadCachingAllocator();
+
+/// <summary> Export the pool of ArrayBuffer contents from napa.dll, whose debug info reports its usage. </summary>
+export let arrayBufferPool: AllocatorDebugger = binding.getArrayBufferPool();
+
+/// <summary> Options of debugAllocator. </summary>
+export interface DebugAllocatorOptions {
+    /// <summary> Whether to report a histogram of sizes, live and peak live size and call sites, false by default. </summary>
+    histogram?: boolean;
+
+    /// <summary> Captures the stack of one allocation out of this many, reported while it's alive. 0 (by default) to disable. Implies histogram. </summary>
+    sampleRate?: number;
+}
+
 /// <summary> Create a debug allocator around allocator. </summary>
 /// <param name="allocator"> User allocator. </param>
-export function debugAllocator(allocator: Allocator): AllocatorDebugger {
-    return new binding.AllocatorDebuggerWrap(allocator);
+/// <param name="options"> Options of what to report, only totals of allocations by default. </param>
+export function debugAllocator(allocator: Allocator, options?: DebugAllocatorOptions): AllocatorDebugger {
+    return new binding.AllocatorDebuggerWrap(allocator, options);
 }
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+/// <summary> Describes how close the host is to running out of memory. </summary>
+export enum MemoryPressureLevel {
+
+    /// <summary> Memory pressure is gone, isolates grow their heaps as usual again. </summary>
+    NONE,
+
+    /// <summary> Isolates collect garbage more eagerly. </summary>
+    MODERATE,
+
+    /// <summary> Isolates collect garbage right away and shrink their heaps, napa allocator caches are released. </summary>
+    CRITICAL,
+}
+
+let binding = require('../binding');
+
+declare var __in_napa: boolean;
+
+/// <summary> Notifies isolates of all zone workers, and the calling isolate, of memory pressure. </summary>
+/// <param name="level"> The level, which stays in effect until another level is notified. </param>
+/// <remarks> Workers running JavaScript are interrupted, idle ones are notified ahead of queued calls. It doesn't wait for workers. </remarks>
+export function memoryPressure(level: MemoryPressureLevel): void {
+    binding.memoryPressure(level);
+
+    // Zone workers release JavaScript caches as they are notified, including the calling one, Node does right away.
+    let hook = (<any>global)['__napa_memory_pressure__'];
+    if (typeof __in_napa === 'undefined' && typeof hook === 'function') {
+        hook(level);
+    }
+}
@@ -16,6 +16,16 @@ export interface Metric {
     set(value: number, dimensions?: string[]): void;
     increment(dimensions?: string[]): void;
     decrement(dimensions?: string[]): void;
+
+    /// <summary> Binds dimension values once, for a metric updated often with the same values. </summary>
+    bind(dimensions?: string[]): BoundMetric;
+}
+
+/// <summary> A metric with its dimension values bound, whose updates don't pass or convert them. </summary>
+export interface BoundMetric {
+    set(value: number): void;
+    increment(): void;
+    decrement(): void;
 }
 
 /// <summary> A cache for metric wraps. </summary>
@@ -38,3 +48,42 @@ export function get(section: string, name: string, type: MetricType, dimensions:
 
     return metricWrap;
 }
+
+/// <summary> The values of a metric for one combination of dimension values. </summary>
+export interface MetricSeriesSnapshot {
+    /// <summary> Dimension values, in the order of the dimension names of the metric. </summary>
+    readonly dimensions: string[];
+
+    /// <summary> Value of a Number or Rate metric, or sum of the values set on a Percentile metric. </summary>
+    readonly value: number;
+
+    /// <summary> Number of values set on a Percentile metric, and their min and max. </summary>
+    readonly count?: number;
+    readonly min?: number;
+    readonly max?: number;
+
+    /// <summary> Values of a Percentile metric, by percentile. </summary>
+    readonly percentiles?: { [percentile: string]: number };
+}
+
+/// <summary> The values of a metric. </summary>
+export interface MetricSnapshot {
+    readonly section: string;
+    readonly name: string;
+    readonly type: MetricType;
+    readonly dimensionNames: string[];
+    readonly series: MetricSeriesSnapshot[];
+}
+
+/// <summary> Percentiles reported for Percentile metrics by default. </summary>
+export const DEFAULT_PERCENTILES: number[] = [50, 90, 99, 99.9];
+
+/// <summary> Gets the values of all metrics, which requires the 'in-process' metric provider. </summary>
+export function snapshot(percentiles: number[] = DEFAULT_PERCENTILES): MetricSnapshot[] {
+    return binding.getMetricSnapshots(percentiles);
+}
+
+/// <summary> Gets the values of all metrics in the Prometheus text format, which requires the 'in-process' metric provider. </summary>
+export function exportPrometheus(percentiles: number[] = DEFAULT_PERCENTILES): string {
+    return binding.exportMetrics(percentiles);
+}
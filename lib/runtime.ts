@@ -2,5 +2,9 @@
 // Licensed under the MIT license.
 
 export { 
-    setPlatformSettings
+    setPlatformSettings,
+    clearModuleResolutionCache,
+    invalidateModule,
+    saveModuleBundle,
+    ModuleBundleOptions
 } from './runtime/platform';
@@ -3,6 +3,7 @@
 
 let binding = require('../binding');
 import { log } from '../log';
+import * as path from 'path';
 
 // This variable is either defined by napa runtime, or not defined (hence node runtime)
 declare var __in_napa: boolean;
@@ -15,8 +16,86 @@ export interface PlatformSettings {
     /// <summary> The logging provider to use when outputting logs. </summary>
     loggingProvider?: string;
 
-    /// <summary> The metric provider to use when creating/setting metric values. </summary>
+    /// <summary> The file the 'async' logging provider appends logs to, the standard output by default. </summary>
+    logFile?: string;
+
+    /// <summary> The number of messages each thread can queue with the 'async' logging provider, 256 by default. </summary>
+    logBufferSize?: number;
+
+    /// <summary> The format of the file written by the 'async' logging provider, 'text' (by default) or 'binary'. </summary>
+    logFormat?: string;
+
+    /// <summary>
+    ///     How console.log of zone workers writes lines: 'async' (by default) in batches on a background thread,
+    ///     'sync' on the calling worker, or 'node' in batches by the Node.js main thread through process.stdout.
+    /// </summary>
+    consoleOutput?: string;
+
+    /// <summary> Number of lines per second each zone worker may write with console.log, beyond which lines are dropped. 0 (by default) for no limit. </summary>
+    consoleRateLimit?: number;
+
+    /// <summary> The metric provider to use when creating/setting metric values, 'in-process' to read them by metric.snapshot(). </summary>
     metricProvider?: string;
+
+    /// <summary> Name of the shared memory segment metric provider 'shared-memory' lays metrics out in, 'napa-metrics-<pid>' by default. </summary>
+    metricSegment?: string;
+
+    /// <summary> Size in MB of the shared memory segment of metric provider 'shared-memory', 16 by default. </summary>
+    metricSegmentSize?: number;
+
+    /// <summary> Number of bootstrapped isolates kept aside for new zones to start on, 0 by default. </summary>
+    spareIsolates?: number;
+
+    /// <summary> Path of a V8 startup snapshot made by the same V8 version, to create napa isolates from. </summary>
+    snapshotBlob?: string;
+
+    /// <summary> Directory to persist code caches of Javascript modules in, so later processes skip compiling them. </summary>
+    codeCacheDirectory?: string;
+
+    /// <summary> Whether Javascript modules are loaded as node.js style function wrappers, instead of a context per module. </summary>
+    moduleWrappers?: boolean;
+
+    /// <summary> Whether file system lookups of module resolution are cached, including misses, until clearModuleResolutionCache() is called. </summary>
+    moduleStatCache?: boolean;
+
+    /// <summary> How workers load JSON modules: 'parse' (by default) each, 'shared' to parse once per process, or 'frozen' to also deep-freeze them. </summary>
+    jsonModules?: string;
+
+    /// <summary> Path of a module bundle written by saveModuleBundle(), to serve the modules it holds from. </summary>
+    moduleBundle?: string;
+
+    /// <summary> Interval in milliseconds to poll files of loaded modules at, and reload the changed ones in all zones. 0 (by default) to disable. </summary>
+    moduleWatchInterval?: number;
+
+    /// <summary> Backend of napa_allocate used by native modules, 'crt' (by default) or 'threadCaching'. </summary>
+    allocator?: string;
+
+    /// <summary> Total size in MB of released ArrayBuffer contents that napa isolates keep for reuse, 0 (by default) to disable pooling. </summary>
+    arrayBufferPoolSize?: number;
+
+    /// <summary> Whether pooled ArrayBuffers of 2MB or more are backed by huge pages where supported, false by default. </summary>
+    arrayBufferHugePages?: boolean;
+
+    /// <summary> Number of threads running CPU bound async work of native modules, the number of processors by default. </summary>
+    asyncCpuWorkers?: number;
+
+    /// <summary> Number of threads running async work of native modules that may block, 16 by default. </summary>
+    asyncIoWorkers?: number;
+
+    /// <summary> Factor V8 grows semi spaces of all isolates by, up to their maximum size, the V8 default of 2 by default. </summary>
+    semiSpaceGrowthFactor?: number;
+
+    /// <summary> Number of threads running background tasks of V8 for all napa isolates, the number of processors by default. Ignored in Node.js. </summary>
+    v8PlatformThreads?: number;
+
+    /// <summary> Number of zone workers of all zones running tasks at the same time, 0 (by default) for no limit. </summary>
+    cpuBudget?: number;
+
+    /// <summary> Number of threads workers of zones with setting sharedThreads take turns on, 0 (by default) for the number of processors. </summary>
+    sharedWorkerThreads?: number;
+
+    /// <summary> Directory recent events of workers are dumped to when V8 hits a fatal error or runs out of memory, the current directory by default. </summary>
+    flightRecorderDirectory?: string;
 }
 
 /// <summary> Initialization of napa is only needed if we run in node. </summary>
@@ -42,5 +121,52 @@ export function initialize() {
         // Guard initialization, should only be called once.
         binding.initialize(_platformSettings);
         _initializationNeeded = false;
+
+        if (_platformSettings.consoleOutput === 'node') {
+            forwardConsoleOutput();
+        }
     }
 }
+
+/// <summary> Interval in milliseconds at which Node writes console output of zone workers. </summary>
+const CONSOLE_FORWARD_INTERVAL = 20;
+
+/// <summary> Writes console output of zone workers to process.stdout in batches, without keeping Node alive. </summary>
+function forwardConsoleOutput() {
+    let write = () => {
+        let output: string = binding.takeConsoleOutput();
+        if (output.length > 0) {
+            process.stdout.write(output);
+        }
+    };
+    setInterval(write, CONSOLE_FORWARD_INTERVAL).unref();
+    process.on('exit', write);
+}
+
+/// <summary> Forgets module resolutions shared by all zones of the process, e.g. after module files were added or removed. </summary>
+/// <remarks> Modules already loaded by a worker stay cached in that worker. </remarks>
+export function clearModuleResolutionCache() {
+    binding.clearModuleResolutionCache();
+}
+
+/// <summary> Makes workers of all zones load a module again on their next require(), e.g. after its file was changed. </summary>
+/// <param name="modulePath"> Path of the module file, relative to the current directory if not absolute. </param>
+/// <remarks> Modules that required it before keep the exports they got, other cached modules are not reloaded. </remarks>
+export function invalidateModule(modulePath: string) {
+    binding.invalidateModule(path.resolve(modulePath));
+}
+
+/// <summary> Options of saveModuleBundle(). </summary>
+export interface ModuleBundleOptions {
+    /// <summary> Whether to compile Javascript modules and keep their code caches in the bundle, false by default. </summary>
+    codeCache?: boolean;
+}
+
+/// <summary> Writes a bundle of the modules that entries require, directly or not, to be loaded by the 'moduleBundle' setting. </summary>
+/// <param name="path"> Path of the bundle file. Module paths are kept relative to its directory. </param>
+/// <param name="entries"> Names of the entry modules, resolved from the current directory. </param>
+/// <returns> Number of bundled modules. </returns>
+/// <remarks> Modules are found by require() calls with a string literal, others are loaded from files at run time. </remarks>
+export function saveModuleBundle(path: string, entries: string[], options?: ModuleBundleOptions): number {
+    return binding.saveModuleBundle(path, entries, options != null && options.codeCache === true);
+}
@@ -1,17 +1,28 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
-import { Store } from './store';
+import { Store, StoreOptions } from './store';
+import { TransportOption } from '../zone/zone';
 
 let binding = require('../binding');
 
 /// <summary> Create a store with an id. </summary>
 /// <param name="id"> String identifier which can be used to get the store from all isolates. </summary>
+/// <param name="transport"> TransportOption.AUTO (default) to marshall values to JSON, or TransportOption.BINARY. </summary>
+/// <param name="shards"> Number of shards to spread keys over, 1 by default. More shards reduce lock contention of writes. </summary>
 /// <returns> A store object or throws Error if store with this id already exists. </returns>
 /// <remarks> Store object will be destroyed when reference from all isolates are unreferenced. 
 /// It's usually a best practice to keep a long-living reference in user modules or global scope. </remarks>
-export function create(id: string): Store {
-    return binding.createStore(id);
+export function create(id: string, transport?: TransportOption, shards?: number): Store;
+
+/// <summary> Create a store with an id and options. </summary>
+/// <param name="id"> String identifier which can be used to get the store from all isolates. </summary>
+/// <param name="options"> Transport option, shards, whether the store is read optimized and how values are cached. </summary>
+/// <returns> A store object or throws Error if store with this id already exists. </returns>
+export function create(id: string, options: StoreOptions): Store;
+
+export function create(id: string, arg?: TransportOption | StoreOptions, shards?: number): Store {
+    return binding.createStore(id, getStoreOptions(arg, shards));
 }
 
 /// <summary> Get a store with an id. </summary>
@@ -23,14 +34,41 @@ export function get(id: string): Store {
 
 /// <summary> Get a store with an id, or create it if not exist. </summary>
 /// <param name="id"> String identifier which can be used to get the store from all isolates. </summary>
+/// <param name="transport"> Transport option of the store if it's created, an existing store keeps its own. </summary>
+/// <param name="shards"> Number of shards of the store if it's created, an existing store keeps its own. </summary>
 /// <returns> A store object associated with the id. </returns>
 /// <remarks> Store object will be destroyed when reference from all isolates are unreferenced. 
 /// It's usually a best practice to keep a long-living reference in user modules or global scope. </remarks>
-export function getOrCreate(id: string): Store {
-    return binding.getOrCreateStore(id);
+export function getOrCreate(id: string, transport?: TransportOption, shards?: number): Store;
+
+/// <summary> Get a store with an id, or create it with options if not exist. </summary>
+/// <param name="id"> String identifier which can be used to get the store from all isolates. </summary>
+/// <param name="options"> Options of the store if it's created, an existing store keeps its own. </summary>
+/// <returns> A store object associated with the id. </returns>
+export function getOrCreate(id: string, options: StoreOptions): Store;
+
+export function getOrCreate(id: string, arg?: TransportOption | StoreOptions, shards?: number): Store {
+    return binding.getOrCreateStore(id, getStoreOptions(arg, shards));
+}
+
+/// <summary> Create a store from a file written by Store.snapshot. </summary>
+/// <param name="path"> Path of the file, which is mapped into memory, so values are read from it on their first get. </summary>
+/// <param name="id"> Id of the new store, the id of the saved store by default. </summary>
+/// <returns> A store object with options of the saved store, or throws Error if store with the id already exists. </returns>
+/// <remarks> Loaded values don't expire, TTL and limits of the saved store are not kept. </remarks>
+export function load(path: string, id?: string): Store {
+    return binding.loadStore(path, id);
 }
 
 /// <summary> Returns number of stores that is alive. </summary>
 export function count(): number {
     return binding.getStoreCount();
-}
\ No newline at end of file
+}
+
+/// <summary> Get store options from either (transport, shards) or an options object. </summary>
+function getStoreOptions(arg: TransportOption | StoreOptions, shards: number): StoreOptions {
+    if (arg != null && typeof arg === 'object') {
+        return <StoreOptions>arg;
+    }
+    return { transport: <TransportOption>arg, shards: shards };
+}
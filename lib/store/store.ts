@@ -1,6 +1,89 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+import { TransportOption } from '../zone/zone';
+
+/// <summary> Options of a store, given when it's created. </summary>
+export interface StoreOptions {
+    /// <summary> TransportOption.AUTO (default) to marshall values to JSON, or TransportOption.BINARY. </summary>
+    transport?: TransportOption;
+
+    /// <summary> Number of shards to spread keys over, 1 by default. More shards reduce lock contention of writes. </summary>
+    shards?: number;
+
+    /// <summary> Whether writes publish immutable snapshots, so reads don't contend. False by default. </summary>
+    /// <remarks> Each write copies the keys of its shard, thus it's for keys that are read far more often than written. </remarks>
+    readOptimized?: boolean;
+
+    /// <summary> Whether each isolate caches the values it gets, so gets of an unchanged value return the same object. False by default. </summary>
+    /// <remarks> A cached object is shared by all its readers in the isolate, changing it changes what later gets return. </remarks>
+    cacheValues?: boolean;
+
+    /// <summary> Whether plain objects and arrays of cached values are frozen, so readers can't change them. False by default. </summary>
+    freezeValues?: boolean;
+
+    /// <summary> Time to live in milliseconds of values that are set without their own. 0 (default) for no expiry. </summary>
+    ttl?: number;
+
+    /// <summary> Maximum number of keys, least recently used keys are evicted beyond it. 0 (default) for no limit. </summary>
+    maxEntries?: number;
+
+    /// <summary> Maximum bytes of keys and payloads, least recently used keys are evicted beyond it. 0 (default) for no limit. </summary>
+    maxBytes?: number;
+
+    /// <summary> Marshalled values of at least this many bytes are kept compressed, and decompressed by gets. 0 (default) to keep values as is. </summary>
+    /// <remarks> Decompressed values are cached along with cacheValues. Not supported by shared stores. </remarks>
+    compressAbove?: number;
+
+    /// <summary> Whether keys and values live in shared memory named by the id, so all Node.js processes of the host share them. False by default. </summary>
+    /// <remarks> Memory is fixed to maxBytes, 64MB by default. TTL, read optimization and values holding shared objects are not supported. </remarks>
+    shared?: boolean;
+
+    /// <summary> The "host:port" address to receive writes of peer processes on, which makes the store replicated. None by default. </summary>
+    /// <remarks> Writes propagate to peers asynchronously, conflicting writes are resolved by last writer wins. Not supported by shared stores. </remarks>
+    replicaAddress?: string;
+
+    /// <summary> The "host:port" addresses of the same store in peer processes, which writes are propagated to. </summary>
+    replicaPeers?: string[];
+}
+
+/// <summary> A value along with its version, which changes with each set of the key. </summary>
+export interface VersionedValue {
+    /// <summary> Value of the key. </summary>
+    value: any;
+
+    /// <summary> Version of the value, never 0. </summary>
+    version: number;
+}
+
+/// <summary> Watch of store keys, returned by Store.watch. </summary>
+export interface StoreWatcher {
+    /// <summary> Whether the watch is closed. </summary>
+    readonly closed: boolean;
+
+    /// <summary> Stop watching. Changes not delivered yet are dropped. </summary>
+    close(): void;
+}
+
+/// <summary> Writer of a large value in chunks, returned by Store.setStream. </summary>
+export interface StoreWriter {
+    /// <summary> Number of bytes written so far. </summary>
+    readonly bytesWritten: number;
+
+    /// <summary> Whether the writer has ended or aborted. </summary>
+    readonly ended: boolean;
+
+    /// <summary> Append a chunk to the value. Strings are written as UTF-8 bytes. </summary>
+    write(chunk: ArrayBuffer | ArrayBufferView | string): void;
+
+    /// <summary> Set the chunks written as one ArrayBuffer value of the key. </summary>
+    /// <remarks> Throws if the store can't take the value, e.g. over its maxBytes. </remarks>
+    end(): void;
+
+    /// <summary> Drop the chunks written, leaving the key unchanged. </summary>
+    abort(): void;
+}
+
 /// <summary> Store is a facility to share (built-in JavaScript types or Transportable subclasses) objects across isolates. </summary>
 export interface Store {
     /// <summary> Id of this store. </summary>
@@ -8,6 +91,12 @@ export interface Store {
 
     /// <summary> Number of keys in this store. </summary>
     readonly size: number;
+
+    /// <summary> Number of shards that keys are spread over, each with its own reader-writer lock. </summary>
+    readonly shards: number;
+
+    /// <summary> Whether reads are served from per-thread snapshots, without locking. </summary>
+    readonly readOptimized: boolean;
     
     /// <summary> Check if this store has a key. </summary>
     /// <param name="key"> Case-sensitive string key. </summary>
@@ -22,7 +111,86 @@ export interface Store {
     /// <summary> Insert or update a JavaScript value by key. </summary>
     /// <param name="key"> Case-sensitive string key. </summary>
     /// <param name="value"> Value. Any value of built-in JavaScript types or Transportable subclasses can be accepted. </summary>
-    set(key: string, value: any): void;
+    /// <param name="ttl"> Time to live in milliseconds, the store's TTL by default. </summary>
+    set(key: string, value: any, ttl?: number): void;
+
+    /// <summary> Get JavaScript values by keys, taking the lock of each shard once. </summary>
+    /// <param name="keys"> Case-sensitive string keys. </summary>
+    /// <returns> Values in the same order as keys, undefined for keys not found. </returns>
+    getMany(keys: string[]): any[];
+
+    /// <summary> Insert or update JavaScript values by keys, taking the lock of each shard once. </summary>
+    /// <param name="entries"> Pairs of case-sensitive string key and value. A later duplicate of a key wins. </summary>
+    /// <param name="ttl"> Time to live in milliseconds, the store's TTL by default. </summary>
+    setMany(entries: [string, any][], ttl?: number): void;
+
+    /// <summary> Get keys along with their values that start with a prefix. </summary>
+    /// <param name="prefix"> Case-sensitive prefix, empty to match all keys. </summary>
+    /// <param name="limit"> Maximum number of keys to return, no limit by default. </summary>
+    /// <returns> Pairs of key and value in ascending order of keys. </returns>
+    scan(prefix: string, limit?: number): [string, any][];
+
+    /// <summary> Get JavaScript value by key along with its version. </summary>
+    /// <param name="key"> Case-sensitive string key. </summary>
+    /// <returns> Value and version for key, undefined if not found. </returns>
+    getVersioned(key: string): VersionedValue;
+
+    /// <summary> Update a JavaScript value by key if its version is unchanged. </summary>
+    /// <param name="key"> Case-sensitive string key. </summary>
+    /// <param name="expectedVersion"> Version from getVersioned, or 0 to set only if the key doesn't exist. </summary>
+    /// <param name="value"> Value. </summary>
+    /// <returns> True if the value is set. </returns>
+    compareAndSet(key: string, expectedVersion: number, value: any): boolean;
+
+    /// <summary> Get JavaScript value by key, or insert the given value if not found. </summary>
+    /// <param name="key"> Case-sensitive string key. </summary>
+    /// <param name="value"> Value to insert. </summary>
+    /// <returns> The existing value, or the given value if inserted. </returns>
+    getOrSet(key: string, value: any): any;
+
+    /// <summary> Atomically add delta to the integer value of a key, which starts from 0 if not found. </summary>
+    /// <param name="key"> Case-sensitive string key. </summary>
+    /// <param name="delta"> Integer to add, 1 by default. </summary>
+    /// <returns> The value after addition. </returns>
+    increment(key: string, delta?: number): number;
+
+    /// <summary> Atomically subtract delta from the integer value of a key, which starts from 0 if not found. </summary>
+    /// <param name="key"> Case-sensitive string key. </summary>
+    /// <param name="delta"> Integer to subtract, 1 by default. </summary>
+    /// <returns> The value after subtraction. </returns>
+    decrement(key: string, delta?: number): number;
+
+    /// <summary> Watch changes of a key, or keys of a prefix. </summary>
+    /// <param name="keyOrPrefix"> Case-sensitive string key, or a prefix followed by '*'. '*' watches all keys. </summary>
+    /// <param name="callback"> Called with each changed key on the watching thread. Repeated changes of a key are coalesced. </summary>
+    /// <returns> The watch, which keeps delivering changes until closed. </returns>
+    watch(keyOrPrefix: string, callback: (key: string) => void): StoreWatcher;
+
+    /// <summary> Set a large ArrayBuffer value in chunks, which are never held by a JavaScript heap. </summary>
+    /// <param name="key"> Case-sensitive string key, which keeps its previous value until the writer ends. </summary>
+    /// <param name="ttl"> Time to live in milliseconds, the store's TTL by default. </summary>
+    /// <returns> The writer, which can be passed to other zones. </returns>
+    setStream(key: string, ttl?: number): StoreWriter;
+
+    /// <summary> Get a range of bytes of an ArrayBuffer or string value. </summary>
+    /// <param name="key"> Case-sensitive string key. </summary>
+    /// <param name="offset"> Start of the range in bytes. </summary>
+    /// <param name="length"> Length of the range in bytes, up to the end of the value by default. </summary>
+    /// <returns> 
+    ///     The range, clamped to the value, or undefined if not found. Ranges of ArrayBuffers are external slices over
+    ///     the stored memory, without copying. Throws if the value is of another type.
+    /// </returns>
+    getRange(key: string, offset: number, length?: number): ArrayBuffer;
+
+    /// <summary> Get the number of bytes a value holds, e.g. to read an ArrayBuffer value by ranges. </summary>
+    /// <param name="key"> Case-sensitive string key. </summary>
+    /// <returns> Byte length of the value, undefined if not found. </returns>
+    getByteLength(key: string): number;
+
+    /// <summary> Save all values to a file, which store.load maps back, e.g. on next process start. </summary>
+    /// <param name="path"> Path of the file, which is replaced only once the snapshot is fully written. </summary>
+    /// <remarks> Throws if a value holds shared objects, e.g. SharedArrayBuffers or allocators, which can't outlive the process. </remarks>
+    snapshot(path: string): void;
 
     /// <summary> Remove a key with its value from this store. </summary>
     /// <param name="key"> Case-sensitive string key. </summary>
@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+let binding = require('./binding');
+
+/// <summary> Number of events each thread keeps by default. </summary>
+export const DEFAULT_BUFFER_SIZE: number = 8192;
+
+/// <summary>
+///     Starts tracing calls of all zones in the process, dropping the events of an earlier trace.
+///     Each thread keeps its latest events, up to the buffer size.
+/// </summary>
+/// <param name="bufferSize"> Number of events each thread keeps, 0 for DEFAULT_BUFFER_SIZE. </param>
+export function start(bufferSize: number = 0): void {
+    binding.startTracing(bufferSize);
+}
+
+/// <summary> Stops tracing, recorded events are kept to be exported. </summary>
+export function stop(): void {
+    binding.stopTracing();
+}
+
+/// <summary> Returns whether tracing is on. </summary>
+export function isEnabled(): boolean {
+    return binding.isTracingEnabled();
+}
+
+/// <summary>
+///     Gets the recorded events in Chrome's trace event JSON format,
+///     which can be opened in chrome://tracing or Perfetto UI.
+/// </summary>
+export function exportChromeTrace(): string {
+    return binding.exportTrace();
+}
+
+/// <summary> Gets the time of the clock of trace events, in nanoseconds. </summary>
+export function now(): number {
+    return binding.getTraceTime();
+}
+
+/// <summary> Records a span of the calling thread from a start time of now() till now, if tracing is on. </summary>
+/// <param name="traceId"> Trace id of the span, by default the trace id of the call the worker runs. </param>
+export function recordSpan(name: string, start: number, traceId?: string): void {
+    binding.recordTraceSpan(name, start, traceId);
+}
+
+/// <summary>
+///     Starts capturing the calls all zones run into a compact binary file, which is overwritten,
+///     for benchmark/trace-replay.js to replay them. A capture in progress is stopped first.
+/// </summary>
+/// <param name="path"> Path of the capture file. </param>
+export function startCapture(path: string): void {
+    if (!binding.startCallCapture(path)) {
+        throw new Error(`Failed to open capture file "${path}".`);
+    }
+}
+
+/// <summary> Stops capturing calls, writing out buffered calls and closing the file. </summary>
+export function stopCapture(): void {
+    binding.stopCallCapture();
+}
@@ -4,9 +4,15 @@
 export { 
     Transportable, 
     TransportableObject, 
+    AutoTransportable, 
     TransportContext, 
     isTransportable, 
-    cid 
+    Forwardable,
+    isForwardable,
+    cid,
+    schema,
+    Schema,
+    FieldType
 } from './transport/transportable';
 
 export * from './transport/transport';
@@ -14,6 +20,7 @@ export * from './transport/transport';
 import { Handle } from './memory/handle';
 import { TransportContext } from './transport/transportable';
 import * as functionTransporter from './transport/function-transporter';
+import { binaryTransform, binaryRevive, forwardPayload } from './transport/transport';
 
 let binding = require('./binding');
 
@@ -23,4 +30,76 @@ export function createTransportContext(owning: boolean = true, handle : Handle =
 }
 
 export let saveFunction = functionTransporter.save;
-export let loadFunction = functionTransporter.load;
\ No newline at end of file
+export let loadFunction = functionTransporter.load;
+
+/// <summary> Marshall a JavaScript value to binary transport format (V8 structured clone). </summary>
+/// <param name="jsValue"> JavaScript value, which maybe built-in JavaScript types, including typed arrays, Map, Set and Date, or transportable objects. </param>
+/// <param name="context"> Transport context to save shared pointers. </param>
+/// <returns> ArrayBuffer of serialized bytes. </returns>
+export function marshallBinary(
+    jsValue: any, 
+    context: TransportContext): ArrayBuffer {
+
+    let payload = forwardPayload(jsValue, true, context);
+    if (payload !== undefined) {
+        return <ArrayBuffer>payload;
+    }
+    let [value, hasTransportables] = binaryTransform(jsValue, context);
+    return binding.serializeValue(value, hasTransportables);
+}
+
+/// <summary> Unmarshall a JavaScript value from binary transport format. </summary>
+/// <param name="payload"> ArrayBuffer or view of bytes returned by marshallBinary. </summary>
+/// <param name="context"> Transport context to load shared pointers. </param>
+/// <returns> Deserialized JavaScript value. </returns>
+export function unmarshallBinary(
+    payload: ArrayBuffer | ArrayBufferView, 
+    context: TransportContext): any {
+
+    let [value, hasTransportables] = binding.deserializeValue(payload);
+    return hasTransportables ? binaryRevive(value, context) : value;
+}
+
+/// <summary>
+///     Starts accounting what marshalling costs calls and stores of all zones in the process, published as metrics
+///     PayloadBytes, TransportTime and SharedPointers of section 'Transport', by zone, function and stage.
+/// </summary>
+/// <remarks> While accounting is on, calls of plain JSON values are not dispatched natively, but by transport. </remarks>
+export function startAccounting(): void {
+    binding.startTransportAccounting();
+}
+
+/// <summary> Stops accounting, recorded metrics are kept by the metric provider. </summary>
+export function stopAccounting(): void {
+    binding.stopTransportAccounting();
+}
+
+/// <summary> Returns whether accounting is on. </summary>
+export function isAccounting(): boolean {
+    return binding.isTransportAccountingEnabled();
+}
+
+/// <summary> Records a stage of marshalling from a start time of tracing.now() till now, if accounting is on. </summary>
+/// <param name="zoneId"> The zone making or running the call, undefined for the zone of the calling thread. </param>
+/// <param name="functionName"> The function called. </param>
+/// <param name="stage"> The stage, e.g. 'MarshallArguments'. </param>
+/// <param name="payloads"> The payloads marshalled or unmarshalled. </param>
+/// <param name="sharedCount"> The number of shared pointers the payloads carry in their transport context. </param>
+/// <param name="start"> The start time returned by tracing.now(). </param>
+export function recordCost(
+    zoneId: string,
+    functionName: string,
+    stage: string,
+    payloads: (string | ArrayBuffer)[],
+    sharedCount: number,
+    start: number): void {
+
+    // JSON payloads are accounted by characters, which are bytes for ASCII, to avoid encoding them.
+    let bytes = 0;
+    for (let payload of payloads) {
+        if (payload != null) {
+            bytes += typeof payload === 'string' ? payload.length : payload.byteLength;
+        }
+    }
+    binding.recordTransport(zoneId, functionName, stage, bytes, sharedCount, start);
+}
@@ -4,21 +4,27 @@
 ////////////////////////////////////////////////////////////////////////
 // Module to support function transport.
 
-import { Store } from '../store/store';
 import * as assert from 'assert';
 import * as path from 'path';
 
 /// <summary> Function hash to function cache. </summary>
-let _hashToFunctionCache: {[hash: string]: (...args: any[]) => any} = {};
+let _hashToFunctionCache = new Map<string, (...args: any[]) => any>();
 
 /// <summary> Function to hash cache. </summary>
-/// <remarks> Function cannot be used as a key in TypeScript. </remarks>
-let _functionToHashCache: any = {};
+/// <remarks> Keyed by the function object itself, functions with the same body may come from different origins. </remarks>
+let _functionToHashCache = new WeakMap<(...args: any[]) => any, string>();
 
-/// <summary> Marshalled function body cache. </summary>
-let _store: Store;
+/// <summary> Hashes of definitions saved from this isolate, by origin and then body. </summary>
+/// <remarks>
+///     Closures created anew for each call miss the identity cache, this spares them a native call that copies and
+///     hashes the body. The native registry never drops definitions, so cached hashes stay valid.
+/// </remarks>
+let _definitionToHashCache = new Map<string, Map<string, string>>();
 
-/// <summary> Interface for function definition that will be saved in store. </summary>
+/// <summary> Native binding that keeps function definitions, across isolates. </summary>
+let _binding: any;
+
+/// <summary> Interface for function definition that is shared across isolates. </summary>
 interface FunctionDef {
     /// <summary> From which file name the function is defined. </summary>
     origin: string;
@@ -27,32 +33,34 @@ interface FunctionDef {
     body: string;
 }
 
-/// <summary> Get underlying store to save marshall function body across isolates. </summary>
-function getStore(): Store {
-    if (_store == null) {
-        // Lazy creation function store
-        // 1) avoid circular runtime dependency between store and transport.
-        // 2) avoid unnecessary cost when function transport is not used.
-        _store = require('../store/store-api')
-            .getOrCreate('__napajs_marshalled_functions');
+/// <summary> Get native binding to save and load function definitions. </summary>
+function getBinding(): any {
+    if (_binding == null) {
+        // Lazy require to avoid circular runtime dependency between binding and transport on bootstrap.
+        _binding = require('../binding');
     }
-    return _store;
+    return _binding;
 }
 
 /// <summary> Save function and get a hash string to use it later. </summary>
+/// <remarks> Definitions are kept in a process-wide native registry, with a 64-bit xxHash of origin and body. </remarks>
 export function save(func: (...args: any[]) => any): string {
-    let hash = _functionToHashCache[(<any>(func))];
+    let hash = _functionToHashCache.get(func);
     if (hash == null) {
         // Should happen only on first marshall of input function in current isolate.
         let origin = (<any>func).origin || '';
         let body = func.toString();
-        let fullContent = origin + ":" + body;
-        hash = getFunctionHash(fullContent);
-        let def: FunctionDef = { 
-            origin: origin,
-            body: body
-        };
-        getStore().set(hash, def);
+
+        let hashes = _definitionToHashCache.get(origin);
+        if (hashes === undefined) {
+            hashes = new Map<string, string>();
+            _definitionToHashCache.set(origin, hashes);
+        }
+        hash = hashes.get(body);
+        if (hash === undefined) {
+            hash = <string>getBinding().saveFunctionDefinition(origin, body);
+            hashes.set(body, hash);
+        }
         cacheFunction(hash, func);
     }
     return hash;
@@ -60,14 +68,14 @@ export function save(func: (...args: any[]) => any): string {
 
 /// <summary> Load a function with a hash retrieved from `save`. </summary>
 export function load(hash: string): (...args: any[]) => any {
-    let func = _hashToFunctionCache[hash];
+    let func = _hashToFunctionCache.get(hash);
     if (func == null) {
         // Should happen only on first unmarshall of given hash in current isolate..
-        let def: FunctionDef = getStore().get(hash);
+        let def: [string, string] = getBinding().getFunctionDefinition(hash);
         if (def == null) {
             throw new Error(`Function hash cannot be found: ${hash}`);
         }
-        func = loadFunction(def);
+        func = loadFunction({ origin: def[0], body: def[1] });
         cacheFunction(hash, func);
     }
     return func;
@@ -75,23 +83,8 @@ export function load(hash: string): (...args: any[]) => any {
 
 /// <summary> Cache function with its hash in current isolate. </summary>
 function cacheFunction(hash: string, func: (...args: any[]) => any) {
-    _functionToHashCache[<any>(func)] = hash;
-    _hashToFunctionCache[hash] = func;
-}
-
-/// <summary> Generate hash for function definition using DJB2 algorithm. 
-/// See: https://en.wikipedia.org/wiki/DJB2 
-/// </summary>
-function getFunctionHash(signature: string): string {
-    let hash = 5381;
-    for (let i = 0; i < signature.length; ++i) {
-        hash = (hash * 33) ^ signature.charCodeAt(i);
-    }
-
-    /* JavaScript does bitwise operations (like XOR, above) on 32-bit signed
-    * integers. Since we want the results to be always positive, convert the
-    * signed int to an unsigned by doing an unsigned bitshift. */
-    return (hash >>> 0).toString(16);
+    _functionToHashCache.set(func, hash);
+    _hashToFunctionCache.set(hash, func);
 }
 
 declare var __in_napa: boolean;
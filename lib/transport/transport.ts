@@ -4,6 +4,7 @@
 import * as transportable from './transportable';
 import * as functionTransporter from './function-transporter';
 import * as path from 'path';
+import { Handle } from '../memory/handle';
 
 /// <summary> Per-isolate cid => constructor registry. </summary>
 let _registry: Map<string, new(...args: any[]) => transportable.Transportable> 
@@ -24,11 +25,310 @@ export function register(subClass: new(...args: any[]) => any) {
         throw new Error(`Constructor ID (cid) "${cid}" is already registered.`);
     }
     _registry.set(cid, subClass);
+
+    if ((<any>subClass).hasOwnProperty('_schema')) {
+        compileSchema(subClass, cid);
+    }
+}
+
+/// <summary> Marshall/unmarshall functions generated from the schema of a transportable class. </summary>
+interface CompiledSchema {
+    /// <summary> Whether payloads only contain primitives and payloads of other plain schemas, 
+    /// which are transported by JSON without replacer/reviver. </summary>
+    plain: boolean;
+
+    /// <summary> Marshall an object to its payload, including members of schema types. </summary>
+    marshall: (object: any, context: transportable.TransportContext) => any;
+
+    /// <summary> Unmarshall an object from a payload that is not revived, including members of schema types. </summary>
+    unmarshall: (payload: any, context: transportable.TransportContext) => any;
+}
+
+/// <summary> Per-isolate compiled schemas by class and by cid. </summary>
+let _schemasByClass = new Map<Function, CompiledSchema>();
+let _schemasByCid = new Map<string, CompiledSchema>();
+
+/// <summary> Start of JSON payloads of schema classes, which have their '_cid' as first key. </summary>
+const SCHEMA_PAYLOAD_PREFIX = '{"_cid":"';
+
+/// <summary> Separator between cid and slot in payloads of root shareables, e.g. '{"_cid":"<cid>","_slot":"<slot>"}'. </summary>
+const SHAREABLE_SLOT_SEPARATOR = '","_slot":"';
+
+/// <summary> Tells if a value is a shareable, i.e. a napa::module::ShareableWrap, without visiting members as memory.isShareable does. </summary>
+function isShareableWrap(value: any): boolean {
+    return value != null && typeof value === 'object' && typeof value['cid'] === 'function' && typeof value['isNull'] === 'function'
+        && value.hasOwnProperty('handle') && value.hasOwnProperty('refCount');
+}
+
+/// <summary> Converts a field value between object and payload. </summary>
+type FieldConverter = (value: any, context: transportable.TransportContext) => any;
+
+/// <summary> Create the converter of a schema field, or null if the field value is copied as is. </summary>
+/// <param name="type"> Field type of the schema. </param>
+/// <param name="toPayload"> Whether to convert from object to payload, or the other way. </param>
+/// <param name="schema"> Compiled schema being built, which is not plain if the field has to go through the generic path. </param>
+function createFieldConverter(type: any, toPayload: boolean, schema: CompiledSchema): FieldConverter {
+    if (Array.isArray(type)) {
+        if (type.length !== 1) {
+            throw new Error(`Array field type should have a single element type, e.g. [Point] or ['number'].`);
+        }
+        let element = createFieldConverter(type[0], toPayload, schema);
+        if (element == null) {
+            return null;
+        }
+        return (value: any, context: transportable.TransportContext): any => {
+            if (value == null) {
+                return value;
+            }
+            let result = new Array(value.length);
+            for (let i = 0; i < value.length; ++i) {
+                result[i] = element(value[i], context);
+            }
+            return result;
+        };
+    }
+    if (type === 'number' || type === 'string' || type === 'boolean') {
+        return null;
+    }
+    if (type === 'any') {
+        schema.plain = false;
+        return null;
+    }
+    if (typeof type === 'function') {
+        // A class without schema goes through the generic path. A class referring to itself is found 
+        // here while it is being compiled, hence the nested schema is accessed when called.
+        let nested = _schemasByClass.get(type);
+        if (nested === undefined) {
+            schema.plain = false;
+            return null;
+        }
+        if (!nested.plain) {
+            schema.plain = false;
+        }
+        return toPayload ? 
+            (value: any, context: transportable.TransportContext): any => value == null ? value : nested.marshall(value, context) :
+            (value: any, context: transportable.TransportContext): any => value == null ? value : nested.unmarshall(value, context);
+    }
+    throw new Error(`Unsupported field type "${type}" in schema.`);
+}
+
+/// <summary> Generate marshall/unmarshall functions of a transportable class declared with @schema. </summary>
+/// <param name="subClass"> Transportable class with a '_schema' property. </param>
+/// <param name="cid"> Constructor ID of the class. </param>
+/// <remarks> 
+///     Generic marshall/unmarshall use the generated functions via Transportable.marshall/unmarshall of the class. 
+///     Payloads of plain schemas are additionally transported without JSON replacer/reviver when they are the root value.
+/// </remarks>
+export function compileSchema(subClass: new(...args: any[]) => any, cid: string) {
+    let fields: transportable.Schema = (<any>subClass)['_schema'];
+    let schema: CompiledSchema = { plain: true, marshall: null, unmarshall: null };
+    _schemasByClass.set(subClass, schema);
+
+    let names = Object.keys(fields);
+    let keys = names.map((name: string) => JSON.stringify(name));
+    let marshallers = names.map((name: string) => createFieldConverter(fields[name], true, schema));
+    let unmarshallers = names.map((name: string) => createFieldConverter(fields[name], false, schema));
+
+    // Object literal of a fixed layout, with '_cid' as first key that unmarshall looks for.
+    let members = [ '"_cid": cid' ].concat(keys.map((key: string, i: number) => 
+        `${key}: ${marshallers[i] != null ? `m[${i}](o[${key}], c)` : `o[${key}]`}`));
+    schema.marshall = new Function('cid', 'm', 
+        `return function (o, c) { return { ${members.join(', ')} }; };`)(cid, marshallers);
+
+    // Keys absent in payload are left as initialized by the constructor.
+    let assignments = keys.map((key: string, i: number) => 
+        `if (p[${key}] !== undefined) { o[${key}] = ${unmarshallers[i] != null ? `u[${i}](p[${key}], c)` : `p[${key}]`}; }`);
+    schema.unmarshall = new Function('C', 'u', 
+        `return function (p, c) { var o = new C(); ${assignments.join(' ')} return o; };`)(subClass, unmarshallers);
+
+    // The generic path revives members before their holder, in which case they are copied as is.
+    let load = new Function(`return function (p) { ${keys.map((key: string) => 
+        `if (p[${key}] !== undefined) { this[${key}] = p[${key}]; }`).join(' ')} };`)();
+
+    subClass.prototype.marshall = function (context: transportable.TransportContext): object {
+        return schema.marshall(this, context);
+    };
+    subClass.prototype.unmarshall = load;
+    _schemasByCid.set(cid, schema);
+}
+
+/// <summary> Constructor ID of ArrayBuffer and ArrayBufferView payloads. </summary>
+const ARRAY_BUFFER_CID = 'ArrayBuffer';
+
+/// <summary> ArrayBufferView types that can be restored from a payload. </summary>
+const ARRAY_BUFFER_VIEWS: { [name: string]: new(buffer: ArrayBuffer, byteOffset: number, length: number) => ArrayBufferView } = {
+    Int8Array: Int8Array,
+    Uint8Array: Uint8Array,
+    Uint8ClampedArray: Uint8ClampedArray,
+    Int16Array: Int16Array,
+    Uint16Array: Uint16Array,
+    Int32Array: Int32Array,
+    Uint32Array: Uint32Array,
+    Float32Array: Float32Array,
+    Float64Array: Float64Array,
+    DataView: DataView
+};
+
+/// <summary> ArrayBuffers to detach from their sender when they are marshalled next time. </summary>
+let _transfers = new WeakSet<ArrayBuffer>();
+
+/// <summary> ArrayBuffers saved per transport context, so a buffer referred to multiple times is saved once. </summary>
+let _savedBuffers = new WeakMap<transportable.TransportContext, Map<ArrayBuffer, Handle>>();
+
+/// <summary> ArrayBuffers loaded per transport context, so a buffer referred to multiple times is loaded once. </summary>
+let _loadedBuffers = new WeakMap<transportable.TransportContext, Map<string, ArrayBuffer>>();
+
+/// <summary> Mark an ArrayBuffer, or the ArrayBuffer of a view, to be transferred instead of copied on next marshall. </summary>
+/// <param name="buffer"> ArrayBuffer or ArrayBufferView, e.g. a Node.js Buffer. </param>
+/// <returns> The buffer itself, which is detached - of zero length - once marshalled. </returns>
+/// <remarks> 
+///     Views that share their ArrayBuffer with other data, e.g. small Node.js Buffers from the pool, are still copied.
+///     SharedArrayBuffers are always shared, thus left as they are.
+/// </remarks>
+export function transfer<T extends ArrayBuffer | ArrayBufferView>(buffer: T): T {
+    if (ArrayBuffer.isView(buffer)) {
+        let view = <ArrayBufferView>buffer;
+        if (view.byteOffset === 0 && view.byteLength === view.buffer.byteLength && !isShared(view)) {
+            _transfers.add(view.buffer);
+        }
+    } else if (typeTag(buffer) === '[object ArrayBuffer]') {
+        _transfers.add(<ArrayBuffer>buffer);
+    } else if (typeTag(buffer) !== '[object SharedArrayBuffer]') {
+        throw new Error('Only ArrayBuffer and ArrayBufferView can be transferred.');
+    }
+    return buffer;
+}
+
+/// <summary> Tells if a value is an ArrayBuffer marked by transfer, or a view of one. </summary>
+function isMarkedForTransfer(value: any): boolean {
+    if (value == null || typeof value !== 'object') {
+        return false;
+    }
+    return _transfers.has(ArrayBuffer.isView(value) ? (<ArrayBufferView>value).buffer : value);
+}
+
+/// <summary> Tells if a value is an ArrayBuffer or a SharedArrayBuffer. </summary>
+function isArrayBuffer(value: any): boolean {
+    let tag = typeTag(value);
+    return tag === '[object ArrayBuffer]' || tag === '[object SharedArrayBuffer]';
+}
+
+/// <summary> Tells if a value is a SharedArrayBuffer, or a view of one. </summary>
+function isShared(value: any): boolean {
+    if (value == null || typeof value !== 'object') {
+        return false;
+    }
+    return typeTag(ArrayBuffer.isView(value) ? (<ArrayBufferView>value).buffer : value) === '[object SharedArrayBuffer]';
+}
+
+/// <summary> Save an ArrayBuffer or ArrayBufferView into transport context, by transferring its memory if marked by transfer. </summary>
+/// <remarks> SharedArrayBuffers are shared rather than copied, views of them keep their offset. </remarks>
+function marshallArrayBuffer(value: ArrayBuffer | ArrayBufferView, context: transportable.TransportContext): object {
+    let payload: any = { _cid: ARRAY_BUFFER_CID };
+    let buffer: any;
+    if (ArrayBuffer.isView(value)) {
+        let view = <ArrayBufferView>value;
+        let name = Object.getPrototypeOf(view).constructor.name;
+        payload.view = name;
+        payload.length = name === 'DataView' ? view.byteLength : (<any>view).length;
+        buffer = view.buffer;
+        if (isShared(buffer)) {
+            payload.byteOffset = view.byteOffset;
+        } else if (view.byteOffset !== 0 || view.byteLength !== buffer.byteLength) {
+            // A slice is a copy of only the viewed bytes, which can be transferred as is.
+            payload.handle = context.saveArrayBuffer(buffer.slice(view.byteOffset, view.byteOffset + view.byteLength), true);
+            return payload;
+        }
+    } else {
+        buffer = value;
+    }
+
+    let saved = _savedBuffers.get(context);
+    if (saved === undefined) {
+        saved = new Map<ArrayBuffer, Handle>();
+        _savedBuffers.set(context, saved);
+    }
+    let handle = saved.get(buffer);
+    if (handle === undefined) {
+        if (isShared(buffer)) {
+            handle = context.saveSharedArrayBuffer(buffer);
+        } else {
+            handle = context.saveArrayBuffer(buffer, _transfers.delete(buffer));
+        }
+        saved.set(buffer, handle);
+    }
+    payload.handle = handle;
+    if (isShared(buffer)) {
+        payload.shared = true;
+    }
+    return payload;
+}
+
+/// <summary> Load an ArrayBuffer or ArrayBufferView from a payload created by marshallArrayBuffer. </summary>
+function unmarshallArrayBuffer(payload: any, context: transportable.TransportContext): ArrayBuffer | ArrayBufferView {
+    let loaded = _loadedBuffers.get(context);
+    if (loaded === undefined) {
+        loaded = new Map<string, ArrayBuffer>();
+        _loadedBuffers.set(context, loaded);
+    }
+    let key = `${payload.handle[0]}:${payload.handle[1]}`;
+    let buffer = loaded.get(key);
+    if (buffer === undefined) {
+        buffer = payload.shared ? context.loadSharedArrayBuffer(payload.handle) : context.loadArrayBuffer(payload.handle);
+        loaded.set(key, buffer);
+    }
+
+    if (payload.view === undefined) {
+        return buffer;
+    }
+    let byteOffset = payload.byteOffset || 0;
+    if (payload.view === 'Buffer' && typeof Buffer !== 'undefined') {
+        return Buffer.from(buffer, byteOffset, payload.length);
+    }
+    let viewType = ARRAY_BUFFER_VIEWS[payload.view];
+    if (viewType === undefined) {
+        // E.g. Buffer in a zone without Node.js Buffer.
+        return new Uint8Array(buffer, byteOffset, buffer.byteLength - byteOffset);
+    }
+    return new viewType(buffer, byteOffset, payload.length);
+}
+
+/// <summary> Tells if a value is an ArrayBufferView with toJSON, i.e. Node.js Buffer. </summary>
+function hasToJSON(value: any): boolean {
+    return ArrayBuffer.isView(value) && typeof (<any>value).toJSON === 'function';
+}
+
+/// <summary> Replace members that are Node.js Buffers by ArrayBuffer payloads, on a copy of an array or plain object. </summary>
+/// <remarks> JSON calls toJSON before the replacer, which turns a Buffer into an array of its bytes, hence the replace from the holder. </remarks>
+function replaceBufferMembers(value: any, context: transportable.TransportContext): any {
+    if (value == null || typeof value !== 'object' || ArrayBuffer.isView(value)) {
+        return value;
+    }
+    let copy: any = undefined;
+    if (Array.isArray(value)) {
+        for (let i = 0; i < value.length; ++i) {
+            if (hasToJSON(value[i])) {
+                copy = copy || value.slice();
+                copy[i] = marshallArrayBuffer(value[i], context);
+            }
+        }
+    } else {
+        for (let key of Object.keys(value)) {
+            if (hasToJSON(value[key])) {
+                copy = copy || Object.assign({}, value);
+                copy[key] = marshallArrayBuffer(value[key], context);
+            }
+        }
+    }
+    return copy !== undefined ? copy : value;
 }
 
 /// <summary> Marshall transform a JS value to a plain JS value that will be stringified. </summary> 
 export function marshallTransform(jsValue: any, context: transportable.TransportContext): any {
-     if (jsValue != null && typeof jsValue === 'object' && !Array.isArray(jsValue)) {
+    if (jsValue != null && typeof jsValue === 'object' && (ArrayBuffer.isView(jsValue) || isArrayBuffer(jsValue))) {
+        return marshallArrayBuffer(jsValue, context);
+    }
+    if (jsValue != null && typeof jsValue === 'object' && !Array.isArray(jsValue)) {
         let constructorName = Object.getPrototypeOf(jsValue).constructor.name;
         if (constructorName !== 'Object') {
             if (typeof jsValue['cid'] === 'function') {
@@ -51,6 +351,9 @@ function unmarshallTransform(payload: any, context: transportable.TransportConte
         if (cid === 'function') {
             return functionTransporter.load(payload.hash);
         }
+        if (cid === ARRAY_BUFFER_CID) {
+            return unmarshallArrayBuffer(payload, context);
+        }
         let subClass = _registry.get(cid);
         if (subClass == null) {
             throw new Error(`Unrecognized Constructor ID (cid) "${cid}". Please ensure @cid is applied on the class or transport.register is called on the class.`);
@@ -73,12 +376,58 @@ export function unmarshall(
     if (json === "undefined") {
         return undefined;
     }
+
+    if (json.startsWith(SCHEMA_PAYLOAD_PREFIX)) {
+        let cidEnd = json.indexOf('"', SCHEMA_PAYLOAD_PREFIX.length);
+        let cid = json.substring(SCHEMA_PAYLOAD_PREFIX.length, cidEnd);
+        if (json.startsWith(SHAREABLE_SLOT_SEPARATOR, cidEnd)) {
+            let subClass = _registry.get(cid);
+            if (subClass == null) {
+                throw new Error(`Unrecognized Constructor ID (cid) "${cid}". Please ensure @cid is applied on the class or transport.register is called on the class.`);
+            }
+            return context.loadShareable(json.substring(cidEnd + SHAREABLE_SLOT_SEPARATOR.length, json.length - 2), subClass);
+        }
+        let schema = _schemasByCid.get(cid);
+        if (schema !== undefined && schema.plain) {
+            return schema.unmarshall(JSON.parse(json), context);
+        }
+    }
+
+    // Transportable objects and functions are marshalled with a "_cid" key, JSON escapes quotes within strings.
+    // Without one, the reviver that is called for every key is not needed.
+    if (json.indexOf('"_cid"') < 0) {
+        return JSON.parse(json);
+    }
     return JSON.parse(json, 
         (key: any, value: any): any => {
             return unmarshallTransform(value, context);
         });
 }
 
+/// <summary> Get the payload of a forwardable value in the requested format, and save its shared objects into context. </summary>
+/// <returns> The payload to pass on as is, or undefined if jsValue has to be marshalled. </returns>
+export function forwardPayload(
+    jsValue: any,
+    binary: boolean,
+    context: transportable.TransportContext): string | ArrayBuffer {
+
+    if (!transportable.isForwardable(jsValue)) {
+        return undefined;
+    }
+    let forwardable = <transportable.Forwardable>jsValue;
+    let payload = forwardable.forwardPayload();
+    if (payload === undefined || (typeof payload === 'string') === binary) {
+        return undefined;
+    }
+
+    // ArrayBuffers and shareables referred to by the payload are kept alive by the source context.
+    let source = forwardable.transportContext;
+    if (source != null && source.sharedCount > 0) {
+        context.saveAll(source);
+    }
+    return payload;
+}
+
 /// <summary> Marshall a JavaScript value to JSON. </summary>
 /// <param name="jsValue"> JavaScript value to stringify, which maybe built-in JavaScript types or transportable objects. </param>
 /// <param name="context"> Transport context to save shared pointers. </param>
@@ -92,8 +441,230 @@ export function marshall(
     if (typeof jsValue === 'function') {
         return `{"_cid": "function", "hash": "${functionTransporter.save(jsValue)}"}`;
     }
+    if (transportable.isForwardable(jsValue)) {
+        let payload = forwardPayload(jsValue, false, context);
+        if (payload !== undefined) {
+            return <string>payload;
+        }
+        jsValue = jsValue.value;
+    }
+    // Shareable as root object only carries its cid and slot, which unmarshall reads without JSON.
+    if (isShareableWrap(jsValue)) {
+        let cid = (<transportable.Transportable>jsValue).cid();
+        if (cid.indexOf('"') < 0 && cid.indexOf('\\') < 0) {
+            return SCHEMA_PAYLOAD_PREFIX + cid + SHAREABLE_SLOT_SEPARATOR + context.saveShareable(jsValue) + '"}';
+        }
+    }
+    if (_schemasByClass.size !== 0 && jsValue != null && typeof jsValue === 'object') {
+        let prototype = Object.getPrototypeOf(jsValue);
+        let schema = prototype != null ? _schemasByClass.get(prototype.constructor) : undefined;
+        if (schema !== undefined && schema.plain) {
+            return JSON.stringify(schema.marshall(jsValue, context));
+        }
+    }
+    if (hasToJSON(jsValue)) {
+        jsValue = marshallArrayBuffer(jsValue, context);
+    }
     return JSON.stringify(jsValue,
         (key: string, value: any) => {
-            return marshallTransform(value, context);
+            return replaceBufferMembers(marshallTransform(value, context), context);
+        });
+}
+
+/// <summary> Built-in types that binary transport format serializes as is, without visiting their members. </summary>
+/// <remarks> Values may come from other contexts (every module has its own), hence the tag test instead of instanceof. </remarks>
+const BINARY_LEAF_TAGS = new Set<string>([
+    '[object ArrayBuffer]',
+    '[object Date]',
+    '[object RegExp]',
+    '[object Boolean]',
+    '[object Number]',
+    '[object String]'
+]);
+
+/// <summary> Get the built-in type tag of an object, e.g. '[object Map]'. </summary>
+function typeTag(value: any): string {
+    return Object.prototype.toString.call(value);
+}
+
+/// <summary> Tells if a value is serialized as is in binary transport format, without visiting its members. </summary>
+function isBinaryLeaf(value: any): boolean {
+    return ArrayBuffer.isView(value) || BINARY_LEAF_TAGS.has(typeTag(value));
+}
+
+/// <summary> Tells if an object has to be replaced before binary serialization, throws if it can't be transported. </summary>
+function isBinaryTransportable(value: any): boolean {
+    let tag = typeTag(value);
+    if (Array.isArray(value) || tag === '[object Map]' || tag === '[object Set]') {
+        return false;
+    }
+    let prototype = Object.getPrototypeOf(value);
+    if (prototype == null || prototype.constructor.name === 'Object') {
+        return false;
+    }
+    if (typeof value['cid'] !== 'function') {
+        throw new Error(`Object type \"${prototype.constructor.name}\" is not transportable.`);
+    }
+    return true;
+}
+
+/// <summary> Tells if a value graph contains transportable objects. </summary>
+function containsTransportable(value: any, visited: Set<any>): boolean {
+    if (isMarkedForTransfer(value) || isShared(value)) {
+        return true;
+    }
+    if (value == null || typeof value !== 'object' || isBinaryLeaf(value) || visited.has(value)) {
+        return false;
+    }
+    visited.add(value);
+    if (isBinaryTransportable(value)) {
+        return true;
+    }
+
+    let tag = typeTag(value);
+    if (tag === '[object Map]' || tag === '[object Set]') {
+        let found = false;
+        (<Map<any, any>>value).forEach((v: any, k: any) => {
+            found = found || containsTransportable(v, visited) || (tag === '[object Map]' && containsTransportable(k, visited));
+        });
+        return found;
+    }
+    for (let key of Object.keys(value)) {
+        if (containsTransportable(value[key], visited)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// <summary> Copies a value graph with transportable objects replaced by their marshalled form. </summary>
+/// <remarks> Copies are registered before visiting members, so circular references are kept. </remarks>
+function replaceTransportables(value: any, context: transportable.TransportContext, copies: Map<any, any>): any {
+    // Structured clone can't share memory without a serializer delegate.
+    if (isMarkedForTransfer(value) || isShared(value)) {
+        return marshallArrayBuffer(value, context);
+    }
+    if (value == null || typeof value !== 'object' || isBinaryLeaf(value)) {
+        return value;
+    }
+    let copy = copies.get(value);
+    if (copy !== undefined) {
+        return copy;
+    }
+
+    if (isBinaryTransportable(value)) {
+        // Marshalled payloads may contain transportables too.
+        copy = replaceTransportables((<transportable.Transportable>value).marshall(context), context, copies);
+        copies.set(value, copy);
+        return copy;
+    }
+
+    let tag = typeTag(value);
+    if (Array.isArray(value)) {
+        copy = new Array(value.length);
+        copies.set(value, copy);
+        for (let i = 0; i < value.length; ++i) {
+            copy[i] = replaceTransportables(value[i], context, copies);
+        }
+    } else if (tag === '[object Map]') {
+        copy = new Map<any, any>();
+        copies.set(value, copy);
+        value.forEach((v: any, k: any) => {
+            copy.set(replaceTransportables(k, context, copies), replaceTransportables(v, context, copies));
+        });
+    } else if (tag === '[object Set]') {
+        copy = new Set<any>();
+        copies.set(value, copy);
+        value.forEach((v: any) => {
+            copy.add(replaceTransportables(v, context, copies));
         });
-}
\ No newline at end of file
+    } else {
+        copy = {};
+        copies.set(value, copy);
+        for (let key of Object.keys(value)) {
+            copy[key] = replaceTransportables(value[key], context, copies);
+        }
+    }
+    return copy;
+}
+
+/// <summary> Prepare a JS value for binary serialization. </summary>
+/// <param name="jsValue"> JavaScript value, which maybe built-in JavaScript types or transportable objects. </param>
+/// <param name="context"> Transport context to save shared pointers. </param>
+/// <returns> The value to serialize, and whether it needs binaryRevive after deserialization. </returns>
+/// <remarks>
+///     V8 structured clone doesn't know about JS classes, so transportable objects are replaced by their marshalled
+///     form here. Values without transportables, the common case, are returned as is without copying.
+/// </remarks>
+export function binaryTransform(
+    jsValue: any, 
+    context: transportable.TransportContext): [any, boolean] {
+
+    // Function is transportable only as root object, same as marshall.
+    if (typeof jsValue === 'function') {
+        return [{ _cid: 'function', hash: functionTransporter.save(jsValue) }, true];
+    }
+    // Forwardable is only unwrapped as root object, too.
+    if (transportable.isForwardable(jsValue)) {
+        jsValue = jsValue.value;
+    }
+    if (!containsTransportable(jsValue, new Set<any>())) {
+        return [jsValue, false];
+    }
+    return [replaceTransportables(jsValue, context, new Map<any, any>()), true];
+}
+
+/// <summary> Restore transportable objects within a deserialized value, members first. </summary>
+/// <remarks> A payload referred to multiple times is unmarshalled once, thus restored as a single object. </remarks>
+function reviveTransportables(value: any, context: transportable.TransportContext, revived: Map<any, any>): any {
+    if (value == null || typeof value !== 'object' || isBinaryLeaf(value)) {
+        return value;
+    }
+    let result = revived.get(value);
+    if (result !== undefined) {
+        return result;
+    }
+    revived.set(value, value);
+
+    let tag = typeTag(value);
+    if (Array.isArray(value)) {
+        for (let i = 0; i < value.length; ++i) {
+            value[i] = reviveTransportables(value[i], context, revived);
+        }
+        return value;
+    }
+    if (tag === '[object Map]') {
+        let entries: [any, any][] = [];
+        value.forEach((v: any, k: any) => { entries.push([k, v]); });
+        value.clear();
+        for (let entry of entries) {
+            value.set(reviveTransportables(entry[0], context, revived), reviveTransportables(entry[1], context, revived));
+        }
+        return value;
+    }
+    if (tag === '[object Set]') {
+        let items: any[] = [];
+        value.forEach((v: any) => { items.push(v); });
+        value.clear();
+        for (let item of items) {
+            value.add(reviveTransportables(item, context, revived));
+        }
+        return value;
+    }
+    for (let key of Object.keys(value)) {
+        value[key] = reviveTransportables(value[key], context, revived);
+    }
+    result = unmarshallTransform(value, context);
+    revived.set(value, result);
+    return result;
+}
+
+/// <summary> Restore transportable objects within a value deserialized from binary transport format. </summary>
+/// <param name="value"> Deserialized value, which is owned by the caller and updated in place. </param>
+/// <param name="context"> Transport context to load shared pointers. </param>
+/// <returns> Transported value. </returns>
+export function binaryRevive(
+    value: any, 
+    context: transportable.TransportContext): any {
+    return reviveTransportables(value, context, new Map<any, any>());
+}
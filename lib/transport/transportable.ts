@@ -30,6 +30,34 @@ export interface TransportContext {
     /// <summary> Load a shared_ptr from previous save in another isolate. </summary>
     loadShared(handle: Handle): Shareable;
 
+    /// <summary> Save the shared_ptr of a shareable for later load in another isolate. </summary>
+    /// <returns> Slot to load the shared_ptr by, in hex. </returns>
+    saveShareable(object: Shareable): string;
+
+    /// <summary> Load a shared_ptr by its slot into a new instance of a shareable class. </summary>
+    /// <param name="slot"> Slot returned by a previous saveShareable in another isolate. </param>
+    /// <param name="constructor"> Constructor of the shareable class, which creates a napa::module::ShareableWrap. </param>
+    loadShareable(slot: string, constructor: Function): Shareable;
+
+    /// <summary> Save all shared objects of another transport context, so payloads marshalled with it can be forwarded. </summary>
+    saveAll(context: TransportContext): void;
+
+    /// <summary> Save the contents of an ArrayBuffer for later load in another isolate. </summary>
+    /// <param name="buffer"> ArrayBuffer to save. </param>
+    /// <param name="transfer"> Detach the memory from buffer instead of copying it. </param>
+    /// <returns> Handle to load the ArrayBuffer. </returns>
+    saveArrayBuffer(buffer: ArrayBuffer, transfer?: boolean): Handle;
+
+    /// <summary> Load an ArrayBuffer from previous save in another isolate, without copying if possible. </summary>
+    loadArrayBuffer(handle: Handle): ArrayBuffer;
+
+    /// <summary> Share the memory of a SharedArrayBuffer with another isolate. </summary>
+    /// <returns> Handle to load the SharedArrayBuffer. </returns>
+    saveSharedArrayBuffer(buffer: any): Handle;
+
+    /// <summary> Load a SharedArrayBuffer over the memory shared by a previous save in another isolate. </summary>
+    loadSharedArrayBuffer(handle: Handle): any;
+
     /// <summary> Number of shared object saved in this TransportContext. </summary> 
     readonly sharedCount: number;
 }
@@ -62,7 +90,7 @@ export interface Transportable {
 export abstract class TransportableObject implements Transportable{
     /// <summary> Get Constructor ID (cid) for this object. </summary>
     cid(): string {
-        return Object.getPrototypeOf(this)._cid;
+        return Object.getPrototypeOf(this).constructor._cid;
     }
 
     /// <summary> Subclass to save state to payload. </summary>
@@ -81,7 +109,7 @@ export abstract class TransportableObject implements Transportable{
     /// <returns> Plain JavaScript value. </returns>
     marshall(context: TransportContext): object {
         let payload = {
-            _cid: this.cid
+            _cid: this.cid()
         };
         this.save(payload, context);
         return payload;
@@ -115,10 +143,33 @@ export class AutoTransportable extends TransportableObject {
     /// <param name='payload'> Payload to read from, which already have inner objects transported. </param>
     /// <param name='context'> Transport context for loading shared pointers, only usable for C++ addons that extends napa::module::ShareableWrap. </param>
     load(payload: object, context: TransportContext) {
-        // Members have already been unmarshalled. Do nothing.
+        // Members have already been unmarshalled, restore them as own properties.
+        for (let property of Object.getOwnPropertyNames(payload)) {
+            if (property !== '_cid') {
+                (<any>(this))[property] = (<any>(payload))[property];
+            }
+        }
     }
 }
 
+/// <summary> Interface for values holding a payload marshalled before, like zone.Result, 
+/// which can be passed on to another zone or store without unmarshalling. </summary>
+export interface Forwardable {
+    /// <summary> Get the payload to pass on as is, or undefined if it can no longer be forwarded. </summary>
+    forwardPayload(): string | ArrayBuffer;
+
+    /// <summary> The unmarshalled value, which is marshalled again when the payload cannot be forwarded. </summary>
+    readonly value: any;
+
+    /// <summary> Transport context of the payload. </summary>
+    readonly transportContext: TransportContext;
+}
+
+/// <summary> Tell if a jsValue is forwardable. </summary>
+export function isForwardable(jsValue: any): boolean {
+    return jsValue != null && typeof jsValue === 'object' && typeof jsValue['forwardPayload'] === 'function';
+}
+
 /// <summary> Tell if a jsValue is transportable. </summary>
 export function isTransportable(jsValue: any): boolean {
     if (Array.isArray(jsValue)) {
@@ -128,6 +179,10 @@ export function isTransportable(jsValue: any): boolean {
                 return false;
             }
         }
+    } else if (ArrayBuffer.isView(jsValue) 
+        || Object.prototype.toString.call(jsValue) === '[object ArrayBuffer]'
+        || Object.prototype.toString.call(jsValue) === '[object SharedArrayBuffer]') {
+        return true;
     } else if (typeof jsValue === 'object') {
         let constructor = Object.getPrototypeOf(jsValue).constructor;
         if (constructor.name === 'Object') {
@@ -147,21 +202,46 @@ export function isTransportable(jsValue: any): boolean {
 
 /// <summary> Decorator 'cid' to register a transportable class with a 'cid'. </summary>
 /// <param name="moduleId"> Return value of 'module.id' within sub-class definition file. </param>
-/// <param name="className"> Optional for exported class, which will use class name by default. 
-/// For non-exported class, it is required, otherwise 'Object' will be used as className. </param>
+/// <param name="className"> Optional, name of the decorated class is used by default. </param>
 export function cid<T extends TransportableObject>(moduleId: string, className?: string) {
-    let cid = className;
-    if (moduleId != null && moduleId.length !== 0) {
-        let moduleName = extractModuleName(moduleId);
-        if (className == null) {
-            className = Object.getPrototypeOf(this).constructor.name; 
+    return (constructor: new(...args: any[]) => any ) => {
+        let cid = className;
+        if (moduleId != null && moduleId.length !== 0) {
+            cid = `${extractModuleName(moduleId)}.${className != null ? className : constructor.name}`; 
         }
-        cid = `${moduleName}.${className}`; 
+        (<any>constructor)['_cid'] = cid;
+        transport.register(constructor);
     }
+}
+
+/// <summary> Type of a field in a transportable class schema, which is one of
+/// 1) 'number', 'string' or 'boolean', copied as is.
+/// 2) a transportable class declared with @schema.
+/// 3) an array of a single field type, e.g. [Point] or ['number'].
+/// 4) 'any' for any transportable value, which is marshalled by the generic path.
+/// </summary>
+export type FieldType = 'number' | 'string' | 'boolean' | 'any' | (new(...args: any[]) => any) | any[];
 
+/// <summary> Field layout of a transportable class, from field name to field type. </summary>
+export interface Schema {
+    [field: string]: FieldType;
+}
+
+/// <summary> Decorator 'schema' to declare the field layout of a transportable class.
+/// Marshall/unmarshall functions are generated from the schema when the class is registered, save()/load() are not called.
+/// Classes of which fields are all of primitive or schema types are marshalled without JSON replacer/reviver, when
+/// they are the root value.
+/// </summary>
+/// <param name="fields"> Field layout of the class, field values must be of the declared types. </param>
+export function schema(fields: Schema) {
     return (constructor: new(...args: any[]) => any ) => {
-        (<any>constructor)['_cid'] = cid;
-        transport.register(constructor);
+        (<any>constructor)['_schema'] = fields;
+
+        // Decorators are applied bottom-up. @cid declared above @schema registers the class afterwards,
+        // which compiles the schema, otherwise the class is registered already.
+        if (constructor.hasOwnProperty('_cid')) {
+            transport.compileSchema(constructor, (<any>constructor)['_cid']);
+        }
     }
 }
 
@@ -77,6 +77,26 @@ export function currentStack(stackTraceLimit: number = 0): CallSite[] {
     return stack;
 }
 
+/// <summary> Gets the file of the function that called a function, capturing a single stack frame. </summary>
+/// <param name="callee"> A function on the current stack, frames from it up are skipped. </param>
+/// <returns> The file name of its caller, or undefined if it isn't on the stack. </returns>
+export function callerFileName(callee: Function): string {
+    let e: any = Error;
+
+    const originPrepare = e.prepareStackTrace;
+    const originLimit = e.stackTraceLimit;
+
+    e.stackTraceLimit = 1;
+    e.prepareStackTrace = (prepare: any, stack: CallSite[]) => stack.length > 0 ? stack[0].getFileName() : undefined;
+    let holder: any = {};
+    e.captureStackTrace(holder, callee);
+    let fileName: string = holder.stack;
+    e.prepareStackTrace = originPrepare;
+    e.stackTraceLimit = originLimit;
+
+    return fileName;
+}
+
 /// <summary> Format stack trace. </summary>
 export function formatStackTrace(trace: CallSite[]): string {
     let s = '';
@@ -11,12 +11,53 @@ let binding = require('./binding');
 // This variable is either defined by napa runtime, or not defined (hence node runtime)
 declare var __in_napa: boolean;
 
+/// <summary> Converts named entries to the 'name:key=value,...' string the binding parses. </summary>
+function toNamedEntries(entries: { [name: string]: any }) : string {
+    return Object.keys(entries).map(name => {
+        let entry: any = entries[name];
+        return [name].concat(Object.keys(entry).map(key => key + '=' + entry[key])).join(':');
+    }).join(',');
+}
+
+/// <summary> Converts worker classes and tenants to the settings strings the binding parses, other settings pass as is. </summary>
+function toBindingSettings(settings: zone.ZoneSettings) : any {
+    if (settings == null || (settings.workerClasses == null && settings.tenants == null)) {
+        return settings;
+    }
+
+    let converted: any = Object.assign({}, settings);
+    if (settings.workerClasses != null) {
+        converted.workerClasses = toNamedEntries(settings.workerClasses);
+    }
+    if (settings.tenants != null) {
+        converted.tenants = toNamedEntries(settings.tenants);
+    }
+    return converted;
+}
+
 /// <summary> Creates a new zone. </summary>
 /// <summary> A unique id to identify the zone. </summary>
 /// <param name="settings"> The settings of the new zone. </param>
 export function create(id: string, settings: zone.ZoneSettings = zone.DEFAULT_SETTINGS) : zone.Zone {
     platform.initialize();
-    return new impl.ZoneImpl(binding.createZone(id, settings));
+    return new impl.ZoneImpl(binding.createZone(id, toBindingSettings(settings)));
+}
+
+/// <summary> Creates a new zone without blocking the caller while its workers start. </summary>
+/// <summary> A unique id to identify the zone. </summary>
+/// <param name="settings"> The settings of the new zone. </param>
+/// <returns> A promise of the zone, which is fulfilled once all its workers are bootstrapped. </returns>
+export function createAsync(id: string, settings: zone.ZoneSettings = zone.DEFAULT_SETTINGS) : Promise<zone.Zone> {
+    platform.initialize();
+    return new Promise<zone.Zone>((resolve, reject) => {
+        binding.createZoneAsync(id, toBindingSettings(settings), (error: string, zoneWrap: any) => {
+            if (error != null) {
+                reject(new Error(error));
+            } else {
+                resolve(new impl.ZoneImpl(zoneWrap));
+            }
+        });
+    });
 }
 
 /// <summary> Returns the zone associated with the provided id. </summary>
@@ -25,6 +66,58 @@ export function get(id: string) : zone.Zone {
     return new impl.ZoneImpl(binding.getZone(id));
 }
 
+/// <summary> Connects to a zone served by another process with zone.serve. </summary>
+/// <param name="address"> The "host:port" address the zone is served on. </param>
+/// <remarks>
+///     Functions are loaded by module on the serving process, which must resolve the same module paths, so functions
+///     passed by value and objects shared by the transport context fail the call. Once the connection is lost, calls fail.
+/// </remarks>
+export function connect(address: string) : zone.Zone {
+    platform.initialize();
+    return new impl.ZoneImpl(binding.connectZone(address));
+}
+
+/// <summary> Groups zones, local or connected, into a zone routing each call to the least loaded of them. </summary>
+/// <param name="zones"> The zones to group. </param>
+/// <param name="options"> Options of the group. </param>
+/// <remarks>
+///     Each call samples two members and goes to the one with fewer pending calls per worker, weighted by the latency
+///     of its recent calls and the pressure it reports. Small calls prefer local members.
+/// </remarks>
+export function group(zones: zone.Zone[], options?: zone.GroupOptions) : zone.Zone {
+    if (!Array.isArray(zones) || zones.length === 0) {
+        throw new TypeError("Expected a non-empty Array of zones");
+    }
+    platform.initialize();
+
+    let id = options != null && options.id != null ? options.id : zones.map(z => z.id).join(',');
+    let localPayloadSize = options != null && options.localPayloadSize != null ? options.localPayloadSize : 16384;
+    return new impl.ZoneImpl(binding.groupZones(id, zones.map(z => (<impl.ZoneImpl>z).nativeZone), localPayloadSize));
+}
+
+/// <summary> Creates a token to cancel calls with, passed in CallOptions.cancellationToken. </summary>
+export function createCancellationToken() : zone.CancellationToken {
+    platform.initialize();
+    return binding.createCancellationToken();
+}
+
+/// <summary> Executes stages of calls in order, each stage in its zone taking the result of the previous stage. </summary>
+/// <param name="stages"> The stages, of which the first is called with its own arguments only. </param>
+/// <param name="options"> Call options of all stages, defaults to DEFAULT_CALL_OPTIONS. </param>
+/// <returns> A promise of the result of the last stage, which is rejected with the error of the first stage that failed. </returns>
+/// <remarks>
+///     A stage's result is forwarded natively from the worker that ran it to the zone of the next stage,
+///     along with its transport context, without coming back to the caller in between.
+/// </remarks>
+export function pipeline(stages: zone.PipelineStage[], options?: zone.CallOptions) : Promise<zone.Result> {
+    if (!Array.isArray(stages) || stages.length === 0) {
+        throw new TypeError("Expected a non-empty Array of pipeline stages");
+    }
+    // <caller> -> pipeline -> executePipeline
+    //   2           1              0
+    return (<impl.ZoneImpl>stages[0].zone).executePipeline(stages, options, 2);
+}
+
 /// TODO: add function getOrCreate(id: string, settings: zone.ZoneSettings): Zone.
 
 /// <summary> Define a getter property 'current' to retrieve the current zone. </summary>
@@ -45,4 +138,6 @@ Object.defineProperty(exports, "node", {
     }
 });
 
-export * from './zone/zone';
\ No newline at end of file
+export * from './zone/zone';
+export { mergeCpuProfiles } from './zone/cpu-profile';
+export { workerCache, WorkerCache, WorkerCacheOptions } from './zone/worker-cache';
\ No newline at end of file
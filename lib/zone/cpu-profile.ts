@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as zone from './zone';
+
+/// <summary> Merges CPU profiles of zone workers into one, e.g. to see where the zone spends its time as a whole. </summary>
+/// <param name="profiles"> Profiles returned by zone.stopProfiling. </param>
+/// <returns> A profile whose root has a '(worker N)' child per worker, above the call tree of that worker. </returns>
+/// <remarks> Samples of all workers are interleaved by time, as if they were taken on a single thread. </remarks>
+export function mergeCpuProfiles(profiles: zone.WorkerCpuProfile[]) : zone.CpuProfile {
+    let root: zone.CpuProfileNode = createNode(1, '(root)');
+    let merged: zone.CpuProfile = {
+        nodes: [root],
+        startTime: profiles.length > 0 ? Math.min(...profiles.map(p => p.profile.startTime)) : 0,
+        endTime: profiles.length > 0 ? Math.max(...profiles.map(p => p.profile.endTime)) : 0,
+        samples: [],
+        timeDeltas: []
+    };
+
+    // Samples of all workers, with node ids of the merged profile and absolute times.
+    let samples: { id: number, time: number }[] = [];
+    let nextId = 2;
+    for (let workerProfile of profiles) {
+        let profile = workerProfile.profile;
+
+        // The root of each worker, which is listed first, becomes its '(worker N)' node.
+        // Ids of other nodes are shifted past the ids taken.
+        let workerRoot = profile.nodes[0];
+        let offset = nextId;
+        let mapId = (id: number) => id === workerRoot.id ? offset : offset + id;
+
+        for (let node of profile.nodes) {
+            let mergedNode = node === workerRoot ?
+                createNode(offset, '(worker ' + workerProfile.workerId + ')') :
+                Object.assign({}, node, { id: mapId(node.id) });
+            mergedNode.hitCount = node.hitCount;
+            mergedNode.children = node.children.map(mapId);
+            merged.nodes.push(mergedNode);
+            nextId = Math.max(nextId, mergedNode.id + 1);
+        }
+        root.children.push(offset);
+
+        let time = profile.startTime;
+        for (let i = 0; i < profile.samples.length; ++i) {
+            time += profile.timeDeltas[i];
+            samples.push({ id: mapId(profile.samples[i]), time: time });
+        }
+    }
+
+    samples.sort((a, b) => a.time - b.time);
+    let previous = merged.startTime;
+    for (let sample of samples) {
+        merged.samples.push(sample.id);
+        merged.timeDeltas.push(sample.time - previous);
+        previous = sample.time;
+    }
+    return merged;
+}
+
+function createNode(id: number, functionName: string) : zone.CpuProfileNode {
+    return {
+        id: id,
+        callFrame: { functionName: functionName, scriptId: '0', url: '', lineNumber: -1, columnNumber: -1 },
+        hitCount: 0,
+        children: []
+    };
+}
@@ -1,8 +1,26 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+import * as tracing from '../tracing';
 import * as transport from '../transport';
-import { CallOptions } from './zone';
+import { CallOptions, TransportOption } from './zone';
+
+/// <summary> Functions of zone.prepare by key, resolved once per isolate. </summary>
+let _preparedFunctions = new Map<string, (...args: any[]) => any>();
+
+/// <summary> Number of module invalidations in the process when prepared functions were resolved. </summary>
+let _preparedGeneration = 0;
+
+/// <summary> Native binding that keeps definitions of prepared functions, across isolates. </summary>
+let _binding: any;
+
+function getBinding(): any {
+    if (_binding == null) {
+        // Lazy require to avoid circular runtime dependency between binding and zone on bootstrap.
+        _binding = require('../binding');
+    }
+    return _binding;
+}
 
 /// <summary> Rejection type </summary>
 /// TODO: we need a better mapping between error code and result code.
@@ -15,7 +33,7 @@ export enum RejectionType {
 export interface CallContext {
 
     /// <summary> Resolve task with marshalled result. </summary>
-    resolve(result: string): void;
+    resolve(result: string | ArrayBuffer): void;
 
     /// <summary> Reject task with reason. </summary>
     reject(reason: any): void;
@@ -35,14 +53,20 @@ export interface CallContext {
     /// <summary> Function name to execute. </summary>
     readonly function: string;
 
-    /// <summary> Marshalled arguments. </summary>
-    readonly args: string[];
+    /// <summary> Marshalled arguments, ArrayBuffers when the call uses TransportOption.BINARY. </summary>
+    readonly args: (string | ArrayBuffer)[];
 
     /// <summary> Transport context. </summary>
     readonly transportContext: transport.TransportContext;
 
     /// <summary> Execute options. </summary>
     readonly options: CallOptions;
+
+    /// <summary> CPU time in nano-seconds the call consumed so far while it executed. </summary>
+    readonly cpuTime: number;
+
+    /// <summary> An estimate of bytes the call allocated so far on the V8 heap while it executed. </summary>
+    readonly allocatedBytes: number;
 }
 
 /// <summary> 
@@ -57,10 +81,14 @@ export interface CallContext {
 ///        module name: target module path.
 ///        function name: target function name from the module.
 ///
+///     4) calling a function of zone.prepare:
+///        module name: literal '__prepared'
+///        function name: key returned from prepareFunction().
+///
 ///     function name can have multiple levels like 'foo.bar'.
 /// </summary>
 export function call(context: CallContext): void {
-    // Cache the context since every call to context.transportContext will create a new wrap upon inner TransportContext pointer.
+    // The wrap caches transportContext for the call, it's kept here to save reading the accessor again.
     let transportContext = context.transportContext;
     let result: any = undefined;
     try {
@@ -75,17 +103,48 @@ export function call(context: CallContext): void {
         context.reject(error);
         return;
     }
+    finishWith(context, transportContext, result);
+}
+
+/// <summary> 
+///     Proxy function for __napa_zone_resolve__, by which calls of plain JSON values are dispatched natively.
+///     Resolves the function of a module and function name as call does, returning undefined if it fails.
+/// </summary>
+export function resolve(moduleName: string, functionName: string): (...args: any[]) => any {
+    try {
+        return getFunction(moduleName, functionName);
+    }
+    catch (error) {
+        // The native dispatcher falls back to call, which rejects with the error.
+        return undefined;
+    }
+}
+
+/// <summary> 
+///     Proxy function for __napa_zone_finish__, by which the native dispatcher completes calls
+///     whose result is not plain JSON, such as promises or Transportable objects.
+/// </summary>
+export function finish(context: CallContext, result: any): void {
+    finishWith(context, context.transportContext, result);
+}
+
+/// <summary> Finish call with a result that may be a promise. </summary>
+function finishWith(
+    context: CallContext, 
+    transportContext: transport.TransportContext, 
+    result: any) {
 
     if (result != null 
         && typeof result === 'object'
         && typeof result['then'] === 'function') {
-        // Delay completion if return value is a promise.
-        result.then((value: any) => {
-            finishCall(context, transportContext, value);
-        })
-        .catch((error: any) => {
-            context.reject(error);
-        });
+        // Delay completion if return value is a promise. Thenables are adopted, their 'then' may not return a promise.
+        Promise.resolve(result).then(
+            (value: any) => {
+                finishCall(context, transportContext, value);
+            },
+            (error: any) => {
+                context.reject(error);
+            });
         return;
     }
     finishCall(context, transportContext, result);
@@ -95,45 +154,106 @@ export function call(context: CallContext): void {
 function callFunction(
     moduleName: string, 
     functionName: string, 
-    marshalledArgs: string[], 
+    marshalledArgs: (string | ArrayBuffer)[], 
     transportContext: transport.TransportContext,
     options: CallOptions): any {
 
-    let module: any = null;
-    let useAnonymousFunction: boolean = false;
+    let func = getFunction(moduleName, functionName);
 
+    let start = tracing.isEnabled() || transport.isAccounting() ? tracing.now() : -1;
+    let args = marshalledArgs.map((arg) => {
+        return typeof arg === 'string' ?
+            transport.unmarshall(arg, transportContext) :
+            transport.unmarshallBinary(arg, transportContext);
+    });
+    if (start >= 0) {
+        tracing.recordSpan('UnmarshallArguments', start);
+        transport.recordCost(undefined, getAccountingName(moduleName, functionName), 'UnmarshallArguments',
+            marshalledArgs, transportContext.sharedCount, start);
+    }
+    return func.apply(this, args);
+}
+
+/// <summary> Gets the function of a call by module and function name, see call. </summary>
+export function getFunction(moduleName: string, functionName: string): (...args: any[]) => any {
+    if (moduleName === '__function') {
+        return transport.loadFunction(functionName);
+    } else if (moduleName === '__prepared') {
+        return loadPreparedFunction(functionName);
+    }
+    return resolveFunction(moduleName, functionName);
+}
+
+/// <summary> Gets the name a function is accounted by in transport metrics. </summary>
+/// <remarks> Anonymous and prepared functions are known by keys, which are accounted as one name each. </remarks>
+export function getAccountingName(moduleName: string, functionName: string): string {
+    if (moduleName === '__function') {
+        return '(anonymous)';
+    } else if (moduleName === '__prepared') {
+        return '(prepared)';
+    } else if (moduleName == null || moduleName.length === 0 || moduleName === 'global') {
+        return functionName;
+    }
+    return moduleName + ':' + functionName;
+}
+
+/// <summary> Resolves a function by module and function name, see call. </summary>
+function resolveFunction(moduleName: string, functionName: string): (...args: any[]) => any {
+    let module: any = null;
     if (moduleName == null || moduleName.length === 0 || moduleName === 'global') {
         module = global;
-    } else if (moduleName === '__function') {
-        useAnonymousFunction = true;
     } else {
         module = require(moduleName);
     }
+    if (module == null) {
+        throw new Error(`Cannot load module \"${moduleName}\".`);
+    }
 
-    let func = null;
-    if (useAnonymousFunction) {
-        func = transport.loadFunction(functionName);
-    } else {
-        if (module == null) {
-            throw new Error(`Cannot load module \"${moduleName}\".`);
-        }
-        func = module;
-        if (functionName != null && functionName.length != 0) {
-            var path = functionName.split('.');
-            for (let item of path) {
-                func = func[item];
-                if (func === undefined) {
-                    throw new Error("Cannot find function '" + functionName + "' in module '" + moduleName + "'");
-                }
+    let func = module;
+    if (functionName != null && functionName.length != 0) {
+        var path = functionName.split('.');
+        for (let item of path) {
+            func = func[item];
+            if (func === undefined) {
+                throw new Error("Cannot find function '" + functionName + "' in module '" + moduleName + "'");
             }
         }
-        if (typeof func !== 'function') {
-            throw new Error("'" + functionName + "' in module '" + moduleName + "' is not a function");
-        }
     }
+    if (typeof func !== 'function') {
+        throw new Error("'" + functionName + "' in module '" + moduleName + "' is not a function");
+    }
+    return func;
+}
 
-    let args = marshalledArgs.map((arg) => { return transport.unmarshall(arg, transportContext); });
-    return func.apply(this, args);
+/// <summary> Registers a function by module and function name, for zone workers to resolve it once. </summary>
+/// <param name="moduleName"> Absolute path of the module, or empty for a global function. </param>
+/// <returns> The key to call it with under module name '__prepared'. </returns>
+/// <remarks> Definitions are kept in the process-wide registry of transported functions. </remarks>
+export function prepareFunction(moduleName: string, functionName: string): string {
+    return <string>getBinding().saveFunctionDefinition(moduleName != null ? moduleName : '', functionName != null ? functionName : '');
+}
+
+/// <summary> Gets a function of prepareFunction, resolving it on first use in the current isolate. </summary>
+function loadPreparedFunction(key: string): (...args: any[]) => any {
+    // Functions of an invalidated module are resolved again from the module loaded anew.
+    let generation: number = getBinding().getModuleGeneration();
+    if (generation !== _preparedGeneration) {
+        _preparedFunctions.clear();
+        _preparedGeneration = generation;
+    }
+
+    let func = _preparedFunctions.get(key);
+    if (func === undefined) {
+        let def: [string, string] = getBinding().getFunctionDefinition(key);
+        if (def == null) {
+            throw new Error(`Prepared function cannot be found: ${key}`);
+        }
+
+        // A function that fails to resolve is not cached, e.g. for a later broadcast to define it.
+        func = resolveFunction(def[0], def[1]);
+        _preparedFunctions.set(key, func);
+    }
+    return func;
 }
 
 /// <summary> Finish call with result. </summary>
@@ -142,13 +262,23 @@ function finishCall(
     transportContext: transport.TransportContext, 
     result: any) {
 
-    let payload: string = undefined;
+    let payload: string | ArrayBuffer = undefined;
+    let start = tracing.isEnabled() || transport.isAccounting() ? tracing.now() : -1;
+    let sharedCount = start >= 0 ? transportContext.sharedCount : 0;
     try {
-        payload = transport.marshall(result, transportContext);
+        payload = context.options.transport === TransportOption.BINARY ?
+            transport.marshallBinary(result, transportContext) :
+            transport.marshall(result, transportContext);
     }
     catch (error) {
         context.reject(error);
         return;
     }
+    if (start >= 0) {
+        // A promise may resolve after the worker moved on to another call, the trace id is the call's own.
+        tracing.recordSpan('MarshallResult', start, context.options.traceId);
+        transport.recordCost(undefined, getAccountingName(context.module, context.function), 'MarshallResult',
+            [payload], transportContext.sharedCount - sharedCount, start);
+    }
     context.resolve(payload);
 }
\ No newline at end of file
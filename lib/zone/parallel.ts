@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as transport from '../transport';
+
+/// <summary> Module of the functions chunks run on zone workers. </summary>
+export const MODULE_NAME: string = __filename;
+
+/// <summary> Chunks per worker when the cost of items is not known yet, so faster workers can take more of them. </summary>
+const CHUNKS_PER_WORKER = 4;
+
+/// <summary> Shortest run of a chunk in nanoseconds, below which the per call overhead outweighs the work. </summary>
+const MIN_CHUNK_TIME = 1e6;
+
+/// <summary> Longest run of a chunk in nanoseconds, above which workers finish too unevenly. </summary>
+const MAX_CHUNK_TIME = 1e8;
+
+/// <summary> Weight of the last measured cost in the moving average of a function's cost. </summary>
+const COST_WEIGHT = 0.5;
+
+/// <summary> Nanoseconds of CPU per item, by hash of the mapping or reducing function. </summary>
+let _itemCosts = new Map<string, number>();
+
+/// <summary> Returns items per chunk to split a number of items into for a number of workers. </summary>
+/// <param name="funcHash"> Hash of the function, by which its cost of earlier calls is looked up. </param>
+/// <remarks>
+///     Items of unknown cost are spread over CHUNKS_PER_WORKER chunks per worker. Once the cost is measured,
+///     chunks are also kept between MIN_CHUNK_TIME and MAX_CHUNK_TIME of CPU when there are enough items.
+/// </remarks>
+export function getChunkSize(funcHash: string, items: number, workers: number): number {
+    let size = Math.ceil(items / (Math.max(workers, 1) * CHUNKS_PER_WORKER));
+    let cost = _itemCosts.get(funcHash);
+    if (cost !== undefined && cost > 0) {
+        size = Math.min(Math.max(size, Math.ceil(MIN_CHUNK_TIME / cost)), Math.floor(MAX_CHUNK_TIME / cost));
+    }
+    return Math.min(Math.max(size, 1), Math.max(items, 1));
+}
+
+/// <summary> Updates the cost of a function with the CPU time its chunks took. </summary>
+/// <param name="cpuTime"> Nanoseconds of CPU of all chunks, 0 if unknown. </param>
+export function recordCost(funcHash: string, items: number, cpuTime: number): void {
+    if (items === 0 || !(cpuTime > 0)) {
+        return;
+    }
+    let cost = cpuTime / items;
+    let last = _itemCosts.get(funcHash);
+    _itemCosts.set(funcHash, last === undefined ? cost : last + COST_WEIGHT * (cost - last));
+}
+
+/// <summary> Maps a chunk of items, called on zone workers by zone.map. </summary>
+/// <param name="funcHash"> Hash of the mapping function, from transport.saveFunction. </param>
+/// <param name="offset"> Index of the first item of the chunk in the whole array. </param>
+export function mapChunk(funcHash: string, items: any[], offset: number): any[] {
+    let func = transport.loadFunction(funcHash);
+    let results = new Array(items.length);
+    for (let i = 0; i < items.length; ++i) {
+        results[i] = func(items[i], offset + i);
+    }
+    return results;
+}
+
+/// <summary> Folds a chunk of items from the initial value, called on zone workers by zone.reduce. </summary>
+/// <param name="funcHash"> Hash of the reducing function, from transport.saveFunction. </param>
+/// <param name="offset"> Index of the first item of the chunk in the whole array. </param>
+export function reduceChunk(funcHash: string, items: any[], initialValue: any, offset: number): any {
+    let func = transport.loadFunction(funcHash);
+    let accumulator = initialValue;
+    for (let i = 0; i < items.length; ++i) {
+        accumulator = func(accumulator, items[i], offset + i);
+    }
+    return accumulator;
+}
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as zone from './zone';
+import * as transport from '../transport';
+
+/// <summary> Native binding to create stream channels. </summary>
+let _binding: any;
+
+/// <summary> Status of a StreamChannelWrap.write. Reference: napa::zone::StreamChannel::WriteStatus. </summary>
+const WRITE_READY = 0;
+const WRITE_CLOSED = 2;
+
+/// <summary> Creates a native channel of chunks, which is shared by a StreamWriter and a ResultStream. </summary>
+/// <param name="capacity"> Number of chunks that can be queued before the writer waits. </param>
+export function createChannel(capacity: number): any {
+    if (_binding == null) {
+        // Lazy require to avoid circular runtime dependency between binding and zone on bootstrap.
+        _binding = require('../binding');
+    }
+    return _binding.createStreamChannel(capacity);
+}
+
+/// <summary> Writer side of a streaming call, transported to the zone function as its last argument. </summary>
+export class StreamWriter extends transport.AutoTransportable implements zone.StreamWriter {
+    private _channel: any;
+    private _binary: boolean;
+
+    constructor(channel?: any, binary: boolean = false) {
+        super();
+        this._channel = channel;
+        this._binary = binary;
+    }
+
+    get closed(): boolean {
+        return this._channel.closed;
+    }
+
+    write(value: any): Promise<boolean> {
+        // Each chunk owns its transport context, which is handed over to the reader along with the payload.
+        let context = transport.createTransportContext(true);
+        let payload = this._binary ? transport.marshallBinary(value, context) : transport.marshall(value, context);
+
+        let status = this._channel.write(payload, context);
+        if (status === WRITE_READY || status === WRITE_CLOSED) {
+            return Promise.resolve(status === WRITE_READY);
+        }
+        return new Promise<boolean>(resolve => {
+            this._channel.waitWritable(resolve);
+        });
+    }
+}
+
+transport.cid(module.id)(StreamWriter);
+
+/// <summary> Reader side of a streaming call. </summary>
+export class ResultStream implements zone.ResultStream {
+    private _channel: any;
+    private _result: Promise<zone.Result>;
+    private _reading: Promise<any>;
+
+    constructor(channel: any, result: Promise<zone.Result>) {
+        this._channel = channel;
+        this._result = result;
+        this._reading = Promise.resolve();
+
+        // Chunks written before the call completes are still read, then the stream ends, with the error if the call failed.
+        result.then(
+            () => { this._channel.end(); },
+            (error: any) => { this._channel.end(error != null ? error.toString() : 'Call failed.'); });
+    }
+
+    get result(): Promise<zone.Result> {
+        return this._result;
+    }
+
+    next(): Promise<IteratorResult<any>> {
+        // The native channel takes one read at a time, reads are chained to keep their order.
+        let read = this._reading.then(() => this.readChunk());
+        this._reading = read.catch(() => {});
+        return read;
+    }
+
+    return(): Promise<IteratorResult<any>> {
+        this.cancel();
+        return Promise.resolve({ done: true, value: undefined });
+    }
+
+    cancel(): void {
+        this._channel.cancel();
+    }
+
+    toReadable(): any {
+        let stream = require('stream');
+        let readable = new stream.Readable({
+            objectMode: true,
+            read: () => {
+                this.next().then(
+                    (chunk: IteratorResult<any>) => { readable.push(chunk.done ? null : chunk.value); },
+                    (error: any) => { readable.emit('error', new Error(error)); });
+            }
+        });
+        return readable;
+    }
+
+    private readChunk(): Promise<IteratorResult<any>> {
+        return new Promise<IteratorResult<any>>((resolve, reject) => {
+            this._channel.read((payload: string | ArrayBuffer, context: transport.TransportContext, error: string) => {
+                if (payload === undefined) {
+                    if (error !== undefined) {
+                        reject(error);
+                    } else {
+                        resolve({ done: true, value: undefined });
+                    }
+                    return;
+                }
+                try {
+                    let value = typeof payload === 'string' ?
+                        transport.unmarshall(payload, context) :
+                        transport.unmarshallBinary(payload, context);
+                    resolve({ done: false, value: value });
+                } catch (e) {
+                    reject(e);
+                }
+            });
+        });
+    }
+}
+
+// Make ResultStream usable in for-await loops where async iteration is supported.
+let asyncIterator = (<any>Symbol).asyncIterator;
+if (asyncIterator !== undefined) {
+    (<any>ResultStream.prototype)[asyncIterator] = function() { return this; };
+}
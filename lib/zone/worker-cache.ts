@@ -0,0 +1,253 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as metric from '../metric';
+import { MemoryPressureLevel } from '../memory/pressure';
+
+let binding = require('../binding');
+
+/// <summary> Limits of a worker cache. </summary>
+export interface WorkerCacheOptions {
+    /// <summary> Entries kept at most, 0 (default) for no limit. </summary>
+    maxEntries?: number;
+
+    /// <summary> Estimated bytes of keys and values kept at most, 0 (default) for no limit. </summary>
+    maxBytes?: number;
+
+    /// <summary> Time to live in milliseconds of entries set without their own, 0 (default) for no expiry. </summary>
+    ttl?: number;
+}
+
+/// <summary> A least recently used cache in the isolate of the worker that created it. </summary>
+export interface WorkerCache {
+    /// <summary> Name of the cache, unique in its worker. </summary>
+    readonly name: string;
+
+    /// <summary> Number of entries, including expired ones not reclaimed yet. </summary>
+    readonly size: number;
+
+    /// <summary> Estimated bytes of keys and values of the entries. </summary>
+    readonly bytes: number;
+
+    /// <summary> Gets the value of a key, which becomes the most recently used one, or undefined if it's missing or expired. </summary>
+    get(key: string): any;
+
+    /// <summary> Sets the value of a key, evicting least recently used keys beyond the limits. </summary>
+    /// <param name="ttl"> Time to live in milliseconds, the ttl of the cache by default. </param>
+    set(key: string, value: any, ttl?: number): void;
+
+    /// <summary> Tells if a key has a value that isn't expired, without making it recently used. </summary>
+    has(key: string): boolean;
+
+    /// <summary> Deletes a key. No-op if the key is missing. </summary>
+    delete(key: string): void;
+
+    /// <summary> Deletes all keys. </summary>
+    clear(): void;
+}
+
+/// <summary> An entry of a worker cache. </summary>
+interface Entry {
+    value: any;
+    bytes: number;
+
+    /// <summary> Time in milliseconds the entry expires at, 0 if it doesn't. </summary>
+    expiration: number;
+}
+
+/// <summary> Bytes V8 takes for an object or array without its members, as far as estimates go. </summary>
+const OBJECT_OVERHEAD = 32;
+
+/// <summary> Estimates bytes a value takes on the heap, counting objects reachable from it once. </summary>
+export function estimateBytes(value: any, visited?: Set<any>): number {
+    switch (typeof value) {
+        case 'string':
+            return 16 + value.length * 2;
+        case 'number':
+        case 'boolean':
+        case 'undefined':
+            return 8;
+        case 'function':
+        case 'symbol':
+            return OBJECT_OVERHEAD;
+    }
+
+    if (value === null) {
+        return 8;
+    }
+    if (value instanceof ArrayBuffer || ArrayBuffer.isView(value)) {
+        return OBJECT_OVERHEAD + value.byteLength;
+    }
+
+    visited = visited || new Set<any>();
+    if (visited.has(value)) {
+        return 8;
+    }
+    visited.add(value);
+
+    let bytes = OBJECT_OVERHEAD;
+    if (value instanceof Map) {
+        value.forEach((v: any, k: any) => {
+            bytes += estimateBytes(k, visited) + estimateBytes(v, visited);
+        });
+    } else if (value instanceof Set) {
+        value.forEach((v: any) => {
+            bytes += estimateBytes(v, visited);
+        });
+    } else if (Array.isArray(value)) {
+        for (let i = 0; i < value.length; ++i) {
+            bytes += estimateBytes(value[i], visited);
+        }
+    } else {
+        for (let key of Object.keys(value)) {
+            bytes += estimateBytes(key, visited) + estimateBytes(value[key], visited);
+        }
+    }
+    return bytes;
+}
+
+/// <summary> Worker caches of this isolate by name. </summary>
+let _caches = new Map<string, WorkerCacheImpl>();
+
+class WorkerCacheImpl implements WorkerCache {
+    private _name: string;
+    private _maxEntries: number;
+    private _maxBytes: number;
+    private _ttl: number;
+
+    /// <summary> Entries in order of use, from the least recently used. </summary>
+    private _entries = new Map<string, Entry>();
+    private _bytes = 0;
+
+    private _hits: metric.BoundMetric;
+    private _misses: metric.BoundMetric;
+    private _evictions: metric.BoundMetric;
+
+    constructor(name: string, options: WorkerCacheOptions) {
+        this._name = name;
+        this._maxEntries = getLimit(options.maxEntries, 'maxEntries');
+        this._maxBytes = getLimit(options.maxBytes, 'maxBytes');
+        this._ttl = getLimit(options.ttl, 'ttl');
+
+        let dimensions = [binding.getCurrentZone().getId(), name];
+        this._hits = metric.get('WorkerCache', 'Hits', metric.MetricType.Rate, ['zone', 'cache']).bind(dimensions);
+        this._misses = metric.get('WorkerCache', 'Misses', metric.MetricType.Rate, ['zone', 'cache']).bind(dimensions);
+        this._evictions = metric.get('WorkerCache', 'Evictions', metric.MetricType.Rate, ['zone', 'cache']).bind(dimensions);
+    }
+
+    public get name(): string {
+        return this._name;
+    }
+
+    public get size(): number {
+        return this._entries.size;
+    }
+
+    public get bytes(): number {
+        return this._bytes;
+    }
+
+    public get(key: string): any {
+        let entry = this._entries.get(key);
+        if (entry === undefined || this.expire(key, entry)) {
+            this._misses.increment();
+            return undefined;
+        }
+
+        // Maps iterate in insertion order, so re-inserting an entry makes it the most recently used.
+        this._entries.delete(key);
+        this._entries.set(key, entry);
+        this._hits.increment();
+        return entry.value;
+    }
+
+    public set(key: string, value: any, ttl?: number): void {
+        ttl = ttl === undefined ? this._ttl : getLimit(ttl, 'ttl');
+
+        this.delete(key);
+        let entry: Entry = {
+            value: value,
+            bytes: estimateBytes(key) + estimateBytes(value),
+            expiration: ttl > 0 ? Date.now() + ttl : 0
+        };
+        this._entries.set(key, entry);
+        this._bytes += entry.bytes;
+
+        // The entry just set is never evicted by its own write, even if it alone exceeds maxBytes.
+        this.evict(this._maxEntries, this._maxBytes, 1);
+    }
+
+    public has(key: string): boolean {
+        let entry = this._entries.get(key);
+        return entry !== undefined && !this.expire(key, entry);
+    }
+
+    public delete(key: string): void {
+        let entry = this._entries.get(key);
+        if (entry !== undefined) {
+            this._entries.delete(key);
+            this._bytes -= entry.bytes;
+        }
+    }
+
+    public clear(): void {
+        this._entries.clear();
+        this._bytes = 0;
+    }
+
+    /// <summary> Evicts least recently used entries until the cache is within the limits, 0 for no limit. </summary>
+    /// <param name="keep"> Most recently used entries that are kept regardless of the limits. </param>
+    public evict(maxEntries: number, maxBytes: number, keep: number = 0): void {
+        let keys = this._entries.keys();
+        while (this._entries.size > keep
+            && ((maxEntries > 0 && this._entries.size > maxEntries) || (maxBytes > 0 && this._bytes > maxBytes))) {
+            let key = keys.next().value;
+            this._bytes -= this._entries.get(key).bytes;
+            this._entries.delete(key);
+            this._evictions.increment();
+        }
+    }
+
+    /// <summary> Deletes an entry if it's expired. </summary>
+    private expire(key: string, entry: Entry): boolean {
+        if (entry.expiration === 0 || entry.expiration > Date.now()) {
+            return false;
+        }
+        this.delete(key);
+        return true;
+    }
+}
+
+function getLimit(value: number, name: string): number {
+    if (value === undefined) {
+        return 0;
+    }
+    if (typeof value !== 'number' || !(value >= 0)) {
+        throw new TypeError(`Option '${name}' must be a non-negative number.`);
+    }
+    return value;
+}
+
+/// <summary> Gets the cache of a name in the isolate of the calling worker, creating it on first use. </summary>
+/// <param name="name"> Name of the cache. </param>
+/// <param name="options"> Limits of the cache if it's created, an existing cache keeps its own. </param>
+export function workerCache(name: string, options: WorkerCacheOptions = {}): WorkerCache {
+    let cache = _caches.get(name);
+    if (cache === undefined) {
+        cache = new WorkerCacheImpl(name, options);
+        _caches.set(name, cache);
+    }
+    return cache;
+}
+
+/// <summary> Releases entries of worker caches of this isolate on memory pressure, as '__napa_memory_pressure__'. </summary>
+/// <remarks> Moderate pressure evicts least recently used entries of half the bytes of each cache, critical pressure clears them. </remarks>
+export function onMemoryPressure(level: MemoryPressureLevel): void {
+    _caches.forEach((cache: WorkerCacheImpl) => {
+        if (level === MemoryPressureLevel.CRITICAL) {
+            cache.clear();
+        } else if (level === MemoryPressureLevel.MODERATE) {
+            cache.evict(0, Math.floor(cache.bytes / 2));
+        }
+    });
+}
@@ -3,6 +3,10 @@
 
 import * as path from 'path';
 import * as zone from './zone';
+import * as functionCall from './function-call';
+import * as parallel from './parallel';
+import * as resultStream from './result-stream';
+import * as tracing from '../tracing';
 import * as transport from '../transport';
 import * as v8 from '../v8';
 
@@ -14,34 +18,214 @@ interface FunctionSpec {
     transportContext: transport.TransportContext;
 }
 
+/// <summary> Returns UTF-8 bytes of a JSON payload, or bytes of a binary payload. </summary>
+function toPayloadBytes(payload: string | ArrayBuffer): Uint8Array {
+    if (typeof payload !== 'string') {
+        return new Uint8Array(payload);
+    } else if (typeof Buffer !== 'undefined') {
+        return Buffer.from(payload, 'utf8');
+    }
+
+    let utf8 = unescape(encodeURIComponent(payload));
+    let bytes = new Uint8Array(utf8.length);
+    for (let i = 0; i < utf8.length; ++i) {
+        bytes[i] = utf8.charCodeAt(i);
+    }
+    return bytes;
+}
+
 class Result implements zone.Result{
 
-     constructor(payload: string, transportContext: transport.TransportContext) {
+     constructor(payload: string | ArrayBuffer, transportContext: transport.TransportContext, cpuTime: number, allocatedBytes: number) {
           this._payload = payload;
           this._transportContext = transportContext; 
+          this._cpuTime = cpuTime;
+          this._allocatedBytes = allocatedBytes;
+     }
+
+     /// <summary> Sets the zone and function the result is accounted to in transport metrics. </summary>
+     accountTo(owner: zone.Zone, spec: FunctionSpec): this {
+         this._accountZone = owner;
+         this._accountSpec = spec;
+         return this;
      }
 
      get value(): any {
          if (this._value == null) {
-             this._value = transport.unmarshall(this._payload, this._transportContext);
+             let start = tracing.isEnabled() || transport.isAccounting() ? tracing.now() : -1;
+             this._value = typeof this._payload === 'string' ?
+                 transport.unmarshall(this._payload, this._transportContext) :
+                 transport.unmarshallBinary(this._payload, this._transportContext);
+             if (start >= 0) {
+                 tracing.recordSpan('UnmarshallResult', start);
+                 if (this._accountSpec != null) {
+                     transport.recordCost(this._accountZone.id, functionCall.getAccountingName(this._accountSpec.module, this._accountSpec.function),
+                         'UnmarshallResult', [this._payload], this._transportContext.sharedCount, start);
+                 }
+             }
          }
 
          return this._value;
      }
 
-     get payload(): string {
+     get payload(): string | ArrayBuffer {
          return this._payload; 
      }
 
+     get payloadBytes(): Uint8Array {
+         if (this._payloadBytes == null) {
+             this._payloadBytes = toPayloadBytes(this._payload);
+         }
+         return this._payloadBytes;
+     }
+
+     forwardPayload(): string | ArrayBuffer {
+         // Loading the value took the memory of transported ArrayBuffers over, the payload doesn't refer to them anymore.
+         if (this._value != null && this._transportContext.sharedCount > 0) {
+             return undefined;
+         }
+         return this._payload;
+     }
+
      get transportContext(): transport.TransportContext {
          return this._transportContext; 
      }
 
+     get cpuTime(): number {
+         return this._cpuTime;
+     }
+
+     get allocatedBytes(): number {
+         return this._allocatedBytes;
+     }
+
      private _transportContext: transport.TransportContext;
-     private _payload: string;
+     private _cpuTime: number;
+     private _allocatedBytes: number;
+     private _payload: string | ArrayBuffer;
+     private _payloadBytes: Uint8Array;
      private _value: any;
+     private _accountZone: zone.Zone;
+     private _accountSpec: FunctionSpec;
 };
 
+/// <summary> Result of a call of executeSync, with the time the caller waited. </summary>
+class SyncResult extends Result implements zone.SyncResult {
+
+    constructor(payload: string | ArrayBuffer, transportContext: transport.TransportContext, cpuTime: number, allocatedBytes: number, waitTime: number) {
+        super(payload, transportContext, cpuTime, allocatedBytes);
+        this._waitTime = waitTime;
+    }
+
+    get waitTime(): number {
+        return this._waitTime;
+    }
+
+    private _waitTime: number;
+}
+
+/// <summary> Result of a call run inline, whose value was returned as is. </summary>
+class InlineResult implements zone.Result {
+
+    constructor(value: any, options: zone.CallOptions) {
+        this._value = value;
+        this._binary = options != null && options.transport === zone.TransportOption.BINARY;
+    }
+
+    get value(): any {
+        return this._value;
+    }
+
+    get payload(): string | ArrayBuffer {
+        this.marshall();
+        return this._payload;
+    }
+
+    get payloadBytes(): Uint8Array {
+        return toPayloadBytes(this.payload);
+    }
+
+    forwardPayload(): string | ArrayBuffer {
+        return this.payload;
+    }
+
+    get transportContext(): transport.TransportContext {
+        this.marshall();
+        return this._transportContext;
+    }
+
+    get cpuTime(): number {
+        return 0;
+    }
+
+    get allocatedBytes(): number {
+        return 0;
+    }
+
+    /// <summary> Marshalls the value the first time its payload is asked for, e.g. to pass it on to another zone. </summary>
+    private marshall(): void {
+        if (this._transportContext == null) {
+            this._transportContext = transport.createTransportContext(true);
+            this._payload = this._binary ?
+                transport.marshallBinary(this._value, this._transportContext) :
+                transport.marshall(this._value, this._transportContext);
+        }
+    }
+
+    private _value: any;
+    private _binary: boolean;
+    private _payload: string | ArrayBuffer;
+    private _transportContext: transport.TransportContext;
+}
+
+/// <summary> Id of the zone of the current isolate, which doesn't change over its lifetime. </summary>
+let _currentZoneId: string;
+
+function getCurrentZoneId(): string {
+    if (_currentZoneId == null) {
+        // Lazy require to avoid circular runtime dependency between binding and zone on bootstrap.
+        _currentZoneId = require('../binding').getCurrentZone().getId();
+    }
+    return _currentZoneId;
+}
+
+/// <summary> Relative module names resolved against the file of their call site, by file and name. </summary>
+let _resolvedModuleNames = new Map<string, string>();
+
+/// <summary> Tells if a module name is resolved against the file of its call site. </summary>
+function isRelativeModuleName(moduleName: string): boolean {
+    return moduleName != null && moduleName.length !== 0 && !path.isAbsolute(moduleName);
+}
+
+/// <summary> Resolves a relative module name against the file of its call site, once per file and name. </summary>
+function resolveModuleNameFrom(fileName: string, moduleName: string): string {
+    let key = fileName + '\n' + moduleName;
+    let resolved = _resolvedModuleNames.get(key);
+    if (resolved === undefined) {
+        resolved = path.resolve(path.dirname(fileName), moduleName);
+        _resolvedModuleNames.set(key, resolved);
+    }
+    return resolved;
+}
+
+/// <summary> A function of zone.prepare, whose module and function are resolved once. </summary>
+class PreparedFunction implements zone.PreparedFunction {
+
+    constructor(zone: ZoneImpl, moduleName: string, functionName: string) {
+        this._zone = zone;
+        this._moduleName = moduleName;
+        this._functionName = functionName;
+    }
+
+    execute(args?: any[], options?: zone.CallOptions) : Promise<zone.Result> {
+        return this._zone.executePrepared(this._moduleName, this._functionName, args, options);
+    }
+
+    private _zone: ZoneImpl;
+    private _moduleName: string;
+    private _functionName: string;
+}
+
 /// <summary> Zone consists of Napa isolates. </summary>
 export class ZoneImpl implements zone.Zone {
     private _nativeZone: any;
@@ -54,6 +238,19 @@ export class ZoneImpl implements zone.Zone {
         return this._nativeZone.getId();
     }
 
+    /// <summary> The native zone, for the binding functions taking zones. </summary>
+    public get nativeZone(): any {
+        return this._nativeZone;
+    }
+
+    public get pressure(): number {
+        return this._nativeZone.getPressure();
+    }
+
+    public get workers(): number {
+        return this._nativeZone.getWorkers();
+    }
+
     public toJSON(): any {
         return { id: this.id, type: this.id === 'node'? 'node': 'napa' };
     }
@@ -72,15 +269,410 @@ export class ZoneImpl implements zone.Zone {
         });
     }
 
+    public broadcastSync(source: string, waitTimeout?: number) : number {
+        let response = this._nativeZone.broadcastSync(source, waitTimeout);
+        if (response.code !== 0) {
+            throw new Error("broadcast failed with result code: " + response.code);
+        }
+        return response.waitTime;
+    }
+
+    public resize(workers: number) : Promise<void> {
+        return new Promise<void>((resolve, reject) => {
+            this._nativeZone.resize(workers, (resultCode: number) => {
+                if (resultCode === 0) {
+                    resolve();
+                } else {
+                    reject("resize failed with result code: " + resultCode);
+                }
+            });
+        });
+    }
+
+    public drain(options: zone.DrainOptions = {}) : Promise<zone.DrainResult> {
+        let timeout = options.timeout === undefined ? 0 : options.timeout;
+        if (typeof timeout !== 'number' || !(timeout >= 0)) {
+            return Promise.reject(new TypeError("Option 'timeout' must be a non-negative number."));
+        }
+
+        return new Promise<zone.DrainResult>((resolve, reject) => {
+            this._nativeZone.drain(Math.floor(timeout), (resultCode: number, cancelled: number) => {
+                if (resultCode === 0 || resultCode === functionCall.RejectionType.TIMEOUT) {
+                    resolve({ drained: resultCode === 0, cancelled: cancelled });
+                } else {
+                    reject("drain failed with result code: " + resultCode);
+                }
+            });
+        });
+    }
+
+    public memoryUsage() : Promise<zone.WorkerMemoryUsage[]> {
+        return new Promise<zone.WorkerMemoryUsage[]>((resolve) => {
+            this._nativeZone.getMemoryUsage((usages: zone.WorkerMemoryUsage[]) => {
+                resolve(usages);
+            });
+        });
+    }
+
+    public heapStatistics() : Promise<zone.WorkerHeapStatistics[]> {
+        return new Promise<zone.WorkerHeapStatistics[]>((resolve) => {
+            this._nativeZone.getHeapStatistics((statistics: zone.WorkerHeapStatistics[]) => {
+                resolve(statistics);
+            });
+        });
+    }
+
+    public heapSnapshot(workerId: number, path: string) : Promise<void> {
+        return new Promise<void>((resolve, reject) => {
+            this._nativeZone.writeHeapSnapshot(workerId, path, (resultCode: number) => {
+                if (resultCode === 0) {
+                    resolve();
+                } else {
+                    reject("heapSnapshot failed with result code: " + resultCode);
+                }
+            });
+        });
+    }
+
+    public slowCalls() : zone.SlowCall[] {
+        return this._nativeZone.getSlowCalls();
+    }
+
+    public functionStats() : zone.FunctionStats[] {
+        return this._nativeZone.getFunctionStats();
+    }
+
+    public serve(address: string) : number {
+        return this._nativeZone.serve(address);
+    }
+
+    public startProfiling(options?: zone.ProfilingOptions) : Promise<void> {
+        let samplingInterval = options != null && options.samplingInterval != null ? options.samplingInterval : 0;
+        return new Promise<void>((resolve, reject) => {
+            this._nativeZone.startProfiling(samplingInterval, (resultCode: number) => {
+                if (resultCode === 0) {
+                    resolve();
+                } else {
+                    reject("startProfiling failed with result code: " + resultCode);
+                }
+            });
+        });
+    }
+
+    public stopProfiling() : Promise<zone.WorkerCpuProfile[]> {
+        return new Promise<zone.WorkerCpuProfile[]>((resolve) => {
+            this._nativeZone.stopProfiling((profiles: string[]) => {
+                let workerProfiles: zone.WorkerCpuProfile[] = [];
+                profiles.forEach((profile, workerId) => {
+                    // Workers which weren't profiling report an empty profile.
+                    if (profile.length > 0) {
+                        workerProfiles.push({ workerId: workerId, profile: JSON.parse(profile) });
+                    }
+                });
+                resolve(workerProfiles);
+            });
+        });
+    }
+
+    public startAllocationProfiling(options?: zone.AllocationProfilingOptions) : Promise<void> {
+        let samplingInterval = options != null && options.samplingInterval != null ? options.samplingInterval : 0;
+        return new Promise<void>((resolve, reject) => {
+            this._nativeZone.startAllocationProfiling(samplingInterval, (resultCode: number) => {
+                if (resultCode === 0) {
+                    resolve();
+                } else {
+                    reject("startAllocationProfiling failed with result code: " + resultCode);
+                }
+            });
+        });
+    }
+
+    public stopAllocationProfiling() : Promise<zone.HeapProfile> {
+        return new Promise<zone.HeapProfile>((resolve, reject) => {
+            this._nativeZone.stopAllocationProfiling((profile: string) => {
+                // The profile is empty if no worker was profiling.
+                if (profile.length > 0) {
+                    resolve(JSON.parse(profile));
+                } else {
+                    reject("stopAllocationProfiling failed as no worker was profiling");
+                }
+            });
+        });
+    }
+
     public execute(arg1: any, arg2?: any, arg3?: any, arg4?: any) : Promise<zone.Result> {
-        let spec : FunctionSpec = this.createExecuteRequest(arg1, arg2, arg3, arg4);
-        
+        let options: zone.CallOptions = typeof arg1 === 'function' ? arg3 : arg4;
+        if (options != null && options.inline && getCurrentZoneId() === this.id) {
+            if (typeof arg1 === 'function') {
+                return this.executeInline(arg1, arg2, options);
+            }
+
+            let moduleName = this.resolveModuleName(arg1, this.execute);
+            let func: (...args: any[]) => any;
+            try {
+                func = functionCall.getFunction(moduleName, arg2);
+            }
+            catch (error) {
+                return Promise.reject(error);
+            }
+            return this.executeInline(func, arg3, options);
+        }
+
+        let spec : FunctionSpec = this.createExecuteRequest(this.execute, arg1, arg2, arg3, arg4);
+        return this.executeSpec(spec);
+    }
+
+    public executeSync(arg1: any, arg2?: any, arg3?: any, arg4?: any) : zone.SyncResult {
+        let options: zone.SyncCallOptions = typeof arg1 === 'function' ? arg3 : arg4;
+        let spec : FunctionSpec = this.createExecuteRequest(this.executeSync, arg1, arg2, arg3, arg4);
+
+        let response = this._nativeZone.executeSync(spec, options != null ? options.waitTimeout : undefined);
+        if (response.code !== 0) {
+            throw new Error(response.errorMessage);
+        }
+        return new SyncResult(
+            response.returnValue,
+            response.transportContext,
+            response.cpuTime,
+            response.allocatedBytes,
+            response.waitTime).accountTo(this, spec);
+    }
+
+    public executeStream(arg1: any, arg2?: any, arg3?: any, arg4?: any) : zone.ResultStream {
+        let anonymous = typeof arg1 === 'function';
+        let args: any[] = anonymous ? arg2 : arg3;
+        let options: zone.StreamOptions = anonymous ? arg3 : arg4;
+
+        let capacity = options != null && options.capacity != null ? options.capacity : zone.DEFAULT_STREAM_CAPACITY;
+        let channel = resultStream.createChannel(capacity);
+        let writer = new resultStream.StreamWriter(
+            channel,
+            options != null && options.transport === zone.TransportOption.BINARY);
+
+        args = (args != null ? args : []).concat([writer]);
+        let spec : FunctionSpec = anonymous ?
+            this.createExecuteRequest(this.executeStream, arg1, args, options) :
+            this.createExecuteRequest(this.executeStream, arg1, arg2, args, options);
+
+        return new resultStream.ResultStream(channel, this.executeSpec(spec));
+    }
+
+    public executeBatch(module: string, func: string, argsArray: any[][], options?: zone.CallOptions) : Promise<zone.Result[]> {
+        let moduleName: string = this.resolveModuleName(module, this.executeBatch);
+        let specs : FunctionSpec[] = argsArray.map(args => this.createFunctionSpec(moduleName, func, args, options));
+        return this.executeSpecs(specs);
+    }
+
+    public prepare(arg1: any, arg2?: any) : zone.PreparedFunction {
+        if (typeof arg1 === 'function') {
+            if (arg1.origin == null) {
+                // <caller> -> prepare
+                //   1          0
+                arg1.origin = v8.currentStack(2)[1].getFileName();
+            }
+            return new PreparedFunction(this, "__function", transport.saveFunction(arg1));
+        }
+
+        let moduleName: string = this.resolveModuleName(arg1, this.prepare);
+        return new PreparedFunction(this, "__prepared", functionCall.prepareFunction(moduleName, arg2));
+    }
+
+    /// <summary> Executes a function of prepare. </summary>
+    public executePrepared(moduleName: string, functionName: string, args: any[], options: zone.CallOptions) : Promise<zone.Result> {
+        return this.executeSpec(this.createFunctionSpec(moduleName, functionName, args, options));
+    }
+
+    public map(func: (item: any, index: number) => any, items: any[], options?: zone.MapOptions) : Promise<any[]> {
+        // <caller> -> map -> createChunkSpecs
+        //   2          1           0
+        let chunks = this.createChunkSpecs(func, items, options, 2, 'mapChunk', (chunk, offset) => [chunk, offset]);
+        return this.executeChunks(chunks, items.length).then(values => [].concat(...values));
+    }
+
+    public reduce(func: (accumulator: any, item: any, index: number) => any, items: any[], initialValue: any, options?: zone.ReduceOptions) : Promise<any> {
+        // <caller> -> reduce -> createChunkSpecs
+        //   2           1            0
+        let chunks = this.createChunkSpecs(func, items, options, 2, 'reduceChunk', (chunk, offset) => [chunk, initialValue, offset]);
+        let combine = options != null && options.combine != null ?
+            options.combine :
+            (left: any, right: any) => func(left, right, undefined);
+        return this.executeChunks(chunks, items.length).then(values =>
+            values.length === 0 ? initialValue : values.reduce((left, right) => combine(left, right)));
+    }
+
+    /// <summary> Splits items into chunks, each a call of a function of the parallel module on a worker. </summary>
+    /// <param name="callerIndex"> Index of the call site in the stack, where createChunkSpecs is at index 0. </param>
+    private createChunkSpecs(
+        func: (...args: any[]) => any,
+        items: any[],
+        options: zone.MapOptions,
+        callerIndex: number,
+        runner: string,
+        createArgs: (chunk: any[], offset: number) => any[]) : { hash: string, specs: FunctionSpec[] } {
+
+        if (typeof func !== 'function') {
+            throw new TypeError("Expected a Function type argument");
+        }
+        if (!Array.isArray(items)) {
+            throw new TypeError("Expected an Array type argument");
+        }
+        if ((<any>func).origin == null) {
+            (<any>func).origin = v8.currentStack(callerIndex + 1)[callerIndex].getFileName();
+        }
+
+        let hash = transport.saveFunction(func);
+        let chunkSize = options != null && options.chunkSize != null ?
+            Math.max(Math.floor(options.chunkSize), 1) :
+            parallel.getChunkSize(hash, items.length, this.workers);
+
+        let specs: FunctionSpec[] = [];
+        for (let offset = 0; offset < items.length; offset += chunkSize) {
+            specs.push(this.createFunctionSpec(
+                parallel.MODULE_NAME, runner, [hash].concat(createArgs(items.slice(offset, offset + chunkSize), offset)), options));
+        }
+        return { hash: hash, specs: specs };
+    }
+
+    /// <summary> Executes chunks, returning their values in order and recording the cost of their items. </summary>
+    private executeChunks(chunks: { hash: string, specs: FunctionSpec[] }, items: number) : Promise<any[]> {
+        if (chunks.specs.length === 0) {
+            return Promise.resolve([]);
+        }
+        return this.executeSpecs(chunks.specs).then(results => {
+            parallel.recordCost(chunks.hash, items, results.reduce((sum, result) => sum + result.cpuTime, 0));
+            return results.map(result => result.value);
+        });
+    }
+
+    /// <summary> Executes stages of a pipeline, the first of which on this zone. See zone.pipeline. </summary>
+    /// <param name="callerIndex"> Index of the call site in the stack, where executePipeline is at index 0. </param>
+    public executePipeline(stages: zone.PipelineStage[], options: zone.CallOptions, callerIndex: number) : Promise<zone.Result> {
+        let specs: FunctionSpec[] = [];
+        let zoneIds: string[] = [];
+        let callerFileName: string;
+        for (let i = 0; i < stages.length; ++i) {
+            let stage = stages[i];
+            let moduleName: string;
+            let functionName: string;
+            if (typeof stage.function === 'function') {
+                if ((<any>stage.function).origin == null) {
+                    (<any>stage.function).origin = v8.currentStack(callerIndex + 1)[callerIndex].getFileName();
+                }
+                moduleName = "__function";
+                functionName = transport.saveFunction(stage.function);
+            } else {
+                moduleName = stage.module;
+                if (isRelativeModuleName(moduleName)) {
+                    // The stack is captured once for all stages.
+                    callerFileName = callerFileName || v8.currentStack(callerIndex + 1)[callerIndex].getFileName();
+                    moduleName = resolveModuleNameFrom(callerFileName, moduleName);
+                }
+                functionName = stage.function;
+            }
+            specs.push(this.createFunctionSpec(moduleName, functionName, stage.args, options));
+            if (i > 0) {
+                zoneIds.push(stage.zone.id);
+            }
+        }
+
+        return new Promise<zone.Result>((resolve, reject) => {
+            this._nativeZone.executePipeline(specs, zoneIds, (result: any) => {
+                if (result.code === 0) {
+                    resolve(new Result(
+                        result.returnValue,
+                        result.transportContext,
+                        result.cpuTime,
+                        result.allocatedBytes).accountTo(stages.length > 1 ? stages[stages.length - 1].zone : this, specs[specs.length - 1]));
+                } else {
+                    reject(result.errorMessage);
+                }
+            });
+        });
+    }
+
+    public executeGraph(nodes: zone.GraphNode[], edges: [number, number][], options?: zone.CallOptions) : Promise<zone.Result[]> {
+        if (!Array.isArray(nodes) || !Array.isArray(edges)) {
+            throw new TypeError("Expected Arrays of graph nodes and edges");
+        }
+
+        let specs: FunctionSpec[] = [];
+        let callerFileName: string;
+        for (let node of nodes) {
+            if (typeof node.function === 'function') {
+                if ((<any>node.function).origin == null) {
+                    // <caller> -> executeGraph
+                    //   1            0
+                    (<any>node.function).origin = v8.currentStack(2)[1].getFileName();
+                }
+                specs.push(this.createFunctionSpec("__function", transport.saveFunction(node.function), node.args, options));
+            } else {
+                let moduleName = node.module;
+                if (isRelativeModuleName(moduleName)) {
+                    // The stack is captured once for all nodes.
+                    callerFileName = callerFileName || v8.callerFileName(this.executeGraph);
+                    moduleName = resolveModuleNameFrom(callerFileName, moduleName);
+                }
+                specs.push(this.createFunctionSpec(moduleName, node.function, node.args, options));
+            }
+        }
+
+        return new Promise<zone.Result[]>((resolve, reject) => {
+            this._nativeZone.executeGraph(specs, edges, (results: any[], failedNode: number) => {
+                if (failedNode >= 0) {
+                    reject(results[failedNode].errorMessage);
+                } else {
+                    resolve(results.map((result, i) => new Result(
+                        result.returnValue,
+                        result.transportContext,
+                        result.cpuTime,
+                        result.allocatedBytes).accountTo(this, specs[i])));
+                }
+            });
+        });
+    }
+
+    private executeSpecs(specs: FunctionSpec[]) : Promise<zone.Result[]> {
+        return new Promise<zone.Result[]>((resolve, reject) => {
+            this._nativeZone.executeBatch(specs, (results: any[]) => {
+                let failed = results.find(result => result.code !== 0);
+                if (failed !== undefined) {
+                    reject(failed.errorMessage);
+                } else {
+                    resolve(results.map((result, i) => new Result(
+                        result.returnValue,
+                        result.transportContext,
+                        result.cpuTime,
+                        result.allocatedBytes).accountTo(this, specs[i])));
+                }
+            });
+        });
+    }
+
+    /// <summary> Calls a function right away on the current worker, with arguments and return value as is. </summary>
+    private executeInline(func: (...args: any[]) => any, args: any[], options: zone.CallOptions) : Promise<zone.Result> {
+        if (options.cancellationToken != null && options.cancellationToken.cancelled) {
+            return Promise.reject("Cancelled by the caller");
+        }
+
+        let value: any;
+        try {
+            value = func.apply(undefined, args != null ? args : []);
+        }
+        catch (error) {
+            return Promise.reject(error);
+        }
+        return Promise.resolve(value).then(resolved => <zone.Result>new InlineResult(resolved, options));
+    }
+
+    private executeSpec(spec: FunctionSpec) : Promise<zone.Result> {
         return new Promise<zone.Result>((resolve, reject) => {
             this._nativeZone.execute(spec, (result: any) => {
                 if (result.code === 0) {
                     resolve(new Result(
                         result.returnValue,
-                        transport.createTransportContext(true, result.contextHandle)));
+                        result.transportContext,
+                        result.cpuTime,
+                        result.allocatedBytes).accountTo(this, spec));
                 } else {
                     reject(result.errorMessage);
                 }
@@ -101,24 +693,29 @@ export class ZoneImpl implements zone.Zone {
             
             let functionString: string = (<Function>arg1).toString();
             
-            // Prepare arguments as a string
-            let argumentsString: string = "";
-            if (arg2 != undefined) {
-                if (!Array.isArray(arg2)) {
-                    throw new TypeError("Expected an Array type argument");
-                }
-                argumentsString = JSON.stringify(arg2);
-                argumentsString = argumentsString.substring(1, argumentsString.length - 1);
+            if (arg2 != undefined && !Array.isArray(arg2)) {
+                throw new TypeError("Expected an Array type argument");
             }
 
-            // Create a self invoking function string
-            source = `(${ functionString })(${ argumentsString })`;
+            if (arg2 == undefined || arg2.length === 0) {
+                source = `(${ functionString })()`;
+            } else {
+                // Arguments are serialized once, and passed to JSON.parse as a string literal. Scanning a string literal
+                // and parsing JSON is much faster than compiling the arguments as JavaScript on every worker.
+                // Non-ASCII characters are escaped, so the source can be shared by workers without copying.
+                let argumentsLiteral = JSON.stringify(JSON.stringify(arg2)).replace(/[\u0080-\uffff]/g, 
+                    (c: string) => '\\u' + ('000' + c.charCodeAt(0).toString(16)).slice(-4));
+
+                // Create a self invoking function string
+                source = `(${ functionString }).apply(undefined, JSON.parse(${ argumentsLiteral }))`;
+            }
         }
 
         return source;
     }
 
-    private createExecuteRequest(arg1: any, arg2: any, arg3?: any, arg4?: any) : FunctionSpec {
+    /// <param name="callee"> The method of the zone called by the call site, e.g. execute. </param>
+    private createExecuteRequest(callee: Function, arg1: any, arg2: any, arg3?: any, arg4?: any) : FunctionSpec {
 
         let moduleName: string = null;
         let functionName: string = null;
@@ -128,10 +725,7 @@ export class ZoneImpl implements zone.Zone {
         if (typeof arg1 === 'function') {
             moduleName = "__function";
             if (arg1.origin == null) {
-                // We get caller stack at index 2.
-                // <caller> -> execute -> createExecuteRequest
-                //   2           1               0
-                arg1.origin = v8.currentStack(3)[2].getFileName();
+                arg1.origin = v8.callerFileName(callee);
             }
 
             functionName = transport.saveFunction(arg1);
@@ -139,31 +733,46 @@ export class ZoneImpl implements zone.Zone {
             options = arg3;
         }
         else {
-            moduleName = arg1;
             // If module name is relative path, try to deduce from call site.
-            if (moduleName != null 
-                && moduleName.length != 0 
-                && !path.isAbsolute(moduleName)) {
-
-                moduleName = path.resolve(
-                    path.dirname(v8.currentStack(3)[2].getFileName()), 
-                    moduleName);
-            }
+            moduleName = this.resolveModuleName(arg1, callee);
             functionName = arg2;
             args = arg3;
             options = arg4;
         }
 
+        return this.createFunctionSpec(moduleName, functionName, args, options);
+    }
+
+    /// <summary> Resolves a relative module name against the file of the call site. </summary>
+    /// <param name="callee"> The method of the zone called by the call site, whose frame is looked up above. </param>
+    /// <remarks> Only relative names capture a stack frame, absolute and empty names are taken as is. </remarks>
+    private resolveModuleName(moduleName: string, callee: Function) : string {
+        if (!isRelativeModuleName(moduleName)) {
+            return moduleName;
+        }
+        return resolveModuleNameFrom(v8.callerFileName(callee), moduleName);
+    }
+
+    private createFunctionSpec(moduleName: string, functionName: string, args: any[], options: zone.CallOptions) : FunctionSpec {
         if (args == null) {
             args = [];
         }
 
         // Create a non-owning transport context which will be passed to execute call.
         let transportContext: transport.TransportContext = transport.createTransportContext(false);
+        let marshall = options != null && options.transport === zone.TransportOption.BINARY ?
+            transport.marshallBinary : transport.marshall;
+        let start = tracing.isEnabled() || transport.isAccounting() ? tracing.now() : -1;
+        let marshalledArgs = (<Array<any>>args).map(arg => { return marshall(arg, transportContext); });
+        if (start >= 0) {
+            tracing.recordSpan('MarshallArguments', start, options != null ? options.traceId : undefined);
+            transport.recordCost(this.id, functionCall.getAccountingName(moduleName, functionName), 'MarshallArguments',
+                marshalledArgs, transportContext.sharedCount, start);
+        }
         return {
             module: moduleName,
             function: functionName,
-            arguments: (<Array<any>>args).map(arg => { return transport.marshall(arg, transportContext); }),
+            arguments: marshalledArgs,
             options: options != null? options: zone.DEFAULT_CALL_OPTIONS,
             transportContext: transportContext
         };
@@ -8,6 +8,251 @@ export interface ZoneSettings {
 
     /// <summary> The number of workers that will serve zone requests. </summary>
     workers?: number;
+
+    /// <summary>
+    ///     Time in microseconds an idle worker keeps spinning for new calls before going to sleep.
+    ///     Spinning burns CPU but saves the wake up latency for bursty traffic. Default is 0 (sleep immediately).
+    /// </summary>
+    idleSpinTime?: number;
+
+    /// <summary>
+    ///     Maximum number of pending (queued or running) calls. Calls beyond it are rejected immediately.
+    ///     Default is 0, which means no limit.
+    /// </summary>
+    maxQueueLength?: number;
+
+    /// <summary>
+    ///     Maximum total size in bytes of pending calls, counting module name, function name and marshalled arguments.
+    ///     Calls beyond it are rejected immediately. Default is 0, which means no limit.
+    /// </summary>
+    maxQueueBytes?: number;
+
+    /// <summary>
+    ///     Maximum size in bytes of cached call results, keyed by module, function and marshalled arguments.
+    ///     A call with a cached result resolves without running. Only for zones of pure functions.
+    ///     Default is 0, which disables the cache.
+    /// </summary>
+    resultCacheBytes?: number;
+
+    /// <summary> Time in milliseconds cached call results live. Default is 0, which means no expiry. </summary>
+    resultCacheTtl?: number;
+
+    /// <summary>
+    ///     The strategy for dispatching execute calls to workers, 'synchronized' (default), 'workStealing' or 'earliestDeadline'.
+    ///     'workStealing' queues calls per worker and lets idle workers steal from busy ones,
+    ///     which scales better with many workers and high call rates.
+    ///     'earliestDeadline' serves queued calls by their timeout deadline and drops calls that expired while queued.
+    /// </summary>
+    scheduler?: string;
+
+    /// <summary>
+    ///     Number of unfinished calls, running one included, that busy workers are kept filled with, so they start their
+    ///     next call without waiting for the scheduler thread. Only with the 'synchronized' scheduler. Default is 0 (off).
+    /// </summary>
+    workerQueueDepth?: number;
+
+    /// <summary>
+    ///     The policy for pinning workers to logical processors, 'none' (default), 'spread' or 'compact'.
+    ///     'spread' places workers round-robin across NUMA nodes, 'compact' fills up a NUMA node before using the next.
+    /// </summary>
+    workerPlacement?: string;
+
+    /// <summary> The NUMA node to run workers on. Default is -1, which means any node. </summary>
+    numaNode?: number;
+
+    /// <summary>
+    ///     The OS scheduling priority of worker threads, 'lowest', 'low', 'normal' (default), 'high' or 'highest',
+    ///     so zones sharing a host can outrank each other. Raising it above 'normal' may require privileges.
+    /// </summary>
+    workerPriority?: string;
+
+    /// <summary>
+    ///     The maximum size in bytes of the JavaScript stack of workers, beyond which calls fail with a RangeError.
+    ///     Worker threads are created with a stack 1MB larger. Default is 512000.
+    /// </summary>
+    maxStackSize?: number;
+
+    /// <summary> The minimum number of workers the autoscaler shrinks the zone to. Default is 1. </summary>
+    minWorkers?: number;
+
+    /// <summary>
+    ///     The maximum number of workers the zone can grow to, by zone.resize or the autoscaler.
+    ///     Default is 0, which means the initial number of workers.
+    /// </summary>
+    maxWorkers?: number;
+
+    /// <summary>
+    ///     Interval in milliseconds the autoscaler checks queued calls and idle workers.
+    ///     The zone grows while calls are queued and no worker is idle, and shrinks by one worker
+    ///     after workers stayed idle for autoscaleIdleTime. Default is 0, which disables autoscaling.
+    /// </summary>
+    autoscaleInterval?: number;
+
+    /// <summary> Time in milliseconds workers must stay idle before the autoscaler removes one. Default is 60000. </summary>
+    autoscaleIdleTime?: number;
+
+    /// <summary>
+    ///     Time in milliseconds a worker may run a single task for before the watchdog takes it as stuck, and stops
+    ///     routing calls that can run on any worker to it until it finishes the task. Default is 0, which disables the watchdog.
+    /// </summary>
+    stuckWorkerThreshold?: number;
+
+    /// <summary>
+    ///     Whether the watchdog adds a worker, up to maxWorkers, in place of each stuck worker, and recycles the isolate of
+    ///     a worker once it recovered. Requires stuckWorkerThreshold. Default is false.
+    /// </summary>
+    replaceStuckWorkers?: boolean;
+
+    /// <summary>
+    ///     The number of calls after which a worker recreates its JavaScript isolate, to release a bloated heap.
+    ///     The new isolate replays all broadcasts before it serves calls again. Default is 0, which disables it.
+    /// </summary>
+    recycleTaskCount?: number;
+
+    /// <summary> The used heap size in MB beyond which a worker recreates its isolate. Default is 0, which disables it. </summary>
+    recycleHeapSize?: number;
+
+    /// <summary>
+    ///     The percentage of free space in the heap beyond which a worker recreates its isolate.
+    ///     Only applies to heaps of 32MB or more. Default is 0, which disables it.
+    /// </summary>
+    recycleFragmentation?: number;
+
+    /// <summary>
+    ///     Time in milliseconds of garbage collection work an idle worker does per idle step, so GC runs between calls
+    ///     instead of in them. Steps are bounded by half of the expected idle time. Default is 0, which disables it.
+    /// </summary>
+    idleGcTime?: number;
+
+    /// <summary>
+    ///     Time in milliseconds a worker stays idle before it runs a full garbage collection, once per idle period.
+    ///     Default is 0, which disables it.
+    /// </summary>
+    idleGcFullTime?: number;
+
+    /// <summary>
+    ///     How the garbage collector of worker isolates trades pause times for throughput and memory:
+    ///     'balanced' (default), 'latency', 'throughput' or 'memory'.
+    /// </summary>
+    gcMode?: string;
+
+    /// <summary> Initial old space size in MB of worker isolates, which delays the first full GCs. Default is 0, the V8 default. </summary>
+    initialOldSpaceSize?: number;
+
+    /// <summary> Initial semi space size in MB of worker isolates, which makes fewer scavenges during warm-up. Default is 0, the V8 default. </summary>
+    minSemiSpaceSize?: number;
+
+    /// <summary>
+    ///     Whether broadcasting a source again replaces its earlier entry in the log replayed on new workers,
+    ///     instead of replaying both. Only use it if broadcasts are idempotent. Default is false.
+    /// </summary>
+    broadcastLogCompaction?: boolean;
+
+    /// <summary>
+    ///     Whether broadcast sources are compiled with a V8 code cache shared by the zone workers,
+    ///     so workers replaying a broadcast don't parse and compile it again. Default is true.
+    /// </summary>
+    broadcastCodeCache?: boolean;
+
+    /// <summary>
+    ///     Maximum number of workers running a broadcast at a time, while the other workers keep running calls.
+    ///     Each worker that ran it passes it on to the next one. Default is 0, for all workers at once.
+    /// </summary>
+    broadcastConcurrency?: number;
+
+    /// <summary>
+    ///     Number of calls and other tasks after which a worker replaces the code caches of the modules it loaded with warm ones,
+    ///     which hold the functions compiled since, so workers created later don't compile them again. Default is 0, which disables it.
+    /// </summary>
+    codeCacheWarmUpTasks?: number;
+
+    /// <summary>
+    ///     Whether each worker runs a libuv loop between tasks, so native modules can use libuv handles,
+    ///     e.g. sockets, pipes and timers, from napa::zone::GetEventLoop() in C++. Default is false.
+    /// </summary>
+    eventLoop?: boolean;
+
+    /// <summary>
+    ///     Number of tasks a worker runs between microtask checkpoints, which run continuations of promises
+    ///     in one go. Workers also run them before going idle. Default is 0, V8 runs them as each call returns.
+    /// </summary>
+    microtaskBatchSize?: number;
+
+    /// <summary>
+    ///     Share of the process-wide CPU budget, see platform setting cpuBudget, that the zone gets relative to other
+    ///     zones when their workers wait for it. Default is 1.
+    /// </summary>
+    cpuWeight?: number;
+
+    /// <summary>
+    ///     Time in milliseconds from execute until completion beyond which a call is kept in the slow-call log of the
+    ///     zone, see Zone.slowCalls. Default is 0, which keeps no calls for their duration.
+    /// </summary>
+    slowCallThreshold?: number;
+
+    /// <summary> Keeps 1 in every N calls in the slow-call log however long they take. Default is 0 (off). </summary>
+    slowCallSampleRate?: number;
+
+    /// <summary> Number of most recent calls the slow-call log keeps. Default is 100. </summary>
+    slowCallLogSize?: number;
+
+    /// <summary>
+    ///     Number of bytes of marshalled arguments kept with each call in the slow-call log.
+    ///     Default is 0, which keeps the sizes of arguments only.
+    /// </summary>
+    slowCallPayloadBytes?: number;
+
+    /// <summary>
+    ///     Whether workers take turns on a process-wide pool of threads, see platform setting sharedWorkerThreads,
+    ///     instead of having a thread each, so many small zones don't cost a thread per worker. Default is false.
+    /// </summary>
+    sharedThreads?: boolean;
+
+    /// <summary>
+    ///     Modules that every worker loads at zone creation, resolved from the current directory.
+    ///     They are compiled in parallel ahead of the workers, which instantiate them from the code caches.
+    /// </summary>
+    preload?: string[];
+
+    /// <summary>
+    ///     Named groups of workers with their own isolate constraints, e.g. a few workers with a large heap for batch jobs
+    ///     in a zone of small workers. Calls pick a class by CallOptions.workerClass. Class workers are the first workers
+    ///     of the zone in the order of the classes, and count in 'workers'. Resizing and autoscaling keep them.
+    /// </summary>
+    workerClasses?: { [name: string]: WorkerClassSettings };
+
+    /// <summary>
+    ///     Callers of the zone with their share of workers, by the name calls pass as CallOptions.tenant. Queued calls
+    ///     are handed to workers by weighted round robin between tenants, so a tenant flooding the zone doesn't starve
+    ///     others. Unlisted tenants and calls without tenant have a weight of 1 and no cap. Only with the 'synchronized' scheduler.
+    /// </summary>
+    tenants?: { [name: string]: TenantSettings };
+}
+
+/// <summary> Describes how a tenant shares the zone workers. </summary>
+export interface TenantSettings {
+
+    /// <summary> The number of queued calls of the tenant handed to workers in each of its turns. Default is 1. </summary>
+    weight?: number;
+
+    /// <summary> The maximum number of calls of the tenant running on workers at the same time. Default is 0, no limit. </summary>
+    maxConcurrency?: number;
+}
+
+/// <summary> Describes a group of zone workers, constraints it doesn't set are the ones of the zone. </summary>
+export interface WorkerClassSettings {
+
+    /// <summary> The number of workers of the class. Default is 1. </summary>
+    workers?: number;
+
+    /// <summary> The maximum old space size of a worker's heap in MB. </summary>
+    maxOldSpaceSize?: number;
+
+    /// <summary> The maximum semi space size of a worker's heap in MB, larger ones suit allocation heavy jobs. </summary>
+    maxSemiSpaceSize?: number;
+
+    /// <summary> The maximum size of a worker's stack in bytes. </summary>
+    maxStackSize?: number;
 }
 
 /// <summary> Default ZoneSettings </summary>
@@ -28,6 +273,24 @@ export enum TransportOption {
 
     /// <summary> transport.marshall/unmarshall will be done by user manually. </summary>
     MANUAL,
+
+    /// <summary> Values are transported in V8 structured clone format instead of JSON, which keeps
+    /// typed arrays, Map, Set, Date, RegExp and circular references. Transportables still apply.
+    /// </summary>
+    BINARY,
+}
+
+/// <summary> Describes the priority of a call, queued calls with higher priority are served first. </summary>
+export enum CallPriority {
+
+    /// <summary> Latency sensitive calls, e.g. interactive requests. </summary>
+    HIGH,
+
+    /// <summary> Default priority. </summary>
+    NORMAL,
+
+    /// <summary> Calls that can wait, e.g. batch jobs. </summary>
+    BACKGROUND,
 }
 
 /// <summary> Represent the options of calling a function. </summary>
@@ -36,8 +299,84 @@ export interface CallOptions {
     /// <summary> Timeout in milliseconds. By default set to 0 if timeout is not needed. </summary>
     timeout?: number,
 
+    /// <summary>
+    ///     CPU time in milliseconds the call may consume before it's terminated, independent of timeout. Time the call
+    ///     waits in queue, is preempted by other threads or blocks doesn't count. By default 0, for no CPU timeout.
+    /// </summary>
+    cpuTimeout?: number,
+
     /// <summary> Transport option on passing arguments. By default set to TransportOption.AUTO </summary>
-    transport?: TransportOption
+    transport?: TransportOption,
+
+    /// <summary> Priority of the call. By default set to CallPriority.NORMAL </summary>
+    priority?: CallPriority,
+
+    /// <summary>
+    ///     Routing key of the call. Calls with the same key prefer the same worker,
+    ///     so states cached in its JavaScript globals can be reused. By default no affinity.
+    /// </summary>
+    affinityKey?: string,
+
+    /// <summary>
+    ///     Trace id of the call, e.g. the id of the request it serves. Logs of the call and
+    ///     its trace events carry it, so they can be correlated with the caller's. By default none.
+    /// </summary>
+    traceId?: string,
+
+    /// <summary>
+    ///     Token to cancel the call with, from zone.createCancellationToken. A call that hasn't started is dropped,
+    ///     a running one is terminated, and either is rejected right away. By default not cancellable.
+    /// </summary>
+    cancellationToken?: CancellationToken,
+
+    /// <summary>
+    ///     Name of the worker class to run the call on, from ZoneSettings.workerClasses. The call goes to the worker
+    ///     of the class with the fewest pending calls, affinityKey is ignored. By default any worker.
+    /// </summary>
+    workerClass?: string,
+
+    /// <summary>
+    ///     Name of the tenant the call is issued for, see ZoneSettings.tenants. Calls without affinityKey or workerClass
+    ///     share workers by the weights and caps of their tenants. By default none.
+    /// </summary>
+    tenant?: string,
+
+    /// <summary>
+    ///     Delay in milliseconds after which a call that hasn't finished is started again on another worker,
+    ///     e.g. the p95 latency of the function. The first result wins and the other attempt is cancelled,
+    ///     which cuts the tail latency of calls stalled on a slow worker. Only idempotent functions should be hedged,
+    ///     as both attempts may run. By default 0, for no hedging.
+    /// </summary>
+    hedgeAfterMs?: number,
+
+    /// <summary>
+    ///     Whether to attach the call to an identical one in flight, with the same module, function and arguments,
+    ///     instead of running it again, e.g. for calls filling a cache. Attached calls get the result of the first
+    ///     call, including its errors. By default false.
+    /// </summary>
+    coalesce?: boolean,
+
+    /// <summary>
+    ///     Whether to run the call right away on the calling worker when the zone is the current zone,
+    ///     e.g. for the sub-problems of divide and conquer. Arguments and the return value are passed as is,
+    ///     without marshalling or queuing. Other zones ignore it. By default false.
+    /// </summary>
+    inline?: boolean
+}
+
+/// <summary> Cancels the calls it's passed to in CallOptions. </summary>
+/// <remarks>
+///     A token is transportable, so a call can be passed its own token as an argument and check whether it's cancelled,
+///     e.g. between the steps of a long running async function, which isn't terminated once it awaits.
+/// </remarks>
+export interface CancellationToken {
+
+    /// <summary> Whether the token was cancelled, from any isolate. </summary>
+    readonly cancelled: boolean;
+
+    /// <summary> Cancels the calls using the token, and calls that use it later. </summary>
+    /// <returns> False if the token was already cancelled. </returns>
+    cancel(): boolean;
 }
 
 /// <summary> Default execution options. </summary>
@@ -47,7 +386,10 @@ export let DEFAULT_CALL_OPTIONS: CallOptions = {
     timeout: 0,
 
     /// <summary> Set argument transport option to automatic. </summary>
-    transport: TransportOption.AUTO
+    transport: TransportOption.AUTO,
+
+    /// <summary> Normal priority. </summary>
+    priority: CallPriority.NORMAL
 }
 
 /// <summary> Represent the result of an execute call. </summary>
@@ -56,11 +398,369 @@ export interface Result {
     /// <summary> The unmarshalled result value. </summary>
     readonly value : any;
 
-    /// <summary> A marshalled result. </summary>
-    readonly payload : string;
+    /// <summary> A marshalled result, an ArrayBuffer when the call used TransportOption.BINARY. </summary>
+    readonly payload : string | ArrayBuffer;
+
+    /// <summary> UTF-8 bytes of a JSON payload, or bytes of a binary payload, e.g. to write to a socket. </summary>
+    readonly payloadBytes : Uint8Array;
 
     /// <summary> Transport context carries additional information needed to unmarshall. </summary>
     readonly transportContext : transport.TransportContext;
+
+    /// <summary>
+    ///     CPU time in nano-seconds the call consumed on its worker, including promise jobs it ran before returning.
+    ///     Continuations after the function returned, e.g. of a timer, are not included.
+    /// </summary>
+    readonly cpuTime : number;
+
+    /// <summary> An estimate of bytes the call allocated on the V8 heap, over the same span as cpuTime. </summary>
+    readonly allocatedBytes : number;
+
+    /// <summary> Get the payload to pass on as is when the result is an argument of zone.execute or a value of store.set. </summary>
+    /// <returns> The payload, or undefined if the value was already loaded with transported objects. </returns>
+    forwardPayload() : string | ArrayBuffer;
+}
+
+/// <summary> Result of a call of zone.executeSync. </summary>
+export interface SyncResult extends Result {
+
+    /// <summary> Milliseconds the caller waited for the call. </summary>
+    readonly waitTime : number;
+}
+
+/// <summary> Memory usage of a zone worker, in bytes unless noted otherwise. </summary>
+export interface WorkerMemoryUsage {
+
+    /// <summary> The worker id. The Node zone reports its isolate as worker 0. </summary>
+    readonly workerId: number;
+
+    /// <summary> V8 heap statistics of the worker isolate, see v8.getHeapStatistics() of Node.js. </summary>
+    readonly usedHeapSize: number;
+    readonly totalHeapSize: number;
+    readonly totalPhysicalSize: number;
+    readonly heapSizeLimit: number;
+    readonly mallocedMemory: number;
+    readonly peakMallocedMemory: number;
+
+    /// <summary> Memory held by JS objects of the isolate outside of the V8 heap, mostly ArrayBuffer contents. </summary>
+    readonly externalMemory: number;
+
+    /// <summary> Number and total size of napa allocations made by the worker thread since it started. </summary>
+    readonly nativeAllocate: number;
+    readonly nativeAllocatedSize: number;
+
+    /// <summary> Number and total size hints of napa deallocations made by the worker thread since it started. </summary>
+    readonly nativeDeallocate: number;
+    readonly nativeDeallocatedSize: number;
+}
+
+/// <summary> V8 heap statistics of a zone worker in bytes, see v8.getHeapStatistics() of Node.js. </summary>
+export interface WorkerHeapStatistics {
+
+    /// <summary> The worker id. The Node zone reports its isolate as worker 0. </summary>
+    readonly workerId: number;
+
+    readonly totalHeapSize: number;
+    readonly totalHeapSizeExecutable: number;
+    readonly totalPhysicalSize: number;
+    readonly totalAvailableSize: number;
+    readonly usedHeapSize: number;
+    readonly heapSizeLimit: number;
+    readonly mallocedMemory: number;
+    readonly peakMallocedMemory: number;
+    readonly numberOfNativeContexts: number;
+    readonly numberOfDetachedContexts: number;
+
+    /// <summary> Statistics of each heap space, see v8.getHeapSpaceStatistics() of Node.js. </summary>
+    readonly spaces: HeapSpaceStatistics[];
+}
+
+/// <summary> Statistics of a V8 heap space in bytes. </summary>
+export interface HeapSpaceStatistics {
+    readonly spaceName: string;
+    readonly spaceSize: number;
+    readonly spaceUsedSize: number;
+    readonly spaceAvailableSize: number;
+    readonly physicalSpaceSize: number;
+}
+
+/// <summary> A call kept by the slow-call log of a zone, with the time in microseconds it spent in each phase. </summary>
+export interface SlowCall {
+    readonly module: string;
+    readonly function: string;
+
+    /// <summary> The id of the worker which ran the call, undefined if it never ran, e.g. it timed out while queued. </summary>
+    readonly workerId?: number;
+
+    /// <summary> The result code of the call, 0 for success. </summary>
+    readonly code: number;
+
+    /// <summary> Whether the call was kept as 1 of every slowCallSampleRate calls rather than for its duration. </summary>
+    readonly sampled: boolean;
+
+    /// <summary> Time the call was issued, in milliseconds since the Unix epoch. </summary>
+    readonly startTime: number;
+
+    /// <summary> Time waiting for a worker. </summary>
+    readonly queueTime: number;
+
+    /// <summary> Time parsing arguments, 0 for calls whose transport runs in JavaScript, which count it in executionTime. </summary>
+    readonly unmarshallTime: number;
+
+    /// <summary> Time until the function returned, or the promise it returned was fulfilled. </summary>
+    readonly executionTime: number;
+
+    /// <summary> Time marshalling the result, 0 for calls whose transport runs in JavaScript, which count it in executionTime. </summary>
+    readonly marshallTime: number;
+
+    /// <summary> Time handing the result over to the caller, e.g. to the Node event loop. </summary>
+    readonly completionTime: number;
+
+    /// <summary> Sizes in bytes of the marshalled arguments. </summary>
+    readonly argumentSizes: number[];
+
+    /// <summary> The start of each marshalled argument, up to slowCallPayloadBytes in total, undefined if none are kept. </summary>
+    readonly arguments?: string[];
+}
+
+/// <summary> Upper bounds in microseconds of the buckets of FunctionStats.histogram, the last bucket has none. </summary>
+export const FUNCTION_STATS_BUCKET_BOUNDS: number[] = [10, 100, 1000, 10000, 100000, 1000000];
+
+/// <summary> Execution statistics of a function of a zone, over all its workers, with times in microseconds. </summary>
+export interface FunctionStats {
+    readonly module: string;
+    readonly function: string;
+
+    /// <summary> Number of calls that ran on a worker. Calls that never ran, e.g. timed out while queued, are not counted. </summary>
+    readonly calls: number;
+
+    /// <summary> Calls that ran and failed, timeouts aside. </summary>
+    readonly errors: number;
+
+    /// <summary> Calls that ran and timed out. </summary>
+    readonly timeouts: number;
+
+    /// <summary> Total and max time calls ran on a worker, until the function returned, as CallExecutionTime. </summary>
+    readonly totalTime: number;
+    readonly maxTime: number;
+
+    /// <summary> Calls by execution time, bucket i counts calls below FUNCTION_STATS_BUCKET_BOUNDS[i] and not below the previous bound. </summary>
+    readonly histogram: number[];
+}
+
+/// <summary> Options of CPU profiling. </summary>
+export interface ProfilingOptions {
+
+    /// <summary> Sampling interval in microseconds. By default V8's, which is 1000. </summary>
+    samplingInterval?: number;
+}
+
+/// <summary> Options of allocation profiling. </summary>
+export interface AllocationProfilingOptions {
+
+    /// <summary> Average number of bytes allocated between two samples. By default V8's, which is 524288. </summary>
+    samplingInterval?: number;
+}
+
+/// <summary> Options of zone.group. </summary>
+export interface GroupOptions {
+
+    /// <summary> Id of the group, by default the ids of its members joined by ','. </summary>
+    id?: string;
+
+    /// <summary>
+    ///     Calls whose arguments take up to this many bytes go to local members while any of them has room,
+    ///     as a network round trip would dominate them. 0 routes all calls alike. Default is 16384.
+    /// </summary>
+    localPayloadSize?: number;
+}
+
+/// <summary> A CPU profile of a zone worker. </summary>
+export interface WorkerCpuProfile {
+
+    /// <summary> The worker id. </summary>
+    readonly workerId: number;
+
+    /// <summary> The profile, which Chrome DevTools loads once written to a .cpuprofile file as JSON. </summary>
+    readonly profile: CpuProfile;
+}
+
+/// <summary> A CPU profile in the .cpuprofile format of Chrome DevTools, with times in microseconds. </summary>
+export interface CpuProfile {
+    nodes: CpuProfileNode[];
+    startTime: number;
+    endTime: number;
+
+    /// <summary> Node id of each sample, and the time of each sample since the previous one. </summary>
+    samples: number[];
+    timeDeltas: number[];
+}
+
+/// <summary> A node of the call tree of a CPU profile. </summary>
+export interface CpuProfileNode {
+    id: number;
+    callFrame: {
+        functionName: string;
+        scriptId: string;
+        url: string;
+        lineNumber: number;
+        columnNumber: number;
+    };
+    hitCount: number;
+    children: number[];
+}
+
+/// <summary> A sampling heap profile in the .heapprofile format of Chrome DevTools, with sizes in bytes. </summary>
+export interface HeapProfile {
+    head: HeapProfileNode;
+
+    /// <summary> Individual samples, which merged profiles leave empty. </summary>
+    samples: { size: number, nodeId: number, ordinal: number }[];
+}
+
+/// <summary> A node of the call tree of a sampling heap profile. </summary>
+export interface HeapProfileNode {
+    id: number;
+    callFrame: {
+        functionName: string;
+        scriptId: string;
+        url: string;
+        lineNumber: number;
+        columnNumber: number;
+    };
+
+    /// <summary> Estimated bytes allocated by the function itself while profiling. </summary>
+    selfSize: number;
+    children: HeapProfileNode[];
+}
+
+/// <summary> Represent the options of a streaming call. </summary>
+export interface StreamOptions extends CallOptions {
+
+    /// <summary>
+    ///     Number of chunks that can be queued between the zone function and the caller.
+    ///     StreamWriter.write waits once the queue is full. By default set to 16.
+    /// </summary>
+    capacity?: number
+}
+
+/// <summary> Represent the options of a synchronous call. </summary>
+export interface SyncCallOptions extends CallOptions {
+
+    /// <summary>
+    ///     Milliseconds to wait for the call before it fails with a timeout, 0 to wait without bound. By default set to 0.
+    ///     The call gets the same timeout, unless it has a timeout of its own.
+    /// </summary>
+    waitTimeout?: number
+}
+
+/// <summary> Default number of chunks that can be queued in a streaming call. </summary>
+export let DEFAULT_STREAM_CAPACITY: number = 16;
+
+/// <summary> A function of zone.prepare, resolved once per worker. </summary>
+export interface PreparedFunction {
+
+    /// <summary> Executes the function on one of the workers of its zone. </summary>
+    /// <param name="args"> The arguments that will pass to the function. </param>
+    /// <param name="options"> Call options, defaults to DEFAULT_CALL_OPTIONS. </param>
+    /// <returns> A promise of result which is resolved when execute completes, and rejected when failed. </returns>
+    execute(args?: any[], options?: CallOptions) : Promise<Result>;
+}
+
+/// <summary> Represent a stage of zone.pipeline. </summary>
+export interface PipelineStage {
+
+    /// <summary> The zone to call the function on. </summary>
+    zone: Zone,
+
+    /// <summary> The module that contains the function, if it's given by name. </summary>
+    module?: string,
+
+    /// <summary> The function name, or a JS function as in zone.execute. </summary>
+    function: string | ((...args: any[]) => any),
+
+    /// <summary> Arguments of the function, after the result of the previous stage for stages other than the first. </summary>
+    args?: any[]
+}
+
+/// <summary> Represent a node of zone.executeGraph. </summary>
+export interface GraphNode {
+
+    /// <summary> The module that contains the function, if it's given by name. </summary>
+    module?: string,
+
+    /// <summary> The function name, or a JS function as in zone.execute. </summary>
+    function: string | ((...args: any[]) => any),
+
+    /// <summary> Arguments of the function, after the results of the nodes it depends on. </summary>
+    args?: any[]
+}
+
+/// <summary> Represent the options of zone.map. </summary>
+export interface MapOptions extends CallOptions {
+
+    /// <summary>
+    ///     Items per call on a worker. By default tuned by the CPU time earlier calls of the same function
+    ///     took per item, so each chunk is long enough to amortize its call and short enough to balance workers.
+    /// </summary>
+    chunkSize?: number
+}
+
+/// <summary> Represent the options of zone.reduce. </summary>
+export interface ReduceOptions extends MapOptions {
+
+    /// <summary>
+    ///     Combines the results of two chunks on the caller, in order of items.
+    ///     By default the reducing function, which fits reductions whose accumulator and items are alike, e.g. sums.
+    /// </summary>
+    combine?: (left: any, right: any) => any
+}
+
+/// <summary> Writes chunks of a streaming call, passed to the zone function as its last argument. </summary>
+export interface StreamWriter {
+
+    /// <summary> Whether the caller cancelled the stream, or the call already completed. Later writes are dropped. </summary>
+    readonly closed: boolean;
+
+    /// <summary> Marshalls a chunk in the transport option of the call, and queues it to the caller. </summary>
+    /// <param name="value"> The chunk, any transportable value. </param>
+    /// <returns> A promise resolved to true once there is room for the next chunk, or to false if the stream is closed. </returns>
+    write(value: any): Promise<boolean>;
+}
+
+/// <summary> Reads chunks of a streaming call, which are written by the zone function via its StreamWriter. </summary>
+export interface ResultStream {
+
+    /// <summary> A promise of the return value of the zone function, settled when the call completes. </summary>
+    readonly result: Promise<Result>;
+
+    /// <summary> Reads the next chunk, in the order written. </summary>
+    /// <returns> A promise of the iterator result, which is rejected if the call failed after the chunks written before. </returns>
+    next(): Promise<IteratorResult<any>>;
+
+    /// <summary> Cancels the stream and ends the iteration, e.g. on break of a for-await loop. </summary>
+    return(): Promise<IteratorResult<any>>;
+
+    /// <summary> Cancels the stream. Queued chunks are dropped and later writes of the zone function return false. </summary>
+    cancel(): void;
+
+    /// <summary> Creates a Node.js Readable in object mode that reads the chunks. Only available in Node.js isolate. </summary>
+    toReadable(): any;
+}
+
+/// <summary> Options of zone.drain. </summary>
+export interface DrainOptions {
+    /// <summary> Milliseconds after which calls still waiting for a worker are cancelled, 0 (default) for none. </summary>
+    timeout?: number;
+}
+
+/// <summary> Outcome of zone.drain. </summary>
+export interface DrainResult {
+    /// <summary> Whether all calls finished before the timeout. </summary>
+    drained: boolean;
+
+    /// <summary> Number of calls cancelled at the timeout. </summary>
+    cancelled: number;
 }
 
 /// <summary>
@@ -83,6 +783,15 @@ export interface Zone {
     /// <summary> The zone id. </summary>
     readonly id: string;
 
+    /// <summary>
+    ///     Load of pending calls relative to zone limits set by maxQueueLength and maxQueueBytes.
+    ///     Calls are rejected when it reaches 1. Always 0 if the zone has no limits.
+    /// </summary>
+    readonly pressure: number;
+
+    /// <summary> Number of running workers, which changes with resize and autoscaling. Always 1 for the node zone. </summary>
+    readonly workers: number;
+
     /// <summary> Compiles and run the provided source code on all zone workers. </summary>
     /// <param name="source"> A valid javascript source code. </param>
     /// <returns> A promise which is resolved when broadcast completes, and rejected when failed. </returns>
@@ -99,6 +808,101 @@ export interface Zone {
     /// <returns> A promise which is resolved when broadcast completes and rejected when failed. </returns>
     broadcast(func: (...args: any[]) => void, args?: any[]) : Promise<void>;
 
+    /// <summary> Compiles and runs the source code on all workers, blocking the caller until it completes. </summary>
+    /// <param name="source"> A valid javascript source code. </param>
+    /// <param name="waitTimeout"> Milliseconds to wait before throwing, 0 to wait without bound. By default set to 0. </param>
+    /// <returns> Milliseconds the caller waited. </returns>
+    /// <remarks>
+    ///     It throws if any worker failed, or on timeout, after which the broadcast goes on. Work posted to the calling
+    ///     thread, e.g. calls of the Node zone, runs while it waits.
+    /// </remarks>
+    broadcastSync(source: string, waitTimeout?: number) : number;
+
+    /// <summary> Changes the number of workers of the zone. </summary>
+    /// <param name="workers"> The new number of workers, between 1 and the maxWorkers setting. </param>
+    /// <returns> A promise which is resolved when the zone has the new number of workers, and rejected when failed. </returns>
+    /// <remarks>
+    ///     New workers replay all broadcasts before serving calls, removed workers finish their queued calls first.
+    ///     Node zone cannot be resized.
+    /// </remarks>
+    resize(workers: number) : Promise<void>;
+
+    /// <summary> Waits for the calls of the zone to finish, cancelling calls still waiting for a worker at a deadline. </summary>
+    /// <param name="options"> Options of draining, with 'timeout' in milliseconds, 0 (default) to wait for all calls. </param>
+    /// <returns>
+    ///     A promise of whether all calls finished in time, and of the number of calls cancelled at the deadline, whose
+    ///     promises are rejected. It's rejected for a remote zone or a zone group, and when called from a worker of the zone.
+    /// </returns>
+    /// <remarks>
+    ///     Calls already running, and calls already handed to a busy worker, are not interrupted. The zone keeps taking
+    ///     calls while it drains. Node zone runs calls as they are made, it's always drained.
+    /// </remarks>
+    drain(options?: DrainOptions) : Promise<DrainResult>;
+
+    /// <summary> Collects memory usage of each worker of the zone. </summary>
+    /// <returns> A promise of the usage of each worker, in order of worker ids. </returns>
+    /// <remarks> Workers report between two calls, ahead of queued calls, so it waits for the calls being run. </remarks>
+    memoryUsage() : Promise<WorkerMemoryUsage[]>;
+
+    /// <summary> Collects V8 heap statistics, with the statistics of each heap space, of each worker of the zone. </summary>
+    /// <returns> A promise of the statistics of each worker, in order of worker ids. </returns>
+    /// <remarks> Workers report between two calls, ahead of queued calls, so it waits for the calls being run. </remarks>
+    heapStatistics() : Promise<WorkerHeapStatistics[]>;
+
+    /// <summary> Writes a V8 heap snapshot of a worker of the zone to a file, which Chrome DevTools loads. </summary>
+    /// <param name="workerId"> The id of the worker, 0 for the Node zone. </param>
+    /// <param name="path"> Path of the file, usually with the .heapsnapshot extension. </param>
+    /// <returns> A promise which is resolved once the snapshot is written, and rejected when failed. </returns>
+    /// <remarks>
+    ///     The worker takes the snapshot between two calls, ahead of its queued calls, and streams it to the file in chunks.
+    ///     Taking a snapshot pauses the worker and takes about as much memory as its heap.
+    /// </remarks>
+    heapSnapshot(workerId: number, path: string) : Promise<void>;
+
+    /// <summary> Gets the calls kept by the slow-call log of the zone, see ZoneSettings.slowCallThreshold. </summary>
+    /// <returns> The calls, oldest first. Always empty for the Node zone, zone groups and connected zones. </returns>
+    slowCalls() : SlowCall[];
+
+    /// <summary> Gets the execution statistics of each function the zone ran, since it was created. </summary>
+    /// <returns> The statistics, in no particular order. Always empty for the Node zone, zone groups and connected zones. </returns>
+    functionStats() : FunctionStats[];
+
+    /// <summary> Serves the zone to other processes, which call it through napa.zone.connect. </summary>
+    /// <param name="address"> The "host:port" address to listen on, port 0 for any free port. </param>
+    /// <returns> The port the zone is served on. </returns>
+    /// <remarks>
+    ///     The zone is served until napa shuts down. There is no authentication: clients call any function of the
+    ///     modules this process resolves and broadcast any code, so zones should only be served on trusted networks.
+    /// </remarks>
+    serve(address: string) : number;
+
+    /// <summary> Starts the V8 CPU profiler on each worker of the zone. </summary>
+    /// <param name="options"> Profiling options. </param>
+    /// <returns> A promise which is resolved once all workers are profiling, and rejected when any worker was profiling already. </returns>
+    /// <remarks>
+    ///     Each worker starts between two calls, ahead of queued calls, on its own thread. Workers don't recycle
+    ///     their isolate while profiling. Workers added by a later resize are not profiled. Node zone cannot be profiled.
+    /// </remarks>
+    startProfiling(options?: ProfilingOptions) : Promise<void>;
+
+    /// <summary> Stops the V8 CPU profiler on each worker of the zone. </summary>
+    /// <returns> A promise of the profile of each worker that was profiling, in order of worker ids. </returns>
+    /// <remarks> Profiles of all workers can be merged into one with zone.mergeCpuProfiles. </remarks>
+    stopProfiling() : Promise<WorkerCpuProfile[]>;
+
+    /// <summary> Starts the V8 sampling heap profiler on each worker of the zone. </summary>
+    /// <param name="options"> Allocation profiling options. </param>
+    /// <returns> A promise which is resolved once all workers are profiling, and rejected when any worker was profiling already. </returns>
+    /// <remarks>
+    ///     Workers start as with startProfiling, and don't recycle their isolate while profiling.
+    ///     Zones whose workers share threads and node zone cannot be profiled.
+    /// </remarks>
+    startAllocationProfiling(options?: AllocationProfilingOptions) : Promise<void>;
+
+    /// <summary> Stops the V8 sampling heap profiler on each worker of the zone. </summary>
+    /// <returns> A promise of the profiles of all workers merged into one, rejected if no worker was profiling. </returns>
+    stopAllocationProfiling() : Promise<HeapProfile>;
+
     /// <summary> Executes the function on one of the zone workers. </summary>
     /// <param name="module"> The module name that contains the function to execute. </param>
     /// <param name="func"> The function name to execute. </param>
@@ -113,5 +917,90 @@ export interface Zone {
     /// <param name="options"> Call options, defaults to DEFAULT_CALL_OPTIONS. </param>
     /// <returns> A promise of result which is resolved when execute completes, and rejected when failed. </returns>
     execute(func: (...args: any[]) => any, args?: any[], options?: CallOptions) : Promise<Result>;
+
+    /// <summary> Executes the function on one of the zone workers, blocking the caller until it completes. </summary>
+    /// <param name="module"> The module name that contains the function to execute. </param>
+    /// <param name="func"> The function name to execute. </param>
+    /// <param name="args"> The arguments that will pass to the function. </param>
+    /// <param name="options"> Call options, with the time to wait for the call. </param>
+    /// <returns> The result, with the time the caller waited. </returns>
+    /// <remarks>
+    ///     It throws if the call failed, or on timeout. Work posted to the calling thread, e.g. calls of the Node zone
+    ///     or completions of async work of the worker, runs while it waits, so the call may wait for it.
+    /// </remarks>
+    executeSync(module: string, func: string, args?: any[], options?: SyncCallOptions) : SyncResult;
+
+    /// <summary> Executes the function on one of the zone workers, blocking the caller until it completes. </summary>
+    /// <param name="func"> The JS function to execute. </param>
+    /// <param name="args"> The arguments that will pass to the function. </param>
+    /// <param name="options"> Call options, with the time to wait for the call. </param>
+    /// <returns> The result, with the time the caller waited. </returns>
+    executeSync(func: (...args: any[]) => any, args?: any[], options?: SyncCallOptions) : SyncResult;
+
+    /// <summary> Executes the function once per arguments list, each call on one of the zone workers. </summary>
+    /// <param name="module"> The module name that contains the function to execute. </param>
+    /// <param name="func"> The function name to execute. </param>
+    /// <param name="argsArray"> A list of arguments lists, one per call. </param>
+    /// <param name="options"> Call options for all calls, defaults to DEFAULT_CALL_OPTIONS. </param>
+    /// <returns> A promise of results in order of argsArray, which is resolved when all calls complete, and rejected if any call failed. </returns>
+    /// <remarks> Calls are scheduled together, which is cheaper than calling execute for each of them. </remarks>
+    executeBatch(module: string, func: string, argsArray: any[][], options?: CallOptions) : Promise<Result[]>;
+
+    /// <summary> Executes a graph of calls on the zone workers, each node called once all nodes it depends on succeeded. </summary>
+    /// <param name="nodes"> The nodes, each called with the results of the nodes it depends on, in order of edges, then its own args. </param>
+    /// <param name="edges"> Pairs of [from, to] node indices, where node 'to' depends on node 'from'. Edges must not form a cycle. </param>
+    /// <param name="options"> Call options of all nodes, defaults to DEFAULT_CALL_OPTIONS. </param>
+    /// <returns> A promise of results in order of nodes, which is rejected with the error of the first node that failed. </returns>
+    /// <remarks>
+    ///     The graph is scheduled natively: a result is forwarded from the worker that returned it to the nodes depending
+    ///     on it, which are started from that worker, so the caller hears of the graph once, when all nodes complete.
+    /// </remarks>
+    executeGraph(nodes: GraphNode[], edges: [number, number][], options?: CallOptions) : Promise<Result[]>;
+
+    /// <summary> Prepares a function for repeated calls, which workers resolve once instead of on every call. </summary>
+    /// <param name="module"> The module name that contains the function to execute. </param>
+    /// <param name="func"> The function name to execute. </param>
+    /// <returns> The prepared function, whose calls carry only their arguments and options. </returns>
+    /// <remarks>
+    ///     Each worker requires the module and looks up the function on its first call of the prepared function, and
+    ///     keeps calling the same function object after, e.g. if a broadcast redefines a global function.
+    /// </remarks>
+    prepare(module: string, func: string) : PreparedFunction;
+
+    /// <summary> Prepares a JS function for repeated calls, which is transported once instead of on every call. </summary>
+    /// <param name="func"> The JS function to execute. </param>
+    /// <returns> The prepared function, whose calls carry only their arguments and options. </returns>
+    prepare(func: (...args: any[]) => any) : PreparedFunction;
+
+    /// <summary> Maps items with a function on the zone workers, in chunks of items per call. </summary>
+    /// <param name="func"> The JS function to map each item with, called with the item and its index. </param>
+    /// <param name="items"> The items to map. </param>
+    /// <param name="options"> Map options, defaults to DEFAULT_CALL_OPTIONS with a tuned chunk size. </param>
+    /// <returns> A promise of the mapped values in order of items, which is rejected if any chunk failed. </returns>
+    /// <remarks> Each chunk is marshalled once, and all chunks are scheduled together as with executeBatch. </remarks>
+    map(func: (item: any, index: number) => any, items: any[], options?: MapOptions) : Promise<any[]>;
+
+    /// <summary> Reduces items with a function on the zone workers, each chunk of items from the initial value. </summary>
+    /// <param name="func"> The JS function to fold each item with, called with the accumulator, the item and its index. </param>
+    /// <param name="items"> The items to reduce. </param>
+    /// <param name="initialValue"> The accumulator each chunk starts from, which should be neutral to options.combine. </param>
+    /// <param name="options"> Reduce options, defaults to DEFAULT_CALL_OPTIONS with a tuned chunk size. </param>
+    /// <returns> A promise of the results of all chunks combined in order, initialValue if there are no items. </returns>
+    reduce(func: (accumulator: any, item: any, index: number) => any, items: any[], initialValue: any, options?: ReduceOptions) : Promise<any>;
+
+    /// <summary> Executes the function on one of the zone workers, which streams chunks back while it runs. </summary>
+    /// <param name="module"> The module name that contains the function to execute. </param>
+    /// <param name="func"> The function name to execute. </param>
+    /// <param name="args"> The arguments that will pass to the function, followed by a StreamWriter. </param>
+    /// <param name="options"> Stream options, defaults to DEFAULT_CALL_OPTIONS with a capacity of DEFAULT_STREAM_CAPACITY. </param>
+    /// <returns> A stream of the chunks, which ends when the call completes. </returns>
+    executeStream(module: string, func: string, args?: any[], options?: StreamOptions) : ResultStream;
+
+    /// <summary> Executes the function on one of the zone workers, which streams chunks back while it runs. </summary>
+    /// <param name="func"> The JS function to execute. </param>
+    /// <param name="args"> The arguments that will pass to the function, followed by a StreamWriter. </param>
+    /// <param name="options"> Stream options, defaults to DEFAULT_CALL_OPTIONS with a capacity of DEFAULT_STREAM_CAPACITY. </param>
+    /// <returns> A stream of the chunks, which ends when the call completes. </returns>
+    executeStream(func: (...args: any[]) => any, args?: any[], options?: StreamOptions) : ResultStream;
 }
 
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <benchmark/benchmark.h>
+
+#include <napa/capi.h>
+#include <providers/nop-metric-provider.h>
+
+#include <cstdlib>
+
+// Components under benchmark count their metrics with the default provider,
+// which is the no-op one since providers aren't loaded outside of napa initialization.
+napa::providers::MetricProvider& napa::providers::GetMetricProvider() {
+    static auto provider = new NopMetricProvider();
+    return *provider;
+}
+
+// The memory C API is implemented by napa library along with the rest of the C API, which needs V8.
+// Allocations of components under benchmark go to the C runtime, as they do by default in napa.
+
+void* napa_malloc(size_t size) {
+    return ::malloc(size);
+}
+
+void napa_free(void* pointer, size_t /*sizeHint*/) {
+    ::free(pointer);
+}
+
+void* napa_allocate(size_t size) {
+    return ::malloc(size);
+}
+
+void napa_deallocate(void* pointer, size_t /*sizeHint*/) {
+    ::free(pointer);
+}
+
+BENCHMARK_MAIN();
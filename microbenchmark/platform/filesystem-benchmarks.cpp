@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <benchmark/benchmark.h>
+
+#include <module/loader/module-resolver.h>
+#include <module/loader/resolution-cache.h>
+#include <platform/filesystem.h>
+
+#include <fstream>
+#include <string>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+
+    /// <summary> A nested directory like the ones modules are required from, as deep as typical npm packages. </summary>
+    const char* CONTEXT_PATH = "/home/user/project/node_modules/package/lib/internal/util/./../streams/readable";
+
+    /// <summary> Creates a directory tree with node_modules at its root, and returns its deepest directory. </summary>
+    filesystem::Path CreateModuleTree() {
+        auto root = filesystem::CurrentDirectory() / "filesystem-benchmarks";
+        filesystem::MakeDirectories(root / "node_modules" / "present");
+        std::ofstream(((root / "node_modules" / "present") / "index.js").String()) << "module.exports = 1;";
+
+        auto deepest = root / "a" / "b" / "c" / "d" / "e" / "f" / "g" / "h";
+        filesystem::MakeDirectories(deepest);
+        return deepest;
+    }
+}
+
+/// <summary> Normalizing a path with '.' and '..' segments. </summary>
+static void BM_PathNormalize(benchmark::State& state) {
+    for (auto _ : state) {
+        filesystem::Path path(CONTEXT_PATH);
+        benchmark::DoNotOptimize(path.Normalize());
+    }
+}
+BENCHMARK(BM_PathNormalize);
+
+/// <summary> Walking up to the root, like the lookup of node_modules directories. </summary>
+static void BM_PathParentWalk(benchmark::State& state) {
+    filesystem::Path start(CONTEXT_PATH);
+    start.Normalize();
+
+    for (auto _ : state) {
+        size_t count = 0;
+        for (auto path = start; !path.IsEmpty(); path = path.Parent().Normalize()) {
+            ++count;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+}
+BENCHMARK(BM_PathParentWalk);
+
+/// <summary> Relative path between two absolute paths sharing a prefix. </summary>
+static void BM_PathRelative(benchmark::State& state) {
+    filesystem::Path path(CONTEXT_PATH);
+    filesystem::Path base("/home/user/project/lib/server");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(path.Relative(base));
+    }
+}
+BENCHMARK(BM_PathRelative);
+
+/// <summary>
+///     Resolving a module that isn't installed, which probes every candidate up to the root.
+///     Stats are cached, and failed resolutions are not, so each iteration composes all the candidate paths.
+/// </summary>
+static void BM_ResolveMissingModule(benchmark::State& state) {
+    static auto contextPath = CreateModuleTree();
+
+    ResolutionCache cache;
+    cache.SetStatCacheEnabled(true);
+    ModuleResolver resolver(cache);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(resolver.Resolve("missing", contextPath.String().c_str()));
+    }
+}
+BENCHMARK(BM_ResolveMissingModule);
+
+/// <summary> Resolving a module from a node_modules directory, which is then served by the resolution cache. </summary>
+static void BM_ResolveCachedModule(benchmark::State& state) {
+    static auto contextPath = CreateModuleTree();
+
+    ResolutionCache cache;
+    cache.SetStatCacheEnabled(true);
+    ModuleResolver resolver(cache);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(resolver.Resolve("present", contextPath.String().c_str()));
+    }
+}
+BENCHMARK(BM_ResolveCachedModule);
@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+var path = require('path');
+var childProcess = require('child_process');
+
+// Results are printed as a table, and written as JSON to build/results.json for benchmark/compare-results.js to compare runs.
+// Benchmarks are repeated 5 times by default to measure their variance. Other arguments are passed on,
+// e.g. --benchmark_filter=BM_Store or --benchmark_repetitions=10.
+var args = process.argv.slice(2);
+if (!args.some(function (arg) { return arg.startsWith('--benchmark_repetitions'); })) {
+    args.push('--benchmark_repetitions=5');
+}
+
+// The commit is recorded in the context of results.
+try {
+    var sha = childProcess.execSync('git rev-parse HEAD', { cwd: __dirname, stdio: ['ignore', 'pipe', 'ignore'] }).toString().trim();
+    args.push('--benchmark_context=git_sha=' + sha);
+}
+catch (err) {
+    // Not a git repository.
+}
+
+try {
+    childProcess.execFileSync(
+        path.join(__dirname, 'build/bin/', process.platform === 'win32'? 'napa-microbenchmark.exe': 'napa-microbenchmark'),
+        [
+            '--benchmark_out=' + path.join(__dirname, 'build/results.json'),
+            '--benchmark_out_format=json'
+        ].concat(args),
+        {
+            cwd: path.join(__dirname, 'build/bin'),
+            stdio: 'inherit'
+        }
+    );
+}
+catch(err) {
+    process.exit(1); // Error
+}
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <benchmark/benchmark.h>
+
+#include <store/store.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace napa::store;
+
+namespace {
+
+    constexpr size_t KEY_COUNT = 1024;
+
+    const std::vector<std::string>& GetKeys() {
+        static auto keys = []() {
+            std::vector<std::string> keys;
+            for (size_t i = 0; i < KEY_COUNT; ++i) {
+                keys.push_back("key-" + std::to_string(i));
+            }
+            return keys;
+        }();
+        return keys;
+    }
+
+    std::shared_ptr<Store::ValueType> MakeValue() {
+        auto value = std::make_shared<Store::ValueType>();
+        value->payload = "{\"id\":1234,\"name\":\"A marshalled value\",\"tags\":[\"a\",\"b\",\"c\"]}";
+        return value;
+    }
+
+    /// <summary> Creates a store of all keys for the benchmark, arguments are the number of shards and whether it's read optimized. </summary>
+    std::shared_ptr<Store> CreatePopulatedStore(const benchmark::State& state) {
+        StoreOptions options;
+        options.shards = static_cast<size_t>(state.range(0));
+        options.readOptimized = state.range(1) != 0;
+
+        static int storeCount = 0;
+        auto store = CreateStore(("microbenchmark-" + std::to_string(storeCount++)).c_str(), options);
+        for (auto& key : GetKeys()) {
+            store->Set(key.c_str(), MakeValue());
+        }
+        return store;
+    }
+
+    /// <summary> The store shared by threads of a benchmark run, thread 0 sets it up before the threads start. </summary>
+    std::shared_ptr<Store> benchmarkStore;
+}
+
+/// <summary> Gets of existing keys by concurrent threads. </summary>
+static void BM_StoreGet(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        benchmarkStore = CreatePopulatedStore(state);
+    }
+
+    auto& keys = GetKeys();
+    size_t i = static_cast<size_t>(state.thread_index()) * 31;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(benchmarkStore->Get(keys[i++ % KEY_COUNT].c_str()));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        benchmarkStore = nullptr;
+    }
+}
+BENCHMARK(BM_StoreGet)->Args({ 1, 0 })->Args({ 16, 0 })->Args({ 1, 1 })->ThreadRange(1, 8)->UseRealTime();
+
+/// <summary> Sets of existing keys by concurrent threads. </summary>
+static void BM_StoreSet(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        benchmarkStore = CreatePopulatedStore(state);
+    }
+
+    auto& keys = GetKeys();
+    size_t i = static_cast<size_t>(state.thread_index()) * 31;
+    for (auto _ : state) {
+        benchmarkStore->Set(keys[i++ % KEY_COUNT].c_str(), MakeValue());
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        benchmarkStore = nullptr;
+    }
+}
+BENCHMARK(BM_StoreSet)->Args({ 1, 0 })->Args({ 16, 0 })->Args({ 1, 1 })->ThreadRange(1, 8)->UseRealTime();
+
+/// <summary> A mix of 9 gets to 1 set by concurrent threads, like a cache. </summary>
+static void BM_StoreGetSetMix(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        benchmarkStore = CreatePopulatedStore(state);
+    }
+
+    auto& keys = GetKeys();
+    auto value = MakeValue();
+    size_t i = static_cast<size_t>(state.thread_index()) * 31;
+    for (auto _ : state) {
+        auto& key = keys[i++ % KEY_COUNT];
+        if (i % 10 == 0) {
+            benchmarkStore->Set(key.c_str(), value);
+        } else {
+            benchmark::DoNotOptimize(benchmarkStore->Get(key.c_str()));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        benchmarkStore = nullptr;
+    }
+}
+BENCHMARK(BM_StoreGetSetMix)->Args({ 1, 0 })->Args({ 16, 0 })->Args({ 1, 1 })->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <benchmark/benchmark.h>
+
+#include <napa/memory/arena-allocator.h>
+#include <napa/transport/transport-context.h>
+
+#include <memory>
+#include <vector>
+
+using namespace napa::transport;
+
+namespace {
+    std::vector<std::shared_ptr<int>> MakePointers(int64_t count) {
+        std::vector<std::shared_ptr<int>> pointers;
+        for (int64_t i = 0; i < count; ++i) {
+            pointers.push_back(std::make_shared<int>(static_cast<int>(i)));
+        }
+        return pointers;
+    }
+}
+
+/// <summary> Saving shared pointers to a new context and loading them back, as marshalling a call and unmarshalling it do. </summary>
+/// <remarks> The argument is the number of pointers, beyond TransportContext::INLINE_CAPACITY they go to a hash map. </remarks>
+static void BM_TransportContextSaveLoad(benchmark::State& state) {
+    auto pointers = MakePointers(state.range(0));
+    for (auto _ : state) {
+        TransportContext context;
+        for (auto& pointer : pointers) {
+            context.SaveShared(pointer);
+        }
+        for (auto& pointer : pointers) {
+            benchmark::DoNotOptimize(context.LoadShared<int>(reinterpret_cast<uintptr_t>(pointer.get())));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransportContextSaveLoad)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+/// <summary> Same as BM_TransportContextSaveLoad, with the hash map allocating from an arena like the one of a call. </summary>
+static void BM_TransportContextSaveLoadInArena(benchmark::State& state) {
+    auto pointers = MakePointers(state.range(0));
+    for (auto _ : state) {
+        napa::memory::ArenaAllocator arena;
+        TransportContext context(arena);
+        for (auto& pointer : pointers) {
+            context.SaveShared(pointer);
+        }
+        for (auto& pointer : pointers) {
+            benchmark::DoNotOptimize(context.LoadShared<int>(reinterpret_cast<uintptr_t>(pointer.get())));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransportContextSaveLoadInArena)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+/// <summary> Moving a context with shared pointers, as each hop from caller to worker and back does. </summary>
+static void BM_TransportContextMove(benchmark::State& state) {
+    auto pointers = MakePointers(state.range(0));
+    TransportContext context;
+    for (auto& pointer : pointers) {
+        context.SaveShared(pointer);
+    }
+    for (auto _ : state) {
+        TransportContext moved(std::move(context));
+        context = std::move(moved);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TransportContextMove)->Arg(1)->Arg(4)->Arg(16);
@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <benchmark/benchmark.h>
+
+#include <zone/scheduler.h>
+#include <zone/task-queue.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace napa;
+using namespace napa::zone;
+using namespace napa::settings;
+
+namespace {
+
+    /// <summary> A worker that runs tasks from a task queue on its thread like Worker, without an isolate. </summary>
+    class QueueWorker {
+    public:
+        QueueWorker(WorkerId id,
+                    const ZoneSettings& settings,
+                    std::function<void(WorkerId)> setupCallback,
+                    std::function<void(WorkerId)> idleNotificationCallback,
+                    std::function<bool(WorkerId)> = nullptr) :
+            _id(id),
+            _spinTime(settings.idleSpinTime),
+            _setupCallback(std::move(setupCallback)),
+            _idleNotificationCallback(std::move(idleNotificationCallback)) {
+        }
+
+        ~QueueWorker() {
+            _tasks.Close();
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+        void Start() {
+            _thread = std::thread([this]() {
+                _setupCallback(_id);
+                while (true) {
+                    std::shared_ptr<Task> task;
+                    if (!_tasks.TryPop(task)) {
+                        _idleNotificationCallback(_id);
+                        if (_spinTime.count() == 0 || !_tasks.TrySpinPop(task, _spinTime)) {
+                            task = _tasks.Pop();
+                        }
+                    }
+                    if (task == nullptr) {
+                        return;
+                    }
+                    task->Execute();
+                    task.reset();
+                    _pendingTasks--;
+                }
+            });
+        }
+
+        void Schedule(std::shared_ptr<Task> task) {
+            _pendingTasks++;
+            _tasks.Push(std::move(task));
+        }
+
+        size_t GetQueueLength() const {
+            return _pendingTasks;
+        }
+
+        void RequestInterrupt(InterruptCallback callback, void* data) {
+            callback(nullptr, data);
+        }
+
+    private:
+        WorkerId _id;
+        std::chrono::microseconds _spinTime;
+        std::function<void(WorkerId)> _setupCallback;
+        std::function<void(WorkerId)> _idleNotificationCallback;
+        TaskQueue _tasks;
+        std::atomic<size_t> _pendingTasks { 0 };
+        std::thread _thread;
+    };
+
+    /// <summary> A task that counts down when it executes. </summary>
+    class CountdownTask : public Task {
+    public:
+        explicit CountdownTask(std::atomic<int64_t>& remaining) : _remaining(remaining) {
+        }
+
+        void Execute() override {
+            _remaining.fetch_sub(1, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<int64_t>& _remaining;
+    };
+
+    void WaitFor(const std::atomic<int64_t>& remaining) {
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    ZoneSettings MakeSettings(uint32_t workers, uint32_t idleSpinTime) {
+        ZoneSettings settings;
+        settings.workers = workers;
+        settings.idleSpinTime = idleSpinTime;
+        return settings;
+    }
+}
+
+/// <summary> Time from scheduling a task on an idle zone of one worker until it observed the task ran. </summary>
+/// <remarks> The argument is the idle spin time in microseconds, 0 parks the worker right away. </remarks>
+static void BM_ScheduleToExecuteLatency(benchmark::State& state) {
+    SchedulerImpl<QueueWorker> scheduler(MakeSettings(1, static_cast<uint32_t>(state.range(0))), [](WorkerId) {});
+
+    std::atomic<int64_t> remaining(0);
+    auto task = std::make_shared<CountdownTask>(remaining);
+    for (auto _ : state) {
+        remaining = 1;
+        scheduler.Schedule(task);
+        WaitFor(remaining);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScheduleToExecuteLatency)->Arg(0)->Arg(50)->UseRealTime();
+
+/// <summary> Tasks a zone runs per second when they are scheduled in bursts, by the number of workers. </summary>
+static void BM_TaskThroughput(benchmark::State& state) {
+    constexpr int64_t TASKS_PER_BURST = 10000;
+    auto workers = static_cast<uint32_t>(state.range(0));
+    SchedulerImpl<QueueWorker> scheduler(MakeSettings(workers, 50), [](WorkerId) {});
+
+    std::atomic<int64_t> remaining(0);
+    auto task = std::make_shared<CountdownTask>(remaining);
+    for (auto _ : state) {
+        remaining = TASKS_PER_BURST;
+        for (int64_t i = 0; i < TASKS_PER_BURST; ++i) {
+            scheduler.Schedule(task);
+        }
+        WaitFor(remaining);
+    }
+    state.SetItemsProcessed(state.iterations() * TASKS_PER_BURST);
+}
+BENCHMARK(BM_TaskThroughput)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+/// <summary> Same as BM_TaskThroughput, with each burst scheduled through ScheduleBatch. </summary>
+static void BM_TaskThroughputBatch(benchmark::State& state) {
+    constexpr int64_t TASKS_PER_BURST = 10000;
+    auto workers = static_cast<uint32_t>(state.range(0));
+    SchedulerImpl<QueueWorker> scheduler(MakeSettings(workers, 50), [](WorkerId) {});
+
+    std::atomic<int64_t> remaining(0);
+    auto task = std::make_shared<CountdownTask>(remaining);
+    for (auto _ : state) {
+        remaining = TASKS_PER_BURST;
+        scheduler.ScheduleBatch(std::vector<std::shared_ptr<Task>>(TASKS_PER_BURST, task));
+        WaitFor(remaining);
+    }
+    state.SetItemsProcessed(state.iterations() * TASKS_PER_BURST);
+}
+BENCHMARK(BM_TaskThroughputBatch)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <benchmark/benchmark.h>
+
+#include <zone/simple-thread-pool.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace napa::zone;
+
+/// <summary> Jobs a pool runs per second when they are executed in bursts, by the number of pool workers. </summary>
+static void BM_ThreadPoolThroughput(benchmark::State& state) {
+    constexpr int64_t JOBS_PER_BURST = 10000;
+    SimpleThreadPool pool(static_cast<uint32_t>(state.range(0)));
+
+    std::atomic<int64_t> remaining(0);
+    for (auto _ : state) {
+        remaining = JOBS_PER_BURST;
+        for (int64_t i = 0; i < JOBS_PER_BURST; ++i) {
+            pool.Execute([&remaining]() {
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * JOBS_PER_BURST);
+}
+BENCHMARK(BM_ThreadPoolThroughput)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+
+/// <summary> Time from executing a job on an idle pool of one worker until it observed the job ran. </summary>
+static void BM_ThreadPoolLatency(benchmark::State& state) {
+    SimpleThreadPool pool(1);
+
+    std::atomic<bool> done(false);
+    for (auto _ : state) {
+        done = false;
+        pool.Execute([&done]() {
+            done.store(true, std::memory_order_release);
+        });
+        while (!done.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ThreadPoolLatency)->UseRealTime();
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <benchmark/benchmark.h>
+
+#include <zone/timer.h>
+
+#include <memory>
+
+using namespace napa::zone;
+
+namespace {
+    /// <summary> Long enough that timers under benchmark never fire, like call timeouts of calls that finish in time. </summary>
+    constexpr std::chrono::milliseconds TIMEOUT(60 * 1000);
+}
+
+/// <summary> Starting and stopping the same timer, e.g. a worker watchdog re-armed around each task. </summary>
+static void BM_TimerStartStop(benchmark::State& state) {
+    Timer timer([]() {}, TIMEOUT);
+    for (auto _ : state) {
+        timer.Start();
+        timer.Stop();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimerStartStop)->ThreadRange(1, 8)->UseRealTime();
+
+/// <summary> Creating, starting, stopping and destroying a timer, which each call with a timeout does. </summary>
+static void BM_TimerLifecycle(benchmark::State& state) {
+    for (auto _ : state) {
+        auto timer = std::make_unique<Timer>([]() {}, TIMEOUT);
+        timer->Start();
+        timer->Stop();
+        timer.reset();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimerLifecycle)->ThreadRange(1, 8)->UseRealTime();
+
+/// <summary> Starting a timer among many active ones, then stopping it, the argument is the number of active timers. </summary>
+static void BM_TimerStartStopAmongActive(benchmark::State& state) {
+    std::vector<std::unique_ptr<Timer>> active;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        active.emplace_back(std::make_unique<Timer>([]() {}, TIMEOUT + std::chrono::milliseconds(i)));
+        active.back()->Start();
+    }
+
+    Timer timer([]() {}, TIMEOUT);
+    for (auto _ : state) {
+        timer.Start();
+        timer.Stop();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimerStartStopAmongActive)->RangeMultiplier(100)->Range(1, 1000000);
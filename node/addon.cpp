@@ -8,6 +8,7 @@
 #include <napa/zone.h>
 
 #include <zone/node-zone.h>
+#include <zone/sync-wait.h>
 
 void Initialize(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
@@ -39,7 +40,15 @@ void Shutdown(const v8::FunctionCallbackInfo<v8::Value>&) {
 
 void InitAll(v8::Local<v8::Object> exports, v8::Local<v8::Object> module) {
     // Init node zone before initialize modules.
-    napa::zone::NodeZone::Init(napa::node_zone::Broadcast, napa::node_zone::Execute);
+    napa::zone::NodeZone::Init(
+        napa::node_zone::Broadcast,
+        napa::node_zone::Execute,
+        napa::node_zone::GetMemoryUsage,
+        napa::node_zone::GetHeapStatistics,
+        napa::node_zone::WriteHeapSnapshot);
+
+    // Synchronous calls made on the Node thread run operations scheduled on Node zone while they wait.
+    napa::zone::SetPendingWork(napa::node_zone::RunScheduled);
 
     // Init core napa modules.
     napa::module::binding::Init(exports, module);
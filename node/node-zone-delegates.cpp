@@ -5,41 +5,78 @@
 
 #include <zone/call-task.h>
 #include <zone/eval-task.h>
+#include <zone/memory-usage.h>
 
+#include <napa/zone/completion-inbox.h>
+
+#include <node.h>
 #include <uv.h>
 
-struct AsyncContext {
-    /// <summary> libuv request. </summary>
-    uv_async_t work;
+#include <functional>
+#include <memory>
 
+/// <summary> An operation scheduled on Node zone. </summary>
+struct ScheduledCall {
     /// <summary> Callback that will be running in Node event loop. </summary>
     std::function<void()> callback;
+
+    /// <summary> Next call in the inbox. </summary>
+    ScheduledCall* nextCompletion = nullptr;
 };
 
-/// <summary> Run an async work item in Node. </summary>
-void Run(uv_async_t* work) {
-    auto context = static_cast<AsyncContext*>(work->data);
+/// <summary>
+///     Operations scheduled on Node zone and not run yet, pushed from any thread without a lock.
+///     Only the first operation into an empty inbox wakes up the event loop, which runs all operations in the
+///     inbox by then, so operations that workers schedule together share one wakeup. Synchronous calls waiting
+///     on the Node thread run them ahead of the event loop.
+/// </summary>
+napa::zone::CompletionInbox<ScheduledCall> scheduledCalls;
+
+/// <summary> Run operations in the inbox, in the order they were scheduled. Called on the Node thread. </summary>
+void RunScheduledCalls() {
+    auto call = scheduledCalls.TakeAll();
+    while (call != nullptr) {
+        std::unique_ptr<ScheduledCall> current(call);
+        call = call->nextCompletion;
+
+        // Run microtasks and next ticks queued by the callback once it returns, e.g. continuations of an async function call.
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+        node::CallbackScope callbackScope(isolate, v8::Object::New(isolate), { 0, 0 });
 
-    context->callback();
+        current->callback();
+    }
+}
+
+/// <summary> Run operations of a wakeup in Node, and close its libuv request. </summary>
+void Run(uv_async_t* work) {
+    // The inbox may have been emptied by a waiting synchronous call already, or have operations of later wakeups.
+    RunScheduledCalls();
 
-    uv_close(reinterpret_cast<uv_handle_t*>(work), [](auto work) {
-        auto context = static_cast<AsyncContext*>(work->data);
-        delete context;
+    // Each wakeup has its own request, which keeps the event loop alive until operations it woke up for ran.
+    uv_close(reinterpret_cast<uv_handle_t*>(work), [](auto handle) {
+        delete reinterpret_cast<uv_async_t*>(handle);
     });
 }
 
 /// <summary> Schedule a function in Node event loop. </summary>
 void ScheduleInNode(std::function<void()> callback) {
-    auto context = new AsyncContext();
-    context->work.data = context;
-    context->callback = std::move(callback);
+    auto call = new ScheduledCall();
+    call->callback = std::move(callback);
+
+    if (scheduledCalls.Push(call)) {
+        auto work = new uv_async_t();
+        uv_async_init(uv_default_loop(), work, Run);
+        uv_async_send(work);
+    }
+}
 
-    uv_async_init(uv_default_loop(), &context->work, Run);
-    uv_async_send(&context->work);
+void napa::node_zone::RunScheduled() {
+    RunScheduledCalls();
 }
 
 void napa::node_zone::Broadcast(const std::string& source, napa::BroadcastCallback callback) {
-    std::string sourceCopy = source;
+    auto sourceCopy = std::make_shared<const std::string>(source);
     ScheduleInNode([sourceCopy = std::move(sourceCopy), callback = std::move(callback)]() {
         napa::zone::EvalTask task(std::move(sourceCopy), "", std::move(callback));
         task.Execute();
@@ -53,3 +90,21 @@ void napa::node_zone::Execute(const napa::FunctionSpec& spec, napa::ExecuteCallb
         task.Execute();
     });
 }
+
+void napa::node_zone::GetMemoryUsage(napa::MemoryUsageCallback callback) {
+    ScheduleInNode([callback = std::move(callback)]() {
+        callback({ napa::zone::GetWorkerMemoryUsage(v8::Isolate::GetCurrent(), 0) });
+    });
+}
+
+void napa::node_zone::GetHeapStatistics(napa::HeapStatisticsCallback callback) {
+    ScheduleInNode([callback = std::move(callback)]() {
+        callback({ napa::zone::GetWorkerHeapStatistics(v8::Isolate::GetCurrent(), 0) });
+    });
+}
+
+void napa::node_zone::WriteHeapSnapshot(const std::string& path, napa::HeapSnapshotCallback callback) {
+    ScheduleInNode([path, callback = std::move(callback)]() {
+        callback(napa::zone::WriteHeapSnapshot(v8::Isolate::GetCurrent(), path));
+    });
+}
@@ -13,5 +13,17 @@ namespace node_zone {
 
     /// <summary> Execute in Node zone. </summary>
     void Execute(const napa::FunctionSpec& spec, napa::ExecuteCallback callback);
+
+    /// <summary> Get memory usage of Node zone. </summary>
+    void GetMemoryUsage(napa::MemoryUsageCallback callback);
+
+    /// <summary> Get heap statistics of Node zone. </summary>
+    void GetHeapStatistics(napa::HeapStatisticsCallback callback);
+
+    /// <summary> Write a heap snapshot of Node zone. </summary>
+    void WriteHeapSnapshot(const std::string& path, napa::HeapSnapshotCallback callback);
+
+    /// <summary> Run operations scheduled on Node zone ahead of the event loop. Called on the Node thread. </summary>
+    void RunScheduled();
 }
 }
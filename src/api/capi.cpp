@@ -3,19 +3,51 @@
 
 #include <napa/capi.h>
 
+#include <memory/buffer-pool.h>
+#include <memory/shared-memory.h>
+#include <memory/thread-allocation-counters.h>
+#include <memory/thread-caching-allocator.h>
+#include <module/core-modules/napa/array-buffer-transport.h>
+#include <module/loader/json-module-cache.h>
+#include <module/loader/module-bundle.h>
+#include <module/loader/module-loader.h>
+#include <module/loader/module-versions.h>
+#include <module/loader/resolution-cache.h>
+#include <module/loader/script-cache.h>
+#include <providers/console-sink.h>
 #include <providers/providers.h>
 #include <settings/settings-parser.h>
 #include <utils/debug.h>
+#include <v8/startup-snapshot.h>
 #include <v8/v8-common.h>
+#include <zone/async-workers.h>
+#include <zone/batch-callback.h>
+#include <zone/cpu-governor.h>
+#include <zone/flight-recorder.h>
+#include <zone/isolate-pool.h>
+#include <zone/memory-pressure.h>
 #include <zone/napa-zone.h>
 #include <zone/node-zone.h>
+#include <zone/remote-zone.h>
+#include <zone/remote-zone-host.h>
+#include <zone/shared-thread-pool.h>
 #include <zone/worker-context.h>
+#include <zone/zone-group.h>
 
 #include <napa/log.h>
+#include <napa/transport/transport-context.h>
 
+#include <rapidjson/document.h>
+#include <v8.h>
+
+#include <algorithm>
 #include <atomic>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <mutex>
 #include <sstream>
+#include <string>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -26,6 +58,10 @@ using namespace napa;
 static std::atomic<bool> _initialized(false);
 static settings::PlatformSettings _platformSettings;
 
+/// <summary> Hosts of served zones, which serve until shutdown. </summary>
+static std::mutex _remoteZoneHostsLock;
+static std::vector<std::unique_ptr<zone::RemoteZoneHost>> _remoteZoneHosts;
+
 /// <summary> a simple wrapper around Zone for managing lifetime using shared_ptr. </summary>
 struct napa_zone {
     std::string id;
@@ -69,6 +105,44 @@ napa_zone_handle napa_zone_get_current() {
     return napa_zone_get(STD_STRING_TO_NAPA_STRING_REF(zone->GetId()));
 }
 
+napa_zone_handle napa_zone_connect(napa_string_ref address) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+
+    auto zone = zone::RemoteZone::Connect(NAPA_STRING_REF_TO_STD_STRING(address));
+    if (zone == nullptr) {
+        return nullptr;
+    }
+
+    auto zoneId = zone->GetId();
+    return new napa_zone { std::move(zoneId), std::move(zone) };
+}
+
+napa_zone_handle napa_zone_group(napa_string_ref id, const napa_zone_handle* members, size_t count, uint32_t local_payload_size) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+
+    std::vector<zone::ZoneGroup::Member> groupMembers;
+    for (size_t i = 0; i < count; i++) {
+        NAPA_ASSERT(members[i], "Zone handle is null");
+        const auto& member = members[i]->zone;
+        if (member == nullptr) {
+            NAPA_DEBUG("Api", "Zone \"%s\" can't be grouped before it's initialized", members[i]->id.c_str());
+            return nullptr;
+        }
+        groupMembers.push_back({ member, dynamic_cast<zone::RemoteZone*>(member.get()) != nullptr });
+    }
+
+    if (groupMembers.empty()) {
+        return nullptr;
+    }
+
+    zone::ZoneGroupSettings settings;
+    settings.localPayloadSize = local_payload_size;
+
+    auto groupId = NAPA_STRING_REF_TO_STD_STRING(id);
+    auto group = std::make_shared<zone::ZoneGroup>(groupId, std::move(groupMembers), settings);
+    return new napa_zone { std::move(groupId), std::move(group) };
+}
+
 napa_result_code napa_zone_init(napa_zone_handle handle, napa_string_ref settings) {
     NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
     NAPA_ASSERT(handle, "Zone handle is null");
@@ -110,6 +184,258 @@ napa_string_ref napa_zone_get_id(napa_zone_handle handle) {
     return STD_STRING_TO_NAPA_STRING_REF(handle->id);
 }
 
+napa_result_code napa_zone_serve(napa_zone_handle handle, napa_string_ref address, uint16_t* port) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    auto host = zone::RemoteZoneHost::Start(handle->zone, NAPA_STRING_REF_TO_STD_STRING(address));
+    if (host == nullptr) {
+        return NAPA_RESULT_ZONE_SERVE_ERROR;
+    }
+
+    if (port != nullptr) {
+        *port = host->GetPort();
+    }
+
+    std::lock_guard<std::mutex> lock(_remoteZoneHostsLock);
+    _remoteZoneHosts.emplace_back(std::move(host));
+    return NAPA_RESULT_SUCCESS;
+}
+
+float napa_zone_get_pressure(napa_zone_handle handle) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    return handle->zone->GetPressure();
+}
+
+uint32_t napa_zone_get_workers(napa_zone_handle handle) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    return handle->zone->GetWorkers();
+}
+
+void napa_zone_resize(napa_zone_handle handle,
+                      uint32_t workers,
+                      napa_zone_resize_callback callback,
+                      void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->Resize(workers, [callback, context](napa_result_code code) {
+        callback(code, context);
+    });
+}
+
+void napa_zone_drain(napa_zone_handle handle,
+                     uint32_t timeout,
+                     napa_zone_drain_callback callback,
+                     void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->Drain(timeout, [callback, context](napa_result_code code, size_t cancelled) {
+        callback(code, cancelled, context);
+    });
+}
+
+void napa_zone_get_memory_usage(napa_zone_handle handle,
+                                napa_zone_memory_usage_callback callback,
+                                void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->GetMemoryUsage([callback, context](std::vector<WorkerMemoryUsage> usages) {
+        callback(usages.data(), usages.size(), context);
+    });
+}
+
+void napa_zone_start_profiling(napa_zone_handle handle,
+                               uint32_t sampling_interval,
+                               napa_zone_profiling_callback callback,
+                               void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->StartProfiling(sampling_interval, [callback, context](napa_result_code code) {
+        callback(code, context);
+    });
+}
+
+void napa_zone_stop_profiling(napa_zone_handle handle,
+                              napa_zone_cpu_profile_callback callback,
+                              void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->StopProfiling([callback, context](std::vector<std::string> profiles) {
+        std::vector<napa_string_ref> refs;
+        refs.reserve(profiles.size());
+        for (const auto& profile : profiles) {
+            refs.push_back(STD_STRING_TO_NAPA_STRING_REF(profile));
+        }
+        callback(refs.data(), refs.size(), context);
+    });
+}
+
+void napa_zone_start_allocation_profiling(napa_zone_handle handle,
+                                          uint32_t sampling_interval,
+                                          napa_zone_profiling_callback callback,
+                                          void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->StartAllocationProfiling(sampling_interval, [callback, context](napa_result_code code) {
+        callback(code, context);
+    });
+}
+
+void napa_zone_stop_allocation_profiling(napa_zone_handle handle,
+                                         napa_zone_allocation_profile_callback callback,
+                                         void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->StopAllocationProfiling([callback, context](std::string profile) {
+        callback(STD_STRING_TO_NAPA_STRING_REF(profile), context);
+    });
+}
+
+void napa_zone_get_heap_statistics(napa_zone_handle handle,
+                                   napa_zone_heap_statistics_callback callback,
+                                   void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->GetHeapStatistics([callback, context](std::vector<WorkerHeapStatistics> statistics) {
+        // Spaces of all workers are kept in one list, which outlives the callback.
+        std::vector<napa_heap_space_statistics> spaces;
+        for (const auto& worker : statistics) {
+            for (const auto& space : worker.spaces) {
+                spaces.push_back({ STD_STRING_TO_NAPA_STRING_REF(space.name),
+                    space.size, space.usedSize, space.availableSize, space.physicalSize });
+            }
+        }
+
+        std::vector<napa_worker_heap_statistics> workers;
+        workers.reserve(statistics.size());
+        size_t spacesOffset = 0;
+        for (const auto& worker : statistics) {
+            workers.push_back({
+                worker.workerId,
+                worker.totalHeapSize,
+                worker.totalHeapSizeExecutable,
+                worker.totalPhysicalSize,
+                worker.totalAvailableSize,
+                worker.usedHeapSize,
+                worker.heapSizeLimit,
+                worker.mallocedMemory,
+                worker.peakMallocedMemory,
+                worker.numberOfNativeContexts,
+                worker.numberOfDetachedContexts,
+                spaces.data() + spacesOffset,
+                worker.spaces.size() });
+            spacesOffset += worker.spaces.size();
+        }
+        callback(workers.data(), workers.size(), context);
+    });
+}
+
+void napa_zone_write_heap_snapshot(napa_zone_handle handle,
+                                   uint32_t worker_id,
+                                   napa_string_ref path,
+                                   napa_zone_heap_snapshot_callback callback,
+                                   void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->WriteHeapSnapshot(worker_id, NAPA_STRING_REF_TO_STD_STRING(path), [callback, context](napa_result_code code) {
+        callback(code, context);
+    });
+}
+
+void napa_zone_get_slow_calls(napa_zone_handle handle,
+                              napa_zone_slow_calls_callback callback,
+                              void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    auto calls = handle->zone->GetSlowCalls();
+
+    // Arguments of all calls are kept in one list each, which outlives the callback.
+    std::vector<size_t> argumentSizes;
+    std::vector<napa_string_ref> arguments;
+    for (const auto& call : calls) {
+        argumentSizes.insert(argumentSizes.end(), call.argumentSizes.begin(), call.argumentSizes.end());
+        arguments.resize(argumentSizes.size(), EMPTY_NAPA_STRING_REF);
+        for (size_t i = 0; i < call.arguments.size(); ++i) {
+            arguments[arguments.size() - call.argumentSizes.size() + i] = STD_STRING_TO_NAPA_STRING_REF(call.arguments[i]);
+        }
+    }
+
+    std::vector<napa_slow_call> results;
+    results.reserve(calls.size());
+    size_t argumentsOffset = 0;
+    for (const auto& call : calls) {
+        results.push_back({
+            STD_STRING_TO_NAPA_STRING_REF(call.module),
+            STD_STRING_TO_NAPA_STRING_REF(call.function),
+            call.workerId,
+            call.code,
+            static_cast<uint8_t>(call.sampled ? 1 : 0),
+            call.startTime,
+            call.queueTime,
+            call.unmarshallTime,
+            call.executionTime,
+            call.marshallTime,
+            call.completionTime,
+            argumentSizes.data() + argumentsOffset,
+            arguments.data() + argumentsOffset,
+            call.argumentSizes.size() });
+        argumentsOffset += call.argumentSizes.size();
+    }
+    callback(results.data(), results.size(), context);
+}
+
+void napa_zone_get_function_stats(napa_zone_handle handle,
+                                  napa_zone_function_stats_callback callback,
+                                  void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    auto stats = handle->zone->GetFunctionStats();
+
+    std::vector<napa_function_stats> results(stats.size());
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const auto& function = stats[i];
+        auto& result = results[i];
+        result.module = STD_STRING_TO_NAPA_STRING_REF(function.module);
+        result.function = STD_STRING_TO_NAPA_STRING_REF(function.function);
+        result.calls = function.calls;
+        result.errors = function.errors;
+        result.timeouts = function.timeouts;
+        result.total_time = function.totalTime;
+        result.max_time = function.maxTime;
+        std::copy(function.histogram.begin(), function.histogram.end(), result.histogram);
+    }
+    callback(results.data(), results.size(), context);
+}
+
 void napa_zone_broadcast(napa_zone_handle handle,
                          napa_string_ref source,
                          napa_zone_broadcast_callback callback,
@@ -123,14 +449,7 @@ void napa_zone_broadcast(napa_zone_handle handle,
     });
 }
 
-void napa_zone_execute(napa_zone_handle handle,
-                       napa_zone_function_spec spec,
-                       napa_zone_execute_callback callback,
-                       void* context) {
-    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
-    NAPA_ASSERT(handle, "Zone handle is null");
-    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
-
+static FunctionSpec ToFunctionSpec(const napa_zone_function_spec& spec) {
     FunctionSpec req;
     req.module = spec.module;
     req.function = spec.function;
@@ -145,28 +464,188 @@ void napa_zone_execute(napa_zone_handle handle,
     // Assume ownership of transport context
     req.transportContext.reset(reinterpret_cast<napa::transport::TransportContext*>(spec.transport_context));
 
-    handle->zone->Execute(req, [callback, context](Result result) {
-        napa_zone_result res;
-        res.code = result.code;
-        res.error_message = STD_STRING_TO_NAPA_STRING_REF(result.errorMessage);
-        res.return_value = STD_STRING_TO_NAPA_STRING_REF(result.returnValue);
-        
-        // Release ownership of transport context
-        res.transport_context = reinterpret_cast<void*>(result.transportContext.release());
+    // And of arguments, if the caller hands them over.
+    if (spec.arguments_release != nullptr) {
+        auto release = spec.arguments_release;
+        req.argumentsOwner = std::shared_ptr<const void>(spec.arguments_release_context, [release](const void* context) {
+            release(const_cast<void*>(context));
+        });
+    }
+    return req;
+}
+
+static napa_zone_result ToZoneResult(Result& result) {
+    napa_zone_result res;
+    res.code = result.code;
+    res.error_message = STD_STRING_TO_NAPA_STRING_REF(result.errorMessage);
+    res.return_value = STD_STRING_TO_NAPA_STRING_REF(result.returnValue);
+
+    // Release ownership of transport context
+    res.transport_context = reinterpret_cast<void*>(result.transportContext.release());
+
+    res.cpu_time = result.cpuTime;
+    res.allocated_bytes = result.allocatedBytes;
+
+    // The string lives as long as the callback, a C++ callback may take it over.
+    res.return_value_owner = &result.returnValue;
+    return res;
+}
+
+void napa_zone_execute(napa_zone_handle handle,
+                       napa_zone_function_spec spec,
+                       napa_zone_execute_callback callback,
+                       void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+
+    handle->zone->Execute(ToFunctionSpec(spec), [callback, context](Result result) {
+        callback(ToZoneResult(result), context);
+    });
+}
+
+void napa_zone_execute_batch(napa_zone_handle handle,
+                             const napa_zone_function_spec* specs,
+                             size_t specs_count,
+                             napa_zone_execute_batch_callback callback,
+                             void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+    NAPA_ASSERT(specs != nullptr || specs_count == 0, "Function specs are null");
+
+    std::vector<FunctionSpec> reqs;
+    reqs.reserve(specs_count);
+    for (size_t i = 0; i < specs_count; i++) {
+        reqs.emplace_back(ToFunctionSpec(specs[i]));
+    }
+
+    handle->zone->ExecuteBatch(reqs, [callback, context](std::vector<Result> results) {
+        std::vector<napa_zone_result> res;
+        res.reserve(results.size());
+        for (auto& result : results) {
+            res.emplace_back(ToZoneResult(result));
+        }
 
-        callback(res, context);
+        callback(res.data(), res.size(), context);
     });
 }
 
+void napa_zone_execute_many(napa_zone_handle handle,
+                            const napa_zone_function_spec* specs,
+                            size_t specs_count,
+                            napa_zone_result* results,
+                            napa_result_arena* arena,
+                            napa_zone_execute_batch_callback callback,
+                            void* context) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+    NAPA_ASSERT(handle, "Zone handle is null");
+    NAPA_ASSERT(handle->zone, "Zone handle wasn't initialized");
+    NAPA_ASSERT(specs != nullptr || specs_count == 0, "Function specs are null");
+    NAPA_ASSERT(results != nullptr || specs_count == 0, "Results are null");
+    NAPA_ASSERT(arena != nullptr && (arena->data != nullptr || arena->capacity == 0), "Result arena is null");
+
+    std::vector<FunctionSpec> reqs;
+    reqs.reserve(specs_count);
+    for (size_t i = 0; i < specs_count; i++) {
+        reqs.emplace_back(ToFunctionSpec(specs[i]));
+    }
+
+    handle->zone->ExecuteBatch(reqs, napa::zone::CreateArenaBatchCallbacks(specs_count, results, arena, callback, context));
+}
+
+void napa_zone_result_take_return_value(const napa_zone_result& result, std::string& return_value) {
+    if (result.return_value_owner != nullptr) {
+        return_value = std::move(*static_cast<std::string*>(result.return_value_owner));
+    } else {
+        return_value = NAPA_STRING_REF_TO_STD_STRING(result.return_value);
+    }
+}
+
+namespace {
+    /// <summary> Whether napa_allocator_set was called, which takes precedence over the 'allocator' platform setting. </summary>
+    std::atomic<bool> _allocatorSet(false);
+} // namespace
+
 static napa_result_code napa_initialize_common() {
+    // The backend is switched before anything is allocated from it.
+    if (_platformSettings.allocator == settings::AllocatorType::THREAD_CACHING) {
+        if (_allocatorSet) {
+            LOG_WARNING("Api", "Platform setting 'allocator' is ignored, since napa_allocator_set was called before initialization");
+        } else {
+            napa_allocator_set(napa::memory::thread_caching::Allocate, napa::memory::thread_caching::Deallocate);
+        }
+    }
+
+    // Isolates pick their ArrayBuffer allocator on creation, so the pool is configured ahead of any zone.
+    if (_platformSettings.arrayBufferPoolSize > 0) {
+        napa::memory::BufferPool::GetInstance().Configure(
+            static_cast<size_t>(_platformSettings.arrayBufferPoolSize) * 1024 * 1024,
+            _platformSettings.arrayBufferHugePages);
+    }
+
+    // Zone workers take slots of the budget from their first task.
+    napa::zone::CpuGovernor::GetInstance().SetBudget(_platformSettings.cpuBudget);
+
+    // Pools of async work start their threads on first use.
+    napa::zone::AsyncWorkers::GetInstance().Configure(napa::zone::AsyncWorkPool::CPU, _platformSettings.asyncCpuWorkers);
+    napa::zone::AsyncWorkers::GetInstance().Configure(napa::zone::AsyncWorkPool::IO, _platformSettings.asyncIoWorkers);
+
+    // So does the pool of shared threads, with the first worker of a zone sharing threads.
+    napa::zone::SharedThreadPool::Configure(_platformSettings.sharedWorkerThreads);
+
+    // Workers record events from their first task, which are dumped here on V8 fatal errors.
+    napa::zone::FlightRecorder::SetDirectory(_platformSettings.flightRecorderDirectory);
+
     if (!napa::providers::Initialize(_platformSettings)) {
         return NAPA_RESULT_PROVIDERS_INIT_ERROR;
     }
 
-    if (!napa::v8_common::Initialize()) {
+    napa::providers::ConsoleSink::GetInstance().Configure(_platformSettings.consoleOutput, _platformSettings.consoleRateLimit);
+
+    if (!napa::v8_common::Initialize(_platformSettings.v8PlatformThreads)) {
         return NAPA_RESULT_V8_INIT_ERROR;
     }
 
+    // V8 reads the flag whenever an isolate grows its young generation, so it can't differ between zones.
+    if (_platformSettings.semiSpaceGrowthFactor > 0) {
+        auto flag = "--semi_space_growth_factor=" + std::to_string(_platformSettings.semiSpaceGrowthFactor);
+        v8::V8::SetFlagsFromString(flag.c_str(), static_cast<int>(flag.size()));
+    }
+
+    if (!_platformSettings.snapshotBlob.empty() && !napa::v8_common::LoadStartupSnapshot(_platformSettings.snapshotBlob)) {
+        return NAPA_RESULT_SNAPSHOT_ERROR;
+    }
+
+    napa::module::ModuleLoader::SetFunctionWrappers(_platformSettings.moduleWrappers);
+    napa::module::ResolutionCache::GetInstance().SetStatCacheEnabled(_platformSettings.moduleStatCache);
+    napa::module::JsonModuleCache::GetInstance().SetMode(
+        _platformSettings.jsonModules != napa::settings::JsonModules::PARSE,
+        _platformSettings.jsonModules == napa::settings::JsonModules::FROZEN);
+
+    if (!_platformSettings.codeCacheDirectory.empty()) {
+        napa::module::ScriptCache::GetInstance().SetDirectory(_platformSettings.codeCacheDirectory);
+    }
+
+    if (!_platformSettings.moduleBundle.empty()) {
+        std::string error;
+        auto bundle = napa::module::ModuleBundle::Open(_platformSettings.moduleBundle.c_str(), error);
+        if (bundle == nullptr) {
+            LOG_ERROR("Api", "%s", error.c_str());
+            return NAPA_RESULT_MODULE_BUNDLE_ERROR;
+        }
+        napa::module::ModuleBundle::SetLoaded(std::move(bundle));
+    }
+
+    if (_platformSettings.moduleWatchInterval > 0) {
+        napa::module::ModuleVersions::GetInstance().StartWatching(
+            std::chrono::milliseconds(_platformSettings.moduleWatchInterval));
+    }
+
+    if (_platformSettings.spareIsolates > 0) {
+        napa::zone::NapaZone::ReserveSpareIsolates(_platformSettings.spareIsolates);
+    }
+
     _initialized = true;
 
     NAPA_DEBUG("Api", "Napa platform initialized successfully");
@@ -194,9 +673,28 @@ napa_result_code napa_initialize_from_console(int argc, const char* argv[]) {
     return napa_initialize_common();
 }
 
+napa_result_code napa_create_snapshot(napa_string_ref source, napa_string_ref path) {
+    NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
+
+    if (!napa::v8_common::CreateStartupSnapshot(NAPA_STRING_REF_TO_STD_STRING(source), NAPA_STRING_REF_TO_STD_STRING(path))) {
+        return NAPA_RESULT_SNAPSHOT_ERROR;
+    }
+
+    return NAPA_RESULT_SUCCESS;
+}
+
 napa_result_code napa_shutdown() {
     NAPA_ASSERT(_initialized, "Napa platform wasn't initialized");
 
+    napa::module::ModuleVersions::GetInstance().StopWatching();
+
+    // Served zones stop taking calls before zones and V8 go away.
+    {
+        std::lock_guard<std::mutex> lock(_remoteZoneHostsLock);
+        _remoteZoneHosts.clear();
+    }
+
+    napa::zone::IsolatePool::GetInstance().Clear();
     napa::providers::Shutdown();
     napa::v8_common::Shutdown();
 
@@ -205,6 +703,17 @@ napa_result_code napa_shutdown() {
     return NAPA_RESULT_SUCCESS;
 }
 
+void napa_memory_pressure(napa_memory_pressure_level level) {
+    NAPA_ASSERT(level >= MEMORY_PRESSURE_NONE && level <= MEMORY_PRESSURE_CRITICAL, "memory pressure level out of range (%d)", level);
+
+    zone::NapaZone::NotifyMemoryPressure(level);
+    if (level == MEMORY_PRESSURE_CRITICAL) {
+        zone::ReleaseAllocatorCaches();
+    }
+
+    LOG_INFO("Api", "Notified memory pressure level %d", static_cast<int>(level));
+}
+
 
 #define NAPA_RESULT_CODE_DEF(symbol, string_rep) string_rep
 
@@ -250,12 +759,130 @@ void napa_allocator_set(
 
     _global_allocate = allocate_callback;
     _global_deallocate = deallocate_callback;
+    _allocatorSet = true;
 }
 
 void* napa_allocate(size_t size) {
+    // Counted per thread, which zone.memoryUsage reports for each worker.
+    auto& counters = memory::GetThreadAllocationCounters();
+    counters.allocateCount++;
+    counters.allocatedSize += size;
     return _global_allocate(size);
 }
 
 void napa_deallocate(void* pointer, size_t size_hint) {
+    auto& counters = memory::GetThreadAllocationCounters();
+    counters.deallocateCount++;
+    counters.deallocatedSize += size_hint;
     _global_deallocate(pointer, size_hint);
 }
+
+///////////////////////////////////////////////////////////////
+/// Implementation of napa shared buffer C API
+
+/// <summary> A reference to shared memory, which zones load as external ArrayBuffers. </summary>
+struct napa_buffer {
+    std::shared_ptr<napa::memory::SharedMemory> memory;
+};
+
+namespace {
+    /// <summary> Number of uint32 words of a handle in payloads, as written by v8_helpers::PtrToV8Uint32Array. </summary>
+    constexpr size_t HANDLE_WORDS = sizeof(uintptr_t) / sizeof(uint32_t);
+} // namespace
+
+napa_buffer_handle napa_buffer_allocate(size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    auto sharedMemory = napa::memory::AllocateSharedMemory(
+        std::shared_ptr<napa::memory::Allocator>(&napa::memory::BufferPool::GetInstance(), [](napa::memory::Allocator*){}),
+        size);
+    if (sharedMemory == nullptr) {
+        return nullptr;
+    }
+    return new napa_buffer { std::move(sharedMemory) };
+}
+
+void* napa_buffer_get_data(napa_buffer_handle handle) {
+    NAPA_ASSERT(handle, "Buffer handle is null");
+    return handle->memory->GetData();
+}
+
+size_t napa_buffer_get_size(napa_buffer_handle handle) {
+    NAPA_ASSERT(handle, "Buffer handle is null");
+    return handle->memory->GetLength();
+}
+
+void napa_buffer_release(napa_buffer_handle handle) {
+    delete handle;
+}
+
+void* napa_transport_context_create() {
+    return new transport::TransportContext();
+}
+
+void napa_transport_context_release(void* transport_context) {
+    delete reinterpret_cast<transport::TransportContext*>(transport_context);
+}
+
+napa_string_ref napa_transport_context_save_buffer(void* transport_context, napa_buffer_handle buffer, char* payload) {
+    NAPA_ASSERT(transport_context, "Transport context is null");
+    NAPA_ASSERT(buffer, "Buffer handle is null");
+    NAPA_ASSERT(payload, "Payload is null");
+
+    // Saved as marshallArrayBuffer saves ArrayBuffers over shared memory, which zones load with LoadExternal.
+    auto transported = std::make_shared<module::array_buffer_transport::TransportedArrayBuffer>(buffer->memory);
+    auto handle = reinterpret_cast<uintptr_t>(transported.get());
+    reinterpret_cast<transport::TransportContext*>(transport_context)->SaveShared(std::move(transported));
+
+    auto length = std::snprintf(payload, NAPA_BUFFER_PAYLOAD_MAX_SIZE, "{\"_cid\":\"ArrayBuffer\",\"handle\":[");
+    for (size_t i = 0; i < HANDLE_WORDS; ++i) {
+        length += std::snprintf(payload + length, NAPA_BUFFER_PAYLOAD_MAX_SIZE - length, i == 0 ? "%u" : ",%u",
+            static_cast<uint32_t>(handle >> (32 * i)));
+    }
+    length += std::snprintf(payload + length, NAPA_BUFFER_PAYLOAD_MAX_SIZE - length, "]}");
+    return NAPA_STRING_REF_WITH_SIZE(payload, static_cast<size_t>(length));
+}
+
+napa_buffer_handle napa_transport_context_load_buffer(void* transport_context, napa_string_ref payload) {
+    NAPA_ASSERT(transport_context, "Transport context is null");
+
+    rapidjson::Document document;
+    document.Parse(payload.data, payload.size);
+    if (document.HasParseError() || !document.IsObject()) {
+        return nullptr;
+    }
+
+    auto cid = document.FindMember("_cid");
+    auto handleMember = document.FindMember("handle");
+    if (cid == document.MemberEnd() || !cid->value.IsString() || std::strcmp(cid->value.GetString(), "ArrayBuffer") != 0
+        || handleMember == document.MemberEnd() || !handleMember->value.IsArray() || handleMember->value.Size() != HANDLE_WORDS) {
+        return nullptr;
+    }
+
+    uintptr_t handle = 0;
+    for (rapidjson::SizeType i = 0; i < HANDLE_WORDS; ++i) {
+        if (!handleMember->value[i].IsUint()) {
+            return nullptr;
+        }
+        handle |= static_cast<uintptr_t>(handleMember->value[i].GetUint()) << (32 * i);
+    }
+
+    auto context = reinterpret_cast<transport::TransportContext*>(transport_context);
+    auto shared = document.FindMember("shared");
+    std::shared_ptr<napa::memory::SharedMemory> sharedMemory;
+    if (shared != document.MemberEnd() && shared->value.IsTrue()) {
+        sharedMemory = context->LoadShared<napa::memory::SharedMemory>(handle);
+    } else {
+        auto transported = context->LoadShared<module::array_buffer_transport::TransportedArrayBuffer>(handle);
+        if (transported != nullptr) {
+            sharedMemory = transported->TakeMemory();
+        }
+    }
+
+    if (sharedMemory == nullptr) {
+        return nullptr;
+    }
+    return new napa_buffer { std::move(sharedMemory) };
+}
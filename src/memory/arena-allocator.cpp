@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <napa/memory/arena-allocator.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Alignment of all allocations, which suits any fundamental type. </summary>
+    constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+    size_t Align(size_t size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+}   // End of anonymous namespace.
+
+/// <summary> Header of a chunk, followed by its memory. </summary>
+struct ArenaAllocator::Chunk {
+    Chunk* next;
+    size_t size;
+};
+
+constexpr size_t ArenaAllocator::DEFAULT_CHUNK_SIZE;
+constexpr size_t ArenaAllocator::MAX_CHUNK_SIZE;
+
+ArenaAllocator::ArenaAllocator(Allocator& allocator, size_t chunkSize) :
+    _allocator(allocator),
+    _chunkSize(std::max<size_t>(chunkSize, ALIGNMENT)),
+    _nextChunkSize(_chunkSize) {
+}
+
+ArenaAllocator::~ArenaAllocator() {
+    FreeChunks(_chunks);
+}
+
+void ArenaAllocator::FreeChunks(Chunk* chunks) {
+    while (chunks != nullptr) {
+        auto next = chunks->next;
+        _allocator.Deallocate(chunks, Align(sizeof(Chunk)) + chunks->size);
+        chunks = next;
+    }
+}
+
+void* ArenaAllocator::Allocate(size_t size) {
+    size = Align(std::max<size_t>(size, 1));
+    _allocatedSize += size;
+
+    if (static_cast<size_t>(_end - _position) >= size) {
+        auto memory = _position;
+        _position += size;
+        return memory;
+    }
+    return AllocateChunk(size);
+}
+
+void* ArenaAllocator::AllocateChunk(size_t size) {
+    auto headerSize = Align(sizeof(Chunk));
+
+    // A large allocation gets a chunk of its own behind the latest one, which keeps being bumped.
+    if (size > _nextChunkSize / 2 && _chunks != nullptr) {
+        auto chunk = static_cast<Chunk*>(_allocator.Allocate(headerSize + size));
+        chunk->size = size;
+        chunk->next = _chunks->next;
+        _chunks->next = chunk;
+        return reinterpret_cast<char*>(chunk) + headerSize;
+    }
+
+    auto chunkSize = std::max(_nextChunkSize, size);
+    _nextChunkSize = std::min(_nextChunkSize * 2, std::max(MAX_CHUNK_SIZE, _chunkSize));
+
+    auto chunk = static_cast<Chunk*>(_allocator.Allocate(headerSize + chunkSize));
+    chunk->size = chunkSize;
+    chunk->next = _chunks;
+    _chunks = chunk;
+
+    auto memory = reinterpret_cast<char*>(chunk) + headerSize;
+    _position = memory + size;
+    _end = memory + chunkSize;
+    return memory;
+}
+
+void ArenaAllocator::Deallocate(void*, size_t) {
+}
+
+const char* ArenaAllocator::GetType() const {
+    return "ArenaAllocator";
+}
+
+bool ArenaAllocator::operator==(const Allocator& other) const {
+    return &other == this;
+}
+
+void ArenaAllocator::Reset() {
+    if (_chunks == nullptr) {
+        return;
+    }
+
+    // The latest chunk is the largest one bumped, so it's kept for the next round of allocations.
+    auto latest = _chunks;
+    FreeChunks(latest->next);
+
+    latest->next = nullptr;
+    _chunks = latest;
+    _position = reinterpret_cast<char*>(latest) + Align(sizeof(Chunk));
+    _end = _position + latest->size;
+    _allocatedSize = 0;
+}
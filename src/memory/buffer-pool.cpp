@@ -0,0 +1,306 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "buffer-pool.h"
+
+#include <platform/platform.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#if defined(OS_WINDOWS)
+#include <malloc.h>
+#elif defined(OS_MAC)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+#if defined(OS_LINUX)
+#include <sys/mman.h>
+#endif
+
+using namespace napa::memory;
+
+constexpr size_t BufferPool::MIN_POOLED_SIZE;
+constexpr size_t BufferPool::MAX_POOLED_SIZE;
+
+namespace {
+
+    /// <summary> MIN_POOLED_SIZE, then 4 classes per power of two up to MAX_POOLED_SIZE. </summary>
+    constexpr size_t CLASS_COUNT = 41;
+
+    /// <summary> Buffers a thread caches per size class. </summary>
+    constexpr size_t THREAD_CACHE_BLOCKS = 2;
+
+    /// <summary> Buffers from this size on are advised to be backed by huge pages, if enabled. </summary>
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    inline size_t GetClassSize(size_t sizeClass) {
+        if (sizeClass == 0) {
+            return BufferPool::MIN_POOLED_SIZE;
+        }
+        auto shift = 12 + (sizeClass - 1) / 4;
+        return (size_t(1) << shift) + ((sizeClass - 1) % 4 + 1) * (size_t(1) << (shift - 2));
+    }
+
+    /// <summary> Gets the smallest class holding a size between MIN_POOLED_SIZE and MAX_POOLED_SIZE. </summary>
+    inline size_t GetClassAbove(size_t size) {
+        if (size <= BufferPool::MIN_POOLED_SIZE) {
+            return 0;
+        }
+
+        size_t shift = 12;
+        while (((size - 1) >> (shift + 1)) != 0) {
+            ++shift;
+        }
+        return 1 + (shift - 12) * 4 + (((size - 1) >> (shift - 2)) & 3);
+    }
+
+    /// <summary> Gets the largest class fitting in a block of given usable size, which is at least MIN_POOLED_SIZE. </summary>
+    inline size_t GetClassBelow(size_t size) {
+        if (size >= BufferPool::MAX_POOLED_SIZE) {
+            return CLASS_COUNT - 1;
+        }
+        auto sizeClass = GetClassAbove(size);
+        return GetClassSize(sizeClass) > size ? sizeClass - 1 : sizeClass;
+    }
+
+    /// <summary> Gets the usable size of a block from ::malloc, which may be larger than requested. </summary>
+    inline size_t GetUsableSize(void* block) {
+#if defined(OS_WINDOWS)
+        return _msize(block);
+#elif defined(OS_MAC)
+        return malloc_size(block);
+#else
+        return malloc_usable_size(block);
+#endif
+    }
+
+    /// <summary> Advises the OS to back a block with huge pages, where supported. </summary>
+    inline void AdviseHugePages(void* block, size_t size) {
+#if defined(OS_LINUX) && defined(MADV_HUGEPAGE)
+        const uintptr_t pageMask = 4096 - 1;
+        auto begin = (reinterpret_cast<uintptr_t>(block) + pageMask) & ~pageMask;
+        auto end = (reinterpret_cast<uintptr_t>(block) + size) & ~pageMask;
+        if (end > begin) {
+            ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+        }
+#else
+        (void)block;
+        (void)size;
+#endif
+    }
+
+    /// <summary> Buffers cached by a thread, trivially destructible so they stay accessible during thread exit. </summary>
+    struct ThreadCache {
+        void* blocks[CLASS_COUNT][THREAD_CACHE_BLOCKS];
+        uint8_t counts[CLASS_COUNT];
+
+        /// <summary> Whether the cache is registered to be flushed on thread exit. </summary>
+        bool registered;
+
+        /// <summary> Whether the cache was flushed on thread exit, later releases of the thread go to central lists. </summary>
+        bool released;
+    };
+
+    thread_local ThreadCache _threadCache;
+
+    /// <summary> Flushes the thread cache on thread exit. </summary>
+    struct ThreadCacheOwner {
+        ~ThreadCacheOwner() {
+            BufferPool::GetInstance().FlushThreadCache();
+            _threadCache.released = true;
+        }
+    };
+
+    /// <summary> Gets the cache of the calling thread, or nullptr once the thread is exiting. </summary>
+    ThreadCache* GetThreadCache() {
+        auto& cache = _threadCache;
+        if (!cache.registered) {
+            static thread_local ThreadCacheOwner owner;
+            (void)owner;
+            cache.registered = true;
+        }
+        return cache.released ? nullptr : &cache;
+    }
+
+}   // End of anonymous namespace.
+
+BufferPool& BufferPool::GetInstance() {
+    // Never destroyed, since buffers may be released during process exit.
+    static BufferPool* bufferPool = new BufferPool();
+    return *bufferPool;
+}
+
+BufferPool::BufferPool() :
+    _centralLists(CLASS_COUNT),
+    _capacity(0),
+    _hugePages(false),
+    _pooledSize(0),
+    _allocateCount(0),
+    _reuseCount(0),
+    _deallocateCount(0),
+    _freeCount(0),
+    _zeroedSize(0) {
+}
+
+void BufferPool::Configure(size_t capacity, bool hugePages) {
+    _capacity = capacity;
+    _hugePages = hugePages;
+    if (capacity == 0) {
+        FlushThreadCache();
+        Trim();
+    }
+}
+
+bool BufferPool::IsEnabled() const {
+    return _capacity.load(std::memory_order_relaxed) > 0;
+}
+
+void* BufferPool::Allocate(size_t size) {
+    return Acquire(size, false);
+}
+
+void* BufferPool::AllocateZeroed(size_t size) {
+    return Acquire(size, true);
+}
+
+void* BufferPool::Acquire(size_t size, bool zeroed) {
+    _allocateCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (!IsEnabled() || size < MIN_POOLED_SIZE || size > MAX_POOLED_SIZE) {
+        return zeroed ? std::calloc(1, size) : std::malloc(size);
+    }
+
+    auto sizeClass = GetClassAbove(size);
+    auto classSize = GetClassSize(sizeClass);
+
+    void* block = nullptr;
+    auto cache = GetThreadCache();
+    if (cache != nullptr && cache->counts[sizeClass] > 0) {
+        block = cache->blocks[sizeClass][--cache->counts[sizeClass]];
+    } else {
+        auto& central = _centralLists[sizeClass];
+        std::lock_guard<std::mutex> lock(central.lock);
+        if (!central.blocks.empty()) {
+            block = central.blocks.back();
+            central.blocks.pop_back();
+        }
+    }
+
+    if (block != nullptr) {
+        _reuseCount.fetch_add(1, std::memory_order_relaxed);
+        _pooledSize.fetch_sub(classSize, std::memory_order_relaxed);
+
+        // Only buffers that V8 doesn't fill up by itself are zeroed.
+        if (zeroed) {
+            std::memset(block, 0, size);
+            _zeroedSize.fetch_add(size, std::memory_order_relaxed);
+        }
+        return block;
+    }
+
+    // A fresh block of the class size, so it can be pooled as such once released.
+    block = zeroed ? std::calloc(1, classSize) : std::malloc(classSize);
+    if (block != nullptr && classSize >= HUGE_PAGE_SIZE && _hugePages.load(std::memory_order_relaxed)) {
+        AdviseHugePages(block, classSize);
+    }
+    return block;
+}
+
+void BufferPool::Deallocate(void* memory, size_t /*sizeHint*/) {
+    if (memory == nullptr) {
+        return;
+    }
+    _deallocateCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Blocks much larger than the largest class would waste their tail, they are freed instead.
+    auto usableSize = GetUsableSize(memory);
+    if (!IsEnabled() || usableSize < MIN_POOLED_SIZE || usableSize >= MAX_POOLED_SIZE + MAX_POOLED_SIZE / 4) {
+        _freeCount.fetch_add(1, std::memory_order_relaxed);
+        std::free(memory);
+        return;
+    }
+
+    auto sizeClass = GetClassBelow(usableSize);
+    auto classSize = GetClassSize(sizeClass);
+    if (_pooledSize.fetch_add(classSize, std::memory_order_relaxed) + classSize > _capacity.load(std::memory_order_relaxed)) {
+        _pooledSize.fetch_sub(classSize, std::memory_order_relaxed);
+        _freeCount.fetch_add(1, std::memory_order_relaxed);
+        std::free(memory);
+        return;
+    }
+
+    auto cache = GetThreadCache();
+    if (cache != nullptr && cache->counts[sizeClass] < THREAD_CACHE_BLOCKS) {
+        cache->blocks[sizeClass][cache->counts[sizeClass]++] = memory;
+        return;
+    }
+    Release(sizeClass, memory);
+}
+
+void BufferPool::Release(size_t sizeClass, void* block) {
+    auto& central = _centralLists[sizeClass];
+    std::lock_guard<std::mutex> lock(central.lock);
+    central.blocks.push_back(block);
+}
+
+const char* BufferPool::GetType() const {
+    return "BufferPool";
+}
+
+bool BufferPool::operator==(const Allocator& other) const {
+    return &other == this;
+}
+
+std::string BufferPool::GetDebugInfo() const {
+    std::stringstream stream;
+    stream << "{ "
+        << "\"allocate\": " << _allocateCount
+        << ", "
+        << "\"reuse\": " << _reuseCount
+        << ", "
+        << "\"deallocate\": " << _deallocateCount
+        << ", "
+        << "\"free\": " << _freeCount
+        << ", "
+        << "\"pooledSize\": " << _pooledSize
+        << ", "
+        << "\"zeroedSize\": " << _zeroedSize
+        << ", "
+        << "\"capacity\": " << _capacity
+        << " }";
+    return stream.str();
+}
+
+void BufferPool::FlushThreadCache() {
+    auto& cache = _threadCache;
+    for (size_t sizeClass = 0; sizeClass < CLASS_COUNT; ++sizeClass) {
+        while (cache.counts[sizeClass] > 0) {
+            Release(sizeClass, cache.blocks[sizeClass][--cache.counts[sizeClass]]);
+        }
+    }
+}
+
+void BufferPool::Trim() {
+    for (size_t sizeClass = 0; sizeClass < CLASS_COUNT; ++sizeClass) {
+        std::vector<void*> blocks;
+        {
+            auto& central = _centralLists[sizeClass];
+            std::lock_guard<std::mutex> lock(central.lock);
+            blocks.swap(central.blocks);
+        }
+        for (auto block : blocks) {
+            std::free(block);
+        }
+        _pooledSize.fetch_sub(blocks.size() * GetClassSize(sizeClass), std::memory_order_relaxed);
+        _freeCount.fetch_add(blocks.size(), std::memory_order_relaxed);
+    }
+}
+
+size_t BufferPool::GetPooledSize() const {
+    return _pooledSize.load(std::memory_order_relaxed);
+}
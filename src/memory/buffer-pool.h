@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/memory/allocator-debugger.h>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace memory {
+
+    /// <summary> Process-wide pool of released ArrayBuffer contents, reused by later ArrayBuffers of a similar size. </summary>
+    /// <remarks>
+    ///     Buffers between MIN_POOLED_SIZE and MAX_POOLED_SIZE are rounded up to one of 4 size classes per power of two.
+    ///     A released buffer goes to the releasing thread's cache first, which holds a few buffers per class, then to the
+    ///     central list of its class, as long as all pooled buffers fit in the capacity. Beyond it, buffers are freed.
+    ///     Each buffer is a block from ::malloc of its class size, since ArrayBuffers transported across isolates are
+    ///     released by other owners with std::free. Conversely, released blocks that didn't come from the pool are pooled by
+    ///     their usable size. Zeroing is left to AllocateZeroed, fresh blocks come zeroed from ::calloc.
+    ///     It's exposed in napa.dll, so Node and Napa isolates share the same instance.
+    /// </remarks>
+    class NAPA_API BufferPool : public AllocatorDebugger {
+    public:
+        /// <summary> Smallest buffer worth pooling, smaller ones are cheap enough to get from ::malloc. </summary>
+        static constexpr size_t MIN_POOLED_SIZE = 4 * 1024;
+
+        /// <summary> Largest buffer that is pooled. </summary>
+        static constexpr size_t MAX_POOLED_SIZE = 4 * 1024 * 1024;
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static BufferPool& GetInstance();
+
+        /// <summary> Sets the total size of buffers the pool may hold, 0 to disable pooling, and whether large buffers are backed by huge pages. </summary>
+        void Configure(size_t capacity, bool hugePages);
+
+        /// <summary> Whether pooling is enabled. </summary>
+        bool IsEnabled() const;
+
+        /// <summary> Allocates a buffer whose content is undefined. </summary>
+        void* Allocate(size_t size) override;
+
+        /// <summary> Allocates a buffer filled with zeros. </summary>
+        void* AllocateZeroed(size_t size);
+
+        /// <summary> Releases a buffer allocated from the pool or ::malloc, on any thread. The size hint is not needed. </summary>
+        void Deallocate(void* memory, size_t sizeHint) override;
+
+        const char* GetType() const override;
+        bool operator==(const Allocator& other) const override;
+
+        /// <summary> Gets counts of allocations served from the pool or not, releases kept or freed, and sizes pooled and zeroed, in JSON. </summary>
+        std::string GetDebugInfo() const override;
+
+        /// <summary> Returns buffers cached by the calling thread to the central lists. </summary>
+        void FlushThreadCache();
+
+        /// <summary> Frees all buffers of the central lists. </summary>
+        void Trim();
+
+        /// <summary> Gets the total size of buffers held by the pool, including thread caches. </summary>
+        size_t GetPooledSize() const;
+
+    private:
+        BufferPool();
+
+        /// <summary> Gets a buffer of at least given size, from the pool if possible. </summary>
+        void* Acquire(size_t size, bool zeroed);
+
+        /// <summary> Puts a block to the central list of its class, or frees it if the pool is full. </summary>
+        void Release(size_t sizeClass, void* block);
+
+        /// <summary> Buffers of a size class shared by all threads. </summary>
+        struct CentralList {
+            std::mutex lock;
+            std::vector<void*> blocks;
+        };
+
+        std::vector<CentralList> _centralLists;
+
+        std::atomic<size_t> _capacity;
+        std::atomic<bool> _hugePages;
+        std::atomic<size_t> _pooledSize;
+
+        std::atomic<uint64_t> _allocateCount;
+        std::atomic<uint64_t> _reuseCount;
+        std::atomic<uint64_t> _deallocateCount;
+        std::atomic<uint64_t> _freeCount;
+        std::atomic<uint64_t> _zeroedSize;
+    };
+}
+}
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include "thread-caching-allocator.h"
+
 #include <napa/memory.h>
 #include <napa/capi.h>
 #include <cstring>
@@ -63,6 +65,35 @@ public:
     }
 };
 
+/// <summary> Size-class allocator with per thread caches of free blocks. </summary>
+class ThreadCachingAllocator: public napa::memory::Allocator {
+public:
+    /// <summary> Allocate memory of given size. </summary>
+    /// <param name="size"> Requested size. </summary>
+    /// <returns> Allocated memory. May throw if error happens. </returns>
+    void* Allocate(size_t size) override {
+        return napa::memory::thread_caching::Allocate(size);
+    }
+
+    /// <summary> Deallocate memory allocated from this allocator. </summary>
+    /// <param name="memory"> Pointer to the memory. </summary>
+    /// <param name="sizeHint"> Hint of size to delete. 0 if not available from caller. </summary>
+    /// <returns> None. May throw if error happens. </returns>
+    void Deallocate(void* memory, size_t sizeHint) override {
+        napa::memory::thread_caching::Deallocate(memory, sizeHint);
+    }
+
+    /// <summary> Get allocator type for better debuggability. </summary>
+    const char* GetType() const override {
+        return "ThreadCachingAllocator";
+    }
+
+    /// <summary> Tell if another allocator equals to this allocator. </summary>
+    bool operator==(const Allocator& other) const override {
+        return std::strcmp(other.GetType(), GetType()) == 0;
+    }
+};
+
 namespace napa {
 namespace memory {
 
@@ -70,6 +101,7 @@ namespace memory {
         // Never destory to ensure they live longer than all consumers.
         auto _crtAllocator = new CrtAllocator();
         auto _defaultAllocator = new DefaultAllocator();
+        auto _threadCachingAllocator = new ThreadCachingAllocator();
     }
 
     Allocator& GetCrtAllocator() {
@@ -79,5 +111,9 @@ namespace memory {
     Allocator& GetDefaultAllocator() {
         return *_defaultAllocator;
     }
+
+    Allocator& GetThreadCachingAllocator() {
+        return *_threadCachingAllocator;
+    }
 } // namespace memory
 } // namespace napa
\ No newline at end of file
@@ -0,0 +1,334 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <napa/memory/histogram-allocator-debugger.h>
+
+#include <napa/assert.h>
+#include <platform/platform.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#ifdef SUPPORT_POSIX
+#include <execinfo.h>
+#else
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+using namespace napa::memory;
+
+constexpr size_t HistogramAllocatorDebugger::BUCKET_COUNT;
+constexpr size_t HistogramAllocatorDebugger::MAX_SITES;
+constexpr size_t HistogramAllocatorDebugger::MAX_FRAMES;
+
+namespace {
+
+    /// <summary> Prefix of each allocation, which keeps payloads 16-byte aligned. </summary>
+    struct alignas(16) Header {
+        uint64_t size;
+        uint32_t site;
+
+        /// <summary> HEADER_MAGIC, with SAMPLED_FLAG if the allocation is sampled. </summary>
+        uint32_t flags;
+    };
+
+    static_assert(sizeof(Header) == 16, "Header must keep payloads 16-byte aligned");
+
+    constexpr uint32_t HEADER_MAGIC = 0x4e415000;
+    constexpr uint32_t SAMPLED_FLAG = 1;
+
+    /// <summary> Marks a site slot being claimed, until its line is set. </summary>
+    const char* const CLAIMING_SITE = reinterpret_cast<const char*>(1);
+
+    /// <summary> Call site of the allocation in progress on this thread, set by AllocateAt. </summary>
+    thread_local const char* _siteFile = nullptr;
+    thread_local int _siteLine = 0;
+
+    /// <summary> Sets the call site of allocations made in its scope. </summary>
+    class SiteScope {
+    public:
+        SiteScope(const char* file, int line) {
+            _siteFile = file;
+            _siteLine = line;
+        }
+
+        ~SiteScope() {
+            _siteFile = nullptr;
+        }
+    };
+
+    /// <summary> Gets the bucket of sizes up to the next power of two. </summary>
+    inline size_t GetBucket(size_t size) {
+        size_t bucket = 0;
+        while (bucket + 1 < HistogramAllocatorDebugger::BUCKET_COUNT && (size_t(1) << bucket) < size) {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    /// <summary> Captures frames of the calling thread's stack, skipping the allocator's own. </summary>
+    std::vector<void*> CaptureStack() {
+        void* frames[HistogramAllocatorDebugger::MAX_FRAMES + 2];
+#ifdef SUPPORT_POSIX
+        auto count = ::backtrace(frames, static_cast<int>(HistogramAllocatorDebugger::MAX_FRAMES + 2));
+#else
+        auto count = ::CaptureStackBackTrace(0, static_cast<DWORD>(HistogramAllocatorDebugger::MAX_FRAMES + 2), frames, nullptr);
+#endif
+        auto skipped = std::min(static_cast<int>(count), 2);
+        return std::vector<void*>(frames + skipped, frames + count);
+    }
+
+    /// <summary> Gets printable frames, symbolized where the platform supports it. </summary>
+    std::vector<std::string> SymbolizeStack(const std::vector<void*>& frames) {
+        std::vector<std::string> symbols;
+#ifdef SUPPORT_POSIX
+        auto names = ::backtrace_symbols(frames.data(), static_cast<int>(frames.size()));
+        if (names != nullptr) {
+            symbols.assign(names, names + frames.size());
+            std::free(names);
+            return symbols;
+        }
+#endif
+        for (auto frame : frames) {
+            std::stringstream stream;
+            stream << frame;
+            symbols.emplace_back(stream.str());
+        }
+        return symbols;
+    }
+
+    /// <summary> Writes a string as a JSON string literal. </summary>
+    void WriteJsonString(std::ostream& stream, const std::string& value) {
+        stream << '"';
+        for (auto c : value) {
+            if (c == '"' || c == '\\') {
+                stream << '\\' << c;
+            } else if (static_cast<unsigned char>(c) >= 0x20) {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+
+}   // End of anonymous namespace.
+
+void* napa::memory::AllocateAt(Allocator& allocator, size_t size, const char* file, int line) {
+    SiteScope scope(file, line);
+    return allocator.Allocate(size);
+}
+
+HistogramAllocatorDebugger::HistogramAllocatorDebugger(std::shared_ptr<Allocator> allocator, uint32_t sampleRate) :
+    _allocator(std::move(allocator)),
+    _sampleRate(sampleRate),
+    _allocateCount(0),
+    _deallocateCount(0),
+    _allocatedSize(0),
+    _deallocatedSize(0),
+    _liveSize(0),
+    _peakLiveSize(0),
+    _sites(new Site[MAX_SITES]) {
+
+    for (auto& count : _histogram) {
+        count = 0;
+    }
+
+    std::stringstream stream;
+    stream << "HistogramAllocatorDebugger<" << _allocator->GetType() << ">";
+    _typeName = stream.str();
+}
+
+uint32_t HistogramAllocatorDebugger::FindSite(const char* file, int line) {
+    if (file == nullptr) {
+        return 0;
+    }
+
+    auto hash = (reinterpret_cast<uintptr_t>(file) >> 4) ^ (static_cast<uintptr_t>(line) * 0x9e3779b1u);
+    for (size_t probe = 0; probe < MAX_SITES - 1; ++probe) {
+        auto index = static_cast<uint32_t>(1 + (hash + probe) % (MAX_SITES - 1));
+        auto& site = _sites[index];
+
+        auto current = site.file.load(std::memory_order_acquire);
+        if (current == nullptr) {
+            if (site.file.compare_exchange_strong(current, CLAIMING_SITE, std::memory_order_acq_rel)) {
+                site.line.store(line, std::memory_order_relaxed);
+                site.file.store(file, std::memory_order_release);
+                return index;
+            }
+        }
+
+        // The line of a slot being claimed is set right after, by the claiming thread.
+        while (current == CLAIMING_SITE) {
+            std::this_thread::yield();
+            current = site.file.load(std::memory_order_acquire);
+        }
+        if (current == file && site.line.load(std::memory_order_relaxed) == line) {
+            return index;
+        }
+    }
+    return 0;
+}
+
+void* HistogramAllocatorDebugger::Allocate(size_t size) {
+    auto site = FindSite(_siteFile, _siteLine);
+
+    auto header = static_cast<Header*>(_allocator->Allocate(sizeof(Header) + size));
+    if (header == nullptr) {
+        return nullptr;
+    }
+    header->size = size;
+    header->site = site;
+    header->flags = HEADER_MAGIC;
+
+    auto count = _allocateCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    _allocatedSize.fetch_add(size, std::memory_order_relaxed);
+    _histogram[GetBucket(size)].fetch_add(1, std::memory_order_relaxed);
+    _sites[site].allocateCount.fetch_add(1, std::memory_order_relaxed);
+    _sites[site].liveSize.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+
+    auto liveSize = _liveSize.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+    auto peakLiveSize = _peakLiveSize.load(std::memory_order_relaxed);
+    while (liveSize > peakLiveSize && !_peakLiveSize.compare_exchange_weak(peakLiveSize, liveSize, std::memory_order_relaxed)) {
+    }
+
+    auto memory = header + 1;
+    if (_sampleRate > 0 && count % _sampleRate == 0) {
+        header->flags |= SAMPLED_FLAG;
+        AddSample(memory, size, site);
+    }
+    return memory;
+}
+
+void HistogramAllocatorDebugger::AddSample(void* memory, size_t size, uint32_t site) {
+    Sample sample { size, site, CaptureStack() };
+
+    std::lock_guard<std::mutex> lock(_samplesLock);
+    _samples[memory] = std::move(sample);
+}
+
+void HistogramAllocatorDebugger::Deallocate(void* memory, size_t /*sizeHint*/) {
+    if (memory == nullptr) {
+        return;
+    }
+
+    auto header = static_cast<Header*>(memory) - 1;
+    NAPA_ASSERT((header->flags & ~SAMPLED_FLAG) == HEADER_MAGIC, "Memory was not allocated by this allocator debugger");
+
+    auto size = header->size;
+    _deallocateCount.fetch_add(1, std::memory_order_relaxed);
+    _deallocatedSize.fetch_add(size, std::memory_order_relaxed);
+    _liveSize.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    _sites[header->site].liveSize.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+
+    if ((header->flags & SAMPLED_FLAG) != 0) {
+        std::lock_guard<std::mutex> lock(_samplesLock);
+        _samples.erase(memory);
+    }
+    _allocator->Deallocate(header, sizeof(Header) + size);
+}
+
+const char* HistogramAllocatorDebugger::GetType() const {
+    return _typeName.c_str();
+}
+
+bool HistogramAllocatorDebugger::operator==(const Allocator& other) const {
+    return &other == this;
+}
+
+size_t HistogramAllocatorDebugger::GetLiveSize() const {
+    return static_cast<size_t>(std::max<int64_t>(_liveSize.load(std::memory_order_relaxed), 0));
+}
+
+size_t HistogramAllocatorDebugger::GetPeakLiveSize() const {
+    return static_cast<size_t>(_peakLiveSize.load(std::memory_order_relaxed));
+}
+
+std::string HistogramAllocatorDebugger::GetDebugInfo() const {
+    std::stringstream stream;
+    stream << "{ "
+        << "\"allocate\": " << _allocateCount
+        << ", "
+        << "\"deallocate\": " << _deallocateCount
+        << ", "
+        << "\"allocatedSize\": " << _allocatedSize
+        << ", "
+        << "\"deallocatedSize\": " << _deallocatedSize
+        << ", "
+        << "\"liveSize\": " << GetLiveSize()
+        << ", "
+        << "\"peakLiveSize\": " << GetPeakLiveSize();
+
+    // Buckets are named by the largest size they hold, empty ones are left out.
+    stream << ", \"histogram\": {";
+    auto first = true;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        auto count = _histogram[bucket].load(std::memory_order_relaxed);
+        if (count > 0) {
+            stream << (first ? " " : ", ") << '"' << (size_t(1) << bucket) << (bucket + 1 == BUCKET_COUNT ? "+" : "") << "\": " << count;
+            first = false;
+        }
+    }
+    stream << " }";
+
+    // Sites with the same name may have several slots, as string literals of different modules differ.
+    std::map<std::string, std::pair<uint64_t, int64_t>> sites;
+    std::vector<std::string> siteNames(MAX_SITES);
+    siteNames[0] = "unknown";
+    for (size_t index = 0; index < MAX_SITES; ++index) {
+        auto& site = _sites[index];
+        if (index > 0) {
+            auto file = site.file.load(std::memory_order_acquire);
+            if (file == nullptr || file == CLAIMING_SITE) {
+                continue;
+            }
+            siteNames[index] = std::string(file) + ":" + std::to_string(site.line.load(std::memory_order_relaxed));
+        }
+
+        auto allocateCount = site.allocateCount.load(std::memory_order_relaxed);
+        if (allocateCount > 0) {
+            auto& counters = sites[siteNames[index]];
+            counters.first += allocateCount;
+            counters.second += site.liveSize.load(std::memory_order_relaxed);
+        }
+    }
+
+    stream << ", \"sites\": [";
+    first = true;
+    for (auto& site : sites) {
+        stream << (first ? " " : ", ") << "{ \"site\": ";
+        WriteJsonString(stream, site.first);
+        stream << ", \"allocate\": " << site.second.first << ", \"liveSize\": " << std::max<int64_t>(site.second.second, 0) << " }";
+        first = false;
+    }
+    stream << " ]";
+
+    std::vector<Sample> samples;
+    {
+        std::lock_guard<std::mutex> lock(_samplesLock);
+        for (auto& sample : _samples) {
+            samples.push_back(sample.second);
+        }
+    }
+
+    stream << ", \"samples\": [";
+    first = true;
+    for (auto& sample : samples) {
+        stream << (first ? " " : ", ") << "{ \"size\": " << sample.size << ", \"site\": ";
+        WriteJsonString(stream, siteNames[sample.site]);
+        stream << ", \"stack\": [";
+        auto firstFrame = true;
+        for (auto& frame : SymbolizeStack(sample.frames)) {
+            stream << (firstFrame ? " " : ", ");
+            WriteJsonString(stream, frame);
+            firstFrame = false;
+        }
+        stream << " ] }";
+        first = false;
+    }
+    stream << " ] }";
+
+    return stream.str();
+}
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "shared-memory.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Shared memory by address. </summary>
+    class SharedMemoryRegistry {
+    public:
+        static SharedMemoryRegistry& GetInstance() {
+            static SharedMemoryRegistry registry;
+            return registry;
+        }
+
+        std::shared_ptr<SharedMemory> Find(const void* data) {
+            std::lock_guard<std::mutex> lock(_lock);
+            auto it = _memories.find(data);
+            return it != _memories.end() ? it->second.lock() : nullptr;
+        }
+
+        void Add(const void* data, const std::shared_ptr<SharedMemory>& memory) {
+            std::lock_guard<std::mutex> lock(_lock);
+            _memories[data] = memory;
+        }
+
+        void Remove(const void* data) {
+            // The address may be reused by memory adopted since the last reference went away.
+            std::lock_guard<std::mutex> lock(_lock);
+            auto it = _memories.find(data);
+            if (it != _memories.end() && it->second.expired()) {
+                _memories.erase(it);
+            }
+        }
+
+    private:
+        std::unordered_map<const void*, std::weak_ptr<SharedMemory>> _memories;
+        std::mutex _lock;
+    };
+
+    class SharedMemoryImpl : public SharedMemory {
+    public:
+        SharedMemoryImpl(void* data, size_t length) : _data(data), _length(length) {
+        }
+
+        void* GetData() const override {
+            return _data;
+        }
+
+        size_t GetLength() const override {
+            return _length;
+        }
+
+        ~SharedMemoryImpl() {
+            SharedMemoryRegistry::GetInstance().Remove(_data);
+            std::free(_data);
+        }
+
+    private:
+        void* _data;
+        size_t _length;
+    };
+
+    class AllocatedSharedMemory : public SharedMemory {
+    public:
+        AllocatedSharedMemory(std::shared_ptr<Allocator> allocator, void* data, size_t length) :
+            _allocator(std::move(allocator)), _data(data), _length(length) {
+        }
+
+        void* GetData() const override {
+            return _data;
+        }
+
+        size_t GetLength() const override {
+            return _length;
+        }
+
+        ~AllocatedSharedMemory() {
+            SharedMemoryRegistry::GetInstance().Remove(_data);
+            _allocator->Deallocate(_data, _length);
+        }
+
+    private:
+        std::shared_ptr<Allocator> _allocator;
+        void* _data;
+        size_t _length;
+    };
+}
+
+std::shared_ptr<SharedMemory> napa::memory::AdoptSharedMemory(void* data, size_t length) {
+    auto memory = std::make_shared<SharedMemoryImpl>(data, length);
+    SharedMemoryRegistry::GetInstance().Add(data, memory);
+    return memory;
+}
+
+std::shared_ptr<SharedMemory> napa::memory::AllocateSharedMemory(std::shared_ptr<Allocator> allocator, size_t length) {
+    auto data = allocator->Allocate(length);
+    if (data == nullptr) {
+        return nullptr;
+    }
+    auto memory = std::make_shared<AllocatedSharedMemory>(std::move(allocator), data, length);
+    SharedMemoryRegistry::GetInstance().Add(data, memory);
+    return memory;
+}
+
+std::shared_ptr<SharedMemory> napa::memory::FindSharedMemory(const void* data) {
+    return SharedMemoryRegistry::GetInstance().Find(data);
+}
@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/memory/allocator.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace napa {
+namespace memory {
+
+    /// <summary> Memory shared by SharedArrayBuffers across isolates, freed when the last reference goes away. </summary>
+    /// <remarks> 
+    ///     SharedMemory is intended to be used by TransportContextWrap. 
+    ///     We expose SharedMemory in napa.dll instead of napa-binding, so Napa and Node.JS find memory shared by each other.
+    /// </remarks>
+    class SharedMemory {
+    public:
+        /// <summary> Get address of the memory. </summary>
+        virtual void* GetData() const = 0;
+
+        /// <summary> Get size of the memory in bytes. </summary>
+        virtual size_t GetLength() const = 0;
+
+        /// <summary> Destructor, which frees the memory. </summary>
+        virtual ~SharedMemory() = default;
+    };
+
+    /// <summary> Take ownership of memory allocated from the C heap, to share it across isolates. </summary>
+    /// <param name="data"> Address of the memory, which is freed with std::free. </param>
+    /// <param name="length"> Size of the memory in bytes. </param>
+    NAPA_API std::shared_ptr<SharedMemory> AdoptSharedMemory(void* data, size_t length);
+
+    /// <summary> Allocate memory from an allocator, to share it across isolates. </summary>
+    /// <param name="allocator"> Allocator of the memory, which is kept until the memory is deallocated through it. </param>
+    /// <param name="length"> Size of the memory in bytes. </param>
+    /// <returns> Shared memory, or nullptr if the allocator failed. </returns>
+    NAPA_API std::shared_ptr<SharedMemory> AllocateSharedMemory(std::shared_ptr<Allocator> allocator, size_t length);
+
+    /// <summary> Find shared memory by its address. </summary>
+    /// <returns> Shared memory, or empty if no shared memory is at given address. </returns>
+    NAPA_API std::shared_ptr<SharedMemory> FindSharedMemory(const void* data);
+}
+}
@@ -0,0 +1,16 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "thread-allocation-counters.h"
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Zero initialized and trivially destructible, so it takes no TLS initialization on first access. </summary>
+    thread_local ThreadAllocationCounters _threadCounters;
+}
+
+ThreadAllocationCounters& napa::memory::GetThreadAllocationCounters() {
+    return _threadCounters;
+}
@@ -0,0 +1,24 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace napa {
+namespace memory {
+
+    /// <summary> Counts of napa_allocate and napa_deallocate calls made by a thread, since the thread started. </summary>
+    /// <remarks> Deallocated sizes are the size hints of callers, which may be 0 if they don't know the size. </remarks>
+    struct ThreadAllocationCounters {
+        uint64_t allocateCount;
+        uint64_t allocatedSize;
+        uint64_t deallocateCount;
+        uint64_t deallocatedSize;
+    };
+
+    /// <summary> Gets the counters of the calling thread. </summary>
+    ThreadAllocationCounters& GetThreadAllocationCounters();
+}
+}
@@ -0,0 +1,284 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "thread-caching-allocator.h"
+
+#include <napa/assert.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Prefix of each block, which keeps payloads aligned like max_align_t. </summary>
+    struct alignas(16) BlockHeader {
+        /// <summary> Size class of the block, LARGE_CLASS for blocks from ::malloc. </summary>
+        uint32_t sizeClass;
+
+        /// <summary> Tells blocks of this allocator, to catch memory released to the wrong allocator. </summary>
+        uint32_t magic;
+
+        /// <summary> Next free block, while the block is in a free list. </summary>
+        BlockHeader* next;
+    };
+
+    static_assert(sizeof(BlockHeader) == 16, "Block header must keep payloads 16-byte aligned");
+    static_assert(alignof(std::max_align_t) <= 16, "Block header must keep payloads aligned like max_align_t");
+
+    constexpr uint32_t BLOCK_MAGIC = 0x4e415041;
+    constexpr uint32_t LARGE_CLASS = 0xffffffff;
+
+    /// <summary> 8 classes of 16 bytes steps up to 128 bytes, then 4 classes per power of two up to MAX_SMALL_SIZE. </summary>
+    constexpr size_t CLASS_COUNT = 40;
+
+    /// <summary> Size of the spans that central lists carve blocks from. </summary>
+    constexpr size_t SPAN_SIZE = 64 * 1024;
+
+    /// <summary> Bytes moved at once between a thread cache and a central list. </summary>
+    constexpr size_t BATCH_BYTES = 16 * 1024;
+
+    /// <summary> Block size and batch size by size class. </summary>
+    struct ClassTable {
+        size_t sizes[CLASS_COUNT];
+        uint32_t batches[CLASS_COUNT];
+
+        constexpr ClassTable() : sizes(), batches() {
+            for (size_t c = 0; c < CLASS_COUNT; ++c) {
+                if (c < 8) {
+                    sizes[c] = (c + 1) * 16;
+                } else {
+                    auto shift = 7 + (c - 8) / 4;
+                    sizes[c] = (size_t(1) << shift) + ((c - 8) % 4 + 1) * (size_t(1) << (shift - 2));
+                }
+                auto batch = BATCH_BYTES / (sizes[c] + sizeof(BlockHeader));
+                batches[c] = static_cast<uint32_t>(batch < 2 ? 2 : (batch > 64 ? 64 : batch));
+            }
+        }
+    };
+
+    constexpr ClassTable CLASSES;
+
+    static_assert(CLASSES.sizes[CLASS_COUNT - 1] == thread_caching::MAX_SMALL_SIZE, "Size classes must end at MAX_SMALL_SIZE");
+
+    /// <summary> Gets the size class of a request up to MAX_SMALL_SIZE. </summary>
+    inline size_t GetSizeClass(size_t size) {
+        if (size <= 128) {
+            return size == 0 ? 0 : (size - 1) >> 4;
+        }
+
+        size_t shift = 7;
+        while (((size - 1) >> (shift + 1)) != 0) {
+            ++shift;
+        }
+        return 8 + (shift - 7) * 4 + (((size - 1) >> (shift - 2)) & 3);
+    }
+
+    /// <summary> Free blocks of a size class shared by all threads. </summary>
+    struct CentralList {
+        std::mutex lock;
+        BlockHeader* head = nullptr;
+        size_t count = 0;
+
+        /// <summary> Keeps lists of different classes off the same cache line. </summary>
+        char padding[64];
+    };
+
+    /// <summary> Gets the central lists, which are never destroyed since threads may release blocks during process exit. </summary>
+    CentralList* GetCentralLists() {
+        static CentralList* lists = new CentralList[CLASS_COUNT];
+        return lists;
+    }
+
+    /// <summary> Free blocks of a size class cached by a thread. </summary>
+    struct FreeList {
+        BlockHeader* head;
+        uint32_t count;
+    };
+
+    /// <summary> Caches of a thread, trivially destructible so they stay accessible during thread exit. </summary>
+    struct ThreadCache {
+        FreeList lists[CLASS_COUNT];
+
+        /// <summary> Whether the cache is registered to be flushed on thread exit. </summary>
+        bool registered;
+
+        /// <summary> Whether the cache was flushed on thread exit, later requests of the thread go to central lists. </summary>
+        bool released;
+    };
+
+    thread_local ThreadCache _threadCache;
+
+    /// <summary> Flushes the thread cache on thread exit. </summary>
+    struct ThreadCacheOwner {
+        ~ThreadCacheOwner() {
+            thread_caching::FlushThreadCache();
+            _threadCache.released = true;
+        }
+    };
+
+    /// <summary> Gets the cache of the calling thread, or nullptr once the thread is exiting. </summary>
+    ThreadCache* GetThreadCache() {
+        auto& cache = _threadCache;
+        if (!cache.registered) {
+            static thread_local ThreadCacheOwner owner;
+            (void)owner;
+            cache.registered = true;
+        }
+        return cache.released ? nullptr : &cache;
+    }
+
+    /// <summary> Takes up to count blocks from the central list of a class, carving a new span if it's empty. </summary>
+    /// <returns> Chain of blocks linked by next, nullptr if out of memory. </returns>
+    BlockHeader* TakeBlocks(size_t sizeClass, uint32_t count, uint32_t& taken) {
+        auto& central = GetCentralLists()[sizeClass];
+        std::lock_guard<std::mutex> lock(central.lock);
+
+        if (central.head == nullptr) {
+            auto blockSize = CLASSES.sizes[sizeClass] + sizeof(BlockHeader);
+            auto blocks = std::max(SPAN_SIZE, blockSize * CLASSES.batches[sizeClass]) / blockSize;
+            auto span = static_cast<char*>(::malloc(blocks * blockSize));
+            if (span == nullptr) {
+                taken = 0;
+                return nullptr;
+            }
+
+            for (size_t i = blocks; i-- > 0; ) {
+                auto block = reinterpret_cast<BlockHeader*>(span + i * blockSize);
+                block->sizeClass = static_cast<uint32_t>(sizeClass);
+                block->magic = BLOCK_MAGIC;
+                block->next = central.head;
+                central.head = block;
+            }
+            central.count += blocks;
+        }
+
+        auto head = central.head;
+        auto tail = head;
+        taken = 1;
+        while (taken < count && tail->next != nullptr) {
+            tail = tail->next;
+            ++taken;
+        }
+        central.head = tail->next;
+        central.count -= taken;
+        tail->next = nullptr;
+        return head;
+    }
+
+    /// <summary> Gives a chain of blocks back to the central list of a class. </summary>
+    void GiveBlocks(size_t sizeClass, BlockHeader* head, BlockHeader* tail, uint32_t count) {
+        auto& central = GetCentralLists()[sizeClass];
+        std::lock_guard<std::mutex> lock(central.lock);
+        tail->next = central.head;
+        central.head = head;
+        central.count += count;
+    }
+
+}   // End of anonymous namespace.
+
+void* thread_caching::Allocate(size_t size) {
+    if (size > MAX_SMALL_SIZE) {
+        auto block = static_cast<BlockHeader*>(::malloc(sizeof(BlockHeader) + size));
+        if (block == nullptr) {
+            return nullptr;
+        }
+        block->sizeClass = LARGE_CLASS;
+        block->magic = BLOCK_MAGIC;
+        return block + 1;
+    }
+
+    auto sizeClass = GetSizeClass(size);
+    auto cache = GetThreadCache();
+    uint32_t taken = 0;
+    if (cache == nullptr) {
+        auto block = TakeBlocks(sizeClass, 1, taken);
+        return block != nullptr ? block + 1 : nullptr;
+    }
+
+    auto& list = cache->lists[sizeClass];
+    if (list.head == nullptr) {
+        list.head = TakeBlocks(sizeClass, CLASSES.batches[sizeClass], taken);
+        list.count = taken;
+        if (list.head == nullptr) {
+            return nullptr;
+        }
+    }
+
+    auto block = list.head;
+    list.head = block->next;
+    --list.count;
+    return block + 1;
+}
+
+void thread_caching::Deallocate(void* memory, size_t /*sizeHint*/) {
+    if (memory == nullptr) {
+        return;
+    }
+
+    auto block = static_cast<BlockHeader*>(memory) - 1;
+    NAPA_ASSERT(block->magic == BLOCK_MAGIC, "Memory was not allocated by the thread caching allocator");
+
+    if (block->sizeClass == LARGE_CLASS) {
+        ::free(block);
+        return;
+    }
+
+    auto sizeClass = block->sizeClass;
+    auto cache = GetThreadCache();
+    if (cache == nullptr) {
+        GiveBlocks(sizeClass, block, block, 1);
+        return;
+    }
+
+    auto& list = cache->lists[sizeClass];
+    block->next = list.head;
+    list.head = block;
+    ++list.count;
+
+    // Blocks released by a thread that doesn't allocate them go back to the central list in batches.
+    auto batch = CLASSES.batches[sizeClass];
+    if (list.count > 2 * batch) {
+        auto head = list.head;
+        auto tail = head;
+        for (uint32_t i = 1; i < batch; ++i) {
+            tail = tail->next;
+        }
+        list.head = tail->next;
+        list.count -= batch;
+        GiveBlocks(sizeClass, head, tail, batch);
+    }
+}
+
+size_t thread_caching::GetAllocationSize(size_t size) {
+    return size > MAX_SMALL_SIZE ? size : CLASSES.sizes[GetSizeClass(size)];
+}
+
+size_t thread_caching::GetCentralFreeCount(size_t size) {
+    NAPA_ASSERT(size <= MAX_SMALL_SIZE, "Size %zu is not served from size classes", size);
+
+    auto& central = GetCentralLists()[GetSizeClass(size)];
+    std::lock_guard<std::mutex> lock(central.lock);
+    return central.count;
+}
+
+void thread_caching::FlushThreadCache() {
+    auto& cache = _threadCache;
+    for (size_t sizeClass = 0; sizeClass < CLASS_COUNT; ++sizeClass) {
+        auto& list = cache.lists[sizeClass];
+        if (list.head == nullptr) {
+            continue;
+        }
+
+        auto tail = list.head;
+        while (tail->next != nullptr) {
+            tail = tail->next;
+        }
+        GiveBlocks(sizeClass, list.head, tail, list.count);
+        list.head = nullptr;
+        list.count = 0;
+    }
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <cstddef>
+
+namespace napa {
+namespace memory {
+
+    /// <summary> Size-class allocator with a cache of free blocks per thread, backing napa_allocate if selected. </summary>
+    /// <remarks>
+    ///     Requests up to MAX_SMALL_SIZE bytes are rounded up to one of 40 size classes, and served from the calling thread's
+    ///     free list of that class without locking. An empty list takes a batch of blocks from the class' central list, which
+    ///     carves new spans from ::malloc when it runs out. Freeing pushes the block to the freeing thread's list, which gives a
+    ///     batch back to the central list once it holds more than two batches. Thus memory allocated on one worker and released
+    ///     on another flows back to the allocating worker through the central list, instead of piling up in the releasing one.
+    ///     Each block is prefixed by a 16-byte header telling its size class, so releasing doesn't need a size hint.
+    ///     Spans are never returned to the OS. Larger requests go to ::malloc directly.
+    /// </remarks>
+    namespace thread_caching {
+
+        /// <summary> Largest request served from size classes. </summary>
+        constexpr size_t MAX_SMALL_SIZE = 32 * 1024;
+
+        /// <summary> Allocates memory of given size, aligned like max_align_t. </summary>
+        NAPA_API void* Allocate(size_t size);
+
+        /// <summary> Deallocates memory from Allocate, on any thread. The size hint is not needed. </summary>
+        NAPA_API void Deallocate(void* memory, size_t sizeHint);
+
+        /// <summary> Gets the size of the class a request is rounded up to, or the request itself beyond MAX_SMALL_SIZE. </summary>
+        NAPA_API size_t GetAllocationSize(size_t size);
+
+        /// <summary> Gets the number of free blocks of a size class held by the central list, for diagnostics. </summary>
+        NAPA_API size_t GetCentralFreeCount(size_t size);
+
+        /// <summary> Returns all free blocks cached by the calling thread to the central lists. </summary>
+        /// <remarks> It's done when a thread exits, workers may call it before parking for long. </remarks>
+        NAPA_API void FlushThreadCache();
+    }
+}
+}
@@ -3,13 +3,16 @@
 
 #pragma once
 
+#include "napa/kernels.h"
 #include "napa/napa-binding.h"
 
 #include "node/console.h"
 #include "node/file-system.h"
 #include "node/os.h"
 #include "node/path.h"
+#include "node/perf-wrap.h"
 #include "node/process.h"
+#include "node/timer-wrap.h"
 #include "node/tty-wrap.h"
 
 
@@ -28,6 +31,9 @@
     INITIALIZE_CORE_MODULE(registerer, "fs", false, file_system::Init);                         \
     INITIALIZE_CORE_MODULE(registerer, "os", false, os::Init);                                  \
     INITIALIZE_CORE_MODULE(registerer, "path", false, path::Init);                              \
+    INITIALIZE_CORE_MODULE(registerer, "perf_wrap", false, perf_wrap::Init);                    \
     INITIALIZE_CORE_MODULE(registerer, "process", true, process::Init);                         \
+    INITIALIZE_CORE_MODULE(registerer, "timer_wrap", false, timer_wrap::Init);                  \
     INITIALIZE_CORE_MODULE(registerer, "tty_wrap", false, tty_wrap::Init);                      \
+    INITIALIZE_CORE_MODULE(registerer, "napa-kernels", false, kernels::Init);                   \
     INITIALIZE_CORE_MODULE(registerer, "napa-binding", false, binding::Init);
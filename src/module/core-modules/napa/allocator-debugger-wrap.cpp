@@ -22,6 +22,7 @@ void AllocatorDebuggerWrap::Init(){
     InitConstructorTemplate<AllocatorDebuggerWrap>(constructorTemplate);
 
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "allocate", AllocatorWrap::AllocateCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "allocateBuffer", AllocatorWrap::AllocateBufferCallback);
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "deallocate", AllocatorWrap::DeallocateCallback);
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getDebugInfo", GetDebugInfoCallback);
     NAPA_SET_ACCESSOR(constructorTemplate, "type", AllocatorWrap::GetTypeCallback, nullptr);
@@ -36,10 +37,10 @@ void AllocatorDebuggerWrap::ConstructorCallback(const v8::FunctionCallbackInfo<v
     v8::HandleScope scope(isolate);
 
     JS_ENSURE(isolate, args.IsConstructCall(), "Class \"AllocatorDebuggerWrap\" allows constructor call only.");
-    CHECK_ARG(isolate, args.Length() <= 1, "Class \"AllocatorDebuggerWrap\" requires 1 argument of \"allocator\" in constructor.'");
+    CHECK_ARG(isolate, args.Length() <= 2, "Class \"AllocatorDebuggerWrap\" accepts arguments of \"allocator\" and \"options\" in constructor.'");
 
     std::shared_ptr<napa::memory::Allocator> allocator;
-    if (args.Length() == 0) {
+    if (args.Length() == 0 || args[0]->IsUndefined()) {
         allocator = std::shared_ptr<napa::memory::Allocator>(
             &napa::memory::GetDefaultAllocator(),
             [](napa::memory::Allocator*){});
@@ -51,8 +52,34 @@ void AllocatorDebuggerWrap::ConstructorCallback(const v8::FunctionCallbackInfo<v
         allocator = allocatorWrap->Get();
     }
 
+    // Options ask for the histogram debugger, with an optional sample rate of stacks.
+    auto histogram = false;
+    uint32_t sampleRate = 0;
+    if (args.Length() == 2 && !args[1]->IsUndefined()) {
+        CHECK_ARG(isolate, args[1]->IsObject(), "Argument \"options\" should be an object.");
+        auto context = isolate->GetCurrentContext();
+        auto options = v8::Local<v8::Object>::Cast(args[1]);
+
+        auto histogramValue = options->Get(context, v8_helpers::MakeV8String(isolate, "histogram")).ToLocalChecked();
+        CHECK_ARG(isolate, histogramValue->IsUndefined() || histogramValue->IsBoolean(), "Option \"histogram\" should be a boolean.");
+        histogram = histogramValue->IsTrue();
+
+        auto sampleRateValue = options->Get(context, v8_helpers::MakeV8String(isolate, "sampleRate")).ToLocalChecked();
+        CHECK_ARG(isolate, sampleRateValue->IsUndefined() || sampleRateValue->IsUint32(), "Option \"sampleRate\" should be a non-negative integer.");
+        if (sampleRateValue->IsUint32()) {
+            sampleRate = sampleRateValue->Uint32Value();
+            histogram = true;
+        }
+    }
+
     // It's deleted when its Javascript object is garbage collected by V8's GC.
-    auto wrap = new AllocatorDebuggerWrap(NAPA_MAKE_SHARED<napa::memory::SimpleAllocatorDebugger>(allocator));
+    std::shared_ptr<napa::memory::AllocatorDebugger> allocatorDebugger;
+    if (histogram) {
+        allocatorDebugger = NAPA_MAKE_SHARED<napa::memory::HistogramAllocatorDebugger>(allocator, sampleRate);
+    } else {
+        allocatorDebugger = NAPA_MAKE_SHARED<napa::memory::SimpleAllocatorDebugger>(allocator);
+    }
+    auto wrap = new AllocatorDebuggerWrap(std::move(allocatorDebugger));
     wrap->Wrap(args.This());
     args.GetReturnValue().Set(args.This());
 }
@@ -2,6 +2,9 @@
 // Licensed under the MIT license.
 
 #include "allocator-wrap.h"
+#include "array-buffer-transport.h"
+
+#include <memory/shared-memory.h>
 
 using namespace napa::module;
 
@@ -16,6 +19,7 @@ void AllocatorWrap::Init() {
     InitConstructorTemplate<AllocatorWrap>(constructorTemplate);
     
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "allocate", AllocateCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "allocateBuffer", AllocateBufferCallback);
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "deallocate", DeallocateCallback);
     NAPA_SET_ACCESSOR(constructorTemplate, "type", GetTypeCallback, nullptr);
 
@@ -43,6 +47,27 @@ void AllocatorWrap::AllocateCallback(const v8::FunctionCallbackInfo<v8::Value>&
     args.GetReturnValue().Set(handle);
 }
 
+void AllocatorWrap::AllocateBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument of 'size' is required for \"allocateBuffer\".");
+    CHECK_ARG(isolate, args[0]->IsUint32(), "Argument \"size\" must be a unsigned integer.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<AllocatorWrap>(args.Holder());
+    auto allocator = thisObject->Get();
+    JS_ENSURE(isolate, allocator != nullptr, "AllocatorWrap is not attached with any C++ allocator.");
+
+    // The memory is deallocated through the allocator once buffers over it in all isolates are collected.
+    std::shared_ptr<napa::memory::SharedMemory> memory;
+    auto size = args[0]->Uint32Value();
+    if (size > 0) {
+        memory = napa::memory::AllocateSharedMemory(std::move(allocator), size);
+        JS_ENSURE(isolate, memory != nullptr, "Failed to allocate %u bytes.", size);
+    }
+    args.GetReturnValue().Set(array_buffer_transport::LoadExternal(std::move(memory)));
+}
+
 void AllocatorWrap::DeallocateCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
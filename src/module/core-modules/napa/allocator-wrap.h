@@ -28,7 +28,10 @@ namespace module {
         /// <summary> It implements Allocator.allocate(size: number): napajs.memory.Handle </summary>
         static void AllocateCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
 
-        /// <summary> It implements Allocator.allocate(size: number): napajs.memory.Handle </summary>
+        /// <summary> It implements Allocator.allocateBuffer(size: number): ArrayBuffer </summary>
+        static void AllocateBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Allocator.deallocate(handle: napajs.memory.Handle, sizeHint: number): void </summary>
         static void DeallocateCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
 
         /// <summary> It implements readonly Allocator.type: string </summary>
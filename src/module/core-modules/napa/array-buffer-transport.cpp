@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "array-buffer-transport.h"
+
+#include <napa/v8-helpers.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace napa::module;
+using namespace napa::module::array_buffer_transport;
+
+namespace {
+
+    /// <summary> Keeps shared memory alive as long as a SharedArrayBuffer, or an external ArrayBuffer, over it. </summary>
+    template <typename BufferType>
+    struct SharedMemoryHolder {
+        std::shared_ptr<napa::memory::SharedMemory> memory;
+        v8::Persistent<BufferType> handle;
+    };
+
+    template <typename BufferType>
+    void OnBufferCollected(const v8::WeakCallbackInfo<SharedMemoryHolder<BufferType>>& info) {
+        auto holder = info.GetParameter();
+        holder->handle.Reset();
+        delete holder;
+    }
+
+    template <typename BufferType>
+    void Hold(v8::Isolate* isolate, v8::Local<BufferType> buffer, std::shared_ptr<napa::memory::SharedMemory> memory) {
+        // Shared memory isn't reported as external memory, no single isolate can release it by collecting garbage.
+        auto holder = new SharedMemoryHolder<BufferType>();
+        holder->memory = std::move(memory);
+        holder->handle.Reset(isolate, buffer);
+        holder->handle.SetWeak(holder, OnBufferCollected<BufferType>, v8::WeakCallbackType::kParameter);
+    }
+}
+
+TransportedArrayBuffer::TransportedArrayBuffer(void* data, size_t length) :
+    _data(data), _length(length), _claimed(false) {
+}
+
+TransportedArrayBuffer::TransportedArrayBuffer(std::shared_ptr<napa::memory::SharedMemory> memory) :
+    _data(nullptr), _length(memory->GetLength()), _claimed(false), _memory(std::move(memory)) {
+}
+
+TransportedArrayBuffer::~TransportedArrayBuffer() {
+    std::free(_data);
+}
+
+v8::MaybeLocal<v8::ArrayBuffer> TransportedArrayBuffer::Load(std::shared_ptr<TransportedArrayBuffer> buffer, bool copy) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+
+    if (buffer->_memory != nullptr) {
+        return scope.Escape(LoadExternal(buffer->_memory));
+    }
+
+    if (buffer->_claimed) {
+        isolate->ThrowException(v8::Exception::Error(
+            napa::v8_helpers::MakeV8String(isolate, "ArrayBuffer is already loaded by another isolate.")));
+        return v8::MaybeLocal<v8::ArrayBuffer>();
+    }
+
+    if (copy || buffer->_length == 0) {
+        auto arrayBuffer = v8::ArrayBuffer::New(isolate, buffer->_length);
+        if (buffer->_length > 0) {
+            std::memcpy(arrayBuffer->GetContents().Data(), buffer->_data, buffer->_length);
+        }
+        return scope.Escape(arrayBuffer);
+    }
+
+    // Loads may come from different threads, only one of them can take the memory over.
+    if (buffer->_claimed.exchange(true)) {
+        isolate->ThrowException(v8::Exception::Error(
+            napa::v8_helpers::MakeV8String(isolate, "ArrayBuffer is already loaded by another isolate.")));
+        return v8::MaybeLocal<v8::ArrayBuffer>();
+    }
+
+    // V8 takes the memory over and frees it with the buffer.
+    auto data = buffer->_data;
+    buffer->_data = nullptr;
+    return scope.Escape(v8::ArrayBuffer::New(isolate, data, buffer->_length, v8::ArrayBufferCreationMode::kInternalized));
+}
+
+std::shared_ptr<napa::memory::SharedMemory> TransportedArrayBuffer::TakeMemory() {
+    if (_memory != nullptr) {
+        return _memory;
+    }
+
+    if (_length == 0 || _claimed.exchange(true)) {
+        return nullptr;
+    }
+
+    // The memory comes from the C heap, which shared memory of AdoptSharedMemory frees it to.
+    auto data = _data;
+    _data = nullptr;
+    return napa::memory::AdoptSharedMemory(data, _length);
+}
+
+std::shared_ptr<TransportedArrayBuffer> array_buffer_transport::Save(v8::Local<v8::ArrayBuffer> buffer, bool transfer) {
+    // Buffers over shared memory go by reference, whether transferred or not, as nobody can detach them.
+    if (buffer->IsExternal()) {
+        auto contents = buffer->GetContents();
+        auto memory = napa::memory::FindSharedMemory(contents.Data());
+        if (memory != nullptr && memory->GetLength() == contents.ByteLength()) {
+            return std::make_shared<TransportedArrayBuffer>(std::move(memory));
+        }
+    }
+
+    // Only memory allocated by the isolate can be detached, external memory is owned by someone else.
+    if (transfer && !buffer->IsExternal() && buffer->IsNeuterable()) {
+        auto contents = buffer->GetContents();
+        if (contents.AllocationMode() == v8::ArrayBuffer::Allocator::AllocationMode::kNormal) {
+            contents = buffer->Externalize();
+            buffer->Neuter();
+            return std::make_shared<TransportedArrayBuffer>(contents.Data(), contents.ByteLength());
+        }
+    }
+
+    auto contents = buffer->GetContents();
+    void* data = nullptr;
+    if (contents.ByteLength() > 0) {
+        data = std::malloc(contents.ByteLength());
+        std::memcpy(data, contents.Data(), contents.ByteLength());
+    }
+    return std::make_shared<TransportedArrayBuffer>(data, contents.ByteLength());
+}
+
+std::shared_ptr<napa::memory::SharedMemory> array_buffer_transport::Share(v8::Local<v8::SharedArrayBuffer> buffer) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    if (buffer->IsExternal()) {
+        // Shared before, or loaded from another isolate.
+        auto memory = napa::memory::FindSharedMemory(buffer->GetContents().Data());
+        if (memory == nullptr) {
+            isolate->ThrowException(v8::Exception::Error(
+                napa::v8_helpers::MakeV8String(isolate, "SharedArrayBuffer is externalized by another owner and can't be shared.")));
+        }
+        return memory;
+    }
+
+    // The sender's buffer, from now on external, holds a reference as well.
+    auto contents = buffer->Externalize();
+    auto memory = napa::memory::AdoptSharedMemory(contents.Data(), contents.ByteLength());
+    Hold(isolate, buffer, memory);
+    return memory;
+}
+
+v8::Local<v8::SharedArrayBuffer> array_buffer_transport::LoadShared(std::shared_ptr<napa::memory::SharedMemory> memory) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+
+    auto buffer = v8::SharedArrayBuffer::New(isolate, memory->GetData(), memory->GetLength(), v8::ArrayBufferCreationMode::kExternalized);
+    Hold(isolate, buffer, std::move(memory));
+    return scope.Escape(buffer);
+}
+
+std::shared_ptr<napa::memory::SharedMemory> array_buffer_transport::SaveShared(v8::Local<v8::ArrayBuffer> buffer) {
+    auto contents = buffer->GetContents();
+    if (contents.ByteLength() == 0) {
+        return nullptr;
+    }
+
+    // A buffer loaded by LoadExternal is saved again without copying.
+    if (buffer->IsExternal()) {
+        auto memory = napa::memory::FindSharedMemory(contents.Data());
+        if (memory != nullptr && memory->GetLength() == contents.ByteLength()) {
+            return memory;
+        }
+    }
+
+    auto data = std::malloc(contents.ByteLength());
+    std::memcpy(data, contents.Data(), contents.ByteLength());
+    return napa::memory::AdoptSharedMemory(data, contents.ByteLength());
+}
+
+v8::Local<v8::ArrayBuffer> array_buffer_transport::LoadExternal(std::shared_ptr<napa::memory::SharedMemory> memory) {
+    auto length = memory != nullptr ? memory->GetLength() : 0;
+    return LoadExternal(std::move(memory), 0, length);
+}
+
+v8::Local<v8::ArrayBuffer> array_buffer_transport::LoadExternal(
+    std::shared_ptr<napa::memory::SharedMemory> memory,
+    size_t offset,
+    size_t length) {
+
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+
+    if (memory == nullptr || length == 0) {
+        return scope.Escape(v8::ArrayBuffer::New(isolate, 0));
+    }
+
+    // A slice is saved again by SaveShared as a copy, as FindSharedMemory only matches the whole memory.
+    auto data = static_cast<char*>(memory->GetData()) + offset;
+    auto buffer = v8::ArrayBuffer::New(isolate, data, length, v8::ArrayBufferCreationMode::kExternalized);
+    Hold(isolate, buffer, std::move(memory));
+    return scope.Escape(buffer);
+}
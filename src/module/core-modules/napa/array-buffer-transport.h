@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <memory/shared-memory.h>
+
+#include <v8.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace napa {
+namespace module {
+namespace array_buffer_transport {
+
+    /// <summary> Contents of an ArrayBuffer held by a TransportContext, either copied or transferred from the sender. </summary>
+    /// <remarks>
+    ///     The memory is handed over to the isolate that loads it, without copying, after which it can't be loaded again.
+    ///     Contexts loaded repeatedly, such as store values, load copies instead.
+    ///     Handing memory over across isolates relies on their ArrayBuffer allocators using the C heap, as allocators
+    ///     of Node.js and of Napa zones do, V8 6.x doesn't tell which allocator an isolate uses.
+    ///     External ArrayBuffers over shared memory, e.g. of allocator.allocateBuffer, are neither copied nor handed over,
+    ///     every isolate loading them gets a buffer over the same memory.
+    /// </remarks>
+    class TransportedArrayBuffer {
+    public:
+
+        /// <summary> Takes ownership of memory allocated from the C heap. </summary>
+        TransportedArrayBuffer(void* data, size_t length);
+
+        /// <summary> Refers to shared memory, which is loaded as external ArrayBuffers over it. </summary>
+        explicit TransportedArrayBuffer(std::shared_ptr<napa::memory::SharedMemory> memory);
+
+        /// <summary> Non-copyable. </summary>
+        TransportedArrayBuffer(const TransportedArrayBuffer&) = delete;
+        TransportedArrayBuffer& operator=(const TransportedArrayBuffer&) = delete;
+
+        /// <summary> Frees the memory unless it was handed over to an isolate. </summary>
+        ~TransportedArrayBuffer();
+
+        /// <summary> Creates an ArrayBuffer in current isolate. </summary>
+        /// <param name="copy"> Copy instead of handing the memory over, for contexts that are loaded repeatedly. </param>
+        /// <returns> The ArrayBuffer, or empty with a pending JS exception if the memory was handed over already. </returns>
+        static v8::MaybeLocal<v8::ArrayBuffer> Load(std::shared_ptr<TransportedArrayBuffer> buffer, bool copy);
+
+        /// <summary> Takes the memory over as shared memory, for hosts reading a transported ArrayBuffer in C++ without copying. </summary>
+        /// <returns> The shared memory, or nullptr if the buffer is empty or its memory was handed over already. </returns>
+        std::shared_ptr<napa::memory::SharedMemory> TakeMemory();
+
+    private:
+        void* _data;
+        size_t _length;
+        std::atomic<bool> _claimed;
+        std::shared_ptr<napa::memory::SharedMemory> _memory;
+    };
+
+    /// <summary> Gets the memory of a SharedArrayBuffer for loading in other isolates. </summary>
+    /// <param name="buffer"> SharedArrayBuffer to share, which is externalized the first time. </param>
+    /// <returns> The shared memory, or empty with a pending JS exception if the memory is externalized by another owner. </returns>
+    /// <remarks> The buffer holds a reference to the memory until it is garbage collected. </remarks>
+    std::shared_ptr<napa::memory::SharedMemory> Share(v8::Local<v8::SharedArrayBuffer> buffer);
+
+    /// <summary> Creates a SharedArrayBuffer over shared memory in current isolate. </summary>
+    /// <remarks> 
+    ///     The buffer holds a reference to the memory until it is garbage collected. Memory is at the same address 
+    ///     in every isolate, thus Atomics work across workers.
+    /// </remarks>
+    v8::Local<v8::SharedArrayBuffer> LoadShared(std::shared_ptr<napa::memory::SharedMemory> memory);
+
+    /// <summary> Saves the contents of an ArrayBuffer as shared memory, which can be loaded by many isolates at a time. </summary>
+    /// <returns> The shared memory, or nullptr if the buffer is empty. </returns>
+    /// <remarks> Contents are copied, unless the buffer is over shared memory from LoadExternal already. </remarks>
+    std::shared_ptr<napa::memory::SharedMemory> SaveShared(v8::Local<v8::ArrayBuffer> buffer);
+
+    /// <summary> Creates an external ArrayBuffer over shared memory in current isolate, without copying. </summary>
+    /// <param name="memory"> Shared memory, or nullptr for an empty ArrayBuffer. </param>
+    /// <remarks> The buffer holds a reference to the memory until it is garbage collected. Writes to it are seen by all its readers. </remarks>
+    v8::Local<v8::ArrayBuffer> LoadExternal(std::shared_ptr<napa::memory::SharedMemory> memory);
+
+    /// <summary> Creates an external ArrayBuffer over a range of shared memory in current isolate, without copying. </summary>
+    /// <param name="memory"> Shared memory, or nullptr for an empty ArrayBuffer. </param>
+    /// <param name="offset"> Start of the range, which must be within the memory. </param>
+    /// <param name="length"> Length of the range, which must be within the memory. </param>
+    /// <remarks> The slice holds a reference to the whole memory until it is garbage collected. </remarks>
+    v8::Local<v8::ArrayBuffer> LoadExternal(std::shared_ptr<napa::memory::SharedMemory> memory, size_t offset, size_t length);
+
+    /// <summary> Saves the contents of an ArrayBuffer for loading in another isolate. </summary>
+    /// <param name="buffer"> ArrayBuffer to save. </param>
+    /// <param name="transfer"> 
+    ///     Detach the backing store from buffer instead of copying it. It falls back to copying for
+    ///     buffers whose memory isn't owned by V8, e.g. external or WebAssembly memory.
+    /// </param>
+    /// <remarks> External buffers over the whole of a shared memory, from LoadExternal, are saved by reference. </remarks>
+    std::shared_ptr<TransportedArrayBuffer> Save(v8::Local<v8::ArrayBuffer> buffer, bool transfer);
+}
+}
+}
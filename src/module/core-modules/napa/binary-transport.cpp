@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "binary-transport.h"
+
+#include <napa/module/binding.h>
+#include <napa/v8-helpers.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace napa::module;
+
+bool binary_transport::Serialize(v8::Local<v8::Value> value, uint32_t flags, std::string& payload) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    // No delegate: subclassing it needs V8 RTTI, which Node doesn't export. Transportable objects, including
+    // ShareableWraps, are replaced by marshalled payloads in binaryTransform, V8 throws a DataCloneError on
+    // any other host object.
+    v8::ValueSerializer serializer(isolate);
+    serializer.WriteHeader();
+    serializer.WriteUint32(flags);
+    if (serializer.WriteValue(context, value).IsNothing()) {
+        return false;
+    }
+
+    auto buffer = serializer.Release();
+    payload.assign(reinterpret_cast<const char*>(buffer.first), buffer.second);
+    std::free(buffer.first);
+    return true;
+}
+
+v8::MaybeLocal<v8::Value> binary_transport::Deserialize(const uint8_t* data, size_t size, uint32_t& flags) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    v8::ValueDeserializer deserializer(isolate, data, size);
+    if (deserializer.ReadHeader(context).IsNothing()) {
+        return v8::MaybeLocal<v8::Value>();
+    }
+
+    if (!deserializer.ReadUint32(&flags)) {
+        isolate->ThrowException(v8::Exception::Error(napa::v8_helpers::MakeV8String(isolate, "Invalid binary payload.")));
+        return v8::MaybeLocal<v8::Value>();
+    }
+    return deserializer.ReadValue(context);
+}
+
+bool binary_transport::Marshall(v8::Local<v8::Value> value, v8::Local<v8::Object> transportContextWrap, std::string& payload) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    // The pre-pass returns [transformed value, whether any transportable was replaced].
+    v8::Local<v8::Value> argv[] = { value, transportContextWrap };
+    auto transformed = binding::Call("../lib/transport/transport", "binaryTransform", sizeof(argv) / sizeof(v8::Local<v8::Value>), argv);
+    if (transformed.IsEmpty()) {
+        return false;
+    }
+
+    auto pair = v8::Local<v8::Array>::Cast(transformed.ToLocalChecked());
+    auto hasTransportables = pair->Get(context, 1).ToLocalChecked()->BooleanValue(context).FromJust();
+    return Serialize(pair->Get(context, 0).ToLocalChecked(), hasTransportables ? HAS_TRANSPORTABLES : 0, payload);
+}
+
+v8::MaybeLocal<v8::Value> binary_transport::Unmarshall(const std::string& payload, v8::Local<v8::Object> transportContextWrap) {
+    uint32_t flags = 0;
+    auto value = Deserialize(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), flags);
+    if (value.IsEmpty() || (flags & HAS_TRANSPORTABLES) == 0) {
+        return value;
+    }
+
+    v8::Local<v8::Value> argv[] = { value.ToLocalChecked(), transportContextWrap };
+    return binding::Call("../lib/transport/transport", "binaryRevive", sizeof(argv) / sizeof(v8::Local<v8::Value>), argv);
+}
+
+bool binary_transport::GetPayloadBytes(v8::Local<v8::Value> value, const uint8_t*& data, size_t& size) {
+    if (value->IsArrayBuffer()) {
+        auto contents = v8::Local<v8::ArrayBuffer>::Cast(value)->GetContents();
+        data = static_cast<const uint8_t*>(contents.Data());
+        size = contents.ByteLength();
+        return true;
+    }
+
+    if (value->IsArrayBufferView()) {
+        auto view = v8::Local<v8::ArrayBufferView>::Cast(value);
+        auto contents = view->Buffer()->GetContents();
+        data = static_cast<const uint8_t*>(contents.Data()) + view->ByteOffset();
+        size = view->ByteLength();
+        return true;
+    }
+    return false;
+}
+
+bool binary_transport::CopyPayload(v8::Local<v8::Value> value, std::string& payload) {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!GetPayloadBytes(value, data, size)) {
+        return false;
+    }
+
+    payload.assign(reinterpret_cast<const char*>(data), size);
+    return true;
+}
+
+v8::Local<v8::ArrayBuffer> binary_transport::NewPayloadBuffer(const char* data, size_t size) {
+    auto buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), size);
+    if (size > 0) {
+        std::memcpy(buffer->GetContents().Data(), data, size);
+    }
+    return buffer;
+}
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <v8.h>
+
+#include <cstdint>
+#include <string>
+
+namespace napa {
+namespace module {
+namespace binary_transport {
+
+    /// <summary> Payload flag telling that transportable objects were replaced by their marshalled form. </summary>
+    constexpr uint32_t HAS_TRANSPORTABLES = 1;
+
+    /// <summary> Serializes a JS value in V8 structured clone format, prefixed with payload flags. </summary>
+    /// <param name="value"> Value to serialize, transportable objects must have been replaced already. </param>
+    /// <param name="flags"> Payload flags, to be returned by Deserialize. </param>
+    /// <param name="payload"> Receives the serialized bytes. </param>
+    /// <returns> True on success, false with a pending JS exception otherwise. </returns>
+    bool Serialize(v8::Local<v8::Value> value, uint32_t flags, std::string& payload);
+
+    /// <summary> Deserializes a JS value serialized by Serialize. </summary>
+    /// <param name="data"> Serialized bytes. </param>
+    /// <param name="size"> Number of serialized bytes. </param>
+    /// <param name="flags"> Receives the payload flags. </param>
+    /// <returns> The value, or empty with a pending JS exception. </returns>
+    v8::MaybeLocal<v8::Value> Deserialize(const uint8_t* data, size_t size, uint32_t& flags);
+
+    /// <summary> Marshalls a JS value in binary form, transportable objects are marshalled into the transport context. </summary>
+    /// <param name="value"> Value to marshall. </param>
+    /// <param name="transportContextWrap"> TransportContextWrap to save shared pointers. </param>
+    /// <param name="payload"> Receives the serialized bytes. </param>
+    /// <returns> True on success, false with a pending JS exception otherwise. </returns>
+    /// <remarks> Reference: napajs/lib/transport/transport.ts#marshallBinary </remarks>
+    bool Marshall(v8::Local<v8::Value> value, v8::Local<v8::Object> transportContextWrap, std::string& payload);
+
+    /// <summary> Unmarshalls a JS value from a payload created by Marshall. </summary>
+    /// <param name="payload"> Serialized bytes. </param>
+    /// <param name="transportContextWrap"> TransportContextWrap to load shared pointers. </param>
+    /// <returns> The value, or empty with a pending JS exception. </returns>
+    /// <remarks> Reference: napajs/lib/transport/transport.ts#unmarshallBinary </remarks>
+    v8::MaybeLocal<v8::Value> Unmarshall(const std::string& payload, v8::Local<v8::Object> transportContextWrap);
+
+    /// <summary> Gets the bytes of a binary payload held by an ArrayBuffer or an ArrayBufferView, without copying. </summary>
+    /// <returns> False if value is neither an ArrayBuffer nor an ArrayBufferView. </returns>
+    bool GetPayloadBytes(v8::Local<v8::Value> value, const uint8_t*& data, size_t& size);
+
+    /// <summary> Copies the bytes of a binary payload held by an ArrayBuffer or an ArrayBufferView. </summary>
+    /// <returns> False if value is neither an ArrayBuffer nor an ArrayBufferView. </returns>
+    bool CopyPayload(v8::Local<v8::Value> value, std::string& payload);
+
+    /// <summary> Creates an ArrayBuffer with a copy of a binary payload. </summary>
+    v8::Local<v8::ArrayBuffer> NewPayloadBuffer(const char* data, size_t size);
+}
+}
+}
@@ -2,6 +2,7 @@
 // Licensed under the MIT license.
 
 #include "call-context-wrap.h"
+#include "binary-transport.h"
 #include "transport-context-wrap-impl.h"
 
 #include <napa/transport.h>
@@ -11,6 +12,59 @@ using namespace napa::module;
 
 NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(CallContextWrap)
 
+namespace {
+
+    /// <summary> One-byte string resource over an interned argument, released by V8 garbage collection. </summary>
+    class SharedPayloadResource : public v8::String::ExternalOneByteStringResource {
+    public:
+        explicit SharedPayloadResource(std::shared_ptr<const zone::PayloadInterner::Payload> payload) :
+            _payload(std::move(payload)) {
+        }
+
+        const char* data() const override {
+            return _payload->data.data();
+        }
+
+        size_t length() const override {
+            return _payload->data.size();
+        }
+
+    private:
+        std::shared_ptr<const zone::PayloadInterner::Payload> _payload;
+    };
+
+    /// <summary> One-byte string resource over an argument borrowed from its caller, which keeps the owner alive. </summary>
+    class BorrowedArgumentResource : public v8::String::ExternalOneByteStringResource {
+    public:
+        BorrowedArgumentResource(napa::StringRef argument, std::shared_ptr<const void> owner) :
+            _argument(argument), _owner(std::move(owner)) {
+        }
+
+        const char* data() const override {
+            return _argument.data;
+        }
+
+        size_t length() const override {
+            return _argument.size;
+        }
+
+    private:
+        napa::StringRef _argument;
+        std::shared_ptr<const void> _owner;
+    };
+
+    /// <summary> Whether all bytes are ASCII, so they can back a one-byte V8 string as is. </summary>
+    bool IsAscii(napa::StringRef str) {
+        for (size_t i = 0; i < str.size; ++i) {
+            if ((str.data[i] & 0x80) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}   // End of anonymous namespace.
+
 void CallContextWrap::Init() {
     auto isolate = v8::Isolate::GetCurrent();
     auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<CallContextWrap>);
@@ -28,6 +82,8 @@ void CallContextWrap::Init() {
     NAPA_SET_ACCESSOR(constructorTemplate, "args", GetArgumentsCallback, nullptr);
     NAPA_SET_ACCESSOR(constructorTemplate, "transportContext", GetTransportContextCallback, nullptr);
     NAPA_SET_ACCESSOR(constructorTemplate, "options", GetOptionsCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "cpuTime", GetCpuTimeCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "allocatedBytes", GetAllocatedBytesCallback, nullptr);
 
     auto constructor = constructorTemplate->GetFunction();
     InitConstructor("<CallContextWrap>", constructor);
@@ -42,15 +98,34 @@ zone::CallContext& CallContextWrap::GetRef() {
     return ShareableWrap::GetRef<zone::CallContext>();
 }
 
+void CallContextWrap::Reset(std::shared_ptr<zone::CallContext> call) {
+    _object = std::move(call);
+    _arguments.Reset();
+    _transportContext.Reset();
+    _options.Reset();
+    _settled = false;
+}
+
+bool CallContextWrap::IsSettled() const {
+    return _settled;
+}
+
 void CallContextWrap::ResolveCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
 
     CHECK_ARG(isolate, args.Length() == 1, "1 argument of 'result' is required for \"resolve\".");
     
-    v8::String::Utf8Value result(args[0]);
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
-    auto success = thisObject->GetRef().Resolve(std::string(*result, result.length()));
+    thisObject->_settled = true;
+    std::string payload;
+    if (args[0]->IsString()) {
+        v8_helpers::WriteUtf8(v8::Local<v8::String>::Cast(args[0]), payload);
+    } else if (!binary_transport::CopyPayload(args[0], payload)) {
+        v8::String::Utf8Value result(args[0]);
+        payload.assign(*result, result.length());
+    }
+    auto success = thisObject->GetRef().Resolve(std::move(payload));
 
     JS_ENSURE(isolate, success, "Resolve call failed: Already finished.");
 }
@@ -76,6 +151,7 @@ void CallContextWrap::RejectCallback(const v8::FunctionCallbackInfo<v8::Value>&
     v8::String::Utf8Value reasonStr(reason);
 
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
+    thisObject->_settled = true;
     auto success = thisObject->GetRef().Reject(code, std::string(*reasonStr, reasonStr.length()));
     JS_ENSURE(isolate, success, "Reject call failed: Already finished.");
 }
@@ -98,14 +174,16 @@ void CallContextWrap::GetModuleCallback(v8::Local<v8::String> /*propertyName*/,
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
-    args.GetReturnValue().Set(v8_helpers::MakeV8String(isolate, thisObject->GetRef().GetModule()));
+    auto module = thisObject->GetRef().GetModule();
+    args.GetReturnValue().Set(v8_helpers::MakeV8String(isolate, module.data, static_cast<int>(module.size)));
 }
 
 void CallContextWrap::GetFunctionCallback(v8::Local<v8::String> /*propertyName*/, const v8::PropertyCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
-    args.GetReturnValue().Set(v8_helpers::MakeV8String(isolate, thisObject->GetRef().GetFunction()));
+    auto function = thisObject->GetRef().GetFunction();
+    args.GetReturnValue().Set(v8_helpers::MakeV8String(isolate, function.data, static_cast<int>(function.size)));
 }
 
 void CallContextWrap::GetArgumentsCallback(v8::Local<v8::String> /*propertyName*/, const v8::PropertyCallbackInfo<v8::Value>& args) {
@@ -113,24 +191,52 @@ void CallContextWrap::GetArgumentsCallback(v8::Local<v8::String> /*propertyName*
     v8::HandleScope scope(isolate);
     auto context = isolate->GetCurrentContext();
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
+    if (!thisObject->_arguments.IsEmpty()) {
+        args.GetReturnValue().Set(thisObject->_arguments);
+        return;
+    }
 
     auto& cppArgs = thisObject->GetRef().GetArguments();
+    auto binary = thisObject->GetRef().GetOptions().transport == napa::TransportOption::BINARY;
     auto jsArgs = v8::Array::New(isolate, static_cast<int>(cppArgs.size()));
     for (size_t i = 0; i < cppArgs.size(); ++i) {
-        (void)jsArgs->CreateDataProperty(context, static_cast<uint32_t>(i), v8_helpers::MakeExternalV8String(isolate, cppArgs[i]));
+        v8::Local<v8::Value> arg;
+        if (binary) {
+            arg = binary_transport::NewPayloadBuffer(cppArgs[i].data, cppArgs[i].size);
+        } else {
+            auto& owner = thisObject->GetRef().GetArgumentsOwner();
+            auto payload = thisObject->GetRef().GetSharedArgument(i);
+            if (owner != nullptr) {
+                // The bytes given by the caller are exposed as they are, they stay alive as long as the string.
+                arg = IsAscii(cppArgs[i]) ?
+                    v8::String::NewExternalOneByte(isolate, new BorrowedArgumentResource(cppArgs[i], owner)).ToLocalChecked() :
+                    v8_helpers::MakeV8String(isolate, cppArgs[i].data, static_cast<int>(cppArgs[i].size));
+            } else if (payload != nullptr && payload->ascii) {
+                // The string keeps the interned payload alive, even after the call completes.
+                arg = v8::String::NewExternalOneByte(isolate, new SharedPayloadResource(std::move(payload))).ToLocalChecked();
+            } else {
+                arg = v8_helpers::MakeExternalV8String(isolate, cppArgs[i].data, cppArgs[i].size);
+            }
+        }
+        (void)jsArgs->CreateDataProperty(context, static_cast<uint32_t>(i), arg);
     }
+    thisObject->_arguments.Reset(isolate, jsArgs);
     args.GetReturnValue().Set(jsArgs);
 }
 
 void CallContextWrap::GetTransportContextCallback(v8::Local<v8::String> /*propertyName*/, const v8::PropertyCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
-    auto context = isolate->GetCurrentContext();
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
+    if (!thisObject->_transportContext.IsEmpty()) {
+        args.GetReturnValue().Set(thisObject->_transportContext);
+        return;
+    }
 
     auto& transportContext = thisObject->GetRef().GetTransportContext();
     // Create a non-owning transport context wrap, since transport context is always owned by call context. 
     auto wrap = TransportContextWrapImpl::NewInstance(false, &transportContext);
+    thisObject->_transportContext.Reset(isolate, wrap);
     args.GetReturnValue().Set(wrap);
 }
 
@@ -138,10 +244,37 @@ void CallContextWrap::GetOptionsCallback(v8::Local<v8::String> /*propertyName*/,
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
     
+    auto context = isolate->GetCurrentContext();
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
+    if (!thisObject->_options.IsEmpty()) {
+        args.GetReturnValue().Set(thisObject->_options);
+        return;
+    }
+
     // Prepare execute options.
-    // NOTE: export necessary fields from CallContext.GetOptions to jsOptions object here. Now it's empty.
+    // NOTE: export necessary fields from CallContext.GetOptions to jsOptions object here.
+    auto& options = thisObject->GetRef().GetOptions();
     auto jsOptions = v8::Object::New(isolate);
+    (void)jsOptions->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "transport"), v8::Uint32::NewFromUnsigned(isolate, options.transport));
+    if (options.trace_id.size > 0) {
+        (void)jsOptions->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "traceId"), v8_helpers::MakeV8String(isolate, options.trace_id.data));
+    }
 
+    thisObject->_options.Reset(isolate, jsOptions);
     args.GetReturnValue().Set(jsOptions);
 }
 
+
+void CallContextWrap::GetCpuTimeCallback(v8::Local<v8::String> /*propertyName*/, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
+    args.GetReturnValue().Set(static_cast<double>(thisObject->GetRef().GetCpuTime().count()));
+}
+
+void CallContextWrap::GetAllocatedBytesCallback(v8::Local<v8::String> /*propertyName*/, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<CallContextWrap>(args.Holder());
+    args.GetReturnValue().Set(static_cast<double>(thisObject->GetRef().GetAllocatedBytes()));
+}
@@ -26,6 +26,13 @@ namespace module {
         /// <summary> Get call context. </summary>
         zone::CallContext& GetRef();
 
+        /// <summary> Re-points the wrap at another call context, or at none, dropping the values cached for the previous one. </summary>
+        /// <remarks> A worker reuses one wrap for its calls this way, rather than creating one per call. </remarks>
+        void Reset(std::shared_ptr<zone::CallContext> call);
+
+        /// <summary> Whether JavaScript resolved or rejected the call through the wrap, after which it doesn't use it anymore. </summary>
+        bool IsSettled() const;
+
         /// <summary> Exported class name. </summary>
         static constexpr const char* exportName = "CallContextWrap";
 
@@ -59,6 +66,20 @@ namespace module {
 
         /// <summary> It implements CallContext.elapse: [number, number] (precision in nano-second) </summary>
         static void GetElapseCallback(v8::Local<v8::String> propertyName, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements CallContext.cpuTime: number (in nano-second) </summary>
+        static void GetCpuTimeCallback(v8::Local<v8::String> propertyName, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements CallContext.allocatedBytes: number </summary>
+        static void GetAllocatedBytesCallback(v8::Local<v8::String> propertyName, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+    private:
+        /// <summary> Values of args, transportContext and options, created on first read as they are read more than once per call. </summary>
+        v8::Global<v8::Value> _arguments;
+        v8::Global<v8::Value> _transportContext;
+        v8::Global<v8::Value> _options;
+
+        bool _settled = false;
     };
 }
 }
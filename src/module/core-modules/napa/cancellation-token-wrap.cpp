@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "cancellation-token-wrap.h"
+
+#include <zone/cancellation-token.h>
+
+#include <napa/v8-helpers.h>
+
+using namespace napa::module;
+using namespace napa::zone;
+
+NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(CancellationTokenWrap)
+
+void CancellationTokenWrap::Init() {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<CancellationTokenWrap>);
+    constructorTemplate->SetClassName(v8_helpers::MakeV8String(isolate, exportName));
+    constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+    InitConstructorTemplate<CancellationTokenWrap>(constructorTemplate);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "cancel", CancelCallback);
+    NAPA_SET_ACCESSOR(constructorTemplate, "cancelled", IsCancelledCallback, nullptr);
+
+    auto constructor = constructorTemplate->GetFunction();
+    InitConstructor("<CancellationTokenWrap>", constructor);
+    NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructor);
+}
+
+void CancellationTokenWrap::CancelCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<CancellationTokenWrap>(args.Holder());
+    args.GetReturnValue().Set(thisObject->GetRef<CancellationToken>().Cancel());
+}
+
+void CancellationTokenWrap::IsCancelledCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<CancellationTokenWrap>(args.Holder());
+    args.GetReturnValue().Set(thisObject->GetRef<CancellationToken>().IsCancelled());
+}
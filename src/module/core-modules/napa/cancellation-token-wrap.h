@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/module.h>
+#include <napa/module/shareable-wrap.h>
+
+namespace napa {
+namespace module {
+
+    /// <summary> It wraps napa::zone::CancellationToken, which is shared by the caller and the calls it cancels. </summary>
+    /// <remarks> Reference: napajs/lib/zone/cancellation.ts </remarks>
+    class CancellationTokenWrap : public ShareableWrap {
+    public:
+        /// <summary> Init this wrap. </summary>
+        static void Init();
+
+        /// <summary> Declare constructor in public, so we can export class constructor in JavaScript world. </summary>
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR
+
+        /// <summary> Exported class name. </summary>
+        static constexpr const char* exportName = "CancellationTokenWrap";
+
+    private:
+        /// <summary> It implements CancellationToken.cancel(): boolean </summary>
+        static void CancelCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements CancellationToken.cancelled </summary>
+        static void IsCancelledCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+    };
+}
+}
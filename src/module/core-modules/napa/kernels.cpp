@@ -0,0 +1,177 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kernels.h"
+
+#include <napa/module.h>
+#include <utils/typed-array-kernels.h>
+
+#include <cstdint>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+
+    /// <summary> Elements of a Float32Array or Float64Array, read and written in place, e.g. over a SharedArrayBuffer. </summary>
+    struct FloatArray {
+        bool isDouble = false;
+        void* data = nullptr;
+        size_t length = 0;
+
+        float* AsFloats() const { return static_cast<float*>(data); }
+        double* AsDoubles() const { return static_cast<double*>(data); }
+    };
+
+    bool GetFloatArray(v8::Local<v8::Value> value, FloatArray& array) {
+        if (!value->IsFloat32Array() && !value->IsFloat64Array()) {
+            return false;
+        }
+        auto view = v8::Local<v8::TypedArray>::Cast(value);
+        auto contents = view->Buffer()->GetContents();
+        array.isDouble = value->IsFloat64Array();
+        array.data = static_cast<uint8_t*>(contents.Data()) + view->ByteOffset();
+        array.length = view->Length();
+        return true;
+    }
+
+    /// <summary> Index of a kernel result, -1 for NOT_FOUND. </summary>
+    double ToIndex(size_t index) {
+        return index == utils::kernels::NOT_FOUND ? -1.0 : static_cast<double>(index);
+    }
+
+    void SumCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        FloatArray x;
+        CHECK_ARG(isolate, args.Length() == 1 && GetFloatArray(args[0], x), "Argument 'x' must be Float32Array or Float64Array.");
+
+        args.GetReturnValue().Set(x.isDouble ? utils::kernels::Sum(x.AsDoubles(), x.length) : utils::kernels::Sum(x.AsFloats(), x.length));
+    }
+
+    void DotCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        FloatArray x, y;
+        CHECK_ARG(isolate, args.Length() == 2 && GetFloatArray(args[0], x) && GetFloatArray(args[1], y),
+            "Arguments 'x' and 'y' must be Float32Array or Float64Array.");
+        CHECK_ARG(isolate, x.isDouble == y.isDouble && x.length == y.length, "Arguments 'x' and 'y' must be of the same type and length.");
+
+        args.GetReturnValue().Set(x.isDouble
+            ? utils::kernels::Dot(x.AsDoubles(), y.AsDoubles(), x.length)
+            : utils::kernels::Dot(x.AsFloats(), y.AsFloats(), x.length));
+    }
+
+    void AxpyCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        FloatArray x, y;
+        CHECK_ARG(isolate, args.Length() == 3 && args[0]->IsNumber(), "Argument 'a' must be number.");
+        CHECK_ARG(isolate, GetFloatArray(args[1], x) && GetFloatArray(args[2], y), "Arguments 'x' and 'y' must be Float32Array or Float64Array.");
+        CHECK_ARG(isolate, x.isDouble == y.isDouble && x.length == y.length, "Arguments 'x' and 'y' must be of the same type and length.");
+
+        auto a = args[0]->NumberValue();
+        if (x.isDouble) {
+            utils::kernels::Axpy(a, x.AsDoubles(), y.AsDoubles(), x.length);
+        } else {
+            utils::kernels::Axpy(static_cast<float>(a), x.AsFloats(), y.AsFloats(), x.length);
+        }
+        args.GetReturnValue().Set(args[2]);
+    }
+
+    void ArgMaxCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        FloatArray x;
+        CHECK_ARG(isolate, args.Length() == 1 && GetFloatArray(args[0], x), "Argument 'x' must be Float32Array or Float64Array.");
+
+        args.GetReturnValue().Set(ToIndex(x.isDouble ? utils::kernels::ArgMax(x.AsDoubles(), x.length) : utils::kernels::ArgMax(x.AsFloats(), x.length)));
+    }
+
+    void TopKCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        FloatArray x;
+        CHECK_ARG(isolate, args.Length() == 2 && GetFloatArray(args[0], x), "Argument 'x' must be Float32Array or Float64Array.");
+        CHECK_ARG(isolate, args[1]->IsUint32(), "Argument 'k' must be a non-negative integer.");
+
+        auto k = std::min(static_cast<size_t>(args[1]->Uint32Value()), x.length);
+        auto buffer = v8::ArrayBuffer::New(isolate, k * sizeof(uint32_t));
+        auto indices = static_cast<uint32_t*>(buffer->GetContents().Data());
+        auto count = x.isDouble
+            ? utils::kernels::TopK(x.AsDoubles(), x.length, k, indices)
+            : utils::kernels::TopK(x.AsFloats(), x.length, k, indices);
+
+        args.GetReturnValue().Set(v8::Uint32Array::New(buffer, 0, count));
+    }
+
+    void HistogramCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        FloatArray x;
+        CHECK_ARG(isolate, (args.Length() == 4 || args.Length() == 5) && GetFloatArray(args[0], x),
+            "Argument 'x' must be Float32Array or Float64Array.");
+        CHECK_ARG(isolate, args[1]->IsNumber() && args[2]->IsNumber(), "Arguments 'min' and 'max' must be numbers.");
+        CHECK_ARG(isolate, args[3]->IsUint32() && args[3]->Uint32Value() > 0, "Argument 'bins' must be a positive integer.");
+
+        // Counts of a part of the input are added to the counts of the previous parts.
+        auto binCount = static_cast<size_t>(args[3]->Uint32Value());
+        v8::Local<v8::Uint32Array> counts;
+        if (args.Length() == 5 && !args[4]->IsUndefined()) {
+            CHECK_ARG(isolate, args[4]->IsUint32Array() && v8::Local<v8::Uint32Array>::Cast(args[4])->Length() == binCount,
+                "Argument 'counts' must be Uint32Array of 'bins' elements.");
+            counts = v8::Local<v8::Uint32Array>::Cast(args[4]);
+        } else {
+            counts = v8::Uint32Array::New(v8::ArrayBuffer::New(isolate, binCount * sizeof(uint32_t)), 0, binCount);
+        }
+
+        auto bins = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(counts->Buffer()->GetContents().Data()) + counts->ByteOffset());
+        auto min = args[1]->NumberValue();
+        auto max = args[2]->NumberValue();
+        if (x.isDouble) {
+            utils::kernels::Histogram(x.AsDoubles(), x.length, min, max, bins, binCount);
+        } else {
+            utils::kernels::Histogram(x.AsFloats(), x.length, min, max, bins, binCount);
+        }
+        args.GetReturnValue().Set(counts);
+    }
+
+    void SortCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        FloatArray x;
+        CHECK_ARG(isolate, args.Length() == 1 && GetFloatArray(args[0], x), "Argument 'x' must be Float32Array or Float64Array.");
+
+        if (x.isDouble) {
+            utils::kernels::Sort(x.AsDoubles(), x.length);
+        } else {
+            utils::kernels::Sort(x.AsFloats(), x.length);
+        }
+        args.GetReturnValue().Set(args[0]);
+    }
+}
+
+void napa::module::kernels::Init(v8::Local<v8::Object> exports) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    NAPA_SET_METHOD(exports, "sum", SumCallback);
+    NAPA_SET_METHOD(exports, "dot", DotCallback);
+    NAPA_SET_METHOD(exports, "axpy", AxpyCallback);
+    NAPA_SET_METHOD(exports, "argmax", ArgMaxCallback);
+    NAPA_SET_METHOD(exports, "topK", TopKCallback);
+    NAPA_SET_METHOD(exports, "histogram", HistogramCallback);
+    NAPA_SET_METHOD(exports, "sort", SortCallback);
+
+    exports->CreateDataProperty(
+        isolate->GetCurrentContext(),
+        v8_helpers::MakeV8String(isolate, "simdLevel"),
+        v8_helpers::MakeV8String(isolate, utils::kernels::GetSimdLevel())).FromJust();
+}
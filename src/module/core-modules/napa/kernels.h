@@ -0,0 +1,21 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <v8.h>
+
+namespace napa {
+namespace module {
+
+/// <summary> Napa core module of numeric kernels over Float32Array and Float64Array. </summary>
+/// <remarks> Reference: napajs/lib/kernels.ts </remarks>
+namespace kernels {
+
+    /// <summary> Set kernels object. </summary>
+    /// <param name="exports"> Object to set module. </param>
+    void Init(v8::Local<v8::Object> exports);
+
+}   // End of namespace kernels
+}   // End of namespace module
+}   // End of namespace napa
@@ -0,0 +1,195 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "message-channel-wrap.h"
+
+#include "binary-transport.h"
+#include "transport-context-wrap-impl.h"
+
+#include <zone/message-channel.h>
+
+#include <napa/async.h>
+#include <napa/v8-helpers.h>
+
+using namespace napa::module;
+using namespace napa::zone;
+
+NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(MessageChannelWrap)
+
+namespace {
+
+    /// <summary> Sets the payload and the transport context of a message as JS values, which take them over. </summary>
+    void ToV8(MessageChannel::Message& message, v8::Local<v8::Value>& payload, v8::Local<v8::Value>& transportContext) {
+        auto isolate = v8::Isolate::GetCurrent();
+        if (message.binary) {
+            payload = binary_transport::NewPayloadBuffer(message.payload.data(), message.payload.size());
+        } else {
+            payload = napa::v8_helpers::MakeV8String(isolate, message.payload);
+        }
+        transportContext = TransportContextWrapImpl::NewInstance(
+            true, new napa::transport::TransportContext(std::move(message.transportContext)));
+    }
+
+}   // End of anonymous namespace.
+
+void MessageChannelWrap::Init() {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<MessageChannelWrap>);
+    constructorTemplate->SetClassName(v8_helpers::MakeV8String(isolate, exportName));
+    constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+    InitConstructorTemplate<MessageChannelWrap>(constructorTemplate);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "send", SendCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "waitWritable", WaitWritableCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "receive", ReceiveCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "tryReceive", TryReceiveCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "close", CloseCallback);
+    NAPA_SET_ACCESSOR(constructorTemplate, "closed", IsClosedCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "size", GetSizeCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "capacity", GetCapacityCallback, nullptr);
+
+    auto constructor = constructorTemplate->GetFunction(isolate->GetCurrentContext()).ToLocalChecked();
+    InitConstructor("<MessageChannelWrap>", constructor);
+    NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructor);
+}
+
+void MessageChannelWrap::SendCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2, "2 arguments are required for \"send\".");
+    CHECK_ARG(isolate, args[1]->IsObject(), "Argument \"transportContext\" shall be 'TransportContextWrap' type.");
+
+    auto message = std::make_unique<MessageChannel::Message>();
+    if (args[0]->IsString()) {
+        message->payload = v8_helpers::V8ValueTo<std::string>(args[0]);
+    } else {
+        CHECK_ARG(isolate, binary_transport::CopyPayload(args[0], message->payload),
+            "Argument \"payload\" shall be a string or an ArrayBuffer.");
+        message->binary = true;
+    }
+
+    auto transportContextWrap = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(v8::Local<v8::Object>::Cast(args[1]));
+    message->transportContext = std::move(*transportContextWrap->Get());
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder());
+    auto status = thisObject->GetRef<MessageChannel>().TrySend(message);
+    if (message != nullptr) {
+        // A message that isn't sent leaves its shared objects to the sender, which may send it again.
+        *transportContextWrap->Get() = std::move(message->transportContext);
+    }
+    args.GetReturnValue().Set(static_cast<uint32_t>(status));
+}
+
+void MessageChannelWrap::WaitWritableCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsFunction(), "Argument \"callback\" shall be 'Function' type.");
+
+    auto channel = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder())->Get<MessageChannel>();
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&channel](std::function<void(void*)> complete) {
+            channel->WaitWritable([complete = std::move(complete)](bool open) {
+                complete(reinterpret_cast<void*>(static_cast<uintptr_t>(open)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            v8::Local<v8::Value> argv[] = { v8::Boolean::New(isolate, result != nullptr) };
+            // An exception of the callback is left to the caller of the completion.
+            if (jsCallback->Call(context, context->Global(), 1, argv).IsEmpty()) {
+                return;
+            }
+        }
+    );
+}
+
+void MessageChannelWrap::ReceiveCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsFunction(), "Argument \"callback\" shall be 'Function' type.");
+
+    // Receivers waiting on an empty channel are woken by a completion posted to their worker by the sender.
+    auto channel = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder())->Get<MessageChannel>();
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&channel](std::function<void(void*)> complete) {
+            channel->Receive([complete = std::move(complete)](std::unique_ptr<MessageChannel::Message> message) {
+                complete(message.release());
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            // Callback arguments are (payload, transportContext) for a message, and none once the channel is closed and drained.
+            std::unique_ptr<MessageChannel::Message> message(static_cast<MessageChannel::Message*>(result));
+            v8::Local<v8::Value> argv[2] = { v8::Undefined(isolate), v8::Undefined(isolate) };
+            if (message != nullptr) {
+                ToV8(*message, argv[0], argv[1]);
+            }
+            // An exception of the callback is left to the caller of the completion.
+            if (jsCallback->Call(context, context->Global(), 2, argv).IsEmpty()) {
+                return;
+            }
+        }
+    );
+}
+
+void MessageChannelWrap::TryReceiveCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder());
+    auto message = thisObject->GetRef<MessageChannel>().TryReceive();
+    if (message == nullptr) {
+        return;
+    }
+
+    v8::Local<v8::Value> payload;
+    v8::Local<v8::Value> transportContext;
+    ToV8(*message, payload, transportContext);
+
+    auto result = v8::Array::New(isolate, 2);
+    result->CreateDataProperty(context, 0, payload).FromJust();
+    result->CreateDataProperty(context, 1, transportContext).FromJust();
+    args.GetReturnValue().Set(result);
+}
+
+void MessageChannelWrap::CloseCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder());
+    thisObject->GetRef<MessageChannel>().Close();
+}
+
+void MessageChannelWrap::IsClosedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder());
+    args.GetReturnValue().Set(thisObject->GetRef<MessageChannel>().IsClosed());
+}
+
+void MessageChannelWrap::GetSizeCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder());
+    args.GetReturnValue().Set(static_cast<uint32_t>(thisObject->GetRef<MessageChannel>().GetSize()));
+}
+
+void MessageChannelWrap::GetCapacityCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<MessageChannelWrap>(args.Holder());
+    args.GetReturnValue().Set(static_cast<uint32_t>(thisObject->GetRef<MessageChannel>().GetCapacity()));
+}
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/module.h>
+#include <napa/module/shareable-wrap.h>
+
+namespace napa {
+namespace module {
+
+    /// <summary> It wraps napa::zone::MessageChannel, which is shared by all workers a channel is transported to. </summary>
+    /// <remarks> Reference: napajs/lib/channel.ts </remarks>
+    class MessageChannelWrap : public ShareableWrap {
+    public:
+        /// <summary> Init this wrap. </summary>
+        static void Init();
+
+        /// <summary> Declare constructor in public, so we can export class constructor in JavaScript world. </summary>
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR
+
+        /// <summary> Exported class name. </summary>
+        static constexpr const char* exportName = "MessageChannelWrap";
+
+    private:
+        /// <summary> It implements MessageChannel.send(payload: string | ArrayBuffer, transportContext: TransportContext): number </summary>
+        static void SendCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements MessageChannel.waitWritable(callback: (open: boolean) => void): void </summary>
+        static void WaitWritableCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements MessageChannel.receive(callback: (payload, transportContext) => void): void </summary>
+        static void ReceiveCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements MessageChannel.tryReceive(): [payload, transportContext] | undefined </summary>
+        static void TryReceiveCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements MessageChannel.close(): void </summary>
+        static void CloseCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements MessageChannel.closed </summary>
+        static void IsClosedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements MessageChannel.size </summary>
+        static void GetSizeCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements MessageChannel.capacity </summary>
+        static void GetCapacityCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+    };
+}
+}
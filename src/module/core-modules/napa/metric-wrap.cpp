@@ -7,6 +7,7 @@ using namespace napa::module;
 using namespace napa::v8_helpers;
 
 NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(MetricWrap);
+NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(BoundMetricWrap);
 
 void MetricWrap::Init() {
     auto isolate = v8::Isolate::GetCurrent();
@@ -20,9 +21,12 @@ void MetricWrap::Init() {
     NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "set", Set);
     NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "increment", Increment);
     NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "decrement", Decrement);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "bind", Bind);
 
     // Set persistent constructor into V8.
     NAPA_SET_PERSISTENT_CONSTRUCTOR(_exportName, functionTemplate->GetFunction());
+
+    BoundMetricWrap::Init();
 }
 
 MetricWrap::MetricWrap(napa::providers::Metric* metric, uint32_t dimensions) :
@@ -88,6 +92,21 @@ void MetricWrap::Decrement(const v8::FunctionCallbackInfo<v8::Value>& args) {
     });
 }
 
+void MetricWrap::Bind(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    napa::providers::BoundMetricPtr boundMetric;
+    InvokeWithDimensions(args, 0, [&boundMetric](napa::providers::Metric* metric, std::vector<const char*>& dimensions) {
+        boundMetric = napa::providers::BindMetric(metric, dimensions.size(), dimensions.data());
+    });
+
+    // A wrong dimensions count threw already.
+    if (boundMetric != nullptr) {
+        args.GetReturnValue().Set(BoundMetricWrap::NewInstance(std::move(boundMetric)));
+    }
+}
+
 template <typename Func>
 void MetricWrap::InvokeWithDimensions(const v8::FunctionCallbackInfo<v8::Value>& args, uint32_t index, Func&& func) {
     auto isolate = v8::Isolate::GetCurrent();
@@ -122,4 +141,51 @@ void MetricWrap::InvokeWithDimensions(const v8::FunctionCallbackInfo<v8::Value>&
     }
 
     func(wrap->_metric, dimensions);
-}
\ No newline at end of file
+}
+void BoundMetricWrap::Init() {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    // Prepare constructor template.
+    auto functionTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<BoundMetricWrap>);
+    functionTemplate->SetClassName(MakeV8String(isolate, exportName));
+    functionTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+    // Prototypes.
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "set", Set);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "increment", Increment);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "decrement", Decrement);
+
+    // Set persistent constructor into V8.
+    NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, functionTemplate->GetFunction());
+}
+
+v8::Local<v8::Object> BoundMetricWrap::NewInstance(napa::providers::BoundMetricPtr boundMetric) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    auto constructor = NAPA_GET_PERSISTENT_CONSTRUCTOR(exportName, BoundMetricWrap);
+    auto object = constructor->NewInstance(context).ToLocalChecked();
+    auto wrap = NAPA_OBJECTWRAP::Unwrap<BoundMetricWrap>(object);
+
+    wrap->_boundMetric = std::move(boundMetric);
+    return object;
+}
+
+void BoundMetricWrap::Set(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsUint32(), "'value' argument must be a valid Uint32");
+
+    auto wrap = NAPA_OBJECTWRAP::Unwrap<BoundMetricWrap>(args.Holder());
+    wrap->_boundMetric->Set(args[0]->Uint32Value());
+}
+
+void BoundMetricWrap::Increment(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto wrap = NAPA_OBJECTWRAP::Unwrap<BoundMetricWrap>(args.Holder());
+    wrap->_boundMetric->Increment(1);
+}
+
+void BoundMetricWrap::Decrement(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto wrap = NAPA_OBJECTWRAP::Unwrap<BoundMetricWrap>(args.Holder());
+    wrap->_boundMetric->Decrement(1);
+}
@@ -49,6 +49,7 @@ namespace module {
         static void Set(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void Increment(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void Decrement(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void Bind(const v8::FunctionCallbackInfo<v8::Value>& args);
 
         /// <summary>
         ///     Helper method that extracts the dimensions and metric from args and calls the func 
@@ -57,5 +58,36 @@ namespace module {
         template <typename Func>
         static void InvokeWithDimensions(const v8::FunctionCallbackInfo<v8::Value>& args, uint32_t index, Func&& func);
     };
+
+    /// <summary> An object wrap to expose a metric with its dimension values bound, returned by Metric.bind. </summary>
+    class BoundMetricWrap : public NAPA_OBJECTWRAP {
+    public:
+
+        /// <summary> Exported class name. </summary>
+        static constexpr const char* exportName = "BoundMetricWrap";
+
+        /// <summary> Initializes the wrap. </summary>
+        static void Init();
+
+        /// <summary> Create a new BoundMetricWrap instance that owns the provided bound metric. </summary>
+        static v8::Local<v8::Object> NewInstance(napa::providers::BoundMetricPtr boundMetric);
+
+    private:
+
+        /// <summary> Declare persistent constructor to create BoundMetric Javascript wrapper instance. </summary>
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR;
+
+        /// <summary> The underlying bound metric, destroyed with the wrap. </summary>
+        napa::providers::BoundMetricPtr _boundMetric;
+
+        // BoundMetricWrap methods
+        static void Set(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void Increment(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void Decrement(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> Friend default constructor callback. </summary>
+        template <typename WrapType>
+        friend void napa::module::DefaultConstructorCallback(const v8::FunctionCallbackInfo<v8::Value>&);
+    };
 }
 }
\ No newline at end of file
@@ -6,15 +6,39 @@
 #include "metric-wrap.h"
 #include "allocator-debugger-wrap.h"
 #include "allocator-wrap.h"
+#include "binary-transport.h"
 #include "call-context-wrap.h"
+#include "cancellation-token-wrap.h"
+#include "kernels.h"
+#include "message-channel-wrap.h"
 #include "shared-ptr-wrap.h"
+#include "store-watcher-wrap.h"
+#include "store-writer-wrap.h"
 #include "store-wrap.h"
+#include "stream-channel-wrap.h"
 #include "transport-context-wrap-impl.h"
 #include "zone-wrap.h"
 
+#include <memory/buffer-pool.h>
+#include <module/loader/function-registry.h>
+#include <module/loader/javascript-module-loader.h>
+#include <module/loader/module-bundle.h>
+#include <module/loader/module-loader.h>
+#include <module/loader/module-versions.h>
+#include <module/loader/resolution-cache.h>
+#include <providers/console-sink.h>
+#include <providers/metric-export.h>
+#include <zone/call-recorder.h>
+#include <zone/cancellation-token.h>
+#include <zone/message-channel.h>
+#include <zone/stream-channel.h>
+#include <zone/tracing.h>
+#include <zone/transport-accounting.h>
 #include <zone/worker-context.h>
+#include <zone/zone.h>
 
 #include <napa/zone.h>
+#include <napa/async.h>
 #include <napa/memory.h>
 #include <napa/module/binding.h>
 #include <napa/module/binding/wraps.h>
@@ -28,10 +52,194 @@ static void RegisterBinding(v8::Local<v8::Object> module) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
 
+    // Functions resolved from a previous binding module are stale.
+    binding::ReleaseCache();
+
     auto persistentModule = new v8::Persistent<v8::Object>(isolate, module);
     zone::WorkerContext::Set(zone::WorkerContextItem::NAPA_BINDING, persistentModule);
 }
 
+namespace {
+    typedef v8::Persistent<v8::Object, v8::CopyablePersistentTraits<v8::Object>> PersistentObject;
+    typedef v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>> PersistentFunction;
+
+    /// <summary> A function resolved by name, with the object it was read from. </summary>
+    struct CachedFunction {
+        PersistentObject holder;
+        PersistentFunction function;
+    };
+
+    /// <summary>
+    ///     Functions and constructors napa::module::binding resolved by name, keyed by module name and function name.
+    ///     Wrap types of napa binding have an empty module name. One per isolate, at worker context.
+    /// </summary>
+    struct BindingCache {
+        std::unordered_map<std::string, CachedFunction> functions;
+
+        /// <summary>
+        ///     Store wraps by store id, held weakly so they don't keep stores alive. A live wrap holds its store,
+        ///     which stays registered under the id, thus it's what a lookup of the id would return.
+        /// </summary>
+        std::unordered_map<std::string, PersistentObject> stores;
+
+        /// <summary> Zone wraps by zone id, held weakly like store wraps, as a live wrap holds its zone registered too. </summary>
+        std::unordered_map<std::string, PersistentObject> zones;
+
+        /// <summary> Buffer the key of a lookup is built in, which saves an allocation per lookup. </summary>
+        std::string key;
+    };
+
+    BindingCache& GetBindingCache() {
+        auto cache = static_cast<BindingCache*>(zone::WorkerContext::Get(zone::WorkerContextItem::BINDING_CACHE));
+        if (cache == nullptr) {
+            cache = new BindingCache();
+            zone::WorkerContext::Set(zone::WorkerContextItem::BINDING_CACHE, cache);
+        }
+        return *cache;
+    }
+
+    /// <summary> Looks up a cached function, creating its locals in the caller's handle scope. </summary>
+    bool FindCachedFunction(
+        BindingCache& cache,
+        const char* moduleName,
+        const char* functionName,
+        v8::Local<v8::Object>& holder,
+        v8::Local<v8::Function>& function) {
+
+        cache.key.assign(moduleName).push_back('\0');
+        cache.key.append(functionName);
+
+        auto it = cache.functions.find(cache.key);
+        if (it == cache.functions.end()) {
+            return false;
+        }
+
+        auto isolate = v8::Isolate::GetCurrent();
+        holder = v8::Local<v8::Object>::New(isolate, it->second.holder);
+        function = v8::Local<v8::Function>::New(isolate, it->second.function);
+        return true;
+    }
+
+    /// <summary> Caches a resolved function under the key of the last lookup. </summary>
+    void AddCachedFunction(BindingCache& cache, v8::Local<v8::Object> holder, v8::Local<v8::Function> function) {
+        auto isolate = v8::Isolate::GetCurrent();
+        auto& entry = cache.functions[cache.key];
+        entry.holder.Reset(isolate, holder);
+        entry.function.Reset(isolate, function);
+    }
+
+    void OnWrapCollected(const v8::WeakCallbackInfo<PersistentObject>& data) {
+        // Entries are kept, map nodes don't move, and the next lookup of the id refills them.
+        data.GetParameter()->Reset();
+    }
+
+    /// <summary> Get the wrap of an id from cached wraps, if there is one alive. </summary>
+    v8::Local<v8::Object> FindWrap(std::unordered_map<std::string, PersistentObject>& wraps, const std::string& id) {
+        auto it = wraps.find(id);
+        if (it == wraps.end() || it->second.IsEmpty()) {
+            return v8::Local<v8::Object>();
+        }
+        return v8::Local<v8::Object>::New(v8::Isolate::GetCurrent(), it->second);
+    }
+
+    /// <summary> Get the wrap of a store with an id in the current isolate, if there is one alive. </summary>
+    v8::Local<v8::Object> FindStoreWrap(const std::string& id) {
+        return FindWrap(GetBindingCache().stores, id);
+    }
+
+    /// <summary> Creates the wrap of a store, which lookups of its id in the current isolate return while it's alive. </summary>
+    v8::Local<v8::Object> NewStoreWrap(std::shared_ptr<napa::store::Store> store) {
+        auto& entry = GetBindingCache().stores[store->GetId()];
+        auto wrap = StoreWrap::NewInstance(std::move(store));
+        entry.Reset(v8::Isolate::GetCurrent(), wrap);
+        entry.SetWeak(&entry, OnWrapCollected, v8::WeakCallbackType::kParameter);
+        return wrap;
+    }
+
+    /// <summary> Get the wrap of a zone with an id in the current isolate, if there is one alive. </summary>
+    v8::Local<v8::Object> FindZoneWrap(const std::string& id) {
+        return FindWrap(GetBindingCache().zones, id);
+    }
+
+    /// <summary> Creates the wrap of a zone, which lookups of its id in the current isolate return while it's alive. </summary>
+    v8::Local<v8::Object> NewZoneWrap(std::unique_ptr<napa::Zone> zoneProxy) {
+        auto& entry = GetBindingCache().zones[zoneProxy->GetId()];
+        auto wrap = ZoneWrap::NewInstance(std::move(zoneProxy));
+        entry.Reset(v8::Isolate::GetCurrent(), wrap);
+        entry.SetWeak(&entry, OnWrapCollected, v8::WeakCallbackType::kParameter);
+        return wrap;
+    }
+}
+
+v8::MaybeLocal<v8::Function> napa::module::binding::GetWrapConstructor(const char* wrapType) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto& cache = GetBindingCache();
+
+    v8::Local<v8::Object> binding;
+    v8::Local<v8::Function> constructor;
+    if (!FindCachedFunction(cache, "", wrapType, binding, constructor)) {
+        v8::EscapableHandleScope scope(isolate);
+
+        binding = GetBinding();
+        auto value = binding->Get(napa::v8_helpers::MakeV8String(isolate, wrapType));
+        JS_ENSURE_WITH_RETURN(
+            isolate,
+            !value.IsEmpty() && value->IsFunction(),
+            v8::MaybeLocal<v8::Function>(),
+            "Wrap type \"%s\" is not found in napa binding.",
+            wrapType);
+
+        constructor = v8::Local<v8::Function>::Cast(value);
+        AddCachedFunction(cache, binding, constructor);
+        return scope.Escape(constructor);
+    }
+    return constructor;
+}
+
+v8::MaybeLocal<v8::Function> napa::module::binding::GetModuleFunction(
+    const char* moduleName,
+    const char* functionName,
+    v8::Local<v8::Object>& module) {
+
+    auto isolate = v8::Isolate::GetCurrent();
+    auto& cache = GetBindingCache();
+
+    v8::Local<v8::Function> function;
+    if (FindCachedFunction(cache, moduleName, functionName, module, function)) {
+        return function;
+    }
+
+    auto moduleHandle = Require(moduleName);
+    RETURN_VALUE_ON_PENDING_EXCEPTION(moduleHandle, v8::MaybeLocal<v8::Function>());
+
+    module = moduleHandle.ToLocalChecked();
+    auto value = module->Get(v8_helpers::MakeV8String(isolate, functionName));
+    JS_ENSURE_WITH_RETURN(
+        isolate,
+        !value.IsEmpty() && value->IsFunction(),
+        v8::MaybeLocal<v8::Function>(),
+        "Function \"%s\" is not found in module \"%s\".",
+        functionName,
+        moduleName);
+
+    function = v8::Local<v8::Function>::Cast(value);
+
+    // Require may have resolved other functions meanwhile, which reused the key buffer.
+    cache.key.assign(moduleName).push_back('\0');
+    cache.key.append(functionName);
+    AddCachedFunction(cache, module, function);
+    return function;
+}
+
+void napa::module::binding::ReleaseCache() {
+    auto cache = static_cast<BindingCache*>(zone::WorkerContext::Get(zone::WorkerContextItem::BINDING_CACHE));
+    if (cache != nullptr) {
+        // Copyable persistent handles are reset on destruction.
+        delete cache;
+        zone::WorkerContext::Set(zone::WorkerContextItem::BINDING_CACHE, nullptr);
+    }
+}
+
 v8::Local<v8::Object> napa::module::binding::GetModule() {
     auto persistentModule = 
         reinterpret_cast<v8::Persistent<v8::Object>*>(
@@ -41,18 +249,14 @@ v8::Local<v8::Object> napa::module::binding::GetModule() {
     return v8::Local<v8::Object>::New(v8::Isolate::GetCurrent(), *persistentModule);
 }
 
-static void CreateZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
+/// <summary> Converts a JS zone settings object to the settings string accepted by napa::Zone. </summary>
+static std::string GetZoneSettingsString(v8::Local<v8::Value> settings) {
     auto isolate = v8::Isolate::GetCurrent();
-    v8::HandleScope scope(isolate);
     auto context = isolate->GetCurrentContext();
 
-    CHECK_ARG(isolate, args[0]->IsString(), "first argument to createZone must be a string");
-    v8::String::Utf8Value zoneId(args[0]->ToString());
-
     std::stringstream ss;
-    if ((args.Length() > 1) && (!args[1]->IsUndefined())) {
-        CHECK_ARG(isolate, args[1]->IsObject(), "second argument to createZone must be an object");
-        auto settingsObj = args[1]->ToObject(context).ToLocalChecked();
+    if (!settings->IsUndefined()) {
+        auto settingsObj = settings->ToObject(context).ToLocalChecked();
 
         auto settingsMap = napa::v8_helpers::V8ObjectToMap<std::string>(isolate, settingsObj);
 
@@ -60,15 +264,64 @@ static void CreateZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
             ss << " --" << kv.first << " " << kv.second;
         }
     }
+    return ss.str();
+}
+
+static void CreateZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args[0]->IsString(), "first argument to createZone must be a string");
+    v8::String::Utf8Value zoneId(args[0]->ToString());
+
+    std::string settings;
+    if (args.Length() > 1) {
+        CHECK_ARG(isolate, args[1]->IsUndefined() || args[1]->IsObject(), "second argument to createZone must be an object");
+        settings = GetZoneSettingsString(args[1]);
+    }
 
     try {
-        auto zoneProxy = std::make_unique<napa::Zone>(*zoneId, ss.str());
-        args.GetReturnValue().Set(ZoneWrap::NewInstance(std::move(zoneProxy)));
+        auto zoneProxy = std::make_unique<napa::Zone>(*zoneId, settings);
+        args.GetReturnValue().Set(NewZoneWrap(std::move(zoneProxy)));
     } catch (const std::exception& ex) {
         JS_FAIL(isolate, ex.what());
     }
 }
 
+static void CreateZoneAsync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args[0]->IsString(), "first argument to createZoneAsync must be a string");
+    CHECK_ARG(isolate, args[1]->IsUndefined() || args[1]->IsObject(), "second argument to createZoneAsync must be an object");
+    CHECK_ARG(isolate, args[2]->IsFunction(), "third argument to createZoneAsync must be the callback");
+
+    std::string zoneId = *v8::String::Utf8Value(args[0]->ToString());
+    auto settings = GetZoneSettingsString(args[1]);
+
+    // Workers are started and bootstrapped on a separate thread, so the calling isolate keeps running meanwhile.
+    napa::zone::MakeAsyncTask()
+        .Post([zoneId = std::move(zoneId), settings = std::move(settings)]() {
+            return std::make_unique<napa::Zone>(zoneId, settings);
+        })
+        .Finally(v8::Local<v8::Function>::Cast(args[2]),
+            [](v8::Local<v8::Function> jsCallback, napa::zone::AsyncResult<std::unique_ptr<napa::Zone>>& result) {
+                auto isolate = v8::Isolate::GetCurrent();
+                auto context = isolate->GetCurrentContext();
+
+                std::vector<v8::Local<v8::Value>> argv;
+                try {
+                    auto zoneProxy = std::move(result.Get());
+                    argv.emplace_back(v8::Undefined(isolate));
+                    argv.emplace_back(NewZoneWrap(std::move(zoneProxy)));
+                } catch (const std::exception& ex) {
+                    argv.emplace_back(v8_helpers::MakeV8String(isolate, ex.what()));
+                }
+
+                (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+            });
+}
+
 static void GetZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
@@ -76,15 +329,63 @@ static void GetZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
     CHECK_ARG(isolate, args[0]->IsString(), "first argument to getZone must be a string");
     v8::String::Utf8Value zoneId(args[0]->ToString());
 
+    // Services resolving a zone per request get the wrap of their isolate, without a lookup of the zone registry.
+    auto wrap = FindZoneWrap(*zoneId);
+    if (!wrap.IsEmpty()) {
+        args.GetReturnValue().Set(wrap);
+        return;
+    }
+
     try {
         auto zoneProxy = napa::Zone::Get(*zoneId);
-        args.GetReturnValue().Set(ZoneWrap::NewInstance(std::move(zoneProxy)));
+        args.GetReturnValue().Set(NewZoneWrap(std::move(zoneProxy)));
     }
     catch (const std::exception &ex) {
         JS_ASSERT(isolate, false, ex.what());
     }
 }
 
+static void ConnectZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args[0]->IsString(), "first argument to connectZone must be a string");
+    v8::String::Utf8Value address(args[0]->ToString());
+
+    try {
+        auto zoneProxy = napa::Zone::Connect(*address);
+        args.GetReturnValue().Set(ZoneWrap::NewInstance(std::move(zoneProxy)));
+    } catch (const std::exception& ex) {
+        JS_FAIL(isolate, "%s", ex.what());
+    }
+}
+
+static void GroupZones(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    CHECK_ARG(isolate, args[0]->IsString(), "first argument to groupZones must be a string");
+    CHECK_ARG(isolate, args[1]->IsArray(), "second argument to groupZones must be an array of zones");
+    CHECK_ARG(isolate, args[2]->IsUint32(), "third argument to groupZones must be an unsigned integer");
+    v8::String::Utf8Value groupId(args[0]->ToString());
+
+    auto zones = v8::Local<v8::Array>::Cast(args[1]);
+    std::vector<const napa::Zone*> members;
+    for (uint32_t i = 0; i < zones->Length(); i++) {
+        auto member = ZoneWrap::GetZoneProxy(zones->Get(context, i).ToLocalChecked());
+        CHECK_ARG(isolate, member != nullptr, "second argument to groupZones must be an array of zones");
+        members.push_back(member);
+    }
+
+    try {
+        auto zoneProxy = napa::Zone::Group(*groupId, members, args[2]->Uint32Value());
+        args.GetReturnValue().Set(ZoneWrap::NewInstance(std::move(zoneProxy)));
+    } catch (const std::exception& ex) {
+        JS_FAIL(isolate, "%s", ex.what());
+    }
+}
+
 static void GetCurrentZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
@@ -95,32 +396,137 @@ static void GetCurrentZone(const v8::FunctionCallbackInfo<v8::Value>& args) {
 /////////////////////////////////////////////////////////////////////
 /// Store APIs
 
+/// <summary> Parses store options from an optional object of StoreOptions. Reference: napajs/lib/store/store.ts#StoreOptions </summary>
+static bool GetStoreOptions(const v8::FunctionCallbackInfo<v8::Value>& args, napa::store::StoreOptions& storeOptions) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    if (args.Length() < 2 || args[1]->IsUndefined()) {
+        return true;
+    }
+    CHECK_ARG_WITH_RETURN(isolate, args[1]->IsObject(), false, "Argument 'options' must be an object.");
+    auto options = v8::Local<v8::Object>::Cast(args[1]);
+
+    auto getOption = [&](const char* name) {
+        auto maybe = options->Get(context, v8_helpers::MakeV8String(isolate, name));
+        return maybe.IsEmpty() ? v8::Undefined(isolate).As<v8::Value>() : maybe.ToLocalChecked();
+    };
+
+    auto transport = getOption("transport");
+    if (!transport->IsUndefined()) {
+        storeOptions.transport = static_cast<napa::TransportOption>(transport->Uint32Value(context).FromJust());
+        CHECK_ARG_WITH_RETURN(isolate,
+            storeOptions.transport == napa::TransportOption::AUTO || storeOptions.transport == napa::TransportOption::BINARY,
+            false,
+            "Option 'transport' must be TransportOption.AUTO or TransportOption.BINARY.");
+    }
+
+    auto shards = getOption("shards");
+    if (!shards->IsUndefined()) {
+        CHECK_ARG_WITH_RETURN(isolate, shards->IsUint32() && shards->Uint32Value() > 0, false, "Option 'shards' must be a positive integer.");
+        storeOptions.shards = shards->Uint32Value();
+    }
+
+    // TTL and limits are in numbers of milliseconds, entries and bytes.
+    auto getLimit = [&](const char* name, size_t& limit) {
+        auto value = getOption(name);
+        if (value->IsUndefined()) {
+            return true;
+        }
+        CHECK_ARG_WITH_RETURN(isolate, value->IsNumber() && value->NumberValue() >= 0, false, "Option '%s' must be a non-negative number.", name);
+        limit = static_cast<size_t>(value->NumberValue());
+        return true;
+    };
+    size_t ttl = 0;
+    if (!getLimit("ttl", ttl) || !getLimit("maxEntries", storeOptions.maxEntries) || !getLimit("maxBytes", storeOptions.maxBytes)
+        || !getLimit("compressAbove", storeOptions.compressAbove)) {
+        return false;
+    }
+    storeOptions.ttl = std::chrono::milliseconds(ttl);
+
+    storeOptions.readOptimized = getOption("readOptimized")->BooleanValue();
+    CHECK_ARG_WITH_RETURN(isolate,
+        !storeOptions.readOptimized || (ttl == 0 && storeOptions.maxEntries == 0 && storeOptions.maxBytes == 0),
+        false,
+        "Options 'ttl', 'maxEntries' and 'maxBytes' are not supported by read optimized stores.");
+
+    storeOptions.shared = getOption("shared")->BooleanValue();
+    CHECK_ARG_WITH_RETURN(isolate,
+        !storeOptions.shared || (ttl == 0 && !storeOptions.readOptimized && storeOptions.compressAbove == 0),
+        false,
+        "Options 'ttl', 'readOptimized' and 'compressAbove' are not supported by shared stores.");
+
+    auto replicaAddress = getOption("replicaAddress");
+    if (!replicaAddress->IsUndefined()) {
+        CHECK_ARG_WITH_RETURN(isolate, replicaAddress->IsString(), false, "Option 'replicaAddress' must be a string.");
+        CHECK_ARG_WITH_RETURN(isolate, !storeOptions.shared, false, "Option 'replicaAddress' is not supported by shared stores.");
+        storeOptions.replicaAddress = napa::v8_helpers::V8ValueTo<std::string>(replicaAddress);
+    }
+    auto replicaPeers = getOption("replicaPeers");
+    if (!replicaPeers->IsUndefined()) {
+        CHECK_ARG_WITH_RETURN(isolate, replicaPeers->IsArray(), false, "Option 'replicaPeers' must be an array of strings.");
+        auto peers = v8::Local<v8::Array>::Cast(replicaPeers);
+        for (uint32_t i = 0; i < peers->Length(); i++) {
+            auto peer = peers->Get(i);
+            CHECK_ARG_WITH_RETURN(isolate, peer->IsString(), false, "Option 'replicaPeers' must be an array of strings.");
+            storeOptions.replicaPeers.emplace_back(napa::v8_helpers::V8ValueTo<std::string>(peer));
+        }
+    }
+    if (getOption("cacheValues")->BooleanValue()) {
+        storeOptions.valueCache = getOption("freezeValues")->BooleanValue() ?
+            napa::store::ValueCacheOption::FROZEN : napa::store::ValueCacheOption::SHARED;
+    }
+    return true;
+}
+
 static void CreateStore(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
 
-    CHECK_ARG(isolate, args.Length() == 1, "1 argument of 'id' is required.");
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 argument of 'id' is required, followed by optional 'options'.");
     CHECK_ARG(isolate, args[0]->IsString(), "Argument 'id' must be string.");
 
+    napa::store::StoreOptions options;
+    if (!GetStoreOptions(args, options)) {
+        return;
+    }
+
     auto id = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
-    auto store = napa::store::CreateStore(id.c_str());
+    auto store = napa::store::CreateStore(id.c_str(), options);
 
+    JS_ENSURE(isolate, store != nullptr || !options.shared || napa::store::GetStore(id.c_str()) != nullptr,
+        "Failed to create or attach shared memory of store \"%s\".", id.c_str());
+    JS_ENSURE(isolate, store != nullptr || options.replicaAddress.empty() || napa::store::GetStore(id.c_str()) != nullptr,
+        "Failed to replicate store \"%s\" on \"%s\".", id.c_str(), options.replicaAddress.c_str());
     JS_ENSURE(isolate, store != nullptr, "Store with id \"%s\" already exists.", id.c_str());
 
-    args.GetReturnValue().Set(StoreWrap::NewInstance(store));
+    args.GetReturnValue().Set(NewStoreWrap(std::move(store)));
 }
 
 static void GetOrCreateStore(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
 
-    CHECK_ARG(isolate, args.Length() == 1, "1 argument of 'id' is required.");
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 argument of 'id' is required, followed by optional 'options'.");
     CHECK_ARG(isolate, args[0]->IsString(), "Argument 'id' must be string.");
 
+    napa::store::StoreOptions options;
+    if (!GetStoreOptions(args, options)) {
+        return;
+    }
+
     auto id = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
-    auto store = napa::store::GetOrCreateStore(id.c_str());
+    auto wrap = FindStoreWrap(id);
+    if (!wrap.IsEmpty()) {
+        args.GetReturnValue().Set(wrap);
+        return;
+    }
 
-    args.GetReturnValue().Set(StoreWrap::NewInstance(store));
+    auto store = napa::store::GetOrCreateStore(id.c_str(), options);
+
+    JS_ENSURE(isolate, store != nullptr, "Failed to create, attach or replicate store \"%s\".", id.c_str());
+
+    args.GetReturnValue().Set(NewStoreWrap(std::move(store)));
 }
 
 static void GetStore(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -131,13 +537,39 @@ static void GetStore(const v8::FunctionCallbackInfo<v8::Value>& args) {
     CHECK_ARG(isolate, args[0]->IsString(), "Argument 'id' must be string.");
 
     auto id = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
+    auto wrap = FindStoreWrap(id);
+    if (!wrap.IsEmpty()) {
+        args.GetReturnValue().Set(wrap);
+        return;
+    }
+
     auto store = napa::store::GetStore(id.c_str());
 
     if (store != nullptr) {
-        args.GetReturnValue().Set(StoreWrap::NewInstance(store));
+        args.GetReturnValue().Set(NewStoreWrap(std::move(store)));
     }
 }
 
+static void LoadStore(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 argument of 'path' is required, followed by optional 'id'.");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'path' must be string.");
+    CHECK_ARG(isolate, args.Length() == 1 || args[1]->IsString() || args[1]->IsUndefined(), "Argument 'id' must be string.");
+
+    auto path = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
+    auto hasId = args.Length() == 2 && args[1]->IsString();
+    auto id = hasId ? napa::v8_helpers::V8ValueTo<std::string>(args[1]) : std::string();
+
+    std::string error;
+    auto store = napa::store::LoadStore(path.c_str(), hasId ? id.c_str() : nullptr, error);
+
+    JS_ENSURE(isolate, store != nullptr, "%s", error.c_str());
+
+    args.GetReturnValue().Set(NewStoreWrap(std::move(store)));
+}
+
 static void GetStoreCount(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(static_cast<uint32_t>(napa::store::GetStoreCount()));
 }
@@ -156,6 +588,34 @@ static void GetDefaultAllocator(const v8::FunctionCallbackInfo<v8::Value>& args)
             [](napa::memory::Allocator*){})));
 }
 
+static void GetThreadCachingAllocator(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(binding::CreateAllocatorWrap(
+        std::shared_ptr<napa::memory::Allocator>(
+            &napa::memory::GetThreadCachingAllocator(),
+            [](napa::memory::Allocator*){})));
+}
+
+static void GetArrayBufferPool(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(binding::CreateAllocatorDebuggerWrap(
+        std::shared_ptr<napa::memory::AllocatorDebugger>(
+            &napa::memory::BufferPool::GetInstance(),
+            [](napa::memory::AllocatorDebugger*){})));
+}
+
+static void MemoryPressure(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsUint32(), "1 argument of 'level' is required.");
+    auto level = args[0]->Uint32Value();
+    CHECK_ARG(isolate, level <= MEMORY_PRESSURE_CRITICAL, "Argument 'level' must be 0 (none), 1 (moderate) or 2 (critical).");
+
+    napa::NotifyMemoryPressure(static_cast<napa::MemoryPressureLevel>(level));
+
+    // The calling isolate is notified right away, which is the only way to reach the isolate of Node.
+    isolate->MemoryPressureNotification(static_cast<v8::MemoryPressureLevel>(level));
+}
+
 static void Log(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
@@ -173,9 +633,12 @@ static void Log(const v8::FunctionCallbackInfo<v8::Value>& args) {
         section = sectionValue.Length() > 0 ? sectionValue.Data() : "";
     }
 
-    auto& logger = napa::providers::GetLoggingProvider();
-
     // If log is not enabled we can return early.
+    if (static_cast<int>(level) > napa::providers::GetLogLevel(section).load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto& logger = napa::providers::GetLoggingProvider();
     if (!logger.IsLogEnabled(section, level)) {
         return;
     }
@@ -183,11 +646,14 @@ static void Log(const v8::FunctionCallbackInfo<v8::Value>& args) {
     CHECK_ARG(isolate, args[2]->IsString() || args[2]->IsUndefined(), "'traceId' must be a valid string or undefined");
     CHECK_ARG(isolate, args[3]->IsString(), "'message' must be a valid string");
 
+    // Logs without a trace id take the one of the call being executed, if any.
     napa::v8_helpers::Utf8String traceIdValue;
     const char* traceId = "";
     if (!args[2]->IsUndefined()) {
         traceIdValue = napa::v8_helpers::V8ValueTo<napa::v8_helpers::Utf8String>(args[2]);
         traceId = traceIdValue.Length() > 0 ? traceIdValue.Data() : "";
+    } else if (auto callTraceId = static_cast<const char*>(napa::zone::WorkerContext::Get(napa::zone::WorkerContextItem::CALL_TRACE_ID))) {
+        traceId = callTraceId;
     }
 
     v8::String::Utf8Value message(args[3]->ToString());
@@ -202,37 +668,541 @@ static void Log(const v8::FunctionCallbackInfo<v8::Value>& args) {
     logger.LogMessage(section, level, traceId, *file, line, *message);
 }
 
+static void SetLogLevel(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2, "setLogLevel accepts exactly 2 arguments (level, section)");
+    CHECK_ARG(isolate, args[0]->IsUint32() && args[0]->Uint32Value() <= 3, "'level' must be a uint32 type that represents the native enum");
+    CHECK_ARG(isolate, args[1]->IsString() || args[1]->IsUndefined(), "'section' must be a valid string or undefined");
+
+    auto level = static_cast<napa::providers::LoggingProvider::Verboseness>(args[0]->Uint32Value());
+    if (args[1]->IsUndefined()) {
+        napa::providers::SetLogLevel(nullptr, level);
+    } else {
+        auto section = napa::v8_helpers::V8ValueTo<napa::v8_helpers::Utf8String>(args[1]);
+        napa::providers::SetLogLevel(section.Length() > 0 ? section.Data() : "", level);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Metric APIs
+
+/// <summary> Gets the percentiles argument of metric snapshots, an array of numbers in [0, 100]. </summary>
+static bool GetPercentiles(v8::Isolate* isolate, const v8::Local<v8::Value>& value, std::vector<double>& percentiles) {
+    if (!value->IsArray()) {
+        return false;
+    }
+
+    auto context = isolate->GetCurrentContext();
+    auto array = v8::Local<v8::Array>::Cast(value);
+    for (uint32_t i = 0; i < array->Length(); ++i) {
+        auto percentile = array->Get(context, i).ToLocalChecked();
+        if (!percentile->IsNumber() || percentile->NumberValue() < 0 || percentile->NumberValue() > 100) {
+            return false;
+        }
+        percentiles.push_back(percentile->NumberValue());
+    }
+    return true;
+}
+
+/// <summary> Gets snapshots of the metric provider, which must support them. </summary>
+static bool TakeMetricSnapshots(
+    const v8::FunctionCallbackInfo<v8::Value>& args,
+    std::vector<double>& percentiles,
+    std::vector<napa::providers::MetricSnapshot>& snapshots) {
+
+    auto isolate = args.GetIsolate();
+    CHECK_ARG_WITH_RETURN(isolate,
+        args.Length() == 1 && GetPercentiles(isolate, args[0], percentiles),
+        false,
+        "1 argument of 'percentiles' is required, as an array of numbers in [0, 100].");
+
+    auto snapshotProvider = napa::providers::GetMetricSnapshotProvider();
+    JS_ENSURE_WITH_RETURN(isolate,
+        snapshotProvider != nullptr,
+        false,
+        "The metric provider doesn't keep metric values, set platform setting 'metricProvider' to 'in-process'.");
+
+    snapshots = snapshotProvider->GetSnapshots(percentiles);
+    return true;
+}
+
+static v8::Local<v8::Array> MakeV8StringArray(v8::Isolate* isolate, const std::vector<std::string>& values) {
+    auto context = isolate->GetCurrentContext();
+    auto array = v8::Array::New(isolate, static_cast<int>(values.size()));
+    for (uint32_t i = 0; i < values.size(); ++i) {
+        (void)array->CreateDataProperty(context, i, napa::v8_helpers::MakeV8String(isolate, values[i]));
+    }
+    return array;
+}
+
+static void GetMetricSnapshots(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    std::vector<double> percentiles;
+    std::vector<napa::providers::MetricSnapshot> snapshots;
+    if (!TakeMetricSnapshots(args, percentiles, snapshots)) {
+        return;
+    }
+
+    auto set = [isolate, &context](v8::Local<v8::Object> object, const char* name, v8::Local<v8::Value> value) {
+        (void)object->CreateDataProperty(context, napa::v8_helpers::MakeV8String(isolate, name), value);
+    };
+
+    auto result = v8::Array::New(isolate, static_cast<int>(snapshots.size()));
+    for (uint32_t i = 0; i < snapshots.size(); ++i) {
+        const auto& snapshot = snapshots[i];
+        auto isPercentile = snapshot.type == napa::providers::MetricType::Percentile;
+
+        auto series = v8::Array::New(isolate, static_cast<int>(snapshot.series.size()));
+        for (uint32_t j = 0; j < snapshot.series.size(); ++j) {
+            const auto& seriesSnapshot = snapshot.series[j];
+
+            auto seriesObject = v8::Object::New(isolate);
+            set(seriesObject, "dimensions", MakeV8StringArray(isolate, seriesSnapshot.dimensionValues));
+            set(seriesObject, "value", v8::Number::New(isolate, static_cast<double>(seriesSnapshot.value)));
+
+            if (isPercentile) {
+                set(seriesObject, "count", v8::Number::New(isolate, static_cast<double>(seriesSnapshot.count)));
+                set(seriesObject, "min", v8::Number::New(isolate, static_cast<double>(seriesSnapshot.min)));
+                set(seriesObject, "max", v8::Number::New(isolate, static_cast<double>(seriesSnapshot.max)));
+
+                auto values = v8::Object::New(isolate);
+                for (size_t k = 0; k < percentiles.size() && k < seriesSnapshot.percentiles.size(); ++k) {
+                    (void)values->CreateDataProperty(
+                        context,
+                        v8::Number::New(isolate, percentiles[k])->ToString(context).ToLocalChecked(),
+                        v8::Number::New(isolate, static_cast<double>(seriesSnapshot.percentiles[k])));
+                }
+                set(seriesObject, "percentiles", values);
+            }
+            (void)series->CreateDataProperty(context, j, seriesObject);
+        }
+
+        auto snapshotObject = v8::Object::New(isolate);
+        set(snapshotObject, "section", napa::v8_helpers::MakeV8String(isolate, snapshot.section));
+        set(snapshotObject, "name", napa::v8_helpers::MakeV8String(isolate, snapshot.name));
+        set(snapshotObject, "type", v8::Uint32::NewFromUnsigned(isolate, static_cast<uint32_t>(snapshot.type)));
+        set(snapshotObject, "dimensionNames", MakeV8StringArray(isolate, snapshot.dimensionNames));
+        set(snapshotObject, "series", series);
+        (void)result->CreateDataProperty(context, i, snapshotObject);
+    }
+    args.GetReturnValue().Set(result);
+}
+
+static void ExportMetrics(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    std::vector<double> percentiles;
+    std::vector<napa::providers::MetricSnapshot> snapshots;
+    if (!TakeMetricSnapshots(args, percentiles, snapshots)) {
+        return;
+    }
+
+    args.GetReturnValue().Set(napa::v8_helpers::MakeV8String(
+        isolate,
+        napa::providers::FormatPrometheusText(snapshots, percentiles)));
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Tracing APIs
+
+static void StartTracing(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsUint32(), "1 argument of 'bufferSize' is required, as a uint32.");
+
+    napa::zone::Tracing::Start(args[0]->Uint32Value());
+}
+
+static void StopTracing(const v8::FunctionCallbackInfo<v8::Value>&) {
+    napa::zone::Tracing::Stop();
+}
+
+static void IsTracingEnabled(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(napa::zone::Tracing::IsEnabled());
+}
+
+static void GetTraceTime(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(static_cast<double>(napa::zone::Tracing::Now()));
+}
+
+static void RecordTraceSpan(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 3, "recordTraceSpan accepts exactly 3 arguments (name, start, traceId)");
+    CHECK_ARG(isolate, args[0]->IsString(), "'name' must be a valid string");
+    CHECK_ARG(isolate, args[1]->IsNumber(), "'start' must be a number returned by getTraceTime");
+    CHECK_ARG(isolate, args[2]->IsString() || args[2]->IsUndefined(), "'traceId' must be a valid string or undefined");
+
+    if (!napa::zone::Tracing::IsEnabled()) {
+        return;
+    }
+
+    // Spans without a trace id take the one of the call being executed, if any.
+    napa::v8_helpers::Utf8String traceIdValue;
+    const char* traceId = static_cast<const char*>(napa::zone::WorkerContext::Get(napa::zone::WorkerContextItem::CALL_TRACE_ID));
+    if (!args[2]->IsUndefined()) {
+        traceIdValue = napa::v8_helpers::V8ValueTo<napa::v8_helpers::Utf8String>(args[2]);
+        traceId = traceIdValue.Data();
+    }
+
+    auto name = napa::v8_helpers::V8ValueTo<napa::v8_helpers::Utf8String>(args[0]);
+    auto start = static_cast<int64_t>(args[1]->NumberValue());
+    napa::zone::Tracing::RecordSpan("js", name.Data(), start, napa::zone::Tracing::Now(), traceId);
+}
+
+static void ExportTrace(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    args.GetReturnValue().Set(napa::v8_helpers::MakeV8String(isolate, napa::zone::Tracing::ExportChromeJson()));
+}
+
+static void StartCallCapture(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsString(), "1 argument of 'path' is required, as a string.");
+
+    auto path = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
+    args.GetReturnValue().Set(napa::zone::CallRecorder::Start(path));
+}
+
+static void StopCallCapture(const v8::FunctionCallbackInfo<v8::Value>&) {
+    napa::zone::CallRecorder::Stop();
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Transport accounting APIs
+
+static void StartTransportAccounting(const v8::FunctionCallbackInfo<v8::Value>&) {
+    napa::zone::TransportAccounting::Start();
+}
+
+static void StopTransportAccounting(const v8::FunctionCallbackInfo<v8::Value>&) {
+    napa::zone::TransportAccounting::Stop();
+}
+
+static void IsTransportAccountingEnabled(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(napa::zone::TransportAccounting::IsEnabled());
+}
+
+static void RecordTransport(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 6, "recordTransport accepts exactly 6 arguments (zoneId, function, stage, bytes, sharedCount, start)");
+    CHECK_ARG(isolate, args[0]->IsString() || args[0]->IsUndefined(), "'zoneId' must be a valid string or undefined");
+    CHECK_ARG(isolate, args[1]->IsString(), "'function' must be a valid string");
+    CHECK_ARG(isolate, args[2]->IsString(), "'stage' must be a valid string");
+    CHECK_ARG(isolate, args[3]->IsNumber(), "'bytes' must be a number");
+    CHECK_ARG(isolate, args[4]->IsNumber(), "'sharedCount' must be a number");
+    CHECK_ARG(isolate, args[5]->IsNumber(), "'start' must be a number returned by getTraceTime");
+
+    if (!napa::zone::TransportAccounting::IsEnabled()) {
+        return;
+    }
+
+    // Stages without a zone id are recorded for the zone of the calling thread.
+    std::string zoneId;
+    if (args[0]->IsUndefined()) {
+        auto zone = static_cast<napa::zone::Zone*>(napa::zone::WorkerContext::Get(napa::zone::WorkerContextItem::ZONE));
+        if (zone != nullptr) {
+            zoneId = zone->GetId();
+        }
+    } else {
+        zoneId = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
+    }
+
+    auto function = napa::v8_helpers::V8ValueTo<napa::v8_helpers::Utf8String>(args[1]);
+    auto stage = napa::v8_helpers::V8ValueTo<napa::v8_helpers::Utf8String>(args[2]);
+    auto start = static_cast<int64_t>(args[5]->NumberValue());
+    napa::zone::TransportAccounting::Record(
+        napa::providers::GetMetricProvider(),
+        zoneId.c_str(),
+        function.Data(),
+        stage.Data(),
+        static_cast<size_t>(args[3]->NumberValue()),
+        static_cast<size_t>(args[4]->NumberValue()),
+        napa::zone::Tracing::Now() - start);
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Binary transport APIs
+
+static void SerializeValue(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2, "2 arguments of 'value' and 'hasTransportables' are required.");
+
+    std::string payload;
+    auto flags = args[1]->BooleanValue() ? binary_transport::HAS_TRANSPORTABLES : 0;
+    if (binary_transport::Serialize(args[0], flags, payload)) {
+        args.GetReturnValue().Set(binary_transport::NewPayloadBuffer(payload.data(), payload.size()));
+    }
+}
+
+static void DeserializeValue(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument of 'payload' is required.");
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    CHECK_ARG(isolate, binary_transport::GetPayloadBytes(args[0], data, size), "Argument 'payload' must be an ArrayBuffer or an ArrayBufferView.");
+
+    uint32_t flags = 0;
+    auto value = binary_transport::Deserialize(data, size, flags);
+    if (value.IsEmpty()) {
+        return;
+    }
+
+    auto result = v8::Array::New(isolate, 2);
+    (void)result->CreateDataProperty(context, 0, value.ToLocalChecked());
+    (void)result->CreateDataProperty(context, 1, v8::Boolean::New(isolate, (flags & binary_transport::HAS_TRANSPORTABLES) != 0));
+    args.GetReturnValue().Set(result);
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Function transport APIs
+
+static void SaveFunctionDefinition(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2, "2 arguments of 'origin' and 'body' are required.");
+    CHECK_ARG(isolate, args[0]->IsString() && args[1]->IsString(), "Arguments 'origin' and 'body' must be string.");
+
+    auto hash = napa::module::FunctionRegistry::GetInstance().Save(
+        napa::v8_helpers::V8ValueTo<std::string>(args[0]),
+        napa::v8_helpers::V8ValueTo<std::string>(args[1]));
+
+    args.GetReturnValue().Set(napa::v8_helpers::MakeV8String(isolate, hash));
+}
+
+static void GetFunctionDefinition(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsString(), "1 argument of 'hash' is required.");
+
+    auto definition = napa::module::FunctionRegistry::GetInstance().Get(napa::v8_helpers::V8ValueTo<std::string>(args[0]));
+    if (definition == nullptr) {
+        return;
+    }
+
+    auto result = v8::Array::New(isolate, 2);
+    (void)result->CreateDataProperty(context, 0, napa::v8_helpers::MakeV8String(isolate, definition->origin));
+    (void)result->CreateDataProperty(context, 1, napa::v8_helpers::MakeV8String(isolate, definition->body));
+    args.GetReturnValue().Set(result);
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Stream APIs
+
+static void CreateStreamChannel(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsUint32(), "1 argument of 'capacity' is required.");
+    CHECK_ARG(isolate, args[0]->Uint32Value() > 0, "Argument 'capacity' must be positive.");
+
+    auto channel = std::make_shared<napa::zone::StreamChannel>(args[0]->Uint32Value());
+    args.GetReturnValue().Set(ShareableWrap::NewInstance<StreamChannelWrap>(std::move(channel)));
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Channel APIs
+
+static void CreateMessageChannel(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsUint32(), "1 argument of 'capacity' is required.");
+    CHECK_ARG(isolate, args[0]->Uint32Value() > 0, "Argument 'capacity' must be positive.");
+
+    auto channel = std::make_shared<napa::zone::MessageChannel>(args[0]->Uint32Value());
+    args.GetReturnValue().Set(ShareableWrap::NewInstance<MessageChannelWrap>(std::move(channel)));
+}
+
+/////////////////////////////////////////////////////////////////////
+/// Cancellation APIs
+
+static void CreateCancellationToken(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto token = std::make_shared<napa::zone::CancellationToken>();
+    args.GetReturnValue().Set(ShareableWrap::NewInstance<CancellationTokenWrap>(std::move(token)));
+}
+
+static void TakeConsoleOutput(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto output = napa::providers::ConsoleSink::GetInstance().Take();
+    args.GetReturnValue().Set(napa::v8_helpers::MakeV8String(isolate, output));
+}
+
+static void ClearModuleResolutionCache(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    napa::module::ResolutionCache::GetInstance().Clear();
+}
+
+static void InvalidateModule(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsString(), "1 argument of 'path' is required.");
+
+    auto path = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
+    auto version = napa::module::ModuleVersions::GetInstance().Invalidate(path);
+    args.GetReturnValue().Set(static_cast<double>(version));
+}
+
+static void GetModuleGeneration(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto generation = napa::module::ModuleVersions::GetInstance().GetGeneration();
+    args.GetReturnValue().Set(static_cast<double>(generation));
+}
+
+static void SaveModuleBundle(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    CHECK_ARG(isolate, args.Length() == 3, "3 arguments of 'path', 'entries' and 'codeCache' are required.");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'path' must be string.");
+    CHECK_ARG(isolate, args[1]->IsArray(), "Argument 'entries' must be an array of strings.");
+    CHECK_ARG(isolate, args[2]->IsBoolean(), "Argument 'codeCache' must be boolean.");
+
+    auto path = napa::v8_helpers::V8ValueTo<std::string>(args[0]);
+
+    std::vector<std::string> entries;
+    auto array = v8::Local<v8::Array>::Cast(args[1]);
+    for (uint32_t i = 0; i < array->Length(); ++i) {
+        auto entry = array->Get(context, i).ToLocalChecked();
+        CHECK_ARG(isolate, entry->IsString(), "Argument 'entries' must be an array of strings.");
+        entries.push_back(napa::v8_helpers::V8ValueTo<std::string>(entry));
+    }
+
+    // Code caches are compiled in the calling isolate, for the way this process loads modules.
+    auto functionWrapper = napa::module::ModuleLoader::HasFunctionWrappers();
+    napa::module::ModuleBundle::CodeCacheProducer codeCacheProducer;
+    if (args[2]->BooleanValue()) {
+        codeCacheProducer = [functionWrapper](const std::string& path, const std::string& content) {
+            return napa::module::JavascriptModuleLoader::ProduceCodeCache(path, content, functionWrapper);
+        };
+    }
+
+    size_t moduleCount = 0;
+    std::string error;
+    JS_ENSURE(isolate,
+              napa::module::ModuleBundle::Save(path.c_str(), entries, codeCacheProducer, functionWrapper, moduleCount, error),
+              "%s",
+              error.c_str());
+
+    args.GetReturnValue().Set(static_cast<uint32_t>(moduleCount));
+}
+
 void binding::Init(v8::Local<v8::Object> exports, v8::Local<v8::Object> module) {
     // Register napa binding in worker context.
     RegisterBinding(module);
 
     AllocatorDebuggerWrap::Init();
     AllocatorWrap::Init();
+    CancellationTokenWrap::Init();
+    MessageChannelWrap::Init();
     MetricWrap::Init();
     CallContextWrap::Init();
     SharedPtrWrap::Init();
     StoreWrap::Init();
+    StoreWatcherWrap::Init();
+    StoreWriterWrap::Init();
+    StreamChannelWrap::Init();
     TransportContextWrapImpl::Init();
     ZoneWrap::Init();
 
     NAPA_EXPORT_OBJECTWRAP(exports, "AllocatorDebuggerWrap", AllocatorDebuggerWrap);
     NAPA_EXPORT_OBJECTWRAP(exports, "AllocatorWrap", AllocatorWrap);
+    NAPA_EXPORT_OBJECTWRAP(exports, "CancellationTokenWrap", CancellationTokenWrap);
+    NAPA_EXPORT_OBJECTWRAP(exports, "MessageChannelWrap", MessageChannelWrap);
     NAPA_EXPORT_OBJECTWRAP(exports, "MetricWrap", MetricWrap);
     NAPA_EXPORT_OBJECTWRAP(exports, "CallContextWrap", CallContextWrap);
     NAPA_EXPORT_OBJECTWRAP(exports, "SharedPtrWrap", SharedPtrWrap);
+    NAPA_EXPORT_OBJECTWRAP(exports, "StoreWatcherWrap", StoreWatcherWrap);
+    NAPA_EXPORT_OBJECTWRAP(exports, "StoreWriterWrap", StoreWriterWrap);
+    NAPA_EXPORT_OBJECTWRAP(exports, "StreamChannelWrap", StreamChannelWrap);
     NAPA_EXPORT_OBJECTWRAP(exports, "TransportContextWrap", TransportContextWrapImpl);
 
     NAPA_SET_METHOD(exports, "createZone", CreateZone);
+    NAPA_SET_METHOD(exports, "createZoneAsync", CreateZoneAsync);
     NAPA_SET_METHOD(exports, "getZone", GetZone);
     NAPA_SET_METHOD(exports, "getCurrentZone", GetCurrentZone);
+    NAPA_SET_METHOD(exports, "connectZone", ConnectZone);
+    NAPA_SET_METHOD(exports, "groupZones", GroupZones);
 
     NAPA_SET_METHOD(exports, "createStore", CreateStore);
     NAPA_SET_METHOD(exports, "getOrCreateStore", GetOrCreateStore);
     NAPA_SET_METHOD(exports, "getStore", GetStore);
+    NAPA_SET_METHOD(exports, "loadStore", LoadStore);
     NAPA_SET_METHOD(exports, "getStoreCount", GetStoreCount);
 
     NAPA_SET_METHOD(exports, "getCrtAllocator", GetCrtAllocator);
     NAPA_SET_METHOD(exports, "getDefaultAllocator", GetDefaultAllocator);
+    NAPA_SET_METHOD(exports, "getThreadCachingAllocator", GetThreadCachingAllocator);
+    NAPA_SET_METHOD(exports, "getArrayBufferPool", GetArrayBufferPool);
+    NAPA_SET_METHOD(exports, "memoryPressure", MemoryPressure);
 
     NAPA_SET_METHOD(exports, "log", Log);
+    NAPA_SET_METHOD(exports, "setLogLevel", SetLogLevel);
+
+    NAPA_SET_METHOD(exports, "getMetricSnapshots", GetMetricSnapshots);
+    NAPA_SET_METHOD(exports, "exportMetrics", ExportMetrics);
+
+    NAPA_SET_METHOD(exports, "startTracing", StartTracing);
+    NAPA_SET_METHOD(exports, "stopTracing", StopTracing);
+    NAPA_SET_METHOD(exports, "isTracingEnabled", IsTracingEnabled);
+    NAPA_SET_METHOD(exports, "getTraceTime", GetTraceTime);
+    NAPA_SET_METHOD(exports, "recordTraceSpan", RecordTraceSpan);
+    NAPA_SET_METHOD(exports, "exportTrace", ExportTrace);
+    NAPA_SET_METHOD(exports, "startCallCapture", StartCallCapture);
+    NAPA_SET_METHOD(exports, "stopCallCapture", StopCallCapture);
+
+    NAPA_SET_METHOD(exports, "startTransportAccounting", StartTransportAccounting);
+    NAPA_SET_METHOD(exports, "stopTransportAccounting", StopTransportAccounting);
+    NAPA_SET_METHOD(exports, "isTransportAccountingEnabled", IsTransportAccountingEnabled);
+    NAPA_SET_METHOD(exports, "recordTransport", RecordTransport);
+
+    NAPA_SET_METHOD(exports, "serializeValue", SerializeValue);
+    NAPA_SET_METHOD(exports, "deserializeValue", DeserializeValue);
+
+    NAPA_SET_METHOD(exports, "saveFunctionDefinition", SaveFunctionDefinition);
+    NAPA_SET_METHOD(exports, "getFunctionDefinition", GetFunctionDefinition);
+
+    NAPA_SET_METHOD(exports, "createStreamChannel", CreateStreamChannel);
+    NAPA_SET_METHOD(exports, "createMessageChannel", CreateMessageChannel);
+
+    NAPA_SET_METHOD(exports, "createCancellationToken", CreateCancellationToken);
+
+    NAPA_SET_METHOD(exports, "takeConsoleOutput", TakeConsoleOutput);
+
+    NAPA_SET_METHOD(exports, "clearModuleResolutionCache", ClearModuleResolutionCache);
+    NAPA_SET_METHOD(exports, "saveModuleBundle", SaveModuleBundle);
+    NAPA_SET_METHOD(exports, "invalidateModule", InvalidateModule);
+    NAPA_SET_METHOD(exports, "getModuleGeneration", GetModuleGeneration);
+
+    // Kernels are also reachable in zones as process.binding('napa-kernels'), and here for Node.
+    auto isolate = v8::Isolate::GetCurrent();
+    auto kernelsObject = v8::Object::New(isolate);
+    kernels::Init(kernelsObject);
+    (void)exports->CreateDataProperty(isolate->GetCurrentContext(), v8_helpers::MakeV8String(isolate, "kernels"), kernelsObject);
 }
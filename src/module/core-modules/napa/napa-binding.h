@@ -11,6 +11,9 @@ namespace binding {
 
     /// <summary> Initialize and export napa related functions and object wraps. </summary>
     void Init(v8::Local<v8::Object> exports, v8::Local<v8::Object> module);
+
+    /// <summary> Releases the functions and constructors resolved in the current isolate, before the isolate is disposed. </summary>
+    void ReleaseCache();
 }
 }
 }
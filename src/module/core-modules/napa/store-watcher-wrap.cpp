@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "store-watcher-wrap.h"
+
+#include <store/store-watcher.h>
+
+#include <napa/v8-helpers.h>
+
+using namespace napa::module;
+using namespace napa::store;
+
+NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(StoreWatcherWrap)
+
+void StoreWatcherWrap::Init() {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<StoreWatcherWrap>);
+    constructorTemplate->SetClassName(v8_helpers::MakeV8String(isolate, exportName));
+    constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+    InitConstructorTemplate<StoreWatcherWrap>(constructorTemplate);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "close", CloseCallback);
+    NAPA_SET_ACCESSOR(constructorTemplate, "closed", IsClosedCallback, nullptr);
+
+    auto constructor = constructorTemplate->GetFunction();
+    InitConstructor("<StoreWatcherWrap>", constructor);
+    NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructor);
+}
+
+void StoreWatcherWrap::CloseCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWatcherWrap>(args.Holder());
+    thisObject->GetRef<StoreWatcher>().Close();
+}
+
+void StoreWatcherWrap::IsClosedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWatcherWrap>(args.Holder());
+    args.GetReturnValue().Set(thisObject->GetRef<StoreWatcher>().IsClosed());
+}
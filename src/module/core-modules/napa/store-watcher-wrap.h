@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/module.h>
+#include <napa/module/shareable-wrap.h>
+
+namespace napa {
+namespace module {
+
+    /// <summary> It wraps napa::store::StoreWatcher, which is returned by Store.watch. </summary>
+    /// <remarks> Reference: napajs/lib/store/store.ts#StoreWatcher </remarks>
+    class StoreWatcherWrap : public ShareableWrap {
+    public:
+        /// <summary> Init this wrap. </summary>
+        static void Init();
+
+        /// <summary> Declare constructor in public, so we can export class constructor in JavaScript world. </summary>
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR
+
+        /// <summary> Exported class name. </summary>
+        static constexpr const char* exportName = "StoreWatcherWrap";
+
+    private:
+        /// <summary> It implements StoreWatcher.close(): void </summary>
+        static void CloseCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StoreWatcher.closed </summary>
+        static void IsClosedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+    };
+}
+}
@@ -2,12 +2,289 @@
 // Licensed under the MIT license.
 
 #include "store-wrap.h"
+#include "array-buffer-transport.h"
+#include "binary-transport.h"
+#include "store-watcher-wrap.h"
+#include "store-writer-wrap.h"
+#include "transport-context-wrap-impl.h"
+
+#include <napa/async.h>
 #include <napa/transport.h>
 
+#include <store/store-writer.h>
+#include <zone/tracing.h>
+#include <zone/transport-accounting.h>
+#include <zone/worker-context.h>
+#include <zone/zone.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 using namespace napa::module;
 
 NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(StoreWrap)
-    
+
+namespace {
+
+    /// <summary> Get the cache of unmarshalled values of a store in the current isolate, as a Map of key to [version, value]. </summary>
+    /// <remarks> The caches are kept on a private property of the global object, thus released along with the context. </remarks>
+    v8::Local<v8::Map> GetValueCache(v8::Isolate* isolate, v8::Local<v8::Context> context, const char* storeId) {
+        auto global = context->Global();
+        auto cachesKey = v8::Private::ForApi(isolate, napa::v8_helpers::MakeV8String(isolate, "napajs.store.valueCaches"));
+
+        auto caches = global->GetPrivate(context, cachesKey).ToLocalChecked();
+        if (!caches->IsMap()) {
+            caches = v8::Map::New(isolate);
+            (void)global->SetPrivate(context, cachesKey, caches);
+        }
+
+        auto id = napa::v8_helpers::MakeV8String(isolate, storeId);
+        auto cache = caches.As<v8::Map>()->Get(context, id).ToLocalChecked();
+        if (!cache->IsMap()) {
+            cache = v8::Map::New(isolate);
+            (void)caches.As<v8::Map>()->Set(context, id, cache);
+        }
+        return cache.As<v8::Map>();
+    }
+
+    /// <summary> Freezes plain objects and arrays of a value, other objects like typed arrays and transportables are left as is. </summary>
+    void FreezeValue(v8::Local<v8::Context> context, v8::Local<v8::Value> value, v8::Local<v8::Set> visited) {
+        if (!value->IsObject()) {
+            return;
+        }
+        auto object = value.As<v8::Object>();
+        if (!object->IsArray()
+            && (object->InternalFieldCount() > 0 || !object->GetConstructorName()->StrictEquals(napa::v8_helpers::MakeV8String(context->GetIsolate(), "Object")))) {
+            return;
+        }
+
+        // Values in binary transport format may have cycles.
+        if (visited->Has(context, object).FromJust()) {
+            return;
+        }
+        (void)visited->Add(context, object);
+        (void)object->SetIntegrityLevel(context, v8::IntegrityLevel::kFrozen);
+
+        auto names = object->GetOwnPropertyNames(context).ToLocalChecked();
+        for (uint32_t i = 0; i < names->Length(); ++i) {
+            auto property = object->Get(context, names->Get(context, i).ToLocalChecked());
+            if (!property.IsEmpty()) {
+                FreezeValue(context, property.ToLocalChecked(), visited);
+            }
+        }
+    }
+
+    /// <summary> Largest integer that a JavaScript number holds exactly. </summary>
+    constexpr double MAX_SAFE_INTEGER = 9007199254740991.0;
+
+    /// <summary> Records the cost of marshalling or unmarshalling a value of a store, for the zone of the calling thread. </summary>
+    void RecordTransport(
+        napa::store::Store& store,
+        const char* stage,
+        size_t bytes,
+        const napa::transport::TransportContext& transportContext,
+        int64_t start) {
+
+        auto zone = static_cast<napa::zone::Zone*>(napa::zone::WorkerContext::Get(napa::zone::WorkerContextItem::ZONE));
+        auto function = std::string("store:") + store.GetId();
+        napa::zone::TransportAccounting::Record(
+            napa::providers::GetMetricProvider(),
+            zone != nullptr ? zone->GetId().c_str() : "",
+            function.c_str(),
+            stage,
+            bytes,
+            transportContext.GetSharedCount(),
+            napa::zone::Tracing::Now() - start);
+    }
+
+    /// <summary> Marshalls a JavaScript value with the transport option of a store, or returns nullptr on a pending exception. </summary>
+    /// <remarks> Primitives and ArrayBuffers are kept natively, they don't need a transport. </remarks>
+    std::shared_ptr<napa::store::Store::ValueType> MarshallValue(napa::store::Store& store, const std::string& key, v8::Local<v8::Value> jsValue) {
+        using napa::store::ValueKind;
+
+        auto start = napa::zone::TransportAccounting::IsEnabled() ? napa::zone::Tracing::Now() : -1;
+        auto value = std::make_shared<napa::store::Store::ValueType>();
+        if (jsValue->IsNull()) {
+            value->kind = ValueKind::NUL;
+        } else if (jsValue->IsBoolean()) {
+            value->kind = ValueKind::BOOLEAN;
+            value->boolean = jsValue->IsTrue();
+        } else if (jsValue->IsNumber()) {
+            value->kind = ValueKind::NUMBER;
+            value->number = jsValue.As<v8::Number>()->Value();
+        } else if (jsValue->IsString()) {
+            value->kind = ValueKind::STRING;
+            value->payload = napa::v8_helpers::V8ValueTo<std::string>(jsValue);
+        } else if (jsValue->IsArrayBuffer()) {
+            value->kind = ValueKind::ARRAY_BUFFER;
+            value->buffer = array_buffer_transport::SaveShared(jsValue.As<v8::ArrayBuffer>());
+        } else if (store.GetTransportOption() == napa::TransportOption::BINARY) {
+            auto transportContextWrap = TransportContextWrapImpl::NewInstance(false, &value->transportContext);
+            if (!binary_transport::Marshall(jsValue, transportContextWrap, value->payload)) {
+                return nullptr;
+            }
+            value->binary = true;
+        } else {
+            auto payload = napa::transport::Marshall(jsValue, &value->transportContext);
+            if (payload.IsEmpty()) {
+                return nullptr;
+            }
+            value->payload = napa::v8_helpers::V8ValueTo<std::string>(payload.ToLocalChecked());
+        }
+        if (start >= 0 && value->kind == ValueKind::MARSHALLED) {
+            RecordTransport(store, "StoreSet", value->payload.size(), value->transportContext, start);
+        }
+
+        std::string error;
+        JS_ENSURE_WITH_RETURN(v8::Isolate::GetCurrent(), store.CanStore(key.c_str(), *value, error), nullptr, "%s", error.c_str());
+        napa::store::CompressValue(store, *value);
+        return value;
+    }
+
+    /// <summary> Creates the JavaScript value of a value that is kept natively. </summary>
+    v8::Local<v8::Value> LoadNativeValue(v8::Isolate* isolate, const napa::store::Store::ValueType& storeValue) {
+        using napa::store::ValueKind;
+
+        switch (storeValue.kind) {
+            case ValueKind::BOOLEAN:
+                return v8::Boolean::New(isolate, storeValue.boolean);
+            case ValueKind::NUMBER:
+                return v8::Number::New(isolate, storeValue.number);
+            case ValueKind::INTEGER:
+                return v8::Number::New(isolate, static_cast<double>(storeValue.integer));
+            case ValueKind::STRING:
+                return napa::v8_helpers::MakeV8String(isolate, storeValue.payload);
+            case ValueKind::ARRAY_BUFFER:
+                // All readers share the memory, which is freed once the value and all buffers over it are gone.
+                return array_buffer_transport::LoadExternal(storeValue.buffer);
+            default:
+                return v8::Null(isolate);
+        }
+    }
+
+    /// <summary> Unmarshalls a stored value, or returns undefined if it's nullptr. Empty on a pending exception. </summary>
+    /// <remarks>
+    ///     Values are cached by version in the current isolate if the store caches values, a version changes with each set.
+    ///     Thus a compressed value is decompressed once per isolate and version, rather than on each get.
+    /// </remarks>
+    v8::MaybeLocal<v8::Value> LoadValue(
+        napa::store::Store& store,
+        v8::Local<v8::Value> key,
+        const napa::store::Store::ValueType* storeValue) {
+
+        auto isolate = v8::Isolate::GetCurrent();
+        auto context = isolate->GetCurrentContext();
+
+        auto cacheOption = store.GetValueCacheOption();
+        v8::Local<v8::Map> cache;
+        if (cacheOption != napa::store::ValueCacheOption::NONE) {
+            cache = GetValueCache(isolate, context, store.GetId());
+        }
+
+        if (storeValue == nullptr) {
+            if (!cache.IsEmpty()) {
+                (void)cache->Delete(context, key);
+            }
+            return v8::Undefined(isolate);
+        }
+
+        // Native values are cheaper to create than to look up, a value cached for the key before is stale.
+        if (storeValue->kind != napa::store::ValueKind::MARSHALLED) {
+            if (!cache.IsEmpty()) {
+                (void)cache->Delete(context, key);
+            }
+            return LoadNativeValue(isolate, *storeValue);
+        }
+
+        auto version = v8::Number::New(isolate, static_cast<double>(storeValue->version));
+        if (!cache.IsEmpty()) {
+            auto entry = cache->Get(context, key).ToLocalChecked();
+            if (entry->IsArray()
+                && entry.As<v8::Array>()->Get(context, 0).ToLocalChecked()->StrictEquals(version)) {
+                return entry.As<v8::Array>()->Get(context, 1);
+            }
+        }
+
+        auto start = napa::zone::TransportAccounting::IsEnabled() ? napa::zone::Tracing::Now() : -1;
+        std::string decompressed;
+        if (storeValue->compressed) {
+            JS_ENSURE_WITH_RETURN(isolate, napa::store::DecompressValue(store, *storeValue, decompressed), v8::MaybeLocal<v8::Value>(),
+                "Value of store \"%s\" is corrupted.", store.GetId());
+        }
+
+        // A value is loaded by every get, so ArrayBuffers are copied out rather than taken over.
+        auto bytes = storeValue->compressed ? decompressed.size() : storeValue->payload.size();
+        auto transportContext = const_cast<napa::transport::TransportContext*>(&storeValue->transportContext);
+        v8::MaybeLocal<v8::Value> value;
+        if (storeValue->binary) {
+            auto transportContextWrap = TransportContextWrapImpl::NewInstance(false, transportContext, true);
+            value = binary_transport::Unmarshall(storeValue->compressed ? decompressed : storeValue->payload, transportContextWrap);
+        } else {
+            // A decompressed payload is taken over by the string, as the parsed value may outlive this call.
+            auto payload = storeValue->compressed
+                ? napa::v8_helpers::MakeOwnedV8String(isolate, std::move(decompressed))
+                : napa::v8_helpers::MakeExternalV8String(isolate, storeValue->payload);
+            value = napa::transport::UnmarshallPlain(payload);
+            if (value.IsEmpty()) {
+                auto transportContextWrap = TransportContextWrapImpl::NewInstance(false, transportContext, true);
+                value = napa::transport::Unmarshall(payload, transportContextWrap);
+            }
+        }
+
+        if (start >= 0 && !value.IsEmpty()) {
+            RecordTransport(store, "StoreGet", bytes, *transportContext, start);
+        }
+
+        if (!value.IsEmpty() && !cache.IsEmpty()) {
+            if (cacheOption == napa::store::ValueCacheOption::FROZEN) {
+                FreezeValue(context, value.ToLocalChecked(), v8::Set::New(isolate));
+            }
+            auto entry = v8::Array::New(isolate, 2);
+            (void)entry->Set(context, 0, version);
+            (void)entry->Set(context, 1, value.ToLocalChecked());
+            (void)cache->Set(context, key, entry);
+        }
+        return value;
+    }
+
+    /// <summary> Waits for keys changed in a store, calls back with each of them, then waits again until the watcher is closed. </summary>
+    /// <remarks> Completions run as tasks on the worker that is watching, or on the Node event loop. </remarks>
+    void WatchNext(std::shared_ptr<napa::store::StoreWatcher> watcher, v8::Local<v8::Function> callback) {
+        napa::zone::DoAsyncWork(callback,
+            [&watcher](std::function<void(void*)> complete) {
+                watcher->Wait([complete = std::move(complete)]() {
+                    complete(nullptr);
+                });
+            },
+            [watcher](v8::Local<v8::Function> jsCallback, void*) {
+                auto isolate = v8::Isolate::GetCurrent();
+                v8::HandleScope scope(isolate);
+                auto context = isolate->GetCurrentContext();
+
+                if (watcher->IsClosed()) {
+                    return;
+                }
+
+                // Keys changed until now are taken at once, and the next wait starts before calling back,
+                // so changes made by the callback are seen, and a callback that throws doesn't stop the watch.
+                auto keys = watcher->Take();
+                WatchNext(watcher, jsCallback);
+
+                for (auto& key : keys) {
+                    v8::Local<v8::Value> argv[] = { napa::v8_helpers::MakeV8String(isolate, key) };
+                    if (jsCallback->Call(context, context->Global(), 1, argv).IsEmpty()) {
+                        break;
+                    }
+                }
+            }
+        );
+    }
+
+}   // End of anonymous namespace.
+
 void StoreWrap::Init() {
     auto isolate = v8::Isolate::GetCurrent();
     auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<StoreWrap>);
@@ -18,8 +295,23 @@ void StoreWrap::Init() {
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "get", GetCallback);
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "has", HasCallback);
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "delete", DeleteCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getMany", GetManyCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "setMany", SetManyCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "scan", ScanCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getVersioned", GetVersionedCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "compareAndSet", CompareAndSetCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getOrSet", GetOrSetCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "increment", IncrementCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "decrement", DecrementCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "watch", WatchCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "snapshot", SnapshotCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "setStream", SetStreamCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getRange", GetRangeCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getByteLength", GetByteLengthCallback);
     NAPA_SET_ACCESSOR(constructorTemplate, "id", GetIdCallback, nullptr);
     NAPA_SET_ACCESSOR(constructorTemplate, "size", GetSizeCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "shards", GetShardCountCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "readOptimized", IsReadOptimizedCallback, nullptr);
 
     NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructorTemplate->GetFunction());
 }
@@ -39,24 +331,24 @@ void StoreWrap::SetCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
     
-    CHECK_ARG(isolate, args.Length() == 2, "2 arguments are required for \"set\".");
+    CHECK_ARG(isolate, args.Length() == 2 || args.Length() == 3, "2 arguments are required for \"set\", followed by an optional 'ttl'.");
     CHECK_ARG(isolate, args[0]->IsString(), "Argument \"key\" must be string.");
+    CHECK_ARG(isolate, args.Length() < 3 || args[2]->IsUndefined() || (args[2]->IsNumber() && args[2]->NumberValue() >= 0),
+        "Argument \"ttl\" must be a non-negative number.");
 
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
     auto& store = thisObject->Get();
 
-    // Marshall value object into payload.
-    napa::transport::TransportContext transportContext;
-    auto payload = napa::transport::Marshall(args[1], &transportContext);
-    
-    RETURN_ON_PENDING_EXCEPTION(payload);
-    
-    store.Set(
-        v8_helpers::V8ValueTo<std::string>(args[0]).c_str(),
-        std::make_shared<napa::store::Store::ValueType>(napa::store::Store::ValueType {
-            v8_helpers::V8ValueTo<std::string>(payload.ToLocalChecked()),
-            std::move(transportContext)
-        }));
+    auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
+    auto value = MarshallValue(store, key, args[1]);
+    if (value == nullptr) {
+        return;
+    }
+
+    if (args.Length() == 3 && !args[2]->IsUndefined()) {
+        value->ttl = std::chrono::milliseconds(static_cast<int64_t>(args[2]->NumberValue()));
+    }
+    store.Set(key.c_str(), std::move(value));
 }
 
 void StoreWrap::GetCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -69,19 +361,352 @@ void StoreWrap::GetCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
     auto& store = thisObject->Get();
 
-    // Marshall value object into payload.
+    // Read optimized stores serve the value without locking or reference counting.
     auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
-    auto storeValue = store.Get(key.c_str());
-    if (storeValue != nullptr) {
-        auto value = napa::transport::Unmarshall(
-            v8_helpers::MakeExternalV8String(isolate, storeValue->payload), 
-            &(storeValue->transportContext));
+    store.Read(key.c_str(), [&args](const napa::store::Store::ValueType* storeValue) {
+        auto value = LoadValue(NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder())->Get(), args[0], storeValue);
+        if (!value.IsEmpty()) {
+            args.GetReturnValue().Set(value.ToLocalChecked());
+        }
+    });
+}
 
-        RETURN_ON_PENDING_EXCEPTION(value);
+void StoreWrap::GetVersionedCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument are required for \"getVersioned\".");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'key' must be string.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
+    store.Read(key.c_str(), [&args](const napa::store::Store::ValueType* storeValue) {
+        auto value = LoadValue(NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder())->Get(), args[0], storeValue);
+        if (value.IsEmpty() || storeValue == nullptr) {
+            return;
+        }
+
+        // The value and its version are read together, so the version can be passed on to compareAndSet.
+        auto isolate = v8::Isolate::GetCurrent();
+        auto context = isolate->GetCurrentContext();
+        auto result = v8::Object::New(isolate);
+        (void)result->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "value"), value.ToLocalChecked());
+        (void)result->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "version"),
+            v8::Number::New(isolate, static_cast<double>(storeValue->version)));
+        args.GetReturnValue().Set(result);
+    });
+}
+
+void StoreWrap::CompareAndSetCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 3, "3 arguments are required for \"compareAndSet\".");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'key' must be string.");
+    CHECK_ARG(isolate, args[1]->IsNumber() && args[1]->NumberValue() >= 0, "Argument 'expectedVersion' must be a non-negative number.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
+    auto value = MarshallValue(store, key, args[2]);
+    if (value == nullptr) {
+        return;
+    }
+
+    auto expectedVersion = static_cast<uint64_t>(args[1]->NumberValue());
+    args.GetReturnValue().Set(store.CompareAndSet(key.c_str(), expectedVersion, std::move(value)));
+}
+
+void StoreWrap::GetOrSetCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2, "2 arguments are required for \"getOrSet\".");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'key' must be string.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
+
+    // An existing value is returned without marshalling the given one.
+    auto existing = store.Get(key.c_str());
+    if (existing == nullptr) {
+        auto value = MarshallValue(store, key, args[1]);
+        if (value == nullptr) {
+            return;
+        }
+
+        existing = store.GetOrSet(key.c_str(), value);
+        if (existing == value) {
+            args.GetReturnValue().Set(args[1]);
+            return;
+        }
+    }
+
+    auto value = LoadValue(store, args[0], existing.get());
+    if (!value.IsEmpty()) {
         args.GetReturnValue().Set(value.ToLocalChecked());
     }
 }
 
+void StoreWrap::IncrementCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    Increment(args, 1);
+}
+
+void StoreWrap::DecrementCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    Increment(args, -1);
+}
+
+void StoreWrap::Increment(const v8::FunctionCallbackInfo<v8::Value>& args, int64_t sign) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 argument of 'key' is required, followed by an optional 'delta'.");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'key' must be string.");
+
+    int64_t delta = 1;
+    if (args.Length() == 2 && !args[1]->IsUndefined()) {
+        auto number = args[1]->IsNumber() ? args[1]->NumberValue() : 0.5;
+        CHECK_ARG(isolate, std::trunc(number) == number && std::abs(number) <= MAX_SAFE_INTEGER, "Argument 'delta' must be a safe integer.");
+        delta = static_cast<int64_t>(number);
+    }
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
+    int64_t result = 0;
+    JS_ENSURE(isolate, store.Increment(key.c_str(), sign * delta, result),
+        "Value of key \"%s\" is not an integer, or the result overflows int64.", key.c_str());
+
+    args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(result)));
+}
+
+void StoreWrap::GetManyCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument are required for \"getMany\".");
+    CHECK_ARG(isolate, args[0]->IsArray(), "Argument 'keys' must be an array of string.");
+
+    auto jsKeys = args[0].As<v8::Array>();
+    std::vector<std::string> keys;
+    keys.reserve(jsKeys->Length());
+    for (uint32_t i = 0; i < jsKeys->Length(); ++i) {
+        auto key = jsKeys->Get(context, i).ToLocalChecked();
+        CHECK_ARG(isolate, key->IsString(), "Argument 'keys' must be an array of string.");
+        keys.emplace_back(v8_helpers::V8ValueTo<std::string>(key));
+    }
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto storeValues = store.GetMany(keys);
+    auto values = v8::Array::New(isolate, static_cast<int>(keys.size()));
+    for (uint32_t i = 0; i < storeValues.size(); ++i) {
+        auto value = LoadValue(store, jsKeys->Get(context, i).ToLocalChecked(), storeValues[i].get());
+        if (value.IsEmpty()) {
+            return;
+        }
+        (void)values->Set(context, i, value.ToLocalChecked());
+    }
+    args.GetReturnValue().Set(values);
+}
+
+void StoreWrap::SetManyCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 argument of 'entries' is required for \"setMany\", followed by an optional 'ttl'.");
+    CHECK_ARG(isolate, args[0]->IsArray(), "Argument 'entries' must be an array of [key, value] pairs.");
+    CHECK_ARG(isolate, args.Length() < 2 || args[1]->IsUndefined() || (args[1]->IsNumber() && args[1]->NumberValue() >= 0),
+        "Argument \"ttl\" must be a non-negative number.");
+
+    std::chrono::milliseconds ttl(0);
+    if (args.Length() == 2 && !args[1]->IsUndefined()) {
+        ttl = std::chrono::milliseconds(static_cast<int64_t>(args[1]->NumberValue()));
+    }
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    // All values are marshalled before any is set, so a value failing to marshall leaves the store as is.
+    auto entries = args[0].As<v8::Array>();
+    std::vector<std::string> keys;
+    std::vector<std::shared_ptr<napa::store::Store::ValueType>> values;
+    keys.reserve(entries->Length());
+    values.reserve(entries->Length());
+    for (uint32_t i = 0; i < entries->Length(); ++i) {
+        auto entry = entries->Get(context, i).ToLocalChecked();
+        CHECK_ARG(isolate, entry->IsArray() && entry.As<v8::Array>()->Length() == 2, "Argument 'entries' must be an array of [key, value] pairs.");
+
+        auto key = entry.As<v8::Array>()->Get(context, 0).ToLocalChecked();
+        CHECK_ARG(isolate, key->IsString(), "Key of entries must be string.");
+
+        keys.emplace_back(v8_helpers::V8ValueTo<std::string>(key));
+        auto value = MarshallValue(store, keys.back(), entry.As<v8::Array>()->Get(context, 1).ToLocalChecked());
+        if (value == nullptr) {
+            return;
+        }
+        value->ttl = ttl;
+
+        values.emplace_back(std::move(value));
+    }
+    store.SetMany(keys, std::move(values));
+}
+
+void StoreWrap::ScanCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 argument of 'prefix' is required for \"scan\", followed by an optional 'limit'.");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'prefix' must be string.");
+    CHECK_ARG(isolate, args.Length() < 2 || args[1]->IsUndefined() || (args[1]->IsUint32() && args[1]->Uint32Value() > 0),
+        "Argument 'limit' must be a positive integer.");
+
+    size_t limit = 0;
+    if (args.Length() == 2 && !args[1]->IsUndefined()) {
+        limit = args[1]->Uint32Value();
+    }
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto storeEntries = store.Scan(v8_helpers::V8ValueTo<std::string>(args[0]).c_str(), limit);
+    auto entries = v8::Array::New(isolate, static_cast<int>(storeEntries.size()));
+    for (uint32_t i = 0; i < storeEntries.size(); ++i) {
+        auto key = v8_helpers::MakeV8String(isolate, storeEntries[i].first);
+        auto value = LoadValue(store, key, storeEntries[i].second.get());
+        if (value.IsEmpty()) {
+            return;
+        }
+        auto entry = v8::Array::New(isolate, 2);
+        (void)entry->Set(context, 0, key);
+        (void)entry->Set(context, 1, value.ToLocalChecked());
+        (void)entries->Set(context, i, entry);
+    }
+    args.GetReturnValue().Set(entries);
+}
+
+void StoreWrap::WatchCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2, "2 arguments are required for \"watch\".");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'keyOrPrefix' must be string.");
+    CHECK_ARG(isolate, args[1]->IsFunction(), "Argument 'callback' must be function.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto watcher = std::make_shared<napa::store::StoreWatcher>(v8_helpers::V8ValueTo<std::string>(args[0]));
+    store.Watch(watcher);
+    WatchNext(watcher, v8::Local<v8::Function>::Cast(args[1]));
+
+    args.GetReturnValue().Set(ShareableWrap::NewInstance<StoreWatcherWrap>(std::move(watcher)));
+}
+
+void StoreWrap::SnapshotCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"snapshot\".");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'path' must be string.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    std::string error;
+    auto saved = napa::store::SaveStore(store, v8_helpers::V8ValueTo<std::string>(args[0]).c_str(), error);
+    JS_ENSURE(isolate, saved, "%s", error.c_str());
+}
+
+void StoreWrap::SetStreamCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 argument is required for \"setStream\", followed by an optional 'ttl'.");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'key' must be string.");
+    CHECK_ARG(isolate, args.Length() < 2 || args[1]->IsUndefined() || (args[1]->IsNumber() && args[1]->NumberValue() >= 0),
+        "Argument 'ttl' must be a non-negative number.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+
+    std::chrono::milliseconds ttl(0);
+    if (args.Length() == 2 && !args[1]->IsUndefined()) {
+        ttl = std::chrono::milliseconds(static_cast<int64_t>(args[1]->NumberValue()));
+    }
+
+    auto writer = std::make_shared<napa::store::StoreWriter>(thisObject->_store, v8_helpers::V8ValueTo<std::string>(args[0]), ttl);
+    args.GetReturnValue().Set(ShareableWrap::NewInstance<StoreWriterWrap>(std::move(writer)));
+}
+
+void StoreWrap::GetRangeCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2 || args.Length() == 3, "2 arguments are required for \"getRange\", followed by an optional 'length'.");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'key' must be string.");
+    CHECK_ARG(isolate, args[1]->IsNumber() && args[1]->NumberValue() >= 0, "Argument 'offset' must be a non-negative number.");
+    CHECK_ARG(isolate, args.Length() < 3 || args[2]->IsUndefined() || (args[2]->IsNumber() && args[2]->NumberValue() >= 0),
+        "Argument 'length' must be a non-negative number.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
+    auto value = store.Get(key.c_str());
+    if (value == nullptr) {
+        return;
+    }
+    JS_ENSURE(isolate, value->kind == napa::store::ValueKind::ARRAY_BUFFER || value->kind == napa::store::ValueKind::STRING,
+        "Value of key \"%s\" is neither an ArrayBuffer nor a string.", key.c_str());
+
+    // The range is clamped to the value, like ArrayBuffer.prototype.slice.
+    auto byteLength = value->GetByteLength();
+    auto offset = static_cast<size_t>(std::min(args[1]->NumberValue(), static_cast<double>(byteLength)));
+    auto length = byteLength - offset;
+    if (args.Length() == 3 && !args[2]->IsUndefined()) {
+        length = static_cast<size_t>(std::min(args[2]->NumberValue(), static_cast<double>(length)));
+    }
+
+    // ArrayBuffers are sliced without copying, strings copy only the bytes in range.
+    if (value->kind == napa::store::ValueKind::ARRAY_BUFFER) {
+        args.GetReturnValue().Set(array_buffer_transport::LoadExternal(value->buffer, offset, length));
+        return;
+    }
+    auto range = v8::ArrayBuffer::New(isolate, length);
+    if (length > 0) {
+        std::memcpy(range->GetContents().Data(), value->payload.data() + offset, length);
+    }
+    args.GetReturnValue().Set(range);
+}
+
+void StoreWrap::GetByteLengthCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"getByteLength\".");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument 'key' must be string.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    auto key = v8_helpers::V8ValueTo<std::string>(args[0]);
+    store.Read(key.c_str(), [&args](const napa::store::Store::ValueType* value) {
+        if (value != nullptr) {
+            args.GetReturnValue().Set(static_cast<double>(value->GetByteLength()));
+        }
+    });
+}
+
 void StoreWrap::HasCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
@@ -128,3 +753,22 @@ void StoreWrap::GetSizeCallback(v8::Local<v8::String>, const v8::PropertyCallbac
     args.GetReturnValue().Set(static_cast<uint32_t>(store.Size()));
 }
 
+void StoreWrap::GetShardCountCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    args.GetReturnValue().Set(static_cast<uint32_t>(store.GetShardCount()));
+}
+
+void StoreWrap::IsReadOptimizedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWrap>(args.Holder());
+    auto& store = thisObject->Get();
+
+    args.GetReturnValue().Set(store.IsReadOptimized());
+}
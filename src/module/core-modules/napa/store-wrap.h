@@ -43,11 +43,59 @@ namespace module {
         /// <summary> It implements Store.delete(key: string): void </summary>
         static void DeleteCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+        /// <summary> It implements Store.getMany(keys: string[]): any[] </summary>
+        static void GetManyCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.setMany(entries: [string, any][], ttl?: number): void </summary>
+        static void SetManyCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.scan(prefix: string, limit?: number): [string, any][] </summary>
+        static void ScanCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.getVersioned(key: string): VersionedValue </summary>
+        static void GetVersionedCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.compareAndSet(key: string, expectedVersion: number, value: any): boolean </summary>
+        static void CompareAndSetCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.getOrSet(key: string, value: any): any </summary>
+        static void GetOrSetCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.increment(key: string, delta?: number): number </summary>
+        static void IncrementCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.decrement(key: string, delta?: number): number </summary>
+        static void DecrementCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.watch(keyOrPrefix: string, callback: (key: string) => void): StoreWatcher </summary>
+        static void WatchCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.snapshot(path: string): void </summary>
+        static void SnapshotCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.setStream(key: string, ttl?: number): StoreWriter </summary>
+        static void SetStreamCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.getRange(key: string, offset: number, length?: number): ArrayBuffer </summary>
+        static void GetRangeCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.getByteLength(key: string): number </summary>
+        static void GetByteLengthCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> Adds delta of the arguments in the given direction. </summary>
+        static void Increment(const v8::FunctionCallbackInfo<v8::Value>& args, int64_t sign);
+
         /// <summary> It implements Store.id </summary>
         static void GetIdCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
 
         /// <summary> It implements Store.size </summary>
         static void GetSizeCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.shards </summary>
+        static void GetShardCountCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements Store.readOptimized </summary>
+        static void IsReadOptimizedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
         
         /// <summary> Friend default constructor callback. </summary>
         template <typename T>
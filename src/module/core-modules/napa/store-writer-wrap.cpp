@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "store-writer-wrap.h"
+
+#include <store/store-writer.h>
+
+#include <napa/v8-helpers.h>
+
+using namespace napa::module;
+using namespace napa::store;
+
+NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(StoreWriterWrap)
+
+void StoreWriterWrap::Init() {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<StoreWriterWrap>);
+    constructorTemplate->SetClassName(v8_helpers::MakeV8String(isolate, exportName));
+    constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+    InitConstructorTemplate<StoreWriterWrap>(constructorTemplate);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "write", WriteCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "end", EndCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "abort", AbortCallback);
+    NAPA_SET_ACCESSOR(constructorTemplate, "bytesWritten", GetBytesWrittenCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "ended", IsEndedCallback, nullptr);
+
+    auto constructor = constructorTemplate->GetFunction();
+    InitConstructor("<StoreWriterWrap>", constructor);
+    NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructor);
+}
+
+void StoreWriterWrap::WriteCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"write\".");
+    CHECK_ARG(isolate, args[0]->IsArrayBuffer() || args[0]->IsArrayBufferView() || args[0]->IsString(),
+        "Argument 'chunk' must be ArrayBuffer, ArrayBufferView or string.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWriterWrap>(args.Holder());
+    auto& writer = thisObject->GetRef<StoreWriter>();
+
+    // Chunks are copied straight from their backing stores, strings as UTF-8 bytes.
+    std::string error;
+    bool written;
+    if (args[0]->IsArrayBuffer()) {
+        auto contents = args[0].As<v8::ArrayBuffer>()->GetContents();
+        written = writer.Write(contents.Data(), contents.ByteLength(), error);
+    } else if (args[0]->IsArrayBufferView()) {
+        auto view = args[0].As<v8::ArrayBufferView>();
+        auto contents = view->Buffer()->GetContents();
+        written = writer.Write(static_cast<char*>(contents.Data()) + view->ByteOffset(), view->ByteLength(), error);
+    } else {
+        v8::String::Utf8Value chunk(args[0]);
+        written = writer.Write(*chunk, static_cast<size_t>(chunk.length()), error);
+    }
+    JS_ENSURE(isolate, written, "%s", error.c_str());
+}
+
+void StoreWriterWrap::EndCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWriterWrap>(args.Holder());
+
+    std::string error;
+    auto ended = thisObject->GetRef<StoreWriter>().End(error);
+    JS_ENSURE(isolate, ended, "%s", error.c_str());
+}
+
+void StoreWriterWrap::AbortCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWriterWrap>(args.Holder());
+    thisObject->GetRef<StoreWriter>().Abort();
+}
+
+void StoreWriterWrap::GetBytesWrittenCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWriterWrap>(args.Holder());
+    args.GetReturnValue().Set(static_cast<double>(thisObject->GetRef<StoreWriter>().GetLength()));
+}
+
+void StoreWriterWrap::IsEndedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StoreWriterWrap>(args.Holder());
+    args.GetReturnValue().Set(thisObject->GetRef<StoreWriter>().IsEnded());
+}
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/module.h>
+#include <napa/module/shareable-wrap.h>
+
+namespace napa {
+namespace module {
+
+    /// <summary> It wraps napa::store::StoreWriter, which is returned by Store.setStream. </summary>
+    /// <remarks> Reference: napajs/lib/store/store.ts#StoreWriter </remarks>
+    class StoreWriterWrap : public ShareableWrap {
+    public:
+        /// <summary> Init this wrap. </summary>
+        static void Init();
+
+        /// <summary> Declare constructor in public, so we can export class constructor in JavaScript world. </summary>
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR
+
+        /// <summary> Exported class name. </summary>
+        static constexpr const char* exportName = "StoreWriterWrap";
+
+    private:
+        /// <summary> It implements StoreWriter.write(chunk: ArrayBuffer | ArrayBufferView | string): void </summary>
+        static void WriteCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StoreWriter.end(): void </summary>
+        static void EndCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StoreWriter.abort(): void </summary>
+        static void AbortCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StoreWriter.bytesWritten </summary>
+        static void GetBytesWrittenCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StoreWriter.ended </summary>
+        static void IsEndedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+    };
+}
+}
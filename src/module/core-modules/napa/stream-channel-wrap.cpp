@@ -0,0 +1,195 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "stream-channel-wrap.h"
+
+#include "binary-transport.h"
+#include "transport-context-wrap-impl.h"
+
+#include <zone/stream-channel.h>
+
+#include <napa/async.h>
+#include <napa/v8-helpers.h>
+
+using namespace napa::module;
+using namespace napa::zone;
+
+NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(StreamChannelWrap)
+
+namespace {
+
+    /// <summary> Outcome of a read, passed from the writer thread to the reader isolate. </summary>
+    struct ReadResult {
+        std::unique_ptr<StreamChannel::Chunk> chunk;
+        std::string error;
+    };
+
+    /// <summary> Completes a callback on the current isolate with a single argument. </summary>
+    void CallWith(v8::Local<v8::Function> jsCallback, v8::Local<v8::Value> arg) {
+        auto isolate = v8::Isolate::GetCurrent();
+        auto context = isolate->GetCurrentContext();
+
+        v8::Local<v8::Value> argv[] = { arg };
+        // An exception of the callback is left to the caller of the completion.
+        if (jsCallback->Call(context, context->Global(), 1, argv).IsEmpty()) {
+            return;
+        }
+    }
+
+}   // End of anonymous namespace.
+
+void StreamChannelWrap::Init() {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<StreamChannelWrap>);
+    constructorTemplate->SetClassName(v8_helpers::MakeV8String(isolate, exportName));
+    constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+    InitConstructorTemplate<StreamChannelWrap>(constructorTemplate);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "write", WriteCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "waitWritable", WaitWritableCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "end", EndCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "read", ReadCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "cancel", CancelCallback);
+    NAPA_SET_ACCESSOR(constructorTemplate, "closed", IsClosedCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "size", GetSizeCallback, nullptr);
+    NAPA_SET_ACCESSOR(constructorTemplate, "capacity", GetCapacityCallback, nullptr);
+
+    auto constructor = constructorTemplate->GetFunction();
+    InitConstructor("<StreamChannelWrap>", constructor);
+    NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructor);
+}
+
+void StreamChannelWrap::WriteCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 2, "2 arguments are required for \"write\".");
+    CHECK_ARG(isolate, args[1]->IsObject(), "Argument \"transportContext\" shall be 'TransportContextWrap' type.");
+
+    auto chunk = std::make_unique<StreamChannel::Chunk>();
+    if (args[0]->IsString()) {
+        chunk->payload = v8_helpers::V8ValueTo<std::string>(args[0]);
+    } else {
+        CHECK_ARG(isolate, binary_transport::CopyPayload(args[0], chunk->payload),
+            "Argument \"payload\" shall be a string or an ArrayBuffer.");
+        chunk->binary = true;
+    }
+
+    auto transportContextWrap = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(v8::Local<v8::Object>::Cast(args[1]));
+    chunk->transportContext = std::move(*transportContextWrap->Get());
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder());
+    auto status = thisObject->GetRef<StreamChannel>().Write(std::move(chunk));
+    args.GetReturnValue().Set(static_cast<uint32_t>(status));
+}
+
+void StreamChannelWrap::WaitWritableCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsFunction(), "Argument \"callback\" shall be 'Function' type.");
+
+    auto channel = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder())->Get<StreamChannel>();
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&channel](std::function<void(void*)> complete) {
+            channel->WaitWritable([complete = std::move(complete)](bool open) {
+                complete(reinterpret_cast<void*>(static_cast<uintptr_t>(open)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+
+            CallWith(jsCallback, v8::Boolean::New(isolate, result != nullptr));
+        }
+    );
+}
+
+void StreamChannelWrap::EndCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    std::string error;
+    if (args.Length() > 0 && !args[0]->IsUndefined() && !args[0]->IsNull()) {
+        CHECK_ARG(isolate, args[0]->IsString(), "Argument \"error\" shall be 'string' type.");
+        error = v8_helpers::V8ValueTo<std::string>(args[0]);
+    }
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder());
+    thisObject->GetRef<StreamChannel>().End(std::move(error));
+}
+
+void StreamChannelWrap::ReadCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsFunction(), "Argument \"callback\" shall be 'Function' type.");
+
+    auto channel = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder())->Get<StreamChannel>();
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&channel](std::function<void(void*)> complete) {
+            channel->Read([complete = std::move(complete)](std::unique_ptr<StreamChannel::Chunk> chunk, const std::string& error) {
+                complete(new ReadResult { std::move(chunk), error });
+            });
+        },
+        [](auto jsCallback, void* res) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::unique_ptr<ReadResult> result(static_cast<ReadResult*>(res));
+
+            // Callback arguments are (payload, transportContext) for a chunk, and (undefined, undefined, error) at the end.
+            v8::Local<v8::Value> argv[3] = { v8::Undefined(isolate), v8::Undefined(isolate), v8::Undefined(isolate) };
+            auto& chunk = result->chunk;
+            if (chunk != nullptr) {
+                if (chunk->binary) {
+                    argv[0] = binary_transport::NewPayloadBuffer(chunk->payload.data(), chunk->payload.size());
+                } else {
+                    argv[0] = v8_helpers::MakeV8String(isolate, chunk->payload);
+                }
+                argv[1] = TransportContextWrapImpl::NewInstance(
+                    true, new napa::transport::TransportContext(std::move(chunk->transportContext)));
+            } else if (!result->error.empty()) {
+                argv[2] = v8_helpers::MakeV8String(isolate, result->error);
+            }
+
+            // An exception of the callback is left to the caller of the completion.
+            if (jsCallback->Call(context, context->Global(), 3, argv).IsEmpty()) {
+                return;
+            }
+        }
+    );
+}
+
+void StreamChannelWrap::CancelCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder());
+    thisObject->GetRef<StreamChannel>().Cancel();
+}
+
+void StreamChannelWrap::IsClosedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder());
+    args.GetReturnValue().Set(thisObject->GetRef<StreamChannel>().IsClosed());
+}
+
+void StreamChannelWrap::GetSizeCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder());
+    args.GetReturnValue().Set(static_cast<uint32_t>(thisObject->GetRef<StreamChannel>().GetSize()));
+}
+
+void StreamChannelWrap::GetCapacityCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<StreamChannelWrap>(args.Holder());
+    args.GetReturnValue().Set(static_cast<uint32_t>(thisObject->GetRef<StreamChannel>().GetCapacity()));
+}
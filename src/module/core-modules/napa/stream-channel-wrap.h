@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/module.h>
+#include <napa/module/shareable-wrap.h>
+
+namespace napa {
+namespace module {
+
+    /// <summary> It wraps napa::zone::StreamChannel, which is shared by the zone function of a streaming call and its caller. </summary>
+    /// <remarks> Reference: napajs/lib/zone/result-stream.ts </remarks>
+    class StreamChannelWrap : public ShareableWrap {
+    public:
+        /// <summary> Init this wrap. </summary>
+        static void Init();
+
+        /// <summary> Declare constructor in public, so we can export class constructor in JavaScript world. </summary>
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR
+
+        /// <summary> Exported class name. </summary>
+        static constexpr const char* exportName = "StreamChannelWrap";
+
+    private:
+        /// <summary> It implements StreamChannel.write(payload: string | ArrayBuffer, transportContext: TransportContext): number </summary>
+        static void WriteCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StreamChannel.waitWritable(callback: (open: boolean) => void): void </summary>
+        static void WaitWritableCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StreamChannel.end(error?: string): void </summary>
+        static void EndCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StreamChannel.read(callback: (payload, transportContext, error) => void): void </summary>
+        static void ReadCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StreamChannel.cancel(): void </summary>
+        static void CancelCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StreamChannel.closed </summary>
+        static void IsClosedCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StreamChannel.size </summary>
+        static void GetSizeCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements StreamChannel.capacity </summary>
+        static void GetCapacityCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+    };
+}
+}
@@ -2,10 +2,15 @@
 // Licensed under the MIT license.
 
 #include "transport-context-wrap-impl.h"
+#include "array-buffer-transport.h"
 
 #include <napa/module/shareable-wrap.h>
 #include <napa/module/binding/wraps.h>
 
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
 using namespace napa;
 using namespace napa::transport;
 using namespace napa::module;
@@ -14,18 +19,21 @@ using namespace napa::module;
 NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(TransportContextWrapImpl);
 
 TransportContextWrapImpl::TransportContextWrapImpl(TransportContext* context, bool owning) : 
-    _context(context), _owning(owning) {
+    _context(context), _owning(owning), _copyArrayBuffers(false) {
 }
 
-v8::Local<v8::Object> TransportContextWrapImpl::NewInstance(bool owning, napa::transport::TransportContext* context) {
+v8::Local<v8::Object> TransportContextWrapImpl::NewInstance(bool owning, napa::transport::TransportContext* context, bool copyArrayBuffers) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::EscapableHandleScope scope(isolate);
 
-    v8::Local<v8::Value> argv[] = { v8::Boolean::New(isolate, owning), v8_helpers::PtrToV8Uint32Array(isolate, context) };
+    // The context is passed as an external, which is cheaper to create and read than a handle.
+    v8::Local<v8::Value> argv[] = { v8::Boolean::New(isolate, owning), v8::External::New(isolate, context) };
     auto object = napa::module::NewInstance<TransportContextWrapImpl>(sizeof(argv) / sizeof(v8::Local<v8::Value>), argv);
     RETURN_VALUE_ON_PENDING_EXCEPTION(object, v8::Local<v8::Object>());
-    
-    return scope.Escape(object.ToLocalChecked());
+
+    auto instance = object.ToLocalChecked();
+    NAPA_OBJECTWRAP::Unwrap<TransportContextWrapImpl>(instance)->_copyArrayBuffers = copyArrayBuffers;
+    return scope.Escape(instance);
 }
 
 TransportContextWrapImpl::~TransportContextWrapImpl() {
@@ -46,6 +54,13 @@ void TransportContextWrapImpl::Init() {
 
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "saveShared", SaveSharedCallback);
     NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "loadShared", LoadSharedCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "saveShareable", SaveShareableCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "loadShareable", LoadShareableCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "saveAll", SaveAllCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "saveArrayBuffer", SaveArrayBufferCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "loadArrayBuffer", LoadArrayBufferCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "saveSharedArrayBuffer", SaveSharedArrayBufferCallback);
+    NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "loadSharedArrayBuffer", LoadSharedArrayBufferCallback);
     NAPA_SET_ACCESSOR(constructorTemplate, "sharedCount", GetSharedCountCallback, nullptr);
 
     NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructorTemplate->GetFunction());
@@ -78,6 +93,9 @@ void TransportContextWrapImpl::ConstructorCallback(const v8::FunctionCallbackInf
     
     if (args.Length() == 1 || args[1]->IsUndefined()) {
         context = new TransportContext();
+    } else if (args[1]->IsExternal()) {
+        // Only native code creates externals, see NewInstance.
+        context = static_cast<TransportContext*>(v8::Local<v8::External>::Cast(args[1])->Value());
     } else {
         auto result = v8_helpers::V8ValueToPtr<TransportContext>(isolate, args[1]);
         JS_ENSURE(isolate, result.second, 
@@ -85,6 +103,12 @@ void TransportContextWrapImpl::ConstructorCallback(const v8::FunctionCallbackInf
 
         context = result.first;
     }
+
+    // Results without shared objects come with a null handle, give them an empty context of their own.
+    if (context == nullptr) {
+        context = new TransportContext();
+        owning = true;
+    }
     auto wrap = new TransportContextWrapImpl(context, owning);
     wrap->Wrap(args.This());
     args.GetReturnValue().Set(args.This());
@@ -116,3 +140,131 @@ void TransportContextWrapImpl::LoadSharedCallback(const v8::FunctionCallbackInfo
 
     args.GetReturnValue().Set(binding::CreateShareableWrap(object));
 }
+
+void TransportContextWrapImpl::SaveShareableCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"saveShareable\".");
+    CHECK_ARG(isolate, args[0]->IsObject() && v8::Local<v8::Object>::Cast(args[0])->InternalFieldCount() > 0,
+        "Argument \"object\" shall be 'ShareableWrap' type.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(args.Holder());
+    auto object = NAPA_OBJECTWRAP::Unwrap<ShareableWrap>(v8::Local<v8::Object>::Cast(args[0]))->Get<void>();
+
+    // The slot is the address of the object, which keeps payloads valid when their context is saved into another by saveAll.
+    char slot[2 * sizeof(uintptr_t) + 1];
+    auto length = std::snprintf(slot, sizeof(slot), "%" PRIxPTR, reinterpret_cast<uintptr_t>(object.get()));
+    args.GetReturnValue().Set(v8::String::NewFromOneByte(
+        isolate, reinterpret_cast<const uint8_t*>(slot), v8::NewStringType::kNormal, length).ToLocalChecked());
+
+    thisObject->Get()->SaveShared(std::move(object));
+}
+
+void TransportContextWrapImpl::LoadShareableCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    CHECK_ARG(isolate, args.Length() == 2, "2 arguments are required for \"loadShareable\".");
+    CHECK_ARG(isolate, args[0]->IsString(), "Argument \"slot\" shall be 'string' type.");
+    CHECK_ARG(isolate, args[1]->IsFunction(), "Argument \"constructor\" shall be 'Function' type.");
+
+    v8::String::Utf8Value slot(args[0]);
+    char* end = nullptr;
+    auto handle = static_cast<uintptr_t>(std::strtoull(*slot, &end, 16));
+    JS_ENSURE(isolate, slot.length() > 0 && end == *slot + slot.length(), "Unable to parse slot \"%s\" of shareable.", *slot);
+
+    v8::Local<v8::Object> instance;
+    if (!v8::Local<v8::Function>::Cast(args[1])->NewInstance(context).ToLocal(&instance)) {
+        return;
+    }
+    JS_ENSURE(isolate, instance->InternalFieldCount() > 0, "Constructor of shareable shall create a 'ShareableWrap'.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(args.Holder());
+    ShareableWrap::Set(instance, thisObject->Get()->LoadShared<void>(handle));
+    args.GetReturnValue().Set(instance);
+}
+
+void TransportContextWrapImpl::SaveAllCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"saveAll\".");
+    CHECK_ARG(isolate, args[0]->IsObject(), "Argument \"context\" shall be 'TransportContext' type.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(args.Holder());
+    auto otherObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(v8::Local<v8::Object>::Cast(args[0]));
+    JS_ENSURE(isolate, otherObject != nullptr, "Argument \"context\" shall be 'TransportContext' type.");
+
+    thisObject->Get()->SaveAll(*otherObject->Get());
+}
+
+void TransportContextWrapImpl::SaveArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1 || args.Length() == 2, "1 or 2 arguments are required for \"saveArrayBuffer\".");
+    CHECK_ARG(isolate, args[0]->IsArrayBuffer(), "Argument \"buffer\" shall be 'ArrayBuffer' type.");
+    CHECK_ARG(isolate, args.Length() == 1 || args[1]->IsUndefined() || args[1]->IsBoolean(), "Argument \"transfer\" must be boolean.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(args.Holder());
+    auto buffer = array_buffer_transport::Save(
+        v8::Local<v8::ArrayBuffer>::Cast(args[0]), 
+        args.Length() == 2 && args[1]->BooleanValue());
+
+    args.GetReturnValue().Set(v8_helpers::PtrToV8Uint32Array(isolate, buffer.get()));
+    thisObject->Get()->SaveShared(std::move(buffer));
+}
+
+void TransportContextWrapImpl::LoadArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"loadArrayBuffer\".");
+
+    auto result = v8_helpers::V8ValueToUintptr(isolate, args[0]);
+    JS_ENSURE(isolate, result.second, "Unable to cast \"handle\" to pointer. Please check if it's in valid format.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrapImpl>(args.Holder());
+    auto buffer = thisObject->Get()->LoadShared<array_buffer_transport::TransportedArrayBuffer>(result.first);
+    JS_ENSURE(isolate, buffer != nullptr, "ArrayBuffer is not found in transport context.");
+
+    auto arrayBuffer = array_buffer_transport::TransportedArrayBuffer::Load(std::move(buffer), thisObject->_copyArrayBuffers);
+    RETURN_ON_PENDING_EXCEPTION(arrayBuffer);
+
+    args.GetReturnValue().Set(arrayBuffer.ToLocalChecked());
+}
+
+void TransportContextWrapImpl::SaveSharedArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"saveSharedArrayBuffer\".");
+    CHECK_ARG(isolate, args[0]->IsSharedArrayBuffer(), "Argument \"buffer\" shall be 'SharedArrayBuffer' type.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(args.Holder());
+    auto memory = array_buffer_transport::Share(v8::Local<v8::SharedArrayBuffer>::Cast(args[0]));
+    if (memory == nullptr) {
+        return;
+    }
+
+    args.GetReturnValue().Set(v8_helpers::PtrToV8Uint32Array(isolate, memory.get()));
+    thisObject->Get()->SaveShared(std::move(memory));
+}
+
+void TransportContextWrapImpl::LoadSharedArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    CHECK_ARG(isolate, args.Length() == 1, "1 argument is required for \"loadSharedArrayBuffer\".");
+
+    auto result = v8_helpers::V8ValueToUintptr(isolate, args[0]);
+    JS_ENSURE(isolate, result.second, "Unable to cast \"handle\" to pointer. Please check if it's in valid format.");
+
+    auto thisObject = NAPA_OBJECTWRAP::Unwrap<TransportContextWrap>(args.Holder());
+    auto memory = thisObject->Get()->LoadShared<napa::memory::SharedMemory>(result.first);
+    JS_ENSURE(isolate, memory != nullptr, "SharedArrayBuffer is not found in transport context.");
+
+    args.GetReturnValue().Set(array_buffer_transport::LoadShared(std::move(memory)));
+}
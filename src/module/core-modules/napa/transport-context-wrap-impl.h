@@ -17,7 +17,11 @@ namespace module {
         static void Init();
 
         /// <summary> Create a non-owning transport context wrap. </summary>
-        static v8::Local<v8::Object> NewInstance(bool owning = true, napa::transport::TransportContext* context = nullptr);
+        /// <param name="copyArrayBuffers"> Load copies of ArrayBuffers, for contexts that are loaded repeatedly. </param>
+        static v8::Local<v8::Object> NewInstance(
+            bool owning = true, 
+            napa::transport::TransportContext* context = nullptr, 
+            bool copyArrayBuffers = false);
 
         /// <summary> Destructor. </summary>
         ~TransportContextWrapImpl(); 
@@ -51,11 +55,35 @@ namespace module {
         /// <summary> It implements TransportContext.loadShared(handle: Handle): napajs.memory.ShareableWrap) </summary>
         static void LoadSharedCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+        /// <summary> It implements TransportContext.saveShareable(object: napajs.memory.ShareableWrap): string </summary>
+        static void SaveShareableCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements TransportContext.loadShareable(slot: string, constructor: Function): napajs.memory.ShareableWrap </summary>
+        static void LoadShareableCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements TransportContext.saveAll(context: TransportContext) </summary>
+        static void SaveAllCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements TransportContext.saveArrayBuffer(buffer: ArrayBuffer, transfer: boolean): Handle </summary>
+        static void SaveArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements TransportContext.loadArrayBuffer(handle: Handle): ArrayBuffer </summary>
+        static void LoadArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements TransportContext.saveSharedArrayBuffer(buffer: SharedArrayBuffer): Handle </summary>
+        static void SaveSharedArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements TransportContext.loadSharedArrayBuffer(handle: Handle): SharedArrayBuffer </summary>
+        static void LoadSharedArrayBufferCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
         /// <summary> Transport context. </summary>
         napa::transport::TransportContext* _context;
 
         /// <summary> Own context or not. </summary>
         bool _owning;
+
+        /// <summary> Load copies of ArrayBuffers instead of taking their memory over. </summary>
+        bool _copyArrayBuffers;
     };
 }
 }
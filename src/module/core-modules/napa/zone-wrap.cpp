@@ -3,13 +3,21 @@
 
 #include "zone-wrap.h"
 
+#include "binary-transport.h"
+#include "cancellation-token-wrap.h"
 #include "transport-context-wrap-impl.h"
 
+#include <zone/cancellation-token.h>
+#include <zone/cpu-governor.h>
+#include <zone/sync-wait.h>
+#include <zone/task-graph.h>
+
 #include <napa/zone.h>
 #include <napa/assert.h>
 #include <napa/async.h>
 #include <napa/v8-helpers.h>
 
+#include <chrono>
 #include <sstream>
 #include <vector>
 
@@ -18,10 +26,82 @@ using namespace napa::v8_helpers;
 
 NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(ZoneWrap);
 
+/// <summary> A function spec along with the strings it refers to. </summary>
+struct FunctionSpecHolder {
+    napa::FunctionSpec spec;
+    Utf8String module;
+    Utf8String function;
+    std::vector<Utf8String> arguments;
+    std::vector<std::string> binaryArguments;
+    Utf8String affinityKey;
+    Utf8String workerClass;
+    Utf8String tenant;
+    Utf8String traceId;
+    std::shared_ptr<napa::zone::CancellationToken> cancellationToken;
+};
+
+/// <summary> Stages of a pipeline, each a call in a zone which takes the result of the previous stage. </summary>
+struct PipelineState {
+    explicit PipelineState(size_t stages) : holders(stages), zones(stages) {}
+
+    /// <summary> Holders are created in place, since moving one would invalidate the references of its spec. </summary>
+    std::vector<FunctionSpecHolder> holders;
+    std::vector<std::unique_ptr<napa::Zone>> zones;
+
+    /// <summary> Completes the pipeline with the result of the last stage, or of the stage that failed. </summary>
+    std::function<void(void*)> complete;
+
+    uint64_t cpuTime = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+/// <summary> Nodes of a graph, each a call in the zone which takes the results of the nodes it depends on. </summary>
+struct GraphState {
+    explicit GraphState(size_t nodes) : holders(nodes) {}
+
+    /// <summary> Holders are created in place, since moving one would invalidate the references of its spec. </summary>
+    std::vector<FunctionSpecHolder> holders;
+    std::unique_ptr<napa::Zone> zone;
+};
+
+/// <summary> Constructor of response objects, whose instances have all properties of a response from the start. </summary>
+struct ZoneResponse {
+    static constexpr const char* exportName = "ZoneResponse";
+
+    enum Property { CODE, ERROR_MESSAGE, RETURN_VALUE, TRANSPORT_CONTEXT, CPU_TIME, ALLOCATED_BYTES, PROPERTY_COUNT };
+
+    static void Init() {
+        auto isolate = v8::Isolate::GetCurrent();
+
+        auto functionTemplate = v8::FunctionTemplate::New(isolate);
+        functionTemplate->SetClassName(MakeV8String(isolate, exportName));
+        for (int i = 0; i < PROPERTY_COUNT; ++i) {
+            functionTemplate->InstanceTemplate()->Set(GetName(isolate, static_cast<Property>(i)), v8::Undefined(isolate));
+        }
+
+        NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, functionTemplate->GetFunction());
+    }
+
+    /// <summary> Gets the name of a property, internalized as property names are. </summary>
+    static v8::Local<v8::String> GetName(v8::Isolate* isolate, Property property) {
+        static const char* names[PROPERTY_COUNT] = {
+            "code", "errorMessage", "returnValue", "transportContext", "cpuTime", "allocatedBytes"
+        };
+        return v8::String::NewFromUtf8(isolate, names[property], v8::NewStringType::kInternalized).ToLocalChecked();
+    }
+
+    NAPA_DECLARE_PERSISTENT_CONSTRUCTOR;
+};
+
+NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(ZoneResponse);
+
 // Forward declaration.
-static v8::Local<v8::Object> CreateResponseObject(const napa::Result& result);
-template <typename Func>
-static void CreateRequestAndExecute(v8::Local<v8::Object> obj, Func&& func);
+static v8::Local<v8::Object> CreateResponseObject(napa::Result& result, bool binary);
+static bool CreateRequest(v8::Local<v8::Object> obj, FunctionSpecHolder& holder);
+static void ExecuteStage(std::shared_ptr<PipelineState> state, size_t stage, napa::Result previous);
+static void ExecuteGraphNode(GraphState& state, uint32_t node, const napa::zone::TaskGraph::Inputs& inputs, napa::ExecuteCallback callback);
+static std::chrono::milliseconds GetWaitTimeout(const v8::FunctionCallbackInfo<v8::Value>& args, int index);
+static v8::Local<v8::Value> MakeWaitTime(v8::Isolate* isolate, std::chrono::nanoseconds waitTime);
 
 void ZoneWrap::Init() {
     auto isolate = v8::Isolate::GetCurrent();
@@ -37,9 +117,28 @@ void ZoneWrap::Init() {
     NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "broadcastSync", BroadcastSync);
     NODE_SET_PROTOTYPE_METHOD(functionTemplate, "execute", Execute);
     NODE_SET_PROTOTYPE_METHOD(functionTemplate, "executeSync", ExecuteSync);
+    NODE_SET_PROTOTYPE_METHOD(functionTemplate, "executeBatch", ExecuteBatch);
+    NODE_SET_PROTOTYPE_METHOD(functionTemplate, "executePipeline", ExecutePipeline);
+    NODE_SET_PROTOTYPE_METHOD(functionTemplate, "executeGraph", ExecuteGraph);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "resize", Resize);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "drain", Drain);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "getPressure", GetPressure);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "getWorkers", GetWorkers);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "getMemoryUsage", GetMemoryUsage);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "startProfiling", StartProfiling);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "stopProfiling", StopProfiling);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "startAllocationProfiling", StartAllocationProfiling);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "stopAllocationProfiling", StopAllocationProfiling);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "getHeapStatistics", GetHeapStatistics);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "writeHeapSnapshot", WriteHeapSnapshot);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "getSlowCalls", GetSlowCalls);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "getFunctionStats", GetFunctionStats);
+    NAPA_SET_PROTOTYPE_METHOD(functionTemplate, "serve", Serve);
 
     // Set persistent constructor into V8.
     NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, functionTemplate->GetFunction());
+
+    ZoneResponse::Init();
 }
 
 v8::Local<v8::Object> ZoneWrap::NewInstance(std::unique_ptr<napa::Zone> zoneProxy) {
@@ -54,6 +153,17 @@ v8::Local<v8::Object> ZoneWrap::NewInstance(std::unique_ptr<napa::Zone> zoneProx
     return object;
 }
 
+const napa::Zone* ZoneWrap::GetZoneProxy(v8::Local<v8::Value> value) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    auto constructor = NAPA_GET_PERSISTENT_CONSTRUCTOR(exportName, ZoneWrap);
+    if (!value->IsObject() || !value->InstanceOf(context, constructor).FromMaybe(false)) {
+        return nullptr;
+    }
+    return NAPA_OBJECTWRAP::Unwrap<ZoneWrap>(v8::Local<v8::Object>::Cast(value))->_zoneProxy.get();
+}
+
 void ZoneWrap::GetId(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
 
@@ -62,6 +172,22 @@ void ZoneWrap::GetId(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(MakeV8String(isolate, wrap->_zoneProxy->GetId()));
 }
 
+void ZoneWrap::GetPressure(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Number::New(isolate, wrap->_zoneProxy->GetPressure()));
+}
+
+void ZoneWrap::GetWorkers(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+    args.GetReturnValue().Set(v8::Integer::NewFromUnsigned(isolate, wrap->_zoneProxy->GetWorkers()));
+}
+
 void ZoneWrap::Broadcast(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
 
@@ -92,17 +218,479 @@ void ZoneWrap::Broadcast(const v8::FunctionCallbackInfo<v8::Value>& args) {
     );
 }
 
+void ZoneWrap::Resize(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsUint32(), "first argument to zone.resize must be the number of workers");
+    CHECK_ARG(isolate, args[1]->IsFunction(), "second argument to zone.resize must be the callback");
+
+    auto workers = args[0]->Uint32Value();
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[1]),
+        [&args, workers](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->Resize(workers, [complete = std::move(complete)](ResultCode resultCode) {
+                complete(reinterpret_cast<void*>(static_cast<uintptr_t>(resultCode)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::vector<v8::Local<v8::Value>> argv;
+            auto resultCode = static_cast<ResultCode>(reinterpret_cast<uintptr_t>(result));
+            argv.emplace_back(v8::Uint32::NewFromUnsigned(isolate, resultCode));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::Drain(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsUint32(), "first argument to zone.drain must be the timeout in milliseconds");
+    CHECK_ARG(isolate, args[1]->IsFunction(), "second argument to zone.drain must be the callback");
+
+    auto timeout = args[0]->Uint32Value();
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[1]),
+        [&args, timeout](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->Drain(timeout, [complete = std::move(complete)](ResultCode resultCode, size_t cancelled) {
+                complete(new std::pair<ResultCode, size_t>(resultCode, cancelled));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::unique_ptr<std::pair<ResultCode, size_t>> outcome(static_cast<std::pair<ResultCode, size_t>*>(result));
+
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(v8::Uint32::NewFromUnsigned(isolate, outcome->first));
+            argv.emplace_back(v8::Number::New(isolate, static_cast<double>(outcome->second)));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::Serve(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsString(), "first argument to zone.serve must be the address to listen on");
+    v8::String::Utf8Value address(args[0]->ToString());
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+    try {
+        auto port = wrap->_zoneProxy->Serve(*address);
+        args.GetReturnValue().Set(v8::Integer::NewFromUnsigned(isolate, port));
+    } catch (const std::exception& ex) {
+        JS_FAIL(isolate, "%s", ex.what());
+    }
+}
+
+void ZoneWrap::GetMemoryUsage(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsFunction(), "first argument to zone.getMemoryUsage must be the callback");
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&args](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->GetMemoryUsage([complete = std::move(complete)](std::vector<napa::WorkerMemoryUsage> usages) {
+                complete(new std::vector<napa::WorkerMemoryUsage>(std::move(usages)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::unique_ptr<std::vector<napa::WorkerMemoryUsage>> usages(static_cast<std::vector<napa::WorkerMemoryUsage>*>(result));
+
+            auto set = [isolate, context](v8::Local<v8::Object> object, const char* name, double value) {
+                (void)object->CreateDataProperty(context, MakeV8String(isolate, name), v8::Number::New(isolate, value));
+            };
+
+            auto array = v8::Array::New(isolate, static_cast<int>(usages->size()));
+            for (uint32_t i = 0; i < usages->size(); ++i) {
+                const auto& usage = (*usages)[i];
+                auto object = v8::Object::New(isolate);
+                set(object, "workerId", usage.worker_id);
+                set(object, "usedHeapSize", static_cast<double>(usage.used_heap_size));
+                set(object, "totalHeapSize", static_cast<double>(usage.total_heap_size));
+                set(object, "totalPhysicalSize", static_cast<double>(usage.total_physical_size));
+                set(object, "heapSizeLimit", static_cast<double>(usage.heap_size_limit));
+                set(object, "mallocedMemory", static_cast<double>(usage.malloced_memory));
+                set(object, "peakMallocedMemory", static_cast<double>(usage.peak_malloced_memory));
+                set(object, "externalMemory", static_cast<double>(usage.external_memory));
+                set(object, "nativeAllocate", static_cast<double>(usage.native_allocate_count));
+                set(object, "nativeAllocatedSize", static_cast<double>(usage.native_allocated_size));
+                set(object, "nativeDeallocate", static_cast<double>(usage.native_deallocate_count));
+                set(object, "nativeDeallocatedSize", static_cast<double>(usage.native_deallocated_size));
+                (void)array->Set(context, i, object);
+            }
+
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(array);
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::GetHeapStatistics(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsFunction(), "first argument to zone.getHeapStatistics must be the callback");
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&args](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->GetHeapStatistics([complete = std::move(complete)](std::vector<napa::WorkerHeapStatistics> statistics) {
+                complete(new std::vector<napa::WorkerHeapStatistics>(std::move(statistics)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::unique_ptr<std::vector<napa::WorkerHeapStatistics>> statistics(static_cast<std::vector<napa::WorkerHeapStatistics>*>(result));
+
+            auto set = [isolate, context](v8::Local<v8::Object> object, const char* name, double value) {
+                (void)object->CreateDataProperty(context, MakeV8String(isolate, name), v8::Number::New(isolate, value));
+            };
+
+            auto array = v8::Array::New(isolate, static_cast<int>(statistics->size()));
+            for (uint32_t i = 0; i < statistics->size(); ++i) {
+                const auto& worker = (*statistics)[i];
+                auto object = v8::Object::New(isolate);
+                set(object, "workerId", worker.workerId);
+                set(object, "totalHeapSize", static_cast<double>(worker.totalHeapSize));
+                set(object, "totalHeapSizeExecutable", static_cast<double>(worker.totalHeapSizeExecutable));
+                set(object, "totalPhysicalSize", static_cast<double>(worker.totalPhysicalSize));
+                set(object, "totalAvailableSize", static_cast<double>(worker.totalAvailableSize));
+                set(object, "usedHeapSize", static_cast<double>(worker.usedHeapSize));
+                set(object, "heapSizeLimit", static_cast<double>(worker.heapSizeLimit));
+                set(object, "mallocedMemory", static_cast<double>(worker.mallocedMemory));
+                set(object, "peakMallocedMemory", static_cast<double>(worker.peakMallocedMemory));
+                set(object, "numberOfNativeContexts", static_cast<double>(worker.numberOfNativeContexts));
+                set(object, "numberOfDetachedContexts", static_cast<double>(worker.numberOfDetachedContexts));
+
+                auto spaces = v8::Array::New(isolate, static_cast<int>(worker.spaces.size()));
+                for (uint32_t j = 0; j < worker.spaces.size(); ++j) {
+                    const auto& space = worker.spaces[j];
+                    auto spaceObject = v8::Object::New(isolate);
+                    (void)spaceObject->CreateDataProperty(context, MakeV8String(isolate, "spaceName"), MakeV8String(isolate, space.name));
+                    set(spaceObject, "spaceSize", static_cast<double>(space.size));
+                    set(spaceObject, "spaceUsedSize", static_cast<double>(space.usedSize));
+                    set(spaceObject, "spaceAvailableSize", static_cast<double>(space.availableSize));
+                    set(spaceObject, "physicalSpaceSize", static_cast<double>(space.physicalSize));
+                    (void)spaces->Set(context, j, spaceObject);
+                }
+                (void)object->CreateDataProperty(context, MakeV8String(isolate, "spaces"), spaces);
+                (void)array->Set(context, i, object);
+            }
+
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(array);
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::WriteHeapSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsUint32(), "first argument to zone.writeHeapSnapshot must be the worker id");
+    CHECK_ARG(isolate, args[1]->IsString(), "second argument to zone.writeHeapSnapshot must be the file path");
+    CHECK_ARG(isolate, args[2]->IsFunction(), "third argument to zone.writeHeapSnapshot must be the callback");
+
+    auto workerId = args[0]->Uint32Value();
+    std::string path = *v8::String::Utf8Value(args[1]);
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[2]),
+        [&args, workerId, &path](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->WriteHeapSnapshot(workerId, path, [complete = std::move(complete)](ResultCode resultCode) {
+                complete(reinterpret_cast<void*>(static_cast<uintptr_t>(resultCode)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::vector<v8::Local<v8::Value>> argv;
+            auto resultCode = static_cast<ResultCode>(reinterpret_cast<uintptr_t>(result));
+            argv.emplace_back(v8::Uint32::NewFromUnsigned(isolate, resultCode));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::GetSlowCalls(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+    auto calls = wrap->_zoneProxy->GetSlowCalls();
+
+    auto set = [isolate, context](v8::Local<v8::Object> object, const char* name, v8::Local<v8::Value> value) {
+        (void)object->CreateDataProperty(context, MakeV8String(isolate, name), value);
+    };
+
+    // Phases are reported in microseconds, and the start in milliseconds since the epoch as Date takes it.
+    auto microseconds = [isolate](uint64_t nanoseconds) {
+        return v8::Number::New(isolate, static_cast<double>(nanoseconds) / 1000);
+    };
+
+    auto array = v8::Array::New(isolate, static_cast<int>(calls.size()));
+    for (uint32_t i = 0; i < calls.size(); ++i) {
+        const auto& call = calls[i];
+        auto object = v8::Object::New(isolate);
+        set(object, "module", MakeV8String(isolate, call.module));
+        set(object, "function", MakeV8String(isolate, call.function));
+        if (call.workerId != UINT32_MAX) {
+            set(object, "workerId", v8::Integer::NewFromUnsigned(isolate, call.workerId));
+        }
+        set(object, "code", v8::Integer::NewFromUnsigned(isolate, call.code));
+        set(object, "sampled", v8::Boolean::New(isolate, call.sampled));
+        set(object, "startTime", v8::Number::New(isolate, static_cast<double>(call.startTime) / 1000));
+        set(object, "queueTime", microseconds(call.queueTime));
+        set(object, "unmarshallTime", microseconds(call.unmarshallTime));
+        set(object, "executionTime", microseconds(call.executionTime));
+        set(object, "marshallTime", microseconds(call.marshallTime));
+        set(object, "completionTime", microseconds(call.completionTime));
+
+        auto argumentSizes = v8::Array::New(isolate, static_cast<int>(call.argumentSizes.size()));
+        for (uint32_t j = 0; j < call.argumentSizes.size(); ++j) {
+            (void)argumentSizes->Set(context, j, v8::Number::New(isolate, static_cast<double>(call.argumentSizes[j])));
+        }
+        set(object, "argumentSizes", argumentSizes);
+
+        if (!call.arguments.empty()) {
+            auto arguments = v8::Array::New(isolate, static_cast<int>(call.arguments.size()));
+            for (uint32_t j = 0; j < call.arguments.size(); ++j) {
+                (void)arguments->Set(context, j, MakeV8String(isolate, call.arguments[j]));
+            }
+            set(object, "arguments", arguments);
+        }
+        (void)array->Set(context, i, object);
+    }
+    args.GetReturnValue().Set(array);
+}
+
+void ZoneWrap::GetFunctionStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+    auto stats = wrap->_zoneProxy->GetFunctionStats();
+
+    auto set = [isolate, context](v8::Local<v8::Object> object, const char* name, v8::Local<v8::Value> value) {
+        (void)object->CreateDataProperty(context, MakeV8String(isolate, name), value);
+    };
+
+    // Times are reported in microseconds, as for slow calls.
+    auto microseconds = [isolate](uint64_t nanoseconds) {
+        return v8::Number::New(isolate, static_cast<double>(nanoseconds) / 1000);
+    };
+    auto count = [isolate](uint64_t value) {
+        return v8::Number::New(isolate, static_cast<double>(value));
+    };
+
+    auto array = v8::Array::New(isolate, static_cast<int>(stats.size()));
+    for (uint32_t i = 0; i < stats.size(); ++i) {
+        const auto& function = stats[i];
+        auto object = v8::Object::New(isolate);
+        set(object, "module", MakeV8String(isolate, function.module));
+        set(object, "function", MakeV8String(isolate, function.function));
+        set(object, "calls", count(function.calls));
+        set(object, "errors", count(function.errors));
+        set(object, "timeouts", count(function.timeouts));
+        set(object, "totalTime", microseconds(function.totalTime));
+        set(object, "maxTime", microseconds(function.maxTime));
+
+        auto histogram = v8::Array::New(isolate, static_cast<int>(function.histogram.size()));
+        for (uint32_t j = 0; j < function.histogram.size(); ++j) {
+            (void)histogram->Set(context, j, count(function.histogram[j]));
+        }
+        set(object, "histogram", histogram);
+        (void)array->Set(context, i, object);
+    }
+    args.GetReturnValue().Set(array);
+}
+
+void ZoneWrap::StartProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsUint32(), "first argument to zone.startProfiling must be the sampling interval in microseconds");
+    CHECK_ARG(isolate, args[1]->IsFunction(), "second argument to zone.startProfiling must be the callback");
+
+    auto samplingInterval = args[0]->Uint32Value();
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[1]),
+        [&args, samplingInterval](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->StartProfiling(samplingInterval, [complete = std::move(complete)](ResultCode resultCode) {
+                complete(reinterpret_cast<void*>(static_cast<uintptr_t>(resultCode)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::vector<v8::Local<v8::Value>> argv;
+            auto resultCode = static_cast<ResultCode>(reinterpret_cast<uintptr_t>(result));
+            argv.emplace_back(v8::Uint32::NewFromUnsigned(isolate, resultCode));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::StopProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsFunction(), "first argument to zone.stopProfiling must be the callback");
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&args](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->StopProfiling([complete = std::move(complete)](std::vector<std::string> profiles) {
+                complete(new std::vector<std::string>(std::move(profiles)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::unique_ptr<std::vector<std::string>> profiles(static_cast<std::vector<std::string>*>(result));
+
+            // .cpuprofile JSON of each worker, empty for workers which weren't profiling.
+            auto array = v8::Array::New(isolate, static_cast<int>(profiles->size()));
+            for (uint32_t i = 0; i < profiles->size(); ++i) {
+                (void)array->Set(context, i, MakeV8String(isolate, (*profiles)[i]));
+            }
+
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(array);
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::StartAllocationProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsUint32(), "first argument to zone.startAllocationProfiling must be the sampling interval in bytes");
+    CHECK_ARG(isolate, args[1]->IsFunction(), "second argument to zone.startAllocationProfiling must be the callback");
+
+    auto samplingInterval = args[0]->Uint32Value();
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[1]),
+        [&args, samplingInterval](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->StartAllocationProfiling(samplingInterval, [complete = std::move(complete)](ResultCode resultCode) {
+                complete(reinterpret_cast<void*>(static_cast<uintptr_t>(resultCode)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            std::vector<v8::Local<v8::Value>> argv;
+            auto resultCode = static_cast<ResultCode>(reinterpret_cast<uintptr_t>(result));
+            argv.emplace_back(v8::Uint32::NewFromUnsigned(isolate, resultCode));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
+void ZoneWrap::StopAllocationProfiling(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsFunction(), "first argument to zone.stopAllocationProfiling must be the callback");
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[0]),
+        [&args](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+
+            wrap->_zoneProxy->StopAllocationProfiling([complete = std::move(complete)](std::string profile) {
+                complete(new std::string(std::move(profile)));
+            });
+        },
+        [](auto jsCallback, void* result) {
+            auto isolate = v8::Isolate::GetCurrent();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            // Merged .heapprofile JSON of all workers, empty if none was profiling.
+            std::unique_ptr<std::string> profile(static_cast<std::string*>(result));
+
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(MakeV8String(isolate, *profile));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+        }
+    );
+}
+
 void ZoneWrap::BroadcastSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
 
     CHECK_ARG(isolate, args[0]->IsString(), "first argument to zone.broadcastSync must be the javascript source");
+    CHECK_ARG(isolate, args.Length() < 2 || args[1]->IsUndefined() || args[1]->IsUint32(),
+        "second argument to zone.broadcastSync must be the wait timeout in milliseconds");
 
     v8::String::Utf8Value source(args[0]->ToString());
+    auto timeout = GetWaitTimeout(args, 1);
 
     auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
-    auto resultCode = wrap->_zoneProxy->BroadcastSync(*source);
+    auto syncResult = std::make_shared<napa::zone::SyncResult<napa::ResultCode>>();
+    wrap->_zoneProxy->Broadcast(*source, [syncResult](napa::ResultCode code) {
+        syncResult->Set(code);
+    });
 
-    args.GetReturnValue().Set(v8::Uint32::NewFromUnsigned(isolate, resultCode));
+    // The broadcast goes on after a timeout, workers that didn't run it yet still do.
+    napa::ResultCode resultCode;
+    std::chrono::nanoseconds waitTime;
+    bool done;
+    {
+        // A worker doesn't hold a slot of the CPU budget that the broadcast may need.
+        napa::zone::CpuGovernor::Yield yield;
+        done = syncResult->Wait(timeout, resultCode, waitTime);
+    }
+    if (!done) {
+        resultCode = NAPA_RESULT_TIMEOUT;
+    }
+
+    auto response = v8::Object::New(isolate);
+    (void)response->CreateDataProperty(context, MakeV8String(isolate, "code"), v8::Uint32::NewFromUnsigned(isolate, resultCode));
+    (void)response->CreateDataProperty(context, MakeV8String(isolate, "waitTime"), MakeWaitTime(isolate, waitTime));
+    args.GetReturnValue().Set(response);
 }
 
 void ZoneWrap::Execute(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -111,17 +699,22 @@ void ZoneWrap::Execute(const v8::FunctionCallbackInfo<v8::Value>& args) {
     CHECK_ARG(isolate, args[0]->IsObject(), "first argument to zone.execute must be the function spec object");
     CHECK_ARG(isolate, args[1]->IsFunction(), "second argument to zone.execute must be the callback");
 
+    // Binary results are handed back as ArrayBuffers, which is known only from the request.
+    FunctionSpecHolder holder;
+    if (!CreateRequest(args[0]->ToObject(), holder)) {
+        return;
+    }
+    auto binary = holder.spec.options.transport == napa::TransportOption::BINARY;
+
     napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[1]),
-        [&args](std::function<void(void*)> complete) {
-            CreateRequestAndExecute(args[0]->ToObject(), [&args, &complete](const napa::FunctionSpec& spec) {
-                auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+        [&args, &holder](std::function<void(void*)> complete) {
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
 
-                wrap->_zoneProxy->Execute(spec, [complete = std::move(complete)](napa::Result result) {
-                    complete(new napa::Result(std::move(result)));
-                });
+            wrap->_zoneProxy->Execute(holder.spec, [complete = std::move(complete)](napa::Result result) {
+                complete(new napa::Result(std::move(result)));
             });
         },
-        [](auto jsCallback, void* res) {
+        [binary](auto jsCallback, void* res) {
             auto isolate = v8::Isolate::GetCurrent();
             auto context = isolate->GetCurrentContext();
 
@@ -130,7 +723,7 @@ void ZoneWrap::Execute(const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::HandleScope scope(isolate);
 
             std::vector<v8::Local<v8::Value>> argv;
-            argv.emplace_back(CreateResponseObject(*result));
+            argv.emplace_back(CreateResponseObject(*result, binary));
 
             (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
 
@@ -141,81 +734,404 @@ void ZoneWrap::Execute(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 void ZoneWrap::ExecuteSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
     auto isolate = v8::Isolate::GetCurrent();
+    auto context = isolate->GetCurrentContext();
 
-    CHECK_ARG(isolate, args[0]->IsObject(), "first argument to zone.execute must be the function spec object");
+    CHECK_ARG(isolate, args[0]->IsObject(), "first argument to zone.executeSync must be the function spec object");
+    CHECK_ARG(isolate, args.Length() < 2 || args[1]->IsUndefined() || args[1]->IsUint32(),
+        "second argument to zone.executeSync must be the wait timeout in milliseconds");
+
+    FunctionSpecHolder holder;
+    if (!CreateRequest(args[0]->ToObject(), holder)) {
+        return;
+    }
+    auto binary = holder.spec.options.transport == napa::TransportOption::BINARY;
+    auto timeout = GetWaitTimeout(args, 1);
+
+    // A call without a timeout of its own doesn't run longer than anyone waits for it.
+    if (holder.spec.options.timeout == 0) {
+        holder.spec.options.timeout = static_cast<uint32_t>(timeout.count());
+    }
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+    auto syncResult = std::make_shared<napa::zone::SyncResult<napa::Result>>();
+    wrap->_zoneProxy->Execute(holder.spec, [syncResult](napa::Result result) {
+        syncResult->Set(std::move(result));
+    });
+
+    napa::Result result;
+    std::chrono::nanoseconds waitTime;
+    bool done;
+    {
+        // A worker doesn't hold a slot of the CPU budget that the call may need.
+        napa::zone::CpuGovernor::Yield yield;
+        done = syncResult->Wait(timeout, result, waitTime);
+    }
+    if (!done) {
+        result.code = NAPA_RESULT_TIMEOUT;
+        result.errorMessage = "Timed out after waiting " + std::to_string(timeout.count()) + "ms for the call";
+    }
+
+    auto response = CreateResponseObject(result, binary);
+    (void)response->CreateDataProperty(context, MakeV8String(isolate, "waitTime"), MakeWaitTime(isolate, waitTime));
+    args.GetReturnValue().Set(response);
+}
+
+void ZoneWrap::ExecuteBatch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsArray(), "first argument to zone.executeBatch must be an array of function spec objects");
+    CHECK_ARG(isolate, args[1]->IsFunction(), "second argument to zone.executeBatch must be the callback");
+
+    // Holders keep the strings referred by specs alive until all calls are scheduled.
+    auto specsArray = v8::Local<v8::Array>::Cast(args[0]);
+    std::vector<FunctionSpecHolder> holders(specsArray->Length());
+    std::vector<bool> binaries(specsArray->Length());
+    for (uint32_t i = 0; i < specsArray->Length(); i++) {
+        auto specValue = specsArray->Get(i);
+        CHECK_ARG(isolate, specValue->IsObject(), "elements of zone.executeBatch's first argument must be function spec objects");
+
+        if (!CreateRequest(specValue->ToObject(), holders[i])) {
+            return;
+        }
+        binaries[i] = holders[i].spec.options.transport == napa::TransportOption::BINARY;
+    }
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[1]),
+        [&args, &holders](std::function<void(void*)> complete) {
+            std::vector<napa::FunctionSpec> specs;
+            specs.reserve(holders.size());
+            for (auto& holder : holders) {
+                specs.emplace_back(std::move(holder.spec));
+            }
+
+            auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+            wrap->_zoneProxy->ExecuteBatch(specs, [complete = std::move(complete)](std::vector<napa::Result> results) {
+                complete(new std::vector<napa::Result>(std::move(results)));
+            });
+        },
+        [binaries = std::move(binaries)](auto jsCallback, void* res) {
+            auto isolate = v8::Isolate::GetCurrent();
+            auto context = isolate->GetCurrentContext();
+
+            auto results = static_cast<std::vector<napa::Result>*>(res);
+
+            v8::HandleScope scope(isolate);
 
-    CreateRequestAndExecute(args[0]->ToObject(), [&args](const napa::FunctionSpec& spec) {
-        auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+            auto responses = v8::Array::New(isolate, static_cast<int>(results->size()));
+            for (uint32_t i = 0; i < results->size(); i++) {
+                (void)responses->CreateDataProperty(context, i, CreateResponseObject((*results)[i], binaries[i]));
+            }
 
-        napa::Result result = wrap->_zoneProxy->ExecuteSync(spec);
-        args.GetReturnValue().Set(CreateResponseObject(result));
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(responses);
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+
+            delete results;
+        }
+    );
+}
+
+void ZoneWrap::ExecutePipeline(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsArray(), "first argument to zone.executePipeline must be an array of function spec objects");
+    CHECK_ARG(isolate, args[1]->IsArray(), "second argument to zone.executePipeline must be an array of zone ids");
+    CHECK_ARG(isolate, args[2]->IsFunction(), "third argument to zone.executePipeline must be the callback");
+
+    // This zone runs the first stage, the zone ids are of the stages that follow.
+    auto specsArray = v8::Local<v8::Array>::Cast(args[0]);
+    auto zoneIdsArray = v8::Local<v8::Array>::Cast(args[1]);
+    CHECK_ARG(isolate, specsArray->Length() > 0, "zone.executePipeline requires at least one stage");
+    CHECK_ARG(isolate, zoneIdsArray->Length() + 1 == specsArray->Length(), "zone.executePipeline requires a zone id per stage after the first");
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+    auto state = std::make_shared<PipelineState>(specsArray->Length());
+    for (uint32_t i = 0; i < specsArray->Length(); i++) {
+        auto specValue = specsArray->Get(i);
+        CHECK_ARG(isolate, specValue->IsObject(), "elements of zone.executePipeline's first argument must be function spec objects");
+
+        if (!CreateRequest(specValue->ToObject(), state->holders[i])) {
+            return;
+        }
+
+        // Proxies of their own keep the zones of all stages alive until the pipeline completes.
+        auto zoneId = i == 0 ? wrap->_zoneProxy->GetId() : std::string(*v8::String::Utf8Value(zoneIdsArray->Get(i - 1)));
+        try {
+            state->zones[i] = napa::Zone::Get(zoneId);
+        } catch (const std::exception& ex) {
+            JS_FAIL(isolate, "%s", ex.what());
+        }
+    }
+    auto binary = state->holders.back().spec.options.transport == napa::TransportOption::BINARY;
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[2]),
+        [&state](std::function<void(void*)> complete) {
+            state->complete = std::move(complete);
+            ExecuteStage(std::move(state), 0, napa::Result());
+        },
+        [binary](auto jsCallback, void* res) {
+            auto isolate = v8::Isolate::GetCurrent();
+            auto context = isolate->GetCurrentContext();
+
+            auto result = static_cast<napa::Result*>(res);
+
+            v8::HandleScope scope(isolate);
+
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(CreateResponseObject(*result, binary));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+
+            delete result;
+        }
+    );
+}
+
+void ZoneWrap::ExecuteGraph(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = v8::Isolate::GetCurrent();
+
+    CHECK_ARG(isolate, args[0]->IsArray(), "first argument to zone.executeGraph must be an array of function spec objects");
+    CHECK_ARG(isolate, args[1]->IsArray(), "second argument to zone.executeGraph must be an array of [from, to] node indices");
+    CHECK_ARG(isolate, args[2]->IsFunction(), "third argument to zone.executeGraph must be the callback");
+
+    auto specsArray = v8::Local<v8::Array>::Cast(args[0]);
+    auto edgesArray = v8::Local<v8::Array>::Cast(args[1]);
+
+    std::vector<napa::zone::TaskGraph::Edge> edges;
+    edges.reserve(edgesArray->Length());
+    for (uint32_t i = 0; i < edgesArray->Length(); i++) {
+        auto edgeValue = edgesArray->Get(i);
+        CHECK_ARG(isolate, edgeValue->IsArray() && v8::Local<v8::Array>::Cast(edgeValue)->Length() == 2,
+            "elements of zone.executeGraph's second argument must be [from, to] pairs");
+
+        auto edge = v8::Local<v8::Array>::Cast(edgeValue);
+        auto from = edge->Get(0);
+        auto to = edge->Get(1);
+        CHECK_ARG(isolate, from->IsUint32() && to->IsUint32(), "node indices of zone.executeGraph's edges must be non-negative integers");
+        edges.emplace_back(from->Uint32Value(), to->Uint32Value());
+    }
+
+    std::string error;
+    JS_ENSURE(isolate, napa::zone::TaskGraph::Validate(specsArray->Length(), edges, error), "%s", error.c_str());
+
+    auto wrap = ObjectWrap::Unwrap<ZoneWrap>(args.Holder());
+    auto state = std::make_shared<GraphState>(specsArray->Length());
+    std::vector<bool> binaries(specsArray->Length());
+    for (uint32_t i = 0; i < specsArray->Length(); i++) {
+        auto specValue = specsArray->Get(i);
+        CHECK_ARG(isolate, specValue->IsObject(), "elements of zone.executeGraph's first argument must be function spec objects");
+
+        if (!CreateRequest(specValue->ToObject(), state->holders[i])) {
+            return;
+        }
+        binaries[i] = state->holders[i].spec.options.transport == napa::TransportOption::BINARY;
+    }
+
+    // A proxy of its own keeps the zone alive until the graph completes.
+    try {
+        state->zone = napa::Zone::Get(wrap->_zoneProxy->GetId());
+    } catch (const std::exception& ex) {
+        JS_FAIL(isolate, "%s", ex.what());
+    }
+
+    napa::zone::DoAsyncWork(v8::Local<v8::Function>::Cast(args[2]),
+        [&state, &edges](std::function<void(void*)> complete) {
+            // The graph keeps the state, and calls in flight keep the graph, until the graph completes.
+            auto graph = std::make_shared<napa::zone::TaskGraph>(
+                static_cast<uint32_t>(state->holders.size()),
+                edges,
+                [state = std::move(state)](uint32_t node, const napa::zone::TaskGraph::Inputs& inputs, napa::ExecuteCallback callback) {
+                    ExecuteGraphNode(*state, node, inputs, std::move(callback));
+                },
+                [complete = std::move(complete)](std::vector<napa::Result> results, uint32_t failedNode) {
+                    complete(new std::pair<std::vector<napa::Result>, uint32_t>(std::move(results), failedNode));
+                });
+            graph->Run();
+        },
+        [binaries = std::move(binaries)](auto jsCallback, void* res) {
+            auto isolate = v8::Isolate::GetCurrent();
+            auto context = isolate->GetCurrentContext();
+
+            auto outcome = static_cast<std::pair<std::vector<napa::Result>, uint32_t>*>(res);
+            auto& results = outcome->first;
+
+            v8::HandleScope scope(isolate);
+
+            auto responses = v8::Array::New(isolate, static_cast<int>(results.size()));
+            for (uint32_t i = 0; i < results.size(); i++) {
+                (void)responses->CreateDataProperty(context, i, CreateResponseObject(results[i], binaries[i]));
+            }
+
+            std::vector<v8::Local<v8::Value>> argv;
+            argv.emplace_back(responses);
+            argv.emplace_back(outcome->second == napa::zone::TaskGraph::NO_FAILURE ?
+                v8::Local<v8::Value>(v8::Integer::New(isolate, -1)) :
+                v8::Local<v8::Value>(v8::Integer::NewFromUnsigned(isolate, outcome->second)));
+
+            (void)jsCallback->Call(context, context->Global(), static_cast<int>(argv.size()), argv.data());
+
+            delete outcome;
+        }
+    );
+}
+
+/// <summary> Schedules a node of a graph from the worker that readied it, i.e. that ran the last node it depends on. </summary>
+/// <param name="inputs"> Results of the nodes it depends on, passed as the first arguments in order of edges. </param>
+static void ExecuteGraphNode(GraphState& state, uint32_t node, const napa::zone::TaskGraph::Inputs& inputs, napa::ExecuteCallback callback) {
+    auto& spec = state.holders[node].spec;
+
+    napa::FunctionSpec next;
+    next.module = spec.module;
+    next.function = spec.function;
+    next.options = spec.options;
+    next.transportContext = std::move(spec.transportContext);
+
+    // Payloads of inputs are copied by the scheduled call, the shared objects they refer to are shared with it,
+    // as an input may go to several nodes.
+    next.arguments.reserve(inputs.size() + spec.arguments.size());
+    for (auto input : inputs) {
+        next.arguments.emplace_back(STD_STRING_TO_NAPA_STRING_REF(input->returnValue));
+        if (input->transportContext != nullptr && input->transportContext->GetSharedCount() > 0) {
+            if (next.transportContext == nullptr) {
+                next.transportContext = std::make_unique<napa::transport::TransportContext>();
+            }
+            next.transportContext->SaveAll(*input->transportContext);
+        }
+    }
+    next.arguments.insert(next.arguments.end(), spec.arguments.begin(), spec.arguments.end());
+
+    state.zone->Execute(next, std::move(callback));
+}
+
+/// <summary> Schedules a stage of a pipeline, whose result is forwarded to the next one from the worker that ran it. </summary>
+/// <param name="previous"> Result of the previous stage, passed as the first argument of stages after the first. </param>
+static void ExecuteStage(std::shared_ptr<PipelineState> state, size_t stage, napa::Result previous) {
+    auto& spec = state->holders[stage].spec;
+
+    napa::FunctionSpec next;
+    next.module = spec.module;
+    next.function = spec.function;
+    next.options = spec.options;
+    next.transportContext = std::move(spec.transportContext);
+    if (stage == 0) {
+        next.arguments = spec.arguments;
+    } else {
+        // The previous payload is copied by the scheduled call, the shared objects it refers to move along with it.
+        // A stage taking only the previous payload borrows it instead, which is kept alive by the call.
+        if (spec.arguments.empty()) {
+            auto payload = std::make_shared<std::string>(std::move(previous.returnValue));
+            next.arguments.emplace_back(STD_STRING_TO_NAPA_STRING_REF(*payload));
+            next.argumentsOwner = std::move(payload);
+        } else {
+            next.arguments.reserve(spec.arguments.size() + 1);
+            next.arguments.emplace_back(STD_STRING_TO_NAPA_STRING_REF(previous.returnValue));
+            next.arguments.insert(next.arguments.end(), spec.arguments.begin(), spec.arguments.end());
+        }
+        if (previous.transportContext != nullptr) {
+            if (next.transportContext == nullptr || next.transportContext->GetSharedCount() == 0) {
+                next.transportContext = std::move(previous.transportContext);
+            } else {
+                next.transportContext->SaveAll(*previous.transportContext);
+            }
+        }
+    }
+
+    state->zones[stage]->Execute(next, [state, stage](napa::Result result) {
+        state->cpuTime += result.cpuTime;
+        state->allocatedBytes += result.allocatedBytes;
+        if (result.code != NAPA_RESULT_SUCCESS || stage + 1 == state->holders.size()) {
+            result.cpuTime = state->cpuTime;
+            result.allocatedBytes = state->allocatedBytes;
+            state->complete(new napa::Result(std::move(result)));
+            return;
+        }
+        ExecuteStage(state, stage + 1, std::move(result));
     });
 }
 
-static v8::Local<v8::Object> CreateResponseObject(const napa::Result& result) {
+/// <remarks>
+///     Responses are instantiated with all their properties, so they share a map and setting a property doesn't
+///     transition the map, which matters at high call rates. The return value is moved out of the result.
+/// </remarks>
+static v8::Local<v8::Object> CreateResponseObject(napa::Result& result, bool binary) {
     auto isolate = v8::Isolate::GetCurrent();
     auto context = isolate->GetCurrentContext();
 
-    auto responseObject = v8::Object::New(isolate);
+    auto constructor = NAPA_GET_PERSISTENT_CONSTRUCTOR(ZoneResponse::exportName, ZoneResponse);
+    auto responseObject = constructor->NewInstance(context).ToLocalChecked();
+    auto set = [&](ZoneResponse::Property property, v8::Local<v8::Value> value) {
+        (void)responseObject->Set(context, ZoneResponse::GetName(isolate, property), value);
+    };
 
-    (void)responseObject->CreateDataProperty(
-        context,
-        MakeV8String(isolate, "code"),
-        v8::Uint32::NewFromUnsigned(isolate, result.code));
+    set(ZoneResponse::CODE, v8::Uint32::NewFromUnsigned(isolate, result.code));
+    set(ZoneResponse::ERROR_MESSAGE,
+        result.errorMessage.empty() ? v8::String::Empty(isolate) : MakeV8String(isolate, result.errorMessage));
 
-    (void)responseObject->CreateDataProperty(
-        context,
-        MakeV8String(isolate, "errorMessage"),
-        MakeV8String(isolate, result.errorMessage));
+    // A failed call carries its error message in place of a binary payload.
+    v8::Local<v8::Value> returnValue;
+    if (binary && result.code == NAPA_RESULT_SUCCESS) {
+        returnValue = binary_transport::NewPayloadBuffer(result.returnValue.data(), result.returnValue.size());
+    } else {
+        // Large payloads back the string as they are, the result isn't used after.
+        returnValue = MakeOwnedV8String(isolate, std::move(result.returnValue));
+    }
+    set(ZoneResponse::RETURN_VALUE, returnValue);
 
-    (void)responseObject->CreateDataProperty(
-        context,
-        MakeV8String(isolate, "returnValue"),
-        MakeV8String(isolate, result.returnValue));
+    // The wrap owns the transport context, an empty one if the result has no shared objects.
+    set(ZoneResponse::TRANSPORT_CONTEXT, TransportContextWrapImpl::NewInstance(true, result.transportContext.release()));
 
-    // Transport context handle
-    (void)responseObject->CreateDataProperty(
-        context,
-        MakeV8String(isolate, "contextHandle"),
-        PtrToV8Uint32Array(isolate, result.transportContext.release()));
+    set(ZoneResponse::CPU_TIME, v8::Number::New(isolate, static_cast<double>(result.cpuTime)));
+    set(ZoneResponse::ALLOCATED_BYTES, v8::Number::New(isolate, static_cast<double>(result.allocatedBytes)));
 
     return responseObject;
 }
 
-template <typename Func>
-static void CreateRequestAndExecute(v8::Local<v8::Object> obj, Func&& func) {
+static bool CreateRequest(v8::Local<v8::Object> obj, FunctionSpecHolder& holder) {
     auto isolate = v8::Isolate::GetCurrent();
     auto context = isolate->GetCurrentContext();
 
-    napa::FunctionSpec spec;
+    auto& spec = holder.spec;
     
     // module property is optional in a spec
-    Utf8String module;
     auto maybe = obj->Get(context, MakeV8String(isolate, "module"));
     if (!maybe.IsEmpty()) {
-        module = Utf8String(maybe.ToLocalChecked());
-        spec.module = NAPA_STRING_REF_WITH_SIZE(module.Data(), module.Length());
+        holder.module = Utf8String(maybe.ToLocalChecked());
+        spec.module = NAPA_STRING_REF_WITH_SIZE(holder.module.Data(), holder.module.Length());
     }
 
     // function property is mandatory in a spec
     maybe = obj->Get(context, MakeV8String(isolate, "function"));
-    CHECK_ARG(isolate, !maybe.IsEmpty(), "function property is missing in function spec object");
+    CHECK_ARG_WITH_RETURN(isolate, !maybe.IsEmpty(), false, "function property is missing in function spec object");
 
     auto functionValue = maybe.ToLocalChecked();
-    CHECK_ARG(isolate, functionValue->IsString(), "function property in function spec object must be a string");
+    CHECK_ARG_WITH_RETURN(isolate, functionValue->IsString(), false, "function property in function spec object must be a string");
 
-    v8::String::Utf8Value function(functionValue->ToString());
-    spec.function = NAPA_STRING_REF_WITH_SIZE(*function, static_cast<size_t>(function.length()));
+    holder.function = Utf8String(functionValue);
+    spec.function = NAPA_STRING_REF_WITH_SIZE(holder.function.Data(), holder.function.Length());
 
     // arguments are optional in a spec
     maybe = obj->Get(context, MakeV8String(isolate, "arguments"));
-    std::vector<Utf8String> arguments;
     if (!maybe.IsEmpty()) {
-        arguments = V8ArrayToVector<Utf8String>(isolate, v8::Local<v8::Array>::Cast(maybe.ToLocalChecked()));
+        auto argumentsArray = v8::Local<v8::Array>::Cast(maybe.ToLocalChecked());
+        auto length = argumentsArray->Length();
 
-        spec.arguments.reserve(arguments.size());
-        for (const auto& arg : arguments) {
-            spec.arguments.emplace_back(NAPA_STRING_REF_WITH_SIZE(arg.Data(), arg.Length()));
+        // Reserved upfront, so the references taken by the spec stay valid.
+        holder.arguments.reserve(length);
+        holder.binaryArguments.reserve(length);
+        spec.arguments.reserve(length);
+        for (uint32_t i = 0; i < length; ++i) {
+            auto arg = argumentsArray->Get(context, i).ToLocalChecked();
+            if (arg->IsArrayBuffer() || arg->IsArrayBufferView()) {
+                holder.binaryArguments.emplace_back();
+                auto& payload = holder.binaryArguments.back();
+                binary_transport::CopyPayload(arg, payload);
+                spec.arguments.emplace_back(NAPA_STRING_REF_WITH_SIZE(payload.data(), payload.size()));
+            } else {
+                holder.arguments.emplace_back(arg);
+                auto& payload = holder.arguments.back();
+                spec.arguments.emplace_back(NAPA_STRING_REF_WITH_SIZE(payload.Data(), payload.Length()));
+            }
         }
     }
 
@@ -223,7 +1139,7 @@ static void CreateRequestAndExecute(v8::Local<v8::Object> obj, Func&& func) {
     maybe = obj->Get(context, MakeV8String(isolate, "options"));
     if (!maybe.IsEmpty()) {
         auto optionsValue = maybe.ToLocalChecked();
-        JS_ENSURE(isolate, optionsValue->IsObject(), "argument 'options' must be an object.");
+        JS_ENSURE_WITH_RETURN(isolate, optionsValue->IsObject(), false, "argument 'options' must be an object.");
         auto options = v8::Local<v8::Object>::Cast(optionsValue);
 
         // timeout is optional.
@@ -232,20 +1148,105 @@ static void CreateRequestAndExecute(v8::Local<v8::Object> obj, Func&& func) {
             spec.options.timeout = maybe.ToLocalChecked()->Uint32Value(context).FromJust();
         }
 
+        // cpuTimeout is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "cpuTimeout"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            JS_ENSURE_WITH_RETURN(isolate, maybe.ToLocalChecked()->IsUint32(), false, "option 'cpuTimeout' must be a non-negative integer.");
+            spec.options.cpu_timeout = maybe.ToLocalChecked()->Uint32Value(context).FromJust();
+        }
+
+        // hedgeAfterMs is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "hedgeAfterMs"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            JS_ENSURE_WITH_RETURN(isolate, maybe.ToLocalChecked()->IsUint32(), false, "option 'hedgeAfterMs' must be a non-negative integer.");
+            spec.options.hedge_after = maybe.ToLocalChecked()->Uint32Value(context).FromJust();
+        }
+
+        // coalesce is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "coalesce"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            JS_ENSURE_WITH_RETURN(isolate, maybe.ToLocalChecked()->IsBoolean(), false, "option 'coalesce' must be a boolean.");
+            spec.options.coalesce = maybe.ToLocalChecked()->IsTrue() ? 1 : 0;
+        }
+
         // transport option is optional.
         maybe = options->Get(context, MakeV8String(isolate, "transport"));
         if (!maybe.IsEmpty()) {
             spec.options.transport = static_cast<napa::TransportOption>(maybe.ToLocalChecked()->Uint32Value(context).FromJust());
         }
+
+        // priority is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "priority"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            auto priority = maybe.ToLocalChecked()->Uint32Value(context).FromJust();
+            JS_ENSURE_WITH_RETURN(isolate, priority <= napa::CallPriority::BACKGROUND, false, "option 'priority' is out of range.");
+            spec.options.priority = static_cast<napa::CallPriority>(priority);
+        }
+
+        // affinityKey is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "affinityKey"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            JS_ENSURE_WITH_RETURN(isolate, maybe.ToLocalChecked()->IsString(), false, "option 'affinityKey' must be a string.");
+            holder.affinityKey = Utf8String(maybe.ToLocalChecked());
+            spec.options.affinity_key = NAPA_STRING_REF_WITH_SIZE(holder.affinityKey.Data(), holder.affinityKey.Length());
+        }
+
+        // workerClass is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "workerClass"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            JS_ENSURE_WITH_RETURN(isolate, maybe.ToLocalChecked()->IsString(), false, "option 'workerClass' must be a string.");
+            holder.workerClass = Utf8String(maybe.ToLocalChecked());
+            spec.options.worker_class = NAPA_STRING_REF_WITH_SIZE(holder.workerClass.Data(), holder.workerClass.Length());
+        }
+
+        // tenant is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "tenant"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            JS_ENSURE_WITH_RETURN(isolate, maybe.ToLocalChecked()->IsString(), false, "option 'tenant' must be a string.");
+            holder.tenant = Utf8String(maybe.ToLocalChecked());
+            spec.options.tenant = NAPA_STRING_REF_WITH_SIZE(holder.tenant.Data(), holder.tenant.Length());
+        }
+
+        // traceId is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "traceId"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            JS_ENSURE_WITH_RETURN(isolate, maybe.ToLocalChecked()->IsString(), false, "option 'traceId' must be a string.");
+            holder.traceId = Utf8String(maybe.ToLocalChecked());
+            spec.options.trace_id = NAPA_STRING_REF_WITH_SIZE(holder.traceId.Data(), holder.traceId.Length());
+        }
+
+        // cancellationToken is optional.
+        maybe = options->Get(context, MakeV8String(isolate, "cancellationToken"));
+        if (!maybe.IsEmpty() && !maybe.ToLocalChecked()->IsUndefined()) {
+            auto tokenValue = maybe.ToLocalChecked();
+            auto constructor = NAPA_GET_PERSISTENT_CONSTRUCTOR(CancellationTokenWrap::exportName, CancellationTokenWrap);
+            JS_ENSURE_WITH_RETURN(isolate, tokenValue->IsObject() && tokenValue->InstanceOf(context, constructor).FromMaybe(false),
+                false, "option 'cancellationToken' must be created by zone.createCancellationToken.");
+            holder.cancellationToken = NAPA_OBJECTWRAP::Unwrap<CancellationTokenWrap>(v8::Local<v8::Object>::Cast(tokenValue))
+                ->Get<napa::zone::CancellationToken>();
+            spec.options.cancellation_token = holder.cancellationToken.get();
+        }
     }
 
     // transportContext property is mandatory in a spec
     maybe = obj->Get(context, MakeV8String(isolate, "transportContext"));
-    CHECK_ARG(isolate, !maybe.IsEmpty(), "transportContext property is missing in function spec object");
+    CHECK_ARG_WITH_RETURN(isolate, !maybe.IsEmpty(), false, "transportContext property is missing in function spec object");
 
     auto transportContextWrap = NAPA_OBJECTWRAP::Unwrap<TransportContextWrapImpl>(maybe.ToLocalChecked()->ToObject());
     spec.transportContext.reset(transportContextWrap->Get());
 
-    // Execute
-    func(spec);
+    return true;
+}
+
+static std::chrono::milliseconds GetWaitTimeout(const v8::FunctionCallbackInfo<v8::Value>& args, int index) {
+    // The wait timeout is optional, 0 to wait without bound.
+    if (args.Length() <= index || args[index]->IsUndefined()) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::milliseconds(args[index]->Uint32Value(args.GetIsolate()->GetCurrentContext()).FromJust());
+}
+
+static v8::Local<v8::Value> MakeWaitTime(v8::Isolate* isolate, std::chrono::nanoseconds waitTime) {
+    // Milliseconds, as timeouts are.
+    return v8::Number::New(isolate, std::chrono::duration<double, std::milli>(waitTime).count());
 }
@@ -28,6 +28,9 @@ namespace module {
         /// <summary> Create a new ZoneWrap instance that wraps the provided proxy. </summary>
         static v8::Local<v8::Object> NewInstance(std::unique_ptr<napa::Zone> zoneProxy);
 
+        /// <summary> Gets the proxy wrapped by a value, or nullptr if it isn't a ZoneWrap. </summary>
+        static const napa::Zone* GetZoneProxy(v8::Local<v8::Value> value);
+
     private:
 
         /// <summary> Declare persistent constructor to create Zone Javascript wrapper instance. </summary>
@@ -39,8 +42,25 @@ namespace module {
         static void GetId(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void Broadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void BroadcastSync(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void Resize(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void Drain(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void Execute(const v8::FunctionCallbackInfo<v8::Value>& args);
         static void ExecuteSync(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void ExecuteBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void ExecutePipeline(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void ExecuteGraph(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void GetPressure(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void GetWorkers(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void GetMemoryUsage(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void StartProfiling(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void StopProfiling(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void StartAllocationProfiling(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void StopAllocationProfiling(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void GetHeapStatistics(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void WriteHeapSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void GetSlowCalls(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void GetFunctionStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void Serve(const v8::FunctionCallbackInfo<v8::Value>& args);
 
         /// <summary> Friend default constructor callback. </summary>
         template <typename WrapType>
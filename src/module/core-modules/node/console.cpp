@@ -4,8 +4,8 @@
 #include "console.h"
 
 #include <napa/module.h>
+#include <providers/console-sink.h>
 
-#include <iostream>
 #include <sstream>
 
 using namespace napa;
@@ -40,7 +40,8 @@ namespace {
             message.pop_back();
         }
 
-        std::cout << message << std::endl;
+        // Written by the console sink, so workers don't wait on the standard output of each other.
+        providers::ConsoleSink::GetInstance().WriteLine(message.data(), message.size());
 
         args.GetReturnValue().Set(args.Holder());
     }
@@ -7,8 +7,13 @@
 
 #include "file-system-helpers.h"
 #include <platform/filesystem.h>
+#include <platform/platform.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
 #include <memory>
 #include <sstream>
@@ -24,39 +29,79 @@ namespace {
 
 }   // End of anonymous namespace.
 
-std::string file_system_helpers::ReadFileSync(const std::string& filename) {
-    std::string fileFullPath = GetFileFullPath(filename);
+namespace {
 
-    FILE* source = fopen(fileFullPath.c_str(), "rb");
-    if (source == nullptr) {
-        std::ostringstream oss;
-        oss << "Can't open for read " << fileFullPath;
-        throw std::runtime_error(oss.str());
-    }
+    /// <summary> Reads a whole file into memory given by 'allocate', which is called with the file size. </summary>
+    template <typename Allocate>
+    void ReadFile(const std::string& filename, Allocate allocate) {
+        std::string fileFullPath = GetFileFullPath(filename);
 
-    std::unique_ptr<FILE, std::function<void(FILE*)>> deferred(source, [](auto file) {
-        fclose(file);
-    });
+        FILE* source = fopen(fileFullPath.c_str(), "rb");
+        if (source == nullptr) {
+            std::ostringstream oss;
+            oss << "Can't open for read " << fileFullPath;
+            throw std::runtime_error(oss.str());
+        }
 
-    fseek(source, 0, SEEK_END);
-    auto size = static_cast<size_t>(ftell(source));
-    rewind(source);
+        std::unique_ptr<FILE, std::function<void(FILE*)>> deferred(source, [](auto file) {
+            fclose(file);
+        });
 
-    std::string content;
-    content.resize(size);
+        fseek(source, 0, SEEK_END);
+        auto size = static_cast<size_t>(ftell(source));
+        rewind(source);
 
-    for (size_t i = 0; i < size; ) {
-        i += fread(&content[i], 1, size - i, source);
-        if (ferror(source) != 0) {
-            std::ostringstream oss;
-            oss << "Can't read " << fileFullPath;
-            throw std::runtime_error(oss.str());
+        char* data = allocate(size);
+
+        for (size_t i = 0; i < size; ) {
+            i += fread(data + i, 1, size - i, source);
+            if (ferror(source) != 0) {
+                std::ostringstream oss;
+                oss << "Can't read " << fileFullPath;
+                throw std::runtime_error(oss.str());
+            }
         }
     }
 
+}   // End of anonymous namespace.
+
+std::string file_system_helpers::ReadFileSync(const std::string& filename) {
+    std::string content;
+    ReadFile(filename, [&content](size_t size) {
+        content.resize(size);
+        return &content[0];
+    });
+
     return content;
 }
 
+void* file_system_helpers::ReadFileToMemorySync(const std::string& filename, size_t& size) {
+    std::unique_ptr<char, void (*)(void*)> memory(nullptr, std::free);
+    ReadFile(filename, [&memory, &size](size_t fileSize) {
+        size = fileSize;
+        memory.reset(static_cast<char*>(fileSize > 0 ? std::malloc(fileSize) : nullptr));
+        if (fileSize > 0 && memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        return memory.get();
+    });
+
+    return memory.release();
+}
+
+std::unique_ptr<platform::MappedFile> file_system_helpers::MapFileSync(const std::string& filename) {
+    if (StatSync(filename).size == 0) {
+        return nullptr;
+    }
+
+    auto fileFullPath = GetFileFullPath(filename);
+    auto file = platform::MappedFile::Open(fileFullPath, true);
+    if (file == nullptr) {
+        throw std::runtime_error("Can't map " + fileFullPath);
+    }
+    return file;
+}
+
 void file_system_helpers::WriteFileSync(const std::string& filename, const char* data, size_t length) {
     auto fileFullPath = GetFileFullPath(filename);
     
@@ -102,4 +147,40 @@ std::vector<std::string> file_system_helpers::ReadDirectorySync(const std::strin
         names.emplace_back(iterator->Filename().String());
     }
     return names;
-}
\ No newline at end of file
+}
+
+file_system_helpers::FileStat file_system_helpers::StatSync(const std::string& path) {
+    auto fullPath = GetFileFullPath(path);
+    FileStat stat;
+
+#ifdef SUPPORT_POSIX
+    struct stat st;
+    if (::stat(fullPath.c_str(), &st) != 0) {
+        throw std::runtime_error("Can't stat " + fullPath);
+    }
+    stat.isFile = S_ISREG(st.st_mode);
+    stat.isDirectory = S_ISDIR(st.st_mode);
+#else
+    struct _stat64 st;
+    if (::_stat64(fullPath.c_str(), &st) != 0) {
+        throw std::runtime_error("Can't stat " + fullPath);
+    }
+    stat.isFile = (st.st_mode & _S_IFMT) == _S_IFREG;
+    stat.isDirectory = (st.st_mode & _S_IFMT) == _S_IFDIR;
+#endif
+
+    stat.size = static_cast<uint64_t>(st.st_size);
+    stat.mode = static_cast<uint32_t>(st.st_mode);
+    stat.atimeMs = static_cast<double>(st.st_atime) * 1000;
+    stat.mtimeMs = static_cast<double>(st.st_mtime) * 1000;
+    stat.ctimeMs = static_cast<double>(st.st_ctime) * 1000;
+
+    // Like node.js, the modification time keeps sub-second precision, so a rewrite within a second tells a file changed.
+#if defined(OS_LINUX)
+    stat.mtimeMs += static_cast<double>(st.st_mtim.tv_nsec) / 1e6;
+#elif defined(OS_MAC)
+    stat.mtimeMs += static_cast<double>(st.st_mtimespec.tv_nsec) / 1e6;
+#endif
+
+    return stat;
+}
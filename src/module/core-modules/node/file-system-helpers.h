@@ -3,6 +3,10 @@
 
 #pragma once
 
+#include <platform/mapped-file.h>
+
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,10 +16,41 @@ namespace module {
 /// <summary> Helper APIs for file system operations. </summary>
 namespace file_system_helpers {
 
+    /// <summary> Status of a file or directory. </summary>
+    struct FileStat {
+        /// <summary> Size in bytes. </summary>
+        uint64_t size = 0;
+
+        /// <summary> File type and permission bits. </summary>
+        uint32_t mode = 0;
+
+        /// <summary> Whether it's a regular file. </summary>
+        bool isFile = false;
+
+        /// <summary> Whether it's a directory. </summary>
+        bool isDirectory = false;
+
+        /// <summary> Times of last access, modification, and status change, in milliseconds since the epoch. </summary>
+        double atimeMs = 0;
+        double mtimeMs = 0;
+        double ctimeMs = 0;
+    };
+
     /// <summary> Read file synchronously. </summary>
     /// <param name="filename"> Filename to read. </param>
     std::string ReadFileSync(const std::string& filename);
 
+    /// <summary> Read file synchronously into memory from std::malloc, which the caller frees with std::free. </summary>
+    /// <param name="filename"> Filename to read. </param>
+    /// <param name="size"> Receives the size of the file. </param>
+    /// <returns> The contents, nullptr for an empty file. </returns>
+    void* ReadFileToMemorySync(const std::string& filename, size_t& size);
+
+    /// <summary> Map a file into memory synchronously, as copy-on-write. </summary>
+    /// <param name="filename"> Filename to map. </param>
+    /// <returns> The mapped file, nullptr for an empty file. </returns>
+    std::unique_ptr<platform::MappedFile> MapFileSync(const std::string& filename);
+
     /// <summary> Write file synchronously. </summary>
     /// <param name="filename"> Filename to write. </param>
     /// <param name="data"> Buffer of data to write. </param>
@@ -36,6 +71,11 @@ namespace file_system_helpers {
     /// <returns> File and directory names except '.' and '..'. </returns>
     std::vector<std::string> ReadDirectorySync(const std::string& directory);
 
+    /// <summary> Get the status of a path synchronously, following symbolic links. </summary>
+    /// <param name="path"> Path to get the status of. </param>
+    /// <returns> The status, it throws if the path doesn't exist. </returns>
+    FileStat StatSync(const std::string& path);
+
 }   // End of namespace file_system_helpers
 }   // End of namespace module
 }   // End of namespace napa
@@ -5,6 +5,12 @@
 #include "file-system-helpers.h"
 
 #include <napa/module.h>
+#include <napa/async.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
 
 using namespace napa;
 using namespace napa::module;
@@ -12,7 +18,7 @@ using namespace napa::module;
 namespace {
 
     /// <summary> Read file synchronously. </summary>
-    /// <param name="args"> It holds filename. </param>
+    /// <param name="args"> It holds filename, and optionally options of the read mode. </param>
     void ReadFileSyncCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
 
     /// <summary> Write file synchronously. </summary>
@@ -31,6 +37,32 @@ namespace {
     /// <param name="args"> A string argument of path. </param>
     void ReaddirSyncCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+    /// <summary> Get the status of a path synchronously. </summary>
+    /// <param name="args"> A string argument of path. </param>
+    void StatSyncCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Read file asynchronously. </summary>
+    /// <param name="args"> It holds filename, optionally options of the read mode, and the callback last, called with an error or the content. </param>
+    void ReadFileCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Write file asynchronously. </summary>
+    /// <param name="args"> It holds filename, string to write, and the callback last, called with an error if any. </param>
+    void WriteFileCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Get the status of a path asynchronously. </summary>
+    /// <param name="args"> It holds the path, and the callback last, called with an error or the status. </param>
+    void StatCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Read a directory asynchronously. </summary>
+    /// <param name="args"> It holds the path, and the callback last, called with an error or the names. </param>
+    void ReaddirCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Promise returning variants of the asynchronous functions, exported as 'fs.promises'. </summary>
+    void ReadFilePromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+    void WriteFilePromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+    void StatPromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+    void ReaddirPromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
 }   // End of anonymous namespace.
 
 void file_system::Init(v8::Local<v8::Object> exports) {
@@ -39,10 +71,168 @@ void file_system::Init(v8::Local<v8::Object> exports) {
     NAPA_SET_METHOD(exports, "mkdirSync", MkdirSyncCallback);
     NAPA_SET_METHOD(exports, "existsSync", ExistsSyncCallback);
     NAPA_SET_METHOD(exports, "readdirSync", ReaddirSyncCallback);
+    NAPA_SET_METHOD(exports, "statSync", StatSyncCallback);
+
+    NAPA_SET_METHOD(exports, "readFile", ReadFileCallback);
+    NAPA_SET_METHOD(exports, "writeFile", WriteFileCallback);
+    NAPA_SET_METHOD(exports, "stat", StatCallback);
+    NAPA_SET_METHOD(exports, "readdir", ReaddirCallback);
+
+    auto isolate = v8::Isolate::GetCurrent();
+    auto promises = v8::Object::New(isolate);
+    NAPA_SET_METHOD(promises, "readFile", ReadFilePromiseCallback);
+    NAPA_SET_METHOD(promises, "writeFile", WriteFilePromiseCallback);
+    NAPA_SET_METHOD(promises, "stat", StatPromiseCallback);
+    NAPA_SET_METHOD(promises, "readdir", ReaddirPromiseCallback);
+    exports->CreateDataProperty(isolate->GetCurrentContext(), v8_helpers::MakeV8String(isolate, "promises"), promises).FromJust();
 }
 
 namespace {
 
+    /// <summary> Returns the data of the function, used for methods of stats objects. </summary>
+    void ReturnDataCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        args.GetReturnValue().Set(args.Data());
+    }
+
+    /// <summary> Makes a node.js like stats object, with the 'isFile' and 'isDirectory' methods. </summary>
+    v8::Local<v8::Value> MakeStats(v8::Isolate* isolate, const file_system_helpers::FileStat& stat) {
+        auto context = isolate->GetCurrentContext();
+        auto stats = v8::Object::New(isolate);
+
+        auto set = [&](const char* name, v8::Local<v8::Value> value) {
+            stats->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, name), value).FromJust();
+        };
+        set("size", v8::Number::New(isolate, static_cast<double>(stat.size)));
+        set("mode", v8::Integer::NewFromUnsigned(isolate, stat.mode));
+        set("atimeMs", v8::Number::New(isolate, stat.atimeMs));
+        set("mtimeMs", v8::Number::New(isolate, stat.mtimeMs));
+        set("ctimeMs", v8::Number::New(isolate, stat.ctimeMs));
+        set("atime", v8::Date::New(context, stat.atimeMs).ToLocalChecked());
+        set("mtime", v8::Date::New(context, stat.mtimeMs).ToLocalChecked());
+        set("ctime", v8::Date::New(context, stat.ctimeMs).ToLocalChecked());
+        set("isFile", v8::Function::New(context, ReturnDataCallback, v8::Boolean::New(isolate, stat.isFile)).ToLocalChecked());
+        set("isDirectory", v8::Function::New(context, ReturnDataCallback, v8::Boolean::New(isolate, stat.isDirectory)).ToLocalChecked());
+
+        return stats;
+    }
+
+    /// <summary> Makes an array of names of a directory. </summary>
+    v8::Local<v8::Value> MakeNames(v8::Isolate* isolate, const std::vector<std::string>& names) {
+        auto context = isolate->GetCurrentContext();
+        auto count = static_cast<uint32_t>(names.size());
+        auto result = v8::Array::New(isolate, count);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            result->CreateDataProperty(context, i, v8_helpers::MakeV8String(isolate, names[i])).FromJust();
+        }
+        return result;
+    }
+
+    /// <summary> How the contents of a file are returned, chosen by the options of fs.readFileSync and fs.readFile. </summary>
+    enum class ReadMode {
+        /// <summary> A string, by default. </summary>
+        STRING,
+
+        /// <summary> An ArrayBuffer the file is read into, with options { arrayBuffer: true }. </summary>
+        ARRAY_BUFFER,
+
+        /// <summary> An ArrayBuffer over a copy-on-write mapping of the file, with options { map: true }. </summary>
+        MAPPED
+    };
+
+    /// <summary> Gets the read mode from an options argument, which is ignored unless it's an object. </summary>
+    ReadMode GetReadMode(v8::Isolate* isolate, v8::Local<v8::Value> options) {
+        if (!options->IsObject() || options->IsFunction()) {
+            return ReadMode::STRING;
+        }
+
+        auto context = isolate->GetCurrentContext();
+        auto object = options.As<v8::Object>();
+        auto isSet = [&](const char* name) {
+            v8::Local<v8::Value> value;
+            return object->Get(context, v8_helpers::MakeV8String(isolate, name)).ToLocal(&value) && value->BooleanValue();
+        };
+
+        if (isSet("map")) {
+            return ReadMode::MAPPED;
+        }
+        return isSet("arrayBuffer") ? ReadMode::ARRAY_BUFFER : ReadMode::STRING;
+    }
+
+    struct FreeDeleter {
+        void operator()(void* memory) const {
+            std::free(memory);
+        }
+    };
+
+    /// <summary> Contents of a file, read in one of the read modes. </summary>
+    struct FileContent {
+        ReadMode mode = ReadMode::STRING;
+        std::string text;
+        std::unique_ptr<void, FreeDeleter> memory;
+        size_t size = 0;
+        std::unique_ptr<platform::MappedFile> mapped;
+    };
+
+    /// <summary> Reads a file in a read mode, without touching V8, so it can run on any thread. </summary>
+    FileContent ReadFileContent(const std::string& filename, ReadMode mode) {
+        FileContent content;
+        content.mode = mode;
+
+        switch (mode) {
+            case ReadMode::STRING:
+                content.text = file_system_helpers::ReadFileSync(filename);
+                break;
+            case ReadMode::ARRAY_BUFFER:
+                content.memory.reset(file_system_helpers::ReadFileToMemorySync(filename, content.size));
+                break;
+            case ReadMode::MAPPED:
+                content.mapped = file_system_helpers::MapFileSync(filename);
+                break;
+        }
+        return content;
+    }
+
+    /// <summary> Keeps a mapped file alive as long as an ArrayBuffer over it. </summary>
+    struct MappedFileHolder {
+        std::unique_ptr<platform::MappedFile> file;
+        v8::Persistent<v8::ArrayBuffer> handle;
+    };
+
+    void OnMappedBufferCollected(const v8::WeakCallbackInfo<MappedFileHolder>& info) {
+        auto holder = info.GetParameter();
+        holder->handle.Reset();
+        delete holder;
+    }
+
+    /// <summary> Makes the Javascript value of file contents, handing memory and mappings over to it. </summary>
+    v8::Local<v8::Value> MakeContent(v8::Isolate* isolate, FileContent& content) {
+        switch (content.mode) {
+            case ReadMode::ARRAY_BUFFER:
+                // V8 takes the memory over and frees it with the buffer, which is how transported ArrayBuffers are loaded too.
+                return content.memory == nullptr
+                    ? v8::ArrayBuffer::New(isolate, 0)
+                    : v8::ArrayBuffer::New(isolate, content.memory.release(), content.size, v8::ArrayBufferCreationMode::kInternalized);
+
+            case ReadMode::MAPPED: {
+                if (content.mapped == nullptr) {
+                    return v8::ArrayBuffer::New(isolate, 0);
+                }
+
+                // The mapping is external memory, unmapped once the buffer is collected. Pages are read as they are touched.
+                auto buffer = v8::ArrayBuffer::New(isolate, content.mapped->GetMutableData(), content.mapped->GetSize(), v8::ArrayBufferCreationMode::kExternalized);
+                auto holder = new MappedFileHolder();
+                holder->file = std::move(content.mapped);
+                holder->handle.Reset(isolate, buffer);
+                holder->handle.SetWeak(holder, OnMappedBufferCollected, v8::WeakCallbackType::kParameter);
+                return buffer;
+            }
+
+            default:
+                return v8_helpers::MakeV8String(isolate, content.text);
+        }
+    }
+
     void ReadFileSyncCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
         auto isolate = v8::Isolate::GetCurrent();
         v8::HandleScope scope(isolate);
@@ -56,10 +246,11 @@ namespace {
             "fs.readFileSync requires a string of file path as the 1st argument.");
 
         v8::String::Utf8Value filename(args[0]);
+        auto mode = GetReadMode(isolate, args[1]);
 
         try {
-            auto content = file_system_helpers::ReadFileSync(*filename);
-            args.GetReturnValue().Set(v8_helpers::MakeV8String(isolate, content));
+            auto content = ReadFileContent(*filename, mode);
+            args.GetReturnValue().Set(MakeContent(isolate, content));
         } catch (const std::exception& ex) {
             isolate->ThrowException(v8::Exception::Error(v8_helpers::MakeV8String(isolate, ex.what())));
             args.GetReturnValue().SetUndefined();
@@ -146,15 +337,204 @@ namespace {
         v8::String::Utf8Value directory(args[0]);
         auto names = file_system_helpers::ReadDirectorySync(std::string(*directory));
 
-        auto context = isolate->GetCurrentContext();
-        auto count = static_cast<uint32_t>(names.size());
-        auto result = v8::Array::New(isolate, count);
+        args.GetReturnValue().Set(MakeNames(isolate, names));
+    }
 
-        for (uint32_t i = 0; i < count; ++i) {
-            (void)result->CreateDataProperty(context, i, v8_helpers::MakeV8String(isolate, names[i]));
+    void StatSyncCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate,
+            args.Length() >= 1 && args[0]->IsString(),
+            "fs.statSync requires a string as the 1st parameter for the path.");
+
+        v8::String::Utf8Value path(args[0]);
+
+        try {
+            args.GetReturnValue().Set(MakeStats(isolate, file_system_helpers::StatSync(*path)));
+        } catch (const std::exception& ex) {
+            isolate->ThrowException(v8::Exception::Error(v8_helpers::MakeV8String(isolate, ex.what())));
         }
-            
-        args.GetReturnValue().Set(result);
+    }
+
+    /// <summary> Runs a file system operation on the I/O pool, then calls back with (error) or (null, result) on the worker. </summary>
+    /// <param name="callback"> The node.js style callback. </param>
+    /// <param name="operation"> Function that runs the operation and returns its result, or throws. </param>
+    /// <param name="convert"> Function that makes the Javascript value of the result, nullptr to call back with no result. </param>
+    template <typename T, typename Operation>
+    void RunAsync(v8::Local<v8::Function> callback,
+                  Operation operation,
+                  v8::Local<v8::Value> (*convert)(v8::Isolate*, T&)) {
+        napa::zone::MakeAsyncTask()
+            .Post(std::move(operation), napa::zone::AsyncWorkPool::IO)
+            .Finally(callback, [convert](v8::Local<v8::Function> jsCallback, napa::zone::AsyncResult<T>& result) {
+                auto isolate = v8::Isolate::GetCurrent();
+
+                // Values are made in the context of the caller, so errors are instances of its Error.
+                auto context = jsCallback->CreationContext();
+                v8::Context::Scope contextScope(context);
+
+                std::string error;
+                try {
+                    result.Get();
+                } catch (const std::exception& ex) {
+                    error = ex.what();
+                }
+
+                v8::Local<v8::Value> argv[] = { v8::Null(isolate), v8::Undefined(isolate) };
+                int argc = 1;
+                if (result.HasError()) {
+                    argv[0] = v8::Exception::Error(v8_helpers::MakeV8String(isolate, error));
+                } else if (convert != nullptr) {
+                    argv[1] = convert(isolate, result.Get());
+                    argc = 2;
+                }
+
+                // An exception of the callback is left to the caller of the completion.
+                if (jsCallback->Call(context, context->Global(), argc, argv).IsEmpty()) {
+                    return;
+                }
+            });
+    }
+
+    /// <summary> Settles the promise resolver in the function data, as the callback of a file system operation. </summary>
+    void SettlePromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = args.GetIsolate();
+        auto context = isolate->GetCurrentContext();
+        auto resolver = v8::Local<v8::Promise::Resolver>::Cast(args.Data());
+
+        auto settled = !args[0]->IsNull()
+            ? resolver->Reject(context, args[0])
+            : resolver->Resolve(context, args.Length() > 1 ? args[1] : v8::Undefined(isolate).As<v8::Value>());
+
+        // Settling only fails while the isolate is terminating.
+        (void)settled;
+    }
+
+    /// <summary> Calls a callback style function with a callback that settles a promise, and returns the promise. </summary>
+    void CallWithPromise(const v8::FunctionCallbackInfo<v8::Value>& args,
+                         void (*function)(const v8::FunctionCallbackInfo<v8::Value>&, v8::Local<v8::Function>)) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto resolver = v8::Promise::Resolver::New(context).ToLocalChecked();
+        auto callback = v8::Function::New(context, SettlePromiseCallback, resolver).ToLocalChecked();
+
+        function(args, callback);
+        args.GetReturnValue().Set(resolver->GetPromise());
+    }
+
+    void ReadFile(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Function> callback) {
+        auto isolate = v8::Isolate::GetCurrent();
+
+        CHECK_ARG(isolate,
+            args.Length() > 0 && args[0]->IsString(),
+            "fs.readFile requires a string of file path as the 1st argument.");
+
+        std::string filename(*v8::String::Utf8Value(args[0]));
+        auto mode = GetReadMode(isolate, args[1]);
+        RunAsync<FileContent>(callback, [filename = std::move(filename), mode]() {
+            return ReadFileContent(filename, mode);
+        }, MakeContent);
+    }
+
+    void WriteFile(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Function> callback) {
+        auto isolate = v8::Isolate::GetCurrent();
+
+        CHECK_ARG(isolate,
+            args.Length() > 0 && args[0]->IsString(),
+            "fs.writeFile requires a string as the 1st parameter for file name.");
+
+        CHECK_ARG(isolate,
+            args.Length() > 1 && args[1]->IsString(),
+            "fs.writeFile require a string as the 2nd parameter for data to write.");
+
+        std::string filename(*v8::String::Utf8Value(args[0]));
+        v8::String::Utf8Value utf8(args[1]);
+        std::string content(*utf8, static_cast<size_t>(utf8.length()));
+
+        RunAsync<bool>(callback, [filename = std::move(filename), content = std::move(content)]() {
+            file_system_helpers::WriteFileSync(filename, content.data(), content.size());
+            return true;
+        }, nullptr);
+    }
+
+    void Stat(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Function> callback) {
+        auto isolate = v8::Isolate::GetCurrent();
+
+        CHECK_ARG(isolate,
+            args.Length() > 0 && args[0]->IsString(),
+            "fs.stat requires a string as the 1st parameter for the path.");
+
+        std::string path(*v8::String::Utf8Value(args[0]));
+        RunAsync<file_system_helpers::FileStat>(callback, [path = std::move(path)]() {
+            return file_system_helpers::StatSync(path);
+        }, [](v8::Isolate* isolate, file_system_helpers::FileStat& stat) {
+            return MakeStats(isolate, stat);
+        });
+    }
+
+    void Readdir(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Function> callback) {
+        auto isolate = v8::Isolate::GetCurrent();
+
+        CHECK_ARG(isolate,
+            args.Length() > 0 && args[0]->IsString(),
+            "fs.readdir requires a string as the 1st parameter for the directory.");
+
+        std::string directory(*v8::String::Utf8Value(args[0]));
+        RunAsync<std::vector<std::string>>(callback, [directory = std::move(directory)]() {
+            return file_system_helpers::ReadDirectorySync(directory);
+        }, [](v8::Isolate* isolate, std::vector<std::string>& names) {
+            return MakeNames(isolate, names);
+        });
+    }
+
+    /// <summary> Calls a callback style function with the callback passed as its last argument. </summary>
+    void CallWithCallback(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          const char* name,
+                          int minArguments,
+                          void (*function)(const v8::FunctionCallbackInfo<v8::Value>&, v8::Local<v8::Function>)) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate,
+            args.Length() > minArguments && args[args.Length() - 1]->IsFunction(),
+            "fs.%s requires a callback as the last argument.", name);
+
+        function(args, v8::Local<v8::Function>::Cast(args[args.Length() - 1]));
+    }
+
+    void ReadFileCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithCallback(args, "readFile", 1, ReadFile);
+    }
+
+    void WriteFileCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithCallback(args, "writeFile", 2, WriteFile);
+    }
+
+    void StatCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithCallback(args, "stat", 1, Stat);
+    }
+
+    void ReaddirCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithCallback(args, "readdir", 1, Readdir);
+    }
+
+    void ReadFilePromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithPromise(args, ReadFile);
+    }
+
+    void WriteFilePromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithPromise(args, WriteFile);
+    }
+
+    void StatPromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithPromise(args, Stat);
+    }
+
+    void ReaddirPromiseCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        CallWithPromise(args, Readdir);
     }
 
 }   // End of anonymous namespace.
\ No newline at end of file
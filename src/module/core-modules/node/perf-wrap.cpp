@@ -0,0 +1,389 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "perf-wrap.h"
+#include "performance-timeline.h"
+
+#include <napa/module.h>
+#include <providers/hdr-histogram.h>
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+using namespace napa;
+using namespace napa::module;
+using namespace napa::module::performance;
+
+namespace {
+
+    /// <summary> Callback to now(), which returns milliseconds since the time origin without allocating a handle scope. </summary>
+    void NowCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Marks and measures of an isolate, which 'perf_hooks' creates once. </summary>
+    class PerformanceTimelineWrap : public NAPA_OBJECTWRAP {
+    public:
+        static constexpr const char* exportName = "PerformanceTimeline";
+
+        static void Init();
+
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR
+
+    private:
+        friend void napa::module::DefaultConstructorCallback<PerformanceTimelineWrap>(const v8::FunctionCallbackInfo<v8::Value>&);
+
+        /// <summary> It implements mark(name: string, startTime?: number): PerformanceEntry </summary>
+        static void MarkCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements measure(name: string, startMark?: string, endMark?: string): PerformanceEntry </summary>
+        static void MeasureCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements getEntries(): PerformanceEntry[] </summary>
+        static void GetEntriesCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements getEntriesByName(name: string, type?: string): PerformanceEntry[] </summary>
+        static void GetEntriesByNameCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements getEntriesByType(type: string): PerformanceEntry[] </summary>
+        static void GetEntriesByTypeCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements clearMarks(name?: string): void </summary>
+        static void ClearMarksCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements clearMeasures(name?: string): void </summary>
+        static void ClearMeasuresCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        static void Clear(const v8::FunctionCallbackInfo<v8::Value>& args, EntryType type);
+
+        PerformanceTimeline _timeline;
+    };
+
+    /// <summary> A histogram that records integers without allocating, which createHistogram() returns. </summary>
+    /// <remarks> Values are counted in the buckets of providers::HdrHistogram, so they are known within 1.6%. </remarks>
+    class HistogramWrap : public NAPA_OBJECTWRAP {
+    public:
+        static constexpr const char* exportName = "Histogram";
+
+        static void Init();
+
+        NAPA_DECLARE_PERSISTENT_CONSTRUCTOR
+
+    private:
+        friend void napa::module::DefaultConstructorCallback<HistogramWrap>(const v8::FunctionCallbackInfo<v8::Value>&);
+
+        HistogramWrap() : _hasDelta(false) {}
+
+        /// <summary> It implements record(value: number): void </summary>
+        static void RecordCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements recordDelta(): void, which records nanoseconds since its previous call. </summary>
+        static void RecordDeltaCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements reset(): void </summary>
+        static void ResetCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements percentile(percentile: number): number </summary>
+        static void PercentileCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> It implements count, min, max and mean. </summary>
+        static void CountCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+        static void MinCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+        static void MaxCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+        static void MeanCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args);
+
+        providers::HdrHistogram _histogram;
+        std::chrono::steady_clock::time_point _lastDelta;
+        bool _hasDelta;
+    };
+
+    /// <summary> Creates the JavaScript object of an entry, as PerformanceEntry of Node.js. </summary>
+    v8::Local<v8::Object> MakeEntry(v8::Isolate* isolate, const TimelineEntry& entry);
+
+    /// <summary> Creates an array of entries. </summary>
+    template <typename Entries>
+    v8::Local<v8::Array> MakeEntries(v8::Isolate* isolate, const Entries& entries);
+
+    /// <summary> Parses an entry type, 'mark' or 'measure'. </summary>
+    bool GetEntryType(v8::Local<v8::Value> value, EntryType& type);
+
+}   // End of anonymous namespace.
+
+void perf_wrap::Init(v8::Local<v8::Object> exports) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto context = isolate->GetCurrentContext();
+
+    NAPA_SET_METHOD(exports, "now", NowCallback);
+    exports->CreateDataProperty(context,
+                                v8_helpers::MakeV8String(isolate, "timeOrigin"),
+                                v8::Number::New(isolate, GetTimeOrigin())).FromJust();
+
+    PerformanceTimelineWrap::Init();
+    NAPA_EXPORT_OBJECTWRAP(exports, "PerformanceTimeline", PerformanceTimelineWrap);
+
+    HistogramWrap::Init();
+    NAPA_EXPORT_OBJECTWRAP(exports, "Histogram", HistogramWrap);
+}
+
+namespace {
+
+    NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(PerformanceTimelineWrap)
+    NAPA_DEFINE_PERSISTENT_CONSTRUCTOR(HistogramWrap)
+
+    void NowCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        args.GetReturnValue().Set(Now());
+    }
+
+    void PerformanceTimelineWrap::Init() {
+        auto isolate = v8::Isolate::GetCurrent();
+        auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<PerformanceTimelineWrap>);
+        constructorTemplate->SetClassName(v8_helpers::MakeV8String(isolate, exportName));
+        constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "mark", MarkCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "measure", MeasureCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getEntries", GetEntriesCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getEntriesByName", GetEntriesByNameCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "getEntriesByType", GetEntriesByTypeCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "clearMarks", ClearMarksCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "clearMeasures", ClearMeasuresCallback);
+
+        NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructorTemplate->GetFunction());
+    }
+
+    void PerformanceTimelineWrap::MarkCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate, args.Length() >= 1 && args[0]->IsString(), "Argument 'name' must be a string.");
+        CHECK_ARG(isolate, args.Length() < 2 || args[1]->IsUndefined() || args[1]->IsNumber(), "Argument 'startTime' must be a number.");
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<PerformanceTimelineWrap>(args.Holder());
+        auto startTime = args.Length() < 2 || args[1]->IsUndefined() ? Now() : args[1]->NumberValue();
+        auto& entry = wrap->_timeline.Mark(v8_helpers::V8ValueTo<std::string>(args[0]), startTime);
+        args.GetReturnValue().Set(MakeEntry(isolate, entry));
+    }
+
+    void PerformanceTimelineWrap::MeasureCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        // The end is taken first, so the time spent looking up marks isn't measured.
+        auto endTime = Now();
+
+        CHECK_ARG(isolate, args.Length() >= 1 && args[0]->IsString(), "Argument 'name' must be a string.");
+        CHECK_ARG(isolate, args.Length() < 2 || args[1]->IsUndefined() || args[1]->IsString(), "Argument 'startMark' must be a string.");
+        CHECK_ARG(isolate, args.Length() < 3 || args[2]->IsUndefined() || args[2]->IsString(), "Argument 'endMark' must be a string.");
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<PerformanceTimelineWrap>(args.Holder());
+
+        // Without a start mark, a measure starts at the time origin.
+        double startTime = 0;
+        if (args.Length() >= 2 && args[1]->IsString()) {
+            auto startMark = v8_helpers::V8ValueTo<std::string>(args[1]);
+            JS_ENSURE(isolate, wrap->_timeline.FindMark(startMark, startTime), "The \"%s\" performance mark has not been set.", startMark.c_str());
+        }
+        if (args.Length() >= 3 && args[2]->IsString()) {
+            auto endMark = v8_helpers::V8ValueTo<std::string>(args[2]);
+            JS_ENSURE(isolate, wrap->_timeline.FindMark(endMark, endTime), "The \"%s\" performance mark has not been set.", endMark.c_str());
+        }
+
+        auto& entry = wrap->_timeline.Measure(v8_helpers::V8ValueTo<std::string>(args[0]), startTime, endTime);
+        args.GetReturnValue().Set(MakeEntry(isolate, entry));
+    }
+
+    void PerformanceTimelineWrap::GetEntriesCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<PerformanceTimelineWrap>(args.Holder());
+        args.GetReturnValue().Set(MakeEntries(isolate, wrap->_timeline.GetEntries()));
+    }
+
+    void PerformanceTimelineWrap::GetEntriesByNameCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate, args.Length() >= 1 && args[0]->IsString(), "Argument 'name' must be a string.");
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<PerformanceTimelineWrap>(args.Holder());
+        auto name = v8_helpers::V8ValueTo<std::string>(args[0]);
+        if (args.Length() < 2 || args[1]->IsUndefined()) {
+            args.GetReturnValue().Set(MakeEntries(isolate, wrap->_timeline.GetEntriesByName(name)));
+            return;
+        }
+
+        EntryType type;
+        if (!GetEntryType(args[1], type)) {
+            args.GetReturnValue().Set(v8::Array::New(isolate));
+            return;
+        }
+        args.GetReturnValue().Set(MakeEntries(isolate, wrap->_timeline.GetEntriesByName(name, &type)));
+    }
+
+    void PerformanceTimelineWrap::GetEntriesByTypeCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate, args.Length() >= 1 && args[0]->IsString(), "Argument 'type' must be a string.");
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<PerformanceTimelineWrap>(args.Holder());
+        EntryType type;
+        if (!GetEntryType(args[0], type)) {
+            args.GetReturnValue().Set(v8::Array::New(isolate));
+            return;
+        }
+        args.GetReturnValue().Set(MakeEntries(isolate, wrap->_timeline.GetEntriesByType(type)));
+    }
+
+    void PerformanceTimelineWrap::ClearMarksCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        Clear(args, EntryType::MARK);
+    }
+
+    void PerformanceTimelineWrap::ClearMeasuresCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        Clear(args, EntryType::MEASURE);
+    }
+
+    void PerformanceTimelineWrap::Clear(const v8::FunctionCallbackInfo<v8::Value>& args, EntryType type) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate, args.Length() < 1 || args[0]->IsUndefined() || args[0]->IsString(), "Argument 'name' must be a string.");
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<PerformanceTimelineWrap>(args.Holder());
+        if (args.Length() < 1 || args[0]->IsUndefined()) {
+            wrap->_timeline.Clear(type);
+        } else {
+            auto name = v8_helpers::V8ValueTo<std::string>(args[0]);
+            wrap->_timeline.Clear(type, &name);
+        }
+    }
+
+    void HistogramWrap::Init() {
+        auto isolate = v8::Isolate::GetCurrent();
+        auto constructorTemplate = v8::FunctionTemplate::New(isolate, DefaultConstructorCallback<HistogramWrap>);
+        constructorTemplate->SetClassName(v8_helpers::MakeV8String(isolate, exportName));
+        constructorTemplate->InstanceTemplate()->SetInternalFieldCount(1);
+
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "record", RecordCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "recordDelta", RecordDeltaCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "reset", ResetCallback);
+        NAPA_SET_PROTOTYPE_METHOD(constructorTemplate, "percentile", PercentileCallback);
+        NAPA_SET_ACCESSOR(constructorTemplate, "count", CountCallback, nullptr);
+        NAPA_SET_ACCESSOR(constructorTemplate, "min", MinCallback, nullptr);
+        NAPA_SET_ACCESSOR(constructorTemplate, "max", MaxCallback, nullptr);
+        NAPA_SET_ACCESSOR(constructorTemplate, "mean", MeanCallback, nullptr);
+
+        NAPA_SET_PERSISTENT_CONSTRUCTOR(exportName, constructorTemplate->GetFunction());
+    }
+
+    void HistogramWrap::RecordCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+
+        CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsNumber(), "Argument 'value' must be a number.");
+        auto value = args[0]->NumberValue();
+        CHECK_ARG(isolate, value >= 0 && value <= static_cast<double>(std::numeric_limits<int64_t>::max()),
+            "Argument 'value' must be a non-negative number.");
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+        wrap->_histogram.Record(static_cast<int64_t>(std::llround(value)));
+    }
+
+    void HistogramWrap::RecordDeltaCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto now = std::chrono::steady_clock::now();
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+
+        // The first call only starts the clock, as in Node.js.
+        if (wrap->_hasDelta) {
+            wrap->_histogram.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - wrap->_lastDelta).count());
+        }
+        wrap->_lastDelta = now;
+        wrap->_hasDelta = true;
+    }
+
+    void HistogramWrap::ResetCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+        wrap->_histogram = providers::HdrHistogram();
+        wrap->_hasDelta = false;
+    }
+
+    void HistogramWrap::PercentileCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+
+        CHECK_ARG(isolate, args.Length() == 1 && args[0]->IsNumber(), "Argument 'percentile' must be a number.");
+        auto percentile = args[0]->NumberValue();
+        CHECK_ARG(isolate, percentile > 0 && percentile <= 100, "Argument 'percentile' must be in (0, 100].");
+
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+        args.GetReturnValue().Set(static_cast<double>(wrap->_histogram.GetValueAtPercentile(percentile)));
+    }
+
+    void HistogramWrap::CountCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+        args.GetReturnValue().Set(static_cast<double>(wrap->_histogram.GetCount()));
+    }
+
+    void HistogramWrap::MinCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+        args.GetReturnValue().Set(static_cast<double>(wrap->_histogram.GetMin()));
+    }
+
+    void HistogramWrap::MaxCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+        args.GetReturnValue().Set(static_cast<double>(wrap->_histogram.GetMax()));
+    }
+
+    void HistogramWrap::MeanCallback(v8::Local<v8::String>, const v8::PropertyCallbackInfo<v8::Value>& args) {
+        auto wrap = NAPA_OBJECTWRAP::Unwrap<HistogramWrap>(args.Holder());
+        auto count = wrap->_histogram.GetCount();
+        args.GetReturnValue().Set(count == 0
+            ? std::numeric_limits<double>::quiet_NaN()
+            : static_cast<double>(wrap->_histogram.GetSum()) / static_cast<double>(count));
+    }
+
+    v8::Local<v8::Object> MakeEntry(v8::Isolate* isolate, const TimelineEntry& entry) {
+        auto context = isolate->GetCurrentContext();
+        auto object = v8::Object::New(isolate);
+        object->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "name"), v8_helpers::MakeV8String(isolate, entry.name)).FromJust();
+        object->CreateDataProperty(context,
+                                   v8_helpers::MakeV8String(isolate, "entryType"),
+                                   v8_helpers::MakeV8String(isolate, GetEntryTypeName(entry.type))).FromJust();
+        object->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "startTime"), v8::Number::New(isolate, entry.startTime)).FromJust();
+        object->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "duration"), v8::Number::New(isolate, entry.duration)).FromJust();
+        return object;
+    }
+
+    const TimelineEntry& GetEntry(const TimelineEntry& entry) {
+        return entry;
+    }
+
+    const TimelineEntry& GetEntry(const TimelineEntry* entry) {
+        return *entry;
+    }
+
+    template <typename Entries>
+    v8::Local<v8::Array> MakeEntries(v8::Isolate* isolate, const Entries& entries) {
+        auto context = isolate->GetCurrentContext();
+        auto array = v8::Array::New(isolate, static_cast<int>(entries.size()));
+        uint32_t index = 0;
+        for (const auto& entry : entries) {
+            array->CreateDataProperty(context, index++, MakeEntry(isolate, GetEntry(entry))).FromJust();
+        }
+        return array;
+    }
+
+    bool GetEntryType(v8::Local<v8::Value> value, EntryType& type) {
+        auto name = v8_helpers::V8ValueTo<std::string>(value);
+        if (name == GetEntryTypeName(EntryType::MARK)) {
+            type = EntryType::MARK;
+            return true;
+        }
+        if (name == GetEntryTypeName(EntryType::MEASURE)) {
+            type = EntryType::MEASURE;
+            return true;
+        }
+        return false;
+    }
+
+}   // End of anonymous namespace.
@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "performance-timeline.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace napa;
+using namespace napa::module;
+using namespace napa::module::performance;
+
+namespace {
+
+    /// <summary> The time origin, taken together on both clocks when napa is loaded. </summary>
+    const auto ORIGIN = std::chrono::steady_clock::now();
+    const auto ORIGIN_SINCE_EPOCH = std::chrono::system_clock::now().time_since_epoch();
+}
+
+double performance::Now() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ORIGIN).count();
+}
+
+double performance::GetTimeOrigin() {
+    return std::chrono::duration<double, std::milli>(ORIGIN_SINCE_EPOCH).count();
+}
+
+const char* performance::GetEntryTypeName(EntryType type) {
+    return type == EntryType::MARK ? "mark" : "measure";
+}
+
+constexpr size_t PerformanceTimeline::DEFAULT_CAPACITY;
+
+PerformanceTimeline::PerformanceTimeline(size_t capacity) : _capacity(std::max<size_t>(capacity, 1)) {}
+
+const TimelineEntry& PerformanceTimeline::Mark(const std::string& name, double startTime) {
+    return Add(TimelineEntry{ name, EntryType::MARK, startTime, 0 });
+}
+
+const TimelineEntry& PerformanceTimeline::Measure(const std::string& name, double startTime, double endTime) {
+    return Add(TimelineEntry{ name, EntryType::MEASURE, startTime, endTime - startTime });
+}
+
+bool PerformanceTimeline::FindMark(const std::string& name, double& startTime) const {
+    auto it = std::find_if(_entries.rbegin(), _entries.rend(), [&name](const TimelineEntry& entry) {
+        return entry.type == EntryType::MARK && entry.name == name;
+    });
+    if (it == _entries.rend()) {
+        return false;
+    }
+    startTime = it->startTime;
+    return true;
+}
+
+std::vector<const TimelineEntry*> PerformanceTimeline::GetEntriesByName(const std::string& name, const EntryType* type) const {
+    std::vector<const TimelineEntry*> entries;
+    for (const auto& entry : _entries) {
+        if (entry.name == name && (type == nullptr || entry.type == *type)) {
+            entries.push_back(&entry);
+        }
+    }
+    return entries;
+}
+
+std::vector<const TimelineEntry*> PerformanceTimeline::GetEntriesByType(EntryType type) const {
+    std::vector<const TimelineEntry*> entries;
+    for (const auto& entry : _entries) {
+        if (entry.type == type) {
+            entries.push_back(&entry);
+        }
+    }
+    return entries;
+}
+
+void PerformanceTimeline::Clear(EntryType type, const std::string* name) {
+    _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [type, name](const TimelineEntry& entry) {
+        return entry.type == type && (name == nullptr || entry.name == *name);
+    }), _entries.end());
+}
+
+const TimelineEntry& PerformanceTimeline::Add(TimelineEntry entry) {
+    if (_entries.size() == _capacity) {
+        _entries.pop_front();
+    }
+    _entries.push_back(std::move(entry));
+    return _entries.back();
+}
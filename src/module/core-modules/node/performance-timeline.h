@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace module {
+
+/// <summary> Helper APIs of the 'perf_hooks' core module. </summary>
+namespace performance {
+
+    /// <summary> Milliseconds since the time origin, with sub-microsecond resolution. </summary>
+    /// <remarks> The origin is when napa was loaded into the process, the same for all isolates. </remarks>
+    double Now();
+
+    /// <summary> The time origin in milliseconds since the Unix epoch. </summary>
+    double GetTimeOrigin();
+
+    /// <summary> Type of a timeline entry. </summary>
+    enum class EntryType {
+        MARK,
+        MEASURE
+    };
+
+    /// <summary> Name of an entry type, i.e. 'mark' or 'measure'. </summary>
+    const char* GetEntryTypeName(EntryType type);
+
+    /// <summary> A mark or a measure, with times in milliseconds since the time origin. </summary>
+    struct TimelineEntry {
+        std::string name;
+        EntryType type;
+        double startTime;
+
+        /// <summary> Time between the start and the end of a measure, 0 for a mark. </summary>
+        double duration;
+    };
+
+    /// <summary> Marks and measures of an isolate, in the order they were added. </summary>
+    /// <remarks> Entries beyond the capacity drop the oldest ones, so instrumented code never grows it without bound. </remarks>
+    class PerformanceTimeline {
+    public:
+
+        /// <summary> Entries kept by default. </summary>
+        static constexpr size_t DEFAULT_CAPACITY = 10000;
+
+        explicit PerformanceTimeline(size_t capacity = DEFAULT_CAPACITY);
+
+        /// <summary> Adds a mark. </summary>
+        const TimelineEntry& Mark(const std::string& name, double startTime);
+
+        /// <summary> Adds a measure between two times. </summary>
+        const TimelineEntry& Measure(const std::string& name, double startTime, double endTime);
+
+        /// <summary> Gets the start time of the latest mark of a name. </summary>
+        /// <returns> False if there is no mark of the name. </returns>
+        bool FindMark(const std::string& name, double& startTime) const;
+
+        /// <summary> Gets all entries, in the order they were added. </summary>
+        const std::deque<TimelineEntry>& GetEntries() const { return _entries; }
+
+        /// <summary> Gets entries of a name, of any type if type is nullptr. </summary>
+        std::vector<const TimelineEntry*> GetEntriesByName(const std::string& name, const EntryType* type = nullptr) const;
+
+        /// <summary> Gets entries of a type. </summary>
+        std::vector<const TimelineEntry*> GetEntriesByType(EntryType type) const;
+
+        /// <summary> Removes entries of a type, only the ones of a name if name is not nullptr. </summary>
+        void Clear(EntryType type, const std::string* name = nullptr);
+
+    private:
+        const TimelineEntry& Add(TimelineEntry entry);
+
+        size_t _capacity;
+        std::deque<TimelineEntry> _entries;
+    };
+
+}   // End of namespace performance
+}   // End of namespace module
+}   // End of namespace napa
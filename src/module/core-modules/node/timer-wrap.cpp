@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "timer-wrap.h"
+
+#include <napa/module.h>
+#include <zone/worker-timers.h>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+
+    /// <summary> Callback to setDispatcher(), which sets the function called with the id of each timer that fires. </summary>
+    void SetDispatcherCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Callback to start(id, delay), which starts or restarts a timer that fires once. </summary>
+    void StartCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Callback to cancel(id). </summary>
+    void CancelCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+    /// <summary> Gets the timers of the calling worker, throws outside of zone workers. </summary>
+    zone::WorkerTimers* GetWorkerTimers(v8::Isolate* isolate);
+
+}   // End of anonymous namespace.
+
+void timer_wrap::Init(v8::Local<v8::Object> exports) {
+    NAPA_SET_METHOD(exports, "setDispatcher", SetDispatcherCallback);
+    NAPA_SET_METHOD(exports, "start", StartCallback);
+    NAPA_SET_METHOD(exports, "cancel", CancelCallback);
+}
+
+namespace {
+
+    void SetDispatcherCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate,
+            args.Length() == 1 && args[0]->IsFunction(),
+            "timer_wrap.setDispatcher requires a function");
+
+        auto timers = GetWorkerTimers(isolate);
+        if (timers != nullptr) {
+            timers->SetDispatcher(v8::Local<v8::Function>::Cast(args[0]));
+        }
+    }
+
+    void StartCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate,
+            args.Length() == 2 && args[0]->IsNumber() && args[1]->IsNumber(),
+            "timer_wrap.start requires a timer id and a delay in milliseconds");
+
+        auto timers = GetWorkerTimers(isolate);
+        if (timers != nullptr) {
+            auto id = static_cast<zone::WorkerTimers::Id>(args[0]->NumberValue());
+            auto delay = static_cast<int64_t>(args[1]->NumberValue());
+            timers->Start(id, std::chrono::milliseconds(delay));
+        }
+    }
+
+    void CancelCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        CHECK_ARG(isolate,
+            args.Length() == 1 && args[0]->IsNumber(),
+            "timer_wrap.cancel requires a timer id");
+
+        auto timers = GetWorkerTimers(isolate);
+        if (timers != nullptr) {
+            timers->Cancel(static_cast<zone::WorkerTimers::Id>(args[0]->NumberValue()));
+        }
+    }
+
+    zone::WorkerTimers* GetWorkerTimers(v8::Isolate* isolate) {
+        auto timers = zone::WorkerTimers::Get();
+        JS_ENSURE_WITH_RETURN(isolate, timers != nullptr, nullptr, "Timers are only available on napa zone workers");
+        return timers;
+    }
+
+}   // End of anonymous namespace.
@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <v8.h>
+
+namespace napa {
+namespace module {
+
+/// <summary> Napa built-in addon to run timers on zone workers, which the 'timers' core module builds on. </summary>
+namespace timer_wrap {
+
+    /// <summary> Set timer_wrap object. </summary>
+    /// <param name="exports"> Object to set module. </param>
+    void Init(v8::Local<v8::Object> exports);
+
+}   // End of namespace timer_wrap
+}   // End of namespace module
+}   // End of namespace napa
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "binary-module-cache.h"
+
+using namespace napa;
+using namespace napa::module;
+
+BinaryModuleCache& BinaryModuleCache::GetInstance() {
+    static BinaryModuleCache* binaryModuleCache = new BinaryModuleCache();
+    return *binaryModuleCache;
+}
+
+const NapaModule* BinaryModuleCache::Get(const std::string& path, std::string& error) {
+    // Loading is serialized, so a library is loaded and its static initializers run only once.
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _entries.find(path);
+    if (it != _entries.end()) {
+        return it->second.module;
+    }
+
+    std::unique_ptr<dll::SharedLibrary> library;
+    try {
+        library = std::make_unique<dll::SharedLibrary>(path);
+    } catch (const std::exception& ex) {
+        error = ex.what();
+        return nullptr;
+    }
+
+    auto napaModule = library->Import<NapaModule>(NAPA_MODULE_EXPORT);
+    if (napaModule == nullptr) {
+        error = "Can't import napa module: \"" + path + "\"";
+        return nullptr;
+    }
+
+    if (napaModule->version != MODULE_VERSION) {
+        error = "Module version is not compatible: \"" + path + "\"";
+        return nullptr;
+    }
+
+    _entries.emplace(path, Entry{ std::move(library), napaModule });
+    return napaModule;
+}
+
+size_t BinaryModuleCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.size();
+}
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/module/module-internal.h>
+#include <platform/dll.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide libraries of binary modules, which isolates of all zones initialize their exports from. </summary>
+    /// <remarks>
+    ///     A binary module is loaded and its export is looked up once per process, the first time an isolate requires it,
+    ///     so other isolates only call its initializer. Libraries stay loaded until the process exits, since objects
+    ///     they created may outlive the isolate that loaded them.
+    /// </remarks>
+    class BinaryModuleCache {
+    public:
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static BinaryModuleCache& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        BinaryModuleCache() = default;
+
+        /// <summary> Non-copyable. </summary>
+        BinaryModuleCache(const BinaryModuleCache&) = delete;
+        BinaryModuleCache& operator=(const BinaryModuleCache&) = delete;
+
+        /// <summary> Gets the export of a binary module, loading its library on first use. </summary>
+        /// <param name="path"> Full path of the binary module. </param>
+        /// <param name="error"> Why the module can't be loaded, if it can't. </param>
+        /// <returns> The export of the module, nullptr if the library can't be loaded or has no compatible export. </returns>
+        /// <remarks> A module that failed to load is tried again next time, e.g. once its file was fixed. </remarks>
+        const NapaModule* Get(const std::string& path, std::string& error);
+
+        /// <summary> Gets the number of loaded binary modules. </summary>
+        size_t GetSize() const;
+
+    private:
+
+        struct Entry {
+            std::unique_ptr<dll::SharedLibrary> library;
+            const NapaModule* module;
+        };
+
+        std::unordered_map<std::string, Entry> _entries;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -2,12 +2,11 @@
 // Licensed under the MIT license.
 
 #include "binary-module-loader.h"
+#include "binary-module-cache.h"
 #include "module-loader-helpers.h"
 
 #include <napa/v8-helpers.h>
 
-#include <platform/dll.h>
-
 using namespace napa;
 using namespace napa::module;
 
@@ -18,22 +17,9 @@ bool BinaryModuleLoader::TryGet(const std::string& path, v8::Local<v8::Value> /*
     auto isolate = v8::Isolate::GetCurrent();
     v8::EscapableHandleScope scope(isolate);
 
-    auto library = std::make_shared<dll::SharedLibrary>(path);
-    auto napaModule = library->Import<NapaModule>(napa::module::NAPA_MODULE_EXPORT);
-
-    JS_ENSURE_WITH_RETURN(isolate,
-                          napaModule != nullptr,
-                          false,
-                          "Can't import napa module: \"%s\"", 
-                          path.c_str());
-
-    JS_ENSURE_WITH_RETURN(isolate,
-                          napaModule->version == MODULE_VERSION,
-                          false,
-                          "Module version is not compatible: \"%s\"",
-                          path.c_str());
-
-    _modules.push_back(library);
+    std::string error;
+    auto napaModule = BinaryModuleCache::GetInstance().Get(path, error);
+    JS_ENSURE_WITH_RETURN(isolate, napaModule != nullptr, false, "%s", error.c_str());
 
     auto context = isolate->GetCurrentContext();
 
@@ -4,16 +4,14 @@
 #pragma once
 
 #include "module-file-loader.h"
-#include "platform/dll.h"
 
-#include <memory>
 #include <string>
-#include <vector>
 
 namespace napa {
 namespace module {
 
     /// <summary> It loads a module from binary file. </summary>
+    /// <remarks> Libraries are loaded once per process by BinaryModuleCache, each isolate initializes its own exports. </remarks>
     class BinaryModuleLoader : public ModuleFileLoader {
     public:
 
@@ -32,9 +30,6 @@ namespace module {
 
         /// Built-in modules registerer.
         BuiltInModulesSetter _builtInModulesSetter;
-
-        /// <summary> It keeps binary modules loaded. </summary>
-        std::vector<std::shared_ptr<dll::SharedLibrary>> _modules;
     };
 
 }   // End of namespace module.
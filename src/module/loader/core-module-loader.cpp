@@ -22,8 +22,10 @@ namespace {
 
 CoreModuleLoader::CoreModuleLoader(BuiltInModulesSetter builtInModulesSetter,
                                    ModuleCache& moduleCache,
-                                   ModuleCache& bindingCache)
-    : JavascriptModuleLoader(std::move(builtInModulesSetter), moduleCache), _bindingCache(bindingCache) {}
+                                   BindingGetter bindingGetter,
+                                   RequireFactory requireFactory)
+    : JavascriptModuleLoader(std::move(builtInModulesSetter), moduleCache, std::move(requireFactory)),
+      _bindingGetter(std::move(bindingGetter)) {}
                                 
 bool CoreModuleLoader::TryGet(const std::string& name, v8::Local<v8::Value> /*arg*/, v8::Local<v8::Object>& module) {
     filesystem::Path basePath(module_loader_helpers::GetNapaRuntimeDirectory());
@@ -43,5 +45,5 @@ bool CoreModuleLoader::TryGet(const std::string& name, v8::Local<v8::Value> /*ar
     }
 
     // Return binary core module if exists.
-    return _bindingCache.TryGet(name, module);
+    return _bindingGetter(name, module);
 }
\ No newline at end of file
@@ -5,11 +5,15 @@
 
 #include "javascript-module-loader.h"
 
+#include <functional>
 #include <string>
 
 namespace napa {
 namespace module {
 
+    /// <summary> Function to get a binary core module, which returns false if it doesn't exist. </summary>
+    using BindingGetter = std::function<bool(const std::string& name, v8::Local<v8::Object>& module)>;
+
     /// <summary> It loads a core module. </summary>
     class CoreModuleLoader : public JavascriptModuleLoader {
     public:
@@ -17,10 +21,12 @@ namespace module {
         /// <summary> Constructor. </summary>
         /// <param name="builtInSetter"> Built-in modules registerer. </param>
         /// <param name="moduleCache"> Cache for all modules. </param>
-        /// <param name="bindingCache"> Cache for binding core binary modules. </param>
+        /// <param name="bindingGetter"> Getter of binding core binary modules. </param>
+        /// <param name="requireFactory"> Creates 'require' of function wrapped modules, null to load modules in their own context. </param>
         CoreModuleLoader(BuiltInModulesSetter builtInModulesSetter,
                          ModuleCache& moduleCache,
-                         ModuleCache& bindingCache);
+                         BindingGetter bindingGetter,
+                         RequireFactory requireFactory = nullptr);
 
         /// <summary> It loads a core module. </summary>
         /// <param name="name"> Core module name. </param>
@@ -31,8 +37,8 @@ namespace module {
 
     private:
 
-        /// Cache instance for binding binary core modules.
-        ModuleCache& _bindingCache;
+        /// <summary> Getter of binding binary core modules. </summary>
+        BindingGetter _bindingGetter;
     };
 
 }   // End of namespace module.
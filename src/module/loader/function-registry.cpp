@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "function-registry.h"
+
+#include <utils/hash.h>
+
+using namespace napa;
+using namespace napa::module;
+
+FunctionRegistry& FunctionRegistry::GetInstance() {
+    static FunctionRegistry functionRegistry;
+    return functionRegistry;
+}
+
+std::string FunctionRegistry::Save(const std::string& origin, const std::string& body) {
+    auto signature = origin + ":" + body;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (uint64_t seed = 0; ; ++seed) {
+        auto hash = utils::hash::ToHexString(utils::hash::XxHash64(signature, seed));
+        auto iter = _definitions.find(hash);
+        if (iter == _definitions.end()) {
+            _definitions.emplace(hash, std::make_shared<const Definition>(Definition { origin, body }));
+            return hash;
+        }
+
+        if (iter->second->origin == origin && iter->second->body == body) {
+            return hash;
+        }
+    }
+}
+
+std::shared_ptr<const FunctionRegistry::Definition> FunctionRegistry::Get(const std::string& hash) const {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto iter = _definitions.find(hash);
+    return iter != _definitions.end() ? iter->second : nullptr;
+}
+
+size_t FunctionRegistry::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _definitions.size();
+}
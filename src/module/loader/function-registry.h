@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide definitions of transported functions, keyed by the hash of their origin and body. </summary>
+    /// <remarks>
+    ///     Hashes are 64-bit xxHash. On the unlikely collision of different definitions, the later one is
+    ///     rehashed with another seed, so a hash always refers to a single definition.
+    ///     It's exposed in napa.dll, so Node and Napa isolates share the same instance.
+    /// </remarks>
+    class NAPA_API FunctionRegistry {
+    public:
+
+        /// <summary> Definition of a transported function. </summary>
+        struct Definition {
+            /// <summary> From which file the function is defined. </summary>
+            std::string origin;
+
+            /// <summary> Function body. </summary>
+            std::string body;
+        };
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static FunctionRegistry& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        FunctionRegistry() = default;
+
+        /// <summary> Non-copyable. </summary>
+        FunctionRegistry(const FunctionRegistry&) = delete;
+        FunctionRegistry& operator=(const FunctionRegistry&) = delete;
+
+        /// <summary> Saves a function definition, no-op if it's already saved. </summary>
+        /// <returns> Hash to get the definition with, 16 hex digits. </returns>
+        std::string Save(const std::string& origin, const std::string& body);
+
+        /// <summary> Gets a function definition by hash. </summary>
+        /// <returns> The definition, or nullptr if not found. </returns>
+        std::shared_ptr<const Definition> Get(const std::string& hash) const;
+
+        /// <summary> Gets the number of saved definitions. </summary>
+        size_t GetSize() const;
+
+    private:
+        std::unordered_map<std::string, std::shared_ptr<const Definition>> _definitions;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -2,31 +2,77 @@
 // Licensed under the MIT license.
 
 #include "javascript-module-loader.h"
+#include "module-bundle.h"
 #include "module-cache.h"
 #include "module-loader-helpers.h"
+#include "script-cache.h"
+
+#include <platform/filesystem.h>
+#include <utils/hash.h>
+#include <zone/cached-script-compiler.h>
 
 #include <napa/v8-helpers.h>
 
 using namespace napa;
 using namespace napa::module;
 
-JavascriptModuleLoader::JavascriptModuleLoader(BuiltInModulesSetter builtInModulesSetter, ModuleCache& moduleCache)
-    : _builtInModulesSetter(std::move(builtInModulesSetter)) , _moduleCache(moduleCache) {}
+namespace {
+    // The header keeps the module source on its first line, so line numbers of stack traces stay the same.
+    const std::string FUNCTION_WRAPPER_HEADER = "(function (exports, require, module, __filename, __dirname) { ";
+    const std::string FUNCTION_WRAPPER_FOOTER = "\n})";
+}   // End of anonymous namespace.
+
+JavascriptModuleLoader::JavascriptModuleLoader(BuiltInModulesSetter builtInModulesSetter,
+                                               ModuleCache& moduleCache,
+                                               RequireFactory requireFactory)
+    : _builtInModulesSetter(std::move(builtInModulesSetter)),
+      _moduleCache(moduleCache),
+      _requireFactory(std::move(requireFactory)) {}
 
 bool JavascriptModuleLoader::TryGet(const std::string& path, v8::Local<v8::Value> arg, v8::Local<v8::Object>& module) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::EscapableHandleScope scope(isolate);
 
     bool fromContent = !arg.IsEmpty();
+    bool functionWrapper = _requireFactory != nullptr;
     v8::Local<v8::String> source;
+    std::shared_ptr<const std::string> sharedSource;
 
     if (!fromContent) {
-        source = module_loader_helpers::ReadModuleFile(path);
+        // Large module files are shared by isolates as they're wrapped, so they aren't copied into each heap.
+        source = module_loader_helpers::ReadModuleFile(path,
+                                                       functionWrapper ? FUNCTION_WRAPPER_HEADER : "",
+                                                       functionWrapper ? FUNCTION_WRAPPER_FOOTER : "",
+                                                       sharedSource);
         JS_ENSURE_WITH_RETURN(isolate, !source.IsEmpty(), false, "Can't read Javascript module: \"%s\"", path.c_str());
     } else {
         JS_ENSURE_WITH_RETURN(isolate, arg->IsString(), false, "The 2nd argument of 'require' must be content of string type.");
         source = v8::Local<v8::String>::Cast(arg);
+        if (functionWrapper) {
+            source = v8::String::Concat(
+                v8::String::Concat(v8_helpers::MakeV8String(isolate, FUNCTION_WRAPPER_HEADER), source),
+                v8_helpers::MakeV8String(isolate, FUNCTION_WRAPPER_FOOTER));
+        }
+    }
+
+    v8::Local<v8::Object> loaded;
+    auto succeeded = functionWrapper
+        ? TryGetAsFunction(path, source, sharedSource.get(), fromContent, loaded)
+        : TryGetInContext(path, source, sharedSource.get(), fromContent, loaded);
+
+    if (succeeded) {
+        module = scope.Escape(loaded);
     }
+    return succeeded;
+}
+
+bool JavascriptModuleLoader::TryGetInContext(const std::string& path,
+                                             v8::Local<v8::String> source,
+                                             const std::string* sharedSource,
+                                             bool fromContent,
+                                             v8::Local<v8::Object>& module) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
 
     auto context = isolate->GetCurrentContext();
 
@@ -46,23 +92,181 @@ bool JavascriptModuleLoader::TryGet(const std::string& path, v8::Local<v8::Value
         _moduleCache.Upsert(path, module_loader_helpers::ExportModule(moduleContext->Global(), nullptr));
     }
 
-    v8::TryCatch tryCatch;
+    v8::TryCatch tryCatch(isolate);
+    if (RunScript(moduleContext, path, source, sharedSource, fromContent).IsEmpty() || tryCatch.HasCaught()) {
+        tryCatch.ReThrow();
+        return false;
+    }
+
+    // Export a loaded module.
+    module = scope.Escape(module_loader_helpers::ExportModule(moduleContext->Global(), nullptr));
+    return true;
+}
+
+bool JavascriptModuleLoader::TryGetAsFunction(const std::string& path,
+                                              v8::Local<v8::String> source,
+                                              const std::string* sharedSource,
+                                              bool fromContent,
+                                              v8::Local<v8::Object>& module) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+
+    auto context = isolate->GetCurrentContext();
+
+    auto moduleObject = module_loader_helpers::CreateModuleObject(path);
+    auto require = _requireFactory(moduleObject);
+    (void)moduleObject->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "require"), require);
+
+    auto exports = moduleObject->Get(context, v8_helpers::MakeV8String(isolate, "exports")).ToLocalChecked();
+
+    // To prevent cycle, cache unloaded module first.
+    if (!fromContent) {
+        _moduleCache.Upsert(path, exports->ToObject());
+    }
+
+    v8::TryCatch tryCatch(isolate);
     {
-        auto origin = v8::ScriptOrigin(v8_helpers::MakeV8String(isolate, path));
-        auto script = v8::Script::Compile(source, &origin);
-        if (script.IsEmpty() || tryCatch.HasCaught()) {
+        auto wrapper = RunScript(context, path, source, sharedSource, fromContent);
+        if (wrapper.IsEmpty() || tryCatch.HasCaught()) {
             tryCatch.ReThrow();
             return false;
         }
 
-        auto run = script->Run();
+        auto dirname = filesystem::Path(path).Parent().Normalize().String();
+        v8::Local<v8::Value> argv[] = {
+            exports,
+            require,
+            moduleObject,
+            v8_helpers::MakeV8String(isolate, path),
+            v8_helpers::MakeV8String(isolate, dirname)
+        };
+
+        auto run = v8::Local<v8::Function>::Cast(wrapper.ToLocalChecked())->Call(context, exports, 5, argv);
         if (run.IsEmpty() || tryCatch.HasCaught()) {
             tryCatch.ReThrow();
             return false;
         }
     }
 
-    // Export a loaded module.
-    module = scope.Escape(module_loader_helpers::ExportModule(moduleContext->Global(), nullptr));
+    // Export a loaded module, which may have replaced module.exports.
+    auto loaded = moduleObject->Get(context, v8_helpers::MakeV8String(isolate, "exports")).ToLocalChecked();
+    module = scope.Escape(loaded->ToObject());
     return true;
-}
\ No newline at end of file
+}
+
+bool JavascriptModuleLoader::Precompile(const std::string& path, const std::string& content, bool functionWrapper) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    // The same source text as loading the module, so the code cache is found by its content hash.
+    auto sourceText = functionWrapper ? FUNCTION_WRAPPER_HEADER + content + FUNCTION_WRAPPER_FOOTER : content;
+    auto& scriptCache = ScriptCache::GetInstance();
+    auto codeCache = scriptCache.Get(path, sourceText);
+    if (codeCache->Get() != nullptr) {
+        return false;
+    }
+
+    // Errors are reported by the workers that load the module.
+    v8::TryCatch tryCatch(isolate);
+    zone::CachedScriptCompiler compiler(codeCache);
+    auto origin = v8::ScriptOrigin(v8_helpers::MakeV8String(isolate, path));
+    auto script = compiler.Compile(isolate->GetCurrentContext(), v8_helpers::MakeV8String(isolate, sourceText), origin);
+    if (script.IsEmpty() || !compiler.Produce(script.ToLocalChecked())) {
+        return false;
+    }
+
+    scriptCache.Save(path, sourceText, *codeCache);
+    return true;
+}
+
+std::shared_ptr<const zone::CodeCache::Data> JavascriptModuleLoader::ProduceCodeCache(const std::string& path,
+                                                                                      const std::string& content,
+                                                                                      bool functionWrapper) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto sourceText = functionWrapper ? FUNCTION_WRAPPER_HEADER + content + FUNCTION_WRAPPER_FOOTER : content;
+    auto codeCache = std::make_shared<zone::CodeCache>();
+
+    v8::TryCatch tryCatch(isolate);
+    zone::CachedScriptCompiler compiler(codeCache);
+    auto origin = v8::ScriptOrigin(v8_helpers::MakeV8String(isolate, path));
+    auto script = compiler.Compile(isolate->GetCurrentContext(), v8_helpers::MakeV8String(isolate, sourceText), origin);
+    if (script.IsEmpty() || !compiler.Produce(script.ToLocalChecked())) {
+        return nullptr;
+    }
+    return codeCache->Get();
+}
+
+v8::MaybeLocal<v8::Value> JavascriptModuleLoader::RunScript(v8::Local<v8::Context> context,
+                                                            const std::string& path,
+                                                            v8::Local<v8::String> source,
+                                                            const std::string* sharedSource,
+                                                            bool fromContent) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+
+    // Modules are compiled once per process, other isolates consume the code cache.
+    // Many scripts may be given as content of the same path, e.g. transported functions, each keeps its own cache.
+    auto& scriptCache = ScriptCache::GetInstance();
+    std::string sourceCopy;
+    if (sharedSource == nullptr) {
+        sourceCopy = *v8::String::Utf8Value(source);
+    }
+    const auto& sourceText = sharedSource != nullptr ? *sharedSource : sourceCopy;
+    auto cacheKey = fromContent ? path + "#" + utils::hash::ToHexString(utils::hash::XxHash64(sourceText)) : path;
+    auto codeCache = scriptCache.Get(cacheKey, sourceText);
+    if (!fromContent && codeCache->Get() == nullptr) {
+        // A bundle saved with code caches spares the first isolate compiling the module, if it loads modules the same way.
+        auto bundle = ModuleBundle::GetLoaded();
+        auto bundled = bundle != nullptr ? bundle->Find(path) : nullptr;
+        if (bundled != nullptr && bundled->codeCache != nullptr
+            && bundle->HasFunctionWrapperCodeCaches() == (_requireFactory != nullptr)) {
+            codeCache->Set(zone::CodeCache::Data(bundled->codeCache, bundled->codeCache + bundled->codeCacheLength));
+        }
+    }
+    zone::CachedScriptCompiler compiler(codeCache);
+
+    auto origin = v8::ScriptOrigin(v8_helpers::MakeV8String(isolate, path));
+    auto script = compiler.Compile(context, source, origin);
+    if (script.IsEmpty()) {
+        return v8::MaybeLocal<v8::Value>();
+    }
+
+    auto result = script.ToLocalChecked()->Run(context);
+    if (result.IsEmpty()) {
+        return v8::MaybeLocal<v8::Value>();
+    }
+
+    if (compiler.Produce(script.ToLocalChecked())) {
+        scriptCache.Save(cacheKey, sourceText, *codeCache);
+    }
+
+    // Kept until the code cache is warm, scripts given as content are too many to keep.
+    if (!fromContent && !codeCache->IsWarm()) {
+        _loadedScripts.emplace_back();
+        auto& loaded = _loadedScripts.back();
+        loaded.cacheKey = cacheKey;
+        loaded.codeCache = codeCache;
+        loaded.script.Reset(isolate, script.ToLocalChecked()->GetUnboundScript());
+    }
+    return scope.Escape(result.ToLocalChecked());
+}
+
+size_t JavascriptModuleLoader::WarmCodeCaches() {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    size_t warmed = 0;
+    auto& scriptCache = ScriptCache::GetInstance();
+    for (auto& loaded : _loadedScripts) {
+        if (zone::CachedScriptCompiler::Warm(loaded.script.Get(isolate), *loaded.codeCache)) {
+            scriptCache.Save(loaded.cacheKey, *loaded.codeCache);
+            warmed++;
+        }
+    }
+
+    // Caches are warmed once per isolate, by this isolate or another.
+    _loadedScripts.clear();
+    return warmed;
+}
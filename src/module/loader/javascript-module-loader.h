@@ -5,7 +5,11 @@
 
 #include "module-file-loader.h"
 
+#include <zone/code-cache.h>
+
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace napa {
 namespace module {
@@ -20,7 +24,10 @@ namespace module {
         /// <summary> Constructor. </summary>
         /// <param name="builtInSetter"> Built-in modules registerer. </param>
         /// <param name="moduleCache"> Cache for all modules. </param>
-        JavascriptModuleLoader(BuiltInModulesSetter builtInModulesSetter, ModuleCache& moduleCache);
+        /// <param name="requireFactory"> Creates 'require' of function wrapped modules, null to load modules in their own context. </param>
+        JavascriptModuleLoader(BuiltInModulesSetter builtInModulesSetter,
+                               ModuleCache& moduleCache,
+                               RequireFactory requireFactory = nullptr);
 
         /// <summary> It loads a module from javascript file. </summary>
         /// <param name="path"> Module path called by require(). </param>
@@ -29,13 +36,72 @@ namespace module {
         /// <returns> True if the javascript module is loaded, false otherwise. </returns>
         bool TryGet(const std::string& path, v8::Local<v8::Value> arg, v8::Local<v8::Object>& module) override;
 
+        /// <summary> It compiles a module file into the process-wide code cache without running it. </summary>
+        /// <param name="path"> Module path. </param>
+        /// <param name="content"> Module file content. </param>
+        /// <param name="functionWrapper"> Whether the module will be loaded as a function wrapper. </param>
+        /// <returns> True if a code cache was produced, false if it existed already or the module doesn't compile. </returns>
+        /// <remarks> It needs an entered context, isolates loading the module later consume the code cache. </remarks>
+        static bool Precompile(const std::string& path, const std::string& content, bool functionWrapper);
+
+        /// <summary> It compiles a module file and returns its code cache, without running it or caching it in the process. </summary>
+        /// <param name="path"> Module path. </param>
+        /// <param name="content"> Module file content. </param>
+        /// <param name="functionWrapper"> Whether the module will be loaded as a function wrapper. </param>
+        /// <returns> The code cache, nullptr if the module doesn't compile. </returns>
+        /// <remarks> It needs an entered context. </remarks>
+        static NAPA_API std::shared_ptr<const zone::CodeCache::Data> ProduceCodeCache(const std::string& path,
+                                                                                      const std::string& content,
+                                                                                      bool functionWrapper);
+
+        /// <summary> It replaces the code caches of modules loaded from files with warm ones, unless other isolates did already. </summary>
+        /// <returns> The number of code caches replaced. </returns>
+        /// <remarks> Warm caches hold the functions compiled since the modules were loaded, see CodeCache::Warm. </remarks>
+        size_t WarmCodeCaches();
+
     private:
 
+        /// <summary> It runs a module in a new context, which is the module's global. </summary>
+        bool TryGetInContext(const std::string& path,
+                             v8::Local<v8::String> source,
+                             const std::string* sharedSource,
+                             bool fromContent,
+                             v8::Local<v8::Object>& module);
+
+        /// <summary> It runs a module as a function wrapper in the calling context, like node.js does. </summary>
+        /// <param name="source"> Module source, already wrapped in the function. </param>
+        bool TryGetAsFunction(const std::string& path,
+                              v8::Local<v8::String> source,
+                              const std::string* sharedSource,
+                              bool fromContent,
+                              v8::Local<v8::Object>& module);
+
+        /// <summary> It compiles and runs a module script with the process-wide code cache. </summary>
+        /// <param name="sharedSource"> Text of the source if it's shared with other isolates, nullptr to read it from the string. </param>
+        /// <param name="fromContent"> Whether the script is given content, which is cached by path and content. </param>
+        /// <returns> The completion value of the script, empty if it threw. </returns>
+        v8::MaybeLocal<v8::Value> RunScript(v8::Local<v8::Context> context,
+                                            const std::string& path,
+                                            v8::Local<v8::String> source,
+                                            const std::string* sharedSource,
+                                            bool fromContent);
+
         /// Built-in modules registerer.
         BuiltInModulesSetter _builtInModulesSetter;
 
         /// Module cache instance.
         ModuleCache& _moduleCache;
+
+        /// 'require' factory of function wrapped modules.
+        RequireFactory _requireFactory;
+
+        /// Scripts of modules loaded from files, with their code cache key and code cache.
+        struct LoadedScript {
+            std::string cacheKey;
+            std::shared_ptr<zone::CodeCache> codeCache;
+            v8::Global<v8::UnboundScript> script;
+        };
+        std::vector<LoadedScript> _loadedScripts;
     };
 
 }   // End of namespace module.
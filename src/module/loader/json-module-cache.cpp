@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "json-module-cache.h"
+
+#include <module/core-modules/node/file-system-helpers.h>
+
+using namespace napa;
+using namespace napa::module;
+
+JsonModuleCache& JsonModuleCache::GetInstance() {
+    static JsonModuleCache* jsonModuleCache = new JsonModuleCache();
+    return *jsonModuleCache;
+}
+
+JsonModuleCache::JsonModuleCache() : _enabled(false), _frozen(false) {}
+
+void JsonModuleCache::SetMode(bool enabled, bool frozen) {
+    _enabled = enabled;
+    _frozen = frozen;
+}
+
+bool JsonModuleCache::IsEnabled() const {
+    return _enabled;
+}
+
+bool JsonModuleCache::IsFrozen() const {
+    return _frozen;
+}
+
+JsonModuleCache::Version JsonModuleCache::GetFileVersion(const std::string& path) {
+    auto stat = file_system_helpers::StatSync(path);
+    return Version(stat.size, stat.mtimeMs);
+}
+
+std::shared_ptr<const JsonModuleCache::Blob> JsonModuleCache::Get(const std::string& path, const Version& version) const {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _entries.find(path);
+    if (it == _entries.end() || it->second.version != version) {
+        return nullptr;
+    }
+    return it->second.blob;
+}
+
+void JsonModuleCache::Set(const std::string& path,
+                          const Version& version,
+                          std::shared_ptr<const Blob> blob) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries[path] = Entry{ version, std::move(blob) };
+}
+
+size_t JsonModuleCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.size();
+}
+
+void JsonModuleCache::Clear() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries.clear();
+}
@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide serialized JSON modules, which isolates of all zones deserialize instead of parsing the file. </summary>
+    /// <remarks>
+    ///     The first isolate requiring a JSON module parses it and stores it as a V8 serialized value, which others
+    ///     deserialize without reading the file. A module is parsed again when the size or modification time of its file changed.
+    /// </remarks>
+    class JsonModuleCache {
+    public:
+
+        /// <summary> V8 serialized value of a JSON module. </summary>
+        typedef std::vector<uint8_t> Blob;
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static JsonModuleCache& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        JsonModuleCache();
+
+        /// <summary> Non-copyable. </summary>
+        JsonModuleCache(const JsonModuleCache&) = delete;
+        JsonModuleCache& operator=(const JsonModuleCache&) = delete;
+
+        /// <summary> Sets whether JSON modules are shared, and whether they are deep-frozen after deserialization. </summary>
+        void SetMode(bool enabled, bool frozen);
+
+        /// <summary> Whether JSON modules are shared. </summary>
+        bool IsEnabled() const;
+
+        /// <summary> Whether deserialized JSON modules are deep-frozen. </summary>
+        bool IsFrozen() const;
+
+        /// <summary> Size and modification time of a module file, which tells if it changed. </summary>
+        typedef std::pair<uint64_t, double> Version;
+
+        /// <summary> Gets the version of a module file, throws if the file can't be stat'ed. </summary>
+        static Version GetFileVersion(const std::string& path);
+
+        /// <summary> Gets the serialized value of a JSON module. </summary>
+        /// <param name="path"> The module path. </param>
+        /// <param name="version"> The version of the module, taken before reading it. </param>
+        /// <returns> The serialized value, nullptr if the module wasn't cached or its version changed since. </returns>
+        std::shared_ptr<const Blob> Get(const std::string& path, const Version& version) const;
+
+        /// <summary> Caches the serialized value of a JSON module. </summary>
+        /// <param name="path"> The module path. </param>
+        /// <param name="version"> The version of the module, taken before reading it. </param>
+        /// <param name="blob"> The serialized value. </param>
+        void Set(const std::string& path, const Version& version, std::shared_ptr<const Blob> blob);
+
+        /// <summary> Gets the number of cached JSON modules. </summary>
+        size_t GetSize() const;
+
+        /// <summary> Drops all cached JSON modules. </summary>
+        void Clear();
+
+    private:
+
+        struct Entry {
+            Version version;
+            std::shared_ptr<const Blob> blob;
+        };
+
+        std::atomic<bool> _enabled;
+        std::atomic<bool> _frozen;
+        std::unordered_map<std::string, Entry> _entries;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -2,23 +2,113 @@
 // Licensed under the MIT license.
 
 #include "json-module-loader.h"
+#include "json-module-cache.h"
+#include "module-bundle.h"
 #include "module-loader-helpers.h"
 
 #include <napa/v8-helpers.h>
 
+#include <cstdlib>
+
 using namespace napa;
 using namespace napa::module;
 
+namespace {
+
+    /// <summary> It deserializes a JSON module cached by another isolate. </summary>
+    v8::MaybeLocal<v8::Value> Deserialize(const JsonModuleCache::Blob& blob) {
+        auto isolate = v8::Isolate::GetCurrent();
+        auto context = isolate->GetCurrentContext();
+
+        v8::ValueDeserializer deserializer(isolate, blob.data(), blob.size());
+        if (deserializer.ReadHeader(context).IsNothing()) {
+            return v8::MaybeLocal<v8::Value>();
+        }
+        return deserializer.ReadValue(context);
+    }
+
+    /// <summary> It serializes a parsed JSON module for other isolates, nullptr if it can't. </summary>
+    std::shared_ptr<const JsonModuleCache::Blob> Serialize(v8::Local<v8::Value> json) {
+        auto isolate = v8::Isolate::GetCurrent();
+        auto context = isolate->GetCurrentContext();
+
+        v8::ValueSerializer serializer(isolate);
+        serializer.WriteHeader();
+        if (serializer.WriteValue(context, json).IsNothing()) {
+            return nullptr;
+        }
+
+        auto buffer = serializer.Release();
+        auto blob = std::make_shared<JsonModuleCache::Blob>(buffer.first, buffer.first + buffer.second);
+        std::free(buffer.first);
+        return blob;
+    }
+
+    /// <summary> It freezes a JSON value and all objects it holds. </summary>
+    void DeepFreeze(v8::Local<v8::Context> context, v8::Local<v8::Value> value) {
+        if (!value->IsObject()) {
+            return;
+        }
+
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        // JSON values have neither cycles nor accessors, so the walk ends and doesn't run code.
+        auto object = value.As<v8::Object>();
+        auto names = object->GetOwnPropertyNames(context).ToLocalChecked();
+        for (uint32_t i = 0; i < names->Length(); ++i) {
+            DeepFreeze(context, object->Get(context, names->Get(context, i).ToLocalChecked()).ToLocalChecked());
+        }
+        (void)object->SetIntegrityLevel(context, v8::IntegrityLevel::kFrozen);
+    }
+
+}   // End of anonymous namespace.
+
 bool JsonModuleLoader::TryGet(const std::string& path, v8::Local<v8::Value> arg, v8::Local<v8::Object>& module) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::EscapableHandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    auto& cache = JsonModuleCache::GetInstance();
+    bool shared = cache.IsEnabled();
+
+    std::shared_ptr<const JsonModuleCache::Blob> blob;
+    JsonModuleCache::Version version;
+    if (shared) {
+        try {
+            // A bundled module doesn't change while the process runs, and may not exist as a file.
+            auto bundle = ModuleBundle::GetLoaded();
+            auto bundled = bundle != nullptr ? bundle->Find(path) : nullptr;
+            version = bundled != nullptr
+                ? JsonModuleCache::Version(bundled->sourceLength, 0)
+                : JsonModuleCache::GetFileVersion(path);
+            blob = cache.Get(path, version);
+        } catch (const std::exception& ex) {
+            isolate->ThrowException(v8::Exception::Error(v8_helpers::MakeV8String(isolate, ex.what())));
+            return false;
+        }
+    }
+
+    v8::Local<v8::Value> json;
+    if (blob == nullptr || !Deserialize(*blob).ToLocal(&json)) {
+        auto source = module_loader_helpers::ReadModuleFile(path);
+        JS_ENSURE_WITH_RETURN(isolate, !source.IsEmpty(), false, "Can't read JSON module: \"%s\"", path.c_str());
+
+        json = v8::JSON::Parse(isolate, source).ToLocalChecked();
+        JS_ENSURE_WITH_RETURN(isolate, !json.IsEmpty(), false, "Can't parse JSON from \"%s\"", path.c_str());
 
-    auto source = module_loader_helpers::ReadModuleFile(path);
-    JS_ENSURE_WITH_RETURN(isolate, !source.IsEmpty(), false, "Can't read JSON module: \"%s\"", path.c_str());
+        if (shared) {
+            blob = Serialize(json);
+            if (blob != nullptr) {
+                cache.Set(path, version, std::move(blob));
+            }
+        }
+    }
 
-    auto json = v8::JSON::Parse(isolate, source).ToLocalChecked();
-    JS_ENSURE_WITH_RETURN(isolate, !json.IsEmpty(), false, "Can't parse JSON from \"%s\"", path.c_str());
+    if (shared && cache.IsFrozen()) {
+        DeepFreeze(context, json);
+    }
 
-    module = scope.Escape(json->ToObject(isolate->GetCurrentContext()).ToLocalChecked());
+    module = scope.Escape(json->ToObject(context).ToLocalChecked());
     return true;
 }
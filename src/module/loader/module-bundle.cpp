@@ -0,0 +1,422 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "module-bundle.h"
+#include "module-source-cache.h"
+
+#include <module/core-modules/node/file-system-helpers.h>
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+
+    /// <summary> Identifies a module bundle, followed by the format version. </summary>
+    constexpr char BUNDLE_MAGIC[8] = { 'N', 'A', 'P', 'A', 'B', 'N', 'D', 'L' };
+    constexpr uint32_t BUNDLE_VERSION = 1;
+
+    /// <summary> Header flag telling that code caches are for modules loaded as function wrappers. </summary>
+    constexpr uint32_t FUNCTION_WRAPPER_CODE_CACHES = 1;
+
+    /// <summary> Header at the start of a bundle. </summary>
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t moduleCount;
+        uint64_t resolutionCount;
+        uint64_t modulesOffset;
+        uint64_t resolutionsOffset;
+        uint64_t payloadsOffset;
+        uint64_t fileSize;
+    };
+
+    /// <summary> Record of a module, followed by its path relative to the bundle directory. </summary>
+    struct ModuleRecord {
+        uint32_t type;
+        uint32_t idLength;
+        uint64_t sourceOffset;
+        uint64_t sourceLength;
+        uint64_t codeCacheOffset;
+        uint64_t codeCacheLength;
+    };
+
+    /// <summary> Record of a resolution, followed by its key. </summary>
+    struct ResolutionRecord {
+        uint64_t module;
+        uint32_t keyLength;
+        uint32_t reserved;
+    };
+
+    /// <summary> A module file to bundle. </summary>
+    struct ModuleFile {
+        ModuleType type;
+        std::string fullPath;
+        std::string content;
+        std::shared_ptr<const std::vector<uint8_t>> codeCache;
+    };
+
+    /// <summary> Records are 8-byte aligned, so they can be read in place. </summary>
+    uint64_t Align(uint64_t offset) {
+        return (offset + 7) & ~static_cast<uint64_t>(7);
+    }
+
+    /// <summary> The same key is made when saving and at run time, from the directory a module is required from. </summary>
+    std::string MakeResolutionKey(const std::string& name, const filesystem::Path& basePath, const filesystem::Path& directory) {
+        return basePath.Relative(directory).String() + '\n' + name;
+    }
+
+    bool IsIdentifierPart(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$';
+    }
+
+    size_t SkipSpaces(const std::string& source, size_t i) {
+        while (i < source.size() && (source[i] == ' ' || source[i] == '\t' || source[i] == '\r' || source[i] == '\n')) {
+            ++i;
+        }
+        return i;
+    }
+
+    /// <summary> Finds the names of require() calls with a single string literal. </summary>
+    /// <remarks> Calls in comments or strings are found too, which only bundles modules that may not be loaded. </remarks>
+    std::vector<std::string> FindRequires(const std::string& source) {
+        static const std::string REQUIRE = "require";
+
+        std::vector<std::string> names;
+        for (auto pos = source.find(REQUIRE); pos != std::string::npos; pos = source.find(REQUIRE, pos + REQUIRE.size())) {
+            if ((pos > 0 && IsIdentifierPart(source[pos - 1])) || pos + REQUIRE.size() >= source.size()) {
+                continue;
+            }
+
+            auto i = SkipSpaces(source, pos + REQUIRE.size());
+            if (i >= source.size() || source[i] != '(') {
+                continue;
+            }
+
+            i = SkipSpaces(source, i + 1);
+            if (i >= source.size() || (source[i] != '\'' && source[i] != '"' && source[i] != '`')) {
+                continue;
+            }
+
+            auto quote = source[i];
+            auto end = source.find(quote, i + 1);
+            if (end == std::string::npos) {
+                continue;
+            }
+
+            auto name = source.substr(i + 1, end - i - 1);
+            if (name.empty() || name.find_first_of("\\\n") != std::string::npos || (quote == '`' && name.find("${") != std::string::npos)) {
+                continue;
+            }
+
+            i = SkipSpaces(source, end + 1);
+            if (i < source.size() && source[i] == ')') {
+                names.push_back(std::move(name));
+            }
+        }
+        return names;
+    }
+
+    /// <summary> The bundle that modules of all zones are served from. </summary>
+    std::shared_ptr<const ModuleBundle> _loadedBundle;
+
+}   // End of anonymous namespace.
+
+bool ModuleBundle::Save(const char* path,
+                        const std::vector<std::string>& entries,
+                        const CodeCacheProducer& codeCacheProducer,
+                        bool functionWrapperCodeCaches,
+                        size_t& moduleCount,
+                        std::string& error) {
+    auto directory = filesystem::Path(path).Absolute().Parent();
+    auto currentDirectory = filesystem::CurrentDirectory().Normalize().String();
+
+    // Core modules are resolved before the bundle at run time, so resolutions of their names here are never used.
+    ModuleResolver resolver;
+
+    // Modules are found breadth first from the entries, in the order they're required.
+    std::vector<ModuleFile> files;
+    std::unordered_map<std::string, size_t> indices;
+    std::map<std::string, size_t> resolutions;
+    std::deque<std::pair<std::string, std::string>> pending;
+    for (const auto& entry : entries) {
+        pending.emplace_back(entry, currentDirectory);
+    }
+
+    while (!pending.empty()) {
+        auto name = std::move(pending.front().first);
+        auto basePath = std::move(pending.front().second);
+        pending.pop_front();
+
+        auto key = MakeResolutionKey(name, basePath, directory);
+        if (resolutions.find(key) != resolutions.end()) {
+            continue;
+        }
+
+        auto moduleInfo = resolver.Resolve(name.c_str(), basePath.c_str());
+        if (moduleInfo.type != ModuleType::JAVASCRIPT && moduleInfo.type != ModuleType::JSON) {
+            continue;
+        }
+
+        auto it = indices.find(moduleInfo.fullPath);
+        if (it == indices.end()) {
+            ModuleFile file{ moduleInfo.type, moduleInfo.fullPath, std::string(), nullptr };
+            try {
+                file.content = file_system_helpers::ReadFileSync(file.fullPath);
+            } catch (const std::exception& ex) {
+                error = "Failed to read module \"" + file.fullPath + "\": " + ex.what();
+                return false;
+            }
+
+            if (file.type == ModuleType::JAVASCRIPT) {
+                auto moduleDirectory = filesystem::Path(file.fullPath).Parent().Normalize().String();
+                for (auto& required : FindRequires(file.content)) {
+                    pending.emplace_back(std::move(required), moduleDirectory);
+                }
+
+                if (codeCacheProducer != nullptr) {
+                    file.codeCache = codeCacheProducer(file.fullPath, file.content);
+                }
+            }
+
+            it = indices.emplace(file.fullPath, files.size()).first;
+            files.push_back(std::move(file));
+        }
+        resolutions.emplace(std::move(key), it->second);
+    }
+
+    std::vector<std::string> ids;
+    for (const auto& file : files) {
+        ids.push_back(filesystem::Path(file.fullPath).Relative(directory).String());
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+    header.version = BUNDLE_VERSION;
+    header.flags = functionWrapperCodeCaches ? FUNCTION_WRAPPER_CODE_CACHES : 0;
+    header.moduleCount = files.size();
+    header.resolutionCount = resolutions.size();
+    header.modulesOffset = Align(sizeof(Header));
+
+    // Payloads follow all records, so opening a bundle reads only the records.
+    auto offset = header.modulesOffset;
+    for (const auto& id : ids) {
+        offset = Align(offset + sizeof(ModuleRecord) + id.size());
+    }
+    header.resolutionsOffset = offset;
+    for (const auto& resolution : resolutions) {
+        offset = Align(offset + sizeof(ResolutionRecord) + resolution.first.size());
+    }
+    header.payloadsOffset = offset;
+    for (const auto& file : files) {
+        offset += file.content.size() + (file.codeCache != nullptr ? file.codeCache->size() : 0);
+    }
+    header.fileSize = offset;
+
+    // Written to a temporary file first, so a failed save never leaves a partial bundle at the path.
+    std::string temporaryPath = std::string(path) + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            error = "Failed to open \"" + temporaryPath + "\" for writing.";
+            return false;
+        }
+
+        const char padding[8] = {};
+        auto pad = [&file, &padding](uint64_t written) {
+            file.write(padding, static_cast<std::streamsize>(Align(written) - written));
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        pad(sizeof(Header));
+
+        auto payloadOffset = header.payloadsOffset;
+        for (size_t i = 0; i < files.size(); ++i) {
+            ModuleRecord record = {};
+            record.type = static_cast<uint32_t>(files[i].type);
+            record.idLength = static_cast<uint32_t>(ids[i].size());
+            record.sourceOffset = payloadOffset;
+            record.sourceLength = files[i].content.size();
+            payloadOffset += record.sourceLength;
+            if (files[i].codeCache != nullptr) {
+                record.codeCacheOffset = payloadOffset;
+                record.codeCacheLength = files[i].codeCache->size();
+                payloadOffset += record.codeCacheLength;
+            }
+
+            file.write(reinterpret_cast<const char*>(&record), sizeof(ModuleRecord));
+            file.write(ids[i].data(), static_cast<std::streamsize>(ids[i].size()));
+            pad(sizeof(ModuleRecord) + ids[i].size());
+        }
+
+        for (const auto& resolution : resolutions) {
+            ResolutionRecord record = {};
+            record.module = resolution.second;
+            record.keyLength = static_cast<uint32_t>(resolution.first.size());
+
+            file.write(reinterpret_cast<const char*>(&record), sizeof(ResolutionRecord));
+            file.write(resolution.first.data(), static_cast<std::streamsize>(resolution.first.size()));
+            pad(sizeof(ResolutionRecord) + resolution.first.size());
+        }
+
+        for (const auto& module : files) {
+            file.write(module.content.data(), static_cast<std::streamsize>(module.content.size()));
+            if (module.codeCache != nullptr) {
+                file.write(reinterpret_cast<const char*>(module.codeCache->data()), static_cast<std::streamsize>(module.codeCache->size()));
+            }
+        }
+
+        if (!file.flush()) {
+            error = "Failed to write \"" + temporaryPath + "\".";
+            return false;
+        }
+    }
+
+    std::remove(path);
+    if (std::rename(temporaryPath.c_str(), path) != 0) {
+        std::remove(temporaryPath.c_str());
+        error = "Failed to move the bundle to \"" + std::string(path) + "\".";
+        return false;
+    }
+
+    moduleCount = files.size();
+    return true;
+}
+
+std::shared_ptr<ModuleBundle> ModuleBundle::Open(const char* path, std::string& error) {
+    auto file = platform::MappedFile::Open(path);
+    if (file == nullptr) {
+        error = "Failed to map \"" + std::string(path) + "\".";
+        return nullptr;
+    }
+
+    auto data = file->GetData();
+    auto size = file->GetSize();
+
+    Header header;
+    if (size < sizeof(Header)) {
+        error = "\"" + std::string(path) + "\" is not a module bundle.";
+        return nullptr;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0) {
+        error = "\"" + std::string(path) + "\" is not a module bundle.";
+        return nullptr;
+    }
+    if (header.version != BUNDLE_VERSION) {
+        error = "Module bundle \"" + std::string(path) + "\" has unsupported version " + std::to_string(header.version) + ".";
+        return nullptr;
+    }
+
+    const auto corrupted = "Module bundle \"" + std::string(path) + "\" is truncated or corrupted.";
+    if (header.fileSize != size
+        || header.modulesOffset < sizeof(Header)
+        || header.modulesOffset > header.resolutionsOffset
+        || header.resolutionsOffset > header.payloadsOffset
+        || header.payloadsOffset > size) {
+        error = corrupted;
+        return nullptr;
+    }
+
+    auto bundle = std::make_shared<ModuleBundle>();
+    bundle->_directory = filesystem::Path(path).Absolute().Parent();
+    bundle->_functionWrapperCodeCaches = (header.flags & FUNCTION_WRAPPER_CODE_CACHES) != 0;
+
+    // Records are validated once here, so modules can be served without checks.
+    auto offset = header.modulesOffset;
+    for (uint64_t i = 0; i < header.moduleCount; ++i) {
+        if (offset + sizeof(ModuleRecord) > header.resolutionsOffset) {
+            error = corrupted;
+            return nullptr;
+        }
+        auto record = reinterpret_cast<const ModuleRecord*>(data + offset);
+        offset = Align(offset + sizeof(ModuleRecord) + record->idLength);
+        if (offset > header.resolutionsOffset
+            || (record->type != static_cast<uint32_t>(ModuleType::JAVASCRIPT) && record->type != static_cast<uint32_t>(ModuleType::JSON))
+            || record->sourceOffset < header.payloadsOffset
+            || record->sourceLength > size - record->sourceOffset
+            || (record->codeCacheLength > 0
+                && (record->codeCacheOffset < header.payloadsOffset || record->codeCacheLength > size - record->codeCacheOffset))) {
+            error = corrupted;
+            return nullptr;
+        }
+
+        std::string id(reinterpret_cast<const char*>(record + 1), record->idLength);
+        Module module{
+            static_cast<ModuleType>(record->type),
+            (bundle->_directory / id).Normalize().String(),
+            data + record->sourceOffset,
+            static_cast<size_t>(record->sourceLength),
+            record->codeCacheLength > 0 ? reinterpret_cast<const uint8_t*>(data + record->codeCacheOffset) : nullptr,
+            static_cast<size_t>(record->codeCacheLength)
+        };
+        bundle->_paths.emplace(module.fullPath, bundle->_modules.size());
+        bundle->_modules.push_back(std::move(module));
+    }
+
+    for (uint64_t i = 0; i < header.resolutionCount; ++i) {
+        if (offset + sizeof(ResolutionRecord) > header.payloadsOffset) {
+            error = corrupted;
+            return nullptr;
+        }
+        auto record = reinterpret_cast<const ResolutionRecord*>(data + offset);
+        offset = Align(offset + sizeof(ResolutionRecord) + record->keyLength);
+        if (offset > header.payloadsOffset || record->module >= header.moduleCount) {
+            error = corrupted;
+            return nullptr;
+        }
+        bundle->_resolutions.emplace(std::string(reinterpret_cast<const char*>(record + 1), record->keyLength),
+                                     static_cast<size_t>(record->module));
+    }
+
+    bundle->_sources.resize(bundle->_modules.size());
+    bundle->_file = std::move(file);
+    return bundle;
+}
+
+std::shared_ptr<const ModuleBundle> ModuleBundle::GetLoaded() {
+    return std::atomic_load(&_loadedBundle);
+}
+
+void ModuleBundle::SetLoaded(std::shared_ptr<const ModuleBundle> bundle) {
+    std::atomic_store(&_loadedBundle, std::move(bundle));
+}
+
+const ModuleBundle::Module* ModuleBundle::Resolve(const std::string& name, const filesystem::Path& basePath) const {
+    auto it = _resolutions.find(GetResolutionKey(name, basePath));
+    return it != _resolutions.end() ? &_modules[it->second] : nullptr;
+}
+
+const ModuleBundle::Module* ModuleBundle::Find(const std::string& fullPath) const {
+    auto it = _paths.find(fullPath);
+    return it != _paths.end() ? &_modules[it->second] : nullptr;
+}
+
+std::shared_ptr<const std::string> ModuleBundle::GetSource(const Module& module,
+                                                           const std::string& header,
+                                                           const std::string& footer,
+                                                           bool& ascii) const {
+    auto& source = _sources[static_cast<size_t>(&module - _modules.data())];
+
+    std::lock_guard<std::mutex> lock(_lock);
+    if (source.text == nullptr || source.header != header || source.footer != footer) {
+        auto text = std::make_shared<std::string>();
+        text->reserve(header.size() + module.sourceLength + footer.size());
+        text->append(header).append(module.source, module.sourceLength).append(footer);
+
+        source = Source{ header, footer, ModuleSourceCache::IsAscii(module.source, module.sourceLength), std::move(text) };
+    }
+
+    ascii = source.ascii;
+    return source.text;
+}
+
+std::string ModuleBundle::GetResolutionKey(const std::string& name, const filesystem::Path& basePath) const {
+    return MakeResolutionKey(name, basePath, _directory);
+}
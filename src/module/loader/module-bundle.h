@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "module-resolver.h"
+
+#include <napa/exports.h>
+#include <platform/filesystem.h>
+#include <platform/mapped-file.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Read-only bundle of Javascript and JSON modules with their resolutions, which is mapped into memory. </summary>
+    /// <remarks>
+    ///     A bundle holds the modules that its entries require, directly or not, with the resolution of each require() call
+    ///     found in their sources, and optionally their code caches. Once loaded, modules and resolutions in the bundle are
+    ///     served without file system access, others are still resolved and read from files.
+    ///     Module paths and context directories are kept relative to the directory of the bundle, so a bundle can be moved
+    ///     together with the files it was saved from. Integers are in native byte order, and code caches are for the V8
+    ///     version of the saving process, so a bundle is meant to be loaded by the same build on the same architecture.
+    /// </remarks>
+    class NAPA_API ModuleBundle {
+    public:
+
+        /// <summary> A module of the bundle. </summary>
+        struct Module {
+            /// <summary> JAVASCRIPT or JSON. </summary>
+            ModuleType type;
+
+            /// <summary> Full path of the module, as if it was resolved from files next to the bundle. </summary>
+            std::string fullPath;
+
+            /// <summary> Content of the module file, in the mapped bundle. </summary>
+            const char* source;
+            size_t sourceLength;
+
+            /// <summary> V8 code cache of a Javascript module, in the mapped bundle, nullptr if none. </summary>
+            const uint8_t* codeCache;
+            size_t codeCacheLength;
+        };
+
+        /// <summary> Produces the code cache of a Javascript module, nullptr if it doesn't compile. </summary>
+        typedef std::function<std::shared_ptr<const std::vector<uint8_t>>(const std::string& path, const std::string& content)> CodeCacheProducer;
+
+        /// <summary> Writes a bundle of the modules that entries require, directly or not. </summary>
+        /// <param name="path"> Path of the bundle file. </param>
+        /// <param name="entries"> Names of the entry modules, resolved from the current directory. </param>
+        /// <param name="codeCacheProducer"> Produces code caches of Javascript modules, null to bundle none. </param>
+        /// <param name="functionWrapperCodeCaches"> Whether code caches are produced for modules loaded as function wrappers. </param>
+        /// <param name="moduleCount"> Number of bundled modules. </param>
+        /// <returns> True on success, otherwise false with error set. </returns>
+        /// <remarks> Modules are found by require() calls with a string literal, others are loaded from files at run time. </remarks>
+        static bool Save(const char* path,
+                         const std::vector<std::string>& entries,
+                         const CodeCacheProducer& codeCacheProducer,
+                         bool functionWrapperCodeCaches,
+                         size_t& moduleCount,
+                         std::string& error);
+
+        /// <summary> Maps a bundle and reads its modules and resolutions. </summary>
+        /// <returns> The bundle, or nullptr with error set if the file can't be mapped or isn't a valid bundle. </returns>
+        static std::shared_ptr<ModuleBundle> Open(const char* path, std::string& error);
+
+        /// <summary> Gets the bundle that modules of all zones are served from, nullptr if none. </summary>
+        static std::shared_ptr<const ModuleBundle> GetLoaded();
+
+        /// <summary> Sets the bundle that modules of all zones are served from, nullptr for none. </summary>
+        static void SetLoaded(std::shared_ptr<const ModuleBundle> bundle);
+
+        /// <summary> Resolves a require() call that was found in a module of the bundle or was an entry. </summary>
+        /// <param name="name"> Module name or path. </param>
+        /// <param name="basePath"> The directory it's required from. </param>
+        /// <returns> The bundled module, nullptr if the bundle doesn't know the resolution. </returns>
+        const Module* Resolve(const std::string& name, const filesystem::Path& basePath) const;
+
+        /// <summary> Finds a bundled module by its full path. </summary>
+        /// <returns> The bundled module, nullptr if the path isn't in the bundle. </returns>
+        const Module* Find(const std::string& fullPath) const;
+
+        /// <summary> Gets the source of a bundled module wrapped in a header and footer, shared by all isolates. </summary>
+        /// <param name="module"> The bundled module. </param>
+        /// <param name="header"> The text the source starts with, empty if not wrapped. </param>
+        /// <param name="footer"> The text the source ends with, empty if not wrapped. </param>
+        /// <param name="ascii"> Whether the source is ASCII, so V8 can use it as a one-byte string as is. </param>
+        std::shared_ptr<const std::string> GetSource(const Module& module,
+                                                     const std::string& header,
+                                                     const std::string& footer,
+                                                     bool& ascii) const;
+
+        /// <summary> Whether code caches are for modules loaded as function wrappers. </summary>
+        bool HasFunctionWrapperCodeCaches() const {
+            return _functionWrapperCodeCaches;
+        }
+
+        /// <summary> Gets the number of bundled modules. </summary>
+        size_t GetModuleCount() const {
+            return _modules.size();
+        }
+
+    private:
+
+        /// <summary> Gets the key of a resolution, made of the context directory relative to the bundle and the name. </summary>
+        std::string GetResolutionKey(const std::string& name, const filesystem::Path& basePath) const;
+
+        struct Source {
+            std::string header;
+            std::string footer;
+            bool ascii;
+            std::shared_ptr<const std::string> text;
+        };
+
+        std::unique_ptr<platform::MappedFile> _file;
+        filesystem::Path _directory;
+        bool _functionWrapperCodeCaches = false;
+        std::vector<Module> _modules;
+        std::unordered_map<std::string, size_t> _paths;
+        std::unordered_map<std::string, size_t> _resolutions;
+
+        mutable std::vector<Source> _sources;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -2,6 +2,7 @@
 // Licensed under the MIT license.
 
 #include "module-cache.h"
+#include "module-versions.h"
 
 #include <unordered_map>
 
@@ -9,7 +10,17 @@ using namespace napa;
 using namespace napa::module;
 
 using PersistentModule = v8::Persistent<v8::Object, v8::CopyablePersistentTraits<v8::Object>>;
-using PersistentModuleCache = std::unordered_map<std::string, PersistentModule>;
+
+/// <summary> A cached module with its version. </summary>
+struct CachedModule {
+    PersistentModule module;
+    uint64_t version;
+
+    /// <summary> The last generation the version was found current at, to skip the check while no module is invalidated. </summary>
+    uint64_t generation;
+};
+
+using PersistentModuleCache = std::unordered_map<std::string, CachedModule>;
 
 struct ModuleCache::ModuleCacheImpl {
     /// <summary> Module cache to avoid module loading overhead. </summary>
@@ -30,7 +41,19 @@ std::string NormalizeCacheKey(const std::string& path) {
     return path;
 }
 
+ModuleCache::Version ModuleCache::GetVersion(const std::string& path) {
+    auto& moduleVersions = ModuleVersions::GetInstance();
+
+    // The generation is taken first, so an invalidation in between makes the version checked again.
+    auto generation = moduleVersions.GetGeneration();
+    return Version{ generation, moduleVersions.GetVersion(NormalizeCacheKey(path)) };
+}
+
 void ModuleCache::Upsert(const std::string& path, v8::Local<v8::Object> module) {
+    Upsert(path, module, GetVersion(path));
+}
+
+void ModuleCache::Upsert(const std::string& path, v8::Local<v8::Object> module, const Version& version) {
     if (module.IsEmpty()) {
         return;
     }
@@ -42,12 +65,12 @@ void ModuleCache::Upsert(const std::string& path, v8::Local<v8::Object> module)
     auto iter = _impl->moduleCache.find(key);
     if (iter != _impl->moduleCache.end()) {
         // If exists, reset it and override with new module.
-        iter->second.Reset();
-        iter->second = PersistentModule(isolate, module);
+        iter->second.module.Reset();
+        iter->second.module = PersistentModule(isolate, module);
+        iter->second.version = version.version;
+        iter->second.generation = version.generation;
     } else {
-        _impl->moduleCache.emplace(std::piecewise_construct,
-                                   std::forward_as_tuple(key),
-                                   std::forward_as_tuple(isolate, module));
+        _impl->moduleCache.emplace(key, CachedModule{ PersistentModule(isolate, module), version.version, version.generation });
     }
 }
 
@@ -60,6 +83,16 @@ bool ModuleCache::TryGet(const std::string& path, v8::Local<v8::Object>& module)
         return false;
     }
 
-    module = v8::Local<v8::Object>::New(isolate, iter->second);
+    auto& moduleVersions = ModuleVersions::GetInstance();
+    auto generation = moduleVersions.GetGeneration();
+    if (iter->second.generation != generation) {
+        if (moduleVersions.GetVersion(key) != iter->second.version) {
+            // The module is loaded again, and replaces this entry.
+            return false;
+        }
+        iter->second.generation = generation;
+    }
+
+    module = v8::Local<v8::Object>::New(isolate, iter->second.module);
     return true;
 }
\ No newline at end of file
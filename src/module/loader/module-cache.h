@@ -5,15 +5,30 @@
 
 #include <napa/module/module-internal.h>
 
+#include <cstdint>
 #include <memory>
 
 namespace napa {
 namespace module {
 
     /// <summary> Module cache to avoid module loading overhead. </summary>
+    /// <remarks> Modules are cached with their version, and aren't returned once invalidated, see ModuleVersions. </remarks>
     class ModuleCache {
     public:
 
+        /// <summary> Version of a module at load time, see ModuleVersions. </summary>
+        struct Version {
+            /// <summary> Number of module invalidations in the process, when the version was taken. </summary>
+            uint64_t generation;
+
+            /// <summary> Version of the module. </summary>
+            uint64_t version;
+        };
+
+        /// <summary> Gets the current version of a module, to take before loading it. </summary>
+        /// <param name="path"> The module name path. </param>
+        static Version GetVersion(const std::string& path);
+
         /// <summary> Constructor. </summary>
         ModuleCache();
 
@@ -28,15 +43,21 @@ namespace module {
         ModuleCache(ModuleCache&&) = default;
         ModuleCache& operator=(ModuleCache&&) = default;
 
-        /// <summary> It inserts or updates a module into cache using path as a key. </summary>
+        /// <summary> It inserts or updates a module into cache using path as a key, at the current version of the module. </summary>
         /// <param name="path"> The module name path. </param>
         /// <param name="module"> V8 representative javascript object to be cached. </param>
         void Upsert(const std::string& path, v8::Local<v8::Object> module);
 
+        /// <summary> It inserts or updates a module into cache using path as a key. </summary>
+        /// <param name="path"> The module name path. </param>
+        /// <param name="module"> V8 representative javascript object to be cached. </param>
+        /// <param name="version"> The version taken before loading the module, so an invalidation while loading isn't missed. </param>
+        void Upsert(const std::string& path, v8::Local<v8::Object> module, const Version& version);
+
         /// <summary> A helper to load a module from cache. </summary>
         /// <param name="path"> Full path of javascript or napa module. </param>
         /// <param name="module"> Cached module if successful. </param>
-        /// <returns> True if it finds successfully. False, otherwise. </returns>
+        /// <returns> True if it finds successfully. False if it's not cached, or was invalidated since it was cached. </returns>
         bool TryGet(const std::string& path, v8::Local<v8::Object>& module) const;
 
     private:
@@ -13,6 +13,9 @@ namespace module {
 
     using BuiltInModulesSetter = std::function<void (v8::Local<v8::Context> context)>;
 
+    /// <summary> Creates the 'require' function of a module, which resolves paths relative to the module. </summary>
+    using RequireFactory = std::function<v8::Local<v8::Function> (v8::Local<v8::Object> module)>;
+
     /// <summary> Interface to load a module from file. </summary>
     class ModuleFileLoader {
     public:
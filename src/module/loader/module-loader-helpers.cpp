@@ -2,6 +2,8 @@
 // Licensed under the MIT license.
 
 #include "module-loader-helpers.h" 
+#include "module-bundle.h"
+#include "module-source-cache.h"
 
 #include <module/core-modules/node/file-system-helpers.h>
 #include <platform/dll.h>
@@ -21,6 +23,23 @@ using namespace napa::module;
 
 namespace {
 
+    /// <summary> External string resource of a module source shared by isolates. </summary>
+    class SharedSourceResource : public v8::String::ExternalOneByteStringResource {
+    public:
+        explicit SharedSourceResource(std::shared_ptr<const std::string> source) : _source(std::move(source)) {}
+
+        const char* data() const override {
+            return _source->data();
+        }
+
+        size_t length() const override {
+            return _source->size();
+        }
+
+    private:
+        std::shared_ptr<const std::string> _source;
+    };
+
     /// <summary> Set up __dirname and __filename at V8 context. </summary>
     /// <param name="exports"> Object to set module paths. </param>
     /// <param name="dirname"> Module directory name. </param>
@@ -133,6 +152,21 @@ void module_loader_helpers::SetupModuleContext(v8::Local<v8::Context> parentCont
     (void)exports->Set(v8_helpers::MakeV8String(isolate, "global"), global);
 }
 
+v8::Local<v8::Object> module_loader_helpers::CreateModuleObject(const std::string& id) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+
+    auto context = isolate->GetCurrentContext();
+
+    auto module = v8::Object::New(isolate);
+    (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "exports"), v8::Object::New(isolate));
+    (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "paths"), v8::Array::New(isolate));
+    (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "id"), v8_helpers::MakeV8String(isolate, id));
+    (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "filename"), v8_helpers::MakeV8String(isolate, id));
+
+    return scope.Escape(module);
+}
+
 std::vector<module_loader_helpers::CoreModuleInfo> module_loader_helpers::ReadCoreModulesJson() {
     static const std::string CORE_MODULES_JSON_PATH =
         (filesystem::Path(GetLibDirectory()) / "core" / "core-modules.json").String();
@@ -169,6 +203,18 @@ v8::Local<v8::String> module_loader_helpers::ReadModuleFile(const std::string& p
     auto isolate = v8::Isolate::GetCurrent();
     v8::EscapableHandleScope scope(isolate);
 
+    auto bundle = ModuleBundle::GetLoaded();
+    auto bundled = bundle != nullptr ? bundle->Find(path) : nullptr;
+    if (bundled != nullptr) {
+        JS_ENSURE_WITH_RETURN(isolate,
+                              bundled->sourceLength > 0,
+                              scope.Escape(v8::Local<v8::String>()),
+                              "\"%s\" is empty",
+                              path.c_str());
+
+        return scope.Escape(v8_helpers::MakeV8String(isolate, bundled->source, static_cast<int>(bundled->sourceLength)));
+    }
+
     std::string content;
     try {
         content = file_system_helpers::ReadFileSync(path);
@@ -186,6 +232,51 @@ v8::Local<v8::String> module_loader_helpers::ReadModuleFile(const std::string& p
     return scope.Escape(v8_helpers::MakeV8String(isolate, content));
 }
 
+v8::Local<v8::String> module_loader_helpers::ReadModuleFile(const std::string& path,
+                                                            const std::string& header,
+                                                            const std::string& footer,
+                                                            std::shared_ptr<const std::string>& sharedSource) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+
+    // Sources of a loaded bundle are shared by isolates as well, whatever their size.
+    auto bundle = ModuleBundle::GetLoaded();
+    auto bundled = bundle != nullptr ? bundle->Find(path) : nullptr;
+    if (bundled != nullptr) {
+        bool ascii;
+        sharedSource = bundle->GetSource(*bundled, header, footer, ascii);
+        if (!ascii) {
+            return scope.Escape(v8_helpers::MakeV8String(isolate, *sharedSource));
+        }
+    } else {
+        try {
+            sharedSource = ModuleSourceCache::GetInstance().Get(path, header, footer);
+        } catch (const std::exception& ex) {
+            isolate->ThrowException(v8::Exception::Error(v8_helpers::MakeV8String(isolate, ex.what())));
+            return scope.Escape(v8::Local<v8::String>());
+        }
+    }
+
+    if (sharedSource != nullptr) {
+        // V8 deletes the resource once the string is collected, which releases the source when no isolate uses it.
+        auto resource = new SharedSourceResource(sharedSource);
+        v8::Local<v8::String> source;
+        if (v8::String::NewExternalOneByte(isolate, resource).ToLocal(&source)) {
+            return scope.Escape(source);
+        }
+        delete resource;
+        sharedSource = nullptr;
+    }
+
+    auto content = ReadModuleFile(path);
+    if (content.IsEmpty()) {
+        return scope.Escape(content);
+    }
+    return scope.Escape(v8::String::Concat(
+        v8::String::Concat(v8_helpers::MakeV8String(isolate, header), content),
+        v8_helpers::MakeV8String(isolate, footer)));
+}
+
 namespace {
 
     void SetupModulePath(v8::Local<v8::Object> exports, const std::string& dirname, const std::string& filename) {
@@ -206,11 +297,7 @@ namespace {
 
         auto context = isolate->GetCurrentContext();
 
-        auto module = v8::Object::New(isolate);
-        (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "exports"), v8::Object::New(isolate));
-        (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "paths"), v8::Array::New(isolate));
-        (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "id"), v8_helpers::MakeV8String(isolate, id));
-        (void)module->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "filename"), v8_helpers::MakeV8String(isolate, id));
+        auto module = module_loader_helpers::CreateModuleObject(id);
 
         // Setup 'module.require'.
         if (!parentContext.IsEmpty()) {
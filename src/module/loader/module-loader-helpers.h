@@ -6,6 +6,8 @@
 #include <napa/module/module-internal.h>
 #include <vector>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace napa {
@@ -69,11 +71,26 @@ namespace module_loader_helpers {
     /// <summary> It reads javascript core module information. </summary>
     std::vector<CoreModuleInfo> ReadCoreModulesJson();
 
+    /// <summary> It creates a 'module' object with empty exports. </summary>
+    /// <param name="id"> Module id, which is also its file name. </param>
+    v8::Local<v8::Object> CreateModuleObject(const std::string& id);
+
     /// <summary> It reads a module file to javascript string. </summary>
     /// <param name="path"> File path to read. </param>
     /// <returns> V8 string containing file content. </returns>
     v8::Local<v8::String> ReadModuleFile(const std::string& path);
 
+    /// <summary> It reads a module file to javascript string, wrapped by a header and a footer. </summary>
+    /// <param name="path"> File path to read. </param>
+    /// <param name="header"> Text to prepend to the file content. </param>
+    /// <param name="footer"> Text to append to the file content. </param>
+    /// <param name="sharedSource"> Receives the source text if the string is shared with other isolates, nullptr otherwise. </param>
+    /// <returns> V8 string of the wrapped file content, which is external if it's shared. </returns>
+    v8::Local<v8::String> ReadModuleFile(const std::string& path,
+                                         const std::string& header,
+                                         const std::string& footer,
+                                         std::shared_ptr<const std::string>& sharedSource);
+
 }   // End of namespace module_loader_helpers.
 }   // End of namespace module
 }   // End of namespace napa
\ No newline at end of file
@@ -10,22 +10,32 @@
 #include "module-cache.h"
 #include "module-loader-helpers.h"
 #include "module-resolver.h"
+#include "module-versions.h"
+#include "wasm-module-loader.h"
 
 #include <module/core-modules/core-modules.h>
 #include <platform/filesystem.h>
 #include <utils/debug.h>
 
 // TODO: decouple dependencies between module-loader and zone.
+#include <zone/tracing.h>
 #include <zone/worker-context.h>
 
 #include <napa/log.h>
 #include <napa/module.h>
 
+#include <atomic>
+#include <unordered_map>
 #include <unordered_set>
 
 using namespace napa;
 using namespace napa::module;
 
+namespace {
+    /// <summary> Whether new module loaders load Javascript modules as function wrappers. </summary>
+    std::atomic<bool> _functionWrappers(false);
+}   // End of anonymous namespace.
+
 /// <summary> Implementation of module loader. </summary>
 /// <remarks>
 /// It has three kinds of core modules.
@@ -35,11 +45,12 @@ using namespace napa::module;
 ///     If javascript core file exists, it overrides binary core module.
 /// Binary core module:
 ///     It can be accessed with only process.binding(), not with require().
-///     It's cached at only binding cache.
+///     It's cached at only binding cache, and initialized when it's first accessed.
 /// Javascript core module:
 ///     It exists as Javascript file at './lib' or '../lib' directory.
 ///     It can be accessed with only require() and cached at only module cache.
 ///     If javascript core file exists, it overrides binary core module.
+///     It's loaded when it's first required, unless it's a built-in module.
 /// </remarks>
 class ModuleLoader::ModuleLoaderImpl {
 public:
@@ -47,6 +58,9 @@ public:
     /// <summary> Constructor. </summary>
     ModuleLoaderImpl();
 
+    /// <summary> Replaces the code caches of loaded Javascript modules with warm ones. </summary>
+    size_t WarmCodeCaches();
+
     /// <summary> Bootstrap core modules into module loader. </summary>
     /// <remarks>
     /// Bootstraping must be done after module loader is created and registered into isolate data
@@ -78,14 +92,30 @@ private:
     /// <param name="name"> Module name. </param>
     /// <param name="isBuiltInModule"> True if it's a built-in module, which doesn't need require() to call. </param>
     /// <param name="initializer"> Module initialization function. </param>
+    /// <remarks> Built-in modules are initialized right away, others when they are first accessed. </remarks>
     void LoadBinaryCoreModule(const char* name,
                               bool isBuiltInModule,
                               const napa::module::ModuleInitializer& initializer);
 
+    /// <summary> It initializes a binary core module in its own context. </summary>
+    /// <param name="initializer"> Module initialization function. </param>
+    /// <returns> Exports of the binary core module. </returns>
+    v8::Local<v8::Object> InitializeBinaryCoreModule(const napa::module::ModuleInitializer& initializer);
+
+    /// <summary> It gets a binary core module, which is initialized at the first access. </summary>
+    /// <param name="name"> Module name. </param>
+    /// <param name="module"> Binary core module if successful. </param>
+    /// <returns> True if the binary core module exists, false otherwise. </returns>
+    bool TryGetBinding(const std::string& name, v8::Local<v8::Object>& module);
+
     /// <summary> It sets up built-in modules at each module's' context. </summary>
     /// <param name="context"> V8 context. </param>
     void SetupBuiltInModules(v8::Local<v8::Context> context);
 
+    /// <summary> It creates the 'require' function of a function wrapped module. </summary>
+    /// <param name="module"> The module object, 'require' resolves paths relative to its file name. </param>
+    static v8::Local<v8::Function> CreateRequire(v8::Local<v8::Object> module);
+
     /// <summary> It sets up require function. </summary>
     /// <param name="context"> V8 context. </param>
     void SetupRequire(v8::Local<v8::Context> context);
@@ -101,6 +131,9 @@ private:
     /// <summary> Cache for core binary modules, which can be accessed by process.binding(). </summary>
     ModuleCache _bindingCache;
 
+    /// <summary> Initialization functions of core binary modules, which are not accessed yet. </summary>
+    std::unordered_map<std::string, napa::module::ModuleInitializer> _pendingBindings;
+
     /// <summary> Module resolver to resolve module path. </summary>
     ModuleResolver _resolver;
 
@@ -123,6 +156,39 @@ void ModuleLoader::CreateModuleLoader() {
     NAPA_DEBUG("ModuleLoader", "Module loader is created successfully.");
 }
 
+void ModuleLoader::DestroyModuleLoader() {
+    auto moduleLoader = reinterpret_cast<ModuleLoader*>(zone::WorkerContext::Get(zone::WorkerContextItem::MODULE_LOADER));
+    if (moduleLoader != nullptr) {
+        delete moduleLoader;
+        zone::WorkerContext::Set(zone::WorkerContextItem::MODULE_LOADER, nullptr);
+    }
+
+    auto napaBinding = reinterpret_cast<v8::Persistent<v8::Object>*>(
+        zone::WorkerContext::Get(zone::WorkerContextItem::NAPA_BINDING));
+    if (napaBinding != nullptr) {
+        napaBinding->Reset();
+        delete napaBinding;
+        zone::WorkerContext::Set(zone::WorkerContextItem::NAPA_BINDING, nullptr);
+    }
+
+    binding::ReleaseCache();
+    ReleasePersistentConstructors();
+    NAPA_DEBUG("ModuleLoader", "Module loader is destroyed.");
+}
+
+void ModuleLoader::SetFunctionWrappers(bool enabled) {
+    _functionWrappers = enabled;
+}
+
+bool ModuleLoader::HasFunctionWrappers() {
+    return _functionWrappers;
+}
+
+size_t ModuleLoader::WarmCodeCaches() {
+    auto moduleLoader = reinterpret_cast<ModuleLoader*>(zone::WorkerContext::Get(zone::WorkerContextItem::MODULE_LOADER));
+    return moduleLoader != nullptr ? moduleLoader->_impl->WarmCodeCaches() : 0;
+}
+
 ModuleLoader::ModuleLoader() : _impl(std::make_unique<ModuleLoader::ModuleLoaderImpl>()) {}
 
 ModuleLoader::~ModuleLoader() = default;
@@ -133,16 +199,29 @@ ModuleLoader::ModuleLoaderImpl::ModuleLoaderImpl() {
         SetupBuiltInModules(context);
     };
 
+    // Function wrapped modules share the worker context, which already has the built-in modules.
+    RequireFactory requireFactory = _functionWrappers ? RequireFactory(CreateRequire) : nullptr;
+
     // Set up module loaders for each module type.
     _loaders = {{
         nullptr,
-        std::make_unique<CoreModuleLoader>(builtInModulesSetter, _moduleCache, _bindingCache),
-        std::make_unique<JavascriptModuleLoader>(builtInModulesSetter, _moduleCache),
+        std::make_unique<CoreModuleLoader>(
+            builtInModulesSetter,
+            _moduleCache,
+            [this](const std::string& name, v8::Local<v8::Object>& module) { return TryGetBinding(name, module); },
+            requireFactory),
+        std::make_unique<JavascriptModuleLoader>(builtInModulesSetter, _moduleCache, requireFactory),
         std::make_unique<JsonModuleLoader>(),
-        std::make_unique<BinaryModuleLoader>(builtInModulesSetter)
+        std::make_unique<BinaryModuleLoader>(builtInModulesSetter),
+        std::make_unique<WasmModuleLoader>()
     }};
 }
 
+size_t ModuleLoader::ModuleLoaderImpl::WarmCodeCaches() {
+    auto& loader = _loaders[static_cast<size_t>(ModuleType::JAVASCRIPT)];
+    return static_cast<JavascriptModuleLoader*>(loader.get())->WarmCodeCaches();
+}
+
 void ModuleLoader::ModuleLoaderImpl::Bootstrap() {
     // Set up top-level context.
     module_loader_helpers::SetupTopLevelContext();
@@ -154,9 +233,9 @@ void ModuleLoader::ModuleLoaderImpl::Bootstrap() {
     // 'require' needs to be available in top-level context before core-module is loaded.
     SetupRequire(context);
 
-    // Initialize core modules listed in core-modules.h.
+    // Register core modules listed in core-modules.h.
     INITIALIZE_CORE_MODULES(LoadBinaryCoreModule)
-    NAPA_DEBUG("ModuleLoader", "Binary core modules are loaded.");
+    NAPA_DEBUG("ModuleLoader", "Binary core modules are registered.");
 
     // Set up built-in modules from binaries.
     SetupBuiltInModules(context);
@@ -184,6 +263,9 @@ void ModuleLoader::ModuleLoaderImpl::Bootstrap() {
                                          module);
         }
     }
+
+    // Built-in modules may have been replaced by JavaScript ones.
+    DecorateBuiltInModules(context);
     NAPA_DEBUG("ModuleLoader", "JavaScript core modules are loaded.");
 }
 
@@ -212,7 +294,16 @@ void ModuleLoader::ModuleLoaderImpl::ResolveCallback(const v8::FunctionCallbackI
     JS_ENSURE(isolate, moduleLoader != nullptr, "Module loader is not initialized");
 
     v8::String::Utf8Value path(args[0]);
-    auto contextDir = module_loader_helpers::GetCurrentContextDirectory();
+
+    // 'require.resolve' of a function wrapped module carries its module object.
+    std::string contextDir;
+    if (args.Data()->IsObject()) {
+        contextDir = module_loader_helpers::GetModuleDirectory(args.Data()->ToObject());
+    }
+
+    if (contextDir.empty()) {
+        contextDir = module_loader_helpers::GetCurrentContextDirectory();
+    }
 
     auto moduleInfo = moduleLoader->_impl->_resolver.Resolve(*path, contextDir.c_str());
     JS_ENSURE(isolate, moduleInfo.type != ModuleType::NONE, "Cannot find module \"%s\"", *path);
@@ -232,7 +323,7 @@ void ModuleLoader::ModuleLoaderImpl::BindingCallback(const v8::FunctionCallbackI
     v8::String::Utf8Value name(args[0]);
     v8::Local<v8::Object> module;
 
-    if (moduleLoader->_impl->_bindingCache.TryGet(*name, module)) {
+    if (moduleLoader->_impl->TryGetBinding(*name, module)) {
         args.GetReturnValue().Set(module);
         return;
     }
@@ -254,9 +345,12 @@ void ModuleLoader::ModuleLoaderImpl::RequireModule(const char* path, const v8::F
     auto arg = args.Length() == 1 ? v8::Local<v8::Value>() : args[1]; 
     bool fromContent = !arg.IsEmpty() && arg->IsString();
 
-    // If require is called with a module receiver, use module.filename to deduce context directory.
+    // 'require' of a function wrapped module carries its module object, otherwise if require is called with
+    // a module receiver, use module.filename to deduce context directory.
     std::string contextDir;
-    if (!args.Holder().IsEmpty()) {
+    if (args.Data()->IsObject()) {
+        contextDir = module_loader_helpers::GetModuleDirectory(args.Data()->ToObject());
+    } else if (!args.Holder().IsEmpty()) {
         contextDir = module_loader_helpers::GetModuleDirectory(args.Holder());
     }
 
@@ -294,7 +388,24 @@ void ModuleLoader::ModuleLoaderImpl::RequireModule(const char* path, const v8::F
     auto& loader = _loaders[static_cast<size_t>(moduleInfo.type)];
     JS_ENSURE(isolate, loader != nullptr, "No proper module loader is defined");
 
-    auto succeeded = loader->TryGet(moduleInfo.fullPath, arg, module);
+    // The version is taken before the file is read, so a change while loading makes the module load again.
+    ModuleCache::Version version = {};
+    if (!fromContent) {
+        version = ModuleCache::GetVersion(moduleInfo.fullPath);
+        if (moduleInfo.type == ModuleType::JAVASCRIPT || moduleInfo.type == ModuleType::JSON || moduleInfo.type == ModuleType::WASM) {
+            ModuleVersions::GetInstance().Watch(moduleInfo.fullPath);
+        }
+    }
+
+    bool succeeded;
+    {
+        zone::TraceScope traceScope(
+            "module",
+            "LoadModule",
+            static_cast<const char*>(zone::WorkerContext::Get(zone::WorkerContextItem::CALL_TRACE_ID)),
+            path);
+        succeeded = loader->TryGet(moduleInfo.fullPath, arg, module);
+    }
     if (!succeeded) {
         NAPA_DEBUG("ModuleLoader", "Cannot load module \"%s\".", path);
         args.GetReturnValue().SetUndefined();
@@ -304,7 +415,7 @@ void ModuleLoader::ModuleLoaderImpl::RequireModule(const char* path, const v8::F
     NAPA_DEBUG("ModuleLoader", "Loaded module from file (first time): \"%s\".", path);
 
     if (!fromContent) {
-        _moduleCache.Upsert(moduleInfo.fullPath, module);
+        _moduleCache.Upsert(moduleInfo.fullPath, module, version);
     }
     args.GetReturnValue().Set(module);
 }
@@ -313,8 +424,29 @@ void ModuleLoader::ModuleLoaderImpl::LoadBinaryCoreModule(
         const char* name,
         bool isBuiltInModule,
         const napa::module::ModuleInitializer& initializer) {
+    // Put it into module resolver to prevent from resolving as user module.
+    _resolver.SetAsCoreModule(name);
+
+    if (isBuiltInModule) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::HandleScope scope(isolate);
+
+        _builtInNames.emplace(name);
+
+        // Put core module into cache.
+        // This makes the same behavior with node.js, i.e. it must be loaded by 'require'.
+        _moduleCache.Upsert(name, InitializeBinaryCoreModule(initializer));
+    } else {
+        // It goes to binding cache at the first access by process.binding(), not by require().
+        // Most workers never touch most of them, so we save their contexts until then.
+        _pendingBindings[name] = initializer;
+    }
+}
+
+v8::Local<v8::Object> ModuleLoader::ModuleLoaderImpl::InitializeBinaryCoreModule(
+        const napa::module::ModuleInitializer& initializer) {
     auto isolate = v8::Isolate::GetCurrent();
-    v8::HandleScope scope(isolate);
+    v8::EscapableHandleScope scope(isolate);
 
     auto context = isolate->GetCurrentContext();
 
@@ -327,22 +459,28 @@ void ModuleLoader::ModuleLoaderImpl::LoadBinaryCoreModule(
 
     module_loader_helpers::SetupModuleContext(context, moduleContext, module_loader_helpers::GetNapaDllPath());
 
-    // Put it into module resolver to prevent from resolving as user module.
-    _resolver.SetAsCoreModule(name);
-
-    auto module = module_loader_helpers::ExportModule(moduleContext->Global(), initializer);
+    return scope.Escape(module_loader_helpers::ExportModule(moduleContext->Global(), initializer));
+}
 
-    if (isBuiltInModule) {
-        _builtInNames.emplace(name);
+bool ModuleLoader::ModuleLoaderImpl::TryGetBinding(const std::string& name, v8::Local<v8::Object>& module) {
+    if (_bindingCache.TryGet(name, module)) {
+        return true;
+    }
 
-        // Put core module into cache.
-        // This makes the same behavior with node.js, i.e. it must be loaded by 'require'.
-        _moduleCache.Upsert(name, module);
-    } else {
-        // Put into binding cache.
-        // It must be accessed by process.binding(), not by require().
-        _bindingCache.Upsert(name, module);
+    auto it = _pendingBindings.find(name);
+    if (it == _pendingBindings.end()) {
+        return false;
     }
+
+    // Initializer may access other binary core modules, so take it out first.
+    auto initializer = it->second;
+    _pendingBindings.erase(it);
+
+    module = InitializeBinaryCoreModule(initializer);
+    _bindingCache.Upsert(name, module);
+
+    NAPA_DEBUG("ModuleLoader", "Binary core module \"%s\" is initialized at first access.", name.c_str());
+    return true;
 }
 
 void ModuleLoader::ModuleLoaderImpl::SetupBuiltInModules(v8::Local<v8::Context> context) {
@@ -382,6 +520,18 @@ void ModuleLoader::ModuleLoaderImpl::SetupRequire(v8::Local<v8::Context> context
                                       resolveFunctionTemplate->GetFunction());
 }
 
+v8::Local<v8::Function> ModuleLoader::ModuleLoaderImpl::CreateRequire(v8::Local<v8::Object> module) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    auto require = v8::Function::New(context, RequireCallback, module).ToLocalChecked();
+    auto resolve = v8::Function::New(context, ResolveCallback, module).ToLocalChecked();
+    (void)require->CreateDataProperty(context, v8_helpers::MakeV8String(isolate, "resolve"), resolve);
+
+    return scope.Escape(require);
+}
+
 // If we have more decorations, move them out from this class.
 void ModuleLoader::ModuleLoaderImpl::DecorateBuiltInModules(v8::Local<v8::Context> context) {
     auto isolate = v8::Isolate::GetCurrent();
@@ -396,4 +546,17 @@ void ModuleLoader::ModuleLoaderImpl::DecorateBuiltInModules(v8::Local<v8::Contex
     (void)process->CreateDataProperty(context,
                                       v8_helpers::MakeV8String(isolate, "binding"),
                                       bindingFunctionTemplate->GetFunction());
+
+    // Timer functions are globals as in node.js, once the 'timers' core module is loaded.
+    auto timers = context->Global()->Get(context, v8_helpers::MakeV8String(isolate, "timers"));
+    if (!timers.IsEmpty() && timers.ToLocalChecked()->IsObject()) {
+        auto timersObject = timers.ToLocalChecked()->ToObject();
+        for (auto name : { "setTimeout", "clearTimeout", "setInterval", "clearInterval", "setImmediate", "clearImmediate" }) {
+            auto key = v8_helpers::MakeV8String(isolate, name);
+            auto function = timersObject->Get(context, key);
+            if (!function.IsEmpty() && function.ToLocalChecked()->IsFunction()) {
+                (void)context->Global()->CreateDataProperty(context, key, function.ToLocalChecked());
+            }
+        }
+    }
 }
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <napa/exports.h>
+
+#include <cstddef>
 #include <memory>
 
 namespace napa {
@@ -25,6 +28,31 @@ namespace module {
         /// </summary>
         #define CREATE_MODULE_LOADER napa::module::ModuleLoader::CreateModuleLoader
 
+        /// <summary>
+        /// It destroys the module loader of current thread, with the persistent handles that loaded modules hold in
+        /// worker context. It must be called before the isolate is disposed, if the thread goes on with a new isolate.
+        /// </summary>
+        static void DestroyModuleLoader();
+
+        /// <summary> A helper macro to destroy the module loader instance at current thread. </summary>
+        #define DESTROY_MODULE_LOADER napa::module::ModuleLoader::DestroyModuleLoader
+
+        /// <summary>
+        /// It sets whether Javascript modules are loaded as function wrappers in the calling context, like node.js does,
+        /// instead of a new context per module. It applies to module loaders created afterwards.
+        /// </summary>
+        static void SetFunctionWrappers(bool enabled);
+
+        /// <summary> It returns whether Javascript modules are loaded as function wrappers. </summary>
+        static NAPA_API bool HasFunctionWrappers();
+
+        /// <summary>
+        /// It replaces the code caches of Javascript modules loaded at current thread with warm ones, which hold the
+        /// functions compiled since, unless other isolates did already. Isolates loading the modules later consume them.
+        /// </summary>
+        /// <returns> The number of code caches replaced. </returns>
+        static size_t WarmCodeCaches();
+
         /// <summary> Non-copyable and Non-movable. </summary>
         ModuleLoader(const ModuleLoader&) = delete;
         ModuleLoader& operator=(const ModuleLoader&) = delete;
@@ -2,6 +2,8 @@
 // Licensed under the MIT license.
 
 #include "module-resolver.h"
+#include "module-bundle.h"
+#include "resolution-cache.h"
 
 #include <platform/filesystem.h>
 #include <platform/os.h>
@@ -14,7 +16,6 @@
 #include <rapidjson/istreamwrapper.h>
 
 #include <fstream>
-#include <sstream>
 #include <unordered_set>
 
 using namespace napa;
@@ -25,6 +26,27 @@ namespace {
     const std::string NAPA_MODULE_EXTENSION = ".napa";
     const std::string JAVASCRIPT_MODULE_EXTENSION = ".js";
     const std::string JSON_OBJECT_EXTENSION = ".json";
+    const std::string WASM_MODULE_EXTENSION = ".wasm";
+
+    const filesystem::Path NODE_MODULES_DIRECTORY("node_modules");
+    const filesystem::Path PACKAGE_JSON_FILE("package.json");
+    const filesystem::Path INDEX_FILE("index");
+
+    /// <summary> It checks whether a path ends with a given suffix, without making a string of its extension. </summary>
+    bool EndsWith(const std::string& path, const std::string& suffix) {
+        return path.size() >= suffix.size()
+            && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    /// <summary> It checks whether the last segment of a path is a given file name. </summary>
+    bool IsFilename(const std::string& path, const std::string& filename) {
+        if (!EndsWith(path, filename)) {
+            return false;
+        }
+        auto pos = path.size() - filename.size();
+        return pos == 0 || path[pos - 1] == '/' || path[pos - 1] == '\\';
+    }
+
 
 }   // End of anonymous namespace.
 
@@ -32,7 +54,7 @@ class ModuleResolver::ModuleResolverImpl {
 public:
 
     /// <summary> Constructor. </summary>
-    ModuleResolverImpl();
+    explicit ModuleResolverImpl(ResolutionCache& cache);
 
     /// <summary> It resolves a full module path from a given argument of require(). </summary>
     /// <param name="name"> Module name or path. </param>
@@ -87,30 +109,39 @@ private:
     /// <returns> Module resolution details. </returns>
     ModuleInfo LoadNodeModules(const filesystem::Path& name, const filesystem::Path& path);
 
-    /// <summary> It returns all possible node module paths. </summary>
-    /// <param name="path"> Base path. </param>
-    /// <returns> List of possible node_modules paths. </summary>
-    std::vector<std::string> GetNodeModulesPaths(const filesystem::Path& path);
-
     /// <summary> It tries the extension candidates. </summary>
     /// <param name="path"> Possible module path. </param>
     /// <returns> Module resolution details. </returns>
     /// <remarks> "path" argument is changed. </remarks>
-    ModuleInfo TryExtensions(const filesystem::Path& path);
+    ModuleInfo TryExtensions(filesystem::Path& path);
 
     /// <summary> It checks whether a path is relative. </summary>
     /// <param name="path"> Path. </param>
     /// <returns> True if a path is relative. </summary>
     bool IsExplicitRelativePath(const filesystem::Path& path) const;
 
+    /// <summary> Resolutions and file system lookups shared with other resolvers. </summary>
+    ResolutionCache& _cache;
+
     /// <summary> Registered modules. </summary>
     std::unordered_set<std::string> _coreModules;
 
     /// <summary> Paths in 'NODE_PATH' environment variable. </summary>
     std::vector<std::string> _nodePaths;
+
+    /// <summary>
+    ///     Candidate paths are computed in these buffers, which keep their capacity across calls,
+    ///     so probing a candidate doesn't allocate. A resolver is used by one thread only.
+    /// </summary>
+    filesystem::Path _candidate;
+    filesystem::Path _directory;
+    filesystem::Path _searchPath;
+    filesystem::Path _nodeModules;
 };
 
-ModuleResolver::ModuleResolver() : _impl(std::make_unique<ModuleResolver::ModuleResolverImpl>()) {}
+ModuleResolver::ModuleResolver() : ModuleResolver(ResolutionCache::GetInstance()) {}
+
+ModuleResolver::ModuleResolver(ResolutionCache& cache) : _impl(std::make_unique<ModuleResolver::ModuleResolverImpl>(cache)) {}
 
 ModuleResolver::~ModuleResolver() = default;
 
@@ -122,7 +153,7 @@ bool ModuleResolver::SetAsCoreModule(const char* name) {
     return _impl->SetAsCoreModule(name);
 }
 
-ModuleResolver::ModuleResolverImpl::ModuleResolverImpl() {
+ModuleResolver::ModuleResolverImpl::ModuleResolverImpl(ResolutionCache& cache) : _cache(cache) {
     auto envPath = platform::GetEnv("NODE_PATH");
     if (!envPath.empty()) {
         std::vector<std::string> nodePaths;
@@ -154,11 +185,28 @@ ModuleInfo ModuleResolver::ModuleResolverImpl::Resolve(const char* name, const c
     filesystem::Path basePath =
         (path == nullptr) ? filesystem::CurrentDirectory() : filesystem::Path(path);
 
-    // Look up from the given path.
-    RETURN_IF_NOT_EMPTY(ResolveFromPath(name, basePath));
+    // Requires found in a loaded bundle are resolved without file system access.
+    auto bundle = ModuleBundle::GetLoaded();
+    if (bundle != nullptr) {
+        auto bundled = bundle->Resolve(name, basePath);
+        if (bundled != nullptr) {
+            return ModuleInfo{bundled->type, bundled->fullPath, std::string()};
+        }
+    }
+
+    ModuleInfo moduleInfo;
+    if (_cache.TryGet(name, basePath.String(), moduleInfo)) {
+        return moduleInfo;
+    }
+
+    // Look up from the given path, then NODE_PATH.
+    moduleInfo = ResolveFromPath(name, basePath);
+    if (moduleInfo.type == ModuleType::NONE) {
+        moduleInfo = ResolveFromEnv(name, basePath);
+    }
 
-    // Look up NODE_PATH
-    return ResolveFromEnv(name, basePath);
+    _cache.Insert(name, basePath.String(), moduleInfo);
+    return moduleInfo;
 }
 
 bool ModuleResolver::ModuleResolverImpl::SetAsCoreModule(const char* name) {
@@ -200,33 +248,41 @@ bool ModuleResolver::ModuleResolverImpl::IsCoreModule(const std::string& module)
 
 ModuleInfo ModuleResolver::ModuleResolverImpl::LoadAsFile(const filesystem::Path& name,
                                                           const filesystem::Path& path) {
-    auto fullPath = (path / name).Normalize();
+    _candidate = path;
+    _candidate.Append(name).Normalize();
 
-    if (filesystem::IsRegularFile(fullPath)) {
+    if (_cache.IsRegularFile(_candidate)) {
         ModuleType type = ModuleType::JAVASCRIPT;
 
-        auto extension = fullPath.Extension().String();
-        if (extension == JSON_OBJECT_EXTENSION) {
+        const auto& fullPath = _candidate.String();
+        if (EndsWith(fullPath, JSON_OBJECT_EXTENSION)) {
             type = ModuleType::JSON;
-        } else if (extension == NAPA_MODULE_EXTENSION) {
+        } else if (EndsWith(fullPath, NAPA_MODULE_EXTENSION)) {
             type = ModuleType::NAPA;
+        } else if (EndsWith(fullPath, WASM_MODULE_EXTENSION)) {
+            type = ModuleType::WASM;
         }
 
-        return ModuleInfo{type, fullPath.String(), std::string()};
+        return ModuleInfo{type, fullPath, std::string()};
     }
 
-    return TryExtensions(fullPath);
+    return TryExtensions(_candidate);
 }
 
 ModuleInfo ModuleResolver::ModuleResolverImpl::LoadAsDirectory(const filesystem::Path& name,
                                                                const filesystem::Path& path) {
-    auto fullPath = (path / name).Normalize();
+    _directory = path;
+    _directory.Append(name).Normalize();
+
+    _candidate = _directory;
+    _candidate.Append(PACKAGE_JSON_FILE);
+    if (_cache.IsRegularFile(_candidate)) {
+        // LoadAsFile() reuses the candidate buffer, so keep the package.json path.
+        auto packageJson = _candidate.String();
 
-    auto packageJson = fullPath / "package.json";
-    if (filesystem::IsRegularFile(packageJson)) {
         rapidjson::Document package;
         try {
-            std::ifstream ifs(packageJson.String());
+            std::ifstream ifs(packageJson);
             rapidjson::IStreamWrapper isw(ifs);
             if (package.ParseStream(isw).HasParseError()) {
                 throw std::runtime_error(rapidjson::GetParseError_En(package.GetParseError()));
@@ -235,67 +291,57 @@ ModuleInfo ModuleResolver::ModuleResolverImpl::LoadAsDirectory(const filesystem:
             filesystem::Path mainPath(package["main"].GetString());
             mainPath.Normalize();
 
-            auto moduleInfo = LoadAsFile(mainPath, fullPath);
+            auto moduleInfo = LoadAsFile(mainPath, _directory);
             if (moduleInfo.type != ModuleType::NONE) {
-                moduleInfo.packageJsonPath = packageJson.String();
+                moduleInfo.packageJsonPath = std::move(packageJson);
                 return moduleInfo;
             }
         } catch (...) {}    // ignore exception and continue.
     }
 
-    fullPath = fullPath / "index";
-    return TryExtensions(fullPath);
+    _candidate = _directory;
+    _candidate.Append(INDEX_FILE);
+    return TryExtensions(_candidate);
 }
 
 ModuleInfo ModuleResolver::ModuleResolverImpl::LoadNodeModules(const filesystem::Path& name,
                                                                const filesystem::Path& path) {
-    auto modulePaths = GetNodeModulesPaths(path);
-    for (const auto& modulePath :modulePaths) {
-        // Load as a file (path + name).
-        RETURN_IF_NOT_EMPTY(LoadAsFile(name, modulePath));
-
-        // Load as a directory (path + name)
-        RETURN_IF_NOT_EMPTY(LoadAsDirectory(name, modulePath));
-    }
-
-    return ModuleInfo{ModuleType::NONE, std::string(), std::string()};
-}
-
-std::vector<std::string> ModuleResolver::ModuleResolverImpl::GetNodeModulesPaths(const filesystem::Path& path) {
-    std::vector<std::string> subpaths;
-    subpaths.reserve(256);
-
-    for (filesystem::Path subpath(path); !subpath.IsEmpty(); subpath = subpath.Parent().Normalize()) {
-        if (subpath.Filename().String() == "node_modules") {
+    // Walk up from the base path, trying each node_modules directory as soon as it's found.
+    for (_searchPath = path; !_searchPath.IsEmpty(); _searchPath.Append("..").Normalize()) {
+        if (IsFilename(_searchPath.String(), NODE_MODULES_DIRECTORY.String())) {
             continue;
         }
 
-        auto modulePath = subpath / "node_modules";
-        if (filesystem::IsDirectory(modulePath)) {
-            subpaths.emplace_back(modulePath.String());
+        _nodeModules = _searchPath;
+        _nodeModules.Append(NODE_MODULES_DIRECTORY);
+        if (!_cache.IsDirectory(_nodeModules)) {
+            continue;
         }
+
+        // Load as a file (path + name).
+        RETURN_IF_NOT_EMPTY(LoadAsFile(name, _nodeModules));
+
+        // Load as a directory (path + name)
+        RETURN_IF_NOT_EMPTY(LoadAsDirectory(name, _nodeModules));
     }
 
-    return subpaths;
+    return ModuleInfo{ModuleType::NONE, std::string(), std::string()};
 }
 
-ModuleInfo ModuleResolver::ModuleResolverImpl::TryExtensions(const filesystem::Path& path) {
-    std::ostringstream oss;
-    oss << path.String() << JAVASCRIPT_MODULE_EXTENSION;
-
-    auto modulePath = filesystem::Path(oss.str());
-    if (filesystem::IsRegularFile(modulePath)) {
-        return ModuleInfo{ModuleType::JAVASCRIPT, modulePath.String(), std::string()};
+ModuleInfo ModuleResolver::ModuleResolverImpl::TryExtensions(filesystem::Path& path) {
+    path.AddExtension(JAVASCRIPT_MODULE_EXTENSION);
+    if (_cache.IsRegularFile(path)) {
+        return ModuleInfo{ModuleType::JAVASCRIPT, path.String(), std::string()};
     }
 
-    modulePath.ReplaceExtension(JSON_OBJECT_EXTENSION);
-    if (filesystem::IsRegularFile(modulePath)) {
-        return ModuleInfo{ModuleType::JSON, modulePath.String(), std::string()};
+    path.ReplaceExtension(JSON_OBJECT_EXTENSION);
+    if (_cache.IsRegularFile(path)) {
+        return ModuleInfo{ModuleType::JSON, path.String(), std::string()};
     }
 
-    modulePath.ReplaceExtension(NAPA_MODULE_EXTENSION);
-    if (filesystem::IsRegularFile(modulePath)) {
-        return ModuleInfo{ModuleType::NAPA, modulePath.String(), std::string()};
+    path.ReplaceExtension(NAPA_MODULE_EXTENSION);
+    if (_cache.IsRegularFile(path)) {
+        return ModuleInfo{ModuleType::NAPA, path.String(), std::string()};
     }
 
     return ModuleInfo{ModuleType::NONE, std::string(), std::string()};
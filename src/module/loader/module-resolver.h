@@ -25,6 +25,9 @@ namespace module {
         /// <summary> Binary module. </summary>
         NAPA,
 
+        /// <summary> WebAssembly module, which is only resolved by its full file name. </summary>
+        WASM,
+
         /// <summary> End of module type. </summary>
         END_OF_MODULE_TYPE
     };
@@ -41,17 +44,25 @@ namespace module {
         std::string packageJsonPath;
     };
 
+    // forward declaration.
+    class ResolutionCache;
+
     /// <summary>
     /// It resolves a module path by the algorithm described at
     /// https://nodejs.org/api/modules.html#modules_all_together.
     /// One module loader has one module resolver, so each thread has its own instance of this class.
+    /// Resolutions are shared across threads through a resolution cache.
     /// </summary>
     class ModuleResolver {
     public:
 
-        /// <summary> Constructor. </summary>
+        /// <summary> Constructor, with the process-wide resolution cache. </summary>
         ModuleResolver();
 
+        /// <summary> Constructor. </summary>
+        /// <param name="cache"> Resolution cache. </param>
+        explicit ModuleResolver(ResolutionCache& cache);
+
         /// <summary> Default destructor. </summary>
         ~ModuleResolver();
 
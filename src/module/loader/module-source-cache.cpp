@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "module-source-cache.h"
+
+#include <module/core-modules/node/file-system-helpers.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+using namespace napa;
+using namespace napa::module;
+
+constexpr size_t ModuleSourceCache::DEFAULT_MIN_SIZE;
+
+ModuleSourceCache& ModuleSourceCache::GetInstance() {
+    static ModuleSourceCache* moduleSourceCache = new ModuleSourceCache();
+    return *moduleSourceCache;
+}
+
+ModuleSourceCache::ModuleSourceCache(size_t minSize) : _minSize(minSize) {}
+
+std::shared_ptr<const std::string> ModuleSourceCache::Get(const std::string& path,
+                                                          const std::string& header,
+                                                          const std::string& footer) {
+    auto stat = file_system_helpers::StatSync(path);
+    if (stat.size < _minSize) {
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto it = _entries.find(path);
+        if (it != _entries.end()) {
+            auto& entry = it->second;
+            if (entry.size == stat.size && entry.mtimeMs == stat.mtimeMs) {
+                // A module that isn't ASCII isn't read again to find out.
+                if (!entry.ascii) {
+                    return nullptr;
+                }
+
+                auto source = entry.source.lock();
+                if (source != nullptr && entry.header == header && entry.footer == footer) {
+                    return source;
+                }
+            }
+        }
+    }
+
+    // Read without holding the lock, other isolates may read the same module meanwhile and the last one is kept.
+    auto content = file_system_helpers::ReadFileSync(path);
+    if (content.size() < _minSize) {
+        return nullptr;
+    }
+
+    if (!IsAscii(content.data(), content.size())) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _entries[path] = Entry{ stat.size, stat.mtimeMs, false, header, footer, {} };
+        return nullptr;
+    }
+
+    auto source = std::make_shared<std::string>();
+    source->reserve(header.size() + content.size() + footer.size());
+    source->append(header).append(content).append(footer);
+
+    std::lock_guard<std::mutex> lock(_lock);
+
+    // Drop sources no isolate uses anymore.
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        it = it->second.ascii && it->second.source.expired() ? _entries.erase(it) : std::next(it);
+    }
+
+    _entries[path] = Entry{ stat.size, stat.mtimeMs, true, header, footer, source };
+    return source;
+}
+
+size_t ModuleSourceCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    size_t size = 0;
+    for (const auto& entry : _entries) {
+        if (!entry.second.source.expired()) {
+            ++size;
+        }
+    }
+    return size;
+}
+
+bool ModuleSourceCache::IsAscii(const char* data, size_t length) {
+    // Checks a word at a time, a module is mostly scanned to its end.
+    const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if ((word & HIGH_BITS) != 0) {
+            return false;
+        }
+    }
+    for (; i < length; ++i) {
+        if ((static_cast<uint8_t>(data[i]) & 0x80) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
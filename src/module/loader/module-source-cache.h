@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide sources of large ASCII Javascript modules, which isolates of all zones share as external strings. </summary>
+    /// <remarks>
+    ///     A module source is read once per process, instead of being copied into the heap of each isolate requiring it.
+    ///     Sources are kept with the header and footer they're wrapped in, so isolates don't concatenate them into a heap string.
+    ///     A source is read again when the size or modification time of its file changed. Once every isolate dropped it,
+    ///     e.g. all its workers were recycled, its memory is released.
+    /// </remarks>
+    class ModuleSourceCache {
+    public:
+
+        /// <summary> Modules smaller than this are cheaper to copy into each isolate. </summary>
+        static constexpr size_t DEFAULT_MIN_SIZE = 64 * 1024;
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static ModuleSourceCache& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        /// <param name="minSize"> Minimal size of the modules to share. </param>
+        explicit ModuleSourceCache(size_t minSize = DEFAULT_MIN_SIZE);
+
+        /// <summary> Non-copyable. </summary>
+        ModuleSourceCache(const ModuleSourceCache&) = delete;
+        ModuleSourceCache& operator=(const ModuleSourceCache&) = delete;
+
+        /// <summary> Gets the shared source of a module file, throws if the file can't be read. </summary>
+        /// <param name="path"> The module path. </param>
+        /// <param name="header"> The text the module source starts with, empty if not wrapped. </param>
+        /// <param name="footer"> The text the module source ends with, empty if not wrapped. </param>
+        /// <returns> The wrapped source, nullptr if the module is smaller than the minimal size or isn't ASCII. </returns>
+        std::shared_ptr<const std::string> Get(const std::string& path, const std::string& header, const std::string& footer);
+
+        /// <summary> Gets the number of module sources still used by isolates. </summary>
+        size_t GetSize() const;
+
+        /// <summary> Tells if a text is ASCII, so V8 can use it as a one-byte string as is. </summary>
+        static bool IsAscii(const char* data, size_t length);
+
+    private:
+
+        struct Entry {
+            uint64_t size;
+            double mtimeMs;
+            bool ascii;
+            std::string header;
+            std::string footer;
+            std::weak_ptr<const std::string> source;
+        };
+
+        const size_t _minSize;
+        std::unordered_map<std::string, Entry> _entries;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -0,0 +1,143 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "module-versions.h"
+
+#include <module/core-modules/node/file-system-helpers.h>
+
+#include <vector>
+
+using namespace napa;
+using namespace napa::module;
+
+ModuleVersions& ModuleVersions::GetInstance() {
+    static ModuleVersions* moduleVersions = new ModuleVersions();
+    return *moduleVersions;
+}
+
+ModuleVersions::ModuleVersions() : _generation(0), _watching(false), _stopWatcher(false) {}
+
+ModuleVersions::~ModuleVersions() {
+    StopWatching();
+}
+
+uint64_t ModuleVersions::GetVersion(const std::string& path) const {
+    if (GetGeneration() == 0) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _versions.find(path);
+    return it != _versions.end() ? it->second : 0;
+}
+
+uint64_t ModuleVersions::Invalidate(const std::string& path) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto version = ++_versions[path];
+
+    // The version is set before the generation moves, so a cache seeing the new generation sees the new version.
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+    return version;
+}
+
+void ModuleVersions::Watch(const std::string& path) {
+    if (!IsWatching()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_filesLock);
+        if (_files.find(path) != _files.end()) {
+            return;
+        }
+    }
+
+    file_system_helpers::FileStat stat;
+    try {
+        stat = file_system_helpers::StatSync(path);
+    } catch (const std::exception&) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_filesLock);
+    _files.emplace(path, FileVersion{ stat.size, stat.mtimeMs });
+}
+
+size_t ModuleVersions::Poll() {
+    std::vector<std::pair<std::string, FileVersion>> files;
+    {
+        std::lock_guard<std::mutex> lock(_filesLock);
+        files.assign(_files.begin(), _files.end());
+    }
+
+    // Files are stat'ed without the lock, so isolates loading modules don't wait for the file system.
+    std::vector<std::pair<std::string, FileVersion>> changed;
+    for (const auto& file : files) {
+        file_system_helpers::FileStat stat;
+        try {
+            stat = file_system_helpers::StatSync(file.first);
+        } catch (const std::exception&) {
+            continue;
+        }
+
+        if (stat.size != file.second.size || stat.mtimeMs != file.second.mtimeMs) {
+            changed.emplace_back(file.first, FileVersion{ stat.size, stat.mtimeMs });
+        }
+    }
+
+    if (!changed.empty()) {
+        std::lock_guard<std::mutex> lock(_filesLock);
+        for (const auto& file : changed) {
+            auto it = _files.find(file.first);
+            if (it != _files.end()) {
+                it->second = file.second;
+            }
+        }
+    }
+
+    for (const auto& file : changed) {
+        Invalidate(file.first);
+    }
+    return changed.size();
+}
+
+void ModuleVersions::StartWatching(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(_watcherLock);
+    if (_watcher.joinable()) {
+        return;
+    }
+
+    _stopWatcher = false;
+    _watching = true;
+    _watcher = std::thread(&ModuleVersions::WatchLoop, this, interval);
+}
+
+void ModuleVersions::StopWatching() {
+    {
+        std::lock_guard<std::mutex> lock(_watcherLock);
+        _stopWatcher = true;
+        _watching = false;
+    }
+    _stopEvent.notify_all();
+
+    if (_watcher.joinable()) {
+        _watcher.join();
+    }
+
+    std::lock_guard<std::mutex> lock(_filesLock);
+    _files.clear();
+}
+
+size_t ModuleVersions::GetWatchedCount() const {
+    std::lock_guard<std::mutex> lock(_filesLock);
+    return _files.size();
+}
+
+void ModuleVersions::WatchLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(_watcherLock);
+    while (!_stopEvent.wait_for(lock, interval, [this]() { return _stopWatcher; })) {
+        lock.unlock();
+        Poll();
+        lock.lock();
+    }
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide versions of modules, which tell the module caches of all isolates to load a changed module again. </summary>
+    /// <remarks>
+    ///     Each isolate caches a module with its version at load time. Invalidating a module bumps its version, so every
+    ///     isolate loads it again on its next require(), while other cached modules stay warm.
+    ///     When watching, the size and modification time of loaded module files are polled from a background thread,
+    ///     which invalidates the modules whose file changed.
+    ///     It's exposed in napa.dll, so Node and Napa isolates share the same instance.
+    /// </remarks>
+    class NAPA_API ModuleVersions {
+    public:
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static ModuleVersions& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        ModuleVersions();
+
+        /// <summary> Destructor, which stops watching. </summary>
+        ~ModuleVersions();
+
+        /// <summary> Non-copyable. </summary>
+        ModuleVersions(const ModuleVersions&) = delete;
+        ModuleVersions& operator=(const ModuleVersions&) = delete;
+
+        /// <summary> Gets the number of invalidations so far, so caches skip checking versions while it didn't change. </summary>
+        uint64_t GetGeneration() const {
+            return _generation.load(std::memory_order_acquire);
+        }
+
+        /// <summary> Gets the version of a module, 0 until it's invalidated. </summary>
+        /// <param name="path"> Full path of the module. </param>
+        uint64_t GetVersion(const std::string& path) const;
+
+        /// <summary> Invalidates a module, so isolates load it again on their next require(). </summary>
+        /// <param name="path"> Full path of the module. </param>
+        /// <returns> The new version of the module. </returns>
+        uint64_t Invalidate(const std::string& path);
+
+        /// <summary> Watches the file of a loaded module. No-op if not watching or already watched. </summary>
+        /// <param name="path"> Full path of the module file, which is ignored if it can't be stat'ed. </param>
+        void Watch(const std::string& path);
+
+        /// <summary> Invalidates the watched modules whose file size or modification time changed. </summary>
+        /// <returns> The number of invalidated modules. </returns>
+        /// <remarks> A file that can't be stat'ed, e.g. while it's replaced, is checked again next time. </remarks>
+        size_t Poll();
+
+        /// <summary> Starts polling watched files from a background thread. </summary>
+        /// <param name="interval"> The time between two polls. </param>
+        void StartWatching(std::chrono::milliseconds interval);
+
+        /// <summary> Stops polling, and forgets watched files. </summary>
+        void StopWatching();
+
+        /// <summary> Whether files of loaded modules are watched. </summary>
+        bool IsWatching() const {
+            return _watching.load(std::memory_order_acquire);
+        }
+
+        /// <summary> Gets the number of watched files. </summary>
+        size_t GetWatchedCount() const;
+
+    private:
+
+        struct FileVersion {
+            uint64_t size;
+            double mtimeMs;
+        };
+
+        /// <summary> Polls watched files until stopped. </summary>
+        void WatchLoop(std::chrono::milliseconds interval);
+
+        std::atomic<uint64_t> _generation;
+        std::unordered_map<std::string, uint64_t> _versions;
+        mutable std::mutex _lock;
+
+        std::atomic<bool> _watching;
+        std::unordered_map<std::string, FileVersion> _files;
+        mutable std::mutex _filesLock;
+
+        std::thread _watcher;
+        std::condition_variable _stopEvent;
+        std::mutex _watcherLock;
+        bool _stopWatcher;
+    };
+}
+}
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "resolution-cache.h"
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+    /// <summary> Names and paths never contain a null character. </summary>
+    std::string GetKey(const std::string& name, const std::string& path) {
+        std::string key;
+        key.reserve(name.size() + path.size() + 1);
+        key.append(name).append(1, '\0').append(path);
+        return key;
+    }
+}   // End of anonymous namespace.
+
+ResolutionCache& ResolutionCache::GetInstance() {
+    static ResolutionCache resolutionCache;
+    return resolutionCache;
+}
+
+ResolutionCache::ResolutionCache() : _statCacheEnabled(false) {}
+
+bool ResolutionCache::TryGet(const std::string& name, const std::string& path, ModuleInfo& moduleInfo) const {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    auto iter = _resolutions.find(GetKey(name, path));
+    if (iter == _resolutions.end()) {
+        return false;
+    }
+
+    moduleInfo = iter->second;
+    return true;
+}
+
+void ResolutionCache::Insert(const std::string& name, const std::string& path, const ModuleInfo& moduleInfo) {
+    if (moduleInfo.type == ModuleType::NONE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _resolutions[GetKey(name, path)] = moduleInfo;
+}
+
+void ResolutionCache::SetStatCacheEnabled(bool enabled) {
+    _statCacheEnabled = enabled;
+}
+
+bool ResolutionCache::IsRegularFile(const filesystem::Path& path) {
+    if (!_statCacheEnabled) {
+        return filesystem::IsRegularFile(path);
+    }
+    return GetFileType(path) == FileType::REGULAR_FILE;
+}
+
+bool ResolutionCache::IsDirectory(const filesystem::Path& path) {
+    if (!_statCacheEnabled) {
+        return filesystem::IsDirectory(path);
+    }
+    return GetFileType(path) == FileType::DIRECTORY;
+}
+
+void ResolutionCache::Clear() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _resolutions.clear();
+    _stats.clear();
+}
+
+size_t ResolutionCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _resolutions.size();
+}
+
+ResolutionCache::FileType ResolutionCache::GetFileType(const filesystem::Path& path) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto iter = _stats.find(path.String());
+        if (iter != _stats.end()) {
+            return iter->second;
+        }
+    }
+
+    // Stat without the lock, concurrent misses on the same path store the same answer.
+    auto type = FileType::NONE;
+    if (filesystem::IsRegularFile(path)) {
+        type = FileType::REGULAR_FILE;
+    } else if (filesystem::IsDirectory(path)) {
+        type = FileType::DIRECTORY;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    _stats[path.String()] = type;
+    return type;
+}
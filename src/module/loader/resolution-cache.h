@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "module-resolver.h"
+
+#include <napa/exports.h>
+#include <platform/filesystem.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide cache of module resolutions, shared by the module resolvers of all isolates. </summary>
+    /// <remarks>
+    ///     Resolutions are keyed by module name and base path, and only successful ones are cached, so a module
+    ///     that is installed later is still found. The optional stat cache also remembers file system lookups,
+    ///     including misses, until it's cleared. It's exposed in napa.dll, so napa-binding clears the same instance.
+    /// </remarks>
+    class NAPA_API ResolutionCache {
+    public:
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static ResolutionCache& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        ResolutionCache();
+
+        /// <summary> Non-copyable. </summary>
+        ResolutionCache(const ResolutionCache&) = delete;
+        ResolutionCache& operator=(const ResolutionCache&) = delete;
+
+        /// <summary> Gets a cached resolution. </summary>
+        /// <param name="name"> Module name or path, as given to require(). </param>
+        /// <param name="path"> Base path of the resolution. </param>
+        /// <param name="moduleInfo"> Receives the resolution. </param>
+        /// <returns> True if the resolution was cached. </returns>
+        bool TryGet(const std::string& name, const std::string& path, ModuleInfo& moduleInfo) const;
+
+        /// <summary> Caches a successful resolution. </summary>
+        void Insert(const std::string& name, const std::string& path, const ModuleInfo& moduleInfo);
+
+        /// <summary> Enables or disables the stat cache. </summary>
+        void SetStatCacheEnabled(bool enabled);
+
+        /// <summary> Tells if a path is a regular file, from the stat cache if enabled. </summary>
+        bool IsRegularFile(const filesystem::Path& path);
+
+        /// <summary> Tells if a path is a directory, from the stat cache if enabled. </summary>
+        bool IsDirectory(const filesystem::Path& path);
+
+        /// <summary> Drops all resolutions and stats, e.g. after deploying new modules. </summary>
+        void Clear();
+
+        /// <summary> Gets the number of cached resolutions. </summary>
+        size_t GetSize() const;
+
+    private:
+
+        /// <summary> File system entry type in the stat cache. </summary>
+        enum class FileType {
+            NONE,
+            REGULAR_FILE,
+            DIRECTORY
+        };
+
+        /// <summary> Gets the type of a path, from the stat cache. </summary>
+        FileType GetFileType(const filesystem::Path& path);
+
+        std::unordered_map<std::string, ModuleInfo> _resolutions;
+        std::unordered_map<std::string, FileType> _stats;
+        std::atomic<bool> _statCacheEnabled;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "script-cache.h"
+
+#include <platform/filesystem.h>
+#include <platform/process.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+    /// <summary> FNV-1a hash, stable across processes so persisted caches can be found again. </summary>
+    uint64_t Hash(const std::string& value) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (auto c : value) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+ScriptCache& ScriptCache::GetInstance() {
+    static ScriptCache scriptCache;
+    return scriptCache;
+}
+
+void ScriptCache::SetDirectory(std::string directory) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _directory = std::move(directory);
+}
+
+std::shared_ptr<zone::CodeCache> ScriptCache::Get(const std::string& path, const std::string& source) {
+    auto sourceHash = Hash(source);
+
+    std::unique_lock<std::mutex> lock(_lock);
+    auto& entry = _entries[path];
+    if (entry.codeCache != nullptr && entry.sourceHash == sourceHash) {
+        return entry.codeCache;
+    }
+
+    entry.sourceHash = sourceHash;
+    entry.codeCache = std::make_shared<zone::CodeCache>();
+    auto codeCache = entry.codeCache;
+
+    if (_directory.empty()) {
+        return codeCache;
+    }
+    auto filePath = GetFilePath(path, sourceHash);
+    lock.unlock();
+
+    // V8 checks the source hash and version of the data, a stale or corrupted file is rejected on compile.
+    std::ifstream file(filePath, std::ios::binary);
+    if (file) {
+        zone::CodeCache::Data data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!data.empty()) {
+            codeCache->Set(std::move(data));
+        }
+    }
+    return codeCache;
+}
+
+bool ScriptCache::Save(const std::string& path, const std::string& source, const zone::CodeCache& codeCache) {
+    std::string filePath;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_directory.empty()) {
+            return false;
+        }
+        filePath = GetFilePath(path, Hash(source));
+    }
+    return Write(filePath, codeCache);
+}
+
+bool ScriptCache::Save(const std::string& path, const zone::CodeCache& codeCache) {
+    std::string filePath;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto it = _entries.find(path);
+        if (_directory.empty() || it == _entries.end() || it->second.codeCache.get() != &codeCache) {
+            return false;
+        }
+        filePath = GetFilePath(path, it->second.sourceHash);
+    }
+    return Write(filePath, codeCache);
+}
+
+bool ScriptCache::Write(const std::string& filePath, const zone::CodeCache& codeCache) {
+    auto data = codeCache.Get();
+    if (data == nullptr) {
+        return false;
+    }
+
+    // Write to a temporary file first, so processes loading the cache concurrently never see a partial file.
+    // It's named after the process and thread, so zones or processes saving the same cache don't write the same file.
+    auto tempPath = filePath + "." + std::to_string(platform::Getpid()) + "-" + std::to_string(platform::Gettid()) + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data->data()), data->size());
+        if (!file) {
+            file.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t ScriptCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.size();
+}
+
+std::string ScriptCache::GetFilePath(const std::string& path, uint64_t sourceHash) const {
+    char filename[64];
+    snprintf(filename, sizeof(filename), "%016llx-%016llx.cache",
+        static_cast<unsigned long long>(Hash(path)),
+        static_cast<unsigned long long>(sourceHash));
+
+    return (filesystem::Path(_directory) / filename).String();
+}
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <zone/code-cache.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide code caches of Javascript modules, shared by all isolates of all zones. </summary>
+    /// <remarks>
+    ///     Caches are keyed by module path and content hash, a module whose content changed gets a new cache.
+    ///     When a directory is set, caches are loaded from it on first use and saved to it once produced,
+    ///     so later processes skip compiling modules from scratch.
+    /// </remarks>
+    class ScriptCache {
+    public:
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static ScriptCache& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        ScriptCache() = default;
+
+        /// <summary> Non-copyable. </summary>
+        ScriptCache(const ScriptCache&) = delete;
+        ScriptCache& operator=(const ScriptCache&) = delete;
+
+        /// <summary> Sets the directory to persist caches in, empty to keep them in memory only. </summary>
+        void SetDirectory(std::string directory);
+
+        /// <summary> Gets the code cache of a module, which is empty until an isolate produced or loaded it. </summary>
+        /// <param name="path"> The module path. </param>
+        /// <param name="source"> The module content. </param>
+        std::shared_ptr<zone::CodeCache> Get(const std::string& path, const std::string& source);
+
+        /// <summary> Saves the produced code cache of a module, if a directory is set. </summary>
+        /// <returns> True if the cache was saved. </returns>
+        bool Save(const std::string& path, const std::string& source, const zone::CodeCache& codeCache);
+
+        /// <summary> Saves the code cache of a module again, e.g. once it's warm, if a directory is set. </summary>
+        /// <returns> True if the cache was saved, false if it's no longer the cache of the module path. </returns>
+        bool Save(const std::string& path, const zone::CodeCache& codeCache);
+
+        /// <summary> Gets the number of cached modules. </summary>
+        size_t GetSize() const;
+
+    private:
+
+        /// <summary> Writes the data of a code cache to its file. </summary>
+        static bool Write(const std::string& filePath, const zone::CodeCache& codeCache);
+
+        /// <summary> Gets the file a module cache is persisted in. </summary>
+        std::string GetFilePath(const std::string& path, uint64_t sourceHash) const;
+
+        struct Entry {
+            uint64_t sourceHash;
+            std::shared_ptr<zone::CodeCache> codeCache;
+        };
+
+        std::string _directory;
+        std::unordered_map<std::string, Entry> _entries;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "wasm-module-cache.h"
+
+#include <module/core-modules/node/file-system-helpers.h>
+
+using namespace napa;
+using namespace napa::module;
+
+WasmModuleCache& WasmModuleCache::GetInstance() {
+    static WasmModuleCache* wasmModuleCache = new WasmModuleCache();
+    return *wasmModuleCache;
+}
+
+WasmModuleCache::Version WasmModuleCache::GetFileVersion(const std::string& path) {
+    auto stat = file_system_helpers::StatSync(path);
+    return Version(stat.size, stat.mtimeMs);
+}
+
+std::shared_ptr<const WasmModuleCache::CompiledModule> WasmModuleCache::Get(const std::string& path, const Version& version) const {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto it = _entries.find(path);
+    if (it == _entries.end() || it->second.version != version) {
+        return nullptr;
+    }
+    return it->second.module;
+}
+
+void WasmModuleCache::Set(const std::string& path,
+                          const Version& version,
+                          std::shared_ptr<const CompiledModule> module) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries[path] = Entry{ version, std::move(module) };
+}
+
+size_t WasmModuleCache::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.size();
+}
+
+void WasmModuleCache::Clear() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _entries.clear();
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <v8.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace module {
+
+    /// <summary> Process-wide compiled WebAssembly modules, which isolates of all zones instantiate instead of compiling. </summary>
+    /// <remarks>
+    ///     The first isolate requiring a .wasm module compiles it and keeps it as a V8 transferrable module, from which
+    ///     others create their module objects sharing the compiled code. A module is compiled again when the size or
+    ///     modification time of its file changed.
+    /// </remarks>
+    class WasmModuleCache {
+    public:
+
+        /// <summary> Compiled module, which any isolate can create a module object from. </summary>
+        typedef v8::WasmCompiledModule::TransferrableModule CompiledModule;
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static WasmModuleCache& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        WasmModuleCache() = default;
+
+        /// <summary> Non-copyable. </summary>
+        WasmModuleCache(const WasmModuleCache&) = delete;
+        WasmModuleCache& operator=(const WasmModuleCache&) = delete;
+
+        /// <summary> Size and modification time of a module file, which tells if it changed. </summary>
+        typedef std::pair<uint64_t, double> Version;
+
+        /// <summary> Gets the version of a module file, throws if the file can't be stat'ed. </summary>
+        static Version GetFileVersion(const std::string& path);
+
+        /// <summary> Gets the compiled module of a path. </summary>
+        /// <param name="path"> The module path. </param>
+        /// <param name="version"> The version of the module, taken before reading it. </param>
+        /// <returns> The compiled module, nullptr if the module wasn't cached or its version changed since. </returns>
+        std::shared_ptr<const CompiledModule> Get(const std::string& path, const Version& version) const;
+
+        /// <summary> Caches the compiled module of a path. </summary>
+        /// <param name="path"> The module path. </param>
+        /// <param name="version"> The version of the module, taken before reading it. </param>
+        /// <param name="module"> The compiled module. </param>
+        void Set(const std::string& path, const Version& version, std::shared_ptr<const CompiledModule> module);
+
+        /// <summary> Gets the number of cached modules. </summary>
+        size_t GetSize() const;
+
+        /// <summary> Drops all cached modules. Module objects created from them are unaffected. </summary>
+        void Clear();
+
+    private:
+
+        struct Entry {
+            Version version;
+            std::shared_ptr<const CompiledModule> module;
+        };
+
+        std::unordered_map<std::string, Entry> _entries;
+        mutable std::mutex _lock;
+    };
+}
+}
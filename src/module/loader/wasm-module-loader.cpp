@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "wasm-module-loader.h"
+#include "wasm-module-cache.h"
+
+#include <module/core-modules/node/file-system-helpers.h>
+
+#include <napa/v8-helpers.h>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+
+    /// <summary> It compiles a .wasm file, caching the compiled module for other isolates. </summary>
+    v8::MaybeLocal<v8::WasmCompiledModule> Compile(const std::string& path, const WasmModuleCache::Version& version) {
+        auto isolate = v8::Isolate::GetCurrent();
+        v8::EscapableHandleScope scope(isolate);
+
+        std::string bytes;
+        try {
+            bytes = file_system_helpers::ReadFileSync(path);
+        } catch (const std::exception& ex) {
+            isolate->ThrowException(v8::Exception::Error(v8_helpers::MakeV8String(isolate, ex.what())));
+            return v8::MaybeLocal<v8::WasmCompiledModule>();
+        }
+
+        // Compile is private. Without a serialized module, DeserializeOrCompile compiles the wire bytes.
+        v8::WasmCompiledModule::CallerOwnedBuffer serialized(nullptr, 0);
+        v8::WasmCompiledModule::CallerOwnedBuffer wireBytes(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+        v8::Local<v8::WasmCompiledModule> compiled;
+        if (!v8::WasmCompiledModule::DeserializeOrCompile(isolate, serialized, wireBytes).ToLocal(&compiled)) {
+            // V8 throws a WebAssembly.CompileError.
+            return v8::MaybeLocal<v8::WasmCompiledModule>();
+        }
+
+        WasmModuleCache::GetInstance().Set(
+            path,
+            version,
+            std::make_shared<const WasmModuleCache::CompiledModule>(compiled->GetTransferrableModule()));
+        return scope.Escape(compiled);
+    }
+
+}   // End of anonymous namespace.
+
+bool WasmModuleLoader::TryGet(const std::string& path, v8::Local<v8::Value> arg, v8::Local<v8::Object>& module) {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::EscapableHandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    JS_ENSURE_WITH_RETURN(isolate, arg.IsEmpty() || arg->IsUndefined() || arg->IsObject(), false,
+        "Import object of WebAssembly module \"%s\" must be an object.", path.c_str());
+
+    auto& cache = WasmModuleCache::GetInstance();
+    WasmModuleCache::Version version;
+    try {
+        version = WasmModuleCache::GetFileVersion(path);
+    } catch (const std::exception& ex) {
+        isolate->ThrowException(v8::Exception::Error(v8_helpers::MakeV8String(isolate, ex.what())));
+        return false;
+    }
+
+    // Module objects of other isolates share the code compiled by the first one.
+    v8::Local<v8::WasmCompiledModule> compiled;
+    auto cached = cache.Get(path, version);
+    if (cached == nullptr || !v8::WasmCompiledModule::FromTransferrableModule(isolate, *cached).ToLocal(&compiled)) {
+        if (!Compile(path, version).ToLocal(&compiled)) {
+            return false;
+        }
+    }
+
+    // Each isolate has its own instance, i.e. its own memory and globals.
+    auto webAssembly = context->Global()->Get(context, v8_helpers::MakeV8String(isolate, "WebAssembly")).ToLocalChecked();
+    JS_ENSURE_WITH_RETURN(isolate, webAssembly->IsObject(), false, "WebAssembly is not supported.");
+    auto instanceConstructor = webAssembly.As<v8::Object>()->Get(context, v8_helpers::MakeV8String(isolate, "Instance")).ToLocalChecked();
+    JS_ENSURE_WITH_RETURN(isolate, instanceConstructor->IsFunction(), false, "WebAssembly is not supported.");
+
+    v8::Local<v8::Value> argv[] = { compiled, arg.IsEmpty() ? v8::Undefined(isolate).As<v8::Value>() : arg };
+    v8::Local<v8::Object> instance;
+    if (!instanceConstructor.As<v8::Function>()->NewInstance(context, 2, argv).ToLocal(&instance)) {
+        // V8 throws a WebAssembly.LinkError for missing imports.
+        return false;
+    }
+
+    auto exports = instance->Get(context, v8_helpers::MakeV8String(isolate, "exports")).ToLocalChecked();
+    module = scope.Escape(exports->ToObject(context).ToLocalChecked());
+    return true;
+}
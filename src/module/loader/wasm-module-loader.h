@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "module-file-loader.h"
+
+#include <string>
+
+namespace napa {
+namespace module {
+
+    /// <summary> It loads the exports of a WebAssembly module from .wasm file. </summary>
+    class WasmModuleLoader : public ModuleFileLoader {
+    public:
+
+        /// <summary> It instantiates a WebAssembly module, compiled once per process, and returns its exports. </summary>
+        /// <param name="path"> Module path called by require(). </param>
+        /// <param name="arg"> Import object of the instance, passed through as arg1 from require. </param>
+        /// <param name="module"> Exports of the instance if successful. </param>
+        /// <returns> True if the module is instantiated, false otherwise. </returns>
+        bool TryGet(const std::string& path, v8::Local<v8::Value> arg, v8::Local<v8::Object>& module) override;
+    };
+
+}   // End of namespace module.
+}   // End of namespace napa.
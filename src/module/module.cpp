@@ -41,6 +41,16 @@ void napa::module::SetPersistentConstructor(const char* name,
 /// <summary> It gets the given persistent constructor from the current V8 isolate. </summary>
 /// <param name="name"> Unique constructor name given at SetPersistentConstructor() call. </param>
 /// <returns> V8 local function object. </returns>
+void napa::module::ReleasePersistentConstructors() {
+    auto constructorInfo =
+        static_cast<ConstructorInfo*>(zone::WorkerContext::Get(zone::WorkerContextItem::CONSTRUCTOR));
+    if (constructorInfo != nullptr) {
+        // Copyable persistent handles are reset on destruction.
+        delete constructorInfo;
+        zone::WorkerContext::Set(zone::WorkerContextItem::CONSTRUCTOR, nullptr);
+    }
+}
+
 v8::Local<v8::Function> napa::module::GetPersistentConstructor(const char* name) {
     auto isolate = v8::Isolate::GetCurrent();
     v8::EscapableHandleScope scope(isolate);
@@ -7,9 +7,9 @@
 #include "utils/string.h"
 
 #include <algorithm>
+#include <cctype>
 #include <cstdio>
 #include <deque>
-#include <sstream>
 #include <iostream>
 #include <vector>
 
@@ -44,6 +44,14 @@ namespace {
         return segment.size() == 2 && IsLetter(segment[0]) && segment[1] == ':';
     }
 
+    /// <summary> Tell if two strings are equal regardless of ASCII case. </summary>
+    bool EqualsIgnoreCase(const StringType& lhs, const StringType& rhs) {
+        return lhs.size() == rhs.size()
+            && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](CharType a, CharType b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+    }
+
     /// <summary> Has UNC prefix "\\\\?" in windows. </summary>
     bool ParseUncPrefix(const std::string& path) {
         if (path.size() < 4) {
@@ -136,41 +144,6 @@ namespace {
         }
     }
 
-    /// <summary> Format path name from path meta-data. </summary>
-    std::string FormatPathString(
-        bool hasUncPrefix,
-        const std::string& driveSpec,
-        bool isAbsolute,
-        const std::vector<StringType>& segments,
-        const CharType* seperator = platform::DIR_SEPARATOR) {
-
-        // Output normalized string.
-        std::stringstream ss;
-
-        if (hasUncPrefix) {
-            ss << "\\\\?\\";
-        }
-
-        // Drive spec could be empty.
-        ss << driveSpec;
-
-        if (isAbsolute) {
-            ss << platform::DIR_SEPARATOR;
-        }
-
-        for (auto it = segments.begin(); it != segments.end(); ++it) {
-            if (it != segments.begin()) {
-                ss << seperator;
-            }
-            ss << *it;
-        }
-        auto path = ss.str();
-        if (path.size() == 0) {
-            return ".";
-        }
-        return path;
-    }
-
 }
 
 Path& Path::operator=(const CharType* path) {
@@ -248,21 +221,72 @@ Path& Path::Append(const Path& path) {
 }
 
 Path& Path::Normalize() {
-    if (!_pathname.empty()) {
-        std::string driveSpec;
-        bool hasUncPrefix = false;
-        bool isAbsolute = false;
-        std::vector<StringType> segs;
+    if (_pathname.empty()) {
+        return *this;
+    }
 
-        Parse(_pathname, &hasUncPrefix, &driveSpec, &isAbsolute, &segs);
+    // Segments are resolved in place, the normalized path is never longer than the original one.
+    // The UNC prefix and drive spec are kept as they are, and both '/' and '\\' separate segments.
+    bool hasUncPrefix = false;
+    auto driveSpec = ParseDriveSpec(_pathname, &hasUncPrefix);
+    StringType::size_type pathStart = (hasUncPrefix ? 4 : 0) + driveSpec.size();
 
-        // No parent path.
-        if (isAbsolute && segs.size() > 0 && segs[0] == "..") {
-            _pathname = "";
+    auto separator = platform::DIR_SEPARATOR[0];
+    auto isAbsolute = pathStart < _pathname.size() && IsSeparator(_pathname[pathStart]);
+    auto write = pathStart;
+    if (isAbsolute) {
+        _pathname[write++] = separator;
+    }
+    auto segmentsStart = write;
+
+    auto read = pathStart;
+    auto size = _pathname.size();
+    while (read < size) {
+        while (read < size && (_pathname[read] == '/' || _pathname[read] == '\\')) {
+            ++read;
+        }
+        if (read == size) {
+            break;
+        }
+
+        auto segment = read;
+        while (read < size && _pathname[read] != '/' && _pathname[read] != '\\') {
+            ++read;
         }
-        else {
-            _pathname = FormatPathString(hasUncPrefix, driveSpec, isAbsolute, segs, platform::DIR_SEPARATOR);
+        auto length = read - segment;
+
+        if (length == 1 && _pathname[segment] == '.') {
+            // Skip '.'
+            continue;
+        }
+
+        if (length == 2 && _pathname[segment] == '.' && _pathname[segment + 1] == '.' && write > segmentsStart) {
+            // Backtrack '..', unless the last resolved segment is '..' too.
+            auto last = _pathname.find_last_of(separator, write - 1);
+            last = (last == StringType::npos || last < segmentsStart) ? segmentsStart : last + 1;
+            if (write - last != 2 || _pathname[last] != '.' || _pathname[last + 1] != '.') {
+                write = last > segmentsStart ? last - 1 : segmentsStart;
+                continue;
+            }
         }
+
+        if (write > segmentsStart) {
+            _pathname[write++] = separator;
+        }
+        if (write != segment) {
+            std::copy(_pathname.begin() + segment, _pathname.begin() + read, _pathname.begin() + write);
+        }
+        write += length;
+    }
+    _pathname.resize(write);
+
+    // No parent path.
+    if (isAbsolute
+        && _pathname.compare(segmentsStart, 2, "..") == 0
+        && (_pathname.size() == segmentsStart + 2 || _pathname[segmentsStart + 2] == separator)) {
+        _pathname.clear();
+    } else if (_pathname.empty()) {
+        _pathname = ".";
     }
     return *this;
 }
@@ -275,6 +299,11 @@ Path& Path::ReplaceExtension(const std::string& extension) {
     return *this;
 }
 
+Path& Path::AddExtension(const std::string& extension) {
+    _pathname += extension;
+    return *this;
+}
+
 Path Path::GenericForm() const {
     if (HasUncPrefix()) {
         return *this;
@@ -393,35 +422,47 @@ Path Path::Relative(const Path& base) const {
     Parse(other._pathname, nullptr, &driveSpecOther, nullptr, &segsOther);
 
     // Return current path if base is from different drive spec.
-    if (utils::string::ToLowerCopy(driveSpecCurrent) != utils::string::ToLowerCopy(driveSpecOther)) {
+    if (!EqualsIgnoreCase(driveSpecCurrent, driveSpecOther)) {
         return current;
     }
 
     StringType::size_type same = 0;
     for (; same < segsCurrent.size() && same < segsOther.size(); ++same) {
-        if (utils::string::ToLowerCopy(segsCurrent[same]) != utils::string::ToLowerCopy(segsOther[same])) {
+        if (!EqualsIgnoreCase(segsCurrent[same], segsOther[same])) {
             break;
         }
     }
 
-    std::stringstream ss;
+    StringType relative;
+    relative.reserve(current._pathname.size() + 3 * (segsOther.size() - same));
     for (size_t i = 0; i < segsOther.size() - same; ++i) {
-        ss << ".." << platform::DIR_SEPARATOR;
+        relative.append("..").append(platform::DIR_SEPARATOR);
     }
 
     for (size_t i = same; i < segsCurrent.size(); ++i) {
-        ss << segsCurrent[i];
+        relative.append(segsCurrent[i]);
         if (i != segsCurrent.size() - 1) {
-            ss << platform::DIR_SEPARATOR;
+            relative.append(platform::DIR_SEPARATOR);
         }
     }
-    return Path(ss.str()).RemoveTrailingSeparator();
+    return Path(std::move(relative)).RemoveTrailingSeparator();
 }
 
 Path Path::Absolute() const {
     if (IsEmpty()) {
         return Path();
     }
+
+#ifdef SUPPORT_POSIX
+    // An absolute path doesn't depend on the current directory, which takes a system call to get.
+    if (IsAbsolute()) {
+        return *this;
+    }
+#else
+    if (IsAbsolute() && (HasUncPrefix() || HasDriveSpec())) {
+        return *this;
+    }
+#endif
     return CurrentDirectory() / *this;
 }
 
@@ -554,6 +595,58 @@ bool MakeDirectories(const Path& path) {
     return MakeDirectory(path);
 }
 
+Path TemporaryDirectory() {
+#ifdef SUPPORT_POSIX
+    auto directory = ::getenv("TMPDIR");
+    return Path(directory != nullptr && *directory != '\0' ? directory : "/tmp").Normalize();
+#else
+    char path[MAX_PATH + 1];
+    auto length = ::GetTempPathA(sizeof(path), path);
+    if (length == 0 || length > sizeof(path)) {
+        return Path();
+    }
+    return Path(path).Normalize();
+#endif
+}
+
+bool RemoveAll(const Path& path) {
+#ifdef SUPPORT_POSIX
+    struct stat st;
+    if (::lstat(path.c_str(), &st) != 0) {
+        return errno == ENOENT;
+    }
+    auto isDirectory = S_ISDIR(st.st_mode);
+#else
+    auto attribute = GetFileAttributesA(path.c_str());
+    if (attribute == INVALID_FILE_ATTRIBUTES) {
+        return ::GetLastError() == ERROR_FILE_NOT_FOUND || ::GetLastError() == ERROR_PATH_NOT_FOUND;
+    }
+    auto isDirectory = (attribute & FILE_ATTRIBUTE_DIRECTORY) && !(attribute & FILE_ATTRIBUTE_REPARSE_POINT);
+#endif
+
+    if (!isDirectory) {
+        return std::remove(path.c_str()) == 0;
+    }
+
+    // Entries are listed before they are removed, as a directory changing while it's read may skip entries.
+    std::vector<Path> entries;
+    PathIterator iterator(path);
+    while (iterator.Next()) {
+        entries.push_back(*iterator);
+    }
+    for (const auto& entry : entries) {
+        if (!RemoveAll(entry)) {
+            return false;
+        }
+    }
+
+#ifdef SUPPORT_POSIX
+    return ::rmdir(path.c_str()) == 0;
+#else
+    return ::RemoveDirectoryA(path.c_str()) == TRUE;
+#endif
+}
+
 PathIterator::PathIterator(Path path)
     : _base(std::move(path)) {
 #ifdef SUPPORT_POSIX
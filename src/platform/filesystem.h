@@ -74,12 +74,15 @@ namespace filesystem {
         /// </summary>
         Path& Append(const Path& path);
 
-        /// <summary> Normalize current path. </summary>
+        /// <summary> Normalize current path, in place without allocating. </summary>
         Path& Normalize();
 
         /// <summary> Replace extension. </summary>
         Path& ReplaceExtension(const std::string& extension);
 
+        /// <summary> Append an extension to the file name, after its current extension if any. </summary>
+        Path& AddExtension(const std::string& extension);
+
         /// <summary> Get normalized generic form of path string. using '/' as separator. </summary>
         Path GenericForm() const;
 
@@ -188,6 +191,13 @@ namespace filesystem {
     /// <summary> Make directories recursively. </summary>
     bool MakeDirectories(const Path& path);
 
+    /// <summary> Get the directory of temporary files, TMPDIR or /tmp on POSIX and GetTempPath on Windows. </summary>
+    Path TemporaryDirectory();
+
+    /// <summary> Remove a file, or a directory with its content. Symbolic links are removed, not followed. </summary>
+    /// <returns> True if the path was removed or didn't exist, false if operation failed. </returns>
+    bool RemoveAll(const Path& path);
+
     /// <summary> Path iterator </summary>
     class PathIterator {
     public:
@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <platform/mapped-file.h>
+#include <platform/platform.h>
+
+#ifdef SUPPORT_POSIX
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#else
+
+#pragma push_macro("NOMINMAX")
+#define NOMINMAX
+#include <windows.h>
+#pragma pop_macro("NOMINMAX")
+
+#endif
+
+namespace napa {
+namespace platform {
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path, bool copyOnWrite) {
+    std::unique_ptr<MappedFile> file(new MappedFile());
+
+#ifdef SUPPORT_POSIX
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || status.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    auto protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    auto data = ::mmap(nullptr, static_cast<size_t>(status.st_size), protection, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    file->_data = static_cast<const char*>(data);
+    file->_size = static_cast<size_t>(status.st_size);
+#else
+    auto handle = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        ::CloseHandle(handle);
+        return nullptr;
+    }
+
+    auto mapping = ::CreateFileMappingA(handle, nullptr, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(handle);
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+
+    auto data = ::MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        ::CloseHandle(mapping);
+        return nullptr;
+    }
+
+    file->_data = static_cast<const char*>(data);
+    file->_size = static_cast<size_t>(size.QuadPart);
+    file->_mapping = mapping;
+#endif
+
+    return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef SUPPORT_POSIX
+    ::munmap(const_cast<char*>(_data), _size);
+#else
+    ::UnmapViewOfFile(_data);
+    ::CloseHandle(static_cast<HANDLE>(_mapping));
+#endif
+}
+
+}
+}
@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace napa {
+namespace platform {
+
+    /// <summary> Cross-platform read-only memory mapping of a whole file. Pages are read when they are first accessed. </summary>
+    class MappedFile {
+    public:
+        /// <summary> Maps a file into memory. </summary>
+        /// <param name="copyOnWrite"> Whether the contents may be written, which goes to private copies of the pages, never to the file. </param>
+        /// <returns> The mapped file, or nullptr if the file is empty or can't be opened or mapped. </returns>
+        static std::unique_ptr<MappedFile> Open(const std::string& path, bool copyOnWrite = false);
+
+        /// <summary> Unmaps the file. </summary>
+        ~MappedFile();
+
+        /// <summary> Non-copyable. </summary>
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /// <summary> Get address of the mapped contents. </summary>
+        const char* GetData() const {
+            return _data;
+        }
+
+        /// <summary> Get address of the mapped contents, which may only be written if mapped as copy-on-write. </summary>
+        char* GetMutableData() {
+            return const_cast<char*>(_data);
+        }
+
+        /// <summary> Get size of the file in bytes. </summary>
+        size_t GetSize() const {
+            return _size;
+        }
+
+    private:
+        MappedFile() = default;
+
+        const char* _data = nullptr;
+        size_t _size = 0;
+        void* _mapping = nullptr;
+    };
+}
+}
@@ -5,10 +5,35 @@
 #include <platform/platform.h>
 
 #ifdef SUPPORT_POSIX
+
+#include <pthread.h>
 #include <sys/utsname.h>
+#include <unistd.h>
+
+#ifdef OS_LINUX
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#else
+
+#pragma push_macro("NOMINMAX")
+#define NOMINMAX
+#include <windows.h>
+#pragma pop_macro("NOMINMAX")
+
 #endif
 
+#include <algorithm>
+#include <climits>
+#include <exception>
+#include <fstream>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
 
 namespace napa {
 namespace platform {
@@ -38,5 +63,240 @@ const char* GetOSType() {
     const char* DIR_SEPARATOR = "\\";
 #endif
 
+#ifdef OS_LINUX
+/// <summary> Parse a Linux cpu list, i.e. "0-3,8,10-11". </summary>
+static std::vector<uint32_t> ParseCpuList(const std::string& list) {
+    std::vector<uint32_t> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+
+        auto dash = range.find('-');
+        auto first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+        auto last = dash == std::string::npos ? first : static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+        for (auto cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+#endif
+
+static std::vector<Processor> DetectProcessorTopology() {
+    std::vector<Processor> processors;
+
+#if defined(OS_LINUX)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool hasAllowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    // Nodes are numbered contiguously in sysfs, stop at the first missing one.
+    for (uint32_t node = 0; ; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            break;
+        }
+
+        std::string list;
+        std::getline(file, list);
+        for (auto cpu : ParseCpuList(list)) {
+            if (!hasAllowed || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) {
+                processors.push_back({ cpu, node });
+            }
+        }
+    }
+
+    if (processors.empty() && hasAllowed) {
+        for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                processors.push_back({ cpu, 0 });
+            }
+        }
+    }
+#elif defined(OS_WINDOWS)
+    // Only processor group 0 is considered, which covers up to 64 logical processors.
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    ::GetProcessAffinityMask(::GetCurrentProcess(), &processMask, &systemMask);
+
+    ULONG highestNode = 0;
+    if (::GetNumaHighestNodeNumber(&highestNode) == TRUE) {
+        for (ULONG node = 0; node <= highestNode; ++node) {
+            ULONGLONG nodeMask = 0;
+            if (::GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &nodeMask) != TRUE) {
+                continue;
+            }
+
+            for (uint32_t cpu = 0; cpu < sizeof(DWORD_PTR) * 8; ++cpu) {
+                auto bit = static_cast<DWORD_PTR>(1) << cpu;
+                if ((nodeMask & bit) != 0 && (processMask & bit) != 0) {
+                    processors.push_back({ cpu, static_cast<uint32_t>(node) });
+                }
+            }
+        }
+    }
+#endif
+
+    // Fallback for platforms without topology information: a single node.
+    if (processors.empty()) {
+        auto count = std::max(std::thread::hardware_concurrency(), 1u);
+        for (uint32_t cpu = 0; cpu < count; ++cpu) {
+            processors.push_back({ cpu, 0 });
+        }
+    }
+
+    std::stable_sort(processors.begin(), processors.end(), [](const Processor& left, const Processor& right) {
+        return left.numaNode < right.numaNode || (left.numaNode == right.numaNode && left.id < right.id);
+    });
+    return processors;
+}
+
+const std::vector<Processor>& GetProcessorTopology() {
+    static const std::vector<Processor> topology = DetectProcessorTopology();
+    return topology;
+}
+
+bool SetCurrentThreadAffinity(const std::vector<uint32_t>& processorIds) {
+    if (processorIds.empty()) {
+        return false;
+    }
+
+#if defined(OS_LINUX)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (auto id : processorIds) {
+        if (id >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(id, &cpus);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#elif defined(OS_WINDOWS)
+    DWORD_PTR mask = 0;
+    for (auto id : processorIds) {
+        if (id >= sizeof(DWORD_PTR) * 8) {
+            return false;
+        }
+        mask |= static_cast<DWORD_PTR>(1) << id;
+    }
+    return ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0;
+#else
+    // macOS only supports affinity hints through thread_policy_set, which are not binding.
+    return false;
+#endif
+}
+
+bool SetCurrentThreadPriority(ThreadPriority priority) {
+#if defined(OS_LINUX)
+    // Linux threads have a nice value of their own, which setpriority sets given the thread id.
+    static const int NICE_VALUES[] = { 19, 10, 0, -10, -20 };
+    auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, tid, NICE_VALUES[static_cast<int>(priority)]) == 0;
+#elif defined(OS_WINDOWS)
+    static const int PRIORITIES[] = {
+        THREAD_PRIORITY_LOWEST,
+        THREAD_PRIORITY_BELOW_NORMAL,
+        THREAD_PRIORITY_NORMAL,
+        THREAD_PRIORITY_ABOVE_NORMAL,
+        THREAD_PRIORITY_HIGHEST
+    };
+    return ::SetThreadPriority(::GetCurrentThread(), PRIORITIES[static_cast<int>(priority)]) != 0;
+#else
+    return priority == ThreadPriority::NORMAL;
+#endif
+}
+
+struct Thread::Impl {
+    std::function<void()> function;
+#ifdef SUPPORT_POSIX
+    pthread_t handle;
+#else
+    HANDLE handle;
+#endif
+};
+
+namespace {
+#ifdef SUPPORT_POSIX
+    void* RunThread(void* arg) {
+        (*static_cast<std::function<void()>*>(arg))();
+        return nullptr;
+    }
+#else
+    DWORD WINAPI RunThread(LPVOID arg) {
+        (*static_cast<std::function<void()>*>(arg))();
+        return 0;
+    }
+#endif
+}
+
+Thread::Thread() = default;
+
+Thread::Thread(std::function<void()> function, size_t stackSize) : _impl(std::make_unique<Impl>()) {
+    _impl->function = std::move(function);
+
+#ifdef SUPPORT_POSIX
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    if (stackSize > 0) {
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        stackSize = std::max(stackSize, static_cast<size_t>(PTHREAD_STACK_MIN));
+        stackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+        pthread_attr_setstacksize(&attributes, stackSize);
+    }
+    auto error = pthread_create(&_impl->handle, &attributes, RunThread, &_impl->function);
+    pthread_attr_destroy(&attributes);
+
+    if (error != 0) {
+        _impl.reset();
+        throw std::system_error(error, std::generic_category(), "Failed to create thread");
+    }
+#else
+    // The size is reserved, and committed as the stack grows.
+    _impl->handle = ::CreateThread(nullptr, stackSize, RunThread, &_impl->function, STACK_SIZE_PARAM_IS_A_RESERVATION, nullptr);
+    if (_impl->handle == nullptr) {
+        auto error = static_cast<int>(::GetLastError());
+        _impl.reset();
+        throw std::system_error(error, std::system_category(), "Failed to create thread");
+    }
+#endif
+}
+
+Thread::~Thread() {
+    if (Joinable()) {
+        std::terminate();
+    }
+}
+
+Thread::Thread(Thread&&) = default;
+
+Thread& Thread::operator=(Thread&& other) {
+    if (Joinable()) {
+        std::terminate();
+    }
+    _impl = std::move(other._impl);
+    return *this;
+}
+
+bool Thread::Joinable() const {
+    return _impl != nullptr;
+}
+
+void Thread::Join() {
+    if (!Joinable()) {
+        throw std::system_error(std::make_error_code(std::errc::invalid_argument), "Thread is not joinable");
+    }
+
+#ifdef SUPPORT_POSIX
+    pthread_join(_impl->handle, nullptr);
+#else
+    ::WaitForSingleObject(_impl->handle, INFINITE);
+    ::CloseHandle(_impl->handle);
+#endif
+    _impl.reset();
+}
+
 }
 }
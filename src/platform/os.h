@@ -3,6 +3,12 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
 namespace napa {
 namespace platform {
     /// <summary> Get OS type. </summary>
@@ -13,5 +19,66 @@ namespace platform {
 
     /// <summary> Directory separator. </summary>
     extern const char* DIR_SEPARATOR;
+
+    /// <summary> A logical processor available to the current process. </summary>
+    struct Processor {
+        /// <summary> The OS id of the logical processor. </summary>
+        uint32_t id;
+
+        /// <summary> The NUMA node the processor belongs to, 0 on machines without NUMA. </summary>
+        uint32_t numaNode;
+    };
+
+    /// <summary> Get logical processors available to the current process, ordered by NUMA node then by id. </summary>
+    /// <remarks> The topology is detected once and cached. </remarks>
+    const std::vector<Processor>& GetProcessorTopology();
+
+    /// <summary> Restrict the current thread to run on given logical processors. </summary>
+    /// <returns> True if affinity was set, false if it failed or the platform doesn't support it. </returns>
+    bool SetCurrentThreadAffinity(const std::vector<uint32_t>& processorIds);
+
+    /// <summary> OS scheduling priorities of threads, relative to the other threads of the host. </summary>
+    enum class ThreadPriority {
+        LOWEST,
+        LOW,
+        NORMAL,
+        HIGH,
+        HIGHEST
+    };
+
+    /// <summary> Set the OS scheduling priority of the current thread. </summary>
+    /// <returns> True if the priority was set, false if it failed, e.g. raising it requires privileges, or the platform doesn't support it. </returns>
+    /// <remarks> On Linux, priorities are nice values of the thread, from 19 for LOWEST to -20 for HIGHEST. </remarks>
+    bool SetCurrentThreadPriority(ThreadPriority priority);
+
+    /// <summary> A thread created with an explicit stack size, which std::thread doesn't support. </summary>
+    /// <remarks> Like std::thread, a thread must be joined before it's destroyed. </remarks>
+    class Thread {
+    public:
+
+        /// <summary> An empty thread, which is not joinable. </summary>
+        Thread();
+
+        /// <summary> Starts a thread running a function. </summary>
+        /// <param name="function"> The function the thread runs. </param>
+        /// <param name="stackSize"> The stack size in bytes, rounded up to pages and to the OS minimum. 0 for the OS default. </param>
+        /// <remarks> Throws std::system_error if the thread can't be started. </remarks>
+        Thread(std::function<void()> function, size_t stackSize);
+
+        ~Thread();
+
+        Thread(Thread&&);
+        Thread& operator=(Thread&&);
+
+        /// <summary> Whether the thread was started and not joined yet. </summary>
+        bool Joinable() const;
+
+        /// <summary> Waits for the thread to finish. </summary>
+        void Join();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> _impl;
+    };
 }
 }
@@ -8,7 +8,9 @@
 
 #include <unistd.h>
 #include <limits.h>
+#include <pthread.h>
 #include <sys/syscall.h>
+#include <time.h>
 
 #else
 
@@ -19,6 +21,8 @@
 
 #endif
 
+#include <functional>
+
 #include <sys/stat.h>
 
 #include <memory>
@@ -162,6 +166,81 @@ int32_t Gettid() {
 #endif
 }
 
+int64_t GetThreadCpuTime() {
+#ifdef SUPPORT_POSIX
+    timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+        return 0;
+    }
+    return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#else
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+
+    // FILETIME counts 100 nanosecond intervals.
+    auto toInt64 = [](const FILETIME& time) {
+        return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (toInt64(kernelTime) + toInt64(userTime)) * 100;
+#endif
+}
+
+#ifndef SUPPORT_POSIX
+namespace {
+    /// <summary> A real handle of the calling thread, GetCurrentThread() only returns a pseudo handle. Closed as the thread exits. </summary>
+    struct ThreadHandle {
+        ThreadHandle() : handle(nullptr) {
+            DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &handle, THREAD_QUERY_LIMITED_INFORMATION, FALSE, 0);
+        }
+
+        ~ThreadHandle() {
+            if (handle != nullptr) {
+                CloseHandle(handle);
+            }
+        }
+
+        HANDLE handle;
+    };
+}
+#endif
+
+ThreadCpuClock GetCurrentThreadCpuClock() {
+#ifdef SUPPORT_POSIX
+    clockid_t clock;
+    if (pthread_getcpuclockid(pthread_self(), &clock) != 0) {
+        return static_cast<ThreadCpuClock>(CLOCK_THREAD_CPUTIME_ID);
+    }
+    return static_cast<ThreadCpuClock>(clock);
+#else
+    thread_local ThreadHandle thread;
+    return static_cast<ThreadCpuClock>(reinterpret_cast<intptr_t>(thread.handle));
+#endif
+}
+
+int64_t GetThreadCpuTime(ThreadCpuClock clock) {
+#ifdef SUPPORT_POSIX
+    timespec time;
+    if (clock_gettime(static_cast<clockid_t>(clock), &time) != 0) {
+        return 0;
+    }
+    return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#else
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    auto handle = reinterpret_cast<HANDLE>(static_cast<intptr_t>(clock));
+    if (handle == nullptr || !GetThreadTimes(handle, &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+
+    // FILETIME counts 100 nanosecond intervals.
+    auto toInt64 = [](const FILETIME& time) {
+        return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (toInt64(kernelTime) + toInt64(userTime)) * 100;
+#endif
+}
+
 int32_t Isatty(int32_t fd) {
 #ifdef SUPPORT_POSIX
     return static_cast<int32_t>(isatty(fd));
@@ -30,6 +30,19 @@ namespace platform {
     /// <summary> Return tid. </summary>
     int32_t Gettid();
 
+    /// <summary> Return CPU time the calling thread consumed in user and kernel mode, in nanoseconds. </summary>
+    int64_t GetThreadCpuTime();
+
+    /// <summary> Identifies the CPU time clock of a thread, which other threads can read. </summary>
+    typedef int64_t ThreadCpuClock;
+
+    /// <summary> Return the CPU time clock of the calling thread, which is valid until the thread exits. </summary>
+    ThreadCpuClock GetCurrentThreadCpuClock();
+
+    /// <summary> Return CPU time the thread of a clock consumed in user and kernel mode, in nanoseconds. 0 if unavailable. </summary>
+    /// <param name="clock"> The clock of the thread, the thread must not have exited. </param>
+    int64_t GetThreadCpuTime(ThreadCpuClock clock);
+
     /// <summary> Return nonzero value if a descriptor is associated with a character device. </summary>
     /// <param name="fd"> File descriptor. </param>
     int32_t Isatty(int32_t fd);
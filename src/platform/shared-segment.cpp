@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <platform/shared-segment.h>
+#include <platform/platform.h>
+
+#ifdef SUPPORT_POSIX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+#else
+
+#pragma push_macro("NOMINMAX")
+#define NOMINMAX
+#include <windows.h>
+#pragma pop_macro("NOMINMAX")
+
+#endif
+
+namespace napa {
+namespace platform {
+
+std::unique_ptr<SharedSegment> SharedSegment::Open(const std::string& name, size_t size, bool& created) {
+    std::unique_ptr<SharedSegment> segment(new SharedSegment());
+
+#ifdef SUPPORT_POSIX
+    auto path = "/" + name;
+    created = true;
+    auto fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        created = false;
+        fd = ::shm_open(path.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    if (created) {
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            ::shm_unlink(path.c_str());
+            return nullptr;
+        }
+    } else {
+        // The creator sizes the segment right after creating it, which an opener may race with.
+        struct stat status;
+        for (int i = 0; ; ++i) {
+            if (::fstat(fd, &status) != 0 || i == 1000) {
+                ::close(fd);
+                return nullptr;
+            }
+            if (status.st_size > 0) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        size = static_cast<size_t>(status.st_size);
+    }
+
+    auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        if (created) {
+            ::shm_unlink(path.c_str());
+        }
+        return nullptr;
+    }
+#else
+    auto mapping = ::CreateFileMappingA(
+        INVALID_HANDLE_VALUE,
+        nullptr,
+        PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+        static_cast<DWORD>(size),
+        ("Local\\" + name).c_str());
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+    created = ::GetLastError() != ERROR_ALREADY_EXISTS;
+
+    auto data = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (data == nullptr) {
+        ::CloseHandle(mapping);
+        return nullptr;
+    }
+
+    MEMORY_BASIC_INFORMATION info;
+    ::VirtualQuery(data, &info, sizeof(info));
+    size = static_cast<size_t>(info.RegionSize);
+    segment->_mapping = mapping;
+#endif
+
+    segment->_data = static_cast<char*>(data);
+    segment->_size = size;
+    return segment;
+}
+
+void SharedSegment::Remove(const std::string& name) {
+#ifdef SUPPORT_POSIX
+    ::shm_unlink(("/" + name).c_str());
+#endif
+}
+
+SharedSegment::~SharedSegment() {
+#ifdef SUPPORT_POSIX
+    ::munmap(_data, _size);
+#else
+    ::UnmapViewOfFile(_data);
+    ::CloseHandle(_mapping);
+#endif
+}
+
+constexpr size_t InterprocessMutex::STORAGE_SIZE;
+
+InterprocessMutex::InterprocessMutex(void* storage, const std::string& name, bool initialize) {
+#ifdef SUPPORT_POSIX
+    static_assert(sizeof(pthread_mutex_t) <= STORAGE_SIZE, "STORAGE_SIZE is too small for pthread_mutex_t");
+
+    // Robust mutexes live in the shared memory itself, only named Windows mutexes need the name.
+    (void)name;
+
+    auto mutex = static_cast<pthread_mutex_t*>(storage);
+    if (initialize) {
+        pthread_mutexattr_t attributes;
+        ::pthread_mutexattr_init(&attributes);
+        ::pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        ::pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        ::pthread_mutex_init(mutex, &attributes);
+        ::pthread_mutexattr_destroy(&attributes);
+    }
+    _handle = mutex;
+#else
+    _handle = ::CreateMutexA(nullptr, FALSE, ("Local\\" + name).c_str());
+#endif
+}
+
+InterprocessMutex::~InterprocessMutex() {
+#ifndef SUPPORT_POSIX
+    ::CloseHandle(_handle);
+#endif
+}
+
+void InterprocessMutex::lock() {
+#ifdef SUPPORT_POSIX
+    auto mutex = static_cast<pthread_mutex_t*>(_handle);
+    if (::pthread_mutex_lock(mutex) == EOWNERDEAD) {
+        ::pthread_mutex_consistent(mutex);
+    }
+#else
+    ::WaitForSingleObject(_handle, INFINITE);
+#endif
+}
+
+void InterprocessMutex::unlock() {
+#ifdef SUPPORT_POSIX
+    ::pthread_mutex_unlock(static_cast<pthread_mutex_t*>(_handle));
+#else
+    ::ReleaseMutex(_handle);
+#endif
+}
+
+}
+}
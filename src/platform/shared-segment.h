@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace napa {
+namespace platform {
+
+    /// <summary> Cross-platform named shared memory, which all processes of the host mapping the same name share. </summary>
+    class SharedSegment {
+    public:
+        /// <summary> Maps a segment, which is created zero-filled with the given size if it doesn't exist. </summary>
+        /// <param name="name"> Name of the segment, without path separators. </param>
+        /// <param name="size"> Size of a created segment, an existing one keeps its own. </param>
+        /// <param name="created"> Receives whether the segment is created by this call. </param>
+        /// <returns> The mapped segment, or nullptr if it can't be created or mapped. </returns>
+        static std::unique_ptr<SharedSegment> Open(const std::string& name, size_t size, bool& created);
+
+        /// <summary> Removes the name of a segment, so later opens create a new one. Mapped segments stay valid. </summary>
+        /// <remarks> No-op on Windows, where a segment is gone once the last process unmaps it. </remarks>
+        static void Remove(const std::string& name);
+
+        /// <summary> Unmaps the segment. </summary>
+        ~SharedSegment();
+
+        /// <summary> Non-copyable. </summary>
+        SharedSegment(const SharedSegment&) = delete;
+        SharedSegment& operator=(const SharedSegment&) = delete;
+
+        /// <summary> Get address of the mapped segment, which differs among processes. </summary>
+        char* GetData() const {
+            return _data;
+        }
+
+        /// <summary> Get size of the segment in bytes. </summary>
+        size_t GetSize() const {
+            return _size;
+        }
+
+    private:
+        SharedSegment() = default;
+
+        char* _data = nullptr;
+        size_t _size = 0;
+        void* _mapping = nullptr;
+    };
+
+    /// <summary> Mutex shared by processes, whose state lives in a shared segment. </summary>
+    /// <remarks>
+    ///     On POSIX it's a robust process-shared pthread mutex within the segment, so a process that dies while
+    ///     holding it doesn't block others forever. On Windows it's a named mutex, the storage is unused.
+    /// </remarks>
+    class InterprocessMutex {
+    public:
+        /// <summary> Bytes to reserve in a shared segment for the state of a mutex. </summary>
+        static constexpr size_t STORAGE_SIZE = 64;
+
+        /// <summary> Constructor. </summary>
+        /// <param name="storage"> STORAGE_SIZE bytes in a shared segment, 8-byte aligned. </param>
+        /// <param name="name"> Name of the mutex, unique on the host. </param>
+        /// <param name="initialize"> Whether to initialize the storage, by the process that created the segment only. </param>
+        InterprocessMutex(void* storage, const std::string& name, bool initialize);
+
+        /// <summary> Destructor, which leaves a POSIX mutex in the segment for other processes. </summary>
+        ~InterprocessMutex();
+
+        /// <summary> Non-copyable. </summary>
+        InterprocessMutex(const InterprocessMutex&) = delete;
+        InterprocessMutex& operator=(const InterprocessMutex&) = delete;
+
+        /// <summary> Acquires the mutex. A mutex abandoned by a dead owner is acquired as is. </summary>
+        void lock();
+
+        /// <summary> Releases the mutex. </summary>
+        void unlock();
+
+    private:
+        void* _handle;
+    };
+}
+}
@@ -0,0 +1,241 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <platform/socket.h>
+#include <platform/platform.h>
+
+#ifdef SUPPORT_POSIX
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#else
+
+#pragma push_macro("NOMINMAX")
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma pop_macro("NOMINMAX")
+
+#include <algorithm>
+#include <climits>
+#include <mutex>
+
+#endif
+
+namespace napa {
+namespace platform {
+
+namespace {
+
+#ifdef SUPPORT_POSIX
+    constexpr intptr_t INVALID_HANDLE = -1;
+
+    void CloseHandle(intptr_t handle) {
+        ::close(static_cast<int>(handle));
+    }
+#else
+    constexpr intptr_t INVALID_HANDLE = static_cast<intptr_t>(INVALID_SOCKET);
+
+    void CloseHandle(intptr_t handle) {
+        ::closesocket(static_cast<SOCKET>(handle));
+    }
+
+    /// <summary> Winsock is started once per process, and left for the process exit to clean up. </summary>
+    void StartWinsock() {
+        static std::once_flag started;
+        std::call_once(started, []() {
+            WSADATA data;
+            ::WSAStartup(MAKEWORD(2, 2), &data);
+        });
+    }
+#endif
+
+    /// <summary> Resolves the addresses of a host, which the caller frees with freeaddrinfo. </summary>
+    addrinfo* Resolve(const std::string& host, uint16_t port, bool passive) {
+#ifndef SUPPORT_POSIX
+        StartWinsock();
+#endif
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+        addrinfo* addresses = nullptr;
+        auto service = std::to_string(port);
+        if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &addresses) != 0) {
+            return nullptr;
+        }
+        return addresses;
+    }
+
+    void DisableNagle(intptr_t handle) {
+        int noDelay = 1;
+        ::setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    }
+}
+
+std::unique_ptr<Socket> Socket::Connect(const std::string& host, uint16_t port) {
+    auto addresses = Resolve(host, port, false);
+    if (addresses == nullptr) {
+        return nullptr;
+    }
+
+    auto handle = INVALID_HANDLE;
+    for (auto address = addresses; address != nullptr; address = address->ai_next) {
+        handle = static_cast<intptr_t>(::socket(address->ai_family, address->ai_socktype, address->ai_protocol));
+        if (handle == INVALID_HANDLE) {
+            continue;
+        }
+        if (::connect(handle, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) {
+            break;
+        }
+        CloseHandle(handle);
+        handle = INVALID_HANDLE;
+    }
+    ::freeaddrinfo(addresses);
+
+    if (handle == INVALID_HANDLE) {
+        return nullptr;
+    }
+    DisableNagle(handle);
+    return std::unique_ptr<Socket>(new Socket(handle));
+}
+
+std::unique_ptr<Socket> Socket::Listen(const std::string& host, uint16_t port, uint16_t& boundPort) {
+    auto addresses = Resolve(host, port, true);
+    if (addresses == nullptr) {
+        return nullptr;
+    }
+
+    auto handle = INVALID_HANDLE;
+    for (auto address = addresses; address != nullptr; address = address->ai_next) {
+        handle = static_cast<intptr_t>(::socket(address->ai_family, address->ai_socktype, address->ai_protocol));
+        if (handle == INVALID_HANDLE) {
+            continue;
+        }
+
+#ifdef SUPPORT_POSIX
+        // A host restarting on the same port shouldn't wait for connections of its previous run to time out.
+        int reuse = 1;
+        ::setsockopt(static_cast<int>(handle), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+        if (::bind(handle, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 && ::listen(handle, SOMAXCONN) == 0) {
+            break;
+        }
+        CloseHandle(handle);
+        handle = INVALID_HANDLE;
+    }
+    ::freeaddrinfo(addresses);
+
+    if (handle == INVALID_HANDLE) {
+        return nullptr;
+    }
+
+    sockaddr_storage bound = {};
+#ifdef SUPPORT_POSIX
+    socklen_t boundSize = sizeof(bound);
+#else
+    int boundSize = sizeof(bound);
+#endif
+    if (::getsockname(handle, reinterpret_cast<sockaddr*>(&bound), &boundSize) != 0) {
+        CloseHandle(handle);
+        return nullptr;
+    }
+    boundPort = ntohs(bound.ss_family == AF_INET6 ?
+        reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port :
+        reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+
+    return std::unique_ptr<Socket>(new Socket(handle));
+}
+
+Socket::Socket(intptr_t handle) : _handle(handle) {}
+
+Socket::~Socket() {
+    if (_handle != INVALID_HANDLE) {
+        CloseHandle(_handle);
+    }
+}
+
+std::unique_ptr<Socket> Socket::Accept() {
+    while (true) {
+        auto handle = static_cast<intptr_t>(::accept(_handle, nullptr, nullptr));
+        if (handle != INVALID_HANDLE) {
+            DisableNagle(handle);
+            return std::unique_ptr<Socket>(new Socket(handle));
+        }
+#ifdef SUPPORT_POSIX
+        // A peer that went away before it was accepted doesn't stop listening.
+        if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+#endif
+        return nullptr;
+    }
+}
+
+bool Socket::Send(const char* data, size_t size) {
+    while (size > 0) {
+#ifdef SUPPORT_POSIX
+#ifdef MSG_NOSIGNAL
+        // A peer closing the connection fails the send, rather than raising SIGPIPE.
+        auto sent = ::send(static_cast<int>(_handle), data, size, MSG_NOSIGNAL);
+#else
+        auto sent = ::send(static_cast<int>(_handle), data, size, 0);
+#endif
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+#else
+        auto sent = ::send(static_cast<SOCKET>(_handle), data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+#endif
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool Socket::Receive(char* data, size_t size) {
+    while (size > 0) {
+#ifdef SUPPORT_POSIX
+        auto received = ::recv(static_cast<int>(_handle), data, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+#else
+        auto received = ::recv(static_cast<SOCKET>(_handle), data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+#endif
+        if (received <= 0) {
+            return false;
+        }
+        data += received;
+        size -= static_cast<size_t>(received);
+    }
+    return true;
+}
+
+void Socket::Shutdown() {
+#ifdef SUPPORT_POSIX
+    ::shutdown(static_cast<int>(_handle), SHUT_RDWR);
+#else
+    // Shutting a listening socket down doesn't unblock accept on Windows, closing it does.
+    auto handle = _handle.exchange(INVALID_HANDLE);
+    if (handle != INVALID_HANDLE) {
+        ::shutdown(static_cast<SOCKET>(handle), SD_BOTH);
+        CloseHandle(handle);
+    }
+#endif
+}
+
+}
+}
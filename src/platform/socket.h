@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace napa {
+namespace platform {
+
+    /// <summary> Cross-platform blocking TCP socket, either connected to a peer or listening for peers. </summary>
+    /// <remarks> Connected sockets have Nagle's algorithm disabled, since their frames are written whole. </remarks>
+    class Socket {
+    public:
+        /// <summary> Connects to a peer. </summary>
+        /// <param name="host"> Host name or IP address. </param>
+        /// <param name="port"> Port number. </param>
+        /// <returns> The connected socket, or nullptr if the host can't be resolved or reached. </returns>
+        static std::unique_ptr<Socket> Connect(const std::string& host, uint16_t port);
+
+        /// <summary> Listens for peers. </summary>
+        /// <param name="host"> Host name or IP address of the interface to listen on. </param>
+        /// <param name="port"> Port number, 0 for any free port. </param>
+        /// <param name="boundPort"> Receives the port the socket listens on. </param>
+        /// <returns> The listening socket, or nullptr if the address can't be bound. </returns>
+        static std::unique_ptr<Socket> Listen(const std::string& host, uint16_t port, uint16_t& boundPort);
+
+        /// <summary> Closes the socket. </summary>
+        ~Socket();
+
+        /// <summary> Non-copyable. </summary>
+        Socket(const Socket&) = delete;
+        Socket& operator=(const Socket&) = delete;
+
+        /// <summary> Waits for a peer to connect to a listening socket. </summary>
+        /// <returns> The socket connected to the peer, or nullptr once the socket is shut down. </returns>
+        std::unique_ptr<Socket> Accept();
+
+        /// <summary> Sends all bytes. </summary>
+        /// <returns> False if the connection is broken. </returns>
+        bool Send(const char* data, size_t size);
+
+        /// <summary> Receives exactly size bytes. </summary>
+        /// <returns> False if the connection is closed or broken before. </returns>
+        bool Receive(char* data, size_t size);
+
+        /// <summary> Shuts the socket down, which unblocks Accept() and Receive() called by other threads. </summary>
+        void Shutdown();
+
+    private:
+        explicit Socket(intptr_t handle);
+
+        /// <summary> The native socket, atomic as Shutdown() invalidates it on Windows while other threads use it. </summary>
+        std::atomic<intptr_t> _handle;
+    };
+}
+}
@@ -48,11 +48,10 @@ namespace tls {
 #endif
         }
 
-        /// <summary> Per-thread install object of T.  </summary>
+        /// <summary> Per-thread install object of T, replacing the object installed before if any. </summary>
         template <typename... Args>
         void Install(Args&&... args) {
-            auto object = new T(std::forward<Args>(args)...);
-            TlsSet(object);
+            Reset(new T(std::forward<Args>(args)...));
         }
 
         T& operator*() {
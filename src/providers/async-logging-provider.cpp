@@ -0,0 +1,433 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "async-logging-provider.h"
+#include "log-record.h"
+
+#include <napa/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace napa::providers;
+
+constexpr uint32_t AsyncLoggingProvider::DEFAULT_BUFFER_SIZE;
+constexpr std::chrono::milliseconds AsyncLoggingProvider::FLUSH_INTERVAL;
+
+namespace {
+
+    /// <summary> Size of the buffer of messages written at once. </summary>
+    constexpr size_t BATCH_SIZE = 64 * 1024;
+
+    /// <summary> Format of messages formatted before they are logged. </summary>
+    const char* const TEXT_FORMAT = "%s";
+
+    /// <summary> Format of the message reporting dropped messages. </summary>
+    const char* const DROPPED_FORMAT = "%llu message(s) dropped, logging threads queued more than %u messages.";
+
+    /// <summary> Copies a string, truncated to fit with its terminating null character. </summary>
+    template <size_t N>
+    void CopyString(char (&destination)[N], const char* source) {
+        if (source == nullptr) {
+            destination[0] = '\0';
+            return;
+        }
+        auto length = strnlen(source, N - 1);
+        std::memcpy(destination, source, length);
+        destination[length] = '\0';
+    }
+
+    /// <summary> Copies the end of a path, which names the file, truncated to fit. </summary>
+    template <size_t N>
+    void CopyPathEnd(char (&destination)[N], const char* source) {
+        if (source == nullptr) {
+            destination[0] = '\0';
+            return;
+        }
+        auto length = std::strlen(source);
+        auto start = length < N ? 0 : length - (N - 1);
+        std::memcpy(destination, source + start, length - start + 1);
+    }
+
+    uint32_t RoundUpToPowerOf2(uint32_t value) {
+        uint32_t result = 1;
+        while (result < value && result < (1u << 31)) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::atomic<uint64_t> _nextProviderId(1);
+}
+
+/// <summary> A message as queued by a logging thread, with its arguments to be formatted by the flusher. </summary>
+struct AsyncLoggingProvider::Record {
+    const char* format;
+
+    /// <summary> The source file if the caller guarantees it's kept, nullptr if it's copied to fileCopy. </summary>
+    const char* file;
+
+    int line;
+    Verboseness level;
+    uint32_t size;
+    char section[64];
+    char fileCopy[128];
+    char data[LOG_MAX_SIZE + 32];
+
+    const char* GetFile() const {
+        return file != nullptr ? file : fileCopy;
+    }
+};
+
+/// <summary> Single producer, single consumer ring of records, the producer being the thread owning it. </summary>
+class AsyncLoggingProvider::Ring {
+public:
+    explicit Ring(uint32_t capacity) :
+        _records(new Record[capacity]),
+        _mask(capacity - 1),
+        _head(0),
+        _tail(0),
+        _dropped(0),
+        _abandoned(false) {
+    }
+
+    /// <summary> Queues a record filled by a function, returns the number of queued records including it, 0 if the ring was full. </summary>
+    template <typename Fill>
+    uint64_t Push(Fill fill) {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        auto size = tail - _head.load(std::memory_order_acquire);
+        if (size > _mask) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        fill(_records[tail & _mask]);
+
+        _tail.store(tail + 1, std::memory_order_release);
+        return size + 1;
+    }
+
+    /// <summary> Calls a function with each queued record, then releases them. Must not be called concurrently. </summary>
+    template <typename Function>
+    void Pop(Function function) {
+        auto head = _head.load(std::memory_order_relaxed);
+        auto tail = _tail.load(std::memory_order_acquire);
+        for (auto i = head; i != tail; ++i) {
+            function(_records[i & _mask]);
+        }
+        _head.store(tail, std::memory_order_release);
+    }
+
+    bool IsEmpty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    uint64_t GetCapacity() const {
+        return _mask + 1;
+    }
+
+    uint64_t GetDroppedCount() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /// <summary> Marks that the owning thread exited, so the ring is removed once drained. </summary>
+    void Abandon() {
+        _abandoned.store(true, std::memory_order_release);
+    }
+
+    bool IsAbandoned() const {
+        return _abandoned.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<Record[]> _records;
+    const uint64_t _mask;
+
+    // Written by the consumer and the producer respectively, on separate cache lines.
+    alignas(64) std::atomic<uint64_t> _head;
+    alignas(64) std::atomic<uint64_t> _tail;
+
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool> _abandoned;
+};
+
+namespace {
+
+    /// <summary> The ring of a thread, abandoned when the thread exits. </summary>
+    template <typename Ring>
+    struct ThreadRing {
+        uint64_t providerId = 0;
+        std::shared_ptr<Ring> ring;
+
+        ~ThreadRing() {
+            if (ring != nullptr) {
+                ring->Abandon();
+            }
+        }
+    };
+}
+
+AsyncLoggingProvider::AsyncLoggingProvider(const std::string& path, uint32_t bufferSize, bool binary) :
+    _id(_nextProviderId++),
+    _bufferSize(RoundUpToPowerOf2(bufferSize == 0 ? DEFAULT_BUFFER_SIZE : bufferSize)),
+    _binary(binary),
+    _output(stdout),
+    _ownsOutput(false),
+    _removedDroppedCount(0),
+    _reportedDroppedCount(0),
+    _flushRequested(false),
+    _startedDrains(0),
+    _completedDrains(0),
+    _stopped(false) {
+
+    if (!path.empty()) {
+        auto output = fopen(path.c_str(), "ab");
+        if (output != nullptr) {
+            _output = output;
+            _ownsOutput = true;
+        } else {
+            fprintf(stderr, "Failed to open log file '%s', logging to the standard output.\n", path.c_str());
+        }
+    }
+
+    _batch.reserve(BATCH_SIZE);
+    if (_binary) {
+        _binaryWriter.WriteHeader(_batch);
+    }
+    _flusher = std::thread(&AsyncLoggingProvider::RunFlusher, this);
+}
+
+AsyncLoggingProvider::~AsyncLoggingProvider() {
+    Destroy();
+
+    if (_ownsOutput) {
+        fclose(_output);
+    }
+}
+
+void AsyncLoggingProvider::LogMessage(
+    const char* section,
+    Verboseness level,
+    const char* /*traceId*/,
+    const char* file,
+    int line,
+    const char* message) {
+
+    Queue([section, level, file, line, message](Record& record) {
+        LogArgument argument;
+        argument.type = LogArgument::Type::STRING;
+        argument.pointerValue = message;
+
+        CopyString(record.section, section);
+        CopyPathEnd(record.fileCopy, file);
+        record.file = nullptr;
+        record.line = line;
+        record.level = level;
+        record.format = TEXT_FORMAT;
+        record.size = static_cast<uint32_t>(EncodeLogArguments(&argument, 1, record.data, sizeof(record.data)));
+    });
+}
+
+void AsyncLoggingProvider::LogDeferred(
+    const char* section,
+    Verboseness level,
+    const char* /*traceId*/,
+    const char* file,
+    int line,
+    const char* format,
+    const LogArgument* arguments,
+    size_t count) {
+
+    Queue([section, level, file, line, format, arguments, count](Record& record) {
+        CopyString(record.section, section);
+        record.file = file;
+        record.line = line;
+        record.level = level;
+        record.format = format;
+        record.size = static_cast<uint32_t>(EncodeLogArguments(arguments, count, record.data, sizeof(record.data)));
+    });
+}
+
+template <typename Fill>
+void AsyncLoggingProvider::Queue(Fill fill) {
+    auto& ring = GetRing();
+    auto size = ring.Push(fill);
+
+    // Waking the flusher early keeps the ring from overflowing between two intervals.
+    if (size == ring.GetCapacity() / 2 + 1) {
+        _flusherCondition.notify_one();
+    }
+
+    // Once the flusher stopped, or while it's stopping, messages are written right away.
+    if (_stopped.load()) {
+        std::lock_guard<std::mutex> lock(_outputMutex);
+        Drain();
+    }
+}
+
+bool AsyncLoggingProvider::IsLogEnabled(const char* /*section*/, Verboseness /*level*/) {
+    return true;
+}
+
+void AsyncLoggingProvider::Destroy() {
+    {
+        std::lock_guard<std::mutex> lock(_flusherMutex);
+        _stopped.store(true);
+    }
+    _flusherCondition.notify_one();
+    _drainedCondition.notify_all();
+
+    if (_flusher.joinable()) {
+        _flusher.join();
+    }
+}
+
+void AsyncLoggingProvider::Flush() {
+    if (!_stopped.load()) {
+        std::unique_lock<std::mutex> lock(_flusherMutex);
+
+        // A drain that started before the call may have passed rings already.
+        auto target = _startedDrains + 1;
+        _flushRequested = true;
+        _flusherCondition.notify_one();
+        _drainedCondition.wait(lock, [this, target]() {
+            return _completedDrains >= target || _stopped.load();
+        });
+    }
+
+    std::lock_guard<std::mutex> lock(_outputMutex);
+    Drain();
+}
+
+uint64_t AsyncLoggingProvider::GetDroppedCount() const {
+    std::lock_guard<std::mutex> lock(_ringsMutex);
+
+    auto count = _removedDroppedCount.load();
+    for (auto& ring : _rings) {
+        count += ring->GetDroppedCount();
+    }
+    return count;
+}
+
+AsyncLoggingProvider::Ring& AsyncLoggingProvider::GetRing() {
+    thread_local ThreadRing<Ring> threadRing;
+
+    if (threadRing.providerId != _id) {
+        if (threadRing.ring != nullptr) {
+            threadRing.ring->Abandon();
+        }
+
+        threadRing.ring = std::make_shared<Ring>(_bufferSize);
+        threadRing.providerId = _id;
+
+        std::lock_guard<std::mutex> lock(_ringsMutex);
+        _rings.push_back(threadRing.ring);
+    }
+    return *threadRing.ring;
+}
+
+void AsyncLoggingProvider::RunFlusher() {
+    std::unique_lock<std::mutex> lock(_flusherMutex);
+    while (true) {
+        auto stopping = _stopped.load();
+        if (!stopping && !_flushRequested) {
+            _flusherCondition.wait_for(lock, FLUSH_INTERVAL);
+        }
+        _flushRequested = false;
+        auto drain = ++_startedDrains;
+        lock.unlock();
+
+        {
+            std::lock_guard<std::mutex> outputLock(_outputMutex);
+            Drain();
+        }
+
+        lock.lock();
+        _completedDrains = drain;
+        _drainedCondition.notify_all();
+
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+bool AsyncLoggingProvider::Drain() {
+    bool written = false;
+    uint64_t droppedCount = _removedDroppedCount.load();
+    {
+        std::lock_guard<std::mutex> lock(_ringsMutex);
+
+        auto end = std::remove_if(_rings.begin(), _rings.end(), [this, &written, &droppedCount](const std::shared_ptr<Ring>& ring) {
+            // Checked before draining, so the messages queued before the thread exited are written.
+            auto abandoned = ring->IsAbandoned();
+            if (!ring->IsEmpty()) {
+                ring->Pop([this](const Record& record) { Append(record); });
+                written = true;
+            }
+
+            droppedCount += ring->GetDroppedCount();
+            if (abandoned) {
+                _removedDroppedCount += ring->GetDroppedCount();
+            }
+            return abandoned;
+        });
+        _rings.erase(end, _rings.end());
+    }
+
+    if (droppedCount > _reportedDroppedCount) {
+        LogArgument arguments[2];
+        arguments[0].type = LogArgument::Type::UNSIGNED;
+        arguments[0].unsignedValue = droppedCount - _reportedDroppedCount;
+        arguments[1].type = LogArgument::Type::UNSIGNED;
+        arguments[1].unsignedValue = _bufferSize;
+        _reportedDroppedCount = droppedCount;
+
+        Record record;
+        CopyString(record.section, "Log");
+        record.file = __FILE__;
+        record.line = __LINE__;
+        record.level = Verboseness::Warning;
+        record.format = DROPPED_FORMAT;
+        record.size = static_cast<uint32_t>(EncodeLogArguments(arguments, 2, record.data, sizeof(record.data)));
+        Append(record);
+        written = true;
+    }
+
+    if (!_batch.empty()) {
+        Write(_batch.data(), _batch.size());
+        _batch.clear();
+    }
+
+    if (written) {
+        fflush(_output);
+    }
+    return written;
+}
+
+void AsyncLoggingProvider::Append(const Record& record) {
+    if (_binary) {
+        _binaryWriter.WriteRecord(
+            _batch,
+            record.level,
+            record.section,
+            record.GetFile(),
+            record.file != nullptr,
+            record.line,
+            record.format,
+            record.data,
+            record.size);
+    } else {
+        auto line = FormatLogLine(record.section, FormatLogMessage(record.format, record.data, record.size), record.GetFile(), record.line);
+        _batch.insert(_batch.end(), line.begin(), line.end());
+    }
+
+    if (_batch.size() >= BATCH_SIZE) {
+        Write(_batch.data(), _batch.size());
+        _batch.clear();
+    }
+}
+
+void AsyncLoggingProvider::Write(const char* data, size_t size) {
+    fwrite(data, 1, size, _output);
+}
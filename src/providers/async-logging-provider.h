@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "log-record.h"
+
+#include <napa/providers/logging.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> A logging provider that queues messages and writes them in batches on a background thread. </summary>
+    /// <remarks>
+    ///     Each logging thread copies messages into a ring buffer of its own, without locks or system calls, and a
+    ///     flusher thread drains all rings into a file, or the standard output, with one write per batch.
+    ///     Messages logged by LogDeferred are queued as their format and arguments, and formatted by the flusher,
+    ///     or written as binary records to be rendered by the log decoder.
+    ///     Messages of a thread keep their order, messages of different threads are ordered per batch only.
+    ///     When the ring of a thread is full, its messages are dropped and counted, and the flusher logs the count.
+    /// </remarks>
+    class AsyncLoggingProvider : public LoggingProvider, public DeferredLoggingProvider {
+    public:
+
+        /// <summary> Default number of messages each logging thread can queue. </summary>
+        static constexpr uint32_t DEFAULT_BUFFER_SIZE = 256;
+
+        /// <summary> Interval at which the flusher drains the rings, unless a ring fills up before. </summary>
+        static constexpr std::chrono::milliseconds FLUSH_INTERVAL = std::chrono::milliseconds(20);
+
+        /// <summary> Constructor, which starts the flusher thread. </summary>
+        /// <param name="path"> The file to append messages to, empty for the standard output. </param>
+        /// <param name="bufferSize"> The number of messages each thread can queue, rounded up to a power of 2, 0 for the default. </param>
+        /// <param name="binary"> Whether messages are written in the binary log format, see BinaryLogWriter. </param>
+        explicit AsyncLoggingProvider(const std::string& path = "", uint32_t bufferSize = DEFAULT_BUFFER_SIZE, bool binary = false);
+
+        /// <summary> Stops the flusher thread once all queued messages are written. </summary>
+        ~AsyncLoggingProvider();
+
+        /// <summary> Non-copyable. </summary>
+        AsyncLoggingProvider(const AsyncLoggingProvider&) = delete;
+        AsyncLoggingProvider& operator=(const AsyncLoggingProvider&) = delete;
+
+        virtual void LogMessage(
+            const char* section,
+            Verboseness level,
+            const char* traceId,
+            const char* file,
+            int line,
+            const char* message) override;
+
+        virtual void LogDeferred(
+            const char* section,
+            Verboseness level,
+            const char* traceId,
+            const char* file,
+            int line,
+            const char* format,
+            const LogArgument* arguments,
+            size_t count) override;
+
+        virtual bool IsLogEnabled(const char* section, Verboseness level) override;
+
+        /// <summary> Writes all queued messages, then stops the flusher. Later messages are written synchronously. </summary>
+        virtual void Destroy() override;
+
+        /// <summary> Waits until the messages queued by all threads before the call are written. </summary>
+        void Flush();
+
+        /// <summary> Gets the number of messages dropped because the ring of their thread was full. </summary>
+        uint64_t GetDroppedCount() const;
+
+    private:
+
+        struct Record;
+        class Ring;
+
+        /// <summary> Queues a record filled by a function in the ring of the calling thread. </summary>
+        template <typename Fill>
+        void Queue(Fill fill);
+
+        /// <summary> Gets the ring of the calling thread, registering one on its first message. </summary>
+        Ring& GetRing();
+
+        /// <summary> Loop of the flusher thread. </summary>
+        void RunFlusher();
+
+        /// <summary> Drains all rings into the output, returns whether any message was written. </summary>
+        bool Drain();
+
+        /// <summary> Appends a record to the batch, writing the batch once it's full. </summary>
+        void Append(const Record& record);
+
+        void Write(const char* data, size_t size);
+
+        /// <summary> Identifies this instance in the thread local ring of logging threads. </summary>
+        const uint64_t _id;
+
+        const uint32_t _bufferSize;
+
+        const bool _binary;
+        BinaryLogWriter _binaryWriter;
+
+        FILE* _output;
+        bool _ownsOutput;
+
+        /// <summary> The rings of all threads, whose threads may have exited. </summary>
+        std::vector<std::shared_ptr<Ring>> _rings;
+        mutable std::mutex _ringsMutex;
+
+        /// <summary> Messages dropped by rings that were removed. </summary>
+        std::atomic<uint64_t> _removedDroppedCount;
+
+        /// <summary> Dropped messages the flusher reported so far. </summary>
+        uint64_t _reportedDroppedCount;
+
+        std::vector<char> _batch;
+
+        /// <summary> Held while draining, by the flusher, or by logging threads once it stopped. </summary>
+        std::mutex _outputMutex;
+
+        std::mutex _flusherMutex;
+        std::condition_variable _flusherCondition;
+        std::condition_variable _drainedCondition;
+        bool _flushRequested;
+        uint64_t _startedDrains;
+        uint64_t _completedDrains;
+        std::atomic<bool> _stopped;
+        std::thread _flusher;
+    };
+
+}
+}
@@ -0,0 +1,257 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "console-sink.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace napa::providers;
+using napa::settings::ConsoleOutput;
+
+constexpr size_t ConsoleSink::DEFAULT_BUFFER_SIZE;
+constexpr std::chrono::milliseconds ConsoleSink::FLUSH_INTERVAL;
+
+namespace {
+
+    /// <summary> Format of the line reporting dropped lines. </summary>
+    const char* const DROPPED_FORMAT = "%llu console line(s) dropped, zone workers wrote more than console output keeps up with.\n";
+
+    std::atomic<uint64_t> _nextSinkId(1);
+}
+
+/// <summary> Lines of a thread not written yet, and what the thread may still write. </summary>
+struct ConsoleSink::Buffer {
+    std::mutex mutex;
+    std::string lines;
+
+    /// <summary> Lines the thread may write before the rate limit drops them, refilled over time up to the limit. </summary>
+    double tokens = 0;
+    std::chrono::steady_clock::time_point refilled;
+
+    uint64_t dropped = 0;
+
+    /// <summary> Set once the owning thread exited, so the buffer is removed once drained. </summary>
+    std::atomic<bool> abandoned { false };
+};
+
+namespace {
+
+    /// <summary> The buffer of a thread, abandoned when the thread exits. </summary>
+    template <typename Buffer>
+    struct ThreadBuffer {
+        uint64_t sinkId = 0;
+        std::shared_ptr<Buffer> buffer;
+
+        ~ThreadBuffer() {
+            if (buffer != nullptr) {
+                buffer->abandoned = true;
+            }
+        }
+    };
+}
+
+ConsoleSink& ConsoleSink::GetInstance() {
+    // Leaked like other process-wide objects, as workers may still write while static objects are destroyed.
+    static auto instance = new ConsoleSink();
+    static bool flushedAtExit = (std::atexit([]() { instance->Stop(); }) == 0);
+    (void)flushedAtExit;
+    return *instance;
+}
+
+ConsoleSink::ConsoleSink(FILE* output, size_t bufferSize) :
+    _id(_nextSinkId++),
+    _output(output),
+    _bufferSize(bufferSize),
+    _mode(ConsoleOutput::SYNC),
+    _rateLimit(0),
+    _stopped(false),
+    _removedDroppedCount(0),
+    _reportedDroppedCount(0),
+    _flusherStopping(false) {
+}
+
+ConsoleSink::~ConsoleSink() {
+    Stop();
+}
+
+void ConsoleSink::Configure(ConsoleOutput output, uint32_t rateLimit) {
+    _rateLimit = rateLimit;
+    _mode = output;
+
+    if (output == ConsoleOutput::ASYNC && !_stopped) {
+        std::lock_guard<std::mutex> lock(_flusherMutex);
+        if (!_flusher.joinable()) {
+            _flusherStopping = false;
+            _flusher = std::thread(&ConsoleSink::RunFlusher, this);
+        }
+    } else {
+        StopFlusher();
+        if (output == ConsoleOutput::SYNC) {
+            Flush();
+        }
+    }
+}
+
+void ConsoleSink::WriteLine(const char* data, size_t size) {
+    auto& buffer = GetBuffer();
+    auto mode = _mode.load();
+    bool wakeFlusher = false;
+    {
+        std::unique_lock<std::mutex> lock(buffer.mutex);
+        if (!TakeToken(buffer, _rateLimit.load())) {
+            ++buffer.dropped;
+            return;
+        }
+
+        if (mode == ConsoleOutput::SYNC || _stopped) {
+            lock.unlock();
+            std::lock_guard<std::mutex> outputLock(_outputMutex);
+            fwrite(data, 1, size, _output);
+            fputc('\n', _output);
+            fflush(_output);
+            return;
+        }
+
+        if (buffer.lines.size() + size + 1 > _bufferSize) {
+            ++buffer.dropped;
+            return;
+        }
+        buffer.lines.append(data, size);
+        buffer.lines.push_back('\n');
+
+        // Waking the flusher early keeps the buffer from overflowing between two intervals.
+        wakeFlusher = buffer.lines.size() > _bufferSize / 2 && buffer.lines.size() - size - 1 <= _bufferSize / 2;
+    }
+
+    if (wakeFlusher && mode == ConsoleOutput::ASYNC) {
+        _flusherCondition.notify_one();
+    }
+}
+
+void ConsoleSink::Flush() {
+    std::lock_guard<std::mutex> lock(_outputMutex);
+    std::string batch;
+    Drain(batch);
+    Write(batch);
+}
+
+std::string ConsoleSink::Take() {
+    std::string batch;
+    Drain(batch);
+    return batch;
+}
+
+void ConsoleSink::Stop() {
+    _stopped = true;
+    StopFlusher();
+    Flush();
+}
+
+uint64_t ConsoleSink::GetDroppedCount() const {
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+
+    auto count = _removedDroppedCount;
+    for (auto& buffer : _buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += buffer->dropped;
+    }
+    return count;
+}
+
+ConsoleSink::Buffer& ConsoleSink::GetBuffer() {
+    thread_local ThreadBuffer<Buffer> threadBuffer;
+
+    if (threadBuffer.sinkId != _id) {
+        if (threadBuffer.buffer != nullptr) {
+            threadBuffer.buffer->abandoned = true;
+        }
+
+        threadBuffer.buffer = std::make_shared<Buffer>();
+        threadBuffer.sinkId = _id;
+
+        std::lock_guard<std::mutex> lock(_buffersMutex);
+        _buffers.push_back(threadBuffer.buffer);
+    }
+    return *threadBuffer.buffer;
+}
+
+bool ConsoleSink::TakeToken(Buffer& buffer, uint32_t rateLimit) {
+    if (rateLimit == 0) {
+        return true;
+    }
+
+    // A thread may write a second worth of lines at once, e.g. its first lines.
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration<double>(now - buffer.refilled).count();
+    buffer.refilled = now;
+    buffer.tokens = std::min<double>(rateLimit, buffer.tokens + elapsed * rateLimit);
+    if (buffer.tokens < 1) {
+        return false;
+    }
+    buffer.tokens -= 1;
+    return true;
+}
+
+void ConsoleSink::Drain(std::string& batch) {
+    std::lock_guard<std::mutex> lock(_buffersMutex);
+
+    auto droppedCount = _removedDroppedCount;
+    auto end = std::remove_if(_buffers.begin(), _buffers.end(), [this, &batch, &droppedCount](const std::shared_ptr<Buffer>& buffer) {
+        // Checked before draining, so the lines written before the thread exited are taken.
+        auto abandoned = buffer->abandoned.load();
+
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        if (batch.empty()) {
+            batch.swap(buffer->lines);
+        } else {
+            batch += buffer->lines;
+            buffer->lines.clear();
+        }
+
+        droppedCount += buffer->dropped;
+        if (abandoned) {
+            _removedDroppedCount += buffer->dropped;
+        }
+        return abandoned;
+    });
+    _buffers.erase(end, _buffers.end());
+
+    if (droppedCount > _reportedDroppedCount) {
+        char line[128];
+        snprintf(line, sizeof(line), DROPPED_FORMAT, static_cast<unsigned long long>(droppedCount - _reportedDroppedCount));
+        batch += line;
+        _reportedDroppedCount = droppedCount;
+    }
+}
+
+void ConsoleSink::Write(const std::string& batch) {
+    if (!batch.empty()) {
+        fwrite(batch.data(), 1, batch.size(), _output);
+        fflush(_output);
+    }
+}
+
+void ConsoleSink::RunFlusher() {
+    std::unique_lock<std::mutex> lock(_flusherMutex);
+    while (!_flusherStopping) {
+        _flusherCondition.wait_for(lock, FLUSH_INTERVAL);
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+void ConsoleSink::StopFlusher() {
+    std::thread flusher;
+    {
+        std::lock_guard<std::mutex> lock(_flusherMutex);
+        _flusherStopping = true;
+        flusher = std::move(_flusher);
+    }
+    _flusherCondition.notify_one();
+
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+}
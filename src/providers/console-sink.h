@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "settings/settings.h"
+
+#include <napa/exports.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> Where console.log of zone workers writes lines to, so a chatty module doesn't stall workers on the output. </summary>
+    /// <remarks>
+    ///     Each writing thread appends lines to a buffer of its own, whose lock only the flusher contends for, and a
+    ///     flusher thread writes all buffers in one batch every 20ms. Lines beyond the buffer of a thread, or beyond the
+    ///     lines per second each thread may write, are dropped and counted, and the count is written with the next batch.
+    ///     Lines of a thread keep their order, lines of different threads are ordered per batch only.
+    ///     It's exposed in napa.dll, so Node takes the batches of the process-wide sink when it writes them itself.
+    /// </remarks>
+    class NAPA_API ConsoleSink {
+    public:
+
+        /// <summary> Default size in bytes of lines each thread can buffer. </summary>
+        static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+        /// <summary> Interval at which the flusher writes buffered lines, unless a buffer fills up by half before. </summary>
+        static constexpr std::chrono::milliseconds FLUSH_INTERVAL = std::chrono::milliseconds(20);
+
+        /// <summary> Gets the sink of console.log in zones, which writes to the standard output synchronously until configured. </summary>
+        static ConsoleSink& GetInstance();
+
+        /// <summary> Constructor, of a sink writing synchronously. </summary>
+        /// <param name="output"> The file to write lines to. </param>
+        /// <param name="bufferSize"> The size in bytes of lines each thread can buffer. </param>
+        explicit ConsoleSink(FILE* output = stdout, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+        /// <summary> Writes buffered lines, then stops the flusher. </summary>
+        ~ConsoleSink();
+
+        /// <summary> Non-copyable. </summary>
+        ConsoleSink(const ConsoleSink&) = delete;
+        ConsoleSink& operator=(const ConsoleSink&) = delete;
+
+        /// <summary> Sets how lines are written, and how many lines per second each thread may write, 0 for no limit. </summary>
+        void Configure(settings::ConsoleOutput output, uint32_t rateLimit);
+
+        /// <summary> Writes a line, to which a line break is appended. </summary>
+        void WriteLine(const char* data, size_t size);
+
+        /// <summary> Writes the lines buffered by all threads before the call. </summary>
+        void Flush();
+
+        /// <summary> Takes the lines buffered by all threads as one batch, which NODE output leaves to the caller to write. </summary>
+        std::string Take();
+
+        /// <summary> Stops the flusher once buffered lines are written. Later lines are written synchronously. </summary>
+        void Stop();
+
+        /// <summary> Gets the number of lines dropped because their thread wrote too many. </summary>
+        uint64_t GetDroppedCount() const;
+
+    private:
+
+        struct Buffer;
+
+        /// <summary> Gets the buffer of the calling thread, registering one on its first line. </summary>
+        Buffer& GetBuffer();
+
+        /// <summary> Whether the rate limit lets the thread of a buffer write a line now, called with the buffer locked. </summary>
+        bool TakeToken(Buffer& buffer, uint32_t rateLimit);
+
+        /// <summary> Moves the lines of all buffers into a batch, followed by a line telling lines dropped since the last batch. </summary>
+        void Drain(std::string& batch);
+
+        void Write(const std::string& batch);
+
+        void RunFlusher();
+
+        void StopFlusher();
+
+        /// <summary> Identifies this instance in the thread local buffer of writing threads. </summary>
+        const uint64_t _id;
+
+        FILE* const _output;
+        const size_t _bufferSize;
+
+        std::atomic<settings::ConsoleOutput> _mode;
+        std::atomic<uint32_t> _rateLimit;
+        std::atomic<bool> _stopped;
+
+        /// <summary> The buffers of all threads, whose threads may have exited. </summary>
+        std::vector<std::shared_ptr<Buffer>> _buffers;
+        mutable std::mutex _buffersMutex;
+
+        /// <summary> Lines dropped by buffers that were removed, and dropped lines reported so far. </summary>
+        uint64_t _removedDroppedCount;
+        uint64_t _reportedDroppedCount;
+
+        /// <summary> Held while writing, so batches and synchronous lines don't interleave. </summary>
+        std::mutex _outputMutex;
+
+        std::mutex _flusherMutex;
+        std::condition_variable _flusherCondition;
+        bool _flusherStopping;
+        std::thread _flusher;
+    };
+}
+}
@@ -0,0 +1,158 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "hdr-histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace napa::providers;
+
+constexpr uint32_t HdrHistogram::SUB_BUCKET_BITS;
+constexpr size_t HdrHistogram::BUCKET_COUNT;
+
+namespace {
+
+    constexpr uint64_t SUB_BUCKET_COUNT = uint64_t(1) << HdrHistogram::SUB_BUCKET_BITS;
+    constexpr uint64_t SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT >> 1;
+
+    /// <summary> Gets the index of the most significant bit of a non-zero value. </summary>
+    uint32_t GetMostSignificantBit(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    uint64_t ToRecordedValue(int64_t value) {
+        return value < 0 ? 0 : static_cast<uint64_t>(value);
+    }
+
+    /// <summary> Lowers an atomic min, or raises an atomic max, unless it's already beyond the value. </summary>
+    template <typename Compare>
+    void UpdateBound(std::atomic<int64_t>& bound, int64_t value, Compare beyond) {
+        auto current = bound.load(std::memory_order_relaxed);
+        while (beyond(value, current)
+            && !bound.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+size_t HdrHistogram::GetBucket(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(value);
+    }
+
+    // Values of [2^n, 2^(n+1)) keep their top SUB_BUCKET_BITS bits, their shifted value is in the upper half of sub buckets.
+    auto shift = GetMostSignificantBit(value) - (SUB_BUCKET_BITS - 1);
+    return static_cast<size_t>(shift * SUB_BUCKET_HALF_COUNT + (value >> shift));
+}
+
+uint64_t HdrHistogram::GetHighestValue(size_t bucket) {
+    if (bucket < SUB_BUCKET_COUNT) {
+        return bucket;
+    }
+
+    auto shift = bucket / SUB_BUCKET_HALF_COUNT - 1;
+    auto lowest = static_cast<uint64_t>(bucket - shift * SUB_BUCKET_HALF_COUNT) << shift;
+    return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+HdrHistogram::HdrHistogram() :
+    _counts(BUCKET_COUNT, 0),
+    _count(0),
+    _sum(0),
+    _min(std::numeric_limits<int64_t>::max()),
+    _max(0) {
+}
+
+void HdrHistogram::Record(int64_t value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    auto recorded = ToRecordedValue(value);
+    _counts[GetBucket(recorded)] += count;
+    _count += count;
+    _sum += static_cast<int64_t>(recorded * count);
+    _min = std::min(_min, static_cast<int64_t>(recorded));
+    _max = std::max(_max, static_cast<int64_t>(recorded));
+}
+
+void HdrHistogram::Add(const HdrHistogram& other) {
+    if (other._count == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        _counts[i] += other._counts[i];
+    }
+    _count += other._count;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+int64_t HdrHistogram::GetValueAtPercentile(double percentile) const {
+    if (_count == 0) {
+        return 0;
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(_count)));
+    rank = std::min(std::max(rank, uint64_t(1)), _count);
+
+    uint64_t counted = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counted += _counts[i];
+        if (counted >= rank) {
+            auto value = std::min(GetHighestValue(i), static_cast<uint64_t>(_max));
+            return std::max(static_cast<int64_t>(value), _min);
+        }
+    }
+    return _max;
+}
+
+ConcurrentHdrHistogram::ConcurrentHdrHistogram() :
+    _counts(new std::atomic<uint64_t>[HdrHistogram::BUCKET_COUNT]()),
+    _sum(0),
+    _min(std::numeric_limits<int64_t>::max()),
+    _max(0) {
+}
+
+void ConcurrentHdrHistogram::Record(int64_t value) {
+    auto recorded = ToRecordedValue(value);
+
+    // Bounds first, so a copy seeing the value counted mostly sees them too.
+    UpdateBound(_min, static_cast<int64_t>(recorded), [](int64_t value, int64_t min) { return value < min; });
+    UpdateBound(_max, static_cast<int64_t>(recorded), [](int64_t value, int64_t max) { return value > max; });
+    _sum.fetch_add(static_cast<int64_t>(recorded), std::memory_order_relaxed);
+    _counts[HdrHistogram::GetBucket(recorded)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ConcurrentHdrHistogram::AddTo(HdrHistogram& histogram) const {
+    // The count is made of the buckets read, so percentiles are consistent even if values are recorded meanwhile.
+    uint64_t count = 0;
+    for (size_t i = 0; i < HdrHistogram::BUCKET_COUNT; ++i) {
+        auto bucketCount = _counts[i].load(std::memory_order_relaxed);
+        histogram._counts[i] += bucketCount;
+        count += bucketCount;
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    histogram._count += count;
+    histogram._sum += _sum.load(std::memory_order_relaxed);
+    histogram._min = std::min(histogram._min, _min.load(std::memory_order_relaxed));
+    histogram._max = std::max(histogram._max, _max.load(std::memory_order_relaxed));
+}
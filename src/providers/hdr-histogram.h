@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> A high dynamic range histogram of non-negative values. </summary>
+    /// <remarks>
+    ///     Values are counted in log-linear buckets: 128 buckets of width 1 for values below 128, then 64 buckets per
+    ///     power of two, so a value is known within 1/64th of it (about 1.6%) over the whole range of int64_t.
+    /// </remarks>
+    class HdrHistogram {
+    public:
+
+        /// <summary> Number of bits of a value kept by its bucket. </summary>
+        static constexpr uint32_t SUB_BUCKET_BITS = 7;
+
+        /// <summary> Number of buckets covering all values of int64_t. </summary>
+        static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS) * (size_t(1) << (SUB_BUCKET_BITS - 1)) + (size_t(1) << SUB_BUCKET_BITS);
+
+        /// <summary> Gets the bucket of a value. </summary>
+        static size_t GetBucket(uint64_t value);
+
+        /// <summary> Gets the highest value counted by a bucket. </summary>
+        static uint64_t GetHighestValue(size_t bucket);
+
+        HdrHistogram();
+
+        /// <summary> Counts a value, negative values are counted as 0. </summary>
+        void Record(int64_t value, uint64_t count = 1);
+
+        /// <summary> Adds the values of another histogram. </summary>
+        void Add(const HdrHistogram& other);
+
+        /// <summary> Gets the value at a percentile, 0 if there are no values. </summary>
+        /// <param name="percentile"> The percentile in [0, 100]. </param>
+        /// <returns> The highest value of the bucket at the percentile, bounded by the min and max values. </returns>
+        int64_t GetValueAtPercentile(double percentile) const;
+
+        uint64_t GetCount() const { return _count; }
+        int64_t GetSum() const { return _sum; }
+
+        /// <summary> Gets the min value, 0 if there are no values. </summary>
+        int64_t GetMin() const { return _count == 0 ? 0 : _min; }
+
+        /// <summary> Gets the max value, 0 if there are no values. </summary>
+        int64_t GetMax() const { return _count == 0 ? 0 : _max; }
+
+    private:
+        friend class ConcurrentHdrHistogram;
+
+        std::vector<uint64_t> _counts;
+        uint64_t _count;
+        int64_t _sum;
+        int64_t _min;
+        int64_t _max;
+    };
+
+    /// <summary> An HdrHistogram that threads record to without locks, and which is read by copying it. </summary>
+    /// <remarks> A copy made while values are recorded may miss some of them, or count them but not in the sum. </remarks>
+    class ConcurrentHdrHistogram {
+    public:
+
+        ConcurrentHdrHistogram();
+
+        /// <summary> Non-copyable. </summary>
+        ConcurrentHdrHistogram(const ConcurrentHdrHistogram&) = delete;
+        ConcurrentHdrHistogram& operator=(const ConcurrentHdrHistogram&) = delete;
+
+        /// <summary> Counts a value, negative values are counted as 0. </summary>
+        void Record(int64_t value);
+
+        /// <summary> Adds the values recorded so far to a histogram. </summary>
+        void AddTo(HdrHistogram& histogram) const;
+
+    private:
+        std::unique_ptr<std::atomic<uint64_t>[]> _counts;
+        std::atomic<int64_t> _sum;
+        std::atomic<int64_t> _min;
+        std::atomic<int64_t> _max;
+    };
+}
+}
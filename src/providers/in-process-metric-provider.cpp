@@ -0,0 +1,296 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "in-process-metric-provider.h"
+#include "hdr-histogram.h"
+
+#include <atomic>
+#include <shared_mutex>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> Number of stripes each metric value is split in. </summary>
+    static constexpr size_t METRIC_STRIPE_COUNT = 16;
+
+    /// <summary> Gets the stripe of the calling thread, threads are spread over stripes round robin. </summary>
+    static size_t GetThreadStripe() {
+        static std::atomic<uint32_t> nextStripe(0);
+        thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % METRIC_STRIPE_COUNT;
+        return stripe;
+    }
+
+    /// <summary> The value of a metric for one combination of dimension values, which is its bound metric too. </summary>
+    class MetricSeries : public BoundMetric {
+    public:
+
+        MetricSeries(MetricType type, std::vector<std::string> dimensionValues) :
+            _type(type),
+            _dimensionValues(std::move(dimensionValues)),
+            _base(0),
+            _stripes(new Stripe[METRIC_STRIPE_COUNT]) {
+        }
+
+        ~MetricSeries() {
+            for (size_t i = 0; i < METRIC_STRIPE_COUNT; ++i) {
+                delete _stripes[i].histogram.load(std::memory_order_relaxed);
+            }
+        }
+
+        bool Set(int64_t value) override {
+            if (_type == MetricType::Percentile) {
+                Record(value);
+            } else {
+                // Stripes are not reset, the base makes up for them. Increments racing with it may be lost.
+                _base.store(value - GetStripesValue(), std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        bool Increment(uint64_t value) override {
+            return Add(static_cast<int64_t>(value));
+        }
+
+        bool Decrement(uint64_t value) override {
+            return Add(-static_cast<int64_t>(value));
+        }
+
+        void Destroy() override {
+            // Don't actually delete. Series are owned by their metric.
+        }
+
+        int64_t GetValue() const {
+            return _base.load(std::memory_order_relaxed) + GetStripesValue();
+        }
+
+        void AddTo(HdrHistogram& histogram) const {
+            for (size_t i = 0; i < METRIC_STRIPE_COUNT; ++i) {
+                auto stripeHistogram = _stripes[i].histogram.load(std::memory_order_acquire);
+                if (stripeHistogram != nullptr) {
+                    stripeHistogram->AddTo(histogram);
+                }
+            }
+        }
+
+        const std::vector<std::string>& GetDimensionValues() const {
+            return _dimensionValues;
+        }
+
+    private:
+
+        bool Add(int64_t value) {
+            if (_type == MetricType::Percentile) {
+                return false;
+            }
+
+            _stripes[GetThreadStripe()].value.fetch_add(value, std::memory_order_relaxed);
+            return true;
+        }
+
+        void Record(int64_t value) {
+            auto& stripe = _stripes[GetThreadStripe()];
+
+            auto histogram = stripe.histogram.load(std::memory_order_acquire);
+            if (histogram == nullptr) {
+                // Histograms are allocated the first time a stripe records, as most metrics are set by few threads.
+                auto created = new ConcurrentHdrHistogram();
+                if (stripe.histogram.compare_exchange_strong(histogram, created, std::memory_order_acq_rel)) {
+                    histogram = created;
+                } else {
+                    delete created;
+                }
+            }
+            histogram->Record(value);
+        }
+
+        /// <summary> A stripe takes a cache line, so threads of different stripes don't contend. </summary>
+        struct Stripe {
+            std::atomic<int64_t> value { 0 };
+            std::atomic<ConcurrentHdrHistogram*> histogram { nullptr };
+            char padding[64 - sizeof(std::atomic<int64_t>) - sizeof(std::atomic<ConcurrentHdrHistogram*>)];
+        };
+
+        int64_t GetStripesValue() const {
+            int64_t value = 0;
+            for (size_t i = 0; i < METRIC_STRIPE_COUNT; ++i) {
+                value += _stripes[i].value.load(std::memory_order_relaxed);
+            }
+            return value;
+        }
+
+        MetricType _type;
+        std::vector<std::string> _dimensionValues;
+        std::atomic<int64_t> _base;
+        std::unique_ptr<Stripe[]> _stripes;
+    };
+
+    /// <summary> A metric of InProcessMetricProvider. </summary>
+    class InProcessMetric : public Metric {
+    public:
+
+        InProcessMetric(const char* section, const char* name, MetricType type, size_t dimensions, const char* dimensionNames[]) :
+            _section(section != nullptr ? section : ""),
+            _name(name != nullptr ? name : ""),
+            _type(type) {
+            for (size_t i = 0; i < dimensions; ++i) {
+                _dimensionNames.emplace_back(dimensionNames[i] != nullptr ? dimensionNames[i] : "");
+            }
+
+            if (dimensions == 0) {
+                _defaultSeries = std::make_unique<MetricSeries>(type, std::vector<std::string>());
+                _order.push_back(_defaultSeries.get());
+            }
+        }
+
+        bool Set(int64_t value, size_t numberOfDimensions, const char* dimensionValues[]) override {
+            auto series = GetSeries(numberOfDimensions, dimensionValues);
+            return series != nullptr && series->Set(value);
+        }
+
+        bool Increment(uint64_t value, size_t numberOfDimensions, const char* dimensionValues[]) override {
+            auto series = GetSeries(numberOfDimensions, dimensionValues);
+            return series != nullptr && series->Increment(value);
+        }
+
+        bool Decrement(uint64_t value, size_t numberOfDimensions, const char* dimensionValues[]) override {
+            auto series = GetSeries(numberOfDimensions, dimensionValues);
+            return series != nullptr && series->Decrement(value);
+        }
+
+        BoundMetric* Bind(size_t numberOfDimensions, const char* dimensionValues[]) override {
+            return GetSeries(numberOfDimensions, dimensionValues);
+        }
+
+        void Destroy() override {
+            // Don't actually delete. Metrics are owned by the provider.
+        }
+
+        MetricSnapshot GetSnapshot(const std::vector<double>& percentiles) {
+            MetricSnapshot snapshot;
+            snapshot.section = _section;
+            snapshot.name = _name;
+            snapshot.type = _type;
+            snapshot.dimensionNames = _dimensionNames;
+
+            std::shared_lock<std::shared_timed_mutex> lock(_seriesAccess);
+            for (auto series : _order) {
+                MetricSeriesSnapshot seriesSnapshot;
+                seriesSnapshot.dimensionValues = series->GetDimensionValues();
+
+                if (_type == MetricType::Percentile) {
+                    HdrHistogram histogram;
+                    series->AddTo(histogram);
+
+                    seriesSnapshot.value = histogram.GetSum();
+                    seriesSnapshot.count = histogram.GetCount();
+                    seriesSnapshot.min = histogram.GetMin();
+                    seriesSnapshot.max = histogram.GetMax();
+                    for (auto percentile : percentiles) {
+                        seriesSnapshot.percentiles.push_back(histogram.GetValueAtPercentile(percentile));
+                    }
+                } else {
+                    seriesSnapshot.value = series->GetValue();
+                    seriesSnapshot.count = 0;
+                    seriesSnapshot.min = 0;
+                    seriesSnapshot.max = 0;
+                }
+                snapshot.series.push_back(std::move(seriesSnapshot));
+            }
+            return snapshot;
+        }
+
+    private:
+
+        MetricSeries* GetSeries(size_t numberOfDimensions, const char* dimensionValues[]) {
+            if (numberOfDimensions != _dimensionNames.size()) {
+                return nullptr;
+            }
+
+            if (_defaultSeries != nullptr) {
+                return _defaultSeries.get();
+            }
+
+            // Dimension values are joined by '\0', which C strings can't contain.
+            thread_local std::string key;
+            key.clear();
+            for (size_t i = 0; i < numberOfDimensions; ++i) {
+                if (dimensionValues[i] == nullptr) {
+                    return nullptr;
+                }
+                key.append(dimensionValues[i]).push_back('\0');
+            }
+
+            {
+                std::shared_lock<std::shared_timed_mutex> lock(_seriesAccess);
+                auto it = _series.find(key);
+                if (it != _series.end()) {
+                    return it->second.get();
+                }
+            }
+
+            std::lock_guard<std::shared_timed_mutex> lock(_seriesAccess);
+            auto& series = _series[key];
+            if (series == nullptr) {
+                series = std::make_unique<MetricSeries>(_type, std::vector<std::string>(dimensionValues, dimensionValues + numberOfDimensions));
+                _order.push_back(series.get());
+            }
+            return series.get();
+        }
+
+        std::string _section;
+        std::string _name;
+        MetricType _type;
+        std::vector<std::string> _dimensionNames;
+
+        /// <summary> The only series of a metric without dimensions, which is found without a lock. </summary>
+        std::unique_ptr<MetricSeries> _defaultSeries;
+
+        std::unordered_map<std::string, std::unique_ptr<MetricSeries>> _series;
+        std::vector<MetricSeries*> _order;
+        std::shared_timed_mutex _seriesAccess;
+    };
+}
+}
+
+using namespace napa::providers;
+
+InProcessMetricProvider::InProcessMetricProvider() = default;
+
+InProcessMetricProvider::~InProcessMetricProvider() = default;
+
+Metric* InProcessMetricProvider::GetMetric(
+    const char* section,
+    const char* name,
+    MetricType type,
+    size_t dimensions,
+    const char* dimensionNames[]) {
+
+    auto key = std::string(section != nullptr ? section : "") + '\0' + (name != nullptr ? name : "");
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& metric = _metrics[key];
+    if (metric == nullptr) {
+        metric = std::make_unique<InProcessMetric>(section, name, type, dimensions, dimensionNames);
+        _order.push_back(metric.get());
+    }
+    return metric.get();
+}
+
+void InProcessMetricProvider::Destroy() {
+    // Don't actually delete. We're a lifetime process object.
+}
+
+std::vector<MetricSnapshot> InProcessMetricProvider::GetSnapshots(const std::vector<double>& percentiles) {
+    std::vector<InProcessMetric*> metrics;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        metrics = _order;
+    }
+
+    std::vector<MetricSnapshot> snapshots;
+    snapshots.reserve(metrics.size());
+    for (auto metric : metrics) {
+        snapshots.push_back(metric->GetSnapshot(percentiles));
+    }
+    return snapshots;
+}
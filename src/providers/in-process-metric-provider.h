@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/providers/metric.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace providers {
+
+    class InProcessMetric;
+
+    /// <summary> A metric provider that keeps metric values in process, to be read as snapshots. </summary>
+    /// <remarks>
+    ///     Number and Rate metrics are counters, Percentile metrics are HDR histograms of the values set. Each value
+    ///     of a metric is split in stripes, that threads update with relaxed atomics, and merged when read.
+    ///     Bound metrics are the values of their dimension values, so updating them doesn't look anything up.
+    ///     Metrics live as long as the process, like the provider.
+    /// </remarks>
+    class InProcessMetricProvider : public MetricProvider, public MetricSnapshotProvider {
+    public:
+
+        InProcessMetricProvider();
+        ~InProcessMetricProvider();
+
+        /// <summary> Non-copyable. </summary>
+        InProcessMetricProvider(const InProcessMetricProvider&) = delete;
+        InProcessMetricProvider& operator=(const InProcessMetricProvider&) = delete;
+
+        /// <summary> Gets or creates a metric, an existing metric keeps the type and dimensions it was created with. </summary>
+        Metric* GetMetric(
+            const char* section,
+            const char* name,
+            MetricType type,
+            size_t dimensions,
+            const char* dimensionNames[]) override;
+
+        void Destroy() override;
+
+        std::vector<MetricSnapshot> GetSnapshots(const std::vector<double>& percentiles) override;
+
+    private:
+        std::unordered_map<std::string, std::unique_ptr<InProcessMetric>> _metrics;
+        std::vector<InProcessMetric*> _order;
+        std::mutex _mutex;
+    };
+}
+}
@@ -0,0 +1,428 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "log-record.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace napa::providers;
+
+namespace {
+
+    /// <summary> Header starting each session of a binary log, its first byte being the entry type. </summary>
+    const char BINARY_LOG_HEADER[8] = { 'N', 'A', 'P', 'A', 'L', 'O', 'G', '1' };
+
+    /// <summary> Types of entries of a binary log. </summary>
+    const char HEADER_ENTRY = 'N';
+    const char STRING_ENTRY = 'S';
+    const char RECORD_ENTRY = 'R';
+
+    /// <summary> Id of the strings written in records rather than in the dictionary. </summary>
+    const uint32_t INLINE_STRING_ID = 0;
+
+    template <typename T>
+    void AppendValue(std::vector<char>& output, T value) {
+        auto bytes = reinterpret_cast<const char*>(&value);
+        output.insert(output.end(), bytes, bytes + sizeof(T));
+    }
+
+    void AppendString16(std::vector<char>& output, const char* value, size_t maxSize) {
+        auto length = value == nullptr ? 0 : strnlen(value, maxSize);
+        AppendValue<uint16_t>(output, static_cast<uint16_t>(length));
+        output.insert(output.end(), value, value + length);
+    }
+
+    /// <summary> A decoded argument. </summary>
+    struct Argument {
+        LogArgument value;
+        std::string string;
+    };
+
+    /// <summary> Reads arguments encoded by EncodeLogArguments, in turn. </summary>
+    class ArgumentReader {
+    public:
+        ArgumentReader(const char* data, size_t size) : _data(data), _end(data + size) {}
+
+        /// <summary> Reads the next argument, returns false once all were read. </summary>
+        bool Next(Argument& argument) {
+            if (_data >= _end) {
+                return false;
+            }
+
+            argument.value.type = static_cast<LogArgument::Type>(*_data++);
+            if (argument.value.type == LogArgument::Type::STRING) {
+                uint16_t length = 0;
+                if (!Read(length) || static_cast<size_t>(_end - _data) < length) {
+                    _data = _end;
+                    return false;
+                }
+                argument.string.assign(_data, length);
+                _data += length;
+                return true;
+            }
+
+            uint64_t bits = 0;
+            if (!Read(bits)) {
+                return false;
+            }
+            std::memcpy(&argument.value.unsignedValue, &bits, sizeof(bits));
+            return true;
+        }
+
+        int64_t NextSigned() {
+            Argument argument;
+            if (!Next(argument)) {
+                return 0;
+            }
+            switch (argument.value.type) {
+                case LogArgument::Type::SIGNED: return argument.value.signedValue;
+                case LogArgument::Type::DOUBLE: return static_cast<int64_t>(argument.value.doubleValue);
+                case LogArgument::Type::STRING: return 0;
+                default: return static_cast<int64_t>(argument.value.unsignedValue);
+            }
+        }
+
+        uint64_t NextUnsigned() {
+            return static_cast<uint64_t>(NextSigned());
+        }
+
+        double NextDouble() {
+            Argument argument;
+            if (!Next(argument)) {
+                return 0;
+            }
+            switch (argument.value.type) {
+                case LogArgument::Type::DOUBLE: return argument.value.doubleValue;
+                case LogArgument::Type::SIGNED: return static_cast<double>(argument.value.signedValue);
+                case LogArgument::Type::UNSIGNED: return static_cast<double>(argument.value.unsignedValue);
+                default: return 0;
+            }
+        }
+
+        std::string NextString() {
+            Argument argument;
+            if (!Next(argument)) {
+                return std::string();
+            }
+            switch (argument.value.type) {
+                case LogArgument::Type::STRING: return argument.string;
+                case LogArgument::Type::POINTER: return argument.value.unsignedValue == 0 ? "(null)" : std::string();
+                default: return std::string();
+            }
+        }
+
+    private:
+        template <typename T>
+        bool Read(T& value) {
+            if (static_cast<size_t>(_end - _data) < sizeof(T)) {
+                _data = _end;
+                return false;
+            }
+            std::memcpy(&value, _data, sizeof(T));
+            _data += sizeof(T);
+            return true;
+        }
+
+        const char* _data;
+        const char* _end;
+    };
+
+    /// <summary> Appends a value formatted by a single printf conversion. </summary>
+    template <typename T>
+    void AppendFormatted(std::string& output, const std::string& conversion, T value) {
+        char buffer[128];
+        auto size = snprintf(buffer, sizeof(buffer), conversion.c_str(), value);
+        if (size < 0) {
+            return;
+        }
+        if (static_cast<size_t>(size) < sizeof(buffer)) {
+            output.append(buffer, size);
+            return;
+        }
+
+        std::vector<char> large(size + 1);
+        snprintf(large.data(), large.size(), conversion.c_str(), value);
+        output.append(large.data(), size);
+    }
+
+    /// <summary> Parses the digits or '*' of a width or precision into a conversion. </summary>
+    const char* ParseNumber(const char* format, std::string& conversion, ArgumentReader& reader) {
+        if (*format == '*') {
+            conversion += std::to_string(static_cast<int>(reader.NextSigned()));
+            return format + 1;
+        }
+        while (*format >= '0' && *format <= '9') {
+            conversion += *format++;
+        }
+        return format;
+    }
+
+    template <typename T>
+    bool Read(std::istream& input, T& value) {
+        return static_cast<bool>(input.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool ReadString(std::istream& input, size_t length, std::string& value) {
+        value.resize(length);
+        return length == 0 || static_cast<bool>(input.read(&value[0], length));
+    }
+
+    bool ReadString16(std::istream& input, std::string& value) {
+        uint16_t length = 0;
+        return Read(input, length) && ReadString(input, length, value);
+    }
+}
+
+size_t napa::providers::EncodeLogArguments(const LogArgument* arguments, size_t count, char* data, size_t capacity) {
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& argument = arguments[i];
+        if (argument.type == LogArgument::Type::STRING && argument.pointerValue != nullptr) {
+            if (capacity - size < 1 + sizeof(uint16_t)) {
+                break;
+            }
+            auto value = static_cast<const char*>(argument.pointerValue);
+            auto length = strnlen(value, std::min(LOG_MAX_STRING_ARGUMENT_SIZE, capacity - size - 1 - sizeof(uint16_t)));
+            auto length16 = static_cast<uint16_t>(length);
+
+            data[size++] = static_cast<char>(argument.type);
+            std::memcpy(data + size, &length16, sizeof(length16));
+            size += sizeof(length16);
+            std::memcpy(data + size, value, length);
+            size += length;
+        } else {
+            if (capacity - size < 1 + sizeof(uint64_t)) {
+                break;
+            }
+
+            // A null string is kept as a null pointer, which is formatted as "(null)" like printf does.
+            auto type = argument.type == LogArgument::Type::STRING ? LogArgument::Type::POINTER : argument.type;
+            data[size++] = static_cast<char>(type);
+            std::memcpy(data + size, &argument.unsignedValue, sizeof(uint64_t));
+            size += sizeof(uint64_t);
+        }
+    }
+    return size;
+}
+
+std::string napa::providers::FormatLogMessage(const char* format, const char* data, size_t size) {
+    ArgumentReader reader(data, size);
+    std::string message;
+
+    auto current = format;
+    while (*current != '\0') {
+        if (*current != '%') {
+            auto next = std::strchr(current, '%');
+            if (next == nullptr) {
+                message.append(current);
+                break;
+            }
+            message.append(current, next - current);
+            current = next;
+            continue;
+        }
+
+        if (current[1] == '%') {
+            message += '%';
+            current += 2;
+            continue;
+        }
+
+        // Flags, width and precision are kept, the length is replaced by the one of the decoded argument.
+        auto start = current++;
+        std::string conversion = "%";
+        while (*current != '\0' && std::strchr("-+ #0", *current) != nullptr) {
+            conversion += *current++;
+        }
+        current = ParseNumber(current, conversion, reader);
+        if (*current == '.') {
+            conversion += *current++;
+            current = ParseNumber(current, conversion, reader);
+        }
+        while (*current != '\0' && std::strchr("hlLqjzt", *current) != nullptr) {
+            ++current;
+        }
+
+        auto type = *current;
+        if (type == '\0') {
+            message.append(start);
+            break;
+        }
+        ++current;
+
+        switch (type) {
+            case 'd':
+            case 'i':
+                AppendFormatted(message, conversion + "ll" + type, static_cast<long long>(reader.NextSigned()));
+                break;
+
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                AppendFormatted(message, conversion + "ll" + type, static_cast<unsigned long long>(reader.NextUnsigned()));
+                break;
+
+            case 'c':
+                AppendFormatted(message, conversion + type, static_cast<int>(reader.NextSigned()));
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                AppendFormatted(message, conversion + type, reader.NextDouble());
+                break;
+
+            case 's':
+                AppendFormatted(message, conversion + type, reader.NextString().c_str());
+                break;
+
+            case 'p':
+                AppendFormatted(message, conversion + type, reinterpret_cast<const void*>(static_cast<uintptr_t>(reader.NextUnsigned())));
+                break;
+
+            case 'n':
+                reader.NextUnsigned();
+                break;
+
+            default:
+                message.append(start, current - start);
+                break;
+        }
+    }
+    return message;
+}
+
+std::string napa::providers::FormatLogLine(const char* section, const std::string& message, const char* file, int line) {
+    std::string result;
+    if (section != nullptr && section[0] != '\0') {
+        result += '[';
+        result += section;
+        result += "] ";
+    }
+    result += message;
+    result += " [";
+    result += file == nullptr ? "" : file;
+    result += ':';
+    result += std::to_string(line);
+    result += "]\n";
+    return result;
+}
+
+void BinaryLogWriter::WriteHeader(std::vector<char>& output) {
+    output.insert(output.end(), BINARY_LOG_HEADER, BINARY_LOG_HEADER + sizeof(BINARY_LOG_HEADER));
+    _stringIds.clear();
+}
+
+void BinaryLogWriter::WriteRecord(
+    std::vector<char>& output,
+    LoggingProvider::Verboseness level,
+    const char* section,
+    const char* file,
+    bool sharedFile,
+    int line,
+    const char* format,
+    const char* data,
+    size_t size) {
+
+    auto formatId = GetStringId(output, format);
+    auto fileId = sharedFile ? GetStringId(output, file) : INLINE_STRING_ID;
+
+    output.push_back(RECORD_ENTRY);
+    AppendValue<uint8_t>(output, static_cast<uint8_t>(level));
+    AppendValue<uint32_t>(output, formatId);
+    AppendValue<uint32_t>(output, fileId);
+    AppendValue<int32_t>(output, line);
+    AppendString16(output, section, UINT16_MAX);
+    if (fileId == INLINE_STRING_ID) {
+        AppendString16(output, file, UINT16_MAX);
+    }
+    AppendValue<uint16_t>(output, static_cast<uint16_t>(size));
+    output.insert(output.end(), data, data + size);
+}
+
+uint32_t BinaryLogWriter::GetStringId(std::vector<char>& output, const char* value) {
+    auto it = _stringIds.find(value);
+    if (it != _stringIds.end()) {
+        return it->second;
+    }
+
+    auto id = static_cast<uint32_t>(_stringIds.size() + 1);
+    _stringIds.emplace(value, id);
+
+    auto length = static_cast<uint32_t>(std::strlen(value));
+    output.push_back(STRING_ENTRY);
+    AppendValue<uint32_t>(output, id);
+    AppendValue<uint32_t>(output, length);
+    output.insert(output.end(), value, value + length);
+    return id;
+}
+
+bool napa::providers::DecodeBinaryLog(std::istream& input, std::ostream& output) {
+    std::unordered_map<uint32_t, std::string> strings;
+    bool started = false;
+
+    char type;
+    while (input.get(type)) {
+        if (type == HEADER_ENTRY) {
+            char header[sizeof(BINARY_LOG_HEADER) - 1];
+            if (!input.read(header, sizeof(header)) ||
+                std::memcmp(header, BINARY_LOG_HEADER + 1, sizeof(header)) != 0) {
+                return false;
+            }
+            strings.clear();
+            started = true;
+            continue;
+        }
+
+        if (!started) {
+            return false;
+        }
+
+        if (type == STRING_ENTRY) {
+            uint32_t id = 0;
+            uint32_t length = 0;
+            if (!Read(input, id) || !Read(input, length) || !ReadString(input, length, strings[id])) {
+                return false;
+            }
+            continue;
+        }
+
+        if (type != RECORD_ENTRY) {
+            return false;
+        }
+
+        uint8_t level = 0;
+        uint32_t formatId = 0;
+        uint32_t fileId = 0;
+        int32_t line = 0;
+        std::string section;
+        std::string file;
+        std::string data;
+        if (!Read(input, level) || !Read(input, formatId) || !Read(input, fileId) || !Read(input, line) ||
+            !ReadString16(input, section)) {
+            return false;
+        }
+        if (fileId == INLINE_STRING_ID) {
+            if (!ReadString16(input, file)) {
+                return false;
+            }
+        } else {
+            file = strings[fileId];
+        }
+        if (!ReadString16(input, data)) {
+            return false;
+        }
+
+        auto message = FormatLogMessage(strings[formatId].c_str(), data.data(), data.size());
+        output << FormatLogLine(section.c_str(), message, file.c_str(), line);
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/providers/logging.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> The maximum length of a string argument of a deferred log message. Longer ones are truncated. </summary>
+    constexpr size_t LOG_MAX_STRING_ARGUMENT_SIZE = 511;
+
+    /// <summary> Encodes log arguments into a buffer, copying strings. </summary>
+    /// <returns> The number of bytes used, arguments that don't fit are left out and strings are truncated. </returns>
+    size_t EncodeLogArguments(const LogArgument* arguments, size_t count, char* data, size_t capacity);
+
+    /// <summary> Formats a message by printf rules, with arguments encoded by EncodeLogArguments. </summary>
+    /// <remarks>
+    ///     Arguments are converted to the types that conversions expect, so a length modifier or argument type that
+    ///     doesn't match the format is harmless. Missing arguments are formatted as 0 or an empty string.
+    /// </remarks>
+    std::string FormatLogMessage(const char* format, const char* data, size_t size);
+
+    /// <summary> Formats a log line the way ConsoleLoggingProvider does, including the line break. </summary>
+    std::string FormatLogLine(const char* section, const std::string& message, const char* file, int line);
+
+    /// <summary> Writes entries of the binary log format, which keeps formats and file names in a dictionary. </summary>
+    /// <remarks>
+    ///     A binary log is a sequence of sessions, each starting with a header, so a file can be appended to by later
+    ///     processes. A string is written once per session, the first time a record refers to it, records then refer
+    ///     to strings by id. Values are in the byte order of the writer.
+    /// </remarks>
+    class BinaryLogWriter {
+    public:
+
+        /// <summary> Writes the header starting a session. </summary>
+        void WriteHeader(std::vector<char>& output);
+
+        /// <summary> Writes a record. </summary>
+        /// <param name="format"> The format, which is written to the dictionary by its address. </param>
+        /// <param name="file"> The source file, which is written to the dictionary if it's shared, or in the record. </param>
+        void WriteRecord(
+            std::vector<char>& output,
+            LoggingProvider::Verboseness level,
+            const char* section,
+            const char* file,
+            bool sharedFile,
+            int line,
+            const char* format,
+            const char* data,
+            size_t size);
+
+    private:
+
+        /// <summary> Gets the id of a string, writing it to the dictionary if it wasn't yet. </summary>
+        uint32_t GetStringId(std::vector<char>& output, const char* value);
+
+        std::unordered_map<const char*, uint32_t> _stringIds;
+    };
+
+    /// <summary> Renders a binary log as lines of text formatted like ConsoleLoggingProvider. </summary>
+    /// <returns> False if the input is not a binary log or is truncated, after rendering the records before. </returns>
+    bool DecodeBinaryLog(std::istream& input, std::ostream& output);
+}
+}
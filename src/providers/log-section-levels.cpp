@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "log-section-levels.h"
+
+using namespace napa::providers;
+
+LogSectionLevels::LogSectionLevels(LoggingProvider::Verboseness defaultLevel) :
+    _defaultLevel(static_cast<int>(defaultLevel)) {
+}
+
+std::atomic<int>& LogSectionLevels::Get(const char* section) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return GetEntry(section).level;
+}
+
+void LogSectionLevels::Set(const char* section, LoggingProvider::Verboseness level) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto& entry = GetEntry(section);
+    entry.isSet = true;
+    entry.level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void LogSectionLevels::SetDefault(LoggingProvider::Verboseness level) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _defaultLevel = static_cast<int>(level);
+    for (auto& entry : _entries) {
+        if (!entry.second->isSet) {
+            entry.second->level.store(_defaultLevel, std::memory_order_relaxed);
+        }
+    }
+}
+
+LogSectionLevels::Entry& LogSectionLevels::GetEntry(const char* section) {
+    auto& entry = _entries[section == nullptr ? "" : section];
+    if (entry == nullptr) {
+        entry = std::make_unique<Entry>();
+        entry->level.store(_defaultLevel, std::memory_order_relaxed);
+        entry->isSet = false;
+    }
+    return *entry;
+}
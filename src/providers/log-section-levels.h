@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/providers/logging.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> The most verbose level logged for each section, which can be changed at any time. </summary>
+    /// <remarks>
+    ///     Levels are kept in atomics that are never freed, so LOG call sites cache the one of their section, and
+    ///     checking whether a message is logged costs a relaxed load.
+    /// </remarks>
+    class LogSectionLevels {
+    public:
+
+        /// <summary> Constructor. </summary>
+        /// <param name="defaultLevel"> The level of sections that weren't given a level of their own. </param>
+        explicit LogSectionLevels(LoggingProvider::Verboseness defaultLevel = LoggingProvider::Verboseness::Debug);
+
+        /// <summary> Gets the level of a section, as an int of LoggingProvider::Verboseness. </summary>
+        /// <param name="section"> The section, nullptr for messages without a section like "". </param>
+        std::atomic<int>& Get(const char* section);
+
+        /// <summary> Sets the level of a section. </summary>
+        void Set(const char* section, LoggingProvider::Verboseness level);
+
+        /// <summary> Sets the level of the sections that weren't given a level of their own, including later ones. </summary>
+        void SetDefault(LoggingProvider::Verboseness level);
+
+    private:
+        struct Entry {
+            std::atomic<int> level;
+            bool isSet;
+        };
+
+        Entry& GetEntry(const char* section);
+
+        std::unordered_map<std::string, std::unique_ptr<Entry>> _entries;
+        int _defaultLevel;
+        std::mutex _mutex;
+    };
+}
+}
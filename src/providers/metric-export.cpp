@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "metric-export.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace napa::providers;
+
+namespace {
+
+    bool IsNameCharacter(char c, bool first) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (!first && c >= '0' && c <= '9');
+    }
+
+    /// <summary> Makes a Prometheus metric or label name, matching [a-zA-Z_][a-zA-Z0-9_]*. </summary>
+    std::string ToName(const std::string& value) {
+        std::string name;
+        for (auto c : value) {
+            name.push_back(IsNameCharacter(c, name.empty()) ? c : '_');
+        }
+
+        if (name.empty()) {
+            name.push_back('_');
+        }
+        return name;
+    }
+
+    void AppendLabelValue(std::string& output, const std::string& value) {
+        output.push_back('"');
+        for (auto c : value) {
+            if (c == '\\' || c == '"') {
+                output.push_back('\\');
+                output.push_back(c);
+            } else if (c == '\n') {
+                output.append("\\n");
+            } else {
+                output.push_back(c);
+            }
+        }
+        output.push_back('"');
+    }
+
+    /// <summary> Appends a sample line, with the labels of the series and an optional quantile label. </summary>
+    void AppendSample(
+        std::string& output,
+        const std::string& name,
+        const char* suffix,
+        const MetricSnapshot& snapshot,
+        const MetricSeriesSnapshot& series,
+        const char* quantile,
+        const std::string& value) {
+
+        output.append(name).append(suffix);
+
+        auto labels = std::min(snapshot.dimensionNames.size(), series.dimensionValues.size());
+        if (labels > 0 || quantile != nullptr) {
+            output.push_back('{');
+            for (size_t i = 0; i < labels; ++i) {
+                output.append(ToName(snapshot.dimensionNames[i])).push_back('=');
+                AppendLabelValue(output, series.dimensionValues[i]);
+                output.push_back(',');
+            }
+
+            if (quantile != nullptr) {
+                output.append("quantile=\"").append(quantile).append("\",");
+            }
+            output.back() = '}';
+        }
+        output.append(" ").append(value).push_back('\n');
+    }
+}
+
+std::string napa::providers::FormatPrometheusText(const std::vector<MetricSnapshot>& snapshots, const std::vector<double>& percentiles) {
+    std::string output;
+
+    for (const auto& snapshot : snapshots) {
+        auto name = ToName(snapshot.section.empty() ? snapshot.name : snapshot.section + "_" + snapshot.name);
+
+        const char* type = "gauge";
+        if (snapshot.type == MetricType::Rate) {
+            type = "counter";
+        } else if (snapshot.type == MetricType::Percentile) {
+            type = "summary";
+        }
+        output.append("# TYPE ").append(name).append(" ").append(type).push_back('\n');
+
+        for (const auto& series : snapshot.series) {
+            if (snapshot.type != MetricType::Percentile) {
+                AppendSample(output, name, "", snapshot, series, nullptr, std::to_string(series.value));
+                continue;
+            }
+
+            for (size_t i = 0; i < percentiles.size() && i < series.percentiles.size(); ++i) {
+                char quantile[32];
+                std::snprintf(quantile, sizeof(quantile), "%g", percentiles[i] / 100.0);
+                AppendSample(output, name, "", snapshot, series, quantile, std::to_string(series.percentiles[i]));
+            }
+            AppendSample(output, name, "_sum", snapshot, series, nullptr, std::to_string(series.value));
+            AppendSample(output, name, "_count", snapshot, series, nullptr, std::to_string(series.count));
+        }
+    }
+    return output;
+}
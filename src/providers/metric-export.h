@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/providers/metric.h>
+
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> Formats metric snapshots in the Prometheus text exposition format. </summary>
+    /// <param name="snapshots"> The snapshots, as returned by MetricSnapshotProvider::GetSnapshots. </param>
+    /// <param name="percentiles"> The percentiles the snapshots were taken with, reported as quantiles. </param>
+    /// <remarks>
+    ///     A metric is named '<section>_<name>', with characters Prometheus doesn't allow replaced by '_', and its
+    ///     dimensions are labels. Number metrics are gauges, Rate metrics are counters, Percentile metrics are summaries.
+    /// </remarks>
+    std::string FormatPrometheusText(const std::vector<MetricSnapshot>& snapshots, const std::vector<double>& percentiles);
+}
+}
@@ -8,6 +8,27 @@
 namespace napa {
 namespace providers {
 
+    ///<summary> A no-operation instance of a BoundMetric. </summary>
+    class NopBoundMetric : public BoundMetric {
+    public:
+
+        bool Set(int64_t) override {
+            return true;
+        }
+
+        bool Increment(uint64_t) override {
+            return true;
+        }
+
+        bool Decrement(uint64_t) override {
+            return true;
+        }
+
+        void Destroy() override {
+            // Don't actually delete. We're a lifetime process object.
+        }
+    };
+
     ///<summary> A no-operation instance of a Metric. </summary>
     class NopMetric : public Metric {
     public:
@@ -24,9 +45,16 @@ namespace providers {
             return true;
         }
 
+        BoundMetric* Bind(size_t, const char*[]) override {
+            return &_boundMetric;
+        }
+
         void Destroy() override {
             // Don't actually delete. We're a lifetime process object.
         }
+
+    private:
+        NopBoundMetric _boundMetric;
     };
 
     ///<summary> A no-operation instance of a MetricProvider.</summary>
@@ -3,7 +3,11 @@
 
 #include "providers.h"
 
+#include "async-logging-provider.h"
 #include "console-logging-provider.h"
+#include "in-process-metric-provider.h"
+#include "shared-memory-metric-provider.h"
+#include "log-section-levels.h"
 #include "nop-logging-provider.h"
 #include "nop-metric-provider.h"
 
@@ -17,6 +21,7 @@
 #include <rapidjson/error/en.h>
 #include <rapidjson/istreamwrapper.h>
 
+#include <cstdlib>
 #include <fstream>
 #include <string>
 
@@ -24,17 +29,25 @@ using namespace napa;
 using namespace napa::providers;
 
 // Forward declarations.
-static LoggingProvider* LoadLoggingProvider(const std::string& providerName);
-static MetricProvider* LoadMetricProvider(const std::string& providerName);
+static LoggingProvider* LoadLoggingProvider(const settings::PlatformSettings& settings, DeferredLoggingProvider*& deferred);
+static MetricProvider* LoadMetricProvider(const settings::PlatformSettings& settings, MetricSnapshotProvider*& snapshots);
+
+static LogSectionLevels& GetLogSectionLevels() {
+    // Leaked, as call sites keep the levels of their sections.
+    static auto levels = new LogSectionLevels();
+    return *levels;
+}
 
 // Providers - Initially assigned to defaults.
-static LoggingProvider* _loggingProvider = LoadLoggingProvider("");
-static MetricProvider* _metricProvider = LoadMetricProvider("");
+static DeferredLoggingProvider* _deferredLoggingProvider = nullptr;
+static LoggingProvider* _loggingProvider = LoadLoggingProvider(settings::PlatformSettings(), _deferredLoggingProvider);
+static MetricSnapshotProvider* _metricSnapshotProvider = nullptr;
+static MetricProvider* _metricProvider = LoadMetricProvider(settings::PlatformSettings(), _metricSnapshotProvider);
 
 
 bool napa::providers::Initialize(const settings::PlatformSettings& settings) {
-    _loggingProvider = LoadLoggingProvider(settings.loggingProvider);
-    _metricProvider = LoadMetricProvider(settings.metricProvider);
+    _loggingProvider = LoadLoggingProvider(settings, _deferredLoggingProvider);
+    _metricProvider = LoadMetricProvider(settings, _metricSnapshotProvider);
 
     return true;
 }
@@ -53,10 +66,30 @@ LoggingProvider& napa::providers::GetLoggingProvider() {
     return *_loggingProvider;
 }
 
+DeferredLoggingProvider* napa::providers::GetDeferredLoggingProvider() {
+    return _deferredLoggingProvider;
+}
+
+std::atomic<int>& napa::providers::GetLogLevel(const char* section) {
+    return GetLogSectionLevels().Get(section);
+}
+
+void napa::providers::SetLogLevel(const char* section, LoggingProvider::Verboseness level) {
+    if (section == nullptr) {
+        GetLogSectionLevels().SetDefault(level);
+    } else {
+        GetLogSectionLevels().Set(section, level);
+    }
+}
+
 MetricProvider& napa::providers::GetMetricProvider() {
     return *_metricProvider;
 }
 
+MetricSnapshotProvider* napa::providers::GetMetricSnapshotProvider() {
+    return _metricSnapshotProvider;
+}
+
 template <typename ProviderType>
 static ProviderType* LoadProvider(
     const std::string& providerName,
@@ -94,7 +127,10 @@ static ProviderType* LoadProvider(
     return createProviderFunc();
 }
 
-static LoggingProvider* LoadLoggingProvider(const std::string& providerName) {
+static LoggingProvider* LoadLoggingProvider(const settings::PlatformSettings& settings, DeferredLoggingProvider*& deferred) {
+    const auto& providerName = settings.loggingProvider;
+    deferred = nullptr;
+
     if (providerName.empty() || providerName == "console") {
         static auto consoleLoggingProvider = std::make_unique<ConsoleLoggingProvider>();
         return consoleLoggingProvider.get();
@@ -105,14 +141,48 @@ static LoggingProvider* LoadLoggingProvider(const std::string& providerName) {
         return nopLoggingProvider.get();
     }
 
+    if (providerName == "async") {
+        // Leaked like other process-wide objects, as workers may still log while static objects are destroyed.
+        static auto asyncLoggingProvider = new AsyncLoggingProvider(
+            settings.logFile,
+            settings.logBufferSize,
+            settings.logFormat == settings::LogFormat::BINARY);
+        static bool flushedAtExit = (std::atexit([]() { asyncLoggingProvider->Destroy(); }) == 0);
+        UNUSED(flushedAtExit);
+
+        deferred = asyncLoggingProvider;
+        return asyncLoggingProvider;
+    }
+
     return LoadProvider<LoggingProvider>(providerName, "providers.logging", "CreateLoggingProvider");
 }
 
-static MetricProvider* LoadMetricProvider(const std::string& providerName) {
+static MetricProvider* LoadMetricProvider(const settings::PlatformSettings& settings, MetricSnapshotProvider*& snapshots) {
+    const auto& providerName = settings.metricProvider;
+    snapshots = nullptr;
+
     if (providerName.empty()) {
         static auto nopMetricProvider = std::make_unique<NopMetricProvider>();
         return nopMetricProvider.get();
     }
 
+    if (providerName == "in-process") {
+        // Leaked like other process-wide objects, as workers may still set metrics while static objects are destroyed.
+        static auto inProcessMetricProvider = new InProcessMetricProvider();
+
+        snapshots = inProcessMetricProvider;
+        return inProcessMetricProvider;
+    }
+
+    if (providerName == "shared-memory") {
+        // Leaked like the in-process provider. The segment's name is removed at exit, so agents can tell the process is gone.
+        static auto sharedMemoryMetricProvider = new SharedMemoryMetricProvider(settings.metricSegment, settings.metricSegmentSize);
+        static bool removedAtExit = (std::atexit([]() { sharedMemoryMetricProvider->RemoveSegment(); }) == 0);
+        UNUSED(removedAtExit);
+
+        snapshots = sharedMemoryMetricProvider;
+        return sharedMemoryMetricProvider;
+    }
+
     return LoadProvider<MetricProvider>(providerName, "providers.metric", "CreateMetricProvider");;
 }
@@ -0,0 +1,514 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "shared-memory-metric-provider.h"
+
+#include <platform/process.h>
+
+#include <napa/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <shared_mutex>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace napa::providers;
+using namespace napa::providers::shared_metrics;
+
+constexpr uint32_t SharedMemoryMetricProvider::DEFAULT_SEGMENT_SIZE;
+
+static_assert(sizeof(std::atomic<int64_t>) == sizeof(int64_t) && sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+    "Atomics of the segment must have the layout of their values");
+static_assert(sizeof(Header) <= CACHE_LINE_SIZE, "The header must fit in a cache line");
+static_assert(sizeof(CounterSlot) == CACHE_LINE_SIZE, "Counter slots must take a cache line");
+
+namespace {
+
+    /// <summary> Gets the slot of the calling thread, threads are spread over slots round robin. </summary>
+    uint32_t GetThreadSlot() {
+        static std::atomic<uint32_t> nextSlot(0);
+        thread_local uint32_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % SLOT_COUNT;
+        return slot;
+    }
+
+    /// <summary> Views a field of the segment as an atomic, which has the same layout. </summary>
+    template <typename T>
+    std::atomic<T>& AsAtomic(T& field) {
+        return *reinterpret_cast<std::atomic<T>*>(&field);
+    }
+
+    template <typename T>
+    const std::atomic<T>& AsAtomic(const T& field) {
+        return *reinterpret_cast<const std::atomic<T>*>(&field);
+    }
+
+    size_t AlignToCacheLine(size_t size) {
+        return (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    }
+
+    /// <summary> Gets the index of the most significant bit of a non-zero value. </summary>
+    uint32_t GetMostSignificantBit(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return 63u - static_cast<uint32_t>(__builtin_clzll(value));
+#endif
+    }
+
+    /// <summary> Lowers an atomic min, or raises an atomic max, unless it's already beyond the value. </summary>
+    template <typename Compare>
+    void UpdateBound(std::atomic<int64_t>& bound, int64_t value, Compare beyond) {
+        auto current = bound.load(std::memory_order_relaxed);
+        while (beyond(value, current)
+            && !bound.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// <summary> A series of a metric, which is its bound metric too. It updates the record of the series in the segment. </summary>
+    class SharedMemorySeries : public BoundMetric {
+    public:
+
+        SharedMemorySeries(MetricType type, char* record) :
+            _type(type),
+            _header(reinterpret_cast<SeriesHeader*>(record)),
+            _slots(record + _header->slotsOffset) {
+        }
+
+        bool Set(int64_t value) override {
+            if (_type == MetricType::Percentile) {
+                Record(value);
+            } else {
+                // Slots are not reset, the base makes up for them. Increments racing with it may be lost.
+                int64_t slotsValue = 0;
+                for (uint32_t i = 0; i < SLOT_COUNT; ++i) {
+                    slotsValue += AsAtomic(GetCounterSlot(i).value).load(std::memory_order_relaxed);
+                }
+                AsAtomic(_header->base).store(value - slotsValue, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        bool Increment(uint64_t value) override {
+            return Add(static_cast<int64_t>(value));
+        }
+
+        bool Decrement(uint64_t value) override {
+            return Add(-static_cast<int64_t>(value));
+        }
+
+        void Destroy() override {
+            // Don't actually delete. Series are owned by their metric.
+        }
+
+    private:
+
+        bool Add(int64_t value) {
+            if (_type == MetricType::Percentile) {
+                return false;
+            }
+            AsAtomic(GetCounterSlot(GetThreadSlot()).value).fetch_add(value, std::memory_order_relaxed);
+            return true;
+        }
+
+        void Record(int64_t value) {
+            auto& slot = *reinterpret_cast<PercentileSlot*>(_slots + GetThreadSlot() * PERCENTILE_SLOT_SIZE);
+            AsAtomic(slot.buckets[GetBucket(value)]).fetch_add(1, std::memory_order_relaxed);
+            AsAtomic(slot.sum).fetch_add(value, std::memory_order_relaxed);
+            UpdateBound(AsAtomic(slot.min), value, std::less<int64_t>());
+            UpdateBound(AsAtomic(slot.max), value, std::greater<int64_t>());
+
+            // Counted last, so readers seeing the count see the bounds of the value.
+            AsAtomic(slot.count).fetch_add(1, std::memory_order_release);
+        }
+
+        CounterSlot& GetCounterSlot(uint32_t index) {
+            return reinterpret_cast<CounterSlot*>(_slots)[index];
+        }
+
+        MetricType _type;
+        SeriesHeader* _header;
+        char* _slots;
+    };
+}
+
+namespace napa {
+namespace providers {
+
+    /// <summary> A metric of SharedMemoryMetricProvider. </summary>
+    class SharedMemoryMetric : public Metric {
+    public:
+
+        SharedMemoryMetric(
+            SharedMemoryMetricProvider& provider,
+            const char* section,
+            const char* name,
+            MetricType type,
+            size_t dimensions,
+            const char* dimensionNames[]) :
+            _provider(provider),
+            _section(section != nullptr ? section : ""),
+            _name(name != nullptr ? name : ""),
+            _type(type) {
+            for (size_t i = 0; i < dimensions; ++i) {
+                _dimensionNames.emplace_back(dimensionNames[i] != nullptr ? dimensionNames[i] : "");
+            }
+
+            if (dimensions == 0) {
+                _defaultSeries = CreateSeries(std::vector<std::string>());
+            }
+        }
+
+        bool Set(int64_t value, size_t numberOfDimensions, const char* dimensionValues[]) override {
+            auto series = GetSeries(numberOfDimensions, dimensionValues);
+            return series != nullptr && series->Set(value);
+        }
+
+        bool Increment(uint64_t value, size_t numberOfDimensions, const char* dimensionValues[]) override {
+            auto series = GetSeries(numberOfDimensions, dimensionValues);
+            return series != nullptr && series->Increment(value);
+        }
+
+        bool Decrement(uint64_t value, size_t numberOfDimensions, const char* dimensionValues[]) override {
+            auto series = GetSeries(numberOfDimensions, dimensionValues);
+            return series != nullptr && series->Decrement(value);
+        }
+
+        BoundMetric* Bind(size_t numberOfDimensions, const char* dimensionValues[]) override {
+            return GetSeries(numberOfDimensions, dimensionValues);
+        }
+
+        void Destroy() override {
+            // Don't actually delete. Metrics are owned by the provider.
+        }
+
+    private:
+
+        std::unique_ptr<SharedMemorySeries> CreateSeries(const std::vector<std::string>& dimensionValues) {
+            auto record = _provider.AllocateSeries(_type, _section, _name, _dimensionNames, dimensionValues);
+            return record != nullptr ? std::make_unique<SharedMemorySeries>(_type, record) : nullptr;
+        }
+
+        SharedMemorySeries* GetSeries(size_t numberOfDimensions, const char* dimensionValues[]) {
+            if (numberOfDimensions != _dimensionNames.size()) {
+                return nullptr;
+            }
+
+            if (numberOfDimensions == 0) {
+                return _defaultSeries.get();
+            }
+
+            // Dimension values are joined by '\0', which C strings can't contain.
+            thread_local std::string key;
+            key.clear();
+            for (size_t i = 0; i < numberOfDimensions; ++i) {
+                if (dimensionValues[i] == nullptr) {
+                    return nullptr;
+                }
+                key.append(dimensionValues[i]).push_back('\0');
+            }
+
+            {
+                std::shared_lock<std::shared_timed_mutex> lock(_seriesAccess);
+                auto it = _series.find(key);
+                if (it != _series.end()) {
+                    return it->second.get();
+                }
+            }
+
+            // Series which don't fit are kept as nullptr, so they're not allocated again.
+            std::lock_guard<std::shared_timed_mutex> lock(_seriesAccess);
+            auto it = _series.find(key);
+            if (it == _series.end()) {
+                it = _series.emplace(key, CreateSeries(std::vector<std::string>(dimensionValues, dimensionValues + numberOfDimensions))).first;
+            }
+            return it->second.get();
+        }
+
+        SharedMemoryMetricProvider& _provider;
+        std::string _section;
+        std::string _name;
+        MetricType _type;
+        std::vector<std::string> _dimensionNames;
+
+        /// <summary> The only series of a metric without dimensions, which is found without a lock. </summary>
+        std::unique_ptr<SharedMemorySeries> _defaultSeries;
+
+        std::unordered_map<std::string, std::unique_ptr<SharedMemorySeries>> _series;
+        std::shared_timed_mutex _seriesAccess;
+    };
+}
+}
+
+uint32_t shared_metrics::GetBucket(int64_t value) {
+    if (value < 4) {
+        return value < 0 ? 0 : static_cast<uint32_t>(value);
+    }
+
+    // The 2 bits after the most significant one pick the bucket within its power of two.
+    auto exponent = GetMostSignificantBit(static_cast<uint64_t>(value));
+    auto subBucket = static_cast<uint32_t>(static_cast<uint64_t>(value) >> (exponent - 2)) & 3;
+    return 4 + (exponent - 2) * 4 + subBucket;
+}
+
+int64_t shared_metrics::GetHighestValue(uint32_t bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+
+    auto shift = (bucket - 4) / 4;
+    auto lowest = static_cast<uint64_t>(4 + (bucket - 4) % 4) << shift;
+    auto highest = lowest + (uint64_t(1) << shift) - 1;
+    return static_cast<int64_t>(std::min<uint64_t>(highest, std::numeric_limits<int64_t>::max()));
+}
+
+std::vector<MetricSnapshot> shared_metrics::ReadSegment(const char* data, const std::vector<double>& percentiles) {
+    std::vector<MetricSnapshot> snapshots;
+
+    auto& header = *reinterpret_cast<const Header*>(data);
+    if (header.magic != MAGIC || header.version != VERSION) {
+        return snapshots;
+    }
+
+    // Series of a metric are grouped in the snapshot of the metric, which is in the order of its first series.
+    std::unordered_map<std::string, size_t> metricIndexes;
+    auto recordsEnd = AsAtomic(header.recordsEnd).load(std::memory_order_acquire);
+    for (auto offset = static_cast<uint64_t>(CACHE_LINE_SIZE); offset < recordsEnd; ) {
+        auto record = data + offset;
+        auto& series = *reinterpret_cast<const SeriesHeader*>(record);
+        offset += series.size;
+
+        auto names = record + sizeof(SeriesHeader);
+        auto nextName = [&names]() {
+            std::string name(names);
+            names += name.size() + 1;
+            return name;
+        };
+
+        MetricSnapshot metric;
+        metric.section = nextName();
+        metric.name = nextName();
+        metric.type = static_cast<MetricType>(series.type);
+
+        MetricSeriesSnapshot seriesSnapshot;
+        for (uint32_t i = 0; i < series.dimensionCount; ++i) {
+            metric.dimensionNames.push_back(nextName());
+            seriesSnapshot.dimensionValues.push_back(nextName());
+        }
+
+        auto slots = record + series.slotsOffset;
+        seriesSnapshot.value = 0;
+        seriesSnapshot.count = 0;
+        seriesSnapshot.min = 0;
+        seriesSnapshot.max = 0;
+        if (metric.type == MetricType::Percentile) {
+            std::vector<uint64_t> buckets(BUCKET_COUNT, 0);
+            auto min = std::numeric_limits<int64_t>::max();
+            auto max = std::numeric_limits<int64_t>::min();
+            for (uint32_t i = 0; i < header.slotCount; ++i) {
+                auto& slot = *reinterpret_cast<const PercentileSlot*>(slots + i * PERCENTILE_SLOT_SIZE);
+                auto count = AsAtomic(slot.count).load(std::memory_order_acquire);
+                if (count == 0) {
+                    continue;
+                }
+                seriesSnapshot.count += count;
+                seriesSnapshot.value += AsAtomic(slot.sum).load(std::memory_order_relaxed);
+                min = std::min(min, AsAtomic(slot.min).load(std::memory_order_relaxed));
+                max = std::max(max, AsAtomic(slot.max).load(std::memory_order_relaxed));
+                for (uint32_t j = 0; j < BUCKET_COUNT; ++j) {
+                    buckets[j] += AsAtomic(slot.buckets[j]).load(std::memory_order_relaxed);
+                }
+            }
+
+            if (seriesSnapshot.count > 0) {
+                seriesSnapshot.min = min;
+                seriesSnapshot.max = max;
+            }
+
+            // Buckets may count values recorded after the counts were read, which ranks are taken among.
+            uint64_t bucketsCount = 0;
+            for (auto count : buckets) {
+                bucketsCount += count;
+            }
+            for (auto percentile : percentiles) {
+                if (bucketsCount == 0) {
+                    seriesSnapshot.percentiles.push_back(0);
+                    continue;
+                }
+
+                percentile = std::min(std::max(percentile, 0.0), 100.0);
+                auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(bucketsCount)));
+                rank = std::min(std::max(rank, uint64_t(1)), bucketsCount);
+
+                uint64_t counted = 0;
+                uint32_t bucket = 0;
+                for (; bucket < BUCKET_COUNT - 1; ++bucket) {
+                    counted += buckets[bucket];
+                    if (counted >= rank) {
+                        break;
+                    }
+                }
+                auto value = GetHighestValue(bucket);
+                if (seriesSnapshot.count > 0) {
+                    value = std::max(std::min(value, seriesSnapshot.max), seriesSnapshot.min);
+                }
+                seriesSnapshot.percentiles.push_back(value);
+            }
+        } else {
+            seriesSnapshot.value = AsAtomic(series.base).load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < header.slotCount; ++i) {
+                auto& slot = *reinterpret_cast<const CounterSlot*>(slots + i * sizeof(CounterSlot));
+                seriesSnapshot.value += AsAtomic(slot.value).load(std::memory_order_relaxed);
+            }
+        }
+
+        auto key = metric.section + '\0' + metric.name;
+        auto it = metricIndexes.find(key);
+        if (it == metricIndexes.end()) {
+            it = metricIndexes.emplace(key, snapshots.size()).first;
+            snapshots.push_back(std::move(metric));
+        }
+        snapshots[it->second].series.push_back(std::move(seriesSnapshot));
+    }
+    return snapshots;
+}
+
+SharedMemoryMetricProvider::SharedMemoryMetricProvider(const std::string& name, uint32_t size) :
+    _segmentName(!name.empty() ? name : "napa-metrics-" + std::to_string(platform::Getpid())) {
+
+    auto segmentSize = static_cast<size_t>(size > 0 ? size : DEFAULT_SEGMENT_SIZE) * 1024 * 1024;
+
+    // A segment of the same name was left over by an earlier process, which is replaced to start from a clean layout.
+    bool created = false;
+    _segment = platform::SharedSegment::Open(_segmentName, segmentSize, created);
+    if (_segment != nullptr && !created) {
+        _segment.reset();
+        platform::SharedSegment::Remove(_segmentName);
+        _segment = platform::SharedSegment::Open(_segmentName, segmentSize, created);
+    }
+
+    if (_segment == nullptr || !created) {
+        LOG_ERROR("Metrics", "Failed to create shared memory segment '%s' of metrics.", _segmentName.c_str());
+        _segment.reset();
+        return;
+    }
+
+    auto& header = *reinterpret_cast<Header*>(_segment->GetData());
+    header.segmentSize = _segment->GetSize();
+    header.pid = platform::Getpid();
+    header.slotCount = SLOT_COUNT;
+    header.bucketCount = BUCKET_COUNT;
+    header.droppedSeries = 0;
+    header.version = VERSION;
+    AsAtomic(header.recordsEnd).store(CACHE_LINE_SIZE, std::memory_order_relaxed);
+
+    // The magic is written last, so readers don't take a segment being initialized for a valid one.
+    AsAtomic(header.magic).store(MAGIC, std::memory_order_release);
+}
+
+SharedMemoryMetricProvider::~SharedMemoryMetricProvider() = default;
+
+Metric* SharedMemoryMetricProvider::GetMetric(
+    const char* section,
+    const char* name,
+    MetricType type,
+    size_t dimensions,
+    const char* dimensionNames[]) {
+
+    auto key = std::string(section != nullptr ? section : "") + '\0' + (name != nullptr ? name : "");
+
+    std::lock_guard<std::mutex> lock(_metricsMutex);
+    auto& metric = _metrics[key];
+    if (metric == nullptr) {
+        metric = std::make_unique<SharedMemoryMetric>(*this, section, name, type, dimensions, dimensionNames);
+    }
+    return metric.get();
+}
+
+void SharedMemoryMetricProvider::Destroy() {
+    // Don't actually delete. We're a lifetime process object.
+}
+
+std::vector<MetricSnapshot> SharedMemoryMetricProvider::GetSnapshots(const std::vector<double>& percentiles) {
+    if (_segment == nullptr) {
+        return std::vector<MetricSnapshot>();
+    }
+    return ReadSegment(_segment->GetData(), percentiles);
+}
+
+const std::string& SharedMemoryMetricProvider::GetSegmentName() const {
+    return _segmentName;
+}
+
+void SharedMemoryMetricProvider::RemoveSegment() {
+    platform::SharedSegment::Remove(_segmentName);
+}
+
+char* SharedMemoryMetricProvider::AllocateSeries(
+    MetricType type,
+    const std::string& section,
+    const std::string& name,
+    const std::vector<std::string>& dimensionNames,
+    const std::vector<std::string>& dimensionValues) {
+
+    if (_segment == nullptr) {
+        return nullptr;
+    }
+
+    auto namesSize = section.size() + 1 + name.size() + 1;
+    for (size_t i = 0; i < dimensionNames.size(); ++i) {
+        namesSize += dimensionNames[i].size() + 1 + dimensionValues[i].size() + 1;
+    }
+    auto slotsOffset = AlignToCacheLine(sizeof(SeriesHeader) + namesSize);
+    auto slotSize = type == MetricType::Percentile ? PERCENTILE_SLOT_SIZE : sizeof(CounterSlot);
+    auto size = slotsOffset + SLOT_COUNT * slotSize;
+
+    std::lock_guard<std::mutex> lock(_allocationMutex);
+    auto data = _segment->GetData();
+    auto& header = *reinterpret_cast<Header*>(data);
+    auto offset = AsAtomic(header.recordsEnd).load(std::memory_order_relaxed);
+    if (offset + size > _segment->GetSize()) {
+        if (header.droppedSeries++ == 0) {
+            LOG_WARNING("Metrics", "Shared memory segment '%s' of metrics is full, new series are dropped.", _segmentName.c_str());
+        }
+        return nullptr;
+    }
+
+    auto record = data + offset;
+    auto& series = *reinterpret_cast<SeriesHeader*>(record);
+    series.size = static_cast<uint32_t>(size);
+    series.type = static_cast<uint32_t>(type);
+    series.dimensionCount = static_cast<uint32_t>(dimensionNames.size());
+    series.slotsOffset = static_cast<uint32_t>(slotsOffset);
+    series.base = 0;
+
+    auto names = record + sizeof(SeriesHeader);
+    auto appendName = [&names](const std::string& value) {
+        memcpy(names, value.c_str(), value.size() + 1);
+        names += value.size() + 1;
+    };
+    appendName(section);
+    appendName(name);
+    for (size_t i = 0; i < dimensionNames.size(); ++i) {
+        appendName(dimensionNames[i]);
+        appendName(dimensionValues[i]);
+    }
+
+    if (type == MetricType::Percentile) {
+        for (uint32_t i = 0; i < SLOT_COUNT; ++i) {
+            auto& slot = *reinterpret_cast<PercentileSlot*>(record + slotsOffset + i * PERCENTILE_SLOT_SIZE);
+            slot.min = std::numeric_limits<int64_t>::max();
+            slot.max = std::numeric_limits<int64_t>::min();
+        }
+    }
+
+    AsAtomic(header.recordsEnd).store(offset + size, std::memory_order_release);
+    return record;
+}
@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/providers/metric.h>
+#include <platform/shared-segment.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace providers {
+
+    /// <summary> Layout of the shared segment of SharedMemoryMetricProvider, which external agents read. </summary>
+    /// <remarks>
+    ///     The segment is a header followed by series records, one per metric and combination of dimension values,
+    ///     in the order they were created. A record is published by increasing the header's recordsEnd once it's
+    ///     complete, and never moves, so readers walk records up to recordsEnd read with acquire semantics.
+    ///     All fields are native endian, records and slots are aligned on cache lines.
+    /// </remarks>
+    namespace shared_metrics {
+
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        static constexpr uint32_t MAGIC = 0x534d504e;    // "NPMS"
+        static constexpr uint32_t VERSION = 1;
+
+        /// <summary> Number of slots each series is split in, threads are spread over slots round robin. </summary>
+        static constexpr uint32_t SLOT_COUNT = 16;
+
+        /// <summary>
+        ///     Buckets of Percentile slots are log-linear: buckets 0 to 3 count values 0 to 3, then each power of two is
+        ///     split in 4 buckets, so a value is known within 25%. Negative values are counted in bucket 0.
+        /// </summary>
+        static constexpr uint32_t BUCKET_COUNT = 248;
+
+        /// <summary> The header at the start of the segment. </summary>
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t segmentSize;
+            int32_t pid;
+            uint32_t slotCount;
+            uint32_t bucketCount;
+
+            /// <summary> Number of series which didn't fit in the segment, and aren't recorded. </summary>
+            uint32_t droppedSeries;
+
+            /// <summary> Offset from the start of the segment of the end of published records. </summary>
+            uint64_t recordsEnd;
+        };
+
+        /// <summary> The header of a series record, followed by its names, and by its slots at slotsOffset. </summary>
+        /// <remarks>
+        ///     Names are '\0' terminated strings: the section, the metric name, then the name and the value of each
+        ///     dimension. The value of a Number or Rate series is its base plus the values of its slots.
+        /// </remarks>
+        struct SeriesHeader {
+            /// <summary> Size of the record, the next record starts right after it. </summary>
+            uint32_t size;
+
+            /// <summary> MetricType of the series. </summary>
+            uint32_t type;
+
+            uint32_t dimensionCount;
+            uint32_t slotsOffset;
+            int64_t base;
+        };
+
+        /// <summary> A slot of a Number or Rate series, a cache line each. </summary>
+        struct CounterSlot {
+            int64_t value;
+            char padding[CACHE_LINE_SIZE - sizeof(int64_t)];
+        };
+
+        /// <summary> A slot of a Percentile series, padded to cache lines. min and max are only valid if count > 0. </summary>
+        struct PercentileSlot {
+            uint64_t count;
+            int64_t sum;
+            int64_t min;
+            int64_t max;
+            uint64_t buckets[BUCKET_COUNT];
+        };
+
+        /// <summary> Size of a Percentile slot, padded to cache lines. </summary>
+        static constexpr size_t PERCENTILE_SLOT_SIZE = (sizeof(PercentileSlot) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+        /// <summary> Gets the bucket of a value. </summary>
+        uint32_t GetBucket(int64_t value);
+
+        /// <summary> Gets the highest value counted by a bucket. </summary>
+        int64_t GetHighestValue(uint32_t bucket);
+
+        /// <summary> Reads the metrics of a segment, which is how external agents are expected to read them. </summary>
+        /// <param name="data"> The mapped segment. </param>
+        /// <param name="percentiles"> Percentiles in [0, 100] to report for Percentile metrics. </param>
+        /// <returns> Snapshots of metrics in the order their first series was created, empty if the segment isn't valid. </returns>
+        std::vector<MetricSnapshot> ReadSegment(const char* data, const std::vector<double>& percentiles);
+    }
+
+    class SharedMemoryMetric;
+
+    /// <summary> A metric provider that keeps metric values in a named shared memory segment, for external agents to read. </summary>
+    /// <remarks>
+    ///     Reading metrics doesn't call into the process, so scraping them doesn't contend with calls. Series are laid out
+    ///     as in shared_metrics, each split in cache line padded slots that threads update with relaxed atomics, like the
+    ///     stripes of InProcessMetricProvider. Percentile metrics are coarser histograms, as each slot is 2KB.
+    ///     Series that don't fit in the segment anymore are dropped, and their updates fail.
+    /// </remarks>
+    class SharedMemoryMetricProvider : public MetricProvider, public MetricSnapshotProvider {
+    public:
+
+        /// <summary> Size of the segment in MB when it isn't set. </summary>
+        static constexpr uint32_t DEFAULT_SEGMENT_SIZE = 16;
+
+        /// <summary> Creates the segment, replacing a segment of the same name left over by an earlier process. </summary>
+        /// <param name="name"> Name of the segment, empty for 'napa-metrics-<pid>'. </param>
+        /// <param name="size"> Size of the segment in MB, 0 for DEFAULT_SEGMENT_SIZE. </param>
+        /// <remarks> Metrics are all dropped if the segment can't be created. </remarks>
+        SharedMemoryMetricProvider(const std::string& name, uint32_t size);
+        ~SharedMemoryMetricProvider();
+
+        /// <summary> Non-copyable. </summary>
+        SharedMemoryMetricProvider(const SharedMemoryMetricProvider&) = delete;
+        SharedMemoryMetricProvider& operator=(const SharedMemoryMetricProvider&) = delete;
+
+        /// <summary> Gets or creates a metric, an existing metric keeps the type and dimensions it was created with. </summary>
+        Metric* GetMetric(
+            const char* section,
+            const char* name,
+            MetricType type,
+            size_t dimensions,
+            const char* dimensionNames[]) override;
+
+        void Destroy() override;
+
+        std::vector<MetricSnapshot> GetSnapshots(const std::vector<double>& percentiles) override;
+
+        /// <summary> Gets the name of the segment. </summary>
+        const std::string& GetSegmentName() const;
+
+        /// <summary> Removes the name of the segment, which stays mapped until the provider is destroyed. </summary>
+        void RemoveSegment();
+
+        /// <summary> Allocates a series record, nullptr if it doesn't fit. Used by metrics. </summary>
+        char* AllocateSeries(
+            MetricType type,
+            const std::string& section,
+            const std::string& name,
+            const std::vector<std::string>& dimensionNames,
+            const std::vector<std::string>& dimensionValues);
+
+    private:
+        std::string _segmentName;
+        std::unique_ptr<platform::SharedSegment> _segment;
+
+        std::unordered_map<std::string, std::unique_ptr<SharedMemoryMetric>> _metrics;
+        std::mutex _metricsMutex;
+
+        /// <summary> Serializes allocations of series, which are published in order. </summary>
+        std::mutex _allocationMutex;
+    };
+}
+}
@@ -3,6 +3,8 @@
 
 #include "settings-parser.h"
 
+#include <utils/string.h>
+
 #include <napa/log.h>
 
 // Open source header only library for argument parsing.
@@ -12,12 +14,177 @@
 using namespace napa;
 using namespace napa::settings;
 
+namespace {
+
+    /// <summary> A named entry of a list setting, with its numeric fields. </summary>
+    struct NamedEntry {
+        std::string name;
+        std::vector<std::pair<std::string, uint32_t>> fields;
+    };
+
+    /// <summary> Parses a list of named entries like "large:workers=2:maxOldSpaceSize=4096,small". </summary>
+    /// <param name="kind"> What entries are, for error messages. </param>
+    /// <returns> False if an entry has no name, is defined twice or has a field that isn't a number. </returns>
+    bool ParseNamedEntries(const std::string& str, const char* kind, std::vector<NamedEntry>& entries) {
+        std::vector<std::string> entryStrings;
+        utils::string::Split(str, entryStrings, ",", true);
+
+        for (const auto& entryString : entryStrings) {
+            std::vector<std::string> fields;
+            utils::string::Split(entryString, fields, ":");
+
+            NamedEntry entry;
+            entry.name = fields[0];
+            if (entry.name.empty()) {
+                auto message = std::string(kind) + " \"" + entryString + "\" has no name.";
+                LOG_ERROR("Settings", "%s", message.c_str());
+                return false;
+            }
+            for (const auto& other : entries) {
+                if (other.name == entry.name) {
+                    auto message = std::string(kind) + " \"" + entry.name + "\" is defined twice.";
+                    LOG_ERROR("Settings", "%s", message.c_str());
+                    return false;
+                }
+            }
+
+            for (size_t i = 1; i < fields.size(); i++) {
+                auto pos = fields[i].find('=');
+                uint32_t value = 0;
+                try {
+                    value = static_cast<uint32_t>(std::stoul(fields[i].substr(pos == std::string::npos ? fields[i].size() : pos + 1)));
+                } catch (const std::exception&) {
+                    auto message = std::string(kind) + " setting \"" + fields[i] + "\" has an invalid value.";
+                    LOG_ERROR("Settings", "%s", message.c_str());
+                    return false;
+                }
+                entry.fields.emplace_back(fields[i].substr(0, pos), value);
+            }
+            entries.emplace_back(std::move(entry));
+        }
+        return true;
+    }
+
+    /// <summary> Parses worker classes like "large:workers=2:maxOldSpaceSize=4096,small:maxStackSize=262144". </summary>
+    /// <remarks> Constraints that a class doesn't set are the ones of the zone. </remarks>
+    bool ParseWorkerClasses(const std::string& str, const ZoneSettings& settings, std::vector<WorkerClass>& workerClasses) {
+        std::vector<NamedEntry> entries;
+        if (!ParseNamedEntries(str, "Worker class", entries)) {
+            return false;
+        }
+
+        for (const auto& entry : entries) {
+            WorkerClass workerClass;
+            workerClass.name = entry.name;
+            workerClass.maxOldSpaceSize = settings.maxOldSpaceSize;
+            workerClass.maxSemiSpaceSize = settings.maxSemiSpaceSize;
+            workerClass.maxStackSize = settings.maxStackSize;
+
+            for (const auto& field : entry.fields) {
+                const auto& key = field.first;
+                auto value = field.second;
+                if (key == "workers" && value > 0) {
+                    workerClass.workers = value;
+                } else if (key == "maxOldSpaceSize") {
+                    workerClass.maxOldSpaceSize = value;
+                } else if (key == "maxSemiSpaceSize") {
+                    workerClass.maxSemiSpaceSize = value;
+                } else if (key == "maxStackSize" && value > 0) {
+                    workerClass.maxStackSize = value;
+                } else {
+                    LOG_ERROR("Settings", "Worker class setting \"%s\" is invalid.", key.c_str());
+                    return false;
+                }
+            }
+            workerClasses.emplace_back(std::move(workerClass));
+        }
+        return true;
+    }
+
+    /// <summary> Parses tenants like "search:weight=4:maxConcurrency=8,reports:weight=1". </summary>
+    bool ParseTenants(const std::string& str, std::vector<Tenant>& tenants) {
+        std::vector<NamedEntry> entries;
+        if (!ParseNamedEntries(str, "Tenant", entries)) {
+            return false;
+        }
+
+        for (const auto& entry : entries) {
+            Tenant tenant;
+            tenant.name = entry.name;
+
+            for (const auto& field : entry.fields) {
+                const auto& key = field.first;
+                auto value = field.second;
+                if (key == "weight" && value > 0) {
+                    tenant.weight = value;
+                } else if (key == "maxConcurrency") {
+                    tenant.maxConcurrency = value;
+                } else {
+                    LOG_ERROR("Settings", "Tenant setting \"%s\" is invalid.", key.c_str());
+                    return false;
+                }
+            }
+            tenants.emplace_back(std::move(tenant));
+        }
+        return true;
+    }
+
+}   // End of anonymous namespace.
+
 
 bool settings::Parse(const std::vector<std::string>& args, PlatformSettings& settings) {
     args::ArgumentParser parser("platform settings parser");
 
     args::ValueFlag<std::string> loggingProvider(parser, "loggingProvider", "logging provider", { "loggingProvider" });
+    args::ValueFlag<std::string> logFile(parser, "logFile", "file of the async logging provider", { "logFile" });
+    args::ValueFlag<uint32_t> logBufferSize(parser, "logBufferSize", "messages each thread queues with the async logging provider", { "logBufferSize" });
+    args::MapFlag<std::string, LogFormat> logFormat(parser, "logFormat", "file format of the async logging provider", { "logFormat" }, {
+        { "text", LogFormat::TEXT },
+        { "binary", LogFormat::BINARY }
+    });
+    args::MapFlag<std::string, ConsoleOutput> consoleOutput(parser, "consoleOutput", "how console.log of zone workers writes lines", { "consoleOutput" }, {
+        { "sync", ConsoleOutput::SYNC },
+        { "async", ConsoleOutput::ASYNC },
+        { "node", ConsoleOutput::NODE }
+    });
+    args::ValueFlag<uint32_t> consoleRateLimit(parser, "consoleRateLimit", "lines per second each zone worker may write to console", { "consoleRateLimit" });
     args::ValueFlag<std::string> metricProvider(parser, "metricProvider", "metric provider", { "metricProvider" });
+    args::ValueFlag<std::string> metricSegment(parser, "metricSegment", "shared memory segment of the shared-memory metric provider", { "metricSegment" });
+    args::ValueFlag<uint32_t> metricSegmentSize(parser, "metricSegmentSize", "size in MB of the segment of the shared-memory metric provider", { "metricSegmentSize" });
+    args::ValueFlag<uint32_t> spareIsolates(parser, "spareIsolates", "number of spare isolates for new zones", { "spareIsolates" });
+    args::ValueFlag<std::string> snapshotBlob(parser, "snapshotBlob", "V8 startup snapshot file", { "snapshotBlob" });
+    args::ValueFlag<std::string> codeCacheDirectory(parser, "codeCacheDirectory", "directory of module code caches", { "codeCacheDirectory" });
+    args::MapFlag<std::string, bool> moduleWrappers(parser, "moduleWrappers", "load modules as function wrappers in the worker context", { "moduleWrappers" }, {
+        { "true", true },
+        { "false", false }
+    });
+    args::MapFlag<std::string, bool> moduleStatCache(parser, "moduleStatCache", "cache file system lookups of module resolution", { "moduleStatCache" }, {
+        { "true", true },
+        { "false", false }
+    });
+    args::MapFlag<std::string, JsonModules> jsonModules(parser, "jsonModules", "how workers load JSON modules", { "jsonModules" }, {
+        { "parse", JsonModules::PARSE },
+        { "shared", JsonModules::SHARED },
+        { "frozen", JsonModules::FROZEN }
+    });
+    args::ValueFlag<std::string> moduleBundle(parser, "moduleBundle", "module bundle to serve modules from", { "moduleBundle" });
+    args::ValueFlag<uint32_t> moduleWatchInterval(parser, "moduleWatchInterval", "interval in ms to poll loaded module files at", { "moduleWatchInterval" });
+    args::MapFlag<std::string, AllocatorType> allocator(parser, "allocator", "backend of napa_allocate", { "allocator" }, {
+        { "crt", AllocatorType::CRT },
+        { "threadCaching", AllocatorType::THREAD_CACHING }
+    });
+    args::ValueFlag<uint32_t> arrayBufferPoolSize(parser, "arrayBufferPoolSize", "size in MB of pooled ArrayBuffer contents", { "arrayBufferPoolSize" });
+    args::MapFlag<std::string, bool> arrayBufferHugePages(parser, "arrayBufferHugePages", "back large pooled ArrayBuffers by huge pages", { "arrayBufferHugePages" }, {
+        { "true", true },
+        { "false", false }
+    });
+    args::ValueFlag<uint32_t> asyncCpuWorkers(parser, "asyncCpuWorkers", "number of threads running CPU bound async work", { "asyncCpuWorkers" });
+    args::ValueFlag<uint32_t> asyncIoWorkers(parser, "asyncIoWorkers", "number of threads running blocking async work", { "asyncIoWorkers" });
+    args::ValueFlag<uint32_t> semiSpaceGrowthFactor(parser, "semiSpaceGrowthFactor", "factor V8 grows semi spaces by", { "semiSpaceGrowthFactor" });
+    args::ValueFlag<uint32_t> v8PlatformThreads(parser, "v8PlatformThreads", "number of threads running V8 background tasks", { "v8PlatformThreads" });
+    args::ValueFlag<uint32_t> cpuBudget(parser, "cpuBudget", "number of zone workers running tasks at the same time", { "cpuBudget" });
+    args::ValueFlag<uint32_t> sharedWorkerThreads(parser, "sharedWorkerThreads", "number of threads workers of zones with shared threads run on", { "sharedWorkerThreads" });
+    args::ValueFlag<std::string> flightRecorderDirectory(parser, "flightRecorderDirectory", "directory of flight recorder dumps", { "flightRecorderDirectory" });
 
     try {
         parser.ParseArgs(args);
@@ -31,10 +198,110 @@ bool settings::Parse(const std::vector<std::string>& args, PlatformSettings& set
         settings.loggingProvider = loggingProvider.Get();
     }
 
+    if (logFile) {
+        settings.logFile = logFile.Get();
+    }
+
+    if (logBufferSize) {
+        settings.logBufferSize = logBufferSize.Get();
+    }
+
+    if (logFormat) {
+        settings.logFormat = logFormat.Get();
+    }
+
+    if (consoleOutput) {
+        settings.consoleOutput = consoleOutput.Get();
+    }
+
+    if (consoleRateLimit) {
+        settings.consoleRateLimit = consoleRateLimit.Get();
+    }
+
     if (metricProvider) {
         settings.metricProvider = metricProvider.Get();
     }
 
+    if (metricSegment) {
+        settings.metricSegment = metricSegment.Get();
+    }
+
+    if (metricSegmentSize) {
+        settings.metricSegmentSize = metricSegmentSize.Get();
+    }
+
+    if (spareIsolates) {
+        settings.spareIsolates = spareIsolates.Get();
+    }
+
+    if (snapshotBlob) {
+        settings.snapshotBlob = snapshotBlob.Get();
+    }
+
+    if (codeCacheDirectory) {
+        settings.codeCacheDirectory = codeCacheDirectory.Get();
+    }
+
+    if (moduleWrappers) {
+        settings.moduleWrappers = moduleWrappers.Get();
+    }
+
+    if (moduleStatCache) {
+        settings.moduleStatCache = moduleStatCache.Get();
+    }
+
+    if (jsonModules) {
+        settings.jsonModules = jsonModules.Get();
+    }
+
+    if (moduleBundle) {
+        settings.moduleBundle = moduleBundle.Get();
+    }
+
+    if (moduleWatchInterval) {
+        settings.moduleWatchInterval = moduleWatchInterval.Get();
+    }
+
+    if (allocator) {
+        settings.allocator = allocator.Get();
+    }
+
+    if (arrayBufferPoolSize) {
+        settings.arrayBufferPoolSize = arrayBufferPoolSize.Get();
+    }
+
+    if (arrayBufferHugePages) {
+        settings.arrayBufferHugePages = arrayBufferHugePages.Get();
+    }
+
+    if (asyncCpuWorkers) {
+        settings.asyncCpuWorkers = asyncCpuWorkers.Get();
+    }
+
+    if (asyncIoWorkers) {
+        settings.asyncIoWorkers = asyncIoWorkers.Get();
+    }
+
+    if (semiSpaceGrowthFactor) {
+        settings.semiSpaceGrowthFactor = semiSpaceGrowthFactor.Get();
+    }
+
+    if (v8PlatformThreads) {
+        settings.v8PlatformThreads = v8PlatformThreads.Get();
+    }
+
+    if (cpuBudget) {
+        settings.cpuBudget = cpuBudget.Get();
+    }
+
+    if (sharedWorkerThreads) {
+        settings.sharedWorkerThreads = sharedWorkerThreads.Get();
+    }
+
+    if (flightRecorderDirectory) {
+        settings.flightRecorderDirectory = flightRecorderDirectory.Get();
+    }
+
     return true;
 }
 
@@ -42,10 +309,84 @@ bool settings::Parse(const std::vector<std::string>& args, ZoneSettings& setting
     args::ArgumentParser parser("zone settings parser");
 
     args::ValueFlag<uint32_t> workers(parser, "workers", "number of zone workers", { "workers" });
+    args::ValueFlag<uint32_t> minWorkers(parser, "minWorkers", "min number of zone workers for autoscaling", { "minWorkers" });
+    args::ValueFlag<uint32_t> maxWorkers(parser, "maxWorkers", "max number of zone workers", { "maxWorkers" });
+    args::ValueFlag<uint32_t> autoscaleInterval(parser, "autoscaleInterval", "autoscaler sampling interval in milliseconds", { "autoscaleInterval" });
+    args::ValueFlag<uint32_t> autoscaleIdleTime(parser, "autoscaleIdleTime", "idle time in milliseconds before removing a worker", { "autoscaleIdleTime" });
+    args::ValueFlag<uint32_t> stuckWorkerThreshold(parser, "stuckWorkerThreshold", "time in milliseconds a worker runs a task for before it's stuck", { "stuckWorkerThreshold" });
+    args::MapFlag<std::string, bool> replaceStuckWorkers(parser, "replaceStuckWorkers", "add a worker in place of each stuck one", { "replaceStuckWorkers" }, {
+        { "true", true },
+        { "false", false }
+    });
     args::ValueFlag<uint32_t> maxOldSpaceSize(parser, "maxOldSpaceSize", "max old space size in MB", { "maxOldSpaceSize" });
     args::ValueFlag<uint32_t> maxSemiSpaceSize(parser, "maxSemiSpaceSize", "max semi space size in MB", { "maxSemiSpaceSize" });
     args::ValueFlag<uint32_t> maxExecutableSize(parser, "maxExecutableSize", "max executable size in MB", { "maxExecutableSize" });
+    args::ValueFlag<uint32_t> initialOldSpaceSize(parser, "initialOldSpaceSize", "initial old space size in MB", { "initialOldSpaceSize" });
+    args::ValueFlag<uint32_t> minSemiSpaceSize(parser, "minSemiSpaceSize", "initial semi space size in MB", { "minSemiSpaceSize" });
     args::ValueFlag<uint32_t> maxStackSize(parser, "maxStackSize", "max isolate stack size in bytes", { "maxStackSize" });
+    args::ValueFlag<uint32_t> idleSpinTime(parser, "idleSpinTime", "idle worker spin time in microseconds", { "idleSpinTime" });
+    args::ValueFlag<uint32_t> affinitySpillThreshold(parser, "affinitySpillThreshold", "max queued tasks on an affinity worker before spilling", { "affinitySpillThreshold" });
+    args::ValueFlag<uint32_t> workerQueueDepth(parser, "workerQueueDepth", "number of unfinished tasks busy workers are kept filled with", { "workerQueueDepth" });
+    args::ValueFlag<uint32_t> maxQueueLength(parser, "maxQueueLength", "max number of pending calls", { "maxQueueLength" });
+    args::ValueFlag<uint64_t> maxQueueBytes(parser, "maxQueueBytes", "max size of pending calls in bytes", { "maxQueueBytes" });
+    args::ValueFlag<uint64_t> resultCacheBytes(parser, "resultCacheBytes", "max size of cached call results in bytes", { "resultCacheBytes" });
+    args::ValueFlag<uint32_t> resultCacheTtl(parser, "resultCacheTtl", "time in milliseconds cached call results live", { "resultCacheTtl" });
+    args::MapFlag<std::string, SchedulerType> scheduler(parser, "scheduler", "task scheduling strategy", { "scheduler" }, {
+        { "synchronized", SchedulerType::SYNCHRONIZED },
+        { "workStealing", SchedulerType::WORK_STEALING },
+        { "earliestDeadline", SchedulerType::EARLIEST_DEADLINE }
+    });
+    args::MapFlag<std::string, WorkerPlacement> workerPlacement(parser, "workerPlacement", "worker pinning policy", { "workerPlacement" }, {
+        { "none", WorkerPlacement::NONE },
+        { "spread", WorkerPlacement::SPREAD },
+        { "compact", WorkerPlacement::COMPACT }
+    });
+    args::ValueFlag<int32_t> numaNode(parser, "numaNode", "NUMA node to run workers on", { "numaNode" });
+    args::MapFlag<std::string, WorkerPriority> workerPriority(parser, "workerPriority", "OS scheduling priority of worker threads", { "workerPriority" }, {
+        { "lowest", WorkerPriority::LOWEST },
+        { "low", WorkerPriority::LOW },
+        { "normal", WorkerPriority::NORMAL },
+        { "high", WorkerPriority::HIGH },
+        { "highest", WorkerPriority::HIGHEST }
+    });
+    args::ValueFlag<uint32_t> recycleTaskCount(parser, "recycleTaskCount", "number of tasks before recreating a worker isolate", { "recycleTaskCount" });
+    args::ValueFlag<uint32_t> recycleHeapSize(parser, "recycleHeapSize", "used heap size in MB before recreating a worker isolate", { "recycleHeapSize" });
+    args::ValueFlag<uint32_t> recycleFragmentation(parser, "recycleFragmentation", "percentage of free heap space before recreating a worker isolate", { "recycleFragmentation" });
+    args::ValueFlag<uint32_t> idleGcTime(parser, "idleGcTime", "garbage collection time in milliseconds per idle step of a worker", { "idleGcTime" });
+    args::ValueFlag<uint32_t> idleGcFullTime(parser, "idleGcFullTime", "idle time in milliseconds before a worker runs a full garbage collection", { "idleGcFullTime" });
+    args::MapFlag<std::string, GcMode> gcMode(parser, "gcMode", "garbage collector trade-off of worker isolates", { "gcMode" }, {
+        { "balanced", GcMode::BALANCED },
+        { "latency", GcMode::LATENCY },
+        { "throughput", GcMode::THROUGHPUT },
+        { "memory", GcMode::MEMORY }
+    });
+    args::MapFlag<std::string, bool> broadcastLogCompaction(parser, "broadcastLogCompaction", "replace repeated broadcasts in the replay log", { "broadcastLogCompaction" }, {
+        { "true", true },
+        { "false", false }
+    });
+    args::MapFlag<std::string, bool> broadcastCodeCache(parser, "broadcastCodeCache", "compile broadcasts with a shared code cache", { "broadcastCodeCache" }, {
+        { "true", true },
+        { "false", false }
+    });
+    args::MapFlag<std::string, bool> eventLoop(parser, "eventLoop", "run a libuv loop on each worker between tasks", { "eventLoop" }, {
+        { "true", true },
+        { "false", false }
+    });
+    args::MapFlag<std::string, bool> sharedThreads(parser, "sharedThreads", "run workers in turns on a process-wide pool of threads", { "sharedThreads" }, {
+        { "true", true },
+        { "false", false }
+    });
+    args::ValueFlag<uint32_t> codeCacheWarmUpTasks(parser, "codeCacheWarmUpTasks", "number of tasks a worker runs before warming module code caches", { "codeCacheWarmUpTasks" });
+    args::ValueFlag<uint32_t> broadcastConcurrency(parser, "broadcastConcurrency", "max number of workers running a broadcast at a time", { "broadcastConcurrency" });
+    args::ValueFlag<uint32_t> microtaskBatchSize(parser, "microtaskBatchSize", "number of tasks a worker runs between microtask checkpoints", { "microtaskBatchSize" });
+    args::ValueFlag<uint32_t> cpuWeight(parser, "cpuWeight", "share of the process CPU budget relative to other zones", { "cpuWeight" });
+    args::ValueFlag<uint32_t> slowCallThreshold(parser, "slowCallThreshold", "time in milliseconds beyond which calls are kept in the slow-call log", { "slowCallThreshold" });
+    args::ValueFlag<uint32_t> slowCallSampleRate(parser, "slowCallSampleRate", "keep 1 in every N calls in the slow-call log", { "slowCallSampleRate" });
+    args::ValueFlag<uint32_t> slowCallLogSize(parser, "slowCallLogSize", "number of calls the slow-call log keeps", { "slowCallLogSize" });
+    args::ValueFlag<uint32_t> slowCallPayloadBytes(parser, "slowCallPayloadBytes", "bytes of arguments kept with calls in the slow-call log", { "slowCallPayloadBytes" });
+    args::ValueFlag<std::string> preload(parser, "preload", "comma separated modules to load on all workers at zone creation", { "preload" });
+    args::ValueFlag<std::string> workerClasses(parser, "workerClasses", "comma separated worker classes with their workers and isolate constraints", { "workerClasses" });
+    args::ValueFlag<std::string> tenants(parser, "tenants", "comma separated tenants with their weights and concurrency caps", { "tenants" });
 
     try {
         parser.ParseArgs(args);
@@ -60,6 +401,31 @@ bool settings::Parse(const std::vector<std::string>& args, ZoneSettings& setting
         settings.workers = workers.Get();
     }
 
+    if (minWorkers) {
+        NAPA_ASSERT(minWorkers.Get() > 0, "The minimum number of workers must be greater than 0");
+        settings.minWorkers = minWorkers.Get();
+    }
+
+    if (maxWorkers) {
+        settings.maxWorkers = maxWorkers.Get();
+    }
+
+    if (autoscaleInterval) {
+        settings.autoscaleInterval = autoscaleInterval.Get();
+    }
+
+    if (autoscaleIdleTime) {
+        settings.autoscaleIdleTime = autoscaleIdleTime.Get();
+    }
+
+    if (stuckWorkerThreshold) {
+        settings.stuckWorkerThreshold = stuckWorkerThreshold.Get();
+    }
+
+    if (replaceStuckWorkers) {
+        settings.replaceStuckWorkers = replaceStuckWorkers.Get();
+    }
+
     if (maxOldSpaceSize) {
         settings.maxOldSpaceSize = maxOldSpaceSize.Get();
     }
@@ -72,10 +438,201 @@ bool settings::Parse(const std::vector<std::string>& args, ZoneSettings& setting
         settings.maxExecutableSize = maxExecutableSize.Get();
     }
 
+    if (initialOldSpaceSize) {
+        settings.initialOldSpaceSize = initialOldSpaceSize.Get();
+    }
+
+    if (minSemiSpaceSize) {
+        settings.minSemiSpaceSize = minSemiSpaceSize.Get();
+    }
+
     if (maxStackSize) {
         NAPA_ASSERT(maxStackSize.Get() > 0, "The maximum allowed stack size must be greater than 0");
         settings.maxStackSize = maxStackSize.Get();
     }
 
+    if (idleSpinTime) {
+        settings.idleSpinTime = idleSpinTime.Get();
+    }
+
+    if (affinitySpillThreshold) {
+        settings.affinitySpillThreshold = affinitySpillThreshold.Get();
+    }
+
+    if (workerQueueDepth) {
+        settings.workerQueueDepth = workerQueueDepth.Get();
+    }
+
+    if (maxQueueLength) {
+        settings.maxQueueLength = maxQueueLength.Get();
+    }
+
+    if (maxQueueBytes) {
+        settings.maxQueueBytes = maxQueueBytes.Get();
+    }
+
+    if (resultCacheBytes) {
+        settings.resultCacheBytes = resultCacheBytes.Get();
+    }
+
+    if (resultCacheTtl) {
+        settings.resultCacheTtl = resultCacheTtl.Get();
+    }
+
+    if (scheduler) {
+        settings.scheduler = scheduler.Get();
+    }
+
+    if (workerPlacement) {
+        settings.workerPlacement = workerPlacement.Get();
+    }
+
+    if (numaNode) {
+        NAPA_ASSERT(numaNode.Get() >= -1, "The NUMA node must be -1 or a node number");
+        settings.numaNode = numaNode.Get();
+    }
+
+    if (workerPriority) {
+        settings.workerPriority = workerPriority.Get();
+    }
+
+    if (recycleTaskCount) {
+        settings.recycleTaskCount = recycleTaskCount.Get();
+    }
+
+    if (recycleHeapSize) {
+        settings.recycleHeapSize = recycleHeapSize.Get();
+    }
+
+    if (recycleFragmentation) {
+        NAPA_ASSERT(recycleFragmentation.Get() <= 100, "The recycle fragmentation must be a percentage");
+        settings.recycleFragmentation = recycleFragmentation.Get();
+    }
+
+    if (idleGcTime) {
+        settings.idleGcTime = idleGcTime.Get();
+    }
+
+    if (idleGcFullTime) {
+        settings.idleGcFullTime = idleGcFullTime.Get();
+    }
+
+    if (gcMode) {
+        settings.gcMode = gcMode.Get();
+    }
+
+    if (broadcastLogCompaction) {
+        settings.broadcastLogCompaction = broadcastLogCompaction.Get();
+    }
+
+    if (broadcastCodeCache) {
+        settings.broadcastCodeCache = broadcastCodeCache.Get();
+    }
+
+    if (codeCacheWarmUpTasks) {
+        settings.codeCacheWarmUpTasks = codeCacheWarmUpTasks.Get();
+    }
+
+    if (broadcastConcurrency) {
+        settings.broadcastConcurrency = broadcastConcurrency.Get();
+    }
+
+    if (eventLoop) {
+        settings.eventLoop = eventLoop.Get();
+    }
+
+    if (sharedThreads) {
+        settings.sharedThreads = sharedThreads.Get();
+    }
+
+    if (microtaskBatchSize) {
+        settings.microtaskBatchSize = microtaskBatchSize.Get();
+    }
+
+    if (cpuWeight) {
+        if (cpuWeight.Get() == 0) {
+            LOG_ERROR("Settings", "cpuWeight must be positive.");
+            return false;
+        }
+        settings.cpuWeight = cpuWeight.Get();
+    }
+
+    if (slowCallThreshold) {
+        settings.slowCallThreshold = slowCallThreshold.Get();
+    }
+
+    if (slowCallSampleRate) {
+        settings.slowCallSampleRate = slowCallSampleRate.Get();
+    }
+
+    if (slowCallLogSize) {
+        if (slowCallLogSize.Get() == 0) {
+            LOG_ERROR("Settings", "slowCallLogSize must be positive.");
+            return false;
+        }
+        settings.slowCallLogSize = slowCallLogSize.Get();
+    }
+
+    if (slowCallPayloadBytes) {
+        settings.slowCallPayloadBytes = slowCallPayloadBytes.Get();
+    }
+
+    if (preload) {
+        settings.preload.clear();
+        utils::string::Split(preload.Get(), settings.preload, ",", true);
+    }
+
+    // Parsed last, classes default to the isolate constraints of the zone.
+    if (workerClasses) {
+        std::vector<WorkerClass> parsed;
+        if (!ParseWorkerClasses(workerClasses.Get(), settings, parsed)) {
+            return false;
+        }
+        settings.workerClasses = std::move(parsed);
+    }
+
+    if (settings.maxSemiSpaceSize > 0 && settings.minSemiSpaceSize > settings.maxSemiSpaceSize) {
+        LOG_ERROR("Settings", "The initial semi space size exceeds the maximum of %u MB.", settings.maxSemiSpaceSize);
+        return false;
+    }
+
+    if (tenants) {
+        std::vector<Tenant> parsed;
+        if (!ParseTenants(tenants.Get(), parsed)) {
+            return false;
+        }
+        settings.tenants = std::move(parsed);
+    }
+
+    // A libuv loop blocks the thread of its worker while it waits.
+    if (settings.sharedThreads && settings.eventLoop) {
+        LOG_ERROR("Settings", "Workers with an event loop can't share threads.");
+        return false;
+    }
+
+    if (!settings.tenants.empty() && settings.scheduler != SchedulerType::SYNCHRONIZED) {
+        LOG_ERROR("Settings", "Tenants require the \"%s\" scheduler.", "synchronized");
+        return false;
+    }
+
+    if (settings.replaceStuckWorkers && settings.stuckWorkerThreshold == 0) {
+        LOG_ERROR("Settings", "replaceStuckWorkers requires a stuckWorkerThreshold.");
+        return false;
+    }
+
+    if (settings.workerQueueDepth > 0 && settings.scheduler != SchedulerType::SYNCHRONIZED) {
+        LOG_ERROR("Settings", "workerQueueDepth requires the \"%s\" scheduler.", "synchronized");
+        return false;
+    }
+
+    uint32_t classWorkers = 0;
+    for (const auto& workerClass : settings.workerClasses) {
+        classWorkers += workerClass.workers;
+    }
+    if (classWorkers > settings.workers) {
+        LOG_ERROR("Settings", "Worker classes have more workers than the %u workers of the zone.", settings.workers);
+        return false;
+    }
+
     return true;
 }
\ No newline at end of file
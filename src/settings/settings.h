@@ -4,20 +4,218 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace napa {
 namespace settings {
 
+    /// <summary> Backends of napa_allocate and napa_deallocate. </summary>
+    enum class AllocatorType {
+        /// <summary> C runtime malloc and free from napa.dll. </summary>
+        CRT,
+
+        /// <summary> Size classes with per thread caches of free blocks, see napa::memory::GetThreadCachingAllocator. </summary>
+        THREAD_CACHING
+    };
+
+    /// <summary> Formats of the file written by the 'async' logging provider. </summary>
+    enum class LogFormat {
+        /// <summary> Lines of text, like the 'console' logging provider writes. </summary>
+        TEXT,
+
+        /// <summary> Binary records of formats and arguments, rendered by the napa-log-decoder tool. </summary>
+        BINARY
+    };
+
+    /// <summary> How console.log of zone workers writes lines. </summary>
+    enum class ConsoleOutput {
+        /// <summary> Each line is written to the standard output on the calling thread. </summary>
+        SYNC,
+
+        /// <summary> Lines are buffered per thread and written to the standard output in batches on a background thread. </summary>
+        ASYNC,
+
+        /// <summary> Lines are buffered per thread and written in batches by the Node.js main thread. </summary>
+        NODE
+    };
+
+    /// <summary> How workers load JSON modules. </summary>
+    enum class JsonModules {
+        /// <summary> Each worker reads and parses the file. </summary>
+        PARSE,
+
+        /// <summary> The file is parsed once per process, and workers deserialize a shared binary copy. </summary>
+        SHARED,
+
+        /// <summary> As SHARED, and workers deep-freeze the deserialized objects. </summary>
+        FROZEN
+    };
+
     /// <summary> Platform settings - setting that affect all zones. </summary>
     struct PlatformSettings {
 
         /// <summary> The logging provider. </summary>
         std::string loggingProvider = "console";
 
+        /// <summary> The file the 'async' logging provider appends to, empty for the standard output. </summary>
+        std::string logFile;
+
+        /// <summary> The number of messages each thread can queue with the 'async' logging provider, 0 for the default of 256. </summary>
+        uint32_t logBufferSize = 0;
+
+        /// <summary> The format of the file written by the 'async' logging provider. </summary>
+        LogFormat logFormat = LogFormat::TEXT;
+
+        /// <summary> How console.log of zone workers writes lines. </summary>
+        ConsoleOutput consoleOutput = ConsoleOutput::ASYNC;
+
+        /// <summary> The number of lines per second each zone worker may write with console.log, beyond which lines are dropped. 0 for no limit. </summary>
+        uint32_t consoleRateLimit = 0;
+
         /// <summary> The metric provider. </summary>
         std::string metricProvider;
+
+        /// <summary> Name of the shared memory segment of the 'shared-memory' metric provider, empty for 'napa-metrics-<pid>'. </summary>
+        std::string metricSegment;
+
+        /// <summary> Size in MB of the shared memory segment of the 'shared-memory' metric provider, 0 for the default of 16. </summary>
+        uint32_t metricSegmentSize = 0;
+
+        /// <summary> Number of bootstrapped isolates kept aside for new zones, 0 to disable. </summary>
+        uint32_t spareIsolates = 0;
+
+        /// <summary> Path of a V8 startup snapshot to create napa isolates from, empty for the built-in one. </summary>
+        std::string snapshotBlob;
+
+        /// <summary> Directory to persist code caches of Javascript modules in, empty to keep them in memory only. </summary>
+        std::string codeCacheDirectory;
+
+        /// <summary> Whether Javascript modules are loaded as function wrappers in the worker context, instead of a context per module. </summary>
+        bool moduleWrappers = false;
+
+        /// <summary> Whether file system lookups of module resolution are cached process-wide, including misses. </summary>
+        bool moduleStatCache = false;
+
+        /// <summary> How workers load JSON modules. </summary>
+        JsonModules jsonModules = JsonModules::PARSE;
+
+        /// <summary> Path of a module bundle to serve modules from, empty for none. </summary>
+        std::string moduleBundle;
+
+        /// <summary> Interval in milliseconds to poll files of loaded modules at, and reload the changed ones. 0 to disable. </summary>
+        uint32_t moduleWatchInterval = 0;
+
+        /// <summary> The backend of napa_allocate, set on initialization unless napa_allocator_set was called before. </summary>
+        AllocatorType allocator = AllocatorType::CRT;
+
+        /// <summary> The total size in MB of released ArrayBuffer contents kept for reuse by napa isolates. 0 to disable pooling. </summary>
+        uint32_t arrayBufferPoolSize = 0;
+
+        /// <summary> Whether pooled ArrayBuffers of 2MB or more are advised to be backed by huge pages, where supported. </summary>
+        bool arrayBufferHugePages = false;
+
+        /// <summary> Number of threads running CPU bound work posted by modules, 0 for the number of processors. </summary>
+        uint32_t asyncCpuWorkers = 0;
+
+        /// <summary> Number of threads running work posted by modules that may block, 0 for the default of 16. </summary>
+        uint32_t asyncIoWorkers = 0;
+
+        /// <summary> The factor V8 grows the semi spaces of all isolates by, up to their maximum size. 0 for the V8 default. </summary>
+        uint32_t semiSpaceGrowthFactor = 0;
+
+        /// <summary> Number of threads running background tasks of V8 for all isolates, 0 for the number of processors. </summary>
+        uint32_t v8PlatformThreads = 0;
+
+        /// <summary> Number of zone workers of all zones running tasks at the same time, 0 for no limit. </summary>
+        uint32_t cpuBudget = 0;
+
+        /// <summary> Number of threads that workers of zones with the 'sharedThreads' setting take turns on, 0 for the number of processors. </summary>
+        uint32_t sharedWorkerThreads = 0;
+
+        /// <summary> Directory the flight recorder of worker events is dumped to on V8 fatal errors, empty for the current directory. </summary>
+        std::string flightRecorderDirectory;
+    };
+
+    /// <summary> Strategies for dispatching tasks to zone workers. </summary>
+    enum class SchedulerType {
+        /// <summary> A single synchronizer thread owns the task queue and the idle workers list. </summary>
+        SYNCHRONIZED,
+
+        /// <summary> Tasks are queued per worker, idle workers steal tasks from their peers. </summary>
+        WORK_STEALING,
+
+        /// <summary> Like SYNCHRONIZED, but queued tasks are served by earliest deadline and expired ones are dropped. </summary>
+        EARLIEST_DEADLINE
+    };
+
+    /// <summary> Policies for pinning zone workers to logical processors. </summary>
+    enum class WorkerPlacement {
+        /// <summary> Workers are not pinned, the OS may migrate them freely. </summary>
+        NONE,
+
+        /// <summary> Workers are pinned round-robin across NUMA nodes, for the most memory bandwidth. </summary>
+        SPREAD,
+
+        /// <summary> Workers fill up the processors of a NUMA node before using the next, for the most cache sharing. </summary>
+        COMPACT
+    };
+
+    /// <summary> OS scheduling priorities of zone worker threads, relative to other threads of the host. </summary>
+    enum class WorkerPriority {
+        LOWEST,
+        LOW,
+        NORMAL,
+        HIGH,
+        HIGHEST
+    };
+
+    /// <summary> How the garbage collector of zone isolates trades pause times for throughput and memory. </summary>
+    enum class GcMode {
+        /// <summary> The V8 default, incremental and concurrent marking balance latency and throughput. </summary>
+        BALANCED,
+
+        /// <summary> V8 avoids interrupting Javascript, at the cost of throughput. </summary>
+        LATENCY,
+
+        /// <summary> V8 may turn off latency optimizations, such as starting incremental marking early, for throughput. </summary>
+        THROUGHPUT,
+
+        /// <summary> V8 optimizes for memory usage, e.g. by compacting the heap more eagerly. </summary>
+        MEMORY
+    };
+
+    /// <summary> A named group of zone workers with their own isolate constraints, which calls can be routed to. </summary>
+    struct WorkerClass {
+
+        /// <summary> The name calls pick the class by. </summary>
+        std::string name;
+
+        /// <summary> The number of workers of the class. </summary>
+        uint32_t workers = 1u;
+
+        /// <summary> Isolate memory constraint - The maximum old space size in megabytes. </summary>
+        uint32_t maxOldSpaceSize = 0u;
+
+        /// <summary> Isolate memory constraint - The maximum semi space size in megabytes. </summary>
+        uint32_t maxSemiSpaceSize = 0u;
+
+        /// <summary> The maximum size that the isolate stack is allowed to grow in bytes. </summary>
+        uint32_t maxStackSize = 500 * 1024;
+    };
+
+    /// <summary> A caller of a zone, whose calls share the zone workers fairly with other tenants. </summary>
+    struct Tenant {
+
+        /// <summary> The name calls are tagged with. </summary>
+        std::string name;
+
+        /// <summary> The share of workers the tenant gets relative to other tenants, when calls are queued. </summary>
+        uint32_t weight = 1u;
+
+        /// <summary> The maximum number of calls of the tenant running on workers at the same time. 0 for no limit. </summary>
+        uint32_t maxConcurrency = 0u;
     };
 
     /// <summary> Zone specific settings. </summary>
@@ -29,6 +227,24 @@ namespace settings {
         /// <summary> The number of zone workers. </summary>
         uint32_t workers = 2;
 
+        /// <summary> The minimum number of workers the autoscaler shrinks the zone to. </summary>
+        uint32_t minWorkers = 1u;
+
+        /// <summary> The maximum number of workers the zone can be resized to. 0 for the initial number of workers. </summary>
+        uint32_t maxWorkers = 0u;
+
+        /// <summary> The interval in milliseconds of the autoscaler sampling queue depth and idle workers. 0 disables autoscaling. </summary>
+        uint32_t autoscaleInterval = 0u;
+
+        /// <summary> The time in milliseconds workers must have been idle before the autoscaler removes one. </summary>
+        uint32_t autoscaleIdleTime = 60000u;
+
+        /// <summary> The time in milliseconds a worker runs a task for before the watchdog takes it as stuck. 0 disables the watchdog. </summary>
+        uint32_t stuckWorkerThreshold = 0u;
+
+        /// <summary> Whether the watchdog adds a worker in place of each stuck one, and recycles the isolate of a worker that recovered. </summary>
+        bool replaceStuckWorkers = false;
+
         /// <summary> Isolate memory constraint - The maximum old space size in megabytes. </summary>
         uint32_t maxOldSpaceSize = 0u;
 
@@ -38,8 +254,119 @@ namespace settings {
         /// <summary> Isolate memory constraint - The maximum executable size in megabytes. </summary>
         uint32_t maxExecutableSize = 0u;
 
-        /// <summary> The maximum size that the isolate stack is allowed to grow in bytes. </summary>
+        /// <summary> Isolate heap - The initial old space size in megabytes, which the first full GCs are triggered by. 0 for the V8 default. </summary>
+        uint32_t initialOldSpaceSize = 0u;
+
+        /// <summary> Isolate heap - The initial semi space size in megabytes, which the young generation grows from. 0 for the V8 default. </summary>
+        uint32_t minSemiSpaceSize = 0u;
+
+        /// <summary> The maximum size that the isolate stack is allowed to grow in bytes, worker threads are created with a larger stack. </summary>
         uint32_t maxStackSize = 500 * 1024;
+
+        /// <summary> The time in microseconds an idle worker spins for new tasks before parking. 0 parks immediately. </summary>
+        uint32_t idleSpinTime = 0u;
+
+        /// <summary> The maximum number of queued tasks on the preferred worker of an affinity key, beyond which calls spill to other workers. </summary>
+        uint32_t affinitySpillThreshold = 16u;
+
+        /// <summary>
+        /// The number of unfinished tasks, running one included, a busy worker is kept filled with from the queue of the
+        /// synchronized scheduler, so it starts its next task without waiting for the scheduler. 0 hands tasks to idle workers only.
+        /// </summary>
+        uint32_t workerQueueDepth = 0u;
+
+        /// <summary> The maximum number of pending calls (queued or running), beyond which calls are rejected. 0 for no limit. </summary>
+        uint32_t maxQueueLength = 0u;
+
+        /// <summary> The maximum total size in bytes of pending calls' module, function and arguments. 0 for no limit. </summary>
+        uint64_t maxQueueBytes = 0u;
+
+        /// <summary> The maximum size in bytes of cached call results, keyed by function and arguments. 0 disables the cache. </summary>
+        uint64_t resultCacheBytes = 0u;
+
+        /// <summary> The time in milliseconds cached call results live. 0 for no expiry. </summary>
+        uint32_t resultCacheTtl = 0u;
+
+        /// <summary> The strategy used for dispatching tasks to zone workers. </summary>
+        SchedulerType scheduler = SchedulerType::SYNCHRONIZED;
+
+        /// <summary> The policy for pinning zone workers to logical processors. </summary>
+        WorkerPlacement workerPlacement = WorkerPlacement::NONE;
+
+        /// <summary> The NUMA node zone workers are restricted to. -1 for any node. </summary>
+        int32_t numaNode = -1;
+
+        /// <summary> The OS scheduling priority of zone worker threads. </summary>
+        WorkerPriority workerPriority = WorkerPriority::NORMAL;
+
+        /// <summary> The number of tasks after which a worker recreates its isolate. 0 to disable. </summary>
+        uint32_t recycleTaskCount = 0u;
+
+        /// <summary> The used heap size in MB beyond which a worker recreates its isolate. 0 to disable. </summary>
+        uint32_t recycleHeapSize = 0u;
+
+        /// <summary> The percentage of free heap space beyond which a worker recreates its isolate. 0 to disable. </summary>
+        uint32_t recycleFragmentation = 0u;
+
+        /// <summary> The time in milliseconds of garbage collection work an idle worker does per idle step. 0 to disable. </summary>
+        uint32_t idleGcTime = 0u;
+
+        /// <summary> The time in milliseconds a worker stays idle before it runs a full garbage collection. 0 to disable. </summary>
+        uint32_t idleGcFullTime = 0u;
+
+        /// <summary> How the garbage collector of worker isolates trades pause times for throughput and memory. </summary>
+        GcMode gcMode = GcMode::BALANCED;
+
+        /// <summary> Whether broadcasting a source again replaces its earlier entry in the broadcast replay log. </summary>
+        bool broadcastLogCompaction = false;
+
+        /// <summary> Whether broadcast sources are compiled with a V8 code cache shared by zone workers. </summary>
+        bool broadcastCodeCache = true;
+
+        /// <summary> The number of tasks after which a worker replaces the code caches of modules it loaded with warm ones. 0 to disable. </summary>
+        uint32_t codeCacheWarmUpTasks = 0u;
+
+        /// <summary> The maximum number of workers running a broadcast at a time, the others keep running calls. 0 for all workers at once. </summary>
+        uint32_t broadcastConcurrency = 0u;
+
+        /// <summary> Whether each worker runs a libuv loop between tasks, for native modules using libuv handles. </summary>
+        bool eventLoop = false;
+
+        /// <summary> Whether workers take turns on a process-wide pool of threads instead of having a thread each. </summary>
+        bool sharedThreads = false;
+
+        /// <summary> The number of tasks after which a worker runs a microtask checkpoint. 0 leaves microtasks to V8. </summary>
+        uint32_t microtaskBatchSize = 0u;
+
+        /// <summary> The share of the process-wide CPU budget the zone gets relative to other zones, when workers wait for it. </summary>
+        uint32_t cpuWeight = 1u;
+
+        /// <summary> The time in milliseconds from Execute() to completion beyond which a call is kept in the slow-call log. 0 to disable. </summary>
+        uint32_t slowCallThreshold = 0u;
+
+        /// <summary> The rate of calls kept in the slow-call log however long they take, 1 in every N calls. 0 to disable. </summary>
+        uint32_t slowCallSampleRate = 0u;
+
+        /// <summary> The number of most recent calls the slow-call log keeps. </summary>
+        uint32_t slowCallLogSize = 100u;
+
+        /// <summary> The number of bytes of marshalled arguments kept with each call in the slow-call log. 0 keeps their sizes only. </summary>
+        uint32_t slowCallPayloadBytes = 0u;
+
+        /// <summary> Modules that every worker loads at zone creation, compiled in parallel ahead of the workers. </summary>
+        std::vector<std::string> preload;
+
+        /// <summary>
+        ///     Groups of workers with their own isolate constraints, which are the first workers of the zone in order.
+        ///     They count in the number of workers, and resizing only adds or removes the workers after them.
+        /// </summary>
+        std::vector<WorkerClass> workerClasses;
+
+        /// <summary>
+        ///     Tenants with their weights and concurrency caps. Calls of other tenants share workers with a weight of 1
+        ///     and no cap, and so do calls without a tenant. Only the synchronized scheduler shares workers by tenant.
+        /// </summary>
+        std::vector<Tenant> tenants;
     };
 }
 }
\ No newline at end of file
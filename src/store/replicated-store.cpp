@@ -0,0 +1,621 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "replicated-store.h"
+
+#include <memory/shared-memory.h>
+#include <zone/remote-protocol.h>
+
+#include <napa/log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace napa;
+using namespace napa::store;
+
+namespace {
+
+    /// <summary> Types of frames, each a u32 size and a u8 type followed by the payload, little-endian. </summary>
+    enum class FrameType : uint8_t {
+        SET = 1,
+        DELETE
+    };
+
+    const size_t HEADER_SIZE = 5;
+
+    /// <summary> Largest frame accepted from a peer. </summary>
+    const uint32_t MAX_PAYLOAD_SIZE = 1 << 30;
+
+    /// <summary> Flags of a set value. Compressed values are shipped as they are stored. </summary>
+    const uint8_t BINARY_FLAG = 1;
+    const uint8_t COMPRESSED_FLAG = 2;
+
+    void WriteUint8(std::string& buffer, uint8_t value) {
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void WriteUint32(std::string& buffer, uint32_t value) {
+        for (size_t i = 0; i < 4; i++) {
+            buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void WriteUint64(std::string& buffer, uint64_t value) {
+        for (size_t i = 0; i < 8; i++) {
+            buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void WriteBytes(std::string& buffer, const void* data, size_t size) {
+        WriteUint32(buffer, static_cast<uint32_t>(size));
+        buffer.append(static_cast<const char*>(data), size);
+    }
+
+    /// <summary> Reads fields of a payload, failing once past its end. </summary>
+    class Reader {
+    public:
+        Reader(const std::string& payload) : _data(payload.data()), _size(payload.size()), _position(0) {}
+
+        bool ReadUint8(uint8_t& value) {
+            if (_size - _position < 1) {
+                return false;
+            }
+            value = static_cast<uint8_t>(_data[_position++]);
+            return true;
+        }
+
+        bool ReadUint64(uint64_t& value) {
+            if (_size - _position < 8) {
+                return false;
+            }
+            value = 0;
+            for (size_t i = 0; i < 8; i++) {
+                value |= static_cast<uint64_t>(static_cast<uint8_t>(_data[_position++])) << (8 * i);
+            }
+            return true;
+        }
+
+        bool ReadBytes(const char*& data, size_t& size) {
+            if (_size - _position < 4) {
+                return false;
+            }
+            uint32_t length = 0;
+            for (size_t i = 0; i < 4; i++) {
+                length |= static_cast<uint32_t>(static_cast<uint8_t>(_data[_position++])) << (8 * i);
+            }
+            if (_size - _position < length) {
+                return false;
+            }
+            data = _data + _position;
+            size = length;
+            _position += length;
+            return true;
+        }
+
+    private:
+        const char* _data;
+        size_t _size;
+        size_t _position;
+    };
+
+    /// <summary> Receives a frame, false once the connection is closed or sends an invalid frame. </summary>
+    bool ReceiveFrame(platform::Socket& socket, FrameType& type, std::string& payload) {
+        char header[HEADER_SIZE];
+        if (!socket.Receive(header, HEADER_SIZE)) {
+            return false;
+        }
+
+        uint32_t size = 0;
+        for (size_t i = 0; i < 4; i++) {
+            size |= static_cast<uint32_t>(static_cast<uint8_t>(header[i])) << (8 * i);
+        }
+        type = static_cast<FrameType>(header[4]);
+        if (size > MAX_PAYLOAD_SIZE || (type != FrameType::SET && type != FrameType::DELETE)) {
+            return false;
+        }
+
+        payload.resize(size);
+        return size == 0 || socket.Receive(&payload[0], size);
+    }
+
+    uint64_t GetWallClock() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+}
+
+struct ReplicatedStore::Peer {
+    std::string address;
+    std::string host;
+    uint16_t port = 0;
+
+    /// <summary> Guards the fields below, which the shipping thread and writers share. </summary>
+    std::mutex lock;
+    std::condition_variable changed;
+
+    /// <summary> Writes to ship, queued only while connected, as a new connection starts with all keys. </summary>
+    std::vector<Write> queue;
+    bool connected = false;
+
+    /// <summary> The connection, which the store shuts down to stop the shipping thread. </summary>
+    std::unique_ptr<platform::Socket> socket;
+
+    std::thread thread;
+};
+
+struct ReplicatedStore::Connection {
+    std::unique_ptr<platform::Socket> socket;
+    std::thread thread;
+    std::atomic<bool> done { false };
+};
+
+constexpr std::chrono::milliseconds ReplicatedStore::RECONNECT_INTERVAL;
+
+std::unique_ptr<ReplicatedStore> ReplicatedStore::Start(
+    std::unique_ptr<Store> local,
+    const std::string& address,
+    const std::vector<std::string>& peers) {
+
+    std::string host;
+    uint16_t port;
+    if (!zone::remote::ParseAddress(address, host, port)) {
+        LOG_ERROR("Store", "Invalid address \"%s\" to replicate store \"%s\" on, expected \"host:port\".", address.c_str(), local->GetId());
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Peer>> parsedPeers;
+    for (const auto& peerAddress : peers) {
+        auto peer = std::make_unique<Peer>();
+        peer->address = peerAddress;
+        if (!zone::remote::ParseAddress(peerAddress, peer->host, peer->port) || peer->port == 0) {
+            LOG_ERROR("Store", "Invalid peer address \"%s\" of store \"%s\", expected \"host:port\".", peerAddress.c_str(), local->GetId());
+            return nullptr;
+        }
+        parsedPeers.emplace_back(std::move(peer));
+    }
+
+    uint16_t boundPort;
+    auto listener = platform::Socket::Listen(host, port, boundPort);
+    if (listener == nullptr) {
+        LOG_ERROR("Store", "Failed to listen on \"%s\" to replicate store \"%s\".", address.c_str(), local->GetId());
+        return nullptr;
+    }
+
+    std::unique_ptr<ReplicatedStore> store(new ReplicatedStore(std::move(local), std::move(listener), boundPort));
+    store->_peers = std::move(parsedPeers);
+    for (auto& peer : store->_peers) {
+        peer->thread = std::thread(&ReplicatedStore::Ship, store.get(), std::ref(*peer));
+    }
+
+    LOG_INFO("Store", "Replicating store \"%s\" on port %u to %zu peers.", store->GetId(), static_cast<uint32_t>(boundPort), peers.size());
+    return store;
+}
+
+ReplicatedStore::ReplicatedStore(std::unique_ptr<Store> local, std::unique_ptr<platform::Socket> listener, uint16_t port) :
+    _local(std::move(local)),
+    _listener(std::move(listener)),
+    _port(port),
+    _stopping(false) {
+
+    // Stamps are striped like the shards of the local store, so writes of different shards don't contend.
+    for (size_t i = 0; i < _local->GetShardCount(); i++) {
+        _stripes.emplace_back(std::make_unique<Stripe>());
+    }
+
+    std::random_device random;
+    _replica = (static_cast<uint64_t>(random()) << 32) | random();
+    _clock = GetWallClock();
+
+    _acceptor = std::thread(&ReplicatedStore::Accept, this);
+}
+
+ReplicatedStore::~ReplicatedStore() {
+    _stopping = true;
+
+    _listener->Shutdown();
+    _acceptor.join();
+
+    // The acceptor is gone, no connection is added anymore.
+    for (auto& connection : _connections) {
+        connection->socket->Shutdown();
+        connection->thread.join();
+    }
+
+    for (auto& peer : _peers) {
+        {
+            std::lock_guard<std::mutex> lock(peer->lock);
+            if (peer->socket != nullptr) {
+                peer->socket->Shutdown();
+            }
+            peer->changed.notify_all();
+        }
+        peer->thread.join();
+    }
+}
+
+uint16_t ReplicatedStore::GetPort() const {
+    return _port;
+}
+
+size_t ReplicatedStore::GetConnectedPeerCount() const {
+    size_t count = 0;
+    for (auto& peer : _peers) {
+        std::lock_guard<std::mutex> lock(peer->lock);
+        count += peer->connected ? 1 : 0;
+    }
+    return count;
+}
+
+const char* ReplicatedStore::GetId() const {
+    return _local->GetId();
+}
+
+napa::TransportOption ReplicatedStore::GetTransportOption() const {
+    return _local->GetTransportOption();
+}
+
+size_t ReplicatedStore::GetShardCount() const {
+    return _local->GetShardCount();
+}
+
+bool ReplicatedStore::IsReadOptimized() const {
+    return _local->IsReadOptimized();
+}
+
+ValueCacheOption ReplicatedStore::GetValueCacheOption() const {
+    return _local->GetValueCacheOption();
+}
+
+size_t ReplicatedStore::GetCompressionThreshold() const {
+    return _local->GetCompressionThreshold();
+}
+
+bool ReplicatedStore::CanStore(const char* key, const ValueType& value, std::string& error) const {
+    if (value.transportContext.GetSharedCount() > 0) {
+        error = "Values holding shared objects, e.g. allocators or SharedArrayBuffers, can't be set in a replicated store.";
+        return false;
+    }
+    return _local->CanStore(key, value, error);
+}
+
+void ReplicatedStore::Set(const char* key, std::shared_ptr<ValueType> value) {
+    std::string keyString(key);
+    auto& stripe = GetStripe(keyString);
+
+    std::lock_guard<std::mutex> lock(stripe.lock);
+    _local->Set(key, value);
+    Record(stripe, keyString, std::move(value));
+}
+
+std::shared_ptr<Store::ValueType> ReplicatedStore::Get(const char* key) const {
+    return _local->Get(key);
+}
+
+void ReplicatedStore::Read(const char* key, const std::function<void(const ValueType*)>& reader) const {
+    _local->Read(key, reader);
+}
+
+bool ReplicatedStore::Has(const char* key) const {
+    return _local->Has(key);
+}
+
+bool ReplicatedStore::CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) {
+    std::string keyString(key);
+    auto& stripe = GetStripe(keyString);
+
+    std::lock_guard<std::mutex> lock(stripe.lock);
+    if (!_local->CompareAndSet(key, expectedVersion, value)) {
+        return false;
+    }
+    Record(stripe, keyString, std::move(value));
+    return true;
+}
+
+std::shared_ptr<Store::ValueType> ReplicatedStore::GetOrSet(const char* key, std::shared_ptr<ValueType> value) {
+    std::string keyString(key);
+    auto& stripe = GetStripe(keyString);
+
+    std::lock_guard<std::mutex> lock(stripe.lock);
+    auto current = _local->GetOrSet(key, value);
+    if (current == value) {
+        Record(stripe, keyString, std::move(value));
+    }
+    return current;
+}
+
+bool ReplicatedStore::Increment(const char* key, int64_t delta, int64_t& result) {
+    std::string keyString(key);
+    auto& stripe = GetStripe(keyString);
+
+    // The sum is shipped, not the delta, as writes of peers are ordered by last writer wins.
+    std::lock_guard<std::mutex> lock(stripe.lock);
+    if (!_local->Increment(key, delta, result)) {
+        return false;
+    }
+    Record(stripe, keyString, _local->Get(key));
+    return true;
+}
+
+std::vector<std::shared_ptr<Store::ValueType>> ReplicatedStore::GetMany(const std::vector<std::string>& keys) const {
+    return _local->GetMany(keys);
+}
+
+void ReplicatedStore::SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) {
+    // Stripes of all keys are locked in order, so the local store still sets them with each of its shard locks once.
+    std::vector<size_t> stripeIndexes;
+    for (const auto& key : keys) {
+        stripeIndexes.push_back(GetShardIndex(key, _stripes.size()));
+    }
+    std::sort(stripeIndexes.begin(), stripeIndexes.end());
+    stripeIndexes.erase(std::unique(stripeIndexes.begin(), stripeIndexes.end()), stripeIndexes.end());
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for (auto index : stripeIndexes) {
+        locks.emplace_back(_stripes[index]->lock);
+    }
+
+    auto shipped = values;
+    _local->SetMany(keys, std::move(values));
+    for (size_t i = 0; i < keys.size(); i++) {
+        Record(GetStripe(keys[i]), keys[i], std::move(shipped[i]));
+    }
+}
+
+std::vector<Store::KeyValue> ReplicatedStore::Scan(const char* prefix, size_t limit) const {
+    return _local->Scan(prefix, limit);
+}
+
+void ReplicatedStore::Watch(std::shared_ptr<StoreWatcher> watcher) {
+    // Writes of peers apply to the local store, which notifies them like local writes.
+    _local->Watch(std::move(watcher));
+}
+
+void ReplicatedStore::Delete(const char* key) {
+    std::string keyString(key);
+    auto& stripe = GetStripe(keyString);
+
+    std::lock_guard<std::mutex> lock(stripe.lock);
+    _local->Delete(key);
+    Record(stripe, keyString, nullptr);
+}
+
+size_t ReplicatedStore::Size() const {
+    return _local->Size();
+}
+
+ReplicatedStore::Stripe& ReplicatedStore::GetStripe(const std::string& key) {
+    return *_stripes[GetShardIndex(key, _stripes.size())];
+}
+
+ReplicatedStore::Stamp ReplicatedStore::NextStamp() {
+    // Ahead of the wall clock and of all stamps seen, so a write always wins over the writes it saw.
+    auto now = GetWallClock();
+    auto clock = _clock.load();
+    uint64_t next;
+    do {
+        next = std::max(now, clock + 1);
+    } while (!_clock.compare_exchange_weak(clock, next));
+
+    Stamp stamp;
+    stamp.clock = next;
+    stamp.replica = _replica;
+    return stamp;
+}
+
+void ReplicatedStore::Record(Stripe& stripe, const std::string& key, std::shared_ptr<const ValueType> value) {
+    auto& keyStamp = stripe.stamps[key];
+    keyStamp.stamp = NextStamp();
+    keyStamp.deleted = value == nullptr;
+
+    for (auto& peer : _peers) {
+        std::lock_guard<std::mutex> lock(peer->lock);
+        if (peer->connected) {
+            peer->queue.push_back({ key, keyStamp.stamp, value });
+            if (peer->queue.size() == 1) {
+                peer->changed.notify_one();
+            }
+        }
+    }
+}
+
+void ReplicatedStore::Apply(Write write) {
+    auto clock = _clock.load();
+    while (write.stamp.clock > clock && !_clock.compare_exchange_weak(clock, write.stamp.clock)) {}
+
+    auto& stripe = GetStripe(write.key);
+    std::lock_guard<std::mutex> lock(stripe.lock);
+
+    auto& keyStamp = stripe.stamps[write.key];
+    if (!(keyStamp.stamp < write.stamp)) {
+        return;
+    }
+    keyStamp.stamp = write.stamp;
+    keyStamp.deleted = write.value == nullptr;
+
+    if (write.value == nullptr) {
+        _local->Delete(write.key.c_str());
+    } else {
+        _local->Set(write.key.c_str(), std::const_pointer_cast<ValueType>(write.value));
+    }
+}
+
+void ReplicatedStore::Accept() {
+    while (auto socket = _listener->Accept()) {
+        std::lock_guard<std::mutex> lock(_connectionsLock);
+
+        // Connections of peers that went away are reaped as new ones come.
+        auto finished = std::partition(_connections.begin(), _connections.end(), [](const std::unique_ptr<Connection>& existing) {
+            return !existing->done;
+        });
+        for (auto it = finished; it != _connections.end(); ++it) {
+            (*it)->thread.join();
+        }
+        _connections.erase(finished, _connections.end());
+
+        auto connection = std::make_unique<Connection>();
+        connection->socket = std::move(socket);
+        connection->thread = std::thread(&ReplicatedStore::Receive, this, std::ref(*connection));
+        _connections.emplace_back(std::move(connection));
+    }
+}
+
+void ReplicatedStore::Receive(Connection& connection) {
+    FrameType type;
+    std::string payload;
+    while (ReceiveFrame(*connection.socket, type, payload)) {
+        Reader reader(payload);
+        const char* data;
+        size_t size;
+
+        Write write;
+        if (!reader.ReadBytes(data, size) || !reader.ReadUint64(write.stamp.clock) || !reader.ReadUint64(write.stamp.replica)) {
+            break;
+        }
+        write.key.assign(data, size);
+
+        if (type == FrameType::SET) {
+            auto value = std::make_shared<ValueType>();
+            uint8_t kind, flags;
+            uint64_t scalar, ttl;
+            if (!reader.ReadUint8(kind)
+                || !reader.ReadUint8(flags)
+                || !reader.ReadUint64(scalar)
+                || !reader.ReadUint64(ttl)
+                || !reader.ReadBytes(data, size)
+                || kind > static_cast<uint8_t>(ValueKind::ARRAY_BUFFER)) {
+                break;
+            }
+
+            value->kind = static_cast<ValueKind>(kind);
+            value->binary = (flags & BINARY_FLAG) != 0;
+            value->compressed = (flags & COMPRESSED_FLAG) != 0;
+            std::memcpy(&value->integer, &scalar, sizeof(scalar));
+            value->ttl = std::chrono::milliseconds(ttl);
+            if (value->kind == ValueKind::ARRAY_BUFFER) {
+                if (size > 0) {
+                    auto buffer = std::malloc(size);
+                    std::memcpy(buffer, data, size);
+                    value->buffer = napa::memory::AdoptSharedMemory(buffer, size);
+                }
+            } else {
+                value->payload.assign(data, size);
+            }
+            write.value = std::move(value);
+        }
+        Apply(std::move(write));
+    }
+
+    connection.socket->Shutdown();
+    connection.done = true;
+}
+
+void ReplicatedStore::Ship(Peer& peer) {
+    while (!_stopping) {
+        auto socket = platform::Socket::Connect(peer.host, peer.port);
+        {
+            std::unique_lock<std::mutex> lock(peer.lock);
+            if (socket == nullptr) {
+                peer.changed.wait_for(lock, RECONNECT_INTERVAL, [this]() { return _stopping.load(); });
+                continue;
+            }
+            if (_stopping) {
+                break;
+            }
+            peer.socket = std::move(socket);
+            peer.connected = true;
+            peer.queue.clear();
+        }
+        LOG_INFO("Store", "Store \"%s\" connected to peer \"%s\".", GetId(), peer.address.c_str());
+
+        // Writes made while all keys are encoded are queued too, receivers ignore those that are not newer.
+        std::string buffer;
+        EncodeAll(buffer);
+
+        auto sent = buffer.empty() || peer.socket->Send(buffer.data(), buffer.size());
+        while (sent) {
+            std::vector<Write> writes;
+            {
+                std::unique_lock<std::mutex> lock(peer.lock);
+                peer.changed.wait(lock, [this, &peer]() { return _stopping || !peer.queue.empty(); });
+                if (_stopping) {
+                    break;
+                }
+                writes.swap(peer.queue);
+            }
+
+            // Writes queued meanwhile go with a single send.
+            buffer.clear();
+            for (const auto& write : writes) {
+                Encode(write, buffer);
+            }
+            sent = peer.socket->Send(buffer.data(), buffer.size());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(peer.lock);
+            peer.connected = false;
+            peer.queue.clear();
+            peer.socket->Shutdown();
+            peer.socket.reset();
+        }
+        if (!_stopping) {
+            LOG_WARNING("Store", "Store \"%s\" lost its connection to peer \"%s\", reconnecting.", GetId(), peer.address.c_str());
+        }
+    }
+}
+
+void ReplicatedStore::EncodeAll(std::string& buffer) {
+    std::vector<Write> all;
+    for (auto& stripe : _stripes) {
+        std::lock_guard<std::mutex> lock(stripe->lock);
+        for (const auto& entry : stripe->stamps) {
+            std::shared_ptr<const ValueType> value;
+            if (!entry.second.deleted) {
+                value = _local->Get(entry.first.c_str());
+                if (value == nullptr) {
+                    // Evicted or expired locally.
+                    continue;
+                }
+            }
+            all.push_back({ entry.first, entry.second.stamp, std::move(value) });
+        }
+    }
+
+    // Encoded out of stripe locks, as writers wait on them.
+    for (const auto& write : all) {
+        Encode(write, buffer);
+    }
+}
+
+void ReplicatedStore::Encode(const Write& write, std::string& buffer) {
+    auto start = buffer.size();
+    WriteUint32(buffer, 0);
+    WriteUint8(buffer, static_cast<uint8_t>(write.value != nullptr ? FrameType::SET : FrameType::DELETE));
+    WriteBytes(buffer, write.key.data(), write.key.size());
+    WriteUint64(buffer, write.stamp.clock);
+    WriteUint64(buffer, write.stamp.replica);
+
+    if (write.value != nullptr) {
+        const auto& value = *write.value;
+        uint64_t scalar;
+        std::memcpy(&scalar, &value.integer, sizeof(scalar));
+        WriteUint8(buffer, static_cast<uint8_t>(value.kind));
+        WriteUint8(buffer, static_cast<uint8_t>((value.binary ? BINARY_FLAG : 0) | (value.compressed ? COMPRESSED_FLAG : 0)));
+        WriteUint64(buffer, scalar);
+        WriteUint64(buffer, static_cast<uint64_t>(value.ttl.count()));
+        if (value.kind == ValueKind::ARRAY_BUFFER) {
+            WriteBytes(buffer, value.buffer != nullptr ? value.buffer->GetData() : nullptr, value.buffer != nullptr ? value.buffer->GetLength() : 0);
+        } else {
+            WriteBytes(buffer, value.payload.data(), value.payload.size());
+        }
+    }
+
+    auto size = static_cast<uint32_t>(buffer.size() - start - HEADER_SIZE);
+    for (size_t i = 0; i < 4; i++) {
+        buffer[start + i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+    }
+}
@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "store.h"
+
+#include <platform/socket.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace store {
+
+    /// <summary> Store whose writes are propagated asynchronously to the stores of the same id in peer processes. </summary>
+    /// <remarks>
+    ///     Reads and watches go to a local store, so they are as fast as those of a store that isn't replicated. Writes
+    ///     apply locally, then are queued for a thread per peer, which ships them in batches over a TCP connection.
+    ///     Conflicting writes are resolved by last writer wins: each write is stamped by a hybrid logical clock, with the
+    ///     replica id breaking ties, and a replica applies a write only if its stamp is newer than that of the key.
+    ///     Deleted keys keep a tombstone stamp, so a late write doesn't bring them back.
+    ///     A peer that is unreachable is retried every second, and gets all keys with their stamps once connected, so
+    ///     writes missed meanwhile converge. Writes are not forwarded, each replica lists all others as peers.
+    ///     Atomic operations are atomic per replica only, e.g. concurrent increments on two replicas keep one of them.
+    ///     Keys evicted or expired by limits of the local store are not propagated. There is no authentication, so
+    ///     replicas should only listen on trusted networks.
+    /// </remarks>
+    class ReplicatedStore : public Store {
+    public:
+        /// <summary> Interval between attempts to connect to a peer. </summary>
+        static constexpr std::chrono::milliseconds RECONNECT_INTERVAL { 1000 };
+
+        /// <summary> Starts replicating a local store. </summary>
+        /// <param name="local"> The store that reads go to and writes apply to. </param>
+        /// <param name="address"> The "host:port" address to receive writes of peers on, port 0 for any free port. </param>
+        /// <param name="peers"> The "host:port" addresses of peers to propagate writes to. </param>
+        /// <returns> The store, or nullptr if an address is invalid or can't be listened on. </returns>
+        static std::unique_ptr<ReplicatedStore> Start(
+            std::unique_ptr<Store> local,
+            const std::string& address,
+            const std::vector<std::string>& peers);
+
+        /// <summary> Stops replicating, writes not shipped yet are dropped. </summary>
+        ~ReplicatedStore();
+
+        /// <summary> Gets the port that writes of peers are received on. </summary>
+        uint16_t GetPort() const;
+
+        /// <summary> Gets the number of peers that are connected. </summary>
+        size_t GetConnectedPeerCount() const;
+
+        const char* GetId() const override;
+        napa::TransportOption GetTransportOption() const override;
+        size_t GetShardCount() const override;
+        bool IsReadOptimized() const override;
+        ValueCacheOption GetValueCacheOption() const override;
+        size_t GetCompressionThreshold() const override;
+        bool CanStore(const char* key, const ValueType& value, std::string& error) const override;
+        void Set(const char* key, std::shared_ptr<ValueType> value) override;
+        std::shared_ptr<ValueType> Get(const char* key) const override;
+        void Read(const char* key, const std::function<void(const ValueType*)>& reader) const override;
+        bool Has(const char* key) const override;
+        bool CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) override;
+        std::shared_ptr<ValueType> GetOrSet(const char* key, std::shared_ptr<ValueType> value) override;
+        bool Increment(const char* key, int64_t delta, int64_t& result) override;
+        std::vector<std::shared_ptr<ValueType>> GetMany(const std::vector<std::string>& keys) const override;
+        void SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) override;
+        std::vector<KeyValue> Scan(const char* prefix, size_t limit) const override;
+        void Watch(std::shared_ptr<StoreWatcher> watcher) override;
+        void Delete(const char* key) override;
+        size_t Size() const override;
+
+    private:
+        /// <summary> Stamp of a write, ordered by clock then replica. </summary>
+        struct Stamp {
+            uint64_t clock = 0;
+            uint64_t replica = 0;
+
+            bool operator<(const Stamp& other) const {
+                return clock < other.clock || (clock == other.clock && replica < other.replica);
+            }
+        };
+
+        /// <summary> Stamp of the latest write of a key, which is a deletion for tombstones. </summary>
+        struct KeyStamp {
+            Stamp stamp;
+            bool deleted = false;
+        };
+
+        /// <summary> Stamps of the keys of a shard of the local store, and the lock ordering writes of the keys. </summary>
+        struct Stripe {
+            std::mutex lock;
+            std::unordered_map<std::string, KeyStamp> stamps;
+        };
+
+        /// <summary> A write queued for peers, the value is null for a deletion. </summary>
+        struct Write {
+            std::string key;
+            Stamp stamp;
+            std::shared_ptr<const ValueType> value;
+        };
+
+        /// <summary> A peer that writes are shipped to. </summary>
+        struct Peer;
+
+        /// <summary> A connection of a peer writing to this replica. </summary>
+        struct Connection;
+
+        ReplicatedStore(std::unique_ptr<Store> local, std::unique_ptr<platform::Socket> listener, uint16_t port);
+
+        /// <summary> Gets the stripe of a key. </summary>
+        Stripe& GetStripe(const std::string& key);
+
+        /// <summary> Gets the stamp of a local write. </summary>
+        Stamp NextStamp();
+
+        /// <summary> Records the stamp of a local write of a key under its stripe lock, and queues it for peers. </summary>
+        void Record(Stripe& stripe, const std::string& key, std::shared_ptr<const ValueType> value);
+
+        /// <summary> Applies a write of a peer, if it's newer than the latest write of the key. </summary>
+        void Apply(Write write);
+
+        /// <summary> Accepts connections of peers until the store stops. </summary>
+        void Accept();
+
+        /// <summary> Receives writes of a peer until it disconnects or the store stops. </summary>
+        void Receive(Connection& connection);
+
+        /// <summary> Connects to a peer and ships writes to it until the store stops. </summary>
+        void Ship(Peer& peer);
+
+        /// <summary> Encodes all keys with their stamps, which a newly connected peer gets first. </summary>
+        void EncodeAll(std::string& buffer);
+
+        /// <summary> Encodes a write as a frame. </summary>
+        static void Encode(const Write& write, std::string& buffer);
+
+        std::unique_ptr<Store> _local;
+        std::vector<std::unique_ptr<Stripe>> _stripes;
+
+        /// <summary> Random id of this replica, which breaks ties of stamps. </summary>
+        uint64_t _replica;
+
+        /// <summary> Hybrid logical clock, microseconds since epoch moved ahead by stamps of local and received writes. </summary>
+        std::atomic<uint64_t> _clock;
+
+        std::unique_ptr<platform::Socket> _listener;
+        uint16_t _port;
+        std::thread _acceptor;
+
+        std::vector<std::unique_ptr<Peer>> _peers;
+
+        /// <summary> Connections of peers writing to this replica. </summary>
+        std::mutex _connectionsLock;
+        std::vector<std::unique_ptr<Connection>> _connections;
+
+        std::atomic<bool> _stopping;
+    };
+}
+}
@@ -0,0 +1,721 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "shared-store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+using namespace napa::store;
+using napa::platform::InterprocessMutex;
+using napa::platform::SharedSegment;
+
+namespace {
+
+    /// <summary> Identifies a segment of a shared store, followed by the layout version. </summary>
+    constexpr char SEGMENT_MAGIC[8] = { 'N', 'A', 'P', 'A', 'S', 'H', 'M', 'S' };
+    constexpr uint32_t SEGMENT_VERSION = 1;
+
+    /// <summary> Alignment of heap blocks, and the smallest remainder worth splitting off a free block. </summary>
+    constexpr uint64_t BLOCK_ALIGNMENT = 16;
+    constexpr uint64_t MIN_SPLIT_SIZE = 64;
+
+    /// <summary> Headers of shards are kept on their own cache lines. </summary>
+    constexpr uint64_t CACHE_LINE_SIZE = 64;
+
+    /// <summary> Header of a block in the heap of a shard, followed by the key and payload of a used block. </summary>
+    struct Block {
+        /// <summary> Bytes of the block, including this header. </summary>
+        uint64_t size;
+
+        /// <summary> Offset of the next free block in ascending order, 0 for none. Only meaningful when free. </summary>
+        uint64_t next;
+    };
+
+    uint64_t Align(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    uint64_t RoundUpToPowerOfTwo(uint64_t value) {
+        uint64_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /// <summary> Attached stores of this process. Never destroyed, so it outlives the handler of process exit. </summary>
+    std::unordered_set<SharedStore*>& GetAttachedStores() {
+        static auto stores = new std::unordered_set<SharedStore*>();
+        return *stores;
+    }
+
+    std::mutex& GetAttachedStoresLock() {
+        static auto lock = new std::mutex();
+        return *lock;
+    }
+
+    /// <summary> Get bytes to copy into the segment for a value. </summary>
+    const char* GetPayload(const Store::ValueType& value, uint64_t& length) {
+        if (value.kind == ValueKind::ARRAY_BUFFER) {
+            length = value.buffer != nullptr ? value.buffer->GetLength() : 0;
+            return value.buffer != nullptr ? static_cast<const char*>(value.buffer->GetData()) : nullptr;
+        }
+        length = value.payload.size();
+        return value.payload.data();
+    }
+
+}   // End of anonymous namespace.
+
+struct SharedStore::SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t transport;
+
+    /// <summary> Set by the creator once the segment is initialized. </summary>
+    std::atomic<uint32_t> ready;
+    uint32_t valueCache;
+    uint64_t shardCount;
+
+    /// <summary> Hash of the store id, which the segment name is derived from. </summary>
+    uint64_t idHash;
+
+    /// <summary> Offset of the first shard header, and bytes between shard headers. </summary>
+    uint64_t shardsOffset;
+    uint64_t shardStride;
+
+    /// <summary> Next value version. </summary>
+    std::atomic<uint64_t> nextVersion;
+
+    /// <summary> Number of attached stores among processes, and whether the segment name is removed. Guarded by lock. </summary>
+    uint64_t attached;
+    uint64_t removed;
+
+    alignas(8) char lock[InterprocessMutex::STORAGE_SIZE];
+};
+
+struct SharedStore::ShardHeader {
+    alignas(8) char lock[InterprocessMutex::STORAGE_SIZE];
+
+    /// <summary> Offsets from the start of the segment, and sizes, of the slots and the heap. </summary>
+    uint64_t slotsOffset;
+    uint64_t slotCount;
+    uint64_t heapOffset;
+    uint64_t heapSize;
+
+    /// <summary> Offset of the first free block, 0 for none. </summary>
+    uint64_t freeList;
+
+    /// <summary> Number of used slots, beyond maxEntries keys are evicted. </summary>
+    uint64_t entries;
+    uint64_t maxEntries;
+
+    /// <summary> Position of the clock hand, modulo slotCount. </summary>
+    uint64_t hand;
+};
+
+struct SharedStore::Slot {
+    uint64_t hash;
+
+    /// <summary> Offset of the block of key and payload, 0 for an empty slot. </summary>
+    uint64_t block;
+    uint64_t payloadLength;
+
+    /// <summary> Bits of a BOOLEAN, NUMBER or INTEGER. </summary>
+    uint64_t scalar;
+    uint64_t version;
+    uint32_t kind;
+    uint32_t keyLength;
+    uint32_t binary;
+
+    /// <summary> Whether the slot was read since the clock hand last passed it. </summary>
+    uint32_t referenced;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "Atomics in shared memory must be lock-free.");
+
+constexpr size_t SharedStore::DEFAULT_BYTES;
+constexpr uint64_t SharedStore::NOT_FOUND;
+
+std::unique_ptr<SharedStore> SharedStore::Open(const char* id, const StoreOptions& options) {
+    std::string idString(id);
+    auto idHash = napa::utils::hash::XxHash64(idString);
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(idHash));
+    std::string name = std::string("napa-store-") + hash;
+
+    // Slots are a third more than entries, so probes stay short.
+    uint64_t shardCount = std::max<size_t>(options.shards, 1);
+    uint64_t bytes = options.maxBytes > 0 ? options.maxBytes : DEFAULT_BYTES;
+    auto heapSize = Align(std::max<uint64_t>(bytes / shardCount, 4096), BLOCK_ALIGNMENT);
+    auto maxEntries = options.maxEntries > 0 ?
+        (options.maxEntries + shardCount - 1) / shardCount : std::max<uint64_t>(heapSize / 256, 16);
+    auto slotCount = RoundUpToPowerOfTwo(maxEntries + maxEntries / 3 + 1);
+
+    auto shardsOffset = Align(sizeof(SegmentHeader), CACHE_LINE_SIZE);
+    auto shardStride = Align(sizeof(ShardHeader), CACHE_LINE_SIZE);
+    auto dataOffset = shardsOffset + shardCount * shardStride;
+    auto size = dataOffset + shardCount * (slotCount * sizeof(Slot) + heapSize);
+
+    // An opener may map a segment whose last store is detaching, then it retries with a new segment.
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        bool created = false;
+        auto segment = SharedSegment::Open(name, static_cast<size_t>(size), created);
+        if (segment == nullptr) {
+            return nullptr;
+        }
+
+        auto data = segment->GetData();
+        auto header = reinterpret_cast<SegmentHeader*>(data);
+        if (created) {
+            std::memcpy(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+            header->version = SEGMENT_VERSION;
+            header->transport = static_cast<uint32_t>(options.transport);
+            header->valueCache = static_cast<uint32_t>(options.valueCache);
+            header->shardCount = shardCount;
+            header->idHash = idHash;
+            header->shardsOffset = shardsOffset;
+            header->shardStride = shardStride;
+
+            // Versions go to JavaScript as numbers, so they stay below 2^53. They start above versions of local stores,
+            // from the creation time in microseconds, so a re-created segment doesn't repeat versions of an old one.
+            auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            header->nextVersion = (static_cast<uint64_t>(1) << 52) + (static_cast<uint64_t>(now) & ((static_cast<uint64_t>(1) << 51) - 1));
+
+            auto offset = dataOffset;
+            for (uint64_t i = 0; i < shardCount; ++i) {
+                auto& shard = *reinterpret_cast<ShardHeader*>(data + shardsOffset + i * shardStride);
+                shard.slotsOffset = offset;
+                shard.slotCount = slotCount;
+                offset += slotCount * sizeof(Slot);
+
+                shard.heapOffset = offset;
+                shard.heapSize = heapSize;
+                shard.freeList = offset;
+                shard.maxEntries = maxEntries;
+                auto block = reinterpret_cast<Block*>(data + offset);
+                block->size = heapSize;
+                block->next = 0;
+                offset += heapSize;
+            }
+        } else {
+            for (int i = 0; header->ready.load(std::memory_order_acquire) == 0; ++i) {
+                if (i == 1000) {
+                    return nullptr;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (std::memcmp(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0
+                || header->version != SEGMENT_VERSION
+                || header->idHash != idHash) {
+                return nullptr;
+            }
+        }
+
+        std::unique_ptr<SharedStore> store(new SharedStore(idString, name, std::move(segment), created));
+        if (created) {
+            header->ready.store(1, std::memory_order_release);
+        }
+
+        {
+            std::lock_guard<InterprocessMutex> lock(*store->_segmentLock);
+            if (header->removed != 0) {
+                continue;
+            }
+            ++header->attached;
+            store->_attached = true;
+        }
+
+        std::lock_guard<std::mutex> lock(GetAttachedStoresLock());
+        static auto registered = std::atexit(DetachAll) == 0;
+        (void)registered;
+        GetAttachedStores().insert(store.get());
+        return store;
+    }
+    return nullptr;
+}
+
+SharedStore::SharedStore(const std::string& id, const std::string& name, std::unique_ptr<SharedSegment> segment, bool created) :
+    _id(id),
+    _name(name),
+    _segment(std::move(segment)),
+    _header(reinterpret_cast<SegmentHeader*>(_segment->GetData())) {
+
+    _segmentLock = std::make_unique<InterprocessMutex>(_header->lock, _name + "-lock", created);
+    for (uint64_t i = 0; i < _header->shardCount; ++i) {
+        _shardLocks.emplace_back(std::make_unique<InterprocessMutex>(
+            GetShard(static_cast<size_t>(i)).lock, _name + "-shard-" + std::to_string(i), created));
+    }
+}
+
+SharedStore::~SharedStore() {
+    {
+        std::lock_guard<std::mutex> lock(GetAttachedStoresLock());
+        GetAttachedStores().erase(this);
+    }
+    Detach();
+}
+
+void SharedStore::Detach() {
+    if (!_attached) {
+        return;
+    }
+    _attached = false;
+
+    // The name is removed under the lock, so an opener attaches either before or to a new segment.
+    std::lock_guard<InterprocessMutex> lock(*_segmentLock);
+    if (--_header->attached == 0) {
+        _header->removed = 1;
+        SharedSegment::Remove(_name);
+    }
+}
+
+void SharedStore::DetachAll() {
+    // Segments stay mapped until exit, so stores can still be used by threads that haven't stopped yet.
+    std::lock_guard<std::mutex> lock(GetAttachedStoresLock());
+    for (auto store : GetAttachedStores()) {
+        store->Detach();
+    }
+}
+
+const char* SharedStore::GetId() const {
+    return _id.c_str();
+}
+
+napa::TransportOption SharedStore::GetTransportOption() const {
+    return static_cast<napa::TransportOption>(_header->transport);
+}
+
+size_t SharedStore::GetShardCount() const {
+    return static_cast<size_t>(_header->shardCount);
+}
+
+bool SharedStore::IsReadOptimized() const {
+    return false;
+}
+
+ValueCacheOption SharedStore::GetValueCacheOption() const {
+    return static_cast<ValueCacheOption>(_header->valueCache);
+}
+
+bool SharedStore::CanStore(const char* key, const ValueType& value, std::string& error) const {
+    if (value.transportContext.GetSharedCount() > 0) {
+        error = "Values holding shared objects, e.g. allocators or SharedArrayBuffers, can't be set in a store shared by processes.";
+        return false;
+    }
+    auto keyLength = std::strlen(key);
+    if (!FitsInShard(GetShard(0), keyLength, value.GetByteLength())) {
+        error = "Value of " + std::to_string(value.GetByteLength()) + " bytes with a key of " + std::to_string(keyLength)
+            + " bytes exceeds the memory of a shard.";
+        return false;
+    }
+    return true;
+}
+
+void SharedStore::Set(const char* key, std::shared_ptr<ValueType> value) {
+    std::string keyString(key);
+    auto hash = napa::utils::hash::XxHash64(keyString);
+    auto shardIndex = GetShardIndex(keyString, GetShardCount());
+
+    std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+    value->version = NextVersion();
+    Put(GetShard(shardIndex), keyString, hash, *value);
+}
+
+std::shared_ptr<SharedStore::ValueType> SharedStore::Get(const char* key) const {
+    std::string keyString(key);
+    auto hash = napa::utils::hash::XxHash64(keyString);
+    auto shardIndex = GetShardIndex(keyString, GetShardCount());
+    auto& shard = GetShard(shardIndex);
+
+    std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+    auto position = Find(shard, keyString, hash);
+    if (position == NOT_FOUND) {
+        return nullptr;
+    }
+    auto& slot = GetSlots(shard)[position];
+    slot.referenced = 1;
+    return Load(slot);
+}
+
+bool SharedStore::Has(const char* key) const {
+    std::string keyString(key);
+    auto hash = napa::utils::hash::XxHash64(keyString);
+    auto shardIndex = GetShardIndex(keyString, GetShardCount());
+
+    std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+    return Find(GetShard(shardIndex), keyString, hash) != NOT_FOUND;
+}
+
+bool SharedStore::CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) {
+    std::string keyString(key);
+    auto hash = napa::utils::hash::XxHash64(keyString);
+    auto shardIndex = GetShardIndex(keyString, GetShardCount());
+    auto& shard = GetShard(shardIndex);
+
+    std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+    auto position = Find(shard, keyString, hash);
+    if ((position != NOT_FOUND ? GetSlots(shard)[position].version : 0) != expectedVersion) {
+        return false;
+    }
+    value->version = NextVersion();
+    return Put(shard, keyString, hash, *value);
+}
+
+std::shared_ptr<SharedStore::ValueType> SharedStore::GetOrSet(const char* key, std::shared_ptr<ValueType> value) {
+    std::string keyString(key);
+    auto hash = napa::utils::hash::XxHash64(keyString);
+    auto shardIndex = GetShardIndex(keyString, GetShardCount());
+    auto& shard = GetShard(shardIndex);
+
+    std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+    auto position = Find(shard, keyString, hash);
+    if (position != NOT_FOUND) {
+        auto& slot = GetSlots(shard)[position];
+        slot.referenced = 1;
+        return Load(slot);
+    }
+    value->version = NextVersion();
+    Put(shard, keyString, hash, *value);
+    return value;
+}
+
+bool SharedStore::Increment(const char* key, int64_t delta, int64_t& result) {
+    std::string keyString(key);
+    auto hash = napa::utils::hash::XxHash64(keyString);
+    auto shardIndex = GetShardIndex(keyString, GetShardCount());
+    auto& shard = GetShard(shardIndex);
+
+    std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+    auto position = Find(shard, keyString, hash);
+    auto current = position != NOT_FOUND ? Load(GetSlots(shard)[position]) : nullptr;
+    auto value = IncrementValue(current.get(), delta, result);
+    if (value == nullptr) {
+        return false;
+    }
+    value->version = NextVersion();
+    return Put(shard, keyString, hash, *value);
+}
+
+std::vector<std::shared_ptr<SharedStore::ValueType>> SharedStore::GetMany(const std::vector<std::string>& keys) const {
+    std::vector<std::shared_ptr<ValueType>> values(keys.size());
+    auto groups = GroupByShard(keys, GetShardCount());
+    for (size_t i = 0; i < groups.size(); ) {
+        auto shardIndex = groups[i].first;
+        auto& shard = GetShard(shardIndex);
+
+        std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+        for (; i < groups.size() && groups[i].first == shardIndex; ++i) {
+            auto& key = keys[groups[i].second];
+            auto position = Find(shard, key, napa::utils::hash::XxHash64(key));
+            if (position != NOT_FOUND) {
+                auto& slot = GetSlots(shard)[position];
+                slot.referenced = 1;
+                values[groups[i].second] = Load(slot);
+            }
+        }
+    }
+    return values;
+}
+
+void SharedStore::SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) {
+    auto groups = GroupByShard(keys, GetShardCount());
+    for (size_t i = 0; i < groups.size(); ) {
+        auto shardIndex = groups[i].first;
+        auto& shard = GetShard(shardIndex);
+
+        std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+        for (; i < groups.size() && groups[i].first == shardIndex; ++i) {
+            auto position = groups[i].second;
+            values[position]->version = NextVersion();
+            Put(shard, keys[position], napa::utils::hash::XxHash64(keys[position]), *values[position]);
+        }
+    }
+}
+
+std::vector<SharedStore::KeyValue> SharedStore::Scan(const char* prefix, size_t limit) const {
+    std::string prefixString(prefix);
+
+    std::vector<KeyValue> entries;
+    for (size_t shardIndex = 0; shardIndex < GetShardCount(); ++shardIndex) {
+        auto& shard = GetShard(shardIndex);
+        auto slots = GetSlots(shard);
+
+        std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+        for (uint64_t i = 0; i < shard.slotCount; ++i) {
+            if (slots[i].block == 0) {
+                continue;
+            }
+            auto key = GetKey(slots[i]);
+            if (key.compare(0, prefixString.size(), prefixString) == 0) {
+                entries.emplace_back(std::move(key), Load(slots[i]));
+            }
+        }
+    }
+    SortScan(entries, limit);
+    return entries;
+}
+
+void SharedStore::Watch(std::shared_ptr<StoreWatcher> watcher) {
+    _watchers.Add(std::move(watcher));
+}
+
+void SharedStore::Delete(const char* key) {
+    std::string keyString(key);
+    auto hash = napa::utils::hash::XxHash64(keyString);
+    auto shardIndex = GetShardIndex(keyString, GetShardCount());
+    auto& shard = GetShard(shardIndex);
+
+    std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+    auto position = Find(shard, keyString, hash);
+    if (position != NOT_FOUND) {
+        Erase(shard, position);
+        _watchers.Notify(keyString);
+    }
+}
+
+size_t SharedStore::Size() const {
+    size_t size = 0;
+    for (size_t shardIndex = 0; shardIndex < GetShardCount(); ++shardIndex) {
+        std::lock_guard<InterprocessMutex> lock(GetLock(shardIndex));
+        size += static_cast<size_t>(GetShard(shardIndex).entries);
+    }
+    return size;
+}
+
+SharedStore::ShardHeader& SharedStore::GetShard(size_t shardIndex) const {
+    return *reinterpret_cast<ShardHeader*>(_segment->GetData() + _header->shardsOffset + shardIndex * _header->shardStride);
+}
+
+InterprocessMutex& SharedStore::GetLock(size_t shardIndex) const {
+    return *_shardLocks[shardIndex];
+}
+
+SharedStore::Slot* SharedStore::GetSlots(const ShardHeader& shard) const {
+    return reinterpret_cast<Slot*>(_segment->GetData() + shard.slotsOffset);
+}
+
+std::string SharedStore::GetKey(const Slot& slot) const {
+    return std::string(_segment->GetData() + slot.block + sizeof(Block), slot.keyLength);
+}
+
+uint64_t SharedStore::Find(const ShardHeader& shard, const std::string& key, uint64_t hash) const {
+    auto slots = GetSlots(shard);
+    auto mask = shard.slotCount - 1;
+
+    // Low bits of the hash pick the shard, the slot is picked by others.
+    for (auto i = (hash >> 8) & mask; slots[i].block != 0; i = (i + 1) & mask) {
+        auto& slot = slots[i];
+        if (slot.hash == hash
+            && slot.keyLength == key.size()
+            && std::memcmp(_segment->GetData() + slot.block + sizeof(Block), key.data(), key.size()) == 0) {
+            return i;
+        }
+    }
+    return NOT_FOUND;
+}
+
+std::shared_ptr<SharedStore::ValueType> SharedStore::Load(const Slot& slot) const {
+    auto value = std::make_shared<ValueType>();
+    value->kind = static_cast<ValueKind>(slot.kind);
+    value->binary = slot.binary != 0;
+    value->version = slot.version;
+
+    auto payload = _segment->GetData() + slot.block + sizeof(Block) + slot.keyLength;
+    auto length = static_cast<size_t>(slot.payloadLength);
+    switch (value->kind) {
+        case ValueKind::BOOLEAN:
+            value->boolean = slot.scalar != 0;
+            break;
+        case ValueKind::NUMBER:
+            std::memcpy(&value->number, &slot.scalar, sizeof(double));
+            break;
+        case ValueKind::INTEGER:
+            std::memcpy(&value->integer, &slot.scalar, sizeof(int64_t));
+            break;
+        case ValueKind::ARRAY_BUFFER:
+            if (length > 0) {
+                auto data = std::malloc(length);
+                std::memcpy(data, payload, length);
+                value->buffer = napa::memory::AdoptSharedMemory(data, length);
+            }
+            break;
+        default:
+            value->payload.assign(payload, length);
+            break;
+    }
+    return value;
+}
+
+bool SharedStore::FitsInShard(const ShardHeader& shard, uint64_t keyLength, uint64_t payloadLength) {
+    // Blocks are allocated with their header and alignment, see Allocate().
+    return Align(sizeof(Block) + keyLength + payloadLength, BLOCK_ALIGNMENT) <= shard.heapSize;
+}
+
+bool SharedStore::Put(ShardHeader& shard, const std::string& key, uint64_t hash, const ValueType& value) {
+    uint64_t length;
+    auto payload = GetPayload(value, length);
+
+    // A value that can't fit even in an empty heap leaves the old value and other keys in place.
+    if (!FitsInShard(shard, key.size(), length)) {
+        return false;
+    }
+
+    // The old value is freed first, so its memory can hold the new one.
+    auto position = Find(shard, key, hash);
+    if (position != NOT_FOUND) {
+        Erase(shard, position);
+    }
+
+    while (shard.entries >= shard.maxEntries) {
+        EvictOne(shard);
+    }
+    uint64_t block;
+    while ((block = Allocate(shard, sizeof(Block) + key.size() + length)) == 0) {
+        if (shard.entries == 0) {
+            _watchers.Notify(key);
+            return false;
+        }
+        EvictOne(shard);
+    }
+
+    auto data = _segment->GetData() + block + sizeof(Block);
+    std::memcpy(data, key.data(), key.size());
+    if (length > 0) {
+        std::memcpy(data + key.size(), payload, static_cast<size_t>(length));
+    }
+
+    // Evictions above may have shifted slots, so the free slot is found after them.
+    auto slots = GetSlots(shard);
+    auto mask = shard.slotCount - 1;
+    auto i = (hash >> 8) & mask;
+    while (slots[i].block != 0) {
+        i = (i + 1) & mask;
+    }
+
+    auto& slot = slots[i];
+    slot.hash = hash;
+    slot.block = block;
+    slot.payloadLength = length;
+    slot.scalar = 0;
+    if (value.kind == ValueKind::BOOLEAN) {
+        slot.scalar = value.boolean ? 1 : 0;
+    } else if (value.kind == ValueKind::NUMBER) {
+        std::memcpy(&slot.scalar, &value.number, sizeof(double));
+    } else if (value.kind == ValueKind::INTEGER) {
+        std::memcpy(&slot.scalar, &value.integer, sizeof(int64_t));
+    }
+    slot.version = value.version;
+    slot.kind = static_cast<uint32_t>(value.kind);
+    slot.keyLength = static_cast<uint32_t>(key.size());
+    slot.binary = value.binary ? 1 : 0;
+    slot.referenced = 0;
+    ++shard.entries;
+
+    _watchers.Notify(key);
+    return true;
+}
+
+void SharedStore::Erase(ShardHeader& shard, uint64_t position) {
+    auto slots = GetSlots(shard);
+    auto mask = shard.slotCount - 1;
+    Free(shard, slots[position].block);
+
+    // A later slot moves into the hole unless its home lies cyclically within (hole, slot], then probes still reach it.
+    auto hole = position;
+    for (auto i = (hole + 1) & mask; slots[i].block != 0; i = (i + 1) & mask) {
+        auto home = (slots[i].hash >> 8) & mask;
+        auto reachable = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!reachable) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole] = Slot();
+    --shard.entries;
+}
+
+void SharedStore::EvictOne(ShardHeader& shard) {
+    // Each pass of the hand clears the referenced bits it meets, so a key is evicted within two passes.
+    auto slots = GetSlots(shard);
+    for (;;) {
+        auto position = shard.hand++ & (shard.slotCount - 1);
+        auto& slot = slots[position];
+        if (slot.block == 0) {
+            continue;
+        }
+        if (slot.referenced != 0) {
+            slot.referenced = 0;
+            continue;
+        }
+        _watchers.Notify(GetKey(slot));
+        Erase(shard, position);
+        return;
+    }
+}
+
+uint64_t SharedStore::Allocate(ShardHeader& shard, uint64_t bytes) {
+    auto data = _segment->GetData();
+    auto size = Align(bytes, BLOCK_ALIGNMENT);
+
+    // First fit, a large free block gives its tail, so the free list doesn't change.
+    for (auto link = &shard.freeList; *link != 0; link = &reinterpret_cast<Block*>(data + *link)->next) {
+        auto block = reinterpret_cast<Block*>(data + *link);
+        if (block->size < size) {
+            continue;
+        }
+        if (block->size - size >= MIN_SPLIT_SIZE) {
+            block->size -= size;
+            auto offset = *link + block->size;
+            reinterpret_cast<Block*>(data + offset)->size = size;
+            return offset;
+        }
+        auto offset = *link;
+        *link = block->next;
+        return offset;
+    }
+    return 0;
+}
+
+void SharedStore::Free(ShardHeader& shard, uint64_t offset) {
+    auto data = _segment->GetData();
+    auto blockAt = [data](uint64_t blockOffset) {
+        return reinterpret_cast<Block*>(data + blockOffset);
+    };
+
+    // Free blocks are kept in ascending order, so adjacent ones are merged.
+    uint64_t previous = 0;
+    auto next = shard.freeList;
+    while (next != 0 && next < offset) {
+        previous = next;
+        next = blockAt(next)->next;
+    }
+
+    auto block = blockAt(offset);
+    block->next = next;
+    if (next != 0 && offset + block->size == next) {
+        block->size += blockAt(next)->size;
+        block->next = blockAt(next)->next;
+    }
+    if (previous == 0) {
+        shard.freeList = offset;
+    } else if (previous + blockAt(previous)->size == offset) {
+        blockAt(previous)->size += block->size;
+        blockAt(previous)->next = block->next;
+    } else {
+        blockAt(previous)->next = offset;
+    }
+}
+
+uint64_t SharedStore::NextVersion() {
+    return _header->nextVersion.fetch_add(1);
+}
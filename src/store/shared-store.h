@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "store.h"
+
+#include <platform/shared-segment.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace store {
+
+    /// <summary> Store whose keys and values live in a named shared memory segment, shared by all processes of the host. </summary>
+    /// <remarks>
+    ///     Each shard has a hash table with linear probing, a heap of key and payload blocks, and a robust process-shared
+    ///     mutex, within the segment. Memory is fixed on creation by the maxBytes and maxEntries options, and sets beyond
+    ///     it evict the least recently used keys of their shard by CLOCK. Reads copy the value out of the segment.
+    ///     The segment is removed when the last process detaches from it, processes that die keep it alive until reboot.
+    /// </remarks>
+    class SharedStore : public Store {
+    public:
+        /// <summary> Memory of a store that isn't given maxBytes. </summary>
+        static constexpr size_t DEFAULT_BYTES = 64 * 1024 * 1024;
+
+        /// <summary> Attaches to the store of an id on this host, which is created with the options if it doesn't exist. </summary>
+        /// <returns> The store, or nullptr if its segment can't be created or mapped. </returns>
+        /// <remarks> An existing store keeps its own options. </remarks>
+        static std::unique_ptr<SharedStore> Open(const char* id, const StoreOptions& options);
+
+        /// <summary> Detaches from the segment, which is removed if no other process is attached. </summary>
+        ~SharedStore();
+
+        const char* GetId() const override;
+        napa::TransportOption GetTransportOption() const override;
+        size_t GetShardCount() const override;
+        bool IsReadOptimized() const override;
+        ValueCacheOption GetValueCacheOption() const override;
+        bool CanStore(const char* key, const ValueType& value, std::string& error) const override;
+        void Set(const char* key, std::shared_ptr<ValueType> value) override;
+        std::shared_ptr<ValueType> Get(const char* key) const override;
+        bool Has(const char* key) const override;
+        bool CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) override;
+        std::shared_ptr<ValueType> GetOrSet(const char* key, std::shared_ptr<ValueType> value) override;
+        bool Increment(const char* key, int64_t delta, int64_t& result) override;
+        std::vector<std::shared_ptr<ValueType>> GetMany(const std::vector<std::string>& keys) const override;
+        void SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) override;
+        std::vector<KeyValue> Scan(const char* prefix, size_t limit) const override;
+        void Watch(std::shared_ptr<StoreWatcher> watcher) override;
+        void Delete(const char* key) override;
+        size_t Size() const override;
+
+    private:
+        struct SegmentHeader;
+        struct ShardHeader;
+        struct Slot;
+
+        /// <summary> Position of a key that isn't in its shard. </summary>
+        static constexpr uint64_t NOT_FOUND = ~static_cast<uint64_t>(0);
+
+        SharedStore(const std::string& id, const std::string& name, std::unique_ptr<platform::SharedSegment> segment, bool created);
+
+        /// <summary> Detaches from the segment once, on destruction or process exit, whichever comes first. </summary>
+        /// <remarks> Stores held by JavaScript aren't destroyed on exit, which would keep their segments until reboot. </remarks>
+        void Detach();
+
+        /// <summary> Detaches all stores of this process, registered with std::atexit. </summary>
+        static void DetachAll();
+
+        /// <summary> Get header of a shard, and its lock which guards all below. </summary>
+        ShardHeader& GetShard(size_t shardIndex) const;
+        platform::InterprocessMutex& GetLock(size_t shardIndex) const;
+
+        /// <summary> Get slots of a shard. </summary>
+        Slot* GetSlots(const ShardHeader& shard) const;
+
+        /// <summary> Get the key of a used slot. </summary>
+        std::string GetKey(const Slot& slot) const;
+
+        /// <summary> Find the slot of a key in its shard. </summary>
+        /// <returns> Position of the slot, or NOT_FOUND. </returns>
+        uint64_t Find(const ShardHeader& shard, const std::string& key, uint64_t hash) const;
+
+        /// <summary> Copies the value of a used slot out of the segment. </summary>
+        std::shared_ptr<ValueType> Load(const Slot& slot) const;
+
+        /// <summary> Whether a key and payload fit in the heap of a shard once it's emptied. </summary>
+        static bool FitsInShard(const ShardHeader& shard, uint64_t keyLength, uint64_t payloadLength);
+
+        /// <summary> Replaces or inserts the value of a key, evicting other keys of the shard as needed. </summary>
+        /// <returns> False if the key and value don't fit in the shard, then the shard is left unchanged. </returns>
+        bool Put(ShardHeader& shard, const std::string& key, uint64_t hash, const ValueType& value);
+
+        /// <summary> Removes a used slot, shifting back the slots that probed past it. </summary>
+        void Erase(ShardHeader& shard, uint64_t position);
+
+        /// <summary> Removes the least recently used key of a shard by CLOCK. </summary>
+        void EvictOne(ShardHeader& shard);
+
+        /// <summary> Allocates a block in the heap of a shard. </summary>
+        /// <returns> Offset of the block from the start of the segment, or 0 if no free block is large enough. </returns>
+        uint64_t Allocate(ShardHeader& shard, uint64_t bytes);
+
+        /// <summary> Returns a block to the heap of a shard, merging it with adjacent free blocks. </summary>
+        void Free(ShardHeader& shard, uint64_t offset);
+
+        /// <summary> Get a new version, unique among processes sharing the segment. </summary>
+        uint64_t NextVersion();
+
+        /// <summary> ID. Case sensitive. </summary>
+        std::string _id;
+
+        /// <summary> Name of the segment, derived from the id. </summary>
+        std::string _name;
+
+        /// <summary> Mapped segment. </summary>
+        std::unique_ptr<platform::SharedSegment> _segment;
+
+        /// <summary> Header at the start of the segment. </summary>
+        SegmentHeader* _header;
+
+        /// <summary> Lock that guards attaching and detaching processes, and locks of shards. </summary>
+        std::unique_ptr<platform::InterprocessMutex> _segmentLock;
+        std::vector<std::unique_ptr<platform::InterprocessMutex>> _shardLocks;
+
+        /// <summary> Whether this store is counted among attached stores of the segment. </summary>
+        bool _attached = false;
+
+        /// <summary> Watchers of keys changed by this process. </summary>
+        StoreWatchers _watchers;
+    };
+}
+}
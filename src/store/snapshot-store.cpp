@@ -0,0 +1,308 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "snapshot-store.h"
+
+using namespace napa::store;
+
+namespace {
+
+    /// <summary> Serials are never reused, so a thread never mistakes the slot of a destroyed store for another one's. </summary>
+    std::atomic<uint64_t> _nextSerial { 0 };
+
+    /// <summary> Tracks the depth of a read, so a nested read leaves the outer read's snapshot in place. </summary>
+    class ReadScope {
+    public:
+        explicit ReadScope(size_t& depth) : _depth(depth) {
+            ++_depth;
+        }
+
+        ~ReadScope() {
+            --_depth;
+        }
+
+    private:
+        size_t& _depth;
+    };
+
+}   // End of anonymous namespace.
+
+SnapshotStore::SnapshotStore(const char* id, const StoreOptions& options) :
+    _id(id),
+    _options(options),
+    _shards(options.shards),
+    _serial(_nextSerial++) {
+}
+
+SnapshotStore::~SnapshotStore() = default;
+
+const char* SnapshotStore::GetId() const {
+    return _id.c_str();
+}
+
+napa::TransportOption SnapshotStore::GetTransportOption() const {
+    return _options.transport;
+}
+
+size_t SnapshotStore::GetShardCount() const {
+    return _shards.size();
+}
+
+bool SnapshotStore::IsReadOptimized() const {
+    return true;
+}
+
+ValueCacheOption SnapshotStore::GetValueCacheOption() const {
+    return _options.valueCache;
+}
+
+size_t SnapshotStore::GetCompressionThreshold() const {
+    return _options.compressAbove;
+}
+
+template <typename Func>
+bool SnapshotStore::Update(const std::string& key, Func update, std::shared_ptr<ValueType>* existing) {
+    auto& shard = _shards[GetShardIndex(key, _shards.size())];
+
+    // Released after the lock, it may be the last reference to the replaced values.
+    std::shared_ptr<const ValueMap> replaced;
+
+    // Writers of a shard are serialized, so no update is lost between copying and publishing. Readers aren't blocked.
+    std::lock_guard<std::mutex> lock(shard.writeAccess);
+    auto it = shard.snapshot->find(key);
+    auto current = it != shard.snapshot->end() ? it->second : nullptr;
+    if (existing != nullptr) {
+        *existing = current;
+    }
+
+    auto value = update(current.get());
+    if (value == nullptr) {
+        return false;
+    }
+
+    auto map = std::make_shared<ValueMap>(*shard.snapshot);
+    (*map)[key] = std::move(value);
+    Publish(shard, std::move(map), replaced);
+    _watchers.Notify(key);
+    return true;
+}
+
+void SnapshotStore::Publish(Shard& shard, std::shared_ptr<const ValueMap> map, std::shared_ptr<const ValueMap>& replaced) {
+    replaced = std::move(shard.snapshot);
+    shard.snapshot = std::move(map);
+    shard.version.fetch_add(1, std::memory_order_release);
+}
+
+void SnapshotStore::Set(const char* key, std::shared_ptr<ValueType> value) {
+    value->version = NewValueVersion();
+    Update(key, [&value](const ValueType*) {
+        return std::move(value);
+    });
+}
+
+template <typename Visitor>
+void SnapshotStore::Visit(const char* key, Visitor visitor) const {
+    std::string keyString(key);
+    auto shardIndex = GetShardIndex(keyString, _shards.size());
+
+    auto& slot = GetReaderSlot();
+    auto map = GetSnapshot(slot, shardIndex);
+
+    // The snapshot that an outer read is using can't be replaced, a nested read holds the latest one instead.
+    std::shared_ptr<const ValueMap> nested;
+    if (map == nullptr) {
+        auto& shard = _shards[shardIndex];
+        std::lock_guard<std::mutex> lock(shard.writeAccess);
+        nested = shard.snapshot;
+        map = nested.get();
+    }
+
+    ReadScope scope(slot.depth);
+    auto it = map->find(keyString);
+    visitor(it != map->end() ? &it->second : nullptr);
+}
+
+std::shared_ptr<SnapshotStore::ValueType> SnapshotStore::Get(const char* key) const {
+    std::shared_ptr<ValueType> value;
+    Visit(key, [&value](const std::shared_ptr<ValueType>* found) {
+        if (found != nullptr) {
+            value = *found;
+        }
+    });
+    return value;
+}
+
+void SnapshotStore::Read(const char* key, const std::function<void(const ValueType*)>& reader) const {
+    Visit(key, [&reader](const std::shared_ptr<ValueType>* found) {
+        reader(found != nullptr ? found->get() : nullptr);
+    });
+}
+
+bool SnapshotStore::Has(const char* key) const {
+    auto has = false;
+    Visit(key, [&has](const std::shared_ptr<ValueType>* found) {
+        has = found != nullptr;
+    });
+    return has;
+}
+
+void SnapshotStore::Delete(const char* key) {
+    auto& shard = _shards[GetShardIndex(key, _shards.size())];
+    std::shared_ptr<const ValueMap> replaced;
+
+    std::lock_guard<std::mutex> lock(shard.writeAccess);
+    if (shard.snapshot->find(key) == shard.snapshot->end()) {
+        return;
+    }
+
+    auto map = std::make_shared<ValueMap>(*shard.snapshot);
+    map->erase(key);
+    Publish(shard, std::move(map), replaced);
+    _watchers.Notify(key);
+}
+
+void SnapshotStore::Watch(std::shared_ptr<StoreWatcher> watcher) {
+    _watchers.Add(std::move(watcher));
+}
+
+size_t SnapshotStore::Size() const {
+    size_t size = 0;
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard.writeAccess);
+        size += shard.snapshot->size();
+    }
+    return size;
+}
+
+SnapshotStore::ReaderSlot& SnapshotStore::GetReaderSlot() const {
+    // Entries of destroyed stores are left behind, their serials never come back.
+    static thread_local std::unordered_map<uint64_t, ReaderSlot*> slots;
+
+    auto it = slots.find(_serial);
+    if (it != slots.end()) {
+        return *it->second;
+    }
+
+    auto slot = std::make_unique<ReaderSlot>();
+    slot->snapshots.resize(_shards.size());
+
+    auto result = slot.get();
+    {
+        std::lock_guard<std::mutex> lock(_readerSlotsAccess);
+        _readerSlots.emplace_back(std::move(slot));
+    }
+    slots.emplace(_serial, result);
+    return *result;
+}
+
+const SnapshotStore::ValueMap* SnapshotStore::GetSnapshot(ReaderSlot& slot, size_t shardIndex) const {
+    auto& shard = _shards[shardIndex];
+    auto& cached = slot.snapshots[shardIndex];
+
+    // Only this load touches a shared cache line, which is written by writers only.
+    if (cached.second != nullptr && cached.first == shard.version.load(std::memory_order_acquire)) {
+        return cached.second.get();
+    }
+    if (slot.depth > 0) {
+        return nullptr;
+    }
+
+    // Released after the lock, it may be the last reference to a replaced snapshot.
+    auto stale = std::move(cached.second);
+
+    std::lock_guard<std::mutex> lock(shard.writeAccess);
+    cached.first = shard.version.load(std::memory_order_relaxed);
+    cached.second = shard.snapshot;
+    return cached.second.get();
+}
+
+bool SnapshotStore::CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) {
+    return Update(key, [&](const ValueType* current) -> std::shared_ptr<ValueType> {
+        if ((current != nullptr ? current->version : 0) != expectedVersion) {
+            return nullptr;
+        }
+        value->version = NewValueVersion();
+        return std::move(value);
+    });
+}
+
+std::shared_ptr<SnapshotStore::ValueType> SnapshotStore::GetOrSet(const char* key, std::shared_ptr<ValueType> value) {
+    // The latest snapshot is checked under the write lock, the reader's may be behind.
+    std::shared_ptr<ValueType> existing;
+    Update(key, [&](const ValueType* current) -> std::shared_ptr<ValueType> {
+        if (current != nullptr) {
+            return nullptr;
+        }
+        value->version = NewValueVersion();
+        return value;
+    }, &existing);
+    return existing != nullptr ? existing : value;
+}
+
+bool SnapshotStore::Increment(const char* key, int64_t delta, int64_t& result) {
+    auto valid = true;
+    Update(key, [&](const ValueType* current) {
+        auto next = IncrementValue(current, delta, result);
+        valid = next != nullptr;
+        return next;
+    });
+    return valid;
+}
+
+std::vector<std::shared_ptr<SnapshotStore::ValueType>> SnapshotStore::GetMany(const std::vector<std::string>& keys) const {
+    // Reads don't lock, so each key is read from the snapshot of the calling thread.
+    std::vector<std::shared_ptr<ValueType>> values;
+    values.reserve(keys.size());
+    for (auto& key : keys) {
+        values.emplace_back(Get(key.c_str()));
+    }
+    return values;
+}
+
+void SnapshotStore::SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) {
+    for (auto& value : values) {
+        value->version = NewValueVersion();
+    }
+
+    // Each shard is copied and published once for all its keys.
+    auto groups = GroupByShard(keys, _shards.size());
+    for (size_t i = 0; i < groups.size(); ) {
+        auto& shard = _shards[groups[i].first];
+        std::shared_ptr<const ValueMap> replaced;
+
+        std::lock_guard<std::mutex> lock(shard.writeAccess);
+        auto map = std::make_shared<ValueMap>(*shard.snapshot);
+        auto begin = i;
+        for (auto shardIndex = groups[i].first; i < groups.size() && groups[i].first == shardIndex; ++i) {
+            auto position = groups[i].second;
+            (*map)[keys[position]] = std::move(values[position]);
+        }
+        Publish(shard, std::move(map), replaced);
+
+        // Readers of the new snapshot are notified after it's published.
+        for (auto j = begin; j < i; ++j) {
+            _watchers.Notify(keys[groups[j].second]);
+        }
+    }
+}
+
+std::vector<SnapshotStore::KeyValue> SnapshotStore::Scan(const char* prefix, size_t limit) const {
+    std::string prefixString(prefix);
+
+    std::vector<KeyValue> entries;
+    for (auto& shard : _shards) {
+        // The snapshot is immutable, so it's scanned after the lock.
+        std::shared_ptr<const ValueMap> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(shard.writeAccess);
+            snapshot = shard.snapshot;
+        }
+        for (auto& entry : *snapshot) {
+            if (entry.first.compare(0, prefixString.size(), prefixString) == 0) {
+                entries.emplace_back(entry);
+            }
+        }
+    }
+    SortScan(entries, limit);
+    return entries;
+}
@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "store.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace store {
+
+    /// <summary> Read optimized store, whose writes publish immutable snapshots of a shard. </summary>
+    /// <remarks>
+    ///     Each reading thread keeps the snapshot it last read from, and only refreshes it when the shard's version moved.
+    ///     Thus reads of an unchanged shard don't lock, nor touch a cache line that other threads write.
+    ///     An old snapshot is released once all threads having read from it have refreshed, or the store is destroyed.
+    ///     Writes copy the map of their shard, which makes them O(n / shards).
+    /// </remarks>
+    class SnapshotStore : public Store {
+    public:
+        /// <summary> Constructor. </summary>
+        SnapshotStore(const char* id, const StoreOptions& options);
+
+        /// <summary> Destructor. </summary>
+        ~SnapshotStore();
+
+        const char* GetId() const override;
+        napa::TransportOption GetTransportOption() const override;
+        size_t GetShardCount() const override;
+        bool IsReadOptimized() const override;
+        ValueCacheOption GetValueCacheOption() const override;
+        size_t GetCompressionThreshold() const override;
+        void Set(const char* key, std::shared_ptr<ValueType> value) override;
+        std::shared_ptr<ValueType> Get(const char* key) const override;
+        void Read(const char* key, const std::function<void(const ValueType*)>& reader) const override;
+        bool Has(const char* key) const override;
+        bool CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) override;
+        std::shared_ptr<ValueType> GetOrSet(const char* key, std::shared_ptr<ValueType> value) override;
+        bool Increment(const char* key, int64_t delta, int64_t& result) override;
+        std::vector<std::shared_ptr<ValueType>> GetMany(const std::vector<std::string>& keys) const override;
+        void SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) override;
+        std::vector<KeyValue> Scan(const char* prefix, size_t limit) const override;
+        void Watch(std::shared_ptr<StoreWatcher> watcher) override;
+        void Delete(const char* key) override;
+        size_t Size() const override;
+
+    private:
+        using ValueMap = std::unordered_map<std::string, std::shared_ptr<ValueType>>;
+
+        /// <summary> A partition of keys, whose map is replaced as a whole by each write. </summary>
+        struct Shard {
+            /// <summary> Latest snapshot, guarded by writeAccess. </summary>
+            std::shared_ptr<const ValueMap> snapshot = std::make_shared<ValueMap>();
+
+            /// <summary> Version of the latest snapshot, which readers poll without locking. </summary>
+            std::atomic<uint64_t> version { 0 };
+
+            /// <summary> Serializes writers, and readers that refresh their snapshot. </summary>
+            std::mutex writeAccess;
+        };
+
+        /// <summary> Snapshots that a thread reads from, only accessed by that thread. </summary>
+        struct ReaderSlot {
+            /// <summary> Snapshot and its version by shard. </summary>
+            std::vector<std::pair<uint64_t, std::shared_ptr<const ValueMap>>> snapshots;
+
+            /// <summary> Depth of reads in progress, a nested read can't replace a snapshot that an outer read is using. </summary>
+            size_t depth = 0;
+
+            /// <summary> Keeps slots of different threads off the same cache line. </summary>
+            char padding[64];
+        };
+
+        /// <summary> Visits the stored pointer of a key, or nullptr if not found, in the snapshot that the calling thread reads. </summary>
+        template <typename Visitor>
+        void Visit(const char* key, Visitor visitor) const;
+
+        /// <summary> Get the slot of the calling thread, which is created on its first read. </summary>
+        ReaderSlot& GetReaderSlot() const;
+
+        /// <summary> Get the map that the calling thread reads a shard from, refreshed if the shard has changed. </summary>
+        /// <returns> The map, or nullptr if it can't be refreshed during a nested read. </returns>
+        const ValueMap* GetSnapshot(ReaderSlot& slot, size_t shardIndex) const;
+
+        /// <summary> Replaces the snapshot of a shard by a copy with the value of a key updated. </summary>
+        /// <param name="update"> Computes the new value from the current one or nullptr, returns nullptr to leave the shard as is. </param>
+        /// <param name="existing"> Optionally receives the current value. </param>
+        /// <returns> True if the value is updated. </returns>
+        template <typename Func>
+        bool Update(const std::string& key, Func update, std::shared_ptr<ValueType>* existing = nullptr);
+
+        /// <summary> Publishes a new snapshot of a shard under its write lock, the replaced one is released after the lock. </summary>
+        static void Publish(Shard& shard, std::shared_ptr<const ValueMap> map, std::shared_ptr<const ValueMap>& replaced);
+
+        /// <summary> ID. Case sensitive. </summary>
+        std::string _id;
+
+        /// <summary> Options given on creation. </summary>
+        StoreOptions _options;
+
+        /// <summary> Shards of keys, which are fixed on creation. </summary>
+        mutable std::vector<Shard> _shards;
+
+        /// <summary> Watchers of changed keys. </summary>
+        StoreWatchers _watchers;
+
+        /// <summary> Unique serial of this store, which keys the reader slots of each thread. </summary>
+        uint64_t _serial;
+
+        /// <summary> Slots of all threads that have read from this store. </summary>
+        mutable std::vector<std::unique_ptr<ReaderSlot>> _readerSlots;
+        mutable std::mutex _readerSlotsAccess;
+    };
+}
+}
@@ -0,0 +1,248 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "store-image.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+using namespace napa::store;
+
+namespace {
+
+    /// <summary> Identifies a store image, followed by the format version. </summary>
+    constexpr char IMAGE_MAGIC[8] = { 'N', 'A', 'P', 'A', 'S', 'T', 'O', 'R' };
+    constexpr uint32_t IMAGE_VERSION = 1;
+
+    /// <summary> Header at the start of an image, followed by the store id. </summary>
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t transport;
+        uint64_t shards;
+        uint32_t readOptimized;
+        uint32_t valueCache;
+        uint64_t recordCount;
+        uint64_t recordsOffset;
+        uint64_t payloadsOffset;
+        uint64_t fileSize;
+        uint32_t idLength;
+
+        /// <summary> StoreOptions::compressAbove, 0 in images of versions that didn't compress. </summary>
+        uint32_t compressAbove;
+    };
+
+    /// <summary> Records are 8-byte aligned, so they can be read in place. </summary>
+    uint64_t Align(uint64_t offset) {
+        return (offset + 7) & ~static_cast<uint64_t>(7);
+    }
+
+    /// <summary> Bytes of the payload that is saved for a value. </summary>
+    const char* GetPayload(const Store::ValueType& value, uint64_t& length) {
+        if (value.kind == ValueKind::ARRAY_BUFFER) {
+            length = value.buffer != nullptr ? value.buffer->GetLength() : 0;
+            return value.buffer != nullptr ? static_cast<const char*>(value.buffer->GetData()) : nullptr;
+        }
+        length = value.payload.size();
+        return value.payload.data();
+    }
+
+}   // End of anonymous namespace.
+
+bool StoreImage::Save(const Store& store, const char* path, std::string& error) {
+    auto entries = store.Scan("", 0);
+    for (auto& entry : entries) {
+        if (entry.second->transportContext.GetSharedCount() > 0) {
+            error = "Value of key \"" + entry.first + "\" holds shared objects, which can't be saved.";
+            return false;
+        }
+    }
+
+    std::string id(store.GetId());
+
+    Header header = {};
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = IMAGE_VERSION;
+    header.transport = static_cast<uint32_t>(store.GetTransportOption());
+    header.shards = store.GetShardCount();
+    header.readOptimized = store.IsReadOptimized() ? 1 : 0;
+    header.valueCache = static_cast<uint32_t>(store.GetValueCacheOption());
+    header.compressAbove = static_cast<uint32_t>(std::min<size_t>(store.GetCompressionThreshold(), UINT32_MAX));
+    header.recordCount = entries.size();
+    header.idLength = static_cast<uint32_t>(id.size());
+    header.recordsOffset = Align(sizeof(Header) + id.size());
+
+    // Payloads follow all records, so opening an image reads only the records.
+    auto offset = header.recordsOffset;
+    for (auto& entry : entries) {
+        offset = Align(offset + sizeof(Record) + entry.first.size());
+    }
+    header.payloadsOffset = offset;
+    for (auto& entry : entries) {
+        uint64_t length;
+        GetPayload(*entry.second, length);
+        offset += length;
+    }
+    header.fileSize = offset;
+
+    // Written to a temporary file first, so a failed save never leaves a partial image at the path.
+    std::string temporaryPath = std::string(path) + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            error = "Failed to open \"" + temporaryPath + "\" for writing.";
+            return false;
+        }
+
+        const char padding[8] = {};
+        auto pad = [&file, &padding](uint64_t written) {
+            file.write(padding, static_cast<std::streamsize>(Align(written) - written));
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(id.data(), static_cast<std::streamsize>(id.size()));
+        pad(sizeof(Header) + id.size());
+
+        auto payloadOffset = header.payloadsOffset;
+        for (auto& entry : entries) {
+            auto& value = *entry.second;
+
+            Record record = {};
+            record.kind = static_cast<uint32_t>(value.kind);
+            record.keyLength = static_cast<uint32_t>(entry.first.size());
+            record.payloadOffset = payloadOffset;
+            GetPayload(value, record.payloadLength);
+            record.binary = value.binary ? 1 : 0;
+            record.compressed = value.compressed ? 1 : 0;
+            if (value.kind == ValueKind::BOOLEAN) {
+                record.scalar = value.boolean ? 1 : 0;
+            } else if (value.kind == ValueKind::NUMBER) {
+                std::memcpy(&record.scalar, &value.number, sizeof(double));
+            } else if (value.kind == ValueKind::INTEGER) {
+                std::memcpy(&record.scalar, &value.integer, sizeof(int64_t));
+            }
+            payloadOffset += record.payloadLength;
+
+            file.write(reinterpret_cast<const char*>(&record), sizeof(Record));
+            file.write(entry.first.data(), static_cast<std::streamsize>(entry.first.size()));
+            pad(sizeof(Record) + entry.first.size());
+        }
+
+        for (auto& entry : entries) {
+            uint64_t length;
+            auto payload = GetPayload(*entry.second, length);
+            file.write(payload, static_cast<std::streamsize>(length));
+        }
+
+        if (!file.flush()) {
+            error = "Failed to write \"" + temporaryPath + "\".";
+            return false;
+        }
+    }
+
+    std::remove(path);
+    if (std::rename(temporaryPath.c_str(), path) != 0) {
+        std::remove(temporaryPath.c_str());
+        error = "Failed to move the image to \"" + std::string(path) + "\".";
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<StoreImage> StoreImage::Open(const char* path, std::string& error) {
+    auto file = platform::MappedFile::Open(path);
+    if (file == nullptr) {
+        error = "Failed to map \"" + std::string(path) + "\".";
+        return nullptr;
+    }
+
+    auto data = file->GetData();
+    auto size = file->GetSize();
+
+    Header header;
+    if (size < sizeof(Header)) {
+        error = "\"" + std::string(path) + "\" is not a store image.";
+        return nullptr;
+    }
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0) {
+        error = "\"" + std::string(path) + "\" is not a store image.";
+        return nullptr;
+    }
+    if (header.version != IMAGE_VERSION) {
+        error = "Store image \"" + std::string(path) + "\" has unsupported version " + std::to_string(header.version) + ".";
+        return nullptr;
+    }
+    if (header.fileSize != size || header.shards == 0 || sizeof(Header) + header.idLength > header.recordsOffset || header.payloadsOffset > size) {
+        error = "Store image \"" + std::string(path) + "\" is truncated or corrupted.";
+        return nullptr;
+    }
+
+    auto image = std::make_shared<StoreImage>();
+    image->_id.assign(data + sizeof(Header), header.idLength);
+    image->_options.transport = static_cast<napa::TransportOption>(header.transport);
+    image->_options.shards = static_cast<size_t>(header.shards);
+    image->_options.readOptimized = header.readOptimized != 0;
+    image->_options.valueCache = static_cast<ValueCacheOption>(header.valueCache);
+    image->_options.compressAbove = header.compressAbove;
+
+    // Records are validated once here, so values can be materialized without checks.
+    image->_records.reserve(static_cast<size_t>(header.recordCount));
+    auto offset = header.recordsOffset;
+    for (uint64_t i = 0; i < header.recordCount; ++i) {
+        if (offset + sizeof(Record) > header.payloadsOffset) {
+            error = "Store image \"" + std::string(path) + "\" is truncated or corrupted.";
+            return nullptr;
+        }
+        auto record = reinterpret_cast<const Record*>(data + offset);
+        offset = Align(offset + sizeof(Record) + record->keyLength);
+        if (offset > header.payloadsOffset
+            || record->kind > static_cast<uint32_t>(ValueKind::ARRAY_BUFFER)
+            || record->payloadOffset < header.payloadsOffset
+            || record->payloadLength > size - record->payloadOffset) {
+            error = "Store image \"" + std::string(path) + "\" is truncated or corrupted.";
+            return nullptr;
+        }
+        image->_records.push_back(record);
+    }
+
+    image->_file = std::move(file);
+    return image;
+}
+
+std::shared_ptr<Store::ValueType> StoreImage::Materialize(const Record& record) const {
+    auto value = std::make_shared<Store::ValueType>();
+    value->kind = static_cast<ValueKind>(record.kind);
+    value->binary = record.binary != 0;
+    value->compressed = record.compressed != 0;
+    value->version = NewValueVersion();
+
+    auto payload = _file->GetData() + record.payloadOffset;
+    auto length = static_cast<size_t>(record.payloadLength);
+    switch (value->kind) {
+        case ValueKind::BOOLEAN:
+            value->boolean = record.scalar != 0;
+            break;
+        case ValueKind::NUMBER:
+            std::memcpy(&value->number, &record.scalar, sizeof(double));
+            break;
+        case ValueKind::INTEGER:
+            std::memcpy(&value->integer, &record.scalar, sizeof(int64_t));
+            break;
+        case ValueKind::ARRAY_BUFFER:
+            if (length > 0) {
+                auto data = std::malloc(length);
+                std::memcpy(data, payload, length);
+                value->buffer = napa::memory::AdoptSharedMemory(data, length);
+            }
+            break;
+        default:
+            value->payload.assign(payload, length);
+            break;
+    }
+    return value;
+}
@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "store.h"
+
+#include <platform/mapped-file.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace store {
+
+    /// <summary> Read-only image of a store saved to a file, which is mapped into memory. Internal to store implementations. </summary>
+    /// <remarks>
+    ///     The file has a header, then a record with the key of each value, in ascending order of keys, then payloads.
+    ///     Records of all keys are read on open, while pages of payloads are read when their values are materialized.
+    ///     Integers are in native byte order, and binary payloads are in the V8 serializer format of the writing process,
+    ///     so an image is meant to be loaded by the same build on the same architecture.
+    /// </remarks>
+    class StoreImage {
+    public:
+        /// <summary> Fixed size part of a record, followed by the key. </summary>
+        struct Record {
+            /// <summary> ValueKind of the value. </summary>
+            uint32_t kind;
+
+            /// <summary> Bytes of the key that follows. </summary>
+            uint32_t keyLength;
+
+            /// <summary> Offset of the payload from the start of the file. </summary>
+            uint64_t payloadOffset;
+
+            /// <summary> Bytes of the payload, which is the ArrayBuffer contents of an ARRAY_BUFFER. </summary>
+            uint64_t payloadLength;
+
+            /// <summary> Bits of a BOOLEAN, NUMBER or INTEGER. </summary>
+            uint64_t scalar;
+
+            /// <summary> Whether the payload is in binary transport format. </summary>
+            uint32_t binary;
+
+            /// <summary> Whether the payload is compressed, 0 in images of versions that didn't compress. </summary>
+            uint32_t compressed;
+
+            /// <summary> Get the key, which follows the record. </summary>
+            std::string GetKey() const {
+                return std::string(reinterpret_cast<const char*>(this + 1), keyLength);
+            }
+        };
+
+        /// <summary> Writes the values of a store to a file. </summary>
+        /// <returns> True on success, otherwise false with error set. </returns>
+        /// <remarks> Values holding shared objects, e.g. allocators or SharedArrayBuffers, can't be saved. </remarks>
+        static bool Save(const Store& store, const char* path, std::string& error);
+
+        /// <summary> Maps an image and reads its records. </summary>
+        /// <returns> The image, or nullptr with error set if the file can't be mapped or isn't a valid image. </returns>
+        static std::shared_ptr<StoreImage> Open(const char* path, std::string& error);
+
+        /// <summary> Get ID of the saved store. </summary>
+        const std::string& GetId() const {
+            return _id;
+        }
+
+        /// <summary> Get options of the saved store. </summary>
+        const StoreOptions& GetOptions() const {
+            return _options;
+        }
+
+        /// <summary> Get records in ascending order of keys. </summary>
+        const std::vector<const Record*>& GetRecords() const {
+            return _records;
+        }
+
+        /// <summary> Creates the value of a record, copying its payload out of the mapped file. </summary>
+        std::shared_ptr<Store::ValueType> Materialize(const Record& record) const;
+
+    private:
+        std::unique_ptr<platform::MappedFile> _file;
+        std::string _id;
+        StoreOptions _options;
+        std::vector<const Record*> _records;
+    };
+}
+}
@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "store-watcher.h"
+
+#include <napa/assert.h>
+
+#include <algorithm>
+
+using namespace napa::store;
+
+StoreWatcher::StoreWatcher(const std::string& pattern) :
+    _key(pattern), _prefix(false), _closed(false) {
+
+    if (!_key.empty() && _key.back() == '*') {
+        _key.pop_back();
+        _prefix = true;
+    }
+}
+
+bool StoreWatcher::Matches(const std::string& key) const {
+    return _prefix ? key.compare(0, _key.size(), _key) == 0 : key == _key;
+}
+
+void StoreWatcher::Notify(const std::string& key) {
+    WaitCallback wait;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_closed || !_pendingKeys.insert(key).second) {
+            return;
+        }
+        _pending.emplace_back(key);
+
+        wait = std::move(_pendingWait);
+        _pendingWait = nullptr;
+    }
+
+    if (wait != nullptr) {
+        wait();
+    }
+}
+
+void StoreWatcher::Wait(WaitCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        NAPA_ASSERT(_pendingWait == nullptr, "There can be only one pending wait on a store watcher");
+        if (!_closed && _pending.empty()) {
+            _pendingWait = std::move(callback);
+            return;
+        }
+    }
+
+    callback();
+}
+
+std::vector<std::string> StoreWatcher::Take() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _pendingKeys.clear();
+    return std::move(_pending);
+}
+
+void StoreWatcher::Close() {
+    WaitCallback wait;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_closed) {
+            return;
+        }
+        _closed = true;
+        _pending.clear();
+        _pendingKeys.clear();
+
+        wait = std::move(_pendingWait);
+        _pendingWait = nullptr;
+    }
+
+    if (wait != nullptr) {
+        wait();
+    }
+}
+
+bool StoreWatcher::IsClosed() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _closed;
+}
+
+void StoreWatchers::Add(std::shared_ptr<StoreWatcher> watcher) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _watchers.emplace_back(std::move(watcher));
+    _count.store(_watchers.size(), std::memory_order_release);
+}
+
+void StoreWatchers::Notify(const std::string& key) {
+    if (_count.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+
+    // Closed watchers are dropped by the next change, nobody waits on them anymore.
+    _watchers.erase(
+        std::remove_if(_watchers.begin(), _watchers.end(), [](const std::shared_ptr<StoreWatcher>& watcher) {
+            return watcher->IsClosed();
+        }),
+        _watchers.end());
+    _count.store(_watchers.size(), std::memory_order_release);
+
+    for (auto& watcher : _watchers) {
+        if (watcher->Matches(key)) {
+            watcher->Notify(key);
+        }
+    }
+}
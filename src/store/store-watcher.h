@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace napa {
+namespace store {
+
+    /// <summary> Collects changed keys of a store that match a pattern, for one reader to take in batches. </summary>
+    /// <remarks>
+    ///     Keys changed again before they are taken are kept once, so a burst of updates to a key makes a single change.
+    ///     Stores notify from their writing threads, and a wait completes through a callback that is called from
+    ///     the notifying thread, or inline if keys are pending.
+    ///     It's exposed in napa.dll, so Node and Napa isolates can watch the same stores.
+    /// </remarks>
+    class NAPA_API StoreWatcher {
+    public:
+        /// <summary> Callback of a wait, once keys are pending or the watcher is closed. </summary>
+        typedef std::function<void()> WaitCallback;
+
+        /// <summary> Constructor. </summary>
+        /// <param name="pattern"> A key, or a prefix followed by '*'. A single '*' matches all keys. </param>
+        explicit StoreWatcher(const std::string& pattern);
+
+        /// <summary> Non-copyable. </summary>
+        StoreWatcher(const StoreWatcher&) = delete;
+        StoreWatcher& operator=(const StoreWatcher&) = delete;
+
+        /// <summary> Whether a key matches the pattern. </summary>
+        bool Matches(const std::string& key) const;
+
+        /// <summary> Adds a changed key, and completes a pending wait. No-op if closed. </summary>
+        void Notify(const std::string& key);
+
+        /// <summary> Calls back once keys are pending, or the watcher is closed. There can be only one pending wait. </summary>
+        void Wait(WaitCallback callback);
+
+        /// <summary> Takes pending keys, in the order they first changed. </summary>
+        std::vector<std::string> Take();
+
+        /// <summary> Stops watching, pending keys are dropped and a pending wait completes. </summary>
+        void Close();
+
+        /// <summary> Whether the watcher is closed. </summary>
+        bool IsClosed() const;
+
+    private:
+        std::string _key;
+        bool _prefix;
+        std::vector<std::string> _pending;
+        std::unordered_set<std::string> _pendingKeys;
+        WaitCallback _pendingWait;
+        bool _closed;
+        mutable std::mutex _lock;
+    };
+
+    /// <summary> Watchers of a store. Internal to store implementations. </summary>
+    class StoreWatchers {
+    public:
+        /// <summary> Adds a watcher, which is removed once closed. </summary>
+        void Add(std::shared_ptr<StoreWatcher> watcher);
+
+        /// <summary> Notifies watchers matching a changed key. </summary>
+        /// <remarks> Writes of a store without watchers only load an atomic count. </remarks>
+        void Notify(const std::string& key);
+
+    private:
+        std::vector<std::shared_ptr<StoreWatcher>> _watchers;
+        std::atomic<size_t> _count { 0 };
+        std::mutex _lock;
+    };
+}
+}
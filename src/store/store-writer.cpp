@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "store-writer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace napa::store;
+
+namespace {
+
+    /// <summary> Capacity of the first allocation, which doubles as chunks are appended. </summary>
+    constexpr size_t INITIAL_CAPACITY = 64 * 1024;
+}
+
+StoreWriter::StoreWriter(std::shared_ptr<Store> store, std::string key, std::chrono::milliseconds ttl) :
+    _store(std::move(store)),
+    _key(std::move(key)),
+    _ttl(ttl),
+    _data(nullptr),
+    _length(0),
+    _capacity(0),
+    _ended(false) {
+}
+
+StoreWriter::~StoreWriter() {
+    Release();
+}
+
+bool StoreWriter::Write(const void* data, size_t length, std::string& error) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_ended) {
+        error = "The writer of key \"" + _key + "\" has ended.";
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+
+    // Large reallocations are remapped by the C heap rather than copied on most platforms.
+    if (_capacity - _length < length) {
+        auto capacity = std::max(std::max(_capacity * 2, INITIAL_CAPACITY), _length + length);
+        auto grown = static_cast<char*>(std::realloc(_data, capacity));
+        if (grown == nullptr) {
+            error = "Failed to allocate " + std::to_string(capacity) + " bytes for the value of key \"" + _key + "\".";
+            return false;
+        }
+        _data = grown;
+        _capacity = capacity;
+    }
+
+    std::memcpy(_data + _length, data, length);
+    _length += length;
+    return true;
+}
+
+bool StoreWriter::End(std::string& error) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_ended) {
+        error = "The writer of key \"" + _key + "\" has ended.";
+        return false;
+    }
+
+    auto value = std::make_shared<Store::ValueType>();
+    value->kind = ValueKind::ARRAY_BUFFER;
+    value->ttl = _ttl;
+    if (_length > 0) {
+        // Spare capacity is given back, the value keeps its memory as long as it's stored or read.
+        auto data = _capacity > _length ? std::realloc(_data, _length) : _data;
+        value->buffer = napa::memory::AdoptSharedMemory(data != nullptr ? data : _data, _length);
+        _data = nullptr;
+        _length = 0;
+        _capacity = 0;
+    }
+
+    if (!_store->CanStore(_key.c_str(), *value, error)) {
+        // The buffer was taken over by the value, which frees it.
+        _ended = true;
+        return false;
+    }
+    _ended = true;
+    _store->Set(_key.c_str(), std::move(value));
+    return true;
+}
+
+void StoreWriter::Abort() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _ended = true;
+    Release();
+}
+
+size_t StoreWriter::GetLength() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_ended) {
+        return 0;
+    }
+    return _length;
+}
+
+bool StoreWriter::IsEnded() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _ended;
+}
+
+void StoreWriter::Release() {
+    std::free(_data);
+    _data = nullptr;
+    _length = 0;
+    _capacity = 0;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "store.h"
+
+#include <napa/exports.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace napa {
+namespace store {
+
+    /// <summary> Writes a large value of a key in chunks, which is set as an ARRAY_BUFFER once ended. </summary>
+    /// <remarks>
+    ///     Chunks are appended to memory of the C heap, which the value takes over without copying when it's set.
+    ///     Thus a value of hundreds of MB is never held by a JavaScript heap. Readers see the previous value of the key
+    ///     until the writer ends. It's thread-safe, and exposed in napa.dll like StoreWatcher.
+    /// </remarks>
+    class NAPA_API StoreWriter {
+    public:
+        /// <summary> Constructor. </summary>
+        /// <param name="store"> Store to set the value in. </param>
+        /// <param name="key"> Case-sensitive key of the value. </param>
+        /// <param name="ttl"> Time to live of the value, 0 for the TTL of the store. </param>
+        StoreWriter(std::shared_ptr<Store> store, std::string key, std::chrono::milliseconds ttl);
+
+        /// <summary> Frees the written bytes, unless they were set. </summary>
+        ~StoreWriter();
+
+        /// <summary> Non-copyable. </summary>
+        StoreWriter(const StoreWriter&) = delete;
+        StoreWriter& operator=(const StoreWriter&) = delete;
+
+        /// <summary> Appends bytes to the value. </summary>
+        /// <returns> False with error set if the writer has ended, or memory is exhausted. </returns>
+        bool Write(const void* data, size_t length, std::string& error);
+
+        /// <summary> Sets the value written so far in the store. </summary>
+        /// <returns> False with error set if the writer has ended already, or the store can't take the value. </returns>
+        bool End(std::string& error);
+
+        /// <summary> Drops the bytes written so far, the store is left unchanged. No-op if the writer has ended. </summary>
+        void Abort();
+
+        /// <summary> Get the number of bytes written. </summary>
+        size_t GetLength() const;
+
+        /// <summary> Whether the writer has ended or aborted. </summary>
+        bool IsEnded() const;
+
+    private:
+        /// <summary> Frees the buffer. Called under the lock. </summary>
+        void Release();
+
+        std::shared_ptr<Store> _store;
+        std::string _key;
+        std::chrono::milliseconds _ttl;
+
+        mutable std::mutex _lock;
+        char* _data;
+        size_t _length;
+        size_t _capacity;
+        bool _ended;
+    };
+}
+}
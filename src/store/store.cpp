@@ -2,19 +2,52 @@
 // Licensed under the MIT license.
 
 #include "store.h"
+#include "replicated-store.h"
+#include "shared-store.h"
+#include "snapshot-store.h"
+#include "store-image.h"
 
+#include <napa/log.h>
 #include <napa/memory.h>
+#include <napa/providers/metric.h>
+#include <utils/compression.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include <mutex>
+#include <shared_mutex>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 using namespace napa::store;
 
 class StoreImpl: public Store {
 public:
     /// <summary> Constructor. </summary>
-    explicit StoreImpl(const char* id)
-        : _id(id) {
+    StoreImpl(const char* id, const StoreOptions& options)
+        : _id(id), _options(options), _shards(options.shards) {
+
+        // Limits are divided among shards, so a shard evicts without looking at others.
+        _maxEntriesPerShard = DivideLimit(options.maxEntries, options.shards);
+        _maxBytesPerShard = DivideLimit(options.maxBytes, options.shards);
+
+        // Metrics are bound to the store id, so gets don't pass it on each count.
+        const char* dimensionNames[] = { "store" };
+        const char* dimensionValues[] = { _id.c_str() };
+        auto& metricProvider = napa::providers::GetMetricProvider();
+        auto bind = [&](const char* name) {
+            return napa::providers::BindMetric(
+                metricProvider.GetMetric("Store", name, napa::providers::MetricType::Rate, 1, dimensionNames), 1, dimensionValues);
+        };
+        _hitsMetric = bind("Hits");
+        _missesMetric = bind("Misses");
+        _evictionsMetric = bind("Evictions");
+        _expirationsMetric = bind("Expirations");
     }
 
     /// <summary> Get ID of this store. </summary>
@@ -22,87 +55,588 @@ public:
         return _id.c_str();
     }
 
+    /// <summary> Get the transport option that values are marshalled with. </summary>
+    napa::TransportOption GetTransportOption() const override {
+        return _options.transport;
+    }
+
+    /// <summary> Get the number of shards that keys are spread over. </summary>
+    size_t GetShardCount() const override {
+        return _shards.size();
+    }
+
+    /// <summary> Reads take a shared lock of their shard. </summary>
+    bool IsReadOptimized() const override {
+        return false;
+    }
+
+    /// <summary> Get how each isolate caches unmarshalled values. </summary>
+    ValueCacheOption GetValueCacheOption() const override {
+        return _options.valueCache;
+    }
+
+    /// <summary> Get the size from which marshalled values are compressed. </summary>
+    size_t GetCompressionThreshold() const override {
+        return _options.compressAbove;
+    }
+
     /// <summary> Set value with a key. </summary>
     /// <param name="key"> Case-sensitive key to set. </param>
     /// <param name="value"> A shared pointer of ValueType,
     /// which is composed by a pair of payload and transport context. </returns>
     void Set(const char* key, std::shared_ptr<Store::ValueType> value) override {
-        std::lock_guard<std::mutex> lock(_storeAccess);
-        auto it = _valueMap.find(key);
-        if (it != _valueMap.end()) {
-            it->second = std::move(value);
-        } else {
-            _valueMap.emplace(std::string(key), std::move(value));
+        value->version = NewValueVersion();
+
+        std::string keyString(key);
+        auto& shard = GetShard(keyString);
+
+        // Replaced and evicted values are released after the lock.
+        std::vector<std::shared_ptr<Store::ValueType>> released;
+
+        std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+        Assign(shard, std::move(keyString), std::move(value), false, released);
+    }
+
+    /// <summary> Set value with a key only if the current value has the expected version, 0 for no value. </summary>
+    bool CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<Store::ValueType> value) override {
+        std::string keyString(key);
+        auto& shard = GetShard(keyString);
+
+        std::vector<std::shared_ptr<Store::ValueType>> released;
+
+        std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+        auto entry = Find(shard, keyString);
+        if ((entry != nullptr ? GetValue(*entry)->version : 0) != expectedVersion) {
+            return false;
+        }
+
+        value->version = NewValueVersion();
+        Assign(shard, std::move(keyString), std::move(value), false, released);
+        return true;
+    }
+
+    /// <summary> Get value by a key, or set it if the key doesn't exist. </summary>
+    std::shared_ptr<Store::ValueType> GetOrSet(const char* key, std::shared_ptr<Store::ValueType> value) override {
+        std::string keyString(key);
+        auto& shard = GetShard(keyString);
+
+        std::vector<std::shared_ptr<Store::ValueType>> released;
+
+        std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+        auto entry = Find(shard, keyString);
+        if (entry != nullptr) {
+            entry->referenced.store(true, std::memory_order_relaxed);
+            Count(_hitsMetric);
+            return GetValue(*entry);
         }
+
+        Count(_missesMetric);
+        value->version = NewValueVersion();
+        Assign(shard, std::move(keyString), value, false, released);
+        return value;
+    }
+
+    /// <summary> Add to an integer value in place, keeping its expiry. </summary>
+    bool Increment(const char* key, int64_t delta, int64_t& result) override {
+        std::string keyString(key);
+        auto& shard = GetShard(keyString);
+
+        std::vector<std::shared_ptr<Store::ValueType>> released;
+
+        std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+        auto entry = Find(shard, keyString);
+        auto value = IncrementValue(entry != nullptr ? GetValue(*entry).get() : nullptr, delta, result);
+        if (value == nullptr) {
+            return false;
+        }
+
+        // A counter with a TTL expires relative to its first increment, so it can count within a time window.
+        Assign(shard, std::move(keyString), std::move(value), entry != nullptr, released);
+        return true;
+    }
+
+    /// <summary> Get values by keys, taking the shared lock of each shard once. </summary>
+    std::vector<std::shared_ptr<ValueType>> GetMany(const std::vector<std::string>& keys) const override {
+        std::vector<std::shared_ptr<ValueType>> values(keys.size());
+        auto groups = GroupByShard(keys, _shards.size());
+        for (size_t i = 0; i < groups.size(); ) {
+            auto& shard = _shards[groups[i].first];
+            std::shared_lock<std::shared_timed_mutex> lock(shard.access);
+            for (auto shardIndex = groups[i].first; i < groups.size() && groups[i].first == shardIndex; ++i) {
+                auto position = groups[i].second;
+                auto entry = Find(shard, keys[position]);
+                if (entry == nullptr) {
+                    Count(_missesMetric);
+                    continue;
+                }
+                if (!entry->referenced.load(std::memory_order_relaxed)) {
+                    entry->referenced.store(true, std::memory_order_relaxed);
+                }
+                Count(_hitsMetric);
+                values[position] = GetValue(*entry);
+            }
+        }
+        return values;
+    }
+
+    /// <summary> Set values with keys, taking the exclusive lock of each shard once. </summary>
+    void SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) override {
+        for (auto& value : values) {
+            value->version = NewValueVersion();
+        }
+
+        std::vector<std::shared_ptr<Store::ValueType>> released;
+
+        auto groups = GroupByShard(keys, _shards.size());
+        for (size_t i = 0; i < groups.size(); ) {
+            auto& shard = _shards[groups[i].first];
+            std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+            for (auto shardIndex = groups[i].first; i < groups.size() && groups[i].first == shardIndex; ++i) {
+                auto position = groups[i].second;
+                Assign(shard, keys[position], std::move(values[position]), false, released);
+            }
+        }
+    }
+
+    /// <summary> Get keys and values that start with a prefix, visiting each shard under its shared lock. </summary>
+    std::vector<KeyValue> Scan(const char* prefix, size_t limit) const override {
+        std::string prefixString(prefix);
+        auto now = Clock::now();
+
+        std::vector<KeyValue> entries;
+        for (auto& shard : _shards) {
+            std::shared_lock<std::shared_timed_mutex> lock(shard.access);
+            for (auto& entry : shard.entries) {
+                if (entry.second.expiry > now && entry.first.compare(0, prefixString.size(), prefixString) == 0) {
+                    entries.emplace_back(entry.first, GetValue(entry.second));
+                }
+            }
+        }
+        SortScan(entries, limit);
+        return entries;
+    }
+
+    /// <summary> Watch changes of keys. </summary>
+    void Watch(std::shared_ptr<StoreWatcher> watcher) override {
+        _watchers.Add(std::move(watcher));
     }
 
     /// <summary> Get value by a key. </summary>
     /// <param name="key"> Case-sensitive key to get. </param>
     /// <returns> A ValueType shared pointer, empty if not found. </returns>
     std::shared_ptr<ValueType> Get(const char* key) const override {
-        std::lock_guard<std::mutex> lock(_storeAccess);
-        auto it = _valueMap.find(key);
-        if (it != _valueMap.end()) {
-            return it->second;
+        std::string keyString(key);
+        auto& shard = GetShard(keyString);
+        std::shared_lock<std::shared_timed_mutex> lock(shard.access);
+        auto entry = Find(shard, keyString);
+        if (entry == nullptr) {
+            Count(_missesMetric);
+            return nullptr;
         }
-        return nullptr;
+
+        // Marking an entry as recently used only writes its cache line the first time after a sweep.
+        if (!entry->referenced.load(std::memory_order_relaxed)) {
+            entry->referenced.store(true, std::memory_order_relaxed);
+        }
+        Count(_hitsMetric);
+        return GetValue(*entry);
     }
 
     /// <summary> Check if this store has a key. </summary>
     /// <param name="key"> Case-sensitive key. </param>
     /// <returns> True if the key exists in store. </returns>
     bool Has(const char* key) const override {
-        std::lock_guard<std::mutex> lock(_storeAccess);
-        return _valueMap.find(key) != _valueMap.end();
+        std::string keyString(key);
+        auto& shard = GetShard(keyString);
+
+        std::shared_lock<std::shared_timed_mutex> lock(shard.access);
+        return Find(shard, keyString) != nullptr;
     }
 
     /// <summary> Delete a key. No-op if key is not found in store. </summary>
     void Delete(const char* key) override {
-        std::lock_guard<std::mutex> lock(_storeAccess);
-        _valueMap.erase(key);
+        std::string keyString(key);
+        auto& shard = GetShard(keyString);
+
+        std::shared_ptr<Store::ValueType> released;
+
+        std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+        auto it = shard.entries.find(keyString);
+        if (it != shard.entries.end()) {
+            released = Remove(shard, &*it);
+        }
+    }
+
+    /// <summary> Adds entries of an image, whose values are created on their first read. Called before the store is shared. </summary>
+    void Load(std::shared_ptr<const StoreImage> image) {
+        _image = std::move(image);
+        for (auto record : _image->GetRecords()) {
+            auto key = record->GetKey();
+            auto& shard = GetShard(key);
+            auto it = shard.entries.emplace(
+                std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple()).first;
+            it->second.record = record;
+            it->second.expiry = Clock::time_point::max();
+            it->second.clockIndex = shard.clock.size();
+            shard.clock.push_back(&*it);
+            shard.bytes += it->first.size() + GetByteLength(it->second);
+        }
     }
 
     /// <summary> Return size of the store. </summary>
+    /// <remarks>
+    ///     Shards are counted one after another, so the size may be off during concurrent writes.
+    ///     Expired entries are counted until they are reclaimed by writes of their shard.
+    /// </remarks>
     size_t Size() const override {
-        std::lock_guard<std::mutex> lock(_storeAccess);
-        return _valueMap.size();
+        size_t size = 0;
+        for (auto& shard : _shards) {
+            std::shared_lock<std::shared_timed_mutex> lock(shard.access);
+            size += shard.entries.size();
+        }
+        return size;
     }
 
 private:
+    using Clock = std::chrono::steady_clock;
+
+    /// <summary> A stored value with what's needed to expire and evict it. </summary>
+    struct Entry {
+        /// <summary> Value, nullptr until a loaded entry is first read. Set under a shared lock by GetValue only. </summary>
+        mutable std::shared_ptr<Store::ValueType> value;
+
+        /// <summary> Record of a loaded entry in the image of this store, nullptr once the entry is set. </summary>
+        const StoreImage::Record* record = nullptr;
+
+        /// <summary> Time after which the entry is expired, time_point::max() if it never expires. </summary>
+        Clock::time_point expiry;
+
+        /// <summary> Position of the entry in the clock of its shard. </summary>
+        size_t clockIndex = 0;
+
+        /// <summary> Whether the entry was read since the clock hand last passed it. Set under a shared lock. </summary>
+        mutable std::atomic<bool> referenced { false };
+    };
+
+    using EntryMap = std::unordered_map<std::string, Entry>;
+
+    /// <summary> A partition of keys with its own lock, so readers of a shard don't block each other. </summary>
+    struct Shard {
+        /// <summary> Key to entry map. </summary>
+        EntryMap entries;
+
+        /// <summary> Entries in a ring for CLOCK eviction, which approximates LRU without writing on each read. </summary>
+        /// <remarks> Nodes of an unordered_map don't move on rehash, so they can be referred to by pointers. </remarks>
+        std::vector<EntryMap::value_type*> clock;
+
+        /// <summary> Position of the clock hand. </summary>
+        size_t hand = 0;
+
+        /// <summary> Bytes of keys and payloads in this shard. </summary>
+        size_t bytes = 0;
+
+        /// <summary> Reader-writer lock of entries access. </summary>
+        mutable std::shared_timed_mutex access;
+    };
+
+    /// <summary> Counts an event of this store on a metric. </summary>
+    void Count(const napa::providers::BoundMetricPtr& metric) const {
+        if (metric != nullptr) {
+            metric->Increment(1);
+        }
+    }
+
+    /// <summary> Divides a store limit among shards, 0 for no limit. </summary>
+    static size_t DivideLimit(size_t limit, size_t shards) {
+        return limit == 0 ? 0 : std::max<size_t>(1, (limit + shards - 1) / shards);
+    }
+
+    /// <summary> Get the shard of a key. </summary>
+    Shard& GetShard(const std::string& key) {
+        return _shards[GetShardIndex(key, _shards.size())];
+    }
+
+    const Shard& GetShard(const std::string& key) const {
+        return const_cast<StoreImpl*>(this)->GetShard(key);
+    }
+
+    /// <summary> Find an entry that is not expired. </summary>
+    static const Entry* Find(const Shard& shard, const std::string& key) {
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end() || it->second.expiry <= Clock::now()) {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    static Entry* Find(Shard& shard, const std::string& key) {
+        return const_cast<Entry*>(Find(static_cast<const Shard&>(shard), key));
+    }
+
+    /// <summary> Get the value of an entry, which is created from its record on the first read of a loaded entry. </summary>
+    /// <remarks> Readers under the same shared lock may race to create it, the first one to publish wins. </remarks>
+    std::shared_ptr<Store::ValueType> GetValue(const Entry& entry) const {
+        auto value = std::atomic_load(&entry.value);
+        if (value == nullptr && entry.record != nullptr) {
+            auto created = _image->Materialize(*entry.record);
+            if (std::atomic_compare_exchange_strong(&entry.value, &value, created)) {
+                value = std::move(created);
+            }
+        }
+        return value;
+    }
+
+    /// <summary> Bytes of an entry's value, which are known from the record before it's created. </summary>
+    static size_t GetByteLength(const Entry& entry) {
+        auto value = std::atomic_load(&entry.value);
+        return value != nullptr ? value->GetByteLength() : static_cast<size_t>(entry.record->payloadLength);
+    }
+
+    /// <summary> Whether a shard holds more entries or bytes than its limits. </summary>
+    bool IsOverLimit(const Shard& shard) const {
+        return (_maxEntriesPerShard > 0 && shard.entries.size() > _maxEntriesPerShard)
+            || (_maxBytesPerShard > 0 && shard.bytes > _maxBytesPerShard);
+    }
+
+    /// <summary> Removes an entry from its shard, returning its value to release after the lock. </summary>
+    std::shared_ptr<Store::ValueType> Remove(Shard& shard, EntryMap::value_type* entry) {
+        _watchers.Notify(entry->first);
+
+        auto index = entry->second.clockIndex;
+        auto last = shard.clock.back();
+        shard.clock[index] = last;
+        last->second.clockIndex = index;
+        shard.clock.pop_back();
+
+        shard.bytes -= entry->first.size() + GetByteLength(entry->second);
+        auto value = std::move(entry->second.value);
+        shard.entries.erase(shard.entries.find(entry->first));
+        return value;
+    }
+
+    /// <summary> Inserts or replaces an entry under the exclusive lock of its shard, then evicts beyond limits. </summary>
+    /// <param name="keepExpiry"> Whether a replaced entry keeps its expiry, otherwise it's computed from the TTL. </param>
+    /// <param name="released"> Receives replaced and evicted values, to release after the lock. </param>
+    void Assign(
+        Shard& shard,
+        std::string key,
+        std::shared_ptr<Store::ValueType> value,
+        bool keepExpiry,
+        std::vector<std::shared_ptr<Store::ValueType>>& released) {
+
+        auto ttl = value->ttl.count() > 0 ? value->ttl : _options.ttl;
+        auto expiry = ttl.count() > 0 ? Clock::now() + ttl : Clock::time_point::max();
+
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            shard.bytes -= it->first.size() + GetByteLength(it->second);
+            released.emplace_back(std::move(it->second.value));
+            it->second.record = nullptr;
+            if (keepExpiry) {
+                expiry = it->second.expiry;
+            }
+        } else {
+            it = shard.entries.emplace(
+                std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple()).first;
+            it->second.clockIndex = shard.clock.size();
+            shard.clock.push_back(&*it);
+        }
+        _watchers.Notify(it->first);
+        shard.bytes += it->first.size() + value->GetByteLength();
+        it->second.value = std::move(value);
+        it->second.expiry = expiry;
+
+        Reclaim(shard, &*it, released);
+    }
+
+    /// <summary> Reclaims expired entries at the clock hand, then evicts entries until the shard is within its limits. </summary>
+    /// <param name="keep"> The entry that was just set, which is never evicted by its own write. </param>
+    void Reclaim(Shard& shard, const EntryMap::value_type* keep, std::vector<std::shared_ptr<Store::ValueType>>& released) {
+        auto now = Clock::now();
+
+        // A few entries are checked by each write, so expired entries don't pile up in shards without limits.
+        for (int i = 0; i < 2 && shard.clock.size() > 1; ++i) {
+            shard.hand %= shard.clock.size();
+            auto entry = shard.clock[shard.hand];
+            if (entry != keep && entry->second.expiry <= now) {
+                released.emplace_back(Remove(shard, entry));
+                Count(_expirationsMetric);
+            } else {
+                ++shard.hand;
+            }
+        }
+
+        // Each pass of the hand clears the referenced bits it meets, so an entry is evicted within two passes.
+        while (IsOverLimit(shard) && shard.clock.size() > 1) {
+            shard.hand %= shard.clock.size();
+            auto entry = shard.clock[shard.hand];
+            if (entry == keep || entry->second.referenced.exchange(false, std::memory_order_relaxed)) {
+                ++shard.hand;
+                continue;
+            }
+
+            auto expired = entry->second.expiry <= now;
+            released.emplace_back(Remove(shard, entry));
+            Count(expired ? _expirationsMetric : _evictionsMetric);
+        }
+    }
+
     /// <summary> ID. Case sensitive. </summary>
     std::string _id;
 
-    /// <summary> Key to value map. </summary>
-    std::unordered_map<std::string, std::shared_ptr<Store::ValueType>> _valueMap;
+    /// <summary> Options given on creation. </summary>
+    StoreOptions _options;
+
+    /// <summary> Maximum number of entries in each shard, 0 for no limit. </summary>
+    size_t _maxEntriesPerShard;
+
+    /// <summary> Maximum bytes of keys and payloads in each shard, 0 for no limit. </summary>
+    size_t _maxBytesPerShard;
+
+    /// <summary> Shards of keys, which are fixed on creation. </summary>
+    std::vector<Shard> _shards;
+
+    /// <summary> Watchers of changed keys. </summary>
+    StoreWatchers _watchers;
+
+    /// <summary> Image that loaded entries are created from, nullptr if the store isn't loaded. </summary>
+    std::shared_ptr<const StoreImage> _image;
 
-    /// <summary> Mutex to value map access. (use std::shared_mutex when it's public) </summary>
-    mutable std::mutex _storeAccess;
+    /// <summary> Metrics of gets that found a value, gets that didn't, and entries removed by limits and by TTL. </summary>
+    napa::providers::BoundMetricPtr _hitsMetric;
+    napa::providers::BoundMetricPtr _missesMetric;
+    napa::providers::BoundMetricPtr _evictionsMetric;
+    napa::providers::BoundMetricPtr _expirationsMetric;
 };
 
 namespace napa {
 namespace store {
 
     namespace {
-        std::unordered_map<std::string, std::weak_ptr<Store>> _storeRegistry;
-        std::mutex _registryAccess;
+
+        /// <summary> Stores by id, sharded so lookups of different ids don't contend, and lookups of an id share a lock. </summary>
+        /// <remarks> A store removes its entry when its last reference is released, so the registry holds live stores only. </remarks>
+        class StoreRegistry {
+        public:
+            /// <summary> Never destroyed, since stores referred to by JavaScript objects may be released during process exit. </summary>
+            static StoreRegistry& GetInstance() {
+                static auto registry = new StoreRegistry();
+                return *registry;
+            }
+
+            /// <summary> Registers a new store with the id, unless a live store has it. </summary>
+            /// <param name="create"> Creates the store under the lock of its shard, returns nullptr on failure. </param>
+            /// <returns> The new store, or nullptr if the id exists or the store can't be created. </returns>
+            template <typename Factory>
+            std::shared_ptr<Store> Insert(const std::string& id, Factory create) {
+                auto& shard = GetShard(id);
+
+                std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+                auto it = shard.entries.find(id);
+                if (it != shard.entries.end() && !it->second.store.expired()) {
+                    return nullptr;
+                }
+
+                std::unique_ptr<Store> created = create();
+                if (created == nullptr) {
+                    return nullptr;
+                }
+                auto address = created.get();
+                std::shared_ptr<Store> store(created.release(), [this, id](Store* store) {
+                    Remove(id, store);
+                    delete store;
+                });
+
+                // An expired entry is replaced, its store no longer removes it once released.
+                if (it == shard.entries.end()) {
+                    shard.entries.emplace(id, Entry { address, store });
+                    _size.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    it->second = Entry { address, store };
+                }
+                return store;
+            }
+
+            /// <summary> Get a live store by id, or nullptr. </summary>
+            std::shared_ptr<Store> Find(const std::string& id) const {
+                auto& shard = GetShard(id);
+
+                std::shared_lock<std::shared_timed_mutex> lock(shard.access);
+                auto it = shard.entries.find(id);
+                return it != shard.entries.end() ? it->second.store.lock() : nullptr;
+            }
+
+            /// <summary> Get number of registered stores, which are alive or being destroyed. </summary>
+            size_t GetSize() const {
+                return _size.load(std::memory_order_relaxed);
+            }
+
+        private:
+            struct Entry {
+                /// <summary> Address of the store, which identifies its entry after it's released. </summary>
+                const Store* address;
+                std::weak_ptr<Store> store;
+            };
+
+            struct Shard {
+                std::unordered_map<std::string, Entry> entries;
+                mutable std::shared_timed_mutex access;
+            };
+
+            static constexpr size_t SHARD_COUNT = 16;
+
+            Shard& GetShard(const std::string& id) const {
+                return _shards[GetShardIndex(id, SHARD_COUNT)];
+            }
+
+            /// <summary> Removes the entry of a released store, unless a new store has taken its id. </summary>
+            void Remove(const std::string& id, const Store* store) {
+                auto& shard = GetShard(id);
+
+                std::lock_guard<std::shared_timed_mutex> lock(shard.access);
+                auto it = shard.entries.find(id);
+                if (it != shard.entries.end() && it->second.address == store) {
+                    shard.entries.erase(it);
+                    _size.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+            mutable std::array<Shard, SHARD_COUNT> _shards;
+            std::atomic<size_t> _size { 0 };
+        };
+
     } // namespace
 
-    std::shared_ptr<Store> CreateStore(const char* id) {
-        std::lock_guard<std::mutex> lockWrite(_registryAccess);
-        
-        std::shared_ptr<Store> store;
-        auto it = _storeRegistry.find(id);
-        if (it == _storeRegistry.end()) {
-            store = std::make_shared<StoreImpl>(id);
-            _storeRegistry.insert(std::make_pair(std::string(id), store));
-        }
-        return store;
+    std::shared_ptr<Store> CreateStore(const char* id, const StoreOptions& options) {
+        return StoreRegistry::GetInstance().Insert(id, [id, &options]() -> std::unique_ptr<Store> {
+            auto storeOptions = options;
+            storeOptions.shards = options.shards > 0 ? options.shards : 1;
+            if (storeOptions.shared) {
+                // Memory of another process's store with the same id is attached, it keeps its own options.
+                auto store = SharedStore::Open(id, storeOptions);
+                if (store == nullptr) {
+                    LOG_ERROR("Store", "Failed to create or attach shared memory of store \"%s\".", id);
+                }
+                return store;
+            }
+            std::unique_ptr<Store> store;
+            if (storeOptions.readOptimized) {
+                store = std::make_unique<SnapshotStore>(id, storeOptions);
+            } else {
+                store = std::make_unique<StoreImpl>(id, storeOptions);
+            }
+            if (!storeOptions.replicaAddress.empty()) {
+                // Errors are logged by Start.
+                return ReplicatedStore::Start(std::move(store), storeOptions.replicaAddress, storeOptions.replicaPeers);
+            }
+            return store;
+        });
     }
 
-    std::shared_ptr<Store> GetOrCreateStore(const char* id) {
+    std::shared_ptr<Store> GetOrCreateStore(const char* id, const StoreOptions& options) {
         auto store = GetStore(id);
         if (store == nullptr) {
-            store = CreateStore(id);
+            store = CreateStore(id, options);
             if (store == nullptr) {
                 // Already created just now. Lookup again.
                 store = GetStore(id);
@@ -112,24 +646,189 @@ namespace store {
     }
 
     std::shared_ptr<Store> GetStore(const char* id) {
-        std::lock_guard<std::mutex> lockRead(_registryAccess);
-        auto it = _storeRegistry.find(id);
-        if (it != _storeRegistry.end()) {
-            return it->second.lock();
+        return StoreRegistry::GetInstance().Find(id);
+    }
+
+    bool SaveStore(const Store& store, const char* path, std::string& error) {
+        return StoreImage::Save(store, path, error);
+    }
+
+    std::shared_ptr<Store> LoadStore(const char* path, const char* id, std::string& error) {
+        auto image = StoreImage::Open(path, error);
+        if (image == nullptr) {
+            return nullptr;
+        }
+        std::string storeId(id != nullptr ? id : image->GetId().c_str());
+
+        // Values are created outside the registry lock, a read optimized store can't create them lazily.
+        std::unique_ptr<Store> store;
+        if (image->GetOptions().readOptimized) {
+            auto snapshotStore = std::make_unique<SnapshotStore>(storeId.c_str(), image->GetOptions());
+            std::vector<std::string> keys;
+            std::vector<std::shared_ptr<Store::ValueType>> values;
+            for (auto record : image->GetRecords()) {
+                keys.emplace_back(record->GetKey());
+                values.emplace_back(image->Materialize(*record));
+            }
+            snapshotStore->SetMany(keys, std::move(values));
+            store = std::move(snapshotStore);
+        } else {
+            auto storeImpl = std::make_unique<StoreImpl>(storeId.c_str(), image->GetOptions());
+            storeImpl->Load(std::move(image));
+            store = std::move(storeImpl);
+        }
+
+        auto registered = StoreRegistry::GetInstance().Insert(storeId, [&store]() {
+            return std::move(store);
+        });
+        if (registered == nullptr) {
+            error = "Store with id \"" + storeId + "\" already exists.";
         }
-        return std::shared_ptr<Store>();
+        return registered;
     }
 
-    size_t GetStoreCount() {
-        std::lock_guard<std::mutex> lockWrite(_registryAccess);
-        for (auto it = _storeRegistry.begin(); it != _storeRegistry.end(); ) {
-            if (it->second.use_count() == 0) {
-                _storeRegistry.erase(it++);
+    uint64_t NewValueVersion() {
+        // Unique across stores, so a store re-created with the same id never matches a cached value of the old one.
+        static std::atomic<uint64_t> nextVersion { 1 };
+        return nextVersion++;
+    }
+
+    std::shared_ptr<Store::ValueType> IncrementValue(const Store::ValueType* current, int64_t delta, int64_t& result) {
+        // Numbers beyond 2^53 may not be integers exactly, only those below are counters.
+        constexpr double maxExactInteger = 9007199254740992.0;
+
+        int64_t value = 0;
+        if (current != nullptr) {
+            if (current->kind == ValueKind::INTEGER) {
+                value = current->integer;
+            } else if (current->kind == ValueKind::NUMBER
+                && std::trunc(current->number) == current->number
+                && std::abs(current->number) <= maxExactInteger) {
+                value = static_cast<int64_t>(current->number);
             } else {
-                ++it;
+                return nullptr;
             }
         }
-        return _storeRegistry.size();
+
+        if ((delta > 0 && value > std::numeric_limits<int64_t>::max() - delta)
+            || (delta < 0 && value < std::numeric_limits<int64_t>::min() - delta)) {
+            return nullptr;
+        }
+        result = value + delta;
+
+        auto next = std::make_shared<Store::ValueType>();
+        next->kind = ValueKind::INTEGER;
+        next->integer = result;
+        next->version = NewValueVersion();
+        return next;
+    }
+
+    namespace {
+
+        /// <summary> Metrics of compression, which are reported by the store id. </summary>
+        struct CompressionMetrics {
+            napa::providers::Metric* compressedBytes;
+            napa::providers::Metric* uncompressedBytes;
+            napa::providers::Metric* compressionTime;
+            napa::providers::Metric* decompressionTime;
+        };
+
+        const CompressionMetrics& GetCompressionMetrics() {
+            static CompressionMetrics metrics = []() {
+                const char* dimensionNames[] = { "store" };
+                auto& metricProvider = napa::providers::GetMetricProvider();
+                auto get = [&](const char* name, napa::providers::MetricType type) {
+                    return metricProvider.GetMetric("Store", name, type, 1, dimensionNames);
+                };
+                return CompressionMetrics {
+                    get("CompressedBytes", napa::providers::MetricType::Rate),
+                    get("UncompressedBytes", napa::providers::MetricType::Rate),
+                    get("CompressionTime", napa::providers::MetricType::Percentile),
+                    get("DecompressionTime", napa::providers::MetricType::Percentile)
+                };
+            }();
+            return metrics;
+        }
+
+        int64_t MicrosecondsSince(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    } // namespace
+
+    void CompressValue(const Store& store, Store::ValueType& value) {
+        auto threshold = store.GetCompressionThreshold();
+        if (threshold == 0 || value.kind != ValueKind::MARSHALLED || value.compressed || value.payload.size() < threshold) {
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::string compressed;
+        if (!napa::utils::compression::Compress(value.payload.data(), value.payload.size(), compressed)) {
+            return;
+        }
+
+        auto& metrics = GetCompressionMetrics();
+        const char* dimensionValues[] = { store.GetId() };
+        if (metrics.compressionTime != nullptr) {
+            metrics.compressionTime->Set(MicrosecondsSince(start), 1, dimensionValues);
+        }
+
+        // Values that don't shrink, e.g. binary payloads of random data, are kept as is.
+        auto uncompressedSize = value.payload.size();
+        if (compressed.size() < uncompressedSize) {
+            value.payload = std::move(compressed);
+            value.compressed = true;
+        }
+        if (metrics.uncompressedBytes != nullptr) {
+            metrics.uncompressedBytes->Increment(uncompressedSize, 1, dimensionValues);
+        }
+        if (metrics.compressedBytes != nullptr) {
+            metrics.compressedBytes->Increment(value.payload.size(), 1, dimensionValues);
+        }
+    }
+
+    bool DecompressValue(const Store& store, const Store::ValueType& value, std::string& payload) {
+        auto start = std::chrono::steady_clock::now();
+        if (!napa::utils::compression::Decompress(value.payload.data(), value.payload.size(), payload)) {
+            LOG_ERROR("Store", "Compressed value of store \"%s\" is corrupted.", store.GetId());
+            return false;
+        }
+
+        auto& metrics = GetCompressionMetrics();
+        if (metrics.decompressionTime != nullptr) {
+            const char* dimensionValues[] = { store.GetId() };
+            metrics.decompressionTime->Set(MicrosecondsSince(start), 1, dimensionValues);
+        }
+        return true;
+    }
+
+    std::vector<std::pair<size_t, size_t>> GroupByShard(const std::vector<std::string>& keys, size_t shardCount) {
+        std::vector<std::pair<size_t, size_t>> groups;
+        groups.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            groups.emplace_back(GetShardIndex(keys[i], shardCount), i);
+        }
+        if (shardCount > 1) {
+            std::sort(groups.begin(), groups.end());
+        }
+        return groups;
+    }
+
+    void SortScan(std::vector<Store::KeyValue>& entries, size_t limit) {
+        auto byKey = [](const Store::KeyValue& left, const Store::KeyValue& right) {
+            return left.first < right.first;
+        };
+        if (limit > 0 && limit < entries.size()) {
+            std::partial_sort(entries.begin(), entries.begin() + limit, entries.end(), byKey);
+            entries.resize(limit);
+        } else {
+            std::sort(entries.begin(), entries.end(), byKey);
+        }
+    }
+
+    size_t GetStoreCount() {
+        return StoreRegistry::GetInstance().GetSize();
     }
 } // namespace store
 } // namespace napa
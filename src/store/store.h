@@ -4,14 +4,104 @@
 #pragma once
 
 #include <napa/exports.h>
+#include <napa/types.h>
 #include <napa/transport/transport-context.h>
 
+#include <memory/shared-memory.h>
+#include <store/store-watcher.h>
+#include <utils/hash.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace napa {
 namespace store {
 
+    /// <summary> How each isolate caches values that it has unmarshalled from a store. </summary>
+    enum class ValueCacheOption : uint32_t {
+        /// <summary> Each get unmarshalls the value. </summary>
+        NONE = 0,
+
+        /// <summary> Gets of an unchanged value return the same object, which is shared by its readers in the isolate. </summary>
+        SHARED,
+
+        /// <summary> Same as SHARED, with plain objects and arrays of the cached value frozen. </summary>
+        FROZEN
+    };
+
+    /// <summary> Kinds of stored values. Values other than MARSHALLED are kept natively, without a transport. </summary>
+    enum class ValueKind : uint32_t {
+        /// <summary> Payload and transport context of a value marshalled by the store's transport option. </summary>
+        MARSHALLED = 0,
+
+        /// <summary> null. </summary>
+        NUL,
+
+        /// <summary> A boolean primitive. </summary>
+        BOOLEAN,
+
+        /// <summary> A number primitive. </summary>
+        NUMBER,
+
+        /// <summary> A 64-bit integer, produced by Store::Increment. </summary>
+        INTEGER,
+
+        /// <summary> A string primitive, whose UTF-8 bytes are the payload. </summary>
+        STRING,
+
+        /// <summary> Contents of an ArrayBuffer, shared by all readers. </summary>
+        ARRAY_BUFFER
+    };
+
+    /// <summary> Options of a store, which are fixed on creation. </summary>
+    struct StoreOptions {
+        /// <summary> Transport option that values are marshalled with, AUTO (JSON) or BINARY. </summary>
+        napa::TransportOption transport = napa::TransportOption::AUTO;
+
+        /// <summary> Number of shards to spread keys over, more shards reduce lock contention of writes. </summary>
+        size_t shards = 1;
+
+        /// <summary> Whether writes publish immutable snapshots, so reads don't contend. </summary>
+        bool readOptimized = false;
+
+        /// <summary> How each isolate caches unmarshalled values. </summary>
+        ValueCacheOption valueCache = ValueCacheOption::NONE;
+
+        /// <summary> Time to live of values that aren't set with their own, 0 for no expiry. </summary>
+        /// <remarks> TTL and limits below are not supported by read optimized stores. </remarks>
+        std::chrono::milliseconds ttl { 0 };
+
+        /// <summary> Maximum number of keys, 0 for no limit. Least recently used keys are evicted beyond it. </summary>
+        /// <remarks> Limits are divided evenly among shards. </remarks>
+        size_t maxEntries = 0;
+
+        /// <summary> Maximum bytes of keys and payloads, 0 for no limit. Least recently used keys are evicted beyond it. </summary>
+        size_t maxBytes = 0;
+
+        /// <summary> Whether keys and values live in shared memory named by the id, so all processes of the host share them. </summary>
+        /// <remarks>
+        ///     Such a store has a fixed memory of maxBytes, 64MB by default, and evicts beyond it or maxEntries.
+        ///     It doesn't support TTL, nor read optimization, nor values holding shared objects.
+        /// </remarks>
+        bool shared = false;
+
+        /// <summary> Marshalled values of at least this many bytes are kept compressed, 0 to keep all values as is. </summary>
+        /// <remarks> Not supported by shared stores. </remarks>
+        size_t compressAbove = 0;
+
+        /// <summary> The "host:port" address to receive writes of peer processes on, empty for a store that isn't replicated. </summary>
+        /// <remarks> Writes propagate asynchronously, reads stay local. Not supported by shared stores. </remarks>
+        std::string replicaAddress;
+
+        /// <summary> The "host:port" addresses of the same store in peer processes, which writes are propagated to. </summary>
+        std::vector<std::string> replicaPeers;
+    };
+
     /// <summary> Class for memory store, which stores transportable JS objects across isolates. </summary>
     /// <remarks> Store is intended to be used by StoreWrap. 
     /// We expose Store in napa.dll instead of napa-binding for sharing memory between Napa and Node.JS. </remarks>
@@ -19,16 +109,69 @@ namespace store {
     public:
         /// Meta-data that is necessary to marshall/unmarshall JS values.
         struct ValueType {
-            /// <summary> JSON string from marshalled JS value. </summary>
+            /// <summary> Kind of the value, which tells the fields below that hold it. </summary>
+            ValueKind kind = ValueKind::MARSHALLED;
+
+            /// <summary> Value of BOOLEAN, NUMBER and INTEGER kinds. </summary>
+            union {
+                bool boolean;
+                double number;
+                int64_t integer = 0;
+            };
+
+            /// <summary> JSON string, or binary payload, from marshalled JS value. UTF-8 bytes of a STRING. </summary>
             std::string payload;
 
+            /// <summary> Memory of an ARRAY_BUFFER, nullptr if it's empty. </summary>
+            std::shared_ptr<napa::memory::SharedMemory> buffer;
+
             /// <summary> TransportContext that is needed to unmarshall the JS value. </summary>
             napa::transport::TransportContext transportContext;
+
+            /// <summary> Whether payload is in binary transport format. </summary>
+            bool binary = false;
+
+            /// <summary> Whether payload is compressed, see CompressValue. </summary>
+            bool compressed = false;
+
+            /// <summary> Process-wide unique version, assigned when the value is set. Unmarshalled values are cached by it. </summary>
+            uint64_t version = 0;
+
+            /// <summary> Time to live of the value, 0 for the TTL of its store. </summary>
+            std::chrono::milliseconds ttl { 0 };
+
+            /// <summary> Bytes held by the value, which limits of a store count. </summary>
+            size_t GetByteLength() const {
+                return payload.size() + (buffer != nullptr ? buffer->GetLength() : 0);
+            }
         };
 
         /// <summary> Get ID of this store. </summary>
         virtual const char* GetId() const = 0;
 
+        /// <summary> Get the transport option that values are marshalled with. </summary>
+        virtual napa::TransportOption GetTransportOption() const = 0;
+
+        /// <summary> Get the number of shards that keys are spread over, each guarded by its own reader-writer lock. </summary>
+        virtual size_t GetShardCount() const = 0;
+
+        /// <summary> Whether reads are served from per-thread snapshots, without locking or reference counting. </summary>
+        virtual bool IsReadOptimized() const = 0;
+
+        /// <summary> Get how each isolate caches unmarshalled values. </summary>
+        virtual ValueCacheOption GetValueCacheOption() const = 0;
+
+        /// <summary> Get the size from which marshalled values are compressed, 0 if they aren't. </summary>
+        virtual size_t GetCompressionThreshold() const {
+            return 0;
+        }
+
+        /// <summary> Check if a value can be set with a key, before it's set by any of the setters below. </summary>
+        /// <param name="error"> Receives the reason why the value can't be set. </param>
+        virtual bool CanStore(const char* /*key*/, const ValueType& /*value*/, std::string& /*error*/) const {
+            return true;
+        }
+
         /// <summary> Set value with a key. </summary>
         /// <param name="key"> Case-sensitive key to set. </param>
         /// <param name="value"> A shared pointer of ValueType,
@@ -40,11 +183,63 @@ namespace store {
         /// <returns> A ValueType shared pointer, empty if not found. </returns>
         virtual std::shared_ptr<ValueType> Get(const char* key) const = 0;
 
+        /// <summary> Read value by a key without taking a reference to it. </summary>
+        /// <param name="key"> Case-sensitive key to read. </param>
+        /// <param name="reader"> Called with the value, or nullptr if not found. The value is only valid during the call. </param>
+        virtual void Read(const char* key, const std::function<void(const ValueType*)>& reader) const {
+            auto value = Get(key);
+            reader(value.get());
+        }
+
         /// <summary> Check if this store has a key. </summary>
         /// <param name="key"> Case-sensitive key. </param>
         /// <returns> True if the key exists in store. </returns>
         virtual bool Has(const char* key) const = 0;
 
+        /// <summary> Set value with a key only if the current value has the expected version. </summary>
+        /// <param name="key"> Case-sensitive key to set. </param>
+        /// <param name="expectedVersion"> Version of the current value, or 0 if the key shall not exist. </param>
+        /// <param name="value"> Value to set, which gets a new version. </param>
+        /// <returns> True if the value is set, false if the current version didn't match. </returns>
+        virtual bool CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) = 0;
+
+        /// <summary> Get value by a key, or set it if the key doesn't exist. </summary>
+        /// <param name="key"> Case-sensitive key. </param>
+        /// <param name="value"> Value to set if the key doesn't exist. </param>
+        /// <returns> The existing value, or the given value if it's set. </returns>
+        virtual std::shared_ptr<ValueType> GetOrSet(const char* key, std::shared_ptr<ValueType> value) = 0;
+
+        /// <summary> Add to an integer value in place, which becomes an INTEGER. A missing key counts from 0. </summary>
+        /// <param name="key"> Case-sensitive key. </param>
+        /// <param name="delta"> Number to add, negative to decrement. </param>
+        /// <param name="result"> Value after the addition. </param>
+        /// <returns> False if the current value is not an integer, or the result overflows int64. </returns>
+        virtual bool Increment(const char* key, int64_t delta, int64_t& result) = 0;
+
+        /// <summary> Key and value pair, which Scan returns. </summary>
+        using KeyValue = std::pair<std::string, std::shared_ptr<ValueType>>;
+
+        /// <summary> Get values by keys, taking the lock of each shard once. </summary>
+        /// <param name="keys"> Case-sensitive keys to get. </param>
+        /// <returns> Values in the same order as keys, empty ones for keys not found. </returns>
+        virtual std::vector<std::shared_ptr<ValueType>> GetMany(const std::vector<std::string>& keys) const = 0;
+
+        /// <summary> Set values with keys, taking the lock of each shard once. A later duplicate of a key wins. </summary>
+        /// <param name="keys"> Case-sensitive keys to set. </param>
+        /// <param name="values"> Values in the same order as keys. </param>
+        virtual void SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) = 0;
+
+        /// <summary> Get keys, along with their values, that start with a prefix. </summary>
+        /// <param name="prefix"> Case-sensitive prefix, an empty prefix matches all keys. </param>
+        /// <param name="limit"> Maximum number of keys to return, 0 for no limit. </param>
+        /// <returns> Matched keys and values in ascending order of keys. </returns>
+        /// <remarks> Keys are hashed, so a scan visits all keys of the store. </remarks>
+        virtual std::vector<KeyValue> Scan(const char* prefix, size_t limit) const = 0;
+
+        /// <summary> Watch changes of keys, which are set, deleted or evicted. Expired keys are not notified. </summary>
+        /// <param name="watcher"> Watcher to notify, which is dropped by the store once closed. </param>
+        virtual void Watch(std::shared_ptr<StoreWatcher> watcher) = 0;
+
         /// <summary> Delete a key. No-op if key is not found in store. </summary>
         virtual void Delete(const char* key) = 0;
 
@@ -57,19 +252,71 @@ namespace store {
 
     /// <summary> Create a store by id. </summary>
     /// <param name="id"> Case-sensitive id. </summary>
+    /// <param name="options"> Options of the store. </summary>
     /// <returns> Newly created store, or nullptr if store associated with id already exists. </summary>
-    NAPA_API std::shared_ptr<Store> CreateStore(const char* id);
+    NAPA_API std::shared_ptr<Store> CreateStore(const char* id, const StoreOptions& options = StoreOptions());
 
     /// <summary> Get or create a store by id. </summary>
     /// <param name="id"> Case-sensitive id. </summary>
-    /// <returns> Existing or newly created store. Should never be nullptr. </summary>
-    NAPA_API std::shared_ptr<Store> GetOrCreateStore(const char* id);
+    /// <param name="options"> Options of the store if it's created, an existing store keeps its own. </summary>
+    /// <returns> Existing or newly created store, nullptr only if memory of a shared store can't be created or attached. </summary>
+    NAPA_API std::shared_ptr<Store> GetOrCreateStore(const char* id, const StoreOptions& options = StoreOptions());
 
     /// <summary> Get a store by id. </summary>
     /// <param name="id"> Case-sensitive id. </summary>
     /// <returns> Existing store or nullptr if not found. </summary>
     NAPA_API std::shared_ptr<Store> GetStore(const char* id);
 
+    /// <summary> Save values of a store to a file, which LoadStore maps back. </summary>
+    /// <param name="store"> Store to save, whose values holding shared objects can't be saved. </summary>
+    /// <param name="path"> Path of the file, which is replaced once the image is fully written. </summary>
+    /// <param name="error"> Receives the reason of a failure. </summary>
+    /// <returns> True if saved. </summary>
+    NAPA_API bool SaveStore(const Store& store, const char* path, std::string& error);
+
+    /// <summary> Create a store from a file that SaveStore has written. </summary>
+    /// <param name="path"> Path of the file, which is mapped into memory as long as the store is alive. </summary>
+    /// <param name="id"> Case-sensitive id of the new store, nullptr for the id of the saved store. </summary>
+    /// <param name="error"> Receives the reason of a failure. </summary>
+    /// <returns> Newly created store, or nullptr if the file is not a valid image or a store with the id already exists. </summary>
+    /// <remarks>
+    ///     Values of a store that isn't read optimized are created from the mapped file on their first read.
+    ///     A read optimized store creates all values on load. Loaded values get the TTL and limits of no store.
+    /// </remarks>
+    NAPA_API std::shared_ptr<Store> LoadStore(const char* path, const char* id, std::string& error);
+
+    /// <summary> Compresses the payload of a marshalled value if it reaches the compression threshold of a store. </summary>
+    /// <remarks>
+    ///     It's called before the value is set, on the thread setting it. The payload is kept as is if it doesn't shrink.
+    ///     Compressed and decompressed bytes, and the time taken, are reported with metrics of the store.
+    /// </remarks>
+    NAPA_API void CompressValue(const Store& store, Store::ValueType& value);
+
+    /// <summary> Decompresses the payload of a compressed value of a store. </summary>
+    /// <param name="payload"> Receives the decompressed payload. </param>
+    /// <returns> False if the payload is corrupted. </returns>
+    NAPA_API bool DecompressValue(const Store& store, const Store::ValueType& value, std::string& payload);
+
+    /// <summary> Get the shard of a key among shards of a store. Internal to store implementations. </summary>
+    /// <remarks> A hash other than std::hash, thus keys of a shard still spread over buckets of its map. </remarks>
+    inline size_t GetShardIndex(const std::string& key, size_t shardCount) {
+        return shardCount == 1 ? 0 : static_cast<size_t>(napa::utils::hash::XxHash64(key) % shardCount);
+    }
+
+    /// <summary> Get a new version for a value being set. Internal to store implementations. </summary>
+    uint64_t NewValueVersion();
+
+    /// <summary> Computes the value of Store::Increment from the current value, or nullptr. Internal to store implementations. </summary>
+    /// <returns> The new value, or nullptr if the current value is not an integer or the result overflows int64. </returns>
+    std::shared_ptr<Store::ValueType> IncrementValue(const Store::ValueType* current, int64_t delta, int64_t& result);
+
+    /// <summary> Get positions of keys grouped by their shards, in ascending order of shards. Internal to store implementations. </summary>
+    /// <returns> Pairs of shard index and position, positions of a shard keep their order. </returns>
+    std::vector<std::pair<size_t, size_t>> GroupByShard(const std::vector<std::string>& keys, size_t shardCount);
+
+    /// <summary> Sorts entries of a scan by key, then keeps the first limit ones, 0 for no limit. Internal to store implementations. </summary>
+    void SortScan(std::vector<Store::KeyValue>& entries, size_t limit);
+
     /// <summary> Get store count currently in use. </summary>
     NAPA_API size_t GetStoreCount();
 }
@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace napa {
+namespace utils {
+
+    /// <summary> Thread-safe pool that recycles memory blocks of a single size. </summary>
+    /// <remarks>
+    ///     The block size is fixed by the first allocation, blocks of other sizes fall through to the heap.
+    ///     Released blocks are kept in a free list of bounded capacity, the free list never grows after construction.
+    /// </remarks>
+    class BlockPool {
+    public:
+
+        /// <summary> Constructor. </summary>
+        /// <param name="capacity"> Maximum number of released blocks kept for reuse. </param>
+        explicit BlockPool(size_t capacity = 1024) : _blockSize(0), _heapAllocations(0) {
+            _freeBlocks.reserve(capacity);
+        }
+
+        /// <summary> Non-copyable. </summary>
+        BlockPool(const BlockPool&) = delete;
+        BlockPool& operator=(const BlockPool&) = delete;
+
+        /// <summary> Destructor. Returns the free blocks to the heap. </summary>
+        ~BlockPool() {
+            for (auto block : _freeBlocks) {
+                ::operator delete(block);
+            }
+        }
+
+        /// <summary> Allocates a block of given size. </summary>
+        void* Allocate(size_t size) {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                if (_blockSize == 0) {
+                    _blockSize = size;
+                }
+
+                if (size == _blockSize && !_freeBlocks.empty()) {
+                    auto block = _freeBlocks.back();
+                    _freeBlocks.pop_back();
+                    return block;
+                }
+            }
+
+            _heapAllocations++;
+            return ::operator new(size);
+        }
+
+        /// <summary> Releases a block allocated from this pool. </summary>
+        void Deallocate(void* block, size_t size) {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                if (size == _blockSize && _freeBlocks.size() < _freeBlocks.capacity()) {
+                    _freeBlocks.push_back(block);
+                    return;
+                }
+            }
+
+            ::operator delete(block);
+        }
+
+        /// <summary> Gets the number of blocks currently available for reuse. </summary>
+        size_t GetFreeCount() const {
+            std::lock_guard<std::mutex> lock(_lock);
+            return _freeBlocks.size();
+        }
+
+        /// <summary> Gets the number of allocations that were served by the heap since the pool was created. </summary>
+        uint64_t GetHeapAllocationCount() const {
+            return _heapAllocations;
+        }
+
+    private:
+        size_t _blockSize;
+        std::vector<void*> _freeBlocks;
+        std::atomic<uint64_t> _heapAllocations;
+        mutable std::mutex _lock;
+    };
+
+    /// <summary> STL allocator backed by a BlockPool, designed for std::allocate_shared. </summary>
+    /// <remarks>
+    ///     Each copy shares ownership of the pool, so objects may outlive the owner that created the pool.
+    ///     std::allocate_shared rebinds the allocator to its control block type, which makes every
+    ///     allocation through a given pool the same size.
+    /// </remarks>
+    template <typename T>
+    class PoolAllocator {
+    public:
+        typedef T value_type;
+
+        explicit PoolAllocator(std::shared_ptr<BlockPool> pool) : _pool(std::move(pool)) {}
+
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>& other) : _pool(other._pool) {}
+
+        T* allocate(size_t n) {
+            return static_cast<T*>(_pool->Allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_t n) {
+            _pool->Deallocate(p, n * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator==(const PoolAllocator<U>& other) const {
+            return _pool == other._pool;
+        }
+
+        template <typename U>
+        bool operator!=(const PoolAllocator<U>& other) const {
+            return _pool != other._pool;
+        }
+
+    private:
+        template <typename U>
+        friend class PoolAllocator;
+
+        std::shared_ptr<BlockPool> _pool;
+    };
+}
+}
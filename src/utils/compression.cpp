@@ -0,0 +1,228 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "compression.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace napa::utils;
+
+namespace {
+
+    /// <summary> Shortest match, which the token stores the length beyond. </summary>
+    constexpr size_t MIN_MATCH = 4;
+
+    /// <summary> The block format ends with at least 5 literals, and the last match starts at least 12 bytes before the end. </summary>
+    constexpr size_t LAST_LITERALS = 5;
+    constexpr size_t MATCH_FIND_LIMIT = 12;
+
+    /// <summary> Farthest a match may be, offsets are 16 bits. </summary>
+    constexpr size_t MAX_OFFSET = 65535;
+
+    /// <summary> Positions of recent sequences are kept in 2^HASH_BITS slots, 16KB that stay in L1 cache. </summary>
+    constexpr uint32_t HASH_BITS = 12;
+
+    /// <summary> After 2^SKIP_TRIGGER bytes without a match, the search skips ahead faster over incompressible data. </summary>
+    constexpr uint32_t SKIP_TRIGGER = 6;
+
+    inline uint32_t Read32(const uint8_t* data) {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t Hash(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    /// <summary> Writes the part of a length beyond 15 as bytes of 255 and a remainder. </summary>
+    inline uint8_t* WriteLength(uint8_t* output, size_t length) {
+        for (; length >= 255; length -= 255) {
+            *output++ = 255;
+        }
+        *output++ = static_cast<uint8_t>(length);
+        return output;
+    }
+
+    /// <summary> Reads the part of a length beyond 15, failing if it runs past the end. </summary>
+    inline bool ReadLength(const uint8_t*& input, const uint8_t* end, size_t& length) {
+        uint8_t byte;
+        do {
+            if (input == end) {
+                return false;
+            }
+            byte = *input++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    /// <summary> Writes a sequence of literals, followed by a match unless it's the last sequence. </summary>
+    uint8_t* WriteSequence(uint8_t* output, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength) {
+        auto token = output++;
+        *token = static_cast<uint8_t>((literalLength >= 15 ? 15 : literalLength) << 4);
+        if (literalLength >= 15) {
+            output = WriteLength(output, literalLength - 15);
+        }
+        if (literalLength > 0) {
+            std::memcpy(output, literals, literalLength);
+            output += literalLength;
+        }
+
+        if (matchLength == 0) {
+            return output;
+        }
+        *output++ = static_cast<uint8_t>(offset & 0xFF);
+        *output++ = static_cast<uint8_t>(offset >> 8);
+
+        matchLength -= MIN_MATCH;
+        *token |= static_cast<uint8_t>(matchLength >= 15 ? 15 : matchLength);
+        if (matchLength >= 15) {
+            output = WriteLength(output, matchLength - 15);
+        }
+        return output;
+    }
+
+}   // End of anonymous namespace.
+
+bool compression::Compress(const char* data, size_t size, std::string& output) {
+    if (size > MAX_INPUT_SIZE) {
+        return false;
+    }
+
+    // Worst case of incompressible input: a length byte per 255 literals, the token and the header.
+    output.resize(HEADER_SIZE + size + size / 255 + 16);
+    auto begin = reinterpret_cast<uint8_t*>(&output[0]);
+    for (size_t i = 0; i < HEADER_SIZE; i++) {
+        begin[i] = static_cast<uint8_t>((size >> (8 * i)) & 0xFF);
+    }
+
+    auto out = begin + HEADER_SIZE;
+    auto input = reinterpret_cast<const uint8_t*>(data);
+    size_t anchor = 0;
+
+    if (size > MATCH_FIND_LIMIT) {
+        std::vector<uint32_t> table(static_cast<size_t>(1) << HASH_BITS, 0);
+        auto matchLimit = size - LAST_LITERALS;
+        auto searchLimit = size - MATCH_FIND_LIMIT;
+
+        size_t position = 1;
+        table[Hash(Read32(input))] = 0;
+        while (position < searchLimit) {
+            auto sequence = Read32(input + position);
+            auto& slot = table[Hash(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(position);
+
+            if (position - candidate > MAX_OFFSET || Read32(input + candidate) != sequence) {
+                position += 1 + ((position - anchor) >> SKIP_TRIGGER);
+                continue;
+            }
+
+            // Extend the match backwards over pending literals, then forwards.
+            while (position > anchor && candidate > 0 && input[position - 1] == input[candidate - 1]) {
+                --position;
+                --candidate;
+            }
+            auto length = MIN_MATCH;
+            while (position + length < matchLimit && input[candidate + length] == input[position + length]) {
+                ++length;
+            }
+
+            out = WriteSequence(out, input + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+
+            // The position just before the next search often starts a match too.
+            if (position < searchLimit) {
+                table[Hash(Read32(input + position - 2))] = static_cast<uint32_t>(position - 2);
+            }
+        }
+    }
+
+    out = WriteSequence(out, input + anchor, size - anchor, 0, 0);
+    output.resize(static_cast<size_t>(out - begin));
+    return true;
+}
+
+bool compression::GetDecompressedSize(const char* data, size_t size, size_t& decompressedSize) {
+    if (size < HEADER_SIZE) {
+        return false;
+    }
+    decompressedSize = 0;
+    for (size_t i = 0; i < HEADER_SIZE; i++) {
+        decompressedSize |= static_cast<size_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return true;
+}
+
+bool compression::Decompress(const char* data, size_t size, std::string& output, size_t maxSize) {
+    size_t decompressedSize;
+    if (!GetDecompressedSize(data, size, decompressedSize) || decompressedSize > maxSize) {
+        return false;
+    }
+
+    output.resize(decompressedSize);
+    auto begin = decompressedSize > 0 ? reinterpret_cast<uint8_t*>(&output[0]) : nullptr;
+    auto out = begin;
+    auto outEnd = begin + decompressedSize;
+    auto input = reinterpret_cast<const uint8_t*>(data) + HEADER_SIZE;
+    auto end = reinterpret_cast<const uint8_t*>(data) + size;
+
+    while (true) {
+        if (input == end) {
+            return false;
+        }
+        auto token = *input++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(input, end, literalLength)) {
+            return false;
+        }
+        if (literalLength > static_cast<size_t>(end - input) || literalLength > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+        if (literalLength > 0) {
+            std::memcpy(out, input, literalLength);
+        }
+        input += literalLength;
+        out += literalLength;
+
+        // The last sequence has no match.
+        if (input == end) {
+            break;
+        }
+
+        if (end - input < 2) {
+            return false;
+        }
+        size_t offset = static_cast<size_t>(input[0]) | (static_cast<size_t>(input[1]) << 8);
+        input += 2;
+        if (offset == 0 || offset > static_cast<size_t>(out - begin)) {
+            return false;
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(input, end, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+
+        // A match may overlap the bytes it produces, e.g. a run of one byte has offset 1.
+        auto match = out - offset;
+        if (offset >= matchLength) {
+            std::memcpy(out, match, matchLength);
+            out += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; i++) {
+                *out++ = *match++;
+            }
+        }
+    }
+    return out == outEnd;
+}
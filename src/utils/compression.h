@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace napa {
+namespace utils {
+namespace compression {
+
+    /// <summary> Bytes before the compressed block, i.e. the decompressed size as a little-endian uint32. </summary>
+    constexpr size_t HEADER_SIZE = 4;
+
+    /// <summary> Largest input that Compress takes. </summary>
+    constexpr size_t MAX_INPUT_SIZE = 0x7E000000;
+
+    /// <summary> Compresses bytes into the LZ4 block format, prefixed with the decompressed size. </summary>
+    /// <remarks>
+    ///     It's a greedy single pass over a table of recent 4-byte sequences, which trades ratio for speed like LZ4's
+    ///     default level. Text, e.g. JSON, typically shrinks 3 to 10 times. Incompressible input grows by up to 0.4%.
+    /// </remarks>
+    /// <param name="output"> Receives the compressed bytes, replacing its contents. </param>
+    /// <returns> False if the input is larger than MAX_INPUT_SIZE. </returns>
+    bool Compress(const char* data, size_t size, std::string& output);
+
+    /// <summary> Gets the decompressed size of bytes that Compress has written. </summary>
+    /// <returns> False if the bytes are shorter than the header. </returns>
+    bool GetDecompressedSize(const char* data, size_t size, size_t& decompressedSize);
+
+    /// <summary> Decompresses bytes that Compress has written. Malformed input is detected, never read or written past. </summary>
+    /// <param name="output"> Receives the decompressed bytes, replacing its contents. </param>
+    /// <param name="maxSize"> Largest decompressed size accepted, larger ones fail before allocating. </param>
+    /// <returns> False if the bytes are malformed, or decompress to more than maxSize. </returns>
+    bool Decompress(const char* data, size_t size, std::string& output, size_t maxSize = MAX_INPUT_SIZE);
+}
+}
+}
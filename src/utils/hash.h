@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace napa {
+namespace utils {
+namespace hash {
+
+    /// <summary> Constants and helpers of xxHash64. </summary>
+    namespace detail {
+        const uint64_t PRIME64_1 = 11400714785074694791ULL;
+        const uint64_t PRIME64_2 = 14029467366897019727ULL;
+        const uint64_t PRIME64_3 = 1609587929392839161ULL;
+        const uint64_t PRIME64_4 = 9650029242287828579ULL;
+        const uint64_t PRIME64_5 = 2870177450012600261ULL;
+
+        inline uint64_t RotateLeft(uint64_t value, int bits) {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        /// <summary> Reads little-endian words, inputs are not necessarily aligned. </summary>
+        inline uint64_t Read64(const uint8_t* p) {
+            uint64_t value = 0;
+            for (int i = 7; i >= 0; --i) {
+                value = (value << 8) | p[i];
+            }
+            return value;
+        }
+
+        inline uint32_t Read32(const uint8_t* p) {
+            return static_cast<uint32_t>(p[0])
+                | (static_cast<uint32_t>(p[1]) << 8)
+                | (static_cast<uint32_t>(p[2]) << 16)
+                | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        inline uint64_t Round(uint64_t accumulator, uint64_t input) {
+            accumulator += input * PRIME64_2;
+            return RotateLeft(accumulator, 31) * PRIME64_1;
+        }
+
+        inline uint64_t MergeRound(uint64_t accumulator, uint64_t value) {
+            accumulator ^= Round(0, value);
+            return accumulator * PRIME64_1 + PRIME64_4;
+        }
+    }
+
+    /// <summary> 64-bit xxHash of a byte range. See: https://github.com/Cyan4973/xxHash </summary>
+    /// <param name="data"> Bytes to hash. </param>
+    /// <param name="length"> Number of bytes. </param>
+    /// <param name="seed"> Seed, different seeds give independent hashes of the same input. </param>
+    inline uint64_t XxHash64(const void* data, size_t length, uint64_t seed) {
+        using namespace detail;
+
+        auto p = static_cast<const uint8_t*>(data);
+        auto end = p + length;
+        uint64_t hash;
+
+        if (length >= 32) {
+            auto limit = end - 32;
+            uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+            uint64_t v2 = seed + PRIME64_2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME64_1;
+
+            do {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+            hash = MergeRound(hash, v1);
+            hash = MergeRound(hash, v2);
+            hash = MergeRound(hash, v3);
+            hash = MergeRound(hash, v4);
+        } else {
+            hash = seed + PRIME64_5;
+        }
+
+        hash += static_cast<uint64_t>(length);
+
+        for (; p + 8 <= end; p += 8) {
+            hash ^= Round(0, Read64(p));
+            hash = RotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+        }
+
+        if (p + 4 <= end) {
+            hash ^= static_cast<uint64_t>(Read32(p)) * PRIME64_1;
+            hash = RotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+            p += 4;
+        }
+
+        for (; p < end; ++p) {
+            hash ^= static_cast<uint64_t>(*p) * PRIME64_5;
+            hash = RotateLeft(hash, 11) * PRIME64_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= PRIME64_2;
+        hash ^= hash >> 29;
+        hash *= PRIME64_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    /// <summary> 64-bit xxHash of a string. </summary>
+    inline uint64_t XxHash64(const std::string& value, uint64_t seed = 0) {
+        return XxHash64(value.data(), value.size(), seed);
+    }
+
+    /// <summary> Formats a 64-bit hash as 16 lowercase hex digits. </summary>
+    inline std::string ToHexString(uint64_t hash) {
+        const char* digits = "0123456789abcdef";
+        std::string hex(16, '0');
+        for (int i = 15; i >= 0; --i) {
+            hex[i] = digits[hash & 0xF];
+            hash >>= 4;
+        }
+        return hex;
+    }
+}
+}
+}
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstddef>
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -138,6 +139,25 @@ namespace string {
     inline bool CaseInsensitiveEquals(const std::string& left, const std::string& right) {
         return CaseInsensitiveCompare(left, right) == 0;
     }
+
+    /// <summary> Appends a string as a quoted JSON string, escaping quotes, backslashes and control characters. </summary>
+    inline void AppendJsonString(std::string& out, const char* value) {
+        out.push_back('"');
+        for (auto p = value; *p != '\0'; ++p) {
+            auto c = static_cast<unsigned char>(*p);
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(static_cast<char>(c));
+            } else if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out.append(escaped);
+            } else {
+                out.push_back(static_cast<char>(c));
+            }
+        }
+        out.push_back('"');
+    }
 }
 }
 }
\ No newline at end of file
@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "text-search.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TEXT_SEARCH_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TEXT_SEARCH_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC compiles intrinsics of any instruction set without a target attribute.
+#if defined(TEXT_SEARCH_X64) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+using namespace napa::utils;
+
+namespace {
+
+    typedef size_t (*FindFunction)(const char* text, size_t size, const char* pattern, size_t length);
+
+    inline uint32_t CountTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+    }
+
+    /// <summary> Checks the candidates of a block, whose first and last characters matched, by their middle characters. </summary>
+    /// <param name="mask"> Candidates of the block, one bit per position, or per bitsPerPosition bits. </param>
+    inline size_t MatchCandidates(
+        uint64_t mask,
+        uint32_t bitsPerPosition,
+        const char* block,
+        size_t offset,
+        const char* pattern,
+        size_t length) {
+
+        while (mask != 0) {
+            auto position = CountTrailingZeros(mask) / bitsPerPosition;
+            if (std::memcmp(block + position + 1, pattern + 1, length - 2) == 0) {
+                return offset + position;
+            }
+
+            // Clears the bits of the position.
+            mask &= ~(((uint64_t(1) << bitsPerPosition) - 1) << (position * bitsPerPosition));
+        }
+        return text::NOT_FOUND;
+    }
+
+    /// <summary> Finds a pattern of at least 2 characters from an offset, for the tails SIMD blocks don't cover. </summary>
+    size_t FindFrom(const char* text, size_t size, const char* pattern, size_t length, size_t offset) {
+        auto result = text::FindScalar(text + offset, size - offset, pattern, length);
+        return result == text::NOT_FOUND ? result : result + offset;
+    }
+
+#ifdef TEXT_SEARCH_X64
+    size_t FindSse2(const char* text, size_t size, const char* pattern, size_t length) {
+        const size_t BLOCK = 16;
+        auto first = _mm_set1_epi8(pattern[0]);
+        auto last = _mm_set1_epi8(pattern[length - 1]);
+
+        size_t i = 0;
+        for (; i + length - 1 + BLOCK <= size; i += BLOCK) {
+            auto blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            auto blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + length - 1));
+            auto matches = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+            if (mask != 0) {
+                auto result = MatchCandidates(mask, 1, text + i, i, pattern, length);
+                if (result != text::NOT_FOUND) {
+                    return result;
+                }
+            }
+        }
+        return FindFrom(text, size, pattern, length, i);
+    }
+
+    TARGET_AVX2 size_t FindAvx2(const char* text, size_t size, const char* pattern, size_t length) {
+        const size_t BLOCK = 32;
+        auto first = _mm256_set1_epi8(pattern[0]);
+        auto last = _mm256_set1_epi8(pattern[length - 1]);
+
+        size_t i = 0;
+        for (; i + length - 1 + BLOCK <= size; i += BLOCK) {
+            auto blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            auto blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + length - 1));
+            auto matches = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+            if (mask != 0) {
+                auto result = MatchCandidates(mask, 1, text + i, i, pattern, length);
+                if (result != text::NOT_FOUND) {
+                    return result;
+                }
+            }
+        }
+        return FindFrom(text, size, pattern, length, i);
+    }
+
+    bool HasAvx2() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+
+        // AVX2 needs the OS to save YMM registers, which OSXSAVE and XCR0 tell.
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+#ifdef TEXT_SEARCH_NEON
+    size_t FindNeon(const char* text, size_t size, const char* pattern, size_t length) {
+        const size_t BLOCK = 16;
+        auto first = vdupq_n_u8(static_cast<uint8_t>(pattern[0]));
+        auto last = vdupq_n_u8(static_cast<uint8_t>(pattern[length - 1]));
+
+        size_t i = 0;
+        for (; i + length - 1 + BLOCK <= size; i += BLOCK) {
+            auto blockFirst = vld1q_u8(reinterpret_cast<const uint8_t*>(text + i));
+            auto blockLast = vld1q_u8(reinterpret_cast<const uint8_t*>(text + i + length - 1));
+            auto matches = vandq_u8(vceqq_u8(blockFirst, first), vceqq_u8(blockLast, last));
+
+            // NEON has no movemask, narrowing each byte to 4 bits gives a 64 bit mask instead.
+            auto mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+            if (mask != 0) {
+                auto result = MatchCandidates(mask, 4, text + i, i, pattern, length);
+                if (result != text::NOT_FOUND) {
+                    return result;
+                }
+            }
+        }
+        return FindFrom(text, size, pattern, length, i);
+    }
+#endif
+
+    struct Implementation {
+        FindFunction find;
+        const char* level;
+    };
+
+    const Implementation& GetImplementation() {
+        static const Implementation implementation = []() {
+#if defined(TEXT_SEARCH_X64)
+            return HasAvx2() ? Implementation{ FindAvx2, "avx2" } : Implementation{ FindSse2, "sse2" };
+#elif defined(TEXT_SEARCH_NEON)
+            return Implementation{ FindNeon, "neon" };
+#else
+            return Implementation{ text::FindScalar, "scalar" };
+#endif
+        }();
+        return implementation;
+    }
+}
+
+size_t text::Find(const char* text, size_t size, const char* pattern, size_t length) {
+    if (length < 2 || length > size) {
+        return FindScalar(text, size, pattern, length);
+    }
+    return GetImplementation().find(text, size, pattern, length);
+}
+
+const char* text::GetSimdLevel() {
+    return GetImplementation().level;
+}
+
+size_t text::FindScalar(const char* text, size_t size, const char* pattern, size_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    if (length > size) {
+        return NOT_FOUND;
+    }
+
+    // memchr is vectorized by the C runtime, which makes it a fair fallback for the first character.
+    auto end = text + size - length + 1;
+    for (auto candidate = text; candidate < end; ++candidate) {
+        candidate = static_cast<const char*>(std::memchr(candidate, pattern[0], end - candidate));
+        if (candidate == nullptr) {
+            return NOT_FOUND;
+        }
+        if (std::memcmp(candidate + 1, pattern + 1, length - 1) == 0) {
+            return static_cast<size_t>(candidate - text);
+        }
+    }
+    return NOT_FOUND;
+}
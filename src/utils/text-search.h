@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+
+namespace napa {
+namespace utils {
+namespace text {
+
+    /// <summary> Returned by Find when the pattern isn't found. </summary>
+    constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    /// <summary> Finds the first occurrence of a pattern in a text, which needn't be null terminated. </summary>
+    /// <remarks>
+    ///     Candidates are filtered by the first and last characters of the pattern, 16 or 32 positions at a time with
+    ///     the widest SIMD instructions the CPU supports, picked at runtime. It scans payloads of calls for markers.
+    /// </remarks>
+    /// <returns> Offset of the first occurrence, NOT_FOUND if there is none. An empty pattern is found at 0. </returns>
+    size_t Find(const char* text, size_t size, const char* pattern, size_t length);
+
+    /// <summary> Whether a text contains a pattern, see Find. </summary>
+    inline bool Contains(const char* text, size_t size, const char* pattern, size_t length) {
+        return Find(text, size, pattern, length) != NOT_FOUND;
+    }
+
+    /// <summary> Gets the instruction set Find uses on this CPU, i.e. "avx2", "sse2", "neon" or "scalar". </summary>
+    const char* GetSimdLevel();
+
+    /// <summary> Finds a pattern by the first character with memchr, the fallback and reference of Find. </summary>
+    size_t FindScalar(const char* text, size_t size, const char* pattern, size_t length);
+}
+}
+}
@@ -0,0 +1,462 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "typed-array-kernels.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define KERNELS_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC compiles intrinsics of any instruction set without a target attribute.
+#if defined(KERNELS_X64) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define TARGET_AVX2
+#endif
+
+using namespace napa::utils;
+
+namespace {
+
+    typedef double (*SumFunction)(const float* x, size_t length);
+    typedef double (*DotFunction)(const float* x, const float* y, size_t length);
+    typedef void (*AxpyFunction)(float a, const float* x, float* y, size_t length);
+    typedef float (*MaxFunction)(const float* x, size_t length);
+
+    /// <summary> Largest value, NaNs skipped, -infinity if there is none. </summary>
+    template <typename T>
+    T MaxScalar(const T* x, size_t length) {
+        auto max = -std::numeric_limits<T>::infinity();
+        for (size_t i = 0; i < length; ++i) {
+            if (x[i] > max) {
+                max = x[i];
+            }
+        }
+        return max;
+    }
+
+    /// <summary> Index of the first value equal to the largest one, which the SIMD kernels find first. </summary>
+    template <typename T>
+    size_t IndexOf(const T* x, size_t length, T value) {
+        for (size_t i = 0; i < length; ++i) {
+            if (x[i] == value) {
+                return i;
+            }
+        }
+        return kernels::NOT_FOUND;
+    }
+
+    // Kernels of double, and fallbacks of float, keep 4 independent accumulators, which hides the latency of adds.
+    template <typename T>
+    double SumUnrolled(const T* x, size_t length) {
+        T acc[4] = { 0, 0, 0, 0 };
+        size_t i = 0;
+        for (; i + 4 <= length; i += 4) {
+            acc[0] += x[i];
+            acc[1] += x[i + 1];
+            acc[2] += x[i + 2];
+            acc[3] += x[i + 3];
+        }
+        for (; i < length; ++i) {
+            acc[0] += x[i];
+        }
+        return static_cast<double>((acc[0] + acc[1]) + (acc[2] + acc[3]));
+    }
+
+    template <typename T>
+    double DotUnrolled(const T* x, const T* y, size_t length) {
+        T acc[4] = { 0, 0, 0, 0 };
+        size_t i = 0;
+        for (; i + 4 <= length; i += 4) {
+            acc[0] += x[i] * y[i];
+            acc[1] += x[i + 1] * y[i + 1];
+            acc[2] += x[i + 2] * y[i + 2];
+            acc[3] += x[i + 3] * y[i + 3];
+        }
+        for (; i < length; ++i) {
+            acc[0] += x[i] * y[i];
+        }
+        return static_cast<double>((acc[0] + acc[1]) + (acc[2] + acc[3]));
+    }
+
+    template <typename T>
+    void AxpyLoop(T a, const T* x, T* y, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            y[i] += a * x[i];
+        }
+    }
+
+#ifdef KERNELS_X64
+    inline float HorizontalSum(__m128 value) {
+        auto high = _mm_movehl_ps(value, value);
+        auto pairs = _mm_add_ps(value, high);
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    }
+
+    inline float HorizontalMax(__m128 value) {
+        auto high = _mm_movehl_ps(value, value);
+        auto pairs = _mm_max_ps(value, high);
+        return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+    }
+
+    double SumSse2(const float* x, size_t length) {
+        auto acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps(), acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            acc0 = _mm_add_ps(acc0, _mm_loadu_ps(x + i));
+            acc1 = _mm_add_ps(acc1, _mm_loadu_ps(x + i + 4));
+            acc2 = _mm_add_ps(acc2, _mm_loadu_ps(x + i + 8));
+            acc3 = _mm_add_ps(acc3, _mm_loadu_ps(x + i + 12));
+        }
+        auto sum = HorizontalSum(_mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)));
+        for (; i < length; ++i) {
+            sum += x[i];
+        }
+        return sum;
+    }
+
+    double DotSse2(const float* x, const float* y, size_t length) {
+        auto acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps(), acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(x + i + 8), _mm_loadu_ps(y + i + 8)));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(x + i + 12), _mm_loadu_ps(y + i + 12)));
+        }
+        auto sum = HorizontalSum(_mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)));
+        for (; i < length; ++i) {
+            sum += x[i] * y[i];
+        }
+        return sum;
+    }
+
+    void AxpySse2(float a, const float* x, float* y, size_t length) {
+        auto scale = _mm_set1_ps(a);
+        size_t i = 0;
+        for (; i + 4 <= length; i += 4) {
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(scale, _mm_loadu_ps(x + i))));
+        }
+        AxpyLoop(a, x + i, y + i, length - i);
+    }
+
+    // MAXPS returns its second operand if either is NaN, so NaNs of x never replace the maximum so far.
+    float MaxSse2(const float* x, size_t length) {
+        auto acc0 = _mm_set1_ps(-std::numeric_limits<float>::infinity()), acc1 = acc0;
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            acc0 = _mm_max_ps(_mm_loadu_ps(x + i), acc0);
+            acc1 = _mm_max_ps(_mm_loadu_ps(x + i + 4), acc1);
+        }
+        return std::max(HorizontalMax(_mm_max_ps(acc0, acc1)), MaxScalar(x + i, length - i));
+    }
+
+    TARGET_AVX2 inline __m128 Narrow(__m256 value) {
+        return _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    }
+
+    TARGET_AVX2 double SumAvx2(const float* x, size_t length) {
+        auto acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps(), acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32) {
+            acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+            acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(x + i + 8));
+            acc2 = _mm256_add_ps(acc2, _mm256_loadu_ps(x + i + 16));
+            acc3 = _mm256_add_ps(acc3, _mm256_loadu_ps(x + i + 24));
+        }
+        auto sum = HorizontalSum(Narrow(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3))));
+        for (; i < length; ++i) {
+            sum += x[i];
+        }
+        return sum;
+    }
+
+    TARGET_AVX2 double DotAvx2(const float* x, const float* y, size_t length) {
+        auto acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps(), acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= length; i += 32) {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), acc1);
+            acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 16), _mm256_loadu_ps(y + i + 16), acc2);
+            acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 24), _mm256_loadu_ps(y + i + 24), acc3);
+        }
+        auto sum = HorizontalSum(Narrow(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3))));
+        for (; i < length; ++i) {
+            sum += x[i] * y[i];
+        }
+        return sum;
+    }
+
+    TARGET_AVX2 void AxpyAvx2(float a, const float* x, float* y, size_t length) {
+        auto scale = _mm256_set1_ps(a);
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            _mm256_storeu_ps(y + i, _mm256_fmadd_ps(scale, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+        }
+        AxpyLoop(a, x + i, y + i, length - i);
+    }
+
+    TARGET_AVX2 float MaxAvx2(const float* x, size_t length) {
+        auto acc0 = _mm256_set1_ps(-std::numeric_limits<float>::infinity()), acc1 = acc0;
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            acc0 = _mm256_max_ps(_mm256_loadu_ps(x + i), acc0);
+            acc1 = _mm256_max_ps(_mm256_loadu_ps(x + i + 8), acc1);
+        }
+        auto max = _mm256_max_ps(acc0, acc1);
+        auto narrowed = _mm_max_ps(_mm256_castps256_ps128(max), _mm256_extractf128_ps(max, 1));
+        return std::max(HorizontalMax(narrowed), MaxScalar(x + i, length - i));
+    }
+
+    bool HasAvx2() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+
+        // AVX2 needs the OS to save YMM registers, which OSXSAVE and XCR0 tell.
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6 || (info[2] & (1 << 12)) == 0) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    }
+#endif
+
+#ifdef KERNELS_NEON
+    double SumNeon(const float* x, size_t length) {
+        auto acc0 = vdupq_n_f32(0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            acc0 = vaddq_f32(acc0, vld1q_f32(x + i));
+            acc1 = vaddq_f32(acc1, vld1q_f32(x + i + 4));
+            acc2 = vaddq_f32(acc2, vld1q_f32(x + i + 8));
+            acc3 = vaddq_f32(acc3, vld1q_f32(x + i + 12));
+        }
+        auto sum = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+        for (; i < length; ++i) {
+            sum += x[i];
+        }
+        return sum;
+    }
+
+    double DotNeon(const float* x, const float* y, size_t length) {
+        auto acc0 = vdupq_n_f32(0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        size_t i = 0;
+        for (; i + 16 <= length; i += 16) {
+            acc0 = vfmaq_f32(acc0, vld1q_f32(x + i), vld1q_f32(y + i));
+            acc1 = vfmaq_f32(acc1, vld1q_f32(x + i + 4), vld1q_f32(y + i + 4));
+            acc2 = vfmaq_f32(acc2, vld1q_f32(x + i + 8), vld1q_f32(y + i + 8));
+            acc3 = vfmaq_f32(acc3, vld1q_f32(x + i + 12), vld1q_f32(y + i + 12));
+        }
+        auto sum = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+        for (; i < length; ++i) {
+            sum += x[i] * y[i];
+        }
+        return sum;
+    }
+
+    void AxpyNeon(float a, const float* x, float* y, size_t length) {
+        auto scale = vdupq_n_f32(a);
+        size_t i = 0;
+        for (; i + 4 <= length; i += 4) {
+            vst1q_f32(y + i, vfmaq_f32(vld1q_f32(y + i), scale, vld1q_f32(x + i)));
+        }
+        AxpyLoop(a, x + i, y + i, length - i);
+    }
+
+    // FMAXNM returns the number if one operand is NaN.
+    float MaxNeon(const float* x, size_t length) {
+        auto acc0 = vdupq_n_f32(-std::numeric_limits<float>::infinity()), acc1 = acc0;
+        size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            acc0 = vmaxnmq_f32(acc0, vld1q_f32(x + i));
+            acc1 = vmaxnmq_f32(acc1, vld1q_f32(x + i + 4));
+        }
+        return std::max(vmaxnmvq_f32(vmaxnmq_f32(acc0, acc1)), MaxScalar(x + i, length - i));
+    }
+#endif
+
+    struct Implementation {
+        SumFunction sum;
+        DotFunction dot;
+        AxpyFunction axpy;
+        MaxFunction max;
+        const char* level;
+    };
+
+    const Implementation& GetImplementation() {
+        static const Implementation implementation = []() {
+#if defined(KERNELS_X64)
+            return HasAvx2()
+                ? Implementation{ SumAvx2, DotAvx2, AxpyAvx2, MaxAvx2, "avx2" }
+                : Implementation{ SumSse2, DotSse2, AxpySse2, MaxSse2, "sse2" };
+#elif defined(KERNELS_NEON)
+            return Implementation{ SumNeon, DotNeon, AxpyNeon, MaxNeon, "neon" };
+#else
+            return Implementation{ kernels::SumScalar, kernels::DotScalar, kernels::AxpyScalar, MaxScalar<float>, "scalar" };
+#endif
+        }();
+        return implementation;
+    }
+
+    /// <summary> Whether a candidate of TopK ranks before another, i.e. has a larger value or the same value at a smaller index. </summary>
+    template <typename T>
+    struct RanksBefore {
+        bool operator()(const std::pair<T, uint32_t>& left, const std::pair<T, uint32_t>& right) const {
+            return left.first > right.first || (left.first == right.first && left.second < right.second);
+        }
+    };
+
+    template <typename T>
+    size_t TopKHeap(const T* x, size_t length, size_t k, uint32_t* indices) {
+        if (k == 0) {
+            return 0;
+        }
+
+        // A heap ordered by RanksBefore has the candidate ranking last at its front.
+        RanksBefore<T> ranksBefore;
+        std::vector<std::pair<T, uint32_t>> heap;
+        heap.reserve(std::min(k, length));
+        for (size_t i = 0; i < length; ++i) {
+            if (x[i] != x[i]) {
+                continue;
+            }
+            std::pair<T, uint32_t> candidate(x[i], static_cast<uint32_t>(i));
+            if (heap.size() < k) {
+                heap.push_back(candidate);
+                std::push_heap(heap.begin(), heap.end(), ranksBefore);
+            } else if (ranksBefore(candidate, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), ranksBefore);
+                heap.back() = candidate;
+                std::push_heap(heap.begin(), heap.end(), ranksBefore);
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end(), ranksBefore);
+        for (size_t i = 0; i < heap.size(); ++i) {
+            indices[i] = heap[i].second;
+        }
+        return heap.size();
+    }
+
+    template <typename T>
+    void HistogramLoop(const T* x, size_t length, double min, double max, uint32_t* bins, size_t binCount) {
+        if (binCount == 0 || !(min <= max)) {
+            return;
+        }
+
+        // A range of a single value counts it in the first bin.
+        auto scale = max > min ? static_cast<double>(binCount) / (max - min) : 0.0;
+        auto last = binCount - 1;
+        for (size_t i = 0; i < length; ++i) {
+            double value = x[i];
+            if (!(value >= min && value <= max)) {
+                continue;
+            }
+            auto bin = static_cast<size_t>((value - min) * scale);
+            ++bins[bin < last ? bin : last];
+        }
+    }
+
+    template <typename T>
+    void SortNumbers(T* x, size_t length) {
+        auto end = std::partition(x, x + length, [](T value) { return value == value; });
+        std::sort(x, end);
+    }
+}
+
+const char* kernels::GetSimdLevel() {
+    return GetImplementation().level;
+}
+
+double kernels::Sum(const float* x, size_t length) {
+    return GetImplementation().sum(x, length);
+}
+
+double kernels::Sum(const double* x, size_t length) {
+    return SumUnrolled(x, length);
+}
+
+double kernels::Dot(const float* x, const float* y, size_t length) {
+    return GetImplementation().dot(x, y, length);
+}
+
+double kernels::Dot(const double* x, const double* y, size_t length) {
+    return DotUnrolled(x, y, length);
+}
+
+void kernels::Axpy(float a, const float* x, float* y, size_t length) {
+    GetImplementation().axpy(a, x, y, length);
+}
+
+void kernels::Axpy(double a, const double* x, double* y, size_t length) {
+    AxpyLoop(a, x, y, length);
+}
+
+size_t kernels::ArgMax(const float* x, size_t length) {
+    return IndexOf(x, length, GetImplementation().max(x, length));
+}
+
+size_t kernels::ArgMax(const double* x, size_t length) {
+    return IndexOf(x, length, MaxScalar(x, length));
+}
+
+size_t kernels::TopK(const float* x, size_t length, size_t k, uint32_t* indices) {
+    return TopKHeap(x, length, k, indices);
+}
+
+size_t kernels::TopK(const double* x, size_t length, size_t k, uint32_t* indices) {
+    return TopKHeap(x, length, k, indices);
+}
+
+void kernels::Histogram(const float* x, size_t length, double min, double max, uint32_t* bins, size_t binCount) {
+    HistogramLoop(x, length, min, max, bins, binCount);
+}
+
+void kernels::Histogram(const double* x, size_t length, double min, double max, uint32_t* bins, size_t binCount) {
+    HistogramLoop(x, length, min, max, bins, binCount);
+}
+
+void kernels::Sort(float* x, size_t length) {
+    SortNumbers(x, length);
+}
+
+void kernels::Sort(double* x, size_t length) {
+    SortNumbers(x, length);
+}
+
+double kernels::SumScalar(const float* x, size_t length) {
+    return SumUnrolled(x, length);
+}
+
+double kernels::DotScalar(const float* x, const float* y, size_t length) {
+    return DotUnrolled(x, y, length);
+}
+
+void kernels::AxpyScalar(float a, const float* x, float* y, size_t length) {
+    AxpyLoop(a, x, y, length);
+}
+
+size_t kernels::ArgMaxScalar(const float* x, size_t length) {
+    return IndexOf(x, length, MaxScalar(x, length));
+}
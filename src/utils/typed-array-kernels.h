@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace napa {
+namespace utils {
+namespace kernels {
+
+    /// <summary> Returned by ArgMax when there is no number to pick. </summary>
+    constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    /// <summary> Gets the instruction set kernels of float use on this CPU, i.e. "avx2", "sse2", "neon" or "scalar". </summary>
+    /// <remarks>
+    ///     Sum, Dot, Axpy and ArgMax of float run 8 or 4 lanes at a time with the widest SIMD instructions the CPU
+    ///     supports, picked at runtime. Kernels of double, and the others, are portable loops.
+    /// </remarks>
+    const char* GetSimdLevel();
+
+    /// <summary> Sums values. Floats are accumulated in float lanes, like BLAS, and returned as double. </summary>
+    double Sum(const float* x, size_t length);
+    double Sum(const double* x, size_t length);
+
+    /// <summary> Dot product of two arrays of the same length. </summary>
+    double Dot(const float* x, const float* y, size_t length);
+    double Dot(const double* x, const double* y, size_t length);
+
+    /// <summary> Adds a times x to y in place, i.e. y[i] += a * x[i]. </summary>
+    void Axpy(float a, const float* x, float* y, size_t length);
+    void Axpy(double a, const double* x, double* y, size_t length);
+
+    /// <summary> Gets the index of the first largest value, NaNs skipped. </summary>
+    /// <returns> The index, NOT_FOUND if the array is empty or only has NaNs. </returns>
+    size_t ArgMax(const float* x, size_t length);
+    size_t ArgMax(const double* x, size_t length);
+
+    /// <summary> Gets indices of the k largest values, NaNs skipped, in descending order of values, then ascending order of indices. </summary>
+    /// <param name="indices"> Receives up to k indices. </param>
+    /// <returns> Number of indices written, less than k if there are fewer numbers. </returns>
+    /// <remarks> It keeps a heap of k candidates, O(length * log k) without allocating per element. </remarks>
+    size_t TopK(const float* x, size_t length, size_t k, uint32_t* indices);
+    size_t TopK(const double* x, size_t length, size_t k, uint32_t* indices);
+
+    /// <summary> Counts values into bins of equal width over [min, max], adding to the counts bins already hold. </summary>
+    /// <remarks> The last bin includes max. Values out of range and NaNs are not counted. Counts of parts can be summed. </remarks>
+    void Histogram(const float* x, size_t length, double min, double max, uint32_t* bins, size_t binCount);
+    void Histogram(const double* x, size_t length, double min, double max, uint32_t* bins, size_t binCount);
+
+    /// <summary> Sorts values in ascending order in place, NaNs last like TypedArray.prototype.sort. </summary>
+    void Sort(float* x, size_t length);
+    void Sort(double* x, size_t length);
+
+    /// <summary> Portable loops behind the SIMD kernels of float, the fallback and reference of them. </summary>
+    double SumScalar(const float* x, size_t length);
+    double DotScalar(const float* x, const float* y, size_t length);
+    void AxpyScalar(float a, const float* x, float* y, size_t length);
+    size_t ArgMaxScalar(const float* x, size_t length);
+}
+}
+}
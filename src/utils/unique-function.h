@@ -0,0 +1,145 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace napa {
+namespace utils {
+
+    template <typename Signature>
+    class UniqueFunction;
+
+    /// <summary> Move-only counterpart of std::function, which keeps small callables inline without allocating. </summary>
+    /// <remarks>
+    ///     Callables up to INLINE_SIZE bytes that are nothrow movable are stored inline, larger ones on the heap.
+    ///     Being move-only, it can hold lambdas capturing move-only objects, and moving it never copies captures.
+    /// </remarks>
+    template <typename R, typename... Args>
+    class UniqueFunction<R(Args...)> {
+    public:
+
+        /// <summary> Size of the inline storage, enough for a lambda capturing a few pointers and shared_ptrs. </summary>
+        static constexpr size_t INLINE_SIZE = 8 * sizeof(void*);
+
+        /// <summary> Constructs an empty function. </summary>
+        UniqueFunction() noexcept : _operations(nullptr) {}
+
+        UniqueFunction(std::nullptr_t) noexcept : _operations(nullptr) {}
+
+        /// <summary> Constructs from a callable, which is moved or copied in. </summary>
+        template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, UniqueFunction>::value>::type>
+        UniqueFunction(F&& function) : _operations(nullptr) {
+            Emplace<typename std::decay<F>::type>(std::forward<F>(function), IsInline<typename std::decay<F>::type>());
+        }
+
+        UniqueFunction(UniqueFunction&& other) noexcept : _operations(other._operations) {
+            if (_operations != nullptr) {
+                _operations->move(&other._storage, &_storage);
+                other._operations = nullptr;
+            }
+        }
+
+        UniqueFunction& operator=(UniqueFunction&& other) noexcept {
+            if (this != &other) {
+                Reset();
+                if (other._operations != nullptr) {
+                    other._operations->move(&other._storage, &_storage);
+                    _operations = other._operations;
+                    other._operations = nullptr;
+                }
+            }
+            return *this;
+        }
+
+        UniqueFunction& operator=(std::nullptr_t) noexcept {
+            Reset();
+            return *this;
+        }
+
+        /// <summary> Non-copyable. </summary>
+        UniqueFunction(const UniqueFunction&) = delete;
+        UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+        ~UniqueFunction() {
+            Reset();
+        }
+
+        /// <summary> Whether it holds a callable. </summary>
+        explicit operator bool() const noexcept {
+            return _operations != nullptr;
+        }
+
+        /// <summary> Invokes the callable, which must not be empty. </summary>
+        R operator()(Args... args) {
+            return _operations->invoke(&_storage, std::forward<Args>(args)...);
+        }
+
+    private:
+
+        /// <summary> Type-erased operations on the storage, one static instance per callable type. </summary>
+        struct Operations {
+            R (*invoke)(void* storage, Args&&... args);
+            void (*move)(void* from, void* to) noexcept;
+            void (*destroy)(void* storage) noexcept;
+        };
+
+        template <typename F>
+        using IsInline = std::integral_constant<bool,
+            sizeof(F) <= INLINE_SIZE &&
+            alignof(F) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<F>::value>;
+
+        template <typename F, typename G>
+        void Emplace(G&& function, std::true_type) {
+            static const Operations operations = {
+                [](void* storage, Args&&... args) -> R {
+                    return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+                },
+                [](void* from, void* to) noexcept {
+                    ::new (to) F(std::move(*static_cast<F*>(from)));
+                    static_cast<F*>(from)->~F();
+                },
+                [](void* storage) noexcept {
+                    static_cast<F*>(storage)->~F();
+                }
+            };
+
+            ::new (static_cast<void*>(&_storage)) F(std::forward<G>(function));
+            _operations = &operations;
+        }
+
+        template <typename F, typename G>
+        void Emplace(G&& function, std::false_type) {
+            static const Operations operations = {
+                [](void* storage, Args&&... args) -> R {
+                    return (**static_cast<F**>(storage))(std::forward<Args>(args)...);
+                },
+                [](void* from, void* to) noexcept {
+                    *static_cast<F**>(to) = *static_cast<F**>(from);
+                },
+                [](void* storage) noexcept {
+                    delete *static_cast<F**>(storage);
+                }
+            };
+
+            *reinterpret_cast<F**>(&_storage) = new F(std::forward<G>(function));
+            _operations = &operations;
+        }
+
+        void Reset() noexcept {
+            if (_operations != nullptr) {
+                _operations->destroy(&_storage);
+                _operations = nullptr;
+            }
+        }
+
+        typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type _storage;
+        const Operations* _operations;
+    };
+}
+}
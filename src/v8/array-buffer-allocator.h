@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <memory/buffer-pool.h>
+
 #include <v8.h>
 #include <cstring>
 
@@ -29,5 +31,25 @@ namespace v8_extensions {
             free(data);
         }
     };
+
+    ///<summary> Allocator of |ArrayBuffer|'s memory from the process-wide buffer pool, shared by all napa isolates. </summary>
+    class PooledArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
+    public:
+
+        /// <see> v8::ArrayBuffer::Allocator::Allocate </see>
+        virtual void* Allocate(size_t length) override {
+            return napa::memory::BufferPool::GetInstance().AllocateZeroed(length);
+        }
+
+        /// <see> v8::ArrayBuffer::Allocator::AllocateUninitialized </see>
+        virtual void* AllocateUninitialized(size_t length) override {
+            return napa::memory::BufferPool::GetInstance().Allocate(length);
+        }
+
+        /// <see> v8::ArrayBuffer::Allocator::Free </see>
+        virtual void Free(void* data, size_t length) override {
+            napa::memory::BufferPool::GetInstance().Deallocate(data, length);
+        }
+    };
 }
 }
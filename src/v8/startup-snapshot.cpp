@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "startup-snapshot.h"
+
+#include <napa/log.h>
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+using namespace napa;
+
+namespace {
+    /// <summary> The loaded blob, which must outlive all isolates created from it. </summary>
+    std::vector<char> _blobData;
+    v8::StartupData _blob { nullptr, 0 };
+}
+
+bool v8_common::CreateStartupSnapshot(const std::string& source, const std::string& path) {
+#ifdef USING_V8_SHARED
+    UNUSED(source);
+    UNUSED(path);
+
+    // The host platform, e.g. node's, doesn't serve isolates it didn't register, like the one V8 creates for the snapshot.
+    LOG_ERROR("V8", "Startup snapshots can't be created when V8 is shared with the host, use mksnapshot of the same V8 version instead.");
+    return false;
+#else
+    auto blob = v8::V8::CreateSnapshotDataBlob(source.c_str());
+    std::unique_ptr<const char[]> data(blob.data);
+
+    if (data == nullptr || blob.raw_size <= 0) {
+        LOG_ERROR("V8", "Failed to create startup snapshot, the script may have thrown or used a native binding.");
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.get(), blob.raw_size);
+    if (!file) {
+        LOG_ERROR("V8", "Failed to write startup snapshot to \"%s\".", path.c_str());
+        return false;
+    }
+
+    LOG_INFO("V8", "Startup snapshot of %d bytes saved to \"%s\".", blob.raw_size, path.c_str());
+    return true;
+#endif
+}
+
+bool v8_common::LoadStartupSnapshot(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        LOG_ERROR("V8", "Failed to open startup snapshot \"%s\".", path.c_str());
+        return false;
+    }
+
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty()) {
+        LOG_ERROR("V8", "Startup snapshot \"%s\" is empty.", path.c_str());
+        return false;
+    }
+
+    _blobData = std::move(data);
+    _blob.data = _blobData.data();
+    _blob.raw_size = static_cast<int>(_blobData.size());
+
+    LOG_INFO("V8", "Startup snapshot \"%s\" loaded.", path.c_str());
+    return true;
+}
+
+v8::StartupData* v8_common::GetStartupSnapshot() {
+    return _blob.data != nullptr ? &_blob : nullptr;
+}
@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <v8.h>
+
+#include <string>
+
+namespace napa {
+namespace v8_common {
+
+    /// <summary> Creates a V8 startup snapshot that contains the globals defined by a script, and saves it to a file. </summary>
+    /// <param name="source"> Script to run in the context of the snapshot. It can't depend on native bindings, e.g. require. </param>
+    /// <param name="path"> Path of the snapshot blob file. </param>
+    /// <returns> True if the snapshot was created and saved. Always false when V8 is shared with the host, e.g. node. </returns>
+    bool CreateStartupSnapshot(const std::string& source, const std::string& path);
+
+    /// <summary> Loads a snapshot blob file, isolates created afterwards are deserialized from it. </summary>
+    /// <param name="path"> Path of a snapshot blob created by the same V8 version. </param>
+    /// <returns> True if the file was loaded. </returns>
+    bool LoadStartupSnapshot(const std::string& path);
+
+    /// <summary> Gets the loaded startup snapshot, or nullptr if none was loaded. </summary>
+    v8::StartupData* GetStartupSnapshot();
+}
+}
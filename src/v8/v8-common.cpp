@@ -5,8 +5,8 @@
 
 #ifdef USING_V8_SHARED
 
-// Empty stubs when using shared v8
-bool napa::v8_common::Initialize() { return true; }
+// Empty stubs when using shared v8, whose platform is owned by the host, e.g. sized by node's --v8-pool-size.
+bool napa::v8_common::Initialize(uint32_t) { return true; }
 void napa::v8_common::Shutdown() {}
 
 #else
@@ -20,10 +20,11 @@ void napa::v8_common::Shutdown() {}
 static v8::Platform* _platform = nullptr;
 
 
-bool napa::v8_common::Initialize() {
+bool napa::v8_common::Initialize(uint32_t platformThreads) {
     NAPA_ASSERT(!_platform, "V8 was already initialized");
 
-    _platform = v8::platform::CreateDefaultPlatform();
+    // Background tasks of all isolates, e.g. concurrent marking and compilation, share the pool of the platform.
+    _platform = v8::platform::CreateDefaultPlatform(static_cast<int>(platformThreads));
     v8::V8::InitializePlatform(_platform);
     v8::V8::Initialize();
 
@@ -3,11 +3,14 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace napa {
 namespace v8_common {
 
     /// <summary> Performs v8 global initialization. </summary>
-    bool Initialize();
+    /// <param name="platformThreads"> Number of threads running background tasks of V8, 0 for the number of processors. </param>
+    bool Initialize(uint32_t platformThreads);
 
     /// <summary> Shutdown and clean v8 global resources. </summary>
     void Shutdown();
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "allocation-profile.h"
+
+#include <utils/string.h>
+
+using namespace napa::zone;
+using napa::utils::string::AppendJsonString;
+
+namespace {
+
+    bool IsSameFunction(const AllocationProfileNode& left, const AllocationProfileNode& right) {
+        return left.lineNumber == right.lineNumber
+            && left.columnNumber == right.columnNumber
+            && left.functionName == right.functionName
+            && left.url == right.url;
+    }
+
+    // Recursive, as trees are only as deep as the stacks the sampling heap profiler keeps.
+    void AppendNode(std::string& out, const AllocationProfileNode& node, uint32_t& nextId) {
+        out.append("{\"callFrame\":{\"functionName\":");
+        AppendJsonString(out, node.functionName.c_str());
+        out.append(",\"scriptId\":\"").append(std::to_string(node.scriptId));
+        out.append("\",\"url\":");
+        AppendJsonString(out, node.url.c_str());
+        out.append(",\"lineNumber\":").append(std::to_string(node.lineNumber));
+        out.append(",\"columnNumber\":").append(std::to_string(node.columnNumber));
+        out.append("},\"selfSize\":").append(std::to_string(node.selfSize));
+        out.append(",\"id\":").append(std::to_string(nextId++));
+
+        out.append(",\"children\":[");
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            if (i > 0) {
+                out.push_back(',');
+            }
+            AppendNode(out, node.children[i], nextId);
+        }
+        out.append("]}");
+    }
+}
+
+void napa::zone::MergeAllocationProfile(AllocationProfileNode& merged, AllocationProfileNode&& profile) {
+    merged.selfSize += profile.selfSize;
+
+    for (auto& child : profile.children) {
+        auto found = false;
+        for (auto& mergedChild : merged.children) {
+            if (IsSameFunction(mergedChild, child)) {
+                MergeAllocationProfile(mergedChild, std::move(child));
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            merged.children.push_back(std::move(child));
+        }
+    }
+}
+
+std::string napa::zone::ToHeapProfileJson(const AllocationProfileNode& root) {
+    // Node ids start at 1, DevTools reads the tree only, samples are left empty.
+    std::string out = "{\"head\":";
+    uint32_t nextId = 1;
+    AppendNode(out, root, nextId);
+    out.append(",\"samples\":[]}");
+    return out;
+}
@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> A function of the call tree of a sampling heap profile, with the bytes sampled in it. </summary>
+    struct AllocationProfileNode {
+        std::string functionName;
+        std::string url;
+        int32_t scriptId = 0;
+
+        /// <summary> Numbered from 0 as in DevTools, -1 if unknown. </summary>
+        int32_t lineNumber = -1;
+        int32_t columnNumber = -1;
+
+        /// <summary> Bytes of the sampled allocations made by the function itself, scaled by V8 to estimate all allocations. </summary>
+        uint64_t selfSize = 0;
+
+        std::vector<AllocationProfileNode> children;
+    };
+
+    /// <summary> Merges the call tree of a worker into the merged one, adding up the sizes of the same call paths. </summary>
+    /// <remarks>
+    ///     Functions are the same when their name, url, line and column are, as each isolate numbers scripts on its own.
+    ///     The merged tree keeps the script id of the first worker which sampled the function.
+    /// </remarks>
+    NAPA_API void MergeAllocationProfile(AllocationProfileNode& merged, AllocationProfileNode&& profile);
+
+    /// <summary> Serializes a call tree in the .heapprofile JSON format of Chrome DevTools. </summary>
+    NAPA_API std::string ToHeapProfileJson(const AllocationProfileNode& root);
+}
+}
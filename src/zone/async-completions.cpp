@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "async-completions.h"
+
+#include "sync-wait.h"
+#include "worker-context.h"
+
+#include <v8.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+class AsyncCompletions::DrainTask : public Task {
+public:
+    explicit DrainTask(std::shared_ptr<AsyncCompletions> completions) : _completions(std::move(completions)) {}
+
+    void Execute() override {
+        _completions->Drain();
+    }
+
+private:
+    std::shared_ptr<AsyncCompletions> _completions;
+};
+
+std::shared_ptr<AsyncCompletions> AsyncCompletions::Get() {
+    auto completions = static_cast<std::shared_ptr<AsyncCompletions>*>(WorkerContext::Get(WorkerContextItem::ASYNC_COMPLETIONS));
+    if (completions == nullptr) {
+        if (WorkerContext::Get(WorkerContextItem::ZONE) == nullptr) {
+            return nullptr;
+        }
+
+        completions = new std::shared_ptr<AsyncCompletions>(std::make_shared<AsyncCompletions>());
+        WorkerContext::Set(WorkerContextItem::ASYNC_COMPLETIONS, completions);
+
+        // Synchronous calls made on the worker run completions while they wait, which the call may wait for.
+        SetPendingWork([completions = *completions]() {
+            completions->Drain();
+        });
+    }
+
+    return *completions;
+}
+
+void AsyncCompletions::Destroy() {
+    auto completions = static_cast<std::shared_ptr<AsyncCompletions>*>(WorkerContext::Get(WorkerContextItem::ASYNC_COMPLETIONS));
+    WorkerContext::Set(WorkerContextItem::ASYNC_COMPLETIONS, nullptr);
+    SetPendingWork(nullptr);
+    delete completions;
+}
+
+void AsyncCompletions::Post(std::shared_ptr<AsyncContext> context) {
+    auto scheduler = context->scheduler;
+    auto workerId = context->workerId;
+
+    // The inbox holds a raw pointer, the context keeps itself alive until the completion ran.
+    auto item = context.get();
+    item->self = std::move(context);
+
+    if (_inbox.Push(item)) {
+        scheduler->ScheduleOnWorker(workerId, std::make_shared<DrainTask>(shared_from_this()));
+    }
+}
+
+void AsyncCompletions::Drain() {
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+
+    auto item = _inbox.TakeAll();
+    while (item != nullptr) {
+        auto context = std::move(item->self);
+        item = item->nextCompletion;
+
+        auto jsCallback = v8::Local<v8::Function>::New(isolate, context->jsCallback);
+        context->asyncCompleteCallback(jsCallback, context->result);
+
+        context->jsCallback.Reset();
+        context->scheduler->UnpinWorker(context->workerId);
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "async-context.h"
+
+#include <napa/zone/completion-inbox.h>
+
+#include <memory>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Completions of asynchronous work posted by a zone worker, which run on the same worker. </summary>
+    /// <remarks>
+    ///     Completions accumulate in a lock-free inbox. Only the first completion into an empty inbox schedules a task
+    ///     on the worker, which runs all completions in the inbox by then, so completions that finish together
+    ///     share one task and one HandleScope. Synchronous calls waiting on the worker run them as well.
+    /// </remarks>
+    class AsyncCompletions : public std::enable_shared_from_this<AsyncCompletions> {
+    public:
+
+        /// <summary> Gets the completions of the calling worker, creating them on first use. </summary>
+        /// <returns> The completions, or nullptr if the calling thread isn't a napa zone worker. </returns>
+        static std::shared_ptr<AsyncCompletions> Get();
+
+        /// <summary> Releases the completions of the calling worker if any, before its isolate is disposed. </summary>
+        static void Destroy();
+
+        /// <summary> Posts the completion of an asynchronous work to the worker. Called from any thread. </summary>
+        /// <param name="context"> The context of the work, whose result is set. </param>
+        void Post(std::shared_ptr<AsyncContext> context);
+
+    private:
+
+        /// <summary> Task that runs the completions in the inbox on the worker. </summary>
+        class DrainTask;
+
+        /// <summary> Runs the completions in the inbox, in the order they were posted. </summary>
+        void Drain();
+
+        CompletionInbox<AsyncContext> _inbox;
+    };
+}
+}
@@ -10,11 +10,13 @@
 
 #include <v8.h>
 
-#include <future>
+#include <memory>
 
 namespace napa {
 namespace zone {
-    
+
+    class AsyncCompletions;
+
     /// <summary> Class holding asynchronous callbacks. </summary>
     struct AsyncContext {
         /// <summary> Zone instance issueing asynchronous work. </summary>
@@ -26,13 +28,10 @@ namespace zone {
         /// <summary> Worker Id issueing asynchronous work. </summary>
         zone::WorkerId workerId;
 
-        /// <summary> Future to wait async callback. </summary>
-        std::future<void> future;
-
         /// <summary> Javascript callback. </summary>
         v8::Persistent<v8::Function> jsCallback;
 
-        /// <summary> Function to run asynchronously in separate thread. </summary>
+        /// <summary> Function to run asynchronously in separate thread, released once it ran. </summary>
         AsyncWork asyncWork;
 
         /// <summary> Return value from asynchronous work. </summary>
@@ -40,6 +39,15 @@ namespace zone {
 
         /// <summary> Callback running in V8 isolate after asynchronous callback completes. </summary>
         AsyncCompleteCallback asyncCompleteCallback;
+
+        /// <summary> Completions of the worker issueing asynchronous work. </summary>
+        std::shared_ptr<AsyncCompletions> completions;
+
+        /// <summary> Reference to itself while the completion is in the inbox. </summary>
+        std::shared_ptr<AsyncContext> self;
+
+        /// <summary> Next completion in the inbox. </summary>
+        AsyncContext* nextCompletion = nullptr;
     };
 
 }   // End of namespace zone.
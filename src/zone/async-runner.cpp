@@ -3,9 +3,14 @@
 
 #include <napa/zone/napa-async-runner.h>
 
-#include <zone/async-complete-task.h>
+#include <zone/async-completions.h>
+#include <zone/async-workers.h>
+#include <zone/event-loop.h>
 #include <zone/worker-context.h>
 #include <zone/napa-zone.h>
+#include <zone/timer.h>
+
+#include <napa/providers/metric.h>
 
 using namespace napa;
 using namespace napa::zone;
@@ -21,26 +26,35 @@ namespace {
                                                    AsyncWork asyncWork,
                                                    AsyncCompleteCallback asyncCompleteCallback);
 
+    /// <summary> Reports the number of jobs of a pool that didn't start yet. </summary>
+    void UpdateQueueDepthMetric(AsyncWorkPool pool);
+
 }   // End of anonymous namespace.
 
 /// <summary> It runs a synchronous function in the separate thread and posts a completion into the current V8 execution loop. </summary>
 /// <param name="jsCallback"> Javascript callback. </summary>
 /// <param name="asyncWork"> Function to run asynchronously in separate thread. </param>
 /// <param name="asyncCompleteCallback"> Callback running in V8 isolate after asynchronous callback completes. </param>
+/// <param name="pool"> The process-wide pool whose threads run 'asyncWork'. </param>
 void napa::zone::PostAsyncWork(v8::Local<v8::Function> jsCallback,
                                AsyncWork asyncWork,
-                               AsyncCompleteCallback asyncCompleteCallback) {
+                               AsyncCompleteCallback asyncCompleteCallback,
+                               AsyncWorkPool pool) {
     auto context = PrepareAsyncWork(jsCallback, std::move(asyncWork), std::move(asyncCompleteCallback));
     if (context == nullptr) {
         return;
     }
 
-    context->future = std::async(std::launch::async, [context]() {
+    // The completion is scheduled by the pool thread once the work returned, so it never waits on the work.
+    AsyncWorkers::GetInstance().Execute(pool, [context, pool]() {
+        UpdateQueueDepthMetric(pool);
+
         context->result = context->asyncWork();
+        context->asyncWork = nullptr;
 
-        auto asyncCompleteTask = std::make_shared<AsyncCompleteTask>(context);
-        context->zone->GetScheduler()->ScheduleOnWorker(context->workerId, asyncCompleteTask);
+        context->completions->Post(context);
     });
+    UpdateQueueDepthMetric(pool);
 }
 
 /// <summary> It runs an asynchronous function and post a completion into the current V8 execution loop. </summary>
@@ -58,11 +72,38 @@ void napa::zone::DoAsyncWork(v8::Local<v8::Function> jsCallback,
     asyncWork([context](void* result) {
         context->result = result;
 
-        auto asyncCompleteTask = std::make_shared<AsyncCompleteTask>(context);
-        context->zone->GetScheduler()->ScheduleOnWorker(context->workerId, asyncCompleteTask);
+        context->completions->Post(context);
     });
 }
 
+/// <summary> It posts a completion into the current V8 execution loop after a delay. </summary>
+/// <param name="jsCallback"> Javascript callback. </summary>
+/// <param name="delay"> Delay after which the completion is posted. </param>
+/// <param name="asyncCompleteCallback"> Callback running in V8 isolate after the delay, with a null result. </param>
+void napa::zone::PostDelayedCompletion(v8::Local<v8::Function> jsCallback,
+                                       std::chrono::milliseconds delay,
+                                       AsyncCompleteCallback asyncCompleteCallback) {
+    // The timer is destroyed by the completion on the worker, as timer callbacks must not destroy their timer.
+    auto timer = std::make_shared<std::unique_ptr<Timer>>();
+    DoAsyncWork(jsCallback,
+        [&timer, delay](std::function<void(void*)> complete) {
+            *timer = std::make_unique<Timer>([complete = std::move(complete)]() {
+                complete(nullptr);
+            }, delay);
+            (*timer)->Start();
+        },
+        [timer, asyncCompleteCallback = std::move(asyncCompleteCallback)](v8::Local<v8::Function> jsCallback, void* result) {
+            timer->reset();
+            asyncCompleteCallback(jsCallback, result);
+        });
+}
+
+/// <summary> It gets the libuv loop of the calling worker. </summary>
+uv_loop_s* napa::zone::GetEventLoop() {
+    auto eventLoop = static_cast<EventLoop*>(WorkerContext::Get(WorkerContextItem::EVENT_LOOP));
+    return eventLoop != nullptr ? eventLoop->Get() : nullptr;
+}
+
 namespace {
 
     std::shared_ptr<AsyncContext> PrepareAsyncWork(v8::Local<v8::Function> jsCallback,
@@ -78,10 +119,14 @@ namespace {
             return nullptr;
         }
 
+        context->completions = AsyncCompletions::Get();
         context->scheduler = context->zone->GetScheduler();
         context->workerId = static_cast<WorkerId>(
             reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
 
+        // Keep the worker from being removed or recycling its isolate until the completion ran on it.
+        context->scheduler->PinWorker(context->workerId);
+
         context->jsCallback.Reset(isolate, jsCallback);
         context->asyncWork = std::move(asyncWork);
         context->asyncCompleteCallback = std::move(asyncCompleteCallback);
@@ -89,4 +134,15 @@ namespace {
         return context;
     }
 
+    void UpdateQueueDepthMetric(AsyncWorkPool pool) {
+        static const char* dimensionNames[] = { "pool" };
+        static auto metric = providers::GetMetricProvider().GetMetric(
+            "Zone", "AsyncWorkQueueDepth", providers::MetricType::Number, 1, dimensionNames);
+
+        if (metric != nullptr) {
+            const char* dimensionValues[] = { pool == AsyncWorkPool::CPU ? "cpu" : "io" };
+            metric->Set(static_cast<int64_t>(AsyncWorkers::GetInstance().GetQueueDepth(pool)), 1, dimensionValues);
+        }
+    }
+
 }   // End of anonymous namespace.
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "async-workers.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace napa::zone;
+
+constexpr uint32_t AsyncWorkers::DEFAULT_IO_WORKERS;
+
+AsyncWorkers& AsyncWorkers::GetInstance() {
+    // Never destroyed, so process exit doesn't wait for pending work.
+    static AsyncWorkers* asyncWorkers = new AsyncWorkers();
+    return *asyncWorkers;
+}
+
+AsyncWorkers::AsyncWorkers() {
+    for (auto type : { AsyncWorkPool::CPU, AsyncWorkPool::IO }) {
+        auto& pool = GetPool(type);
+        pool.workers = GetDefaultWorkers(type);
+        pool.queueDepth = 0;
+        pool.running = false;
+    }
+}
+
+void AsyncWorkers::Configure(AsyncWorkPool type, uint32_t workers) {
+    auto& pool = GetPool(type);
+    if (!pool.running) {
+        pool.workers = workers > 0 ? workers : GetDefaultWorkers(type);
+    }
+}
+
+void AsyncWorkers::Execute(AsyncWorkPool type, SimpleThreadPool::Job job) {
+    auto& pool = GetPool(type);
+    std::call_once(pool.started, [&pool]() {
+        pool.running = true;
+        pool.threads = std::make_unique<SimpleThreadPool>(pool.workers.load());
+    });
+
+    pool.queueDepth.fetch_add(1);
+    pool.threads->Execute([&pool, job = std::move(job)]() mutable {
+        pool.queueDepth.fetch_sub(1);
+        job();
+    });
+}
+
+size_t AsyncWorkers::GetQueueDepth(AsyncWorkPool type) const {
+    return GetPool(type).queueDepth;
+}
+
+uint32_t AsyncWorkers::GetWorkers(AsyncWorkPool type) const {
+    return GetPool(type).workers;
+}
+
+AsyncWorkers::Pool& AsyncWorkers::GetPool(AsyncWorkPool type) {
+    return _pools[type == AsyncWorkPool::CPU ? 0 : 1];
+}
+
+const AsyncWorkers::Pool& AsyncWorkers::GetPool(AsyncWorkPool type) const {
+    return _pools[type == AsyncWorkPool::CPU ? 0 : 1];
+}
+
+uint32_t AsyncWorkers::GetDefaultWorkers(AsyncWorkPool type) {
+    if (type == AsyncWorkPool::CPU) {
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    return DEFAULT_IO_WORKERS;
+}
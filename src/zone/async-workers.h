@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/zone/async-work-pool.h>
+
+#include <zone/simple-thread-pool.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Process-wide pools of threads that run the work posted by PostAsyncWork, one per AsyncWorkPool. </summary>
+    /// <remarks>
+    ///     Each pool starts its threads on first use, with the number of workers configured by then.
+    ///     Work beyond the number of workers queues up in the pool instead of starting more threads.
+    /// </remarks>
+    class AsyncWorkers {
+    public:
+
+        /// <summary> Default number of workers of the IO pool. </summary>
+        static constexpr uint32_t DEFAULT_IO_WORKERS = 16;
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static AsyncWorkers& GetInstance();
+
+        /// <summary> Constructor, with the default number of workers per pool. </summary>
+        AsyncWorkers();
+
+        /// <summary> Sets the number of workers of a pool, 0 for the default. It has no effect once the pool started. </summary>
+        void Configure(AsyncWorkPool pool, uint32_t workers);
+
+        /// <summary> Runs a job on a worker of the given pool. </summary>
+        void Execute(AsyncWorkPool pool, SimpleThreadPool::Job job);
+
+        /// <summary> Gets the number of jobs of a pool that didn't start yet. </summary>
+        size_t GetQueueDepth(AsyncWorkPool pool) const;
+
+        /// <summary> Gets the number of workers a pool has, or will start with. </summary>
+        uint32_t GetWorkers(AsyncWorkPool pool) const;
+
+    private:
+
+        /// <summary> Threads and counters of a pool. </summary>
+        struct Pool {
+            std::atomic<uint32_t> workers;
+            std::atomic<size_t> queueDepth;
+            std::atomic<bool> running;
+            std::once_flag started;
+            std::unique_ptr<SimpleThreadPool> threads;
+        };
+
+        Pool& GetPool(AsyncWorkPool pool);
+        const Pool& GetPool(AsyncWorkPool pool) const;
+
+        /// <summary> Gets the default number of workers of a pool. </summary>
+        static uint32_t GetDefaultWorkers(AsyncWorkPool pool);
+
+        Pool _pools[2];
+    };
+}
+}
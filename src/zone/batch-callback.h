@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/types.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Creates one callback per call of a batch, the batch callback fires once all of them were called. </summary>
+    /// <param name="count"> Number of calls in the batch. </param>
+    /// <param name="callback"> Receives the results in the order of calls. </param>
+    /// <remarks> For an empty batch, the callback is triggered immediately. </remarks>
+    inline std::vector<ExecuteCallback> CreateBatchCallbacks(size_t count, ExecuteBatchCallback callback) {
+        struct BatchState {
+            std::vector<Result> results;
+            std::atomic<size_t> remaining;
+            ExecuteBatchCallback callback;
+        };
+
+        std::vector<ExecuteCallback> callbacks;
+        if (count == 0) {
+            callback(std::vector<Result>());
+            return callbacks;
+        }
+
+        auto state = std::make_shared<BatchState>();
+        state->results.resize(count);
+        state->remaining = count;
+        state->callback = std::move(callback);
+
+        callbacks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            callbacks.emplace_back([state, i](Result result) {
+                state->results[i] = std::move(result);
+
+                // The last finished call reports the batch.
+                if (--state->remaining == 0) {
+                    state->callback(std::move(state->results));
+                }
+            });
+        }
+        return callbacks;
+    }
+
+    /// <summary> Creates one callback per call of a batch, which copies its result into caller-owned storage. </summary>
+    /// <param name="count"> Number of calls in the batch. </param>
+    /// <param name="results"> Caller-owned array of count results, in the order of calls. </param>
+    /// <param name="arena"> Caller-owned buffer for error messages and return values, whose 'used' is set before the callback. </param>
+    /// <param name="callback"> Triggered with results once all calls were done. </param>
+    /// <param name="context"> An opaque pointer that is passed back in the callback. </param>
+    /// <remarks>
+    ///     Strings are copied into the arena as calls finish, so nothing is kept per call until the batch is done.
+    ///     A result whose strings don't fit is reported as NAPA_RESULT_RESULT_ARENA_EXHAUSTED, with its transport context.
+    ///     For an empty batch, the callback is triggered immediately.
+    /// </remarks>
+    inline std::vector<ExecuteCallback> CreateArenaBatchCallbacks(
+        size_t count, 
+        napa_zone_result* results, 
+        napa_result_arena* arena, 
+        napa_zone_execute_batch_callback callback, 
+        void* context) {
+
+        struct BatchState {
+            napa_zone_result* results;
+            size_t count;
+            napa_result_arena* arena;
+            std::atomic<size_t> used;
+            std::atomic<size_t> remaining;
+            napa_zone_execute_batch_callback callback;
+            void* context;
+        };
+
+        std::vector<ExecuteCallback> callbacks;
+        if (count == 0) {
+            arena->used = 0;
+            callback(results, 0, context);
+            return callbacks;
+        }
+
+        auto state = std::make_shared<BatchState>();
+        state->results = results;
+        state->count = count;
+        state->arena = arena;
+        state->used = 0;
+        state->remaining = count;
+        state->callback = callback;
+        state->context = context;
+
+        callbacks.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            callbacks.emplace_back([state, i](Result result) {
+                auto& res = state->results[i];
+                res.code = result.code;
+                res.transport_context = reinterpret_cast<void*>(result.transportContext.release());
+                res.cpu_time = result.cpuTime;
+                res.allocated_bytes = result.allocatedBytes;
+                res.return_value_owner = nullptr;
+
+                // Space is reserved for both strings at once, a failed reservation leaves it to later results.
+                auto size = result.errorMessage.size() + result.returnValue.size();
+                auto offset = state->used.load();
+                while (offset + size <= state->arena->capacity 
+                    && !state->used.compare_exchange_weak(offset, offset + size)) {
+                }
+                if (offset + size <= state->arena->capacity) {
+                    auto data = state->arena->data + offset;
+                    std::memcpy(data, result.errorMessage.data(), result.errorMessage.size());
+                    std::memcpy(data + result.errorMessage.size(), result.returnValue.data(), result.returnValue.size());
+                    res.error_message = napa_string_ref { data, result.errorMessage.size() };
+                    res.return_value = napa_string_ref { data + result.errorMessage.size(), result.returnValue.size() };
+                } else {
+                    res.code = NAPA_RESULT_RESULT_ARENA_EXHAUSTED;
+                    res.error_message = NAPA_STRING_REF("The result doesn't fit in the result arena");
+                    res.return_value = EMPTY_NAPA_STRING_REF;
+                }
+
+                // The last finished call reports the batch.
+                if (--state->remaining == 0) {
+                    state->arena->used = state->used;
+                    state->callback(state->results, state->count, state->context);
+                }
+            });
+        }
+        return callbacks;
+    }
+}
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "broadcast-log.h"
+
+#include <algorithm>
+
+using namespace napa::zone;
+
+BroadcastLog::BroadcastLog(bool compaction, bool codeCache) :
+    _compaction(compaction),
+    _codeCache(codeCache),
+    _sequence(0) {}
+
+BroadcastLog::Entry BroadcastLog::Append(std::string source) {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    if (_compaction) {
+        auto iter = std::find_if(_entries.begin(), _entries.end(), [&source](const Entry& entry) {
+            return *entry.source == source;
+        });
+
+        if (iter != _entries.end()) {
+            auto entry = std::move(*iter);
+            entry.sequence = ++_sequence;
+            _entries.erase(iter);
+            _entries.push_back(entry);
+            return entry;
+        }
+    }
+
+    Entry entry { std::make_shared<const std::string>(std::move(source)), ++_sequence, _codeCache ? std::make_shared<CodeCache>() : nullptr };
+    _entries.push_back(entry);
+    return entry;
+}
+
+std::vector<BroadcastLog::Entry> BroadcastLog::GetEntries() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries;
+}
+
+size_t BroadcastLog::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _entries.size();
+}
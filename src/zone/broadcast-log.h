@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "code-cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Ordered history of the sources broadcast to a zone, replayed on workers created later. </summary>
+    /// <remarks>
+    ///     With compaction, broadcasting a source that is already logged moves it to the end of the log instead of
+    ///     logging it twice. It's only correct if broadcasts are idempotent, e.g. function or module definitions.
+    /// </remarks>
+    class BroadcastLog {
+    public:
+
+        /// <summary> A logged broadcast. </summary>
+        struct Entry {
+            /// <summary> The JS source code, shared by the log snapshots and the tasks that run it. </summary>
+            std::shared_ptr<const std::string> source;
+
+            /// <summary> Sequence number of the broadcast, increasing in log order starting from 1. </summary>
+            uint64_t sequence;
+
+            /// <summary> The code cache of the source, or nullptr when code caching is disabled. </summary>
+            std::shared_ptr<CodeCache> codeCache;
+        };
+
+        /// <summary> Constructor. </summary>
+        /// <param name="compaction"> Whether a source broadcast again replaces its earlier entry. </param>
+        /// <param name="codeCache"> Whether entries keep a code cache of their source. </param>
+        BroadcastLog(bool compaction, bool codeCache);
+
+        /// <summary> Non-copyable. </summary>
+        BroadcastLog(const BroadcastLog&) = delete;
+        BroadcastLog& operator=(const BroadcastLog&) = delete;
+
+        /// <summary> Appends a source to the log. </summary>
+        /// <returns> The logged entry, which shares the code cache of the replaced entry on compaction, but gets a new sequence number. </returns>
+        Entry Append(std::string source);
+
+        /// <summary> Gets a snapshot of the logged entries, in replay order. </summary>
+        std::vector<Entry> GetEntries() const;
+
+        /// <summary> Gets the number of logged entries. </summary>
+        size_t GetSize() const;
+
+    private:
+        bool _compaction;
+        bool _codeCache;
+        uint64_t _sequence;
+        std::vector<Entry> _entries;
+        mutable std::mutex _lock;
+    };
+}
+}
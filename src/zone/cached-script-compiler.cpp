@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "cached-script-compiler.h"
+
+#include <utils/debug.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+// CreateCodeCache(UnboundScript) caches functions compiled while running the script, not only the top level.
+#if (V8_MAJOR_VERSION == 6 && V8_MINOR_VERSION >= 8) || V8_MAJOR_VERSION > 6
+    #define NAPA_CREATE_CODE_CACHE_AFTER_RUN
+#endif
+
+CachedScriptCompiler::CachedScriptCompiler(std::shared_ptr<CodeCache> codeCache) :
+    _codeCache(std::move(codeCache)),
+    _produce(false) {}
+
+v8::MaybeLocal<v8::Script> CachedScriptCompiler::Compile(
+    v8::Local<v8::Context> context,
+    v8::Local<v8::String> source,
+    const v8::ScriptOrigin& origin) {
+
+    // Consume the code cache if another isolate produced it already, the source owns the cached data wrapper.
+    _cachedData = _codeCache != nullptr ? _codeCache->Get() : nullptr;
+    auto compileOptions = v8::ScriptCompiler::kNoCompileOptions;
+    v8::ScriptCompiler::CachedData* compilerCachedData = nullptr;
+    if (_cachedData != nullptr) {
+        compileOptions = v8::ScriptCompiler::kConsumeCodeCache;
+        compilerCachedData = new v8::ScriptCompiler::CachedData(
+            _cachedData->data(),
+            static_cast<int>(_cachedData->size()),
+            v8::ScriptCompiler::CachedData::BufferNotOwned);
+    }
+#ifndef NAPA_CREATE_CODE_CACHE_AFTER_RUN
+    else if (_codeCache != nullptr) {
+        compileOptions = v8::ScriptCompiler::kProduceCodeCache;
+    }
+#endif
+    _source = std::make_unique<v8::ScriptCompiler::Source>(source, origin, compilerCachedData);
+
+    auto script = v8::ScriptCompiler::Compile(context, _source.get(), compileOptions);
+    if (script.IsEmpty()) {
+        return script;
+    }
+
+    _produce = _codeCache != nullptr && _cachedData == nullptr;
+    if (_cachedData != nullptr && _source->GetCachedData()->rejected) {
+        // E.g. V8 flags changed, the source was compiled from scratch instead.
+        NAPA_DEBUG("CachedScriptCompiler", "Code cache was rejected");
+        _codeCache->Reject(_cachedData);
+        _produce = true;
+    }
+
+    return script;
+}
+
+bool CachedScriptCompiler::Produce(v8::Local<v8::Script> script) {
+    if (!_produce) {
+        return false;
+    }
+    _produce = false;
+
+#ifdef NAPA_CREATE_CODE_CACHE_AFTER_RUN
+    std::unique_ptr<v8::ScriptCompiler::CachedData> producedData(
+        v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript()));
+    auto produced = producedData.get();
+#else
+    auto produced = _source->GetCachedData();
+#endif
+    if (produced == nullptr || produced->length <= 0) {
+        return false;
+    }
+
+    NAPA_DEBUG("CachedScriptCompiler", "Code cache produced: %d bytes", produced->length);
+    return _codeCache->Set(CodeCache::Data(produced->data, produced->data + produced->length));
+}
+
+bool CachedScriptCompiler::Warm(v8::Local<v8::UnboundScript> script, CodeCache& codeCache) {
+#ifdef NAPA_CREATE_CODE_CACHE_AFTER_RUN
+    if (codeCache.IsWarm()) {
+        return false;
+    }
+
+    std::unique_ptr<v8::ScriptCompiler::CachedData> produced(v8::ScriptCompiler::CreateCodeCache(script));
+    if (produced == nullptr || produced->length <= 0) {
+        return false;
+    }
+
+    NAPA_DEBUG("CachedScriptCompiler", "Warm code cache produced: %d bytes", produced->length);
+    return codeCache.Warm(CodeCache::Data(produced->data, produced->data + produced->length));
+#else
+    // Caches of older V8 only hold what was compiled up front.
+    return false;
+#endif
+}
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "code-cache.h"
+
+#include <v8.h>
+
+#include <memory>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Compiles a script with a code cache, consuming the cache if available and producing it otherwise. </summary>
+    /// <remarks> Call Compile once, then Produce after the script ran successfully. </remarks>
+    class CachedScriptCompiler {
+    public:
+
+        /// <summary> Constructor. </summary>
+        /// <param name="codeCache"> The code cache of the script, it compiles without cache if null. </param>
+        explicit CachedScriptCompiler(std::shared_ptr<CodeCache> codeCache);
+
+        /// <summary> Compiles a script, the caller handles exceptions with a v8::TryCatch. </summary>
+        v8::MaybeLocal<v8::Script> Compile(v8::Local<v8::Context> context, v8::Local<v8::String> source, const v8::ScriptOrigin& origin);
+
+        /// <summary> Fills the code cache from a script that ran, if the cache wasn't consumed. </summary>
+        /// <returns> True if the code cache was filled by this call. </returns>
+        bool Produce(v8::Local<v8::Script> script);
+
+        /// <summary> Replaces a code cache with one created from a script that ran for a while, see CodeCache::Warm. </summary>
+        /// <returns> True if the code cache was replaced by this call. </returns>
+        static bool Warm(v8::Local<v8::UnboundScript> script, CodeCache& codeCache);
+
+    private:
+        std::shared_ptr<CodeCache> _codeCache;
+        std::shared_ptr<const CodeCache::Data> _cachedData;
+        std::unique_ptr<v8::ScriptCompiler::Source> _source;
+        bool _produce;
+    };
+}
+}
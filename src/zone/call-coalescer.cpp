@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "call-coalescer.h"
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Copies a result for a follower, which shares the leader's shared objects. </summary>
+    Result CopyResult(const Result& result) {
+        Result copy;
+        copy.code = result.code;
+        copy.errorMessage = result.errorMessage;
+        copy.returnValue = result.returnValue;
+        if (result.transportContext != nullptr) {
+            copy.transportContext = std::make_unique<napa::transport::TransportContext>();
+            copy.transportContext->SaveAll(*result.transportContext);
+        }
+
+        // Followers didn't run, the leader accounts for the resources.
+        return copy;
+    }
+}
+
+bool CallCoalescer::Attach(const ResultCache::Key& key, ExecuteCallback& callback) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto it = _calls.find(key);
+        if (it != _calls.end()) {
+            it->second.emplace_back(std::move(callback));
+            return true;
+        }
+        _calls.emplace(key, Followers());
+    }
+
+    callback = [self = shared_from_this(), key, callback = std::move(callback)](Result result) {
+        // Calls attaching from now on lead a new flight, as the result may be stale for them.
+        auto followers = self->Detach(key);
+        for (auto& follower : followers) {
+            follower(CopyResult(result));
+        }
+        callback(std::move(result));
+    };
+    return false;
+}
+
+size_t CallCoalescer::GetCount() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _calls.size();
+}
+
+CallCoalescer::Followers CallCoalescer::Detach(const ResultCache::Key& key) {
+    std::lock_guard<std::mutex> lock(_lock);
+    Followers followers;
+    auto it = _calls.find(key);
+    if (it != _calls.end()) {
+        followers.swap(it->second);
+        _calls.erase(it);
+    }
+    return followers;
+}
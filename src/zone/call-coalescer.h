@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "result-cache.h"
+
+#include <napa/types.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Identical calls in flight, which are run once and share the result of the first of them. </summary>
+    /// <remarks>
+    ///     Calls are identified by the key of the result cache. The first call leads, the others attach to it
+    ///     until it finishes, and get a copy of its result, including shared objects. They don't run, and so
+    ///     their own timeouts and cancellation tokens don't apply, only the leader's do.
+    ///     It's shared with the callbacks of leaders, which may outlive the zone.
+    /// </remarks>
+    class CallCoalescer : public std::enable_shared_from_this<CallCoalescer> {
+    public:
+
+        /// <summary> Attaches a call to an identical one in flight, or makes it lead. </summary>
+        /// <param name="key"> The key of the call. </param>
+        /// <param name="callback"> The callback of the call, which a leader's is wrapped to pass its result on. </param>
+        /// <returns> True if the call was attached and must not run, false if it leads. </returns>
+        bool Attach(const ResultCache::Key& key, ExecuteCallback& callback);
+
+        /// <summary> Gets the number of calls in flight that lead. </summary>
+        size_t GetCount() const;
+
+    private:
+        typedef std::vector<ExecuteCallback> Followers;
+
+        /// <summary> Removes the followers of a leader that finished. </summary>
+        Followers Detach(const ResultCache::Key& key);
+
+        mutable std::mutex _lock;
+        std::unordered_map<ResultCache::Key, Followers, ResultCache::KeyHash> _calls;
+    };
+}
+}
@@ -7,33 +7,116 @@
 #endif
 
 #include "call-context.h"
+#include "memory-usage.h"
+#include "worker-context.h"
+
+#include <platform/process.h>
 
 #include <utils/debug.h>
 
 #include <napa/log.h>
 #include <napa/v8-helpers.h>
 
+#include <cstring>
 #include <stdint.h>
 
 using namespace napa::zone;
 
+/// <summary> Copies a string into the buffer as a null terminated string, and advances the buffer position. </summary>
+static napa::StringRef CopyToBuffer(napa::StringRef str, char*& position) {
+    if (str.size > 0) {
+        std::memcpy(position, str.data, str.size);
+    }
+    position[str.size] = '\0';
+
+    auto copy = NAPA_STRING_REF_WITH_SIZE(position, str.size);
+    position += str.size + 1;
+    return copy;
+}
+
 CallContext::CallContext(const napa::FunctionSpec& spec, napa::ExecuteCallback callback) : 
-    _module(NAPA_STRING_REF_TO_STD_STRING(spec.module)),
-    _function(NAPA_STRING_REF_TO_STD_STRING(spec.function)),
-    _callback(callback),
-    _finished(false) {
+    _callback(std::move(callback)),
+    _finished(false),
+    _cpuTime(0),
+    _allocatedBytes(0),
+    _executingIsolate(nullptr),
+    _cancellationHandlerId(0),
+    _cancelled(false),
+    _executionCpuStart(0),
+    _executionHeapStart(0),
+    _sampled(false),
+    _workerId(UINT32_MAX),
+    _statsEntry(nullptr) {
 
     // Audit start time.
-    _startTime = std::chrono::high_resolution_clock::now();
-    
+    _startTime = Clock::Now();
+
+    // One allocation for all strings instead of one per string, this is on the hot path of each call.
+    // Large arguments are interned instead, so calls repeating them share one copy.
+    // Arguments handed over by the caller are neither, they are used where they are.
+    _argumentsOwner = spec.argumentsOwner;
+    auto bufferSize = spec.module.size + spec.function.size + spec.options.trace_id.size + 3;
+    if (_argumentsOwner == nullptr) {
+        for (auto& arg : spec.arguments) {
+            if (arg.size < PayloadInterner::MIN_PAYLOAD_SIZE) {
+                bufferSize += arg.size + 1;
+            }
+        }
+    }
+    _buffer.reset(new char[bufferSize]);
+
+    auto position = _buffer.get();
+    _module = CopyToBuffer(spec.module, position);
+    _function = CopyToBuffer(spec.function, position);
+
     _arguments.reserve(spec.arguments.size());
-    for (auto& arg : spec.arguments) {
-        _arguments.emplace_back(NAPA_STRING_REF_TO_STD_STRING(arg));
+    for (size_t i = 0; i < spec.arguments.size(); ++i) {
+        auto& arg = spec.arguments[i];
+        if (_argumentsOwner != nullptr) {
+            _arguments.emplace_back(arg);
+            continue;
+        }
+        if (arg.size < PayloadInterner::MIN_PAYLOAD_SIZE) {
+            _arguments.emplace_back(CopyToBuffer(arg, position));
+            continue;
+        }
+
+        if (_sharedArguments.empty()) {
+            _sharedArguments.resize(spec.arguments.size());
+        }
+        auto payload = PayloadInterner::GetInstance().Intern(arg.data, arg.size);
+
+        // std::string data is null terminated, same as the copied arguments.
+        _arguments.emplace_back(NAPA_STRING_REF_WITH_SIZE(payload->data.c_str(), payload->data.size()));
+        _sharedArguments[i] = std::move(payload);
     }
     _options = spec.options;
+    _options.trace_id = CopyToBuffer(spec.options.trace_id, position);
+
+    // The affinity key, worker class and tenant are not owned by the spec, don't keep them beyond scheduling.
+    _options.affinity_key = EMPTY_NAPA_STRING_REF;
+    _options.worker_class = EMPTY_NAPA_STRING_REF;
+    _options.tenant = EMPTY_NAPA_STRING_REF;
+
+    // Nor is the token, which is kept by a reference of the call instead.
+    if (spec.options.cancellation_token != nullptr) {
+        _cancellationToken = static_cast<CancellationToken*>(spec.options.cancellation_token)->shared_from_this();
+        _options.cancellation_token = nullptr;
+    }
+
+    // Take over the shared pointers of the transport context, if any.
+    if (spec.transportContext != nullptr) {
+        _transportContext = std::move(*spec.transportContext);
+        spec.transportContext.reset();
+    }
+}
 
-    // Pass ownership of the transport context.
-    _transportContext = std::move(spec.transportContext);
+std::unique_ptr<napa::transport::TransportContext> CallContext::ReleaseTransportContext() {
+    // Most calls don't carry shared objects, only allocate a context for the result when needed.
+    if (_transportContext.GetSharedCount() == 0) {
+        return nullptr;
+    }
+    return std::make_unique<napa::transport::TransportContext>(std::move(_transportContext));
 }
 
 bool CallContext::Resolve(std::string marshalledResult) {
@@ -42,14 +125,18 @@ bool CallContext::Resolve(std::string marshalledResult) {
         return false;
     }
 
-    NAPA_DEBUG("CallTask", "Call to \"%s.%s\" is resolved successfully.", _module.c_str(), _function.c_str());
+    NAPA_DEBUG("CallTask", "Call to \"%s.%s\" is resolved successfully.", _module.data, _function.data);
 
+    MarkPhase(CallPhase::FINISHED);
     _callback({ 
         NAPA_RESULT_SUCCESS, 
         "", 
         std::move(marshalledResult),
-        std::move(_transportContext) 
+        ReleaseTransportContext(),
+        static_cast<uint64_t>(GetCpuTime().count()),
+        GetAllocatedBytes()
     });
+    RecordSlowCall(NAPA_RESULT_SUCCESS);
     return true;
 }
 
@@ -59,9 +146,24 @@ bool CallContext::Reject(napa::ResultCode code, std::string reason) {
         return false;
     }
 
-    NAPA_DEBUG("CallTask", "Call to \"%s.%s\" was rejected: %s.", _module.c_str(), _function.c_str(), reason.c_str());
+    NAPA_DEBUG("CallTask", "Call to \"%s.%s\" was rejected: %s.", _module.data, _function.data, reason.c_str());
+
+    // Counted before the callback, so callers see the statistics of the calls they got results of.
+    auto statsEntry = _statsEntry.load(std::memory_order_acquire);
+    if (statsEntry != nullptr) {
+        statsEntry->RecordOutcome(code);
+    }
 
-    _callback({ code, reason, "", std::move(_transportContext) });
+    MarkPhase(CallPhase::FINISHED);
+    _callback({
+        code,
+        reason,
+        "",
+        ReleaseTransportContext(),
+        static_cast<uint64_t>(GetCpuTime().count()),
+        GetAllocatedBytes()
+    });
+    RecordSlowCall(code);
     return true;
 }
 
@@ -69,26 +171,175 @@ bool CallContext::IsFinished() const {
     return _finished;
 }
 
-const std::string& CallContext::GetModule() const {
+void CallContext::WatchCancellation(const std::shared_ptr<CallContext>& context) {
+    if (context->_cancellationToken == nullptr) {
+        return;
+    }
+    std::weak_ptr<CallContext> weakContext = context;
+    context->_cancellationHandlerId = context->_cancellationToken->Register([weakContext]() {
+        if (auto context = weakContext.lock()) {
+            context->Cancel();
+        }
+    });
+}
+
+void CallContext::Cancel() {
+    if (_finished) {
+        return;
+    }
+    _cancelled = true;
+    {
+        // A call can't terminate itself, e.g. when it cancels its own token, it's rejected instead.
+        std::lock_guard<std::mutex> lock(_executionLock);
+        if (_executingIsolate != nullptr && _executingIsolate != v8::Isolate::GetCurrent()) {
+            NAPA_DEBUG("CallTask", "Terminate cancelled call to \"%s.%s\".", _module.data, _function.data);
+            _executingIsolate->TerminateExecution();
+            return;
+        }
+    }
+    Reject(NAPA_RESULT_CANCELLED, "Cancelled by the caller");
+}
+
+bool CallContext::IsCancelled() const {
+    return _cancelled;
+}
+
+napa::StringRef CallContext::GetModule() const {
     return _module;
 }
 
-const std::string& CallContext::GetFunction() const {
+napa::StringRef CallContext::GetFunction() const {
     return _function;
 }
 
-const std::vector<std::string>& CallContext::GetArguments() const {
+const std::vector<napa::StringRef>& CallContext::GetArguments() const {
     return _arguments;
 }
 
+const std::shared_ptr<const void>& CallContext::GetArgumentsOwner() const {
+    return _argumentsOwner;
+}
+
+std::shared_ptr<const PayloadInterner::Payload> CallContext::GetSharedArgument(size_t index) const {
+    return index < _sharedArguments.size() ? _sharedArguments[index] : nullptr;
+}
+
 napa::transport::TransportContext& CallContext::GetTransportContext() {
-    return *_transportContext.get();
+    return _transportContext;
 }
 
 const napa::CallOptions& CallContext::GetOptions() const {
     return _options;
 }
 
+const char* CallContext::GetTraceId() const {
+    return _options.trace_id.data;
+}
+
+Clock::time_point CallContext::GetStartTime() const {
+    return _startTime;
+}
+
 std::chrono::nanoseconds CallContext::GetElapse() const {
-    return std::chrono::high_resolution_clock::now() - _startTime;
+    return Clock::Now() - _startTime;
+}
+
+napa::memory::ArenaAllocator& CallContext::GetArena() {
+    return _arena;
+}
+
+void CallContext::BeginExecution(v8::Isolate* isolate) {
+    {
+        std::lock_guard<std::mutex> lock(_executionLock);
+        _executingIsolate = isolate;
+    }
+    _executionCpuStart = napa::platform::GetThreadCpuTime();
+    _executionHeapStart = GetHeapAllocationCounter(isolate);
+    _executingThread = std::this_thread::get_id();
+}
+
+void CallContext::EndExecution() {
+    // Reading the usage on the executing thread includes the ongoing execution.
+    _cpuTime = GetCpuTime().count();
+    _allocatedBytes = GetAllocatedBytes();
+    _executingThread = std::thread::id();
+
+    {
+        std::lock_guard<std::mutex> lock(_executionLock);
+        _executingIsolate = nullptr;
+    }
+
+    // A call cancelled while it executed is rejected once it unwinds, unless it completed meanwhile.
+    if (_cancelled) {
+        Reject(NAPA_RESULT_CANCELLED, "Cancelled by the caller");
+    }
+}
+
+CallContext::~CallContext() {
+    if (_cancellationToken != nullptr && _cancellationHandlerId != 0) {
+        _cancellationToken->Unregister(_cancellationHandlerId);
+    }
+}
+
+std::chrono::nanoseconds CallContext::GetCpuTime() const {
+    auto cpuTime = _cpuTime.load();
+    if (_executingThread == std::this_thread::get_id()) {
+        cpuTime += napa::platform::GetThreadCpuTime() - _executionCpuStart;
+    }
+    return std::chrono::nanoseconds(cpuTime);
+}
+
+uint64_t CallContext::GetAllocatedBytes() const {
+    auto allocatedBytes = _allocatedBytes.load();
+    if (_executingThread == std::this_thread::get_id()) {
+        // Lazy sweeping may lower the counter below its starting point.
+        auto counter = GetHeapAllocationCounter(_executingIsolate);
+        if (counter > _executionHeapStart) {
+            allocatedBytes += counter - _executionHeapStart;
+        }
+    }
+    return allocatedBytes;
+}
+
+void CallContext::TimePhases(std::shared_ptr<SlowCallLog> log) {
+    for (auto& end : _phaseEnds) {
+        end.store(-1, std::memory_order_relaxed);
+    }
+    _sampled = log->Sample();
+    _slowCallLog = std::move(log);
+}
+
+void CallContext::MarkPhase(CallPhase phase) {
+    if (_slowCallLog != nullptr) {
+        _phaseEnds[static_cast<size_t>(phase)].store(GetElapse().count(), std::memory_order_relaxed);
+    }
+}
+
+void CallContext::MarkDequeued(uint32_t workerId, std::chrono::nanoseconds elapse) {
+    if (_slowCallLog != nullptr) {
+        _workerId.store(workerId, std::memory_order_relaxed);
+        _phaseEnds[static_cast<size_t>(CallPhase::DEQUEUED)].store(elapse.count(), std::memory_order_relaxed);
+    }
+}
+
+void CallContext::CountOutcome(FunctionStatsTable::Entry* entry, std::shared_ptr<const void> owner) {
+    _statsOwner = std::move(owner);
+    _statsEntry.store(entry, std::memory_order_release);
+}
+
+void CallContext::RecordSlowCall(napa::ResultCode code) {
+    if (_slowCallLog == nullptr) {
+        return;
+    }
+    MarkPhase(CallPhase::COMPLETED);
+
+    PhaseEnds ends;
+    for (size_t i = 0; i < ends.size(); ++i) {
+        ends[i] = _phaseEnds[i].load(std::memory_order_relaxed);
+    }
+    _slowCallLog->Record(_module.data, _function.data, _workerId.load(std::memory_order_relaxed), code, _sampled, _startTime, ends, _arguments);
+}
+
+napa::memory::ArenaAllocator* napa::memory::GetCallArena() {
+    return static_cast<ArenaAllocator*>(WorkerContext::Get(WorkerContextItem::CALL_ARENA));
 }
\ No newline at end of file
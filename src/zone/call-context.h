@@ -3,12 +3,23 @@
 
 #pragma once
 
+#include "cancellation-token.h"
+#include "clock.h"
+#include "function-stats.h"
+#include "payload-interner.h"
+#include "slow-call-log.h"
+
+#include <napa/memory/arena-allocator.h>
 #include <napa/types.h>
+#include <napa/transport/transport-context.h>
 #include <v8.h>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace napa {
@@ -36,14 +47,36 @@ namespace zone {
         /// <summary> Returns whether current job is completed or cancelled. </summary>
         bool IsFinished() const;
 
-        /// <summary> Get module name to load function. </summary>
-        const std::string& GetModule() const;
+        /// <summary> Cancels the call when the cancellation token of its options is cancelled, if it has one. </summary>
+        /// <param name="context"> The call context, which the token refers to weakly, since the token may outlive it. </param>
+        static void WatchCancellation(const std::shared_ptr<CallContext>& context);
+
+        /// <summary>
+        ///     Cancels the call. One that is executing is terminated, and rejected by its task once it unwinds.
+        ///     Otherwise it's rejected right away, and a queued call is dropped when its task is dequeued.
+        /// </summary>
+        void Cancel();
+
+        /// <summary> Returns whether the call was cancelled. </summary>
+        bool IsCancelled() const;
+
+        /// <summary> Get module name to load function. The string is null terminated. </summary>
+        napa::StringRef GetModule() const;
+
+        /// <summary> Get function name to execute. The string is null terminated. </summary>
+        napa::StringRef GetFunction() const;
 
-        /// <summary> Get function name to execute. </summary>
-        const std::string& GetFunction() const;
+        /// <summary> Get marshalled arguments, which stay valid for the life time of the call context. </summary>
+        /// <remarks> Arguments are null terminated, unless they are borrowed from the owner given by the caller. </remarks>
+        const std::vector<napa::StringRef>& GetArguments() const;
 
-        /// <summary> Get marshalled arguments. </summary>
-        const std::vector<std::string>& GetArguments() const;
+        /// <summary> Get the owner of arguments given by the caller, or nullptr if arguments were copied. </summary>
+        /// <remarks> The owner may outlive the call context, e.g. when arguments back V8 strings. </remarks>
+        const std::shared_ptr<const void>& GetArgumentsOwner() const;
+
+        /// <summary> Get the interned payload of an argument, or nullptr if the argument is too small to be interned. </summary>
+        /// <remarks> The payload may outlive the call context, e.g. when it backs a V8 string. </remarks>
+        std::shared_ptr<const PayloadInterner::Payload> GetSharedArgument(size_t index) const;
 
         /// <summary> Get transport context. </summary>
         napa::transport::TransportContext& GetTransportContext();
@@ -51,24 +84,84 @@ namespace zone {
         /// <summary> Get options. </summary>
         const napa::CallOptions& GetOptions() const;
 
+        /// <summary> Get the trace id of the call, an empty string if it has none. The string is null terminated. </summary>
+        const char* GetTraceId() const;
+
+        /// <summary> Get the time the call was created. </summary>
+        Clock::time_point GetStartTime() const;
+
         /// <summary> Get elapse since task start in nano-second. </summary>
         std::chrono::nanoseconds GetElapse() const;
 
+        /// <summary> Get the arena of this call, whose memory is freed when the call context is destroyed. </summary>
+        napa::memory::ArenaAllocator& GetArena();
+
+        /// <summary> Starts accounting CPU time and V8 heap allocations of the calling thread to this call. </summary>
+        /// <param name="isolate"> The isolate the call executes in, which must be entered by the calling thread. </param>
+        void BeginExecution(v8::Isolate* isolate);
+
+        /// <summary> Stops accounting, adding the usage since BeginExecution to the usage of the call. </summary>
+        void EndExecution();
+
+        /// <summary> Destructor, which unregisters from the cancellation token. </summary>
+        ~CallContext();
+
+        /// <summary> Get CPU time the call consumed so far while it executed. </summary>
+        std::chrono::nanoseconds GetCpuTime() const;
+
+        /// <summary> Get an estimate of bytes the call allocated so far on the V8 heap while it executed. </summary>
+        uint64_t GetAllocatedBytes() const;
+
+        /// <summary> Times the phases of the call, which the slow-call log records once the call completes. </summary>
+        /// <param name="log"> The slow-call log of the zone, which counts the call for sampling. </param>
+        void TimePhases(std::shared_ptr<SlowCallLog> log);
+
+        /// <summary> Marks the end of a phase at the current time, if phases are timed. </summary>
+        void MarkPhase(CallPhase phase);
+
+        /// <summary> Marks the end of the queue wait as a worker picks up the call, if phases are timed. </summary>
+        /// <param name="workerId"> The id of the worker. </param>
+        /// <param name="elapse"> The elapse since the call was created, as the worker read it. </param>
+        void MarkDequeued(uint32_t workerId, std::chrono::nanoseconds elapse);
+
+        /// <summary> Counts the call on the statistics of its function if it fails, as it may finish on another thread. </summary>
+        /// <param name="entry"> The entry of the function on the worker running the call. </param>
+        /// <param name="owner"> The owner of the entry, which the call keeps alive. </param>
+        void CountOutcome(FunctionStatsTable::Entry* entry, std::shared_ptr<const void> owner);
+
     private:
+        /// <summary> Moves the shared pointers to a transport context for the result, or returns nullptr if there is none. </summary>
+        std::unique_ptr<napa::transport::TransportContext> ReleaseTransportContext();
+
+        /// <summary> Records the call to the slow-call log once its callback returned, if phases are timed. </summary>
+        void RecordSlowCall(napa::ResultCode code);
+
+        /// <summary> Module name, function name and arguments copied into a single allocation. </summary>
+        std::unique_ptr<char[]> _buffer;
+
         /// <summary> Module name. </summary>
-        std::string _module;
+        napa::StringRef _module;
 
         /// <summary> Function name. </summary>
-        std::string _function;
+        napa::StringRef _function;
 
         /// <summary> Arguments. </summary>
-        std::vector<std::string> _arguments;
+        std::vector<napa::StringRef> _arguments;
+
+        /// <summary> Owner of the memory of arguments given by the caller, whose arguments are borrowed instead of copied. </summary>
+        std::shared_ptr<const void> _argumentsOwner;
+
+        /// <summary> Interned payloads of large arguments by argument index, empty if no argument is interned. </summary>
+        std::vector<std::shared_ptr<const PayloadInterner::Payload>> _sharedArguments;
 
         /// <summary> Execute options. </summary>
         napa::CallOptions _options;
 
-        /// <summary> Transport context. </summary>
-        std::unique_ptr<napa::transport::TransportContext> _transportContext;
+        /// <summary> Transport context, embedded to save an allocation per call. </summary>
+        napa::transport::TransportContext _transportContext;
+
+        /// <summary> Arena for native modules, which allocates its first chunk on first use. </summary>
+        napa::memory::ArenaAllocator _arena;
 
          /// <summary> Callback when task completes. </summary>
         napa::ExecuteCallback _callback;
@@ -77,7 +170,49 @@ namespace zone {
         std::atomic<bool> _finished;
 
         /// <summary> Call start time. </summary>
-        std::chrono::high_resolution_clock::time_point _startTime;
+        Clock::time_point _startTime;
+
+        /// <summary> CPU time in nano-seconds of executions which ended. </summary>
+        std::atomic<int64_t> _cpuTime;
+
+        /// <summary> Bytes allocated on the V8 heap by executions which ended. </summary>
+        std::atomic<uint64_t> _allocatedBytes;
+
+        /// <summary> The thread executing the call, which alone reads the starting points below, or no thread. </summary>
+        std::atomic<std::thread::id> _executingThread;
+
+        /// <summary> The isolate of the ongoing execution, guarded by _executionLock for cancellation. </summary>
+        v8::Isolate* _executingIsolate;
+
+        /// <summary> Guards the executing isolate against termination by cancellation after the execution ended. </summary>
+        std::mutex _executionLock;
+
+        /// <summary> Token of cancellation, and the id of the handler registered by WatchCancellation. </summary>
+        std::shared_ptr<CancellationToken> _cancellationToken;
+        CancellationToken::HandlerId _cancellationHandlerId;
+
+        /// <summary> Whether the call was cancelled. </summary>
+        std::atomic<bool> _cancelled;
+
+        /// <summary> Thread CPU time when the ongoing execution began. </summary>
+        int64_t _executionCpuStart;
+
+        /// <summary> Heap allocation counter when the ongoing execution began. </summary>
+        uint64_t _executionHeapStart;
+
+        /// <summary> The slow-call log of the zone when phases are timed, or nullptr. </summary>
+        std::shared_ptr<SlowCallLog> _slowCallLog;
+
+        /// <summary> Whether the slow-call log sampled the call, and the worker which ran it. </summary>
+        bool _sampled;
+        std::atomic<uint32_t> _workerId;
+
+        /// <summary> Nano-seconds from the start to the end of each phase, negative until reached. </summary>
+        std::array<std::atomic<int64_t>, static_cast<size_t>(CallPhase::COUNT)> _phaseEnds;
+
+        /// <summary> The entry counting the outcome of the call once a worker picked it up, and the owner of the entry. </summary>
+        std::atomic<FunctionStatsTable::Entry*> _statsEntry;
+        std::shared_ptr<const void> _statsOwner;
     };
 }
 }
\ No newline at end of file
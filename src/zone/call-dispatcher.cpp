@@ -0,0 +1,360 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "call-dispatcher.h"
+
+#include "tracing.h"
+#include "transport-accounting.h"
+#include "worker-context.h"
+
+#include <module/core-modules/napa/call-context-wrap.h>
+#include <module/loader/module-versions.h>
+#include <utils/text-search.h>
+
+#include <napa/v8-helpers.h>
+
+#include <cstring>
+
+using namespace napa;
+using namespace napa::zone;
+using namespace napa::v8_helpers;
+
+namespace {
+
+    /// <summary> Deepest nesting of a plain result, beyond which it may be circular and goes through JavaScript. </summary>
+    constexpr int MAX_PLAIN_DEPTH = 32;
+
+    /// <summary> Marker of Transportable objects and functions in JSON payloads, see lib/transport. </summary>
+    constexpr const char* CID_KEY = "\"_cid\"";
+
+    bool IsGlobalModule(const StringRef& module) {
+        return module.size == 0 || (module.size == 6 && std::memcmp(module.data, "global", 6) == 0);
+    }
+
+    bool Contains(const StringRef& text, const char* pattern) {
+        return utils::text::Contains(text.data, text.size, pattern, std::strlen(pattern));
+    }
+
+}   // End of anonymous namespace.
+
+CallDispatcher* CallDispatcher::Get() {
+    auto dispatcher = static_cast<CallDispatcher*>(WorkerContext::Get(WorkerContextItem::CALL_DISPATCHER));
+    if (dispatcher == nullptr) {
+        dispatcher = new CallDispatcher(v8::Isolate::GetCurrent());
+        WorkerContext::Set(WorkerContextItem::CALL_DISPATCHER, dispatcher);
+    }
+    return dispatcher;
+}
+
+void CallDispatcher::Destroy() {
+    auto dispatcher = static_cast<CallDispatcher*>(WorkerContext::Get(WorkerContextItem::CALL_DISPATCHER));
+    WorkerContext::Set(WorkerContextItem::CALL_DISPATCHER, nullptr);
+    delete dispatcher;
+}
+
+CallDispatcher::CallDispatcher(v8::Isolate* isolate) : _isolate(isolate), _moduleGeneration(0) {
+    v8::HandleScope scope(isolate);
+    _objectPrototype.Reset(isolate, v8::Object::New(isolate)->GetPrototype());
+}
+
+void CallDispatcher::Dispatch(const std::shared_ptr<CallContext>& call, v8::TryCatch& tryCatch) {
+    auto context = _isolate->GetCurrentContext();
+
+    v8::Local<v8::Function> function;
+    std::vector<v8::Local<v8::Value>> args;
+    auto native = call->GetOptions().transport != TransportOption::BINARY
+        && !Tracing::IsEnabled()
+        && !TransportAccounting::IsEnabled()
+        && ParseArguments(*call, args)
+        && ResolveFunction(*call, function);
+
+    if (!native) {
+        auto callFunction = GetGlobalFunction(_callFunction, "__napa_zone_call__");
+        JS_ENSURE(_isolate, !callFunction.IsEmpty(), "__napa_zone_call__ function must exist in global scope");
+
+        CallWithContextWrap(callFunction, call, v8::Local<v8::Value>());
+        return;
+    }
+
+    call->MarkPhase(CallPhase::UNMARSHALLED);
+
+    // Functions are called as module functions are by __napa_zone_call__, without a receiver.
+    v8::Local<v8::Value> result;
+    if (!function->Call(context, v8::Undefined(_isolate), static_cast<int>(args.size()), args.data()).ToLocal(&result)) {
+        RejectWithException(*call, tryCatch);
+        return;
+    }
+
+    Finish(call, result, tryCatch);
+}
+
+bool CallDispatcher::ResolveFunction(const CallContext& call, v8::Local<v8::Function>& function) {
+    auto context = _isolate->GetCurrentContext();
+    auto module = call.GetModule();
+    auto functionName = call.GetFunction();
+
+    // Global functions are looked up every call, along their path of names like 'foo.bar'.
+    if (IsGlobalModule(module)) {
+        v8::Local<v8::Value> value = context->Global();
+        size_t start = 0;
+        while (start < functionName.size) {
+            auto end = start;
+            while (end < functionName.size && functionName.data[end] != '.') {
+                ++end;
+            }
+            auto name = v8::String::NewFromUtf8(
+                _isolate, functionName.data + start, v8::NewStringType::kInternalized, static_cast<int>(end - start));
+            if (!value->IsObject() || name.IsEmpty() || !value.As<v8::Object>()->Get(context, name.ToLocalChecked()).ToLocal(&value)) {
+                return false;
+            }
+            start = end + 1;
+        }
+        if (!value->IsFunction()) {
+            return false;
+        }
+        function = value.As<v8::Function>();
+        return true;
+    }
+
+    // Functions of an invalidated module are resolved again from the module loaded anew.
+    auto moduleGeneration = module::ModuleVersions::GetInstance().GetGeneration();
+    if (moduleGeneration != _moduleGeneration) {
+        _functions.clear();
+        _moduleGeneration = moduleGeneration;
+    }
+
+    _key.assign(module.data, module.size).append(1, '\n').append(functionName.data, functionName.size);
+    auto iter = _functions.find(_key);
+    if (iter != _functions.end()) {
+        function = v8::Local<v8::Function>::New(_isolate, iter->second);
+        return true;
+    }
+
+    auto resolveFunction = GetGlobalFunction(_resolveFunction, "__napa_zone_resolve__");
+    if (resolveFunction.IsEmpty()) {
+        return false;
+    }
+
+    v8::Local<v8::Value> argv[] = {
+        MakeV8String(_isolate, module.data, static_cast<int>(module.size)),
+        MakeV8String(_isolate, functionName.data, static_cast<int>(functionName.size))
+    };
+    v8::Local<v8::Value> resolved;
+    if (!resolveFunction->Call(context, v8::Undefined(_isolate), 2, argv).ToLocal(&resolved) || !resolved->IsFunction()) {
+        // A function that fails to resolve is left to __napa_zone_call__, which rejects the call with the reason.
+        return false;
+    }
+
+    function = resolved.As<v8::Function>();
+    _functions.emplace(std::piecewise_construct, std::forward_as_tuple(_key), std::forward_as_tuple(_isolate, function));
+    return true;
+}
+
+bool CallDispatcher::ParseArguments(const CallContext& call, std::vector<v8::Local<v8::Value>>& args) {
+    auto context = _isolate->GetCurrentContext();
+    auto& arguments = call.GetArguments();
+
+    args.reserve(arguments.size());
+    for (auto& argument : arguments) {
+        if (argument.size == 9 && std::memcmp(argument.data, "undefined", 9) == 0) {
+            args.push_back(v8::Undefined(_isolate));
+            continue;
+        }
+
+        // Transportable objects, functions and schema payloads need the reviver of transport.unmarshall.
+        if (Contains(argument, CID_KEY)) {
+            return false;
+        }
+
+        v8::TryCatch tryCatch(_isolate);
+        v8::Local<v8::Value> value;
+        if (!v8::JSON::Parse(context, MakeExternalV8String(_isolate, argument.data, argument.size)).ToLocal(&value)) {
+            return false;
+        }
+        args.push_back(value);
+    }
+    return true;
+}
+
+bool CallDispatcher::IsPlain(v8::Local<v8::Context> context, v8::Local<v8::Value> value, int depth) {
+    if (value->IsUndefined() || value->IsNull() || value->IsBoolean() || value->IsNumber() || value->IsString()) {
+        return true;
+    }
+    if (depth >= MAX_PLAIN_DEPTH || !value->IsObject() || value->IsFunction() || value->IsProxy()) {
+        return false;
+    }
+
+    auto object = value.As<v8::Object>();
+    v8::Local<v8::Value> element;
+    if (value->IsArray()) {
+        auto array = value.As<v8::Array>();
+        for (uint32_t i = 0; i < array->Length(); ++i) {
+            if (!array->Get(context, i).ToLocal(&element) || !IsPlain(context, element, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Only objects of Object, which transport.marshall stringifies as is.
+    if (object->InternalFieldCount() > 0 || !object->GetPrototype()->StrictEquals(v8::Local<v8::Value>::New(_isolate, _objectPrototype))) {
+        return false;
+    }
+    v8::Local<v8::Array> names;
+    if (!object->GetOwnPropertyNames(context).ToLocal(&names)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < names->Length(); ++i) {
+        v8::Local<v8::Value> name;
+        if (!names->Get(context, i).ToLocal(&name)
+            || !object->Get(context, name).ToLocal(&element)
+            || !IsPlain(context, element, depth + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CallDispatcher::Finish(const std::shared_ptr<CallContext>& call, v8::Local<v8::Value> result, v8::TryCatch& tryCatch) {
+    auto context = _isolate->GetCurrentContext();
+
+    if (result->IsPromise()) {
+        FinishPromise(call, result.As<v8::Promise>(), tryCatch);
+        return;
+    }
+    call->MarkPhase(CallPhase::EXECUTED);
+
+    if (!IsPlain(context, result, 0)) {
+        auto finishFunction = GetGlobalFunction(_finishFunction, "__napa_zone_finish__");
+        JS_ENSURE(_isolate, !finishFunction.IsEmpty(), "__napa_zone_finish__ function must exist in global scope");
+
+        CallWithContextWrap(finishFunction, call, result);
+        return;
+    }
+
+    // JSON.stringify returns undefined for undefined, which transport.unmarshall takes as "undefined".
+    if (result->IsUndefined()) {
+        call->Resolve("undefined");
+        return;
+    }
+
+    v8::Local<v8::String> json;
+    if (!v8::JSON::Stringify(context, result).ToLocal(&json)) {
+        RejectWithException(*call, tryCatch);
+        return;
+    }
+
+    std::string payload;
+    WriteUtf8(json, payload);
+    call->Resolve(std::move(payload));
+}
+
+void CallDispatcher::FinishPromise(const std::shared_ptr<CallContext>& call, v8::Local<v8::Promise> promise, v8::TryCatch& tryCatch) {
+    // Promises of async functions are mostly settled once they return, as microtasks ran when the call returned.
+    switch (promise->State()) {
+        case v8::Promise::kFulfilled:
+            Finish(call, promise->Result(), tryCatch);
+            return;
+
+        case v8::Promise::kRejected: {
+            v8::String::Utf8Value reason(promise->Result());
+            call->Reject(NAPA_RESULT_EXECUTE_FUNC_ERROR, std::string(*reason, reason.length()));
+            return;
+        }
+
+        default:
+            break;
+    }
+
+    // The wrap keeps the call alive until the promise settles, or is collected if it never does.
+    auto context = _isolate->GetCurrentContext();
+    auto contextWrap = napa::module::CallContextWrap::NewInstance(call);
+
+    v8::Local<v8::Function> onFulfilled;
+    v8::Local<v8::Function> onRejected;
+    v8::Local<v8::Promise> fulfilled;
+    if (!v8::Function::New(context, OnPromiseFulfilled, contextWrap, 1).ToLocal(&onFulfilled)
+        || !v8::Function::New(context, OnPromiseRejected, contextWrap, 1).ToLocal(&onRejected)
+        || !promise->Then(context, onFulfilled).ToLocal(&fulfilled)
+        || fulfilled->Catch(context, onRejected).IsEmpty()) {
+        RejectWithException(*call, tryCatch);
+    }
+}
+
+void CallDispatcher::OnPromiseFulfilled(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto isolate = args.GetIsolate();
+    auto contextWrap = NAPA_OBJECTWRAP::Unwrap<napa::module::CallContextWrap>(args.Data().As<v8::Object>());
+    auto call = contextWrap->Get<CallContext>();
+    auto dispatcher = Get();
+
+    // Spans and transport costs of marshalling results are recorded by '__napa_zone_finish__'.
+    if (Tracing::IsEnabled() || TransportAccounting::IsEnabled()) {
+        auto finishFunction = dispatcher->GetGlobalFunction(dispatcher->_finishFunction, "__napa_zone_finish__");
+        JS_ENSURE(isolate, !finishFunction.IsEmpty(), "__napa_zone_finish__ function must exist in global scope");
+
+        dispatcher->CallWithContextWrap(finishFunction, call, args[0]);
+        return;
+    }
+
+    v8::TryCatch tryCatch(isolate);
+    dispatcher->Finish(call, args[0], tryCatch);
+}
+
+void CallDispatcher::OnPromiseRejected(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    auto contextWrap = NAPA_OBJECTWRAP::Unwrap<napa::module::CallContextWrap>(args.Data().As<v8::Object>());
+
+    v8::String::Utf8Value reason(args[0]);
+    contextWrap->GetRef().Reject(NAPA_RESULT_EXECUTE_FUNC_ERROR, std::string(*reason, reason.length()));
+}
+
+void CallDispatcher::RejectWithException(CallContext& call, v8::TryCatch& tryCatch) {
+    // Termination is left to the caller, i.e. CallTask rejects for timeout or cancellation.
+    if (!tryCatch.HasTerminated()) {
+        v8::String::Utf8Value reason(tryCatch.Exception());
+        call.Reject(NAPA_RESULT_EXECUTE_FUNC_ERROR, std::string(*reason, reason.length()));
+        tryCatch.Reset();
+    }
+}
+
+v8::Local<v8::Function> CallDispatcher::GetGlobalFunction(v8::Global<v8::Function>& cache, const char* name) {
+    if (cache.IsEmpty()) {
+        auto context = _isolate->GetCurrentContext();
+        v8::Local<v8::Value> function;
+        if (!context->Global()->Get(context, MakeExternalV8String(_isolate, name)).ToLocal(&function) || !function->IsFunction()) {
+            return v8::Local<v8::Function>();
+        }
+        cache.Reset(_isolate, function.As<v8::Function>());
+    }
+    return v8::Local<v8::Function>::New(_isolate, cache);
+}
+
+void CallDispatcher::CallWithContextWrap(
+    v8::Local<v8::Function> function,
+    const std::shared_ptr<CallContext>& call,
+    v8::Local<v8::Value> result) {
+
+    auto context = _isolate->GetCurrentContext();
+
+    // The wrap is taken out while in use, so a call nested by running microtasks gets its own.
+    v8::Local<v8::Object> contextWrap;
+    if (_contextWrap.IsEmpty()) {
+        contextWrap = napa::module::CallContextWrap::NewInstance(call);
+    } else {
+        contextWrap = v8::Local<v8::Object>::New(_isolate, _contextWrap);
+        _contextWrap.Reset();
+        NAPA_OBJECTWRAP::Unwrap<napa::module::CallContextWrap>(contextWrap)->Reset(call);
+    }
+
+    v8::Local<v8::Value> argv[] = { contextWrap, result };
+    if (function->Call(context, context->Global(), result.IsEmpty() ? 1 : 2, argv).IsEmpty()) {
+        // The exception is left to the caller, a wrap that may still be referenced isn't reused.
+        return;
+    }
+
+    // The call is released rather than kept alive by the wrap until the next call.
+    auto wrap = NAPA_OBJECTWRAP::Unwrap<napa::module::CallContextWrap>(contextWrap);
+    if (wrap->IsSettled() && _contextWrap.IsEmpty()) {
+        wrap->Reset(nullptr);
+        _contextWrap.Reset(_isolate, contextWrap);
+    }
+}
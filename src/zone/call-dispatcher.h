@@ -0,0 +1,107 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "call-context.h"
+
+#include <v8.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Dispatches calls to their functions in the current isolate, natively when their values are plain JSON. </summary>
+    /// <remarks>
+    ///     Functions are resolved once per isolate by module and function name through '__napa_zone_resolve__', and again
+    ///     after a module is invalidated, except global functions, which broadcasts may redefine and are looked up on
+    ///     the global object every call.
+    ///     Arguments are parsed with V8's JSON parser and the function is called directly. A result of plain objects,
+    ///     arrays and primitives is stringified natively, so is the value of a native promise, which is awaited natively.
+    ///     Any other result goes to '__napa_zone_finish__' to be marshalled or awaited. Calls which need the transport of lib/transport, i.e. with binary transport, Transportable objects
+    ///     or functions among their arguments, or while tracing or transport accounting is enabled, and calls whose function fails to resolve
+    ///     go through '__napa_zone_call__' as a whole.
+    /// </remarks>
+    class CallDispatcher {
+    public:
+
+        /// <summary> Gets the dispatcher of the calling thread's isolate, creating it on first use. </summary>
+        static CallDispatcher* Get();
+
+        /// <summary> Destroys the dispatcher of the calling thread if any, before its isolate is disposed. </summary>
+        static void Destroy();
+
+        /// <summary> Runs a call to completion, or until it awaits a promise. </summary>
+        /// <param name="call"> The call, which is resolved or rejected unless it awaits. </param>
+        /// <param name="tryCatch"> The caller's TryCatch, which is left with termination, if any, for the caller to handle. </param>
+        void Dispatch(const std::shared_ptr<CallContext>& call, v8::TryCatch& tryCatch);
+
+    private:
+
+        explicit CallDispatcher(v8::Isolate* isolate);
+
+        /// <summary> Resolves the function of a call. </summary>
+        /// <returns> False if the function isn't resolved, e.g. if the module has no such function. </returns>
+        bool ResolveFunction(const CallContext& call, v8::Local<v8::Function>& function);
+
+        /// <summary> Parses the arguments of a call. </summary>
+        /// <returns> False if an argument isn't plain JSON. </returns>
+        bool ParseArguments(const CallContext& call, std::vector<v8::Local<v8::Value>>& args);
+
+        /// <summary> Whether a value is stringified by JSON.stringify the same as by transport.marshall. </summary>
+        bool IsPlain(v8::Local<v8::Context> context, v8::Local<v8::Value> value, int depth);
+
+        /// <summary> Resolves or rejects a call with the value its function returned. </summary>
+        void Finish(const std::shared_ptr<CallContext>& call, v8::Local<v8::Value> result, v8::TryCatch& tryCatch);
+
+        /// <summary> Finishes a call with the outcome of a promise, right away if it's settled. </summary>
+        void FinishPromise(const std::shared_ptr<CallContext>& call, v8::Local<v8::Promise> promise, v8::TryCatch& tryCatch);
+
+        /// <summary> Handlers of a pending promise that a call returned, with a call context wrap as data. </summary>
+        static void OnPromiseFulfilled(const v8::FunctionCallbackInfo<v8::Value>& args);
+        static void OnPromiseRejected(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+        /// <summary> Rejects a call with the exception it threw, unless it was terminated. </summary>
+        static void RejectWithException(CallContext& call, v8::TryCatch& tryCatch);
+
+        /// <summary> Gets a function set on the global object by lib/zone, or an empty handle if there is none. </summary>
+        v8::Local<v8::Function> GetGlobalFunction(v8::Global<v8::Function>& cache, const char* name);
+
+        /// <summary> Calls '__napa_zone_call__' or '__napa_zone_finish__' with a wrap of the call and extra arguments. </summary>
+        /// <remarks>
+        ///     The wrap is reused for the next call once JavaScript resolved or rejected the call through it. A wrap that
+        ///     JavaScript may still use, e.g. once a promise settles, is left to it and the next call gets a new one.
+        /// </remarks>
+        void CallWithContextWrap(
+            v8::Local<v8::Function> function,
+            const std::shared_ptr<CallContext>& call,
+            v8::Local<v8::Value> result);
+
+        v8::Isolate* _isolate;
+
+        v8::Global<v8::Function> _callFunction;
+        v8::Global<v8::Function> _resolveFunction;
+        v8::Global<v8::Function> _finishFunction;
+
+        /// <summary> Call context wrap released by the previous call, empty while a call uses it. </summary>
+        v8::Global<v8::Object> _contextWrap;
+
+        /// <summary> Prototype of plain objects, in the context of the isolate. </summary>
+        v8::Global<v8::Value> _objectPrototype;
+
+        /// <summary> Resolved functions, keyed by module and function name. </summary>
+        std::unordered_map<std::string, v8::Global<v8::Function>> _functions;
+
+        /// <summary> Number of module invalidations in the process when functions were resolved, see ModuleVersions. </summary>
+        uint64_t _moduleGeneration;
+
+        /// <summary> Buffer of the key of the last lookup, kept to not allocate on every call. </summary>
+        std::string _key;
+    };
+}
+}
@@ -0,0 +1,200 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "call-recorder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+using namespace napa::zone;
+
+std::atomic<bool> CallRecorder::_enabled(false);
+
+namespace {
+
+    const char HEADER[] = "NAPACAP1";
+    const size_t HEADER_LENGTH = sizeof(HEADER) - 1;
+
+    const char NAME_TAG = 'N';
+    const char CALL_TAG = 'C';
+
+    /// <summary> Size of the buffer of records, which is written once it's full. </summary>
+    const size_t BLOCK_SIZE = 64 * 1024;
+
+    /// <summary> The capture in progress, all fields are guarded by the lock. </summary>
+    struct Capture {
+        std::mutex lock;
+        FILE* file = nullptr;
+        Clock::time_point start;
+        std::unordered_map<std::string, uint64_t> names;
+        std::string buffer;
+    };
+
+    Capture& GetCapture() {
+        static Capture capture;
+        return capture;
+    }
+
+    void AppendVarint(std::string& buffer, uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    /// <summary> Gets the id of a name, defining it in the buffer on first use. Called under the lock. </summary>
+    uint64_t GetNameId(Capture& capture, const char* name, size_t length) {
+        std::string key(name, length);
+        auto it = capture.names.find(key);
+        if (it != capture.names.end()) {
+            return it->second;
+        }
+
+        auto id = static_cast<uint64_t>(capture.names.size());
+        capture.buffer.push_back(NAME_TAG);
+        AppendVarint(capture.buffer, id);
+        AppendVarint(capture.buffer, length);
+        capture.buffer.append(name, length);
+        capture.names.emplace(std::move(key), id);
+        return id;
+    }
+
+    /// <summary> Writes out buffered records. Called under the lock. </summary>
+    void Flush(Capture& capture) {
+        if (!capture.buffer.empty()) {
+            fwrite(capture.buffer.data(), 1, capture.buffer.size(), capture.file);
+            capture.buffer.clear();
+        }
+    }
+
+    /// <summary> Reads a varint, returning false at the end of the data. </summary>
+    bool ReadVarint(const std::string& data, size_t& offset, uint64_t& value) {
+        value = 0;
+        for (uint32_t shift = 0; offset < data.size() && shift < 64; shift += 7) {
+            auto byte = static_cast<uint8_t>(data[offset++]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+bool CallRecorder::Start(const std::string& path) {
+    Stop();
+
+    auto& capture = GetCapture();
+    std::lock_guard<std::mutex> lock(capture.lock);
+
+    capture.file = fopen(path.c_str(), "wb");
+    if (capture.file == nullptr) {
+        return false;
+    }
+
+    capture.start = Clock::Now();
+    capture.names.clear();
+    capture.buffer.assign(HEADER, HEADER_LENGTH);
+    _enabled = true;
+    return true;
+}
+
+void CallRecorder::Stop() {
+    auto& capture = GetCapture();
+    std::lock_guard<std::mutex> lock(capture.lock);
+
+    _enabled = false;
+    if (capture.file != nullptr) {
+        Flush(capture);
+        fclose(capture.file);
+        capture.file = nullptr;
+    }
+}
+
+void CallRecorder::Record(
+    const std::string& zoneId,
+    const char* module,
+    const char* function,
+    size_t payloadSize,
+    Clock::time_point arrival,
+    std::chrono::nanoseconds executionTime) {
+
+    auto& capture = GetCapture();
+    std::lock_guard<std::mutex> lock(capture.lock);
+
+    // Stopped meanwhile, or issued before the capture started.
+    if (capture.file == nullptr || arrival < capture.start) {
+        return;
+    }
+
+    auto zoneName = GetNameId(capture, zoneId.data(), zoneId.size());
+    auto moduleName = GetNameId(capture, module, strlen(module));
+    auto functionName = GetNameId(capture, function, strlen(function));
+
+    capture.buffer.push_back(CALL_TAG);
+    AppendVarint(capture.buffer, std::chrono::duration_cast<std::chrono::nanoseconds>(arrival - capture.start).count());
+    AppendVarint(capture.buffer, zoneName);
+    AppendVarint(capture.buffer, moduleName);
+    AppendVarint(capture.buffer, functionName);
+    AppendVarint(capture.buffer, payloadSize);
+    AppendVarint(capture.buffer, executionTime.count() > 0 ? executionTime.count() : 0);
+
+    if (capture.buffer.size() >= BLOCK_SIZE) {
+        Flush(capture);
+    }
+}
+
+bool CallRecorder::Load(const std::string& path, std::vector<CallRecord>& records) {
+    auto file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    std::string data;
+    char block[BLOCK_SIZE];
+    size_t read;
+    while ((read = fread(block, 1, sizeof(block), file)) > 0) {
+        data.append(block, read);
+    }
+    fclose(file);
+
+    if (data.compare(0, HEADER_LENGTH, HEADER) != 0) {
+        return false;
+    }
+
+    std::vector<std::string> names;
+    size_t offset = HEADER_LENGTH;
+    while (offset < data.size()) {
+        auto tag = data[offset++];
+        if (tag == NAME_TAG) {
+            uint64_t id, length;
+            if (!ReadVarint(data, offset, id) || !ReadVarint(data, offset, length) || length > data.size() - offset) {
+                break;
+            }
+            if (id != names.size()) {
+                return false;
+            }
+            names.emplace_back(data, offset, length);
+            offset += length;
+        } else if (tag == CALL_TAG) {
+            uint64_t fields[6];
+            auto complete = true;
+            for (auto& field : fields) {
+                complete = complete && ReadVarint(data, offset, field);
+            }
+            if (!complete) {
+                break;
+            }
+            if (fields[1] >= names.size() || fields[2] >= names.size() || fields[3] >= names.size()) {
+                return false;
+            }
+            records.push_back(CallRecord{ names[fields[1]], names[fields[2]], names[fields[3]], fields[0], fields[4], fields[5] });
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
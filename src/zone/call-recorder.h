@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "clock.h"
+
+#include <napa/exports.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> A call of a capture, see CallRecorder. </summary>
+    struct CallRecord {
+        std::string zoneId;
+        std::string module;
+        std::string function;
+
+        /// <summary> Time the call was issued, in nanoseconds since the capture started. </summary>
+        uint64_t arrival;
+
+        /// <summary> Total size in bytes of the marshalled arguments. </summary>
+        uint64_t payloadSize;
+
+        /// <summary> Time the call ran on a worker, in nanoseconds. </summary>
+        uint64_t executionTime;
+    };
+
+    /// <summary> Process wide capture of the calls zones run, into a compact binary file for replaying them offline. </summary>
+    /// <remarks>
+    ///     A capture is a header "NAPACAP1" followed by records, each starting with a tag byte:
+    ///         - 'N': a name, i.e. varint id, varint length and UTF-8 bytes. Names are numbered from 0 as they first occur.
+    ///         - 'C': a call, i.e. varints of arrival, zone id name, module name, function name, payload size and execution time.
+    ///     Varints are LEB128, unsigned. Calls are written as they finish, so they are not in arrival order. Calls issued
+    ///     before the capture started are not recorded. Records are buffered and written in blocks from the thread
+    ///     which fills a block. When capturing is off, a call costs a relaxed atomic load.
+    ///     It's exposed in napa.dll, as calls run from the binding of Node as well.
+    /// </remarks>
+    class NAPA_API CallRecorder {
+    public:
+
+        /// <summary> Starts capturing calls into a file, which is overwritten. A capture in progress is stopped first. </summary>
+        /// <returns> False if the file can't be opened. </returns>
+        static bool Start(const std::string& path);
+
+        /// <summary> Stops capturing, writing out buffered records and closing the file. </summary>
+        static void Stop();
+
+        /// <summary> Returns whether calls are captured. </summary>
+        static bool IsEnabled() {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        /// <summary> Records a finished call, if capturing is on. </summary>
+        /// <param name="zoneId"> The zone id. </param>
+        /// <param name="module"> The module name of the call. </param>
+        /// <param name="function"> The function name of the call. </param>
+        /// <param name="payloadSize"> Total size in bytes of the marshalled arguments. </param>
+        /// <param name="arrival"> The time the call was issued. </param>
+        /// <param name="executionTime"> The time the call ran on a worker. </param>
+        static void Record(
+            const std::string& zoneId,
+            const char* module,
+            const char* function,
+            size_t payloadSize,
+            Clock::time_point arrival,
+            std::chrono::nanoseconds executionTime);
+
+        /// <summary> Reads the calls of a capture file, e.g. for tools. </summary>
+        /// <returns> False if the file can't be read or isn't a capture. Records of a truncated end are dropped. </returns>
+        static bool Load(const std::string& path, std::vector<CallRecord>& records);
+
+    private:
+        static std::atomic<bool> _enabled;
+    };
+}
+}
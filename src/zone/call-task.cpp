@@ -7,39 +7,157 @@
 #endif
 
 #include "call-task.h"
+#include "call-dispatcher.h"
+#include "call-recorder.h"
+#include "clock.h"
+#include "flight-recorder.h"
+#include "tracing.h"
+#include "worker-context.h"
 
-#include <module/core-modules/napa/call-context-wrap.h>
 #include <utils/debug.h>
 
 using namespace napa::zone;
-using namespace napa::v8_helpers;
 
-napa::zone::CallTask::CallTask(std::shared_ptr<CallContext> context) : 
-    _context(std::move(context)) {
+namespace {
+
+    /// <summary>
+    ///     Publishes the arena and the trace id of a call to native modules while it executes,
+    ///     restoring the ones of an outer call.
+    /// </summary>
+    class CallScope {
+    public:
+        CallScope(napa::memory::ArenaAllocator& arena, const char* traceId) :
+            _outerArena(WorkerContext::Get(WorkerContextItem::CALL_ARENA)),
+            _outerTraceId(WorkerContext::Get(WorkerContextItem::CALL_TRACE_ID)) {
+            WorkerContext::Set(WorkerContextItem::CALL_ARENA, &arena);
+            WorkerContext::Set(WorkerContextItem::CALL_TRACE_ID, const_cast<char*>(traceId));
+        }
+
+        ~CallScope() {
+            WorkerContext::Set(WorkerContextItem::CALL_ARENA, _outerArena);
+            WorkerContext::Set(WorkerContextItem::CALL_TRACE_ID, _outerTraceId);
+        }
+
+    private:
+        void* _outerArena;
+        void* _outerTraceId;
+    };
+
+    /// <summary>
+    ///     Records the execution time of a call once it returned, however it returned, on the metrics of the zone and on
+    ///     the statistics of its function, and captures the call if capturing is on.
+    /// </summary>
+    class ExecutionTimeScope {
+    public:
+        ExecutionTimeScope(ZoneMetrics* metrics, FunctionStatsTable::Entry* statsEntry, WorkerId workerId, const CallContext& context, std::chrono::nanoseconds start) :
+            _metrics(metrics), _statsEntry(statsEntry), _workerId(workerId), _context(context), _start(start) {
+        }
+
+        ~ExecutionTimeScope() {
+            auto elapse = _context.GetElapse();
+            if (_metrics != nullptr) {
+                _metrics->RecordExecutionTime(_workerId, elapse - _start);
+            }
+            if (_statsEntry != nullptr) {
+                _statsEntry->RecordExecution(elapse - _start);
+            }
+
+            if (CallRecorder::IsEnabled()) {
+                size_t payloadSize = 0;
+                for (const auto& argument : _context.GetArguments()) {
+                    payloadSize += argument.size;
+                }
+
+                static const std::string noZone;
+                CallRecorder::Record(
+                    _metrics != nullptr ? _metrics->GetZoneId() : noZone,
+                    _context.GetModule().data,
+                    _context.GetFunction().data,
+                    payloadSize,
+                    _context.GetStartTime(),
+                    elapse - _start);
+            }
+        }
+
+    private:
+        ZoneMetrics* _metrics;
+        FunctionStatsTable::Entry* _statsEntry;
+        WorkerId _workerId;
+        const CallContext& _context;
+        std::chrono::nanoseconds _start;
+    };
+
+    /// <summary> Accounts the CPU time and heap allocations of the calling thread to a call while it executes. </summary>
+    class ExecutionUsageScope {
+    public:
+        ExecutionUsageScope(CallContext& context, v8::Isolate* isolate) : _context(context) {
+            _context.BeginExecution(isolate);
+        }
+
+        ~ExecutionUsageScope() {
+            _context.EndExecution();
+        }
+
+    private:
+        CallContext& _context;
+    };
+
+}   // End of anonymous namespace.
+
+napa::zone::CallTask::CallTask(std::shared_ptr<CallContext> context, std::shared_ptr<ZoneMetrics> metrics) : 
+    _context(std::move(context)),
+    _metrics(std::move(metrics)) {
+    CallContext::WatchCancellation(_context);
 }
 
 void CallTask::Execute() {
-    NAPA_DEBUG("CallTask", "Begin executing function (%s.%s).", _context->GetModule().c_str(), _context->GetFunction().c_str());
+    // A call cancelled while it was queued is dropped without running.
+    if (_context->IsFinished()) {
+        NAPA_DEBUG("CallTask", "Drop finished function (%s.%s).", _context->GetModule().data, _context->GetFunction().data);
+        return;
+    }
+    NAPA_DEBUG("CallTask", "Begin executing function (%s.%s).", _context->GetModule().data, _context->GetFunction().data);
+
+    // The call is timed from its creation, which is when Execute() queued it.
+    auto workerId = static_cast<WorkerId>(reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
+    auto queueTime = _context->GetElapse();
+    if (_metrics != nullptr) {
+        _metrics->RecordQueueTime(workerId, queueTime);
+    }
+    _context->MarkDequeued(workerId, queueTime);
+    FlightTaskScope flightTask(workerId, _context->GetModule().data, _context->GetFunction().data);
+
+    // The worker times the function on its own shard, a failure is counted by whichever thread finishes the call.
+    FunctionStatsTable::Entry* statsEntry = nullptr;
+    if (_metrics != nullptr) {
+        statsEntry = _metrics->GetFunctionStats().GetEntry(workerId, _context->GetModule().data, _context->GetFunction().data);
+        if (statsEntry != nullptr) {
+            _context->CountOutcome(statsEntry, _metrics);
+        }
+    }
+    ExecutionTimeScope executionTime(_metrics.get(), statsEntry, workerId, *_context, queueTime);
+
+    // The queued span began when the call was created, on the thread which scheduled it.
+    auto traceId = _context->GetTraceId();
+    std::string traceDetail;
+    if (Tracing::IsEnabled()) {
+        Tracing::RecordAsyncSpan(false, "zone", "Queued", reinterpret_cast<uintptr_t>(_context.get()), Tracing::Now(), traceId);
+        traceDetail.append(_context->GetModule().data).append(":").append(_context->GetFunction().data);
+    }
+    TraceScope traceScope("zone", "Execute", traceId, traceDetail.c_str());
 
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
     auto context = isolate->GetCurrentContext();
 
-    // Get the module based main function from global scope.
-    auto executeFunction = context->Global()->Get(MakeExternalV8String(isolate, "__napa_zone_call__"));
-    JS_ENSURE(isolate, executeFunction->IsFunction(), "__napa_zone_call__ function must exist in global scope");
+    // Promise jobs the call runs before it returns are accounted to it, later continuations aren't.
+    ExecutionUsageScope executionUsage(*_context, isolate);
 
-    // Create task wrap.
-    auto contextWrap = napa::module::CallContextWrap::NewInstance(_context);
-    v8::Local<v8::Value> argv[] = { contextWrap };
+    CallScope callScope(_context->GetArena(), traceId);
 
-    // Execute the function.
+    // Execute the function, natively when the call allows it or else through __napa_zone_call__.
     v8::TryCatch tryCatch(isolate);
-    auto res = v8::Local<v8::Function>::Cast(executeFunction)->Call(
-        isolate->GetCurrentContext(),
-        context->Global(),
-        1,
-        argv);
+    CallDispatcher::Get()->Dispatch(_context, tryCatch);
 
     // Terminating an isolate may occur from a different thread, i.e. from timeout service.
     // If the function call already finished successfully when the isolate is terminated it may lead
@@ -50,12 +168,27 @@ void CallTask::Execute() {
     //  In both cases the isolate is being restored since this happens before each task executes.
     if (tryCatch.HasTerminated()) {
         if (_terminationReason == TerminationReason::TIMEOUT) {
-            (void)_context->Reject(NAPA_RESULT_TIMEOUT, "Terminated due to timeout");
+            Reject(NAPA_RESULT_TIMEOUT, "Terminated due to timeout");
+        } else if (_terminationReason == TerminationReason::CPU_TIMEOUT) {
+            Reject(NAPA_RESULT_TIMEOUT, "Terminated due to CPU timeout");
+        } else if (_context->IsCancelled()) {
+            Reject(NAPA_RESULT_CANCELLED, "Cancelled by the caller");
         } else {
-            (void)_context->Reject(NAPA_RESULT_INTERNAL_ERROR, "Terminated with unknown reason");
+            Reject(NAPA_RESULT_INTERNAL_ERROR, "Terminated with unknown reason");
         }
         return;
     }
 
-    NAPA_ASSERT(!tryCatch.HasCaught(), "__napa_zone_call__ should catch all user exceptions and reject task.");
+    NAPA_ASSERT(!tryCatch.HasCaught(), "Dispatched calls should catch all user exceptions and reject task.");
+}
+
+void CallTask::Cancel(ResultCode code, const std::string& reason) {
+    NAPA_DEBUG("CallTask", "Cancel function (%s.%s): %s", _context->GetModule().data, _context->GetFunction().data, reason.c_str());
+    Reject(code, reason);
+}
+
+void CallTask::Reject(ResultCode code, const std::string& reason) {
+    if (_context->Reject(code, reason) && _metrics != nullptr) {
+        _metrics->RecordFailure(code);
+    }
 }
@@ -5,6 +5,7 @@
 
 #include "call-context.h"
 #include "terminable-task.h"
+#include "zone-metrics.h"
 
 #include <memory>
 
@@ -16,14 +17,24 @@ namespace zone {
     public:
         /// <summary> Constructor. </summary>
         /// <param name="context"> Call context. </param>
-        CallTask(std::shared_ptr<CallContext> context);
+        /// <param name="metrics"> Metrics of the zone, which record the queue and execution time of the call. Optional. </param>
+        CallTask(std::shared_ptr<CallContext> context, std::shared_ptr<ZoneMetrics> metrics = nullptr);
 
         /// <summary> Overrides Task.Execute to define execution logic. </summary>
         virtual void Execute() override;
 
+        /// <summary> Overrides Task.Cancel to reject the call. </summary>
+        virtual void Cancel(ResultCode code, const std::string& reason) override;
+
     private:
+        /// <summary> Rejects the call, counting the failure. </summary>
+        void Reject(ResultCode code, const std::string& reason);
+
         /// <summary> Call context. </summary>
         std::shared_ptr<CallContext> _context;
+
+        /// <summary> Metrics of the zone. </summary>
+        std::shared_ptr<ZoneMetrics> _metrics;
     };
 }
 }
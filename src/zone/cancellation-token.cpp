@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "cancellation-token.h"
+
+#include <algorithm>
+
+using namespace napa::zone;
+
+CancellationToken::CancellationToken() : _cancelled(false), _nextId(1) {
+}
+
+bool CancellationToken::Cancel() {
+    std::vector<std::pair<HandlerId, Handler>> handlers;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_cancelled) {
+            return false;
+        }
+        _cancelled = true;
+        handlers.swap(_handlers);
+    }
+
+    // Handlers are called without the lock, so they can complete calls which register or unregister handlers.
+    for (auto& handler : handlers) {
+        handler.second();
+    }
+    return true;
+}
+
+bool CancellationToken::IsCancelled() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _cancelled;
+}
+
+CancellationToken::HandlerId CancellationToken::Register(Handler handler) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_cancelled) {
+            auto id = _nextId++;
+            _handlers.emplace_back(id, std::move(handler));
+            return id;
+        }
+    }
+    handler();
+    return 0;
+}
+
+void CancellationToken::Unregister(HandlerId id) {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    // Handlers are registered in order of ids.
+    auto it = std::lower_bound(_handlers.begin(), _handlers.end(), id,
+        [](const std::pair<HandlerId, Handler>& handler, HandlerId id) { return handler.first < id; });
+    if (it != _handlers.end() && it->first == id) {
+        _handlers.erase(it);
+    }
+}
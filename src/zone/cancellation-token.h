@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Cancels calls it's passed to, e.g. when the client that issued them went away. </summary>
+    /// <remarks>
+    ///     A token is shared by its creator and the calls using it, hence always owned by a std::shared_ptr.
+    ///     It can be cancelled once, from any thread.
+    ///     It's exposed in napa.dll, so tokens can be shared by Node and Napa isolates.
+    /// </remarks>
+    class NAPA_API CancellationToken : public std::enable_shared_from_this<CancellationToken> {
+    public:
+
+        /// <summary> Called once when the token is cancelled, on the thread that cancelled it. </summary>
+        typedef std::function<void()> Handler;
+
+        /// <summary> Id of a registered handler, never 0. </summary>
+        typedef uint64_t HandlerId;
+
+        CancellationToken();
+
+        /// <summary> Non-copyable. </summary>
+        CancellationToken(const CancellationToken&) = delete;
+        CancellationToken& operator=(const CancellationToken&) = delete;
+
+        /// <summary> Cancels the token, calling the registered handlers in order of registration. </summary>
+        /// <returns> False if the token was already cancelled. </returns>
+        bool Cancel();
+
+        /// <summary> Returns whether the token was cancelled. </summary>
+        bool IsCancelled() const;
+
+        /// <summary> Registers a handler, which is called right away if the token is already cancelled. </summary>
+        /// <returns> Id to unregister the handler with, 0 if it was called right away. </returns>
+        HandlerId Register(Handler handler);
+
+        /// <summary> Unregisters a handler that is no longer needed, e.g. once its call completed. </summary>
+        /// <remarks> Does nothing if the handler was already called, or is being called by another thread. </remarks>
+        void Unregister(HandlerId id);
+
+    private:
+        mutable std::mutex _lock;
+        bool _cancelled;
+        HandlerId _nextId;
+        std::vector<std::pair<HandlerId, Handler>> _handlers;
+    };
+}
+}
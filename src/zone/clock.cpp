@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "clock.h"
+
+#include <platform/platform.h>
+
+#ifdef OS_LINUX
+#include <time.h>
+#endif
+
+using namespace napa::zone;
+
+#ifdef OS_LINUX
+
+// libstdc++ and libc++ read steady_clock from CLOCK_MONOTONIC, which its coarse variant shares the epoch with.
+// The coarse variant returns the time of the last tick from the vDSO, without reading the hardware counter.
+
+namespace {
+    Clock::duration GetResolution() {
+        timespec resolution;
+        if (clock_getres(CLOCK_MONOTONIC_COARSE, &resolution) != 0) {
+            return Clock::duration::zero();
+        }
+        return std::chrono::duration_cast<Clock::duration>(
+            std::chrono::seconds(resolution.tv_sec) + std::chrono::nanoseconds(resolution.tv_nsec));
+    }
+}
+
+Clock::time_point Clock::CoarseNow() {
+    timespec now;
+    if (GetCoarseResolution() == duration::zero() || clock_gettime(CLOCK_MONOTONIC_COARSE, &now) != 0) {
+        return Now();
+    }
+    return time_point(std::chrono::duration_cast<duration>(std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec)));
+}
+
+Clock::duration Clock::GetCoarseResolution() {
+    // A local static, as timers may start during static initialization.
+    static const auto resolution = GetResolution();
+    return resolution;
+}
+
+#else
+
+Clock::time_point Clock::CoarseNow() {
+    return Now();
+}
+
+Clock::duration Clock::GetCoarseResolution() {
+    return duration::zero();
+}
+
+#endif
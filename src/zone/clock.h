@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <chrono>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> The monotonic clock zones take timestamps from, with a cheaper coarse reading for hot paths. </summary>
+    /// <remarks>
+    ///     Both readings share the epoch of std::chrono::steady_clock, so their time points compare with each other and
+    ///     with condition variable deadlines. The coarse reading is what the OS last published at its scheduler tick,
+    ///     it never runs ahead of Now(). It usually lags by up to GetCoarseResolution(), but more on tickless kernels
+    ///     that skip ticks, where lags of nearly twice the resolution were measured. It suits expirations that may pass
+    ///     a few milliseconds early, like cache entries, not timeouts that must not fire early or durations measured
+    ///     across a call.
+    /// </remarks>
+    class Clock {
+    public:
+        typedef std::chrono::steady_clock::rep rep;
+        typedef std::chrono::steady_clock::period period;
+        typedef std::chrono::steady_clock::duration duration;
+        typedef std::chrono::steady_clock::time_point time_point;
+        static constexpr bool is_steady = true;
+
+        /// <summary> Reads the clock at full resolution. </summary>
+        static time_point Now() {
+            return std::chrono::steady_clock::now();
+        }
+
+        /// <summary> Reads the clock at the resolution of the OS tick, a few times cheaper than Now(). </summary>
+        /// <remarks> Platforms without a coarse clock of the same epoch read the clock at full resolution. </remarks>
+        static time_point CoarseNow();
+
+        /// <summary> Gets the resolution the OS reports for CoarseNow(), zero where it reads at full resolution. </summary>
+        /// <remarks> It isn't a bound of how far CoarseNow() lags behind Now(), see Clock. </remarks>
+        static duration GetCoarseResolution();
+    };
+}
+}
@@ -0,0 +1,78 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> V8 code cache of a script, shared by the isolates that compile the same source. </summary>
+    /// <remarks>
+    ///     The first isolate that runs the script produces the cache, later isolates consume it instead of parsing
+    ///     and compiling the source again. The cache only holds bytes and doesn't depend on any isolate.
+    ///     Once an isolate ran the script for a while, it may replace the cache by a warm one, which also holds
+    ///     the functions compiled since, so later isolates don't compile them lazily either.
+    /// </remarks>
+    class CodeCache {
+    public:
+        typedef std::vector<uint8_t> Data;
+
+        /// <summary> Gets the cached data, or nullptr if none was produced yet. </summary>
+        std::shared_ptr<const Data> Get() const {
+            std::lock_guard<std::mutex> lock(_lock);
+            return _data;
+        }
+
+        /// <summary> Sets the cached data, unless another isolate already did. </summary>
+        /// <returns> True if the data was set. </returns>
+        bool Set(Data data) {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (_data != nullptr) {
+                return false;
+            }
+
+            _data = std::make_shared<const Data>(std::move(data));
+            return true;
+        }
+
+        /// <summary> Replaces the cached data with data created after the script warmed up, unless another isolate did already. </summary>
+        /// <returns> True if the data was replaced. </returns>
+        bool Warm(Data data) {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (_warm) {
+                return false;
+            }
+
+            _data = std::make_shared<const Data>(std::move(data));
+            _warm = true;
+            return true;
+        }
+
+        /// <summary> Whether the cached data was created after the script warmed up. </summary>
+        bool IsWarm() const {
+            std::lock_guard<std::mutex> lock(_lock);
+            return _warm;
+        }
+
+        /// <summary> Drops cached data that V8 rejected, so the next isolate that runs the script produces it again. </summary>
+        /// <param name="data"> The rejected data, as returned by Get(). </param>
+        void Reject(const std::shared_ptr<const Data>& data) {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (_data == data) {
+                _data = nullptr;
+                _warm = false;
+            }
+        }
+
+    private:
+        std::shared_ptr<const Data> _data;
+        bool _warm = false;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -0,0 +1,156 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "cpu-governor.h"
+#include "clock.h"
+
+#include <algorithm>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Token held by a thread. </summary>
+    struct Token {
+        CpuGovernor* governor = nullptr;
+        CpuGovernor::Share* share = nullptr;
+        std::chrono::steady_clock::time_point start;
+        double charged = 0;
+    };
+
+    thread_local Token threadToken;
+
+    /// <summary> Weight of the last task time in the moving average. </summary>
+    const double AVERAGE_WEIGHT = 0.125;
+}
+
+CpuGovernor& CpuGovernor::GetInstance() {
+    static CpuGovernor instance;
+    return instance;
+}
+
+CpuGovernor::CpuGovernor(uint32_t budget) : _budget(budget), _running(0), _virtualTime(0) {}
+
+void CpuGovernor::SetBudget(uint32_t budget) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _budget = budget;
+    Grant();
+}
+
+uint32_t CpuGovernor::GetBudget() const {
+    return _budget.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<CpuGovernor::Share> CpuGovernor::GetShare(const std::string& zoneId, uint32_t weight) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto& entry = _shares[zoneId];
+    auto share = entry.lock();
+    if (share == nullptr) {
+        share = std::make_shared<Share>(weight);
+        entry = share;
+    }
+    return share;
+}
+
+void CpuGovernor::Acquire(Share& share) {
+    if (GetBudget() == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_lock);
+    if (_budget == 0) {
+        return;
+    }
+
+    // Idle time isn't banked, a share starts where the share served last is.
+    share._virtualTime = std::max(share._virtualTime, _virtualTime);
+
+    // Waiting shares go first, even if a token was just freed.
+    if (_running < _budget && _waiting.empty()) {
+        _running++;
+        Hold(share, true);
+        return;
+    }
+
+    if (share._waiting++ == 0) {
+        _waiting.push_back(&share);
+    }
+    _grantEvent.wait(lock, [&share]() { return share._granted > 0; });
+    share._granted--;
+    Hold(share, false);
+}
+
+void CpuGovernor::Release() {
+    auto token = threadToken;
+    if (token.governor != this) {
+        return;
+    }
+    threadToken = Token();
+
+    auto used = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::Now() - token.start).count());
+
+    std::lock_guard<std::mutex> lock(_lock);
+    auto& share = *token.share;
+    share._virtualTime += (used - token.charged) / share._weight;
+    share._averageTaskTime += (used - share._averageTaskTime) * AVERAGE_WEIGHT;
+
+    _running--;
+    Grant();
+}
+
+uint32_t CpuGovernor::GetRunning() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _running;
+}
+
+void CpuGovernor::Grant() {
+    auto granted = false;
+    while (!_waiting.empty() && (_budget == 0 || _running < _budget)) {
+        auto next = std::min_element(_waiting.begin(), _waiting.end(), [](Share* left, Share* right) {
+            return left->_virtualTime < right->_virtualTime;
+        });
+
+        auto share = *next;
+        _virtualTime = share->_virtualTime;
+        share->_granted++;
+        if (--share->_waiting == 0) {
+            _waiting.erase(next);
+        }
+
+        // Tokens granted when the limit is lifted are counted until they're released as well.
+        _running++;
+        granted = true;
+
+        // The estimate is charged right away, so the next grant sees it.
+        share->_virtualTime += share->_averageTaskTime / share->_weight;
+    }
+
+    if (granted) {
+        _grantEvent.notify_all();
+    }
+}
+
+void CpuGovernor::Hold(Share& share, bool charge) {
+    threadToken.governor = this;
+    threadToken.share = &share;
+    threadToken.start = Clock::Now();
+    threadToken.charged = share._averageTaskTime;
+
+    if (charge) {
+        share._virtualTime += share._averageTaskTime / share._weight;
+    }
+}
+
+CpuGovernor::Yield::Yield() : _governor(threadToken.governor), _share(threadToken.share) {
+    if (_governor != nullptr) {
+        _governor->Release();
+    }
+}
+
+CpuGovernor::Yield::~Yield() {
+    if (_governor != nullptr) {
+        _governor->Acquire(*_share);
+    }
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Process-wide budget of zone workers running tasks at the same time, which zones share by weight. </summary>
+    /// <remarks>
+    ///     A worker holds a token of the budget only while it runs a task, so idle zones don't reserve processors.
+    ///     When workers wait for tokens, the next token goes to the zone with the least virtual time, i.e. the CPU
+    ///     time its tasks took divided by its weight. A zone that was idle starts from the virtual time of the zone
+    ///     served last, it doesn't catch up on the time it didn't use. Tasks are charged an estimate of their time
+    ///     when they get a token, which is corrected once they finish, so a zone with many waiting workers doesn't
+    ///     take all tokens freed while its running tasks are not charged yet.
+    /// </remarks>
+    class NAPA_API CpuGovernor {
+    public:
+
+        /// <summary> Share of the budget of a zone, which all its workers use. </summary>
+        class Share {
+        public:
+            explicit Share(uint32_t weight) : _weight(weight > 0 ? weight : 1) {}
+
+        private:
+            friend class CpuGovernor;
+
+            double _weight;
+
+            /// <summary> CPU time in nanoseconds charged to the share, divided by its weight. </summary>
+            double _virtualTime = 0;
+
+            /// <summary> Moving average of the time of the tasks of the share in nanoseconds, charged when they get a token. </summary>
+            double _averageTaskTime = 1e6;
+
+            uint32_t _waiting = 0;
+            uint32_t _granted = 0;
+        };
+
+        /// <summary> Releases the token of the calling worker while it's blocked, e.g. waiting for a synchronous call. </summary>
+        class NAPA_API Yield {
+        public:
+            Yield();
+            ~Yield();
+
+            Yield(const Yield&) = delete;
+            Yield& operator=(const Yield&) = delete;
+
+        private:
+            CpuGovernor* _governor;
+            Share* _share;
+        };
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static CpuGovernor& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        /// <param name="budget"> The number of workers running tasks at the same time, 0 for no limit. </param>
+        explicit CpuGovernor(uint32_t budget = 0);
+
+        /// <summary> Sets the budget, 0 for no limit. Waiting workers get the tokens it adds. </summary>
+        void SetBudget(uint32_t budget);
+
+        /// <summary> Gets the budget, 0 for no limit. </summary>
+        uint32_t GetBudget() const;
+
+        /// <summary> Gets the share of a zone, creating it on first use. </summary>
+        /// <param name="zoneId"> The id of the zone. </param>
+        /// <param name="weight"> The weight of the zone, used when its share is created. </param>
+        std::shared_ptr<Share> GetShare(const std::string& zoneId, uint32_t weight);
+
+        /// <summary> Waits for a token to run a task of a share on the calling thread, unless there is no limit. </summary>
+        void Acquire(Share& share);
+
+        /// <summary> Releases the token of the calling thread, if it holds one, charging the share for the time it held it. </summary>
+        void Release();
+
+        /// <summary> Gets the number of tokens held. </summary>
+        uint32_t GetRunning() const;
+
+    private:
+
+        /// <summary> Grants tokens to waiting shares by least virtual time, while the budget allows. Called under the lock. </summary>
+        void Grant();
+
+        /// <summary> Records the token held by the calling thread. Called under the lock. </summary>
+        /// <param name="charge"> Whether to charge the share an estimate of the task, which Grant did for tokens it granted. </param>
+        void Hold(Share& share, bool charge);
+
+        mutable std::mutex _lock;
+        std::condition_variable _grantEvent;
+
+        /// <summary> Read without the lock, so workers of a process without budget don't contend for it. </summary>
+        std::atomic<uint32_t> _budget;
+        uint32_t _running;
+
+        /// <summary> Virtual time of the share served last, which idle shares start from. </summary>
+        double _virtualTime;
+
+        std::vector<Share*> _waiting;
+        std::unordered_map<std::string, std::weak_ptr<Share>> _shares;
+    };
+}
+}
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "cpu-profiling.h"
+
+#include <utils/string.h>
+
+#include <v8-profiler.h>
+
+#include <vector>
+
+using namespace napa;
+using napa::utils::string::AppendJsonString;
+
+namespace {
+
+    /// <summary> Title of profiles, each thread records one at a time. </summary>
+    constexpr const char* PROFILE_TITLE = "napa";
+
+    /// <summary> The profiler of the calling thread, created by the start of profiling. </summary>
+    thread_local v8::CpuProfiler* threadProfiler = nullptr;
+
+    void AppendNode(std::string& out, const v8::CpuProfileNode* node) {
+        out.append("{\"id\":").append(std::to_string(node->GetNodeId()));
+        out.append(",\"callFrame\":{\"functionName\":");
+        AppendJsonString(out, node->GetFunctionNameStr());
+        out.append(",\"scriptId\":\"").append(std::to_string(node->GetScriptId()));
+        out.append("\",\"url\":");
+        AppendJsonString(out, node->GetScriptResourceNameStr());
+
+        // V8 numbers lines and columns from 1, DevTools from 0, missing ones are -1 in both.
+        out.append(",\"lineNumber\":").append(std::to_string(node->GetLineNumber() - 1));
+        out.append(",\"columnNumber\":").append(std::to_string(node->GetColumnNumber() - 1));
+        out.append("},\"hitCount\":").append(std::to_string(node->GetHitCount()));
+
+        out.append(",\"children\":[");
+        for (int i = 0; i < node->GetChildrenCount(); ++i) {
+            if (i > 0) {
+                out.push_back(',');
+            }
+            out.append(std::to_string(node->GetChild(i)->GetNodeId()));
+        }
+        out.append("]}");
+    }
+
+    std::string ToCpuProfileJson(const v8::CpuProfile* profile) {
+        std::string out = "{\"nodes\":[";
+
+        // Nodes are listed parents first, iteratively since JS call stacks may be deeper than native ones.
+        std::vector<const v8::CpuProfileNode*> pending = { profile->GetTopDownRoot() };
+        bool first = true;
+        while (!pending.empty()) {
+            auto node = pending.back();
+            pending.pop_back();
+            if (!first) {
+                out.push_back(',');
+            }
+            first = false;
+            AppendNode(out, node);
+            for (int i = node->GetChildrenCount() - 1; i >= 0; --i) {
+                pending.push_back(node->GetChild(i));
+            }
+        }
+
+        auto startTime = profile->GetStartTime();
+        out.append("],\"startTime\":").append(std::to_string(startTime));
+        out.append(",\"endTime\":").append(std::to_string(profile->GetEndTime()));
+
+        out.append(",\"samples\":[");
+        for (int i = 0; i < profile->GetSamplesCount(); ++i) {
+            if (i > 0) {
+                out.push_back(',');
+            }
+            out.append(std::to_string(profile->GetSample(i)->GetNodeId()));
+        }
+
+        // Sample times are in microseconds, each relative to the previous sample.
+        out.append("],\"timeDeltas\":[");
+        auto previous = startTime;
+        for (int i = 0; i < profile->GetSamplesCount(); ++i) {
+            if (i > 0) {
+                out.push_back(',');
+            }
+            auto timestamp = profile->GetSampleTimestamp(i);
+            out.append(std::to_string(timestamp - previous));
+            previous = timestamp;
+        }
+        out.append("]}");
+        return out;
+    }
+}
+
+ResultCode napa::zone::StartCpuProfiling(v8::Isolate* isolate, uint32_t samplingInterval) {
+    if (threadProfiler != nullptr) {
+        return NAPA_RESULT_PROFILING_ERROR;
+    }
+
+    v8::HandleScope scope(isolate);
+
+    threadProfiler = v8::CpuProfiler::New(isolate);
+    if (samplingInterval > 0) {
+        // Only takes effect before profiling starts.
+        threadProfiler->SetSamplingInterval(static_cast<int>(samplingInterval));
+    }
+    threadProfiler->StartProfiling(v8::String::NewFromUtf8(isolate, PROFILE_TITLE), true);
+    return NAPA_RESULT_SUCCESS;
+}
+
+std::string napa::zone::StopCpuProfiling(v8::Isolate* isolate) {
+    if (threadProfiler == nullptr) {
+        return std::string();
+    }
+
+    v8::HandleScope scope(isolate);
+
+    std::string json;
+    auto profile = threadProfiler->StopProfiling(v8::String::NewFromUtf8(isolate, PROFILE_TITLE));
+    if (profile != nullptr) {
+        json = ToCpuProfileJson(profile);
+        profile->Delete();
+    }
+    DisposeCpuProfiler();
+    return json;
+}
+
+bool napa::zone::IsCpuProfiling() {
+    return threadProfiler != nullptr;
+}
+
+void napa::zone::DisposeCpuProfiler() {
+    if (threadProfiler != nullptr) {
+        threadProfiler->Dispose();
+        threadProfiler = nullptr;
+    }
+}
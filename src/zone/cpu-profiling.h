@@ -0,0 +1,34 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/types.h>
+
+#include <v8.h>
+
+#include <string>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Starts the V8 CPU profiler on the isolate of the calling thread. </summary>
+    /// <param name="isolate"> The isolate of the calling thread, which must be entered. </param>
+    /// <param name="samplingInterval"> Sampling interval in microseconds, 0 for the V8 default. </param>
+    /// <returns> NAPA_RESULT_PROFILING_ERROR if the thread is profiling already, NAPA_RESULT_SUCCESS otherwise. </returns>
+    NAPA_API ResultCode StartCpuProfiling(v8::Isolate* isolate, uint32_t samplingInterval);
+
+    /// <summary> Stops the V8 CPU profiler of the calling thread. </summary>
+    /// <param name="isolate"> The isolate of the calling thread, which must be entered. </param>
+    /// <returns> The profile in the .cpuprofile JSON format of Chrome DevTools, empty if the thread wasn't profiling. </returns>
+    NAPA_API std::string StopCpuProfiling(v8::Isolate* isolate);
+
+    /// <summary> Returns whether the calling thread is profiling. </summary>
+    /// <remarks> Workers don't recycle their isolate while profiling, so the profile covers a single isolate. </remarks>
+    NAPA_API bool IsCpuProfiling();
+
+    /// <summary> Drops the profiler of the calling thread and its profile, before the isolate is disposed. </summary>
+    NAPA_API void DisposeCpuProfiler();
+}
+}
@@ -7,6 +7,7 @@
 #endif
 
 #include "eval-task.h"
+#include "cached-script-compiler.h"
 
 #include <platform/filesystem.h>
 #include <utils/debug.h>
@@ -16,20 +17,50 @@
 
 #include <v8.h>
 
+#include <algorithm>
+
 using namespace napa;
 using namespace napa::zone;
 
-EvalTask::EvalTask(std::string source, std::string sourceOrigin, BroadcastCallback callback) :
+namespace {
+
+    /// <summary> Exposes an ASCII source to V8 in place, so workers running a broadcast don't copy it into their heap. </summary>
+    class SharedSourceResource : public v8::String::ExternalOneByteStringResource {
+    public:
+        explicit SharedSourceResource(std::shared_ptr<const std::string> source) : _source(std::move(source)) {}
+
+        const char* data() const override {
+            return _source->data();
+        }
+
+        size_t length() const override {
+            return _source->size();
+        }
+
+    private:
+        std::shared_ptr<const std::string> _source;
+    };
+
+    bool IsAscii(const std::string& source) {
+        return std::all_of(source.begin(), source.end(), [](char c) { return (c & 0x80) == 0; });
+    }
+
+    /// <summary> Minimal length of an ASCII source to be exposed in place rather than copied into the isolate heap. </summary>
+    const size_t MIN_EXTERNAL_SOURCE_LENGTH = 1024;
+}
+
+EvalTask::EvalTask(std::shared_ptr<const std::string> source, std::string sourceOrigin, BroadcastCallback callback, std::shared_ptr<CodeCache> codeCache) :
     _source(std::move(source)),
     _sourceOrigin(std::move(sourceOrigin)),
-    _callback(std::move(callback)) {}
+    _callback(std::move(callback)),
+    _codeCache(std::move(codeCache)) {}
 
 void EvalTask::Execute() {
     auto isolate = v8::Isolate::GetCurrent();
     v8::HandleScope scope(isolate);
     auto context = isolate->GetCurrentContext();
 
-    NAPA_DEBUG("EvalTask", "Begin executing script:\"%s\"", _source.c_str());
+    NAPA_DEBUG("EvalTask", "Begin executing script:\"%s\"", _source->c_str());
 
     auto filename = v8_helpers::MakeV8String(isolate, _sourceOrigin);
     filesystem::Path originPath(_sourceOrigin);
@@ -41,14 +72,22 @@ void EvalTask::Execute() {
         (void)global->Set(context, v8_helpers::MakeV8String(isolate, "__filename"), filename);
     }
 
-    auto source = napa::v8_helpers::MakeV8String(isolate, _source);
+    v8::Local<v8::String> source;
+    if (_source->size() >= MIN_EXTERNAL_SOURCE_LENGTH && IsAscii(*_source)) {
+        // V8 takes ownership of the resource, which keeps the shared source alive.
+        source = v8::String::NewExternalOneByte(isolate, new SharedSourceResource(_source)).ToLocalChecked();
+    } else {
+        source = napa::v8_helpers::MakeV8String(isolate, *_source);
+    }
     auto sourceOrigin = v8::ScriptOrigin(filename);
 
+    CachedScriptCompiler compiler(_codeCache);
+
     // Compile the source code.
     v8::MaybeLocal<v8::Script> compileResult;
     {
         v8::TryCatch tryCatch(isolate);
-        compileResult = v8::Script::Compile(context, source, &sourceOrigin);
+        compileResult = compiler.Compile(context, source, sourceOrigin);
         if (tryCatch.HasCaught()) {
             auto exception = tryCatch.Exception();
             v8::String::Utf8Value exceptionStr(exception);
@@ -80,6 +119,8 @@ void EvalTask::Execute() {
         }
     }
 
+    compiler.Produce(script);
+
     NAPA_DEBUG("EvalTask", "Eval script completed with success");
     _callback(NAPA_RESULT_SUCCESS);
 }
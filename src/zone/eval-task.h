@@ -4,10 +4,12 @@
 #pragma once
 
 #include "task.h"
+#include "code-cache.h"
 
 #include "napa/types.h"
 
 #include <functional>
+#include <memory>
 #include <string>
 
 namespace napa {
@@ -17,20 +19,23 @@ namespace zone {
     class EvalTask : public Task {
     public:
         /// <summary> Constructor. </summary>
-        /// <param name="source"> The JS source code to load on the isolate the runs this task. </param>
+        /// <param name="source"> The JS source code to load on the isolate the runs this task, which may be shared with other tasks. </param>
         /// <param name="sourceOrigin"> The origin of the source code. </param>
         /// <param name="callback"> A callback that is triggered when the task execution completed. </param>
-        EvalTask(std::string source,
+        /// <param name="codeCache"> Code cache to compile the source with, or to fill after a successful run. Optional. </param>
+        EvalTask(std::shared_ptr<const std::string> source,
             std::string sourceOrigin = "",
-            BroadcastCallback callback = [](ResultCode) {});
+            BroadcastCallback callback = [](ResultCode) {},
+            std::shared_ptr<CodeCache> codeCache = nullptr);
 
         /// <summary> Overrides Task.Execute to define loading execution logic. </summary>
         virtual void Execute() override;
 
     private:
-        std::string _source;
+        std::shared_ptr<const std::string> _source;
         std::string _sourceOrigin;
         BroadcastCallback _callback;
+        std::shared_ptr<CodeCache> _codeCache;
     };
 }
 }
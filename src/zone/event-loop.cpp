@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "event-loop.h"
+
+#include <napa/log.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+EventLoop::EventLoop() : _waiting(false) {
+    auto result = uv_loop_init(&_loop);
+    NAPA_ASSERT(result == 0, "Failed to initialize event loop: %s", uv_strerror(result));
+
+    uv_async_init(&_loop, &_wakeup, [](uv_async_t*) {});
+    uv_timer_init(&_loop, &_timeout);
+}
+
+EventLoop::~EventLoop() {
+    CloseHandles();
+
+    uv_close(reinterpret_cast<uv_handle_t*>(&_wakeup), nullptr);
+    uv_close(reinterpret_cast<uv_handle_t*>(&_timeout), nullptr);
+    uv_run(&_loop, UV_RUN_DEFAULT);
+
+    auto result = uv_loop_close(&_loop);
+    NAPA_ASSERT(result == 0, "Failed to close event loop: %s", uv_strerror(result));
+}
+
+uv_loop_t* EventLoop::Get() {
+    return &_loop;
+}
+
+void EventLoop::RunPending() {
+    uv_run(&_loop, UV_RUN_NOWAIT);
+}
+
+void EventLoop::Wait(const std::function<bool()>& ready, std::chrono::milliseconds timeout) {
+    // Pairs with the fence in Wake(), either the producer sees the thread waiting, or the thread sees what is ready.
+    _waiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!ready()) {
+        if (timeout.count() >= 0) {
+            uv_timer_start(&_timeout, [](uv_timer_t*) {}, static_cast<uint64_t>(timeout.count()), 0);
+        }
+
+        // The wakeup handle keeps the loop alive, so it returns once any callback ran.
+        uv_run(&_loop, UV_RUN_ONCE);
+        uv_timer_stop(&_timeout);
+    }
+
+    _waiting.store(false, std::memory_order_relaxed);
+}
+
+void EventLoop::Wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiting.load(std::memory_order_relaxed)) {
+        uv_async_send(&_wakeup);
+    }
+}
+
+bool EventLoop::HasActiveHandles() {
+    struct Walk {
+        EventLoop* loop;
+        bool active;
+    } walk = { this, false };
+
+    uv_walk(&_loop, [](uv_handle_t* handle, void* arg) {
+        auto walk = static_cast<Walk*>(arg);
+        if (!walk->loop->IsOwnHandle(handle) && uv_is_active(handle) && uv_has_ref(handle)) {
+            walk->active = true;
+        }
+    }, &walk);
+
+    return walk.active;
+}
+
+void EventLoop::CloseHandles() {
+    struct Walk {
+        EventLoop* loop;
+        int closed;
+    } walk = { this, 0 };
+
+    uv_walk(&_loop, [](uv_handle_t* handle, void* arg) {
+        auto walk = static_cast<Walk*>(arg);
+        if (!walk->loop->IsOwnHandle(handle) && !uv_is_closing(handle)) {
+            uv_close(handle, nullptr);
+            walk->closed++;
+        }
+    }, &walk);
+
+    if (walk.closed > 0) {
+        LOG_WARNING("EventLoop", "Closed %d handle(s) left open by modules.", walk.closed);
+    }
+
+    // Close callbacks of handles closed before, by modules or above, run in the next iteration, while the isolate is there.
+    uv_run(&_loop, UV_RUN_NOWAIT);
+}
+
+bool EventLoop::IsOwnHandle(uv_handle_t* handle) const {
+    return handle == reinterpret_cast<const uv_handle_t*>(&_wakeup) || handle == reinterpret_cast<const uv_handle_t*>(&_timeout);
+}
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <uv.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> libuv loop of a zone worker, which serves libuv handles of native modules between tasks. </summary>
+    /// <remarks>
+    ///     The worker runs ready callbacks before each task, and waits in the loop instead of on its task queue when idle,
+    ///     so I/O completions and new tasks both wake it up. Only Wake() may be called from other threads.
+    /// </remarks>
+    class EventLoop {
+    public:
+
+        /// <summary> Constructor. </summary>
+        EventLoop();
+
+        /// <summary> Destructor. Closes the remaining handles. </summary>
+        ~EventLoop();
+
+        /// <summary> Non-copyable. </summary>
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        /// <summary> Gets the libuv loop. </summary>
+        uv_loop_t* Get();
+
+        /// <summary> Runs the callbacks that are ready, without waiting. </summary>
+        void RunPending();
+
+        /// <summary> Waits until a callback ran, Wake() was called, or a timeout expired. </summary>
+        /// <param name="ready"> Checked once the thread is marked waiting, nothing is waited for if it returns true. </param>
+        /// <param name="timeout"> How long to wait, negative to wait without timeout. </param>
+        void Wait(const std::function<bool()>& ready, std::chrono::milliseconds timeout);
+
+        /// <summary> Wakes up the thread waiting in the loop, if any. Can be called from any thread. </summary>
+        void Wake();
+
+        /// <summary> Whether handles opened by modules are active and referenced, i.e. would keep a node event loop alive. </summary>
+        bool HasActiveHandles();
+
+        /// <summary> Closes the handles opened by modules, e.g. before an isolate they call back into is disposed. </summary>
+        /// <remarks> Close callbacks aren't called for handles closed this way, those of handles closed before run first. </remarks>
+        void CloseHandles();
+
+    private:
+
+        /// <summary> Whether a handle is one of the loop itself. </summary>
+        bool IsOwnHandle(uv_handle_t* handle) const;
+
+        uv_loop_t _loop;
+
+        /// <summary> Handle that Wake() signals. </summary>
+        uv_async_t _wakeup;
+
+        /// <summary> Timer of waits with a timeout. </summary>
+        uv_timer_t _timeout;
+
+        /// <summary> Whether the thread is waiting or about to wait in the loop. </summary>
+        std::atomic<bool> _waiting;
+    };
+}
+}
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "fair-share-queue.h"
+
+#include <utils/debug.h>
+
+#include <algorithm>
+
+using namespace napa;
+using namespace napa::zone;
+
+FairShareQueue::FairShareQueue(size_t lanes) : _lanes(lanes), _size(0) {
+    AddTenant(1, 0);
+}
+
+size_t FairShareQueue::AddTenant(uint32_t weight, uint32_t maxConcurrency) {
+    _tenants.push_back(Tenant{ std::max(weight, 1u), maxConcurrency, 0 });
+    for (auto& lane : _lanes) {
+        lane.tenants.emplace_back();
+    }
+    return _tenants.size() - 1;
+}
+
+size_t FairShareQueue::GetTenantCount() const {
+    return _tenants.size();
+}
+
+void FairShareQueue::Push(size_t lane, size_t tenant, std::shared_ptr<Task> task) {
+    NAPA_ASSERT(lane < _lanes.size(), "lane out of range");
+    NAPA_ASSERT(tenant < _tenants.size(), "tenant out of range");
+
+    auto& tasks = _lanes[lane].tenants[tenant].tasks;
+    if (tasks.empty()) {
+        // Joins the round right before the tenant whose turn it is, so it waits for a full round at most.
+        auto& active = _lanes[lane].active;
+        auto position = std::min(_lanes[lane].current, active.size());
+        active.insert(active.begin() + position, tenant);
+        _lanes[lane].current = position + 1;
+    }
+    tasks.emplace(std::move(task));
+    _size++;
+}
+
+std::shared_ptr<Task> FairShareQueue::Pop(size_t& laneIndex) {
+    for (laneIndex = 0; laneIndex < _lanes.size(); laneIndex++) {
+        auto& lane = _lanes[laneIndex];
+
+        for (size_t tried = 0; tried < lane.active.size(); tried++) {
+            if (lane.current >= lane.active.size()) {
+                lane.current = 0;
+            }
+
+            auto tenantIndex = lane.active[lane.current];
+            auto& tenant = _tenants[tenantIndex];
+            auto& tenantTasks = lane.tenants[tenantIndex];
+            if (IsAtCap(tenant)) {
+                // A capped tenant doesn't save up its turn.
+                tenantTasks.deficit = 0;
+                lane.current++;
+                continue;
+            }
+
+            if (tenantTasks.deficit == 0) {
+                tenantTasks.deficit = tenant.weight;
+            }
+
+            auto task = std::move(tenantTasks.tasks.front());
+            tenantTasks.tasks.pop();
+            tenantTasks.deficit--;
+            _size--;
+            if (tenant.maxConcurrency > 0) {
+                tenant.running++;
+            }
+
+            if (tenantTasks.tasks.empty()) {
+                // The next tenant moves into the current position.
+                tenantTasks.deficit = 0;
+                lane.active.erase(lane.active.begin() + lane.current);
+            } else if (tenantTasks.deficit == 0) {
+                lane.current++;
+            }
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+bool FairShareQueue::TryAcquire(size_t tenant) {
+    NAPA_ASSERT(tenant < _tenants.size(), "tenant out of range");
+
+    auto& state = _tenants[tenant];
+    if (state.maxConcurrency == 0) {
+        return true;
+    }
+    if (state.running >= state.maxConcurrency) {
+        return false;
+    }
+    state.running++;
+    return true;
+}
+
+void FairShareQueue::Release(size_t tenant) {
+    NAPA_ASSERT(tenant < _tenants.size(), "tenant out of range");
+    NAPA_ASSERT(_tenants[tenant].running > 0, "tenant has no running task");
+
+    _tenants[tenant].running--;
+}
+
+uint32_t FairShareQueue::GetRunning(size_t tenant) const {
+    NAPA_ASSERT(tenant < _tenants.size(), "tenant out of range");
+    return _tenants[tenant].running;
+}
+
+size_t FairShareQueue::GetSize() const {
+    return _size;
+}
+
+bool FairShareQueue::IsAtCap(const Tenant& tenant) const {
+    return tenant.maxConcurrency > 0 && tenant.running >= tenant.maxConcurrency;
+}
@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "task.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Tasks waiting for a worker, queued per priority lane and per tenant, served by weighted deficit round robin. </summary>
+    /// <remarks>
+    ///     Lanes are served in order, the first lane holding the highest priority. Within a lane, each tenant with queued
+    ///     tasks gets turns of as many tasks as its weight, so under load tenants share workers in proportion to their
+    ///     weights, whatever the number of tasks each of them queues. A tenant running as many tasks as its concurrency cap
+    ///     is skipped, in all lanes, until one of its tasks finishes. Tasks of a tenant are served in FIFO order.
+    ///     Tenant 0 is added on construction, with a weight of 1 and no cap. It's not thread-safe.
+    /// </remarks>
+    class FairShareQueue {
+    public:
+
+        /// <summary> Constructor. </summary>
+        /// <param name="lanes"> The number of priority lanes. </param>
+        explicit FairShareQueue(size_t lanes);
+
+        /// <summary> Adds a tenant. </summary>
+        /// <param name="weight"> The number of tasks of each turn of the tenant, at least 1. </param>
+        /// <param name="maxConcurrency"> The maximum number of running tasks of the tenant, 0 for no cap. </param>
+        /// <returns> The tenant index, tenants are numbered in the order they are added. </returns>
+        size_t AddTenant(uint32_t weight, uint32_t maxConcurrency);
+
+        /// <summary> Gets the number of tenants. </summary>
+        size_t GetTenantCount() const;
+
+        /// <summary> Queues a task of a tenant. </summary>
+        void Push(size_t lane, size_t tenant, std::shared_ptr<Task> task);
+
+        /// <summary> Takes the next task, and counts it as running if its tenant has a cap. </summary>
+        /// <param name="lane"> Receives the lane of the task. </param>
+        /// <returns> The task, nullptr if there is none, or if all tenants with queued tasks are at their cap. </returns>
+        std::shared_ptr<Task> Pop(size_t& lane);
+
+        /// <summary> Counts a task of a tenant as running, if it's below its cap, for tasks that skip the queue. </summary>
+        /// <returns> False if the tenant is at its cap, then the task should be queued. </returns>
+        bool TryAcquire(size_t tenant);
+
+        /// <summary> Ends a running task of a tenant which has a cap, counted by Pop() or TryAcquire(). </summary>
+        void Release(size_t tenant);
+
+        /// <summary> Gets the number of running tasks of a tenant, which are only counted for tenants with a cap. </summary>
+        uint32_t GetRunning(size_t tenant) const;
+
+        /// <summary> Gets the number of queued tasks. </summary>
+        size_t GetSize() const;
+
+    private:
+
+        struct Tenant {
+            uint32_t weight;
+            uint32_t maxConcurrency;
+            uint32_t running;
+        };
+
+        /// <summary> Tasks of a tenant in a lane, and what is left of its current turn. </summary>
+        struct TenantTasks {
+            std::queue<std::shared_ptr<Task>> tasks;
+            uint32_t deficit = 0;
+        };
+
+        struct Lane {
+            /// <summary> Indexed by tenant. </summary>
+            std::vector<TenantTasks> tenants;
+
+            /// <summary> Tenants with queued tasks, in the order of their turns. </summary>
+            std::vector<size_t> active;
+
+            /// <summary> The position in active of the tenant whose turn it is. </summary>
+            size_t current = 0;
+        };
+
+        bool IsAtCap(const Tenant& tenant) const;
+
+        std::vector<Tenant> _tenants;
+        std::vector<Lane> _lanes;
+        size_t _size;
+    };
+}
+}
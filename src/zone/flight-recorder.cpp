@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "flight-recorder.h"
+#include "clock.h"
+
+#include <platform/process.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+using namespace napa::zone;
+
+constexpr size_t FlightEvent::MAX_NAME_LENGTH;
+constexpr size_t FlightRecorder::RING_SIZE;
+
+namespace {
+
+    /// <summary> The events of a thread, written by the thread only. </summary>
+    struct Ring {
+
+        /// <summary> Number of events written, the next one goes at its index modulo RING_SIZE. </summary>
+        std::atomic<uint64_t> count { 0 };
+
+        /// <summary> Numbers threads in the order they first recorded, starting at 1. </summary>
+        std::atomic<uint32_t> thread { 0 };
+
+        /// <summary> Whether a live thread writes into the ring, cleared when it exits. </summary>
+        std::atomic<bool> owned { true };
+
+        FlightEvent events[FlightRecorder::RING_SIZE];
+    };
+
+    /// <summary> Max number of rings, threads beyond which while all rings are owned don't record. </summary>
+    constexpr size_t MAX_RINGS = 4096;
+
+    /// <summary> Rings registered so far, leaked as threads may record while static objects are destroyed. </summary>
+    std::atomic<Ring*> _rings[MAX_RINGS];
+    std::atomic<size_t> _ringCount(0);
+    std::atomic<uint32_t> _nextThread(1);
+
+    /// <summary> The dump directory, a fixed buffer so that dumping doesn't race with allocations or locks. </summary>
+    char _directory[1024] = { 0 };
+
+    /// <summary> Takes over the ring of an exited thread, or registers a new one. </summary>
+    Ring* AcquireRing() {
+        auto count = std::min(_ringCount.load(std::memory_order_acquire), MAX_RINGS);
+        for (size_t i = 0; i < count; ++i) {
+            auto ring = _rings[i].load(std::memory_order_acquire);
+            auto owned = false;
+            if (ring != nullptr && ring->owned.compare_exchange_strong(owned, true)) {
+                ring->count.store(0, std::memory_order_relaxed);
+                ring->thread.store(_nextThread++, std::memory_order_relaxed);
+                return ring;
+            }
+        }
+
+        auto index = _ringCount++;
+        if (index >= MAX_RINGS) {
+            return nullptr;
+        }
+        auto ring = new Ring();
+        ring->thread.store(_nextThread++, std::memory_order_relaxed);
+        _rings[index].store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    /// <summary> The ring of a thread, released when the thread exits. </summary>
+    struct ThreadRing {
+        Ring* ring = nullptr;
+        bool acquired = false;
+
+        ~ThreadRing() {
+            if (ring != nullptr) {
+                ring->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    const char* GetTypeName(FlightEventType type) {
+        switch (type) {
+            case FlightEventType::TASK_START: return "task-start";
+            case FlightEventType::TASK_END: return "task-end";
+            case FlightEventType::GC_START: return "gc-start";
+            case FlightEventType::GC_END: return "gc-end";
+            case FlightEventType::QUEUE_DEPTH: return "queue-depth";
+            default: return "unknown";
+        }
+    }
+
+    /// <summary> Copies a string at a position of the name, returning the position after it. </summary>
+    size_t CopyName(char* name, size_t position, const char* source) {
+        while (position < FlightEvent::MAX_NAME_LENGTH && *source != '\0') {
+            name[position++] = *source++;
+        }
+        return position;
+    }
+}
+
+void FlightRecorder::Record(FlightEventType type, uint64_t value, const char* name, const char* qualifier) {
+    thread_local ThreadRing threadRing;
+    if (!threadRing.acquired) {
+        threadRing.ring = AcquireRing();
+        threadRing.acquired = true;
+    }
+
+    auto ring = threadRing.ring;
+    if (ring == nullptr) {
+        return;
+    }
+
+    // Only this thread writes the count, the release store publishes the event to dumps.
+    auto count = ring->count.load(std::memory_order_relaxed);
+    auto& event = ring->events[count % RING_SIZE];
+    event.time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::CoarseNow().time_since_epoch()).count();
+    event.value = value;
+    event.type = type;
+
+    size_t length = 0;
+    if (name != nullptr) {
+        length = CopyName(event.name, length, name);
+    }
+    if (qualifier != nullptr) {
+        length = CopyName(event.name, length, ":");
+        length = CopyName(event.name, length, qualifier);
+    }
+    event.name[length] = '\0';
+
+    ring->count.store(count + 1, std::memory_order_release);
+}
+
+void FlightRecorder::SetDirectory(const std::string& directory) {
+    snprintf(_directory, sizeof(_directory), "%s", directory.c_str());
+}
+
+std::string FlightRecorder::Dump(const char* reason) {
+    char path[sizeof(_directory) + 64];
+    snprintf(path, sizeof(path), "%s%snapa-flight-%d-%lld.log",
+        _directory,
+        _directory[0] == '\0' ? "" : "/",
+        static_cast<int>(platform::Getpid()),
+        static_cast<long long>(std::time(nullptr)));
+
+    auto file = fopen(path, "w");
+    if (file == nullptr) {
+        return std::string();
+    }
+    Dump(reason, file);
+    fclose(file);
+    return path;
+}
+
+void FlightRecorder::Dump(const char* reason, FILE* file) {
+    auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::CoarseNow().time_since_epoch()).count();
+    fprintf(file, "napa flight recorder, pid %d: %s\n", static_cast<int>(platform::Getpid()), reason);
+    fprintf(file, "Times are in milliseconds before the dump, at the resolution of the coarse clock.\n");
+
+    auto ringCount = std::min(_ringCount.load(std::memory_order_acquire), MAX_RINGS);
+    for (size_t i = 0; i < ringCount; ++i) {
+        auto ring = _rings[i].load(std::memory_order_acquire);
+        if (ring == nullptr) {
+            continue;
+        }
+
+        auto count = ring->count.load(std::memory_order_acquire);
+        if (count == 0) {
+            continue;
+        }
+        fprintf(file, "\nthread %u%s:\n", ring->thread.load(std::memory_order_relaxed),
+            ring->owned.load(std::memory_order_relaxed) ? "" : " (exited)");
+
+        auto first = count > RING_SIZE ? count - RING_SIZE : 0;
+        for (auto j = first; j < count; ++j) {
+            const auto& event = ring->events[j % RING_SIZE];
+            fprintf(file, "%12.3f %-12s %-20llu %.*s\n",
+                static_cast<double>(now - event.time) / 1e6,
+                GetTypeName(event.type),
+                static_cast<unsigned long long>(event.value),
+                static_cast<int>(FlightEvent::MAX_NAME_LENGTH),
+                event.name);
+        }
+    }
+    fflush(file);
+}
@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Kinds of events kept by the flight recorder. </summary>
+    enum class FlightEventType : uint8_t {
+
+        /// <summary> A worker started a call, value is the worker id and name is 'module:function'. </summary>
+        TASK_START,
+
+        /// <summary> A worker finished a call. </summary>
+        TASK_END,
+
+        /// <summary> A garbage collection started, name is its type. </summary>
+        GC_START,
+
+        /// <summary> A garbage collection ended, value is the used heap size in bytes. </summary>
+        GC_END,
+
+        /// <summary> The number of calls queued in a zone changed, value is the depth and name the priority. </summary>
+        QUEUE_DEPTH
+    };
+
+    /// <summary> An event of the flight recorder, copied in full so it outlives what it describes. </summary>
+    struct FlightEvent {
+
+        /// <summary> Max length of the name, longer ones are truncated. </summary>
+        static constexpr size_t MAX_NAME_LENGTH = 47;
+
+        /// <summary> Time in nanoseconds of the coarse monotonic clock. </summary>
+        int64_t time;
+
+        uint64_t value;
+        FlightEventType type;
+        char name[MAX_NAME_LENGTH + 1];
+    };
+
+    /// <summary> Always-on recorder of the most recent events of each thread, dumped to a file when V8 hits a fatal error. </summary>
+    /// <remarks>
+    ///     Each thread writes into its own fixed ring of events with no lock and no allocation, which costs a read of the
+    ///     coarse clock and a copy of the name, so it stays on in production. Rings are registered once per thread and
+    ///     taken over by new threads after their thread exits. Dumps read rings while their threads may still write,
+    ///     as the process is going down, so the event being written at the time may be torn.
+    ///     It's exposed in napa.dll, as isolates configured by the binding of Node dump it as well.
+    /// </remarks>
+    class NAPA_API FlightRecorder {
+    public:
+
+        /// <summary> Number of events each thread keeps. </summary>
+        static constexpr size_t RING_SIZE = 256;
+
+        /// <summary> Records an event of the calling thread. </summary>
+        /// <param name="type"> The kind of event. </param>
+        /// <param name="value"> The value of the event, per its type. </param>
+        /// <param name="name"> The name of the event, may be nullptr. </param>
+        /// <param name="qualifier"> Appended to the name after a ':', may be nullptr. </param>
+        static void Record(FlightEventType type, uint64_t value = 0, const char* name = nullptr, const char* qualifier = nullptr);
+
+        /// <summary> Sets the directory dumps are written to, the current directory if empty. </summary>
+        static void SetDirectory(const std::string& directory);
+
+        /// <summary> Dumps the events of all threads to a new file 'napa-flight-<pid>-<time>.log' in the dump directory. </summary>
+        /// <param name="reason"> The reason of the dump, written in its header. </param>
+        /// <returns> The path of the dump, empty if it couldn't be written. </returns>
+        static std::string Dump(const char* reason);
+
+        /// <summary> Dumps the events of all threads to a file, oldest first per thread. </summary>
+        static void Dump(const char* reason, FILE* file);
+    };
+
+    /// <summary> Records the start and the end of a task on the calling thread. </summary>
+    class FlightTaskScope {
+    public:
+        FlightTaskScope(uint32_t workerId, const char* module, const char* function) :
+            _workerId(workerId) {
+            FlightRecorder::Record(FlightEventType::TASK_START, workerId, module, function);
+        }
+
+        ~FlightTaskScope() {
+            FlightRecorder::Record(FlightEventType::TASK_END, _workerId);
+        }
+
+    private:
+        uint32_t _workerId;
+    };
+}
+}
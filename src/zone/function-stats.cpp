@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "function-stats.h"
+
+#include <map>
+#include <utility>
+
+using namespace napa;
+using namespace napa::zone;
+
+constexpr size_t FunctionStatsTable::DEFAULT_SHARD_CAPACITY;
+constexpr const char* FunctionStatsTable::OTHER_FUNCTION;
+
+namespace {
+
+    /// <summary> FNV-1a hash of a module and a function name. </summary>
+    size_t Hash(const char* module, const char* function) {
+        uint64_t hash = 14695981039346656037ull;
+        for (auto p = module; *p != '\0'; ++p) {
+            hash = (hash ^ static_cast<uint8_t>(*p)) * 1099511628211ull;
+        }
+        hash = (hash ^ ':') * 1099511628211ull;
+        for (auto p = function; *p != '\0'; ++p) {
+            hash = (hash ^ static_cast<uint8_t>(*p)) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+
+    /// <summary> Smallest power of two above a capacity, so a slot is always left free to end probes. </summary>
+    size_t GetSlotCount(size_t capacity) {
+        size_t count = 2;
+        while (count <= capacity) {
+            count <<= 1;
+        }
+        return count;
+    }
+
+    /// <summary> Index of the histogram bucket of an execution time, see napa_function_stats. </summary>
+    size_t GetBucket(std::chrono::nanoseconds time) {
+        auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+        size_t bucket = 0;
+        for (int64_t bound = 10; bucket < NAPA_FUNCTION_STATS_BUCKETS - 1 && microseconds >= bound; bound *= 10) {
+            ++bucket;
+        }
+        return bucket;
+    }
+}
+
+FunctionStatsTable::Entry::Entry(const char* module, const char* function) :
+    _module(module),
+    _function(function),
+    _calls(0),
+    _totalTime(0),
+    _maxTime(0),
+    _errors(0),
+    _timeouts(0) {
+
+    for (auto& count : _histogram) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void FunctionStatsTable::Entry::RecordExecution(std::chrono::nanoseconds time) {
+    // The owning worker is the only writer, loads and stores save the locked instructions of increments.
+    auto nanoseconds = static_cast<uint64_t>(time.count() > 0 ? time.count() : 0);
+    _calls.store(_calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _totalTime.store(_totalTime.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+    if (nanoseconds > _maxTime.load(std::memory_order_relaxed)) {
+        _maxTime.store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    auto& count = _histogram[GetBucket(time)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void FunctionStatsTable::Entry::RecordOutcome(ResultCode code) {
+    if (code == NAPA_RESULT_TIMEOUT) {
+        _timeouts.fetch_add(1, std::memory_order_relaxed);
+    } else if (code != NAPA_RESULT_SUCCESS) {
+        _errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FunctionStatsTable::Shard::Shard(size_t capacity) :
+    slots(new std::atomic<Entry*>[GetSlotCount(capacity)]),
+    other("", OTHER_FUNCTION),
+    size(0) {
+
+    for (size_t i = 0; i < GetSlotCount(capacity); ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+FunctionStatsTable::FunctionStatsTable(uint32_t workerCapacity, size_t shardCapacity) :
+    _capacity(shardCapacity),
+    _mask(GetSlotCount(shardCapacity) - 1) {
+
+    _shards.reserve(workerCapacity);
+    for (uint32_t i = 0; i < workerCapacity; ++i) {
+        _shards.emplace_back(std::make_unique<Shard>(shardCapacity));
+    }
+}
+
+FunctionStatsTable::~FunctionStatsTable() {
+    for (auto& shard : _shards) {
+        for (size_t i = 0; i <= _mask; ++i) {
+            delete shard->slots[i].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+FunctionStatsTable::Entry* FunctionStatsTable::GetEntry(WorkerId workerId, const char* module, const char* function) {
+    if (workerId >= _shards.size()) {
+        return nullptr;
+    }
+
+    auto& shard = *_shards[workerId];
+    for (auto i = Hash(module, function); ; ++i) {
+        auto& slot = shard.slots[i & _mask];
+        auto entry = slot.load(std::memory_order_relaxed);
+        if (entry == nullptr) {
+            // A slot is always left free, so probes end, and functions beyond the capacity share an entry.
+            if (shard.size >= _capacity) {
+                return &shard.other;
+            }
+            entry = new Entry(module, function);
+            slot.store(entry, std::memory_order_release);
+            ++shard.size;
+            return entry;
+        }
+        if (entry->_function == function && entry->_module == module) {
+            return entry;
+        }
+    }
+}
+
+std::vector<napa::FunctionStats> FunctionStatsTable::GetStats() const {
+    std::map<std::pair<std::string, std::string>, FunctionStats> merged;
+    auto merge = [&merged](const Entry& entry) {
+        auto calls = entry._calls.load(std::memory_order_relaxed);
+        auto errors = entry._errors.load(std::memory_order_relaxed);
+        auto timeouts = entry._timeouts.load(std::memory_order_relaxed);
+        if (calls == 0 && errors == 0 && timeouts == 0) {
+            return;
+        }
+
+        auto inserted = merged.emplace(std::make_pair(entry._module, entry._function), FunctionStats());
+        auto& stats = inserted.first->second;
+        if (inserted.second) {
+            stats.module = entry._module;
+            stats.function = entry._function;
+            stats.calls = stats.errors = stats.timeouts = stats.totalTime = stats.maxTime = 0;
+            stats.histogram.fill(0);
+        }
+        stats.calls += calls;
+        stats.errors += errors;
+        stats.timeouts += timeouts;
+        stats.totalTime += entry._totalTime.load(std::memory_order_relaxed);
+        auto maxTime = entry._maxTime.load(std::memory_order_relaxed);
+        if (maxTime > stats.maxTime) {
+            stats.maxTime = maxTime;
+        }
+        for (size_t i = 0; i < NAPA_FUNCTION_STATS_BUCKETS; ++i) {
+            stats.histogram[i] += entry._histogram[i].load(std::memory_order_relaxed);
+        }
+    };
+
+    for (const auto& shard : _shards) {
+        for (size_t i = 0; i <= _mask; ++i) {
+            auto entry = shard->slots[i].load(std::memory_order_acquire);
+            if (entry != nullptr) {
+                merge(*entry);
+            }
+        }
+        merge(shard->other);
+    }
+
+    std::vector<FunctionStats> stats;
+    stats.reserve(merged.size());
+    for (auto& function : merged) {
+        stats.push_back(std::move(function.second));
+    }
+    return stats;
+}
@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "worker.h"
+
+#include <napa/exports.h>
+#include <napa/types.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Execution statistics of the functions a zone ran, keyed by module and function. </summary>
+    /// <remarks>
+    ///     Each worker owns a shard, a fixed open addressing table of entries, which only the worker adds entries to
+    ///     and times calls on, with atomic stores and no lock. An entry is allocated the first time a worker runs a
+    ///     function, functions beyond the capacity of a shard are counted in its entry '(other)'. Outcomes are counted
+    ///     by whichever thread finishes a call, with atomic increments. Reads merge the shards of all workers while
+    ///     they run calls, so the counters of a function may be apart from each other by the calls in flight.
+    ///     It's exposed in napa.dll, as zones are queried from the binding of Node as well.
+    /// </remarks>
+    class NAPA_API FunctionStatsTable {
+    public:
+
+        /// <summary> Number of functions each worker keeps apart. </summary>
+        static constexpr size_t DEFAULT_SHARD_CAPACITY = 256;
+
+        /// <summary> Function name of the entry counting functions beyond the capacity of a shard. </summary>
+        static constexpr const char* OTHER_FUNCTION = "(other)";
+
+        /// <summary> Statistics of a function on a worker. </summary>
+        class Entry {
+        public:
+            Entry(const char* module, const char* function);
+
+            /// <summary> Non-copyable. </summary>
+            Entry(const Entry&) = delete;
+            Entry& operator=(const Entry&) = delete;
+
+            /// <summary> Records the execution time of a call, only called by the worker owning the entry. </summary>
+            void RecordExecution(std::chrono::nanoseconds time);
+
+            /// <summary> Counts the outcome of a call, called by any thread. Successes are not counted apart. </summary>
+            void RecordOutcome(ResultCode code);
+
+        private:
+            friend class FunctionStatsTable;
+
+            std::string _module;
+            std::string _function;
+
+            /// <summary> Written by the owning worker only. </summary>
+            std::atomic<uint64_t> _calls;
+            std::atomic<uint64_t> _totalTime;
+            std::atomic<uint64_t> _maxTime;
+            std::array<std::atomic<uint64_t>, NAPA_FUNCTION_STATS_BUCKETS> _histogram;
+
+            /// <summary> Written by any thread. </summary>
+            std::atomic<uint64_t> _errors;
+            std::atomic<uint64_t> _timeouts;
+        };
+
+        /// <summary> Constructor. </summary>
+        /// <param name="workerCapacity"> The maximum number of workers of the zone. </param>
+        /// <param name="shardCapacity"> The number of functions each worker keeps apart. </param>
+        FunctionStatsTable(uint32_t workerCapacity, size_t shardCapacity = DEFAULT_SHARD_CAPACITY);
+
+        /// <summary> Non-copyable. </summary>
+        FunctionStatsTable(const FunctionStatsTable&) = delete;
+        FunctionStatsTable& operator=(const FunctionStatsTable&) = delete;
+
+        ~FunctionStatsTable();
+
+        /// <summary> Gets the entry of a function on a worker, adding it on first use. Only called by the worker. </summary>
+        /// <returns> The entry, which lives as long as the table, or nullptr if the worker id is beyond the capacity. </returns>
+        Entry* GetEntry(WorkerId workerId, const char* module, const char* function);
+
+        /// <summary> Gets the statistics of each function, merged over workers. </summary>
+        std::vector<FunctionStats> GetStats() const;
+
+    private:
+
+        /// <summary> Entries of a worker, slots are published with a release store once their entry is set up. </summary>
+        struct Shard {
+            std::unique_ptr<std::atomic<Entry*>[]> slots;
+            Entry other;
+
+            /// <summary> Number of slots taken, only used by the owning worker. </summary>
+            size_t size;
+
+            explicit Shard(size_t capacity);
+        };
+
+        std::vector<std::unique_ptr<Shard>> _shards;
+        size_t _capacity;
+        size_t _mask;
+    };
+}
+}
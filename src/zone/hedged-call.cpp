@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "hedged-call.h"
+
+using namespace napa;
+using namespace napa::zone;
+
+HedgedCall::HedgedCall(ExecuteCallback callback, CancellationToken* token) :
+    _callback(std::move(callback)),
+    _finished(false),
+    _hedged(false),
+    _handlerId(0) {
+
+    _tokens[PRIMARY] = std::make_shared<CancellationToken>();
+    _tokens[HEDGE] = std::make_shared<CancellationToken>();
+    if (token != nullptr) {
+        _token = token->shared_from_this();
+    }
+}
+
+ExecuteCallback HedgedCall::GetCallback(Attempt attempt) {
+    auto self = shared_from_this();
+    return [self, attempt](Result result) {
+        self->Finish(attempt, std::move(result));
+    };
+}
+
+CancellationToken* HedgedCall::GetToken(Attempt attempt) {
+    return _tokens[attempt].get();
+}
+
+void HedgedCall::Arm(std::chrono::milliseconds delay, std::function<void()> start) {
+    // Registered out of the lock, as a token that is already cancelled calls the handler right away.
+    CancellationToken::HandlerId handlerId = 0;
+    if (_token != nullptr) {
+        std::weak_ptr<HedgedCall> weak = shared_from_this();
+        handlerId = _token->Register([weak]() {
+            auto call = weak.lock();
+            if (call != nullptr) {
+                call->_tokens[PRIMARY]->Cancel();
+                call->_tokens[HEDGE]->Cancel();
+            }
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_finished) {
+            _handlerId = handlerId;
+            _start = std::move(start);
+
+            // The timer keeps the call, Finish drops it. Callbacks must not destroy their timer,
+            // which can't happen while the timer keeps the call.
+            auto self = shared_from_this();
+            _timer = std::make_unique<Timer>([self]() {
+                std::function<void()> start;
+                {
+                    std::lock_guard<std::mutex> lock(self->_lock);
+                    start.swap(self->_start);
+                }
+                if (start != nullptr && !self->_finished) {
+                    self->_hedged = true;
+                    start();
+                }
+            }, delay);
+            _timer->Start();
+            return;
+        }
+    }
+
+    // Finished before it was armed, e.g. rejected by an overloaded zone.
+    if (handlerId != 0) {
+        _token->Unregister(handlerId);
+    }
+}
+
+bool HedgedCall::IsHedged() const {
+    return _hedged;
+}
+
+void HedgedCall::Finish(Attempt attempt, Result result) {
+    if (_finished.exchange(true)) {
+        return;
+    }
+
+    // The other attempt is rejected right away, its result is dropped above.
+    _tokens[attempt == PRIMARY ? HEDGE : PRIMARY]->Cancel();
+
+    std::unique_ptr<Timer> timer;
+    std::function<void()> start;
+    CancellationToken::HandlerId handlerId;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        timer = std::move(_timer);
+        start = std::move(_start);
+        handlerId = _handlerId;
+        _handlerId = 0;
+    }
+    if (handlerId != 0) {
+        _token->Unregister(handlerId);
+    }
+
+    // Destroying the timer waits for its callback if it's running, the start function drops a hedge not started.
+    timer.reset();
+    start = nullptr;
+
+    _callback(std::move(result));
+}
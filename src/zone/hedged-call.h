@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "cancellation-token.h"
+#include "timer.h"
+
+#include <napa/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> A call run by two attempts, the second started only if the first hasn't finished after a delay. </summary>
+    /// <remarks>
+    ///     The first result of either attempt completes the call, and the other attempt is cancelled through its token.
+    ///     So a call stalled on a slow worker, e.g. one collecting garbage, gets a second chance on another worker,
+    ///     at the cost of running twice when it's slow anyway. Only idempotent functions should be hedged.
+    ///     Cancelling the token of the call cancels both attempts.
+    /// </remarks>
+    class HedgedCall : public std::enable_shared_from_this<HedgedCall> {
+    public:
+
+        /// <summary> Attempts of a call. </summary>
+        enum Attempt {
+            PRIMARY = 0,
+            HEDGE
+        };
+
+        /// <summary> Constructor. </summary>
+        /// <param name="callback"> Receives the first result of the attempts. </param>
+        /// <param name="token"> The token of the call, which cancels both attempts, or null for none. </param>
+        HedgedCall(ExecuteCallback callback, CancellationToken* token);
+
+        /// <summary> Non-copyable. </summary>
+        HedgedCall(const HedgedCall&) = delete;
+        HedgedCall& operator=(const HedgedCall&) = delete;
+
+        /// <summary> Gets the callback of an attempt. </summary>
+        ExecuteCallback GetCallback(Attempt attempt);
+
+        /// <summary> Gets the token that cancels an attempt, owned by the call. </summary>
+        CancellationToken* GetToken(Attempt attempt);
+
+        /// <summary> Starts the hedge with a function after a delay, unless the call finished by then. </summary>
+        /// <param name="delay"> The delay since the primary attempt started. </param>
+        /// <param name="start">
+        ///     Starts the hedge, on the timers thread so it should only schedule it.
+        ///     It's dropped once the call finishes, thus it may keep what the hedge uses until then.
+        /// </param>
+        void Arm(std::chrono::milliseconds delay, std::function<void()> start);
+
+        /// <summary> Whether the hedge was started. </summary>
+        bool IsHedged() const;
+
+    private:
+        /// <summary> Completes the call with the first result, and cancels the other attempt. </summary>
+        void Finish(Attempt attempt, Result result);
+
+        ExecuteCallback _callback;
+        std::atomic<bool> _finished;
+        std::atomic<bool> _hedged;
+
+        std::shared_ptr<CancellationToken> _tokens[2];
+
+        /// <summary> Token of the call, and the id of the handler that cancels both attempts. </summary>
+        std::shared_ptr<CancellationToken> _token;
+        CancellationToken::HandlerId _handlerId;
+
+        /// <summary> Guards the timer and the start function, which Finish drops. </summary>
+        std::mutex _lock;
+
+        /// <summary> Timer starting the hedge, which keeps the call until the call finishes. </summary>
+        std::unique_ptr<Timer> _timer;
+        std::function<void()> _start;
+    };
+}
+}
@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "idle-gc-policy.h"
+
+#include <algorithm>
+
+using namespace napa::zone;
+
+constexpr std::chrono::microseconds IdleGcPolicy::MIN_STEP_BUDGET;
+
+IdleGcPolicy::IdleGcPolicy(const settings::ZoneSettings& settings) :
+    _stepTime(std::chrono::milliseconds(settings.idleGcTime)),
+    _fullGcDelay(std::chrono::milliseconds(settings.idleGcFullTime)),
+    _expectedIdleTime(-1) {
+}
+
+bool IdleGcPolicy::IsEnabled() const {
+    return _stepTime.count() > 0 || _fullGcDelay.count() > 0;
+}
+
+std::chrono::microseconds IdleGcPolicy::GetStepBudget() const {
+    if (_stepTime.count() == 0) {
+        return std::chrono::microseconds(0);
+    }
+
+    // Until the first idle period ended, nothing tells it's short.
+    auto budget = _expectedIdleTime.count() < 0 ? _stepTime : std::min(_stepTime, _expectedIdleTime / 2);
+    return budget >= MIN_STEP_BUDGET ? budget : std::chrono::microseconds(0);
+}
+
+std::chrono::microseconds IdleGcPolicy::GetFullGcDelay() const {
+    return _fullGcDelay;
+}
+
+void IdleGcPolicy::EndIdlePeriod(std::chrono::microseconds idleTime) {
+    // Weighs the last period by 1/4, which follows changes of traffic within a few periods.
+    _expectedIdleTime = _expectedIdleTime.count() < 0 ? idleTime : (_expectedIdleTime * 3 + idleTime) / 4;
+}
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "settings/settings.h"
+
+#include <chrono>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Decides how much garbage collection work an idle worker does, from the zone settings and its recent idle periods. </summary>
+    /// <remarks>
+    ///     Idle steps are given a budget of idleGcTime, but no more than half of the expected idle time, so the GC
+    ///     work doesn't delay the next task. The expected idle time is a moving average of past idle periods.
+    ///     A worker that stays idle for idleGcFullTime runs a full GC, once per idle period.
+    /// </remarks>
+    class IdleGcPolicy {
+    public:
+        /// <summary> Smallest budget worth an idle step, shorter idle periods are left alone. </summary>
+        static constexpr std::chrono::microseconds MIN_STEP_BUDGET = std::chrono::microseconds(1000);
+
+        /// <summary> Constructor. </summary>
+        /// <param name="settings"> The zone settings that hold the idle GC policy. </param>
+        explicit IdleGcPolicy(const settings::ZoneSettings& settings);
+
+        /// <summary> Whether idle steps or full GCs are enabled. </summary>
+        bool IsEnabled() const;
+
+        /// <summary> Gets the budget of idle steps in the current idle period, 0 if no step should run. </summary>
+        std::chrono::microseconds GetStepBudget() const;
+
+        /// <summary> Gets how long a worker stays idle before it runs a full GC, 0 if full GCs are disabled. </summary>
+        std::chrono::microseconds GetFullGcDelay() const;
+
+        /// <summary> Records the length of an idle period, once the next task arrived. </summary>
+        void EndIdlePeriod(std::chrono::microseconds idleTime);
+
+    private:
+        std::chrono::microseconds _stepTime;
+        std::chrono::microseconds _fullGcDelay;
+
+        /// <summary> Moving average of idle periods, negative until the first one ended. </summary>
+        std::chrono::microseconds _expectedIdleTime;
+    };
+}
+}
@@ -0,0 +1,279 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "isolate-pool.h"
+#include "flight-recorder.h"
+
+#include <utils/debug.h>
+#include <v8/array-buffer-allocator.h>
+#include <v8/startup-snapshot.h>
+
+#include <napa/log.h>
+
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+    /// <summary> Spares are created with default settings. </summary>
+    const settings::ZoneSettings SPARE_SETTINGS;
+
+    /// <summary>
+    ///     V8 only takes initial heap sizes from its flags, which an isolate reads when it's created, so isolates with
+    ///     initial heap sizes are created exclusively, with the flags set meanwhile. Others are created concurrently.
+    /// </summary>
+    std::shared_timed_mutex heapFlagsLock;
+
+    /// <summary> Sets the initial heap sizes in MB that isolates are created with, 0 for the V8 defaults. </summary>
+    void SetInitialHeapFlags(uint32_t initialOldSpaceSize, uint32_t minSemiSpaceSize) {
+        auto flags = "--initial_old_space_size=" + std::to_string(initialOldSpaceSize)
+            + " --min_semi_space_size=" + std::to_string(minSemiSpaceSize);
+        v8::V8::SetFlagsFromString(flags.c_str(), static_cast<int>(flags.size()));
+    }
+
+    /// <summary> Dumps the flight recorder once, as other workers may hit fatal errors while the process goes down. </summary>
+    void DumpFlightRecorder(const char* reason) {
+        static std::atomic_flag dumped = ATOMIC_FLAG_INIT;
+        if (dumped.test_and_set()) {
+            return;
+        }
+
+        auto path = FlightRecorder::Dump(reason);
+        if (path.empty()) {
+            LOG_ERROR("V8", "Failed to write the flight recorder dump.");
+        } else {
+            LOG_ERROR("V8", "Flight recorder dumped to %s.", path.c_str());
+        }
+    }
+}
+
+IsolatePool& IsolatePool::GetInstance() {
+    static IsolatePool pool;
+    return pool;
+}
+
+IsolatePool::IsolatePool() : _count(0) {}
+
+void IsolatePool::Reserve(size_t count, std::function<bool()> bootstrap, std::function<void()> teardown) {
+    std::lock_guard<std::mutex> lock(_lock);
+
+    _count = count;
+    _bootstrap = std::move(bootstrap);
+    _teardown = std::move(teardown);
+    if (_background == nullptr) {
+        _background = std::make_unique<SimpleThreadPool>(1);
+    }
+    _background->Execute([this]() { Refill(); });
+
+    NAPA_DEBUG("IsolatePool", "Reserving %zu spare isolates.", count);
+}
+
+std::unique_ptr<IsolatePool::Spare> IsolatePool::Adopt(const settings::ZoneSettings& settings) {
+    if (settings.maxOldSpaceSize != SPARE_SETTINGS.maxOldSpaceSize
+        || settings.maxSemiSpaceSize != SPARE_SETTINGS.maxSemiSpaceSize
+        || settings.maxExecutableSize != SPARE_SETTINGS.maxExecutableSize
+        || settings.initialOldSpaceSize != SPARE_SETTINGS.initialOldSpaceSize
+        || settings.minSemiSpaceSize != SPARE_SETTINGS.minSemiSpaceSize) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_spares.empty()) {
+        return nullptr;
+    }
+
+    auto spare = std::move(_spares.front());
+    _spares.pop_front();
+    _background->Execute([this]() { Refill(); });
+
+    return spare;
+}
+
+size_t IsolatePool::GetSpareCount() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _spares.size();
+}
+
+void IsolatePool::Clear() {
+    std::unique_lock<std::mutex> lock(_lock);
+    _count = 0;
+
+    if (_background == nullptr) {
+        return;
+    }
+
+    // Spares are torn down on the thread that created them, after any refill in progress.
+    _background->Execute([this]() {
+        std::unique_lock<std::mutex> lock(_lock);
+        auto spares = std::move(_spares);
+        lock.unlock();
+
+        for (auto& spare : spares) {
+            DisposeSpare(std::move(spare));
+        }
+    });
+
+    auto background = std::move(_background);
+    lock.unlock();
+
+    // Waits for the queued tasks.
+    background.reset();
+}
+
+void IsolatePool::Refill() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (_spares.size() >= _count) {
+                return;
+            }
+        }
+
+        auto spare = CreateSpare();
+        if (spare == nullptr) {
+            // Don't retry, bootstrap would most likely fail again.
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(_lock);
+        if (_spares.size() >= _count) {
+            // Cleared or shrunk in the meantime.
+            lock.unlock();
+            DisposeSpare(std::move(spare));
+            return;
+        }
+        _spares.emplace_back(std::move(spare));
+    }
+}
+
+std::unique_ptr<IsolatePool::Spare> IsolatePool::CreateSpare() {
+    INIT_WORKER_CONTEXT();
+
+    auto spare = std::make_unique<Spare>();
+    spare->isolate = CreateIsolate(SPARE_SETTINGS);
+
+    bool bootstrapped = false;
+    {
+        v8::Locker locker(spare->isolate);
+        ConfigureIsolate(spare->isolate, SPARE_SETTINGS);
+
+        v8::Isolate::Scope isolateScope(spare->isolate);
+        v8::HandleScope handleScope(spare->isolate);
+        auto context = v8::Context::New(spare->isolate);
+        context->SetSecurityToken(v8::Undefined(spare->isolate));
+        v8::Context::Scope contextScope(context);
+
+        bootstrapped = _bootstrap();
+        if (bootstrapped) {
+            spare->context.Reset(spare->isolate, context);
+        } else {
+            _teardown();
+        }
+    }
+    spare->workerContext = WorkerContext::Detach();
+
+    if (!bootstrapped) {
+        LOG_ERROR("IsolatePool", "Failed to bootstrap a spare isolate.");
+        spare->isolate->Dispose();
+        return nullptr;
+    }
+
+    NAPA_DEBUG("IsolatePool", "Spare isolate created.");
+    return spare;
+}
+
+void IsolatePool::DisposeSpare(std::unique_ptr<Spare> spare) {
+    {
+        v8::Locker locker(spare->isolate);
+        v8::Isolate::Scope isolateScope(spare->isolate);
+        v8::HandleScope handleScope(spare->isolate);
+        auto context = v8::Local<v8::Context>::New(spare->isolate, spare->context);
+        v8::Context::Scope contextScope(context);
+
+        WorkerContext::Attach(spare->workerContext);
+        _teardown();
+        WorkerContext::Detach();
+
+        spare->context.Reset();
+    }
+    spare->isolate->Dispose();
+}
+
+v8::Isolate* zone::CreateIsolate(const settings::ZoneSettings& settings) {
+    v8::Isolate::CreateParams createParams;
+
+    // The allocator is a global V8 setting.
+    static napa::v8_extensions::PooledArrayBufferAllocator pooledAllocator;
+#if (V8_MAJOR_VERSION == 5 && V8_MINOR_VERSION >= 5) || V8_MAJOR_VERSION > 5
+    static std::unique_ptr<v8::ArrayBuffer::Allocator> commonAllocator(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
+#else
+    static std::unique_ptr<v8::ArrayBuffer::Allocator> commonAllocator(new napa::v8_extensions::ArrayBufferAllocator());
+#endif
+    if (napa::memory::BufferPool::GetInstance().IsEnabled()) {
+        createParams.array_buffer_allocator = &pooledAllocator;
+    } else {
+        createParams.array_buffer_allocator = commonAllocator.get();
+    }
+
+    // Set the maximum V8 heap size.
+    createParams.constraints.set_max_old_space_size(settings.maxOldSpaceSize);
+    createParams.constraints.set_max_semi_space_size(settings.maxSemiSpaceSize);
+    createParams.constraints.set_max_executable_size(settings.maxExecutableSize);
+
+    // Deserialize the default context from the startup snapshot instead of running its script again.
+    createParams.snapshot_blob = v8_common::GetStartupSnapshot();
+
+    if (settings.initialOldSpaceSize == 0 && settings.minSemiSpaceSize == 0) {
+        std::shared_lock<std::shared_timed_mutex> lock(heapFlagsLock);
+        return v8::Isolate::New(createParams);
+    }
+
+    std::lock_guard<std::shared_timed_mutex> lock(heapFlagsLock);
+    SetInitialHeapFlags(settings.initialOldSpaceSize, settings.minSemiSpaceSize);
+    auto isolate = v8::Isolate::New(createParams);
+    SetInitialHeapFlags(0, 0);
+
+    return isolate;
+}
+
+void zone::ConfigureIsolate(v8::Isolate* isolate, const settings::ZoneSettings& settings) {
+    isolate->SetFatalErrorHandler([](const char* location, const char* message) {
+        LOG_ERROR("V8", "V8 Fatal error at %s. Error: %s", location, message);
+        DumpFlightRecorder("V8 fatal error");
+    });
+
+    isolate->SetOOMErrorHandler([](const char* location, bool isHeapOom) {
+        LOG_ERROR("V8", "V8 out of %s memory at %s.", isHeapOom ? "heap" : "process", location);
+        DumpFlightRecorder(isHeapOom ? "V8 out of heap memory" : "V8 out of process memory");
+    });
+
+    // Prevent V8 from aborting on uncaught exception.
+    isolate->SetAbortOnUncaughtExceptionCallback([](v8::Isolate*) {
+        LOG_ERROR("V8", "V8 uncaught exception was thrown.");
+        return false;
+    });
+
+    // V8 takes a pointer to the minimum (x86 stack grows down) allowed stack address
+    // so, capture the current top of the stack and calculate minimum allowed
+    uint32_t currentStackAddress;
+    auto limit = reinterpret_cast<uintptr_t>(&currentStackAddress) - settings.maxStackSize;
+    isolate->SetStackLimit(limit);
+
+    switch (settings.gcMode) {
+        case settings::GcMode::LATENCY:
+            isolate->SetRAILMode(v8::PERFORMANCE_RESPONSE);
+            break;
+        case settings::GcMode::THROUGHPUT:
+            isolate->SetRAILMode(v8::PERFORMANCE_LOAD);
+            break;
+        case settings::GcMode::MEMORY:
+            // Background isolates are tuned by V8 for memory instead of latency.
+            isolate->IsolateInBackgroundNotification();
+            break;
+        default:
+            break;
+    }
+}
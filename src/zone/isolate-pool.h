@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "simple-thread-pool.h"
+#include "worker-context.h"
+#include "settings/settings.h"
+
+#include <v8.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Creates an isolate with the heap constraints of zone settings. </summary>
+    v8::Isolate* CreateIsolate(const settings::ZoneSettings& settings);
+
+    /// <summary> Configures an isolate for the current thread, must be called again if the isolate moves to another thread. </summary>
+    void ConfigureIsolate(v8::Isolate* isolate, const settings::ZoneSettings& settings);
+
+    /// <summary> Process-wide pool of spare isolates, created and bootstrapped ahead of time for new workers to adopt. </summary>
+    /// <remarks>
+    ///     Spares are created one at a time on a background thread, with default heap constraints. Only workers of zones
+    ///     that keep the default heap constraints can adopt them. The pool refills itself after each adoption.
+    /// </remarks>
+    class IsolatePool {
+    public:
+
+        /// <summary> A bootstrapped isolate, unlocked and not entered by any thread. </summary>
+        struct Spare {
+            /// <summary> The isolate. </summary>
+            v8::Isolate* isolate;
+
+            /// <summary> The context that was bootstrapped. </summary>
+            v8::Persistent<v8::Context> context;
+
+            /// <summary> The worker context items bound to the isolate, e.g. its module loader. </summary>
+            WorkerContext::Items workerContext;
+        };
+
+        /// <summary> Gets the process-wide pool. </summary>
+        static IsolatePool& GetInstance();
+
+        /// <summary> Starts keeping a number of spare isolates. </summary>
+        /// <param name="count"> The number of spares. </param>
+        /// <param name="bootstrap">
+        ///     Runs in the context of a new isolate to bootstrap it, and returns whether it succeeded.
+        ///     Worker context items it sets stay bound to the isolate.
+        /// </param>
+        /// <param name="teardown"> Runs in the context of a spare isolate to release its worker context items, before it's disposed. </param>
+        void Reserve(size_t count, std::function<bool()> bootstrap, std::function<void()> teardown);
+
+        /// <summary> Takes a spare isolate, for a worker to serve a zone with given settings. </summary>
+        /// <returns> The spare, or nullptr if none is ready or the zone settings need other heap constraints. </returns>
+        std::unique_ptr<Spare> Adopt(const settings::ZoneSettings& settings);
+
+        /// <summary> Gets the number of spares ready for adoption. </summary>
+        size_t GetSpareCount() const;
+
+        /// <summary> Disposes all spares and stops refilling. </summary>
+        void Clear();
+
+    private:
+        IsolatePool();
+
+        /// <summary> Creates spares until the pool is full, on the background thread. </summary>
+        void Refill();
+
+        /// <summary> Creates and bootstraps a spare, returns nullptr on failure. </summary>
+        std::unique_ptr<Spare> CreateSpare();
+
+        /// <summary> Tears down and disposes a spare. </summary>
+        void DisposeSpare(std::unique_ptr<Spare> spare);
+
+        size_t _count;
+        std::function<bool()> _bootstrap;
+        std::function<void()> _teardown;
+        std::deque<std::unique_ptr<Spare>> _spares;
+        std::unique_ptr<SimpleThreadPool> _background;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "memory-pressure.h"
+
+#include <memory/buffer-pool.h>
+#include <memory/thread-caching-allocator.h>
+#include <napa/v8-helpers.h>
+
+#include <atomic>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace napa;
+
+namespace {
+    std::atomic<MemoryPressureLevel> _level(MEMORY_PRESSURE_NONE);
+}
+
+void zone::SetMemoryPressureLevel(MemoryPressureLevel level) {
+    _level = level;
+}
+
+MemoryPressureLevel zone::GetMemoryPressureLevel() {
+    return _level;
+}
+
+void zone::ApplyMemoryPressure(v8::Isolate* isolate) {
+    auto level = GetMemoryPressureLevel();
+
+    // The notification collects garbage at once when the calling thread holds the isolate, as workers do.
+    isolate->MemoryPressureNotification(static_cast<v8::MemoryPressureLevel>(level));
+    if (level == MEMORY_PRESSURE_CRITICAL) {
+        memory::BufferPool::GetInstance().FlushThreadCache();
+        memory::thread_caching::FlushThreadCache();
+
+        // Buffers flushed by workers after ReleaseAllocatorCaches() ran are freed by the workers themselves.
+        memory::BufferPool::GetInstance().Trim();
+    }
+}
+
+void zone::NotifyJavaScriptOfMemoryPressure(v8::Isolate* isolate) {
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    v8::Local<v8::Value> hook;
+    if (!context->Global()->Get(context, v8_helpers::MakeV8String(isolate, "__napa_memory_pressure__")).ToLocal(&hook)
+        || !hook->IsFunction()) {
+        return;
+    }
+
+    // Errors of the hook don't concern the caller.
+    v8::TryCatch tryCatch(isolate);
+    v8::Local<v8::Value> argv[] = { v8::Integer::New(isolate, static_cast<int32_t>(GetMemoryPressureLevel())) };
+    if (hook.As<v8::Function>()->Call(context, v8::Undefined(isolate), 1, argv).IsEmpty()) {
+        tryCatch.Reset();
+    }
+}
+
+void zone::ReleaseAllocatorCaches() {
+    memory::BufferPool::GetInstance().FlushThreadCache();
+    memory::BufferPool::GetInstance().Trim();
+
+#if defined(__GLIBC__)
+    // Pages freed by allocators above, or by the GC of workers, stay in the malloc heap otherwise.
+    ::malloc_trim(0);
+#endif
+}
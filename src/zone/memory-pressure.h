@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/types.h>
+
+#include <v8.h>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Sets the memory pressure level that workers apply from now on, see napa_memory_pressure. </summary>
+    void SetMemoryPressureLevel(MemoryPressureLevel level);
+
+    /// <summary> Gets the memory pressure level last set, MEMORY_PRESSURE_NONE by default. </summary>
+    MemoryPressureLevel GetMemoryPressureLevel();
+
+    /// <summary> Notifies an isolate of the current memory pressure level, on the thread that has entered it. </summary>
+    /// <remarks>
+    ///     The level is read when it's applied rather than when it's requested, so a late interrupt doesn't bring back a
+    ///     level that is gone. At the critical level, napa allocator caches of the thread are flushed, and pooled buffers freed.
+    /// </remarks>
+    void ApplyMemoryPressure(v8::Isolate* isolate);
+
+    /// <summary> Calls '__napa_memory_pressure__' of the current context with the current level, if JavaScript defined it. </summary>
+    /// <remarks> It lets caches of JavaScript release entries, thus it's called between calls rather than from interrupts. </remarks>
+    void NotifyJavaScriptOfMemoryPressure(v8::Isolate* isolate);
+
+    /// <summary> Frees pooled buffers of the calling thread and central lists, and returns free heap memory to the OS where supported. </summary>
+    void ReleaseAllocatorCaches();
+}
+}
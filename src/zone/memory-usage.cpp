@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "memory-usage.h"
+
+#include <memory/thread-allocation-counters.h>
+
+#include <napa/log.h>
+
+#include <v8-profiler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace napa;
+
+namespace {
+
+    /// <summary> Tracks bytes reclaimed by collections of an isolate. </summary>
+    struct HeapAllocationTracker {
+        /// <summary> The tracked isolate, or nullptr if the thread tracks none. </summary>
+        v8::Isolate* isolate = nullptr;
+
+        /// <summary> Used heap size when the ongoing collection started. </summary>
+        size_t usedBeforeCollection = 0;
+
+        /// <summary> Bytes reclaimed by collections since tracking started. </summary>
+        uint64_t reclaimedBytes = 0;
+    };
+
+    /// <summary> The tracker of the calling thread, GC callbacks run on the thread of their isolate. </summary>
+    thread_local HeapAllocationTracker threadHeapAllocationTracker;
+
+    size_t GetUsedHeapSize(v8::Isolate* isolate) {
+        v8::HeapStatistics heapStatistics;
+        isolate->GetHeapStatistics(&heapStatistics);
+        return heapStatistics.used_heap_size();
+    }
+
+    void OnTrackedGcPrologue(v8::Isolate* isolate, v8::GCType, v8::GCCallbackFlags) {
+        threadHeapAllocationTracker.usedBeforeCollection = GetUsedHeapSize(isolate);
+    }
+
+    void OnTrackedGcEpilogue(v8::Isolate* isolate, v8::GCType, v8::GCCallbackFlags) {
+        auto& tracker = threadHeapAllocationTracker;
+        auto used = GetUsedHeapSize(isolate);
+        if (used < tracker.usedBeforeCollection) {
+            tracker.reclaimedBytes += tracker.usedBeforeCollection - used;
+        }
+    }
+}
+
+WorkerMemoryUsage napa::zone::GetWorkerMemoryUsage(v8::Isolate* isolate, uint32_t workerId) {
+    v8::HeapStatistics heapStatistics;
+    isolate->GetHeapStatistics(&heapStatistics);
+
+    WorkerMemoryUsage usage;
+    usage.worker_id = workerId;
+    usage.used_heap_size = heapStatistics.used_heap_size();
+    usage.total_heap_size = heapStatistics.total_heap_size();
+    usage.total_physical_size = heapStatistics.total_physical_size();
+    usage.heap_size_limit = heapStatistics.heap_size_limit();
+    usage.malloced_memory = heapStatistics.malloced_memory();
+    usage.peak_malloced_memory = heapStatistics.peak_malloced_memory();
+
+    // Adjusting by 0 returns the amount V8 currently accounts for, which includes contents of live ArrayBuffers.
+    usage.external_memory = static_cast<size_t>(std::max<int64_t>(isolate->AdjustAmountOfExternalAllocatedMemory(0), 0));
+
+    const auto& counters = memory::GetThreadAllocationCounters();
+    usage.native_allocate_count = counters.allocateCount;
+    usage.native_allocated_size = counters.allocatedSize;
+    usage.native_deallocate_count = counters.deallocateCount;
+    usage.native_deallocated_size = counters.deallocatedSize;
+    return usage;
+}
+
+WorkerHeapStatistics napa::zone::GetWorkerHeapStatistics(v8::Isolate* isolate, uint32_t workerId) {
+    v8::HeapStatistics heapStatistics;
+    isolate->GetHeapStatistics(&heapStatistics);
+
+    WorkerHeapStatistics statistics;
+    statistics.workerId = workerId;
+    statistics.totalHeapSize = heapStatistics.total_heap_size();
+    statistics.totalHeapSizeExecutable = heapStatistics.total_heap_size_executable();
+    statistics.totalPhysicalSize = heapStatistics.total_physical_size();
+    statistics.totalAvailableSize = heapStatistics.total_available_size();
+    statistics.usedHeapSize = heapStatistics.used_heap_size();
+    statistics.heapSizeLimit = heapStatistics.heap_size_limit();
+    statistics.mallocedMemory = heapStatistics.malloced_memory();
+    statistics.peakMallocedMemory = heapStatistics.peak_malloced_memory();
+    statistics.numberOfNativeContexts = heapStatistics.number_of_native_contexts();
+    statistics.numberOfDetachedContexts = heapStatistics.number_of_detached_contexts();
+
+    auto spaces = isolate->NumberOfHeapSpaces();
+    statistics.spaces.reserve(spaces);
+    for (size_t i = 0; i < spaces; ++i) {
+        v8::HeapSpaceStatistics spaceStatistics;
+        if (isolate->GetHeapSpaceStatistics(&spaceStatistics, i)) {
+            statistics.spaces.push_back({
+                spaceStatistics.space_name(),
+                spaceStatistics.space_size(),
+                spaceStatistics.space_used_size(),
+                spaceStatistics.space_available_size(),
+                spaceStatistics.physical_space_size() });
+        }
+    }
+    return statistics;
+}
+
+namespace {
+
+    /// <summary> Writes chunks of a serialized heap snapshot to a file as they come, snapshots may take GBs as one string. </summary>
+    class FileOutputStream : public v8::OutputStream {
+    public:
+        explicit FileOutputStream(FILE* file) : _file(file), _failed(false) {}
+
+        int GetChunkSize() override {
+            return 64 * 1024;
+        }
+
+        WriteResult WriteAsciiChunk(char* data, int size) override {
+            if (std::fwrite(data, 1, static_cast<size_t>(size), _file) != static_cast<size_t>(size)) {
+                _failed = true;
+                return kAbort;
+            }
+            return kContinue;
+        }
+
+        void EndOfStream() override {}
+
+        bool Failed() const {
+            return _failed;
+        }
+
+    private:
+        FILE* _file;
+        bool _failed;
+    };
+}
+
+ResultCode napa::zone::WriteHeapSnapshot(v8::Isolate* isolate, const std::string& path) {
+    auto file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        LOG_ERROR("Zone", "Cannot open \"%s\" to write a heap snapshot.", path.c_str());
+        return NAPA_RESULT_HEAP_SNAPSHOT_ERROR;
+    }
+
+    v8::HandleScope scope(isolate);
+
+    auto profiler = isolate->GetHeapProfiler();
+    auto snapshot = profiler->TakeHeapSnapshot();
+
+    FileOutputStream stream(file);
+    snapshot->Serialize(&stream, v8::HeapSnapshot::kJSON);
+
+    // Snapshots are kept by the profiler until deleted, and take as much memory as the heap.
+    const_cast<v8::HeapSnapshot*>(snapshot)->Delete();
+
+    bool failed = stream.Failed();
+    failed = std::fclose(file) != 0 || failed;
+    if (failed) {
+        LOG_ERROR("Zone", "Failed to write a heap snapshot to \"%s\".", path.c_str());
+        return NAPA_RESULT_HEAP_SNAPSHOT_ERROR;
+    }
+    return NAPA_RESULT_SUCCESS;
+}
+
+uint64_t napa::zone::GetHeapAllocationCounter(v8::Isolate* isolate) {
+    auto& tracker = threadHeapAllocationTracker;
+    if (tracker.isolate != isolate) {
+        StopHeapAllocationCounter();
+        tracker.isolate = isolate;
+        isolate->AddGCPrologueCallback(OnTrackedGcPrologue);
+        isolate->AddGCEpilogueCallback(OnTrackedGcEpilogue);
+    }
+    return GetUsedHeapSize(isolate) + tracker.reclaimedBytes;
+}
+
+void napa::zone::StopHeapAllocationCounter() {
+    auto& tracker = threadHeapAllocationTracker;
+    if (tracker.isolate != nullptr) {
+        tracker.isolate->RemoveGCPrologueCallback(OnTrackedGcPrologue);
+        tracker.isolate->RemoveGCEpilogueCallback(OnTrackedGcEpilogue);
+        tracker = HeapAllocationTracker();
+    }
+}
+
+namespace {
+
+    /// <summary> Whether the calling thread profiles allocations of its isolate. </summary>
+    thread_local bool threadAllocationProfiling = false;
+
+    /// <summary> Depth of the stacks the sampling heap profiler keeps, deeper frames are attributed to their caller at that depth. </summary>
+    constexpr int ALLOCATION_STACK_DEPTH = 64;
+
+    std::string ToStdString(v8::Local<v8::String> value) {
+        if (value.IsEmpty()) {
+            return std::string();
+        }
+        v8::String::Utf8Value utf8(value);
+        return *utf8 != nullptr ? std::string(*utf8, utf8.length()) : std::string();
+    }
+
+    /// <summary> Copies a node of the V8 call tree, its children are copied iteratively by the caller. </summary>
+    zone::AllocationProfileNode CopyNode(const v8::AllocationProfile::Node* node) {
+        zone::AllocationProfileNode copy;
+        copy.functionName = ToStdString(node->name);
+        copy.url = ToStdString(node->script_name);
+        copy.scriptId = node->script_id;
+
+        // V8 numbers lines and columns from 1, DevTools from 0, missing ones are 0 in V8.
+        copy.lineNumber = node->line_number - 1;
+        copy.columnNumber = node->column_number - 1;
+        for (const auto& allocation : node->allocations) {
+            copy.selfSize += static_cast<uint64_t>(allocation.size) * allocation.count;
+        }
+        return copy;
+    }
+}
+
+ResultCode napa::zone::StartAllocationProfiling(v8::Isolate* isolate, uint32_t samplingInterval) {
+    if (threadAllocationProfiling) {
+        return NAPA_RESULT_PROFILING_ERROR;
+    }
+
+    auto interval = samplingInterval > 0 ? samplingInterval : 512 * 1024;
+#if V8_MAJOR_VERSION > 10
+    // Objects already collected when the profile is taken are what drives GC cost, so they're kept too.
+    auto flags = static_cast<v8::HeapProfiler::SamplingFlags>(
+        v8::HeapProfiler::kSamplingIncludeObjectsCollectedByMajorGC | v8::HeapProfiler::kSamplingIncludeObjectsCollectedByMinorGC);
+    if (!isolate->GetHeapProfiler()->StartSamplingHeapProfiler(interval, ALLOCATION_STACK_DEPTH, flags)) {
+        return NAPA_RESULT_PROFILING_ERROR;
+    }
+#else
+    if (!isolate->GetHeapProfiler()->StartSamplingHeapProfiler(interval, ALLOCATION_STACK_DEPTH)) {
+        return NAPA_RESULT_PROFILING_ERROR;
+    }
+#endif
+    threadAllocationProfiling = true;
+    return NAPA_RESULT_SUCCESS;
+}
+
+bool napa::zone::StopAllocationProfiling(v8::Isolate* isolate, AllocationProfileNode& profile) {
+    if (!threadAllocationProfiling) {
+        return false;
+    }
+
+    v8::HandleScope scope(isolate);
+
+    auto heapProfiler = isolate->GetHeapProfiler();
+    std::unique_ptr<v8::AllocationProfile> allocationProfile(heapProfiler->GetAllocationProfile());
+    if (allocationProfile != nullptr) {
+        // Nodes are copied iteratively, pairing each V8 node with its copy.
+        profile = CopyNode(allocationProfile->GetRootNode());
+        std::vector<std::pair<const v8::AllocationProfile::Node*, AllocationProfileNode*>> pending = {
+            { allocationProfile->GetRootNode(), &profile }
+        };
+        while (!pending.empty()) {
+            auto node = pending.back().first;
+            auto copy = pending.back().second;
+            pending.pop_back();
+
+            copy->children.reserve(node->children.size());
+            for (auto child : node->children) {
+                copy->children.push_back(CopyNode(child));
+            }
+            for (size_t i = 0; i < node->children.size(); ++i) {
+                pending.emplace_back(node->children[i], &copy->children[i]);
+            }
+        }
+    }
+
+    DisposeAllocationProfiler(isolate);
+    return true;
+}
+
+bool napa::zone::IsAllocationProfiling() {
+    return threadAllocationProfiling;
+}
+
+void napa::zone::DisposeAllocationProfiler(v8::Isolate* isolate) {
+    if (threadAllocationProfiling) {
+        isolate->GetHeapProfiler()->StopSamplingHeapProfiler();
+        threadAllocationProfiling = false;
+    }
+}
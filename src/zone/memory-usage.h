@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "allocation-profile.h"
+
+#include <napa/exports.h>
+#include <napa/types.h>
+
+#include <v8.h>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Gets memory usage of a worker, from the heap statistics of its isolate and the napa allocator counters of its thread. </summary>
+    /// <param name="isolate"> The isolate of the worker, which must be entered by the calling thread. </param>
+    /// <param name="workerId"> The worker id. </param>
+    NAPA_API WorkerMemoryUsage GetWorkerMemoryUsage(v8::Isolate* isolate, uint32_t workerId);
+
+    /// <summary> Gets heap statistics of a worker, with the statistics of each heap space of its isolate. </summary>
+    /// <param name="isolate"> The isolate of the worker, which must be entered by the calling thread. </param>
+    /// <param name="workerId"> The worker id. </param>
+    NAPA_API WorkerHeapStatistics GetWorkerHeapStatistics(v8::Isolate* isolate, uint32_t workerId);
+
+    /// <summary> Takes a heap snapshot of an isolate and streams it to a file, in the .heapsnapshot format of Chrome DevTools. </summary>
+    /// <param name="isolate"> The isolate, which must be entered by the calling thread. </param>
+    /// <param name="path"> Path of the file. </param>
+    /// <returns> NAPA_RESULT_HEAP_SNAPSHOT_ERROR if the file can't be written, NAPA_RESULT_SUCCESS otherwise. </returns>
+    NAPA_API ResultCode WriteHeapSnapshot(v8::Isolate* isolate, const std::string& path);
+
+    /// <summary> Gets a counter of bytes allocated on the heap of an isolate, the difference of two readings estimates the bytes allocated in between. </summary>
+    /// <param name="isolate"> The isolate of the calling thread, whose collections are tracked from the first reading on. </param>
+    /// <remarks> The counter is the used heap size plus the bytes collections reclaimed, collections that sweep lazily make it lag behind. </remarks>
+    NAPA_API uint64_t GetHeapAllocationCounter(v8::Isolate* isolate);
+
+    /// <summary> Stops tracking collections of the isolate of the calling thread, before the isolate is disposed. </summary>
+    NAPA_API void StopHeapAllocationCounter();
+
+    /// <summary> Starts the V8 sampling heap profiler on the isolate of the calling thread. </summary>
+    /// <param name="isolate"> The isolate of the calling thread, which must be entered. </param>
+    /// <param name="samplingInterval"> Average number of bytes allocated between two samples, 0 for the V8 default of 512KB. </param>
+    /// <returns> NAPA_RESULT_PROFILING_ERROR if the isolate is profiling allocations already, NAPA_RESULT_SUCCESS otherwise. </returns>
+    NAPA_API ResultCode StartAllocationProfiling(v8::Isolate* isolate, uint32_t samplingInterval);
+
+    /// <summary> Stops the V8 sampling heap profiler of the calling thread, getting the call tree of sampled allocations. </summary>
+    /// <param name="isolate"> The isolate of the calling thread, which must be entered. </param>
+    /// <param name="profile"> Receives the call tree. </param>
+    /// <returns> False if the thread wasn't profiling allocations. </returns>
+    NAPA_API bool StopAllocationProfiling(v8::Isolate* isolate, AllocationProfileNode& profile);
+
+    /// <summary> Returns whether the calling thread is profiling allocations. </summary>
+    /// <remarks> Workers don't recycle their isolate while profiling, so the profile covers a single isolate. </remarks>
+    NAPA_API bool IsAllocationProfiling();
+
+    /// <summary> Stops profiling allocations of the calling thread, dropping the profile, before the isolate is disposed. </summary>
+    NAPA_API void DisposeAllocationProfiler(v8::Isolate* isolate);
+}
+}
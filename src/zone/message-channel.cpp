@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "message-channel.h"
+
+#include <napa/assert.h>
+
+#include <cstdint>
+#include <utility>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Smallest power of two not less than a capacity, at least 2 for cell sequences to tell laps apart. </summary>
+    size_t GetRingSize(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+}
+
+MessageChannel::MessageChannel(size_t capacity) :
+    _cells(new Cell[GetRingSize(capacity)]),
+    _mask(GetRingSize(capacity) - 1),
+    _sendPosition(0),
+    _receivePosition(0),
+    _closed(false),
+    _waitingReceivers(0),
+    _waitingWriters(0) {
+
+    for (size_t i = 0; i <= _mask; ++i) {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+        _cells[i].message = nullptr;
+    }
+}
+
+MessageChannel::~MessageChannel() {
+    while (auto message = Dequeue()) {
+        delete message;
+    }
+}
+
+MessageChannel::SendStatus MessageChannel::TrySend(std::unique_ptr<Message>& message) {
+    NAPA_ASSERT(message != nullptr, "Message should not be null");
+
+    if (_closed.load(std::memory_order_acquire)) {
+        return SendStatus::CLOSED;
+    }
+
+    if (!Enqueue(message.get())) {
+        return SendStatus::FULL;
+    }
+    message.release();
+
+    // Pairs with the fence of Receive: either the receiver sees the message, or the sender sees the receiver.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waitingReceivers.load(std::memory_order_relaxed) > 0) {
+        ServeReceivers();
+    }
+    return SendStatus::SENT;
+}
+
+void MessageChannel::WaitWritable(WritableCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _pendingWritables.emplace_back(std::move(callback));
+        _waitingWriters.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Room made, or a close, before the sender was registered isn't notified by the other side.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (GetSize() <= _mask || _closed.load(std::memory_order_acquire)) {
+        NotifyWritable();
+    }
+}
+
+std::unique_ptr<MessageChannel::Message> MessageChannel::TryReceive() {
+    std::unique_ptr<Message> message(Dequeue());
+    if (message != nullptr) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_waitingWriters.load(std::memory_order_relaxed) > 0) {
+            NotifyWritable();
+        }
+    }
+    return message;
+}
+
+void MessageChannel::Receive(ReceiveCallback callback) {
+    auto message = TryReceive();
+    if (message != nullptr) {
+        callback(std::move(message));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _pendingReceives.emplace_back(std::move(callback));
+        _waitingReceivers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // A message sent, or a close, before the receiver was registered isn't handed over by the other side.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ServeReceivers();
+}
+
+void MessageChannel::Close() {
+    if (_closed.exchange(true)) {
+        return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ServeReceivers();
+    NotifyWritable();
+}
+
+bool MessageChannel::IsClosed() const {
+    return _closed.load(std::memory_order_acquire);
+}
+
+size_t MessageChannel::GetSize() const {
+    auto received = _receivePosition.load(std::memory_order_acquire);
+    auto sent = _sendPosition.load(std::memory_order_acquire);
+    return sent > received ? sent - received : 0;
+}
+
+size_t MessageChannel::GetCapacity() const {
+    return _mask + 1;
+}
+
+bool MessageChannel::Enqueue(Message* message) {
+    auto position = _sendPosition.load(std::memory_order_relaxed);
+    for (;;) {
+        auto& cell = _cells[position & _mask];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto lap = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (lap == 0) {
+            if (_sendPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                cell.message = message;
+                cell.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (lap < 0) {
+            // The cell still holds the message of the previous lap.
+            return false;
+        } else {
+            position = _sendPosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+MessageChannel::Message* MessageChannel::Dequeue() {
+    auto position = _receivePosition.load(std::memory_order_relaxed);
+    for (;;) {
+        auto& cell = _cells[position & _mask];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto lap = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+        if (lap == 0) {
+            if (_receivePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                auto message = cell.message;
+                cell.message = nullptr;
+                cell.sequence.store(position + _mask + 1, std::memory_order_release);
+                return message;
+            }
+        } else if (lap < 0) {
+            // The cell wasn't written in this lap yet.
+            return nullptr;
+        } else {
+            position = _receivePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void MessageChannel::ServeReceivers() {
+    std::vector<std::pair<ReceiveCallback, std::unique_ptr<Message>>> served;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        while (!_pendingReceives.empty()) {
+            std::unique_ptr<Message> message(Dequeue());
+            if (message == nullptr && !_closed.load(std::memory_order_acquire)) {
+                break;
+            }
+            served.emplace_back(std::move(_pendingReceives.front()), std::move(message));
+            _pendingReceives.pop_front();
+            _waitingReceivers.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (served.empty()) {
+        return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waitingWriters.load(std::memory_order_relaxed) > 0) {
+        NotifyWritable();
+    }
+
+    // Callbacks run outside of the lock, as they may send or receive again.
+    for (auto& receive : served) {
+        receive.first(std::move(receive.second));
+    }
+}
+
+void MessageChannel::NotifyWritable() {
+    std::vector<WritableCallback> writables;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        writables.swap(_pendingWritables);
+        _waitingWriters.store(0, std::memory_order_relaxed);
+    }
+
+    // Every waiting sender retries, those that find the channel full again wait again.
+    auto open = !_closed.load(std::memory_order_acquire);
+    for (auto& writable : writables) {
+        writable(open);
+    }
+}
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/transport/transport-context.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Bounded queue of marshalled messages, sent and received by any workers that the channel is transported to. </summary>
+    /// <remarks>
+    ///     Messages go through a lock-free ring of cells with sequence numbers, which takes many senders and receivers,
+    ///     the common single producer and single consumer case included. Sending and receiving never take a lock while
+    ///     the ring is neither empty nor full. Only receivers waiting on an empty ring, and senders waiting on a full one,
+    ///     are kept under a lock, and are called back from the thread of the other side once it makes progress.
+    ///     It's exposed in napa.dll, so channels can be shared by Node and Napa isolates.
+    /// </remarks>
+    class NAPA_API MessageChannel {
+    public:
+
+        /// <summary> A marshalled message. </summary>
+        struct Message {
+            /// <summary> JSON string, or binary payload, from marshalled JS value. </summary>
+            std::string payload;
+
+            /// <summary> Whether payload is in binary transport format. </summary>
+            bool binary = false;
+
+            /// <summary> TransportContext that is needed to unmarshall the JS value. </summary>
+            napa::transport::TransportContext transportContext;
+        };
+
+        /// <summary> Status of a send. </summary>
+        enum class SendStatus {
+            /// <summary> The message is queued. </summary>
+            SENT,
+
+            /// <summary> The message is not queued, since the channel is full. </summary>
+            FULL,
+
+            /// <summary> The message is dropped, since the channel is closed. </summary>
+            CLOSED
+        };
+
+        /// <summary> Callback of a receive, with a null message once the channel is closed and drained. </summary>
+        typedef std::function<void(std::unique_ptr<Message>)> ReceiveCallback;
+
+        /// <summary> Callback of a wait for room, false if the channel is closed meanwhile. </summary>
+        typedef std::function<void(bool)> WritableCallback;
+
+        /// <summary> Constructor. </summary>
+        /// <param name="capacity"> Number of messages that can be queued, rounded up to a power of two. </param>
+        explicit MessageChannel(size_t capacity);
+
+        /// <summary> Non-copyable. </summary>
+        MessageChannel(const MessageChannel&) = delete;
+        MessageChannel& operator=(const MessageChannel&) = delete;
+
+        ~MessageChannel();
+
+        /// <summary> Queues a message, or hands it to a waiting receiver. </summary>
+        /// <param name="message"> The message, which is left to the caller unless it's sent. </param>
+        SendStatus TrySend(std::unique_ptr<Message>& message);
+
+        /// <summary> Calls back once the channel has room for a message, or is closed. </summary>
+        void WaitWritable(WritableCallback callback);
+
+        /// <summary> Takes the next message without waiting. </summary>
+        /// <returns> The message, or null if there is none. </returns>
+        std::unique_ptr<Message> TryReceive();
+
+        /// <summary> Calls back with the next message, inline if there is one, or once one is sent or the channel is closed. </summary>
+        void Receive(ReceiveCallback callback);
+
+        /// <summary> Closes the channel. Later sends are dropped, queued messages are still received. No-op if already closed. </summary>
+        /// <remarks> A send racing with Close may be queued after waiting receivers were called back, it's then received by later receives. </remarks>
+        void Close();
+
+        /// <summary> Whether the channel accepts no more messages. </summary>
+        bool IsClosed() const;
+
+        /// <summary> Gets the number of queued messages, which may be outdated by concurrent senders and receivers. </summary>
+        size_t GetSize() const;
+
+        /// <summary> Gets the number of messages that can be queued. </summary>
+        size_t GetCapacity() const;
+
+    private:
+        /// <summary> A cell of the ring, whose sequence tells which lap of senders or receivers may use it next. </summary>
+        struct Cell {
+            std::atomic<size_t> sequence;
+            Message* message;
+        };
+
+        /// <summary> Puts a message into the ring, false if it's full. </summary>
+        bool Enqueue(Message* message);
+
+        /// <summary> Takes a message from the ring, null if it's empty. </summary>
+        Message* Dequeue();
+
+        /// <summary> Hands queued messages to waiting receivers as long as there are both, or null messages once closed. </summary>
+        void ServeReceivers();
+
+        /// <summary> Calls back all waiting senders, after a receive made room. </summary>
+        void NotifyWritable();
+
+        std::unique_ptr<Cell[]> _cells;
+        size_t _mask;
+
+        /// <summary> Positions of the next send and receive, on cache lines of their own as they are hot on different threads. </summary>
+        alignas(64) std::atomic<size_t> _sendPosition;
+        alignas(64) std::atomic<size_t> _receivePosition;
+
+        alignas(64) std::atomic<bool> _closed;
+
+        /// <summary> Number of waiting receivers and senders, read without the lock to skip it when nobody waits. </summary>
+        std::atomic<size_t> _waitingReceivers;
+        std::atomic<size_t> _waitingWriters;
+
+        std::deque<ReceiveCallback> _pendingReceives;
+        std::vector<WritableCallback> _pendingWritables;
+        std::mutex _lock;
+    };
+}
+}
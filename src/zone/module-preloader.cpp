@@ -0,0 +1,115 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "module-preloader.h"
+#include "isolate-pool.h"
+#include "simple-thread-pool.h"
+
+#include <module/core-modules/node/file-system-helpers.h>
+#include <module/loader/javascript-module-loader.h>
+#include <module/loader/module-loader.h>
+#include <module/loader/module-resolver.h>
+#include <utils/debug.h>
+
+#include <napa/log.h>
+
+#include <v8.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> A module file to compile. </summary>
+    struct ModuleFile {
+        std::string path;
+        std::string content;
+    };
+
+    /// <summary> The I/O thread shared by all zones, so preloading zones don't compete for the disk. </summary>
+    SimpleThreadPool& GetIoThread() {
+        static SimpleThreadPool ioThread(1);
+        return ioThread;
+    }
+
+    /// <summary> Resolves and reads the Javascript module files. </summary>
+    std::vector<ModuleFile> ReadModuleFiles(const std::vector<std::string>& names) {
+        module::ModuleResolver resolver;
+
+        std::vector<ModuleFile> files;
+        for (const auto& name : names) {
+            auto moduleInfo = resolver.Resolve(name.c_str());
+            if (moduleInfo.type != module::ModuleType::JAVASCRIPT) {
+                NAPA_DEBUG("ModulePreloader", "Skip precompiling \"%s\", it's not a Javascript file.", name.c_str());
+                continue;
+            }
+
+            try {
+                auto content = module::file_system_helpers::ReadFileSync(moduleInfo.fullPath);
+                if (!content.empty()) {
+                    files.push_back({ std::move(moduleInfo.fullPath), std::move(content) });
+                }
+            } catch (const std::exception& ex) {
+                LOG_WARNING("ModulePreloader", "Failed to read module \"%s\": %s", moduleInfo.fullPath.c_str(), ex.what());
+            }
+        }
+        return files;
+    }
+
+    /// <summary> Compiles module files on a new isolate until none is left. </summary>
+    size_t CompileModuleFiles(const std::vector<ModuleFile>& files,
+                              std::atomic<size_t>& next,
+                              const settings::ZoneSettings& settings) {
+        auto functionWrapper = module::ModuleLoader::HasFunctionWrappers();
+        size_t compiled = 0;
+
+        auto isolate = CreateIsolate(settings);
+        {
+            v8::Locker locker(isolate);
+            ConfigureIsolate(isolate, settings);
+
+            v8::Isolate::Scope isolateScope(isolate);
+            v8::HandleScope handleScope(isolate);
+            auto context = v8::Context::New(isolate);
+            v8::Context::Scope contextScope(context);
+
+            for (auto i = next++; i < files.size(); i = next++) {
+                if (module::JavascriptModuleLoader::Precompile(files[i].path, files[i].content, functionWrapper)) {
+                    compiled++;
+                }
+            }
+        }
+        isolate->Dispose();
+
+        return compiled;
+    }
+}
+
+size_t zone::PrecompileModules(const std::vector<std::string>& names, const settings::ZoneSettings& settings) {
+    std::promise<std::vector<ModuleFile>> promise;
+    auto future = promise.get_future();
+    GetIoThread().Execute([&names, &promise]() {
+        promise.set_value(ReadModuleFiles(names));
+    });
+    auto files = future.get();
+
+    auto threads = std::min<size_t>(files.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next(0);
+    std::vector<std::future<size_t>> compilations;
+    for (size_t i = 0; i < threads; i++) {
+        compilations.emplace_back(std::async(std::launch::async, CompileModuleFiles, std::cref(files), std::ref(next), std::cref(settings)));
+    }
+
+    size_t compiled = 0;
+    for (auto& compilation : compilations) {
+        compiled += compilation.get();
+    }
+
+    NAPA_DEBUG("ModulePreloader", "Precompiled %zu of %zu modules on %zu threads.", compiled, names.size(), threads);
+    return compiled;
+}
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <settings/settings.h>
+
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Compiles the Javascript modules of a zone into the process-wide code caches, ahead of its workers. </summary>
+    /// <remarks>
+    ///     Modules are resolved from the current directory and read on an I/O thread shared by all zones, then compiled
+    ///     in parallel on short-lived isolates, one per compilation thread. Workers that load the modules afterwards
+    ///     consume the code caches instead of compiling them. Modules that aren't Javascript files are skipped.
+    /// </remarks>
+    /// <param name="names"> Module names, as passed to require(). </param>
+    /// <param name="settings"> Settings of the zone, for the heap constraints of compilation isolates. </param>
+    /// <returns> The number of modules compiled. </returns>
+    size_t PrecompileModules(const std::vector<std::string>& names, const settings::ZoneSettings& settings);
+}
+}
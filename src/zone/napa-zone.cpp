@@ -8,14 +8,29 @@
 #include <platform/filesystem.h>
 #include <utils/debug.h>
 #include <utils/string.h>
+#include <zone/async-completions.h>
+#include <zone/clock.h>
 #include <zone/eval-task.h>
+#include <zone/isolate-pool.h>
+#include <zone/memory-pressure.h>
+#include <zone/memory-usage.h>
+#include <zone/module-preloader.h>
+#include <zone/call-dispatcher.h>
 #include <zone/call-task.h>
+#include <zone/batch-callback.h>
 #include <zone/call-context.h>
+#include <zone/cpu-profiling.h>
+#include <zone/hedged-call.h>
 #include <zone/task-decorators.h>
+#include <zone/tracing.h>
 #include <zone/worker-context.h>
+#include <zone/worker-timers.h>
+#include <zone/worker-watchdog.h>
 
 #include <napa/log.h>
 
+#include <algorithm>
+#include <array>
 #include <future>
 
 using namespace napa;
@@ -23,17 +38,266 @@ using namespace napa::zone;
 
 // Static members initialization
 std::mutex NapaZone::_mutex;
-std::unordered_map<std::string, std::weak_ptr<NapaZone>> NapaZone::_zones;
+std::shared_ptr<const NapaZone::ZoneMap> NapaZone::_zones = std::make_shared<NapaZone::ZoneMap>();
+std::atomic<uint64_t> NapaZone::_zonesVersion(0);
 
 /// <summary> Load 'napajs' module during bootstrap. We use relative path to decouple from how module will be published.  </summary>
 static const std::string NAPAJS_MODULE_PATH = filesystem::Path(dll::ThisLineLocation()).Parent().Parent().Normalize().String();
 static const std::string BOOTSTRAP_SOURCE = "require('" + utils::string::ReplaceAllCopy(NAPAJS_MODULE_PATH, "\\", "\\\\") + "');";
 
+/// <summary> Source that loads the preloaded modules of a zone on a worker. </summary>
+static std::string GetPreloadSource(const std::vector<std::string>& names) {
+    std::string source;
+    for (const auto& name : names) {
+        auto escaped = utils::string::ReplaceAllCopy(utils::string::ReplaceAllCopy(name, "\\", "\\\\"), "'", "\\'");
+        source += "require('" + escaped + "');";
+    }
+    return source;
+}
+
+/// <summary> FNV-1a hash of an affinity key, stable across processes so routing is reproducible. </summary>
+static uint64_t HashAffinityKey(const StringRef& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.size; i++) {
+        hash ^= static_cast<uint8_t>(key.data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// <summary> Replayed broadcast sequence of a worker that is about to replay the broadcast log on a recycled isolate. </summary>
+static const uint64_t REPLAY_PENDING = UINT64_MAX;
+
+namespace {
+
+    /// <summary> Runs a logged broadcast, unless the worker already replayed it on a recycled isolate. </summary>
+    class LoggedBroadcastTask : public Task {
+    public:
+        LoggedBroadcastTask(std::shared_ptr<EvalTask> task,
+                            uint64_t sequence,
+                            BroadcastCallback callback,
+                            std::shared_ptr<const std::vector<uint64_t>> replayedBroadcasts) :
+            _task(std::move(task)),
+            _sequence(sequence),
+            _callback(std::move(callback)),
+            _replayedBroadcasts(std::move(replayedBroadcasts)) {}
+
+        void Execute() override {
+            auto workerId = static_cast<WorkerId>(
+                reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
+
+            if (_sequence <= (*_replayedBroadcasts)[workerId]) {
+                _callback(NAPA_RESULT_SUCCESS);
+                return;
+            }
+            _task->Execute();
+        }
+
+    private:
+        std::shared_ptr<EvalTask> _task;
+        uint64_t _sequence;
+        BroadcastCallback _callback;
+        std::shared_ptr<const std::vector<uint64_t>> _replayedBroadcasts;
+    };
+
+    /// <summary> Collects memory usage on each worker it runs on, then calls back once all workers reported. </summary>
+    class MemoryUsageTask : public Task {
+    public:
+        MemoryUsageTask(uint32_t workers, MemoryUsageCallback callback) :
+            _usages(workers),
+            _pending(workers),
+            _callback(std::move(callback)) {}
+
+        void Execute() override {
+            auto workerId = static_cast<WorkerId>(
+                reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
+
+            // Each worker writes its own slot, the last one to finish sees all of them.
+            _usages[workerId] = GetWorkerMemoryUsage(v8::Isolate::GetCurrent(), workerId);
+            if (--_pending == 0) {
+                _callback(std::move(_usages));
+            }
+        }
+
+    private:
+        std::vector<WorkerMemoryUsage> _usages;
+        std::atomic<uint32_t> _pending;
+        MemoryUsageCallback _callback;
+    };
+
+    /// <summary> Collects heap statistics on each worker it runs on, then calls back once all workers reported. </summary>
+    class HeapStatisticsTask : public Task {
+    public:
+        HeapStatisticsTask(uint32_t workers, HeapStatisticsCallback callback) :
+            _statistics(workers),
+            _pending(workers),
+            _callback(std::move(callback)) {}
+
+        void Execute() override {
+            auto workerId = static_cast<WorkerId>(
+                reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
+
+            // Each worker writes its own slot, the last one to finish sees all of them.
+            _statistics[workerId] = GetWorkerHeapStatistics(v8::Isolate::GetCurrent(), workerId);
+            if (--_pending == 0) {
+                _callback(std::move(_statistics));
+            }
+        }
+
+    private:
+        std::vector<WorkerHeapStatistics> _statistics;
+        std::atomic<uint32_t> _pending;
+        HeapStatisticsCallback _callback;
+    };
+
+    /// <summary> Writes a heap snapshot of the worker it runs on. </summary>
+    class HeapSnapshotTask : public Task {
+    public:
+        HeapSnapshotTask(std::string path, HeapSnapshotCallback callback) :
+            _path(std::move(path)),
+            _callback(std::move(callback)) {}
+
+        void Execute() override {
+            _callback(WriteHeapSnapshot(v8::Isolate::GetCurrent(), _path));
+        }
+
+    private:
+        std::string _path;
+        HeapSnapshotCallback _callback;
+    };
+
+    /// <summary> Starts the CPU profiler on each worker it runs on, then calls back once all workers started. </summary>
+    class StartProfilingTask : public Task {
+    public:
+        StartProfilingTask(uint32_t workers, uint32_t samplingInterval, ProfilingCallback callback) :
+            _samplingInterval(samplingInterval),
+            _failed(false),
+            _pending(workers),
+            _callback(std::move(callback)) {}
+
+        void Execute() override {
+            if (StartCpuProfiling(v8::Isolate::GetCurrent(), _samplingInterval) != NAPA_RESULT_SUCCESS) {
+                _failed = true;
+            }
+            if (--_pending == 0) {
+                _callback(_failed ? NAPA_RESULT_PROFILING_ERROR : NAPA_RESULT_SUCCESS);
+            }
+        }
+
+    private:
+        uint32_t _samplingInterval;
+        std::atomic<bool> _failed;
+        std::atomic<uint32_t> _pending;
+        ProfilingCallback _callback;
+    };
+
+    /// <summary> Stops the CPU profiler on each worker it runs on, then calls back with all profiles. </summary>
+    class StopProfilingTask : public Task {
+    public:
+        StopProfilingTask(uint32_t workers, CpuProfileCallback callback) :
+            _profiles(workers),
+            _pending(workers),
+            _callback(std::move(callback)) {}
+
+        void Execute() override {
+            auto workerId = static_cast<WorkerId>(
+                reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
+
+            // Each worker writes its own slot, the last one to finish sees all of them.
+            _profiles[workerId] = StopCpuProfiling(v8::Isolate::GetCurrent());
+            if (--_pending == 0) {
+                _callback(std::move(_profiles));
+            }
+        }
+
+    private:
+        std::vector<std::string> _profiles;
+        std::atomic<uint32_t> _pending;
+        CpuProfileCallback _callback;
+    };
+
+    /// <summary> Starts the sampling heap profiler on each worker it runs on, then calls back once all workers started. </summary>
+    class StartAllocationProfilingTask : public Task {
+    public:
+        StartAllocationProfilingTask(uint32_t workers, uint32_t samplingInterval, ProfilingCallback callback) :
+            _samplingInterval(samplingInterval),
+            _failed(false),
+            _pending(workers),
+            _callback(std::move(callback)) {}
+
+        void Execute() override {
+            if (StartAllocationProfiling(v8::Isolate::GetCurrent(), _samplingInterval) != NAPA_RESULT_SUCCESS) {
+                _failed = true;
+            }
+            if (--_pending == 0) {
+                _callback(_failed ? NAPA_RESULT_PROFILING_ERROR : NAPA_RESULT_SUCCESS);
+            }
+        }
+
+    private:
+        uint32_t _samplingInterval;
+        std::atomic<bool> _failed;
+        std::atomic<uint32_t> _pending;
+        ProfilingCallback _callback;
+    };
+
+    /// <summary> Stops the sampling heap profiler on each worker it runs on, then calls back with the merged profile. </summary>
+    class StopAllocationProfilingTask : public Task {
+    public:
+        StopAllocationProfilingTask(uint32_t workers, AllocationProfileCallback callback) :
+            _profiled(false),
+            _pending(workers),
+            _callback(std::move(callback)) {}
+
+        void Execute() override {
+            // Workers merge their tree in turn, the last one to finish serializes the merged tree.
+            AllocationProfileNode profile;
+            if (StopAllocationProfiling(v8::Isolate::GetCurrent(), profile)) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_profiled) {
+                    _profile = std::move(profile);
+                    _profiled = true;
+                } else {
+                    MergeAllocationProfile(_profile, std::move(profile));
+                }
+            }
+
+            if (--_pending == 0) {
+                _callback(_profiled ? ToHeapProfileJson(_profile) : std::string());
+            }
+        }
+
+    private:
+        AllocationProfileNode _profile;
+        bool _profiled;
+        std::mutex _mutex;
+        std::atomic<uint32_t> _pending;
+        AllocationProfileCallback _callback;
+    };
+
+    /// <summary> Applies the current memory pressure level on each worker it runs on. </summary>
+    class MemoryPressureTask : public Task {
+    public:
+        void Execute() override {
+            // Entries that JavaScript caches release are collected along.
+            auto isolate = v8::Isolate::GetCurrent();
+            NotifyJavaScriptOfMemoryPressure(isolate);
+            ApplyMemoryPressure(isolate);
+        }
+    };
+
+    /// <summary> Applies the current memory pressure level on a worker interrupted while running JavaScript. </summary>
+    void OnMemoryPressureInterrupt(v8::Isolate* isolate, void* /*data*/) {
+        ApplyMemoryPressure(isolate);
+    }
+}
+
 std::shared_ptr<NapaZone> NapaZone::Create(const settings::ZoneSettings& settings) {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    auto iter = _zones.find(settings.id);
-    if (iter != _zones.end() && !iter->second.expired()) {
+    auto zones = _zones;
+    auto iter = zones->find(settings.id);
+    if (iter != zones->end() && !iter->second.expired()) {
         NAPA_DEBUG("Zone", "Failed to create zone '%s': a zone with this name already exists.", settings.id.c_str());
         return nullptr;
     }
@@ -45,7 +309,17 @@ std::shared_ptr<NapaZone> NapaZone::Create(const settings::ZoneSettings& setting
 
     // Fail to create Napa zone is not expected, will always trigger crash.
     auto zone = std::make_shared<MakeSharedEnabler>(settings);
-    _zones[settings.id] = zone;
+
+    auto updated = std::make_shared<ZoneMap>();
+    updated->reserve(zones->size() + 1);
+    for (const auto& entry : *zones) {
+        if (!entry.second.expired()) {
+            updated->emplace(entry);
+        }
+    }
+    (*updated)[settings.id] = zone;
+    _zones = std::move(updated);
+    _zonesVersion.fetch_add(1, std::memory_order_release);
 
     NAPA_DEBUG("Zone", "Napa zone \"%s\" created.", settings.id.c_str());
 
@@ -53,10 +327,23 @@ std::shared_ptr<NapaZone> NapaZone::Create(const settings::ZoneSettings& setting
 }
 
 std::shared_ptr<NapaZone> NapaZone::Get(const std::string& id) {
-    std::lock_guard<std::mutex> lock(_mutex);
+    // Expired zones are left to the next Create to prune, so lookups never write.
+    struct Snapshot {
+        std::shared_ptr<const ZoneMap> zones;
+        uint64_t version = 0;
+    };
+    thread_local Snapshot snapshot;
 
-    auto iter = _zones.find(id);
-    if (iter == _zones.end()) {
+    auto version = _zonesVersion.load(std::memory_order_acquire);
+    if (snapshot.zones == nullptr || snapshot.version != version) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        snapshot.zones = _zones;
+        snapshot.version = _zonesVersion.load(std::memory_order_relaxed);
+    }
+    const auto& zones = snapshot.zones;
+
+    auto iter = zones->find(id);
+    if (iter == zones->end()) {
         NAPA_DEBUG("Zone", "Get zone \"%s\" failed due to not found.", id.c_str());
         return nullptr;
     }
@@ -64,31 +351,132 @@ std::shared_ptr<NapaZone> NapaZone::Get(const std::string& id) {
     auto zone = iter->second.lock();
     if (zone == nullptr) {
         LOG_WARNING("Zone", "Zone '%s' was already deleted.", id.c_str());
-
-        // Use this chance to clean up the map
-        _zones.erase(id);
+        return nullptr;
     }
-    
+
     NAPA_DEBUG("Zone", "Get zone \"%s\" succeeded.", id.c_str());
     return zone;
 }
 
+void NapaZone::ReserveSpareIsolates(size_t count) {
+    IsolatePool::GetInstance().Reserve(count, []() {
+        // Same bootstrap as zone workers, which later find napajs in the module cache.
+        CREATE_MODULE_LOADER();
+
+        auto result = NAPA_RESULT_INTERNAL_ERROR;
+        EvalTask(std::make_shared<const std::string>(BOOTSTRAP_SOURCE), "", [&result](ResultCode code) { result = code; }).Execute();
+        return result == NAPA_RESULT_SUCCESS;
+    }, []() {
+        DESTROY_MODULE_LOADER();
+    });
+}
+
+void NapaZone::NotifyMemoryPressure(MemoryPressureLevel level) {
+    SetMemoryPressureLevel(level);
+
+    std::vector<std::shared_ptr<NapaZone>> zones;
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto registered = _zones;
+    lock.unlock();
+    for (const auto& entry : *registered) {
+        auto zone = entry.second.lock();
+        if (zone != nullptr) {
+            zones.emplace_back(std::move(zone));
+        }
+    }
+
+    // A worker may both be interrupted and run the task, the second notification of a level is a no-op.
+    auto task = std::make_shared<MemoryPressureTask>();
+    for (auto& zone : zones) {
+        zone->_scheduler->InterruptAllWorkers(OnMemoryPressureInterrupt, nullptr);
+        zone->_scheduler->ScheduleOnAllWorkers(task);
+    }
+    NAPA_DEBUG("Zone", "Notified %zu zones of memory pressure level %d.", zones.size(), static_cast<int>(level));
+}
+
 NapaZone::NapaZone(const settings::ZoneSettings& settings) : 
-    _settings(settings) {
+    _settings(settings),
+    _pendingCalls(std::make_shared<PendingCalls>()),
+    _coalescer(std::make_shared<CallCoalescer>()),
+    _callContextPool(std::make_shared<utils::BlockPool>()),
+    _callTaskPool(std::make_shared<utils::BlockPool>()),
+    _timeoutCallTaskPool(std::make_shared<utils::BlockPool>()),
+    _broadcastLog(settings.broadcastLogCompaction, settings.broadcastCodeCache),
+    _pendingResizes(0),
+    _stopping(false) {
+
+    const char* dimensionNames[] = { "zone" };
+    _workersMetric = providers::GetMetricProvider().GetMetric(
+        "Zone", "Workers", providers::MetricType::Number, 1, dimensionNames);
+
+    auto capacity = std::max(_settings.workers, _settings.maxWorkers);
+    _metrics = std::make_shared<ZoneMetrics>(providers::GetMetricProvider(), _settings.id, capacity);
+    _replayedBroadcasts = std::make_shared<std::vector<uint64_t>>(capacity, 0);
+
+    if (_settings.resultCacheBytes > 0) {
+        _resultCache = std::make_shared<ResultCache>(
+            static_cast<size_t>(_settings.resultCacheBytes), std::chrono::milliseconds(_settings.resultCacheTtl));
+    }
+
+    if (_settings.slowCallThreshold > 0 || _settings.slowCallSampleRate > 0) {
+        _slowCallLog = std::make_shared<SlowCallLog>(
+            std::chrono::milliseconds(_settings.slowCallThreshold),
+            _settings.slowCallSampleRate,
+            _settings.slowCallLogSize,
+            _settings.slowCallPayloadBytes);
+    }
+
+    // Preloaded modules compile off the worker threads, while workers bootstrap.
+    std::future<size_t> precompiled;
+    if (!_settings.preload.empty()) {
+        precompiled = std::async(std::launch::async, PrecompileModules, std::cref(_settings.preload), std::cref(_settings));
+    }
 
     // Create the zone's scheduler.
     _scheduler = std::make_unique<Scheduler>(_settings, [this](WorkerId id) {
-        // Initialize the worker context TLS data
-        INIT_WORKER_CONTEXT();
-
         // Zone instance into TLS.
         WorkerContext::Set(WorkerContextItem::ZONE, reinterpret_cast<void*>(this));
 
         // Worker Id into TLS.
         WorkerContext::Set(WorkerContextItem::WORKER_ID, reinterpret_cast<void*>(static_cast<uintptr_t>(id)));
 
-        // Load module loader and built-in modules of require, console and etc.
+        // Load module loader and built-in modules of require, console and etc. A spare isolate comes with one.
+        auto bootstrapped = WorkerContext::Get(WorkerContextItem::MODULE_LOADER) != nullptr;
+        auto bootstrapStart = Clock::Now();
         CREATE_MODULE_LOADER();
+        if (!bootstrapped) {
+            _metrics->RecordBootstrapTime(id, Clock::Now() - bootstrapStart);
+        }
+
+        // Workers added or recycled under memory pressure start with the level in effect.
+        if (GetMemoryPressureLevel() != MEMORY_PRESSURE_NONE) {
+            ApplyMemoryPressure(v8::Isolate::GetCurrent());
+        }
+
+        // A recycled isolate catches up before the tasks still queued on the worker, which skip the replayed broadcasts.
+        auto recycled = (*_replayedBroadcasts)[id] == REPLAY_PENDING;
+        (*_replayedBroadcasts)[id] = 0;
+        if (recycled) {
+            for (auto& task : CreateWarmUpTasks(id)) {
+                task->Execute();
+            }
+        }
+    }, [this](WorkerId id) {
+        // Completions of asynchronous work hold on to the isolate.
+        if (_scheduler->IsWorkerPinned(id)) {
+            return false;
+        }
+
+        WorkerTimers::Destroy();
+        CallDispatcher::Destroy();
+        AsyncCompletions::Destroy();
+        DESTROY_MODULE_LOADER();
+        (*_replayedBroadcasts)[id] = REPLAY_PENDING;
+        return true;
+    }, [metrics = _metrics](CallPriority priority, size_t depth) {
+        metrics->SetQueueDepth(priority, depth);
+    }, [metrics = _metrics](const std::string& tenant, std::chrono::nanoseconds time) {
+        metrics->RecordTenantQueueTime(tenant, time);
     });
 
     // Bootstrap after zone is created.
@@ -100,6 +488,56 @@ NapaZone::NapaZone(const settings::ZoneSettings& settings) :
     });
 
     NAPA_ASSERT(future.get() == NAPA_RESULT_SUCCESS, "Bootstrap Napa zone failed.");
+
+    // Workers instantiate the preloaded modules from the code caches. As a broadcast, workers added later load them too.
+    if (precompiled.valid()) {
+        // Waits for the code caches outside of the log macro, which may compile its arguments out.
+        auto precompiledCount = precompiled.get();
+        NAPA_DEBUG("Zone", "Precompiled %zu modules for zone \"%s\".", precompiledCount, _settings.id.c_str());
+
+        std::promise<ResultCode> preloadPromise;
+        auto preloadFuture = preloadPromise.get_future();
+        Broadcast(GetPreloadSource(_settings.preload), [&preloadPromise](ResultCode code) {
+            preloadPromise.set_value(code);
+        });
+
+        auto code = preloadFuture.get();
+        if (code != NAPA_RESULT_SUCCESS) {
+            LOG_WARNING("Zone", "Preloading modules in zone \"%s\" failed with result code %d.", _settings.id.c_str(), code);
+        }
+    }
+
+    if (_settings.autoscaleInterval > 0) {
+        _autoscaler = std::thread(&NapaZone::AutoscaleLoop, this);
+    }
+
+    if (_settings.stuckWorkerThreshold > 0) {
+        _watchdog = std::thread(&NapaZone::WatchdogLoop, this);
+    }
+}
+
+NapaZone::~NapaZone() {
+    std::unique_lock<std::mutex> lock(_resizeLock);
+    _stopping = true;
+    _resizeEvent.notify_all();
+    lock.unlock();
+
+    if (_autoscaler.joinable()) {
+        _autoscaler.join();
+    }
+
+    if (_watchdog.joinable()) {
+        _watchdog.join();
+    }
+
+    // New workers still call back into this zone while they start.
+    lock.lock();
+    _resizeEvent.wait(lock, [this]() { return _pendingResizes == 0; });
+    lock.unlock();
+
+    // Workers set up, warm up and recycle through callbacks into this zone, and the scheduler may outlive it in
+    // asynchronous work. Started workers finish their setup and remaining tasks before the members they use are destroyed.
+    _scheduler->Shutdown();
 }
 
 const std::string& NapaZone::GetId() const {
@@ -107,34 +545,530 @@ const std::string& NapaZone::GetId() const {
 }
 
 void NapaZone::Broadcast(const std::string& source, BroadcastCallback callback) {
-    // Makes sure the callback is only called once, after all workers finished running the broadcast task.
-    auto counter = std::make_shared<std::atomic<uint32_t>>(_settings.workers);
-    auto callOnce = [this, source, callback = std::move(callback), counter](napa_result_code code) {
-        if (--(*counter) == 0) {
-            NAPA_DEBUG("Zone", "Finishing broadcast script \"%s\" to zone \"%s\"", source.c_str(), _settings.id.c_str());
-            callback(code);
+    _scheduler->ScheduleOnAllWorkers([this, &source, &callback](uint32_t workers) {
+        // Logged while the number of workers can't change, so workers added later replay it exactly once.
+        auto entry = _broadcastLog.Append(source);
+        auto sequence = entry.sequence;
+
+        // Makes sure the callback is only called once, after all workers finished running the broadcast task.
+        auto counter = std::make_shared<std::atomic<uint32_t>>(workers);
+        auto callOnce = [this, source = entry.source, callback = std::move(callback), counter](napa_result_code code) {
+            if (--(*counter) == 0) {
+                NAPA_DEBUG("Zone", "Finishing broadcast script \"%s\" to zone \"%s\"", source->c_str(), _settings.id.c_str());
+                callback(code);
+            }
+        };
+
+        auto task = std::make_shared<EvalTask>(std::move(entry.source), "", callOnce, std::move(entry.codeCache));
+        return std::make_shared<LoggedBroadcastTask>(std::move(task), sequence, std::move(callOnce), _replayedBroadcasts);
+    }, _settings.broadcastConcurrency);
+    NAPA_DEBUG("Zone", "Scheduling broadcast script \"%s\" to zone \"%s\"", source.c_str(), _settings.id.c_str());
+}
+
+void NapaZone::Resize(uint32_t workers, ResizeCallback callback) {
+    // Workers of worker classes are kept.
+    auto minWorkers = std::max(1u, _scheduler->GetWorkerClassWorkers());
+    if (workers < minWorkers || workers > _scheduler->GetWorkerCapacity()) {
+        LOG_ERROR("Zone", "Cannot resize zone \"%s\" to %u workers, it must be between %u and %u.",
+            _settings.id.c_str(), workers, minWorkers, _scheduler->GetWorkerCapacity());
+        callback(NAPA_RESULT_ZONE_RESIZE_ERROR);
+        return;
+    }
+
+    // A removed worker would wait forever for the completion of its own resize call. The worker is told by the
+    // context of the thread, not by the thread itself, as workers sharing threads run on any of them.
+    if (WorkerContext::IsInitialized() && WorkerContext::Get(WorkerContextItem::ZONE) == this) {
+        auto self = static_cast<WorkerId>(reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
+        if (self >= workers) {
+            LOG_ERROR("Zone", "Worker %u cannot resize zone \"%s\" to %u workers, which would remove itself.",
+                self, _settings.id.c_str(), workers);
+            callback(NAPA_RESULT_ZONE_RESIZE_ERROR);
+            return;
         }
+    }
+
+    std::unique_lock<std::mutex> lock(_resizeLock);
+
+    _pendingResizes++;
+    lock.unlock();
+
+    NAPA_DEBUG("Zone", "Resizing zone \"%s\" to %u workers.", _settings.id.c_str(), workers);
+    _scheduler->Resize(workers, [this](WorkerId workerId) {
+        return CreateWarmUpTasks(workerId);
+    }, [this, callback = std::move(callback)]() {
+        if (_workersMetric != nullptr) {
+            const char* dimensionValues[] = { _settings.id.c_str() };
+            _workersMetric->Set(static_cast<int64_t>(_scheduler->GetWorkerCount()), 1, dimensionValues);
+        }
+        callback(NAPA_RESULT_SUCCESS);
+
+        std::lock_guard<std::mutex> lock(_resizeLock);
+        _pendingResizes--;
+        _resizeEvent.notify_all();
+    });
+}
+
+void NapaZone::Drain(uint32_t timeout, DrainCallback callback) {
+    if (WorkerContext::IsInitialized() && WorkerContext::Get(WorkerContextItem::ZONE) == this) {
+        LOG_ERROR("Zone", "Zone \"%s\" cannot be drained from one of its workers.", _settings.id.c_str());
+        callback(NAPA_RESULT_ZONE_DRAIN_ERROR, 0);
+        return;
+    }
+
+    auto deadline = timeout > 0
+        ? std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout)
+        : std::chrono::steady_clock::time_point::max();
+
+    NAPA_DEBUG("Zone", "Draining zone \"%s\" with a timeout of %u ms.", _settings.id.c_str(), timeout);
+    _scheduler->Drain(deadline, [callback = std::move(callback)](bool drained, size_t cancelled) {
+        callback(drained ? NAPA_RESULT_SUCCESS : NAPA_RESULT_TIMEOUT, cancelled);
+    });
+}
+
+void NapaZone::GetMemoryUsage(MemoryUsageCallback callback) {
+    _scheduler->ScheduleOnAllWorkers([&callback](uint32_t workers) {
+        return std::make_shared<MemoryUsageTask>(workers, std::move(callback));
+    });
+}
+
+void NapaZone::StartProfiling(uint32_t samplingInterval, ProfilingCallback callback) {
+    // The profiler samples the thread of an isolate, which workers sharing threads don't keep.
+    if (_settings.sharedThreads) {
+        LOG_ERROR("Zone", "Cannot profile zone \"%s\", its workers share threads.", _settings.id.c_str());
+        callback(NAPA_RESULT_PROFILING_ERROR);
+        return;
+    }
+
+    _scheduler->ScheduleOnAllWorkers([samplingInterval, &callback](uint32_t workers) {
+        return std::make_shared<StartProfilingTask>(workers, samplingInterval, std::move(callback));
+    });
+}
+
+void NapaZone::GetHeapStatistics(HeapStatisticsCallback callback) {
+    _scheduler->ScheduleOnAllWorkers([&callback](uint32_t workers) {
+        return std::make_shared<HeapStatisticsTask>(workers, std::move(callback));
+    });
+}
+
+void NapaZone::WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) {
+    if (workerId >= _scheduler->GetWorkerCount()) {
+        LOG_ERROR("Zone", "Cannot write a heap snapshot of worker %u, zone \"%s\" has %u workers.",
+            workerId, _settings.id.c_str(), _scheduler->GetWorkerCount());
+        callback(NAPA_RESULT_HEAP_SNAPSHOT_ERROR);
+        return;
+    }
+
+    NAPA_DEBUG("Zone", "Writing a heap snapshot of worker %u of zone \"%s\" to \"%s\".", workerId, _settings.id.c_str(), path.c_str());
+    _scheduler->ScheduleOnWorker(workerId, std::make_shared<HeapSnapshotTask>(path, std::move(callback)));
+}
+
+void NapaZone::StopProfiling(CpuProfileCallback callback) {
+    _scheduler->ScheduleOnAllWorkers([&callback](uint32_t workers) {
+        return std::make_shared<StopProfilingTask>(workers, std::move(callback));
+    });
+}
+
+void NapaZone::StartAllocationProfiling(uint32_t samplingInterval, ProfilingCallback callback) {
+    // Workers keep whether they profile per thread, which workers sharing threads hop between.
+    if (_settings.sharedThreads) {
+        LOG_ERROR("Zone", "Cannot profile allocations of zone \"%s\", its workers share threads.", _settings.id.c_str());
+        callback(NAPA_RESULT_PROFILING_ERROR);
+        return;
+    }
+
+    _scheduler->ScheduleOnAllWorkers([samplingInterval, &callback](uint32_t workers) {
+        return std::make_shared<StartAllocationProfilingTask>(workers, samplingInterval, std::move(callback));
+    });
+}
+
+void NapaZone::StopAllocationProfiling(AllocationProfileCallback callback) {
+    _scheduler->ScheduleOnAllWorkers([&callback](uint32_t workers) {
+        return std::make_shared<StopAllocationProfilingTask>(workers, std::move(callback));
+    });
+}
+
+std::vector<napa::SlowCall> NapaZone::GetSlowCalls() const {
+    return _slowCallLog != nullptr ? _slowCallLog->GetCalls() : std::vector<SlowCall>();
+}
+
+std::vector<napa::FunctionStats> NapaZone::GetFunctionStats() const {
+    return _metrics->GetFunctionStats().GetStats();
+}
+
+std::vector<std::shared_ptr<Task>> NapaZone::CreateWarmUpTasks(WorkerId workerId) {
+    auto entries = _broadcastLog.GetEntries();
+
+    std::vector<std::shared_ptr<Task>> tasks;
+    tasks.reserve(entries.size());
+    for (auto& entry : entries) {
+        auto callback = [zoneId = _settings.id, replayed = _replayedBroadcasts, workerId, sequence = entry.sequence](napa_result_code code) {
+            if (code != NAPA_RESULT_SUCCESS) {
+                LOG_WARNING("Zone", "Replaying a broadcast on worker %u of zone \"%s\" failed with result code %d.",
+                    workerId, zoneId.c_str(), code);
+            }
+
+            // Runs on the worker being warmed up, skipped broadcasts report an older sequence.
+            (*replayed)[workerId] = std::max((*replayed)[workerId], sequence);
+        };
+
+        auto task = std::make_shared<EvalTask>(std::move(entry.source), "", callback, std::move(entry.codeCache));
+        tasks.emplace_back(std::make_shared<LoggedBroadcastTask>(std::move(task), entry.sequence, std::move(callback), _replayedBroadcasts));
+    }
+    return tasks;
+}
+
+void NapaZone::AutoscaleLoop() {
+    auto interval = std::chrono::milliseconds(_settings.autoscaleInterval);
+    auto idleTime = std::chrono::milliseconds(_settings.autoscaleIdleTime);
+    auto maxWorkers = _scheduler->GetWorkerCapacity();
+    auto minWorkers = std::min(std::max(_settings.minWorkers, _scheduler->GetWorkerClassWorkers()), maxWorkers);
+
+    // Since when there has been an idle worker and nothing queued.
+    auto idleSince = std::chrono::steady_clock::time_point::max();
+
+    std::unique_lock<std::mutex> lock(_resizeLock);
+    while (!_resizeEvent.wait_for(lock, interval, [this]() { return _stopping; })) {
+        if (_pendingResizes > 0) {
+            continue;
+        }
+
+        auto workers = _scheduler->GetWorkerCount();
+        auto idleWorkers = _scheduler->GetIdleWorkerCount();
+        size_t queued = 0;
+        for (size_t priority = 0; priority <= static_cast<size_t>(CallPriority::BACKGROUND); priority++) {
+            queued += _scheduler->GetQueueDepth(static_cast<CallPriority>(priority));
+        }
+
+        uint32_t target = workers;
+        auto now = Clock::Now();
+        if (queued > 0 && idleWorkers == 0) {
+            // Grow with the backlog, at most doubling at a time.
+            idleSince = std::chrono::steady_clock::time_point::max();
+            auto growth = static_cast<uint32_t>(std::min<size_t>(queued, workers));
+            target = std::min(maxWorkers, workers + std::max(growth, 1u));
+        } else if (queued == 0 && idleWorkers > 0) {
+            // Shrink one worker at a time, once workers stayed idle long enough.
+            if (idleSince == std::chrono::steady_clock::time_point::max()) {
+                idleSince = now;
+            } else if (now - idleSince >= idleTime && workers > minWorkers) {
+                idleSince = now;
+                target = workers - 1;
+            }
+        } else {
+            idleSince = std::chrono::steady_clock::time_point::max();
+        }
+
+        if (target != workers) {
+            NAPA_DEBUG("Zone", "Autoscaling zone \"%s\" from %u to %u workers.", _settings.id.c_str(), workers, target);
+            lock.unlock();
+            Resize(target, [](ResultCode) {});
+            lock.lock();
+        }
+    }
+}
+
+void NapaZone::WatchdogLoop() {
+    WorkerWatchdog watchdog(std::chrono::milliseconds(_settings.stuckWorkerThreshold), _scheduler->GetWorkerCapacity());
+
+    // Workers added in place of stuck ones, removed again as stuck workers recover.
+    uint32_t replacements = 0;
+
+    // Resizes are waited for, so the next one starts from the number of workers this one leaves.
+    auto resize = [this](uint32_t workers) {
+        std::promise<ResultCode> promise;
+        auto future = promise.get_future();
+        Resize(workers, [&promise](ResultCode code) {
+            promise.set_value(code);
+        });
+        return future.get() == NAPA_RESULT_SUCCESS;
     };
 
-    auto broadcastTask = std::make_shared<EvalTask>(source, "", std::move(callOnce));
+    std::unique_lock<std::mutex> lock(_resizeLock);
+    while (!_resizeEvent.wait_for(lock, watchdog.GetCheckInterval(), [this]() { return _stopping; })) {
+        lock.unlock();
+        auto changes = watchdog.Check(_scheduler->GetWorkerCount(), [this](WorkerId id) {
+            return _scheduler->GetWorkerBusyTime(id);
+        });
 
-    _scheduler->ScheduleOnAllWorkers(std::move(broadcastTask));
-    NAPA_DEBUG("Zone", "Scheduling broadcast script \"%s\" to zone \"%s\"", source.c_str(), _settings.id.c_str());
+        for (const auto& change : changes) {
+            _scheduler->SetWorkerStuck(change.workerId, change.stuck);
+            _metrics->SetStuckWorkers(watchdog.GetStuckWorkerCount(), change.stuck);
+
+            auto workers = _scheduler->GetWorkerCount();
+            if (change.stuck) {
+                LOG_WARNING("Zone", "Worker %u of zone \"%s\" is stuck in a task for %lld ms, calls are routed to other workers.",
+                    change.workerId, _settings.id.c_str(),
+                    static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(change.busyTime).count()));
+
+                // Without a spare slot, the zone runs with one worker less until the worker recovers.
+                if (_settings.replaceStuckWorkers && workers < _scheduler->GetWorkerCapacity() && resize(workers + 1)) {
+                    replacements++;
+                }
+                continue;
+            }
+
+            LOG_INFO("Zone", "Worker %u of zone \"%s\" is no longer stuck.", change.workerId, _settings.id.c_str());
+            if (_settings.replaceStuckWorkers) {
+                // The stuck task may have left the isolate in a bad state, e.g. after a native call was abandoned.
+                _scheduler->RequestWorkerRecycle(change.workerId);
+
+                // The last worker is removed, which waits for its task to finish, unless it's stuck itself.
+                if (replacements > 0 && !_scheduler->IsWorkerStuck(workers - 1) && resize(workers - 1)) {
+                    replacements--;
+                }
+            }
+        }
+        lock.lock();
+    }
 }
 
 void NapaZone::Execute(const FunctionSpec& spec, ExecuteCallback callback) {
-    std::shared_ptr<Task> task;
+    // The trace id of the spec isn't null terminated, the queued span of the call carries it.
+    TraceScope traceScope("zone", "Schedule");
 
-    if (spec.options.timeout > 0) {
-        task = std::make_shared<TimeoutTaskDecorator<CallTask>>(
-            std::chrono::milliseconds(spec.options.timeout),
-            std::make_shared<CallContext>(spec, std::move(callback)));
-    } else {
-        task = std::make_shared<CallTask>(std::make_shared<CallContext>(spec, std::move(callback)));
+    int32_t workerClass = -1;
+    if (spec.options.worker_class.size > 0) {
+        workerClass = _scheduler->FindWorkerClass(spec.options.worker_class.data, spec.options.worker_class.size);
+        if (workerClass < 0) {
+            Result result;
+            result.code = NAPA_RESULT_UNKNOWN_WORKER_CLASS;
+            result.errorMessage = "Zone \"" + _settings.id + "\" has no worker class \""
+                + NAPA_STRING_REF_TO_STD_STRING(spec.options.worker_class) + "\"";
+            callback(std::move(result));
+            return;
+        }
+    }
+
+    if (spec.options.coalesce != 0 && _coalescer->Attach(ResultCache::GetKey(spec), callback)) {
+        _metrics->RecordCoalesce();
+        return;
+    }
+
+    if (ResolveFromCache(spec, callback)) {
+        return;
+    }
+
+    if (spec.options.hedge_after > 0) {
+        ExecuteHedged(spec, workerClass, std::move(callback));
+        return;
+    }
+
+    auto task = CreateCallTask(spec, std::move(callback));
+    if (task == nullptr) {
+        return;
     }
-    
+
     NAPA_DEBUG("Zone", "Execute function \"%s.%s\" on zone \"%s\"", spec.module.data, spec.function.data, _settings.id.c_str());
-    _scheduler->Schedule(std::move(task));
+    ScheduleCall(std::move(task), spec.options, workerClass);
+}
+
+void NapaZone::ExecuteHedged(const FunctionSpec& spec, int32_t workerClass, ExecuteCallback callback) {
+    auto call = std::make_shared<HedgedCall>(std::move(callback), static_cast<CancellationToken*>(spec.options.cancellation_token));
+
+    auto attemptSpec = [&spec, &call](HedgedCall::Attempt attempt) {
+        FunctionSpec attemptSpec;
+        attemptSpec.module = spec.module;
+        attemptSpec.function = spec.function;
+        attemptSpec.arguments = spec.arguments;
+        attemptSpec.options = spec.options;
+        attemptSpec.options.cancellation_token = call->GetToken(attempt);
+        attemptSpec.argumentsOwner = spec.argumentsOwner;
+        return attemptSpec;
+    };
+
+    // The hedge is created up front, as arguments of the spec may be freed once Execute returns. It isn't admitted
+    // nor counted as pending, it's only a copy of the primary call. Shared objects are passed to both.
+    auto hedgeSpec = attemptSpec(HedgedCall::HEDGE);
+    if (spec.transportContext != nullptr) {
+        hedgeSpec.transportContext = std::make_unique<napa::transport::TransportContext>();
+        hedgeSpec.transportContext->SaveAll(*spec.transportContext);
+    }
+    auto hedge = NewCallTask(hedgeSpec, call->GetCallback(HedgedCall::HEDGE));
+
+    auto primarySpec = attemptSpec(HedgedCall::PRIMARY);
+    primarySpec.transportContext = std::move(spec.transportContext);
+    auto task = CreateCallTask(primarySpec, call->GetCallback(HedgedCall::PRIMARY));
+    if (task == nullptr) {
+        return;
+    }
+
+    NAPA_DEBUG("Zone", "Execute hedged function \"%s.%s\" on zone \"%s\"", spec.module.data, spec.function.data, _settings.id.c_str());
+    ScheduleCall(std::move(task), spec.options, workerClass);
+
+    // The hedge goes to any worker of its class or tenant, ignoring affinity, so it doesn't queue behind the primary.
+    std::weak_ptr<Scheduler> weakScheduler = _scheduler;
+    auto priority = spec.options.priority;
+    auto tenant = workerClass < 0 ? _scheduler->FindOrAddTenant(spec.options.tenant.data, spec.options.tenant.size) : 0;
+    call->Arm(std::chrono::milliseconds(spec.options.hedge_after), [weakScheduler, hedge, priority, tenant, workerClass, metrics = _metrics]() {
+        auto scheduler = weakScheduler.lock();
+        if (scheduler == nullptr) {
+            return;
+        }
+
+        metrics->RecordHedge();
+        if (workerClass >= 0) {
+            scheduler->ScheduleOnWorkerClass(static_cast<size_t>(workerClass), hedge);
+        } else {
+            scheduler->Schedule(hedge, priority, tenant);
+        }
+    });
+}
+
+void NapaZone::ScheduleCall(std::shared_ptr<Task> task, const CallOptions& options, int32_t workerClass) {
+    if (workerClass >= 0) {
+        _scheduler->ScheduleOnWorkerClass(static_cast<size_t>(workerClass), std::move(task));
+    } else if (options.affinity_key.size > 0) {
+        // The scheduler takes it modulo the current number of workers.
+        auto workerId = static_cast<WorkerId>(HashAffinityKey(options.affinity_key));
+        _scheduler->ScheduleOnPreferredWorker(workerId, std::move(task), options.priority);
+    } else {
+        auto tenant = _scheduler->FindOrAddTenant(options.tenant.data, options.tenant.size);
+        _scheduler->Schedule(std::move(task), options.priority, tenant);
+    }
+}
+
+void NapaZone::ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) {
+    ExecuteBatch(specs, CreateBatchCallbacks(specs.size(), std::move(callback)));
+}
+
+void NapaZone::ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) {
+    TraceScope traceScope("zone", "ScheduleBatch");
+
+    // Calls without affinity, worker class or tenant are handed to the scheduler at once, per priority.
+    std::array<std::vector<std::shared_ptr<Task>>, static_cast<size_t>(CallPriority::BACKGROUND) + 1> tasks;
+    for (size_t i = 0; i < specs.size(); i++) {
+        const auto& spec = specs[i];
+        if (spec.options.affinity_key.size > 0
+            || spec.options.worker_class.size > 0
+            || spec.options.tenant.size > 0
+            || spec.options.hedge_after > 0
+            || spec.options.coalesce != 0) {
+            Execute(spec, std::move(callbacks[i]));
+            continue;
+        }
+
+        if (ResolveFromCache(spec, callbacks[i])) {
+            continue;
+        }
+
+        auto task = CreateCallTask(spec, std::move(callbacks[i]));
+        if (task != nullptr) {
+            tasks[spec.options.priority].emplace_back(std::move(task));
+        }
+    }
+
+    NAPA_DEBUG("Zone", "Execute a batch of %zu functions on zone \"%s\"", specs.size(), _settings.id.c_str());
+    for (size_t priority = 0; priority < tasks.size(); priority++) {
+        if (!tasks[priority].empty()) {
+            _scheduler->ScheduleBatch(std::move(tasks[priority]), static_cast<CallPriority>(priority));
+        }
+    }
+}
+
+bool NapaZone::ResolveFromCache(const FunctionSpec& spec, ExecuteCallback& callback) {
+    if (_resultCache == nullptr || !ResultCache::IsCacheable(spec)) {
+        return false;
+    }
+
+    auto key = ResultCache::GetKey(spec);
+    Result result;
+    if (_resultCache->Get(key, result.returnValue)) {
+        _metrics->RecordResultCacheLookup(true);
+        result.code = NAPA_RESULT_SUCCESS;
+        callback(std::move(result));
+        return true;
+    }
+    _metrics->RecordResultCacheLookup(false);
+
+    // Results returning shared objects aren't cached, their objects would be shared by all hits.
+    callback = [resultCache = _resultCache, key, callback = std::move(callback)](Result result) {
+        if (result.code == NAPA_RESULT_SUCCESS
+            && (result.transportContext == nullptr || result.transportContext->GetSharedCount() == 0)) {
+            resultCache->Put(key, result.returnValue);
+        }
+        callback(std::move(result));
+    };
+    return false;
+}
+
+std::shared_ptr<Task> NapaZone::CreateCallTask(const FunctionSpec& spec, ExecuteCallback callback) {
+    if (_settings.maxQueueLength > 0 || _settings.maxQueueBytes > 0) {
+        auto bytes = spec.module.size + spec.function.size;
+        for (const auto& arg : spec.arguments) {
+            bytes += arg.size;
+        }
+
+        if (!Admit(bytes)) {
+            NAPA_DEBUG("Zone", "Reject function \"%s.%s\" on zone \"%s\", too many pending calls.", spec.module.data, spec.function.data, _settings.id.c_str());
+            Result result;
+            result.code = NAPA_RESULT_ZONE_OVERLOADED;
+            result.errorMessage = "Too many pending calls in zone \"" + _settings.id + "\"";
+            callback(std::move(result));
+            _metrics->RecordFailure(NAPA_RESULT_ZONE_OVERLOADED);
+            return nullptr;
+        }
+
+        callback = [pendingCalls = _pendingCalls, bytes, callback = std::move(callback)](Result result) {
+            pendingCalls->count--;
+            pendingCalls->bytes -= bytes;
+            callback(std::move(result));
+        };
+    }
+    return NewCallTask(spec, std::move(callback));
+}
+
+std::shared_ptr<Task> NapaZone::NewCallTask(const FunctionSpec& spec, ExecuteCallback callback) {
+    // Objects and their control blocks are allocated from zone pools, which avoids a round trip to
+    // the heap allocator for each of them once the pools are warm.
+    auto context = std::allocate_shared<CallContext>(
+        utils::PoolAllocator<CallContext>(_callContextPool), spec, std::move(callback));
+    if (_slowCallLog != nullptr) {
+        context->TimePhases(_slowCallLog);
+    }
+
+    // The call task ends the span once a worker picks it up.
+    if (Tracing::IsEnabled()) {
+        Tracing::RecordAsyncSpan(true, "zone", "Queued", reinterpret_cast<uintptr_t>(context.get()), Tracing::Now(), context->GetTraceId());
+    }
+
+    if (spec.options.timeout > 0 || spec.options.cpu_timeout > 0) {
+        return std::allocate_shared<TimeoutTaskDecorator<CallTask>>(
+            utils::PoolAllocator<TimeoutTaskDecorator<CallTask>>(_timeoutCallTaskPool),
+            std::chrono::milliseconds(spec.options.timeout),
+            std::chrono::milliseconds(spec.options.cpu_timeout),
+            std::move(context),
+            _metrics);
+    }
+    return std::allocate_shared<CallTask>(utils::PoolAllocator<CallTask>(_callTaskPool), std::move(context), _metrics);
+}
+
+float NapaZone::GetPressure() const {
+    float pressure = 0.0f;
+    if (_settings.maxQueueLength > 0) {
+        pressure = static_cast<float>(_pendingCalls->count) / _settings.maxQueueLength;
+    }
+
+    if (_settings.maxQueueBytes > 0) {
+        pressure = std::max(pressure, static_cast<float>(_pendingCalls->bytes) / _settings.maxQueueBytes);
+    }
+    return pressure;
+}
+
+uint32_t NapaZone::GetWorkers() const {
+    return _scheduler->GetWorkerCount();
+}
+
+bool NapaZone::Admit(size_t bytes) {
+    auto count = ++_pendingCalls->count;
+    auto totalBytes = (_pendingCalls->bytes += bytes);
+
+    if ((_settings.maxQueueLength > 0 && count > _settings.maxQueueLength)
+        || (_settings.maxQueueBytes > 0 && totalBytes > _settings.maxQueueBytes)) {
+        _pendingCalls->count--;
+        _pendingCalls->bytes -= bytes;
+        return false;
+    }
+    return true;
 }
 
 const settings::ZoneSettings& NapaZone::GetSettings() const {
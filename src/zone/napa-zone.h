@@ -5,12 +5,25 @@
 
 #include "zone.h"
 
+#include "zone/broadcast-log.h"
+#include "zone/call-coalescer.h"
+#include "zone/result-cache.h"
 #include "zone/scheduler.h"
+#include "zone/slow-call-log.h"
+#include "zone/zone-metrics.h"
 #include "settings/settings.h"
+#include "utils/block-pool.h"
 
+#include <napa/providers/metric.h>
+
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 
 namespace napa {
@@ -23,9 +36,16 @@ namespace zone {
         /// <summary> Creates a new zone with the provided id and settings. </summary>
         static std::shared_ptr<NapaZone> Create(const settings::ZoneSettings& settings);
 
-        /// <summary> Retrieves an existing zone by id. </summary>
+        /// <summary> Retrieves an existing zone by id, without taking a lock unless zones were created since the last lookup of the thread. </summary>
         static std::shared_ptr<NapaZone> Get(const std::string& id);
 
+        /// <summary> Keeps a number of bootstrapped isolates aside, for workers of new zones to start on. </summary>
+        static void ReserveSpareIsolates(size_t count);
+
+        /// <summary> Notifies workers of all zones of memory pressure, interrupting busy ones. </summary>
+        /// <remarks> Idle workers run the notification with the priority of broadcasts, new workers apply the level on setup. </remarks>
+        static void NotifyMemoryPressure(MemoryPressureLevel level);
+
         /// <see cref="Zone::GetId" />
         virtual const std::string& GetId() const override;
 
@@ -35,6 +55,64 @@ namespace zone {
         /// <see cref="Zone::Execute" />
         virtual void Execute(const FunctionSpec& spec, ExecuteCallback callback) override;
 
+        /// <see cref="Zone::ExecuteBatch" />
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) override;
+
+        /// <see cref="Zone::ExecuteBatch" />
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) override;
+
+        /// <see cref="Zone::GetPressure" />
+        virtual float GetPressure() const override;
+
+        /// <see cref="Zone::GetWorkers" />
+        virtual uint32_t GetWorkers() const override;
+
+        /// <see cref="Zone::Resize" />
+        /// <remarks> New workers replay the bootstrap and all broadcasts before they take calls. </remarks>
+        virtual void Resize(uint32_t workers, ResizeCallback callback) override;
+
+        /// <see cref="Zone::Drain" />
+        /// <remarks>
+        ///     Waits for running calls and asynchronous work they left, then cancels calls still waiting for a worker.
+        ///     It fails on a worker of the zone, which would wait for its own call.
+        /// </remarks>
+        virtual void Drain(uint32_t timeout, DrainCallback callback) override;
+
+        /// <see cref="Zone::GetMemoryUsage" />
+        /// <remarks> Runs on all workers with the priority of broadcasts, ahead of queued calls. </remarks>
+        virtual void GetMemoryUsage(MemoryUsageCallback callback) override;
+
+        /// <see cref="Zone::StartProfiling" />
+        /// <remarks> Each worker starts its own profiler between two tasks, workers don't recycle their isolate while profiling. </remarks>
+        virtual void StartProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopProfiling" />
+        virtual void StopProfiling(CpuProfileCallback callback) override;
+
+        /// <see cref="Zone::StartAllocationProfiling" />
+        virtual void StartAllocationProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopAllocationProfiling" />
+        virtual void StopAllocationProfiling(AllocationProfileCallback callback) override;
+
+        /// <see cref="Zone::GetHeapStatistics" />
+        /// <remarks> Runs on all workers with the priority of broadcasts, ahead of queued calls. </remarks>
+        virtual void GetHeapStatistics(HeapStatisticsCallback callback) override;
+
+        /// <see cref="Zone::WriteHeapSnapshot" />
+        /// <remarks> Runs on the worker ahead of its queued calls, which wait while the snapshot is written. </remarks>
+        virtual void WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) override;
+
+        /// <see cref="Zone::GetSlowCalls" />
+        /// <remarks> Empty unless settings slowCallThreshold or slowCallSampleRate are set. </remarks>
+        virtual std::vector<SlowCall> GetSlowCalls() const override;
+
+        /// <see cref="Zone::GetFunctionStats" />
+        virtual std::vector<FunctionStats> GetFunctionStats() const override;
+
+        /// <summary> Destructor. Stops the autoscaler and the watchdog, waits for pending resizes, then shuts down the workers. </summary>
+        ~NapaZone();
+
         /// <summary> Retrieves the zone settings. </summary>
         const settings::ZoneSettings& GetSettings() const;
 
@@ -48,8 +126,97 @@ namespace zone {
         settings::ZoneSettings _settings;
         std::shared_ptr<zone::Scheduler> _scheduler;
 
+        /// <summary> Calls that were admitted but haven't finished yet. </summary>
+        struct PendingCalls {
+            std::atomic<size_t> count { 0 };
+            std::atomic<size_t> bytes { 0 };
+        };
+
+        /// <summary> Admits a call if it fits into zone limits, and counts it as pending. </summary>
+        bool Admit(size_t bytes);
+
+        /// <summary> Creates the task for a call, or rejects the call and returns nullptr if the zone is overloaded. </summary>
+        std::shared_ptr<Task> CreateCallTask(const FunctionSpec& spec, ExecuteCallback callback);
+
+        /// <summary> Creates the task for a call, without admitting it. </summary>
+        std::shared_ptr<Task> NewCallTask(const FunctionSpec& spec, ExecuteCallback callback);
+
+        /// <summary> Schedules the task of a call by its worker class, affinity key or tenant. </summary>
+        /// <param name="workerClass"> The index of the worker class of the call, -1 for none. </param>
+        void ScheduleCall(std::shared_ptr<Task> task, const CallOptions& options, int32_t workerClass);
+
+        /// <summary> Executes a call with a hedge, which starts on another worker if the call is still pending after its delay. </summary>
+        void ExecuteHedged(const FunctionSpec& spec, int32_t workerClass, ExecuteCallback callback);
+
+        /// <summary> Resolves a call from the result cache, or makes the callback fill the cache on a miss. </summary>
+        /// <returns> True if the call was resolved, with the callback called back. </returns>
+        bool ResolveFromCache(const FunctionSpec& spec, ExecuteCallback& callback);
+
+        /// <summary> Creates the tasks that replay broadcasts on a new worker. </summary>
+        std::vector<std::shared_ptr<Task>> CreateWarmUpTasks(WorkerId workerId);
+
+        /// <summary> Autoscaler thread: resizes the zone by queue depth and idle workers, every autoscale interval. </summary>
+        void AutoscaleLoop();
+
+        /// <summary> Watchdog thread: finds stuck workers, routes calls around them and replaces them if enabled. </summary>
+        void WatchdogLoop();
+
+        /// <summary> Pending calls, shared with call callbacks which may outlive the zone. </summary>
+        std::shared_ptr<PendingCalls> _pendingCalls;
+
+        /// <summary> Built-in metrics of calls, shared with call tasks which may outlive the zone. </summary>
+        std::shared_ptr<ZoneMetrics> _metrics;
+
+        /// <summary> Results of calls, null if disabled. Shared with call callbacks which may outlive the zone. </summary>
+        std::shared_ptr<ResultCache> _resultCache;
+
+        /// <summary> Calls in flight that identical calls attach to. Shared with call callbacks which may outlive the zone. </summary>
+        std::shared_ptr<CallCoalescer> _coalescer;
+
+        /// <summary> Slow and sampled calls, null if disabled. Shared with call contexts which may outlive the zone. </summary>
+        std::shared_ptr<SlowCallLog> _slowCallLog;
+
+        /// <summary> Number of workers, reported on each resize. </summary>
+        providers::Metric* _workersMetric;
+
+        /// <summary> Recycled memory of call contexts and call tasks, one pool per object type. </summary>
+        std::shared_ptr<utils::BlockPool> _callContextPool;
+        std::shared_ptr<utils::BlockPool> _callTaskPool;
+        std::shared_ptr<utils::BlockPool> _timeoutCallTaskPool;
+
+        /// <summary> Sources broadcast to the zone in order, including the bootstrap. Replayed on new workers. </summary>
+        BroadcastLog _broadcastLog;
+
+        /// <summary> Number of resizes that didn't finish yet, the lock and event also serve the autoscaler. </summary>
+        uint32_t _pendingResizes;
+        std::mutex _resizeLock;
+        std::condition_variable _resizeEvent;
+
+        /// <summary>
+        ///     Sequence of the last broadcast each worker replayed from the log. Only accessed from the worker's thread.
+        ///     Shared with broadcast tasks, which may outlive the zone.
+        /// </summary>
+        std::shared_ptr<std::vector<uint64_t>> _replayedBroadcasts;
+
+        /// <summary> The autoscaler thread, if autoscaling is enabled. </summary>
+        std::thread _autoscaler;
+
+        /// <summary> The watchdog thread, if stuckWorkerThreshold is set. </summary>
+        std::thread _watchdog;
+
+        /// <summary> Stops the autoscaler and the watchdog, guarded by the resize lock. </summary>
+        bool _stopping;
+
+        typedef std::unordered_map<std::string, std::weak_ptr<NapaZone>> ZoneMap;
+
+        /// <summary>
+        ///     Zones by id, guarded by the lock and replaced as a whole when a zone is created, with expired zones pruned.
+        ///     The version moves on each replacement. Lookups keep a snapshot per thread and only take the lock to
+        ///     refresh it when the version moved, as copies of a shared_ptr don't load or store atomically without a lock.
+        /// </summary>
         static std::mutex _mutex;
-        static std::unordered_map<std::string, std::weak_ptr<NapaZone>> _zones;
+        static std::shared_ptr<const ZoneMap> _zones;
+        static std::atomic<uint64_t> _zonesVersion;
     };
 }
 }
\ No newline at end of file
@@ -2,7 +2,7 @@
 // Licensed under the MIT license.
 
 #include "node-zone.h"
-
+#include "batch-callback.h"
 #include "worker-context.h"
 
 #include <napa/assert.h>
@@ -12,15 +12,33 @@ using namespace napa::zone;
 
 std::shared_ptr<NodeZone> NodeZone::_instance;
 
-void NodeZone::Init(BroadcastDelegate broadcast, ExecuteDelegate execute) {
-    _instance.reset(new NodeZone(broadcast, execute));
+void NodeZone::Init(
+    BroadcastDelegate broadcast,
+    ExecuteDelegate execute,
+    MemoryUsageDelegate memoryUsage,
+    HeapStatisticsDelegate heapStatistics,
+    HeapSnapshotDelegate heapSnapshot) {
+    _instance.reset(new NodeZone(broadcast, execute, memoryUsage, heapStatistics, heapSnapshot));
 }
 
-NodeZone::NodeZone(BroadcastDelegate broadcast, ExecuteDelegate execute):
-    _broadcast(std::move(broadcast)), _execute(std::move(execute)), _id("node") {
+NodeZone::NodeZone(
+    BroadcastDelegate broadcast,
+    ExecuteDelegate execute,
+    MemoryUsageDelegate memoryUsage,
+    HeapStatisticsDelegate heapStatistics,
+    HeapSnapshotDelegate heapSnapshot):
+    _broadcast(std::move(broadcast)),
+    _execute(std::move(execute)),
+    _memoryUsage(std::move(memoryUsage)),
+    _heapStatistics(std::move(heapStatistics)),
+    _heapSnapshot(std::move(heapSnapshot)),
+    _id("node") {
 
     NAPA_ASSERT(_broadcast, "Broadcast delegate must be a valid function.");
     NAPA_ASSERT(_execute, "Execute delegate must be a valid function.");
+    NAPA_ASSERT(_memoryUsage, "Memory usage delegate must be a valid function.");
+    NAPA_ASSERT(_heapStatistics, "Heap statistics delegate must be a valid function.");
+    NAPA_ASSERT(_heapSnapshot, "Heap snapshot delegate must be a valid function.");
 
     // Init worker context for Node event loop.
     INIT_WORKER_CONTEXT();
@@ -47,3 +65,69 @@ void NodeZone::Broadcast(const std::string& source, BroadcastCallback callback)
 void NodeZone::Execute(const FunctionSpec& spec, ExecuteCallback callback) {
     _execute(spec, callback);
 }
+
+void NodeZone::ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) {
+    ExecuteBatch(specs, CreateBatchCallbacks(specs.size(), std::move(callback)));
+}
+
+void NodeZone::ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) {
+    for (size_t i = 0; i < specs.size(); i++) {
+        _execute(specs[i], std::move(callbacks[i]));
+    }
+}
+
+float NodeZone::GetPressure() const {
+    return 0.0f;
+}
+
+uint32_t NodeZone::GetWorkers() const {
+    return 1;
+}
+
+void NodeZone::Resize(uint32_t /*workers*/, ResizeCallback callback) {
+    callback(NAPA_RESULT_ZONE_RESIZE_ERROR);
+}
+
+void NodeZone::Drain(uint32_t /*timeout*/, DrainCallback callback) {
+    callback(NAPA_RESULT_SUCCESS, 0);
+}
+
+void NodeZone::GetMemoryUsage(MemoryUsageCallback callback) {
+    _memoryUsage(std::move(callback));
+}
+
+void NodeZone::GetHeapStatistics(HeapStatisticsCallback callback) {
+    _heapStatistics(std::move(callback));
+}
+
+void NodeZone::WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) {
+    if (workerId != 0) {
+        callback(NAPA_RESULT_HEAP_SNAPSHOT_ERROR);
+        return;
+    }
+    _heapSnapshot(path, std::move(callback));
+}
+
+std::vector<napa::SlowCall> NodeZone::GetSlowCalls() const {
+    return std::vector<SlowCall>();
+}
+
+std::vector<napa::FunctionStats> NodeZone::GetFunctionStats() const {
+    return std::vector<FunctionStats>();
+}
+
+void NodeZone::StartProfiling(uint32_t /*samplingInterval*/, ProfilingCallback callback) {
+    callback(NAPA_RESULT_PROFILING_ERROR);
+}
+
+void NodeZone::StopProfiling(CpuProfileCallback callback) {
+    callback({ std::string() });
+}
+
+void NodeZone::StartAllocationProfiling(uint32_t /*samplingInterval*/, ProfilingCallback callback) {
+    callback(NAPA_RESULT_PROFILING_ERROR);
+}
+
+void NodeZone::StopAllocationProfiling(AllocationProfileCallback callback) {
+    callback(std::string());
+}
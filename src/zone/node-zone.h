@@ -18,11 +18,25 @@ namespace zone {
     /// <summary> Delegate for Execute on Node zone. </summary>
     using ExecuteDelegate = std::function<void(const FunctionSpec&, ExecuteCallback)>;
 
+    /// <summary> Delegate for GetMemoryUsage on Node zone. </summary>
+    using MemoryUsageDelegate = std::function<void(MemoryUsageCallback)>;
+
+    /// <summary> Delegate for GetHeapStatistics on Node zone. </summary>
+    using HeapStatisticsDelegate = std::function<void(HeapStatisticsCallback)>;
+
+    /// <summary> Delegate for WriteHeapSnapshot on Node zone. </summary>
+    using HeapSnapshotDelegate = std::function<void(const std::string&, HeapSnapshotCallback)>;
+
     /// <summary> Concrete implementation of a Node zone. </summary>
     class NodeZone : public Zone {
     public:
-        /// <summary> Set delegate function for Broadcast and Execute on node zone. This is intended to be called from napa-binding.node. </summary>
-        static NAPA_API void Init(BroadcastDelegate broadcast, ExecuteDelegate execute);
+        /// <summary> Set delegate functions of operations which run on the Node event loop. This is intended to be called from napa-binding.node. </summary>
+        static NAPA_API void Init(
+            BroadcastDelegate broadcast,
+            ExecuteDelegate execute,
+            MemoryUsageDelegate memoryUsage,
+            HeapStatisticsDelegate heapStatistics,
+            HeapSnapshotDelegate heapSnapshot);
 
         /// <summary> 
         ///    Retrieves an existing zone. 
@@ -39,9 +53,71 @@ namespace zone {
         /// <see cref="Zone::Execute" />
         virtual void Execute(const FunctionSpec& spec, ExecuteCallback callback) override;
 
+        /// <see cref="Zone::ExecuteBatch" />
+        /// <remarks> Node zone runs calls on a single thread, the batch is executed call by call. </remarks>
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) override;
+
+        /// <see cref="Zone::ExecuteBatch" />
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) override;
+
+        /// <see cref="Zone::GetPressure" />
+        /// <remarks> Node zone has no limits on pending calls. </remarks>
+        virtual float GetPressure() const override;
+
+        /// <see cref="Zone::GetWorkers" />
+        /// <remarks> Node runs calls on its only thread. </remarks>
+        virtual uint32_t GetWorkers() const override;
+
+        /// <see cref="Zone::Resize" />
+        /// <remarks> Node zone always has the single Node event loop thread, resizing fails. </remarks>
+        virtual void Resize(uint32_t workers, ResizeCallback callback) override;
+
+        /// <see cref="Zone::Drain" />
+        /// <remarks> Node runs calls as they are made, there is no queue to drain. </remarks>
+        virtual void Drain(uint32_t timeout, DrainCallback callback) override;
+
+        /// <see cref="Zone::GetMemoryUsage" />
+        /// <remarks> Reports the Node isolate as worker 0. </remarks>
+        virtual void GetMemoryUsage(MemoryUsageCallback callback) override;
+
+        /// <see cref="Zone::StartProfiling" />
+        /// <remarks> Node is profiled with its own tools, e.g. the inspector, starting fails. </remarks>
+        virtual void StartProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopProfiling" />
+        /// <remarks> Reports an empty profile for the Node isolate. </remarks>
+        virtual void StopProfiling(CpuProfileCallback callback) override;
+
+        /// <see cref="Zone::StartAllocationProfiling" />
+        virtual void StartAllocationProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopAllocationProfiling" />
+        virtual void StopAllocationProfiling(AllocationProfileCallback callback) override;
+
+        /// <see cref="Zone::GetHeapStatistics" />
+        /// <remarks> Reports the Node isolate as worker 0. </remarks>
+        virtual void GetHeapStatistics(HeapStatisticsCallback callback) override;
+
+        /// <see cref="Zone::WriteHeapSnapshot" />
+        /// <remarks> Snapshots the Node isolate as worker 0. </remarks>
+        virtual void WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) override;
+
+        /// <see cref="Zone::GetSlowCalls" />
+        /// <remarks> Calls to the Node zone run on the Node event loop, which has no slow-call log. </remarks>
+        virtual std::vector<SlowCall> GetSlowCalls() const override;
+
+        /// <see cref="Zone::GetFunctionStats" />
+        /// <remarks> Calls to the Node zone run on the Node event loop, which keeps no statistics. </remarks>
+        virtual std::vector<FunctionStats> GetFunctionStats() const override;
+
     private:
         /// <summary> Constructor. </summary>
-        NodeZone(BroadcastDelegate broadcast, ExecuteDelegate execute);
+        NodeZone(
+            BroadcastDelegate broadcast,
+            ExecuteDelegate execute,
+            MemoryUsageDelegate memoryUsage,
+            HeapStatisticsDelegate heapStatistics,
+            HeapSnapshotDelegate heapSnapshot);
 
         /// <summary> Broadcast delegate for node zone. </summary>
         BroadcastDelegate _broadcast;
@@ -49,6 +125,15 @@ namespace zone {
         /// <summary> Execute delegate for node zone. </summary>
         ExecuteDelegate _execute;
 
+        /// <summary> GetMemoryUsage delegate for node zone. </summary>
+        MemoryUsageDelegate _memoryUsage;
+
+        /// <summary> GetHeapStatistics delegate for node zone. </summary>
+        HeapStatisticsDelegate _heapStatistics;
+
+        /// <summary> WriteHeapSnapshot delegate for node zone. </summary>
+        HeapSnapshotDelegate _heapSnapshot;
+
         /// <summary> Node zone id. </summary>
         std::string _id;
 
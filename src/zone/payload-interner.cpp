@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "payload-interner.h"
+
+#include <utils/hash.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace napa::zone;
+
+constexpr size_t PayloadInterner::MIN_PAYLOAD_SIZE;
+
+PayloadInterner& PayloadInterner::GetInstance() {
+    // Never destroyed, since V8 strings may release payloads during process exit.
+    static PayloadInterner* payloadInterner = new PayloadInterner();
+    return *payloadInterner;
+}
+
+std::shared_ptr<const PayloadInterner::Payload> PayloadInterner::Intern(const char* data, size_t size) {
+    auto hash = utils::hash::XxHash64(data, size, 0);
+
+    // Colliding payloads are released after the lock, since their deleters take the lock.
+    std::vector<std::shared_ptr<const Payload>> collisions;
+
+    std::lock_guard<std::mutex> lock(_lock);
+    auto range = _payloads.equal_range(hash);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+        // A payload whose last reference is being released can't be locked anymore, it's removed by its deleter.
+        auto payload = iter->second.second.lock();
+        if (payload == nullptr) {
+            continue;
+        }
+        if (payload->data.size() == size && std::memcmp(payload->data.data(), data, size) == 0) {
+            return payload;
+        }
+        collisions.emplace_back(std::move(payload));
+    }
+
+    auto ascii = true;
+    for (size_t i = 0; i < size; ++i) {
+        if ((data[i] & 0x80) != 0) {
+            ascii = false;
+            break;
+        }
+    }
+
+    std::shared_ptr<const Payload> payload(
+        new Payload { std::string(data, size), ascii },
+        [this, hash](const Payload* payload) {
+            Remove(hash, payload);
+            delete payload;
+        });
+
+    _payloads.emplace(hash, std::make_pair(payload.get(), std::weak_ptr<const Payload>(payload)));
+    return payload;
+}
+
+void PayloadInterner::Remove(uint64_t hash, const Payload* payload) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto range = _payloads.equal_range(hash);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+        if (iter->second.first == payload) {
+            _payloads.erase(iter);
+            return;
+        }
+    }
+}
+
+size_t PayloadInterner::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _payloads.size();
+}
@@ -0,0 +1,62 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Process-wide table of large marshalled arguments, so calls repeating the same argument share one copy. </summary>
+    /// <remarks>
+    ///     Payloads are keyed by 64-bit xxHash and compared by content. The table doesn't own payloads,
+    ///     a payload is removed once the last call context or V8 string referring to it is gone.
+    ///     It's exposed in napa.dll, so calls from Node and Napa isolates share the same instance.
+    /// </remarks>
+    class NAPA_API PayloadInterner {
+    public:
+
+        /// <summary> An immutable interned payload. </summary>
+        struct Payload {
+            /// <summary> Payload bytes. </summary>
+            std::string data;
+
+            /// <summary> Whether all bytes are ASCII, so the payload can back a one-byte V8 string as is. </summary>
+            bool ascii;
+        };
+
+        /// <summary> Payloads smaller than this are not worth hashing, they are copied per call. </summary>
+        static constexpr size_t MIN_PAYLOAD_SIZE = 1024;
+
+        /// <summary> Gets the process-wide instance. </summary>
+        static PayloadInterner& GetInstance();
+
+        /// <summary> Constructor. </summary>
+        PayloadInterner() = default;
+
+        /// <summary> Non-copyable. </summary>
+        PayloadInterner(const PayloadInterner&) = delete;
+        PayloadInterner& operator=(const PayloadInterner&) = delete;
+
+        /// <summary> Gets the interned payload of given bytes, which is created if no payload alive has the same bytes. </summary>
+        std::shared_ptr<const Payload> Intern(const char* data, size_t size);
+
+        /// <summary> Gets the number of payloads alive. </summary>
+        size_t GetSize() const;
+
+    private:
+        /// <summary> Removes a payload whose last reference is released. </summary>
+        void Remove(uint64_t hash, const Payload* payload);
+
+        std::unordered_multimap<uint64_t, std::pair<const Payload*, std::weak_ptr<const Payload>>> _payloads;
+        mutable std::mutex _lock;
+    };
+}
+}
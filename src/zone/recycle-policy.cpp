@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "recycle-policy.h"
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+    // Below this size, a sparse heap is just a young one and isn't worth recycling.
+    constexpr size_t MIN_FRAGMENTED_HEAP_SIZE = 32 * 1024 * 1024;
+}
+
+uint64_t zone::GetRecycleTaskCount(uint32_t workerId, uint32_t generation, const settings::ZoneSettings& settings) {
+    uint64_t count = settings.recycleTaskCount;
+    if (count == 0) {
+        return 0;
+    }
+
+    // Knuth's multiplicative hash spreads consecutive workers and generations over [0, 1024).
+    auto spread = ((workerId + 1) * 2654435761u + generation * 40503u) % 1024;
+    return count + count * spread / 2048;
+}
+
+bool zone::IsHeapRecycleNeeded(const HeapUsage& usage, const settings::ZoneSettings& settings) {
+    if (settings.recycleHeapSize > 0 && usage.usedHeapSize >= static_cast<size_t>(settings.recycleHeapSize) * 1024 * 1024) {
+        return true;
+    }
+
+    if (settings.recycleFragmentation > 0 && usage.totalHeapSize >= MIN_FRAGMENTED_HEAP_SIZE) {
+        auto freeSize = usage.totalHeapSize > usage.usedHeapSize ? usage.totalHeapSize - usage.usedHeapSize : 0;
+        return freeSize * 100 >= static_cast<size_t>(settings.recycleFragmentation) * usage.totalHeapSize;
+    }
+
+    return false;
+}
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "settings/settings.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Heap usage of an isolate, as reported by v8::HeapStatistics. </summary>
+    struct HeapUsage {
+        /// <summary> Bytes used by objects, including garbage not collected yet. </summary>
+        size_t usedHeapSize;
+
+        /// <summary> Bytes committed for the heap. </summary>
+        size_t totalHeapSize;
+    };
+
+    /// <summary> Gets the number of tasks after which a worker recycles its isolate. </summary>
+    /// <param name="workerId"> The worker id. </param>
+    /// <param name="generation"> The number of times the worker recycled its isolate so far. </param>
+    /// <param name="settings"> The zone settings that hold the recycling policy. </param>
+    /// <returns> The number of tasks, in [recycleTaskCount, 1.5 * recycleTaskCount), or 0 if the policy is disabled. </returns>
+    /// <remarks> The count is staggered per worker and generation, so workers of a zone don't recycle all at once. </remarks>
+    uint64_t GetRecycleTaskCount(uint32_t workerId, uint32_t generation, const settings::ZoneSettings& settings);
+
+    /// <summary> Tells whether the heap usage of an isolate calls for recycling it, by heap size or fragmentation. </summary>
+    /// <param name="usage"> The heap usage of the isolate. </param>
+    /// <param name="settings"> The zone settings that hold the recycling policy. </param>
+    bool IsHeapRecycleNeeded(const HeapUsage& usage, const settings::ZoneSettings& settings);
+}
+}
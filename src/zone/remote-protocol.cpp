@@ -0,0 +1,314 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "remote-protocol.h"
+
+#include <utils/compression.h>
+#include <utils/debug.h>
+
+#include <cstring>
+
+using namespace napa;
+using namespace napa::zone;
+using namespace napa::zone::remote;
+
+FrameWriter::FrameWriter(std::string& buffer) : _buffer(buffer), _frameStart(std::string::npos) {}
+
+void FrameWriter::Begin(FrameType type, uint64_t id) {
+    NAPA_ASSERT(_frameStart == std::string::npos, "the previous frame wasn't ended");
+
+    _frameStart = _buffer.size();
+    WriteUint32(0);
+    WriteUint8(static_cast<uint8_t>(type));
+    WriteUint64(id);
+}
+
+void FrameWriter::End() {
+    NAPA_ASSERT(_frameStart != std::string::npos, "no frame was begun");
+
+    auto payloadStart = _frameStart + HEADER_SIZE;
+    if (_buffer.size() - payloadStart >= COMPRESS_ABOVE) {
+        std::string compressed;
+        if (utils::compression::Compress(_buffer.data() + payloadStart, _buffer.size() - payloadStart, compressed)
+            && compressed.size() < _buffer.size() - payloadStart) {
+            _buffer.replace(payloadStart, std::string::npos, compressed);
+            _buffer[_frameStart + 4] = static_cast<char>(static_cast<uint8_t>(_buffer[_frameStart + 4]) | COMPRESSED_FLAG);
+        }
+    }
+
+    auto size = static_cast<uint32_t>(_buffer.size() - payloadStart);
+    for (size_t i = 0; i < 4; i++) {
+        _buffer[_frameStart + i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+    }
+    _frameStart = std::string::npos;
+}
+
+void FrameWriter::WriteUint8(uint8_t value) {
+    _buffer.push_back(static_cast<char>(value));
+}
+
+void FrameWriter::WriteUint32(uint32_t value) {
+    for (size_t i = 0; i < 4; i++) {
+        _buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void FrameWriter::WriteUint64(uint64_t value) {
+    for (size_t i = 0; i < 8; i++) {
+        _buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void FrameWriter::WriteFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteUint32(bits);
+}
+
+void FrameWriter::WriteString(const char* data, size_t size) {
+    WriteUint32(static_cast<uint32_t>(size));
+    _buffer.append(data, size);
+}
+
+FrameReader::FrameReader(const char* data, size_t size) : _data(data), _size(size), _position(0) {}
+
+bool FrameReader::ReadUint8(uint8_t& value) {
+    if (_size - _position < 1) {
+        return false;
+    }
+    value = static_cast<uint8_t>(_data[_position++]);
+    return true;
+}
+
+bool FrameReader::ReadUint32(uint32_t& value) {
+    if (_size - _position < 4) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(_data[_position++])) << (8 * i);
+    }
+    return true;
+}
+
+bool FrameReader::ReadUint64(uint64_t& value) {
+    if (_size - _position < 8) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(_data[_position++])) << (8 * i);
+    }
+    return true;
+}
+
+bool FrameReader::ReadFloat(float& value) {
+    uint32_t bits;
+    if (!ReadUint32(bits)) {
+        return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+bool FrameReader::ReadString(std::string& value) {
+    uint32_t size;
+    auto start = _position;
+    if (!ReadUint32(size)) {
+        return false;
+    }
+    if (_size - _position < size) {
+        _position = start;
+        return false;
+    }
+    value.assign(_data + _position, size);
+    _position += size;
+    return true;
+}
+
+bool remote::ReadHeader(const char* data, FrameHeader& header) {
+    FrameReader reader(data, HEADER_SIZE);
+    uint8_t type;
+    reader.ReadUint32(header.size);
+    reader.ReadUint8(type);
+    reader.ReadUint64(header.id);
+
+    header.compressed = (type & COMPRESSED_FLAG) != 0;
+    type = static_cast<uint8_t>(type & ~COMPRESSED_FLAG);
+    header.type = static_cast<FrameType>(type);
+    return header.size <= MAX_PAYLOAD_SIZE
+        && type >= static_cast<uint8_t>(FrameType::HELLO)
+        && type <= static_cast<uint8_t>(FrameType::BROADCAST_RESULT);
+}
+
+bool remote::ReceiveFrame(platform::Socket& socket, FrameHeader& header, std::string& payload) {
+    char headerData[HEADER_SIZE];
+    if (!socket.Receive(headerData, HEADER_SIZE) || !ReadHeader(headerData, header)) {
+        return false;
+    }
+
+    payload.resize(header.size);
+    if (header.size > 0 && !socket.Receive(&payload[0], header.size)) {
+        return false;
+    }
+    if (!header.compressed) {
+        return true;
+    }
+
+    std::string decompressed;
+    if (!utils::compression::Decompress(payload.data(), payload.size(), decompressed, MAX_PAYLOAD_SIZE)) {
+        return false;
+    }
+    payload.swap(decompressed);
+    header.size = static_cast<uint32_t>(payload.size());
+    return true;
+}
+
+FunctionSpec ExecuteRequest::ToSpec() const {
+    FunctionSpec spec;
+    spec.module = STD_STRING_TO_NAPA_STRING_REF(module);
+    spec.function = STD_STRING_TO_NAPA_STRING_REF(function);
+    spec.arguments.reserve(arguments.size());
+    for (const auto& argument : arguments) {
+        spec.arguments.emplace_back(STD_STRING_TO_NAPA_STRING_REF(argument));
+    }
+    spec.options.timeout = timeout;
+    spec.options.cpu_timeout = cpuTimeout;
+    spec.options.transport = transport;
+    spec.options.priority = priority;
+    spec.options.affinity_key = STD_STRING_TO_NAPA_STRING_REF(affinityKey);
+    spec.options.trace_id = STD_STRING_TO_NAPA_STRING_REF(traceId);
+    spec.options.worker_class = STD_STRING_TO_NAPA_STRING_REF(workerClass);
+    spec.options.tenant = STD_STRING_TO_NAPA_STRING_REF(tenant);
+    return spec;
+}
+
+void remote::WriteHello(std::string& buffer, const std::string& zoneId, uint32_t workers, float pressure) {
+    FrameWriter writer(buffer);
+    writer.Begin(FrameType::HELLO, 0);
+    writer.WriteUint32(PROTOCOL_VERSION);
+    writer.WriteString(zoneId.data(), zoneId.size());
+    writer.WriteUint32(workers);
+    writer.WriteFloat(pressure);
+    writer.End();
+}
+
+bool remote::ReadHello(FrameReader& reader, std::string& zoneId, uint32_t& workers, float& pressure) {
+    uint32_t version;
+    return reader.ReadUint32(version)
+        && version == PROTOCOL_VERSION
+        && reader.ReadString(zoneId)
+        && reader.ReadUint32(workers)
+        && reader.ReadFloat(pressure);
+}
+
+void remote::WriteExecute(std::string& buffer, uint64_t id, const FunctionSpec& spec) {
+    FrameWriter writer(buffer);
+    writer.Begin(FrameType::EXECUTE, id);
+    writer.WriteString(spec.module.data, spec.module.size);
+    writer.WriteString(spec.function.data, spec.function.size);
+    writer.WriteUint32(static_cast<uint32_t>(spec.arguments.size()));
+    for (const auto& argument : spec.arguments) {
+        writer.WriteString(argument.data, argument.size);
+    }
+    writer.WriteUint32(spec.options.timeout);
+    writer.WriteUint32(spec.options.cpu_timeout);
+    writer.WriteUint8(static_cast<uint8_t>(spec.options.transport));
+    writer.WriteUint8(static_cast<uint8_t>(spec.options.priority));
+    writer.WriteString(spec.options.affinity_key.data, spec.options.affinity_key.size);
+    writer.WriteString(spec.options.trace_id.data, spec.options.trace_id.size);
+    writer.WriteString(spec.options.worker_class.data, spec.options.worker_class.size);
+    writer.WriteString(spec.options.tenant.data, spec.options.tenant.size);
+    writer.WriteUint8(spec.options.cancellation_token != nullptr ? 1 : 0);
+    writer.End();
+}
+
+bool remote::ReadExecute(FrameReader& reader, ExecuteRequest& request) {
+    uint32_t count;
+    if (!reader.ReadString(request.module) || !reader.ReadString(request.function) || !reader.ReadUint32(count)) {
+        return false;
+    }
+
+    // Each argument takes at least its size, which bounds a forged count by the frame size.
+    request.arguments.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        std::string argument;
+        if (!reader.ReadString(argument)) {
+            return false;
+        }
+        request.arguments.emplace_back(std::move(argument));
+    }
+
+    uint8_t transport, priority, cancellable;
+    if (!reader.ReadUint32(request.timeout)
+        || !reader.ReadUint32(request.cpuTimeout)
+        || !reader.ReadUint8(transport)
+        || !reader.ReadUint8(priority)
+        || !reader.ReadString(request.affinityKey)
+        || !reader.ReadString(request.traceId)
+        || !reader.ReadString(request.workerClass)
+        || !reader.ReadString(request.tenant)
+        || !reader.ReadUint8(cancellable)) {
+        return false;
+    }
+    if (transport > static_cast<uint8_t>(TransportOption::BINARY) || priority > static_cast<uint8_t>(CallPriority::BACKGROUND)) {
+        return false;
+    }
+
+    request.transport = static_cast<TransportOption>(transport);
+    request.priority = static_cast<CallPriority>(priority);
+    request.cancellable = cancellable != 0;
+    return true;
+}
+
+void remote::WriteResult(std::string& buffer, uint64_t id, const Result& result, float pressure) {
+    FrameWriter writer(buffer);
+    writer.Begin(FrameType::RESULT, id);
+    writer.WriteUint32(static_cast<uint32_t>(result.code));
+    writer.WriteString(result.errorMessage.data(), result.errorMessage.size());
+    writer.WriteString(result.returnValue.data(), result.returnValue.size());
+    writer.WriteUint64(result.cpuTime);
+    writer.WriteUint64(result.allocatedBytes);
+    writer.WriteFloat(pressure);
+    writer.End();
+}
+
+bool remote::ReadResult(FrameReader& reader, Result& result, float& pressure) {
+    uint32_t code;
+    if (!reader.ReadUint32(code)
+        || !reader.ReadString(result.errorMessage)
+        || !reader.ReadString(result.returnValue)
+        || !reader.ReadUint64(result.cpuTime)
+        || !reader.ReadUint64(result.allocatedBytes)
+        || !reader.ReadFloat(pressure)) {
+        return false;
+    }
+    result.code = static_cast<ResultCode>(code);
+    return true;
+}
+
+bool remote::ParseAddress(const std::string& address, std::string& host, uint16_t& port) {
+    auto separator = address.rfind(':');
+    if (separator == std::string::npos || separator + 1 == address.size()) {
+        return false;
+    }
+
+    host = address.substr(0, separator);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    uint32_t value = 0;
+    for (auto i = separator + 1; i < address.size(); i++) {
+        auto c = address[i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+        if (value > UINT16_MAX) {
+            return false;
+        }
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
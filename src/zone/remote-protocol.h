@@ -0,0 +1,159 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/types.h>
+#include <platform/socket.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+namespace remote {
+
+    /// <summary> Version of the protocol, which the host announces and clients check. </summary>
+    constexpr uint32_t PROTOCOL_VERSION = 3;
+
+    /// <summary> Size of a frame header: payload size (4 bytes), frame type (1 byte) and request id (8 bytes). </summary>
+    constexpr size_t HEADER_SIZE = 13;
+
+    /// <summary> Largest frame payload a peer accepts, larger ones break the connection. </summary>
+    constexpr uint32_t MAX_PAYLOAD_SIZE = 1u << 30;
+
+    /// <summary> Payloads of at least this many bytes are sent compressed, unless they don't shrink. </summary>
+    constexpr size_t COMPRESS_ABOVE = 4096;
+
+    /// <summary> Bit of the frame type byte set when the payload is compressed. </summary>
+    constexpr uint8_t COMPRESSED_FLAG = 0x80;
+
+    /// <summary> Type of a frame. Clients send requests, the host sends the hello and responses. </summary>
+    enum class FrameType : uint8_t {
+        /// <summary> Host: id, workers and pressure of the served zone, sent once a client connects. </summary>
+        HELLO = 1,
+
+        /// <summary> Client: a call to execute. </summary>
+        EXECUTE = 2,
+
+        /// <summary> Client: a source to broadcast. </summary>
+        BROADCAST = 3,
+
+        /// <summary> Client: cancels the call of the request id, which must have been sent with a cancellation token. </summary>
+        CANCEL = 4,
+
+        /// <summary> Host: the result of the call of the request id. </summary>
+        RESULT = 5,
+
+        /// <summary> Host: the result code of the broadcast of the request id. </summary>
+        BROADCAST_RESULT = 6,
+    };
+
+    /// <summary> A frame header. All integers on the wire are little-endian. </summary>
+    struct FrameHeader {
+        uint32_t size;
+        FrameType type;
+        uint64_t id;
+
+        /// <summary> Whether the payload is compressed with utils::compression, which ReceiveFrame undoes. </summary>
+        bool compressed;
+    };
+
+    /// <summary> Appends frames to a buffer, which may hold several frames to send at once. </summary>
+    class FrameWriter {
+    public:
+        /// <summary> Constructor. </summary>
+        /// <param name="buffer"> The buffer frames are appended to. </param>
+        explicit FrameWriter(std::string& buffer);
+
+        /// <summary> Starts a frame, its size is filled in by End(). </summary>
+        void Begin(FrameType type, uint64_t id);
+
+        /// <summary> Ends the frame started last, compressing its payload if it reaches COMPRESS_ABOVE bytes. </summary>
+        void End();
+
+        void WriteUint8(uint8_t value);
+        void WriteUint32(uint32_t value);
+        void WriteUint64(uint64_t value);
+        void WriteFloat(float value);
+
+        /// <summary> Writes a string, prefixed with its size. </summary>
+        void WriteString(const char* data, size_t size);
+
+    private:
+        std::string& _buffer;
+        size_t _frameStart;
+    };
+
+    /// <summary> Reads the fields of a frame payload. Reads past the end fail and leave the value untouched. </summary>
+    class FrameReader {
+    public:
+        FrameReader(const char* data, size_t size);
+
+        bool ReadUint8(uint8_t& value);
+        bool ReadUint32(uint32_t& value);
+        bool ReadUint64(uint64_t& value);
+        bool ReadFloat(float& value);
+        bool ReadString(std::string& value);
+
+    private:
+        const char* _data;
+        size_t _size;
+        size_t _position;
+    };
+
+    /// <summary> Decodes a frame header. </summary>
+    /// <returns> False if the header is malformed, or its payload is too large. </returns>
+    bool ReadHeader(const char* data, FrameHeader& header);
+
+    /// <summary> Receives a frame, decompressing its payload if it was sent compressed. </summary>
+    /// <returns> False if the connection is closed or broken, or the frame is malformed. </returns>
+    bool ReceiveFrame(platform::Socket& socket, FrameHeader& header, std::string& payload);
+
+    /// <summary> A call received by the host, owning the strings its function spec refers to. </summary>
+    struct ExecuteRequest {
+        std::string module;
+        std::string function;
+        std::vector<std::string> arguments;
+        std::string affinityKey;
+        std::string traceId;
+        std::string workerClass;
+        std::string tenant;
+        uint32_t timeout = 0;
+        uint32_t cpuTimeout = 0;
+        TransportOption transport = TransportOption::AUTO;
+        CallPriority priority = CallPriority::NORMAL;
+
+        /// <summary> Whether the client may cancel the call. </summary>
+        bool cancellable = false;
+
+        /// <summary> Creates the spec of the call, which refers to the request. </summary>
+        FunctionSpec ToSpec() const;
+    };
+
+    /// <summary> Appends a hello frame. </summary>
+    void WriteHello(std::string& buffer, const std::string& zoneId, uint32_t workers, float pressure);
+
+    /// <summary> Reads a hello frame payload. </summary>
+    /// <returns> False if it's malformed, or of another protocol version. </returns>
+    bool ReadHello(FrameReader& reader, std::string& zoneId, uint32_t& workers, float& pressure);
+
+    /// <summary> Appends an execute frame. Transport context and cancellation token of the spec are not sent. </summary>
+    void WriteExecute(std::string& buffer, uint64_t id, const FunctionSpec& spec);
+
+    /// <summary> Reads an execute frame payload. </summary>
+    bool ReadExecute(FrameReader& reader, ExecuteRequest& request);
+
+    /// <summary> Appends a result frame, with the pressure of the zone as the call ended. </summary>
+    void WriteResult(std::string& buffer, uint64_t id, const Result& result, float pressure);
+
+    /// <summary> Reads a result frame payload. </summary>
+    bool ReadResult(FrameReader& reader, Result& result, float& pressure);
+
+    /// <summary> Parses a "host:port" address. The host may be a bracketed IPv6 address, e.g. "[::1]:7000". </summary>
+    bool ParseAddress(const std::string& address, std::string& host, uint16_t& port);
+}
+}
+}
@@ -0,0 +1,222 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "remote-zone-host.h"
+
+#include "cancellation-token.h"
+#include "remote-protocol.h"
+
+#include <utils/debug.h>
+
+#include <napa/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+using namespace napa;
+using namespace napa::zone;
+using namespace napa::zone::remote;
+
+struct RemoteZoneHost::Connection {
+    explicit Connection(std::unique_ptr<platform::Socket> socket) : socket(std::move(socket)), done(false) {}
+
+    /// <summary> Sends frames, a client that went away drops them. </summary>
+    void Send(const std::string& buffer) {
+        std::lock_guard<std::mutex> lock(sendLock);
+        if (!socket->Send(buffer.data(), buffer.size())) {
+            socket->Shutdown();
+        }
+    }
+
+    /// <summary> Takes the token of a call out, as it finished or to cancel it. </summary>
+    std::shared_ptr<CancellationToken> TakeToken(uint64_t id) {
+        std::lock_guard<std::mutex> lock(tokensLock);
+        auto it = tokens.find(id);
+        if (it == tokens.end()) {
+            return nullptr;
+        }
+        auto token = std::move(it->second);
+        tokens.erase(it);
+        return token;
+    }
+
+    std::unique_ptr<platform::Socket> socket;
+    std::mutex sendLock;
+
+    /// <summary> Tokens of the running calls the client may cancel, by request id. </summary>
+    std::mutex tokensLock;
+    std::unordered_map<uint64_t, std::shared_ptr<CancellationToken>> tokens;
+
+    std::thread thread;
+    std::atomic<bool> done;
+};
+
+std::unique_ptr<RemoteZoneHost> RemoteZoneHost::Start(std::shared_ptr<Zone> zone, const std::string& address) {
+    NAPA_ASSERT(zone != nullptr, "zone is null");
+
+    std::string host;
+    uint16_t port;
+    if (!ParseAddress(address, host, port)) {
+        LOG_ERROR("RemoteZone", "Invalid address \"%s\" to serve zone \"%s\" on, expected \"host:port\".", address.c_str(), zone->GetId().c_str());
+        return nullptr;
+    }
+
+    uint16_t boundPort;
+    auto listener = platform::Socket::Listen(host, port, boundPort);
+    if (listener == nullptr) {
+        LOG_ERROR("RemoteZone", "Failed to listen on \"%s\" to serve zone \"%s\".", address.c_str(), zone->GetId().c_str());
+        return nullptr;
+    }
+
+    LOG_INFO("RemoteZone", "Serving zone \"%s\" on port %u.", zone->GetId().c_str(), static_cast<uint32_t>(boundPort));
+    return std::unique_ptr<RemoteZoneHost>(new RemoteZoneHost(std::move(zone), std::move(listener), boundPort));
+}
+
+RemoteZoneHost::RemoteZoneHost(std::shared_ptr<Zone> zone, std::unique_ptr<platform::Socket> listener, uint16_t port) :
+    _zone(std::move(zone)),
+    _listener(std::move(listener)),
+    _port(port),
+    _pendingRequests(0) {
+    _acceptor = std::thread(&RemoteZoneHost::Accept, this);
+}
+
+RemoteZoneHost::~RemoteZoneHost() {
+    _listener->Shutdown();
+    _acceptor.join();
+
+    // The acceptor is gone, no connection is added anymore.
+    for (auto& connection : _connections) {
+        connection->socket->Shutdown();
+        connection->thread.join();
+    }
+
+    // Callbacks of calls still running use the zone, which the host may hold the last reference of.
+    std::unique_lock<std::mutex> lock(_lock);
+    _requestsDone.wait(lock, [this]() { return _pendingRequests == 0; });
+    LOG_INFO("RemoteZone", "Stopped serving zone \"%s\".", _zone->GetId().c_str());
+}
+
+const std::shared_ptr<Zone>& RemoteZoneHost::GetZone() const {
+    return _zone;
+}
+
+uint16_t RemoteZoneHost::GetPort() const {
+    return _port;
+}
+
+void RemoteZoneHost::Accept() {
+    while (auto socket = _listener->Accept()) {
+        auto connection = std::make_shared<Connection>(std::move(socket));
+
+        std::lock_guard<std::mutex> lock(_lock);
+
+        // Connections of clients that went away are reaped as new ones come.
+        auto finished = std::partition(_connections.begin(), _connections.end(), [](const std::shared_ptr<Connection>& existing) {
+            return !existing->done;
+        });
+        for (auto it = finished; it != _connections.end(); ++it) {
+            (*it)->thread.join();
+        }
+        _connections.erase(finished, _connections.end());
+
+        connection->thread = std::thread(&RemoteZoneHost::Serve, this, connection);
+        _connections.emplace_back(std::move(connection));
+    }
+}
+
+void RemoteZoneHost::EndRequest() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (--_pendingRequests == 0) {
+        _requestsDone.notify_all();
+    }
+}
+
+void RemoteZoneHost::Serve(std::shared_ptr<Connection> connection) {
+    auto zone = _zone.get();
+    std::string hello;
+    WriteHello(hello, zone->GetId(), zone->GetWorkers(), zone->GetPressure());
+    connection->Send(hello);
+
+    FrameHeader header;
+    std::string payload;
+    while (ReceiveFrame(*connection->socket, header, payload)) {
+        FrameReader reader(payload.data(), payload.size());
+        auto id = header.id;
+
+        if (header.type == FrameType::EXECUTE) {
+            auto request = std::make_shared<ExecuteRequest>();
+            if (!ReadExecute(reader, *request)) {
+                break;
+            }
+
+            // Arguments are used in place by the call, which keeps the request.
+            auto spec = request->ToSpec();
+            spec.argumentsOwner = request;
+
+            std::shared_ptr<CancellationToken> token;
+            if (request->cancellable) {
+                token = std::make_shared<CancellationToken>();
+                spec.options.cancellation_token = token.get();
+
+                std::lock_guard<std::mutex> lock(connection->tokensLock);
+                connection->tokens.emplace(id, token);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _pendingRequests++;
+            }
+            zone->Execute(spec, [this, zone, connection, id, cancellable = request->cancellable](Result result) {
+                if (cancellable) {
+                    connection->TakeToken(id);
+                }
+
+                std::string frame;
+                WriteResult(frame, id, result, zone->GetPressure());
+                connection->Send(frame);
+                EndRequest();
+            });
+        } else if (header.type == FrameType::BROADCAST) {
+            std::string source;
+            if (!reader.ReadString(source)) {
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _pendingRequests++;
+            }
+            zone->Broadcast(source, [this, connection, id](ResultCode code) {
+                std::string frame;
+                FrameWriter writer(frame);
+                writer.Begin(FrameType::BROADCAST_RESULT, id);
+                writer.WriteUint32(static_cast<uint32_t>(code));
+                writer.End();
+                connection->Send(frame);
+                EndRequest();
+            });
+        } else if (header.type == FrameType::CANCEL) {
+            auto token = connection->TakeToken(id);
+            if (token != nullptr) {
+                token->Cancel();
+            }
+        } else {
+            LOG_WARNING("RemoteZone", "Unexpected frame from client of zone \"%s\", closing the connection.", zone->GetId().c_str());
+            break;
+        }
+    }
+
+    connection->socket->Shutdown();
+
+    // Results of the running calls have nowhere to go, the ones that can be are cancelled.
+    std::unordered_map<uint64_t, std::shared_ptr<CancellationToken>> tokens;
+    {
+        std::lock_guard<std::mutex> lock(connection->tokensLock);
+        tokens.swap(connection->tokens);
+    }
+    for (auto& token : tokens) {
+        token.second->Cancel();
+    }
+    connection->done = true;
+}
@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "zone.h"
+
+#include <platform/socket.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Serves a zone to other processes, which call it through a RemoteZone. </summary>
+    /// <remarks>
+    ///     Each client connection is read by a thread of its own, which hands calls to the zone as they arrive, so calls of
+    ///     a client run concurrently. Results are sent back by the workers that ran the calls, in the order calls finish.
+    ///     There is no authentication: clients run any function of the modules the host resolves, and broadcast any code,
+    ///     so zones should only be served on trusted networks.
+    /// </remarks>
+    class RemoteZoneHost {
+    public:
+        /// <summary> Starts serving a zone. </summary>
+        /// <param name="zone"> The zone to serve, which the host keeps until it stops. </param>
+        /// <param name="address"> The "host:port" address to listen on, port 0 for any free port. </param>
+        /// <returns> The host, or nullptr if the address can't be listened on. </returns>
+        static std::unique_ptr<RemoteZoneHost> Start(std::shared_ptr<Zone> zone, const std::string& address);
+
+        /// <summary> Stops serving, closing the connections, and waits for the calls still running, whose results are dropped. </summary>
+        /// <remarks> Calls of a client are cancelled as its connection is closed, the ones without cancellation points run to the end. </remarks>
+        ~RemoteZoneHost();
+
+        /// <summary> Non-copyable. </summary>
+        RemoteZoneHost(const RemoteZoneHost&) = delete;
+        RemoteZoneHost& operator=(const RemoteZoneHost&) = delete;
+
+        /// <summary> Gets the served zone. </summary>
+        const std::shared_ptr<Zone>& GetZone() const;
+
+        /// <summary> Gets the port the host listens on. </summary>
+        uint16_t GetPort() const;
+
+    private:
+        /// <summary> A client connection, shared with the callbacks of its calls. </summary>
+        struct Connection;
+
+        RemoteZoneHost(std::shared_ptr<Zone> zone, std::unique_ptr<platform::Socket> listener, uint16_t port);
+
+        /// <summary> Accepts clients until the host stops. </summary>
+        void Accept();
+
+        /// <summary> Serves the requests of a client until it disconnects or the host stops. </summary>
+        void Serve(std::shared_ptr<Connection> connection);
+
+        /// <summary> Counts a call or broadcast out, which no longer uses the zone. </summary>
+        void EndRequest();
+
+        std::shared_ptr<Zone> _zone;
+        std::unique_ptr<platform::Socket> _listener;
+        uint16_t _port;
+
+        /// <summary> Guards the connections and the pending requests. </summary>
+        std::mutex _lock;
+        std::vector<std::shared_ptr<Connection>> _connections;
+
+        /// <summary> Calls and broadcasts handed to the zone and not finished, which the host waits for as it stops. </summary>
+        size_t _pendingRequests;
+        std::condition_variable _requestsDone;
+
+        std::thread _acceptor;
+    };
+}
+}
@@ -0,0 +1,380 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "remote-zone.h"
+
+#include "batch-callback.h"
+#include "cancellation-token.h"
+#include "remote-protocol.h"
+
+#include <platform/socket.h>
+#include <utils/debug.h>
+
+#include <napa/log.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+using namespace napa;
+using namespace napa::zone;
+using namespace napa::zone::remote;
+
+namespace {
+
+    /// <summary> A call waiting for its result. </summary>
+    struct PendingCall {
+        ExecuteCallback callback;
+
+        /// <summary> The token of the call, if any, and its handler which sends the cancellation to the host. </summary>
+        std::shared_ptr<CancellationToken> token;
+        CancellationToken::HandlerId handlerId = 0;
+    };
+
+    Result MakeErrorResult(ResultCode code, std::string message) {
+        Result result;
+        result.code = code;
+        result.errorMessage = std::move(message);
+        return result;
+    }
+}
+
+struct RemoteZone::Connection {
+    explicit Connection(std::unique_ptr<platform::Socket> socket, float pressure) :
+        socket(std::move(socket)), pressure(pressure), nextId(1), connected(true) {}
+
+    /// <summary> Sends frames, and shuts the connection down if it's broken, which fails the pending calls. </summary>
+    void Send(const std::string& buffer) {
+        std::lock_guard<std::mutex> lock(sendLock);
+        if (!socket->Send(buffer.data(), buffer.size())) {
+            socket->Shutdown();
+        }
+    }
+
+    /// <summary> Completes a pending call, if it's still pending. </summary>
+    void Complete(uint64_t id, Result result) {
+        PendingCall call;
+        {
+            std::lock_guard<std::mutex> lock(pendingLock);
+            auto it = pendingCalls.find(id);
+            if (it == pendingCalls.end()) {
+                return;
+            }
+            call = std::move(it->second);
+            pendingCalls.erase(it);
+        }
+
+        if (call.token != nullptr && call.handlerId != 0) {
+            call.token->Unregister(call.handlerId);
+        }
+        call.callback(std::move(result));
+    }
+
+    /// <summary> Receives results until the connection is closed, then fails the calls that are still pending. </summary>
+    static void Receive(std::shared_ptr<Connection> connection) {
+        FrameHeader header;
+        std::string payload;
+        while (ReceiveFrame(*connection->socket, header, payload)) {
+            FrameReader reader(payload.data(), payload.size());
+            if (header.type == FrameType::RESULT) {
+                Result result;
+                float pressure;
+                if (!ReadResult(reader, result, pressure)) {
+                    break;
+                }
+                connection->pressure = pressure;
+                connection->Complete(header.id, std::move(result));
+            } else if (header.type == FrameType::BROADCAST_RESULT) {
+                uint32_t code;
+                if (!reader.ReadUint32(code)) {
+                    break;
+                }
+
+                BroadcastCallback callback;
+                {
+                    std::lock_guard<std::mutex> lock(connection->pendingLock);
+                    auto it = connection->pendingBroadcasts.find(header.id);
+                    if (it != connection->pendingBroadcasts.end()) {
+                        callback = std::move(it->second);
+                        connection->pendingBroadcasts.erase(it);
+                    }
+                }
+                if (callback) {
+                    callback(static_cast<ResultCode>(code));
+                }
+            } else {
+                break;
+            }
+        }
+
+        LOG_INFO("RemoteZone", "Connection to the remote zone is closed.");
+        connection->socket->Shutdown();
+
+        std::unordered_map<uint64_t, PendingCall> calls;
+        std::unordered_map<uint64_t, BroadcastCallback> broadcasts;
+        {
+            std::lock_guard<std::mutex> lock(connection->pendingLock);
+            connection->connected = false;
+            calls.swap(connection->pendingCalls);
+            broadcasts.swap(connection->pendingBroadcasts);
+        }
+
+        for (auto& entry : calls) {
+            auto& call = entry.second;
+            if (call.token != nullptr && call.handlerId != 0) {
+                call.token->Unregister(call.handlerId);
+            }
+            call.callback(MakeErrorResult(NAPA_RESULT_ZONE_DISCONNECTED, "The connection to the remote zone was lost."));
+        }
+        for (auto& entry : broadcasts) {
+            entry.second(NAPA_RESULT_ZONE_DISCONNECTED);
+        }
+    }
+
+    std::unique_ptr<platform::Socket> socket;
+    std::atomic<float> pressure;
+
+    /// <summary> Serializes writes, so frames of concurrent calls don't interleave. </summary>
+    std::mutex sendLock;
+
+    /// <summary> Guards the pending calls and broadcasts, the next request id and the connection state. </summary>
+    std::mutex pendingLock;
+    std::unordered_map<uint64_t, PendingCall> pendingCalls;
+    std::unordered_map<uint64_t, BroadcastCallback> pendingBroadcasts;
+    uint64_t nextId;
+    bool connected;
+};
+
+std::shared_ptr<RemoteZone> RemoteZone::Connect(const std::string& address) {
+    std::string host;
+    uint16_t port;
+    if (!ParseAddress(address, host, port)) {
+        LOG_ERROR("RemoteZone", "Invalid remote zone address \"%s\", expected \"host:port\".", address.c_str());
+        return nullptr;
+    }
+
+    auto socket = platform::Socket::Connect(host, port);
+    if (socket == nullptr) {
+        LOG_ERROR("RemoteZone", "Failed to connect to remote zone at \"%s\".", address.c_str());
+        return nullptr;
+    }
+
+    // The host announces the zone it serves first.
+    FrameHeader header;
+    std::string payload;
+    std::string id;
+    uint32_t workers;
+    float pressure;
+    if (!ReceiveFrame(*socket, header, payload) || header.type != FrameType::HELLO) {
+        LOG_ERROR("RemoteZone", "\"%s\" doesn't serve a zone.", address.c_str());
+        return nullptr;
+    }
+    FrameReader reader(payload.data(), payload.size());
+    if (!ReadHello(reader, id, workers, pressure)) {
+        LOG_ERROR("RemoteZone", "The zone served at \"%s\" uses another protocol version.", address.c_str());
+        return nullptr;
+    }
+
+    auto connection = std::make_shared<Connection>(std::move(socket), pressure);
+    LOG_INFO("RemoteZone", "Connected to remote zone \"%s\" at \"%s\".", id.c_str(), address.c_str());
+    return std::shared_ptr<RemoteZone>(new RemoteZone(std::move(connection), std::move(id), workers));
+}
+
+RemoteZone::RemoteZone(std::shared_ptr<Connection> connection, std::string id, uint32_t workers) :
+    _connection(std::move(connection)),
+    _id(std::move(id)),
+    _workers(workers) {
+    _receiver = std::thread(&Connection::Receive, _connection);
+}
+
+RemoteZone::~RemoteZone() {
+    _connection->socket->Shutdown();
+
+    // A callback releasing the zone runs on the receiver, which keeps the connection until it's done.
+    if (_receiver.get_id() == std::this_thread::get_id()) {
+        _receiver.detach();
+    } else {
+        _receiver.join();
+    }
+}
+
+const std::string& RemoteZone::GetId() const {
+    return _id;
+}
+
+void RemoteZone::Broadcast(const std::string& source, BroadcastCallback callback) {
+    std::string buffer;
+    {
+        std::lock_guard<std::mutex> lock(_connection->pendingLock);
+        if (_connection->connected) {
+            auto id = _connection->nextId++;
+            _connection->pendingBroadcasts.emplace(id, std::move(callback));
+
+            FrameWriter writer(buffer);
+            writer.Begin(FrameType::BROADCAST, id);
+            writer.WriteString(source.data(), source.size());
+            writer.End();
+        }
+    }
+
+    if (buffer.empty()) {
+        callback(NAPA_RESULT_ZONE_DISCONNECTED);
+        return;
+    }
+    _connection->Send(buffer);
+}
+
+void RemoteZone::Execute(const FunctionSpec& spec, ExecuteCallback callback) {
+    SendCalls(&spec, &callback, 1);
+}
+
+void RemoteZone::ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) {
+    auto callbacks = CreateBatchCallbacks(specs.size(), std::move(callback));
+    SendCalls(specs.data(), callbacks.data(), specs.size());
+}
+
+void RemoteZone::ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) {
+    NAPA_ASSERT(specs.size() == callbacks.size(), "specs and callbacks must have the same size");
+    SendCalls(specs.data(), callbacks.data(), specs.size());
+}
+
+void RemoteZone::SendCalls(const FunctionSpec* specs, ExecuteCallback* callbacks, size_t count) {
+    std::string buffer;
+    std::vector<std::pair<ExecuteCallback, Result>> failed;
+    std::vector<std::pair<uint64_t, std::shared_ptr<CancellationToken>>> cancellable;
+    {
+        std::lock_guard<std::mutex> lock(_connection->pendingLock);
+        for (size_t i = 0; i < count; i++) {
+            const auto& spec = specs[i];
+            if (!_connection->connected) {
+                failed.emplace_back(std::move(callbacks[i]),
+                    MakeErrorResult(NAPA_RESULT_ZONE_DISCONNECTED, "The connection to the remote zone was lost."));
+                continue;
+            }
+            if (spec.transportContext != nullptr && spec.transportContext->GetSharedCount() > 0) {
+                failed.emplace_back(std::move(callbacks[i]),
+                    MakeErrorResult(NAPA_RESULT_EXECUTE_FUNC_ERROR, "Objects shared by transport context can't be passed to a remote zone."));
+                continue;
+            }
+
+            std::shared_ptr<CancellationToken> token;
+            if (spec.options.cancellation_token != nullptr) {
+                token = static_cast<CancellationToken*>(spec.options.cancellation_token)->shared_from_this();
+                if (token->IsCancelled()) {
+                    failed.emplace_back(std::move(callbacks[i]),
+                        MakeErrorResult(NAPA_RESULT_CANCELLED, "The call was cancelled by the caller."));
+                    continue;
+                }
+            }
+
+            auto id = _connection->nextId++;
+            WriteExecute(buffer, id, spec);
+
+            PendingCall call;
+            call.callback = std::move(callbacks[i]);
+            call.token = token;
+            _connection->pendingCalls.emplace(id, std::move(call));
+            if (token != nullptr) {
+                cancellable.emplace_back(id, std::move(token));
+            }
+        }
+    }
+
+    // Frames of all calls go with a single write.
+    if (!buffer.empty()) {
+        _connection->Send(buffer);
+    }
+
+    // Cancellations are sent after their calls, the host ignores cancellations of calls that already finished.
+    std::weak_ptr<Connection> weakConnection = _connection;
+    for (auto& entry : cancellable) {
+        auto id = entry.first;
+        auto handlerId = entry.second->Register([weakConnection, id]() {
+            auto connection = weakConnection.lock();
+            if (connection == nullptr) {
+                return;
+            }
+
+            std::string frame;
+            FrameWriter writer(frame);
+            writer.Begin(FrameType::CANCEL, id);
+            writer.End();
+            connection->Send(frame);
+        });
+
+        // The call may have finished meanwhile, then it no longer needs the handler.
+        bool pending;
+        {
+            std::lock_guard<std::mutex> lock(_connection->pendingLock);
+            auto it = _connection->pendingCalls.find(id);
+            pending = it != _connection->pendingCalls.end();
+            if (pending) {
+                it->second.handlerId = handlerId;
+            }
+        }
+        if (!pending && handlerId != 0) {
+            entry.second->Unregister(handlerId);
+        }
+    }
+
+    for (auto& entry : failed) {
+        entry.first(std::move(entry.second));
+    }
+}
+
+float RemoteZone::GetPressure() const {
+    return _connection->pressure;
+}
+
+uint32_t RemoteZone::GetWorkers() const {
+    return _workers;
+}
+
+void RemoteZone::Resize(uint32_t, ResizeCallback callback) {
+    LOG_ERROR("RemoteZone", "Remote zone \"%s\" can only be resized by its host.", _id.c_str());
+    callback(NAPA_RESULT_ZONE_RESIZE_ERROR);
+}
+
+void RemoteZone::Drain(uint32_t, DrainCallback callback) {
+    LOG_ERROR("RemoteZone", "Remote zone \"%s\" can only be drained by its host.", _id.c_str());
+    callback(NAPA_RESULT_ZONE_DRAIN_ERROR, 0);
+}
+
+void RemoteZone::GetMemoryUsage(MemoryUsageCallback callback) {
+    callback(std::vector<WorkerMemoryUsage>());
+}
+
+void RemoteZone::StartProfiling(uint32_t, ProfilingCallback callback) {
+    LOG_ERROR("RemoteZone", "Remote zone \"%s\" can only be profiled by its host.", _id.c_str());
+    callback(NAPA_RESULT_PROFILING_ERROR);
+}
+
+void RemoteZone::StopProfiling(CpuProfileCallback callback) {
+    callback(std::vector<std::string>());
+}
+
+void RemoteZone::StartAllocationProfiling(uint32_t, ProfilingCallback callback) {
+    LOG_ERROR("RemoteZone", "Remote zone \"%s\" can only be profiled by its host.", _id.c_str());
+    callback(NAPA_RESULT_PROFILING_ERROR);
+}
+
+void RemoteZone::StopAllocationProfiling(AllocationProfileCallback callback) {
+    callback(std::string());
+}
+
+void RemoteZone::GetHeapStatistics(HeapStatisticsCallback callback) {
+    callback(std::vector<WorkerHeapStatistics>());
+}
+
+void RemoteZone::WriteHeapSnapshot(uint32_t, const std::string&, HeapSnapshotCallback callback) {
+    LOG_ERROR("RemoteZone", "Remote zone \"%s\" can only be snapshot by its host.", _id.c_str());
+    callback(NAPA_RESULT_HEAP_SNAPSHOT_ERROR);
+}
+
+std::vector<napa::SlowCall> RemoteZone::GetSlowCalls() const {
+    return std::vector<SlowCall>();
+}
+
+std::vector<napa::FunctionStats> RemoteZone::GetFunctionStats() const {
+    return std::vector<FunctionStats>();
+}
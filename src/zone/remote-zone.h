@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "zone.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> A zone served by another process, on this host or another, see RemoteZoneHost. </summary>
+    /// <remarks>
+    ///     Calls are sent over one connection as soon as they're made, without waiting for the results of earlier ones,
+    ///     and results are received in the order calls finish. A batch is sent with a single write.
+    ///     Arguments and return values are the payloads the local zones exchange, so the host runs calls of AUTO and BINARY
+    ///     transport the same, but objects shared by the transport context can't leave the process and fail the call.
+    ///     Functions are loaded by module on the host, which must resolve the same module paths.
+    ///     Once the connection is lost, pending and later calls fail with NAPA_RESULT_ZONE_DISCONNECTED.
+    ///     Callbacks are called by the thread receiving results.
+    /// </remarks>
+    class RemoteZone : public Zone {
+    public:
+        /// <summary> Connects to a served zone. </summary>
+        /// <param name="address"> The "host:port" address the zone is served on. </param>
+        /// <returns> The remote zone, or nullptr if the host can't be reached or doesn't serve a zone. </returns>
+        static std::shared_ptr<RemoteZone> Connect(const std::string& address);
+
+        /// <summary> Closes the connection, failing calls that are still pending. </summary>
+        ~RemoteZone();
+
+        /// <see cref="Zone::GetId" />
+        /// <remarks> The id of the zone on its host. </remarks>
+        virtual const std::string& GetId() const override;
+
+        /// <see cref="Zone::Broadcast" />
+        virtual void Broadcast(const std::string& source, BroadcastCallback callback) override;
+
+        /// <see cref="Zone::Execute" />
+        virtual void Execute(const FunctionSpec& spec, ExecuteCallback callback) override;
+
+        /// <see cref="Zone::ExecuteBatch" />
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) override;
+
+        /// <see cref="Zone::ExecuteBatch" />
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) override;
+
+        /// <see cref="Zone::GetPressure" />
+        /// <remarks> The pressure the host reported with the latest result. </remarks>
+        virtual float GetPressure() const override;
+
+        /// <see cref="Zone::GetWorkers" />
+        /// <remarks> The number of workers the host reported as the connection was made. </remarks>
+        virtual uint32_t GetWorkers() const override;
+
+        /// <see cref="Zone::Resize" />
+        /// <remarks> Remote zones are resized by their host, resizing fails. </remarks>
+        virtual void Resize(uint32_t workers, ResizeCallback callback) override;
+
+        /// <see cref="Zone::Drain" />
+        /// <remarks> Remote zones are drained by their host, draining fails. </remarks>
+        virtual void Drain(uint32_t timeout, DrainCallback callback) override;
+
+        /// <see cref="Zone::GetMemoryUsage" />
+        /// <remarks> Memory of remote workers is inspected on their host, it reports no worker. </remarks>
+        virtual void GetMemoryUsage(MemoryUsageCallback callback) override;
+
+        /// <see cref="Zone::StartProfiling" />
+        /// <remarks> Remote workers are profiled on their host, starting fails. </remarks>
+        virtual void StartProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopProfiling" />
+        /// <remarks> Reports no profile. </remarks>
+        virtual void StopProfiling(CpuProfileCallback callback) override;
+
+        /// <see cref="Zone::StartAllocationProfiling" />
+        virtual void StartAllocationProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopAllocationProfiling" />
+        virtual void StopAllocationProfiling(AllocationProfileCallback callback) override;
+
+        /// <see cref="Zone::GetHeapStatistics" />
+        /// <remarks> Reports no worker. </remarks>
+        virtual void GetHeapStatistics(HeapStatisticsCallback callback) override;
+
+        /// <see cref="Zone::WriteHeapSnapshot" />
+        /// <remarks> Snapshots are written on the host, writing fails. </remarks>
+        virtual void WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) override;
+
+        /// <see cref="Zone::GetSlowCalls" />
+        /// <remarks> Slow calls are kept by the log of the host, there are none. </remarks>
+        virtual std::vector<SlowCall> GetSlowCalls() const override;
+
+        /// <see cref="Zone::GetFunctionStats" />
+        /// <remarks> Statistics are kept by the host of the zone, there are none. </remarks>
+        virtual std::vector<FunctionStats> GetFunctionStats() const override;
+
+    private:
+        /// <summary> The connection with the calls waiting for results, shared with the thread receiving them. </summary>
+        struct Connection;
+
+        RemoteZone(std::shared_ptr<Connection> connection, std::string id, uint32_t workers);
+
+        /// <summary> Sends calls, the ones that can't be sent fail right away. </summary>
+        void SendCalls(const FunctionSpec* specs, ExecuteCallback* callbacks, size_t count);
+
+        std::shared_ptr<Connection> _connection;
+        std::string _id;
+        uint32_t _workers;
+        std::thread _receiver;
+    };
+}
+}
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "result-cache.h"
+#include "clock.h"
+
+#include <utils/hash.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+using napa::utils::hash::XxHash64;
+
+namespace {
+
+    /// <summary> Seeds of the two halves of a key, which are independent hashes of the same call. </summary>
+    const uint64_t FIRST_SEED = 0;
+    const uint64_t SECOND_SEED = 0x9E3779B97F4A7C15ULL;
+
+    /// <summary> Chains the hash of a string into a hash, each hash covers the length, so strings don't run into each other. </summary>
+    uint64_t Chain(uint64_t hash, napa::StringRef value) {
+        return XxHash64(value.data, value.size, hash);
+    }
+}
+
+ResultCache::ResultCache(size_t maxBytes, std::chrono::milliseconds ttl) :
+    _shardBytes(maxBytes / SHARD_COUNT),
+    _ttl(ttl) {
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        _shards.emplace_back(std::make_unique<Shard>());
+    }
+}
+
+bool ResultCache::IsCacheable(const FunctionSpec& spec) {
+    return spec.transportContext == nullptr || spec.transportContext->GetSharedCount() == 0;
+}
+
+ResultCache::Key ResultCache::GetKey(const FunctionSpec& spec) {
+    uint8_t transport = static_cast<uint8_t>(spec.options.transport);
+
+    Key key;
+    key.first = XxHash64(&transport, sizeof(transport), FIRST_SEED);
+    key.second = XxHash64(&transport, sizeof(transport), SECOND_SEED);
+
+    key.first = Chain(Chain(key.first, spec.module), spec.function);
+    key.second = Chain(Chain(key.second, spec.module), spec.function);
+    for (const auto& argument : spec.arguments) {
+        key.first = Chain(key.first, argument);
+        key.second = Chain(key.second, argument);
+    }
+    return key;
+}
+
+bool ResultCache::Get(const Key& key, std::string& result) {
+    auto& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        return false;
+    }
+
+    auto entry = it->second;
+    if (_ttl.count() > 0 && entry->expiration <= Clock::CoarseNow()) {
+        Remove(shard, entry);
+        return false;
+    }
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+    result = entry->result;
+    return true;
+}
+
+void ResultCache::Put(const Key& key, const std::string& result) {
+    auto bytes = result.size() + ENTRY_OVERHEAD;
+    if (bytes > _shardBytes) {
+        return;
+    }
+
+    auto& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    // Concurrent misses of the same call put it more than once, the last one wins.
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        Remove(shard, it->second);
+    }
+
+    shard.entries.push_front({ key, result, Clock::CoarseNow() + _ttl });
+    shard.index.emplace(key, shard.entries.begin());
+    shard.bytes += bytes;
+
+    // Expired entries are evicted as if they were least recently used, they are reclaimed once at the back.
+    while (shard.bytes > _shardBytes) {
+        Remove(shard, std::prev(shard.entries.end()));
+    }
+}
+
+size_t ResultCache::GetCount() const {
+    size_t count = 0;
+    for (const auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->lock);
+        count += shard->entries.size();
+    }
+    return count;
+}
+
+size_t ResultCache::GetBytes() const {
+    size_t bytes = 0;
+    for (const auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->lock);
+        bytes += shard->bytes;
+    }
+    return bytes;
+}
+
+ResultCache::Shard& ResultCache::GetShard(const Key& key) {
+    // The second half picks the shard, the first one the bucket in the shard's index.
+    return *_shards[key.second % SHARD_COUNT];
+}
+
+void ResultCache::Remove(Shard& shard, std::list<Entry>::iterator entry) {
+    shard.bytes -= entry->result.size() + ENTRY_OVERHEAD;
+    shard.index.erase(entry->key);
+    shard.entries.erase(entry);
+}
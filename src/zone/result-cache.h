@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/types.h>
+#include <napa/transport/transport-context.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Results of calls by their function and marshalled arguments, so repeated calls of pure functions don't run again. </summary>
+    /// <remarks>
+    ///     A call is keyed by a 128-bit hash of its module, function, transport option and arguments, which is cheap
+    ///     next to running it, and makes a false hit as unlikely as a hardware fault. Keys are spread over shards,
+    ///     each with its own lock and least recently used list. Entries expire after the TTL, and the least recently
+    ///     used ones are evicted beyond the size bound, which is divided evenly among shards.
+    ///     The cache is shared with the callbacks of calls, which fill it and may outlive the zone.
+    /// </remarks>
+    class ResultCache {
+    public:
+
+        /// <summary> Key of a call. </summary>
+        struct Key {
+            uint64_t first;
+            uint64_t second;
+
+            bool operator==(const Key& other) const {
+                return first == other.first && second == other.second;
+            }
+        };
+
+        /// <summary> Hash of keys, which are hashes already. </summary>
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                return static_cast<size_t>(key.first);
+            }
+        };
+
+        /// <summary> Bytes an entry takes besides its result. </summary>
+        static const size_t ENTRY_OVERHEAD = 96;
+
+        /// <summary> Constructor. </summary>
+        /// <param name="maxBytes"> The maximum bytes of results, least recently used results are evicted beyond it. </param>
+        /// <param name="ttl"> Time to live of results, 0 for no expiry. </param>
+        ResultCache(size_t maxBytes, std::chrono::milliseconds ttl);
+
+        /// <summary> Non-copyable. </summary>
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        /// <summary> Whether a call can be cached, i.e. its arguments don't refer to shared objects. </summary>
+        static bool IsCacheable(const FunctionSpec& spec);
+
+        /// <summary> Gets the key of a call. </summary>
+        static Key GetKey(const FunctionSpec& spec);
+
+        /// <summary> Gets the result of a call, which counts as used. </summary>
+        /// <returns> False if the result isn't cached or expired. </returns>
+        bool Get(const Key& key, std::string& result);
+
+        /// <summary> Caches the result of a call, unless it alone exceeds the bound of its shard. </summary>
+        void Put(const Key& key, const std::string& result);
+
+        /// <summary> Gets the number of cached results, including expired ones not evicted yet. </summary>
+        size_t GetCount() const;
+
+        /// <summary> Gets the bytes of cached results, counting the overhead of entries. </summary>
+        size_t GetBytes() const;
+
+    private:
+        static const size_t SHARD_COUNT = 16;
+
+        struct Entry {
+            Key key;
+            std::string result;
+            std::chrono::steady_clock::time_point expiration;
+        };
+
+        /// <summary> Entries from the most to the least recently used, indexed by key. </summary>
+        struct Shard {
+            mutable std::mutex lock;
+            std::list<Entry> entries;
+            std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+            size_t bytes = 0;
+        };
+
+        Shard& GetShard(const Key& key);
+
+        /// <summary> Removes an entry of a shard, whose lock is held. </summary>
+        static void Remove(Shard& shard, std::list<Entry>::iterator entry);
+
+        size_t _shardBytes;
+        std::chrono::milliseconds _ttl;
+        std::vector<std::unique_ptr<Shard>> _shards;
+    };
+}
+}
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "clock.h"
+#include "scheduling-policy.h"
 #include "simple-thread-pool.h"
 #include "task.h"
 #include "worker.h"
@@ -11,18 +13,35 @@
 #include <utils/debug.h>
 
 #include <napa/log.h>
+#include <napa/types.h>
 
+#include <array>
 #include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
+#include <random>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace napa {
 namespace zone {
 
     /// <summary> The scheduler is responsible for assigning tasks to workers. </summary>
+    /// <remarks>
+    ///     It runs the workers, wakes them and tracks which of them are idle, while the order in which queued tasks
+    ///     run is decided by a SchedulingPolicy, picked by the scheduler type of zone settings.
+    /// </remarks>
     template <typename WorkerType>
     class SchedulerImpl {
     public:
@@ -30,14 +49,50 @@ namespace zone {
         /// <summary> Constructor. </summary>
         /// <param name="settings"> A settings object. </param>
         /// <param name="workerSetupCallback"> Callback to setup the isolate after worker created its isolate. </param>
-        SchedulerImpl(const settings::ZoneSettings& settings, std::function<void(WorkerId)> workerSetupCallback);
+        /// <param name="workerRecycleCallback"> Callback before a worker recreates its isolate, see Worker. Optional. </param>
+        /// <param name="queueDepthCallback"> Called with the queue depth of a priority whenever it changes. Optional. </param>
+        /// <param name="tenantQueueTimeCallback"> Called with the time a task of a tenant waited, as it starts. Optional. </param>
+        SchedulerImpl(const settings::ZoneSettings& settings,
+                      std::function<void(WorkerId)> workerSetupCallback,
+                      std::function<bool(WorkerId)> workerRecycleCallback = nullptr,
+                      std::function<void(CallPriority, size_t)> queueDepthCallback = nullptr,
+                      std::function<void(const std::string&, std::chrono::nanoseconds)> tenantQueueTimeCallback = nullptr);
 
         /// <summary> Destructor. Waits for all tasks to finish. </summary>
         ~SchedulerImpl();
 
+        /// <summary> Waits for all tasks to finish, then closes and destroys the workers. Done once, on destruction at the latest. </summary>
+        /// <remarks>
+        ///     Owners whose callbacks run on workers shut down the scheduler before they destroy what the callbacks use.
+        ///     Pinned workers aren't waited for, as pending timers pin them. Tasks scheduled afterwards are cancelled.
+        /// </remarks>
+        void Shutdown();
+
         /// <summary> Schedules the task on a single worker. </summary>
         /// <param name="task"> Task to schedule. </param>
-        void Schedule(std::shared_ptr<Task> task);
+        /// <param name="priority"> Task priority, queued tasks with higher priority are handed to workers first. </param>
+        /// <param name="tenant"> The tenant the task is issued for, see FindOrAddTenant(). 0 for none. </param>
+        /// <remarks>
+        /// With the synchronized scheduler, queued tasks of the same priority are handed to workers by weighted round robin
+        /// between tenants, and tasks of a tenant at its concurrency cap wait for one of its running tasks to finish.
+        /// With workerQueueDepth in zone settings, a task that finds no idle worker goes to the shorter queue of two
+        /// busy workers picked at random, unless both already have that many unfinished tasks.
+        /// </remarks>
+        void Schedule(std::shared_ptr<Task> task, CallPriority priority = CallPriority::NORMAL, size_t tenant = 0);
+
+        /// <summary> Schedules a batch of tasks, each on a single worker. </summary>
+        /// <param name="tasks"> Tasks to schedule. </param>
+        /// <param name="priority"> Priority of all tasks. </param>
+        /// <param name="tenant"> The tenant of all tasks, 0 for none. </param>
+        /// <remarks> Same as calling Schedule() for each task, but with one round trip to the synchronizer. </remarks>
+        void ScheduleBatch(std::vector<std::shared_ptr<Task>> tasks, CallPriority priority = CallPriority::NORMAL, size_t tenant = 0);
+
+        /// <summary> Finds a tenant by name, and adds it with a weight of 1 and no cap if it's not in zone settings. </summary>
+        /// <returns>
+        /// The tenant to schedule tasks for, numbered from 1 in the order of zone settings. 0 if the name is empty, if the
+        /// scheduler doesn't share workers by tenant, or if there are too many tenants already.
+        /// </returns>
+        size_t FindOrAddTenant(const char* name, size_t length);
 
         /// <summary> Schedules the task on a specific worker. </summary>
         /// <param name="workerId"> The id of the worker. </param>
@@ -48,6 +103,29 @@ namespace zone {
         /// </remarks>
         void ScheduleOnWorker(WorkerId workerId, std::shared_ptr<Task> task);
 
+        /// <summary> Schedules the task on a preferred worker, unless that worker already has too many queued tasks. </summary>
+        /// <param name="workerId"> The id of the preferred worker. </param>
+        /// <param name="task"> Task to schedule. </param>
+        /// <param name="priority"> Task priority, used when the task spills to other workers. </param>
+        /// <remarks>
+        /// The task goes through ScheduleOnWorker() if the preferred worker has fewer queued tasks than
+        /// affinitySpillThreshold in zone settings, otherwise it's scheduled by Schedule() on any worker.
+        /// </remarks>
+        void ScheduleOnPreferredWorker(WorkerId workerId, std::shared_ptr<Task> task, CallPriority priority = CallPriority::NORMAL);
+
+        /// <summary> Finds a worker class of the zone settings by name. </summary>
+        /// <returns> The index of the class in zone settings, or -1 if there is no class of that name. </returns>
+        int32_t FindWorkerClass(const char* name, size_t length) const;
+
+        /// <summary> Schedules the task on the worker of a worker class that has the fewest unfinished tasks. </summary>
+        /// <param name="workerClass"> The index of the worker class, see FindWorkerClass(). </param>
+        /// <param name="task"> Task to schedule. </param>
+        /// <remarks>
+        /// The task goes through ScheduleOnWorker(). Ties are broken round-robin, so a burst of tasks spreads over the class.
+        /// Workers of a class also take tasks scheduled by Schedule() when they are idle.
+        /// </remarks>
+        void ScheduleOnWorkerClass(size_t workerClass, std::shared_ptr<Task> task);
+
         /// <summary> Schedules the task on all workers. </summary>
         /// <param name="task"> Task to schedule. </param>
         /// <remarks>
@@ -56,16 +134,385 @@ namespace zone {
         /// </remarks>
         void ScheduleOnAllWorkers(std::shared_ptr<Task> task);
 
+        /// <summary> Schedules a task on all workers, creating it once the number of workers is known. </summary>
+        /// <param name="createTask"> Creates the task given the number of workers that will run it. </param>
+        /// <remarks>
+        /// It's serialized with adding workers in Resize(), so a task logged by createTask and replayed by
+        /// the warm-up of new workers runs exactly once on each worker.
+        /// </remarks>
+        void ScheduleOnAllWorkers(std::function<std::shared_ptr<Task>(uint32_t)> createTask);
+
+        /// <summary> Schedules a task on all workers, with at most a number of workers running it at a time. </summary>
+        /// <param name="createTask"> Creates the task given the number of workers that will run it. </param>
+        /// <param name="concurrency"> The maximum number of workers running the task at a time, 0 for all of them. </param>
+        /// <remarks>
+        /// The first workers get the task right away, and each worker that ran it passes it on to the next one,
+        /// so the other workers keep taking tasks from Schedule() meanwhile. Workers the task hasn't reached
+        /// yet are pinned, thus they run it even if they are removed by Resize() in between.
+        /// </remarks>
+        void ScheduleOnAllWorkers(std::function<std::shared_ptr<Task>(uint32_t)> createTask, uint32_t concurrency);
+
+        /// <summary> Requests all workers to run a callback on their isolates while they run JavaScript, see Worker::RequestInterrupt(). </summary>
+        /// <param name="callback"> Callback to run on each worker thread. </param>
+        /// <param name="data"> An opaque pointer that is passed to the callback, which must outlive all workers. </param>
+        void InterruptAllWorkers(InterruptCallback callback, void* data);
+
+        /// <summary> Grows or shrinks the number of workers asynchronously. </summary>
+        /// <param name="workers"> The new number of workers, between 1 and the worker capacity. </param>
+        /// <param name="warmUp"> Creates the tasks a new worker runs before any other task, e.g. a replay of broadcasts. </param>
+        /// <param name="callback"> Called from a background thread once new workers are started, or removed workers are shut down. </param>
+        /// <remarks>
+        /// Resizes are applied one at a time in call order. Removed workers stop receiving new tasks, and are shut down
+        /// once their queued tasks finished and no asynchronous work issued from them is pending, see PinWorker().
+        /// </remarks>
+        void Resize(uint32_t workers,
+                    std::function<std::vector<std::shared_ptr<Task>>(WorkerId)> warmUp,
+                    std::function<void()> callback);
+
+        /// <summary> Waits asynchronously for all tasks to finish, cancelling tasks still queued at a deadline. </summary>
+        /// <param name="deadline"> Time at which tasks waiting for a worker are cancelled, time_point::max() for none. </param>
+        /// <param name="callback">
+        ///     Called from a background thread with whether all tasks finished by the deadline, and the number of tasks
+        ///     cancelled, once no task is queued or running, or at the deadline.
+        /// </param>
+        /// <remarks>
+        /// It's applied on the thread of Resize(), in call order with resizes. Workers with pending asynchronous work
+        /// count as running, see PinWorker(). Tasks already handed to workers, and tasks of tenants at their cap,
+        /// are not cancelled. The wait is on an event that workers signal as they run out of tasks, rechecked every
+        /// DRAIN_CHECK_INTERVAL for the state that doesn't signal it.
+        /// </remarks>
+        void Drain(std::chrono::steady_clock::time_point deadline, std::function<void(bool, size_t)> callback);
+
+        /// <summary> Gets the number of workers. </summary>
+        uint32_t GetWorkerCount() const;
+
+        /// <summary> Gets the maximum number of workers, which is the higher of workers and maxWorkers in zone settings. </summary>
+        uint32_t GetWorkerCapacity() const;
+
+        /// <summary> Gets the number of workers waiting for a task. </summary>
+        uint32_t GetIdleWorkerCount() const;
+
+        /// <summary> Gets the number of workers of all worker classes, which are the first workers and aren't removed by Resize(). </summary>
+        uint32_t GetWorkerClassWorkers() const;
+
+        /// <summary> Keeps a worker from being shut down by Resize(), i.e. while a completion will be scheduled on it. </summary>
+        void PinWorker(WorkerId workerId);
+
+        /// <summary> Releases a pin taken by PinWorker(), once the pending task ran on the worker. </summary>
+        void UnpinWorker(WorkerId workerId);
+
+        /// <summary> Tells whether asynchronous work issued from a worker is pending. </summary>
+        bool IsWorkerPinned(WorkerId workerId) const;
+
+        /// <summary> Gets the number of tasks of a priority that are waiting for a worker. </summary>
+        /// <param name="priority"> The priority. </param>
+        size_t GetQueueDepth(CallPriority priority) const;
+
+        /// <summary> Gets how long a worker has run its current task, zero between tasks or if the worker was removed. </summary>
+        std::chrono::steady_clock::duration GetWorkerBusyTime(WorkerId workerId);
+
+        /// <summary> Marks a worker as stuck in its current task, or as recovered. </summary>
+        /// <remarks>
+        /// Tasks that may run on any worker are not routed to a stuck worker, i.e. by worker queue depth, worker class,
+        /// preferred worker or on the per worker queues of the policy. Tasks scheduled on the worker itself, such as
+        /// completions of asynchronous work issued from it, still wait for it.
+        /// </remarks>
+        void SetWorkerStuck(WorkerId workerId, bool stuck);
+
+        /// <summary> Tells whether a worker is marked as stuck. </summary>
+        bool IsWorkerStuck(WorkerId workerId) const;
+
+        /// <summary> Requests a worker to recycle its isolate once it finishes its current task, see Worker::RequestRecycle(). </summary>
+        void RequestWorkerRecycle(WorkerId workerId);
+
     private:
 
+        /// <summary> Number of priority lanes, lane index is the priority value. </summary>
+        static constexpr size_t PRIORITY_LANES = static_cast<size_t>(CallPriority::BACKGROUND) + 1;
+
+        /// <summary> Maximum number of tenants, beyond which tasks of new tenant names are scheduled as untagged ones. </summary>
+        static constexpr size_t MAX_TENANTS = 1024;
+
+        /// <summary> A tenant known to the scheduler, indexed by tenant. </summary>
+        struct TenantEntry {
+            std::string name;
+
+            /// <summary> Whether the tenant has a concurrency cap, then its tasks release their slot as they finish. </summary>
+            bool capped;
+        };
+
+        /// <summary> Decorates a task of a tenant, to report its queue time and release its slot under the cap. </summary>
+        class TenantTask : public Task {
+        public:
+            TenantTask(SchedulerImpl& scheduler, size_t tenant, const TenantEntry& entry, std::shared_ptr<Task> task) :
+                _scheduler(scheduler),
+                _tenant(tenant),
+                _entry(entry),
+                _task(std::move(task)),
+                _queuedAt(Clock::Now()) {}
+
+            void Execute() override {
+                if (_scheduler._tenantQueueTimeCallback) {
+                    _scheduler._tenantQueueTimeCallback(_entry.name, Clock::Now() - _queuedAt);
+                }
+
+                _task->Execute();
+
+                if (_entry.capped) {
+                    _scheduler.ReleaseTenant(_tenant);
+                }
+            }
+
+            std::chrono::steady_clock::time_point GetDeadline() const override {
+                return _task->GetDeadline();
+            }
+
+            void Cancel(ResultCode code, const std::string& reason) override {
+                _task->Cancel(code, reason);
+            }
+
+        private:
+            SchedulerImpl& _scheduler;
+            size_t _tenant;
+            const TenantEntry& _entry;
+            std::shared_ptr<Task> _task;
+            std::chrono::steady_clock::time_point _queuedAt;
+        };
+
+        /// <summary> Progress of a task rolling over all workers, shared by the decorators of the task. </summary>
+        struct Roll {
+            std::atomic<WorkerId> next;
+            uint32_t workers;
+        };
+
+        /// <summary> Decorates a task rolling over workers, to pass it on to the next worker once it ran. </summary>
+        class RollingTask : public Task {
+        public:
+            RollingTask(SchedulerImpl& scheduler, std::shared_ptr<Task> task, std::shared_ptr<Roll> roll) :
+                _scheduler(scheduler),
+                _task(std::move(task)),
+                _roll(std::move(roll)) {}
+
+            void Execute() override {
+                _task->Execute();
+                PassOn();
+            }
+
+            std::chrono::steady_clock::time_point GetDeadline() const override {
+                return _task->GetDeadline();
+            }
+
+            void Cancel(ResultCode code, const std::string& reason) override {
+                _task->Cancel(code, reason);
+                PassOn();
+            }
+
+        private:
+            void PassOn() {
+                auto workerId = _roll->next++;
+                if (workerId >= _roll->workers) {
+                    return;
+                }
+
+                _scheduler.ScheduleOnWorker(workerId, std::make_shared<RollingTask>(_scheduler, _task, _roll));
+                _scheduler.UnpinWorker(workerId);
+                if (workerId + 1 == _roll->workers) {
+                    _scheduler._rollingTasks--;
+                }
+            }
+
+            SchedulerImpl& _scheduler;
+            std::shared_ptr<Task> _task;
+            std::shared_ptr<Roll> _roll;
+        };
+
+        /// <summary> Wraps a task of a tenant into a TenantTask, tasks without tenant are returned as is. </summary>
+        std::shared_ptr<Task> TagTenant(std::shared_ptr<Task> task, size_t tenant);
+
+        /// <summary> Releases the slot of a finished task of a capped tenant, and hands a task held back by it to an idle worker. </summary>
+        void ReleaseTenant(size_t tenant);
+
+        /// <summary> Whether there is any task waiting for a worker. </summary>
+        bool HasQueuedTasks() const;
+
+        /// <summary> Passes the queue depth of a priority to the queue depth callback, if any. </summary>
+        void ReportQueueDepth(size_t lane);
+
+        /// <summary> Counts scheduling operations in flight, which may still use workers being removed. </summary>
+        /// <returns> The epoch slot to pass to EndScheduling(). </returns>
+        size_t BeginScheduling(size_t count = 1);
+
+        /// <summary> Ends scheduling operations started by BeginScheduling(). </summary>
+        void EndScheduling(size_t slot, size_t count = 1);
+
+        /// <summary> Cancels a task being scheduled once the workers shut down, then ends its scheduling operation. </summary>
+        /// <param name="task"> The task, null for an operation whose task isn't created yet. </param>
+        /// <returns> True if the scheduler shut down and the task was cancelled. </returns>
+        /// <remarks> Asynchronous work and timers may hold on to the scheduler and complete after its workers are gone. </remarks>
+        bool CancelIfShutDown(size_t slot, const std::shared_ptr<Task>& task);
+
+        /// <summary> Cancels tasks being scheduled in a batch once the workers shut down, see above. </summary>
+        bool CancelIfShutDown(size_t slot, const std::vector<std::shared_ptr<Task>>& tasks);
+
+        /// <summary> Creates and starts a worker in an empty slot. </summary>
+        void CreateWorker(WorkerId workerId, std::vector<std::shared_ptr<Task>> warmUpTasks);
+
+        /// <summary> Gets the settings a worker is created with, which have the isolate constraints of its worker class if any. </summary>
+        const settings::ZoneSettings& GetWorkerSettings(WorkerId workerId) const;
+
+        /// <summary> Runs on the resizer thread: adds workers up to, or removes workers down to, the given number. </summary>
+        void ApplyResize(uint32_t workers, const std::function<std::vector<std::shared_ptr<Task>>(WorkerId)>& warmUp);
+
+        /// <summary> Runs on the resizer thread: waits for a removed worker to finish its work, then shuts it down. </summary>
+        void RetireWorker(WorkerId workerId);
+
+        /// <summary> Gets the thread resizes and drains are applied on, creating it on first use. </summary>
+        SimpleThreadPool& GetResizer();
+
+        /// <summary> Whether no task is being scheduled, waiting for a worker or rolling over workers. </summary>
+        bool IsSchedulingDone() const;
+
+        /// <summary> Runs on the resizer thread: whether no worker has unfinished tasks or pending asynchronous work. </summary>
+        bool AreWorkersDone() const;
+
+        /// <summary> Waits on the drain event until a condition holds, or until a deadline. </summary>
+        /// <returns> True if the condition holds, false if the deadline passed first. </returns>
+        bool WaitForDrainEvent(const std::function<bool()>& condition, std::chrono::steady_clock::time_point deadline);
+
+        /// <summary> Cancels tasks waiting for a worker, on the synchronizer with a synchronized policy. </summary>
+        /// <returns> The number of tasks cancelled. </returns>
+        size_t CancelQueuedTasks(ResultCode code, const std::string& reason);
+
+        /// <summary> Synchronized: waits until all operations queued on the synchronizer so far have run. </summary>
+        void WaitForSynchronizer();
+
+        /// <summary> Synchronized: puts a worker into the idle list. </summary>
+        void MarkIdle(WorkerId workerId);
+
+        /// <summary> Synchronized: removes a worker from the idle list. </summary>
+        void UnmarkIdle(WorkerId workerId);
+
+        /// <summary> Synchronized: takes the first worker from the idle list. The list must not be empty. </summary>
+        WorkerId PopIdleWorker();
+
+        /// <summary> Synchronized: hands a task to an idle worker, or queues it if there is none or its tenant is at its cap. </summary>
+        void DispatchOrQueue(size_t lane, size_t tenant, std::shared_ptr<Task> task);
+
+        /// <summary> Synchronized: picks the busy worker with fewer unfinished tasks of two random ones, see workerQueueDepth. </summary>
+        /// <returns> False if both are at the depth, or if queued tasks would be overtaken. </returns>
+        bool FindShortWorkerQueue(WorkerId& workerId);
+
+        /// <summary> Picks the worker the next task is queued on for policies that queue tasks per worker, round robin past stuck workers. </summary>
+        WorkerId NextQueueWorker(uint32_t workers);
+
+        /// <summary> Queues a task with the policy, on a worker picked round robin for policies that queue tasks per worker. </summary>
+        /// <remarks> Called on the synchronizer with a synchronized policy. </remarks>
+        void QueueTask(size_t lane, size_t tenant, std::shared_ptr<Task> task);
+
+        /// <summary> Takes the next queued task for a worker from the policy, or nullptr if there is none. </summary>
+        /// <remarks>
+        /// Called on the synchronizer with a synchronized policy. Tasks that already expired are cancelled
+        /// on the way if the policy drops them.
+        /// </remarks>
+        std::shared_ptr<Task> PickNextTask(WorkerId workerId);
+
         /// <summary> The logic invoked when a worker is idle. </summary>
         void IdleWorkerNotificationCallback(WorkerId workerId);
 
-        /// <summary> The workers that are used for running the tasks. </summary>
-        std::vector<WorkerType> _workers;
+        /// <summary> Unsynchronized policy: hands a task to the worker or marks it idle when there is nothing to run. </summary>
+        /// <remarks> The worker must not be marked idle by the caller. </remarks>
+        void FeedOrParkWorker(WorkerId workerId);
+
+        /// <summary> Unsynchronized policy: claims an idle worker and feeds it with a pending task. </summary>
+        void WakeIdleWorker();
+
+        /// <summary> Per worker state that is read from any thread. </summary>
+        struct WorkerSlot {
+            /// <summary> Unsynchronized policy: whether the worker is idle and waiting for a task. </summary>
+            std::atomic<bool> idle;
+
+            /// <summary> Number of pins that keep the worker from being shut down. </summary>
+            std::atomic<uint32_t> pins;
+
+            /// <summary> Whether the worker is stuck in its current task, then tasks for any worker are routed elsewhere. </summary>
+            std::atomic<bool> stuck;
+        };
+
+        /// <summary> The zone settings, used for creating workers. </summary>
+        settings::ZoneSettings _settings;
+
+        /// <summary> The slots of a worker class, and the settings its workers are created with. </summary>
+        struct WorkerClassSlots {
+            WorkerId first;
+            uint32_t workers;
+            settings::ZoneSettings settings;
+        };
+
+        /// <summary> Worker classes in the order of zone settings, their slots follow each other from the first one. </summary>
+        std::vector<WorkerClassSlots> _workerClasses;
+
+        /// <summary> Number of workers of all worker classes. </summary>
+        uint32_t _workerClassWorkers;
+
+        /// <summary> Round robin counter for breaking ties between workers of a class. </summary>
+        std::atomic<uint32_t> _nextClassWorker;
+
+        /// <summary> Callback to setup the isolate of a new worker. </summary>
+        std::function<void(WorkerId)> _workerSetupCallback;
+
+        /// <summary> Callback before a worker recreates its isolate. </summary>
+        std::function<bool(WorkerId)> _workerRecycleCallback;
+
+        /// <summary> Callback when the queue depth of a priority changes. </summary>
+        std::function<void(CallPriority, size_t)> _queueDepthCallback;
+
+        /// <summary> Callback when a task of a tenant starts. </summary>
+        std::function<void(const std::string&, std::chrono::nanoseconds)> _tenantQueueTimeCallback;
+
+        /// <summary> Queue length of a preferred worker beyond which tasks spill to other workers. </summary>
+        size_t _affinitySpillThreshold;
+
+        /// <summary> Number of unfinished tasks busy workers are kept filled with, 0 for idle workers only. </summary>
+        size_t _workerQueueDepth;
+
+        /// <summary> Synchronized: picks the workers compared by FindShortWorkerQueue(). </summary>
+        std::minstd_rand _random;
+
+        /// <summary> Maximum number of workers, all per worker structures are allocated for it up front. </summary>
+        uint32_t _capacity;
+
+        /// <summary> The workers that are used for running the tasks, indexed by worker id. Empty slots are null. </summary>
+        std::vector<std::unique_ptr<WorkerType>> _workers;
+
+        /// <summary> Decides the order of queued tasks. </summary>
+        std::unique_ptr<SchedulingPolicy> _policy;
+
+        /// <summary> Whether the policy is synchronized, then the synchronizer keeps the idle list and calls the policy. </summary>
+        bool _synchronized;
+
+        /// <summary> Number of workers that take new tasks, they are the first slots. </summary>
+        std::atomic<uint32_t> _activeWorkers;
+
+        /// <summary> Number of slots that ever had a worker, the queues of all of them are looked at when stealing. </summary>
+        std::atomic<uint32_t> _usedSlots;
+
+        /// <summary> Per worker state, indexed by worker id. </summary>
+        std::unique_ptr<WorkerSlot[]> _workerSlots;
+
+        /// <summary> Round robin counter for picking the worker a new task is queued on, see SchedulingPolicy::Enqueue(). </summary>
+        std::atomic<uint32_t> _nextQueue;
+
+        /// <summary> Tenants by index, a deque keeps the entries that queued tasks refer to in place. Tenant 0 has no name. </summary>
+        std::deque<TenantEntry> _tenants;
+
+        /// <summary> Tenant indices by name. </summary>
+        std::unordered_map<std::string, size_t> _tenantIds;
+
+        /// <summary> Lock for the tenants, which are added from calling threads. </summary>
+        std::mutex _tenantLock;
 
-        /// <summary> New tasks that weren't assigned to a specific worker. </summary>
-        std::queue<std::shared_ptr<Task>> _nonScheduledTasks;
+        /// <summary> Number of tasks waiting for a worker per priority, i.e. queued with the policy. </summary>
+        std::array<std::atomic<size_t>, PRIORITY_LANES> _queueDepths;
 
         /// <summary> List of idle workers, used when assigning non scheduled tasks. </summary>
         std::list<WorkerId> _idleWorkers;
@@ -73,149 +520,1085 @@ namespace zone {
         /// <summary> Flags to indicate that a worker is in the idle list. </summary>
         std::vector<std::list<WorkerId>::iterator> _idleWorkersFlags;
 
+        /// <summary> Size of the idle list, readable from any thread. </summary>
+        std::atomic<uint32_t> _idleWorkerCount;
+
         /// <summary> Uses a single thread to synchronize task queuing and posting. </summary>
         std::unique_ptr<SimpleThreadPool> _synchronizer;
 
+        /// <summary> Applies resizes one at a time, created on first resize. </summary>
+        std::unique_ptr<SimpleThreadPool> _resizer;
+
+        /// <summary> Lock for creating the resizer. </summary>
+        std::mutex _resizerLock;
+
+        /// <summary> Serializes adding workers with scheduling tasks on all workers. </summary>
+        std::mutex _allWorkersLock;
+
+        /// <summary> Number of tasks rolling over workers that haven't reached all of them yet. </summary>
+        std::atomic<uint32_t> _rollingTasks;
+
         /// <summary> A flag to signal that scheduler is stopping. </summary>
         std::atomic<bool> _shouldStop;
 
-        /// <summary> Tasks being scheduled but not yet dispatched to worker or put into non-scheduled queue. </summary>
-        std::atomic<size_t> _beingScheduled;
+        /// <summary> Set by the first shutdown. </summary>
+        std::atomic<bool> _shutDown;
+
+        /// <summary>
+        /// Tasks being scheduled but not yet dispatched to worker or put into non-scheduled queue, in 2 epoch slots.
+        /// Removing workers flips the epoch and waits for the previous slot to drain, after which no operation
+        /// that may have seen the old number of workers is in flight.
+        /// </summary>
+        std::array<std::atomic<size_t>, 2> _beingScheduled;
+
+        /// <summary> The current epoch, its lowest bit selects the slot of _beingScheduled. </summary>
+        std::atomic<uint32_t> _epoch;
+
+        /// <summary> How often waiters of the drain event recheck, for pins and scheduling that don't signal it. </summary>
+        static constexpr std::chrono::milliseconds DRAIN_CHECK_INTERVAL = std::chrono::milliseconds(10);
+
+        /// <summary> Event signaled as workers run out of tasks while anyone waits for the scheduler to drain. </summary>
+        std::mutex _drainLock;
+        std::condition_variable _drainEvent;
+
+        /// <summary> Number of threads waiting on the drain event, workers only signal it when there are any. </summary>
+        std::atomic<uint32_t> _drainWaiters;
     };
 
+    template <typename WorkerType>
+    constexpr std::chrono::milliseconds SchedulerImpl<WorkerType>::DRAIN_CHECK_INTERVAL;
+
     typedef SchedulerImpl<Worker> Scheduler;
 
     template <typename WorkerType>
-    SchedulerImpl<WorkerType>::SchedulerImpl(const settings::ZoneSettings& settings, std::function<void(WorkerId)> workerSetupCallback) :
-        _idleWorkersFlags(settings.workers),
-        _synchronizer(std::make_unique<SimpleThreadPool>(1)),
+    SchedulerImpl<WorkerType>::SchedulerImpl(const settings::ZoneSettings& settings,
+                                             std::function<void(WorkerId)> workerSetupCallback,
+                                             std::function<bool(WorkerId)> workerRecycleCallback,
+                                             std::function<void(CallPriority, size_t)> queueDepthCallback,
+                                             std::function<void(const std::string&, std::chrono::nanoseconds)> tenantQueueTimeCallback) :
+        _settings(settings),
+        _workerClassWorkers(0),
+        _nextClassWorker(0),
+        _workerSetupCallback(std::move(workerSetupCallback)),
+        _workerRecycleCallback(std::move(workerRecycleCallback)),
+        _queueDepthCallback(std::move(queueDepthCallback)),
+        _tenantQueueTimeCallback(std::move(tenantQueueTimeCallback)),
+        _affinitySpillThreshold(settings.affinitySpillThreshold),
+        _workerQueueDepth(settings.scheduler == settings::SchedulerType::SYNCHRONIZED ? settings.workerQueueDepth : 0),
+        _capacity(std::max(settings.workers, settings.maxWorkers)),
+        _workers(_capacity),
+        _policy(CreateSchedulingPolicy(settings.scheduler, PRIORITY_LANES, _capacity)),
+        _synchronized(_policy->IsSynchronized()),
+        _activeWorkers(settings.workers),
+        _usedSlots(settings.workers),
+        _workerSlots(std::make_unique<WorkerSlot[]>(_capacity)),
+        _nextQueue(0),
+        _idleWorkersFlags(_capacity),
+        _idleWorkerCount(0),
+        _rollingTasks(0),
         _shouldStop(false),
-        _beingScheduled(0) {
+        _shutDown(false),
+        _epoch(0),
+        _drainWaiters(0) {
 
-        _workers.reserve(settings.workers);
+        if (_synchronized) {
+            _synchronizer = std::make_unique<SimpleThreadPool>(1);
+        }
 
-        for (WorkerId i = 0; i < settings.workers; i++) {
-            _workers.emplace_back(i, settings, workerSetupCallback, [this](WorkerId workerId) {
-                IdleWorkerNotificationCallback(workerId);
-            });
-            _workers[i].Start();
+        for (auto& depth : _queueDepths) {
+            depth = 0;
+        }
 
+        for (auto& count : _beingScheduled) {
+            count = 0;
+        }
+
+        for (WorkerId i = 0; i < _capacity; i++) {
+            _workerSlots[i].idle = false;
+            _workerSlots[i].pins = 0;
+            _workerSlots[i].stuck = false;
+            _idleWorkersFlags[i] = _idleWorkers.end();
+        }
+
+        for (const auto& workerClass : settings.workerClasses) {
+            auto classSettings = settings;
+            classSettings.maxOldSpaceSize = workerClass.maxOldSpaceSize;
+            classSettings.maxSemiSpaceSize = workerClass.maxSemiSpaceSize;
+            classSettings.maxStackSize = workerClass.maxStackSize;
+
+            _workerClasses.push_back(WorkerClassSlots{ _workerClassWorkers, workerClass.workers, std::move(classSettings) });
+            _workerClassWorkers += workerClass.workers;
+        }
+        NAPA_ASSERT(_workerClassWorkers <= settings.workers, "worker classes have more workers than the zone");
+
+        _tenants.push_back(TenantEntry{ std::string(), false });
+        if (_policy->SharesByTenant()) {
+            for (const auto& tenant : settings.tenants) {
+                _tenantIds.emplace(tenant.name, _tenants.size());
+                _tenants.push_back(TenantEntry{ tenant.name, tenant.maxConcurrency > 0 });
+                _policy->AddTenant(tenant.weight, tenant.maxConcurrency);
+            }
+        }
+
+        for (WorkerId i = 0; i < settings.workers; i++) {
             // All workers are idle initially.
-            auto iter = _idleWorkers.emplace(_idleWorkers.end(), i);
-            _idleWorkersFlags[i] = iter;
+            _workerSlots[i].idle = true;
+            MarkIdle(i);
+
+            CreateWorker(i, {});
         }
     }
 
     template <typename WorkerType>
     SchedulerImpl<WorkerType>::~SchedulerImpl() {
+        Shutdown();
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::Shutdown() {
+        if (_shutDown.exchange(true)) {
+            return;
+        }
         NAPA_DEBUG("Scheduler", "Shutting down: Start draining unscheduled tasks...");
 
-        // Wait for all tasks to be scheduled.
-        while (_beingScheduled > 0 || !_nonScheduledTasks.empty()) {
-            std::this_thread::yield();
+        // Wait for pending resizes and drains, removed workers may still be draining.
+        {
+            std::lock_guard<std::mutex> lock(_resizerLock);
+            _resizer = nullptr;
         }
 
-        // Signal scheduler callbacks to not process anymore tasks.
+        // Wait for all tasks to be scheduled, including tasks rolling over workers.
+        WaitForDrainEvent([this]() { return IsSchedulingDone(); }, std::chrono::steady_clock::time_point::max());
+
+        // Signal scheduler callbacks to not process anymore tasks, and scheduling operations to cancel their tasks.
         _shouldStop = true;
 
+        // Operations that began before they could see the signal are done with workers and the synchronizer.
+        while (_beingScheduled[0] > 0 || _beingScheduled[1] > 0) {
+            std::this_thread::yield();
+        }
+
         // Wait for synchronizer to finish his book-keeping.
         _synchronizer = nullptr;
 
-        // Wait for all workers to finish processing remaining tasks.
-        _workers.clear();
+        // Close all workers before waiting for any, so they finish their tasks and dispose their isolates in parallel.
+        for (auto& worker : _workers) {
+            if (worker != nullptr) {
+                worker->Close();
+            }
+        }
+
+        // Slots stay, so calls after shutdown find no worker rather than index past the end.
+        for (auto& worker : _workers) {
+            worker.reset();
+        }
 
         NAPA_DEBUG("Scheduler", "Shutdown completed");
     }
 
     template <typename WorkerType>
-    void SchedulerImpl<WorkerType>::Schedule(std::shared_ptr<Task> task) {
+    void SchedulerImpl<WorkerType>::Schedule(std::shared_ptr<Task> task, CallPriority priority, size_t tenant) {
         NAPA_ASSERT(task, "task is null");
-        _beingScheduled++;
-        _synchronizer->Execute([this, task]() {
-            if (_idleWorkers.empty()) {
-                NAPA_DEBUG("Scheduler", "All workers are busy, putting task to non-scheduled queue.");
-
-                // If there is no idle worker, put the task into the non-scheduled queue.
-                _nonScheduledTasks.emplace(std::move(task));
-            } else {
-                // Pop the worker id from the idle workers list.
-                auto workerId = _idleWorkers.front();
-                _idleWorkers.pop_front();
-                _idleWorkersFlags[workerId] = _idleWorkers.end();
+        auto lane = static_cast<size_t>(priority);
+        NAPA_ASSERT(lane < PRIORITY_LANES, "priority out of range");
+
+        auto slot = BeginScheduling();
+        if (CancelIfShutDown(slot, task)) {
+            return;
+        }
+
+        if (!_synchronized) {
+            QueueTask(lane, 0, std::move(task));
+            WakeIdleWorker();
+            EndScheduling(slot);
+            return;
+        }
+
+        task = TagTenant(std::move(task), tenant);
+        _synchronizer->Execute([this, task = std::move(task), lane, tenant, slot]() mutable {
+            DispatchOrQueue(lane, tenant, std::move(task));
+            EndScheduling(slot);
+        });
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::ScheduleBatch(std::vector<std::shared_ptr<Task>> tasks, CallPriority priority, size_t tenant) {
+        auto lane = static_cast<size_t>(priority);
+        NAPA_ASSERT(lane < PRIORITY_LANES, "priority out of range");
+
+        auto count = tasks.size();
+        auto slot = BeginScheduling(count);
+        if (CancelIfShutDown(slot, tasks)) {
+            return;
+        }
+
+        if (!_synchronized) {
+            auto workers = _activeWorkers.load();
+            for (auto& task : tasks) {
+                NAPA_ASSERT(task, "task is null");
+
+                // Count the task before it becomes visible, so the depth never goes below the actual number of tasks.
+                _queueDepths[lane]++;
+                _policy->Enqueue(lane, 0, NextQueueWorker(workers), std::move(task));
+            }
+
+            NAPA_DEBUG("Scheduler", "Queued a batch of %zu tasks with priority %zu.", count, lane);
+            ReportQueueDepth(lane);
+
+            // Each woken worker keeps pulling tasks until the queues are empty.
+            for (size_t i = 0; i < count && i < workers; i++) {
+                WakeIdleWorker();
+            }
+            EndScheduling(slot, count);
+            return;
+        }
 
-                // Schedule task on worker
-                _workers[workerId].Schedule(std::move(task));
+        for (auto& task : tasks) {
+            NAPA_ASSERT(task, "task is null");
+            task = TagTenant(std::move(task), tenant);
+        }
 
-                NAPA_DEBUG("Scheduler", "Scheduled task on worker %u.", workerId);
+        _synchronizer->Execute([this, tasks = std::move(tasks), lane, tenant, count, slot]() mutable {
+            for (auto& task : tasks) {
+                DispatchOrQueue(lane, tenant, std::move(task));
             }
-            _beingScheduled--;
+
+            NAPA_DEBUG("Scheduler", "Scheduled a batch of %zu tasks with priority %zu.", count, lane);
+            EndScheduling(slot, count);
+        });
+    }
+
+    template <typename WorkerType>
+    size_t SchedulerImpl<WorkerType>::FindOrAddTenant(const char* name, size_t length) {
+        if (length == 0 || !_policy->SharesByTenant()) {
+            return 0;
+        }
+
+        std::string key(name, length);
+        std::lock_guard<std::mutex> lock(_tenantLock);
+        auto it = _tenantIds.find(key);
+        if (it != _tenantIds.end()) {
+            return it->second;
+        }
+
+        if (_tenants.size() >= MAX_TENANTS) {
+            NAPA_DEBUG("Scheduler", "Too many tenants, scheduling tasks of tenant \"%s\" without tenant.", key.c_str());
+            return 0;
+        }
+
+        // Posted under the lock, so the tenant is added before any task of it reaches the synchronizer.
+        auto tenant = _tenants.size();
+        _tenants.push_back(TenantEntry{ key, false });
+        _tenantIds.emplace(std::move(key), tenant);
+        _synchronizer->Execute([this]() {
+            _policy->AddTenant(1, 0);
         });
-        
+        return tenant;
     }
 
     template <typename WorkerType>
     void SchedulerImpl<WorkerType>::ScheduleOnWorker(WorkerId workerId, std::shared_ptr<Task> task) {
-        NAPA_ASSERT(workerId < _workers.size(), "worker id out of range");
+        auto slot = BeginScheduling();
+        if (CancelIfShutDown(slot, task)) {
+            return;
+        }
+        NAPA_ASSERT(workerId < _capacity && _workers[workerId] != nullptr, "worker id out of range");
+
+        if (!_synchronized) {
+            // The worker is busy from now on, it will ask for more work when it becomes idle again.
+            _workerSlots[workerId].idle = false;
+            _workers[workerId]->Schedule(std::move(task));
 
-        _synchronizer->Execute([workerId, this, task]() {
+            NAPA_DEBUG("Scheduler", "Explicitly scheduled task on worker %u.", workerId);
+            EndScheduling(slot);
+            return;
+        }
+
+        _synchronizer->Execute([workerId, this, task = std::move(task), slot]() mutable {
             // If the worker is idle, change it's status.
-            if (_idleWorkersFlags[workerId] != _idleWorkers.end()) {
-                _idleWorkers.erase(_idleWorkersFlags[workerId]);
-                _idleWorkersFlags[workerId] = _idleWorkers.end();
-            }
+            UnmarkIdle(workerId);
 
             // Schedule task on worker
-            _workers[workerId].Schedule(std::move(task));
+            _workers[workerId]->Schedule(std::move(task));
 
             NAPA_DEBUG("Scheduler", "Explicitly scheduled task on worker %u.", workerId);
+            EndScheduling(slot);
         });
     }
 
     template <typename WorkerType>
-    void SchedulerImpl<WorkerType>::ScheduleOnAllWorkers(std::shared_ptr<Task> task) {
-        NAPA_ASSERT(task, "task is null");
+    void SchedulerImpl<WorkerType>::ScheduleOnPreferredWorker(WorkerId workerId, std::shared_ptr<Task> task, CallPriority priority) {
+        auto slot = BeginScheduling();
+        if (CancelIfShutDown(slot, task)) {
+            return;
+        }
+
+        // The number of workers may have changed since the caller picked the worker.
+        workerId %= _activeWorkers.load();
+
+        if (!_workerSlots[workerId].stuck && _workers[workerId]->GetQueueLength() < _affinitySpillThreshold) {
+            ScheduleOnWorker(workerId, std::move(task));
+        } else {
+            NAPA_DEBUG("Scheduler", "Preferred worker %u is overloaded or stuck, spilling task to other workers.", workerId);
+            Schedule(std::move(task), priority);
+        }
+
+        EndScheduling(slot);
+    }
+
+    template <typename WorkerType>
+    int32_t SchedulerImpl<WorkerType>::FindWorkerClass(const char* name, size_t length) const {
+        for (size_t i = 0; i < _workerClasses.size(); i++) {
+            const auto& className = _settings.workerClasses[i].name;
+            if (className.size() == length && className.compare(0, length, name, length) == 0) {
+                return static_cast<int32_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::ScheduleOnWorkerClass(size_t workerClass, std::shared_ptr<Task> task) {
+        NAPA_ASSERT(workerClass < _workerClasses.size(), "worker class out of range");
+        const auto& slots = _workerClasses[workerClass];
+
+        // Workers of a class are never removed, but shut down along with the others.
+        auto slot = BeginScheduling();
+        if (CancelIfShutDown(slot, task)) {
+            return;
+        }
 
-        _synchronizer->Execute([this, task]() {
-            // Clear all idle workers.
-            _idleWorkers.clear();
-            for (auto& flag : _idleWorkersFlags) {
-                flag = _idleWorkers.end();
+        auto start = _nextClassWorker++;
+        auto workerId = slots.first + start % slots.workers;
+        auto stuck = _workerSlots[workerId].stuck.load();
+        auto queueLength = _workers[workerId]->GetQueueLength();
+        for (uint32_t i = 1; i < slots.workers && (stuck || queueLength > 0); i++) {
+            auto candidate = slots.first + (start + i) % slots.workers;
+            if (_workerSlots[candidate].stuck) {
+                continue;
             }
 
-            // Schedule the task on all workers.
-            for (auto& worker : _workers) {
-                worker.Schedule(task);
+            // Any worker that isn't stuck beats a stuck one, if all of them are stuck the task waits on the first one.
+            auto candidateLength = _workers[candidate]->GetQueueLength();
+            if (stuck || candidateLength < queueLength) {
+                workerId = candidate;
+                queueLength = candidateLength;
+                stuck = false;
             }
-            NAPA_DEBUG("Scheduler", "Scheduled task on all workers");
+        }
+
+        NAPA_DEBUG("Scheduler", "Routing task to worker %u of worker class %zu.", workerId, workerClass);
+        ScheduleOnWorker(workerId, std::move(task));
+        EndScheduling(slot);
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::ScheduleOnAllWorkers(std::shared_ptr<Task> task) {
+        NAPA_ASSERT(task, "task is null");
+
+        ScheduleOnAllWorkers([&task](uint32_t) {
+            return std::move(task);
         });
     }
 
     template <typename WorkerType>
-    void SchedulerImpl<WorkerType>::IdleWorkerNotificationCallback(WorkerId workerId) {
-        NAPA_ASSERT(workerId < _workers.size(), "worker id out of range");
+    void SchedulerImpl<WorkerType>::ScheduleOnAllWorkers(std::function<std::shared_ptr<Task>(uint32_t)> createTask) {
+        ScheduleOnAllWorkers(std::move(createTask), 0);
+    }
 
-        if (_shouldStop) {
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::ScheduleOnAllWorkers(std::function<std::shared_ptr<Task>(uint32_t)> createTask, uint32_t concurrency) {
+        auto slot = BeginScheduling();
+        if (CancelIfShutDown(slot, nullptr)) {
             return;
         }
 
-        _synchronizer->Execute([this, workerId]() {
-            if (!_nonScheduledTasks.empty()) {
-                // If there is a non scheduled task, schedule it on the idle worker.
-                auto task = _nonScheduledTasks.front();
-                _nonScheduledTasks.pop();
-                _workers[workerId].Schedule(std::move(task));
-
-                NAPA_DEBUG("Scheduler", "Worker %u fetched a task from non-scheduled queue", workerId);
-            } else {
-                // Put worker in idle list.
-                if (_idleWorkersFlags[workerId] == _idleWorkers.end()) {
-                    auto iter = _idleWorkers.emplace(_idleWorkers.end(), workerId);
-                    _idleWorkersFlags[workerId] = iter;
+        std::shared_ptr<Task> task;
+        uint32_t workers;
+        {
+            std::lock_guard<std::mutex> lock(_allWorkersLock);
+            workers = _activeWorkers.load();
+            task = createTask(workers);
 
-                    NAPA_DEBUG("Scheduler", "Worker %u becomes idle", workerId);
+            // Pinned while the number of workers can't change, so none of them is retired before the task reaches it.
+            if (concurrency > 0 && concurrency < workers) {
+                for (WorkerId i = concurrency; i < workers; i++) {
+                    PinWorker(i);
                 }
+                _rollingTasks++;
             }
-        });
-    }
-}
+        }
+        NAPA_ASSERT(task, "task is null");
+
+        if (concurrency > 0 && concurrency < workers) {
+            auto roll = std::make_shared<Roll>();
+            roll->next = concurrency;
+            roll->workers = workers;
+            for (WorkerId i = 0; i < concurrency; i++) {
+                ScheduleOnWorker(i, std::make_shared<RollingTask>(*this, task, roll));
+            }
+            NAPA_DEBUG("Scheduler", "Scheduled task on %u workers at a time", concurrency);
+            EndScheduling(slot);
+            return;
+        }
+
+        if (!_synchronized) {
+            for (WorkerId i = 0; i < workers; i++) {
+                _workerSlots[i].idle = false;
+                _workers[i]->Schedule(task);
+            }
+            NAPA_DEBUG("Scheduler", "Scheduled task on all workers");
+            EndScheduling(slot);
+            return;
+        }
+
+        _synchronizer->Execute([this, task = std::move(task), workers, slot]() {
+            // Schedule the task on all workers, none of them is idle afterwards.
+            for (WorkerId i = 0; i < workers; i++) {
+                UnmarkIdle(i);
+                _workers[i]->Schedule(task);
+            }
+            NAPA_DEBUG("Scheduler", "Scheduled task on all workers");
+            EndScheduling(slot);
+        });
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::InterruptAllWorkers(InterruptCallback callback, void* data) {
+        // Workers are removed from the active ones under the lock, before they are shut down.
+        std::lock_guard<std::mutex> lock(_allWorkersLock);
+        if (_shouldStop) {
+            return;
+        }
+
+        auto workers = _activeWorkers.load();
+        for (WorkerId i = 0; i < workers; i++) {
+            _workers[i]->RequestInterrupt(callback, data);
+        }
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::Resize(uint32_t workers,
+                                           std::function<std::vector<std::shared_ptr<Task>>(WorkerId)> warmUp,
+                                           std::function<void()> callback) {
+        NAPA_ASSERT(workers > 0 && workers <= _capacity && workers >= _workerClassWorkers, "number of workers out of range");
+
+        GetResizer().Execute([this, workers, warmUp = std::move(warmUp), callback = std::move(callback)]() {
+            ApplyResize(workers, warmUp);
+            if (callback) {
+                callback();
+            }
+        });
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::Drain(std::chrono::steady_clock::time_point deadline, std::function<void(bool, size_t)> callback) {
+        GetResizer().Execute([this, deadline, callback = std::move(callback)]() {
+            auto drained = WaitForDrainEvent([this]() { return IsSchedulingDone() && AreWorkersDone(); }, deadline);
+
+            size_t cancelled = 0;
+            if (!drained) {
+                // Tasks being scheduled are queued by the time the synchronizer ran them.
+                WaitForSynchronizer();
+                cancelled = CancelQueuedTasks(NAPA_RESULT_CANCELLED, "Cancelled by zone drain at its deadline");
+                NAPA_DEBUG("Scheduler", "Drain reached its deadline, cancelled %zu queued tasks.", cancelled);
+            }
+            callback(drained, cancelled);
+        });
+    }
+
+    template <typename WorkerType>
+    uint32_t SchedulerImpl<WorkerType>::GetWorkerCount() const {
+        return _activeWorkers;
+    }
+
+    template <typename WorkerType>
+    uint32_t SchedulerImpl<WorkerType>::GetWorkerCapacity() const {
+        return _capacity;
+    }
+
+    template <typename WorkerType>
+    uint32_t SchedulerImpl<WorkerType>::GetIdleWorkerCount() const {
+        if (_synchronized) {
+            return _idleWorkerCount;
+        }
+
+        uint32_t count = 0;
+        auto workers = _activeWorkers.load();
+        for (WorkerId i = 0; i < workers; i++) {
+            if (_workerSlots[i].idle) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    template <typename WorkerType>
+    uint32_t SchedulerImpl<WorkerType>::GetWorkerClassWorkers() const {
+        return _workerClassWorkers;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::PinWorker(WorkerId workerId) {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+        _workerSlots[workerId].pins++;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::UnpinWorker(WorkerId workerId) {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+        _workerSlots[workerId].pins--;
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::IsWorkerPinned(WorkerId workerId) const {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+        return _workerSlots[workerId].pins > 0;
+    }
+
+    template <typename WorkerType>
+    size_t SchedulerImpl<WorkerType>::GetQueueDepth(CallPriority priority) const {
+        auto lane = static_cast<size_t>(priority);
+        NAPA_ASSERT(lane < PRIORITY_LANES, "priority out of range");
+
+        return _queueDepths[lane];
+    }
+
+    template <typename WorkerType>
+    std::chrono::steady_clock::duration SchedulerImpl<WorkerType>::GetWorkerBusyTime(WorkerId workerId) {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+
+        // Workers are removed from the active ones under the lock, before they are shut down.
+        std::lock_guard<std::mutex> lock(_allWorkersLock);
+        if (workerId >= _activeWorkers) {
+            return std::chrono::steady_clock::duration::zero();
+        }
+        return _workers[workerId]->GetBusyTime();
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::SetWorkerStuck(WorkerId workerId, bool stuck) {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+        _workerSlots[workerId].stuck = stuck;
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::IsWorkerStuck(WorkerId workerId) const {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+        return _workerSlots[workerId].stuck;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::RequestWorkerRecycle(WorkerId workerId) {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+
+        std::lock_guard<std::mutex> lock(_allWorkersLock);
+        if (workerId < _activeWorkers) {
+            _workers[workerId]->RequestRecycle();
+        }
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::HasQueuedTasks() const {
+        for (auto& depth : _queueDepths) {
+            if (depth > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename WorkerType>
+    std::shared_ptr<Task> SchedulerImpl<WorkerType>::TagTenant(std::shared_ptr<Task> task, size_t tenant) {
+        if (tenant == 0) {
+            return task;
+        }
+
+        std::lock_guard<std::mutex> lock(_tenantLock);
+        NAPA_ASSERT(tenant < _tenants.size(), "tenant out of range");
+        return std::make_shared<TenantTask>(*this, tenant, _tenants[tenant], std::move(task));
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::ReleaseTenant(size_t tenant) {
+        if (_shouldStop) {
+            return;
+        }
+
+        _synchronizer->Execute([this, tenant]() {
+            _policy->Release(tenant);
+
+            // Tasks held back by the cap may run on workers that became idle meanwhile.
+            while (!_idleWorkers.empty()) {
+                auto workerId = _idleWorkers.front();
+                auto task = PickNextTask(workerId);
+                if (task == nullptr) {
+                    break;
+                }
+
+                UnmarkIdle(workerId);
+                _workers[workerId]->Schedule(std::move(task));
+                NAPA_DEBUG("Scheduler", "Scheduled a task released by tenant %zu on worker %u.", tenant, workerId);
+            }
+        });
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::ReportQueueDepth(size_t lane) {
+        if (_queueDepthCallback) {
+            _queueDepthCallback(static_cast<CallPriority>(lane), _queueDepths[lane]);
+        }
+    }
+
+    template <typename WorkerType>
+    size_t SchedulerImpl<WorkerType>::BeginScheduling(size_t count) {
+        auto slot = _epoch.load() & 1;
+        _beingScheduled[slot] += count;
+        return slot;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::EndScheduling(size_t slot, size_t count) {
+        _beingScheduled[slot] -= count;
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::CancelIfShutDown(size_t slot, const std::shared_ptr<Task>& task) {
+        // Shutdown() signals before it waits for operations being scheduled, so either it waits or they see the signal.
+        if (!_shouldStop) {
+            return false;
+        }
+
+        EndScheduling(slot);
+        if (task != nullptr) {
+            task->Cancel(NAPA_RESULT_CANCELLED, "Cancelled by scheduler shutdown");
+        }
+        NAPA_DEBUG("Scheduler", "Cancelled a task scheduled after shutdown.");
+        return true;
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::CancelIfShutDown(size_t slot, const std::vector<std::shared_ptr<Task>>& tasks) {
+        if (!_shouldStop) {
+            return false;
+        }
+
+        EndScheduling(slot, tasks.size());
+        for (const auto& task : tasks) {
+            task->Cancel(NAPA_RESULT_CANCELLED, "Cancelled by scheduler shutdown");
+        }
+        NAPA_DEBUG("Scheduler", "Cancelled %zu tasks scheduled after shutdown.", tasks.size());
+        return true;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::CreateWorker(WorkerId workerId, std::vector<std::shared_ptr<Task>> warmUpTasks) {
+        NAPA_ASSERT(_workers[workerId] == nullptr, "worker slot is in use");
+
+        _workers[workerId] = std::make_unique<WorkerType>(workerId, GetWorkerSettings(workerId), _workerSetupCallback, [this](WorkerId id) {
+            IdleWorkerNotificationCallback(id);
+        }, _workerRecycleCallback);
+
+        // Warm-up tasks are queued before the worker becomes visible, thus they run before any other task.
+        for (auto& task : warmUpTasks) {
+            _workers[workerId]->Schedule(std::move(task));
+        }
+        _workers[workerId]->Start();
+    }
+
+    template <typename WorkerType>
+    const settings::ZoneSettings& SchedulerImpl<WorkerType>::GetWorkerSettings(WorkerId workerId) const {
+        for (const auto& workerClass : _workerClasses) {
+            if (workerId >= workerClass.first && workerId < workerClass.first + workerClass.workers) {
+                return workerClass.settings;
+            }
+        }
+        return _settings;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::ApplyResize(uint32_t workers,
+                                                const std::function<std::vector<std::shared_ptr<Task>>(WorkerId)>& warmUp) {
+        auto current = _activeWorkers.load();
+
+        if (workers > current) {
+            {
+                std::lock_guard<std::mutex> lock(_allWorkersLock);
+                for (auto id = current; id < workers; id++) {
+                    _workerSlots[id].idle = false;
+                    CreateWorker(id, warmUp ? warmUp(id) : std::vector<std::shared_ptr<Task>>());
+                }
+
+                if (_usedSlots < workers) {
+                    _usedSlots = workers;
+                }
+                _activeWorkers = workers;
+            }
+
+            // Let new workers pick up queued tasks, or put them into the idle list.
+            for (auto id = current; id < workers; id++) {
+                IdleWorkerNotificationCallback(id);
+            }
+
+            NAPA_DEBUG("Scheduler", "Added %u workers, %u workers in total.", workers - current, workers);
+            return;
+        }
+
+        if (workers == current) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_allWorkersLock);
+            _activeWorkers = workers;
+        }
+
+        // Wait for operations that may have seen the removed workers as active.
+        auto previousSlot = _epoch++ & 1;
+        while (_beingScheduled[previousSlot] > 0) {
+            std::this_thread::yield();
+        }
+
+        if (!_synchronized) {
+            for (auto id = workers; id < current; id++) {
+                _workerSlots[id].idle = false;
+            }
+
+            // Tasks left in queues of removed workers are stolen by the remaining ones.
+            for (WorkerId i = 0; i < workers && HasQueuedTasks(); i++) {
+                WakeIdleWorker();
+            }
+        } else {
+            _synchronizer->Execute([this, workers, current]() {
+                for (auto id = workers; id < current; id++) {
+                    UnmarkIdle(id);
+                }
+            });
+        }
+
+        for (auto id = workers; id < current; id++) {
+            RetireWorker(id);
+        }
+
+        NAPA_DEBUG("Scheduler", "Removed %u workers, %u workers in total.", current - workers, workers);
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::RetireWorker(WorkerId workerId) {
+        // Pins are taken by tasks running on the worker, and released once a task was scheduled on the worker.
+        // Once both the pins and the pending tasks are gone, nothing can reach the worker anymore.
+        while (true) {
+            while (_workerSlots[workerId].pins > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            // Tasks scheduled through the synchronizer are dispatched by now.
+            WaitForSynchronizer();
+
+            if (_workers[workerId]->GetQueueLength() == 0 && _workerSlots[workerId].pins == 0) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // Shutting down the worker disposes its isolate.
+        _workers[workerId] = nullptr;
+        NAPA_DEBUG("Scheduler", "Worker %u is shut down.", workerId);
+    }
+
+    template <typename WorkerType>
+    SimpleThreadPool& SchedulerImpl<WorkerType>::GetResizer() {
+        std::lock_guard<std::mutex> lock(_resizerLock);
+        if (_resizer == nullptr) {
+            _resizer = std::make_unique<SimpleThreadPool>(1);
+        }
+        return *_resizer;
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::IsSchedulingDone() const {
+        return _beingScheduled[0] == 0 && _beingScheduled[1] == 0 && !HasQueuedTasks() && _rollingTasks == 0;
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::AreWorkersDone() const {
+        // Worker slots only change on the resizer thread.
+        auto workers = _usedSlots.load();
+        for (WorkerId i = 0; i < workers; i++) {
+            if (_workerSlots[i].pins > 0 || (_workers[i] != nullptr && _workers[i]->GetQueueLength() > 0)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::WaitForDrainEvent(const std::function<bool()>& condition, std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(_drainLock);
+        _drainWaiters++;
+
+        auto satisfied = condition();
+        while (!satisfied) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                break;
+            }
+
+            auto wakeUp = deadline - now > DRAIN_CHECK_INTERVAL ? now + DRAIN_CHECK_INTERVAL : deadline;
+            _drainEvent.wait_until(lock, wakeUp);
+            satisfied = condition();
+        }
+
+        _drainWaiters--;
+        return satisfied;
+    }
+
+    template <typename WorkerType>
+    size_t SchedulerImpl<WorkerType>::CancelQueuedTasks(ResultCode code, const std::string& reason) {
+        auto cancel = [this, code, &reason]() {
+            size_t cancelled = 0;
+            auto workers = _usedSlots.load();
+            for (WorkerId i = 0; i < workers; i++) {
+                for (auto task = PickNextTask(i); task != nullptr; task = PickNextTask(i)) {
+                    task->Cancel(code, reason);
+                    cancelled++;
+                }
+            }
+            return cancelled;
+        };
+
+        if (!_synchronized) {
+            return cancel();
+        }
+
+        std::promise<size_t> promise;
+        auto future = promise.get_future();
+        _synchronizer->Execute([&promise, &cancel]() {
+            promise.set_value(cancel());
+        });
+        return future.get();
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::WaitForSynchronizer() {
+        if (_synchronizer == nullptr) {
+            return;
+        }
+
+        std::promise<void> promise;
+        auto future = promise.get_future();
+        _synchronizer->Execute([&promise]() {
+            promise.set_value();
+        });
+        future.wait();
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::MarkIdle(WorkerId workerId) {
+        if (_idleWorkersFlags[workerId] == _idleWorkers.end()) {
+            _idleWorkersFlags[workerId] = _idleWorkers.emplace(_idleWorkers.end(), workerId);
+            _idleWorkerCount++;
+        }
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::UnmarkIdle(WorkerId workerId) {
+        if (_idleWorkersFlags[workerId] != _idleWorkers.end()) {
+            _idleWorkers.erase(_idleWorkersFlags[workerId]);
+            _idleWorkersFlags[workerId] = _idleWorkers.end();
+            _idleWorkerCount--;
+        }
+    }
+
+    template <typename WorkerType>
+    WorkerId SchedulerImpl<WorkerType>::PopIdleWorker() {
+        auto workerId = _idleWorkers.front();
+        UnmarkIdle(workerId);
+        return workerId;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::DispatchOrQueue(size_t lane, size_t tenant, std::shared_ptr<Task> task) {
+        auto idle = !_idleWorkers.empty();
+        WorkerId workerId = 0;
+        if ((!idle && !FindShortWorkerQueue(workerId)) || !_policy->TryAcquire(tenant)) {
+            NAPA_DEBUG("Scheduler", "No worker for the task, putting task to non-scheduled queue with priority %zu.", lane);
+
+            // If there is no worker to take it, or the tenant is at its cap, put the task into the non-scheduled queue.
+            QueueTask(lane, tenant, std::move(task));
+            return;
+        }
+
+        // Pop the worker id from the idle workers list.
+        if (idle) {
+            workerId = PopIdleWorker();
+        }
+
+        // Schedule task on worker
+        _workers[workerId]->Schedule(std::move(task));
+
+        NAPA_DEBUG("Scheduler", "Scheduled task on worker %u.", workerId);
+    }
+
+    template <typename WorkerType>
+    bool SchedulerImpl<WorkerType>::FindShortWorkerQueue(WorkerId& workerId) {
+        // Tasks already waiting in the non-scheduled queue go first, they are handed out as workers become idle.
+        if (_workerQueueDepth == 0 || HasQueuedTasks()) {
+            return false;
+        }
+
+        auto workers = _activeWorkers.load();
+        workerId = _random() % workers;
+        if (workers > 1) {
+            auto other = (workerId + 1 + _random() % (workers - 1)) % workers;
+            if (_workerSlots[workerId].stuck || _workers[other]->GetQueueLength() < _workers[workerId]->GetQueueLength()) {
+                workerId = other;
+            }
+        }
+        return !_workerSlots[workerId].stuck && _workers[workerId]->GetQueueLength() < _workerQueueDepth;
+    }
+
+    template <typename WorkerType>
+    WorkerId SchedulerImpl<WorkerType>::NextQueueWorker(uint32_t workers) {
+        auto workerId = _nextQueue++ % workers;
+
+        // Other workers steal tasks queued on a stuck worker anyway, but only once they run out of their own.
+        for (uint32_t i = 1; i < workers && _workerSlots[workerId].stuck; i++) {
+            workerId = _nextQueue++ % workers;
+        }
+        return workerId;
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::QueueTask(size_t lane, size_t tenant, std::shared_ptr<Task> task) {
+        auto workerId = NextQueueWorker(_activeWorkers.load());
+
+        // Count the task before it becomes visible, so the depth never goes below the actual number of tasks.
+        _queueDepths[lane]++;
+        _policy->Enqueue(lane, tenant, workerId, std::move(task));
+
+        NAPA_DEBUG("Scheduler", "Queued task on worker %u with priority %zu.", workerId, lane);
+        ReportQueueDepth(lane);
+    }
+
+    template <typename WorkerType>
+    std::shared_ptr<Task> SchedulerImpl<WorkerType>::PickNextTask(WorkerId workerId) {
+        // Queues of removed workers are looked at too, so tasks left there are not stranded.
+        auto workers = _usedSlots.load();
+
+        while (true) {
+            size_t lane;
+            auto task = _policy->PickNext(workerId, workers, lane);
+            if (task == nullptr) {
+                return nullptr;
+            }
+
+            _queueDepths[lane]--;
+            ReportQueueDepth(lane);
+
+            if (!_policy->DropsExpiredTasks() || task->GetDeadline() > Clock::Now()) {
+                return task;
+            }
+
+            // Don't waste an isolate on a call that its issuer has already given up on.
+            NAPA_DEBUG("Scheduler", "Dropping a task with priority %zu, its deadline passed while queued.", lane);
+            task->Cancel(NAPA_RESULT_TIMEOUT, "Timed out before execution started");
+        }
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::IdleWorkerNotificationCallback(WorkerId workerId) {
+        NAPA_ASSERT(workerId < _capacity, "worker id out of range");
+
+        if (_drainWaiters > 0) {
+            // Taken so a waiter that just found the scheduler busy is waiting by the time it's signaled.
+            std::lock_guard<std::mutex> lock(_drainLock);
+            _drainEvent.notify_all();
+        }
+
+        if (_shouldStop) {
+            return;
+        }
+
+        if (!_synchronized) {
+            FeedOrParkWorker(workerId);
+            return;
+        }
+
+        _synchronizer->Execute([this, workerId]() {
+            // A removed worker only finishes the tasks it has.
+            if (workerId >= _activeWorkers) {
+                return;
+            }
+
+            // If there is a non scheduled task, schedule the one with highest priority on the idle worker.
+            auto task = PickNextTask(workerId);
+            if (task != nullptr) {
+                _workers[workerId]->Schedule(std::move(task));
+
+                // Fill the queue of the worker up to its depth, so it runs the next tasks without waiting for us.
+                for (size_t queued = 1; queued < _workerQueueDepth; queued++) {
+                    task = PickNextTask(workerId);
+                    if (task == nullptr) {
+                        break;
+                    }
+                    _workers[workerId]->Schedule(std::move(task));
+                }
+
+                NAPA_DEBUG("Scheduler", "Worker %u fetched a task from non-scheduled queue", workerId);
+                return;
+            }
+
+            // Put worker in idle list.
+            MarkIdle(workerId);
+            NAPA_DEBUG("Scheduler", "Worker %u becomes idle", workerId);
+        });
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::FeedOrParkWorker(WorkerId workerId) {
+        // A removed worker only finishes the tasks it has.
+        if (workerId >= _activeWorkers) {
+            return;
+        }
+
+        while (true) {
+            auto task = PickNextTask(workerId);
+            if (task != nullptr) {
+                _workers[workerId]->Schedule(std::move(task));
+                return;
+            }
+
+            _workerSlots[workerId].idle = true;
+            NAPA_DEBUG("Scheduler", "Worker %u becomes idle", workerId);
+
+            // A task may have been queued after we looked at the queues but before the worker was marked idle.
+            // Try to claim the worker back, unless another thread already did and fed it.
+            if (!HasQueuedTasks()) {
+                return;
+            }
+
+            auto expected = true;
+            if (!_workerSlots[workerId].idle.compare_exchange_strong(expected, false)) {
+                return;
+            }
+        }
+    }
+
+    template <typename WorkerType>
+    void SchedulerImpl<WorkerType>::WakeIdleWorker() {
+        auto workers = _activeWorkers.load();
+        auto start = _nextQueue.load() % workers;
+
+        for (WorkerId i = 0; i < workers; i++) {
+            auto workerId = (start + i) % workers;
+
+            auto expected = true;
+            if (_workerSlots[workerId].idle.compare_exchange_strong(expected, false)) {
+                FeedOrParkWorker(workerId);
+                return;
+            }
+        }
+    }
 }
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "scheduling-policy.h"
+
+#include <utils/debug.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+bool SchedulingPolicy::DropsExpiredTasks() const {
+    return false;
+}
+
+bool SchedulingPolicy::SharesByTenant() const {
+    return false;
+}
+
+void SchedulingPolicy::AddTenant(uint32_t /*weight*/, uint32_t /*maxConcurrency*/) {}
+
+bool SchedulingPolicy::TryAcquire(size_t /*tenant*/) {
+    return true;
+}
+
+void SchedulingPolicy::Release(size_t /*tenant*/) {}
+
+FifoPolicy::FifoPolicy(size_t lanes) : _tasks(lanes) {}
+
+bool FifoPolicy::IsSynchronized() const {
+    return true;
+}
+
+bool FifoPolicy::SharesByTenant() const {
+    return true;
+}
+
+void FifoPolicy::AddTenant(uint32_t weight, uint32_t maxConcurrency) {
+    _tasks.AddTenant(weight, maxConcurrency);
+}
+
+bool FifoPolicy::TryAcquire(size_t tenant) {
+    return _tasks.TryAcquire(tenant);
+}
+
+void FifoPolicy::Release(size_t tenant) {
+    _tasks.Release(tenant);
+}
+
+void FifoPolicy::Enqueue(size_t lane, size_t tenant, uint32_t /*workerId*/, std::shared_ptr<Task> task) {
+    _tasks.Push(lane, tenant, std::move(task));
+}
+
+std::shared_ptr<Task> FifoPolicy::PickNext(uint32_t /*workerId*/, uint32_t /*workers*/, size_t& lane) {
+    return _tasks.Pop(lane);
+}
+
+DeadlinePolicy::DeadlinePolicy(size_t lanes) : _tasks(lanes) {}
+
+bool DeadlinePolicy::IsSynchronized() const {
+    return true;
+}
+
+bool DeadlinePolicy::DropsExpiredTasks() const {
+    return true;
+}
+
+void DeadlinePolicy::Enqueue(size_t lane, size_t /*tenant*/, uint32_t /*workerId*/, std::shared_ptr<Task> task) {
+    auto deadline = task->GetDeadline();
+    _tasks[lane].emplace(deadline, std::move(task));
+}
+
+std::shared_ptr<Task> DeadlinePolicy::PickNext(uint32_t /*workerId*/, uint32_t /*workers*/, size_t& lane) {
+    for (lane = 0; lane < _tasks.size(); lane++) {
+        auto& tasks = _tasks[lane];
+        if (!tasks.empty()) {
+            auto task = std::move(tasks.begin()->second);
+            tasks.erase(tasks.begin());
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+WorkStealingPolicy::WorkStealingPolicy(size_t lanes, uint32_t capacity) :
+    _queues(std::make_unique<WorkerQueue[]>(capacity)),
+    _counts(std::make_unique<std::atomic<size_t>[]>(lanes)),
+    _lanes(lanes) {
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        _queues[i].lanes.resize(lanes);
+    }
+    for (size_t lane = 0; lane < lanes; lane++) {
+        _counts[lane] = 0;
+    }
+}
+
+bool WorkStealingPolicy::IsSynchronized() const {
+    return false;
+}
+
+void WorkStealingPolicy::Enqueue(size_t lane, size_t /*tenant*/, uint32_t workerId, std::shared_ptr<Task> task) {
+    std::lock_guard<std::mutex> lock(_queues[workerId].lock);
+    _queues[workerId].lanes[lane].emplace_back(std::move(task));
+    _counts[lane]++;
+}
+
+std::shared_ptr<Task> WorkStealingPolicy::PickNext(uint32_t workerId, uint32_t workers, size_t& lane) {
+    for (lane = 0; lane < _lanes; lane++) {
+        if (_counts[lane] == 0) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < workers; i++) {
+            auto queueId = (workerId + i) % workers;
+            auto& tasks = _queues[queueId].lanes[lane];
+
+            std::lock_guard<std::mutex> lock(_queues[queueId].lock);
+            if (tasks.empty()) {
+                continue;
+            }
+
+            std::shared_ptr<Task> task;
+            if (queueId == workerId) {
+                // Own queue, keep FIFO order.
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            } else {
+                // Steal from the opposite end to reduce contention with the owner.
+                task = std::move(tasks.back());
+                tasks.pop_back();
+
+                NAPA_DEBUG("Scheduler", "Worker %u stole a task from worker %u.", workerId, queueId);
+            }
+            _counts[lane]--;
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<SchedulingPolicy> zone::CreateSchedulingPolicy(settings::SchedulerType type, size_t lanes, uint32_t capacity) {
+    switch (type) {
+        case settings::SchedulerType::WORK_STEALING:
+            return std::make_unique<WorkStealingPolicy>(lanes, capacity);
+        case settings::SchedulerType::EARLIEST_DEADLINE:
+            return std::make_unique<DeadlinePolicy>(lanes);
+        default:
+            return std::make_unique<FifoPolicy>(lanes);
+    }
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "fair-share-queue.h"
+#include "task.h"
+
+#include <settings/settings.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Decides the order in which queued tasks run, while SchedulerImpl owns the workers, wakeups and idle tracking. </summary>
+    /// <remarks>
+    ///     The scheduler first hands a task to an idle worker if there is one, and only queues it with the policy otherwise.
+    ///     A worker that ran out of tasks asks the policy for the next one, and is marked idle if there is none.
+    ///     Lanes are priorities, the first lane holding the highest priority.
+    /// </remarks>
+    class SchedulingPolicy {
+    public:
+        virtual ~SchedulingPolicy() = default;
+
+        /// <summary>
+        /// Whether all calls to the policy are serialized on the synchronizer thread of the scheduler, which then keeps
+        /// the list of idle workers. Otherwise the policy is called from any thread and does its own locking, and
+        /// workers are claimed by their idle flags.
+        /// </summary>
+        virtual bool IsSynchronized() const = 0;
+
+        /// <summary> Whether tasks whose deadline passed while queued are cancelled rather than run. </summary>
+        virtual bool DropsExpiredTasks() const;
+
+        /// <summary> Whether tasks are queued per tenant, see FairShareQueue. Otherwise tasks are scheduled without tenant. </summary>
+        virtual bool SharesByTenant() const;
+
+        /// <summary> Adds a tenant, only called if the policy shares by tenant. </summary>
+        /// <param name="weight"> The number of tasks of each turn of the tenant, at least 1. </param>
+        /// <param name="maxConcurrency"> The maximum number of running tasks of the tenant, 0 for no cap. </param>
+        virtual void AddTenant(uint32_t weight, uint32_t maxConcurrency);
+
+        /// <summary> Counts a task of a tenant as running, for a task handed to an idle worker without being queued. </summary>
+        /// <returns> False if the tenant is at its cap, then the task is queued. </returns>
+        virtual bool TryAcquire(size_t tenant);
+
+        /// <summary> Ends a running task of a tenant with a cap, counted by PickNext() or TryAcquire(). </summary>
+        virtual void Release(size_t tenant);
+
+        /// <summary> Queues a task that no idle worker took. </summary>
+        /// <param name="lane"> The priority lane of the task. </param>
+        /// <param name="tenant"> The tenant of the task, 0 for none. </param>
+        /// <param name="workerId"> The worker picked round robin by the scheduler, for policies that queue tasks per worker. </param>
+        /// <param name="task"> The task. </param>
+        virtual void Enqueue(size_t lane, size_t tenant, uint32_t workerId, std::shared_ptr<Task> task) = 0;
+
+        /// <summary> Takes the next task for a worker that ran out of tasks. </summary>
+        /// <param name="workerId"> The worker. </param>
+        /// <param name="workers"> The number of worker slots whose queues may hold tasks, including removed workers. </param>
+        /// <param name="lane"> Receives the lane of the task. </param>
+        /// <returns> The task, nullptr if there is none the worker may run. </returns>
+        virtual std::shared_ptr<Task> PickNext(uint32_t workerId, uint32_t workers, size_t& lane) = 0;
+    };
+
+    /// <summary> The 'synchronized' policy: a single queue, served by priority and in FIFO order, shared by tenants by weight. </summary>
+    class FifoPolicy : public SchedulingPolicy {
+    public:
+        explicit FifoPolicy(size_t lanes);
+
+        bool IsSynchronized() const override;
+        bool SharesByTenant() const override;
+        void AddTenant(uint32_t weight, uint32_t maxConcurrency) override;
+        bool TryAcquire(size_t tenant) override;
+        void Release(size_t tenant) override;
+        void Enqueue(size_t lane, size_t tenant, uint32_t workerId, std::shared_ptr<Task> task) override;
+        std::shared_ptr<Task> PickNext(uint32_t workerId, uint32_t workers, size_t& lane) override;
+
+    private:
+        FairShareQueue _tasks;
+    };
+
+    /// <summary> The 'earliestDeadline' policy: a single queue, served by priority and then by deadline. </summary>
+    /// <remarks> Equal deadlines keep FIFO order, tasks without deadline go last. Expired tasks are dropped. </remarks>
+    class DeadlinePolicy : public SchedulingPolicy {
+    public:
+        explicit DeadlinePolicy(size_t lanes);
+
+        bool IsSynchronized() const override;
+        bool DropsExpiredTasks() const override;
+        void Enqueue(size_t lane, size_t tenant, uint32_t workerId, std::shared_ptr<Task> task) override;
+        std::shared_ptr<Task> PickNext(uint32_t workerId, uint32_t workers, size_t& lane) override;
+
+    private:
+        std::vector<std::multimap<std::chrono::steady_clock::time_point, std::shared_ptr<Task>>> _tasks;
+    };
+
+    /// <summary> The 'workStealing' policy: a queue per worker, which workers that ran out of tasks steal from. </summary>
+    /// <remarks>
+    ///     A worker takes tasks from the front of its own queue, and steals from the back of the queues of its peers.
+    ///     Higher priority tasks are taken first, even if they have to be stolen.
+    /// </remarks>
+    class WorkStealingPolicy : public SchedulingPolicy {
+    public:
+        /// <summary> Constructor. </summary>
+        /// <param name="lanes"> The number of priority lanes. </param>
+        /// <param name="capacity"> The maximum number of workers. </param>
+        WorkStealingPolicy(size_t lanes, uint32_t capacity);
+
+        bool IsSynchronized() const override;
+        void Enqueue(size_t lane, size_t tenant, uint32_t workerId, std::shared_ptr<Task> task) override;
+        std::shared_ptr<Task> PickNext(uint32_t workerId, uint32_t workers, size_t& lane) override;
+
+    private:
+        struct WorkerQueue {
+            /// <summary> Tasks queued on the worker per lane. </summary>
+            std::vector<std::deque<std::shared_ptr<Task>>> lanes;
+            std::mutex lock;
+        };
+
+        std::unique_ptr<WorkerQueue[]> _queues;
+
+        /// <summary> Number of queued tasks per lane, so empty lanes are skipped without locking the queues. </summary>
+        std::unique_ptr<std::atomic<size_t>[]> _counts;
+        size_t _lanes;
+    };
+
+    /// <summary> Creates the policy of a scheduler type. </summary>
+    /// <param name="type"> The scheduler type of the zone settings. </param>
+    /// <param name="lanes"> The number of priority lanes. </param>
+    /// <param name="capacity"> The maximum number of workers. </param>
+    std::unique_ptr<SchedulingPolicy> CreateSchedulingPolicy(settings::SchedulerType type, size_t lanes, uint32_t capacity);
+}
+}
@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "shared-thread-pool.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace napa;
+using namespace napa::zone;
+
+constexpr size_t SharedThreadPool::DEFAULT_STACK_SIZE;
+
+namespace {
+    std::atomic<uint32_t> configuredThreads(0);
+    std::atomic<bool> instanceStarted(false);
+}
+
+SharedThreadPool& SharedThreadPool::GetInstance() {
+    // Never destroyed, like the workers of zones that may still run on it at process exit.
+    static SharedThreadPool* instance = [] {
+        instanceStarted = true;
+        return new SharedThreadPool(configuredThreads);
+    }();
+    return *instance;
+}
+
+void SharedThreadPool::Configure(uint32_t threads) {
+    if (!instanceStarted) {
+        configuredThreads = threads;
+    }
+}
+
+SharedThreadPool::SharedThreadPool(uint32_t threads, size_t stackSize) :
+    _stackSize(stackSize), _nextThread(0), _stopping(false), _migrations(0) {
+
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    std::lock_guard<std::mutex> lock(_lock);
+    for (uint32_t i = 0; i < threads; ++i) {
+        _threads.emplace_back(std::make_unique<Thread>());
+    }
+    for (size_t i = 0; i < _threads.size(); ++i) {
+        _threads[i]->thread = platform::Thread([this, i]() { ThreadFunc(i); }, _stackSize);
+    }
+}
+
+SharedThreadPool::~SharedThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stopping = true;
+        for (auto& thread : _threads) {
+            thread->idle = false;
+            thread->wakeEvent.notify_one();
+        }
+    }
+
+    for (auto& thread : _threads) {
+        thread->thread.Join();
+    }
+}
+
+void SharedThreadPool::Notify(std::shared_ptr<Runnable> runnable) {
+    std::lock_guard<std::mutex> lock(_lock);
+    switch (runnable->_state) {
+        case Runnable::State::IDLE:
+            runnable->_state = Runnable::State::QUEUED;
+            Push(std::move(runnable));
+            break;
+        case Runnable::State::RUNNING:
+            runnable->_state = Runnable::State::NOTIFIED;
+            break;
+        default:
+            break;
+    }
+}
+
+uint32_t SharedThreadPool::GetThreadCount() const {
+    return static_cast<uint32_t>(_threads.size());
+}
+
+size_t SharedThreadPool::GetStackSize() const {
+    return _stackSize;
+}
+
+uint64_t SharedThreadPool::GetMigrations() const {
+    return _migrations;
+}
+
+void SharedThreadPool::ThreadFunc(size_t index) {
+    auto& self = *_threads[index];
+
+    std::unique_lock<std::mutex> lock(_lock);
+    while (!_stopping) {
+        auto runnable = Take(index);
+        if (runnable == nullptr) {
+            self.idle = true;
+            self.wakeEvent.wait(lock, [this, &self]() { return !self.idle || _stopping; });
+            self.idle = false;
+            continue;
+        }
+
+        runnable->_state = Runnable::State::RUNNING;
+        if (runnable->_thread != index) {
+            runnable->_thread = index;
+            _migrations++;
+        }
+
+        lock.unlock();
+        auto more = runnable->Run();
+        lock.lock();
+
+        if (more || runnable->_state == Runnable::State::NOTIFIED) {
+            runnable->_state = Runnable::State::QUEUED;
+            self.queue.emplace_back(std::move(runnable));
+        } else {
+            runnable->_state = Runnable::State::IDLE;
+        }
+    }
+}
+
+void SharedThreadPool::Push(std::shared_ptr<Runnable> runnable) {
+    // New runnables are spread round-robin, later turns go back to the thread of the last one.
+    if (!runnable->_placed) {
+        runnable->_thread = _nextThread++ % _threads.size();
+        runnable->_placed = true;
+    }
+
+    auto& home = *_threads[runnable->_thread];
+    home.queue.emplace_back(std::move(runnable));
+    if (home.idle) {
+        home.idle = false;
+        home.wakeEvent.notify_one();
+        return;
+    }
+
+    // The home thread is busy, an idle thread takes the runnable over rather than leaving it waiting.
+    for (auto& thread : _threads) {
+        if (thread->idle) {
+            thread->idle = false;
+            thread->wakeEvent.notify_one();
+            return;
+        }
+    }
+}
+
+std::shared_ptr<SharedThreadPool::Runnable> SharedThreadPool::Take(size_t index) {
+    std::shared_ptr<Runnable> runnable;
+
+    auto& queue = _threads[index]->queue;
+    if (!queue.empty()) {
+        runnable = std::move(queue.front());
+        queue.pop_front();
+        return runnable;
+    }
+
+    // The runnable queued last on the busiest thread would wait the longest there.
+    Thread* victim = nullptr;
+    for (auto& thread : _threads) {
+        if (!thread->queue.empty() && (victim == nullptr || thread->queue.size() > victim->queue.size())) {
+            victim = thread.get();
+        }
+    }
+    if (victim != nullptr) {
+        runnable = std::move(victim->queue.back());
+        victim->queue.pop_back();
+    }
+    return runnable;
+}
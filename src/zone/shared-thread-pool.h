@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <platform/os.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Pool of threads that runnables take turns on, e.g. the workers of zones with the 'sharedThreads' setting. </summary>
+    /// <remarks>
+    ///     A runnable is queued when it's notified, and runs on one thread at a time. It's queued on the thread that ran
+    ///     it last, whose caches likely still hold its data, unless that thread is busy while another one is idle, which
+    ///     then takes it over. Idle threads also steal queued runnables from busy ones. A runnable that has more work
+    ///     after its turn queues behind the other runnables of its thread.
+    /// </remarks>
+    class SharedThreadPool {
+    public:
+
+        /// <summary> Stack size in bytes of the threads of the process-wide instance. </summary>
+        static constexpr size_t DEFAULT_STACK_SIZE = 8 * 1024 * 1024;
+
+        /// <summary> Work that runs in turns on the threads of the pool. </summary>
+        class Runnable {
+        public:
+            virtual ~Runnable() = default;
+
+            /// <summary> Runs a turn on a thread of the pool. </summary>
+            /// <returns> True if it has more work, to be queued again. </returns>
+            virtual bool Run() = 0;
+
+        private:
+            friend class SharedThreadPool;
+
+            enum class State {
+                IDLE,
+                QUEUED,
+                RUNNING,
+
+                /// <summary> Notified while running, it's queued again after its turn. </summary>
+                NOTIFIED
+            };
+
+            State _state = State::IDLE;
+
+            /// <summary> The thread that ran it last, or the thread it was first queued on. </summary>
+            size_t _thread = 0;
+            bool _placed = false;
+        };
+
+        /// <summary> Gets the process-wide instance, which starts its threads on first use. It's never destroyed. </summary>
+        static SharedThreadPool& GetInstance();
+
+        /// <summary> Sets the number of threads of the process-wide instance, 0 for the number of processors. </summary>
+        /// <remarks> It has no effect once the instance started. </remarks>
+        static void Configure(uint32_t threads);
+
+        /// <summary> Starts the threads. </summary>
+        /// <param name="threads"> The number of threads, 0 for the number of processors. </param>
+        /// <param name="stackSize"> The stack size in bytes of the threads. </param>
+        explicit SharedThreadPool(uint32_t threads, size_t stackSize = DEFAULT_STACK_SIZE);
+
+        /// <summary> Stops the threads once their runnables finished their turn. Queued runnables are dropped. </summary>
+        ~SharedThreadPool();
+
+        SharedThreadPool(const SharedThreadPool&) = delete;
+        SharedThreadPool& operator=(const SharedThreadPool&) = delete;
+
+        /// <summary> Queues a runnable for a turn, unless it's queued already. A running one gets another turn. </summary>
+        void Notify(std::shared_ptr<Runnable> runnable);
+
+        /// <summary> Gets the number of threads. </summary>
+        uint32_t GetThreadCount() const;
+
+        /// <summary> Gets the stack size in bytes of the threads. </summary>
+        size_t GetStackSize() const;
+
+        /// <summary> Gets the number of turns taken on another thread than the last turn of the runnable. </summary>
+        uint64_t GetMigrations() const;
+
+    private:
+
+        /// <summary> A thread and the runnables queued on it. </summary>
+        struct Thread {
+            std::deque<std::shared_ptr<Runnable>> queue;
+            std::condition_variable wakeEvent;
+            bool idle = false;
+            platform::Thread thread;
+        };
+
+        void ThreadFunc(size_t index);
+
+        /// <summary> Queues a runnable on its thread, waking an idle thread to run it. Called under the lock. </summary>
+        void Push(std::shared_ptr<Runnable> runnable);
+
+        /// <summary> Takes a runnable queued on a thread, or stolen from the busiest other thread. Called under the lock. </summary>
+        std::shared_ptr<Runnable> Take(size_t index);
+
+        mutable std::mutex _lock;
+        std::vector<std::unique_ptr<Thread>> _threads;
+        size_t _stackSize;
+        size_t _nextThread;
+        bool _stopping;
+        std::atomic<uint64_t> _migrations;
+    };
+}
+}
@@ -3,50 +3,48 @@
 
 #include "simple-thread-pool.h"
 
-using namespace napa::zone;
+#include <napa/assert.h>
 
-SimpleThreadPool::Worker::Worker(SimpleThreadPool& pool) : _pool(pool) {}
+using namespace napa::zone;
 
-void SimpleThreadPool::Worker::operator()() {
-    std::function<void()> task;
+namespace {
+    /// <summary> Number of times an idle worker looks for a job before parking. </summary>
+    constexpr uint32_t SPIN_COUNT = 64;
+}
 
-    while (true) {
-        {
-            std::unique_lock<std::mutex> lock(_pool._queueLock);
-            if (!_pool._isStopped) {
-                _pool._queueCondition.wait(lock, [this]() {
-                    return _pool._isStopped || !_pool._taskQueue.empty();
-                });
-            }
+SimpleThreadPool::SimpleThreadPool(uint32_t numberOfWorkers, size_t capacity) :
+    _enqueuePosition(0),
+    _dequeuePosition(0),
+    _overflowSize(0),
+    _parkedWorkers(0),
+    _isStopped(false) {
 
-            // Drain all existing tasks before actually stopping.
-            if (_pool._isStopped && _pool._taskQueue.empty()) {
-                break;
-            }
+    NAPA_ASSERT(capacity > 0, "Thread pool capacity must be greater than 0");
 
-            task = std::move(_pool._taskQueue.front());
-            _pool._taskQueue.pop();
-        }
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
 
-        task();
+    _mask = size - 1;
+    _ring = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+        _ring[i].sequence.store(i, std::memory_order_relaxed);
     }
-}
 
-SimpleThreadPool::SimpleThreadPool(uint32_t numberOfWorkers) : _isStopped(false) {
     _workers.reserve(numberOfWorkers);
-
     for (uint32_t i = 0; i < numberOfWorkers; ++i) {
-        _workers.emplace_back(Worker(*this));
+        _workers.emplace_back([this]() { WorkerLoop(); });
     }
 }
 
 SimpleThreadPool::~SimpleThreadPool() {
     {
-        std::unique_lock<std::mutex> lock(_queueLock);
+        std::lock_guard<std::mutex> lock(_parkLock);
         _isStopped = true;
     }
 
-    _queueCondition.notify_all();
+    _parkEvent.notify_all();
 
     for (auto& thread : _workers) {
         if (thread.joinable()) {
@@ -54,3 +52,137 @@ SimpleThreadPool::~SimpleThreadPool() {
         }
     }
 }
+
+void SimpleThreadPool::Enqueue(Job job) {
+    // Once jobs overflow, follow them until the overflow is drained, so a single worker keeps the order.
+    if (_overflowSize.load(std::memory_order_acquire) > 0 || !TryEnqueueToRing(job)) {
+        std::lock_guard<std::mutex> lock(_overflowLock);
+        _overflow.emplace_back(std::move(job));
+        _overflowSize++;
+    }
+
+    // Pairs with the fence in WorkerLoop(), either the worker sees the job or we see the worker parked.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_parkedWorkers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(_parkLock);
+        _parkEvent.notify_one();
+    }
+}
+
+bool SimpleThreadPool::TryDequeue(Job& job) {
+    if (TryDequeueFromRing(job)) {
+        return true;
+    }
+
+    if (_overflowSize.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(_overflowLock);
+        if (!_overflow.empty()) {
+            job = std::move(_overflow.front());
+            _overflow.pop_front();
+            _overflowSize--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SimpleThreadPool::TryEnqueueToRing(Job& job) {
+    auto position = _enqueuePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    while (true) {
+        cell = &_ring[position & _mask];
+        auto sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (diff == 0) {
+            if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The ring is full.
+            return false;
+        } else {
+            position = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->job = std::move(job);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool SimpleThreadPool::TryDequeueFromRing(Job& job) {
+    auto position = _dequeuePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    while (true) {
+        cell = &_ring[position & _mask];
+        auto sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+        if (diff == 0) {
+            if (_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The ring is empty, or the producer of this slot hasn't finished writing yet.
+            return false;
+        } else {
+            position = _dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    job = std::move(cell->job);
+    cell->sequence.store(position + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+void SimpleThreadPool::WorkerLoop() {
+    Job job;
+
+    while (true) {
+        if (TryDequeue(job)) {
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        // Jobs tend to come in bursts, spin shortly before paying for parking and waking up.
+        bool found = false;
+        for (uint32_t i = 0; i < SPIN_COUNT && !found; ++i) {
+            std::this_thread::yield();
+            found = TryDequeue(job);
+        }
+
+        if (found) {
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_parkLock);
+        _parkedWorkers++;
+
+        // Look again after advertising the parked state, a producer may have enqueued in the meantime
+        // without seeing us parked.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (TryDequeue(job)) {
+            _parkedWorkers--;
+            lock.unlock();
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        // Drain all existing jobs before actually stopping.
+        if (_isStopped) {
+            _parkedWorkers--;
+            break;
+        }
+
+        _parkEvent.wait(lock);
+        _parkedWorkers--;
+    }
+}
@@ -3,10 +3,13 @@
 
 #pragma once
 
+#include <utils/unique-function.h>
+
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <deque>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <stdint.h>
 #include <thread>
 #include <utility>
@@ -16,63 +19,91 @@ namespace napa {
 namespace zone {
 
     /// <summary> Simple thread pool. </summary>
+    /// <remarks>
+    ///     Jobs are move-only closures kept inline in a bounded lock-free ring, so executing a small closure
+    ///     neither allocates nor takes a lock, unless the ring is full, in which case jobs go to a locked overflow
+    ///     queue. Idle workers spin shortly, then park on a condition variable, which producers only signal when a worker is parked.
+    ///     With a single worker, jobs run in the order they were executed.
+    /// </remarks>
     class SimpleThreadPool {
     public:
 
+        /// <summary> A job to run on a worker. </summary>
+        typedef napa::utils::UniqueFunction<void()> Job;
+
         /// <summary> Constructor. </summary>
         /// <param name="numberOfWorkers"> Number of workers. </param>
-        explicit SimpleThreadPool(uint32_t numberOfWorkers);
+        /// <param name="capacity"> Capacity of the lock-free ring, rounded up to a power of 2. </param>
+        explicit SimpleThreadPool(uint32_t numberOfWorkers, size_t capacity = 256);
 
-        /// <summary> Destructor. </summary>
+        /// <summary> Destructor. Runs all remaining jobs before the workers stop. </summary>
         virtual ~SimpleThreadPool();
 
         /// <summary> Execute the given function in one of the workers. </summary>
-        /// <param name="function"> Function to run. </param>
-        /// <param name="args"> Arguments for function. </param>
-        template <typename T, typename... Args>
-        void Execute(T&& function, Args&&... args);
+        /// <param name="function"> Function to run, which takes no arguments and is moved into the pool. </param>
+        template <typename Function>
+        void Execute(Function&& function) {
+            Enqueue(Job(std::forward<Function>(function)));
+        }
 
     private:
 
-        /// <summary> Class for worker main loop. </summary>
-        class Worker {
-        public:
+        /// <summary> Enqueues a job and wakes up a parked worker. </summary>
+        void Enqueue(Job job);
+
+        /// <summary> Tries to dequeue a job, from the ring first. </summary>
+        bool TryDequeue(Job& job);
 
-            /// <summary> Constructor. </summary>
-            Worker(SimpleThreadPool& pool);
+        /// <summary> Tries to enqueue a job into the ring. </summary>
+        bool TryEnqueueToRing(Job& job);
 
-            /// <summary> Main thread function. </summary>
-            void operator()();
+        /// <summary> Tries to dequeue a job from the ring. </summary>
+        bool TryDequeueFromRing(Job& job);
 
-        private:
+        /// <summary> Worker main loop. </summary>
+        void WorkerLoop();
 
-            /// <summary> Thread pool instance. </summary>
-            SimpleThreadPool& _pool;
+        /// <summary> A slot of the ring. </summary>
+        struct Cell {
+            /// <summary> Sequence number to coordinate producers and consumers on this slot. </summary>
+            std::atomic<size_t> sequence;
+
+            /// <summary> The job. </summary>
+            Job job;
         };
 
-        std::vector<std::thread> _workers;
-        std::queue<std::function<void()>> _taskQueue;
+        /// <summary> The ring buffer. </summary>
+        std::unique_ptr<Cell[]> _ring;
 
-        /// <summary> Critical section and event for task queue. </summary>
-        std::mutex _queueLock;
-        std::condition_variable _queueCondition;
+        /// <summary> Mask to map a position to a slot. </summary>
+        size_t _mask;
 
-        /// <summary> Flag to stop threads. </summary>
-        bool _isStopped;
-    };
+        /// <summary> Next position to enqueue, shared by producers. </summary>
+        std::atomic<size_t> _enqueuePosition;
 
+        /// <summary> Next position to dequeue, shared by workers. </summary>
+        std::atomic<size_t> _dequeuePosition;
 
-    template <typename T, typename... Args>
-    void SimpleThreadPool::Execute(T&& function, Args&&... args) {
-        auto task = std::bind(std::forward<T>(function), std::forward<Args>(args)...);
+        /// <summary> Jobs that didn't fit into the ring. </summary>
+        std::deque<Job> _overflow;
 
-        {
-            std::unique_lock<std::mutex> lock(_queueLock);
-            _taskQueue.emplace(task);
-        }
+        /// <summary> Number of jobs in overflow queue. Checked without lock. </summary>
+        std::atomic<size_t> _overflowSize;
+
+        /// <summary> Lock for overflow queue. </summary>
+        std::mutex _overflowLock;
+
+        /// <summary> Number of workers that are parked or about to park. </summary>
+        std::atomic<uint32_t> _parkedWorkers;
+
+        /// <summary> Lock and event to park workers. </summary>
+        std::mutex _parkLock;
+        std::condition_variable _parkEvent;
 
-        _queueCondition.notify_one();
-    }
+        /// <summary> Flag to stop threads. </summary>
+        std::atomic<bool> _isStopped;
 
+        std::vector<std::thread> _workers;
+    };
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "slow-call-log.h"
+
+#include <algorithm>
+
+using namespace napa::zone;
+
+SlowCallLog::SlowCallLog(std::chrono::milliseconds threshold, uint32_t sampleRate, size_t capacity, size_t payloadBytes) :
+    _threshold(threshold),
+    _sampleRate(sampleRate),
+    _capacity(std::max<size_t>(capacity, 1)),
+    _payloadBytes(payloadBytes),
+    _calls(0),
+    _next(0) {
+    _ring.reserve(_capacity);
+}
+
+bool SlowCallLog::Sample() {
+    return _sampleRate > 0 && _calls.fetch_add(1, std::memory_order_relaxed) % _sampleRate == 0;
+}
+
+void SlowCallLog::Record(
+    const char* module,
+    const char* function,
+    uint32_t workerId,
+    ResultCode code,
+    bool sampled,
+    Clock::time_point start,
+    const PhaseEnds& ends,
+    const std::vector<StringRef>& arguments) {
+
+    auto duration = ends[static_cast<size_t>(CallPhase::COMPLETED)];
+    if (!sampled && (_threshold.count() == 0 || duration < _threshold.count())) {
+        return;
+    }
+
+    // Phases not reached end where the phase after them does, except unmarshall, which calls marshalled in
+    // JavaScript skip and which ends where it started. A call rejected while queued ends all its phases at once.
+    auto end = [&ends](CallPhase phase) {
+        return ends[static_cast<size_t>(phase)];
+    };
+    auto finished = end(CallPhase::FINISHED) >= 0 ? end(CallPhase::FINISHED) : duration;
+    auto dequeued = end(CallPhase::DEQUEUED) >= 0 ? end(CallPhase::DEQUEUED) : finished;
+    auto unmarshalled = end(CallPhase::UNMARSHALLED) >= 0 ? end(CallPhase::UNMARSHALLED) : dequeued;
+    auto executed = end(CallPhase::EXECUTED) >= 0 ? end(CallPhase::EXECUTED) : finished;
+
+    // Phases are marked by different threads, e.g. a timeout rejects a call while it runs, so clamp them in order.
+    auto span = [](int64_t from, int64_t to) {
+        return static_cast<uint64_t>(std::max<int64_t>(to - from, 0));
+    };
+
+    SlowCall call;
+    call.module = module;
+    call.function = function;
+    call.workerId = workerId;
+    call.code = code;
+    call.sampled = sampled;
+    call.queueTime = span(0, dequeued);
+    call.unmarshallTime = span(dequeued, unmarshalled);
+    call.executionTime = span(std::max(dequeued, unmarshalled), executed);
+    call.marshallTime = span(std::max({ dequeued, unmarshalled, executed }), finished);
+    call.completionTime = span(std::max({ dequeued, unmarshalled, executed, finished }), duration);
+
+    // The start is converted to wall clock time through the time elapsed since.
+    auto sinceStart = Clock::Now() - start;
+    auto startTime = std::chrono::system_clock::now() - std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceStart);
+    call.startTime = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(startTime.time_since_epoch()).count());
+
+    call.argumentSizes.reserve(arguments.size());
+    auto payloadBytes = _payloadBytes;
+    for (const auto& argument : arguments) {
+        call.argumentSizes.push_back(argument.size);
+        if (_payloadBytes > 0) {
+            auto size = std::min(argument.size, payloadBytes);
+            call.arguments.emplace_back(argument.data, size);
+            payloadBytes -= size;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_ring.size() < _capacity) {
+        _ring.push_back(std::move(call));
+    } else {
+        _ring[_next] = std::move(call);
+        _next = (_next + 1) % _capacity;
+    }
+}
+
+std::vector<napa::SlowCall> SlowCallLog::GetCalls() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<SlowCall> calls;
+    calls.reserve(_ring.size());
+    calls.insert(calls.end(), _ring.begin() + _next, _ring.end());
+    calls.insert(calls.end(), _ring.begin(), _ring.begin() + _next);
+    return calls;
+}
@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "clock.h"
+
+#include <napa/exports.h>
+#include <napa/types.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Points a call passes as it runs, each ending a phase of the slow-call log. </summary>
+    enum class CallPhase : uint8_t {
+
+        /// <summary> A worker picked the call up, ending its queue wait. </summary>
+        DEQUEUED,
+
+        /// <summary> Arguments were parsed, only for calls dispatched natively. </summary>
+        UNMARSHALLED,
+
+        /// <summary> The function returned, or the promise it returned was fulfilled. </summary>
+        EXECUTED,
+
+        /// <summary> The call was resolved with its marshalled result, or rejected. </summary>
+        FINISHED,
+
+        /// <summary> The callback of the caller returned. </summary>
+        COMPLETED,
+
+        COUNT
+    };
+
+    /// <summary> Nano-seconds from the creation of a call to the end of each phase, negative for phases not reached. </summary>
+    typedef std::array<int64_t, static_cast<size_t>(CallPhase::COUNT)> PhaseEnds;
+
+    /// <summary> The most recent calls of a zone that were slow, or sampled, with the time they spent in each phase. </summary>
+    /// <remarks>
+    ///     Calls are kept when they took longer than the threshold from Execute() to completion, and 1 in every N calls
+    ///     is kept however long it took, both optional. The log is a ring, the oldest call is overwritten when it's full.
+    ///     A phase not reached takes no time, e.g. a call rejected while queued spends its whole duration queued.
+    ///     Calls going through lib/transport in JavaScript don't report unmarshall and marshall apart, which counts
+    ///     them in their execution. Arguments are kept up to a total number of bytes, which is 0 to keep their sizes only.
+    ///     Zones time the phases of calls only when the log is on, and only copy the calls the log keeps.
+    /// </remarks>
+    class NAPA_API SlowCallLog {
+    public:
+
+        /// <summary> Constructor. </summary>
+        /// <param name="threshold"> Duration beyond which calls are kept, 0 to keep sampled calls only. </param>
+        /// <param name="sampleRate"> Keep 1 in every N calls, 0 to keep slow calls only. </param>
+        /// <param name="capacity"> The number of calls kept. </param>
+        /// <param name="payloadBytes"> Bytes of arguments kept with each call. </param>
+        SlowCallLog(std::chrono::milliseconds threshold, uint32_t sampleRate, size_t capacity, size_t payloadBytes);
+
+        /// <summary> Non-copyable. </summary>
+        SlowCallLog(const SlowCallLog&) = delete;
+        SlowCallLog& operator=(const SlowCallLog&) = delete;
+
+        /// <summary> Counts a new call, returning whether it's sampled. </summary>
+        bool Sample();
+
+        /// <summary> Records a completed call, if it was sampled or slow. </summary>
+        /// <param name="module"> The module name of the call. </param>
+        /// <param name="function"> The function name of the call. </param>
+        /// <param name="workerId"> The worker which ran the call, UINT32_MAX if none did. </param>
+        /// <param name="code"> The result code of the call. </param>
+        /// <param name="sampled"> Whether Sample() returned true for the call. </param>
+        /// <param name="start"> The time the call was created. </param>
+        /// <param name="ends"> The end of each phase, COMPLETED must be reached. </param>
+        /// <param name="arguments"> The marshalled arguments of the call. </param>
+        void Record(
+            const char* module,
+            const char* function,
+            uint32_t workerId,
+            ResultCode code,
+            bool sampled,
+            Clock::time_point start,
+            const PhaseEnds& ends,
+            const std::vector<StringRef>& arguments);
+
+        /// <summary> Gets the calls kept, oldest first. </summary>
+        std::vector<SlowCall> GetCalls() const;
+
+    private:
+        const std::chrono::nanoseconds _threshold;
+        const uint32_t _sampleRate;
+        const size_t _capacity;
+        const size_t _payloadBytes;
+
+        /// <summary> Calls counted by Sample(). </summary>
+        std::atomic<uint64_t> _calls;
+
+        /// <summary> The ring of calls, and the index the next call is written at once it's full. </summary>
+        std::vector<SlowCall> _ring;
+        size_t _next;
+        mutable std::mutex _mutex;
+    };
+}
+}
@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "stream-channel.h"
+
+#include <napa/assert.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+StreamChannel::StreamChannel(size_t capacity) :
+    _capacity(capacity > 0 ? capacity : 1),
+    _ended(false),
+    _cancelled(false) {}
+
+StreamChannel::WriteStatus StreamChannel::Write(std::unique_ptr<Chunk> chunk) {
+    NAPA_ASSERT(chunk != nullptr, "Chunk should not be null");
+
+    ReadCallback read;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_ended) {
+            return WriteStatus::CLOSED;
+        }
+
+        if (_pendingRead == nullptr) {
+            _chunks.emplace_back(std::move(chunk));
+            return _chunks.size() < _capacity ? WriteStatus::READY : WriteStatus::FULL;
+        }
+
+        // A pending read means the queue is empty, the chunk goes to the reader directly.
+        read = std::move(_pendingRead);
+        _pendingRead = nullptr;
+    }
+
+    read(std::move(chunk), std::string());
+    return WriteStatus::READY;
+}
+
+void StreamChannel::WaitWritable(WritableCallback callback) {
+    bool open;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        open = !_ended;
+        if (open && _chunks.size() >= _capacity) {
+            _pendingWritable = std::move(callback);
+            return;
+        }
+    }
+
+    callback(open);
+}
+
+void StreamChannel::End(std::string error) {
+    ReadCallback read;
+    WritableCallback writable;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_ended) {
+            return;
+        }
+
+        _ended = true;
+        _error = std::move(error);
+
+        read = std::move(_pendingRead);
+        _pendingRead = nullptr;
+        writable = std::move(_pendingWritable);
+        _pendingWritable = nullptr;
+    }
+
+    if (read != nullptr) {
+        read(nullptr, _error);
+    }
+    if (writable != nullptr) {
+        writable(false);
+    }
+}
+
+void StreamChannel::Read(ReadCallback callback) {
+    std::unique_ptr<Chunk> chunk;
+    std::string error;
+    WritableCallback writable;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        NAPA_ASSERT(_pendingRead == nullptr, "There can be only one pending read on a stream channel");
+
+        if (_chunks.empty()) {
+            if (!_ended) {
+                _pendingRead = std::move(callback);
+                return;
+            }
+            error = _error;
+        } else {
+            chunk = std::move(_chunks.front());
+            _chunks.pop_front();
+
+            if (_chunks.size() < _capacity) {
+                writable = std::move(_pendingWritable);
+                _pendingWritable = nullptr;
+            }
+        }
+    }
+
+    if (writable != nullptr) {
+        writable(true);
+    }
+    callback(std::move(chunk), error);
+}
+
+void StreamChannel::Cancel() {
+    ReadCallback read;
+    WritableCallback writable;
+    std::deque<std::unique_ptr<Chunk>> chunks;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _cancelled = true;
+        _ended = true;
+        _chunks.swap(chunks);
+
+        read = std::move(_pendingRead);
+        _pendingRead = nullptr;
+        writable = std::move(_pendingWritable);
+        _pendingWritable = nullptr;
+    }
+
+    if (read != nullptr) {
+        read(nullptr, std::string());
+    }
+    if (writable != nullptr) {
+        writable(false);
+    }
+}
+
+bool StreamChannel::IsClosed() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _ended;
+}
+
+size_t StreamChannel::GetSize() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _chunks.size();
+}
+
+size_t StreamChannel::GetCapacity() const {
+    return _capacity;
+}
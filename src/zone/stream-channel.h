@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/transport/transport-context.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Bounded queue of marshalled chunks, streamed from a zone function to its caller. </summary>
+    /// <remarks>
+    ///     There is one writer, the zone function, and one reader, the caller, on different isolates.
+    ///     Neither side blocks: a read on an empty channel, and a wait on a full one, complete through callbacks
+    ///     that are called from the thread of the other side, or inline if they can be served right away.
+    ///     It's exposed in napa.dll, so channels can be shared by Node and Napa isolates.
+    /// </remarks>
+    class NAPA_API StreamChannel {
+    public:
+
+        /// <summary> A marshalled chunk. </summary>
+        struct Chunk {
+            /// <summary> JSON string, or binary payload, from marshalled JS value. </summary>
+            std::string payload;
+
+            /// <summary> Whether payload is in binary transport format. </summary>
+            bool binary = false;
+
+            /// <summary> TransportContext that is needed to unmarshall the JS value. </summary>
+            napa::transport::TransportContext transportContext;
+        };
+
+        /// <summary> Status of the channel after a write. </summary>
+        enum class WriteStatus {
+            /// <summary> The chunk is queued, and there is room for more. </summary>
+            READY,
+
+            /// <summary> The chunk is queued, and the channel is full. </summary>
+            FULL,
+
+            /// <summary> The chunk is dropped, since the channel is ended or cancelled. </summary>
+            CLOSED
+        };
+
+        /// <summary> Callback of a read, with a null chunk at the end of stream, and an error message if the stream failed. </summary>
+        typedef std::function<void(std::unique_ptr<Chunk>, const std::string&)> ReadCallback;
+
+        /// <summary> Callback of a wait for room, false if the channel is closed meanwhile. </summary>
+        typedef std::function<void(bool)> WritableCallback;
+
+        /// <summary> Constructor. </summary>
+        /// <param name="capacity"> Number of chunks that can be queued before the channel is full. </param>
+        explicit StreamChannel(size_t capacity);
+
+        /// <summary> Non-copyable. </summary>
+        StreamChannel(const StreamChannel&) = delete;
+        StreamChannel& operator=(const StreamChannel&) = delete;
+
+        /// <summary> Queues a chunk, or hands it to a pending read. </summary>
+        WriteStatus Write(std::unique_ptr<Chunk> chunk);
+
+        /// <summary> Calls back once the channel has room for a chunk, or is closed. </summary>
+        void WaitWritable(WritableCallback callback);
+
+        /// <summary> Ends the stream. Queued chunks are still read. No-op if already ended. </summary>
+        /// <param name="error"> Error message if the stream failed, empty otherwise. </param>
+        void End(std::string error = std::string());
+
+        /// <summary> Reads the next chunk. There can be only one pending read. </summary>
+        void Read(ReadCallback callback);
+
+        /// <summary> Stops the stream from the reader side, queued chunks are dropped and later writes are closed. </summary>
+        void Cancel();
+
+        /// <summary> Whether the channel accepts no more writes. </summary>
+        bool IsClosed() const;
+
+        /// <summary> Gets the number of queued chunks. </summary>
+        size_t GetSize() const;
+
+        /// <summary> Gets the number of chunks that can be queued before the channel is full. </summary>
+        size_t GetCapacity() const;
+
+    private:
+        size_t _capacity;
+        std::deque<std::unique_ptr<Chunk>> _chunks;
+        bool _ended;
+        bool _cancelled;
+        std::string _error;
+        ReadCallback _pendingRead;
+        WritableCallback _pendingWritable;
+        mutable std::mutex _lock;
+    };
+}
+}
@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "sync-wait.h"
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+    thread_local PendingWork threadPendingWork;
+}
+
+void napa::zone::SetPendingWork(PendingWork pendingWork) {
+    threadPendingWork = std::move(pendingWork);
+}
+
+PendingWork napa::zone::GetPendingWork() {
+    return threadPendingWork;
+}
+
+void napa::zone::RunPendingWork() {
+    if (threadPendingWork) {
+        // Pending work may set the pending work of the thread, e.g. the completion of a worker's last async work.
+        auto pendingWork = threadPendingWork;
+        pendingWork();
+    }
+}
@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "clock.h"
+
+#include <napa/exports.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Work posted to a thread, which it runs while waiting for a synchronous call, e.g. completions of async work. </summary>
+    typedef std::function<void()> PendingWork;
+
+    /// <summary> Sets the pending work of the calling thread, nullptr to clear it. </summary>
+    NAPA_API void SetPendingWork(PendingWork pendingWork);
+
+    /// <summary> Gets the pending work of the calling thread, e.g. to move it to another thread along with its worker. </summary>
+    NAPA_API PendingWork GetPendingWork();
+
+    /// <summary> Runs the pending work of the calling thread, if it has any. </summary>
+    NAPA_API void RunPendingWork();
+
+    /// <summary> Result of a call made synchronously, which is set from any thread and waited for on the calling thread. </summary>
+    /// <remarks>
+    ///     The calling thread doesn't run what is posted to it while it waits, though the call may wait for it, e.g. a
+    ///     function of a zone that calls the Node zone back. The waiter runs the pending work of its thread every
+    ///     millisecond to avoid the deadlock, and gives up after the timeout, leaving the call to finish unattended.
+    ///     It's shared with the callback of the call, which may outlive the wait.
+    /// </remarks>
+    template <typename ResultType>
+    class SyncResult {
+    public:
+
+        SyncResult() : _done(false) {}
+
+        SyncResult(const SyncResult&) = delete;
+        SyncResult& operator=(const SyncResult&) = delete;
+
+        /// <summary> Sets the result. Called from any thread. </summary>
+        void Set(ResultType result) {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _result = std::move(result);
+                _done = true;
+            }
+            _doneEvent.notify_all();
+        }
+
+        /// <summary> Waits for the result, running the pending work of the calling thread meanwhile. </summary>
+        /// <param name="timeout"> The maximum time to wait, 0 to wait without bound. </param>
+        /// <param name="result"> Receives the result, which is moved out. </param>
+        /// <param name="waitTime"> Receives how long it waited. </param>
+        /// <returns> False if it timed out. </returns>
+        bool Wait(std::chrono::milliseconds timeout, ResultType& result, std::chrono::nanoseconds& waitTime) {
+            const auto slice = std::chrono::milliseconds(1);
+
+            auto start = Clock::Now();
+            auto deadline = timeout.count() > 0 ? start + timeout : std::chrono::steady_clock::time_point::max();
+
+            std::unique_lock<std::mutex> lock(_lock);
+            while (!_done) {
+                auto now = Clock::Now();
+                if (now >= deadline) {
+                    break;
+                }
+
+                // Pending work may set the result, or call and wait itself, so it runs without the lock.
+                lock.unlock();
+                RunPendingWork();
+                lock.lock();
+
+                if (!_done) {
+                    _doneEvent.wait_until(lock, deadline - now > slice ? now + slice : deadline);
+                }
+            }
+
+            waitTime = Clock::Now() - start;
+            if (!_done) {
+                return false;
+            }
+            result = std::move(_result);
+            return true;
+        }
+
+    private:
+        std::mutex _lock;
+        std::condition_variable _doneEvent;
+        bool _done;
+        ResultType _result;
+    };
+}
+}
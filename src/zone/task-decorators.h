@@ -3,10 +3,13 @@
 
 #pragma once
 
+#include "clock.h"
 #include "task.h"
 #include "terminable-task.h"
 #include "timer.h"
 
+#include <platform/process.h>
+
 #include <v8.h>
 
 #include <chrono>
@@ -22,6 +25,14 @@ namespace zone {
         template <typename... Args>
         TaskDecorator(Args&&... args) : _innerTask(std::forward<Args>(args)...) {}
 
+        std::chrono::steady_clock::time_point GetDeadline() const override {
+            return _innerTask.GetDeadline();
+        }
+
+        void Cancel(ResultCode code, const std::string& reason) override {
+            _innerTask.Cancel(code, reason);
+        }
+
     protected:
         TaskType _innerTask;
     };
@@ -31,25 +42,59 @@ namespace zone {
     public:
         static_assert(std::is_base_of<TerminableTask, TaskType>::value, "TaskType must inherit from TerminableTask");
 
+        /// <summary> Constructor. </summary>
+        /// <param name="timeout"> Wall clock time the task may take since it was created, 0 for infinite. </param>
+        /// <param name="cpuTimeout"> CPU time the task may consume once it runs, 0 for infinite. </param>
         template <typename... Args>
-        TimeoutTaskDecorator(std::chrono::milliseconds timeout, Args&&... args) :
+        TimeoutTaskDecorator(std::chrono::milliseconds timeout, std::chrono::milliseconds cpuTimeout, Args&&... args) :
             TaskDecorator<TaskType>(std::forward<Args>(args)...),
-            _timeout(timeout) {}
+            _timeout(timeout),
+            _cpuTimeout(cpuTimeout),
+            _deadline(Clock::Now() + timeout) {}
+
+        /// <summary> The caller gives up once the timeout elapsed since the task was created. </summary>
+        std::chrono::steady_clock::time_point GetDeadline() const override {
+            return _timeout.count() > 0 ? _deadline : this->_innerTask.GetDeadline();
+        }
 
         void Execute() override {
             auto isolate = v8::Isolate::GetCurrent();
 
-            // RAII - timer will automatically stop upon destruction.
-            napa::zone::Timer timer([this, isolate]() {
-                this->_innerTask.Terminate(TerminationReason::TIMEOUT, isolate);
-            }, _timeout);
-            timer.Start();
+            // RAII - timers will automatically stop upon destruction.
+            std::unique_ptr<napa::zone::Timer> timer;
+            if (_timeout.count() > 0) {
+                timer = std::make_unique<napa::zone::Timer>([this, isolate]() {
+                    this->_innerTask.Terminate(TerminationReason::TIMEOUT, isolate);
+                }, _timeout);
+                timer->Start();
+            }
+
+            // The CPU time of the worker thread is sampled from the timer thread. A thread can't consume more CPU
+            // time than wall time, so the timer is rearmed after the budget left, and a preempted or GC paused
+            // task is checked rarely.
+            std::unique_ptr<napa::zone::Timer> cpuTimer;
+            if (_cpuTimeout.count() > 0) {
+                auto clock = platform::GetCurrentThreadCpuClock();
+                auto start = platform::GetThreadCpuTime(clock);
+                auto budget = std::chrono::duration_cast<std::chrono::nanoseconds>(_cpuTimeout).count();
+                cpuTimer = std::make_unique<napa::zone::Timer>(_cpuTimeout, [this, isolate, clock, start, budget]() {
+                    auto left = budget - (platform::GetThreadCpuTime(clock) - start);
+                    if (left <= 0) {
+                        this->_innerTask.Terminate(TerminationReason::CPU_TIMEOUT, isolate);
+                        return std::chrono::milliseconds(0);
+                    }
+                    return std::chrono::milliseconds(left / 1000000 + 1);
+                });
+                cpuTimer->Start();
+            }
 
             this->_innerTask.Execute();
         }
 
     private:
         std::chrono::milliseconds _timeout;
+        std::chrono::milliseconds _cpuTimeout;
+        std::chrono::steady_clock::time_point _deadline;
     };
 }
 }
\ No newline at end of file
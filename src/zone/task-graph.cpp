@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "task-graph.h"
+
+using namespace napa;
+using namespace napa::zone;
+
+constexpr uint32_t TaskGraph::NO_FAILURE;
+
+bool TaskGraph::Validate(uint32_t nodeCount, const std::vector<Edge>& edges, std::string& error) {
+    std::vector<uint32_t> pendingInputs(nodeCount, 0);
+    std::vector<std::vector<uint32_t>> successors(nodeCount);
+    for (auto& edge : edges) {
+        if (edge.first >= nodeCount || edge.second >= nodeCount) {
+            error = "Edge [" + std::to_string(edge.first) + ", " + std::to_string(edge.second)
+                + "] refers to a node out of " + std::to_string(nodeCount) + " nodes";
+            return false;
+        }
+        successors[edge.first].push_back(edge.second);
+        ++pendingInputs[edge.second];
+    }
+
+    // Nodes left after removing nodes without inputs one by one are on a cycle.
+    std::vector<uint32_t> ready;
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        if (pendingInputs[node] == 0) {
+            ready.push_back(node);
+        }
+    }
+    uint32_t removed = 0;
+    while (!ready.empty()) {
+        auto node = ready.back();
+        ready.pop_back();
+        ++removed;
+        for (auto successor : successors[node]) {
+            if (--pendingInputs[successor] == 0) {
+                ready.push_back(successor);
+            }
+        }
+    }
+    if (removed != nodeCount) {
+        for (uint32_t node = 0; node < nodeCount; ++node) {
+            if (pendingInputs[node] != 0) {
+                error = "Node " + std::to_string(node) + " depends on itself through a cycle of edges";
+                break;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+TaskGraph::TaskGraph(uint32_t nodeCount, const std::vector<Edge>& edges, StartNode start, CompletionCallback callback) :
+    _start(std::move(start)),
+    _callback(std::move(callback)),
+    _predecessors(nodeCount),
+    _successors(nodeCount),
+    _pendingInputs(new std::atomic<uint32_t>[nodeCount]),
+    _results(nodeCount),
+    _unfinished(nodeCount),
+    _failedNode(NO_FAILURE) {
+
+    for (uint32_t node = 0; node < nodeCount; ++node) {
+        _pendingInputs[node] = 0;
+    }
+    for (auto& edge : edges) {
+        _predecessors[edge.second].push_back(edge.first);
+        _successors[edge.first].push_back(edge.second);
+        ++_pendingInputs[edge.second];
+    }
+}
+
+void TaskGraph::Run() {
+    if (_results.empty()) {
+        _callback(std::vector<Result>(), NO_FAILURE);
+        return;
+    }
+
+    // Roots are collected first, since nodes they ready may be started by their completion while roots are started.
+    std::vector<uint32_t> roots;
+    for (uint32_t node = 0; node < _results.size(); ++node) {
+        if (_pendingInputs[node] == 0) {
+            roots.push_back(node);
+        }
+    }
+    for (auto node : roots) {
+        Start(node);
+    }
+}
+
+void TaskGraph::Start(uint32_t node) {
+    Inputs inputs;
+    inputs.reserve(_predecessors[node].size());
+    for (auto predecessor : _predecessors[node]) {
+        inputs.push_back(&_results[predecessor]);
+    }
+
+    auto self = shared_from_this();
+    _start(node, inputs, [self, node](Result result) {
+        self->Finish(node, std::move(result));
+    });
+}
+
+void TaskGraph::Finish(uint32_t node, Result result) {
+    if (result.code != NAPA_RESULT_SUCCESS) {
+        auto expected = NO_FAILURE;
+        _failedNode.compare_exchange_strong(expected, node);
+    }
+    _results[node] = std::move(result);
+
+    // Skipped nodes finish along with the node, which readies the nodes depending on them in turn.
+    std::vector<uint32_t> finished = { node };
+    std::vector<uint32_t> ready;
+    while (!finished.empty()) {
+        auto current = finished.back();
+        finished.pop_back();
+
+        for (auto successor : _successors[current]) {
+            // The last input readies the node, after the results of all its inputs were written.
+            if (_pendingInputs[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                continue;
+            }
+            auto failedNode = _failedNode.load();
+            if (failedNode == NO_FAILURE) {
+                ready.push_back(successor);
+            } else {
+                auto& skipped = _results[successor];
+                skipped.code = NAPA_RESULT_CANCELLED;
+                skipped.errorMessage = "Skipped since node " + std::to_string(failedNode) + " failed";
+                finished.push_back(successor);
+            }
+        }
+
+        if (_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _callback(std::move(_results), _failedNode.load());
+            return;
+        }
+    }
+
+    for (auto successor : ready) {
+        Start(successor);
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/types.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Calls with dependencies among them, each started once all calls it depends on succeeded. </summary>
+    /// <remarks>
+    ///     Dependency counts are kept in the graph, and the completion of a call starts the calls it readied on the
+    ///     thread it completed on, i.e. the worker that ran it, so the caller only hears of the graph once it's done.
+    ///     Once a call fails, calls that aren't started yet are skipped, and the graph completes when the calls
+    ///     already running finish. It's exposed in napa.dll, so Node isolates can run graphs of their zones.
+    /// </remarks>
+    class NAPA_API TaskGraph : public std::enable_shared_from_this<TaskGraph> {
+    public:
+
+        /// <summary> An edge from the node it's listed first to the node depending on it. </summary>
+        typedef std::pair<uint32_t, uint32_t> Edge;
+
+        /// <summary> Results of the nodes a node depends on, in order of the edges to it. </summary>
+        typedef std::vector<const Result*> Inputs;
+
+        /// <summary> Starts the call of a node, which reports its result to the callback on any thread. </summary>
+        typedef std::function<void(uint32_t node, const Inputs& inputs, ExecuteCallback callback)> StartNode;
+
+        /// <summary> Receives the results of all nodes in order of nodes, and the index of the node that failed if any. </summary>
+        typedef std::function<void(std::vector<Result> results, uint32_t failedNode)> CompletionCallback;
+
+        /// <summary> Index of the failed node when no node failed. </summary>
+        static constexpr uint32_t NO_FAILURE = static_cast<uint32_t>(-1);
+
+        /// <summary> Checks that edges refer to nodes and don't form a cycle. </summary>
+        /// <param name="error"> Receives the reason of an invalid graph. </param>
+        static bool Validate(uint32_t nodeCount, const std::vector<Edge>& edges, std::string& error);
+
+        /// <summary> Constructor, of a graph whose edges are validated. </summary>
+        TaskGraph(uint32_t nodeCount, const std::vector<Edge>& edges, StartNode start, CompletionCallback callback);
+
+        /// <summary> Non-copyable. </summary>
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        /// <summary> Starts the nodes that depend on none, an empty graph completes right away. </summary>
+        void Run();
+
+    private:
+        /// <summary> Starts a node whose inputs are all ready. </summary>
+        void Start(uint32_t node);
+
+        /// <summary> Records the result of a node, and starts or skips the nodes it readied. </summary>
+        void Finish(uint32_t node, Result result);
+
+        StartNode _start;
+        CompletionCallback _callback;
+
+        /// <summary> Nodes each node depends on, in order of edges, and nodes depending on it. </summary>
+        std::vector<std::vector<uint32_t>> _predecessors;
+        std::vector<std::vector<uint32_t>> _successors;
+
+        /// <summary> Inputs of each node that aren't ready yet. </summary>
+        std::unique_ptr<std::atomic<uint32_t>[]> _pendingInputs;
+
+        /// <summary> Written once per node, before the nodes depending on it are readied. </summary>
+        std::vector<Result> _results;
+
+        std::atomic<uint32_t> _unfinished;
+        std::atomic<uint32_t> _failedNode;
+    };
+}
+}
@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "task-queue.h"
+#include "clock.h"
+
+#include <napa/assert.h>
+
+#include <thread>
+
+using namespace napa::zone;
+
+TaskQueue::TaskQueue(size_t capacity) :
+    _enqueuePosition(0),
+    _dequeuePosition(0),
+    _overflowSize(0),
+    _parked(false),
+    _closed(false) {
+
+    NAPA_ASSERT(capacity > 0, "Task queue capacity must be greater than 0");
+
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    _mask = size - 1;
+    _ring = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+        _ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+void TaskQueue::Push(std::shared_ptr<Task> task) {
+    NAPA_ASSERT(task != nullptr, "Task should not be null");
+
+    // Once a task overflowed, the ring is only reused when the overflow drained, as the ring is popped first.
+    if (_overflowSize.load(std::memory_order_acquire) > 0 || !TryPushToRing(task)) {
+        std::lock_guard<std::mutex> lock(_overflowLock);
+        _overflow.emplace_back(std::move(task));
+        _overflowSize++;
+    }
+
+    Unpark();
+}
+
+bool TaskQueue::TryPop(std::shared_ptr<Task>& task) {
+    if (TryPopFromRing(task)) {
+        return true;
+    }
+
+    if (_overflowSize.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(_overflowLock);
+        if (!_overflow.empty()) {
+            task = std::move(_overflow.front());
+            _overflow.pop_front();
+            _overflowSize--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t TaskQueue::TryPopBatch(std::vector<std::shared_ptr<Task>>& tasks, size_t maxTasks) {
+    size_t popped = 0;
+    std::shared_ptr<Task> task;
+    while (popped < maxTasks && TryPopFromRing(task)) {
+        tasks.emplace_back(std::move(task));
+        popped++;
+    }
+
+    // Tasks that overflowed are taken under a single lock acquisition.
+    if (popped < maxTasks && _overflowSize.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(_overflowLock);
+        while (popped < maxTasks && !_overflow.empty()) {
+            tasks.emplace_back(std::move(_overflow.front()));
+            _overflow.pop_front();
+            _overflowSize--;
+            popped++;
+        }
+    }
+
+    return popped;
+}
+
+bool TaskQueue::TrySpinPop(std::shared_ptr<Task>& task, std::chrono::microseconds duration) {
+    auto deadline = Clock::Now() + duration;
+
+    do {
+        if (TryPop(task)) {
+            return true;
+        }
+
+        if (_closed) {
+            return false;
+        }
+
+        std::this_thread::yield();
+    } while (Clock::Now() < deadline);
+
+    return false;
+}
+
+bool TaskQueue::TryPopFor(std::shared_ptr<Task>& task, std::chrono::microseconds timeout) {
+    auto deadline = Clock::Now() + timeout;
+
+    while (true) {
+        if (TryPop(task)) {
+            return true;
+        }
+
+        if (_closed) {
+            return TryPop(task);
+        }
+
+        std::unique_lock<std::mutex> lock(_parkLock);
+        _parked = true;
+
+        // Same handshake with producers as Pop().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (TryPop(task)) {
+            _parked = false;
+            return true;
+        }
+
+        if (_closed) {
+            _parked = false;
+            continue;
+        }
+
+        if (!_parkEvent.wait_until(lock, deadline, [this]() { return !_parked; })) {
+            _parked = false;
+            return TryPop(task);
+        }
+    }
+}
+
+std::shared_ptr<Task> TaskQueue::Pop() {
+    std::shared_ptr<Task> task;
+
+    while (true) {
+        if (TryPop(task)) {
+            return task;
+        }
+
+        if (_closed) {
+            // Catch tasks that were pushed before the queue was closed.
+            return TryPop(task) ? task : nullptr;
+        }
+
+        std::unique_lock<std::mutex> lock(_parkLock);
+        _parked = true;
+
+        // Look again after advertising the parked state, a producer may have pushed in the meantime
+        // without seeing us parked.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (TryPop(task)) {
+            _parked = false;
+            return task;
+        }
+
+        if (_closed) {
+            _parked = false;
+            continue;
+        }
+
+        _parkEvent.wait(lock, [this]() { return !_parked; });
+    }
+}
+
+void TaskQueue::Close() {
+    _closed = true;
+    Unpark();
+}
+
+bool TaskQueue::IsClosed() const {
+    return _closed;
+}
+
+size_t TaskQueue::Size() const {
+    auto dequeuePosition = _dequeuePosition.load(std::memory_order_relaxed);
+    auto enqueuePosition = _enqueuePosition.load(std::memory_order_relaxed);
+    auto ringSize = enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+
+    return ringSize + _overflowSize.load(std::memory_order_relaxed);
+}
+
+bool TaskQueue::TryPushToRing(std::shared_ptr<Task>& task) {
+    auto position = _enqueuePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    while (true) {
+        cell = &_ring[position & _mask];
+        auto sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (diff == 0) {
+            if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The ring is full.
+            return false;
+        } else {
+            position = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->task = std::move(task);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool TaskQueue::TryPopFromRing(std::shared_ptr<Task>& task) {
+    auto position = _dequeuePosition.load(std::memory_order_relaxed);
+    auto& cell = _ring[position & _mask];
+    auto sequence = cell.sequence.load(std::memory_order_acquire);
+
+    if (sequence != position + 1) {
+        // The ring is empty, or the producer of this slot hasn't finished writing yet.
+        return false;
+    }
+
+    task = std::move(cell.task);
+    cell.sequence.store(position + _mask + 1, std::memory_order_release);
+    _dequeuePosition.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void TaskQueue::Unpark() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_parked) {
+        std::lock_guard<std::mutex> lock(_parkLock);
+        _parked = false;
+        _parkEvent.notify_one();
+    }
+}
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "task.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Multiple-producer, single-consumer task queue of a worker. </summary>
+    /// <remarks>
+    ///     Tasks are kept in a bounded lock-free ring, producers never take a lock unless the ring is full,
+    ///     in which case the task goes to a locked overflow queue. Tasks keep going to the overflow queue until
+    ///     it drained, so tasks of a producer are dequeued in order. The consumer only sleeps on a condition
+    ///     variable when the queue is truly empty, and producers only signal it when the consumer is parked.
+    /// </remarks>
+    class TaskQueue {
+    public:
+
+        /// <summary> Constructor. </summary>
+        /// <param name="capacity"> Capacity of the lock-free ring, rounded up to a power of 2. </param>
+        explicit TaskQueue(size_t capacity = 1024);
+
+        /// <summary> Non-copyable. </summary>
+        TaskQueue(const TaskQueue&) = delete;
+        TaskQueue& operator=(const TaskQueue&) = delete;
+
+        /// <summary> Enqueues a task. Can be called from any thread. </summary>
+        /// <param name="task"> Task to enqueue, must not be null. </param>
+        void Push(std::shared_ptr<Task> task);
+
+        /// <summary> Dequeues a task without blocking. Must be called from the consumer thread only. </summary>
+        /// <param name="task"> Out parameter that receives the task. </param>
+        /// <returns> True if a task was dequeued, false if the queue is empty. </returns>
+        bool TryPop(std::shared_ptr<Task>& task);
+
+        /// <summary> Dequeues the queued tasks, up to a maximum, without blocking. Must be called from the consumer thread only. </summary>
+        /// <param name="tasks"> Receives the tasks, appended in the order they would have been dequeued one at a time. </param>
+        /// <param name="maxTasks"> The maximum number of tasks to dequeue. </param>
+        /// <returns> The number of tasks dequeued. </returns>
+        size_t TryPopBatch(std::vector<std::shared_ptr<Task>>& tasks, size_t maxTasks);
+
+        /// <summary> Busy-waits for a task for a limited time without parking. Must be called from the consumer thread only. </summary>
+        /// <param name="task"> Out parameter that receives the task. </param>
+        /// <param name="duration"> How long to spin before giving up. </param>
+        /// <returns> True if a task was dequeued while spinning, false otherwise. </returns>
+        bool TrySpinPop(std::shared_ptr<Task>& task, std::chrono::microseconds duration);
+
+        /// <summary> Parks the consumer until a task is available or a timeout expires. Must be called from the consumer thread only. </summary>
+        /// <param name="task"> Out parameter that receives the task. </param>
+        /// <param name="timeout"> How long to wait for a task. </param>
+        /// <returns> True if a task was dequeued, false on timeout or if the queue is closed and fully drained. </returns>
+        bool TryPopFor(std::shared_ptr<Task>& task, std::chrono::microseconds timeout);
+
+        /// <summary> Dequeues a task, parks the consumer until one is available. Must be called from the consumer thread only. </summary>
+        /// <returns> The task, or nullptr if the queue is closed and fully drained. </returns>
+        std::shared_ptr<Task> Pop();
+
+        /// <summary> Closes the queue. Pop() returns nullptr once all remaining tasks are drained. </summary>
+        void Close();
+
+        /// <summary> Whether the queue is closed. Can be called from any thread. </summary>
+        bool IsClosed() const;
+
+        /// <summary> Gets the approximate number of queued tasks. Can be called from any thread. </summary>
+        size_t Size() const;
+
+    private:
+
+        /// <summary> Tries to enqueue a task into the ring. </summary>
+        bool TryPushToRing(std::shared_ptr<Task>& task);
+
+        /// <summary> Tries to dequeue a task from the ring. </summary>
+        bool TryPopFromRing(std::shared_ptr<Task>& task);
+
+        /// <summary> Wakes up the consumer if it's parked. </summary>
+        void Unpark();
+
+        /// <summary> A slot of the ring. </summary>
+        struct Cell {
+            /// <summary> Sequence number to coordinate producers and consumer on this slot. </summary>
+            std::atomic<size_t> sequence;
+
+            /// <summary> The task. </summary>
+            std::shared_ptr<Task> task;
+        };
+
+        /// <summary> The ring buffer. </summary>
+        std::unique_ptr<Cell[]> _ring;
+
+        /// <summary> Mask to map a position to a slot. </summary>
+        size_t _mask;
+
+        /// <summary> Next position to enqueue, shared by producers. </summary>
+        std::atomic<size_t> _enqueuePosition;
+
+        /// <summary> Next position to dequeue, only written by the consumer. </summary>
+        std::atomic<size_t> _dequeuePosition;
+
+        /// <summary> Tasks that didn't fit into the ring. </summary>
+        std::deque<std::shared_ptr<Task>> _overflow;
+
+        /// <summary> Number of tasks in overflow queue. Checked without lock by the consumer. </summary>
+        std::atomic<size_t> _overflowSize;
+
+        /// <summary> Lock for overflow queue. </summary>
+        std::mutex _overflowLock;
+
+        /// <summary> Whether the consumer is parked or about to park. </summary>
+        std::atomic<bool> _parked;
+
+        /// <summary> Whether the queue is closed. </summary>
+        std::atomic<bool> _closed;
+
+        /// <summary> Lock and event to park the consumer. </summary>
+        std::mutex _parkLock;
+        std::condition_variable _parkEvent;
+    };
+}
+}
@@ -3,6 +3,11 @@
 
 #pragma once
 
+#include <napa/types.h>
+
+#include <chrono>
+#include <string>
+
 namespace napa {
 namespace zone {
 
@@ -13,6 +18,16 @@ namespace zone {
         /// <summary> Executes the task. </summary>
         virtual void Execute() = 0;
 
+        /// <summary> Gets the time after which running the task is pointless. Default is no deadline. </summary>
+        virtual std::chrono::steady_clock::time_point GetDeadline() const {
+            return std::chrono::steady_clock::time_point::max();
+        }
+
+        /// <summary> Completes the task without executing it, e.g. when it's dropped by the scheduler. </summary>
+        /// <param name="code"> The result code reported to the task issuer. </param>
+        /// <param name="reason"> The reason of cancellation. </param>
+        virtual void Cancel(ResultCode /*code*/, const std::string& /*reason*/) {}
+
         /// <summary> Virtual destructor. </summary>
         virtual ~Task() = default;
     };
@@ -15,7 +15,8 @@ namespace zone {
     /// <summary> Specifies the possible reasons for termination. </summary>
     enum class TerminationReason {
         UNKNOWN,
-        TIMEOUT
+        TIMEOUT,
+        CPU_TIMEOUT
     };
 
     /// <summary> Base class for tasks that can be terminated. </summary>
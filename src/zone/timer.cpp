@@ -2,56 +2,248 @@
 // Licensed under the MIT license.
 
 #include "timer.h"
+#include "clock.h"
 
 #include <napa/log.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <limits>
 #include <mutex>
-#include <queue>
-#include <stack>
 #include <thread>
 
-#include <iostream>
-
 using namespace napa::zone;
 
-struct TimerInfo {
-    bool active;
-    std::chrono::milliseconds timeout;
-    Timer::Callback callback;
-};
+namespace {
 
-struct ActiveTimerEntry {
-    Timer::Index index;
-    std::chrono::high_resolution_clock::time_point expirationTime;
-};
+    /// <summary> Each wheel level has 64 slots, a level covers 64 ticks of the level below. </summary>
+    constexpr uint32_t SLOT_BITS = 6;
+    constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+    constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+    /// <summary> 4 levels of 1 millisecond ticks cover about 4.6 hours, longer timers are re-cascaded from the top level. </summary>
+    constexpr uint32_t LEVELS = 4;
+    constexpr uint64_t MAX_DELTA = (1ull << (SLOT_BITS * LEVELS)) - 1;
+
+    /// <summary> Number of shards, threads are assigned to shards round robin. </summary>
+    constexpr size_t SHARDS = 16;
+
+    constexpr uint64_t NO_TICK = std::numeric_limits<uint64_t>::max();
+}
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Hierarchical timing wheel of the timers created by a subset of threads. All methods require the lock. </summary>
+    class TimerShard {
+    public:
+
+        TimerShard() : _nextTick(0), _count(0) {
+            std::fill(&_slots[0][0], &_slots[0][0] + LEVELS * SLOTS, nullptr);
+        }
+
+        /// <summary> Adds a timer that is not active. </summary>
+        void Add(Timer& timer, uint64_t now) {
+            if (_count == 0) {
+                // Nothing to process in ticks elapsed while the shard was empty.
+                _nextTick = std::max(_nextTick, now);
+            }
+            Link(timer);
+        }
+
+        /// <summary> Removes an active timer. </summary>
+        void Remove(Timer& timer) {
+            Unlink(timer);
+        }
+
+        /// <summary> Fires timers that expired by the given tick. </summary>
+        /// <returns> The number of timers that fired. </returns>
+        size_t Advance(uint64_t now) {
+            size_t fired = 0;
+
+            while (_count > 0 && _nextTick <= now) {
+                auto index = _nextTick & SLOT_MASK;
+                if (index == 0) {
+                    // Move the timers of the next slot of upper levels down, once lower levels went full circle.
+                    for (uint32_t level = 1; level < LEVELS; ++level) {
+                        auto slot = (_nextTick >> (level * SLOT_BITS)) & SLOT_MASK;
+                        Cascade(level, slot);
+                        if (slot != 0) {
+                            break;
+                        }
+                    }
+                }
+
+                while (_slots[0][index] != nullptr) {
+                    auto& timer = *_slots[0][index];
+                    Unlink(timer);
+
+                    if (timer._expiration > _nextTick) {
+                        // Timers beyond the range of the wheel are clamped and come back until they are due.
+                        Link(timer);
+                        continue;
+                    }
+
+                    std::chrono::milliseconds rearm(0);
+                    try {
+                        // The callback is assumed to be very fast as it is meant to dispatch to appropriate
+                        // callback queues.
+                        if (timer._rearmCallback) {
+                            rearm = timer._rearmCallback();
+                        } else {
+                            timer._callback();
+                        }
+                    }
+                    catch (const std::exception &ex) {
+                        LOG_ERROR("Timers", "Timer callback threw an exception. %s", ex.what());
+                    }
+
+                    // A re-armed timer stays active, it lands in a later slot so it's not fired again in this tick.
+                    if (rearm.count() > 0) {
+                        timer._expiration = _nextTick + static_cast<uint64_t>(rearm.count());
+                        Link(timer);
+                        continue;
+                    }
+                    ++fired;
+                }
+
+                ++_nextTick;
+            }
+
+            if (_count == 0) {
+                _nextTick = std::max(_nextTick, now + 1);
+            }
+
+            return fired;
+        }
+
+        /// <summary> Gets the tick by which Advance() needs to be called next, NO_TICK if the shard is empty. </summary>
+        uint64_t GetNextTick() const {
+            if (_count == 0) {
+                return NO_TICK;
+            }
+
+            for (auto index = _nextTick & SLOT_MASK; index < SLOTS; ++index) {
+                if (_slots[0][index] != nullptr) {
+                    return (_nextTick & ~SLOT_MASK) + index;
+                }
+            }
+
+            // Upper levels cascade at the start of the next round.
+            return (_nextTick | SLOT_MASK) + 1;
+        }
+
+        std::mutex lock;
+
+    private:
+
+        void Link(Timer& timer) {
+            auto expiration = std::max(timer._expiration, _nextTick);
+            auto delta = std::min(expiration - _nextTick, MAX_DELTA);
+            expiration = _nextTick + delta;
+
+            uint32_t level = 0;
+            while (delta >= (1ull << ((level + 1) * SLOT_BITS))) {
+                ++level;
+            }
+
+            auto& head = _slots[level][(expiration >> (level * SLOT_BITS)) & SLOT_MASK];
+            timer._next = head;
+            if (head != nullptr) {
+                head->_previous = &timer._next;
+            }
+            timer._previous = &head;
+            head = &timer;
+
+            timer._active = true;
+            ++_count;
+        }
+
+        void Unlink(Timer& timer) {
+            *timer._previous = timer._next;
+            if (timer._next != nullptr) {
+                timer._next->_previous = timer._previous;
+            }
+            timer._previous = nullptr;
+            timer._next = nullptr;
+
+            timer._active = false;
+            --_count;
+        }
+
+        void Cascade(uint32_t level, uint64_t slot) {
+            auto timer = _slots[level][slot];
+            _slots[level][slot] = nullptr;
+
+            while (timer != nullptr) {
+                auto next = timer->_next;
+                --_count;
+                Link(*timer);
+                timer = next;
+            }
+        }
 
-static bool operator<(const ActiveTimerEntry& first, const ActiveTimerEntry& second) {
-    // We want the entry that is closest to expire to be at the top of the queue.
-    return first.expirationTime > second.expirationTime;
+        /// <summary> Slots of each level, each slot is a list of timers. </summary>
+        Timer* _slots[LEVELS][SLOTS];
+
+        /// <summary> The next tick to process, all timers expire at or after it. </summary>
+        uint64_t _nextTick;
+
+        /// <summary> Number of active timers. </summary>
+        size_t _count;
+    };
+}
 }
 
 struct TimersScheduler {
+    TimersScheduler();
     ~TimersScheduler();
 
     bool StartMainLoop();
 
-    std::priority_queue<ActiveTimerEntry> activeTimers;
-    std::stack<Timer::Index> freeSlots;
+    /// <summary> Gets the tick in which a point of time falls. </summary>
+    uint64_t GetTick(Clock::time_point time) const;
+
+    /// <summary> Gets the shard of the calling thread. </summary>
+    TimerShard& GetShard();
+
+    /// <summary> Wakes up the timers thread if a timer expires before it planned to wake up. </summary>
+    void OnTimerStarted(uint64_t expiration);
+
+    Clock::time_point epoch;
+    TimerShard shards[SHARDS];
+    std::atomic<size_t> nextShard;
+
+    /// <summary> Number of active timers across shards. </summary>
+    std::atomic<size_t> activeTimers;
 
-    std::vector<TimerInfo> timers;
+    /// <summary> The tick the timers thread waits for, 0 while it processes shards. </summary>
+    std::atomic<uint64_t> plannedWake;
+    std::atomic<bool> wakeRequested;
 
     std::condition_variable cv;
     std::mutex mutex;
-    std::atomic<bool> running;
+    bool running;
 
     std::thread thread;
 };
 
+TimersScheduler::TimersScheduler() :
+    epoch(Clock::Now()),
+    nextShard(0),
+    activeTimers(0),
+    plannedWake(NO_TICK),
+    wakeRequested(false),
+    running(false) {
+}
+
 TimersScheduler::~TimersScheduler() {
-    running = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
     cv.notify_one();
 
     if (thread.joinable()) {
@@ -64,40 +256,50 @@ bool TimersScheduler::StartMainLoop() {
     thread = std::thread([this]() {
         std::unique_lock<std::mutex> lock(mutex);
 
+        // Whether the thread waited for a round without active timers. Calls usually finish long before their
+        // timeout, so it lingers before it goes idle, rather than being woken up by the next timer right away.
+        bool lingered = false;
+
         // Timers main loop.
         while (running) {
-            cv.wait(lock, [this]() {
-                return !activeTimers.empty() || !running;
-            });
+            if (activeTimers == 0 && lingered) {
+                plannedWake = NO_TICK;
+                cv.wait(lock, [this]() {
+                    return wakeRequested || !running;
+                });
 
-            if (!running) {
-                return;
+                if (!running) {
+                    return;
+                }
+                lingered = false;
             }
 
-            const auto& topTimer = activeTimers.top();
-            if (topTimer.expirationTime <= std::chrono::high_resolution_clock::now()) {
-                if (timers[topTimer.index].active) {
-                    try {
-                        // Fire the callback.
-                        // The callback is assumed to be very fast as it is meant to dispatch to appropriate
-                        // callback queues.
-                        timers[topTimer.index].callback();
-                    }
-                    catch (const std::exception &ex) {
-                        LOG_ERROR("Timers", "Timer callback threw an exception. %s", ex.what());
-                    }
-
-                    // We only support single trigger timers.
-                    timers[topTimer.index].active = false;
-                }
+            // Timers started from here on may land in shards that were already processed, so they request a wake up.
+            wakeRequested = false;
+            plannedWake = 0;
+            lock.unlock();
+
+            auto now = GetTick(Clock::Now());
+            auto next = NO_TICK;
+            for (auto& shard : shards) {
+                std::lock_guard<std::mutex> shardLock(shard.lock);
+                activeTimers -= shard.Advance(now);
+                next = std::min(next, shard.GetNextTick());
+            }
 
-                // Timer expired, so it's no longer active.
-                activeTimers.pop();
+            lock.lock();
+            if (next != NO_TICK) {
+                lingered = false;
+            } else if (!lingered) {
+                next = (now | SLOT_MASK) + 1;
+                lingered = true;
             }
-            else {
-                // Wait for timer expiration.
-                cv.wait_until(lock, topTimer.expirationTime, [&topTimer]() {
-                    return topTimer.expirationTime <= std::chrono::high_resolution_clock::now();
+
+            plannedWake = next;
+            if (next != NO_TICK) {
+                // Wait for the next tick with due timers.
+                cv.wait_until(lock, epoch + std::chrono::milliseconds(next), [this]() {
+                    return wakeRequested || !running;
                 });
             }
         }
@@ -106,54 +308,88 @@ bool TimersScheduler::StartMainLoop() {
     return true;
 }
 
+uint64_t TimersScheduler::GetTick(Clock::time_point time) const {
+    if (time <= epoch) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - epoch).count());
+}
+
+TimerShard& TimersScheduler::GetShard() {
+    thread_local size_t index = nextShard++ % SHARDS;
+    return shards[index];
+}
+
+void TimersScheduler::OnTimerStarted(uint64_t expiration) {
+    if (expiration < plannedWake && !wakeRequested.exchange(true)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_one();
+    }
+}
+
 static TimersScheduler _timersScheduler;
 
 
-Timer::Timer(Callback callback, std::chrono::milliseconds timeout) {
+Timer::Timer(Callback callback, std::chrono::milliseconds timeout) :
+    _callback(std::move(callback)),
+    _timeout(timeout),
+    _previous(nullptr),
+    _next(nullptr),
+    _expiration(0),
+    _active(false) {
+
     // Start the timers scheduler if this is the first timer created.
     static bool init = _timersScheduler.StartMainLoop();
+    (void)init;
 
-    std::lock_guard<std::mutex> lock(_timersScheduler.mutex);
-
-    TimerInfo timerInfo{ false, timeout, callback };
-
-    if (!_timersScheduler.freeSlots.empty()) {
-        _index = _timersScheduler.freeSlots.top();
-        _timersScheduler.freeSlots.pop();
+    _shard = &_timersScheduler.GetShard();
+}
 
-        _timersScheduler.timers[_index] = std::move(timerInfo);
-    }
-    else {
-        _index = static_cast<Timer::Index>(_timersScheduler.timers.size());
-        _timersScheduler.timers.emplace_back(timerInfo);
-    }
+Timer::Timer(std::chrono::milliseconds timeout, RearmCallback callback) : Timer(Callback(), timeout) {
+    _rearmCallback = std::move(callback);
 }
 
 Timer::~Timer() {
-    std::lock_guard<std::mutex> lock(_timersScheduler.mutex);
-
-    _timersScheduler.timers[_index].active = false;
-
-    // Free the timer slot.
-    _timersScheduler.freeSlots.emplace(_index);
+    Stop();
 }
 
 void Timer::Start() {
+    // The coarse time may lag by more than its resolution on tickless kernels, which would fire timers early.
+    auto now = Clock::Now();
+    uint64_t expiration;
+
     {
-        std::lock_guard<std::mutex> lock(_timersScheduler.mutex);
-        
-        auto& timerInfo = _timersScheduler.timers[_index];
-        timerInfo.active = true;
+        std::lock_guard<std::mutex> lock(_shard->lock);
 
-        ActiveTimerEntry entry = { _index, std::chrono::high_resolution_clock::now() + timerInfo.timeout };
-        _timersScheduler.activeTimers.emplace(std::move(entry));
+        if (_active) {
+            _shard->Remove(*this);
+        } else {
+            _timersScheduler.activeTimers++;
+        }
+
+        // Round up, the callback must not fire before the timeout elapsed.
+        expiration = _timersScheduler.GetTick(now + _timeout + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1));
+        _expiration = expiration;
+        _shard->Add(*this, _timersScheduler.GetTick(now));
     }
 
-    _timersScheduler.cv.notify_one();
+    _timersScheduler.OnTimerStarted(expiration);
 }
 
 void Timer::Stop() {
-    std::lock_guard<std::mutex> lock(_timersScheduler.mutex);
+    std::lock_guard<std::mutex> lock(_shard->lock);
+
+    if (_active) {
+        _shard->Remove(*this);
+        _timersScheduler.activeTimers--;
+    }
+}
+
+bool Timer::IsActive() const {
+    std::lock_guard<std::mutex> lock(_shard->lock);
+    return _active;
+}
 
-    _timersScheduler.timers[_index].active = false;
+size_t Timer::GetActiveCount() {
+    return _timersScheduler.activeTimers;
 }
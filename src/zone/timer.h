@@ -6,32 +6,78 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <stdint.h>
 
 namespace napa {
 namespace zone {
 
+    class TimerShard;
+
     /// <summary> A timer class that will trigger a callback after elapsed time. </summary>
+    /// <remarks>
+    ///     Active timers are kept in hierarchical timing wheels with a resolution of 1 millisecond, sharded by the
+    ///     thread that creates the timer. Starting and stopping a timer takes constant time and only contends with
+    ///     timers of the same shard, and the number of timers is only limited by memory.
+    ///     Callbacks run on the timers thread while holding the lock of their shard, so they are expected to be fast,
+    ///     e.g. dispatch to another queue, and must not start, stop or destroy timers.
+    /// </remarks>
     class Timer {
     public:
-        typedef uint16_t Index;
         typedef std::function<void(void)> Callback;
 
+        /// <summary> A callback that returns the time after which the timer expires again, 0 to stop. </summary>
+        typedef std::function<std::chrono::milliseconds(void)> RearmCallback;
+
         /// <summary> Creates a new timer which is not active initially. </summary>
         /// <param name="callback"> The callback. </param>
         /// <param name="timeout"> The timeout in millisecond after which the callback will be triggered. </param>
         Timer(Callback callback, std::chrono::milliseconds timeout);
 
+        /// <summary> Creates a new timer which is not active initially, and which its callback re-arms, e.g. for polling. </summary>
+        /// <param name="timeout"> The timeout in millisecond after which the callback is first triggered. </param>
+        /// <param name="callback"> The callback, it returns the timeout of the next time or 0 to leave the timer stopped. </param>
+        Timer(std::chrono::milliseconds timeout, RearmCallback callback);
+
         /// <summary> Destructor. Stops the timer. </summary>
         ~Timer();
 
-        /// <summary> Activates the timer to trigger the callback after specified milliseconds. </summary>
+        /// <summary> Non-copyable, an active timer is linked into a timing wheel. </summary>
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        /// <summary> Activates the timer to trigger the callback after specified milliseconds, restarts it if already active. </summary>
         void Start();
 
         /// <summary> Disables the timer, preventing the calback from triggering. </summary>
+        /// <remarks> The timer is unlinked from its wheel right away, stopped timers don't linger until they would expire. </remarks>
         void Stop();
 
+        /// <summary> Whether the timer is started and neither fired nor stopped yet. </summary>
+        bool IsActive() const;
+
+        /// <summary> Gets the number of active timers in the process. </summary>
+        static size_t GetActiveCount();
+
     private:
-        Index _index;
+        friend class TimerShard;
+
+        Callback _callback;
+        RearmCallback _rearmCallback;
+        std::chrono::milliseconds _timeout;
+
+        /// <summary> The shard keeping the timer while it's active. </summary>
+        TimerShard* _shard;
+
+        /// <summary> Links within the wheel slot while the timer is active, guarded by the shard lock. </summary>
+        /// <remarks> _previous points to the link that points to this timer, so it can be unlinked without knowing its slot. </remarks>
+        Timer** _previous;
+        Timer* _next;
+
+        /// <summary> The tick at which the timer expires. </summary>
+        uint64_t _expiration;
+
+        /// <summary> Whether the timer is linked into a wheel slot. </summary>
+        bool _active;
     };
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,240 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "tracing.h"
+#include "clock.h"
+
+#include <platform/process.h>
+#include <utils/string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace napa::zone;
+using napa::utils::string::AppendJsonString;
+
+constexpr size_t TraceEvent::MAX_NAME_LENGTH;
+constexpr size_t TraceEvent::MAX_DETAIL_LENGTH;
+constexpr size_t TraceEvent::MAX_TRACE_ID_LENGTH;
+constexpr size_t Tracing::DEFAULT_BUFFER_SIZE;
+
+std::atomic<bool> Tracing::_enabled(false);
+
+namespace {
+
+    /// <summary> The events of a thread, the lock is only contended while exporting. </summary>
+    struct ThreadBuffer {
+        std::mutex lock;
+        int32_t threadId = 0;
+        std::string threadName;
+
+        /// <summary> A ring of events, the oldest ones are overwritten once it's full. </summary>
+        std::vector<TraceEvent> events;
+
+        /// <summary> Number of events recorded since the start of the trace. </summary>
+        size_t recorded = 0;
+    };
+
+    /// <summary> The buffers of all threads which recorded events or were named. </summary>
+    struct TraceRegistry {
+        std::mutex lock;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::atomic<size_t> bufferSize { Tracing::DEFAULT_BUFFER_SIZE };
+        int64_t startTime = 0;
+    };
+
+    TraceRegistry& GetRegistry() {
+        // Leaked, threads may record until the process exits.
+        static auto registry = new TraceRegistry();
+        return *registry;
+    }
+
+    ThreadBuffer& GetThreadBuffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (buffer == nullptr) {
+            buffer = std::make_shared<ThreadBuffer>();
+            buffer->threadId = napa::platform::Gettid();
+
+            auto& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            registry.buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    void CopyString(char* destination, size_t maxLength, const char* source) {
+        size_t length = 0;
+        if (source != nullptr) {
+            length = std::min(std::strlen(source), maxLength);
+            std::memcpy(destination, source, length);
+        }
+        destination[length] = '\0';
+    }
+
+    void Record(char phase, const char* category, const char* name, int64_t time, int64_t duration, uint64_t id, const char* traceId, const char* detail) {
+        auto& buffer = GetThreadBuffer();
+        auto bufferSize = GetRegistry().bufferSize.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(buffer.lock);
+
+        // The ring is allocated by the first event of a trace, threads which are only named don't pay for it.
+        if (buffer.events.size() != bufferSize) {
+            buffer.events.resize(bufferSize);
+            buffer.recorded = 0;
+        }
+
+        auto& event = buffer.events[buffer.recorded++ % bufferSize];
+        event.phase = phase;
+        event.category = category != nullptr ? category : "";
+        event.time = time;
+        event.duration = duration;
+        event.id = id;
+        CopyString(event.name, TraceEvent::MAX_NAME_LENGTH, name);
+        CopyString(event.detail, TraceEvent::MAX_DETAIL_LENGTH, detail);
+        CopyString(event.traceId, TraceEvent::MAX_TRACE_ID_LENGTH, traceId);
+    }
+
+    /// <summary> Appends a time in microseconds since the start of the trace, which is the unit of trace events. </summary>
+    void AppendMicroseconds(std::string& out, int64_t nanoseconds) {
+        char value[32];
+        std::snprintf(value, sizeof(value), "%.3f", static_cast<double>(nanoseconds) / 1000.0);
+        out.append(value);
+    }
+
+    void AppendEvent(std::string& out, const TraceEvent& event, int32_t processId, int32_t threadId, int64_t startTime) {
+        out.append("{\"name\":");
+        AppendJsonString(out, event.name);
+        out.append(",\"cat\":");
+        AppendJsonString(out, event.category);
+        out.append(",\"ph\":\"").push_back(event.phase);
+        out.append("\",\"ts\":");
+        AppendMicroseconds(out, event.time - startTime);
+        if (event.phase == 'X') {
+            out.append(",\"dur\":");
+            AppendMicroseconds(out, event.duration);
+        } else if (event.phase == 'b' || event.phase == 'e') {
+            out.append(",\"id\":\"0x");
+            char id[24];
+            std::snprintf(id, sizeof(id), "%llx", static_cast<unsigned long long>(event.id));
+            out.append(id).push_back('"');
+        }
+        out.append(",\"pid\":").append(std::to_string(processId));
+        out.append(",\"tid\":").append(std::to_string(threadId));
+
+        if (event.traceId[0] != '\0' || event.detail[0] != '\0') {
+            out.append(",\"args\":{");
+            if (event.traceId[0] != '\0') {
+                out.append("\"traceId\":");
+                AppendJsonString(out, event.traceId);
+            }
+            if (event.detail[0] != '\0') {
+                if (event.traceId[0] != '\0') {
+                    out.push_back(',');
+                }
+                out.append("\"detail\":");
+                AppendJsonString(out, event.detail);
+            }
+            out.push_back('}');
+        }
+        out.push_back('}');
+    }
+}
+
+void Tracing::Start(size_t bufferSize) {
+    auto& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.lock);
+
+    _enabled.store(false, std::memory_order_relaxed);
+
+    // Buffers of exited threads are only referenced here, they go with the events of the earlier trace.
+    registry.buffers.erase(
+        std::remove_if(registry.buffers.begin(), registry.buffers.end(), [](const std::shared_ptr<ThreadBuffer>& buffer) {
+            return buffer.use_count() == 1;
+        }),
+        registry.buffers.end());
+
+    registry.bufferSize.store(bufferSize > 0 ? bufferSize : DEFAULT_BUFFER_SIZE, std::memory_order_relaxed);
+    for (auto& buffer : registry.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->lock);
+        buffer->events.clear();
+        buffer->events.shrink_to_fit();
+        buffer->recorded = 0;
+    }
+    registry.startTime = Now();
+
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracing::Stop() {
+    _enabled.store(false, std::memory_order_relaxed);
+}
+
+int64_t Tracing::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::Now().time_since_epoch()).count();
+}
+
+void Tracing::RecordSpan(const char* category, const char* name, int64_t start, int64_t end, const char* traceId, const char* detail) {
+    if (IsEnabled()) {
+        Record('X', category, name, start, end - start, 0, traceId, detail);
+    }
+}
+
+void Tracing::RecordAsyncSpan(bool begin, const char* category, const char* name, uint64_t id, int64_t time, const char* traceId) {
+    if (IsEnabled()) {
+        Record(begin ? 'b' : 'e', category, name, time, 0, id, traceId, nullptr);
+    }
+}
+
+void Tracing::SetThreadName(const std::string& name) {
+    auto& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.lock);
+    buffer.threadName = name;
+}
+
+std::string Tracing::ExportChromeJson() {
+    auto& registry = GetRegistry();
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    int64_t startTime;
+    {
+        std::lock_guard<std::mutex> lock(registry.lock);
+        buffers = registry.buffers;
+        startTime = registry.startTime;
+    }
+
+    auto processId = napa::platform::Getpid();
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&out, &first]() {
+        if (!first) {
+            out.push_back(',');
+        }
+        first = false;
+    };
+
+    for (auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->lock);
+        if (!buffer->threadName.empty()) {
+            separate();
+            out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":").append(std::to_string(processId));
+            out.append(",\"tid\":").append(std::to_string(buffer->threadId));
+            out.append(",\"args\":{\"name\":");
+            AppendJsonString(out, buffer->threadName.c_str());
+            out.append("}}");
+        }
+
+        // Oldest first, a full ring starts at the next event to overwrite.
+        auto size = buffer->events.size();
+        auto count = std::min(buffer->recorded, size);
+        for (size_t i = buffer->recorded - count; i < buffer->recorded; ++i) {
+            separate();
+            AppendEvent(out, buffer->events[i % size], processId, buffer->threadId, startTime);
+        }
+    }
+    out.append("],\"displayTimeUnit\":\"ms\"}");
+    return out;
+}
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> An event of the call lifecycle, in the terms of Chrome's trace event format. </summary>
+    struct TraceEvent {
+
+        /// <summary> Max length of the copied strings, longer ones are truncated. </summary>
+        static constexpr size_t MAX_NAME_LENGTH = 31;
+        static constexpr size_t MAX_DETAIL_LENGTH = 63;
+        static constexpr size_t MAX_TRACE_ID_LENGTH = 31;
+
+        /// <summary> 'X' for a span, 'b' and 'e' for the begin and end of an asynchronous span. </summary>
+        char phase;
+
+        /// <summary> Category, a string literal. </summary>
+        const char* category;
+
+        /// <summary> Start time in nanoseconds of the monotonic clock, and duration of a span. </summary>
+        int64_t time;
+        int64_t duration;
+
+        /// <summary> Id that pairs the begin and end of an asynchronous span. </summary>
+        uint64_t id;
+
+        char name[MAX_NAME_LENGTH + 1];
+        char detail[MAX_DETAIL_LENGTH + 1];
+        char traceId[MAX_TRACE_ID_LENGTH + 1];
+    };
+
+    /// <summary> Process wide tracing of schedule, queueing, execution, marshalling, module loading and GC. </summary>
+    /// <remarks>
+    ///     Each thread records into its own ring buffer, which keeps the latest events, so threads don't contend
+    ///     and tracing a long running process keeps a bounded memory. Buffers outlive their threads until the
+    ///     next Start(). When tracing is disabled, trace points cost a relaxed atomic load.
+    ///     It's exposed in napa.dll, as calls are traced from the binding of Node as well.
+    /// </remarks>
+    class NAPA_API Tracing {
+    public:
+
+        /// <summary> Number of events each thread keeps by default. </summary>
+        static constexpr size_t DEFAULT_BUFFER_SIZE = 8192;
+
+        /// <summary> Starts tracing, dropping the events of an earlier trace. </summary>
+        /// <param name="bufferSize"> Number of events each thread keeps, 0 for DEFAULT_BUFFER_SIZE. </param>
+        static void Start(size_t bufferSize = 0);
+
+        /// <summary> Stops tracing, recorded events are kept to be exported. </summary>
+        static void Stop();
+
+        /// <summary> Returns whether tracing is on. </summary>
+        static bool IsEnabled() {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        /// <summary> Gets the time of the clock of trace events, in nanoseconds. </summary>
+        static int64_t Now();
+
+        /// <summary> Records a span of the calling thread, if tracing is on. Strings may be nullptr. </summary>
+        static void RecordSpan(
+            const char* category,
+            const char* name,
+            int64_t start,
+            int64_t end,
+            const char* traceId = nullptr,
+            const char* detail = nullptr);
+
+        /// <summary> Records the begin or the end of a span which may end on another thread, if tracing is on. </summary>
+        /// <param name="begin"> True for the begin of the span, false for its end. </param>
+        /// <param name="id"> The id pairing the begin and end of the span. </param>
+        static void RecordAsyncSpan(
+            bool begin,
+            const char* category,
+            const char* name,
+            uint64_t id,
+            int64_t time,
+            const char* traceId = nullptr);
+
+        /// <summary> Names the calling thread in exported traces, e.g. with its zone and worker id. </summary>
+        static void SetThreadName(const std::string& name);
+
+        /// <summary> Gets the recorded events in Chrome's trace event JSON format, which Perfetto reads as well. </summary>
+        static std::string ExportChromeJson();
+
+    private:
+        static std::atomic<bool> _enabled;
+    };
+
+    /// <summary> Records a span of the calling thread from its construction to its destruction. </summary>
+    /// <remarks> The strings must outlive the scope, they are only copied when the span is recorded. </remarks>
+    class TraceScope {
+    public:
+
+        TraceScope(const char* category, const char* name, const char* traceId = nullptr, const char* detail = nullptr) :
+            _category(category),
+            _name(name),
+            _traceId(traceId),
+            _detail(detail),
+            _start(Tracing::IsEnabled() ? Tracing::Now() : -1) {
+        }
+
+        ~TraceScope() {
+            if (_start >= 0) {
+                Tracing::RecordSpan(_category, _name, _start, Tracing::Now(), _traceId, _detail);
+            }
+        }
+
+        /// <summary> Non-copyable. </summary>
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* _category;
+        const char* _name;
+        const char* _traceId;
+        const char* _detail;
+        int64_t _start;
+    };
+}
+}
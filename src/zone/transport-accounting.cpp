@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "transport-accounting.h"
+
+using namespace napa;
+using namespace napa::zone;
+
+std::atomic<bool> TransportAccounting::_enabled(false);
+
+void TransportAccounting::Start() {
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void TransportAccounting::Stop() {
+    _enabled.store(false, std::memory_order_relaxed);
+}
+
+void TransportAccounting::Record(
+    providers::MetricProvider& provider,
+    const char* zoneId,
+    const char* function,
+    const char* stage,
+    size_t bytes,
+    size_t sharedCount,
+    int64_t nanoseconds) {
+
+    if (!IsEnabled()) {
+        return;
+    }
+
+    // Functions are only known as they are called, so metrics are updated without binding dimension values.
+    const char* dimensionNames[] = { "zone", "function", "stage" };
+    const char* dimensionValues[] = { zoneId, function, stage };
+
+    auto payloadBytes = provider.GetMetric("Transport", "PayloadBytes", providers::MetricType::Percentile, 3, dimensionNames);
+    if (payloadBytes != nullptr) {
+        payloadBytes->Set(static_cast<int64_t>(bytes), 3, dimensionValues);
+    }
+
+    auto time = provider.GetMetric("Transport", "TransportTime", providers::MetricType::Percentile, 3, dimensionNames);
+    if (time != nullptr) {
+        time->Set(nanoseconds / 1000, 3, dimensionValues);
+    }
+
+    if (sharedCount > 0) {
+        auto sharedPointers = provider.GetMetric("Transport", "SharedPointers", providers::MetricType::Rate, 3, dimensionNames);
+        if (sharedPointers != nullptr) {
+            sharedPointers->Increment(static_cast<uint64_t>(sharedCount), 3, dimensionValues);
+        }
+    }
+}
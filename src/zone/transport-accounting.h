@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <napa/exports.h>
+#include <napa/providers/metric.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Process wide accounting of what marshalling costs calls and stores, published as metrics. </summary>
+    /// <remarks>
+    ///     Metrics are in section "Transport", with dimensions zone, function and stage:
+    ///     - PayloadBytes (Percentile): bytes of binary payloads, and characters of JSON payloads, per marshall or unmarshall.
+    ///     - TransportTime (Percentile): microseconds spent marshalling or unmarshalling.
+    ///     - SharedPointers (Rate): shared pointers that payloads carried in their transport context.
+    ///     Stages are MarshallArguments, UnmarshallArguments, MarshallResult and UnmarshallResult for calls,
+    ///     and StoreSet and StoreGet for stores, whose function is 'store:<id>'. While accounting is on, calls of
+    ///     plain JSON values are not dispatched natively, so worker stages are all accounted by transport.
+    ///     When accounting is off, each stage costs a relaxed atomic load.
+    ///     It's exposed in napa.dll, as calls are made from the binding of Node as well.
+    /// </remarks>
+    class NAPA_API TransportAccounting {
+    public:
+
+        /// <summary> Starts accounting. </summary>
+        static void Start();
+
+        /// <summary> Stops accounting, recorded metrics are kept by the provider. </summary>
+        static void Stop();
+
+        /// <summary> Returns whether accounting is on. </summary>
+        static bool IsEnabled() {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        /// <summary> Records a stage of marshalling, if accounting is on. </summary>
+        /// <param name="provider"> The metric provider. </param>
+        /// <param name="zoneId"> The zone making or running the call, or accessing the store. </param>
+        /// <param name="function"> The function called, or 'store:<id>'. </param>
+        /// <param name="stage"> The stage, e.g. 'MarshallArguments'. </param>
+        /// <param name="bytes"> Size of the payloads marshalled or unmarshalled. </param>
+        /// <param name="sharedCount"> Number of shared pointers the payloads carried. </param>
+        /// <param name="nanoseconds"> Time the stage took. </param>
+        static void Record(
+            providers::MetricProvider& provider,
+            const char* zoneId,
+            const char* function,
+            const char* stage,
+            size_t bytes,
+            size_t sharedCount,
+            int64_t nanoseconds);
+
+    private:
+        static std::atomic<bool> _enabled;
+    };
+}
+}
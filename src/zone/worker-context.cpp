@@ -12,9 +12,7 @@ using namespace napa;
 using namespace napa::zone;
 
 namespace {
-    tls::ThreadLocal<std::array<
-        void*,
-        static_cast<size_t>(WorkerContextItem::END_OF_WORKER_CONTEXT_ITEM)>> items;
+    tls::ThreadLocal<WorkerContext::Items> items;
 }
 
 void WorkerContext::Init() {
@@ -22,6 +20,10 @@ void WorkerContext::Init() {
     items->fill(nullptr);
 }
 
+bool WorkerContext::IsInitialized() {
+    return items.operator->() != nullptr;
+}
+
 void* WorkerContext::Get(WorkerContextItem item) {
     NAPA_ASSERT(item < WorkerContextItem::END_OF_WORKER_CONTEXT_ITEM, "Invalid WorkerContextItem");
     return (*items)[static_cast<size_t>(item)];
@@ -30,4 +32,14 @@ void* WorkerContext::Get(WorkerContextItem item) {
 void WorkerContext::Set(WorkerContextItem item, void* data) {
     NAPA_ASSERT(item < WorkerContextItem::END_OF_WORKER_CONTEXT_ITEM, "Invalid WorkerContextItem");
     (*items)[static_cast<size_t>(item)] = data;
-}
\ No newline at end of file
+}
+
+WorkerContext::Items WorkerContext::Detach() {
+    auto detached = *items;
+    items->fill(nullptr);
+    return detached;
+}
+
+void WorkerContext::Attach(const Items& attached) {
+    *items = attached;
+}
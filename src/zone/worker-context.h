@@ -6,6 +6,8 @@
 #include <napa/exports.h>
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace napa {
 namespace zone {
@@ -30,6 +32,27 @@ namespace zone {
         /// <summary> Worker Id. </summary>
         WORKER_ID,
 
+        /// <summary> Arena allocator of the call being executed, nullptr between calls. </summary>
+        CALL_ARENA,
+
+        /// <summary> Trace id of the call being executed as a null terminated string, nullptr between calls. </summary>
+        CALL_TRACE_ID,
+
+        /// <summary> Timers of the worker behind setTimeout() and the like, created on first use. </summary>
+        WORKER_TIMERS,
+
+        /// <summary> Inbox of completions of asynchronous work posted by the worker, created on first use. </summary>
+        ASYNC_COMPLETIONS,
+
+        /// <summary> Event loop of the worker, if the zone has the 'eventLoop' setting. </summary>
+        EVENT_LOOP,
+
+        /// <summary> Dispatcher of calls with functions resolved in the worker's isolate, created on first use. </summary>
+        CALL_DISPATCHER,
+
+        /// <summary> Functions and constructors napa::module::binding resolved by name, created on first use. </summary>
+        BINDING_CACHE,
+
         /// <summary> End of index. </summary>
         END_OF_WORKER_CONTEXT_ITEM
     };
@@ -38,9 +61,15 @@ namespace zone {
     class NAPA_API WorkerContext {
     public:
 
+        /// <summary> All TLS data of a worker, to move isolate bound data between threads. </summary>
+        typedef std::array<void*, static_cast<std::size_t>(WorkerContextItem::END_OF_WORKER_CONTEXT_ITEM)> Items;
+
         /// <summary> Initialize isolate data. </summary>
         static void Init();
 
+        /// <summary> Whether the TLS data of the current thread was initialized, which only threads running isolates have. </summary>
+        static bool IsInitialized();
+
         /// <summary> Get stored TLS data. </summary>
         /// <param name="item"> Pre-defined data id for Napa specific data. </param>
         /// <returns> Stored TLS data. </returns>
@@ -50,6 +79,12 @@ namespace zone {
         /// <param name="item"> Pre-defined data id for Napa specific data. </param>
         /// <param name="data"> Pointer to stored data. </param>
         static void Set(WorkerContextItem item, void* data);
+
+        /// <summary> Takes all TLS data of current thread, leaving the slots empty. </summary>
+        static Items Detach();
+
+        /// <summary> Sets all TLS data of current thread, e.g. data detached from another thread. </summary>
+        static void Attach(const Items& items);
     };
 
     #define INIT_WORKER_CONTEXT napa::zone::WorkerContext::Init
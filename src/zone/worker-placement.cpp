@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "worker-placement.h"
+
+#include <map>
+
+using namespace napa;
+using namespace napa::zone;
+
+std::vector<uint32_t> zone::GetWorkerProcessors(
+    uint32_t workerId,
+    const settings::ZoneSettings& settings,
+    const std::vector<platform::Processor>& topology) {
+
+    if (settings.workerPlacement == settings::WorkerPlacement::NONE && settings.numaNode < 0) {
+        return {};
+    }
+
+    std::vector<platform::Processor> candidates;
+    for (const auto& processor : topology) {
+        if (settings.numaNode < 0 || processor.numaNode == static_cast<uint32_t>(settings.numaNode)) {
+            candidates.push_back(processor);
+        }
+    }
+
+    if (candidates.empty()) {
+        // No processor on the requested NUMA node.
+        return {};
+    }
+
+    std::vector<uint32_t> ids;
+    switch (settings.workerPlacement) {
+        case settings::WorkerPlacement::NONE:
+            // Restricted to a node only, the OS may still move the worker across the node's processors.
+            for (const auto& processor : candidates) {
+                ids.push_back(processor.id);
+            }
+            return ids;
+
+        case settings::WorkerPlacement::COMPACT:
+            return { candidates[workerId % candidates.size()].id };
+
+        case settings::WorkerPlacement::SPREAD: {
+            std::map<uint32_t, std::vector<uint32_t>> nodes;
+            for (const auto& processor : candidates) {
+                nodes[processor.numaNode].push_back(processor.id);
+            }
+
+            // Take the k-th processor of each node in turn.
+            for (size_t k = 0; ids.size() < candidates.size(); ++k) {
+                for (const auto& node : nodes) {
+                    if (k < node.second.size()) {
+                        ids.push_back(node.second[k]);
+                    }
+                }
+            }
+            return { ids[workerId % ids.size()] };
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "platform/os.h"
+#include "settings/settings.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Gets the logical processors a zone worker should be pinned to. </summary>
+    /// <param name="workerId"> The worker id, workers beyond the number of processors wrap around. </param>
+    /// <param name="settings"> The zone settings that hold the placement policy. </param>
+    /// <param name="topology"> The processors available, ordered by NUMA node then by id. </param>
+    /// <returns> The processor ids, empty if the worker shouldn't be pinned. </returns>
+    std::vector<uint32_t> GetWorkerProcessors(
+        uint32_t workerId,
+        const settings::ZoneSettings& settings,
+        const std::vector<platform::Processor>& topology);
+}
+}
@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "worker-timers.h"
+
+#include "napa-zone.h"
+#include "worker-context.h"
+
+#include <napa/log.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+class WorkerTimers::FireTask : public Task {
+public:
+    explicit FireTask(Id id) : _id(id) {}
+
+    void Execute() override {
+        // Timers may be gone with a recycled isolate, then the timer went with them.
+        auto timers = static_cast<WorkerTimers*>(WorkerContext::Get(WorkerContextItem::WORKER_TIMERS));
+        if (timers != nullptr) {
+            timers->Fire(_id);
+        }
+    }
+
+private:
+    Id _id;
+};
+
+WorkerTimers* WorkerTimers::Get() {
+    auto timers = static_cast<WorkerTimers*>(WorkerContext::Get(WorkerContextItem::WORKER_TIMERS));
+    if (timers == nullptr) {
+        auto zone = static_cast<NapaZone*>(WorkerContext::Get(WorkerContextItem::ZONE));
+        if (zone == nullptr) {
+            return nullptr;
+        }
+
+        auto workerId = static_cast<WorkerId>(reinterpret_cast<uintptr_t>(WorkerContext::Get(WorkerContextItem::WORKER_ID)));
+        timers = new WorkerTimers(zone->GetScheduler(), workerId);
+        WorkerContext::Set(WorkerContextItem::WORKER_TIMERS, timers);
+    }
+
+    return timers;
+}
+
+void WorkerTimers::Destroy() {
+    auto timers = static_cast<WorkerTimers*>(WorkerContext::Get(WorkerContextItem::WORKER_TIMERS));
+    WorkerContext::Set(WorkerContextItem::WORKER_TIMERS, nullptr);
+    delete timers;
+}
+
+WorkerTimers::WorkerTimers(std::shared_ptr<Scheduler> scheduler, WorkerId workerId) :
+    _scheduler(std::move(scheduler)),
+    _workerId(workerId) {
+}
+
+WorkerTimers::~WorkerTimers() {
+    auto scheduler = _scheduler.lock();
+    if (scheduler != nullptr) {
+        for (size_t i = 0; i < _pending.size(); i++) {
+            scheduler->UnpinWorker(_workerId);
+        }
+    }
+
+    _pending.clear();
+    _dispatcher.Reset();
+}
+
+void WorkerTimers::SetDispatcher(v8::Local<v8::Function> dispatcher) {
+    _dispatcher.Reset(v8::Isolate::GetCurrent(), dispatcher);
+}
+
+void WorkerTimers::Start(Id id, std::chrono::milliseconds delay) {
+    auto scheduler = _scheduler.lock();
+    if (scheduler == nullptr) {
+        return;
+    }
+
+    auto iter = _pending.find(id);
+    if (iter == _pending.end()) {
+        // Keep the worker until the timer fired on it.
+        scheduler->PinWorker(_workerId);
+        iter = _pending.emplace(id, nullptr).first;
+    }
+
+    if (delay.count() <= 0) {
+        iter->second.reset();
+        ScheduleFire(_scheduler, _workerId, id);
+        return;
+    }
+
+    auto weakScheduler = _scheduler;
+    auto workerId = _workerId;
+    iter->second = std::make_unique<Timer>([weakScheduler, workerId, id]() {
+        ScheduleFire(weakScheduler, workerId, id);
+    }, delay);
+    iter->second->Start();
+}
+
+void WorkerTimers::Cancel(Id id) {
+    auto iter = _pending.find(id);
+    if (iter == _pending.end()) {
+        return;
+    }
+
+    // Destroying the timer stops it, a task that already fires it finds it gone.
+    _pending.erase(iter);
+
+    auto scheduler = _scheduler.lock();
+    if (scheduler != nullptr) {
+        scheduler->UnpinWorker(_workerId);
+    }
+}
+
+size_t WorkerTimers::GetPendingCount() const {
+    return _pending.size();
+}
+
+void WorkerTimers::ScheduleFire(const std::weak_ptr<Scheduler>& scheduler, WorkerId workerId, Id id) {
+    // The pin keeps the worker, unless the zone has gone away.
+    auto lockedScheduler = scheduler.lock();
+    if (lockedScheduler != nullptr) {
+        lockedScheduler->ScheduleOnWorker(workerId, std::make_shared<FireTask>(id));
+    }
+}
+
+void WorkerTimers::Fire(Id id) {
+    auto iter = _pending.find(id);
+    if (iter == _pending.end()) {
+        return;
+    }
+
+    // A restarted timer fires once for its last start, a task of an earlier start may still be pending.
+    if (iter->second != nullptr && iter->second->IsActive()) {
+        return;
+    }
+
+    Cancel(id);
+
+    if (_dispatcher.IsEmpty()) {
+        return;
+    }
+
+    auto isolate = v8::Isolate::GetCurrent();
+    v8::HandleScope scope(isolate);
+    auto context = isolate->GetCurrentContext();
+
+    v8::TryCatch tryCatch(isolate);
+    v8::Local<v8::Value> argv[] = { v8::Number::New(isolate, static_cast<double>(id)) };
+    auto dispatcher = v8::Local<v8::Function>::New(isolate, _dispatcher);
+    if (dispatcher->Call(context, context->Global(), 1, argv).IsEmpty() && tryCatch.HasCaught()) {
+        v8::String::Utf8Value exception(tryCatch.Exception());
+        LOG_ERROR("Timers", "Timer callback on worker %u threw an exception. %s", _workerId, *exception);
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "scheduler.h"
+#include "timer.h"
+
+#include <v8.h>
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Timers of a zone worker, which run their callbacks as tasks on the same worker. </summary>
+    /// <remarks>
+    ///     It backs setTimeout(), setInterval() and setImmediate() in zones, as workers have no event loop of their own.
+    ///     Expired timers are scheduled through ScheduleOnWorker(), so timer callbacks run between other tasks of the worker.
+    ///     Pending timers pin the worker, i.e. keep it from being removed by a resize or recycled, until they fire or are cancelled.
+    ///     All methods must be called on the worker.
+    /// </remarks>
+    class WorkerTimers {
+    public:
+
+        /// <summary> Identifies a timer, ids are chosen by the caller. </summary>
+        typedef int64_t Id;
+
+        /// <summary> Gets the timers of the calling worker, creating them on first use. </summary>
+        /// <returns> The timers, or nullptr if the calling thread isn't a napa zone worker. </returns>
+        static WorkerTimers* Get();
+
+        /// <summary> Destroys the timers of the calling worker if any, before its isolate is disposed. </summary>
+        static void Destroy();
+
+        /// <summary> Destructor. Cancels pending timers. </summary>
+        ~WorkerTimers();
+
+        /// <summary> Sets the function called with the id of each timer that fires. </summary>
+        void SetDispatcher(v8::Local<v8::Function> dispatcher);
+
+        /// <summary> Starts a timer, which fires once. </summary>
+        /// <param name="id"> Id of the timer, passed to the dispatcher. Starting an id that is pending restarts it. </param>
+        /// <param name="delay"> Delay after which the timer fires. With 0, the timer fires as the next task of the worker. </param>
+        void Start(Id id, std::chrono::milliseconds delay);
+
+        /// <summary> Cancels a pending timer, nothing happens if it already fired. </summary>
+        void Cancel(Id id);
+
+        /// <summary> Gets the number of pending timers. </summary>
+        size_t GetPendingCount() const;
+
+    private:
+
+        /// <summary> Task that fires a timer on the worker. </summary>
+        class FireTask;
+
+        WorkerTimers(std::shared_ptr<Scheduler> scheduler, WorkerId workerId);
+
+        /// <summary> Schedules a task that fires the timer on the worker. Called from any thread. </summary>
+        static void ScheduleFire(const std::weak_ptr<Scheduler>& scheduler, WorkerId workerId, Id id);
+
+        /// <summary> Calls the dispatcher for a timer, unless it was cancelled in the meantime. </summary>
+        void Fire(Id id);
+
+        std::weak_ptr<Scheduler> _scheduler;
+        WorkerId _workerId;
+
+        /// <summary> Pending timers, timers that fire on the next task have no Timer. </summary>
+        std::unordered_map<Id, std::unique_ptr<Timer>> _pending;
+
+        v8::Persistent<v8::Function> _dispatcher;
+    };
+}
+}
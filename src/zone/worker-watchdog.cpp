@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "worker-watchdog.h"
+
+#include <algorithm>
+
+using namespace napa::zone;
+
+WorkerWatchdog::WorkerWatchdog(std::chrono::milliseconds threshold, uint32_t workerCapacity) :
+    _threshold(threshold),
+    _stuck(workerCapacity, false),
+    _stuckWorkers(0) {
+}
+
+std::chrono::milliseconds WorkerWatchdog::GetCheckInterval() const {
+    return std::max(_threshold / 2, std::chrono::milliseconds(1));
+}
+
+std::vector<WorkerWatchdog::Change> WorkerWatchdog::Check(
+    uint32_t workers,
+    const std::function<std::chrono::steady_clock::duration(WorkerId)>& getBusyTime) {
+
+    std::vector<Change> changes;
+    for (WorkerId id = 0; id < _stuck.size(); id++) {
+        auto busyTime = id < workers ? getBusyTime(id) : std::chrono::steady_clock::duration::zero();
+        auto stuck = busyTime >= _threshold;
+        if (stuck == _stuck[id]) {
+            continue;
+        }
+
+        _stuck[id] = stuck;
+        if (stuck) {
+            _stuckWorkers++;
+        } else {
+            _stuckWorkers--;
+        }
+        changes.push_back(Change{ id, stuck, busyTime });
+    }
+    return changes;
+}
+
+uint32_t WorkerWatchdog::GetStuckWorkerCount() const {
+    return _stuckWorkers;
+}
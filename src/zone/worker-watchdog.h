@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "worker.h"
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Tells which workers of a zone are stuck, i.e. haven't reached a task boundary for a threshold. </summary>
+    /// <remarks>
+    ///     A worker blocked in a native call, or spinning where TerminateExecution can't reach, never finishes its task.
+    ///     The zone checks its workers periodically and stops routing calls to stuck workers, until they finish the task.
+    ///     Checks are made from a single thread.
+    /// </remarks>
+    class WorkerWatchdog {
+    public:
+
+        /// <summary> A worker that became stuck, or recovered, since the previous check. </summary>
+        struct Change {
+            WorkerId workerId;
+            bool stuck;
+
+            /// <summary> How long the worker has run its task, zero if it finished. </summary>
+            std::chrono::steady_clock::duration busyTime;
+        };
+
+        /// <summary> Constructor. </summary>
+        /// <param name="threshold"> Time a worker must have run a task for to be stuck. </param>
+        /// <param name="workerCapacity"> The maximum number of workers of the zone. </param>
+        WorkerWatchdog(std::chrono::milliseconds threshold, uint32_t workerCapacity);
+
+        /// <summary> Gets the interval of checks, which is half the threshold, so a stuck worker is found within 1.5 thresholds. </summary>
+        std::chrono::milliseconds GetCheckInterval() const;
+
+        /// <summary> Checks the workers of the zone. </summary>
+        /// <param name="workers"> The number of workers, stuck workers removed meanwhile count as recovered. </param>
+        /// <param name="getBusyTime"> Gets how long a worker has run its current task, zero between tasks. </param>
+        /// <returns> The workers that became stuck or recovered since the previous check. </returns>
+        std::vector<Change> Check(uint32_t workers, const std::function<std::chrono::steady_clock::duration(WorkerId)>& getBusyTime);
+
+        /// <summary> Gets the number of stuck workers as of the last check. </summary>
+        uint32_t GetStuckWorkerCount() const;
+
+    private:
+        std::chrono::milliseconds _threshold;
+
+        /// <summary> Whether a worker is stuck, indexed by worker id. </summary>
+        std::vector<bool> _stuck;
+
+        uint32_t _stuckWorkers;
+    };
+}
+}
@@ -2,26 +2,277 @@
 // Licensed under the MIT license.
 
 #include "worker.h"
-
+#include "clock.h"
+#include "cpu-governor.h"
+#include "cpu-profiling.h"
+#include "event-loop.h"
+#include "flight-recorder.h"
+#include "idle-gc-policy.h"
+#include "isolate-pool.h"
+#include "memory-usage.h"
+#include "recycle-policy.h"
+#include "shared-thread-pool.h"
+#include "sync-wait.h"
+#include "task-queue.h"
+#include "tracing.h"
+#include "worker-placement.h"
+
+#include <module/loader/module-loader.h>
+#include <platform/os.h>
 #include <utils/debug.h>
-#include <v8/array-buffer-allocator.h>
 
 #include <napa/log.h>
+#include <napa/providers/metric.h>
 
 #include <v8.h>
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdlib>
 #include <mutex>
-#include <queue>
+#include <string>
 #include <thread>
+#include <vector>
 
 using namespace napa;
 using namespace napa::zone;
 
-// Forward declaration
-static v8::Isolate* CreateIsolate(const settings::ZoneSettings& settings);
-static void ConfigureIsolate(v8::Isolate* isolate, const settings::ZoneSettings& settings);
+namespace {
+
+    /// <summary> Stack size in bytes of a worker thread beyond the isolate stack limit. </summary>
+    const size_t WORKER_STACK_HEADROOM = 1024 * 1024;
+
+    /// <summary> The maximum number of tasks a worker takes from its queue at once. </summary>
+    const size_t WORKER_BATCH_SIZE = 32;
+
+    /// <summary> The time a worker on the shared threads serves tasks before it lets other workers of the thread run. </summary>
+    const auto SHARED_TURN_TIME = std::chrono::milliseconds(1);
+
+    /// <summary> Whether the worker context TLS data of a shared thread was initialized, which workers attach theirs to. </summary>
+    thread_local bool sharedThreadInitialized = false;
+
+    /// <summary> Gets the time in seconds that V8 takes idle deadlines in. </summary>
+    /// <remarks>
+    ///     V8 compares deadlines with the clock of its platform, which is the OS monotonic clock for both the
+    ///     default platform and the platform of Node, whichever napa runs with. So is steady_clock.
+    /// </remarks>
+    double GetMonotonicTime() {
+        return std::chrono::duration<double>(Clock::Now().time_since_epoch()).count();
+    }
+
+    /// <summary> Parks the worker until a task arrives or a timeout expires, serving its event loop meanwhile if it has one. </summary>
+    /// <param name="tasks"> The worker queue. </param>
+    /// <param name="eventLoop"> The worker event loop, nullptr if it has none. </param>
+    /// <param name="task"> Receives the task. </param>
+    /// <param name="timeout"> How long to wait, negative to wait until a task arrives or the queue is closed and drained. </param>
+    /// <returns> True if a task was dequeued. </returns>
+    bool WaitForTask(TaskQueue& tasks, EventLoop* eventLoop, std::shared_ptr<Task>& task, std::chrono::microseconds timeout) {
+        if (eventLoop == nullptr) {
+            if (timeout.count() < 0) {
+                task = tasks.Pop();
+                return task != nullptr;
+            }
+            return tasks.TryPopFor(task, timeout);
+        }
+
+        auto deadline = Clock::Now() + timeout;
+        auto ready = [&tasks]() {
+            return tasks.Size() > 0 || tasks.IsClosed();
+        };
+
+        while (!tasks.TryPop(task)) {
+            if (tasks.IsClosed()) {
+                return false;
+            }
+
+            auto wait = std::chrono::milliseconds(-1);
+            if (timeout.count() >= 0) {
+                auto remaining = deadline - Clock::Now();
+                if (remaining.count() <= 0) {
+                    return false;
+                }
+
+                // Rounded up, libuv timers have a resolution of 1 millisecond.
+                wait = std::chrono::duration_cast<std::chrono::milliseconds>(remaining + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1));
+            }
+            eventLoop->Wait(ready, wait);
+        }
+        return true;
+    }
+
+    /// <summary> Collects garbage while the worker is idle, until a task arrives or the idle GC policy is done. </summary>
+    /// <param name="isolate"> The worker isolate. </param>
+    /// <param name="tasks"> The worker queue, checked between GC steps. </param>
+    /// <param name="eventLoop"> The worker event loop, served while waiting for a full GC, nullptr if it has none. </param>
+    /// <param name="policy"> The idle GC policy. </param>
+    /// <param name="idleStart"> When the idle period started. </param>
+    /// <param name="gcTime"> Receives the time spent in GC. </param>
+    /// <returns> The task that arrived, or nullptr if the worker is still idle. </returns>
+    std::shared_ptr<Task> CollectGarbageWhileIdle(v8::Isolate* isolate,
+                                                  TaskQueue& tasks,
+                                                  EventLoop* eventLoop,
+                                                  const IdleGcPolicy& policy,
+                                                  std::chrono::steady_clock::time_point idleStart,
+                                                  std::chrono::steady_clock::duration& gcTime) {
+        std::shared_ptr<Task> task;
+
+        // Incremental steps, as long as V8 has idle work to do and no task arrives.
+        auto budget = policy.GetStepBudget();
+        if (budget.count() > 0) {
+            auto done = false;
+            while (!done) {
+                auto start = Clock::Now();
+                done = isolate->IdleNotificationDeadline(GetMonotonicTime() + std::chrono::duration<double>(budget).count());
+                auto stepTime = Clock::Now() - start;
+                gcTime += stepTime;
+
+                if (tasks.TryPop(task)) {
+                    return task;
+                }
+
+                // V8 hands most of the budget back when it has nothing to do in idle time yet, without being done.
+                if (stepTime < budget / 4) {
+                    break;
+                }
+            }
+        }
+
+        // A full GC once the worker stayed idle long enough, e.g. the zone went quiet.
+        auto delay = policy.GetFullGcDelay();
+        if (delay.count() > 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(idleStart + delay - Clock::Now());
+            if (remaining.count() > 0 && WaitForTask(tasks, eventLoop, task, remaining)) {
+                return task;
+            }
+
+            // The queue is closed if it's still empty, the isolate is about to be disposed.
+            if (tasks.TryPop(task) || tasks.IsClosed()) {
+                return task;
+            }
+
+            auto start = Clock::Now();
+            isolate->LowMemoryNotification();
+            gcTime += Clock::Now() - start;
+        }
+        return nullptr;
+    }
+
+    /// <summary> Start time of the garbage collection in progress on the worker thread, -1 if it's not traced. </summary>
+    thread_local int64_t gcTraceStart = -1;
+
+    /// <summary> The types of garbage collection reported in metrics, in the order of GcMetrics. </summary>
+    const v8::GCType GC_TYPES[] = {
+        v8::kGCTypeScavenge,
+        v8::kGCTypeMarkSweepCompact,
+        v8::kGCTypeIncrementalMarking,
+        v8::kGCTypeProcessWeakCallbacks
+    };
+    const size_t GC_TYPE_COUNT = sizeof(GC_TYPES) / sizeof(GC_TYPES[0]);
+
+    /// <summary> Counts and pause times of garbage collections on a worker thread, per type. </summary>
+    struct GcMetrics {
+        providers::BoundMetricPtr counts[GC_TYPE_COUNT];
+        providers::BoundMetricPtr pauseTimes[GC_TYPE_COUNT];
+    };
+
+    /// <summary> Metrics of the worker thread's collections, nullptr if the thread doesn't report them. </summary>
+    thread_local GcMetrics* gcMetrics = nullptr;
+
+    /// <summary> Start times of the garbage collections in progress on the worker thread, the innermost last. </summary>
+    const size_t MAX_GC_DEPTH = 4;
+    thread_local std::chrono::steady_clock::time_point gcStarts[MAX_GC_DEPTH];
+    thread_local size_t gcDepth = 0;
+
+    const char* GetGcTypeName(v8::GCType type) {
+        switch (type) {
+            case v8::kGCTypeScavenge: return "Scavenge";
+            case v8::kGCTypeMarkSweepCompact: return "MarkSweepCompact";
+            case v8::kGCTypeIncrementalMarking: return "IncrementalMarking";
+            case v8::kGCTypeProcessWeakCallbacks: return "ProcessWeakCallbacks";
+            default: return "";
+        }
+    }
+
+    void OnGcPrologue(v8::Isolate*, v8::GCType type, v8::GCCallbackFlags) {
+        FlightRecorder::Record(FlightEventType::GC_START, 0, GetGcTypeName(type));
+        gcTraceStart = Tracing::IsEnabled() ? Tracing::Now() : -1;
+
+        if (gcMetrics != nullptr && gcDepth < MAX_GC_DEPTH) {
+            gcStarts[gcDepth] = Clock::Now();
+        }
+        gcDepth++;
+    }
+
+    void OnGcEpilogue(v8::Isolate* isolate, v8::GCType type, v8::GCCallbackFlags) {
+        v8::HeapStatistics heapStatistics;
+        isolate->GetHeapStatistics(&heapStatistics);
+        FlightRecorder::Record(FlightEventType::GC_END, heapStatistics.used_heap_size(), GetGcTypeName(type));
+
+        // A collection nested in another one, e.g. a scavenge during incremental marking, is traced instead of the outer one.
+        if (gcTraceStart >= 0) {
+            Tracing::RecordSpan("v8", "GC", gcTraceStart, Tracing::Now(), nullptr, GetGcTypeName(type));
+            gcTraceStart = -1;
+        }
+
+        // Nested collections are timed on their own, and are part of the pause of the outer one.
+        if (gcDepth == 0 || --gcDepth >= MAX_GC_DEPTH || gcMetrics == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < GC_TYPE_COUNT; ++i) {
+            if (GC_TYPES[i] == type) {
+                auto pauseTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock::Now() - gcStarts[gcDepth]);
+                if (gcMetrics->counts[i] != nullptr) {
+                    gcMetrics->counts[i]->Increment(1);
+                }
+                if (gcMetrics->pauseTimes[i] != nullptr) {
+                    gcMetrics->pauseTimes[i]->Set(pauseTime.count());
+                }
+                break;
+            }
+        }
+    }
+
+    /// <summary> Binds the metrics of collections of a zone, which all isolate generations of its workers report in. </summary>
+    void BindGcMetrics(GcMetrics& metrics, const std::string& zoneId) {
+        const char* dimensionNames[] = { "zone", "type" };
+        auto counts = providers::GetMetricProvider().GetMetric("Zone", "GcCount", providers::MetricType::Rate, 2, dimensionNames);
+        auto pauseTimes = providers::GetMetricProvider().GetMetric("Zone", "GcPauseTime", providers::MetricType::Percentile, 2, dimensionNames);
+        for (size_t i = 0; i < GC_TYPE_COUNT; ++i) {
+            const char* dimensionValues[] = { zoneId.c_str(), GetGcTypeName(GC_TYPES[i]) };
+            metrics.counts[i] = providers::BindMetric(counts, 2, dimensionValues);
+            metrics.pauseTimes[i] = providers::BindMetric(pauseTimes, 2, dimensionValues);
+        }
+    }
+
+    /// <summary> Binds a metric of a worker to its dimension values, it's updated around every task. </summary>
+    providers::BoundMetricPtr BindWorkerMetric(const std::string& zoneId, WorkerId id, const char* name, providers::MetricType type) {
+        auto workerId = std::to_string(id);
+        const char* dimensionNames[] = { "zone", "worker" };
+        const char* dimensionValues[] = { zoneId.c_str(), workerId.c_str() };
+        return providers::BindMetric(
+            providers::GetMetricProvider().GetMetric("Zone", name, type, 2, dimensionNames), 2, dimensionValues);
+    }
+
+    /// <summary> Turns of a worker on the shared threads. The worker retires it on its last turn, later turns do nothing. </summary>
+    class WorkerTurns : public SharedThreadPool::Runnable {
+    public:
+        explicit WorkerTurns(std::function<bool()> turn) : _turn(std::move(turn)), _retired(false) {}
+
+        bool Run() override {
+            return !_retired && _turn();
+        }
+
+        /// <summary> Called on the last turn, before the worker is gone. Turns never overlap, so it needs no lock. </summary>
+        void Retire() {
+            _retired = true;
+        }
+
+    private:
+        std::function<bool()> _turn;
+        bool _retired;
+    };
+}
 
 struct Worker::Impl {
 
@@ -29,19 +280,28 @@ struct Worker::Impl {
     WorkerId id;
 
     /// <summary> The thread that executes the tasks. </summary>
-    std::thread workerThread;
+    platform::Thread workerThread;
 
     /// <summary> Queue for tasks scheduled on this worker. </summary>
-    std::queue<std::shared_ptr<Task>> tasks;
-    
-    /// <summary> Condition variable to indicate if there are more tasks to consume. </summary>
-    std::condition_variable hasTaskEvent;
+    TaskQueue tasks;
 
-    /// <summary> Lock for task queue. </summary>
-    std::mutex queueLock;
+    /// <summary> Number of tasks scheduled but not finished yet. </summary>
+    std::atomic<size_t> pendingTasks { 0 };
+
+    /// <summary> Start of the running task in steady clock ticks, 0 between tasks. </summary>
+    std::atomic<int64_t> taskStart { 0 };
+
+    /// <summary> Whether the isolate is recycled after the current task, see RequestRecycle(). </summary>
+    std::atomic<bool> recycleRequested { false };
 
     /// <summary> V8 isolate associated with this worker. </summary>
-    v8::Isolate* isolate;
+    v8::Isolate* isolate = nullptr;
+
+    /// <summary> Guards the isolate being replaced or disposed by the worker thread, while other threads interrupt it. </summary>
+    std::mutex isolateLock;
+
+    /// <summary> Bootstrapped context of a spare isolate adopted from the isolate pool, empty otherwise. </summary>
+    v8::Persistent<v8::Context> adoptedContext;
 
     /// <summary> A callback function to setup the isolate after worker created its isolate. </summary>
     std::function<void(WorkerId)> setupCallback;
@@ -49,143 +309,709 @@ struct Worker::Impl {
     /// <summary> A callback function that is called when worker becomes idle. </summary>
     std::function<void(WorkerId)> idleNotificationCallback;
 
+    /// <summary> A callback function that is called before the isolate is disposed for recycling. </summary>
+    std::function<bool(WorkerId)> recycleCallback;
+
+    /// <summary> Event loop serving libuv handles between tasks, if the zone has the 'eventLoop' setting. </summary>
+    /// <remarks> It outlives the isolates of the worker, handles are closed before an isolate is disposed. </remarks>
+    std::unique_ptr<EventLoop> eventLoop;
+
+    /// <summary> Idle periods so far, and how many of them ended while spinning. </summary>
+    uint64_t idlePeriods = 0;
+    uint64_t spinHits = 0;
+
     /// <summary> The zone settings for the current worker. </summary>
     settings::ZoneSettings settings;
+
+    /// <summary> State of a worker on the shared threads kept between turns, as the next turn may run on another thread. </summary>
+    struct TurnState {
+        /// <summary> TLS data and pending work of the worker, attached to the thread of each turn. </summary>
+        WorkerContext::Items workerContext {};
+        PendingWork pendingWork;
+
+        /// <summary> The context of the isolate, empty until the first turn of each isolate sets it up. </summary>
+        v8::Persistent<v8::Context> context;
+
+        /// <summary> The thread of the last turn, the isolate is configured again for a new one. </summary>
+        std::thread::id thread;
+
+        GcMetrics gcMetrics;
+        providers::BoundMetricPtr busyTime;
+        providers::BoundMetricPtr idleTime;
+        providers::BoundMetricPtr cpuBudgetWaitTime;
+        std::shared_ptr<CpuGovernor::Share> cpuShare;
+
+        uint32_t generation = 0;
+        uint64_t tasksServed = 0;
+        uint64_t recycleTaskCount = 0;
+        uint32_t uncheckpointedTasks = 0;
+
+        /// <summary> Whether the worker was idle since its last task, it notifies the scheduler once per idle period. </summary>
+        bool idle = false;
+        std::chrono::steady_clock::time_point idleStart;
+
+        bool started = false;
+
+        /// <summary> Set once the isolate is disposed on shutdown, guarded by the isolate lock. </summary>
+        bool disposed = false;
+        std::condition_variable disposedEvent;
+    };
+
+    /// <summary> Turns of the worker on the shared threads and their state, if the zone has the 'sharedThreads' setting. </summary>
+    std::shared_ptr<WorkerTurns> turns;
+    std::unique_ptr<TurnState> turnState;
 };
 
 Worker::Worker(WorkerId id,
                const settings::ZoneSettings& settings,
                std::function<void(WorkerId)> setupCallback,
-               std::function<void(WorkerId)> idleNotificationCallback)
+               std::function<void(WorkerId)> idleNotificationCallback,
+               std::function<bool(WorkerId)> recycleCallback)
     : _impl(std::make_unique<Worker::Impl>()) {
 
     _impl->id = id;
     _impl->setupCallback = std::move(setupCallback);
     _impl->idleNotificationCallback = std::move(idleNotificationCallback);
+    _impl->recycleCallback = std::move(recycleCallback);
     _impl->settings = settings;
+
+    if (settings.eventLoop) {
+        _impl->eventLoop = std::make_unique<EventLoop>();
+    }
+
+    if (settings.sharedThreads) {
+        // The isolate stack lives on whichever shared thread runs the turn, beyond their headroom it's capped.
+        auto maxStackSize = SharedThreadPool::GetInstance().GetStackSize() - WORKER_STACK_HEADROOM;
+        if (settings.maxStackSize > maxStackSize) {
+            LOG_WARNING("Worker", "(id=%u) The isolate stack is limited to %zu bytes on shared threads.", id, maxStackSize);
+            _impl->settings.maxStackSize = static_cast<uint32_t>(maxStackSize);
+        }
+
+        _impl->turnState = std::make_unique<Impl::TurnState>();
+        _impl->turns = std::make_shared<WorkerTurns>([this]() { return RunTurn(); });
+    }
 }
 
 Worker::~Worker() {
-    // Signal the thread loop that it should stop processing tasks.
-    Enqueue(nullptr);
-    NAPA_DEBUG("Worker", "(id=%u) Shutting down: Start draining task queue.", _impl->id);
-    
-    _impl->workerThread.join();
+    Close();
 
-    if (_impl->isolate != nullptr) {
-        _impl->isolate->Dispose();
+    if (_impl->turns != nullptr) {
+        auto& state = *_impl->turnState;
+        if (state.started) {
+            std::unique_lock<std::mutex> lock(_impl->isolateLock);
+            state.disposedEvent.wait(lock, [&state]() { return state.disposed; });
+        }
+    } else {
+        _impl->workerThread.Join();
     }
     NAPA_DEBUG("Worker", "(id=%u) Shutdown complete.", _impl->id);
 }
 
+void Worker::Close() {
+    // Signal the thread loop that it should stop processing tasks once the queue is drained.
+    _impl->tasks.Close();
+    if (_impl->eventLoop != nullptr) {
+        _impl->eventLoop->Wake();
+    }
+    NAPA_DEBUG("Worker", "(id=%u) Shutting down: Start draining task queue.", _impl->id);
+
+    // The turn that finds the queue closed and drained disposes the isolate.
+    if (_impl->turns != nullptr && _impl->turnState->started) {
+        SharedThreadPool::GetInstance().Notify(_impl->turns);
+    }
+}
+
 Worker::Worker(Worker&&) = default;
 Worker& Worker::operator=(Worker&&) = default;
 
 void Worker::Start() {
-    _impl->workerThread = std::thread(&Worker::WorkerThreadFunc, this, _impl->settings);
+    if (_impl->turns != nullptr) {
+        _impl->turnState->started = true;
+        SharedThreadPool::GetInstance().Notify(_impl->turns);
+        return;
+    }
+
+    // The thread stack holds the isolate stack, and the frames of the worker and of native code beyond the isolate limit.
+    auto stackSize = static_cast<size_t>(_impl->settings.maxStackSize) + WORKER_STACK_HEADROOM;
+    _impl->workerThread = platform::Thread([this]() { WorkerThreadFunc(_impl->settings); }, stackSize);
 }
 
 void Worker::Schedule(std::shared_ptr<Task> task) {
     NAPA_ASSERT(task != nullptr, "Task should not be null");
+    _impl->pendingTasks++;
     Enqueue(task);
     NAPA_DEBUG("Worker", "(id=%u) Task queued.", _impl->id);
 }
 
+size_t Worker::GetQueueLength() const {
+    return _impl->pendingTasks;
+}
+
+void Worker::RequestInterrupt(InterruptCallback callback, void* data) {
+    std::lock_guard<std::mutex> lock(_impl->isolateLock);
+    if (_impl->isolate != nullptr) {
+        _impl->isolate->RequestInterrupt(callback, data);
+    }
+}
+
+std::chrono::steady_clock::duration Worker::GetBusyTime() const {
+    auto taskStart = _impl->taskStart.load();
+    if (taskStart == 0) {
+        return std::chrono::steady_clock::duration::zero();
+    }
+    return Clock::Now().time_since_epoch() - std::chrono::steady_clock::duration(taskStart);
+}
+
+void Worker::RequestRecycle() {
+    _impl->recycleRequested = true;
+}
+
 void Worker::Enqueue(std::shared_ptr<Task> task) {
-    {
-        std::unique_lock<std::mutex> lock(_impl->queueLock);
-        _impl->tasks.emplace(std::move(task));
+    _impl->tasks.Push(std::move(task));
+    if (_impl->eventLoop != nullptr) {
+        _impl->eventLoop->Wake();
+    }
+    if (_impl->turns != nullptr) {
+        SharedThreadPool::GetInstance().Notify(_impl->turns);
     }
-    _impl->hasTaskEvent.notify_one();
 }
 
 void Worker::WorkerThreadFunc(const settings::ZoneSettings& settings) {
-    
-    _impl->isolate = CreateIsolate(settings);
+
+    // Pin the thread before creating the isolate, so the isolate heap is first touched, thus allocated,
+    // on the NUMA node local to the worker.
+    auto processors = GetWorkerProcessors(_impl->id, settings, platform::GetProcessorTopology());
+    if (!processors.empty()) {
+        if (platform::SetCurrentThreadAffinity(processors)) {
+            NAPA_DEBUG("Worker", "(id=%u) Pinned to %zu processor(s), starting from %u.", _impl->id, processors.size(), processors[0]);
+        } else {
+            LOG_WARNING("Worker", "(id=%u) Failed to set processor affinity.", _impl->id);
+        }
+    } else if (settings.numaNode >= 0) {
+        LOG_WARNING("Worker", "(id=%u) No processor available on NUMA node %d, worker is not pinned.", _impl->id, settings.numaNode);
+    }
+
+    // Both enums list priorities in the same order.
+    if (settings.workerPriority != settings::WorkerPriority::NORMAL
+        && !platform::SetCurrentThreadPriority(static_cast<platform::ThreadPriority>(settings.workerPriority))) {
+        LOG_WARNING("Worker", "(id=%u) Failed to set thread priority, higher priorities may require privileges.", _impl->id);
+    }
+
+    const char* dimensionNames[] = { "zone" };
+    const char* dimensionValues[] = { settings.id.c_str() };
+    auto recycles = providers::GetMetricProvider().GetMetric(
+        "Zone", "IsolateRecycles", providers::MetricType::Rate, 1, dimensionNames);
+
+    // Collections of all isolate generations are reported in metrics of the zone, by type.
+    GcMetrics workerGcMetrics;
+    BindGcMetrics(workerGcMetrics, settings.id);
+    gcMetrics = &workerGcMetrics;
+
+    // Initialize the worker context TLS data, setup callbacks of later generations reuse it.
+    INIT_WORKER_CONTEXT();
+
+    Tracing::SetThreadName(settings.id + "/worker-" + std::to_string(_impl->id));
+
+    for (uint32_t generation = 0; ; generation++) {
+        CreateWorkerIsolate(settings, generation);
+        auto isolate = _impl->isolate;
+
+        auto recycle = ServeTasks(settings, generation);
+
+        {
+            std::lock_guard<std::mutex> lock(_impl->isolateLock);
+            _impl->isolate = nullptr;
+        }
+
+        // A zone shut down while profiling drops the profile, the profiler can't outlive the isolate.
+        DisposeCpuProfiler();
+        DisposeAllocationProfiler(isolate);
+        StopHeapAllocationCounter();
+        isolate->Dispose();
+
+        if (!recycle) {
+            break;
+        }
+
+        NAPA_DEBUG("Worker", "(id=%u) V8 Isolate disposed for recycling.", _impl->id);
+        if (recycles != nullptr) {
+            recycles->Increment(1, 1, dimensionValues);
+        }
+    }
+
+    gcMetrics = nullptr;
+}
+
+void Worker::CreateWorkerIsolate(const settings::ZoneSettings& settings, uint32_t generation) {
+    // The first isolate may come bootstrapped from the pool, recycled ones are always created from scratch.
+    auto spare = generation == 0 ? IsolatePool::GetInstance().Adopt(settings) : nullptr;
+    auto isolate = spare != nullptr ? spare->isolate : CreateIsolate(settings);
+    {
+        std::lock_guard<std::mutex> lock(_impl->isolateLock);
+        _impl->isolate = isolate;
+    }
+
+    if (spare != nullptr) {
+        _impl->adoptedContext.Reset(spare->isolate, spare->context);
+        spare->context.Reset();
+        WorkerContext::Attach(spare->workerContext);
+        NAPA_DEBUG("Worker", "(id=%u) Adopted a spare V8 Isolate.", _impl->id);
+    }
+}
+
+bool Worker::ServeTasks(const settings::ZoneSettings& settings, uint32_t generation) {
 
     // If any user of v8 library uses a locker on any isolate, all isolates must be locked before use.
-    // Since we are 1-1 with threads and isolates, a top level lock that is never released is ok.
+    // Since we are 1-1 with threads and isolates, a top level lock that is only released to recycle the isolate is ok.
     v8::Locker locker(_impl->isolate);
 
     ConfigureIsolate(_impl->isolate, settings);
 
+    // With a batch size, the worker runs microtasks at checkpoints of its own instead of V8 as each call returns.
+    auto microtaskBatchSize = settings.microtaskBatchSize;
+    _impl->isolate->SetMicrotasksPolicy(microtaskBatchSize > 0 ? v8::MicrotasksPolicy::kExplicit : v8::MicrotasksPolicy::kAuto);
+
+    // Collections are traced along with the calls they delay.
+    _impl->isolate->AddGCPrologueCallback(OnGcPrologue);
+    _impl->isolate->AddGCEpilogueCallback(OnGcEpilogue);
+
     v8::Isolate::Scope isolateScope(_impl->isolate);
     v8::HandleScope handleScope(_impl->isolate);
-    v8::Local<v8::Context> context = v8::Context::New(_impl->isolate);
-
-    // We set an empty security token so callee can access caller's context.
-    context->SetSecurityToken(v8::Undefined(_impl->isolate));
+    v8::Local<v8::Context> context;
+    if (!_impl->adoptedContext.IsEmpty()) {
+        context = v8::Local<v8::Context>::New(_impl->isolate, _impl->adoptedContext);
+        _impl->adoptedContext.Reset();
+    } else {
+        context = v8::Context::New(_impl->isolate);
+
+        // We set an empty security token so callee can access caller's context.
+        context->SetSecurityToken(v8::Undefined(_impl->isolate));
+    }
     v8::Context::Scope contextScope(context);
 
     NAPA_DEBUG("Worker", "(id=%u) V8 Isolate created.", _impl->id);
 
+    auto eventLoop = _impl->eventLoop.get();
+    WorkerContext::Set(WorkerContextItem::EVENT_LOOP, eventLoop);
+
     // Setup worker after isolate creation.
     _impl->setupCallback(_impl->id);
     NAPA_DEBUG("Worker", "(id=%u) Setup completed.", _impl->id);
 
+    auto bindMetric = [&](const char* name, providers::MetricType type) {
+        return BindWorkerMetric(settings.id, _impl->id, name, type);
+    };
+
+    // Percentage of idle periods that ended while spinning, i.e. without paying for park/unpark.
+    auto spinHitRatio = bindMetric("IdleSpinHitRatio", providers::MetricType::Number);
+
+    // Time in microseconds spent in garbage collection between tasks, instead of in them.
+    auto idleGcTime = bindMetric("IdleGcTime", providers::MetricType::Rate);
+
+    // Time in microseconds spent running tasks and waiting for them, their ratio is how busy the worker is.
+    auto busyTime = bindMetric("WorkerBusyTime", providers::MetricType::Rate);
+    auto idleTime = bindMetric("WorkerIdleTime", providers::MetricType::Rate);
+
+    // Time in microseconds spent waiting for a slot of the process-wide CPU budget with a task at hand.
+    auto cpuBudgetWaitTime = bindMetric("CpuBudgetWaitTime", providers::MetricType::Rate);
+    auto& cpuGovernor = CpuGovernor::GetInstance();
+    auto cpuShare = cpuGovernor.GetShare(settings.id, settings.cpuWeight);
+    IdleGcPolicy idleGc(settings);
+
+    auto spinTime = std::chrono::microseconds(settings.idleSpinTime);
+    auto& idlePeriods = _impl->idlePeriods;
+    auto& spinHits = _impl->spinHits;
+
+    auto recycleTaskCount = _impl->recycleCallback ? GetRecycleTaskCount(_impl->id, generation, settings) : 0;
+    auto checkHeap = _impl->recycleCallback && (settings.recycleHeapSize > 0 || settings.recycleFragmentation > 0);
+    uint64_t tasksServed = 0;
+
+    // Tasks, or runs of I/O callbacks, served since the last microtask checkpoint.
+    uint32_t uncheckpointedTasks = 0;
+    auto runMicrotasks = [this, &uncheckpointedTasks]() {
+        if (uncheckpointedTasks > 0) {
+            uncheckpointedTasks = 0;
+            _impl->isolate->CancelTerminateExecution();
+            _impl->isolate->RunMicrotasks();
+        }
+    };
+
+    // Tasks are taken from the queue in batches, which run one at a time as if they were popped one by one.
+    std::vector<std::shared_ptr<Task>> batch;
+    batch.reserve(WORKER_BATCH_SIZE);
+    size_t batchNext = 0;
+    auto popTask = [this, &batch, &batchNext](std::shared_ptr<Task>& task) {
+        if (batchNext == batch.size()) {
+            batch.clear();
+            batchNext = 0;
+            if (_impl->tasks.TryPopBatch(batch, WORKER_BATCH_SIZE) == 0) {
+                return false;
+            }
+        }
+        task = std::move(batch[batchNext++]);
+        return true;
+    };
+
     while (true) {
         std::shared_ptr<Task> task;
 
-        {
-            std::unique_lock<std::mutex> lock(_impl->queueLock);
-            if (_impl->tasks.empty()) {
-                _impl->idleNotificationCallback(_impl->id);
+        // Ready I/O callbacks run ahead of each task, so a busy worker doesn't starve them.
+        if (eventLoop != nullptr) {
+            eventLoop->RunPending();
+            if (microtaskBatchSize > 0) {
+                uncheckpointedTasks++;
+            }
+        }
+
+        if (!popTask(task)) {
+            // Continuations of promises don't wait for more tasks to fill the microtask batch.
+            runMicrotasks();
+        }
+
+        if (task == nullptr && !popTask(task)) {
+            auto idleStart = Clock::Now();
 
-                // Wait until new tasks come.
-                _impl->hasTaskEvent.wait(lock, [this]() { return !_impl->tasks.empty(); });
+            // The scheduler may enqueue a task on this worker from the callback.
+            _impl->idleNotificationCallback(_impl->id);
+
+            if (spinTime.count() > 0) {
+                idlePeriods++;
+                if (_impl->tasks.TrySpinPop(task, spinTime)) {
+                    spinHits++;
+                }
+
+                if (spinHitRatio != nullptr) {
+                    spinHitRatio->Set(static_cast<int64_t>(spinHits * 100 / idlePeriods));
+                }
+            }
+
+            // Nothing is queued for the worker, neither in the zone, which is when GC doesn't delay any call.
+            if (task == nullptr && idleGc.IsEnabled() && !_impl->tasks.TryPop(task)) {
+                std::chrono::steady_clock::duration gcTime(0);
+                task = CollectGarbageWhileIdle(_impl->isolate, _impl->tasks, eventLoop, idleGc, idleStart, gcTime);
+
+                if (idleGcTime != nullptr && gcTime.count() > 0) {
+                    idleGcTime->Increment(std::chrono::duration_cast<std::chrono::microseconds>(gcTime).count());
+                }
+            }
+
+            if (task == nullptr) {
+                // Park until new tasks come, or I/O callbacks are ready.
+                WaitForTask(_impl->tasks, eventLoop, task, std::chrono::microseconds(-1));
             }
 
-            task = _impl->tasks.front();
-            _impl->tasks.pop();
+            auto idleDuration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::Now() - idleStart);
+            if (idleGc.IsEnabled()) {
+                idleGc.EndIdlePeriod(idleDuration);
+            }
+
+            if (idleTime != nullptr) {
+                idleTime->Increment(idleDuration.count());
+            }
         }
 
-        // A null task means that the worker needs to shutdown.
+        // A null task means that the queue was closed and drained, the worker needs to shutdown.
         if (task == nullptr) {
             NAPA_DEBUG("Worker", "(id=%u) Finish serving tasks.", _impl->id);
-            break;
+            if (eventLoop != nullptr) {
+                eventLoop->CloseHandles();
+            }
+            return false;
         }
 
         // Resume execution capabilities if isolate was previously terminated.
         _impl->isolate->CancelTerminateExecution();
 
+        // Zones share the CPU budget by weight, the worker holds a slot only while it runs the task.
+        auto taskStart = Clock::Now();
+        cpuGovernor.Acquire(*cpuShare);
+        if (cpuBudgetWaitTime != nullptr && cpuGovernor.GetBudget() > 0) {
+            auto now = Clock::Now();
+            cpuBudgetWaitTime->Increment(std::chrono::duration_cast<std::chrono::microseconds>(now - taskStart).count());
+            taskStart = now;
+        }
+
+        _impl->taskStart = taskStart.time_since_epoch().count();
         task->Execute();
+        _impl->taskStart = 0;
+        cpuGovernor.Release();
+        task.reset();
+        _impl->pendingTasks--;
+        tasksServed++;
+
+        if (microtaskBatchSize > 0 && ++uncheckpointedTasks >= microtaskBatchSize) {
+            runMicrotasks();
+        }
+
+        // Functions the tasks ran are compiled by now, workers loading the modules later don't compile them lazily again.
+        if (tasksServed == settings.codeCacheWarmUpTasks) {
+            auto warmed = module::ModuleLoader::WarmCodeCaches();
+            NAPA_DEBUG("Worker", "(id=%u) Warmed %zu code caches after %u tasks.", _impl->id, warmed, settings.codeCacheWarmUpTasks);
+        }
+
+        if (busyTime != nullptr) {
+            auto taskDuration = std::chrono::duration_cast<std::chrono::microseconds>(Clock::Now() - taskStart);
+            busyTime->Increment(taskDuration.count());
+        }
+
+        // Recycle between tasks, the worker doesn't mark itself idle until the new isolate is set up,
+        // so the other workers keep serving the zone meanwhile. Tasks left in the batch run on this isolate first.
+        auto batchDrained = batchNext == batch.size();
+        bool recycle = batchDrained && recycleTaskCount > 0 && tasksServed >= recycleTaskCount;
+        if (!recycle && batchDrained && _impl->recycleCallback) {
+            recycle = _impl->recycleRequested;
+        }
+        if (!recycle && batchDrained && checkHeap) {
+            v8::HeapStatistics heapStatistics;
+            _impl->isolate->GetHeapStatistics(&heapStatistics);
+            recycle = IsHeapRecycleNeeded({ heapStatistics.used_heap_size(), heapStatistics.total_heap_size() }, settings);
+        }
+
+        // Active handles postpone recycling like pending timers, as closing them would drop their callbacks.
+        if (recycle && eventLoop != nullptr && eventLoop->HasActiveHandles()) {
+            recycle = false;
+        }
+
+        // So is profiling, a profile covers a single isolate.
+        if (recycle && (IsCpuProfiling() || IsAllocationProfiling())) {
+            recycle = false;
+        }
+
+        // Continuations are run in the isolate they were queued in, before it's gone.
+        if (recycle) {
+            runMicrotasks();
+        }
+
+        // The callback may postpone, the policy is checked again after the next task.
+        if (recycle && _impl->recycleCallback(_impl->id)) {
+            NAPA_DEBUG("Worker", "(id=%u) Recycling V8 Isolate after %llu tasks.", _impl->id, static_cast<unsigned long long>(tasksServed));
+            _impl->recycleRequested = false;
+
+            // Inactive or unreferenced handles are left, they would call back into the disposed isolate.
+            if (eventLoop != nullptr) {
+                eventLoop->CloseHandles();
+            }
+            return true;
+        }
     }
 }
 
-static v8::Isolate* CreateIsolate(const settings::ZoneSettings& settings) {
-    v8::Isolate::CreateParams createParams;
+bool Worker::RunTurn() {
+    auto& settings = _impl->settings;
+    auto& state = *_impl->turnState;
+
+    // Shared threads run workers of any zone, each attaches its TLS data and pending work for the turn.
+    if (!sharedThreadInitialized) {
+        INIT_WORKER_CONTEXT();
+        Tracing::SetThreadName("shared-worker-thread");
+        sharedThreadInitialized = true;
+    }
+    WorkerContext::Attach(state.workerContext);
+    SetPendingWork(std::move(state.pendingWork));
+    gcMetrics = &state.gcMetrics;
+
+    if (_impl->isolate == nullptr) {
+        if (state.generation == 0) {
+            BindGcMetrics(state.gcMetrics, settings.id);
+            state.busyTime = BindWorkerMetric(settings.id, _impl->id, "WorkerBusyTime", providers::MetricType::Rate);
+            state.idleTime = BindWorkerMetric(settings.id, _impl->id, "WorkerIdleTime", providers::MetricType::Rate);
+            state.cpuBudgetWaitTime = BindWorkerMetric(settings.id, _impl->id, "CpuBudgetWaitTime", providers::MetricType::Rate);
+            state.cpuShare = CpuGovernor::GetInstance().GetShare(settings.id, settings.cpuWeight);
+        }
+        CreateWorkerIsolate(settings, state.generation);
+    }
+
+    auto end = ServeTurn(settings);
 
-    // The allocator is a global V8 setting.
-#if (V8_MAJOR_VERSION == 5 && V8_MINOR_VERSION >= 5) || V8_MAJOR_VERSION > 5
-    static std::unique_ptr<v8::ArrayBuffer::Allocator> defaultArrayBufferAllocator(v8::ArrayBuffer::Allocator::NewDefaultAllocator());
-    createParams.array_buffer_allocator = defaultArrayBufferAllocator.get();
-#else
-    static napa::v8_extensions::ArrayBufferAllocator commonAllocator;
-    createParams.array_buffer_allocator = &commonAllocator;
-#endif
+    // The heap allocation counter is registered on the isolate per thread, calls measure it within a turn.
+    StopHeapAllocationCounter();
+    state.pendingWork = GetPendingWork();
+    SetPendingWork(nullptr);
+    gcMetrics = nullptr;
+    state.workerContext = WorkerContext::Detach();
 
-    // Set the maximum V8 heap size.
-    createParams.constraints.set_max_old_space_size(settings.maxOldSpaceSize);
-    createParams.constraints.set_max_semi_space_size(settings.maxSemiSpaceSize);
-    createParams.constraints.set_max_executable_size(settings.maxExecutableSize);
+    if (end == TurnEnd::MORE || end == TurnEnd::IDLE) {
+        return end == TurnEnd::MORE;
+    }
+
+    auto isolate = _impl->isolate;
+    {
+        std::lock_guard<std::mutex> lock(_impl->isolateLock);
+        _impl->isolate = nullptr;
+    }
+    isolate->Dispose();
+
+    if (end == TurnEnd::RECYCLE) {
+        NAPA_DEBUG("Worker", "(id=%u) V8 Isolate disposed for recycling.", _impl->id);
+        const char* dimensionNames[] = { "zone" };
+        const char* dimensionValues[] = { settings.id.c_str() };
+        auto recycles = providers::GetMetricProvider().GetMetric(
+            "Zone", "IsolateRecycles", providers::MetricType::Rate, 1, dimensionNames);
+        if (recycles != nullptr) {
+            recycles->Increment(1, 1, dimensionValues);
+        }
+
+        // The next turn creates the new isolate, and configures it for its thread.
+        state.generation++;
+        state.thread = std::thread::id();
+        return true;
+    }
 
-    return v8::Isolate::New(createParams);
+    // The destructor may free the worker as soon as it's signaled, which is the last thing the turn does.
+    _impl->turns->Retire();
+    std::lock_guard<std::mutex> lock(_impl->isolateLock);
+    state.disposed = true;
+    state.disposedEvent.notify_all();
+    return false;
 }
 
-static void ConfigureIsolate(v8::Isolate* isolate, const settings::ZoneSettings& settings) {
-    isolate->SetFatalErrorHandler([](const char* location, const char* message) {
-        LOG_ERROR("V8", "V8 Fatal error at %s. Error: %s", location, message);
-    });
+Worker::TurnEnd Worker::ServeTurn(const settings::ZoneSettings& settings) {
+    auto& state = *_impl->turnState;
+    auto isolate = _impl->isolate;
+
+    // The isolate is locked for the turn only, the thread runs other workers between turns.
+    v8::Locker locker(isolate);
+
+    // The stack limit is an address on the stack of the thread.
+    if (state.thread != std::this_thread::get_id()) {
+        ConfigureIsolate(isolate, settings);
+        state.thread = std::this_thread::get_id();
+    }
+
+    v8::Isolate::Scope isolateScope(isolate);
+    v8::HandleScope handleScope(isolate);
+
+    auto setup = state.context.IsEmpty();
+    v8::Local<v8::Context> context;
+    if (setup) {
+        isolate->SetMicrotasksPolicy(settings.microtaskBatchSize > 0 ? v8::MicrotasksPolicy::kExplicit : v8::MicrotasksPolicy::kAuto);
+        isolate->AddGCPrologueCallback(OnGcPrologue);
+        isolate->AddGCEpilogueCallback(OnGcEpilogue);
+
+        if (!_impl->adoptedContext.IsEmpty()) {
+            context = v8::Local<v8::Context>::New(isolate, _impl->adoptedContext);
+            _impl->adoptedContext.Reset();
+        } else {
+            context = v8::Context::New(isolate);
+            context->SetSecurityToken(v8::Undefined(isolate));
+        }
+        state.context.Reset(isolate, context);
+    } else {
+        context = v8::Local<v8::Context>::New(isolate, state.context);
+    }
+    v8::Context::Scope contextScope(context);
+
+    if (setup) {
+        NAPA_DEBUG("Worker", "(id=%u) V8 Isolate created on a shared thread.", _impl->id);
+        _impl->setupCallback(_impl->id);
+
+        state.tasksServed = 0;
+        state.recycleTaskCount = _impl->recycleCallback ? GetRecycleTaskCount(_impl->id, state.generation, settings) : 0;
+        state.idle = false;
+    }
+
+    auto& cpuGovernor = CpuGovernor::GetInstance();
+    auto checkHeap = _impl->recycleCallback && (settings.recycleHeapSize > 0 || settings.recycleFragmentation > 0);
+    auto runMicrotasks = [&state, isolate]() {
+        if (state.uncheckpointedTasks > 0) {
+            state.uncheckpointedTasks = 0;
+            isolate->CancelTerminateExecution();
+            isolate->RunMicrotasks();
+        }
+    };
+
+    auto turnEnd = Clock::Now() + SHARED_TURN_TIME;
+    while (true) {
+        std::shared_ptr<Task> task;
+        if (!_impl->tasks.TryPop(task)) {
+            // Continuations of promises don't wait for the next turn.
+            runMicrotasks();
 
-    // Prevent V8 from aborting on uncaught exception.
-    isolate->SetAbortOnUncaughtExceptionCallback([](v8::Isolate*) {
-        LOG_ERROR("V8", "V8 uncaught exception was thrown.");
-        return false;
-    });
+            if (!state.idle && !_impl->tasks.TryPop(task)) {
+                state.idle = true;
+                state.idleStart = Clock::Now();
 
-    // V8 takes a pointer to the minimum (x86 stack grows down) allowed stack address
-    // so, capture the current top of the stack and calculate minimum allowed
-    uint32_t currentStackAddress;
-    auto limit = (reinterpret_cast<uintptr_t>(&currentStackAddress - settings.maxStackSize / sizeof(uint32_t*)));
-    isolate->SetStackLimit(limit);
+                // The scheduler may enqueue a task on this worker from the callback.
+                _impl->idleNotificationCallback(_impl->id);
+            }
+
+            // A task enqueued from now on notifies the worker, which takes another turn.
+            if (task == nullptr && !_impl->tasks.TryPop(task)) {
+                if (!_impl->tasks.IsClosed()) {
+                    return TurnEnd::IDLE;
+                }
+
+                NAPA_DEBUG("Worker", "(id=%u) Finish serving tasks.", _impl->id);
+                state.context.Reset();
+                return TurnEnd::SHUTDOWN;
+            }
+        }
+
+        if (state.idle) {
+            state.idle = false;
+            if (state.idleTime != nullptr) {
+                state.idleTime->Increment(
+                    std::chrono::duration_cast<std::chrono::microseconds>(Clock::Now() - state.idleStart).count());
+            }
+        }
+
+        // Resume execution capabilities if isolate was previously terminated.
+        isolate->CancelTerminateExecution();
+
+        auto taskStart = Clock::Now();
+        cpuGovernor.Acquire(*state.cpuShare);
+        if (state.cpuBudgetWaitTime != nullptr && cpuGovernor.GetBudget() > 0) {
+            auto now = Clock::Now();
+            state.cpuBudgetWaitTime->Increment(std::chrono::duration_cast<std::chrono::microseconds>(now - taskStart).count());
+            taskStart = now;
+        }
+
+        _impl->taskStart = taskStart.time_since_epoch().count();
+        task->Execute();
+        _impl->taskStart = 0;
+        cpuGovernor.Release();
+        task.reset();
+        _impl->pendingTasks--;
+        state.tasksServed++;
+
+        if (settings.microtaskBatchSize > 0 && ++state.uncheckpointedTasks >= settings.microtaskBatchSize) {
+            runMicrotasks();
+        }
+
+        if (state.tasksServed == settings.codeCacheWarmUpTasks) {
+            auto warmed = module::ModuleLoader::WarmCodeCaches();
+            NAPA_DEBUG("Worker", "(id=%u) Warmed %zu code caches after %u tasks.", _impl->id, warmed, settings.codeCacheWarmUpTasks);
+        }
+
+        auto now = Clock::Now();
+        if (state.busyTime != nullptr) {
+            state.busyTime->Increment(std::chrono::duration_cast<std::chrono::microseconds>(now - taskStart).count());
+        }
+
+        bool recycle = state.recycleTaskCount > 0 && state.tasksServed >= state.recycleTaskCount;
+        if (!recycle && _impl->recycleCallback) {
+            recycle = _impl->recycleRequested;
+        }
+        if (!recycle && checkHeap) {
+            v8::HeapStatistics heapStatistics;
+            isolate->GetHeapStatistics(&heapStatistics);
+            recycle = IsHeapRecycleNeeded({ heapStatistics.used_heap_size(), heapStatistics.total_heap_size() }, settings);
+        }
+
+        if (recycle) {
+            runMicrotasks();
+        }
+
+        if (recycle && _impl->recycleCallback(_impl->id)) {
+            NAPA_DEBUG("Worker", "(id=%u) Recycling V8 Isolate after %llu tasks.", _impl->id, static_cast<unsigned long long>(state.tasksServed));
+            _impl->recycleRequested = false;
+            state.context.Reset();
+            return TurnEnd::RECYCLE;
+        }
+
+        // Other workers of the thread get a turn, the worker is queued behind them.
+        if (now >= turnEnd) {
+            return TurnEnd::MORE;
+        }
+    }
 }
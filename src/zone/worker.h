@@ -6,9 +6,13 @@
 #include "task.h"
 #include "settings/settings.h"
 
+#include <chrono>
 #include <functional>
 #include <memory>
 
+namespace v8 {
+    class Isolate;
+}
 
 namespace napa {
 namespace zone {
@@ -16,6 +20,9 @@ namespace zone {
     // Represent the worker id type.
     using WorkerId = uint32_t;
 
+    /// <summary> Callback run by a worker isolate on interruption, same as v8::InterruptCallback. </summary>
+    using InterruptCallback = void (*)(v8::Isolate* isolate, void* data);
+
     /// <summary> Represents an execution unit (a worker) for running tasks. </summary>
     class Worker {
     public:
@@ -25,15 +32,25 @@ namespace zone {
         /// <param name="settings"> A settings object. </param>
         /// <param name="setupCallback"> Callback to setup the isolate after worker created its isolate. </param>
         /// <param name="idleNotificationCallback"> Triggers when the worker becomes idle. </param>
+        /// <param name="recycleCallback">
+        ///     Called between tasks when the zone recycling policy asks to recreate the isolate. It returns false to
+        ///     postpone, otherwise it releases isolate bound state and the setup callback is called again on the new isolate.
+        ///     Optional, the isolate is never recycled without it.
+        /// </param>
         Worker(WorkerId id,
                const settings::ZoneSettings &settings,
                std::function<void(WorkerId)> setupCallback,
-               std::function<void(WorkerId)> idleNotificationCallback);
+               std::function<void(WorkerId)> idleNotificationCallback,
+               std::function<bool(WorkerId)> recycleCallback = nullptr);
 
         /// <summary> Destructor. </summary>
         /// <note> This will block until all pending tasks are completed. </note>
         ~Worker();
 
+        /// <summary> Stops accepting tasks and lets the worker shut down once its queue is drained, without waiting. </summary>
+        /// <remarks> The destructor waits for the shutdown, closing the worker first if it wasn't. </remarks>
+        void Close();
+
         /// <summary> Non-copyable. </summary>
         Worker(const Worker&) = delete;
         Worker& operator=(const Worker&) = delete;
@@ -42,7 +59,7 @@ namespace zone {
         Worker(Worker&&);
         Worker& operator=(Worker&&);
 
-        /// <summary> Start the underlying worker thread. </summary>
+        /// <summary> Start the underlying worker thread, or the first turn on the shared threads. </summary>
         void Start();
 
         /// <summary> Schedules a task on this worker. </summary>
@@ -50,11 +67,57 @@ namespace zone {
         /// <note> Same task instance may run on multiple workers, hence the use of shared_ptr. </node>
         void Schedule(std::shared_ptr<Task> task);
 
+        /// <summary> Gets the number of tasks scheduled on this worker that haven't finished, including the running one. </summary>
+        size_t GetQueueLength() const;
+
+        /// <summary> Requests the worker isolate to run a callback on the worker thread, while it runs JavaScript. </summary>
+        /// <remarks>
+        ///     It's thread-safe and doesn't wait behind queued tasks. An idle worker runs the callback once it runs JavaScript
+        ///     again. No-op while the worker has no isolate, i.e. before it started or while its isolate is recycled.
+        /// </remarks>
+        void RequestInterrupt(InterruptCallback callback, void* data);
+
+        /// <summary> Gets how long the worker has run its current task, zero between tasks. It's thread-safe. </summary>
+        std::chrono::steady_clock::duration GetBusyTime() const;
+
+        /// <summary> Requests the worker to recycle its isolate once it finishes its current task. </summary>
+        /// <remarks> It's thread-safe. The recycle callback may still postpone, it's a no-op without one. </remarks>
+        void RequestRecycle();
+
     private:
 
         /// <summary> The worker thread logic. </summary>
         void WorkerThreadFunc(const settings::ZoneSettings& settings);
 
+        /// <summary> Serves tasks on the current isolate. </summary>
+        /// <returns> True if the isolate needs to be recycled, false if the worker is shutting down. </returns>
+        bool ServeTasks(const settings::ZoneSettings& settings, uint32_t generation);
+
+        /// <summary> Adopts a spare isolate from the isolate pool, or creates one, as the isolate of the worker. </summary>
+        void CreateWorkerIsolate(const settings::ZoneSettings& settings, uint32_t generation);
+
+        /// <summary> How a turn of a worker on the shared threads ended. </summary>
+        enum class TurnEnd {
+            /// <summary> Tasks are left, the worker takes another turn. </summary>
+            MORE,
+
+            /// <summary> The queue is empty, the worker takes a turn once a task arrives. </summary>
+            IDLE,
+
+            /// <summary> The isolate needs to be recycled. </summary>
+            RECYCLE,
+
+            /// <summary> The queue was closed and drained, the worker is shutting down. </summary>
+            SHUTDOWN
+        };
+
+        /// <summary> Takes a turn on a thread of the shared pool, if the zone has the 'sharedThreads' setting. </summary>
+        /// <returns> True if the worker needs another turn. </returns>
+        bool RunTurn();
+
+        /// <summary> Serves tasks on the current isolate for a turn, setting it up on the first turn of each isolate. </summary>
+        TurnEnd ServeTurn(const settings::ZoneSettings& settings);
+
         /// <summary> Enqueue a task. </summary>
         void Enqueue(std::shared_ptr<Task> task);
 
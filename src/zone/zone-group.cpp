@@ -0,0 +1,260 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "zone-group.h"
+#include "clock.h"
+
+#include "batch-callback.h"
+
+#include <utils/debug.h>
+
+#include <napa/log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Weight of a new latency sample in the moving average of a member, as a power of 2. </summary>
+    const uint64_t LATENCY_AVERAGE_SHIFT = 3;
+
+    /// <summary> Random numbers of the routing thread, which needs no lock. </summary>
+    uint32_t NextRandom() {
+        thread_local std::minstd_rand random(static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())));
+        return static_cast<uint32_t>(random());
+    }
+}
+
+ZoneGroup::ZoneGroup(std::string id, std::vector<Member> members, ZoneGroupSettings settings) :
+    _id(std::move(id)),
+    _settings(settings),
+    _mixed(false) {
+    NAPA_ASSERT(!members.empty(), "a zone group needs members");
+
+    for (auto& member : members) {
+        NAPA_ASSERT(member.zone != nullptr, "member zone is null");
+        _mixed = _mixed || member.remote != members.front().remote;
+
+        auto state = std::make_shared<MemberState>();
+        state->member = std::move(member);
+        state->pendingCalls = 0;
+        state->latency = 0;
+        state->disconnected = false;
+        _members.emplace_back(std::move(state));
+    }
+}
+
+const std::string& ZoneGroup::GetId() const {
+    return _id;
+}
+
+void ZoneGroup::Broadcast(const std::string& source, BroadcastCallback callback) {
+    struct BroadcastState {
+        std::atomic<size_t> remaining;
+        std::atomic<ResultCode> code;
+        BroadcastCallback callback;
+    };
+
+    auto state = std::make_shared<BroadcastState>();
+    state->remaining = _members.size();
+    state->code = NAPA_RESULT_SUCCESS;
+    state->callback = std::move(callback);
+
+    for (const auto& member : _members) {
+        member->member.zone->Broadcast(source, [state](ResultCode code) {
+            auto expected = NAPA_RESULT_SUCCESS;
+            if (code != NAPA_RESULT_SUCCESS) {
+                state->code.compare_exchange_strong(expected, code);
+            }
+
+            // The last member to finish reports the broadcast.
+            if (--state->remaining == 0) {
+                state->callback(state->code);
+            }
+        });
+    }
+}
+
+void ZoneGroup::Execute(const FunctionSpec& spec, ExecuteCallback callback) {
+    auto index = Route(spec);
+    const auto& state = _members[index];
+    state->member.zone->Execute(spec, Track(state, std::move(callback)));
+}
+
+void ZoneGroup::ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) {
+    ExecuteBatch(specs, CreateBatchCallbacks(specs.size(), std::move(callback)));
+}
+
+void ZoneGroup::ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) {
+    NAPA_ASSERT(specs.size() == callbacks.size(), "specs and callbacks must have the same size");
+
+    std::vector<std::vector<FunctionSpec>> memberSpecs(_members.size());
+    std::vector<std::vector<ExecuteCallback>> memberCallbacks(_members.size());
+    for (size_t i = 0; i < specs.size(); i++) {
+        const auto& spec = specs[i];
+        auto index = Route(spec);
+
+        // Arguments are still the caller's, members copy or keep them before ExecuteBatch returns.
+        FunctionSpec routed;
+        routed.module = spec.module;
+        routed.function = spec.function;
+        routed.arguments = spec.arguments;
+        routed.options = spec.options;
+        routed.transportContext = std::move(spec.transportContext);
+        routed.argumentsOwner = spec.argumentsOwner;
+
+        memberSpecs[index].emplace_back(std::move(routed));
+        memberCallbacks[index].emplace_back(Track(_members[index], std::move(callbacks[i])));
+    }
+
+    for (size_t index = 0; index < _members.size(); index++) {
+        if (!memberSpecs[index].empty()) {
+            _members[index]->member.zone->ExecuteBatch(memberSpecs[index], std::move(memberCallbacks[index]));
+        }
+    }
+}
+
+float ZoneGroup::GetPressure() const {
+    auto pressure = _members.front()->member.zone->GetPressure();
+    for (const auto& member : _members) {
+        pressure = std::min(pressure, member->member.zone->GetPressure());
+    }
+    return pressure;
+}
+
+uint32_t ZoneGroup::GetWorkers() const {
+    uint32_t workers = 0;
+    for (const auto& member : _members) {
+        workers += member->member.zone->GetWorkers();
+    }
+    return workers;
+}
+
+void ZoneGroup::Resize(uint32_t, ResizeCallback callback) {
+    LOG_ERROR("ZoneGroup", "Zone group \"%s\" can't be resized, its members are resized one by one.", _id.c_str());
+    callback(NAPA_RESULT_ZONE_RESIZE_ERROR);
+}
+
+void ZoneGroup::Drain(uint32_t, DrainCallback callback) {
+    LOG_ERROR("ZoneGroup", "Zone group \"%s\" can't be drained, its members are drained one by one.", _id.c_str());
+    callback(NAPA_RESULT_ZONE_DRAIN_ERROR, 0);
+}
+
+void ZoneGroup::GetMemoryUsage(MemoryUsageCallback callback) {
+    callback(std::vector<WorkerMemoryUsage>());
+}
+
+void ZoneGroup::StartProfiling(uint32_t, ProfilingCallback callback) {
+    LOG_ERROR("ZoneGroup", "Zone group \"%s\" can't be profiled, its members are profiled one by one.", _id.c_str());
+    callback(NAPA_RESULT_PROFILING_ERROR);
+}
+
+void ZoneGroup::StopProfiling(CpuProfileCallback callback) {
+    callback(std::vector<std::string>());
+}
+
+void ZoneGroup::StartAllocationProfiling(uint32_t, ProfilingCallback callback) {
+    LOG_ERROR("ZoneGroup", "Zone group \"%s\" can't be profiled, its members are profiled one by one.", _id.c_str());
+    callback(NAPA_RESULT_PROFILING_ERROR);
+}
+
+void ZoneGroup::StopAllocationProfiling(AllocationProfileCallback callback) {
+    callback(std::string());
+}
+
+void ZoneGroup::GetHeapStatistics(HeapStatisticsCallback callback) {
+    callback(std::vector<WorkerHeapStatistics>());
+}
+
+void ZoneGroup::WriteHeapSnapshot(uint32_t, const std::string&, HeapSnapshotCallback callback) {
+    LOG_ERROR("ZoneGroup", "Zone group \"%s\" has no workers of its own to snapshot.", _id.c_str());
+    callback(NAPA_RESULT_HEAP_SNAPSHOT_ERROR);
+}
+
+std::vector<napa::SlowCall> ZoneGroup::GetSlowCalls() const {
+    return std::vector<SlowCall>();
+}
+
+std::vector<napa::FunctionStats> ZoneGroup::GetFunctionStats() const {
+    return std::vector<FunctionStats>();
+}
+
+uint32_t ZoneGroup::GetPendingCalls(size_t member) const {
+    return _members[member]->pendingCalls;
+}
+
+size_t ZoneGroup::Route(const FunctionSpec& spec) {
+    size_t payloadSize = 0;
+    for (const auto& argument : spec.arguments) {
+        payloadSize += argument.size;
+    }
+    bool preferLocal = _mixed && payloadSize <= _settings.localPayloadSize && _settings.localPayloadSize > 0;
+
+    // Candidates are connected members, local ones with room for small calls. Failing that any connected member,
+    // failing that any member, whose calls then fail as they would have anyway.
+    thread_local std::vector<size_t> candidates;
+    candidates.clear();
+    for (int pass = preferLocal ? 0 : 1; pass < 3 && candidates.empty(); pass++) {
+        for (size_t i = 0; i < _members.size(); i++) {
+            const auto& state = *_members[i];
+            if (pass == 0 && (state.member.remote || state.disconnected || state.member.zone->GetPressure() >= 1.0f)) {
+                continue;
+            }
+            if (pass == 1 && state.disconnected) {
+                continue;
+            }
+            candidates.push_back(i);
+        }
+    }
+
+    auto index = candidates.front();
+    if (candidates.size() > 1) {
+        auto first = NextRandom() % candidates.size();
+        auto second = NextRandom() % (candidates.size() - 1);
+        if (second >= first) {
+            second++;
+        }
+
+        index = candidates[first];
+        if (GetLoad(*_members[candidates[second]]) < GetLoad(*_members[index])) {
+            index = candidates[second];
+        }
+    }
+
+    _members[index]->pendingCalls++;
+    return index;
+}
+
+ExecuteCallback ZoneGroup::Track(std::shared_ptr<MemberState> state, ExecuteCallback callback) {
+    auto start = Clock::Now();
+    return [state = std::move(state), callback = std::move(callback), start](Result result) {
+        auto disconnected = result.code == NAPA_RESULT_ZONE_DISCONNECTED;
+        if (!disconnected) {
+            auto sample = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::Now() - start).count());
+
+            // Concurrent updates may drop a sample, which an average doesn't miss.
+            auto latency = state->latency.load();
+            auto updated = latency == 0 ? sample : latency - (latency >> LATENCY_AVERAGE_SHIFT) + (sample >> LATENCY_AVERAGE_SHIFT);
+            state->latency.compare_exchange_strong(latency, std::max<uint64_t>(updated, 1));
+        }
+        state->disconnected = disconnected;
+        state->pendingCalls--;
+
+        callback(std::move(result));
+    };
+}
+
+double ZoneGroup::GetLoad(const MemberState& state) {
+    // Members without latency yet look idle, so each gets tried early.
+    auto workers = std::max<uint32_t>(state.member.zone->GetWorkers(), 1);
+    auto latency = std::max<uint64_t>(state.latency, 1);
+    auto pressure = state.member.zone->GetPressure();
+    return (state.pendingCalls + 1.0) / workers * static_cast<double>(latency) * (1.0 + pressure);
+}
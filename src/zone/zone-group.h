@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "zone.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Settings of a zone group. </summary>
+    struct ZoneGroupSettings {
+
+        /// <summary> Calls whose arguments take up to this many bytes prefer local members, 0 to route all calls alike. </summary>
+        uint32_t localPayloadSize = 16 * 1024;
+    };
+
+    /// <summary> A zone routing each call to the least loaded of its members, local zones and remote zones alike. </summary>
+    /// <remarks>
+    ///     Each call samples two members at random and goes to the one with the lower load (power of two choices), which
+    ///     spreads calls about as well as asking all members, without the herd effect of everyone picking the same one.
+    ///     The load of a member is the calls the group has pending on it per worker, times the average latency of its
+    ///     recent calls, raised by the pressure the member reports. So slower members, e.g. remote ones across a network,
+    ///     get fewer calls, and members whose queues fill up get fewer still.
+    ///     Small calls, which a network round trip would dominate, only go to local members while any of them has room,
+    ///     i.e. a pressure under 1. Members whose connection was lost are skipped, unless all of them were lost.
+    /// </remarks>
+    class ZoneGroup : public Zone {
+    public:
+
+        /// <summary> A member of the group. </summary>
+        struct Member {
+            std::shared_ptr<Zone> zone;
+
+            /// <summary> Whether calls to the member leave the process. </summary>
+            bool remote;
+        };
+
+        /// <summary> Constructor. </summary>
+        /// <param name="id"> The id of the group. </param>
+        /// <param name="members"> The members, at least one. </param>
+        /// <param name="settings"> Settings of the group. </param>
+        ZoneGroup(std::string id, std::vector<Member> members, ZoneGroupSettings settings);
+
+        /// <see cref="Zone::GetId" />
+        virtual const std::string& GetId() const override;
+
+        /// <see cref="Zone::Broadcast" />
+        /// <remarks> Broadcasts to all members, the callback gets the first failure, if any. </remarks>
+        virtual void Broadcast(const std::string& source, BroadcastCallback callback) override;
+
+        /// <see cref="Zone::Execute" />
+        virtual void Execute(const FunctionSpec& spec, ExecuteCallback callback) override;
+
+        /// <see cref="Zone::ExecuteBatch" />
+        /// <remarks> Calls are routed one by one, those going to the same member are sent to it as one batch. </remarks>
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) override;
+
+        /// <see cref="Zone::ExecuteBatch" />
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) override;
+
+        /// <see cref="Zone::GetPressure" />
+        /// <remarks> The lowest pressure of the members, as calls go to the least loaded one. </remarks>
+        virtual float GetPressure() const override;
+
+        /// <see cref="Zone::GetWorkers" />
+        /// <remarks> The workers of all members. </remarks>
+        virtual uint32_t GetWorkers() const override;
+
+        /// <see cref="Zone::Resize" />
+        /// <remarks> Members are resized one by one, resizing the group fails. </remarks>
+        virtual void Resize(uint32_t workers, ResizeCallback callback) override;
+
+        /// <see cref="Zone::Drain" />
+        /// <remarks> Members are drained one by one, draining the group fails. </remarks>
+        virtual void Drain(uint32_t timeout, DrainCallback callback) override;
+
+        /// <see cref="Zone::GetMemoryUsage" />
+        /// <remarks> Members are inspected one by one, it reports no worker. </remarks>
+        virtual void GetMemoryUsage(MemoryUsageCallback callback) override;
+
+        /// <see cref="Zone::StartProfiling" />
+        /// <remarks> Members are profiled one by one, starting fails. </remarks>
+        virtual void StartProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopProfiling" />
+        /// <remarks> Reports no profile. </remarks>
+        virtual void StopProfiling(CpuProfileCallback callback) override;
+
+        /// <see cref="Zone::StartAllocationProfiling" />
+        virtual void StartAllocationProfiling(uint32_t samplingInterval, ProfilingCallback callback) override;
+
+        /// <see cref="Zone::StopAllocationProfiling" />
+        virtual void StopAllocationProfiling(AllocationProfileCallback callback) override;
+
+        /// <see cref="Zone::GetHeapStatistics" />
+        /// <remarks> Reports no worker. </remarks>
+        virtual void GetHeapStatistics(HeapStatisticsCallback callback) override;
+
+        /// <see cref="Zone::WriteHeapSnapshot" />
+        /// <remarks> Snapshots are written by members, writing fails. </remarks>
+        virtual void WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) override;
+
+        /// <see cref="Zone::GetSlowCalls" />
+        /// <remarks> Slow calls are kept by the logs of members, there are none. </remarks>
+        virtual std::vector<SlowCall> GetSlowCalls() const override;
+
+        /// <see cref="Zone::GetFunctionStats" />
+        /// <remarks> Statistics are kept by members, there are none. </remarks>
+        virtual std::vector<FunctionStats> GetFunctionStats() const override;
+
+        /// <summary> Gets the number of calls the group has pending on a member. </summary>
+        uint32_t GetPendingCalls(size_t member) const;
+
+    private:
+
+        /// <summary> A member with the load feedback of its calls. </summary>
+        struct MemberState {
+            Member member;
+
+            /// <summary> Calls routed to the member and not finished. </summary>
+            std::atomic<uint32_t> pendingCalls;
+
+            /// <summary> Moving average of the latency of the member's calls, in microseconds. </summary>
+            std::atomic<uint64_t> latency;
+
+            /// <summary> Whether the last call failed as the member's connection was lost. </summary>
+            std::atomic<bool> disconnected;
+        };
+
+        /// <summary> Chooses the member of a call, and counts the call pending on it. </summary>
+        /// <returns> The index of the member. </returns>
+        size_t Route(const FunctionSpec& spec);
+
+        /// <summary> Wraps the callback of a call routed to a member, to update the member's load as the call finishes. </summary>
+        /// <remarks> The state is shared with the callback, as calls may finish after the group is gone. </remarks>
+        static ExecuteCallback Track(std::shared_ptr<MemberState> state, ExecuteCallback callback);
+
+        /// <summary> Gets the load of a member, lower is better. </summary>
+        static double GetLoad(const MemberState& state);
+
+        std::string _id;
+        ZoneGroupSettings _settings;
+        std::vector<std::shared_ptr<MemberState>> _members;
+
+        /// <summary> Whether some members are local and some remote, so payload size matters. </summary>
+        bool _mixed;
+    };
+}
+}
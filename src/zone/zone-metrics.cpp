@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "zone-metrics.h"
+#include "flight-recorder.h"
+
+using namespace napa;
+using namespace napa::zone;
+
+/// <summary> Metric dimension values of call priorities, indexed by priority. </summary>
+static const char* PRIORITY_NAMES[] = { "high", "normal", "background" };
+
+ZoneMetrics::ZoneMetrics(providers::MetricProvider& provider, const std::string& zoneId, uint32_t workerCapacity) :
+    _zoneId(zoneId),
+    _functionStats(workerCapacity) {
+    const char* priorityDimensions[] = { "zone", "priority" };
+    auto queueDepth = provider.GetMetric("Zone", "QueueDepth", providers::MetricType::Number, 2, priorityDimensions);
+    for (auto priorityName : PRIORITY_NAMES) {
+        const char* dimensionValues[] = { zoneId.c_str(), priorityName };
+        _queueDepths.push_back(providers::BindMetric(queueDepth, 2, dimensionValues));
+    }
+
+    const char* workerDimensions[] = { "zone", "worker" };
+    auto queueTime = provider.GetMetric("Zone", "CallQueueTime", providers::MetricType::Percentile, 2, workerDimensions);
+    auto executionTime = provider.GetMetric("Zone", "CallExecutionTime", providers::MetricType::Percentile, 2, workerDimensions);
+    auto bootstrapTime = provider.GetMetric("Zone", "WorkerBootstrapTime", providers::MetricType::Percentile, 2, workerDimensions);
+    for (uint32_t i = 0; i < workerCapacity; i++) {
+        auto workerId = std::to_string(i);
+        const char* dimensionValues[] = { zoneId.c_str(), workerId.c_str() };
+        _queueTimes.push_back(providers::BindMetric(queueTime, 2, dimensionValues));
+        _executionTimes.push_back(providers::BindMetric(executionTime, 2, dimensionValues));
+        _bootstrapTimes.push_back(providers::BindMetric(bootstrapTime, 2, dimensionValues));
+    }
+
+    const char* tenantDimensions[] = { "zone", "tenant" };
+    _tenantQueueTime = provider.GetMetric("Zone", "TenantQueueTime", providers::MetricType::Percentile, 2, tenantDimensions);
+
+    const char* zoneDimensions[] = { "zone" };
+    const char* zoneValues[] = { zoneId.c_str() };
+    _timeouts = providers::BindMetric(provider.GetMetric("Zone", "CallTimeouts", providers::MetricType::Rate, 1, zoneDimensions), 1, zoneValues);
+    _rejects = providers::BindMetric(provider.GetMetric("Zone", "CallRejects", providers::MetricType::Rate, 1, zoneDimensions), 1, zoneValues);
+    _hedges = providers::BindMetric(provider.GetMetric("Zone", "CallHedges", providers::MetricType::Rate, 1, zoneDimensions), 1, zoneValues);
+    _coalesced = providers::BindMetric(provider.GetMetric("Zone", "CallsCoalesced", providers::MetricType::Rate, 1, zoneDimensions), 1, zoneValues);
+    _resultCacheHits = providers::BindMetric(provider.GetMetric("Zone", "ResultCacheHits", providers::MetricType::Rate, 1, zoneDimensions), 1, zoneValues);
+    _resultCacheMisses = providers::BindMetric(provider.GetMetric("Zone", "ResultCacheMisses", providers::MetricType::Rate, 1, zoneDimensions), 1, zoneValues);
+    _stuckWorkers = providers::BindMetric(provider.GetMetric("Zone", "StuckWorkers", providers::MetricType::Number, 1, zoneDimensions), 1, zoneValues);
+    _stalls = providers::BindMetric(provider.GetMetric("Zone", "WorkerStalls", providers::MetricType::Rate, 1, zoneDimensions), 1, zoneValues);
+}
+
+const std::string& ZoneMetrics::GetZoneId() const {
+    return _zoneId;
+}
+
+void ZoneMetrics::SetQueueDepth(CallPriority priority, size_t depth) {
+    FlightRecorder::Record(FlightEventType::QUEUE_DEPTH, depth, _zoneId.c_str(), PRIORITY_NAMES[priority]);
+
+    const auto& metric = _queueDepths[priority];
+    if (metric != nullptr) {
+        metric->Set(static_cast<int64_t>(depth));
+    }
+}
+
+void ZoneMetrics::RecordQueueTime(WorkerId workerId, std::chrono::nanoseconds time) {
+    RecordTime(_queueTimes, workerId, time);
+}
+
+void ZoneMetrics::RecordTenantQueueTime(const std::string& tenant, std::chrono::nanoseconds time) {
+    if (_tenantQueueTime == nullptr) {
+        return;
+    }
+
+    const char* dimensionValues[] = { _zoneId.c_str(), tenant.c_str() };
+    _tenantQueueTime->Set(std::chrono::duration_cast<std::chrono::microseconds>(time).count(), 2, dimensionValues);
+}
+
+void ZoneMetrics::RecordExecutionTime(WorkerId workerId, std::chrono::nanoseconds time) {
+    RecordTime(_executionTimes, workerId, time);
+}
+
+void ZoneMetrics::RecordBootstrapTime(WorkerId workerId, std::chrono::nanoseconds time) {
+    RecordTime(_bootstrapTimes, workerId, time);
+}
+
+void ZoneMetrics::RecordFailure(ResultCode code) {
+    if (code == NAPA_RESULT_TIMEOUT && _timeouts != nullptr) {
+        _timeouts->Increment(1);
+    } else if (code == NAPA_RESULT_ZONE_OVERLOADED && _rejects != nullptr) {
+        _rejects->Increment(1);
+    }
+}
+
+void ZoneMetrics::RecordHedge() {
+    if (_hedges != nullptr) {
+        _hedges->Increment(1);
+    }
+}
+
+void ZoneMetrics::RecordCoalesce() {
+    if (_coalesced != nullptr) {
+        _coalesced->Increment(1);
+    }
+}
+
+void ZoneMetrics::RecordResultCacheLookup(bool hit) {
+    const auto& metric = hit ? _resultCacheHits : _resultCacheMisses;
+    if (metric != nullptr) {
+        metric->Increment(1);
+    }
+}
+
+void ZoneMetrics::SetStuckWorkers(uint32_t workers, bool stalled) {
+    if (_stuckWorkers != nullptr) {
+        _stuckWorkers->Set(static_cast<int64_t>(workers));
+    }
+    if (stalled && _stalls != nullptr) {
+        _stalls->Increment(1);
+    }
+}
+
+FunctionStatsTable& ZoneMetrics::GetFunctionStats() {
+    return _functionStats;
+}
+
+const FunctionStatsTable& ZoneMetrics::GetFunctionStats() const {
+    return _functionStats;
+}
+
+void ZoneMetrics::RecordTime(const std::vector<providers::BoundMetricPtr>& metrics, WorkerId workerId, std::chrono::nanoseconds time) {
+    if (workerId >= metrics.size() || metrics[workerId] == nullptr) {
+        return;
+    }
+
+    metrics[workerId]->Set(std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+}
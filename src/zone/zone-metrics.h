@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "function-stats.h"
+#include "worker.h"
+
+#include <napa/exports.h>
+#include <napa/providers/metric.h>
+#include <napa/types.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace napa {
+namespace zone {
+
+    /// <summary> Built-in metrics of the execute path of a zone, in section "Zone", with the zone id as dimension. </summary>
+    /// <remarks>
+    ///     - QueueDepth (Number, zone and priority): calls waiting for a worker, updated as calls are queued and dequeued.
+    ///     - CallQueueTime (Percentile, zone and worker): microseconds from Execute() until the call starts on a worker.
+    ///     - CallExecutionTime (Percentile, zone and worker): microseconds the function runs on the worker, until it
+    ///       returns, so the time an asynchronous function waits for its completion is not included.
+    ///     - WorkerBootstrapTime (Percentile, zone and worker): microseconds a worker spent bootstrapping its module loader,
+    ///       as it started or after its isolate was recycled. Workers adopting a spare isolate don't bootstrap.
+    ///     - TenantQueueTime (Percentile, zone and tenant): microseconds from Execute() until the call starts on a worker,
+    ///       for calls issued for a tenant. Tenants are not known up front, so it's not bound.
+    ///     - CallTimeouts (Rate, zone): calls that timed out, while queued or running.
+    ///     - CallRejects (Rate, zone): calls that were not admitted as the zone had too many pending calls.
+    ///     - CallHedges (Rate, zone): second attempts started for hedged calls that were still pending.
+    ///     - CallsCoalesced (Rate, zone): calls attached to an identical call in flight instead of running.
+    ///     - ResultCacheHits, ResultCacheMisses (Rate, zone): calls resolved from and calls missing the result cache.
+    ///     - StuckWorkers (Number, zone): workers the watchdog found stuck in a task, updated on each change.
+    ///     - WorkerStalls (Rate, zone): workers the watchdog found stuck, counted once per stall.
+    ///     Execution statistics of each function are kept aside of the metric provider, see FunctionStatsTable.
+    ///     Metrics are bound to their dimension values up front, each call updates them without passing any.
+    ///     It's exposed in napa.dll, as calls run from the binding of Node as well.
+    /// </remarks>
+    class NAPA_API ZoneMetrics {
+    public:
+
+        /// <summary> Constructor. </summary>
+        /// <param name="provider"> The metric provider. </param>
+        /// <param name="zoneId"> The zone id. </param>
+        /// <param name="workerCapacity"> The maximum number of workers of the zone. </param>
+        ZoneMetrics(providers::MetricProvider& provider, const std::string& zoneId, uint32_t workerCapacity);
+
+        /// <summary> Non-copyable. </summary>
+        ZoneMetrics(const ZoneMetrics&) = delete;
+        ZoneMetrics& operator=(const ZoneMetrics&) = delete;
+
+        /// <summary> Gets the zone id. </summary>
+        const std::string& GetZoneId() const;
+
+        /// <summary> Sets the number of calls of a priority waiting for a worker. </summary>
+        void SetQueueDepth(CallPriority priority, size_t depth);
+
+        /// <summary> Records the time a call waited before it started on a worker. </summary>
+        void RecordQueueTime(WorkerId workerId, std::chrono::nanoseconds time);
+
+        /// <summary> Records the time a call of a tenant waited before it started on a worker. </summary>
+        void RecordTenantQueueTime(const std::string& tenant, std::chrono::nanoseconds time);
+
+        /// <summary> Records the time a call ran on a worker. </summary>
+        void RecordExecutionTime(WorkerId workerId, std::chrono::nanoseconds time);
+
+        /// <summary> Records the time a worker spent bootstrapping its module loader. </summary>
+        void RecordBootstrapTime(WorkerId workerId, std::chrono::nanoseconds time);
+
+        /// <summary> Counts a call that failed with a result code, only timeouts and rejects are counted. </summary>
+        void RecordFailure(ResultCode code);
+
+        /// <summary> Counts the second attempt of a hedged call. </summary>
+        void RecordHedge();
+
+        /// <summary> Counts a call attached to an identical call in flight. </summary>
+        void RecordCoalesce();
+
+        /// <summary> Counts a lookup of the result cache. </summary>
+        void RecordResultCacheLookup(bool hit);
+
+        /// <summary> Sets the number of stuck workers, and counts a stall if a worker became stuck. </summary>
+        void SetStuckWorkers(uint32_t workers, bool stalled);
+
+        /// <summary> Gets the execution statistics of each function. </summary>
+        FunctionStatsTable& GetFunctionStats();
+        const FunctionStatsTable& GetFunctionStats() const;
+
+    private:
+
+        /// <summary> Records a time in microseconds on the metric of a worker. </summary>
+        static void RecordTime(const std::vector<providers::BoundMetricPtr>& metrics, WorkerId workerId, std::chrono::nanoseconds time);
+
+        /// <summary> Queue depth metrics, indexed by priority. </summary>
+        std::vector<providers::BoundMetricPtr> _queueDepths;
+
+        /// <summary> Queue and execution time metrics, indexed by worker id. </summary>
+        std::vector<providers::BoundMetricPtr> _queueTimes;
+        std::vector<providers::BoundMetricPtr> _executionTimes;
+        std::vector<providers::BoundMetricPtr> _bootstrapTimes;
+
+        /// <summary> Tenant queue time metric, with the zone id passed along the tenant on each call. </summary>
+        providers::Metric* _tenantQueueTime;
+        std::string _zoneId;
+
+        providers::BoundMetricPtr _timeouts;
+        providers::BoundMetricPtr _rejects;
+        providers::BoundMetricPtr _hedges;
+        providers::BoundMetricPtr _coalesced;
+        providers::BoundMetricPtr _resultCacheHits;
+        providers::BoundMetricPtr _resultCacheMisses;
+        providers::BoundMetricPtr _stuckWorkers;
+        providers::BoundMetricPtr _stalls;
+
+        FunctionStatsTable _functionStats;
+    };
+}
+}
@@ -24,6 +24,73 @@ namespace zone {
         /// <param name="callback"> A callback that is triggered when execution is done. </param>
         virtual void Execute(const FunctionSpec& spec, ExecuteCallback callback) = 0;
 
+        /// <summary> Executes a batch of pre-loaded JS functions asynchronously. </summary>
+        /// <param name="specs"> The function specs. </param>
+        /// <param name="callback"> A callback that is triggered with results in order of specs, when all executions are done. </param>
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback callback) = 0;
+
+        /// <summary> Executes a batch of pre-loaded JS functions asynchronously, with a callback per call. </summary>
+        /// <param name="specs"> The function specs. </param>
+        /// <param name="callbacks"> Callbacks in order of specs, each triggered when its execution is done. </param>
+        virtual void ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) = 0;
+
+        /// <summary> Gets the load of pending calls relative to the zone limits, calls are rejected at 1. </summary>
+        virtual float GetPressure() const = 0;
+
+        /// <summary> Gets the number of running workers, which changes with resizing and autoscaling. </summary>
+        virtual uint32_t GetWorkers() const = 0;
+
+        /// <summary> Changes the number of zone workers asynchronously. </summary>
+        /// <param name="workers"> The new number of workers. </param>
+        /// <param name="callback"> A callback that is triggered when resizing is done. </param>
+        virtual void Resize(uint32_t workers, ResizeCallback callback) = 0;
+
+        /// <summary> Waits asynchronously for the calls of the zone to finish, cancelling calls still queued at a deadline. </summary>
+        /// <param name="timeout"> Milliseconds after which queued calls are cancelled, 0 to wait for all calls. </param>
+        /// <param name="callback"> A callback that is triggered with the result code and the number of calls cancelled. </param>
+        virtual void Drain(uint32_t timeout, DrainCallback callback) = 0;
+
+        /// <summary> Collects memory usage of each zone worker asynchronously. </summary>
+        /// <param name="callback"> A callback that is triggered with the usage of each worker, in order of worker ids. </param>
+        virtual void GetMemoryUsage(MemoryUsageCallback callback) = 0;
+
+        /// <summary> Starts the V8 CPU profiler on each zone worker asynchronously. </summary>
+        /// <param name="samplingInterval"> Sampling interval in microseconds, 0 for the V8 default. </param>
+        /// <param name="callback"> A callback that is triggered once all workers started profiling. </param>
+        virtual void StartProfiling(uint32_t samplingInterval, ProfilingCallback callback) = 0;
+
+        /// <summary> Stops the V8 CPU profiler on each zone worker asynchronously. </summary>
+        /// <param name="callback"> A callback that is triggered with the .cpuprofile JSON of each worker, in order of worker ids. </param>
+        virtual void StopProfiling(CpuProfileCallback callback) = 0;
+
+        /// <summary> Starts the V8 sampling heap profiler on each zone worker asynchronously. </summary>
+        /// <param name="samplingInterval"> Average number of bytes allocated between two samples, 0 for the V8 default. </param>
+        /// <param name="callback"> A callback that is triggered once all workers started profiling. </param>
+        virtual void StartAllocationProfiling(uint32_t samplingInterval, ProfilingCallback callback) = 0;
+
+        /// <summary> Stops the V8 sampling heap profiler on each zone worker asynchronously. </summary>
+        /// <param name="callback">
+        ///     A callback that is triggered with the profiles of all workers merged in the .heapprofile JSON format,
+        ///     empty if no worker was profiling.
+        /// </param>
+        virtual void StopAllocationProfiling(AllocationProfileCallback callback) = 0;
+
+        /// <summary> Collects V8 heap statistics, with the statistics of each heap space, of each zone worker asynchronously. </summary>
+        /// <param name="callback"> A callback that is triggered with the statistics of each worker, in order of worker ids. </param>
+        virtual void GetHeapStatistics(HeapStatisticsCallback callback) = 0;
+
+        /// <summary> Writes a V8 heap snapshot of a zone worker to a file asynchronously. </summary>
+        /// <param name="workerId"> The id of the worker. </param>
+        /// <param name="path"> Path of the file. </param>
+        /// <param name="callback"> A callback that is triggered once the snapshot is written. </param>
+        virtual void WriteHeapSnapshot(uint32_t workerId, const std::string& path, HeapSnapshotCallback callback) = 0;
+
+        /// <summary> Gets the calls kept by the slow-call log of the zone, oldest first. </summary>
+        virtual std::vector<SlowCall> GetSlowCalls() const = 0;
+
+        /// <summary> Gets the execution statistics of each function the zone ran, in no particular order. </summary>
+        virtual std::vector<FunctionStats> GetFunctionStats() const = 0;
+
         /// <summary> Virtual destructor. </summary>
         virtual ~Zone() {}
     };
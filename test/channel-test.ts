@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from "../lib/index";
+import * as assert from 'assert';
+
+describe('napajs/channel', function () {
+    this.timeout(0);
+
+    let napaZone = napa.zone.create('channel-zone', { workers: 2 });
+
+    /// <summary> Receives all messages of a channel until it's closed. </summary>
+    async function receiveAll(channel: napa.channel.Channel): Promise<any[]> {
+        let values: any[] = [];
+        for (let message = await channel.receive(); !message.done; message = await channel.receive()) {
+            values.push(message.value);
+        }
+        return values;
+    }
+
+    it('@node: channel.create - capacity is rounded up to a power of two', () => {
+        let channel = napa.channel.create({ capacity: 5 });
+        assert.equal(channel.capacity, 8);
+        assert.equal(channel.size, 0);
+        assert(!channel.closed);
+        assert.equal(napa.channel.create().capacity, napa.channel.DEFAULT_CAPACITY);
+    });
+
+    it('@node: channel.create - bad capacity', () => {
+        assert.throws(() => napa.channel.create({ capacity: 0 }));
+        assert.throws(() => napa.channel.create({ capacity: 1.5 }));
+    });
+
+    it('@node: trySend and tryReceive', () => {
+        let channel = napa.channel.create({ capacity: 2 });
+        assert(channel.trySend({ a: 1 }));
+        assert(channel.trySend('b'));
+        assert(!channel.trySend('full'));
+        assert.equal(channel.size, 2);
+
+        assert.deepEqual(channel.tryReceive(), { done: false, value: { a: 1 } });
+        assert.deepEqual(channel.tryReceive(), { done: false, value: 'b' });
+        assert.strictEqual(channel.tryReceive(), undefined);
+
+        channel.close();
+        assert(!channel.trySend('closed'));
+        assert.deepEqual(channel.tryReceive(), { done: true, value: undefined });
+    });
+
+    it('@node: receive messages queued before close', async () => {
+        let channel = napa.channel.create();
+        await channel.send(1);
+        await channel.send(2);
+        channel.close();
+        assert.equal(await channel.send(3), false);
+        assert.deepEqual(await receiveAll(channel), [1, 2]);
+    });
+
+    it('@node: binary messages', async () => {
+        let channel = napa.channel.create({ binary: true });
+        await channel.send(new Map([['key', 'value']]));
+        let message = await channel.receive();
+        assert(message.value instanceof Map);
+        assert.equal(message.value.get('key'), 'value');
+    });
+
+    it('@node: -> napa zone producer', async () => {
+        let channel = napa.channel.create({ capacity: 4 });
+        let produced = napaZone.execute(async (channel: napa.channel.Channel, count: number) => {
+            for (let i = 0; i < count; ++i) {
+                await channel.send(i);
+            }
+            channel.close();
+            return count;
+        }, [channel, 100]);
+
+        assert.deepEqual(await receiveAll(channel), Array.from(Array(100).keys()));
+        assert.equal((await produced).value, 100);
+    });
+
+    it('@napa: producer and consumer workers', async () => {
+        let channel = napa.channel.create({ capacity: 2 });
+        let consumed = napaZone.execute(async (channel: napa.channel.Channel) => {
+            let sum = 0;
+            for (let message = await channel.receive(); !message.done; message = await channel.receive()) {
+                sum += message.value;
+            }
+            return sum;
+        }, [channel]);
+
+        await napaZone.execute(async (channel: napa.channel.Channel, count: number) => {
+            for (let i = 1; i <= count; ++i) {
+                await channel.send(i);
+            }
+            channel.close();
+        }, [channel, 1000]);
+
+        assert.equal((await consumed).value, 500500);
+    });
+});
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+import * as napa from "../lib/index";
+import * as assert from 'assert';
+
+describe('napajs/kernels', function () {
+    this.timeout(0);
+
+    let napaZone = napa.zone.create('kernels-zone', { workers: 4 });
+
+    it('@node: simdLevel', () => {
+        assert(['avx2', 'sse2', 'neon', 'scalar'].indexOf(napa.kernels.simdLevel) >= 0);
+    });
+
+    it('@node: sum, dot and axpy', () => {
+        let x = new Float32Array([1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11]);
+        let y = new Float32Array(x.length).fill(2);
+        assert.equal(napa.kernels.sum(x), 66);
+        assert.equal(napa.kernels.dot(x, y), 132);
+        assert.strictEqual(napa.kernels.axpy(0.5, x, y), y);
+        assert.deepEqual(Array.from(y.subarray(0, 3)), [2.5, 3, 3.5]);
+
+        let doubles = new Float64Array([0.5, 0.25, 0.125]);
+        assert.equal(napa.kernels.sum(doubles), 0.875);
+        assert.equal(napa.kernels.sum(doubles.subarray(1)), 0.375);
+    });
+
+    it('@node: dot of arrays of different types', () => {
+        assert.throws(() => {
+            napa.kernels.dot(new Float32Array(4), <any>new Float64Array(4));
+        });
+        assert.throws(() => {
+            napa.kernels.sum(<any>new Int32Array(4));
+        });
+    });
+
+    it('@node: argmax and topK', () => {
+        let x = new Float64Array([3, NaN, 5, 1, 5, 4]);
+        assert.equal(napa.kernels.argmax(x), 2);
+        assert.equal(napa.kernels.argmax(new Float32Array([NaN])), -1);
+        assert.deepEqual(Array.from(napa.kernels.topK(x, 3)), [2, 4, 5]);
+        assert.equal(napa.kernels.topK(x, 10).length, 5);
+    });
+
+    it('@node: histogram and sort', () => {
+        let x = new Float32Array([0, 0.25, 0.5, 1, 2, NaN]);
+        let counts = napa.kernels.histogram(x, 0, 1, 2);
+        assert.deepEqual(Array.from(counts), [2, 2]);
+        napa.kernels.histogram(x, 0, 1, 2, counts);
+        assert.deepEqual(Array.from(counts), [4, 4]);
+
+        napa.kernels.sort(x);
+        assert.deepEqual(Array.from(x.subarray(0, 5)), [0, 0.25, 0.5, 1, 2]);
+        assert(isNaN(x[5]));
+    });
+
+    it('@node: split', () => {
+        assert.deepEqual(napa.kernels.split(10, 3), [[0, 3], [3, 6], [6, 10]]);
+        assert.deepEqual(napa.kernels.split(2, 4), [[0, 1], [1, 2]]);
+        assert.deepEqual(napa.kernels.split(0, 4), []);
+    });
+
+    it('@napa: kernels over SharedArrayBuffer', () => {
+        let x = new Float64Array(new SharedArrayBuffer(8 * 1000));
+        let y = new Float64Array(new SharedArrayBuffer(8 * 1000));
+        for (let i = 0; i < x.length; ++i) {
+            x[i] = i;
+            y[i] = 2;
+        }
+        return Promise.all([
+            napa.kernels.parallelSum(napaZone, x),
+            napa.kernels.parallelDot(napaZone, x, y, 3),
+            napa.kernels.parallelHistogram(napaZone, x, 0, 999, 4)
+        ]).then((results: [number, number, Uint32Array]) => {
+            assert.equal(results[0], 499500);
+            assert.equal(results[1], 999000);
+            assert.deepEqual(Array.from(results[2]), [250, 250, 250, 250]);
+        });
+    });
+
+    it('@napa: axpy in place over SharedArrayBuffer', () => {
+        let y = new Float32Array(new SharedArrayBuffer(4 * 8));
+        return napaZone.execute((y: Float32Array) => {
+            let x = new Float32Array(y.length - 4).fill(1);
+            (<any>global).napa.kernels.axpy(3, x, y.subarray(4));
+        }, [y]).then(() => {
+            assert.deepEqual(Array.from(y), [0, 0, 0, 0, 3, 3, 3, 3]);
+        });
+    });
+
+    it('@node: parallel kernels need SharedArrayBuffer', () => {
+        assert.throws(() => {
+            napa.kernels.parallelSum(napaZone, new Float32Array(8));
+        });
+    });
+});
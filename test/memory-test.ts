@@ -46,6 +46,59 @@ describe('napajs/memory', function() {
             napaZone.execute('./napa-zone/test', "defaultAllocatorTest");
         });
 
+        it('@node: threadCachingAllocator', () => {
+            let handle = napa.memory.threadCachingAllocator.allocate(10);
+            assert(!napa.memory.isEmpty(handle));
+            napa.memory.threadCachingAllocator.deallocate(handle, 10);
+        });
+
+        it('@napa: threadCachingAllocator, released in node', () => {
+            return napaZone.execute('./napa-zone/test', "threadCachingAllocatorTest").then((result: napa.zone.Result) => {
+                napa.memory.threadCachingAllocator.deallocate(result.value, 0);
+            });
+        });
+
+        it('@node: allocateBuffer', () => {
+            let buffer = napa.memory.threadCachingAllocator.allocateBuffer(16);
+            assert(buffer instanceof ArrayBuffer);
+            assert.equal(buffer.byteLength, 16);
+            let bytes = new Uint8Array(buffer);
+            bytes[15] = 42;
+            assert.equal(new Uint8Array(buffer)[15], 42);
+            assert.equal(napa.memory.crtAllocator.allocateBuffer(0).byteLength, 0);
+        });
+
+        it('@napa: allocateBuffer, shared with napa zone', () => {
+            let allocator = napa.memory.debugAllocator(napa.memory.crtAllocator);
+            let floats = new Float32Array(allocator.allocateBuffer(4 * 8));
+            return napaZone.execute((floats: Float32Array) => {
+                floats.fill(1.5);
+                return floats.length;
+            }, [napa.transport.transfer(floats)]).then((result: napa.zone.Result) => {
+                assert.equal(result.value, 8);
+                assert.equal(floats.length, 8);
+                assert.equal(floats[7], 1.5);
+                assert.equal(JSON.parse(allocator.getDebugInfo()).allocate, 1);
+            });
+        });
+
+        it('@napa: allocateBuffer in napa zone, returned to node', () => {
+            return napaZone.execute(() => {
+                let bytes = new Uint8Array((<any>global).napa.memory.threadCachingAllocator.allocateBuffer(4));
+                bytes.set([1, 2, 3, 4]);
+                return bytes;
+            }).then((result: napa.zone.Result) => {
+                assert.deepEqual(Array.from(result.value), [1, 2, 3, 4]);
+            });
+        });
+
+        it('@node: arrayBufferPool', () => {
+            let debugInfo = JSON.parse(napa.memory.arrayBufferPool.getDebugInfo());
+            for (let key of ['allocate', 'reuse', 'deallocate', 'free', 'pooledSize', 'zeroedSize', 'capacity']) {
+                assert(typeof debugInfo[key] === 'number', key);
+            }
+        });
+
         it('@node: debugAllocator', () => {
             let allocator = napa.memory.debugAllocator(napa.memory.defaultAllocator);
             let handle = allocator.allocate(10);
@@ -60,8 +113,47 @@ describe('napajs/memory', function() {
             });
         });
 
+        it('@node: debugAllocator with histogram', () => {
+            let allocator = napa.memory.debugAllocator(napa.memory.defaultAllocator, { sampleRate: 1 });
+            let small = allocator.allocate(10);
+            let large = allocator.allocate(1000);
+            allocator.deallocate(small, 0);
+
+            let debugInfo = JSON.parse(allocator.getDebugInfo());
+            assert.equal(debugInfo.allocate, 2);
+            assert.equal(debugInfo.liveSize, 1000);
+            assert.equal(debugInfo.peakLiveSize, 1010);
+            assert.deepEqual(debugInfo.histogram, { '16': 1, '1024': 1 });
+            assert.equal(debugInfo.samples.length, 1);
+            assert.equal(debugInfo.samples[0].size, 1000);
+            assert(debugInfo.samples[0].stack.length > 0);
+            allocator.deallocate(large, 0);
+        });
+
         it('@napa: debugAllocator', () => {
             napaZone.execute('./napa-zone/test', "debugAllocatorTest");
         });
     });
+
+    describe('memoryPressure', () => {
+        it('@node: notifies zones of each level', () => {
+            napa.memoryPressure(napa.memory.MemoryPressureLevel.MODERATE);
+            napa.memoryPressure(napa.memory.MemoryPressureLevel.CRITICAL);
+
+            // Workers keep serving calls under pressure, and once it's gone.
+            return napaZone.execute((a: number) => a + 1, [1]).then((result: napa.zone.Result) => {
+                assert.strictEqual(result.value, 2);
+                napa.memoryPressure(napa.memory.MemoryPressureLevel.NONE);
+                return napaZone.execute((a: number) => a + 1, [2]);
+            }).then((result: napa.zone.Result) => {
+                assert.strictEqual(result.value, 3);
+            });
+        });
+
+        it('@node: rejects an unknown level', () => {
+            assert.throws(() => {
+                napa.memoryPressure(<napa.memory.MemoryPressureLevel>3);
+            });
+        });
+    });
 });
\ No newline at end of file
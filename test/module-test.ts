@@ -3,6 +3,8 @@
 
 import * as napa from "../lib/index";
 import * as assert from "assert";
+import * as fs from "fs";
+import * as os from "os";
 import * as path from "path";
 
 type Zone = napa.zone.Zone;
@@ -47,6 +49,33 @@ describe('napajs/module', function () {
             });
         });
 
+        it('wasm module', () => {
+            return napaZone.execute(() => {
+                var assert = require("assert");
+                var wasmModule = (<any>require)('./module/add.wasm', { env: { base: () => 10 } });
+
+                assert.equal(wasmModule.add(1, 2), 13);
+                assert.strictEqual((<any>require)('./module/add.wasm'), wasmModule);
+            });
+        });
+
+        it('wasm module - compiled once for all zones', async () => {
+            let otherZone = napa.zone.create('module-tests-wasm-zone', { workers: 2 });
+            await otherZone.broadcast(() => {
+                var assert = require("assert");
+                var wasmModule = (<any>require)('./module/add.wasm', { env: { base: () => 100 } });
+                assert.equal(wasmModule.add(1, 2), 103);
+            });
+        });
+
+        it('wasm module - missing imports', () => {
+            let otherZone = napa.zone.create('module-tests-wasm-imports-zone', { workers: 1 });
+            return otherZone.execute(() => {
+                var assert = require("assert");
+                assert.throws(() => require('./module/add.wasm'));
+            });
+        });
+
         it('napa module', () => {
             return napaZone.execute(() => {
                 var assert = require("assert");
@@ -80,6 +109,25 @@ describe('napajs/module', function () {
                 assert(cycle_b.done);
             }, [__dirname]);
         });
+
+        it('large javascript module', () => {
+            return napaZone.execute(() => {
+                var assert = require("assert");
+                var fs = require('fs');
+
+                // Large enough to be shared with other isolates as an external string.
+                fs.writeFileSync(__dirname + '/module/large-module.js',
+                    'exports.value = 1;\n' + '// padding\n'.repeat(10000) + 'exports.stack = function () { return new Error().stack; };');
+
+                var large = require('./module/large-module');
+                assert.equal(large.value, 1);
+                assert(/large-module\.js:10002/.test(large.stack()));
+            }).then(() => {
+                // Cleanup
+                var fs = require('fs');
+                fs.unlinkSync(path.resolve(__dirname, 'module/large-module.js'));
+            });
+        });
     });
 
     describe('resolve', function () {
@@ -87,6 +135,39 @@ describe('napajs/module', function () {
         it('require.resolve', () => {
             return napaZone.execute("./module/resolution-tests.js", "run");
         });
+
+        it('require.resolve after clearing resolution cache', () => {
+            napa.runtime.clearModuleResolutionCache();
+            return napaZone.execute("./module/resolution-tests.js", "run");
+        });
+
+        it('reload an invalidated module', () => {
+            let modulePath = path.join(os.tmpdir(), "module-test-reload.js");
+            fs.writeFileSync(modulePath, "exports.version = function () { return 1; };");
+            return napaZone.execute(modulePath, "version").then((result: napa.zone.Result) => {
+                assert.equal(result.value, 1);
+
+                // Without invalidation, the module stays cached.
+                fs.writeFileSync(modulePath, "exports.version = function () { return 2; };");
+                return napaZone.execute(modulePath, "version");
+            }).then((result: napa.zone.Result) => {
+                assert.equal(result.value, 1);
+
+                napa.runtime.invalidateModule(modulePath);
+                return napaZone.execute(modulePath, "version");
+            }).then((result: napa.zone.Result) => {
+                assert.equal(result.value, 2);
+            });
+        });
+
+        it('save module bundle', () => {
+            // Modules requiring each other are bundled once.
+            let bundlePath = path.join(os.tmpdir(), "module-test.bundle");
+            assert.equal(napa.runtime.saveModuleBundle(bundlePath, [path.resolve(__dirname, "module/cycle-a.js")]), 2);
+            assert.throws(() => {
+                napa.runtime.saveModuleBundle(path.resolve(__dirname, "no-such-folder/test.bundle"), []);
+            });
+        });
     });
 
     describe('core-modules', function () {
@@ -235,6 +316,141 @@ describe('napajs/module', function () {
                     }
                 })
             });
+
+            it('statSync', () => {
+                return napaZone.execute(() => {
+                    var assert = require("assert");
+                    var fs = require('fs');
+
+                    var stats = fs.statSync(__dirname + '/module/test.json');
+                    assert(stats.isFile());
+                    assert(!stats.isDirectory());
+                    assert(stats.size > 0);
+                    assert(fs.statSync(__dirname + '/module').isDirectory());
+                    assert.throws(() => fs.statSync(__dirname + '/non-existing-file.txt'));
+                });
+            });
+
+            it('readFileSync into an ArrayBuffer', () => {
+                return napaZone.execute(() => {
+                    var assert = require("assert");
+                    var fs = require('fs');
+
+                    var filename = __dirname + '/module/test.json';
+                    var text = fs.readFileSync(filename);
+                    var buffer = fs.readFileSync(filename, { arrayBuffer: true });
+                    assert.equal(Object.prototype.toString.call(buffer), '[object ArrayBuffer]');
+                    assert.equal(buffer.byteLength, fs.statSync(filename).size);
+                    assert.equal(String.fromCharCode.apply(null, new Uint8Array(buffer)), text);
+                });
+            });
+
+            it('readFileSync of a mapped file', () => {
+                return napaZone.execute(() => {
+                    var assert = require("assert");
+                    var fs = require('fs');
+
+                    var filename = __dirname + '/module/test.json';
+                    var text = fs.readFileSync(filename);
+                    var buffer = fs.readFileSync(filename, { map: true });
+                    assert.equal(Object.prototype.toString.call(buffer), '[object ArrayBuffer]');
+                    assert.equal(String.fromCharCode.apply(null, new Uint8Array(buffer)), text);
+
+                    // Writes go to private pages, not to the file.
+                    new Uint8Array(buffer)[0] = 0;
+                    assert.equal(fs.readFileSync(filename), text);
+                });
+            });
+
+            it('readFile', () => {
+                return napaZone.execute(() => {
+                    var fs = require('fs');
+
+                    return new Promise((resolve, reject) => {
+                        fs.readFile(__dirname + '/module/test.json', (err: any, content: string) => {
+                            err ? reject(err) : resolve(JSON.parse(content).prop1);
+                        });
+                    });
+                }).then((result: napa.zone.Result) => {
+                    assert.equal(result.value, 'val1');
+                });
+            });
+
+            it('readFile of a missing file', () => {
+                return napaZone.execute(() => {
+                    var fs = require('fs');
+
+                    return new Promise((resolve) => {
+                        fs.readFile(__dirname + '/non-existing-file.txt', (err: any) => {
+                            resolve(err instanceof Error);
+                        });
+                    });
+                }).then((result: napa.zone.Result) => {
+                    assert.strictEqual(result.value, true);
+                });
+            });
+
+            it('writeFile, stat and readdir', () => {
+                return napaZone.execute(() => {
+                    var assert = require("assert");
+                    var fs = require('fs');
+
+                    var testDir = __dirname + '/module/test-async-dir';
+                    fs.mkdirSync(testDir);
+                    return new Promise((resolve, reject) => {
+                        fs.writeFile(testDir + '/1', 'test', (err: any) => {
+                            if (err) {
+                                return reject(err);
+                            }
+                            fs.stat(testDir + '/1', (err: any, stats: any) => {
+                                if (err) {
+                                    return reject(err);
+                                }
+                                assert(stats.isFile());
+                                assert.equal(stats.size, 4);
+                                fs.readdir(testDir, (err: any, names: string[]) => {
+                                    err ? reject(err) : resolve(names);
+                                });
+                            });
+                        });
+                    });
+                }).then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, ['1']);
+                }).then(() => {
+                    // Cleanup
+                    var fs = require('fs');
+                    var testDir = path.join(__dirname, 'module/test-async-dir');
+                    if (fs.existsSync(testDir)) {
+                        fs.unlinkSync(path.join(testDir, '1'));
+                        fs.rmdirSync(testDir);
+                    }
+                });
+            });
+
+            it('promises', () => {
+                return napaZone.execute(() => {
+                    var fs = require('fs');
+
+                    var testFile = __dirname + '/module/test-promise-file';
+                    return fs.promises.writeFile(testFile, 'test')
+                        .then(() => fs.promises.readFile(testFile, { arrayBuffer: true }))
+                        .then((buffer: ArrayBuffer) => fs.promises.readFile(testFile)
+                            .then((content: string) => content + ' ' + buffer.byteLength))
+                        .then((content: string) => {
+                            return fs.promises.stat(__dirname + '/non-existing-file.txt')
+                                .then(() => 'resolved', () => content + ' rejected');
+                        });
+                }).then((result: napa.zone.Result) => {
+                    assert.equal(result.value, 'test 4 rejected');
+                }).then(() => {
+                    // Cleanup
+                    var fs = require('fs');
+                    var testFile = path.join(__dirname, 'module/test-promise-file');
+                    if (fs.existsSync(testFile)) {
+                        fs.unlinkSync(testFile);
+                    }
+                });
+            });
         });
 
         describe('path', function () {
@@ -405,6 +621,144 @@ describe('napajs/module', function () {
                 });
             });
         });
+
+        describe('perf_hooks', function () {
+            it('performance.now', () => {
+                return napaZone.execute(() => {
+                    var performance = require('perf_hooks').performance;
+                    var start = performance.now();
+                    var wait = Date.now();
+                    while (Date.now() - wait < 10) {}
+                    return [typeof start, performance.now() - start >= 9, performance.timeOrigin <= Date.now()];
+                }).then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, ['number', true, true]);
+                });
+            });
+
+            it('marks and measures', () => {
+                return napaZone.execute(() => {
+                    var performance = require('perf_hooks').performance;
+                    performance.clearMarks();
+                    performance.clearMeasures();
+                    performance.mark('start', { startTime: 10 });
+                    performance.mark('end', { startTime: 25 });
+                    var measure = performance.measure('work', 'start', 'end');
+
+                    var threw = false;
+                    try {
+                        performance.measure('missing', 'none');
+                    } catch (error) {
+                        threw = true;
+                    }
+                    return [
+                        measure.entryType,
+                        measure.startTime,
+                        measure.duration,
+                        performance.getEntriesByType('mark').map((entry: any) => entry.name),
+                        performance.getEntriesByName('work', 'measure').length,
+                        threw
+                    ];
+                }).then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, ['measure', 10, 15, ['start', 'end'], 1, true]);
+                });
+            });
+
+            it('createHistogram', () => {
+                return napaZone.execute(() => {
+                    var histogram = require('perf_hooks').createHistogram();
+                    var empty = isNaN(histogram.mean);
+                    for (var i = 1; i <= 100; ++i) {
+                        histogram.record(i);
+                    }
+                    var stats = [empty, histogram.count, histogram.min, histogram.max, histogram.mean, histogram.percentile(50)];
+                    histogram.reset();
+                    stats.push(histogram.count);
+                    return stats;
+                }).then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, [true, 100, 1, 100, 50.5, 50, 0]);
+                });
+            });
+        });
+
+        describe('tty', function () {
+            it('binding is initialized once at first access', () => {
+                return napaZone.execute(() => {
+                    var tty = require('tty');
+                    return typeof tty.isatty === 'function' && process.binding('tty_wrap') === process.binding('tty_wrap');
+                }).then((result: napa.zone.Result) => {
+                    assert.strictEqual(result.value, true);
+                });
+            });
+        });
+
+        describe('timers', function () {
+            it('setTimeout', () => {
+                return napaZone.execute(() => {
+                    var start = Date.now();
+                    return new Promise((resolve) => {
+                        setTimeout((a: string, b: string) => {
+                            resolve([a + b, Date.now() - start >= 50]);
+                        }, 50, 'a', 'b');
+                    });
+                }).then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, ['ab', true]);
+                });
+            });
+
+            it('clearTimeout', () => {
+                return napaZone.execute(() => {
+                    var fired = false;
+                    var timeout = setTimeout(() => { fired = true; }, 10);
+                    clearTimeout(timeout);
+                    return new Promise((resolve) => {
+                        setTimeout(() => { resolve(fired); }, 50);
+                    });
+                }).then((result: napa.zone.Result) => {
+                    assert.strictEqual(result.value, false);
+                });
+            });
+
+            it('setInterval and clearInterval', () => {
+                return napaZone.execute(() => {
+                    var count = 0;
+                    return new Promise((resolve) => {
+                        var interval = setInterval(() => {
+                            if (++count == 3) {
+                                clearInterval(interval);
+                                setTimeout(() => { resolve(count); }, 50);
+                            }
+                        }, 5);
+                    });
+                }).then((result: napa.zone.Result) => {
+                    assert.strictEqual(result.value, 3);
+                });
+            });
+
+            it('setImmediate runs after the current task', () => {
+                return napaZone.execute(() => {
+                    var order: string[] = [];
+                    var promise = new Promise((resolve) => {
+                        setImmediate(() => {
+                            order.push('immediate');
+                            resolve(order);
+                        });
+                    });
+                    order.push('task');
+                    return promise;
+                }).then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, ['task', 'immediate']);
+                });
+            });
+
+            it('require("timers")', () => {
+                return napaZone.execute(() => {
+                    var timers = require('timers');
+                    return timers.setTimeout === setTimeout && typeof timers.clearImmediate === 'function';
+                }).then((result: napa.zone.Result) => {
+                    assert.strictEqual(result.value, true);
+                });
+            });
+        });
     });
 
     describe('async', function () {
@@ -54,6 +54,13 @@ export function execute(id: string, moduleName: string, functionName: string, ar
     });
 }
 
+export function executeMany(id: string, moduleName: string, functionName: string, argsList: any[][]): Promise<any[]> {
+    let zone = napa.zone.get(id);
+    return Promise.all(argsList.map((args: any[]) => {
+        return zone.execute(moduleName, functionName, args).then((result: napa.zone.Result) => result.value);
+    }));
+}
+
 export function executeTestFunction(id: string): Promise<any> {
     let zone = napa.zone.get(id);
     return new Promise((resolve, reject) => {
@@ -128,6 +135,12 @@ export function defaultAllocatorTest(): void {
     napa.memory.defaultAllocator.deallocate(handle, 10);
 }
 
+export function threadCachingAllocatorTest(): napa.memory.Handle {
+    let handle = napa.memory.threadCachingAllocator.allocate(10);
+    assert(!napa.memory.isEmpty(handle));
+    return handle;
+}
+
 export function debugAllocatorTest(): void {
     let allocator = napa.memory.debugAllocator(napa.memory.defaultAllocator);
     let handle = allocator.allocate(10);
@@ -185,6 +198,42 @@ export function storeVerifyNotExist(storeId: string, key: string) {
     assert(store.get(key) === undefined);
 }
 
+export function storeVerifyGetMany(storeId: string, keys: string[], expectedValues: any[]) {
+    let store = napa.store.get(storeId);
+    assert.deepEqual(store.getMany(keys), expectedValues);
+}
+
+export function storeSetStream(storeId: string, key: string, chunks: string[]) {
+    let store = napa.store.get(storeId);
+    let writer = store.setStream(key);
+    for (let chunk of chunks) {
+        writer.write(chunk);
+    }
+    writer.end();
+}
+
+export function storeVerifyRange(storeId: string, key: string, offset: number, length: number, expectedBytes: number[]) {
+    let store = napa.store.get(storeId);
+    assert.deepEqual(Array.from(new Uint8Array(store.getRange(key, offset, length))), expectedBytes);
+}
+
+export function storeIncrement(storeId: string, key: string, count: number) {
+    let store = napa.store.get(storeId);
+    for (let i = 0; i < count; ++i) {
+        store.increment(key);
+    }
+}
+
+export function storeCompareAndIncrement(storeId: string, key: string, count: number) {
+    let store = napa.store.get(storeId);
+    for (let i = 0; i < count; ++i) {
+        let current: napa.store.VersionedValue;
+        do {
+            current = store.getVersioned(key);
+        } while (!store.compareAndSet(key, current.version, { count: current.value.count + 1 }));
+    }
+}
+
 /// <summary> Transport test helpers. </summary>
 export class CannotPass {
     field1: string;
@@ -209,6 +258,29 @@ export class CanPass extends napa.transport.TransportableObject {
     _allocator: napa.memory.Allocator;
 }
 
+@napa.transport.cid(module.id)
+@napa.transport.schema({ x: 'number', y: 'number' })
+export class Point extends napa.transport.AutoTransportable {
+    x: number = 0;
+    y: number = 0;
+}
+
+@napa.transport.cid(module.id)
+@napa.transport.schema({ name: 'string', points: [Point], origin: Point, children: [Shape] })
+export class Shape extends napa.transport.AutoTransportable {
+    name: string = '';
+    points: Point[] = [];
+    origin: Point = null;
+    children: Shape[] = [];
+}
+
+@napa.transport.cid(module.id)
+@napa.transport.schema({ point: Point, allocator: 'any' })
+export class PointWithAllocator extends napa.transport.AutoTransportable {
+    point: Point = null;
+    allocator: napa.memory.Allocator = null;
+}
+
 function testMarshallUnmarshall(input: any) {
     let tc = napa.transport.createTransportContext();
     let payload = napa.transport.marshall(input, tc);
@@ -225,18 +297,299 @@ export function simpleTypeTransportTest() {
     });
 }
 
+export function plainValueTransportTest() {
+    let tc = napa.transport.createTransportContext();
+    let inputs: any[] = [
+        1, 'hello', true, null, [1, 'a', null, [2]],
+        { a: 'hello', b: { c: [0, 1], d: undefined, e: () => 0 }, f: '"_cid"' },
+        { date: new Date(0) }
+    ];
+    for (let input of inputs) {
+        let payload = napa.transport.marshall(input, tc);
+        assert.equal(payload, JSON.stringify(input));
+        assert.deepEqual(napa.transport.unmarshall(payload, tc), JSON.parse(payload));
+    }
+}
+
+/// <summary> Built-in type tag, which doesn't depend on the context that created the value. </summary>
+function typeTag(value: any): string {
+    return Object.prototype.toString.call(value);
+}
+
+export function binaryValueTransportTest() {
+    let tc = napa.transport.createTransportContext();
+    let cyclic: any = { name: 'cyclic' };
+    cyclic.self = cyclic;
+    let input = {
+        floats: new Float32Array([0.5, 1.5]),
+        map: new Map<string, any>([['a', 1], ['b', [new Date(10)]]]),
+        set: new Set([1, 'two']),
+        cyclic: cyclic
+    };
+
+    let payload = napa.transport.marshallBinary(input, tc);
+    assert.equal(typeTag(payload), '[object ArrayBuffer]');
+
+    let output = napa.transport.unmarshallBinary(payload, tc);
+    assert.equal(typeTag(output.floats), '[object Float32Array]');
+    assert.deepEqual(Array.from(output.floats), [0.5, 1.5]);
+    assert.equal(typeTag(output.map), '[object Map]');
+    assert.equal(output.map.get('a'), 1);
+    assert.equal(output.map.get('b')[0].getTime(), 10);
+    assert.equal(typeTag(output.set), '[object Set]');
+    assert(output.set.has('two'));
+    assert.strictEqual(output.cyclic.self, output.cyclic);
+}
+
+export function binaryTransportableTest() {
+    let tc = napa.transport.createTransportContext();
+    let allocator = napa.memory.crtAllocator;
+    let input = {
+        canPass: new CanPass(allocator),
+        map: new Map<string, any>([['allocator', allocator]]),
+        allocators: [allocator, allocator]
+    };
+
+    let output = napa.transport.unmarshallBinary(napa.transport.marshallBinary(input, tc), tc);
+    assert.equal(output.canPass.toString(), input.canPass.toString());
+    assert.deepEqual(output.map.get('allocator').handle, allocator.handle);
+    assert.strictEqual(output.allocators[0], output.allocators[1]);
+
+    let func = napa.transport.unmarshallBinary(napa.transport.marshallBinary(() => { return 0; }, tc), tc);
+    assert.equal(func(), 0);
+
+    assert.throws(() => {
+        napa.transport.marshallBinary({ a: new CannotPass() }, tc);
+    });
+}
+
+export function binaryStoreVerifyGet(storeId: string, key: string) {
+    let value = napa.store.get(storeId).get(key);
+    assert.equal(typeTag(value.floats), '[object Float64Array]');
+    assert.deepEqual(Array.from(value.floats), [1, 2, 3]);
+    assert.equal(typeTag(value.map), '[object Map]');
+    assert.equal(value.map.get(1), 'one');
+}
+
+export function binaryStoreSet(storeId: string, key: string) {
+    napa.store.get(storeId).set(key, {
+        floats: new Float64Array([1, 2, 3]),
+        map: new Map([[1, 'one']])
+    });
+}
+
+export function arrayBufferTransportTest() {
+    let tc = napa.transport.createTransportContext();
+    let buffer = new ArrayBuffer(16);
+    let whole = new Float64Array(buffer);
+    whole[1] = 2.5;
+    let part = new Uint8Array(buffer, 8, 4);
+    let copied = new Int32Array([1, 2, 3]);
+
+    let output = napa.transport.unmarshall(napa.transport.marshall({
+        buffer: buffer,
+        whole: whole,
+        part: part,
+        copied: copied
+    }, tc), tc);
+
+    // Views of the same buffer are restored on a single buffer, except partial views that are copied.
+    assert.equal(typeTag(output.buffer), '[object ArrayBuffer]');
+    assert.equal(output.buffer.byteLength, 16);
+    assert.equal(typeTag(output.whole), '[object Float64Array]');
+    assert.strictEqual(output.whole.buffer, output.buffer);
+    assert.equal(output.whole[1], 2.5);
+    assert.equal(typeTag(output.part), '[object Uint8Array]');
+    assert.deepEqual(Array.from(output.part), Array.from(part));
+    assert.deepEqual(Array.from(output.copied), [1, 2, 3]);
+    assert.equal(buffer.byteLength, 16);
+    assert.equal(copied.length, 3);
+}
+
+export function arrayBufferTransferTest() {
+    let tc = napa.transport.createTransportContext();
+    let floats = new Float32Array([0.5, 1.5]);
+    let payload = napa.transport.marshall({ floats: napa.transport.transfer(floats) }, tc);
+    assert.equal(floats.length, 0);
+
+    let output = napa.transport.unmarshall(payload, tc);
+    assert.deepEqual(Array.from(output.floats), [0.5, 1.5]);
+
+    // Memory is handed over at the first load.
+    assert.throws(() => {
+        tc.loadArrayBuffer(JSON.parse(payload).floats.handle);
+    });
+
+    let bytes = new Uint8Array([1, 2]);
+    let binaryOutput = napa.transport.unmarshallBinary(
+        napa.transport.marshallBinary([napa.transport.transfer(bytes)], tc), tc);
+    assert.equal(bytes.length, 0);
+    assert.deepEqual(Array.from(binaryOutput[0]), [1, 2]);
+}
+
+export function sharedArrayBufferTest() {
+    let tc = napa.transport.createTransportContext();
+    let shared = new SharedArrayBuffer(16);
+    let counter = new Int32Array(shared, 8, 2);
+
+    let output = napa.transport.unmarshall(napa.transport.marshall({ shared: shared, counter: counter }, tc), tc);
+    assert.equal(typeTag(output.shared), '[object SharedArrayBuffer]');
+    assert.strictEqual(output.counter.buffer, output.shared);
+    assert.equal(output.counter.byteOffset, 8);
+
+    // Same memory on both sides.
+    Atomics.add(output.counter, 0, 3);
+    assert.equal(Atomics.load(counter, 0), 3);
+
+    let binaryOutput = napa.transport.unmarshallBinary(napa.transport.marshallBinary([counter], tc), tc);
+    Atomics.add(binaryOutput[0], 0, 1);
+    assert.equal(Atomics.load(counter, 0), 4);
+}
+
+/// <summary> Adds to a shared counter with Atomics. </summary>
+export function addShared(counter: Int32Array, times: number) {
+    for (let i = 0; i < times; ++i) {
+        Atomics.add(counter, 0, 1);
+    }
+}
+
+/// <summary> Returns the length of a transferred buffer, and transfers it back with its first byte set. </summary>
+export function transferBack(bytes: Uint8Array): any {
+    bytes[0] = 42;
+    return [bytes.length, napa.transport.transfer(bytes)];
+}
+
+/// <summary> Returns type tags of its arguments, and echoes the first one. </summary>
+export function binaryEcho(...args: any[]): any {
+    return [args[0], args.map(typeTag)];
+}
+
+export async function streamCount(count: number, writer: napa.zone.StreamWriter) {
+    for (let i = 0; i < count; ++i) {
+        await writer.write({ index: i });
+    }
+    return count;
+}
+
+/// <summary> Writes until the stream is closed, returns the number of writes. </summary>
+export async function streamUntilClosed(writer: napa.zone.StreamWriter) {
+    let writes = 0;
+    do {
+        ++writes;
+    } while (await writer.write(writes));
+    return writes;
+}
+
+export async function streamThenFail(writer: napa.zone.StreamWriter) {
+    await writer.write('first');
+    throw new Error('stream failed');
+}
+
+export async function readStream(id: string, count: number) {
+    let stream = napa.zone.get(id).executeStream('./test', 'streamCount', [count], { capacity: 2 });
+    let indices: number[] = [];
+    for (let chunk = await stream.next(); !chunk.done; chunk = await stream.next()) {
+        indices.push(chunk.value.index);
+    }
+    return indices;
+}
+
 export function jsTransportTest() {
     testMarshallUnmarshall(new CanPass(napa.memory.crtAllocator));
 }
 
+function newPoint(x: number, y: number): Point {
+    let point = new Point();
+    point.x = x;
+    point.y = y;
+    return point;
+}
+
+export function schemaTransportTest() {
+    let tc = napa.transport.createTransportContext();
+    let shape = new Shape();
+    shape.name = 'triangle';
+    shape.points = [newPoint(0, 0), newPoint(1, 2), newPoint(2, 0)];
+    shape.origin = shape.points[1];
+    shape.children = [new Shape()];
+
+    let payload = napa.transport.marshall(shape, tc);
+    assert(payload.startsWith('{"_cid":'));
+    let output = napa.transport.unmarshall(payload, tc);
+    assert(output instanceof Shape);
+    assert(output.points[2] instanceof Point);
+    assert.deepEqual([output.points[2].x, output.points[2].y], [2, 0]);
+    assert.equal(output.origin.y, 2);
+    assert(output.children[0] instanceof Shape);
+    assert.equal(output.children[0].origin, null);
+
+    // Nested in other values, and in binary transport format.
+    let shapes = napa.transport.unmarshall(napa.transport.marshall([shape, { shape: shape }], tc), tc);
+    assert(shapes[1].shape.points[1] instanceof Point);
+    assert.equal(napa.transport.unmarshallBinary(napa.transport.marshallBinary(shape, tc), tc).points[1].x, 1);
+
+    // Fields of 'any' type go through the generic path.
+    let input = new PointWithAllocator();
+    input.point = newPoint(3, 4);
+    input.allocator = napa.memory.crtAllocator;
+    let withAllocator = napa.transport.unmarshall(napa.transport.marshall(input, tc), tc);
+    assert(withAllocator instanceof PointWithAllocator);
+    assert.equal(withAllocator.point.y, 4);
+    assert.deepEqual(withAllocator.allocator.handle, napa.memory.crtAllocator.handle);
+}
+
 export function functionTransportTest() {
     testMarshallUnmarshall(() => { return 0; });
 }
 
+export function functionHashTest() {
+    let first: any = function (x: number) { return x + 1; };
+    let second: any = function (x: number) { return x + 1; };
+    second.origin = 'another-origin.js';
+
+    let hash = napa.transport.saveFunction(first);
+    assert(/^[0-9a-f]{16}$/.test(hash));
+    assert.equal(napa.transport.saveFunction(first), hash);
+    assert.strictEqual(napa.transport.loadFunction(hash), first);
+
+    // Same body from another origin is another function.
+    let secondHash = napa.transport.saveFunction(second);
+    assert.notEqual(secondHash, hash);
+    assert.strictEqual(napa.transport.loadFunction(secondHash), second);
+
+    // A saved function isn't stringified again, and a new closure of the same definition gets the same hash.
+    let stringified = 0;
+    let counted: any = function (x: number) { return x * 3; };
+    counted.toString = function () { stringified++; return Function.prototype.toString.call(counted); };
+    let countedHash = napa.transport.saveFunction(counted);
+    assert.equal(napa.transport.saveFunction(counted), countedHash);
+    assert.equal(stringified, 1);
+
+    let makeClosure = () => <any>function (x: number) { return x * 5; };
+    assert.equal(napa.transport.saveFunction(makeClosure()), napa.transport.saveFunction(makeClosure()));
+}
+
 export function addonTransportTest() {
     testMarshallUnmarshall(napa.memory.debugAllocator(napa.memory.crtAllocator));
 }
 
+export function shareableSlotTransportTest() {
+    let tc = napa.transport.createTransportContext();
+    let allocator = napa.memory.debugAllocator(napa.memory.crtAllocator);
+    let payload = napa.transport.marshall(allocator, tc);
+    assert(payload.indexOf('"_slot":') > 0 && payload.indexOf('"handle"') < 0);
+    assert.equal(tc.sharedCount, 1);
+
+    let loaded = <napa.memory.Allocator>napa.transport.unmarshall(payload, tc);
+    assert.deepEqual(loaded.handle, allocator.handle);
+    assert.equal(loaded.cid(), allocator.cid());
+    assert.equal(loaded.refCount, 3);
+
+    // Nested shareables keep their handle payload.
+    let nested = napa.transport.unmarshall(napa.transport.marshall({ a: allocator }, tc), tc);
+    assert.deepEqual(nested.a.handle, allocator.handle);
+}
+
 export function compositeTransportTest() {
     testMarshallUnmarshall({
         a: napa.memory.debugAllocator(napa.memory.crtAllocator),
@@ -3,6 +3,8 @@
 
 import * as napa from "../lib/index";
 import * as assert from 'assert';
+import * as childProcess from 'child_process';
+import * as os from 'os';
 import * as path from 'path';
 
 describe('napajs/store', function () {
@@ -47,6 +49,12 @@ describe('napajs/store', function () {
         napaZone.execute('./napa-zone/test', "getStoreTest");
     });
 
+    it('@node: store.get returns the same object in an isolate', () => {
+        assert.strictEqual(napa.store.get('store1'), store1);
+        assert.strictEqual(napa.store.getOrCreate('store1'), store1);
+        assert.strictEqual(napa.store.get('store1'), napa.store.get('store1'));
+    });
+
     it('simple types: set in node, get in node', () => {
         store1.set('a', 1);
         assert.equal(store1.get('a'), 1);
@@ -137,6 +145,527 @@ describe('napajs/store', function () {
         assert(store1.get('d') === undefined);
     });
 
+    let binaryStore = napa.store.create('binaryStore', napa.zone.TransportOption.BINARY);
+    it('binary types: set in node, get in node', () => {
+        binaryStore.set('a', { floats: new Float64Array([1, 2, 3]), map: new Map([[1, 'one']]) });
+        let value = binaryStore.get('a');
+        assert(value.floats instanceof Float64Array);
+        assert.deepEqual(Array.from(value.floats), [1, 2, 3]);
+        assert.equal(value.map.get(1), 'one');
+    });
+
+    it('binary types: set in node, get in napa', () => {
+        return napaZone.execute('./napa-zone/test', "binaryStoreVerifyGet", ['binaryStore', 'a']);
+    });
+
+    it('binary types: set in napa, get in node', async () => {
+        await napaZone.execute('./napa-zone/test', "binaryStoreSet", ['binaryStore', 'b']);
+        let value = binaryStore.get('b');
+        assert(value.map instanceof Map);
+        assert.equal(value.map.get(1), 'one');
+    });
+
+    it('binary types: transportable', () => {
+        binaryStore.set('c', [napa.memory.crtAllocator]);
+        assert.deepEqual(binaryStore.get('c')[0].handle, napa.memory.crtAllocator.handle);
+    });
+
+    let shardedStore = napa.store.create('shardedStore', undefined, 8);
+    it('sharded: set in node, get in node and napa', async () => {
+        assert.equal(shardedStore.shards, 8);
+        assert.equal(store1.shards, 1);
+        for (let i = 0; i < 100; ++i) {
+            shardedStore.set('key' + i, i);
+        }
+        assert.equal(shardedStore.size, 100);
+        assert.equal(shardedStore.get('key42'), 42);
+
+        await napaZone.execute('./napa-zone/test', "storeVerifyGet", ['shardedStore', 'key99', 99]);
+        shardedStore.delete('key0');
+        assert(!shardedStore.has('key0'));
+        assert.equal(shardedStore.size, 99);
+    });
+
+    it('sharded: getOrCreate keeps existing shards', () => {
+        assert.equal(napa.store.getOrCreate('shardedStore', undefined, 2).shards, 8);
+    });
+
+    it('sharded: invalid shards', () => {
+        assert.throws(() => napa.store.create('invalidShards', undefined, 0));
+    });
+
+    let readOptimizedStore = napa.store.create('readOptimizedStore', { shards: 4, readOptimized: true });
+    it('read optimized: set in node, get in node and napa', async () => {
+        assert(readOptimizedStore.readOptimized);
+        assert(!store1.readOptimized);
+        assert.equal(readOptimizedStore.shards, 4);
+
+        readOptimizedStore.set('a', { value: 1 });
+        assert.deepEqual(readOptimizedStore.get('a'), { value: 1 });
+        await napaZone.execute('./napa-zone/test', "storeVerifyGet", ['readOptimizedStore', 'a', { value: 1 }]);
+
+        // A newer version is read once published.
+        readOptimizedStore.set('a', { value: 2 });
+        assert.deepEqual(readOptimizedStore.get('a'), { value: 2 });
+        await napaZone.execute('./napa-zone/test', "storeVerifyGet", ['readOptimizedStore', 'a', { value: 2 }]);
+    });
+
+    it('read optimized: set in napa, delete in node', async () => {
+        await napaZone.execute('./napa-zone/test', "storeSet", ['readOptimizedStore', 'b', napa.memory.crtAllocator]);
+        assert.deepEqual(readOptimizedStore.get('b'), napa.memory.crtAllocator);
+        assert.equal(readOptimizedStore.size, 2);
+
+        readOptimizedStore.delete('b');
+        assert(!readOptimizedStore.has('b'));
+        await napaZone.execute('./napa-zone/test', "storeVerifyNotExist", ['readOptimizedStore', 'b']);
+        assert.equal(readOptimizedStore.size, 1);
+    });
+
+    let cachedStore = napa.store.create('cachedStore', { cacheValues: true });
+    it('cached values: unchanged value is unmarshalled once', () => {
+        cachedStore.set('a', { list: [1, 2] });
+        let value = cachedStore.get('a');
+        assert.strictEqual(cachedStore.get('a'), value);
+        assert.notStrictEqual(store1.get('d'), store1.get('d'));
+
+        cachedStore.set('a', { list: [3] });
+        assert.notStrictEqual(cachedStore.get('a'), value);
+        assert.deepEqual(cachedStore.get('a'), { list: [3] });
+
+        cachedStore.delete('a');
+        assert(cachedStore.get('a') === undefined);
+    });
+
+    it('cached values: set in napa, get in node', async () => {
+        let value = cachedStore.get('b');
+        await napaZone.execute('./napa-zone/test', "storeSet", ['cachedStore', 'b', 'hi']);
+        assert.notEqual(cachedStore.get('b'), value);
+        assert.equal(cachedStore.get('b'), 'hi');
+    });
+
+    let frozenStore = napa.store.create('frozenStore', { cacheValues: true, freezeValues: true });
+    it('cached values: frozen', () => {
+        frozenStore.set('a', { list: [1, 2], nested: { b: 1 } });
+        let value = frozenStore.get('a');
+        assert(Object.isFrozen(value));
+        assert(Object.isFrozen(value.list));
+        assert(Object.isFrozen(value.nested));
+        assert.strictEqual(frozenStore.get('a'), value);
+    });
+
+    let boundedStore = napa.store.create('boundedStore', { maxEntries: 3 });
+    it('bounded: least recently used keys are evicted beyond max entries', () => {
+        boundedStore.set('a', 1);
+        boundedStore.set('b', 2);
+        boundedStore.set('c', 3);
+        boundedStore.get('a');
+        boundedStore.set('d', 4);
+
+        assert.equal(boundedStore.size, 3);
+        assert.equal(boundedStore.get('a'), 1);
+        assert(!boundedStore.has('b'));
+        assert.equal(boundedStore.get('d'), 4);
+    });
+
+    it('bounded: max bytes', () => {
+        let store = napa.store.create('boundedBytesStore', { maxBytes: 100 });
+        for (let i = 0; i < 10; ++i) {
+            store.set('key' + i, 'x'.repeat(20));
+        }
+        assert(store.size < 10);
+        assert(store.has('key9'));
+    });
+
+    it('bounded: values expire after ttl', async () => {
+        let store = napa.store.create('ttlStore', { ttl: 50 });
+        store.set('a', 1);
+        store.set('b', 2, 10000);
+        assert.equal(store.get('a'), 1);
+
+        await new Promise(resolve => setTimeout(resolve, 100));
+        assert(!store.has('a'));
+        assert(store.get('a') === undefined);
+        assert.equal(store.get('b'), 2);
+
+        await napaZone.execute('./napa-zone/test', "storeVerifyNotExist", ['ttlStore', 'a']);
+    });
+
+    it('bounded: not supported by read optimized stores', () => {
+        assert.throws(() => napa.store.create('invalidBounded', { readOptimized: true, maxEntries: 1 }));
+    });
+
+    let atomicStore = napa.store.create('atomicStore', { shards: 4 });
+    let readOptimizedAtomicStore = napa.store.create('readOptimizedAtomicStore', { readOptimized: true });
+    it('atomic: compareAndSet', () => {
+        for (let store of [atomicStore, readOptimizedAtomicStore]) {
+            assert(store.getVersioned('a') === undefined);
+            assert(store.compareAndSet('a', 0, 'first'));
+            assert(!store.compareAndSet('a', 0, 'second'));
+
+            let current = store.getVersioned('a');
+            assert.equal(current.value, 'first');
+            assert(current.version > 0);
+            assert(store.compareAndSet('a', current.version, 'third'));
+            assert(!store.compareAndSet('a', current.version, 'fourth'));
+            assert.equal(store.get('a'), 'third');
+        }
+    });
+
+    it('atomic: getOrSet', () => {
+        for (let store of [atomicStore, readOptimizedAtomicStore]) {
+            let value = { list: [1] };
+            assert.strictEqual(store.getOrSet('b', value), value);
+            assert.deepEqual(store.getOrSet('b', { list: [2] }), { list: [1] });
+        }
+    });
+
+    it('atomic: increment and decrement', () => {
+        for (let store of [atomicStore, readOptimizedAtomicStore]) {
+            assert.equal(store.increment('c'), 1);
+            assert.equal(store.increment('c', 10), 11);
+            assert.equal(store.decrement('c'), 10);
+            assert.equal(store.decrement('d', 5), -5);
+            assert.equal(store.get('c'), 10);
+
+            store.set('e', 'text');
+            assert.throws(() => store.increment('e'));
+            assert.throws(() => store.increment('c', 0.5));
+            assert.equal(store.get('e'), 'text');
+        }
+        assert.equal(binaryStore.increment('counter'), 1);
+    });
+
+    it('atomic: increment in napa workers', async () => {
+        await Promise.all([0, 1, 2, 3].map(() =>
+            napaZone.execute('./napa-zone/test', "storeIncrement", ['atomicStore', 'counter', 1000])));
+        assert.equal(atomicStore.get('counter'), 4000);
+    });
+
+    it('atomic: compareAndSet in napa workers', async () => {
+        atomicStore.set('object', { count: 0 });
+        await Promise.all([0, 1, 2, 3].map(() =>
+            napaZone.execute('./napa-zone/test', "storeCompareAndIncrement", ['atomicStore', 'object', 500])));
+        assert.deepEqual(atomicStore.get('object'), { count: 2000 });
+    });
+
+    it('native values: primitives and ArrayBuffers', () => {
+        for (let store of [atomicStore, readOptimizedAtomicStore, binaryStore]) {
+            store.set('number', 1.5);
+            store.set('nan', NaN);
+            store.set('boolean', false);
+            store.set('null', null);
+            store.set('string', 'héllo');
+            assert.equal(store.get('number'), 1.5);
+            assert(isNaN(store.get('nan')));
+            assert.strictEqual(store.get('boolean'), false);
+            assert.strictEqual(store.get('null'), null);
+            assert.equal(store.get('string'), 'héllo');
+
+            let buffer = new Uint8Array([1, 2, 3]).buffer;
+            store.set('buffer', buffer);
+            let loaded = store.get('buffer');
+            assert.notStrictEqual(loaded, buffer);
+            assert.deepEqual(Array.from(new Uint8Array(loaded)), [1, 2, 3]);
+            store.set('empty', new ArrayBuffer(0));
+            assert.equal(store.get('empty').byteLength, 0);
+        }
+    });
+
+    it('native values: ArrayBuffers are shared by readers', () => {
+        atomicStore.set('shared', new Uint8Array([1, 2]).buffer);
+        let first = new Uint8Array(atomicStore.get('shared'));
+        let second = new Uint8Array(atomicStore.get('shared'));
+        first[0] = 5;
+        assert.equal(second[0], 5);
+    });
+
+    it('native values: get in napa', async () => {
+        atomicStore.set('number', 7);
+        await napaZone.execute('./napa-zone/test', "storeVerifyGet", ['atomicStore', 'number', 7]);
+        await napaZone.execute('./napa-zone/test', "storeVerifyGet", ['atomicStore', 'string', 'héllo']);
+    });
+
+    it('chunked: setStream sets the chunks once ended', () => {
+        let writer = atomicStore.setStream('chunked', 60000);
+        writer.write(new Uint8Array([1, 2, 3]).buffer);
+        writer.write(new Uint8Array([0, 4, 5, 6]).subarray(1));
+        writer.write('é');
+        assert.equal(writer.bytesWritten, 8);
+        assert(!atomicStore.has('chunked'));
+
+        writer.end();
+        assert(writer.ended);
+        assert.equal(atomicStore.getByteLength('chunked'), 8);
+        assert.deepEqual(Array.from(new Uint8Array(atomicStore.get('chunked'))), [1, 2, 3, 4, 5, 6, 0xc3, 0xa9]);
+        assert.throws(() => writer.write('x'));
+        assert.throws(() => writer.end());
+    });
+
+    it('chunked: abort leaves the key unchanged', () => {
+        atomicStore.set('aborted', 'previous');
+        let writer = atomicStore.setStream('aborted');
+        writer.write('next');
+        writer.abort();
+        assert(writer.ended);
+        assert.equal(atomicStore.get('aborted'), 'previous');
+    });
+
+    it('chunked: end throws if the store cannot take the value', () => {
+        let smallStore = napa.store.create('smallChunkedStore', { maxBytes: 16 });
+        let writer = smallStore.setStream('large');
+        writer.write(new ArrayBuffer(32));
+        assert.throws(() => writer.end());
+        assert(!smallStore.has('large'));
+    });
+
+    it('chunked: getRange slices ArrayBuffers without copying', () => {
+        atomicStore.set('range', new Uint8Array([0, 1, 2, 3, 4, 5, 6, 7]).buffer);
+        let range = new Uint8Array(atomicStore.getRange('range', 2, 3));
+        assert.deepEqual(Array.from(range), [2, 3, 4]);
+        assert.deepEqual(Array.from(new Uint8Array(atomicStore.getRange('range', 6))), [6, 7]);
+        assert.equal(atomicStore.getRange('range', 10, 2).byteLength, 0);
+
+        // Slices are over the stored memory, which every reader shares.
+        range[0] = 20;
+        assert.equal(new Uint8Array(atomicStore.get('range'))[2], 20);
+    });
+
+    it('chunked: getRange of strings, missing keys and other values', () => {
+        atomicStore.set('rangeString', 'héllo');
+        assert.deepEqual(Array.from(new Uint8Array(atomicStore.getRange('rangeString', 1, 2))), [0xc3, 0xa9]);
+        assert.strictEqual(atomicStore.getRange('missing', 0), undefined);
+        assert.strictEqual(atomicStore.getByteLength('missing'), undefined);
+        atomicStore.set('rangeObject', { a: 1 });
+        assert.throws(() => atomicStore.getRange('rangeObject', 0));
+    });
+
+    it('chunked: setStream and getRange in napa', async () => {
+        await napaZone.execute('./napa-zone/test', "storeSetStream", ['atomicStore', 'napaChunked', ['ab', 'cd']]);
+        assert.equal(Buffer.from(atomicStore.get('napaChunked')).toString(), 'abcd');
+        await napaZone.execute('./napa-zone/test', "storeVerifyRange", ['atomicStore', 'napaChunked', 1, 2, [0x62, 0x63]]);
+    });
+
+    let batchStore = napa.store.create('batchStore', { shards: 4 });
+    let readOptimizedBatchStore = napa.store.create('readOptimizedBatchStore', { shards: 4, readOptimized: true });
+    it('batch: setMany and getMany', () => {
+        for (let store of [batchStore, readOptimizedBatchStore]) {
+            store.setMany([['a', 1], ['b', { value: 2 }], ['c', 'three'], ['a', 4]]);
+            assert.equal(store.size, 3);
+            assert.deepEqual(store.getMany(['a', 'b', 'x', 'c']), [4, { value: 2 }, undefined, 'three']);
+            assert.deepEqual(store.getMany([]), []);
+        }
+    });
+
+    it('batch: setMany leaves store unchanged on invalid entries', () => {
+        assert.throws(() => batchStore.setMany([['d', 1], <any>['e']]));
+        assert.throws(() => batchStore.setMany([['d', 1], <any>[5, 'e']]));
+        assert(!batchStore.has('d'));
+    });
+
+    it('batch: getMany in napa', async () => {
+        await napaZone.execute('./napa-zone/test', "storeVerifyGetMany", ['batchStore', ['c', 'b'], ['three', { value: 2 }]]);
+    });
+
+    it('batch: scan', () => {
+        for (let store of [batchStore, readOptimizedBatchStore]) {
+            for (let i = 0; i < 20; ++i) {
+                store.set('user' + (100 + i), i);
+            }
+            let entries = store.scan('user');
+            assert.equal(entries.length, 20);
+            assert.deepEqual(entries[0], ['user100', 0]);
+            assert.deepEqual(entries[19], ['user119', 19]);
+            assert.deepEqual(store.scan('user11', 3), [['user110', 10], ['user111', 11], ['user112', 12]]);
+            assert.deepEqual(store.scan('none'), []);
+            assert.equal(store.scan('').length, 23);
+        }
+    });
+
+    let watchedStore = napa.store.create('watchedStore', { shards: 4 });
+    it('watch: changes of a key and of a prefix', async () => {
+        let keyChanges: string[] = [];
+        let prefixChanges: string[] = [];
+        let keyWatcher = watchedStore.watch('a', key => keyChanges.push(key));
+        let prefixWatcher = watchedStore.watch('user*', key => prefixChanges.push(key));
+
+        watchedStore.set('a', 1);
+        watchedStore.set('ab', 1);
+        watchedStore.set('user1', 1);
+        watchedStore.increment('user2');
+        watchedStore.delete('user1');
+        await new Promise(resolve => setTimeout(resolve, 50));
+
+        assert.deepEqual(keyChanges, ['a']);
+        assert.deepEqual(prefixChanges.sort(), ['user1', 'user2']);
+
+        keyWatcher.close();
+        prefixWatcher.close();
+        assert(keyWatcher.closed);
+        watchedStore.set('a', 2);
+        await new Promise(resolve => setTimeout(resolve, 50));
+        assert.deepEqual(keyChanges, ['a']);
+    });
+
+    it('watch: changes of a key are coalesced', async () => {
+        let changes: string[] = [];
+        let watcher = watchedStore.watch('*', key => changes.push(key));
+        for (let i = 0; i < 100; ++i) {
+            watchedStore.set('b', i);
+        }
+        await new Promise(resolve => setTimeout(resolve, 50));
+        watcher.close();
+        assert(changes.length > 0 && changes.length < 100);
+        assert(changes.every(key => key === 'b'));
+    });
+
+    it('watch: changes set in napa', async () => {
+        let changes: string[] = [];
+        let watcher = watchedStore.watch('c', key => changes.push(key));
+        await napaZone.execute('./napa-zone/test', "storeSet", ['watchedStore', 'c', 1]);
+        await new Promise(resolve => setTimeout(resolve, 50));
+        watcher.close();
+        assert.deepEqual(changes, ['c']);
+    });
+
+    let compressedStore = napa.store.create('compressedStore', { cacheValues: true, compressAbove: 1024 });
+    let largeValue = { items: Array.from({ length: 200 }, (_, i) => ({ id: i, name: 'item ' + (i % 10) })) };
+    it('compressed: large values round trip', () => {
+        compressedStore.set('large', largeValue);
+        compressedStore.set('small', { a: 1 });
+        assert.deepEqual(compressedStore.get('large'), largeValue);
+        assert.strictEqual(compressedStore.get('large'), compressedStore.get('large'));
+        assert.deepEqual(compressedStore.get('small'), { a: 1 });
+    });
+
+    it('compressed: get in napa', () => {
+        return napaZone.execute('./napa-zone/test', "storeVerifyGet", ['compressedStore', 'large', largeValue]);
+    });
+
+    it('compressed: binary and read optimized', () => {
+        let store = napa.store.create('compressedBinaryStore',
+            { transport: napa.zone.TransportOption.BINARY, readOptimized: true, compressAbove: 1024 });
+        store.set('a', largeValue);
+        assert.deepEqual(store.get('a'), largeValue);
+    });
+
+    let snapshotPath = path.join(os.tmpdir(), `napa-store-test-${process.pid}.store`);
+    let snapshotStore = napa.store.create('snapshotStore', { shards: 4 });
+    it('snapshot: load values of all kinds', () => {
+        snapshotStore.set('object', { a: [1, 'two'], b: { c: true } });
+        snapshotStore.set('null', null);
+        snapshotStore.set('boolean', false);
+        snapshotStore.set('number', 1.5);
+        snapshotStore.set('string', 'héllo');
+        snapshotStore.set('buffer', new Uint8Array([1, 2, 3]).buffer);
+        snapshotStore.increment('counter', 42);
+        snapshotStore.snapshot(snapshotPath);
+
+        let loaded = napa.store.load(snapshotPath, 'loadedStore');
+        assert.equal(loaded.id, 'loadedStore');
+        assert.equal(loaded.shards, 4);
+        assert.equal(loaded.size, 7);
+        assert.deepEqual(loaded.get('object'), { a: [1, 'two'], b: { c: true } });
+        assert.strictEqual(loaded.get('null'), null);
+        assert.strictEqual(loaded.get('boolean'), false);
+        assert.strictEqual(loaded.get('number'), 1.5);
+        assert.strictEqual(loaded.get('string'), 'héllo');
+        assert.deepEqual(Array.from(new Uint8Array(loaded.get('buffer'))), [1, 2, 3]);
+        assert.equal(loaded.increment('counter'), 43);
+        assert.deepEqual(loaded.scan('').map(entry => entry[0]),
+            ['boolean', 'buffer', 'counter', 'null', 'number', 'object', 'string']);
+    });
+
+    it('snapshot: load in napa', () => {
+        return napaZone.execute('./napa-zone/test', "storeVerifyGet", ['loadedStore', 'object', { a: [1, 'two'], b: { c: true } }]);
+    });
+
+    it('snapshot: load with an existing id', () => {
+        assert.throws(() => napa.store.load(snapshotPath), /already exists/);
+        assert.throws(() => napa.store.load(snapshotPath, 'loadedStore'), /already exists/);
+    });
+
+    it('snapshot: binary and read optimized', () => {
+        let store = napa.store.create('binarySnapshotStore', { transport: napa.zone.TransportOption.BINARY, readOptimized: true });
+        store.set('a', { floats: new Float64Array([1, 2, 3]) });
+        store.snapshot(snapshotPath);
+
+        let loaded = napa.store.load(snapshotPath, 'loadedBinaryStore');
+        assert(loaded.readOptimized);
+        assert.deepEqual(Array.from(loaded.get('a').floats), [1, 2, 3]);
+    });
+
+    it('snapshot: compressed values', () => {
+        compressedStore.snapshot(snapshotPath);
+        let loaded = napa.store.load(snapshotPath, 'loadedCompressedStore');
+        assert.deepEqual(loaded.get('large'), largeValue);
+    });
+
+    it('snapshot: shared objects are rejected', () => {
+        assert.throws(() => binaryStore.snapshot(snapshotPath + '.shared'), /shared objects/);
+    });
+
+    it('snapshot: invalid file', () => {
+        assert.throws(() => napa.store.load(path.join(__dirname, 'store-test.js')), /not a store image/);
+        assert.throws(() => napa.store.load(snapshotPath + '.missing'), /Failed to map/);
+    });
+
+    // Ids are unique per run, since segments of a run that was killed survive it.
+    let sharedStore = napa.store.create(`sharedStore-${process.pid}`, { shared: true, shards: 2 });
+    it('shared: values are shared with another process', () => {
+        sharedStore.set('a', { b: [1, 'two'] });
+        sharedStore.set('buffer', new Uint8Array([1, 2]).buffer);
+        sharedStore.increment('counter');
+
+        let script = `
+            let napa = require(${JSON.stringify(path.resolve(__dirname, '../lib/index'))});
+            let store = napa.store.create(${JSON.stringify(sharedStore.id)}, { shared: true });
+            let buffer = Array.from(new Uint8Array(store.get('buffer')));
+            store.set('c', 'from child');
+            store.increment('counter');
+            process.stdout.write(JSON.stringify([store.get('a'), store.shards, buffer]));`;
+        let output = childProcess.execFileSync(process.execPath, ['-e', script]).toString();
+
+        assert.deepEqual(JSON.parse(output), [{ b: [1, 'two'] }, 2, [1, 2]]);
+        assert.equal(sharedStore.get('c'), 'from child');
+        assert.equal(sharedStore.increment('counter'), 3);
+        assert.equal(sharedStore.size, 4);
+    });
+
+    it('shared: get and set in napa', async () => {
+        await napaZone.execute('./napa-zone/test', "storeSet", [sharedStore.id, 'd', { e: 1 }]);
+        assert.deepEqual(sharedStore.get('d'), { e: 1 });
+    });
+
+    it('shared: keys are evicted beyond memory', () => {
+        let store = napa.store.create(`boundedSharedStore-${process.pid}`, { shared: true, maxBytes: 16 * 1024 });
+        let value = 'x'.repeat(1024);
+        for (let i = 0; i < 100; ++i) {
+            store.set('key' + i, value);
+        }
+        assert(store.size > 0 && store.size < 16);
+        assert.equal(store.get('key99'), value);
+        assert.throws(() => store.set('large', 'x'.repeat(32 * 1024)), /exceeds the memory/);
+    });
+
+    it('shared: shared objects are rejected', () => {
+        assert.throws(() => sharedStore.set('allocator', [napa.memory.crtAllocator]), /shared objects/);
+        assert(!sharedStore.has('allocator'));
+    });
+
+    it('shared: unsupported options', () => {
+        assert.throws(() => napa.store.create('invalidSharedStore', { shared: true, ttl: 100 }));
+        assert.throws(() => napa.store.create('invalidSharedStore', { shared: true, readOptimized: true }));
+        assert.throws(() => napa.store.create('invalidSharedStore', { shared: true, compressAbove: 1024 }));
+    });
+
+    it('count: stores alive', () => {
+        let count = napa.store.count();
+        let store = napa.store.create('countedStore');
+        assert.equal(napa.store.count(), count + 1);
+        assert.equal(napa.store.getOrCreate('countedStore').id, store.id);
+        assert.equal(napa.store.count(), count + 1);
+    });
+
     it('size', () => {
         // set 'a', 'b', 'c', 'd', 'a', 'b', 'e', 'f', 'g', 'h', 'i', 'j'.
         // delete 'a', 'b', 'c', 'd'
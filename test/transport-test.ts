@@ -23,6 +23,21 @@ describe('napajs/transport', () => {
 
         it('#sharedCount', () => {
             assert.equal(shareable.refCount, 3);
+            assert.equal(tc.sharedCount, 1);
+        });
+
+        it('#saveShared beyond inline capacity', () => {
+            let context = napa.transport.createTransportContext();
+            let allocators: napa.memory.Allocator[] = [];
+            for (let i = 0; i < 10; ++i) {
+                allocators.push(napa.memory.debugAllocator(napa.memory.crtAllocator));
+                context.saveShared(allocators[i]);
+            }
+            context.saveShared(allocators[0]);
+            assert.equal(context.sharedCount, 10);
+            for (let allocator of allocators) {
+                assert.deepEqual(context.loadShared(allocator.handle).handle, allocator.handle);
+            }
         });
     });
 
@@ -36,6 +51,7 @@ describe('napajs/transport', () => {
             assert(napa.transport.isTransportable({ a: 1}));
             assert(napa.transport.isTransportable({ a: 1, b: new t.CanPass(napa.memory.crtAllocator)}));
             assert(napa.transport.isTransportable(() => { return 0; }));
+            assert(napa.transport.isTransportable({ a: new Float32Array(2), b: new ArrayBuffer(4) }));
             assert(!napa.transport.isTransportable(new t.CannotPass()));
             assert(!napa.transport.isTransportable([1, new t.CannotPass()]));
             assert(!napa.transport.isTransportable({ a: 1, b: new t.CannotPass()}));
@@ -51,6 +67,14 @@ describe('napajs/transport', () => {
             napaZone.execute('./napa-zone/test', "simpleTypeTransportTest");
         }).timeout(3000);
 
+        it('@node: plain values', () => {
+            t.plainValueTransportTest();
+        });
+
+        it('@napa: plain values', () => {
+            return napaZone.execute('./napa-zone/test', "plainValueTransportTest");
+        });
+
         it('@node: JS transportable', () => {
             t.jsTransportTest();
         });
@@ -59,6 +83,14 @@ describe('napajs/transport', () => {
             napaZone.execute('./napa-zone/test', "jsTransportTest");
         });
 
+        it('@node: schema transportable', () => {
+            t.schemaTransportTest();
+        });
+
+        it('@napa: schema transportable', () => {
+            napaZone.execute('./napa-zone/test', "schemaTransportTest");
+        });
+
         it('@node: addon transportable', () => {
            t.addonTransportTest();
         });
@@ -67,6 +99,14 @@ describe('napajs/transport', () => {
             napaZone.execute('./napa-zone/test', "addonTransportTest");
         });
 
+        it('@node: shareable by slot', () => {
+           t.shareableSlotTransportTest();
+        });
+
+        it('@napa: shareable by slot', () => {
+            napaZone.execute('./napa-zone/test', "shareableSlotTransportTest");
+        });
+
         it('@node: function transportable', () => {
            t.functionTransportTest();
         });
@@ -75,6 +115,14 @@ describe('napajs/transport', () => {
             napaZone.execute('./napa-zone/test', "functionTransportTest");
         });
 
+        it('@node: function hash', () => {
+           t.functionHashTest();
+        });
+
+        it('@napa: function hash', () => {
+            return napaZone.execute('./napa-zone/test', "functionHashTest");
+        });
+
         it('@node: composite transportable', () => {
             t.compositeTransportTest();
         });
@@ -91,4 +139,84 @@ describe('napajs/transport', () => {
             napaZone.execute('./napa-zone/test', "nontransportableTest");
         });
     });
+
+    describe('MarshallBinary/UnmarshallBinary', () => {
+        it('@node: built-in types', () => {
+            t.binaryValueTransportTest();
+        });
+
+        it('@napa: built-in types', () => {
+            return napaZone.execute('./napa-zone/test', "binaryValueTransportTest");
+        });
+
+        it('@node: transportable', () => {
+            t.binaryTransportableTest();
+        });
+
+        it('@napa: transportable', () => {
+            return napaZone.execute('./napa-zone/test', "binaryTransportableTest");
+        });
+    });
+
+    describe('ArrayBuffer', () => {
+        it('@node: copy', () => {
+            t.arrayBufferTransportTest();
+        });
+
+        it('@napa: copy', () => {
+            return napaZone.execute('./napa-zone/test', "arrayBufferTransportTest");
+        });
+
+        it('@node: transfer', () => {
+            t.arrayBufferTransferTest();
+        });
+
+        it('@napa: transfer', () => {
+            return napaZone.execute('./napa-zone/test', "arrayBufferTransferTest");
+        });
+
+        it('@node: SharedArrayBuffer', () => {
+            t.sharedArrayBufferTest();
+        });
+
+        it('@napa: SharedArrayBuffer', () => {
+            return napaZone.execute('./napa-zone/test', "sharedArrayBufferTest");
+        });
+
+        it('@node: Node.js Buffer', () => {
+            let tc = napa.transport.createTransportContext();
+            let buffer = Buffer.alloc(64 * 1024, 1);
+            let output = napa.transport.unmarshall(napa.transport.marshall([napa.transport.transfer(buffer)], tc), tc);
+            assert.equal(buffer.length, 0);
+            assert(Buffer.isBuffer(output[0]));
+            assert.equal(output[0].length, 64 * 1024);
+            assert.equal(output[0][100], 1);
+        });
+    });
+
+    describe('Accounting', () => {
+        it('@node: start and stop', () => {
+            assert(!napa.transport.isAccounting());
+            napa.transport.startAccounting();
+            assert(napa.transport.isAccounting());
+            napa.transport.stopAccounting();
+            assert(!napa.transport.isAccounting());
+        });
+
+        it('@node: calls and stores are accounted', async () => {
+            let store = napa.store.create('transport-accounting-store');
+            napa.transport.startAccounting();
+            try {
+                // Plain JSON calls go through transport while accounting, rather than the native dispatcher.
+                let result = await napaZone.execute((a: any, b: any) => { return { sum: a.value + b }; }, [{ value: 1 }, 2]);
+                assert.deepEqual(result.value, { sum: 3 });
+
+                store.set('key', { a: [1, 2] });
+                assert.deepEqual(store.get('key'), { a: [1, 2] });
+            }
+            finally {
+                napa.transport.stopAccounting();
+            }
+        });
+    });
 });
\ No newline at end of file
@@ -2,6 +2,8 @@
 // Licensed under the MIT license.
 
 import * as assert from "assert";
+import * as fs from "fs";
+import * as os from "os";
 import * as path from "path";
 import * as napa from "../lib/index";
 
@@ -49,6 +51,39 @@ describe('napajs/zone', function () {
         });
     });
 
+    describe('createAsync', () => {
+        it('@node: default settings', async () => {
+            let zone = await napa.zone.createAsync('napa-zone-async1');
+            assert.strictEqual(zone.id, 'napa-zone-async1');
+
+            let result = await zone.execute((a: number) => a + 1, [1]);
+            assert.strictEqual(result.value, 2);
+        });
+
+        it('@node: zone id already exists', () => {
+            return shouldFail(() => {
+                return napa.zone.createAsync('napa-zone1');
+            });
+        });
+    });
+
+    describe('preload', () => {
+        it('@node: modules are loaded before zone is returned', async () => {
+            let modulePath = path.resolve(__dirname, 'module/preload');
+            let zone = napa.zone.create('napa-zone-preload', { workers: 2, preload: [modulePath] });
+            let createdAt = Date.now();
+
+            let result = await zone.execute((p: string) => require(p).loadedAt, [modulePath]);
+            assert(result.value <= createdAt);
+        });
+
+        it('@node: missing modules do not fail zone creation', async () => {
+            let zone = napa.zone.create('napa-zone-preload-missing', { preload: ['./does-not-exist'] });
+            let result = await zone.execute((a: number) => a + 1, [1]);
+            assert.strictEqual(result.value, 2);
+        });
+    });
+
     describe("get", () => {
         it('@node: get node zone', () => {
             let zone = napa.zone.get('node');
@@ -83,6 +118,13 @@ describe('napajs/zone', function () {
             assert.strictEqual(result.value.id, 'napa-zone2');
         });
 
+        it('@node: get a zone twice shares the native zone', () => {
+            let zone1 = napa.zone.get('napa-zone1');
+            let zone2 = napa.zone.get('napa-zone1');
+            assert(zone1 !== zone2);
+            assert.strictEqual((<any>zone1)._nativeZone, (<any>zone2)._nativeZone);
+        });
+
         it('@node: id not existed', () => {
             assert.throws(() => { napa.zone.get('zonex'); });
         });
@@ -182,6 +224,26 @@ describe('napajs/zone', function () {
             return napaZone1.execute('./napa-zone/test', "broadcastTestFunction", ['node']);
         });
 
+        it('@node: -> napa zone with large arguments', () => {
+            let config: any = { items: [], text: 'h\u00e9llo \u4e16\u754c "quoted" \\' };
+            for (let i = 0; i < 10000; ++i) {
+                config.items.push({ id: i, name: `item${i}` });
+            }
+            return napaZone1.broadcast((config: any, version: number) => {
+                    (<any>global).broadcastConfig = config;
+                    (<any>global).broadcastVersion = version;
+                }, [config, 2])
+                .then(() => {
+                    return napaZone1.execute(() => {
+                        let config = (<any>global).broadcastConfig;
+                        return [config.items.length, config.items[9999].name, config.text, (<any>global).broadcastVersion];
+                    }, []);
+                })
+                .then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, [10000, 'item9999', config.text, 2]);
+                });
+        });
+
         // TODO #4: support transportable args in broadcast.
         it.skip('@node: -> node zone with transportable args', () => {
             return napa.zone.current.broadcast((allocator: any) => {
@@ -268,6 +330,14 @@ describe('napajs/zone', function () {
                 });
         });
 
+        it('@node: -> napa zone with relative and absolute module names', async () => {
+            let relative = await napaZone1.execute('./napa-zone/test', 'bar', ['hello world']);
+            let repeated = await napaZone1.execute('./napa-zone/test', 'bar', ['hello world']);
+            let absolute = await napaZone1.execute(path.resolve(__dirname, 'napa-zone/test'), 'bar', ['hello world']);
+            let sync = napaZone1.executeSync('./napa-zone/test', 'bar', ['hello world']);
+            assert.deepEqual([relative.value, repeated.value, absolute.value, sync.value], ['hello world', 'hello world', 'hello world', 'hello world']);
+        });
+
         it('@napa: -> napa zone with global function name', () => {
             return napaZone1.execute('./napa-zone/test', 'execute', ["napa-zone2", "", "foo", ['hello world']])
                 .then((result: napa.zone.Result) => {
@@ -282,6 +352,17 @@ describe('napajs/zone', function () {
                 });
         });
 
+        it('@napa: -> node zone with many calls at once', () => {
+            let argsList = [];
+            for (let i = 0; i < 100; ++i) {
+                argsList.push([i]);
+            }
+            return napaZone1.execute('./napa-zone/test', 'executeMany', ["node", "", "foo", argsList])
+                .then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, argsList.map((args: number[]) => args[0]));
+                });
+        });
+
         it('@node: -> napa zone with global function name: function with namespaces', () => {
             return napaZone1.execute("", "ns1.ns2.foo", ['hello world'])
                 .then((result: napa.zone.Result) => {
@@ -511,6 +592,149 @@ describe('napajs/zone', function () {
                 });
         });
 
+        let binaryOptions = { transport: napa.zone.TransportOption.BINARY };
+        let binaryArgs = [new Float32Array([0.5, 1.5]), new Map([['a', 1]]), new Set([1]), new Date(10)];
+        let binaryTags = ['[object Float32Array]', '[object Map]', '[object Set]', '[object Date]'];
+
+        it('@node: -> node zone with binary transport', () => {
+            return napa.zone.node.execute('./napa-zone/test', "binaryEcho", binaryArgs, binaryOptions)
+                .then((result: napa.zone.Result) => {
+                    assert(result.payload instanceof ArrayBuffer);
+                    assert.deepEqual(result.value[1], binaryTags);
+                    assert(result.value[0] instanceof Float32Array);
+                    assert.deepEqual(Array.from(result.value[0]), [0.5, 1.5]);
+                });
+        });
+
+        it('@node: -> napa zone with repeated large arguments', () => {
+            // Arguments above the interning threshold are shared across calls, including ones not in ASCII.
+            let ascii = 'x'.repeat(64 * 1024);
+            let utf8 = '\u00e9'.repeat(4 * 1024);
+            let calls = [];
+            for (let i = 0; i < 8; ++i) {
+                calls.push(napaZone1.execute((a: string, b: string) => a.length + b.length + a.charAt(1) + b.charAt(1), [ascii, utf8]));
+            }
+            return Promise.all(calls)
+                .then((results: napa.zone.Result[]) => {
+                    for (let result of results) {
+                        assert.equal(result.value, (ascii.length + utf8.length) + 'x\u00e9');
+                    }
+                });
+        });
+
+        it('@node: -> napa zone with large results', () => {
+            // Large ASCII results are handed to the caller without a copy, others are transcoded.
+            return Promise.all([
+                    napaZone1.execute(() => 'x'.repeat(64 * 1024), []),
+                    napaZone1.execute(() => '\u00e9'.repeat(4 * 1024), []),
+                    napaZone1.execute(() => ({ text: 'y'.repeat(4 * 1024) }), [])
+                ])
+                .then((results: napa.zone.Result[]) => {
+                    assert.equal(results[0].value, 'x'.repeat(64 * 1024));
+                    assert.equal(results[1].value, '\u00e9'.repeat(4 * 1024));
+                    assert.equal(results[2].value.text, 'y'.repeat(4 * 1024));
+                });
+        });
+
+        it('@node: -> napa zone with binary transport', () => {
+            return napaZone1.execute('./napa-zone/test', "binaryEcho", binaryArgs, binaryOptions)
+                .then((result: napa.zone.Result) => {
+                    assert(result.payload instanceof ArrayBuffer);
+                    assert.deepEqual(result.value[1], binaryTags);
+                    assert(result.value[0] instanceof Float32Array);
+                    assert.deepEqual(Array.from(result.value[0]), [0.5, 1.5]);
+                });
+        });
+
+        it('@node: -> napa zone with binary transport and transportable returns', () => {
+            return napaZone1.execute((allocator: napa.memory.Allocator) => {
+                return new Map([['allocator', allocator]]);
+            }, [napa.memory.crtAllocator], binaryOptions)
+            .then((result: napa.zone.Result) => {
+                assert.deepEqual(result.value.get('allocator').handle, napa.memory.crtAllocator.handle);
+            });
+        });
+
+        it('@node: -> napa zone with transferred ArrayBuffers', () => {
+            let bytes = new Uint8Array(1024 * 1024);
+            return napaZone1.execute('./napa-zone/test', "transferBack", [napa.transport.transfer(bytes)])
+                .then((result: napa.zone.Result) => {
+                    assert.equal(bytes.length, 0);
+                    assert.equal(result.value[0], 1024 * 1024);
+                    assert(result.value[1] instanceof Uint8Array);
+                    assert.equal(result.value[1].length, 1024 * 1024);
+                    assert.equal(result.value[1][0], 42);
+                });
+        });
+
+        it('@node: -> napa zone with SharedArrayBuffer and Atomics', () => {
+            let counter = new Int32Array(new SharedArrayBuffer(4));
+            let calls: Promise<napa.zone.Result>[] = [];
+            for (let i = 0; i < 4; ++i) {
+                calls.push(napaZone1.execute('./napa-zone/test', "addShared", [counter, 1000]));
+            }
+            return Promise.all(calls).then(() => {
+                assert.equal(Atomics.load(counter, 0), 4000);
+            });
+        });
+
+        it('@node: -> napa zone with forwarded result', () => {
+            return napaZone1.execute(() => { return { id: 1, text: 'h\u00e9llo' }; }, [])
+                .then((result: napa.zone.Result) => {
+                    assert.equal(result.forwardPayload(), result.payload);
+                    return napaZone1.execute((value: any) => { return value.text + value.id; }, [result]);
+                })
+                .then((result: napa.zone.Result) => {
+                    assert.equal(result.value, 'h\u00e9llo1');
+                });
+        });
+
+        it('@node: -> napa zone with forwarded result of transferred ArrayBuffers', () => {
+            let bytes = new Uint8Array(1024);
+            return napaZone1.execute('./napa-zone/test', "transferBack", [napa.transport.transfer(bytes)])
+                .then((result: napa.zone.Result) => {
+                    assert(result.transportContext.sharedCount > 0);
+                    return napaZone1.execute((value: any) => { return [value[0], value[1].length, value[1][0]]; }, [result]);
+                })
+                .then((result: napa.zone.Result) => {
+                    assert.deepEqual(result.value, [1024, 1024, 42]);
+                });
+        });
+
+        it('@node: -> napa zone with result forwarded after its value is loaded', () => {
+            let bytes = new Uint8Array(16);
+            return napaZone1.execute('./napa-zone/test', "transferBack", [napa.transport.transfer(bytes)])
+                .then((result: napa.zone.Result) => {
+                    assert.equal(result.value[1][0], 42);
+                    assert.equal(result.forwardPayload(), undefined);
+                    return napaZone1.execute((value: any) => { return value[1][0]; }, [result]);
+                })
+                .then((result: napa.zone.Result) => {
+                    assert.equal(result.value, 42);
+                });
+        });
+
+        it('@node: -> store with forwarded result', () => {
+            let store = napa.store.getOrCreate('forwarded-result-store');
+            return napaZone1.execute(() => { return { id: 2, tags: ['a', 'b'] }; }, [])
+                .then((result: napa.zone.Result) => {
+                    store.set('result', result);
+                    assert.deepEqual(store.get('result'), { id: 2, tags: ['a', 'b'] });
+                });
+        });
+
+        it('@node: -> napa zone with result payload bytes', () => {
+            return napaZone1.execute(() => { return 'h\u00e9llo'; }, [])
+                .then((result: napa.zone.Result) => {
+                    assert.deepEqual(Array.from(result.payloadBytes), Array.from(Buffer.from(<string>result.payload, 'utf8')));
+                    assert.strictEqual(result.payloadBytes, result.payloadBytes);
+                    return napaZone1.execute(() => { return [1, 2, 3]; }, [], { transport: napa.zone.TransportOption.BINARY });
+                })
+                .then((result: napa.zone.Result) => {
+                    assert.equal(result.payloadBytes.length, (<ArrayBuffer>result.payload).byteLength);
+                });
+        });
+
         it.skip('@node: -> napa zone with timeout and succeed', () => {
             return napaZone1.execute('./napa-zone/test', 'waitMS', [1], {timeout: 100});
         });
@@ -543,4 +767,992 @@ describe('napajs/zone', function () {
         it.skip('@napa: -> napa zone with timed out in multiple hops', () => {
         });
     });
-});
\ No newline at end of file
+
+    describe('executeBatch', () => {
+        napaZone1.broadcast('function foo(input) { return input; }');
+        napa.zone.node.broadcast('function foo(input) { return input; }');
+
+        it('@node: -> napa zone with global function name', () => {
+            return napaZone1.executeBatch("", "foo", [['hello'], ['world']])
+                .then((results: napa.zone.Result[]) => {
+                    assert.deepEqual(results.map(result => result.value), ['hello', 'world']);
+                });
+        });
+
+        it('@node: -> node zone with global function name', () => {
+            return napa.zone.node.executeBatch("", "foo", [['hello'], ['world']])
+                .then((results: napa.zone.Result[]) => {
+                    assert.deepEqual(results.map(result => result.value), ['hello', 'world']);
+                });
+        });
+
+        it('@node: -> napa zone with empty batch', () => {
+            return napaZone1.executeBatch("", "foo", [])
+                .then((results: napa.zone.Result[]) => {
+                    assert.equal(results.length, 0);
+                });
+        });
+
+        it('@node: -> napa zone with global function name not exists', () => {
+            return shouldFail(() => {
+                return napaZone1.executeBatch("", "foo1", [['hello'], ['world']]);
+            });
+        });
+    });
+
+    describe('pipeline', () => {
+        it('@node: -> napa zones with anonymous functions', async () => {
+            let result = await napa.zone.pipeline([
+                { zone: napaZone1, function: (text: string) => JSON.parse(text), args: ['{"x": 2}'] },
+                { zone: napaZone2, function: (doc: any, factor: number) => doc.x * factor, args: [10] },
+                { zone: napaZone1, function: (score: number) => 'score: ' + score }
+            ]);
+            assert.strictEqual(result.value, 'score: 20');
+        });
+
+        it('@node: -> napa zone and node zone', async () => {
+            let result = await napa.zone.pipeline([
+                { zone: napaZone1, function: () => 5 },
+                { zone: napa.zone.node, function: (x: number) => x + 1 }
+            ]);
+            assert.strictEqual(result.value, 6);
+        });
+
+        it('@node: -> napa zones with module functions', async () => {
+            let result = await napa.zone.pipeline([
+                { zone: napaZone1, module: napaLibPath + '/zone', function: 'create', args: ['pipeline-zone'] },
+                { zone: napaZone2, function: (zone: any) => zone.id }
+            ]);
+            assert.strictEqual(result.value, 'pipeline-zone');
+        });
+
+        it('@node: -> napa zones with a large payload as only argument', async () => {
+            let result = await napa.zone.pipeline([
+                { zone: napaZone1, function: () => 'x'.repeat(100000) },
+                { zone: napaZone2, module: path.resolve(__dirname, './napa-zone/test'), function: 'bar' },
+                { zone: napaZone1, function: (text: string) => text.length }
+            ]);
+            assert.strictEqual(result.value, 100000);
+        });
+
+        it('@node: -> napa zones with binary transport', async () => {
+            let result = await napa.zone.pipeline([
+                { zone: napaZone1, function: () => new Map([['a', 1]]) },
+                { zone: napaZone2, function: (map: Map<string, number>) => map.get('a') }
+            ], { transport: napa.zone.TransportOption.BINARY });
+            assert.strictEqual(result.value, 1);
+        });
+
+        it('@node: -> single stage', async () => {
+            let result = await napa.zone.pipeline([{ zone: napaZone2, function: (x: number) => x * 2, args: [21] }]);
+            assert.strictEqual(result.value, 42);
+        });
+
+        it('@node: -> failed stage', () => {
+            return shouldFail(() => {
+                return napa.zone.pipeline([
+                    { zone: napaZone1, function: () => 1 },
+                    { zone: napaZone2, function: () => { throw new Error('failed stage'); } },
+                    { zone: napaZone1, function: (x: number) => x }
+                ]);
+            });
+        });
+    });
+
+    describe('executeGraph', () => {
+        it('@node: -> napa zone with a diamond of anonymous functions', async () => {
+            let results = await napaZone1.executeGraph([
+                { function: (text: string) => JSON.parse(text), args: ['{"x": 2}'] },
+                { function: (doc: any, factor: number) => doc.x * factor, args: [10] },
+                { function: (doc: any) => doc.x + 1 },
+                { function: (left: number, right: number, label: string) => label + (left + right), args: ['sum: '] }
+            ], [[0, 1], [0, 2], [1, 3], [2, 3]]);
+            assert.deepEqual(results.map(result => result.value), [{ x: 2 }, 20, 3, 'sum: 23']);
+        });
+
+        it('@node: -> napa zone with module functions and shared objects', async () => {
+            let results = await napaZone1.executeGraph([
+                { module: napaLibPath + '/zone', function: 'create', args: ['graph-zone'] },
+                { function: (zone: any) => zone.id },
+                { function: (zone: any) => zone.id.length }
+            ], [[0, 1], [0, 2]]);
+            assert.strictEqual(results[1].value, 'graph-zone');
+            assert.strictEqual(results[2].value, 10);
+        });
+
+        it('@node: -> node zone', async () => {
+            let results = await napa.zone.node.executeGraph([
+                { function: () => 5 },
+                { function: (x: number) => x + 1 }
+            ], [[0, 1]]);
+            assert.strictEqual(results[1].value, 6);
+        });
+
+        it('@node: -> no nodes', async () => {
+            let results = await napaZone1.executeGraph([], []);
+            assert.deepEqual(results, []);
+        });
+
+        it('@node: -> failed node', () => {
+            return shouldFail(() => {
+                return napaZone1.executeGraph([
+                    { function: () => 1 },
+                    { function: () => { throw new Error('failed node'); } },
+                    { function: (x: number, y: number) => x + y }
+                ], [[0, 2], [1, 2]]);
+            });
+        });
+
+        it('@node: -> cycle', () => {
+            assert.throws(() => {
+                napaZone1.executeGraph([{ function: () => 1 }, { function: () => 2 }], [[0, 1], [1, 0]]);
+            });
+        });
+    });
+
+    describe('cancellation', () => {
+        let cancellationZone: napa.zone.Zone;
+        let busyLoop = (count: number) => {
+            let x = 0;
+            for (let i = 0; i < count; ++i) {
+                x = (x + i) | 0;
+            }
+            return x;
+        };
+
+        before(() => {
+            cancellationZone = napa.zone.create('cancellation-zone', { workers: 1 });
+        });
+
+        it('@node: running call', () => {
+            let token = napa.zone.createCancellationToken();
+            let call = cancellationZone.execute(busyLoop, [1e15], { cancellationToken: token });
+            setTimeout(() => token.cancel(), 100);
+            return shouldFail(() => call);
+        });
+
+        it('@node: queued call', async () => {
+            let running = napa.zone.createCancellationToken();
+            let queued = napa.zone.createCancellationToken();
+            let first = cancellationZone.execute(busyLoop, [1e15], { cancellationToken: running });
+            let second = cancellationZone.execute(() => 'ran', [], { cancellationToken: queued });
+            assert(queued.cancel());
+            assert(!queued.cancel());
+            assert(queued.cancelled);
+            await shouldFail(() => second);
+
+            running.cancel();
+            await shouldFail(() => first);
+            let result = await cancellationZone.execute(() => 'next', []);
+            assert.strictEqual(result.value, 'next');
+        });
+
+        it('@node: cancelled token', () => {
+            let token = napa.zone.createCancellationToken();
+            token.cancel();
+            return shouldFail(() => cancellationZone.execute(() => 1, [], { cancellationToken: token }));
+        });
+
+        it('@node: token passed as an argument', async () => {
+            let token = napa.zone.createCancellationToken();
+            let isCancelled = (token: napa.zone.CancellationToken) => token.cancelled;
+            assert.strictEqual((await cancellationZone.execute(isCancelled, [token])).value, false);
+            token.cancel();
+            assert.strictEqual((await cancellationZone.execute(isCancelled, [token])).value, true);
+        });
+
+        it('@node: invalid token', () => {
+            return shouldFail(() => cancellationZone.execute(() => 1, [], { cancellationToken: <any>{} }));
+        });
+    });
+
+    describe('prepare', () => {
+        it('@node: -> napa zone with module function', async () => {
+            let create = napaZone1.prepare(`${napaLibPath}/zone`, 'get');
+            assert.strictEqual((await create.execute(['napa-zone1'])).value.id, 'napa-zone1');
+            assert.strictEqual((await create.execute(['node'])).value.id, 'node');
+        });
+
+        it('@node: -> napa zone with relative module', async () => {
+            let getCurrentZone = napaZone1.prepare('./napa-zone/test', 'getCurrentZone');
+            assert.strictEqual((await getCurrentZone.execute()).value.id, 'napa-zone1');
+        });
+
+        it('@node: -> napa zone with anonymous function', async () => {
+            let square = napaZone1.prepare((x: number) => x * x);
+            assert.strictEqual((await square.execute([3])).value, 9);
+            assert.strictEqual((await square.execute([4])).value, 16);
+        });
+
+        it('@node: -> node zone with anonymous function', async () => {
+            let square = napa.zone.node.prepare((x: number) => x * x);
+            assert.strictEqual((await square.execute([5])).value, 25);
+        });
+
+        it('@node: -> napa zone with binary transport', async () => {
+            let size = napaZone1.prepare((map: Map<string, number>) => map.size);
+            let result = await size.execute([new Map([['a', 1]])], { transport: napa.zone.TransportOption.BINARY });
+            assert.strictEqual(result.value, 1);
+        });
+
+        it('@node: -> napa zone with missing function', () => {
+            let missing = napaZone1.prepare(`${napaLibPath}/zone`, 'nonExistingFunction');
+            return shouldFail(() => missing.execute([]));
+        });
+    });
+
+    describe('dispatch', () => {
+        let dispatchZone: napa.zone.Zone;
+
+        before(() => {
+            dispatchZone = napa.zone.create('dispatch-zone', { workers: 1 });
+            return dispatchZone.broadcast(`
+                function dispatchPlain(a, b) { return { sum: a.x + b, items: [1, 'a', null, { n: true }] }; }
+                function dispatchUndefined() { }
+                function dispatchDate() { return new Date(0); }
+                function dispatchPromise(x) { return Promise.resolve({ value: x }); }
+                function dispatchThrow() { throw new Error('dispatch error'); }
+                function dispatchVersion() { return 1; }
+                function dispatchPending(x) { return new Promise(resolve => setTimeout(() => resolve([x, x]), 5)); }
+                async function dispatchAsyncThrow() { await null; throw new Error('async dispatch error'); }
+                function dispatchThenable(x) { return { then: resolve => resolve(x + 1) }; }
+            `);
+        });
+
+        it('@node: -> napa zone with plain result', async () => {
+            let result = await dispatchZone.execute('', 'dispatchPlain', [{ x: 1 }, 2]);
+            assert.deepEqual(result.value, { sum: 3, items: [1, 'a', null, { n: true }] });
+        });
+
+        it('@node: -> napa zone with undefined result', async () => {
+            assert.strictEqual((await dispatchZone.execute('', 'dispatchUndefined', [])).value, undefined);
+        });
+
+        it('@node: -> napa zone with non-plain result', async () => {
+            assert.strictEqual((await dispatchZone.execute('', 'dispatchDate', [])).value, new Date(0).toJSON());
+        });
+
+        it('@node: -> napa zone with promise result', async () => {
+            assert.deepEqual((await dispatchZone.execute('', 'dispatchPromise', [5])).value, { value: 5 });
+        });
+
+        it('@node: -> napa zone with thrown error', () => {
+            return dispatchZone.execute('', 'dispatchThrow', []).then(
+                () => assert(false, "Failure was expected."),
+                (error: any) => assert(error.toString().indexOf('dispatch error') >= 0));
+        });
+
+        it('@node: -> napa zone with transportable argument', async () => {
+            let result = await dispatchZone.execute((allocator: napa.memory.Allocator) => allocator.type, [napa.memory.crtAllocator]);
+            assert.strictEqual(result.value, 'CrtAllocator');
+        });
+
+        it('@node: -> napa zone with module function called twice', async () => {
+            assert.strictEqual((await dispatchZone.execute(`${napaLibPath}/zone`, 'get', ['dispatch-zone'])).value.id, 'dispatch-zone');
+            assert.strictEqual((await dispatchZone.execute(`${napaLibPath}/zone`, 'get', ['node'])).value.id, 'node');
+        });
+
+        it('@node: -> napa zone with pending promise result', async () => {
+            assert.deepEqual((await dispatchZone.execute('', 'dispatchPending', [2])).value, [2, 2]);
+        });
+
+        it('@node: -> napa zone with rejected promise result', () => {
+            return dispatchZone.execute('', 'dispatchAsyncThrow', []).then(
+                () => assert(false, "Failure was expected."),
+                (error: any) => assert(error.toString().indexOf('async dispatch error') >= 0));
+        });
+
+        it('@node: -> napa zone with thenable result', async () => {
+            assert.strictEqual((await dispatchZone.execute('', 'dispatchThenable', [1])).value, 2);
+        });
+
+        it('@node: -> napa zone with microtask batches', async () => {
+            let batchZone = napa.zone.create('microtask-batch-zone', { workers: 1, microtaskBatchSize: 4 });
+            let calls: Promise<napa.zone.Result>[] = [];
+            for (let i = 0; i < 10; ++i) {
+                calls.push(batchZone.execute(async (x: number) => { await null; return x * 2; }, [i]));
+            }
+            let results = await Promise.all(calls);
+            assert.deepEqual(results.map(result => result.value), [0, 2, 4, 6, 8, 10, 12, 14, 16, 18]);
+        });
+
+        it('@node: -> napa zone reusing call context wraps across pending calls', async () => {
+            // Transportable arguments go through __napa_zone_call__, the pending call keeps its wrap while later ones reuse one.
+            let allocator = napa.memory.crtAllocator;
+            let pending = dispatchZone.execute((x: any, a: napa.memory.Allocator) => new Promise(resolve => setTimeout(() => resolve([x, a.type]), 20)),
+                [{ id: 'pending' }, allocator]);
+            let calls: Promise<napa.zone.Result>[] = [];
+            for (let i = 0; i < 10; ++i) {
+                calls.push(dispatchZone.execute((x: any, a: napa.memory.Allocator) => [x.id, a.type], [{ id: i }, allocator]));
+            }
+            let results = await Promise.all(calls);
+            assert.deepEqual(results.map(result => result.value[0]), [0, 1, 2, 3, 4, 5, 6, 7, 8, 9]);
+            assert.deepEqual((await pending).value, [{ id: 'pending' }, 'CrtAllocator']);
+        });
+
+        it('@node: -> napa zone with global function redefined by broadcast', async () => {
+            assert.strictEqual((await dispatchZone.execute('', 'dispatchVersion', [])).value, 1);
+            await dispatchZone.broadcast('function dispatchVersion() { return 2; }');
+            assert.strictEqual((await dispatchZone.execute('', 'dispatchVersion', [])).value, 2);
+        });
+    });
+
+    describe('inline', () => {
+        let inlineZone: napa.zone.Zone;
+
+        before(() => {
+            inlineZone = napa.zone.create('inline-zone', { workers: 1 });
+            return inlineZone.broadcast(`
+                var napa = require(${JSON.stringify(path.join(napaLibPath, 'index'))});
+                function inlineFib(n) {
+                    if (n < 2) {
+                        return n;
+                    }
+                    var zone = napa.zone.current;
+                    return Promise.all([
+                        zone.execute('', 'inlineFib', [n - 1], { inline: true }),
+                        zone.execute('', 'inlineFib', [n - 2], { inline: true })
+                    ]).then(function (results) { return results[0].value + results[1].value; });
+                }
+                function inlineSameObject() {
+                    var obj = {};
+                    return napa.zone.current.execute(function (o) { return o === obj; }, [obj], { inline: true })
+                        .then(function (result) { return result.value; });
+                }
+                function inlineThrow() {
+                    return napa.zone.current.execute(function () { throw new Error('inline error'); }, [], { inline: true })
+                        .then(function () { return null; }, function (error) { return error.message; });
+                }
+            `);
+        });
+
+        it('@node: -> napa zone with recursive calls', async () => {
+            assert.strictEqual((await inlineZone.execute('', 'inlineFib', [10])).value, 55);
+        });
+
+        it('@node: -> napa zone with arguments passed as is', async () => {
+            assert.strictEqual((await inlineZone.execute('', 'inlineSameObject', [])).value, true);
+        });
+
+        it('@node: -> napa zone with thrown error', async () => {
+            assert.strictEqual((await inlineZone.execute('', 'inlineThrow', [])).value, 'inline error');
+        });
+
+        it('@node: -> other zone ignores it', async () => {
+            assert.strictEqual((await inlineZone.execute('', 'inlineFib', [5], { inline: true })).value, 5);
+        });
+    });
+
+    describe('map/reduce', () => {
+        let items: number[] = [];
+        for (let i = 0; i < 1000; ++i) {
+            items.push(i);
+        }
+
+        it('@node: workers', () => {
+            assert.strictEqual(napaZone1.workers, 2);
+            assert.strictEqual(napa.zone.node.workers, 1);
+        });
+
+        it('@node: -> napa zone map in order', async () => {
+            let values = await napaZone1.map((item: number, index: number) => item * 2 + index, items);
+            assert.deepEqual(values, items.map(item => item * 3));
+        });
+
+        it('@node: -> napa zone map with chunk size', async () => {
+            let values = await napaZone1.map((item: number) => item + 1, items, { chunkSize: 7 });
+            assert.deepEqual(values, items.map(item => item + 1));
+        });
+
+        it('@node: -> napa zone map of empty array', async () => {
+            assert.deepEqual(await napaZone1.map((item: number) => item, []), []);
+        });
+
+        it('@node: -> node zone map', async () => {
+            let values = await napa.zone.node.map((item: string) => item.toUpperCase(), ['a', 'b', 'c']);
+            assert.deepEqual(values, ['A', 'B', 'C']);
+        });
+
+        it('@node: -> napa zone map failed', () => {
+            return shouldFail(() => {
+                return napaZone1.map((item: number) => { if (item === 500) { throw new Error('bad item'); } return item; }, items);
+            });
+        });
+
+        it('@node: -> napa zone reduce', async () => {
+            let sum = await napaZone1.reduce((sum: number, item: number) => sum + item, items, 0, { chunkSize: 100 });
+            assert.strictEqual(sum, 999 * 1000 / 2);
+        });
+
+        it('@node: -> napa zone reduce with combine', async () => {
+            let joined = await napaZone1.reduce((text: string, item: number) => text + (item % 10), items, '',
+                { chunkSize: 33, combine: (left: string, right: string) => left + right });
+            assert.strictEqual(joined, items.map(item => item % 10).join(''));
+        });
+
+        it('@node: -> napa zone reduce of empty array', async () => {
+            assert.strictEqual(await napaZone1.reduce((sum: number, item: number) => sum + item, [], 42), 42);
+        });
+    });
+
+    describe('executeStream', () => {
+        /// <summary> Reads all chunks of a stream. </summary>
+        async function readAll(stream: napa.zone.ResultStream): Promise<any[]> {
+            let values: any[] = [];
+            for (let chunk = await stream.next(); !chunk.done; chunk = await stream.next()) {
+                values.push(chunk.value);
+            }
+            return values;
+        }
+
+        it('@node: -> napa zone with module function', async () => {
+            let stream = napaZone1.executeStream('./napa-zone/test', 'streamCount', [50], { capacity: 4 });
+            let values = await readAll(stream);
+            assert.deepEqual(values.map(value => value.index), Array.from(Array(50).keys()));
+            assert.equal((await stream.result).value, 50);
+        });
+
+        it('@node: -> node zone with module function', async () => {
+            let stream = napa.zone.node.executeStream('./napa-zone/test', 'streamCount', [5]);
+            let values = await readAll(stream);
+            assert.deepEqual(values.map(value => value.index), [0, 1, 2, 3, 4]);
+        });
+
+        it('@napa: -> napa zone with module function', async () => {
+            let result = await napaZone1.execute('./napa-zone/test', 'readStream', ['napa-zone2', 10]);
+            assert.deepEqual(result.value, Array.from(Array(10).keys()));
+        });
+
+        it('@node: -> napa zone with anonymous function and binary transport', async () => {
+            let stream = napaZone1.executeStream(async (count: number, writer: napa.zone.StreamWriter) => {
+                for (let i = 0; i < count; ++i) {
+                    await writer.write(new Map([['index', i]]));
+                }
+            }, [3], { transport: napa.zone.TransportOption.BINARY });
+            let values = await readAll(stream);
+            assert(values.every(value => value instanceof Map));
+            assert.deepEqual(values.map(value => value.get('index')), [0, 1, 2]);
+        });
+
+        it('@node: -> napa zone reads chunks before the call completes', async () => {
+            let stream = napaZone1.executeStream('./napa-zone/test', 'streamUntilClosed', []);
+            assert.deepEqual(await stream.next(), { done: false, value: 1 });
+            assert.deepEqual(await stream.return(), { done: true, value: undefined });
+            assert.deepEqual(await stream.next(), { done: true, value: undefined });
+            assert((await stream.result).value >= 1);
+        });
+
+        it('@node: -> napa zone queues at most capacity chunks', async () => {
+            let stream = napaZone1.executeStream('./napa-zone/test', 'streamUntilClosed', [], { capacity: 2 });
+            assert.equal((await stream.next()).value, 1);
+
+            // The writer fills up the queue after the first chunk is read, then waits for room.
+            await new Promise(resolve => setTimeout(resolve, 100));
+            stream.cancel();
+            assert.equal((await stream.result).value, 3);
+        });
+
+        it('@node: -> napa zone with function that fails after writes', async () => {
+            let stream = napaZone1.executeStream('./napa-zone/test', 'streamThenFail', []);
+            assert.equal((await stream.next()).value, 'first');
+            await shouldFail(() => stream.next());
+            await shouldFail(() => stream.result);
+        });
+
+        it('@node: -> napa zone with Readable', async () => {
+            let stream = napaZone1.executeStream('./napa-zone/test', 'streamCount', [5], { capacity: 2 });
+            let readable = stream.toReadable();
+            let indices: number[] = [];
+            readable.on('data', (value: any) => { indices.push(value.index); });
+            await new Promise(resolve => readable.on('end', resolve));
+            assert.deepEqual(indices, [0, 1, 2, 3, 4]);
+        });
+    });
+
+    describe('resize', () => {
+        let elasticZone: Zone = napa.zone.create('elastic-zone', { workers: 1, maxWorkers: 4 });
+        elasticZone.broadcast('var resized = "yes";');
+
+        it('@node: -> grow napa zone, new workers replay broadcasts', async () => {
+            await elasticZone.resize(4);
+            let results = await elasticZone.executeBatch("", "eval", [['resized'], ['resized'], ['resized'], ['resized']]);
+            assert.deepEqual(results.map(result => result.value), ['yes', 'yes', 'yes', 'yes']);
+        });
+
+        it('@node: -> shrink napa zone', async () => {
+            await elasticZone.resize(1);
+            let result = await elasticZone.execute("", "eval", ['resized']);
+            assert.equal(result.value, 'yes');
+        });
+
+        it('@node: -> napa zone beyond maxWorkers', () => {
+            return shouldFail(() => {
+                return elasticZone.resize(5);
+            });
+        });
+
+        it('@node: -> node zone', () => {
+            return shouldFail(() => {
+                return napa.zone.node.resize(2);
+            });
+        });
+    });
+
+    describe('drain', () => {
+        let drainZone: Zone = napa.zone.create('drain-zone', { workers: 1 });
+        let busy = 'var start = Date.now(); while (Date.now() - start < 300) {} 1';
+
+        it('@node: -> napa zone waits for running calls', async () => {
+            let call = drainZone.execute('', 'eval', [busy]);
+            let result = await drainZone.drain();
+            assert.deepEqual(result, { drained: true, cancelled: 0 });
+            assert.equal((await call).value, 1);
+        });
+
+        it('@node: -> napa zone cancels queued calls at the timeout', async () => {
+            let calls = [0, 1, 2, 3].map(() => drainZone.execute('', 'eval', [busy]).then(() => true, () => false));
+            let result = await drainZone.drain({ timeout: 50 });
+            assert.equal(result.drained, false);
+
+            // Calls already handed to the busy worker still run.
+            let completed = await Promise.all(calls);
+            assert(completed[0]);
+            assert.equal(completed.filter(done => !done).length, result.cancelled);
+        });
+
+        it('@node: -> node zone', async () => {
+            assert.deepEqual(await napa.zone.node.drain(), { drained: true, cancelled: 0 });
+        });
+
+        it('@node: -> negative timeout', () => {
+            return shouldFail(() => drainZone.drain({ timeout: -1 }));
+        });
+    });
+
+    describe('worker classes', () => {
+        let classZone: Zone = napa.zone.create('worker-class-zone', {
+            workers: 3,
+            maxWorkers: 4,
+            maxOldSpaceSize: 128,
+            workerClasses: { large: { workers: 1, maxOldSpaceSize: 1024 } }
+        });
+
+        it('@node: -> class workers come first with their own heap limit', async () => {
+            let statistics = await classZone.heapStatistics();
+            assert.equal(statistics.length, 3);
+            assert(statistics[0].heapSizeLimit > 1024 * 1024 * 1024);
+            assert(statistics[1].heapSizeLimit < 512 * 1024 * 1024);
+            assert(statistics[2].heapSizeLimit < 512 * 1024 * 1024);
+        });
+
+        it('@node: -> calls with a worker class run on its workers', async () => {
+            await classZone.broadcast('var workerTag = Math.random();');
+            let large = await classZone.execute('', 'eval', ['workerTag'], { workerClass: 'large' });
+            for (let i = 0; i < 5; i++) {
+                let result = await classZone.execute('', 'eval', ['workerTag'], { workerClass: 'large' });
+                assert.equal(result.value, large.value);
+            }
+        });
+
+        it('@node: -> unknown worker class', () => {
+            return shouldFail(() => {
+                return classZone.execute('', 'eval', ['1'], { workerClass: 'huge' });
+            });
+        });
+
+        it('@node: -> resize keeps class workers', async () => {
+            await classZone.resize(1);
+            let result = await classZone.execute('', 'eval', ['1 + 1'], { workerClass: 'large' });
+            assert.equal(result.value, 2);
+            await shouldFail(() => classZone.resize(0));
+        });
+    });
+
+    describe('idle GC', () => {
+        let idleGcZone: Zone = napa.zone.create('idle-gc-zone', { workers: 1, idleGcTime: 5, idleGcFullTime: 20 });
+
+        it('@node: -> napa zone serves calls between idle GCs', async () => {
+            await idleGcZone.broadcast('var garbage = function() { var a = []; for (var i = 0; i < 100000; i++) { a.push({ i: i }); } return a.length; };');
+            for (let i = 0; i < 3; i++) {
+                let result = await idleGcZone.execute('', 'garbage', []);
+                assert.equal(result.value, 100000);
+
+                // Long enough for the worker to run a full GC.
+                await new Promise(resolve => setTimeout(resolve, 50));
+            }
+        });
+    });
+
+    describe('worker threads', () => {
+        let deepStackZone: Zone = napa.zone.create('deep-stack-zone', { workers: 1, maxStackSize: 32 * 1024 * 1024, workerPriority: 'low' });
+
+        it('@node: -> napa zone recurses up to its stack size', async () => {
+            await deepStackZone.broadcast('var depth = function() { var n = 0; function f() { n++; f(); } try { f(); } catch (e) { return n; } };');
+            let result = await deepStackZone.execute('', 'depth', []);
+
+            // The default stack size of 500KB allows less than 10000 frames.
+            assert(result.value > 100000);
+        });
+    });
+
+    describe('tenants', () => {
+        let tenantZone: Zone = napa.zone.create('tenant-zone', {
+            workers: 1,
+            tenants: { heavy: { weight: 2 }, light: { weight: 1, maxConcurrency: 1 } }
+        });
+
+        it('@node: -> queued calls of tenants share the worker by weight', async () => {
+            await tenantZone.broadcast('var sequence = 0; var next = function() { return ++sequence; };'
+                + 'var spin = function(ms) { var end = Date.now() + ms; while (Date.now() < end) {} };');
+
+            // The heavy tenant queues all of its calls first, while the worker is busy.
+            let busy = tenantZone.execute('', 'spin', [100]);
+            let heavy = [0, 1, 2, 3].map(() => tenantZone.execute('', 'next', [], { tenant: 'heavy' }));
+            let light = [0, 1].map(() => tenantZone.execute('', 'next', [], { tenant: 'light' }));
+            await busy;
+
+            let heavySequence = (await Promise.all(heavy)).map(result => result.value);
+            let lightSequence = (await Promise.all(light)).map(result => result.value);
+            assert.deepEqual(heavySequence, [1, 2, 4, 5]);
+            assert.deepEqual(lightSequence, [3, 6]);
+        });
+
+        it('@node: -> calls of tenants that are not in settings', async () => {
+            let result = await tenantZone.execute('', 'eval', ['1 + 1'], { tenant: 'unknown' });
+            assert.equal(result.value, 2);
+        });
+
+        it('@node: -> tenants require the synchronized scheduler', () => {
+            assert.throws(() => {
+                napa.zone.create('tenant-zone-work-stealing', { scheduler: 'workStealing', tenants: { heavy: { weight: 2 } } });
+            });
+        });
+    });
+
+    describe('GC tuning', () => {
+        let defaultGcZone: Zone = napa.zone.create('default-gc-zone', { workers: 1 });
+        let tunedGcZone: Zone = napa.zone.create('tuned-gc-zone', { workers: 1, gcMode: 'throughput', minSemiSpaceSize: 8 });
+
+        it('@node: -> napa zone creates isolates with the initial semi space size', async () => {
+            let defaultUsages = await defaultGcZone.memoryUsage();
+            let tunedUsages = await tunedGcZone.memoryUsage();
+            assert(tunedUsages[0].totalHeapSize > defaultUsages[0].totalHeapSize + 4 * 1024 * 1024);
+        });
+
+        it('@node: -> napa zone rejects an unknown GC mode', () => {
+            assert.throws(() => napa.zone.create('unknown-gc-zone', { gcMode: 'fast' }));
+        });
+    });
+
+    describe('memoryUsage', () => {
+        let memoryZone: Zone = napa.zone.create('memory-usage-zone', { workers: 2 });
+
+        it('@node: -> napa zone reports each worker', async () => {
+            await memoryZone.broadcast('var buffer = new ArrayBuffer(1024 * 1024);');
+            let usages = await memoryZone.memoryUsage();
+            assert.deepEqual(usages.map(usage => usage.workerId), [0, 1]);
+            for (let usage of usages) {
+                assert(usage.usedHeapSize > 0 && usage.usedHeapSize <= usage.totalHeapSize);
+                assert(usage.heapSizeLimit > usage.totalHeapSize);
+                assert(usage.externalMemory >= 1024 * 1024);
+                assert(usage.nativeAllocate > 0 && usage.nativeAllocatedSize > 0);
+            }
+        });
+
+        it('@node: -> node zone', async () => {
+            let usages = await napa.zone.node.memoryUsage();
+            assert.equal(usages.length, 1);
+            assert.equal(usages[0].workerId, 0);
+            assert(usages[0].usedHeapSize > 0);
+        });
+    });
+
+    describe('heapStatistics', () => {
+        it('@node: -> napa zone reports each worker with its heap spaces', async () => {
+            let statistics = await napa.zone.get('memory-usage-zone').heapStatistics();
+            assert.deepEqual(statistics.map(worker => worker.workerId), [0, 1]);
+            for (let worker of statistics) {
+                assert(worker.usedHeapSize > 0 && worker.usedHeapSize <= worker.totalHeapSize);
+                assert(worker.numberOfNativeContexts > 0);
+                let oldSpace = worker.spaces.find(space => space.spaceName === 'old_space');
+                assert(oldSpace != null && oldSpace.spaceUsedSize > 0);
+            }
+        });
+
+        it('@node: -> node zone', async () => {
+            let statistics = await napa.zone.node.heapStatistics();
+            assert.equal(statistics.length, 1);
+            assert(statistics[0].spaces.length > 0);
+        });
+    });
+
+    describe('heapSnapshot', () => {
+        it('@node: -> node zone writes a snapshot', async () => {
+            let file = path.join(os.tmpdir(), 'napa-node-' + process.pid + '.heapsnapshot');
+            await napa.zone.node.heapSnapshot(0, file);
+            let snapshot = JSON.parse(fs.readFileSync(file, 'utf8'));
+            fs.unlinkSync(file);
+            assert(snapshot.snapshot.node_count > 0);
+        });
+
+        it('@node: -> fails for a missing worker', async () => {
+            await shouldFail(() => napa.zone.get('memory-usage-zone').heapSnapshot(100, path.join(os.tmpdir(), 'unused.heapsnapshot')));
+        });
+    });
+
+    describe('slowCalls', () => {
+        it('@node: -> keeps calls beyond the threshold with their phases', async () => {
+            let zone = napa.zone.create('slow-call-zone', { workers: 1, slowCallThreshold: 20, slowCallPayloadBytes: 4 });
+            await zone.execute((wait: number) => {
+                let end = Date.now() + wait;
+                while (Date.now() < end) {}
+                return wait;
+            }, [50]);
+            await zone.execute(() => 1, []);
+
+            let calls = zone.slowCalls();
+            assert.equal(calls.length, 1);
+            let call = calls[0];
+            assert.equal(call.code, 0);
+            assert.equal(call.workerId, 0);
+            assert(!call.sampled);
+            assert.deepEqual(call.argumentSizes, [2]);
+            assert.deepEqual(call.arguments, ['50']);
+            assert(call.executionTime >= 50000);
+            let duration = call.queueTime + call.unmarshallTime + call.executionTime + call.marshallTime + call.completionTime;
+            assert(duration >= 50000 && call.startTime <= Date.now());
+        });
+
+        it('@node: -> keeps sampled calls however long they take', async () => {
+            let zone = napa.zone.create('sampled-call-zone', { workers: 1, slowCallSampleRate: 2, slowCallLogSize: 2 });
+            for (let i = 0; i < 6; ++i) {
+                await zone.execute((value: number) => value, [i]);
+            }
+
+            let calls = zone.slowCalls();
+            assert.equal(calls.length, 2);
+            assert(calls.every(call => call.sampled && call.arguments === undefined));
+        });
+
+        it('@node: -> is empty when disabled', () => {
+            assert.deepEqual(napa.zone.get('memory-usage-zone').slowCalls(), []);
+            assert.deepEqual(napa.zone.node.slowCalls(), []);
+        });
+    });
+
+    describe('functionStats', () => {
+        it('@node: -> counts calls, failures and execution times by function', async () => {
+            let zone = napa.zone.create('function-stats-zone', { workers: 2 });
+            for (let i = 0; i < 4; ++i) {
+                await zone.execute('./napa-zone/test', 'bar', ['hello']);
+            }
+            await shouldFail(() => zone.execute('./napa-zone/test', 'waitMS', [100], { timeout: 20 }));
+            await shouldFail(() => zone.execute(() => { throw new Error('fails'); }, []));
+
+            // The timed out call is timed once it returns on its worker.
+            await new Promise(resolve => setTimeout(resolve, 200));
+            let stats = zone.functionStats();
+            let bar = stats.filter(f => f.function === 'bar')[0];
+            assert.equal(bar.calls, 4);
+            assert.equal(bar.errors + bar.timeouts, 0);
+            assert(bar.maxTime > 0 && bar.totalTime >= bar.maxTime);
+            assert.equal(bar.histogram.length, napa.zone.FUNCTION_STATS_BUCKET_BOUNDS.length + 1);
+            assert.equal(bar.histogram.reduce((sum, count) => sum + count, 0), 4);
+
+            let waitMS = stats.filter(f => f.function === 'waitMS')[0];
+            assert.equal(waitMS.calls, 1);
+            assert.equal(waitMS.timeouts, 1);
+
+            let anonymous = stats.filter(f => f.module === '__function')[0];
+            assert.equal(anonymous.calls, 1);
+            assert.equal(anonymous.errors, 1);
+        });
+
+        it('@node: -> is empty for the node zone', () => {
+            assert.deepEqual(napa.zone.node.functionStats(), []);
+        });
+    });
+
+    describe('usage accounting', () => {
+        it('@node: -> napa zone reports CPU time and allocations of a call', async () => {
+            let result = await napa.zone.get('memory-usage-zone').execute(() => {
+                let objects = [];
+                for (let i = 0; i < 10000; ++i) {
+                    objects.push({ index: i, name: 'object-' + i });
+                }
+                return objects.length;
+            }, []);
+            assert.equal(result.value, 10000);
+            assert(result.cpuTime > 0);
+            assert(result.allocatedBytes >= 10000 * 16);
+        });
+
+        it('@node: -> node zone', async () => {
+            let result = await napa.zone.node.execute(() => new Array(1000).fill(0).map((_, i) => 'item-' + i).length, []);
+            assert.equal(result.value, 1000);
+            assert(result.cpuTime > 0);
+            assert(result.allocatedBytes > 0);
+        });
+    });
+
+    describe('profiling', () => {
+        let profilingZone: Zone = napa.zone.create('profiling-zone', { workers: 2 });
+
+        it('@node: -> napa zone profiles each worker', async () => {
+            await profilingZone.startProfiling({ samplingInterval: 100 });
+            await Promise.all([0, 1, 2, 3].map(() => profilingZone.execute(() => {
+                function spin() {
+                    let sum = 0;
+                    for (let i = 0; i < 1e7; ++i) {
+                        sum += Math.sqrt(i);
+                    }
+                    return sum;
+                }
+                return spin();
+            }, [])));
+
+            let profiles = await profilingZone.stopProfiling();
+            assert.deepEqual(profiles.map(profile => profile.workerId), [0, 1]);
+            assert(profiles.some(profile => profile.profile.nodes.some(node => node.callFrame.functionName === 'spin')));
+            for (let { profile } of profiles) {
+                assert.equal(profile.samples.length, profile.timeDeltas.length);
+                assert(profile.endTime >= profile.startTime);
+            }
+
+            let merged = napa.zone.mergeCpuProfiles(profiles);
+            assert.equal(merged.nodes[0].children.length, 2);
+            assert.equal(merged.samples.length, profiles[0].profile.samples.length + profiles[1].profile.samples.length);
+            let ids = new Set(merged.nodes.map(node => node.id));
+            assert.equal(ids.size, merged.nodes.length);
+            assert(merged.samples.every(id => ids.has(id)));
+
+            assert.deepEqual(await profilingZone.stopProfiling(), []);
+        });
+
+        it('@node: -> starting twice fails', async () => {
+            await profilingZone.startProfiling();
+            await shouldFail(() => profilingZone.startProfiling());
+            await profilingZone.stopProfiling();
+        });
+
+        it('@node: -> node zone cannot be profiled', async () => {
+            await shouldFail(() => napa.zone.node.startProfiling());
+        });
+    });
+
+    describe('allocation profiling', () => {
+        let profilingZone: Zone = napa.zone.create('allocation-profiling-zone', { workers: 2 });
+
+        it('@node: -> napa zone merges the allocation profiles of its workers', async () => {
+            await profilingZone.startAllocationProfiling({ samplingInterval: 1024 });
+            await Promise.all([0, 1, 2, 3].map(() => profilingZone.execute(() => {
+                function allocate() {
+                    let arrays = [];
+                    for (let i = 0; i < 1000; ++i) {
+                        arrays.push(new Array(1000).fill(i));
+                    }
+                    return arrays.length;
+                }
+                return allocate();
+            }, [])));
+
+            let profile = await profilingZone.stopAllocationProfiling();
+            assert.deepEqual(profile.samples, []);
+
+            let ids = new Set<number>();
+            let count = 0;
+            let allocated = 0;
+            let found = false;
+            let visit = (node: napa.zone.HeapProfileNode) => {
+                ids.add(node.id);
+                ++count;
+                allocated += node.selfSize;
+                found = found || node.callFrame.functionName === 'allocate';
+                node.children.forEach(visit);
+            };
+            visit(profile.head);
+            assert(found);
+            assert(allocated > 0);
+            assert.equal(profile.head.id, 1);
+            assert.equal(ids.size, count);
+
+            await shouldFail(() => profilingZone.stopAllocationProfiling());
+        });
+
+        it('@node: -> starting twice fails', async () => {
+            await profilingZone.startAllocationProfiling();
+            await shouldFail(() => profilingZone.startAllocationProfiling());
+            await profilingZone.stopAllocationProfiling();
+        });
+
+        it('@node: -> node zone cannot be profiled', async () => {
+            await shouldFail(() => napa.zone.node.startAllocationProfiling());
+        });
+    });
+
+    describe('workerCache', () => {
+        it('@node: -> evicts least recently used keys beyond maxEntries', () => {
+            let cache = napa.zone.workerCache('lru-test', { maxEntries: 2 });
+            cache.set('a', 1);
+            cache.set('b', 2);
+            assert.strictEqual(cache.get('a'), 1);
+            cache.set('c', 3);
+
+            assert(cache.has('a'));
+            assert(!cache.has('b'));
+            assert(cache.has('c'));
+            assert.strictEqual(cache.size, 2);
+            assert.strictEqual(napa.zone.workerCache('lru-test'), cache);
+        });
+
+        it('@node: -> keeps the key just set beyond maxBytes', () => {
+            let cache = napa.zone.workerCache('bytes-test', { maxBytes: 1024 });
+            cache.set('small', 'x');
+            cache.set('large', new ArrayBuffer(4096));
+
+            assert(!cache.has('small'));
+            assert(cache.has('large'));
+            assert(cache.bytes > 4096);
+
+            cache.delete('large');
+            assert.strictEqual(cache.size, 0);
+            assert.strictEqual(cache.bytes, 0);
+        });
+
+        it('@node: -> entries expire after ttl', async () => {
+            let cache = napa.zone.workerCache('ttl-test', { ttl: 50 });
+            cache.set('short', 1);
+            cache.set('long', 2, 0);
+            await new Promise((resolve) => setTimeout(resolve, 100));
+
+            assert.strictEqual(cache.get('short'), undefined);
+            assert.strictEqual(cache.get('long'), 2);
+        });
+
+        it('@node: -> releases entries on memory pressure', () => {
+            let cache = napa.zone.workerCache('pressure-test');
+            ['a', 'b', 'c', 'd'].forEach((key: string) => cache.set(key, 'value'));
+            try {
+                napa.memoryPressure(napa.memory.MemoryPressureLevel.MODERATE);
+                assert.deepEqual(['a', 'b', 'c', 'd'].filter((key: string) => cache.has(key)), ['c', 'd']);
+
+                napa.memoryPressure(napa.memory.MemoryPressureLevel.CRITICAL);
+                assert.strictEqual(cache.size, 0);
+            }
+            finally {
+                napa.memoryPressure(napa.memory.MemoryPressureLevel.NONE);
+            }
+        });
+
+        it('@napa: -> caches are per worker isolate', async () => {
+            let result = await napaZone1.execute(() => {
+                let cache = (<any>global).napa.zone.workerCache('worker-test');
+                let hit = cache.has('key');
+                cache.set('key', 'value');
+                return hit || cache.get('key') === 'value';
+            });
+            assert.strictEqual(result.value, true);
+            assert(!napa.zone.workerCache('worker-test').has('key'));
+        });
+    });
+});
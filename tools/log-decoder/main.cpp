@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+// Renders binary logs written by the 'async' logging provider with 'logFormat' set to 'binary'.
+// Usage: napa-log-decoder [file...], which decodes the standard input if no file is given.
+
+#include <providers/log-record.h>
+
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        if (!napa::providers::DecodeBinaryLog(std::cin, std::cout)) {
+            std::cerr << "The input is not a binary napa log, or is truncated." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    int result = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream input(argv[i], std::ios::binary);
+        if (!input) {
+            std::cerr << "Failed to open '" << argv[i] << "'." << std::endl;
+            result = 1;
+            continue;
+        }
+
+        if (!napa::providers::DecodeBinaryLog(input, std::cout)) {
+            std::cerr << "'" << argv[i] << "' is not a binary napa log, or is truncated." << std::endl;
+            result = 1;
+        }
+    }
+    return result;
+}
@@ -0,0 +1 @@
+exports.value = require('../data');
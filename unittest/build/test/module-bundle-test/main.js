@@ -0,0 +1,3 @@
+var lib = require('./lib/helper');
+var data = require("./data.json");
+require(name);
@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <napa/memory/arena-allocator.h>
+#include <napa/stl/vector.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Allocator of chunks that counts outstanding allocations. </summary>
+    class CountingAllocator : public Allocator {
+    public:
+        void* Allocate(size_t size) override {
+            ++allocations;
+            return std::malloc(size);
+        }
+
+        void Deallocate(void* memory, size_t) override {
+            --allocations;
+            std::free(memory);
+        }
+
+        const char* GetType() const override {
+            return "CountingAllocator";
+        }
+
+        bool operator==(const Allocator& other) const override {
+            return &other == this;
+        }
+
+        int allocations = 0;
+    };
+
+}
+
+TEST_CASE("arena allocator bumps within a chunk", "[arena-allocator]") {
+    CountingAllocator chunks;
+    ArenaAllocator arena(chunks);
+    REQUIRE(chunks.allocations == 0);
+
+    auto first = static_cast<char*>(arena.Allocate(10));
+    auto second = static_cast<char*>(arena.Allocate(1));
+    REQUIRE(chunks.allocations == 1);
+    REQUIRE(second - first == static_cast<ptrdiff_t>(alignof(std::max_align_t)));
+    REQUIRE(reinterpret_cast<uintptr_t>(second) % alignof(std::max_align_t) == 0);
+
+    std::memset(first, 1, 10);
+    arena.Deallocate(first, 10);
+    REQUIRE(chunks.allocations == 1);
+}
+
+TEST_CASE("arena allocator adds chunks and frees them at once", "[arena-allocator]") {
+    CountingAllocator chunks;
+    {
+        ArenaAllocator arena(chunks, 256);
+        for (int i = 0; i < 100; ++i) {
+            std::memset(arena.Allocate(64), 0, 64);
+        }
+        REQUIRE(chunks.allocations > 1);
+        REQUIRE(arena.GetAllocatedSize() == 100 * 64);
+
+        // A large allocation gets its own chunk, the current one keeps being bumped.
+        auto before = static_cast<char*>(arena.Allocate(16));
+        std::memset(arena.Allocate(64 * 1024), 0, 64 * 1024);
+        auto after = static_cast<char*>(arena.Allocate(16));
+        REQUIRE(after - before == 16);
+    }
+    REQUIRE(chunks.allocations == 0);
+}
+
+TEST_CASE("arena allocator reset keeps the latest chunk", "[arena-allocator]") {
+    CountingAllocator chunks;
+    ArenaAllocator arena(chunks, 256);
+    for (int i = 0; i < 100; ++i) {
+        arena.Allocate(64);
+    }
+
+    arena.Reset();
+    REQUIRE(chunks.allocations == 1);
+    REQUIRE(arena.GetAllocatedSize() == 0);
+
+    arena.Allocate(64);
+    REQUIRE(chunks.allocations == 1);
+}
+
+TEST_CASE("arena allocator works with napa::stl containers", "[arena-allocator]") {
+    CountingAllocator chunks;
+    ArenaAllocator arena(chunks);
+
+    napa::stl::Allocator<int> allocator(arena);
+    napa::stl::Vector<int> values(allocator);
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    REQUIRE(values[999] == 999);
+    REQUIRE(arena.GetAllocatedSize() >= 1000 * sizeof(int));
+}
@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <memory/buffer-pool.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Enables the pool for the scope of a test, and empties it afterwards. </summary>
+    class PoolScope {
+    public:
+        explicit PoolScope(size_t capacity) {
+            BufferPool::GetInstance().Configure(capacity, false);
+        }
+
+        ~PoolScope() {
+            BufferPool::GetInstance().Configure(0, false);
+        }
+    };
+
+}
+
+TEST_CASE("buffer pool reuses released buffers of the same size class", "[buffer-pool]") {
+    PoolScope scope(16 * 1024 * 1024);
+    auto& pool = BufferPool::GetInstance();
+
+    auto first = pool.Allocate(64 * 1024);
+    REQUIRE(first != nullptr);
+    std::memset(first, 0xff, 64 * 1024);
+    pool.Deallocate(first, 64 * 1024);
+    REQUIRE(pool.GetPooledSize() == 64 * 1024);
+
+    // 60KB rounds up to the 64KB class, the pooled buffer is zeroed since it's requested so.
+    auto second = static_cast<unsigned char*>(pool.AllocateZeroed(60 * 1024));
+    REQUIRE(second == first);
+    REQUIRE(pool.GetPooledSize() == 0);
+    REQUIRE(second[0] == 0);
+    REQUIRE(second[60 * 1024 - 1] == 0);
+    pool.Deallocate(second, 60 * 1024);
+}
+
+TEST_CASE("buffer pool doesn't pool small or huge buffers", "[buffer-pool]") {
+    PoolScope scope(64 * 1024 * 1024);
+    auto& pool = BufferPool::GetInstance();
+
+    pool.Deallocate(pool.Allocate(100), 100);
+    pool.Deallocate(pool.Allocate(16 * 1024 * 1024), 16 * 1024 * 1024);
+    REQUIRE(pool.GetPooledSize() == 0);
+}
+
+TEST_CASE("buffer pool frees buffers beyond its capacity", "[buffer-pool]") {
+    PoolScope scope(256 * 1024);
+    auto& pool = BufferPool::GetInstance();
+
+    void* buffers[8];
+    for (auto& buffer : buffers) {
+        buffer = pool.Allocate(64 * 1024);
+    }
+    for (auto buffer : buffers) {
+        pool.Deallocate(buffer, 64 * 1024);
+    }
+    REQUIRE(pool.GetPooledSize() == 256 * 1024);
+}
+
+TEST_CASE("buffer pool takes buffers from malloc and buffers released on other threads", "[buffer-pool]") {
+    PoolScope scope(16 * 1024 * 1024);
+    auto& pool = BufferPool::GetInstance();
+
+    // A foreign block is pooled by its usable size, which is at least what was requested.
+    auto foreign = std::malloc(100 * 1024);
+    pool.Deallocate(foreign, 0);
+    REQUIRE(pool.GetPooledSize() >= 96 * 1024);
+    REQUIRE(pool.GetPooledSize() <= 100 * 1024);
+
+    auto pooledSize = pool.GetPooledSize();
+
+    void* buffers[4];
+    for (auto& buffer : buffers) {
+        buffer = pool.Allocate(1024 * 1024);
+    }
+    std::thread releaser([&buffers, &pool]() {
+        for (auto buffer : buffers) {
+            pool.Deallocate(buffer, 1024 * 1024);
+        }
+    });
+    releaser.join();
+    REQUIRE(pool.GetPooledSize() == pooledSize + 4 * 1024 * 1024);
+
+    // The releasing thread flushed its cache on exit, so all buffers are reused.
+    for (auto& buffer : buffers) {
+        buffer = pool.Allocate(1024 * 1024);
+    }
+    REQUIRE(pool.GetPooledSize() == pooledSize);
+    for (auto buffer : buffers) {
+        pool.Deallocate(buffer, 1024 * 1024);
+    }
+}
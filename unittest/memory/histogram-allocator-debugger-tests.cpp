@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <napa/memory.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Allocator over malloc, standing for the actual allocator being debugged. </summary>
+    class MallocAllocator : public Allocator {
+    public:
+        void* Allocate(size_t size) override {
+            return std::malloc(size);
+        }
+
+        void Deallocate(void* memory, size_t) override {
+            std::free(memory);
+        }
+
+        const char* GetType() const override {
+            return "MallocAllocator";
+        }
+
+        bool operator==(const Allocator& other) const override {
+            return &other == this;
+        }
+    };
+
+}
+
+TEST_CASE("histogram allocator debugger tracks live and peak live size", "[histogram-allocator-debugger]") {
+    HistogramAllocatorDebugger debugger(std::make_shared<MallocAllocator>());
+
+    auto first = debugger.Allocate(100);
+    auto second = debugger.Allocate(1000);
+    REQUIRE(reinterpret_cast<uintptr_t>(first) % 16 == 0);
+    std::memset(second, 0, 1000);
+    REQUIRE(debugger.GetLiveSize() == 1100);
+
+    // Sizes are known from the allocation, without hints.
+    debugger.Deallocate(second, 0);
+    REQUIRE(debugger.GetLiveSize() == 100);
+    REQUIRE(debugger.GetPeakLiveSize() == 1100);
+
+    debugger.Deallocate(first, 0);
+    REQUIRE(debugger.GetLiveSize() == 0);
+    REQUIRE(std::string(debugger.GetType()) == "HistogramAllocatorDebugger<MallocAllocator>");
+}
+
+TEST_CASE("histogram allocator debugger reports sizes and call sites", "[histogram-allocator-debugger]") {
+    HistogramAllocatorDebugger debugger(std::make_shared<MallocAllocator>());
+
+    auto site = std::string(__FILE__) + ":" + std::to_string(__LINE__ + 1);
+    auto tagged = NAPA_ALLOCATE_FROM(debugger, 64);
+    auto untagged = debugger.Allocate(3000);
+
+    auto debugInfo = debugger.GetDebugInfo();
+    REQUIRE(debugInfo.find("\"histogram\": { \"64\": 1, \"4096\": 1 }") != std::string::npos);
+    REQUIRE(debugInfo.find("{ \"site\": \"" + site + "\", \"allocate\": 1, \"liveSize\": 64 }") != std::string::npos);
+    REQUIRE(debugInfo.find("{ \"site\": \"unknown\", \"allocate\": 1, \"liveSize\": 3000 }") != std::string::npos);
+    REQUIRE(debugInfo.find("\"samples\": [ ]") != std::string::npos);
+
+    debugger.Deallocate(tagged, 64);
+    debugger.Deallocate(untagged, 3000);
+}
+
+TEST_CASE("histogram allocator debugger reports stacks of live samples", "[histogram-allocator-debugger]") {
+    HistogramAllocatorDebugger debugger(std::make_shared<MallocAllocator>(), 2);
+
+    void* allocations[4];
+    for (auto& allocation : allocations) {
+        allocation = debugger.Allocate(10);
+    }
+    auto debugInfo = debugger.GetDebugInfo();
+    REQUIRE(debugInfo.find("{ \"size\": 10, \"site\": \"unknown\", \"stack\": [ \"") != std::string::npos);
+
+    for (auto allocation : allocations) {
+        debugger.Deallocate(allocation, 0);
+    }
+    REQUIRE(debugger.GetDebugInfo().find("\"samples\": [ ]") != std::string::npos);
+}
@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <napa/memory/arena-allocator.h>
+#include <napa/stl/map.h>
+#include <napa/stl/string.h>
+#include <napa/stl/unordered_map.h>
+#include <napa/stl/vector.h>
+#include <napa/transport/transport-context.h>
+
+#include <cstdlib>
+#include <memory>
+
+using namespace napa::memory;
+using napa::stl::PolymorphicAllocator;
+
+namespace pmr = napa::stl::pmr;
+
+namespace {
+
+    /// <summary> Allocator that counts outstanding allocations. </summary>
+    class CountingAllocator : public Allocator {
+    public:
+        void* Allocate(size_t size) override {
+            ++allocations;
+            return std::malloc(size);
+        }
+
+        void Deallocate(void* memory, size_t) override {
+            --allocations;
+            std::free(memory);
+        }
+
+        const char* GetType() const override {
+            return "CountingAllocator";
+        }
+
+        bool operator==(const Allocator& other) const override {
+            return &other == this;
+        }
+
+        int allocations = 0;
+    };
+
+    const char* LONG_STRING = "a string too long to fit in the inline buffer of std::basic_string";
+
+}
+
+TEST_CASE("polymorphic allocator allocates containers from the given allocator", "[polymorphic-allocator]") {
+    CountingAllocator allocator;
+    {
+        pmr::Vector<int> vector(allocator);
+        vector.assign(100, 1);
+        REQUIRE(allocator.allocations == 1);
+        REQUIRE(&vector.get_allocator().GetAllocator() == &allocator);
+    }
+    REQUIRE(allocator.allocations == 0);
+}
+
+TEST_CASE("polymorphic allocator passes itself on to nested containers", "[polymorphic-allocator]") {
+    CountingAllocator allocator;
+    {
+        pmr::Vector<pmr::String> strings(allocator);
+        strings.reserve(2);
+        strings.emplace_back(LONG_STRING);
+        strings.push_back(pmr::String(LONG_STRING, allocator));
+
+        REQUIRE(&strings[0].get_allocator().GetAllocator() == &allocator);
+        REQUIRE(&strings[1].get_allocator().GetAllocator() == &allocator);
+        REQUIRE(allocator.allocations == 3);
+    }
+    REQUIRE(allocator.allocations == 0);
+}
+
+TEST_CASE("polymorphic allocator constructs keys and values of maps with itself", "[polymorphic-allocator]") {
+    CountingAllocator allocator;
+    {
+        pmr::Map<pmr::String, pmr::Vector<int>> map(allocator);
+        map[pmr::String(LONG_STRING, allocator)].push_back(1);
+        map.emplace(LONG_STRING + 1, pmr::Vector<int>(allocator));
+
+        for (auto& entry : map) {
+            REQUIRE(&entry.first.get_allocator().GetAllocator() == &allocator);
+            REQUIRE(&entry.second.get_allocator().GetAllocator() == &allocator);
+        }
+
+        pmr::UnorderedMap<int, pmr::String> unorderedMap(allocator);
+        unorderedMap.emplace(1, LONG_STRING);
+        REQUIRE(&unorderedMap[1].get_allocator().GetAllocator() == &allocator);
+        REQUIRE(&unorderedMap[2].get_allocator().GetAllocator() == &allocator);
+    }
+    REQUIRE(allocator.allocations == 0);
+}
+
+TEST_CASE("polymorphic allocator holds move-only elements", "[polymorphic-allocator]") {
+    CountingAllocator allocator;
+    pmr::Vector<std::unique_ptr<int>> vector(allocator);
+    vector.push_back(std::make_unique<int>(1));
+    vector.emplace_back(new int(2));
+
+    REQUIRE(*vector[0] == 1);
+    REQUIRE(*vector[1] == 2);
+}
+
+TEST_CASE("polymorphic allocator compares by the allocator it carries", "[polymorphic-allocator]") {
+    CountingAllocator first;
+    CountingAllocator second;
+
+    REQUIRE(PolymorphicAllocator<int>(first) == PolymorphicAllocator<char>(first));
+    REQUIRE(PolymorphicAllocator<int>(first) != PolymorphicAllocator<int>(second));
+}
+
+TEST_CASE("polymorphic allocator backs containers with an arena", "[polymorphic-allocator]") {
+    CountingAllocator chunks;
+    {
+        ArenaAllocator arena(chunks);
+        pmr::Vector<pmr::String> strings(arena);
+        strings.reserve(10);
+        for (int i = 0; i < 10; ++i) {
+            strings.emplace_back(LONG_STRING);
+        }
+        REQUIRE(&strings.back().get_allocator().GetAllocator() == &arena);
+        REQUIRE(chunks.allocations == 1);
+    }
+    REQUIRE(chunks.allocations == 0);
+}
+
+TEST_CASE("transport context allocates its hash map from a given allocator", "[polymorphic-allocator]") {
+    CountingAllocator first;
+    CountingAllocator second;
+    {
+        std::vector<std::shared_ptr<int>> pointers;
+        napa::transport::TransportContext context(first);
+        for (int i = 0; i < 10; ++i) {
+            pointers.push_back(std::make_shared<int>(i));
+            context.SaveShared(pointers.back());
+        }
+        REQUIRE(first.allocations > 0);
+        REQUIRE(context.GetSharedCount() == 10);
+
+        // Entries move into the allocator of the destination.
+        napa::transport::TransportContext moved(second);
+        moved = std::move(context);
+        REQUIRE(second.allocations > 0);
+        for (auto& pointer : pointers) {
+            REQUIRE(moved.LoadShared<int>(reinterpret_cast<uintptr_t>(pointer.get())) == pointer);
+        }
+    }
+    REQUIRE(first.allocations == 0);
+    REQUIRE(second.allocations == 0);
+}
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <memory/shared-memory.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace napa::memory;
+
+namespace {
+
+    /// <summary> Allocator from the C heap, counting live allocations. </summary>
+    class CountingAllocator : public Allocator {
+    public:
+        void* Allocate(size_t size) override {
+            ++live;
+            return std::malloc(size);
+        }
+
+        void Deallocate(void* memory, size_t sizeHint) override {
+            --live;
+            lastSizeHint = sizeHint;
+            std::free(memory);
+        }
+
+        const char* GetType() const override {
+            return "CountingAllocator";
+        }
+
+        bool operator==(const Allocator& other) const override {
+            return this == &other;
+        }
+
+        int live = 0;
+        size_t lastSizeHint = 0;
+    };
+}
+
+TEST_CASE("allocated shared memory is deallocated through its allocator", "[shared-memory]") {
+    auto allocator = std::make_shared<CountingAllocator>();
+
+    auto memory = AllocateSharedMemory(allocator, 100);
+    REQUIRE(memory != nullptr);
+    REQUIRE(memory->GetLength() == 100);
+    REQUIRE(allocator->live == 1);
+    std::memset(memory->GetData(), 1, 100);
+
+    // It's found by address, as external ArrayBuffers over it are when they are transported.
+    auto data = memory->GetData();
+    REQUIRE(FindSharedMemory(data) == memory);
+
+    memory.reset();
+    REQUIRE(allocator->live == 0);
+    REQUIRE(allocator->lastSizeHint == 100);
+    REQUIRE(FindSharedMemory(data) == nullptr);
+}
+
+TEST_CASE("adopted shared memory is found by address while it's alive", "[shared-memory]") {
+    auto data = std::malloc(10);
+    auto memory = AdoptSharedMemory(data, 10);
+    REQUIRE(FindSharedMemory(data) == memory);
+    REQUIRE(FindSharedMemory(static_cast<char*>(data) + 1) == nullptr);
+
+    memory.reset();
+    REQUIRE(FindSharedMemory(data) == nullptr);
+}
@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <memory/thread-caching-allocator.h>
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace napa::memory;
+
+TEST_CASE("thread caching allocator rounds requests to size classes", "[thread-caching-allocator]") {
+    REQUIRE(thread_caching::GetAllocationSize(0) == 16);
+    REQUIRE(thread_caching::GetAllocationSize(1) == 16);
+    REQUIRE(thread_caching::GetAllocationSize(128) == 128);
+    REQUIRE(thread_caching::GetAllocationSize(129) == 160);
+    REQUIRE(thread_caching::GetAllocationSize(257) == 320);
+    REQUIRE(thread_caching::GetAllocationSize(thread_caching::MAX_SMALL_SIZE) == thread_caching::MAX_SMALL_SIZE);
+    REQUIRE(thread_caching::GetAllocationSize(thread_caching::MAX_SMALL_SIZE + 1) == thread_caching::MAX_SMALL_SIZE + 1);
+}
+
+TEST_CASE("thread caching allocator serves aligned, writable memory", "[thread-caching-allocator]") {
+    std::vector<std::pair<char*, size_t>> blocks;
+    for (size_t size = 1; size <= 4 * thread_caching::MAX_SMALL_SIZE; size = size * 3 / 2 + 1) {
+        auto memory = static_cast<char*>(thread_caching::Allocate(size));
+        REQUIRE(memory != nullptr);
+        REQUIRE(reinterpret_cast<uintptr_t>(memory) % alignof(std::max_align_t) == 0);
+        std::memset(memory, static_cast<int>(size & 0xff), size);
+        blocks.emplace_back(memory, size);
+    }
+
+    for (auto& block : blocks) {
+        REQUIRE(static_cast<unsigned char>(block.first[block.second - 1]) == (block.second & 0xff));
+        thread_caching::Deallocate(block.first, 0);
+    }
+}
+
+TEST_CASE("thread caching allocator reuses blocks freed on the same thread", "[thread-caching-allocator]") {
+    auto first = thread_caching::Allocate(100);
+    thread_caching::Deallocate(first, 100);
+
+    auto second = thread_caching::Allocate(112);
+    REQUIRE(second == first);
+    thread_caching::Deallocate(second, 0);
+}
+
+TEST_CASE("thread caching allocator returns blocks freed on another thread to the central list", "[thread-caching-allocator]") {
+    // A size class that no other test uses, whose batches are 2 blocks.
+    const size_t size = 24000;
+    const size_t count = 20;
+    thread_caching::FlushThreadCache();
+
+    std::vector<void*> blocks;
+    std::thread producer([&blocks, size, count]() {
+        for (size_t i = 0; i < count; ++i) {
+            blocks.push_back(thread_caching::Allocate(size));
+        }
+    });
+    producer.join();
+    auto centralCount = thread_caching::GetCentralFreeCount(size);
+
+    // The consumer keeps at most 2 batches of what it frees, the rest is handed back.
+    for (auto block : blocks) {
+        thread_caching::Deallocate(block, size);
+    }
+    REQUIRE(thread_caching::GetCentralFreeCount(size) >= centralCount + count - 4);
+
+    thread_caching::FlushThreadCache();
+    REQUIRE(thread_caching::GetCentralFreeCount(size) == centralCount + count);
+
+    // Another allocating thread takes them back instead of carving new spans.
+    std::thread consumer([size]() {
+        thread_caching::Deallocate(thread_caching::Allocate(size), size);
+    });
+    consumer.join();
+    REQUIRE(thread_caching::GetCentralFreeCount(size) == centralCount + count);
+}
@@ -3,14 +3,19 @@
 
 #include <catch/catch.hpp>
 
+#include <platform/filesystem.h>
 #include <platform/os.h>
 #include <module/core-modules/node/file-system-helpers.h>
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 using namespace napa;
 using namespace napa::module;
 
 TEST_CASE("File system helpers reads/writes a file correctly.", "[file-system-helpers]") {
-    const std::string dirname("file-system-helpers-test");
+    const std::string dirname((filesystem::TemporaryDirectory() / "napa-file-system-helpers-test").String());
     const std::string filename(dirname + platform::DIR_SEPARATOR + "file-system-helpers-test.dat");
 
     file_system_helpers::MkdirSync(dirname);
@@ -26,4 +31,57 @@ TEST_CASE("File system helpers reads/writes a file correctly.", "[file-system-he
 
     auto names = file_system_helpers::ReadDirectorySync(dirname);
     REQUIRE(names.size() == 3);
-}
\ No newline at end of file
+
+    REQUIRE(filesystem::RemoveAll(dirname));
+}
+
+TEST_CASE("File system helpers get the status of files and directories.", "[file-system-helpers]") {
+    const std::string dirname((filesystem::TemporaryDirectory() / "napa-file-system-helpers-stat-test").String());
+    const std::string filename(dirname + platform::DIR_SEPARATOR + "file-system-helpers-stat-test.dat");
+
+    file_system_helpers::MkdirSync(dirname);
+    file_system_helpers::WriteFileSync(filename, dirname.data(), dirname.length());
+
+    auto fileStat = file_system_helpers::StatSync(filename);
+    REQUIRE(fileStat.isFile);
+    REQUIRE(!fileStat.isDirectory);
+    REQUIRE(fileStat.size == dirname.length());
+    REQUIRE(fileStat.mtimeMs > 0);
+
+    auto directoryStat = file_system_helpers::StatSync(dirname);
+    REQUIRE(!directoryStat.isFile);
+    REQUIRE(directoryStat.isDirectory);
+
+    REQUIRE_THROWS(file_system_helpers::StatSync(dirname + platform::DIR_SEPARATOR + "missing"));
+
+    REQUIRE(filesystem::RemoveAll(dirname));
+}
+
+TEST_CASE("File system helpers read files into memory or map them.", "[file-system-helpers]") {
+    const std::string filename((filesystem::TemporaryDirectory() / "napa-file-system-helpers-memory-test.dat").String());
+    const std::string content("file contents");
+    file_system_helpers::WriteFileSync(filename, content.data(), content.size());
+
+    size_t size = 0;
+    auto memory = file_system_helpers::ReadFileToMemorySync(filename, size);
+    REQUIRE(size == content.size());
+    REQUIRE(std::memcmp(memory, content.data(), size) == 0);
+    std::free(memory);
+
+    auto mapped = file_system_helpers::MapFileSync(filename);
+    REQUIRE(mapped != nullptr);
+    REQUIRE(mapped->GetSize() == content.size());
+
+    const std::string emptyFilename((filesystem::TemporaryDirectory() / "napa-file-system-helpers-empty-test.dat").String());
+    file_system_helpers::WriteFileSync(emptyFilename, "", 0);
+    REQUIRE(file_system_helpers::ReadFileToMemorySync(emptyFilename, size) == nullptr);
+    REQUIRE(size == 0);
+    REQUIRE(file_system_helpers::MapFileSync(emptyFilename) == nullptr);
+
+    REQUIRE_THROWS(file_system_helpers::MapFileSync(
+        (filesystem::TemporaryDirectory() / "napa-file-system-helpers-missing.dat").String()));
+
+    mapped.reset();
+    std::remove(filename.c_str());
+    std::remove(emptyFilename.c_str());
+}
@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/loader/function-registry.h>
+
+using namespace napa;
+using namespace napa::module;
+
+TEST_CASE("Function registry saves a definition once", "[function-registry]") {
+    FunctionRegistry registry;
+
+    auto hash = registry.Save("/a.js", "() => 1");
+    REQUIRE(hash.size() == 16);
+    REQUIRE(registry.Save("/a.js", "() => 1") == hash);
+    REQUIRE(registry.GetSize() == 1);
+
+    auto definition = registry.Get(hash);
+    REQUIRE(definition != nullptr);
+    REQUIRE(definition->origin == "/a.js");
+    REQUIRE(definition->body == "() => 1");
+
+    REQUIRE(registry.Get("0000000000000000") == nullptr);
+}
+
+TEST_CASE("Function registry tells definitions apart by origin and body", "[function-registry]") {
+    FunctionRegistry registry;
+
+    auto hash = registry.Save("/a.js", "() => 1");
+    REQUIRE(registry.Save("/b.js", "() => 1") != hash);
+    REQUIRE(registry.Save("/a.js", "() => 2") != hash);
+    REQUIRE(registry.Save("", "() => 1") != hash);
+    REQUIRE(registry.GetSize() == 4);
+}
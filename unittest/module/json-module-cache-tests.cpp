@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/core-modules/node/file-system-helpers.h>
+#include <module/loader/json-module-cache.h>
+#include <platform/filesystem.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+    void WriteModule(const std::string& path, const std::string& content) {
+        file_system_helpers::WriteFileSync(path, content.data(), content.size());
+    }
+}
+
+TEST_CASE("JSON module cache keeps serialized modules until their file changes", "[json-module-cache]") {
+    JsonModuleCache jsonModuleCache;
+    const std::string path((filesystem::TemporaryDirectory() / "napa-json-module-cache-test.json").String());
+    WriteModule(path, "{\"value\": 1}");
+
+    auto version = JsonModuleCache::GetFileVersion(path);
+    REQUIRE(version.first == 12);
+    REQUIRE(jsonModuleCache.Get(path, version) == nullptr);
+
+    auto blob = std::make_shared<JsonModuleCache::Blob>(JsonModuleCache::Blob{ 1, 2, 3 });
+    jsonModuleCache.Set(path, version, blob);
+    REQUIRE(jsonModuleCache.Get(path, version) == blob);
+    REQUIRE(jsonModuleCache.GetSize() == 1);
+
+    SECTION("A changed module isn't returned") {
+        WriteModule(path, "{\"value\": 10}");
+        auto changed = JsonModuleCache::GetFileVersion(path);
+        REQUIRE(changed.first == 13);
+        REQUIRE(jsonModuleCache.Get(path, changed) == nullptr);
+    }
+
+    SECTION("Clear drops all modules") {
+        jsonModuleCache.Clear();
+        REQUIRE(jsonModuleCache.GetSize() == 0);
+        REQUIRE(jsonModuleCache.Get(path, version) == nullptr);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("JSON module cache is disabled by default, and versions of missing files throw", "[json-module-cache]") {
+    JsonModuleCache jsonModuleCache;
+    REQUIRE_FALSE(jsonModuleCache.IsEnabled());
+    REQUIRE_FALSE(jsonModuleCache.IsFrozen());
+
+    jsonModuleCache.SetMode(true, true);
+    REQUIRE(jsonModuleCache.IsEnabled());
+    REQUIRE(jsonModuleCache.IsFrozen());
+
+    REQUIRE_THROWS(JsonModuleCache::GetFileVersion(
+        (filesystem::TemporaryDirectory() / "napa-json-module-cache-missing.json").String()));
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/core-modules/node/file-system-helpers.h>
+#include <module/loader/module-bundle.h>
+#include <platform/filesystem.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+    void WriteModule(const std::string& path, const std::string& content) {
+        file_system_helpers::WriteFileSync(path, content.data(), content.size());
+    }
+}
+
+TEST_CASE("Module bundle serves modules and resolutions it was saved with", "[module-bundle]") {
+    // Modules are in test-files/module-bundle-test, bundles are written to the temporary directory.
+    const std::string bundlePath((filesystem::TemporaryDirectory() / "napa-module-bundle-test.bundle").String());
+    const std::string invalidBundlePath((filesystem::TemporaryDirectory() / "napa-module-bundle-invalid.bundle").String());
+
+    size_t moduleCount = 0;
+    std::string error;
+    REQUIRE(ModuleBundle::Save(bundlePath.c_str(),
+                               { "./module-bundle-test/main" },
+                               nullptr,
+                               false,
+                               moduleCount,
+                               error));
+    REQUIRE(moduleCount == 3);
+
+    auto bundle = ModuleBundle::Open(bundlePath.c_str(), error);
+    REQUIRE(bundle != nullptr);
+    REQUIRE(bundle->GetModuleCount() == 3);
+    REQUIRE(!bundle->HasFunctionWrapperCodeCaches());
+
+    auto directory = filesystem::CurrentDirectory().Normalize();
+    auto bundleDirectory = (directory / "module-bundle-test").Normalize();
+
+    auto main = bundle->Resolve("./module-bundle-test/main", directory);
+    REQUIRE(main != nullptr);
+    REQUIRE(main->type == ModuleType::JAVASCRIPT);
+    REQUIRE(main->fullPath == (bundleDirectory / "main.js").String());
+    REQUIRE(main->codeCache == nullptr);
+    REQUIRE(bundle->Find(main->fullPath) == main);
+
+    auto helper = bundle->Resolve("./lib/helper", bundleDirectory);
+    REQUIRE(helper != nullptr);
+    REQUIRE(std::string(helper->source, helper->sourceLength) == "exports.value = require('../data');\n");
+
+    // Both requires of the JSON module resolve to the same module.
+    auto data = bundle->Resolve("./data.json", bundleDirectory);
+    REQUIRE(data != nullptr);
+    REQUIRE(data->type == ModuleType::JSON);
+    REQUIRE(bundle->Resolve("../data", (bundleDirectory / "lib").Normalize()) == data);
+
+    // Resolutions that weren't found in sources aren't known.
+    REQUIRE(bundle->Resolve("./lib/helper", directory) == nullptr);
+    REQUIRE(bundle->Find((bundleDirectory / "other.js").String()) == nullptr);
+
+    SECTION("Wrapped sources are shared") {
+        bool ascii = false;
+        auto source = bundle->GetSource(*helper, "(function(){", "})", ascii);
+        REQUIRE(ascii);
+        REQUIRE(*source == "(function(){exports.value = require('../data');\n})");
+        REQUIRE(bundle->GetSource(*helper, "(function(){", "})", ascii) == source);
+    }
+
+    SECTION("An invalid bundle isn't opened") {
+        WriteModule(invalidBundlePath, "NAPABNDL but not a bundle");
+        REQUIRE(ModuleBundle::Open(invalidBundlePath.c_str(), error) == nullptr);
+        REQUIRE(!error.empty());
+        std::remove(invalidBundlePath.c_str());
+    }
+
+    bundle.reset();
+    std::remove(bundlePath.c_str());
+}
@@ -102,6 +102,12 @@ TEST_CASE("resolve node modules correctly.", "[module-resolver]") {
         // Starts with "./" and a binary file exists.
         ResolveIt("./resolve-file-js.napa", currentPath / "resolve-file-js.napa", ModuleType::NAPA);
 
+        // Starts with "./" and a WebAssembly file exists.
+        ResolveIt("./resolve-file-wasm.wasm", currentPath / "resolve-file-wasm.wasm", ModuleType::WASM);
+
+        // Starts with "./", but ".wasm" is not tried as an extension.
+        ResolveIt("./resolve-file-wasm", "", ModuleType::NONE);
+
         // Starts with "./", but a file doesn't exist.
         ResolveIt("./resolve-file-non-existent", "", ModuleType::NONE);
 
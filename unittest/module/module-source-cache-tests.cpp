@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/core-modules/node/file-system-helpers.h>
+#include <module/loader/module-source-cache.h>
+#include <platform/filesystem.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+    void WriteModule(const std::string& path, const std::string& content) {
+        file_system_helpers::WriteFileSync(path, content.data(), content.size());
+    }
+}
+
+TEST_CASE("Module source cache shares wrapped sources of large ASCII modules", "[module-source-cache]") {
+    ModuleSourceCache moduleSourceCache(16);
+    const std::string path((filesystem::TemporaryDirectory() / "napa-module-source-cache-test.js").String());
+    WriteModule(path, "exports.value = 1;");
+
+    auto source = moduleSourceCache.Get(path, "(function () { ", "\n})");
+    REQUIRE(source != nullptr);
+    REQUIRE(*source == "(function () { exports.value = 1;\n})");
+    REQUIRE(moduleSourceCache.Get(path, "(function () { ", "\n})") == source);
+    REQUIRE(moduleSourceCache.GetSize() == 1);
+
+    SECTION("A source wrapped differently is read again") {
+        auto unwrapped = moduleSourceCache.Get(path, "", "");
+        REQUIRE(*unwrapped == "exports.value = 1;");
+    }
+
+    SECTION("A changed module is read again") {
+        WriteModule(path, "exports.value = 2; // longer");
+        auto changed = moduleSourceCache.Get(path, "", "");
+        REQUIRE(*changed == "exports.value = 2; // longer");
+    }
+
+    SECTION("A source is released once no one uses it") {
+        source.reset();
+        REQUIRE(moduleSourceCache.GetSize() == 0);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Module source cache doesn't share small or non-ASCII modules", "[module-source-cache]") {
+    ModuleSourceCache moduleSourceCache(16);
+    const std::string path((filesystem::TemporaryDirectory() / "napa-module-source-cache-test.js").String());
+
+    WriteModule(path, "exports.a = 1;");
+    REQUIRE(moduleSourceCache.Get(path, "", "") == nullptr);
+
+    WriteModule(path, "exports.value = '\xc3\xa9t\xc3\xa9';");
+    REQUIRE(moduleSourceCache.Get(path, "", "") == nullptr);
+    REQUIRE(moduleSourceCache.Get(path, "", "") == nullptr);
+
+    REQUIRE_THROWS(moduleSourceCache.Get(
+        (filesystem::TemporaryDirectory() / "napa-module-source-cache-missing.js").String(), "", ""));
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Module source cache tells ASCII text", "[module-source-cache]") {
+    std::string text(100, 'a');
+    REQUIRE(ModuleSourceCache::IsAscii(text.data(), text.size()));
+    REQUIRE(ModuleSourceCache::IsAscii(text.data(), 0));
+
+    // Non-ASCII bytes are found in a whole word as well as in the remainder.
+    for (auto i : { 0, 7, 8, 63, 96, 99 }) {
+        auto nonAscii = text;
+        nonAscii[i] = '\x80';
+        REQUIRE_FALSE(ModuleSourceCache::IsAscii(nonAscii.data(), nonAscii.size()));
+    }
+}
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/core-modules/node/file-system-helpers.h>
+#include <module/loader/module-versions.h>
+#include <platform/filesystem.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace napa;
+using namespace napa::module;
+
+namespace {
+    void WriteModule(const std::string& path, const std::string& content) {
+        file_system_helpers::WriteFileSync(path, content.data(), content.size());
+    }
+}
+
+TEST_CASE("Module versions move on invalidation", "[module-versions]") {
+    ModuleVersions moduleVersions;
+    REQUIRE(moduleVersions.GetGeneration() == 0);
+    REQUIRE(moduleVersions.GetVersion("/a.js") == 0);
+
+    REQUIRE(moduleVersions.Invalidate("/a.js") == 1);
+    REQUIRE(moduleVersions.Invalidate("/a.js") == 2);
+    REQUIRE(moduleVersions.Invalidate("/b.js") == 1);
+    REQUIRE(moduleVersions.GetGeneration() == 3);
+
+    REQUIRE(moduleVersions.GetVersion("/a.js") == 2);
+    REQUIRE(moduleVersions.GetVersion("/b.js") == 1);
+    REQUIRE(moduleVersions.GetVersion("/c.js") == 0);
+}
+
+TEST_CASE("Module versions invalidate watched files that changed", "[module-versions]") {
+    ModuleVersions moduleVersions;
+    const std::string path((filesystem::TemporaryDirectory() / "napa-module-versions-test.js").String());
+    WriteModule(path, "exports.value = 1;");
+
+    // Files aren't watched unless watching is started.
+    moduleVersions.Watch(path);
+    REQUIRE(moduleVersions.GetWatchedCount() == 0);
+
+    moduleVersions.StartWatching(std::chrono::hours(1));
+    REQUIRE(moduleVersions.IsWatching());
+    moduleVersions.Watch(path);
+    moduleVersions.Watch(path);
+    moduleVersions.Watch("no-such-module.js");
+    REQUIRE(moduleVersions.GetWatchedCount() == 1);
+
+    REQUIRE(moduleVersions.Poll() == 0);
+    REQUIRE(moduleVersions.GetVersion(path) == 0);
+
+    WriteModule(path, "exports.value = 10;");
+    REQUIRE(moduleVersions.Poll() == 1);
+    REQUIRE(moduleVersions.GetVersion(path) == 1);
+
+    // A change is invalidated once.
+    REQUIRE(moduleVersions.Poll() == 0);
+    REQUIRE(moduleVersions.GetVersion(path) == 1);
+
+    moduleVersions.StopWatching();
+    REQUIRE(!moduleVersions.IsWatching());
+    REQUIRE(moduleVersions.GetWatchedCount() == 0);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Module versions poll watched files in background", "[module-versions]") {
+    ModuleVersions moduleVersions;
+    const std::string path((filesystem::TemporaryDirectory() / "napa-module-versions-background-test.js").String());
+    WriteModule(path, "exports.value = 1;");
+
+    moduleVersions.StartWatching(std::chrono::milliseconds(10));
+    moduleVersions.Watch(path);
+    WriteModule(path, "exports.value = 100;");
+
+    for (int i = 0; i < 500 && moduleVersions.GetGeneration() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE(moduleVersions.GetVersion(path) == 1);
+    moduleVersions.StopWatching();
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/core-modules/node/performance-timeline.h>
+
+using namespace napa::module::performance;
+
+TEST_CASE("performance now is monotonic from the time origin", "[performance-timeline]") {
+    auto first = Now();
+    auto second = Now();
+
+    REQUIRE(first >= 0);
+    REQUIRE(second >= first);
+    REQUIRE(GetTimeOrigin() > 0);
+}
+
+TEST_CASE("performance timeline measures between the latest marks of a name", "[performance-timeline]") {
+    PerformanceTimeline timeline;
+    timeline.Mark("start", 1);
+    timeline.Mark("start", 5);
+    timeline.Mark("end", 12);
+
+    double start = 0;
+    double end = 0;
+    REQUIRE(timeline.FindMark("start", start));
+    REQUIRE(timeline.FindMark("end", end));
+    REQUIRE(!timeline.FindMark("missing", end));
+    REQUIRE(start == 5);
+
+    auto& measure = timeline.Measure("work", start, end);
+    REQUIRE(measure.type == EntryType::MEASURE);
+    REQUIRE(measure.startTime == 5);
+    REQUIRE(measure.duration == 7);
+
+    REQUIRE(timeline.GetEntries().size() == 4);
+    REQUIRE(timeline.GetEntriesByName("start").size() == 2);
+    REQUIRE(timeline.GetEntriesByType(EntryType::MEASURE).size() == 1);
+
+    auto mark = EntryType::MARK;
+    REQUIRE(timeline.GetEntriesByName("work", &mark).empty());
+}
+
+TEST_CASE("performance timeline clears entries by type and name", "[performance-timeline]") {
+    PerformanceTimeline timeline;
+    timeline.Mark("a", 1);
+    timeline.Mark("b", 2);
+    timeline.Measure("a", 1, 2);
+
+    std::string name = "a";
+    timeline.Clear(EntryType::MARK, &name);
+    REQUIRE(timeline.GetEntries().size() == 2);
+    REQUIRE(timeline.GetEntriesByName("a").size() == 1);
+
+    timeline.Clear(EntryType::MEASURE);
+    REQUIRE(timeline.GetEntries().size() == 1);
+    REQUIRE(timeline.GetEntries().front().name == "b");
+}
+
+TEST_CASE("performance timeline drops the oldest entries beyond its capacity", "[performance-timeline]") {
+    PerformanceTimeline timeline(2);
+    timeline.Mark("a", 1);
+    timeline.Mark("b", 2);
+    timeline.Mark("c", 3);
+
+    REQUIRE(timeline.GetEntries().size() == 2);
+    REQUIRE(timeline.GetEntries().front().name == "b");
+
+    double time = 0;
+    REQUIRE(!timeline.FindMark("a", time));
+}
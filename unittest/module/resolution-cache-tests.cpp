@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/core-modules/node/file-system-helpers.h>
+#include <module/loader/module-resolver.h>
+#include <module/loader/resolution-cache.h>
+#include <platform/filesystem.h>
+
+#include <cstdio>
+
+using namespace napa;
+using namespace napa::module;
+
+TEST_CASE("Resolution cache keeps successful resolutions by name and path", "[resolution-cache]") {
+    ResolutionCache cache;
+    ModuleInfo moduleInfo;
+
+    REQUIRE_FALSE(cache.TryGet("a", "/base", moduleInfo));
+
+    cache.Insert("a", "/base", ModuleInfo{ ModuleType::JAVASCRIPT, "/base/node_modules/a.js", "" });
+    cache.Insert("b", "/base", ModuleInfo{ ModuleType::NONE, "", "" });
+    REQUIRE(cache.GetSize() == 1);
+
+    REQUIRE(cache.TryGet("a", "/base", moduleInfo));
+    REQUIRE(moduleInfo.type == ModuleType::JAVASCRIPT);
+    REQUIRE(moduleInfo.fullPath == "/base/node_modules/a.js");
+
+    REQUIRE_FALSE(cache.TryGet("a", "/other", moduleInfo));
+    REQUIRE_FALSE(cache.TryGet("b", "/base", moduleInfo));
+
+    cache.Clear();
+    REQUIRE(cache.GetSize() == 0);
+    REQUIRE_FALSE(cache.TryGet("a", "/base", moduleInfo));
+}
+
+TEST_CASE("Module resolvers share a resolution cache", "[resolution-cache]") {
+    auto currentPath = filesystem::CurrentDirectory();
+    ResolutionCache cache;
+
+    ModuleResolver resolver1(cache);
+    auto moduleInfo = resolver1.Resolve("./resolve-file-js");
+    REQUIRE(moduleInfo.type == ModuleType::JAVASCRIPT);
+    REQUIRE(cache.GetSize() == 1);
+
+    ModuleResolver resolver2(cache);
+    REQUIRE(resolver2.Resolve("./resolve-file-js").fullPath == moduleInfo.fullPath);
+    REQUIRE(cache.GetSize() == 1);
+
+    // Core modules aren't shared, each resolver has its own registry.
+    resolver1.SetAsCoreModule("resolution-cache-core");
+    REQUIRE(resolver1.Resolve("resolution-cache-core").type == ModuleType::CORE);
+    REQUIRE(resolver2.Resolve("resolution-cache-core").type == ModuleType::NONE);
+}
+
+TEST_CASE("Stat cache remembers misses until it's cleared", "[resolution-cache]") {
+    const std::string filename("resolution-cache-new.js");
+    std::remove(filename.c_str());
+
+    ResolutionCache cache;
+    cache.SetStatCacheEnabled(true);
+    ModuleResolver resolver(cache);
+
+    REQUIRE(resolver.Resolve("./resolution-cache-new").type == ModuleType::NONE);
+
+    file_system_helpers::WriteFileSync(filename, "", 0);
+    REQUIRE(resolver.Resolve("./resolution-cache-new").type == ModuleType::NONE);
+
+    cache.Clear();
+    REQUIRE(resolver.Resolve("./resolution-cache-new").type == ModuleType::JAVASCRIPT);
+
+    SECTION("Lookups go to the file system without stat cache") {
+        cache.SetStatCacheEnabled(false);
+        cache.Clear();
+        std::remove(filename.c_str());
+        REQUIRE(resolver.Resolve("./resolution-cache-new").type == ModuleType::NONE);
+    }
+
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <module/core-modules/node/file-system-helpers.h>
+#include <module/loader/script-cache.h>
+#include <platform/filesystem.h>
+
+using namespace napa;
+using namespace napa::module;
+
+TEST_CASE("Script cache shares a code cache per module path and content", "[script-cache]") {
+    ScriptCache scriptCache;
+
+    auto codeCache = scriptCache.Get("/a.js", "exports.a = 1;");
+    REQUIRE(codeCache != nullptr);
+    REQUIRE(codeCache->Get() == nullptr);
+    REQUIRE(scriptCache.Get("/a.js", "exports.a = 1;") == codeCache);
+    REQUIRE(scriptCache.Get("/b.js", "exports.a = 1;") != codeCache);
+    REQUIRE(scriptCache.GetSize() == 2);
+
+    SECTION("A changed content replaces the module cache") {
+        auto changed = scriptCache.Get("/a.js", "exports.a = 2;");
+        REQUIRE(changed != codeCache);
+        REQUIRE(scriptCache.Get("/a.js", "exports.a = 2;") == changed);
+        REQUIRE(scriptCache.GetSize() == 2);
+    }
+
+    SECTION("Nothing is saved without directory") {
+        codeCache->Set({ 1, 2, 3 });
+        REQUIRE_FALSE(scriptCache.Save("/a.js", "exports.a = 1;", *codeCache));
+    }
+}
+
+TEST_CASE("Script cache persists code caches in a directory", "[script-cache]") {
+    const std::string directory((filesystem::TemporaryDirectory() / "napa-script-cache-test").String());
+    filesystem::RemoveAll(directory);
+    file_system_helpers::MkdirSync(directory);
+
+    {
+        ScriptCache scriptCache;
+        scriptCache.SetDirectory(directory);
+
+        auto codeCache = scriptCache.Get("/a.js", "exports.a = 1;");
+        REQUIRE_FALSE(scriptCache.Save("/a.js", "exports.a = 1;", *codeCache));
+
+        codeCache->Set({ 1, 2, 3 });
+        REQUIRE(scriptCache.Save("/a.js", "exports.a = 1;", *codeCache));
+
+        // The temporary file is renamed to the cache file.
+        REQUIRE(file_system_helpers::ReadDirectorySync(directory).size() == 1);
+    }
+
+    ScriptCache scriptCache;
+    scriptCache.SetDirectory(directory);
+
+    auto data = scriptCache.Get("/a.js", "exports.a = 1;")->Get();
+    REQUIRE(data != nullptr);
+    REQUIRE(*data == zone::CodeCache::Data({ 1, 2, 3 }));
+
+    REQUIRE(scriptCache.Get("/a.js", "exports.a = 2;")->Get() == nullptr);
+    REQUIRE(scriptCache.Get("/b.js", "exports.a = 1;")->Get() == nullptr);
+
+    REQUIRE(filesystem::RemoveAll(directory));
+}
+
+TEST_CASE("Script cache saves a warm code cache of the current module content", "[script-cache]") {
+    const std::string directory((filesystem::TemporaryDirectory() / "napa-script-cache-test").String());
+    filesystem::RemoveAll(directory);
+    file_system_helpers::MkdirSync(directory);
+
+    {
+        ScriptCache scriptCache;
+        scriptCache.SetDirectory(directory);
+
+        auto codeCache = scriptCache.Get("/warm.js", "exports.a = 1;");
+        codeCache->Set({ 1, 2, 3 });
+        REQUIRE(codeCache->Warm({ 4, 5, 6, 7 }));
+        REQUIRE(scriptCache.Save("/warm.js", *codeCache));
+
+        // A cache replaced by a changed content isn't saved.
+        scriptCache.Get("/warm.js", "exports.a = 2;");
+        REQUIRE_FALSE(scriptCache.Save("/warm.js", *codeCache));
+    }
+
+    ScriptCache scriptCache;
+    scriptCache.SetDirectory(directory);
+
+    auto data = scriptCache.Get("/warm.js", "exports.a = 1;")->Get();
+    REQUIRE(data != nullptr);
+    REQUIRE(*data == zone::CodeCache::Data({ 4, 5, 6, 7 }));
+
+    REQUIRE(filesystem::RemoveAll(directory));
+}
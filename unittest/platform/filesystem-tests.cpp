@@ -4,6 +4,8 @@
 #include <catch/catch.hpp>
 #include <platform/filesystem.h>
 
+#include <cstdio>
+
 using namespace napa;
 
 TEST_CASE("filesystem::Path", "[Path]") {
@@ -282,4 +284,23 @@ TEST_CASE("filesystem", "[Operations]") {
         REQUIRE(filesystem::MakeDirectories("./a/b/c"));
         REQUIRE(filesystem::IsDirectory("./a/b/c"));
     }
-}
\ No newline at end of file
+}
+TEST_CASE("filesystem temporary files", "[Operations]") {
+
+    SECTION("TemporaryDirectory") {
+        auto directory = filesystem::TemporaryDirectory();
+        REQUIRE(directory.IsAbsolute());
+        REQUIRE(filesystem::IsDirectory(directory));
+    }
+
+    SECTION("RemoveAll") {
+        auto root = filesystem::TemporaryDirectory() / "napa-remove-all-test";
+        REQUIRE(filesystem::MakeDirectories(root / "a/b"));
+        REQUIRE(std::fclose(std::fopen((root / "a/b/file").c_str(), "w")) == 0);
+        REQUIRE(std::fclose(std::fopen((root / "file").c_str(), "w")) == 0);
+
+        REQUIRE(filesystem::RemoveAll(root));
+        REQUIRE(!filesystem::Exists(root));
+        REQUIRE(filesystem::RemoveAll(root));
+    }
+}
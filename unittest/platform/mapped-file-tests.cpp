@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <platform/filesystem.h>
+#include <platform/mapped-file.h>
+#include <module/core-modules/node/file-system-helpers.h>
+
+#include <cstdio>
+#include <cstring>
+
+using namespace napa;
+using namespace napa::module;
+
+TEST_CASE("mapped file maps the contents of a file", "[mapped-file]") {
+    auto filename = (filesystem::TemporaryDirectory() / "napa-mapped-file-test.dat").String();
+    const std::string content("mapped file contents");
+    file_system_helpers::WriteFileSync(filename, content.data(), content.size());
+
+    auto file = platform::MappedFile::Open(filename);
+    REQUIRE(file != nullptr);
+    REQUIRE(file->GetSize() == content.size());
+    REQUIRE(std::memcmp(file->GetData(), content.data(), content.size()) == 0);
+
+    REQUIRE(platform::MappedFile::Open((filesystem::TemporaryDirectory() / "napa-mapped-file-missing.dat").String()) == nullptr);
+
+    file.reset();
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("mapped file writes copy-on-write pages without changing the file", "[mapped-file]") {
+    auto filename = (filesystem::TemporaryDirectory() / "napa-mapped-file-cow-test.dat").String();
+    const std::string content("copy on write");
+    file_system_helpers::WriteFileSync(filename, content.data(), content.size());
+
+    auto file = platform::MappedFile::Open(filename, true);
+    REQUIRE(file != nullptr);
+    file->GetMutableData()[0] = 'C';
+    REQUIRE(file->GetData()[0] == 'C');
+
+    REQUIRE(file_system_helpers::ReadFileSync(filename) == content);
+
+    file.reset();
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <platform/os.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+using namespace napa;
+
+TEST_CASE("os detects processor topology", "[os]") {
+    auto& topology = platform::GetProcessorTopology();
+    REQUIRE(!topology.empty());
+
+    std::set<uint32_t> ids;
+    for (size_t i = 0; i < topology.size(); ++i) {
+        ids.insert(topology[i].id);
+        if (i > 0) {
+            REQUIRE(topology[i - 1].numaNode <= topology[i].numaNode);
+        }
+    }
+    REQUIRE(ids.size() == topology.size());
+}
+
+TEST_CASE("os sets thread affinity", "[os]") {
+    REQUIRE(platform::SetCurrentThreadAffinity({}) == false);
+
+#if defined(__linux__) || defined(_WIN32)
+    auto processor = platform::GetProcessorTopology()[0].id;
+    bool succeeded = false;
+    std::thread([&]() {
+        succeeded = platform::SetCurrentThreadAffinity({ processor });
+    }).join();
+    REQUIRE(succeeded);
+#endif
+}
+
+TEST_CASE("os sets thread priority", "[os]") {
+    std::atomic<bool> normal(false);
+    std::atomic<bool> lower(false);
+    std::thread([&]() {
+        normal = platform::SetCurrentThreadPriority(platform::ThreadPriority::NORMAL);
+        lower = platform::SetCurrentThreadPriority(platform::ThreadPriority::LOW);
+    }).join();
+    REQUIRE(normal);
+
+#if defined(__linux__) || defined(_WIN32)
+    // Lowering the priority doesn't require privileges.
+    REQUIRE(lower);
+#endif
+}
+
+TEST_CASE("os creates threads with a stack size", "[os]") {
+    platform::Thread empty;
+    REQUIRE(empty.Joinable() == false);
+
+    const size_t stackSize = 16 * 1024 * 1024;
+    size_t actualStackSize = 0;
+    bool ran = false;
+    platform::Thread thread([&]() {
+        ran = true;
+#ifdef __linux__
+        pthread_attr_t attributes;
+        pthread_getattr_np(pthread_self(), &attributes);
+        pthread_attr_getstacksize(&attributes, &actualStackSize);
+        pthread_attr_destroy(&attributes);
+#else
+        actualStackSize = stackSize;
+#endif
+    }, stackSize);
+    REQUIRE(thread.Joinable());
+
+    platform::Thread moved(std::move(thread));
+    REQUIRE(thread.Joinable() == false);
+    moved.Join();
+
+    REQUIRE(moved.Joinable() == false);
+    REQUIRE(ran);
+    REQUIRE(actualStackSize >= stackSize);
+}
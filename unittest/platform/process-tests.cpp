@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <platform/process.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace napa;
+
+TEST_CASE("process measures CPU time of the calling thread", "[process]") {
+    auto start = platform::GetThreadCpuTime();
+    auto wallStart = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - wallStart < std::chrono::milliseconds(20)) {
+    }
+    auto busy = platform::GetThreadCpuTime() - start;
+    REQUIRE(busy > 0);
+
+    // Sleeping doesn't consume CPU time, unlike spinning the same while.
+    start = platform::GetThreadCpuTime();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto idle = platform::GetThreadCpuTime() - start;
+    REQUIRE(idle < busy);
+
+    // Other threads don't count towards the calling thread.
+    int64_t other = 0;
+    std::thread thread([&other]() {
+        other = platform::GetThreadCpuTime();
+    });
+    thread.join();
+    REQUIRE(other < platform::GetThreadCpuTime());
+}
+
+TEST_CASE("process measures CPU time of another thread by its clock", "[process]") {
+    std::atomic<platform::ThreadCpuClock> clock(0);
+    std::atomic<bool> clockSet(false);
+    std::atomic<bool> stop(false);
+    std::thread thread([&]() {
+        clock = platform::GetCurrentThreadCpuClock();
+        clockSet = true;
+        while (!stop) {
+        }
+    });
+
+    while (!clockSet) {
+        std::this_thread::yield();
+    }
+
+    // The spinning thread consumes CPU time while this one sleeps.
+    auto start = platform::GetThreadCpuTime(clock);
+    auto ownStart = platform::GetThreadCpuTime();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto spent = platform::GetThreadCpuTime(clock) - start;
+    auto ownSpent = platform::GetThreadCpuTime() - ownStart;
+
+    stop = true;
+    thread.join();
+
+    REQUIRE(spent > 0);
+    REQUIRE(spent > ownSpent);
+}
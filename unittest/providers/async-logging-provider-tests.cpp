@@ -0,0 +1,176 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <napa/log.h>
+#include <providers/async-logging-provider.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa::providers;
+
+namespace {
+
+    const char* LOG_FILE = "async-logging-provider-tests.log";
+
+    using Verboseness = LoggingProvider::Verboseness;
+
+    /// <summary> Reads the lines of the log file, then deletes it. </summary>
+    std::vector<std::string> TakeLogLines() {
+        std::vector<std::string> lines;
+        {
+            std::ifstream file(LOG_FILE);
+            std::string line;
+            while (std::getline(file, line)) {
+                lines.push_back(line);
+            }
+        }
+        std::remove(LOG_FILE);
+        return lines;
+    }
+}
+
+TEST_CASE("async logging provider writes messages in the console format", "[async-logging-provider]") {
+    std::remove(LOG_FILE);
+    {
+        AsyncLoggingProvider provider(LOG_FILE);
+        provider.LogMessage("Section", Verboseness::Info, "", "dir/file.cpp", 10, "first message");
+        provider.LogMessage("", Verboseness::Error, "", "file.cpp", 20, "second message");
+        provider.Flush();
+
+        auto lines = TakeLogLines();
+        REQUIRE(lines == std::vector<std::string>({
+            "[Section] first message [dir/file.cpp:10]",
+            "second message [file.cpp:20]" }));
+        REQUIRE(provider.GetDroppedCount() == 0);
+    }
+}
+
+TEST_CASE("async logging provider keeps the order of messages of each thread", "[async-logging-provider]") {
+    std::remove(LOG_FILE);
+
+    const int threadCount = 4;
+    const int messageCount = 100;
+    {
+        AsyncLoggingProvider provider(LOG_FILE, 1024);
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&provider, i]() {
+                for (int j = 0; j < messageCount; ++j) {
+                    provider.LogMessage(std::to_string(i).c_str(), Verboseness::Info, "", "file.cpp", j, "message");
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Destroying the provider wrote all queued messages.
+    std::vector<int> nextLines(threadCount, 0);
+    for (auto& line : TakeLogLines()) {
+        int thread = line[1] - '0';
+        REQUIRE(line == "[" + std::to_string(thread) + "] message [file.cpp:" + std::to_string(nextLines[thread]) + "]");
+        ++nextLines[thread];
+    }
+    REQUIRE(nextLines == std::vector<int>(threadCount, messageCount));
+}
+
+TEST_CASE("async logging provider counts messages dropped when a ring is full", "[async-logging-provider]") {
+    std::remove(LOG_FILE);
+
+    const uint64_t messageCount = 100000;
+    uint64_t droppedCount = 0;
+    {
+        AsyncLoggingProvider provider(LOG_FILE, 2);
+        for (uint64_t i = 0; i < messageCount; ++i) {
+            provider.LogMessage("", Verboseness::Info, "", "file.cpp", 1, "message");
+        }
+        provider.Flush();
+        droppedCount = provider.GetDroppedCount();
+    }
+    REQUIRE(droppedCount > 0);
+
+    uint64_t writtenCount = 0;
+    bool reported = false;
+    for (auto& line : TakeLogLines()) {
+        if (line.find("[Log] ") == 0) {
+            reported = true;
+        } else {
+            ++writtenCount;
+        }
+    }
+    REQUIRE(reported);
+    REQUIRE(writtenCount + droppedCount == messageCount);
+}
+
+TEST_CASE("async logging provider writes synchronously once destroyed", "[async-logging-provider]") {
+    std::remove(LOG_FILE);
+    {
+        AsyncLoggingProvider provider(LOG_FILE);
+        provider.LogMessage("", Verboseness::Info, "", "file.cpp", 1, "before");
+        provider.Destroy();
+        provider.LogMessage("", Verboseness::Info, "", "file.cpp", 2, "after");
+
+        auto lines = TakeLogLines();
+        REQUIRE(lines == std::vector<std::string>({ "before [file.cpp:1]", "after [file.cpp:2]" }));
+    }
+}
+
+TEST_CASE("async logging provider truncates long messages", "[async-logging-provider]") {
+    std::remove(LOG_FILE);
+    {
+        AsyncLoggingProvider provider(LOG_FILE);
+        std::string message(2 * LOG_MAX_SIZE, 'a');
+        provider.LogMessage("", Verboseness::Info, "", "file.cpp", 1, message.c_str());
+        provider.Flush();
+
+        auto lines = TakeLogLines();
+        REQUIRE(lines.size() == 1);
+        REQUIRE(lines[0] == std::string(LOG_MAX_SIZE - 1, 'a') + " [file.cpp:1]");
+    }
+}
+
+TEST_CASE("async logging provider formats deferred messages on the flusher", "[async-logging-provider]") {
+    std::remove(LOG_FILE);
+    {
+        AsyncLoggingProvider provider(LOG_FILE);
+        LogArgument arguments[] = { logging_detail::MakeArgument(42), logging_detail::MakeArgument("name") };
+        provider.LogDeferred("Section", Verboseness::Info, "", "file.cpp", 3, "value %d of %s", arguments, 2);
+        provider.Flush();
+
+        auto lines = TakeLogLines();
+        REQUIRE(lines == std::vector<std::string>({ "[Section] value 42 of name [file.cpp:3]" }));
+    }
+}
+
+TEST_CASE("async logging provider writes binary logs", "[async-logging-provider]") {
+    std::remove(LOG_FILE);
+    {
+        AsyncLoggingProvider provider(LOG_FILE, 0, true);
+        LogArgument arguments[] = { logging_detail::MakeArgument(1.5) };
+        for (int i = 0; i < 3; ++i) {
+            provider.LogDeferred("", Verboseness::Info, "", "file.cpp", i, "deferred %.1f", arguments, 1);
+        }
+        provider.LogMessage("Section", Verboseness::Info, "", "other.cpp", 10, "formatted");
+    }
+
+    std::ifstream input(LOG_FILE, std::ios::binary);
+    std::ostringstream text;
+    REQUIRE(DecodeBinaryLog(input, text));
+    REQUIRE(text.str() ==
+        "deferred 1.5 [file.cpp:0]\n"
+        "deferred 1.5 [file.cpp:1]\n"
+        "deferred 1.5 [file.cpp:2]\n"
+        "[Section] formatted [other.cpp:10]\n");
+
+    input.close();
+    std::remove(LOG_FILE);
+}
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <providers/console-sink.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa::providers;
+using napa::settings::ConsoleOutput;
+
+namespace {
+
+    const char* OUTPUT_FILE = "console-sink-tests.log";
+
+    /// <summary> Reads the output file. </summary>
+    std::string ReadOutput() {
+        std::ifstream file(OUTPUT_FILE);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    void WriteLine(ConsoleSink& sink, const std::string& line) {
+        sink.WriteLine(line.data(), line.size());
+    }
+}
+
+TEST_CASE("console sink writes lines synchronously until configured", "[console-sink]") {
+    auto output = fopen(OUTPUT_FILE, "wb");
+    REQUIRE(output != nullptr);
+    {
+        ConsoleSink sink(output);
+        WriteLine(sink, "hello");
+        REQUIRE(ReadOutput() == "hello\n");
+    }
+    fclose(output);
+    std::remove(OUTPUT_FILE);
+}
+
+TEST_CASE("console sink writes lines of threads in batches", "[console-sink]") {
+    auto output = fopen(OUTPUT_FILE, "wb");
+    REQUIRE(output != nullptr);
+    {
+        ConsoleSink sink(output);
+        sink.Configure(ConsoleOutput::ASYNC, 0);
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&sink, i]() {
+                for (int j = 0; j < 100; ++j) {
+                    WriteLine(sink, std::to_string(i) + ":" + std::to_string(j));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        sink.Flush();
+
+        // Lines of a thread keep their order.
+        auto content = ReadOutput();
+        for (int i = 0; i < 4; ++i) {
+            size_t position = 0;
+            for (int j = 0; j < 100; ++j) {
+                auto line = std::to_string(i) + ":" + std::to_string(j) + "\n";
+                auto found = content.find(line, position);
+                REQUIRE(found != std::string::npos);
+                REQUIRE((found == 0 || content[found - 1] == '\n'));
+                position = found + line.size();
+            }
+        }
+        REQUIRE(sink.GetDroppedCount() == 0);
+    }
+    fclose(output);
+    std::remove(OUTPUT_FILE);
+}
+
+TEST_CASE("console sink drops lines beyond the buffer and the rate limit", "[console-sink]") {
+    auto output = fopen(OUTPUT_FILE, "wb");
+    REQUIRE(output != nullptr);
+    {
+        // 16 bytes hold 4 lines of 4 bytes each, line breaks included.
+        ConsoleSink sink(output, 16);
+        sink.Configure(ConsoleOutput::NODE, 0);
+        for (int i = 0; i < 5; ++i) {
+            WriteLine(sink, "abc");
+        }
+        REQUIRE(sink.GetDroppedCount() == 1);
+        REQUIRE(sink.Take() == "abc\nabc\nabc\nabc\n1 console line(s) dropped, zone workers wrote more than console output keeps up with.\n");
+        REQUIRE(sink.Take().empty());
+
+        // A thread may write a second worth of lines at once.
+        sink.Configure(ConsoleOutput::NODE, 2);
+        for (int i = 0; i < 3; ++i) {
+            WriteLine(sink, std::to_string(i));
+        }
+        REQUIRE(sink.GetDroppedCount() == 2);
+        REQUIRE(sink.Take() == "0\n1\n1 console line(s) dropped, zone workers wrote more than console output keeps up with.\n");
+
+        // Output taken by Node isn't written by the sink.
+        REQUIRE(ReadOutput().empty());
+    }
+    fclose(output);
+    std::remove(OUTPUT_FILE);
+}
+
+TEST_CASE("console sink writes buffered lines when stopped", "[console-sink]") {
+    auto output = fopen(OUTPUT_FILE, "wb");
+    REQUIRE(output != nullptr);
+    {
+        ConsoleSink sink(output);
+        sink.Configure(ConsoleOutput::NODE, 0);
+        WriteLine(sink, "buffered");
+        sink.Stop();
+        WriteLine(sink, "after");
+        REQUIRE(ReadOutput() == "buffered\nafter\n");
+    }
+    fclose(output);
+    std::remove(OUTPUT_FILE);
+}
@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <providers/hdr-histogram.h>
+
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace napa::providers;
+
+TEST_CASE("hdr histogram buckets keep values within 1/64th", "[hdr-histogram]") {
+    REQUIRE(HdrHistogram::GetBucket(0) == 0);
+    REQUIRE(HdrHistogram::GetBucket(127) == 127);
+    REQUIRE(HdrHistogram::GetBucket(128) == 128);
+    REQUIRE(HdrHistogram::GetBucket(129) == 128);
+    REQUIRE(HdrHistogram::GetBucket(std::numeric_limits<uint64_t>::max()) == HdrHistogram::BUCKET_COUNT - 1);
+    REQUIRE(HdrHistogram::GetHighestValue(HdrHistogram::BUCKET_COUNT - 1) == std::numeric_limits<uint64_t>::max());
+
+    for (uint64_t value : { 1ull, 100ull, 1000ull, 123456ull, 1ull << 40, (1ull << 62) + 12345 }) {
+        auto bucket = HdrHistogram::GetBucket(value);
+        auto highest = HdrHistogram::GetHighestValue(bucket);
+        REQUIRE(highest >= value);
+        REQUIRE(highest - value <= value / 64);
+        REQUIRE(HdrHistogram::GetBucket(highest) == bucket);
+        REQUIRE(HdrHistogram::GetBucket(highest + 1) == bucket + 1);
+    }
+}
+
+TEST_CASE("hdr histogram reports percentiles", "[hdr-histogram]") {
+    HdrHistogram histogram;
+    REQUIRE(histogram.GetValueAtPercentile(50) == 0);
+
+    for (int64_t value = 1; value <= 1000; ++value) {
+        histogram.Record(value);
+    }
+    histogram.Record(-5);
+
+    REQUIRE(histogram.GetCount() == 1001);
+    REQUIRE(histogram.GetSum() == 500500);
+    REQUIRE(histogram.GetMin() == 0);
+    REQUIRE(histogram.GetMax() == 1000);
+    REQUIRE(histogram.GetValueAtPercentile(0) == 0);
+    REQUIRE(histogram.GetValueAtPercentile(100) == 1000);
+    REQUIRE(histogram.GetValueAtPercentile(50) == Approx(500).epsilon(1.0 / 64));
+    REQUIRE(histogram.GetValueAtPercentile(99) == Approx(990).epsilon(1.0 / 64));
+}
+
+TEST_CASE("concurrent hdr histograms merge values of all threads", "[hdr-histogram]") {
+    constexpr int THREAD_COUNT = 4;
+    constexpr int VALUE_COUNT = 10000;
+
+    ConcurrentHdrHistogram first;
+    ConcurrentHdrHistogram second;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; ++i) {
+        threads.emplace_back([&first, &second, i]() {
+            for (int value = 0; value < VALUE_COUNT; ++value) {
+                (i % 2 == 0 ? first : second).Record(value);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    HdrHistogram histogram;
+    first.AddTo(histogram);
+    second.AddTo(histogram);
+
+    REQUIRE(histogram.GetCount() == THREAD_COUNT * VALUE_COUNT);
+    REQUIRE(histogram.GetSum() == int64_t(THREAD_COUNT) * VALUE_COUNT * (VALUE_COUNT - 1) / 2);
+    REQUIRE(histogram.GetMin() == 0);
+    REQUIRE(histogram.GetMax() == VALUE_COUNT - 1);
+    REQUIRE(histogram.GetValueAtPercentile(90) == Approx(9000).epsilon(1.0 / 64));
+}
@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <providers/in-process-metric-provider.h>
+#include <providers/metric-export.h>
+
+#include <thread>
+#include <vector>
+
+using namespace napa::providers;
+
+TEST_CASE("in-process metrics are counted across threads", "[in-process-metric-provider]") {
+    InProcessMetricProvider provider;
+
+    const char* dimensionNames[] = { "client" };
+    auto rate = provider.GetMetric("app", "requests", MetricType::Rate, 1, dimensionNames);
+    auto number = provider.GetMetric("app", "connections", MetricType::Number, 0, nullptr);
+    REQUIRE(provider.GetMetric("app", "requests", MetricType::Rate, 1, dimensionNames) == rate);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([rate, number, i]() {
+            const char* client[] = { i % 2 == 0 ? "a" : "b" };
+            for (int j = 0; j < 1000; ++j) {
+                rate->Increment(1, 1, client);
+                number->Increment(2, 0, nullptr);
+                number->Decrement(1, 0, nullptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // The number of dimension values must match.
+    REQUIRE(rate->Increment(1, 0, nullptr) == false);
+
+    auto snapshots = provider.GetSnapshots({});
+    REQUIRE(snapshots.size() == 2);
+    REQUIRE(snapshots[0].name == "requests");
+    REQUIRE((snapshots[0].dimensionNames == std::vector<std::string>{ "client" }));
+    REQUIRE(snapshots[0].series.size() == 2);
+    REQUIRE(snapshots[0].series[0].value == 2000);
+    REQUIRE(snapshots[0].series[1].value == 2000);
+    REQUIRE(snapshots[1].series.size() == 1);
+    REQUIRE(snapshots[1].series[0].value == 4000);
+
+    REQUIRE(number->Set(10, 0, nullptr));
+    number->Increment(5, 0, nullptr);
+    REQUIRE(provider.GetSnapshots({})[1].series[0].value == 15);
+}
+
+TEST_CASE("in-process percentile metrics report percentiles", "[in-process-metric-provider]") {
+    InProcessMetricProvider provider;
+
+    auto latency = provider.GetMetric("app", "latency", MetricType::Percentile, 0, nullptr);
+    for (int64_t value = 1; value <= 100; ++value) {
+        REQUIRE(latency->Set(value, 0, nullptr));
+    }
+    REQUIRE(latency->Increment(1, 0, nullptr) == false);
+
+    auto snapshots = provider.GetSnapshots({ 50, 100 });
+    REQUIRE(snapshots.size() == 1);
+
+    const auto& series = snapshots[0].series[0];
+    REQUIRE(series.count == 100);
+    REQUIRE(series.value == 5050);
+    REQUIRE(series.min == 1);
+    REQUIRE(series.max == 100);
+    REQUIRE((series.percentiles == std::vector<int64_t>{ 50, 100 }));
+}
+
+TEST_CASE("in-process bound metrics update the series of their dimension values", "[in-process-metric-provider]") {
+    InProcessMetricProvider provider;
+
+    const char* dimensionNames[] = { "zone", "worker" };
+    auto rate = provider.GetMetric("app", "tasks", MetricType::Rate, 2, dimensionNames);
+    auto latency = provider.GetMetric("app", "latency", MetricType::Percentile, 2, dimensionNames);
+
+    REQUIRE(rate->Bind(1, dimensionNames) == nullptr);
+
+    const char* dimensionValues[] = { "zone1", "3" };
+    auto bound = BindMetric(rate, 2, dimensionValues);
+    REQUIRE(bound != nullptr);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&bound]() {
+            for (int j = 0; j < 1000; ++j) {
+                bound->Increment(1);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(rate->Increment(1, 2, dimensionValues));
+
+    auto boundLatency = BindMetric(latency, 2, dimensionValues);
+    REQUIRE(boundLatency->Set(42));
+    REQUIRE(boundLatency->Increment(1) == false);
+
+    auto snapshots = provider.GetSnapshots({ 50 });
+    REQUIRE(snapshots[0].series.size() == 1);
+    REQUIRE((snapshots[0].series[0].dimensionValues == std::vector<std::string>{ "zone1", "3" }));
+    REQUIRE(snapshots[0].series[0].value == 4001);
+    REQUIRE(snapshots[1].series[0].count == 1);
+    REQUIRE(snapshots[1].series[0].percentiles[0] == 42);
+
+    // A metric without dimensions binds to its only series.
+    auto number = provider.GetMetric("app", "connections", MetricType::Number, 0, nullptr);
+    auto boundNumber = BindMetric(number, 0, nullptr);
+    REQUIRE(boundNumber->Set(7));
+    REQUIRE(boundNumber->Decrement(2));
+    REQUIRE(provider.GetSnapshots({})[2].series[0].value == 5);
+
+    REQUIRE(BindMetric(nullptr, 0, nullptr) == nullptr);
+}
+
+TEST_CASE("metric snapshots are formatted as Prometheus text", "[in-process-metric-provider]") {
+    InProcessMetricProvider provider;
+
+    const char* dimensionNames[] = { "client-id" };
+    const char* client[] = { "a\"b" };
+    provider.GetMetric("app", "qps", MetricType::Rate, 1, dimensionNames)->Increment(3, 1, client);
+    provider.GetMetric("", "open.files", MetricType::Number, 0, nullptr)->Set(-2, 0, nullptr);
+    provider.GetMetric("app", "latency", MetricType::Percentile, 0, nullptr)->Set(7, 0, nullptr);
+
+    std::vector<double> percentiles = { 50, 99.9 };
+    REQUIRE(FormatPrometheusText(provider.GetSnapshots(percentiles), percentiles) ==
+        "# TYPE app_qps counter\n"
+        "app_qps{client_id=\"a\\\"b\"} 3\n"
+        "# TYPE open_files gauge\n"
+        "open_files -2\n"
+        "# TYPE app_latency summary\n"
+        "app_latency{quantile=\"0.5\"} 7\n"
+        "app_latency{quantile=\"0.999\"} 7\n"
+        "app_latency_sum 7\n"
+        "app_latency_count 1\n");
+}
@@ -0,0 +1,115 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <napa/log.h>
+#include <providers/log-record.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace napa::providers;
+
+namespace {
+
+    /// <summary> Formats a message the way a deferred LOG call is, through the typed arguments of napa/log.h. </summary>
+    template <typename... Args>
+    std::string Format(const char* format, const Args&... args) {
+        LogArgument arguments[sizeof...(Args) + 1] = { logging_detail::MakeArgument(args)... };
+        char data[LOG_MAX_SIZE + 32];
+        auto size = EncodeLogArguments(arguments, sizeof...(Args), data, sizeof(data));
+        return FormatLogMessage(format, data, size);
+    }
+
+    enum Color { RED = 1, GREEN = 2 };
+}
+
+TEST_CASE("log arguments of numbers, pointers and strings are deferrable", "[log-record]") {
+    static_assert(logging_detail::AllSupported<int, unsigned long, double, const char*, char[4], void*, std::nullptr_t, Color>::value, "");
+    static_assert(!logging_detail::AllSupported<int, std::string>::value, "");
+
+    REQUIRE(logging_detail::MakeArgument(-1).type == LogArgument::Type::SIGNED);
+    REQUIRE(logging_detail::MakeArgument(1u).type == LogArgument::Type::UNSIGNED);
+    REQUIRE(logging_detail::MakeArgument(1.5f).type == LogArgument::Type::DOUBLE);
+    REQUIRE(logging_detail::MakeArgument("string").type == LogArgument::Type::STRING);
+    REQUIRE(logging_detail::MakeArgument(static_cast<void*>(nullptr)).type == LogArgument::Type::POINTER);
+    REQUIRE(logging_detail::MakeArgument(GREEN).signedValue == 2);
+}
+
+TEST_CASE("deferred log messages are formatted like printf", "[log-record]") {
+    REQUIRE(Format("no arguments") == "no arguments");
+    REQUIRE(Format("%d %i %u", -1, 2, 3u) == "-1 2 3");
+    REQUIRE(Format("%5d|%-5d|%05d", 42, 42, 42) == "   42|42   |00042");
+    REQUIRE(Format("%x %X %#o", 255u, 255u, 8u) == "ff FF 010");
+    REQUIRE(Format("%.2f %e %g", 3.14159, 1000.0, 0.5) == "3.14 1.000000e+03 0.5");
+    REQUIRE(Format("%s and %.3s", "string", "truncated") == "string and tru");
+    REQUIRE(Format("100%% %c", 'x') == "100% x");
+    REQUIRE(Format("%*d|%.*f", 4, 7, 1, 2.25) == "   7|2.2");
+    REQUIRE(Format("%zu %lld %ld", static_cast<size_t>(10), -20LL, 30L) == "10 -20 30");
+}
+
+TEST_CASE("mismatched or missing log arguments are formatted safely", "[log-record]") {
+    // The length modifier and argument type don't need to match, arguments are converted.
+    REQUIRE(Format("%lld %d", 1, static_cast<int64_t>(-2)) == "1 -2");
+    REQUIRE(Format("%f", 2) == "2.000000");
+    REQUIRE(Format("%s", static_cast<const char*>(nullptr)) == "(null)");
+    REQUIRE(Format("%d and %s") == "0 and ");
+    REQUIRE(Format("unfinished %") == "unfinished %");
+}
+
+TEST_CASE("long string log arguments are truncated", "[log-record]") {
+    std::string first(LOG_MAX_STRING_ARGUMENT_SIZE + 10, 'a');
+    std::string second(LOG_MAX_STRING_ARGUMENT_SIZE, 'b');
+    auto message = Format("%s|%s|%d", first.c_str(), second.c_str(), 1);
+
+    // The first string is truncated, the second one to what's left, and the number doesn't fit.
+    REQUIRE(message.find(std::string(LOG_MAX_STRING_ARGUMENT_SIZE, 'a') + "|") == 0);
+    REQUIRE(message.size() < first.size() + second.size());
+    REQUIRE(message.substr(message.size() - 2) == "|0");
+}
+
+TEST_CASE("binary logs are decoded into lines of text", "[log-record]") {
+    std::vector<char> output;
+    const char* format = "value %d of %s";
+    const char* file = "dir/file.cpp";
+
+    auto writeRecord = [&output, format, file](BinaryLogWriter& writer, int value, bool sharedFile) {
+        LogArgument arguments[] = { logging_detail::MakeArgument(value), logging_detail::MakeArgument("name") };
+        char data[64];
+        auto size = EncodeLogArguments(arguments, 2, data, sizeof(data));
+        writer.WriteRecord(output, LoggingProvider::Verboseness::Info, "Section", file, sharedFile, value, format, data, size);
+    };
+
+    // Two sessions, as appended by two processes, which have dictionaries of their own.
+    BinaryLogWriter first;
+    first.WriteHeader(output);
+    writeRecord(first, 1, true);
+    writeRecord(first, 2, true);
+    writeRecord(first, 3, false);
+
+    BinaryLogWriter second;
+    second.WriteHeader(output);
+    writeRecord(second, 4, true);
+
+    std::istringstream input(std::string(output.begin(), output.end()));
+    std::ostringstream text;
+    REQUIRE(DecodeBinaryLog(input, text));
+    REQUIRE(text.str() ==
+        "[Section] value 1 of name [dir/file.cpp:1]\n"
+        "[Section] value 2 of name [dir/file.cpp:2]\n"
+        "[Section] value 3 of name [dir/file.cpp:3]\n"
+        "[Section] value 4 of name [dir/file.cpp:4]\n");
+
+    // A log cut in the middle of a record renders the records before.
+    std::istringstream truncated(std::string(output.begin(), output.end() - 3));
+    std::ostringstream partial;
+    REQUIRE(DecodeBinaryLog(truncated, partial) == false);
+    REQUIRE(partial.str().find("value 3") != std::string::npos);
+
+    std::istringstream textInput("not a binary log");
+    std::ostringstream nothing;
+    REQUIRE(DecodeBinaryLog(textInput, nothing) == false);
+    REQUIRE(nothing.str().empty());
+}
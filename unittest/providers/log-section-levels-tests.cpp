@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <providers/log-section-levels.h>
+
+using namespace napa::providers;
+
+using Verboseness = LoggingProvider::Verboseness;
+
+TEST_CASE("log section levels start at the default level", "[log-section-levels]") {
+    LogSectionLevels levels(Verboseness::Info);
+
+    REQUIRE(levels.Get("Zone").load() == static_cast<int>(Verboseness::Info));
+    REQUIRE(levels.Get(nullptr).load() == static_cast<int>(Verboseness::Info));
+    REQUIRE(&levels.Get(nullptr) == &levels.Get(""));
+}
+
+TEST_CASE("log section levels are kept at the same address when changed", "[log-section-levels]") {
+    LogSectionLevels levels;
+    auto& zone = levels.Get("Zone");
+    auto& api = levels.Get("Api");
+
+    levels.Set("Zone", Verboseness::Error);
+    REQUIRE(&levels.Get("Zone") == &zone);
+    REQUIRE(zone.load() == static_cast<int>(Verboseness::Error));
+    REQUIRE(api.load() == static_cast<int>(Verboseness::Debug));
+}
+
+TEST_CASE("log section default level applies to sections without their own level", "[log-section-levels]") {
+    LogSectionLevels levels;
+    auto& zone = levels.Get("Zone");
+    auto& api = levels.Get("Api");
+    levels.Set("Zone", Verboseness::Debug);
+
+    levels.SetDefault(Verboseness::Warning);
+    REQUIRE(zone.load() == static_cast<int>(Verboseness::Debug));
+    REQUIRE(api.load() == static_cast<int>(Verboseness::Warning));
+    REQUIRE(levels.Get("Later").load() == static_cast<int>(Verboseness::Warning));
+}
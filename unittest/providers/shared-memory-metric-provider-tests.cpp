@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <platform/shared-segment.h>
+#include <providers/shared-memory-metric-provider.h>
+
+#include <thread>
+#include <vector>
+
+using namespace napa::providers;
+using napa::platform::SharedSegment;
+
+namespace {
+
+    const char* SEGMENT_NAME = "napa-shared-memory-metric-provider-tests";
+}
+
+TEST_CASE("shared memory metrics are read from another mapping of the segment", "[shared-memory-metric-provider]") {
+    SharedMemoryMetricProvider provider(SEGMENT_NAME, 1);
+    REQUIRE(provider.GetSegmentName() == SEGMENT_NAME);
+
+    const char* dimensionNames[] = { "client" };
+    auto rate = provider.GetMetric("app", "requests", MetricType::Rate, 1, dimensionNames);
+    auto number = provider.GetMetric("app", "connections", MetricType::Number, 0, nullptr);
+    REQUIRE(provider.GetMetric("app", "requests", MetricType::Rate, 1, dimensionNames) == rate);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([rate, number, i]() {
+            const char* client[] = { i % 2 == 0 ? "a" : "b" };
+            for (int j = 0; j < 1000; ++j) {
+                rate->Increment(1, 1, client);
+                number->Increment(2, 0, nullptr);
+                number->Decrement(1, 0, nullptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(rate->Increment(1, 0, nullptr) == false);
+
+    // An agent maps the segment by its name, and reads it without calling into the provider.
+    bool created = true;
+    auto segment = SharedSegment::Open(SEGMENT_NAME, 1, created);
+    REQUIRE(segment != nullptr);
+    REQUIRE(!created);
+    REQUIRE(segment->GetSize() == 1024 * 1024);
+
+    auto snapshots = shared_metrics::ReadSegment(segment->GetData(), {});
+    REQUIRE(snapshots.size() == 2);
+    REQUIRE(snapshots[0].name == "connections");
+    REQUIRE(snapshots[0].series[0].value == 4000);
+    REQUIRE(snapshots[1].name == "requests");
+    REQUIRE((snapshots[1].dimensionNames == std::vector<std::string>{ "client" }));
+    REQUIRE(snapshots[1].series.size() == 2);
+    REQUIRE((snapshots[1].series[0].dimensionValues == std::vector<std::string>{ "a" }));
+    REQUIRE(snapshots[1].series[0].value == 2000);
+    REQUIRE(snapshots[1].series[1].value == 2000);
+
+    REQUIRE(number->Set(10, 0, nullptr));
+    number->Increment(5, 0, nullptr);
+    REQUIRE(shared_metrics::ReadSegment(segment->GetData(), {})[0].series[0].value == 15);
+    REQUIRE(provider.GetSnapshots({})[0].series[0].value == 15);
+
+    provider.RemoveSegment();
+}
+
+TEST_CASE("shared memory percentile metrics report percentiles of their buckets", "[shared-memory-metric-provider]") {
+    SharedMemoryMetricProvider provider(SEGMENT_NAME, 1);
+
+    const char* dimensionNames[] = { "zone" };
+    const char* dimensionValues[] = { "zone1" };
+    auto latency = BindMetric(provider.GetMetric("app", "latency", MetricType::Percentile, 1, dimensionNames), 1, dimensionValues);
+    REQUIRE(latency != nullptr);
+    for (int64_t value = 1; value <= 100; ++value) {
+        REQUIRE(latency->Set(value));
+    }
+    REQUIRE(latency->Increment(1) == false);
+
+    auto snapshots = provider.GetSnapshots({ 0, 50, 100 });
+    REQUIRE(snapshots.size() == 1);
+
+    const auto& series = snapshots[0].series[0];
+    REQUIRE(series.count == 100);
+    REQUIRE(series.value == 5050);
+    REQUIRE(series.min == 1);
+    REQUIRE(series.max == 100);
+
+    // 50 is counted in bucket [48, 55], whose highest value is reported.
+    REQUIRE((series.percentiles == std::vector<int64_t>{ 1, 55, 100 }));
+
+    provider.RemoveSegment();
+}
+
+TEST_CASE("shared memory buckets are log-linear", "[shared-memory-metric-provider]") {
+    using namespace shared_metrics;
+
+    REQUIRE(GetBucket(-5) == 0);
+    REQUIRE(GetBucket(3) == 3);
+    REQUIRE(GetBucket(4) == 4);
+    REQUIRE(GetBucket(7) == 7);
+    REQUIRE(GetBucket(8) == 8);
+    REQUIRE(GetBucket(9) == 8);
+    REQUIRE(GetBucket(10) == 9);
+    REQUIRE(GetBucket(INT64_MAX) == BUCKET_COUNT - 1);
+
+    for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        REQUIRE(GetBucket(GetHighestValue(bucket)) == bucket);
+        if (bucket + 1 < BUCKET_COUNT) {
+            REQUIRE(GetBucket(GetHighestValue(bucket) + 1) == bucket + 1);
+        }
+    }
+}
+
+TEST_CASE("shared memory series which don't fit are dropped", "[shared-memory-metric-provider]") {
+    SharedMemoryMetricProvider provider(SEGMENT_NAME, 1);
+
+    // Each percentile series takes 16 slots of 2KB.
+    const char* dimensionNames[] = { "index" };
+    auto latency = provider.GetMetric("app", "latency", MetricType::Percentile, 1, dimensionNames);
+    size_t kept = 0;
+    for (int i = 0; i < 40; ++i) {
+        auto index = std::to_string(i);
+        const char* dimensionValues[] = { index.c_str() };
+        if (latency->Set(1, 1, dimensionValues)) {
+            ++kept;
+        }
+    }
+    REQUIRE(kept == 31);
+    REQUIRE(provider.GetSnapshots({})[0].series.size() == 31);
+
+    // Counters of metrics without dimensions are dropped at once.
+    for (int i = 0; i < 200; ++i) {
+        provider.GetMetric("app", std::to_string(i).c_str(), MetricType::Number, 0, nullptr);
+    }
+    REQUIRE(provider.GetMetric("app", "full", MetricType::Number, 0, nullptr)->Set(1, 0, nullptr) == false);
+
+    provider.RemoveSegment();
+}
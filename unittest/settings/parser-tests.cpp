@@ -36,6 +36,147 @@ TEST_CASE("Parsing from console", "[settings-parser]") {
     REQUIRE(settings.loggingProvider == "myProvider");
 }
 
+TEST_CASE("Parsing async logging settings", "[settings-parser]") {
+    settings::PlatformSettings settings;
+
+    REQUIRE(settings.logFile.empty());
+    REQUIRE(settings.logBufferSize == 0u);
+    REQUIRE(settings::ParseFromString("--loggingProvider async --logFile /tmp/napa.log --logBufferSize 4096", settings));
+    REQUIRE(settings.loggingProvider == "async");
+    REQUIRE(settings.logFile == "/tmp/napa.log");
+    REQUIRE(settings.logBufferSize == 4096u);
+
+    REQUIRE(settings.logFormat == settings::LogFormat::TEXT);
+    REQUIRE(settings::ParseFromString("--logFormat binary", settings));
+    REQUIRE(settings.logFormat == settings::LogFormat::BINARY);
+    REQUIRE(settings::ParseFromString("--logFormat json", settings) == false);
+}
+
+TEST_CASE("Parsing spare isolates", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.spareIsolates == 0);
+
+    REQUIRE(settings::ParseFromString("--spareIsolates 4", settings));
+    REQUIRE(settings.spareIsolates == 4);
+}
+
+TEST_CASE("Parsing snapshot blob", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.snapshotBlob.empty());
+
+    REQUIRE(settings::ParseFromString("--snapshotBlob napa.snapshot.bin", settings));
+    REQUIRE(settings.snapshotBlob == "napa.snapshot.bin");
+}
+
+TEST_CASE("Parsing code cache directory", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.codeCacheDirectory.empty());
+
+    REQUIRE(settings::ParseFromString("--codeCacheDirectory /tmp/napa-cache", settings));
+    REQUIRE(settings.codeCacheDirectory == "/tmp/napa-cache");
+}
+
+TEST_CASE("Parsing module wrappers", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.moduleWrappers == false);
+
+    REQUIRE(settings::ParseFromString("--moduleWrappers true", settings));
+    REQUIRE(settings.moduleWrappers == true);
+
+    REQUIRE(settings::ParseFromString("--moduleWrappers yes", settings) == false);
+}
+
+TEST_CASE("Parsing module stat cache", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.moduleStatCache == false);
+
+    REQUIRE(settings::ParseFromString("--moduleStatCache true", settings));
+    REQUIRE(settings.moduleStatCache == true);
+}
+
+TEST_CASE("Parsing JSON modules", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.jsonModules == settings::JsonModules::PARSE);
+
+    REQUIRE(settings::ParseFromString("--jsonModules shared", settings));
+    REQUIRE(settings.jsonModules == settings::JsonModules::SHARED);
+
+    REQUIRE(settings::ParseFromString("--jsonModules frozen", settings));
+    REQUIRE(settings.jsonModules == settings::JsonModules::FROZEN);
+
+    REQUIRE(settings::ParseFromString("--jsonModules true", settings) == false);
+}
+
+TEST_CASE("Parsing console output", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.consoleOutput == settings::ConsoleOutput::ASYNC);
+    REQUIRE(settings.consoleRateLimit == 0);
+
+    REQUIRE(settings::ParseFromString("--consoleOutput node --consoleRateLimit 100", settings));
+    REQUIRE(settings.consoleOutput == settings::ConsoleOutput::NODE);
+    REQUIRE(settings.consoleRateLimit == 100);
+
+    REQUIRE(settings::ParseFromString("--consoleOutput sync", settings));
+    REQUIRE(settings.consoleOutput == settings::ConsoleOutput::SYNC);
+
+    REQUIRE(settings::ParseFromString("--consoleOutput stderr", settings) == false);
+}
+
+TEST_CASE("Parsing metric segment", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.metricSegment.empty());
+    REQUIRE(settings.metricSegmentSize == 0);
+
+    REQUIRE(settings::ParseFromString("--metricProvider shared-memory --metricSegment my-service-metrics --metricSegmentSize 4", settings));
+    REQUIRE(settings.metricProvider == "shared-memory");
+    REQUIRE(settings.metricSegment == "my-service-metrics");
+    REQUIRE(settings.metricSegmentSize == 4);
+}
+
+TEST_CASE("Parsing flight recorder directory", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.flightRecorderDirectory.empty());
+
+    REQUIRE(settings::ParseFromString("--flightRecorderDirectory /var/crash", settings));
+    REQUIRE(settings.flightRecorderDirectory == "/var/crash");
+}
+
+TEST_CASE("Parsing module bundle", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.moduleBundle.empty());
+
+    REQUIRE(settings::ParseFromString("--moduleBundle modules.bundle", settings));
+    REQUIRE(settings.moduleBundle == "modules.bundle");
+}
+
+TEST_CASE("Parsing module watch interval", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.moduleWatchInterval == 0);
+
+    REQUIRE(settings::ParseFromString("--moduleWatchInterval 500", settings));
+    REQUIRE(settings.moduleWatchInterval == 500);
+}
+
+TEST_CASE("Parsing allocator", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.allocator == settings::AllocatorType::CRT);
+
+    REQUIRE(settings::ParseFromString("--allocator threadCaching", settings));
+    REQUIRE(settings.allocator == settings::AllocatorType::THREAD_CACHING);
+
+    REQUIRE(settings::ParseFromString("--allocator tcmalloc", settings) == false);
+}
+
+TEST_CASE("Parsing array buffer pool", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.arrayBufferPoolSize == 0);
+    REQUIRE(settings.arrayBufferHugePages == false);
+
+    REQUIRE(settings::ParseFromString("--arrayBufferPoolSize 256 --arrayBufferHugePages true", settings));
+    REQUIRE(settings.arrayBufferPoolSize == 256);
+    REQUIRE(settings.arrayBufferHugePages == true);
+}
+
 TEST_CASE("Parsing non existing setting fails", "[settings-parser]") {
     settings::PlatformSettings settings;
 
@@ -69,3 +210,332 @@ TEST_CASE("Parsing with different value type fails", "[settings-parser]") {
 
     REQUIRE(settings::ParseFromString("--workers five", settings) == false);
 }
+
+TEST_CASE("Parsing scheduler type", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.scheduler == settings::SchedulerType::SYNCHRONIZED);
+    REQUIRE(settings::ParseFromString("--scheduler workStealing", settings));
+    REQUIRE(settings.scheduler == settings::SchedulerType::WORK_STEALING);
+    REQUIRE(settings::ParseFromString("--scheduler earliestDeadline", settings));
+    REQUIRE(settings.scheduler == settings::SchedulerType::EARLIEST_DEADLINE);
+    REQUIRE(settings::ParseFromString("--scheduler fifo", settings) == false);
+}
+
+TEST_CASE("Parsing worker bounds and autoscaling", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.minWorkers == 1u);
+    REQUIRE(settings.maxWorkers == 0u);
+    REQUIRE(settings.autoscaleInterval == 0u);
+    REQUIRE(settings.autoscaleIdleTime == 60000u);
+    REQUIRE(settings::ParseFromString("--minWorkers 2 --maxWorkers 16 --autoscaleInterval 500 --autoscaleIdleTime 10000", settings));
+    REQUIRE(settings.minWorkers == 2u);
+    REQUIRE(settings.maxWorkers == 16u);
+    REQUIRE(settings.autoscaleInterval == 500u);
+    REQUIRE(settings.autoscaleIdleTime == 10000u);
+}
+
+TEST_CASE("Parsing stuck worker watchdog", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.stuckWorkerThreshold == 0u);
+    REQUIRE(settings.replaceStuckWorkers == false);
+    REQUIRE(settings::ParseFromString("--stuckWorkerThreshold 5000 --replaceStuckWorkers true", settings));
+    REQUIRE(settings.stuckWorkerThreshold == 5000u);
+    REQUIRE(settings.replaceStuckWorkers == true);
+
+    // Workers can't be replaced without a watchdog.
+    settings::ZoneSettings noThreshold;
+    REQUIRE(settings::ParseFromString("--replaceStuckWorkers true", noThreshold) == false);
+}
+
+TEST_CASE("Parsing worker placement", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.workerPlacement == settings::WorkerPlacement::NONE);
+    REQUIRE(settings.numaNode == -1);
+    REQUIRE(settings::ParseFromString("--workerPlacement compact --numaNode 1", settings));
+    REQUIRE(settings.workerPlacement == settings::WorkerPlacement::COMPACT);
+    REQUIRE(settings.numaNode == 1);
+    REQUIRE(settings::ParseFromString("--workerPlacement spread", settings));
+    REQUIRE(settings.workerPlacement == settings::WorkerPlacement::SPREAD);
+    REQUIRE(settings::ParseFromString("--workerPlacement scatter", settings) == false);
+}
+
+TEST_CASE("Parsing idle spin time", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.idleSpinTime == 0u);
+    REQUIRE(settings::ParseFromString("--idleSpinTime 50", settings));
+    REQUIRE(settings.idleSpinTime == 50u);
+}
+
+TEST_CASE("Parsing affinity spill threshold", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.affinitySpillThreshold == 16u);
+    REQUIRE(settings::ParseFromString("--affinitySpillThreshold 4", settings));
+    REQUIRE(settings.affinitySpillThreshold == 4u);
+}
+
+TEST_CASE("Parsing worker queue depth", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.workerQueueDepth == 0u);
+    REQUIRE(settings::ParseFromString("--workerQueueDepth 3", settings));
+    REQUIRE(settings.workerQueueDepth == 3u);
+
+    settings::ZoneSettings stealing;
+    REQUIRE_FALSE(settings::ParseFromString("--workerQueueDepth 3 --scheduler workStealing", stealing));
+}
+
+TEST_CASE("Parsing queue limits", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.maxQueueLength == 0u);
+    REQUIRE(settings.maxQueueBytes == 0u);
+    REQUIRE(settings::ParseFromString("--maxQueueLength 1000 --maxQueueBytes 8589934592", settings));
+    REQUIRE(settings.maxQueueLength == 1000u);
+    REQUIRE(settings.maxQueueBytes == 8589934592u);
+}
+
+TEST_CASE("Parsing result cache settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.resultCacheBytes == 0u);
+    REQUIRE(settings.resultCacheTtl == 0u);
+    REQUIRE(settings::ParseFromString("--resultCacheBytes 67108864 --resultCacheTtl 60000", settings));
+    REQUIRE(settings.resultCacheBytes == 67108864u);
+    REQUIRE(settings.resultCacheTtl == 60000u);
+}
+
+TEST_CASE("Parsing broadcast log settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.broadcastLogCompaction == false);
+    REQUIRE(settings.broadcastCodeCache == true);
+    REQUIRE(settings::ParseFromString("--broadcastLogCompaction true --broadcastCodeCache false", settings));
+    REQUIRE(settings.broadcastLogCompaction == true);
+    REQUIRE(settings.broadcastCodeCache == false);
+    REQUIRE(settings::ParseFromString("--broadcastCodeCache yes", settings) == false);
+
+    REQUIRE(settings.broadcastConcurrency == 0u);
+    REQUIRE(settings::ParseFromString("--broadcastConcurrency 2", settings));
+    REQUIRE(settings.broadcastConcurrency == 2u);
+
+    REQUIRE(settings.codeCacheWarmUpTasks == 0u);
+    REQUIRE(settings::ParseFromString("--codeCacheWarmUpTasks 1000", settings));
+    REQUIRE(settings.codeCacheWarmUpTasks == 1000u);
+}
+
+TEST_CASE("Parsing event loop setting", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.eventLoop == false);
+    REQUIRE(settings::ParseFromString("--eventLoop true", settings));
+    REQUIRE(settings.eventLoop == true);
+    REQUIRE(settings::ParseFromString("--eventLoop 1", settings) == false);
+}
+
+TEST_CASE("Parsing microtask batch size", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.microtaskBatchSize == 0u);
+    REQUIRE(settings::ParseFromString("--microtaskBatchSize 16", settings));
+    REQUIRE(settings.microtaskBatchSize == 16u);
+}
+
+TEST_CASE("Parsing CPU budget settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+    REQUIRE(settings.cpuWeight == 1u);
+    REQUIRE(settings::ParseFromString("--cpuWeight 4", settings));
+    REQUIRE(settings.cpuWeight == 4u);
+    REQUIRE(settings::ParseFromString("--cpuWeight 0", settings) == false);
+
+    settings::PlatformSettings platformSettings;
+    REQUIRE(platformSettings.cpuBudget == 0u);
+    REQUIRE(settings::ParseFromString("--cpuBudget 16", platformSettings));
+    REQUIRE(platformSettings.cpuBudget == 16u);
+}
+
+TEST_CASE("Parsing slow-call log settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+    REQUIRE(settings.slowCallThreshold == 0u);
+    REQUIRE(settings.slowCallSampleRate == 0u);
+    REQUIRE(settings.slowCallLogSize == 100u);
+    REQUIRE(settings.slowCallPayloadBytes == 0u);
+    REQUIRE(settings::ParseFromString("--slowCallThreshold 50 --slowCallSampleRate 1000 --slowCallLogSize 20 --slowCallPayloadBytes 256", settings));
+    REQUIRE(settings.slowCallThreshold == 50u);
+    REQUIRE(settings.slowCallSampleRate == 1000u);
+    REQUIRE(settings.slowCallLogSize == 20u);
+    REQUIRE(settings.slowCallPayloadBytes == 256u);
+    REQUIRE(settings::ParseFromString("--slowCallLogSize 0", settings) == false);
+}
+
+TEST_CASE("Parsing shared thread settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+    REQUIRE(settings.sharedThreads == false);
+    REQUIRE(settings::ParseFromString("--sharedThreads true", settings));
+    REQUIRE(settings.sharedThreads == true);
+
+    settings::ZoneSettings eventLoopSettings;
+    REQUIRE(settings::ParseFromString("--sharedThreads true --eventLoop true", eventLoopSettings) == false);
+
+    settings::PlatformSettings platformSettings;
+    REQUIRE(platformSettings.sharedWorkerThreads == 0u);
+    REQUIRE(settings::ParseFromString("--sharedWorkerThreads 4", platformSettings));
+    REQUIRE(platformSettings.sharedWorkerThreads == 4u);
+}
+
+TEST_CASE("Parsing idle GC settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.idleGcTime == 0u);
+    REQUIRE(settings.idleGcFullTime == 0u);
+    REQUIRE(settings::ParseFromString("--idleGcTime 5 --idleGcFullTime 10000", settings));
+    REQUIRE(settings.idleGcTime == 5u);
+    REQUIRE(settings.idleGcFullTime == 10000u);
+}
+
+TEST_CASE("Parsing worker priority", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.workerPriority == settings::WorkerPriority::NORMAL);
+    REQUIRE(settings::ParseFromString("--workerPriority high", settings));
+    REQUIRE(settings.workerPriority == settings::WorkerPriority::HIGH);
+    REQUIRE(settings::ParseFromString("--workerPriority lowest", settings));
+    REQUIRE(settings.workerPriority == settings::WorkerPriority::LOWEST);
+    REQUIRE(settings::ParseFromString("--workerPriority realtime", settings) == false);
+}
+
+TEST_CASE("Parsing GC tuning settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.gcMode == settings::GcMode::BALANCED);
+    REQUIRE(settings.initialOldSpaceSize == 0u);
+    REQUIRE(settings.minSemiSpaceSize == 0u);
+    REQUIRE(settings::ParseFromString("--gcMode throughput --initialOldSpaceSize 512 --minSemiSpaceSize 8", settings));
+    REQUIRE(settings.gcMode == settings::GcMode::THROUGHPUT);
+    REQUIRE(settings.initialOldSpaceSize == 512u);
+    REQUIRE(settings.minSemiSpaceSize == 8u);
+    REQUIRE(settings::ParseFromString("--gcMode fast", settings) == false);
+
+    SECTION("initial semi space size can't exceed the maximum") {
+        REQUIRE(settings::ParseFromString("--maxSemiSpaceSize 16 --minSemiSpaceSize 16", settings));
+        REQUIRE(settings::ParseFromString("--maxSemiSpaceSize 16 --minSemiSpaceSize 32", settings) == false);
+    }
+
+    SECTION("semi space growth factor is a platform setting") {
+        settings::PlatformSettings platformSettings;
+        REQUIRE(platformSettings.semiSpaceGrowthFactor == 0u);
+        REQUIRE(settings::ParseFromString("--semiSpaceGrowthFactor 4", platformSettings));
+        REQUIRE(platformSettings.semiSpaceGrowthFactor == 4u);
+    }
+}
+
+TEST_CASE("Parsing V8 platform threads", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.v8PlatformThreads == 0u);
+
+    REQUIRE(settings::ParseFromString("--v8PlatformThreads 2", settings));
+    REQUIRE(settings.v8PlatformThreads == 2u);
+    REQUIRE(settings::ParseFromString("--v8PlatformThreads two", settings) == false);
+}
+
+TEST_CASE("Parsing preloaded modules", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.preload.empty());
+    REQUIRE(settings::ParseFromString("--preload ./a,b,,./c/d", settings));
+    REQUIRE(settings.preload == std::vector<std::string>({ "./a", "b", "./c/d" }));
+}
+
+TEST_CASE("Parsing worker classes", "[settings-parser]") {
+    settings::ZoneSettings settings;
+    REQUIRE(settings.workerClasses.empty());
+
+    REQUIRE(settings::ParseFromString(
+        "--workers 8 --maxOldSpaceSize 256 --workerClasses large:workers=2:maxOldSpaceSize=4096:maxSemiSpaceSize=64,deep:maxStackSize=4194304",
+        settings));
+    REQUIRE(settings.workerClasses.size() == 2);
+
+    const auto& large = settings.workerClasses[0];
+    REQUIRE(large.name == "large");
+    REQUIRE(large.workers == 2u);
+    REQUIRE(large.maxOldSpaceSize == 4096u);
+    REQUIRE(large.maxSemiSpaceSize == 64u);
+    REQUIRE(large.maxStackSize == settings.maxStackSize);
+
+    // Constraints a class doesn't set are the zone's.
+    const auto& deep = settings.workerClasses[1];
+    REQUIRE(deep.name == "deep");
+    REQUIRE(deep.workers == 1u);
+    REQUIRE(deep.maxOldSpaceSize == 256u);
+    REQUIRE(deep.maxStackSize == 4194304u);
+
+    SECTION("more class workers than zone workers") {
+        REQUIRE(!settings::ParseFromString("--workers 2 --workerClasses large:workers=3", settings));
+    }
+
+    SECTION("duplicate class") {
+        REQUIRE(!settings::ParseFromString("--workerClasses a,a", settings));
+    }
+
+    SECTION("unknown class setting") {
+        REQUIRE(!settings::ParseFromString("--workerClasses a:heap=2", settings));
+    }
+}
+
+TEST_CASE("Parsing tenants", "[settings-parser]") {
+    settings::ZoneSettings settings;
+    REQUIRE(settings.tenants.empty());
+
+    REQUIRE(settings::ParseFromString("--tenants search:weight=4,reports:maxConcurrency=2,other", settings));
+    REQUIRE(settings.tenants.size() == 3);
+    REQUIRE(settings.tenants[0].name == "search");
+    REQUIRE(settings.tenants[0].weight == 4u);
+    REQUIRE(settings.tenants[0].maxConcurrency == 0u);
+    REQUIRE(settings.tenants[1].name == "reports");
+    REQUIRE(settings.tenants[1].weight == 1u);
+    REQUIRE(settings.tenants[1].maxConcurrency == 2u);
+    REQUIRE(settings.tenants[2].name == "other");
+
+    SECTION("zero weight") {
+        REQUIRE(!settings::ParseFromString("--tenants a:weight=0", settings));
+    }
+
+    SECTION("duplicate tenant") {
+        REQUIRE(!settings::ParseFromString("--tenants a,a", settings));
+    }
+
+    SECTION("unknown tenant setting") {
+        REQUIRE(!settings::ParseFromString("--tenants a:workers=2", settings));
+    }
+
+    SECTION("other scheduler") {
+        REQUIRE(!settings::ParseFromString("--scheduler workStealing --tenants a:weight=2", settings));
+    }
+}
+
+TEST_CASE("Parsing isolate recycling settings", "[settings-parser]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(settings.recycleTaskCount == 0u);
+    REQUIRE(settings.recycleHeapSize == 0u);
+    REQUIRE(settings.recycleFragmentation == 0u);
+    REQUIRE(settings::ParseFromString("--recycleTaskCount 10000 --recycleHeapSize 512 --recycleFragmentation 60", settings));
+    REQUIRE(settings.recycleTaskCount == 10000u);
+    REQUIRE(settings.recycleHeapSize == 512u);
+    REQUIRE(settings.recycleFragmentation == 60u);
+}
+
+TEST_CASE("Parsing async workers", "[settings-parser]") {
+    settings::PlatformSettings settings;
+    REQUIRE(settings.asyncCpuWorkers == 0);
+    REQUIRE(settings.asyncIoWorkers == 0);
+
+    REQUIRE(settings::ParseFromString("--asyncCpuWorkers 4 --asyncIoWorkers 32", settings));
+    REQUIRE(settings.asyncCpuWorkers == 4);
+    REQUIRE(settings.asyncIoWorkers == 32);
+}
@@ -0,0 +1,312 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <store/replicated-store.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa;
+using namespace napa::store;
+
+namespace napa {
+namespace memory {
+
+    /// <summary> Allocator of transport contexts of values, from the C heap, as the tests don't link the C API. </summary>
+    Allocator& GetDefaultAllocator() {
+        class MallocAllocator : public Allocator {
+        public:
+            void* Allocate(size_t size) override { return std::malloc(size); }
+            void Deallocate(void* memory, size_t) override { std::free(memory); }
+            const char* GetType() const override { return "MallocAllocator"; }
+            bool operator==(const Allocator& other) const override { return &other == this; }
+        };
+
+        static MallocAllocator allocator;
+        return allocator;
+    }
+}
+}
+
+namespace {
+
+    /// <summary> A store keeping values in a map, in place of the stores that need V8 to build. </summary>
+    class MapStore : public Store {
+    public:
+        const char* GetId() const override { return "replicated"; }
+        napa::TransportOption GetTransportOption() const override { return napa::TransportOption::AUTO; }
+        size_t GetShardCount() const override { return 4; }
+        bool IsReadOptimized() const override { return false; }
+        ValueCacheOption GetValueCacheOption() const override { return ValueCacheOption::NONE; }
+
+        void Set(const char* key, std::shared_ptr<ValueType> value) override {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _values[key] = std::move(value);
+            }
+            Notify(key);
+        }
+
+        std::shared_ptr<ValueType> Get(const char* key) const override {
+            std::lock_guard<std::mutex> lock(_lock);
+            auto it = _values.find(key);
+            return it != _values.end() ? it->second : nullptr;
+        }
+
+        bool Has(const char* key) const override {
+            return Get(key) != nullptr;
+        }
+
+        bool CompareAndSet(const char* key, uint64_t expectedVersion, std::shared_ptr<ValueType> value) override {
+            auto current = Get(key);
+            if ((current != nullptr ? current->version : 0) != expectedVersion) {
+                return false;
+            }
+            Set(key, std::move(value));
+            return true;
+        }
+
+        std::shared_ptr<ValueType> GetOrSet(const char* key, std::shared_ptr<ValueType> value) override {
+            auto current = Get(key);
+            if (current != nullptr) {
+                return current;
+            }
+            Set(key, value);
+            return value;
+        }
+
+        bool Increment(const char* key, int64_t delta, int64_t& result) override {
+            auto current = Get(key);
+            auto value = std::make_shared<ValueType>();
+            value->kind = ValueKind::INTEGER;
+            value->integer = (current != nullptr ? current->integer : 0) + delta;
+            result = value->integer;
+            Set(key, std::move(value));
+            return true;
+        }
+
+        std::vector<std::shared_ptr<ValueType>> GetMany(const std::vector<std::string>& keys) const override {
+            std::vector<std::shared_ptr<ValueType>> values;
+            for (const auto& key : keys) {
+                values.push_back(Get(key.c_str()));
+            }
+            return values;
+        }
+
+        void SetMany(const std::vector<std::string>& keys, std::vector<std::shared_ptr<ValueType>> values) override {
+            for (size_t i = 0; i < keys.size(); i++) {
+                Set(keys[i].c_str(), std::move(values[i]));
+            }
+        }
+
+        std::vector<KeyValue> Scan(const char*, size_t) const override {
+            return std::vector<KeyValue>();
+        }
+
+        void Watch(std::shared_ptr<StoreWatcher> watcher) override {
+            std::lock_guard<std::mutex> lock(_lock);
+            _watchers.push_back(std::move(watcher));
+        }
+
+        void Delete(const char* key) override {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                _values.erase(key);
+            }
+            Notify(key);
+        }
+
+        size_t Size() const override {
+            std::lock_guard<std::mutex> lock(_lock);
+            return _values.size();
+        }
+
+    private:
+        void Notify(const std::string& key) {
+            std::lock_guard<std::mutex> lock(_lock);
+            for (auto& watcher : _watchers) {
+                if (watcher->Matches(key)) {
+                    watcher->Notify(key);
+                }
+            }
+        }
+
+        mutable std::mutex _lock;
+        std::map<std::string, std::shared_ptr<ValueType>> _values;
+        std::vector<std::shared_ptr<StoreWatcher>> _watchers;
+    };
+
+    std::shared_ptr<Store::ValueType> MakeString(const std::string& text) {
+        auto value = std::make_shared<Store::ValueType>();
+        value->kind = ValueKind::STRING;
+        value->payload = text;
+        return value;
+    }
+
+    std::string GetString(const Store& store, const char* key) {
+        auto value = store.Get(key);
+        return value != nullptr ? value->payload : "<none>";
+    }
+
+    std::string GetAddress(const ReplicatedStore& store) {
+        return "127.0.0.1:" + std::to_string(store.GetPort());
+    }
+
+    /// <summary> Waits up to 10 seconds for a condition, which replication makes true asynchronously. </summary>
+    bool WaitFor(const std::function<bool()>& condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+
+    /// <summary> Starts two replicas of each other, the second listening on a port picked after the first starts. </summary>
+    void StartPair(std::unique_ptr<ReplicatedStore>& first, std::unique_ptr<ReplicatedStore>& second) {
+        // The first replica's peer is found once the second listens, so it's given a placeholder first.
+        auto probe = ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:0", {});
+        REQUIRE(probe != nullptr);
+        auto secondPort = probe->GetPort();
+        probe.reset();
+
+        first = ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:0", { "127.0.0.1:" + std::to_string(secondPort) });
+        REQUIRE(first != nullptr);
+        second = ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:" + std::to_string(secondPort), { GetAddress(*first) });
+        REQUIRE(second != nullptr);
+
+        auto converged = WaitFor([&]() { return first->GetConnectedPeerCount() == 1 && second->GetConnectedPeerCount() == 1; });
+        REQUIRE(converged);
+    }
+}
+
+TEST_CASE("replicated store propagates sets and deletes to peers", "[replicated-store]") {
+    std::unique_ptr<ReplicatedStore> first, second;
+    StartPair(first, second);
+
+    auto watcher = std::make_shared<StoreWatcher>("*");
+    second->Watch(watcher);
+
+    first->Set("a", MakeString("1"));
+    auto converged = WaitFor([&]() { return GetString(*second, "a") == "1"; });
+    REQUIRE(converged);
+    REQUIRE(watcher->Take() == std::vector<std::string>({ "a" }));
+
+    second->Set("b", MakeString("2"));
+    converged = WaitFor([&]() { return GetString(*first, "b") == "2"; });
+    REQUIRE(converged);
+
+    first->Delete("a");
+    converged = WaitFor([&]() { return !second->Has("a"); });
+    REQUIRE(converged);
+
+    int64_t result;
+    REQUIRE(second->Increment("counter", 5, result));
+    converged = WaitFor([&]() { auto value = first->Get("counter"); return value != nullptr && value->integer == 5; });
+    REQUIRE(converged);
+    REQUIRE(first->Get("counter")->kind == ValueKind::INTEGER);
+}
+
+TEST_CASE("replicated store propagates array buffers by value", "[replicated-store]") {
+    std::unique_ptr<ReplicatedStore> first, second;
+    StartPair(first, second);
+
+    auto value = std::make_shared<Store::ValueType>();
+    value->kind = ValueKind::ARRAY_BUFFER;
+    auto data = std::malloc(3);
+    std::memcpy(data, "abc", 3);
+    value->buffer = napa::memory::AdoptSharedMemory(data, 3);
+    first->Set("buffer", value);
+
+    auto converged = WaitFor([&]() { return second->Has("buffer"); });
+    REQUIRE(converged);
+    auto replicated = second->Get("buffer");
+    REQUIRE(replicated->kind == ValueKind::ARRAY_BUFFER);
+    REQUIRE(replicated->buffer->GetLength() == 3);
+    REQUIRE(std::memcmp(replicated->buffer->GetData(), "abc", 3) == 0);
+}
+
+TEST_CASE("replicated store propagates compressed values as they are", "[replicated-store]") {
+    std::unique_ptr<ReplicatedStore> first, second;
+    StartPair(first, second);
+
+    auto value = std::make_shared<Store::ValueType>();
+    value->payload = "compressed bytes";
+    value->binary = true;
+    value->compressed = true;
+    first->Set("value", value);
+
+    auto converged = WaitFor([&]() { return second->Has("value"); });
+    REQUIRE(converged);
+    auto replicated = second->Get("value");
+    REQUIRE(replicated->kind == ValueKind::MARSHALLED);
+    REQUIRE(replicated->binary);
+    REQUIRE(replicated->compressed);
+    REQUIRE(replicated->payload == "compressed bytes");
+}
+
+TEST_CASE("replicated store resolves concurrent writes by last writer wins", "[replicated-store]") {
+    std::unique_ptr<ReplicatedStore> first, second;
+    StartPair(first, second);
+
+    for (int i = 0; i < 100; i++) {
+        first->Set("key", MakeString("first" + std::to_string(i)));
+        second->Set("key", MakeString("second" + std::to_string(i)));
+    }
+
+    auto converged = WaitFor([&]() {
+        auto value = GetString(*first, "key");
+        return value == GetString(*second, "key") && (value == "first99" || value == "second99");
+    });
+    REQUIRE(converged);
+}
+
+TEST_CASE("replicated store sends all keys to a peer that connects late", "[replicated-store]") {
+    auto probe = ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:0", {});
+    REQUIRE(probe != nullptr);
+    auto latePort = probe->GetPort();
+    probe.reset();
+
+    auto first = ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:0", { "127.0.0.1:" + std::to_string(latePort) });
+    REQUIRE(first != nullptr);
+    first->Set("a", MakeString("1"));
+    first->Set("b", MakeString("2"));
+    first->Delete("b");
+
+    // Until the peer is reachable, writes stay local.
+    REQUIRE(first->GetConnectedPeerCount() == 0);
+
+    auto late = ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:" + std::to_string(latePort), {});
+    REQUIRE(late != nullptr);
+    auto converged = WaitFor([&]() { return GetString(*late, "a") == "1"; });
+    REQUIRE(converged);
+    REQUIRE(!late->Has("b"));
+    REQUIRE(late->Size() == 1);
+}
+
+TEST_CASE("replicated store rejects invalid addresses and values holding shared objects", "[replicated-store]") {
+    REQUIRE(ReplicatedStore::Start(std::make_unique<MapStore>(), "no-port", {}) == nullptr);
+    REQUIRE(ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:0", { "127.0.0.1:0" }) == nullptr);
+
+    auto store = ReplicatedStore::Start(std::make_unique<MapStore>(), "127.0.0.1:0", {});
+    REQUIRE(store != nullptr);
+
+    std::string error;
+    REQUIRE(store->CanStore("key", *MakeString("text"), error));
+
+    auto shared = MakeString("text");
+    shared->transportContext.SaveShared(std::make_shared<int>(1));
+    REQUIRE(!store->CanStore("key", *shared, error));
+    REQUIRE(!error.empty());
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <store/store-watcher.h>
+
+using namespace napa::store;
+
+TEST_CASE("store watcher matches a key or a prefix", "[store-watcher]") {
+    StoreWatcher key("user1");
+    REQUIRE(key.Matches("user1"));
+    REQUIRE(!key.Matches("user10"));
+
+    StoreWatcher prefix("user*");
+    REQUIRE(prefix.Matches("user"));
+    REQUIRE(prefix.Matches("user10"));
+    REQUIRE(!prefix.Matches("use"));
+
+    StoreWatcher all("*");
+    REQUIRE(all.Matches(""));
+    REQUIRE(all.Matches("anything"));
+}
+
+TEST_CASE("store watcher coalesces changes of a key", "[store-watcher]") {
+    StoreWatcher watcher("*");
+    watcher.Notify("a");
+    watcher.Notify("b");
+    watcher.Notify("a");
+
+    REQUIRE(watcher.Take() == std::vector<std::string>({ "a", "b" }));
+    REQUIRE(watcher.Take().empty());
+
+    watcher.Notify("a");
+    REQUIRE(watcher.Take() == std::vector<std::string>({ "a" }));
+}
+
+TEST_CASE("store watcher completes a wait once a key changes", "[store-watcher]") {
+    StoreWatcher watcher("*");
+
+    int waits = 0;
+    watcher.Wait([&waits]() { ++waits; });
+    REQUIRE(waits == 0);
+
+    watcher.Notify("a");
+    watcher.Notify("b");
+    REQUIRE(waits == 1);
+
+    // Keys are pending, thus the next wait completes inline.
+    watcher.Wait([&waits]() { ++waits; });
+    REQUIRE(waits == 2);
+    REQUIRE(watcher.Take().size() == 2);
+}
+
+TEST_CASE("store watcher completes a wait and drops keys on close", "[store-watcher]") {
+    StoreWatcher watcher("*");
+
+    int waits = 0;
+    watcher.Wait([&waits]() { ++waits; });
+    watcher.Close();
+    REQUIRE(waits == 1);
+    REQUIRE(watcher.IsClosed());
+
+    watcher.Notify("a");
+    REQUIRE(watcher.Take().empty());
+}
+
+TEST_CASE("store watchers notify matching watchers and drop closed ones", "[store-watcher]") {
+    auto users = std::make_shared<StoreWatcher>("user*");
+    auto config = std::make_shared<StoreWatcher>("config");
+
+    StoreWatchers watchers;
+    watchers.Add(users);
+    watchers.Add(config);
+
+    watchers.Notify("user1");
+    watchers.Notify("config");
+    REQUIRE(users->Take() == std::vector<std::string>({ "user1" }));
+    REQUIRE(config->Take() == std::vector<std::string>({ "config" }));
+
+    config->Close();
+    watchers.Notify("config");
+    REQUIRE(config.use_count() == 1);
+}
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <store/store-writer.h>
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+using namespace napa::store;
+
+namespace {
+
+    /// <summary> A store keeping values in a map, which takes values up to a number of bytes. </summary>
+    class LimitedStore : public Store {
+    public:
+        explicit LimitedStore(size_t maxBytes) : _maxBytes(maxBytes) {}
+
+        const char* GetId() const override { return "writer"; }
+        napa::TransportOption GetTransportOption() const override { return napa::TransportOption::AUTO; }
+        size_t GetShardCount() const override { return 1; }
+        bool IsReadOptimized() const override { return false; }
+        ValueCacheOption GetValueCacheOption() const override { return ValueCacheOption::NONE; }
+
+        bool CanStore(const char* /*key*/, const ValueType& value, std::string& error) const override {
+            if (value.GetByteLength() > _maxBytes) {
+                error = "Value is too large.";
+                return false;
+            }
+            return true;
+        }
+
+        void Set(const char* key, std::shared_ptr<ValueType> value) override {
+            std::lock_guard<std::mutex> lock(_lock);
+            _values[key] = std::move(value);
+        }
+
+        std::shared_ptr<ValueType> Get(const char* key) const override {
+            std::lock_guard<std::mutex> lock(_lock);
+            auto it = _values.find(key);
+            return it != _values.end() ? it->second : nullptr;
+        }
+
+        bool Has(const char* key) const override { return Get(key) != nullptr; }
+        bool CompareAndSet(const char*, uint64_t, std::shared_ptr<ValueType>) override { return false; }
+        std::shared_ptr<ValueType> GetOrSet(const char*, std::shared_ptr<ValueType> value) override { return value; }
+        bool Increment(const char*, int64_t, int64_t&) override { return false; }
+        std::vector<std::shared_ptr<ValueType>> GetMany(const std::vector<std::string>&) const override { return {}; }
+        void SetMany(const std::vector<std::string>&, std::vector<std::shared_ptr<ValueType>>) override {}
+        std::vector<KeyValue> Scan(const char*, size_t) const override { return {}; }
+        void Watch(std::shared_ptr<StoreWatcher>) override {}
+        void Delete(const char*) override {}
+        size_t Size() const override { return _values.size(); }
+
+    private:
+        size_t _maxBytes;
+        mutable std::mutex _lock;
+        std::map<std::string, std::shared_ptr<ValueType>> _values;
+    };
+}
+
+TEST_CASE("store writer sets the chunks as one ArrayBuffer once ended", "[store-writer]") {
+    auto store = std::make_shared<LimitedStore>(1024 * 1024);
+    StoreWriter writer(store, "blob", std::chrono::milliseconds(500));
+
+    // Chunks past the initial capacity make the buffer grow.
+    std::string expected;
+    std::string error;
+    for (int i = 0; i < 1000; i++) {
+        std::string chunk(100 + i % 7, static_cast<char>('a' + i % 26));
+        REQUIRE(writer.Write(chunk.data(), chunk.size(), error));
+        expected += chunk;
+    }
+    REQUIRE(writer.GetLength() == expected.size());
+    REQUIRE(store->Get("blob") == nullptr);
+
+    REQUIRE(writer.End(error));
+    REQUIRE(writer.IsEnded());
+
+    auto value = store->Get("blob");
+    REQUIRE(value != nullptr);
+    REQUIRE(value->kind == ValueKind::ARRAY_BUFFER);
+    REQUIRE(value->ttl == std::chrono::milliseconds(500));
+    REQUIRE(value->buffer->GetLength() == expected.size());
+    REQUIRE(std::memcmp(value->buffer->GetData(), expected.data(), expected.size()) == 0);
+
+    REQUIRE_FALSE(writer.Write("x", 1, error));
+    REQUIRE_FALSE(writer.End(error));
+}
+
+TEST_CASE("store writer sets an empty ArrayBuffer without chunks", "[store-writer]") {
+    auto store = std::make_shared<LimitedStore>(16);
+    StoreWriter writer(store, "empty", std::chrono::milliseconds(0));
+
+    std::string error;
+    REQUIRE(writer.End(error));
+    auto value = store->Get("empty");
+    REQUIRE(value != nullptr);
+    REQUIRE(value->kind == ValueKind::ARRAY_BUFFER);
+    REQUIRE(value->buffer == nullptr);
+}
+
+TEST_CASE("store writer leaves the store unchanged when aborted or rejected", "[store-writer]") {
+    auto store = std::make_shared<LimitedStore>(16);
+    std::string error;
+
+    StoreWriter aborted(store, "aborted", std::chrono::milliseconds(0));
+    REQUIRE(aborted.Write("0123456789", 10, error));
+    aborted.Abort();
+    REQUIRE(aborted.IsEnded());
+    REQUIRE(aborted.GetLength() == 0);
+    REQUIRE_FALSE(aborted.End(error));
+    REQUIRE(store->Get("aborted") == nullptr);
+
+    StoreWriter rejected(store, "rejected", std::chrono::milliseconds(0));
+    REQUIRE(rejected.Write("0123456789", 10, error));
+    REQUIRE(rejected.Write("0123456789", 10, error));
+    REQUIRE_FALSE(rejected.End(error));
+    REQUIRE(error == "Value is too large.");
+    REQUIRE(rejected.IsEnded());
+    REQUIRE(store->Get("rejected") == nullptr);
+}
@@ -0,0 +1,128 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <napa/transport/codec.h>
+
+#include <string>
+#include <vector>
+
+namespace test {
+    struct Point {
+        double x = 0;
+        double y = 0;
+    };
+
+    struct Shape {
+        std::string name;
+        std::vector<Point> points;
+        uint8_t layer = 0;
+        bool closed = false;
+        std::vector<bool> visible;
+    };
+
+    struct Label {
+        double y = 0;
+        std::string x;
+    };
+}
+
+NAPA_CODEC(test::Point, x, y)
+NAPA_CODEC(test::Shape, name, points, layer, closed, visible)
+NAPA_CODEC(test::Label, y, x)
+
+using namespace napa::transport;
+using namespace test;
+
+namespace {
+    std::string Bytes(std::initializer_list<uint8_t> bytes) {
+        return std::string(bytes.begin(), bytes.end());
+    }
+}
+
+TEST_CASE("codec writes objects the way V8 serializes them", "[codec]") {
+    Point point;
+    point.x = 1;
+    point.y = -1.5;
+
+    // Header, flags, then {x: 1, y: -1.5}, as v8::ValueSerializer writes it.
+    auto payload = EncodeBinary(point);
+    std::string y = Bytes({ 0, 0, 0, 0, 0, 0, 0xF8, 0xBF });
+    REQUIRE(payload == Bytes({ 0xFF, 0x0D, 0x00, 'o', '"', 1, 'x', 'I', 2, '"', 1, 'y', 'N' }) + y + Bytes({ '{', 2 }));
+
+    REQUIRE(EncodeBinary(std::vector<int32_t>({ 1, -2 })) == Bytes({ 0xFF, 0x0D, 0x00, 'A', 2, 'I', 2, 'I', 3, '$', 0, 2 }));
+}
+
+TEST_CASE("codec round trips nested structs", "[codec]") {
+    Shape shape;
+    shape.name = "tri\xC3\xA4ngle";
+    shape.points = { { 0, 0 }, { 1, 0.5 }, { 3e9, -7 } };
+    shape.layer = 200;
+    shape.closed = true;
+    shape.visible = { true, false };
+
+    Shape decoded;
+    CodecError error;
+    REQUIRE(DecodeBinary(EncodeBinary(shape), decoded, error));
+    REQUIRE(decoded.name == shape.name);
+    REQUIRE(decoded.points.size() == 3);
+    REQUIRE(decoded.points[1].y == 0.5);
+    REQUIRE(decoded.points[2].x == 3e9);
+    REQUIRE(decoded.layer == 200);
+    REQUIRE(decoded.closed);
+    REQUIRE(decoded.visible == std::vector<bool>({ true, false }));
+}
+
+TEST_CASE("codec reads what V8 writes beyond what it writes itself", "[codec]") {
+    // {y: 2, z: {a: [true]}, x: "é😀"} with a padded two-byte string and a property of no field.
+    auto payload = Bytes({ 0xFF, 0x0D, 0x00, 'o',
+        '"', 1, 'y', 'U', 2,
+        '"', 1, 'z', 'o', '"', 1, 'a', 'A', 1, 'T', '$', 0, 1, '{', 1,
+        '"', 1, 'x', 0, 'c', 6, 0xE9, 0x00, 0x3D, 0xD8, 0x00, 0xDE,
+        '{', 3 });
+    Label label;
+    CodecError error;
+    REQUIRE(DecodeBinary(payload, label, error));
+    REQUIRE(label.y == 2);
+    REQUIRE(label.x == "\xC3\xA9\xF0\x9F\x98\x80");
+
+    Point point;
+    REQUIRE(!DecodeBinary(payload, point, error));
+    REQUIRE(error.Message() == "Expected a number at 'x'");
+
+    // Latin-1 string, and an array that had holes, which V8 writes as a sparse one.
+    std::vector<std::string> strings;
+    REQUIRE(DecodeBinary(Bytes({ 0xFF, 0x0D, 0x00, 'a', 2, 'I', 2, '"', 1, 0xE9, 'I', 0, '"', 0, '@', 2, 2 }), strings, error));
+    REQUIRE(strings == std::vector<std::string>({ "", "\xC3\xA9" }));
+
+    REQUIRE(!DecodeBinary(Bytes({ 0xFF, 0x0D, 0x00, 'a', 2, 'I', 2, '"', 1, 'a', '@', 1, 2 }), strings, error));
+    REQUIRE(error.Message() == "Expected an array without holes");
+}
+
+TEST_CASE("codec tells where values don't match", "[codec]") {
+    CodecError error;
+    Shape shape;
+    shape.points = { { 0, 0 }, { 1, 1 } };
+    auto payload = EncodeBinary(shape);
+
+    std::vector<Point> points;
+    REQUIRE(!DecodeBinary(payload, points, error));
+    REQUIRE(error.Message() == "Expected an array");
+
+    std::vector<uint8_t> bytes;
+    REQUIRE(!DecodeBinary(EncodeBinary(std::vector<int32_t>({ 1, 256 })), bytes, error));
+    REQUIRE(error.Message() == "Expected an integer in range of the field at '[1]'");
+
+    Shape decoded;
+    REQUIRE(!DecodeBinary(EncodeBinary(std::vector<double>({ 1 })), decoded, error));
+    REQUIRE(error.Message() == "Expected an object");
+
+    auto wrongPayload = Bytes({ 0xFF, 0x0D, 0x00, 'o', '"', 6, 'p', 'o', 'i', 'n', 't', 's', 'A', 1, 'o', '"', 1, 'y', 'T', '{', 1, '$', 0, 1, '{', 1 });
+    REQUIRE(!DecodeBinary(wrongPayload, decoded, error));
+    REQUIRE(error.Message() == "Expected a number at 'points[0].y'");
+
+    REQUIRE(!DecodeBinary(payload.substr(0, payload.size() - 3), decoded, error));
+    REQUIRE(!DecodeBinary(std::string("{}"), decoded, error));
+    REQUIRE(error.Message() == "Invalid binary payload");
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <utils/block-pool.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa;
+
+namespace {
+    struct PooledObject {
+        PooledObject(size_t value) : value(value) {}
+        size_t value;
+        std::string padding;
+    };
+}
+
+TEST_CASE("block pool reuses released blocks", "[block-pool]") {
+    auto pool = std::make_shared<utils::BlockPool>(16);
+
+    auto first = pool->Allocate(64);
+    pool->Deallocate(first, 64);
+    REQUIRE(pool->GetFreeCount() == 1);
+
+    auto second = pool->Allocate(64);
+    REQUIRE(second == first);
+    REQUIRE(pool->GetFreeCount() == 0);
+    REQUIRE(pool->GetHeapAllocationCount() == 1);
+
+    SECTION("blocks of other sizes are not pooled") {
+        auto other = pool->Allocate(32);
+        pool->Deallocate(other, 32);
+        REQUIRE(pool->GetFreeCount() == 0);
+        REQUIRE(pool->GetHeapAllocationCount() == 2);
+    }
+
+    pool->Deallocate(second, 64);
+}
+
+TEST_CASE("block pool keeps a bounded number of free blocks", "[block-pool]") {
+    auto pool = std::make_shared<utils::BlockPool>(4);
+
+    std::vector<void*> blocks;
+    for (int i = 0; i < 10; i++) {
+        blocks.push_back(pool->Allocate(16));
+    }
+    for (auto block : blocks) {
+        pool->Deallocate(block, 16);
+    }
+
+    REQUIRE(pool->GetFreeCount() == 4);
+}
+
+TEST_CASE("allocate_shared with pool allocator stops hitting the heap once warm", "[block-pool]") {
+    const size_t inFlight = 64;
+    const size_t rounds = 100;
+
+    auto pool = std::make_shared<utils::BlockPool>(inFlight);
+    utils::PoolAllocator<PooledObject> allocator(pool);
+
+    std::vector<std::shared_ptr<PooledObject>> objects;
+    objects.reserve(inFlight);
+
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < inFlight; i++) {
+            objects.emplace_back(std::allocate_shared<PooledObject>(allocator, i));
+        }
+        for (size_t i = 0; i < inFlight; i++) {
+            REQUIRE(objects[i]->value == i);
+        }
+        objects.clear();
+    }
+
+    // Only the first round allocates, i.e. 1 allocation per object instead of 1 per object per round.
+    REQUIRE(pool->GetHeapAllocationCount() == inFlight);
+    REQUIRE(pool->GetFreeCount() == inFlight);
+
+    SECTION("objects keep the pool alive") {
+        auto object = std::allocate_shared<PooledObject>(allocator, 1);
+        std::weak_ptr<utils::BlockPool> weakPool = pool;
+        pool.reset();
+        allocator = utils::PoolAllocator<PooledObject>(std::make_shared<utils::BlockPool>());
+
+        REQUIRE(!weakPool.expired());
+        object.reset();
+        REQUIRE(weakPool.expired());
+    }
+}
+
+TEST_CASE("block pool allocates and releases from multiple threads", "[block-pool]") {
+    auto pool = std::make_shared<utils::BlockPool>(256);
+    utils::PoolAllocator<PooledObject> allocator(pool);
+
+    std::vector<std::shared_ptr<PooledObject>> produced[4];
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < 1000; i++) {
+                produced[t].emplace_back(std::allocate_shared<PooledObject>(allocator, i));
+                if (produced[t].size() == 32) {
+                    produced[t].clear();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto& objects : produced) {
+        objects.clear();
+    }
+    REQUIRE(pool->GetHeapAllocationCount() <= 4 * 32);
+}
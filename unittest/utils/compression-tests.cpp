@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "utils/compression.h"
+
+#include <chrono>
+#include <random>
+#include <string>
+
+using namespace napa::utils::compression;
+
+namespace {
+
+    /// <summary> JSON of records alike, as large store values are. </summary>
+    std::string MakeJson(size_t size) {
+        std::string json = "[";
+        for (size_t i = 0; json.size() < size; ++i) {
+            json += "{\"id\":" + std::to_string(i) + ",\"name\":\"item " + std::to_string(i % 97)
+                + "\",\"tags\":[\"red\",\"green\"],\"enabled\":" + (i % 3 == 0 ? "true" : "false") + "},";
+        }
+        json.back() = ']';
+        return json;
+    }
+
+    std::string MakeRandom(size_t size, uint32_t seed) {
+        std::mt19937 random(seed);
+        std::string bytes(size, '\0');
+        for (auto& byte : bytes) {
+            byte = static_cast<char>(random());
+        }
+        return bytes;
+    }
+
+    std::string RoundTrip(const std::string& input) {
+        std::string compressed, decompressed;
+        REQUIRE(Compress(input.data(), input.size(), compressed));
+
+        size_t size;
+        REQUIRE(GetDecompressedSize(compressed.data(), compressed.size(), size));
+        REQUIRE(size == input.size());
+
+        REQUIRE(Decompress(compressed.data(), compressed.size(), decompressed));
+        return decompressed;
+    }
+}
+
+TEST_CASE("compression round-trips inputs of each size", "[compression]") {
+    // Covers inputs too short for a match, and ends of matches and literals around the limits of the block format.
+    for (size_t size = 0; size < 300; ++size) {
+        auto json = MakeJson(400).substr(0, size);
+        REQUIRE(RoundTrip(json) == json);
+
+        auto random = MakeRandom(size, static_cast<uint32_t>(size));
+        REQUIRE(RoundTrip(random) == random);
+
+        std::string run(size, 'a');
+        REQUIRE(RoundTrip(run) == run);
+    }
+
+    // Long matches and literals, and matches at the largest offset.
+    auto large = MakeRandom(70000, 1) + MakeRandom(70000, 1) + std::string(100000, 'x') + MakeRandom(1000, 2);
+    REQUIRE(RoundTrip(large) == large);
+}
+
+TEST_CASE("compression shrinks JSON, and grows incompressible input by little", "[compression]") {
+    auto json = MakeJson(64 * 1024);
+    std::string compressed;
+    REQUIRE(Compress(json.data(), json.size(), compressed));
+    REQUIRE(compressed.size() * 3 < json.size());
+
+    auto random = MakeRandom(64 * 1024, 3);
+    REQUIRE(Compress(random.data(), random.size(), compressed));
+    REQUIRE(compressed.size() <= HEADER_SIZE + random.size() + random.size() / 255 + 16);
+}
+
+TEST_CASE("decompression rejects malformed input", "[compression]") {
+    auto json = MakeJson(4096);
+    std::string compressed, output;
+    REQUIRE(Compress(json.data(), json.size(), compressed));
+
+    REQUIRE_FALSE(Decompress(compressed.data(), 3, output));
+    REQUIRE_FALSE(Decompress(compressed.data(), compressed.size(), output, json.size() - 1));
+
+    // Truncated at each length, it either fails or, stopping at a sequence end, falls short of the size.
+    for (size_t size = HEADER_SIZE; size < compressed.size(); ++size) {
+        REQUIRE_FALSE(Decompress(compressed.data(), size, output));
+    }
+
+    // Corrupted bytes never read or write out of bounds, whether or not they're detected.
+    std::mt19937 random(4);
+    for (int i = 0; i < 1000; ++i) {
+        auto corrupted = compressed;
+        corrupted[HEADER_SIZE + random() % (corrupted.size() - HEADER_SIZE)] = static_cast<char>(random());
+        Decompress(corrupted.data(), corrupted.size(), output);
+    }
+
+    // A match before the start of the output.
+    const char badOffset[] = { 8, 0, 0, 0, 0x04, 0x01, 0x00 };
+    REQUIRE_FALSE(Decompress(badOffset, sizeof(badOffset), output));
+}
+
+// Hidden benchmark of compressing JSON store values, run with: napa-unittest "[compression-benchmark]"
+// Numbers are only meaningful in an optimized build.
+TEST_CASE("compression benchmark", "[.][compression-benchmark]") {
+    for (size_t size = 4 * 1024; size <= 4 * 1024 * 1024; size *= 8) {
+        auto json = MakeJson(size);
+        std::string compressed, decompressed;
+        size_t iterations = 256 * 1024 * 1024 / json.size();
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            Compress(json.data(), json.size(), compressed);
+        }
+        auto compressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            Decompress(compressed.data(), compressed.size(), decompressed);
+        }
+        auto decompressSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        REQUIRE(decompressed == json);
+
+        auto gigabytes = static_cast<double>(iterations * json.size()) / (1024 * 1024 * 1024);
+        WARN(json.size() << " bytes: ratio " << static_cast<double>(json.size()) / compressed.size()
+            << ", compress " << gigabytes / compressSeconds << " GB/s, decompress " << gigabytes / decompressSeconds << " GB/s");
+    }
+}
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <utils/hash.h>
+
+#include <string>
+
+using namespace napa::utils;
+
+TEST_CASE("xxHash64 matches reference values", "[hash]") {
+    REQUIRE(hash::XxHash64("") == 0xef46db3751d8e999ULL);
+    REQUIRE(hash::XxHash64("a") == 0xd24ec4f1a98c6e5bULL);
+    REQUIRE(hash::XxHash64("abc") == 0x44bc2cf5ad770999ULL);
+    REQUIRE(hash::XxHash64("Nobody inspects the spammish repetition") == 0xfbcea83c8a378bf1ULL);
+
+    std::string bytes;
+    for (int i = 0; i < 100; ++i) {
+        bytes.push_back(static_cast<char>(i));
+    }
+    REQUIRE(hash::XxHash64(bytes) == 0x6ac1e58032166597ULL);
+}
+
+TEST_CASE("xxHash64 seeds give different hashes", "[hash]") {
+    REQUIRE(hash::XxHash64("abc", 1) == 0xbea9ca8199328908ULL);
+    REQUIRE(hash::XxHash64("abc", 1) != hash::XxHash64("abc", 0));
+}
+
+TEST_CASE("xxHash64 formats as 16 hex digits", "[hash]") {
+    REQUIRE(hash::ToHexString(0xef46db3751d8e999ULL) == "ef46db3751d8e999");
+    REQUIRE(hash::ToHexString(0x1ULL) == "0000000000000001");
+}
@@ -0,0 +1,96 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "utils/text-search.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+using namespace napa::utils::text;
+
+namespace {
+    size_t Find(const std::string& text, const char* pattern) {
+        return napa::utils::text::Find(text.data(), text.size(), pattern, std::strlen(pattern));
+    }
+}
+
+TEST_CASE("text search finds the first occurrence", "[text-search]") {
+    INFO("SIMD level " << GetSimdLevel());
+
+    REQUIRE(Find("", "") == 0);
+    REQUIRE(Find("abc", "") == 0);
+    REQUIRE(Find("", "a") == NOT_FOUND);
+    REQUIRE(Find("ab", "abc") == NOT_FOUND);
+    REQUIRE(Find("abc", "c") == 2);
+    REQUIRE(Find("{\"_cid\":1}", "\"_cid\"") == 1);
+    REQUIRE(Find("{\"_ci\":1,\"_cid\":2}", "\"_cid\"") == 9);
+    REQUIRE(Find("{\"_cidx\":1}", "\"_cid\"") == NOT_FOUND);
+}
+
+TEST_CASE("text search agrees with the scalar search at each offset and length", "[text-search]") {
+    const char* pattern = "\"_cid\"";
+    const size_t length = std::strlen(pattern);
+
+    // Covers patterns in SIMD blocks, straddling them and in the tails, and candidates matching first and last characters only.
+    for (size_t size = 0; size < 100; ++size) {
+        for (size_t offset = 0; offset + length <= size; ++offset) {
+            std::string text(size, 'x');
+            for (size_t i = 0; i + length <= size; i += 7) {
+                text[i] = '"';
+                text[i + length - 1] = '"';
+            }
+            text.replace(offset, length, pattern);
+
+            auto expected = FindScalar(text.data(), text.size(), pattern, length);
+            REQUIRE(expected <= offset);
+            REQUIRE(Find(text, pattern) == expected);
+        }
+
+        std::string text(size, '"');
+        REQUIRE(Find(text, pattern) == NOT_FOUND);
+    }
+}
+
+// Hidden benchmark over payload sizes of the scan of call arguments, run with: napa-unittest "[text-search-benchmark]"
+// Numbers are only meaningful in an optimized build.
+TEST_CASE("text search benchmark", "[.][text-search-benchmark]") {
+    const char* pattern = "\"_cid\"";
+    const size_t length = std::strlen(pattern);
+
+    // The byte loop the call dispatcher used before.
+    auto byteLoop = [](const char* text, size_t size, const char* pattern, size_t length) {
+        for (size_t i = 0; i + length <= size; ++i) {
+            if (text[i] == pattern[0] && std::memcmp(text + i, pattern, length) == 0) {
+                return i;
+            }
+        }
+        return NOT_FOUND;
+    };
+
+    for (size_t size = 64; size <= 1024 * 1024; size *= 4) {
+        // A JSON payload of strings, full of quotes like text-heavy payloads are.
+        std::string text;
+        while (text.size() < size) {
+            text += "{\"name\":\"item\",\"value\":\"some text\"},";
+        }
+        text.resize(size);
+
+        auto measure = [&](auto find) {
+            size_t iterations = 256 * 1024 * 1024 / size;
+            size_t found = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i) {
+                found += find(text.data(), text.size(), pattern, length) != NOT_FOUND ? 1 : 0;
+            }
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            REQUIRE(found == 0);
+            return iterations * size / seconds / (1024 * 1024 * 1024);
+        };
+
+        WARN(size << " bytes: byte loop " << measure(byteLoop) << " GB/s, scalar " << measure(FindScalar)
+            << " GB/s, " << GetSimdLevel() << " " << measure(napa::utils::text::Find) << " GB/s");
+    }
+}
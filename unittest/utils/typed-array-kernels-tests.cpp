@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "utils/typed-array-kernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace napa::utils;
+
+namespace {
+
+    std::vector<float> MakeFloats(size_t length, uint32_t seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        std::vector<float> values(length);
+        for (auto& value : values) {
+            value = distribution(random);
+        }
+        return values;
+    }
+}
+
+TEST_CASE("typed array kernels match their scalar loops at each length", "[typed-array-kernels]") {
+    INFO("SIMD level: " << kernels::GetSimdLevel());
+
+    // Lengths around the block sizes of each instruction set, and tails of every size.
+    for (size_t length = 0; length < 80; ++length) {
+        auto x = MakeFloats(length, static_cast<uint32_t>(length));
+        auto y = MakeFloats(length, static_cast<uint32_t>(length + 1000));
+
+        REQUIRE(std::abs(kernels::Sum(x.data(), length) - kernels::SumScalar(x.data(), length)) < 1e-4);
+        REQUIRE(std::abs(kernels::Dot(x.data(), y.data(), length) - kernels::DotScalar(x.data(), y.data(), length)) < 1e-4);
+        REQUIRE(kernels::ArgMax(x.data(), length) == kernels::ArgMaxScalar(x.data(), length));
+
+        auto expected = y;
+        kernels::AxpyScalar(0.5f, x.data(), expected.data(), length);
+        kernels::Axpy(0.5f, x.data(), y.data(), length);
+        for (size_t i = 0; i < length; ++i) {
+            REQUIRE(std::abs(y[i] - expected[i]) < 1e-6);
+        }
+    }
+
+    std::vector<double> doubles = { 1.5, -2.0, 4.0, 0.25, 4.0 };
+    std::vector<double> ones(doubles.size(), 1.0);
+    REQUIRE(kernels::Sum(doubles.data(), doubles.size()) == 7.75);
+    REQUIRE(kernels::Dot(doubles.data(), ones.data(), doubles.size()) == 7.75);
+    REQUIRE(kernels::ArgMax(doubles.data(), doubles.size()) == 2);
+    kernels::Axpy(2.0, doubles.data(), ones.data(), doubles.size());
+    REQUIRE(ones == std::vector<double>({ 4.0, -3.0, 9.0, 1.5, 9.0 }));
+}
+
+TEST_CASE("typed array kernels skip NaNs when ranking", "[typed-array-kernels]") {
+    auto nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> values(40, 0.5f);
+    values[3] = nan;
+    values[17] = 2.0f;
+    values[30] = 2.0f;
+    values[35] = nan;
+    REQUIRE(kernels::ArgMax(values.data(), values.size()) == 17);
+
+    std::vector<float> nans(20, nan);
+    REQUIRE(kernels::ArgMax(nans.data(), nans.size()) == kernels::NOT_FOUND);
+    REQUIRE(kernels::ArgMax(nans.data(), 0) == kernels::NOT_FOUND);
+
+    std::vector<uint32_t> indices(5);
+    std::vector<float> ranked = { 3.0f, nan, 5.0f, 1.0f, 5.0f, 4.0f };
+    REQUIRE(kernels::TopK(ranked.data(), ranked.size(), 3, indices.data()) == 3);
+    REQUIRE(std::vector<uint32_t>(indices.begin(), indices.begin() + 3) == std::vector<uint32_t>({ 2, 4, 5 }));
+    REQUIRE(kernels::TopK(ranked.data(), ranked.size(), 10, indices.data()) == 5);
+    REQUIRE(indices == std::vector<uint32_t>({ 2, 4, 5, 0, 3 }));
+    REQUIRE(kernels::TopK(ranked.data(), ranked.size(), 0, indices.data()) == 0);
+
+    kernels::Sort(ranked.data(), ranked.size());
+    REQUIRE(std::isnan(ranked.back()));
+    ranked.pop_back();
+    REQUIRE(ranked == std::vector<float>({ 1.0f, 3.0f, 4.0f, 5.0f, 5.0f }));
+}
+
+TEST_CASE("typed array kernels count histograms over closed ranges", "[typed-array-kernels]") {
+    std::vector<double> values = { 0.0, 0.1, 0.5, 0.99, 1.0, -0.1, 1.1, std::nan("") };
+    std::vector<uint32_t> bins(2, 0);
+    kernels::Histogram(values.data(), values.size(), 0.0, 1.0, bins.data(), bins.size());
+    REQUIRE(bins == std::vector<uint32_t>({ 2, 3 }));
+
+    // Counts of parts add up.
+    kernels::Histogram(values.data(), 3, 0.0, 1.0, bins.data(), bins.size());
+    REQUIRE(bins == std::vector<uint32_t>({ 4, 4 }));
+
+    std::vector<uint32_t> single(3, 0);
+    kernels::Histogram(values.data(), values.size(), 0.5, 0.5, single.data(), single.size());
+    REQUIRE(single == std::vector<uint32_t>({ 1, 0, 0 }));
+}
+
+// Hidden benchmark of the SIMD kernels against their scalar loops, run with: napa-unittest "[typed-array-kernels-benchmark]"
+// Numbers are only meaningful in an optimized build.
+TEST_CASE("typed array kernels benchmark", "[.][typed-array-kernels-benchmark]") {
+    const size_t length = 1024 * 1024;
+    const int iterations = 200;
+    auto x = MakeFloats(length, 1);
+    auto y = MakeFloats(length, 2);
+
+    auto measure = [&](const char* name, const std::function<double()>& simd, const std::function<double()>& scalar) {
+        double simdResult = 0, scalarResult = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            simdResult += simd();
+        }
+        auto simdSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            scalarResult += scalar();
+        }
+        auto scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        REQUIRE(std::abs(simdResult - scalarResult) <= 1e-3 * std::abs(scalarResult) + 1);
+
+        auto gigabytes = static_cast<double>(iterations) * length * sizeof(float) / (1024 * 1024 * 1024);
+        WARN(name << " (" << kernels::GetSimdLevel() << "): " << gigabytes / simdSeconds << " GB/s, scalar "
+            << gigabytes / scalarSeconds << " GB/s");
+    };
+
+    measure("sum",
+        [&]() { return kernels::Sum(x.data(), length); },
+        [&]() { return kernels::SumScalar(x.data(), length); });
+    measure("dot",
+        [&]() { return kernels::Dot(x.data(), y.data(), length); },
+        [&]() { return kernels::DotScalar(x.data(), y.data(), length); });
+    measure("argmax",
+        [&]() { return static_cast<double>(kernels::ArgMax(x.data(), length)); },
+        [&]() { return static_cast<double>(kernels::ArgMaxScalar(x.data(), length)); });
+}
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <utils/unique-function.h>
+
+#include <array>
+#include <memory>
+#include <string>
+
+using namespace napa::utils;
+
+namespace {
+    /// <summary> Counts live instances, to check captures are destroyed exactly once. </summary>
+    struct Counted {
+        Counted(int& count) : count(&count) { ++*this->count; }
+        Counted(const Counted& other) : count(other.count) { ++*count; }
+        ~Counted() { --*count; }
+
+        int* count;
+    };
+}
+
+TEST_CASE("unique function is empty by default", "[unique-function]") {
+    UniqueFunction<void()> function;
+    REQUIRE(!function);
+
+    function = [] {};
+    REQUIRE(function);
+
+    function = nullptr;
+    REQUIRE(!function);
+}
+
+TEST_CASE("unique function forwards arguments and returns the result", "[unique-function]") {
+    UniqueFunction<std::string(const std::string&, int)> function = [](const std::string& text, int count) {
+        std::string result;
+        for (int i = 0; i < count; ++i) {
+            result += text;
+        }
+        return result;
+    };
+
+    REQUIRE(function("ab", 3) == "ababab");
+}
+
+TEST_CASE("unique function holds move-only captures", "[unique-function]") {
+    auto value = std::make_unique<int>(42);
+    UniqueFunction<int()> function = [value = std::move(value)]() { return *value; };
+
+    auto moved = std::move(function);
+    REQUIRE(!function);
+    REQUIRE(moved() == 42);
+}
+
+TEST_CASE("unique function destroys small and large captures once", "[unique-function]") {
+    int count = 0;
+
+    SECTION("small captures are stored inline") {
+        Counted counted(count);
+        {
+            UniqueFunction<int()> function = [counted]() { return *counted.count; };
+            REQUIRE(count == 2);
+
+            UniqueFunction<int()> other = std::move(function);
+            REQUIRE(count == 2);
+            REQUIRE(other() == 2);
+        }
+        REQUIRE(count == 1);
+    }
+
+    SECTION("large captures are stored on the heap") {
+        Counted counted(count);
+        std::array<char, 2 * UniqueFunction<void()>::INLINE_SIZE> padding{};
+        {
+            UniqueFunction<size_t()> function = [counted, padding]() { return padding.size(); };
+            REQUIRE(count == 2);
+
+            UniqueFunction<size_t()> other;
+            other = std::move(function);
+            REQUIRE(count == 2);
+            REQUIRE(other() == padding.size());
+        }
+        REQUIRE(count == 1);
+    }
+
+    REQUIRE(count == 0);
+}
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <zone/allocation-profile.h>
+
+using namespace napa::zone;
+
+namespace {
+
+    AllocationProfileNode MakeNode(const std::string& functionName, int32_t scriptId, int32_t lineNumber, uint64_t selfSize) {
+        AllocationProfileNode node;
+        node.functionName = functionName;
+        node.url = "file.js";
+        node.scriptId = scriptId;
+        node.lineNumber = lineNumber;
+        node.columnNumber = 4;
+        node.selfSize = selfSize;
+        return node;
+    }
+}
+
+TEST_CASE("allocation profiles of workers add up by call path", "[allocation-profile]") {
+    AllocationProfileNode merged = MakeNode("(root)", 0, -1, 0);
+
+    // Each worker numbers scripts on its own, so the same function has another script id.
+    AllocationProfileNode first = MakeNode("(root)", 0, -1, 0);
+    first.children.push_back(MakeNode("render", 10, 5, 100));
+    first.children[0].children.push_back(MakeNode("format", 10, 20, 30));
+
+    AllocationProfileNode second = MakeNode("(root)", 0, -1, 0);
+    second.children.push_back(MakeNode("render", 12, 5, 50));
+    second.children[0].children.push_back(MakeNode("parse", 12, 40, 7));
+    second.children.push_back(MakeNode("render", 12, 6, 1));
+
+    MergeAllocationProfile(merged, std::move(first));
+    MergeAllocationProfile(merged, std::move(second));
+
+    REQUIRE(merged.children.size() == 2);
+
+    auto& render = merged.children[0];
+    REQUIRE(render.selfSize == 150);
+    REQUIRE(render.scriptId == 10);
+    REQUIRE(render.children.size() == 2);
+    REQUIRE(render.children[0].functionName == "format");
+    REQUIRE(render.children[0].selfSize == 30);
+    REQUIRE(render.children[1].functionName == "parse");
+    REQUIRE(render.children[1].selfSize == 7);
+
+    // Another position is another function, even with the same name.
+    REQUIRE(merged.children[1].lineNumber == 6);
+    REQUIRE(merged.children[1].selfSize == 1);
+}
+
+TEST_CASE("allocation profiles serialize to .heapprofile JSON", "[allocation-profile]") {
+    AllocationProfileNode root = MakeNode("(root)", 0, -1, 0);
+    root.url.clear();
+    root.children.push_back(MakeNode("say \"hi\"", 3, 1, 64));
+    root.children.push_back(MakeNode("b", 3, 2, 8));
+
+    REQUIRE(ToHeapProfileJson(root) ==
+        "{\"head\":"
+            "{\"callFrame\":{\"functionName\":\"(root)\",\"scriptId\":\"0\",\"url\":\"\",\"lineNumber\":-1,\"columnNumber\":4},"
+            "\"selfSize\":0,\"id\":1,\"children\":["
+                "{\"callFrame\":{\"functionName\":\"say \\\"hi\\\"\",\"scriptId\":\"3\",\"url\":\"file.js\",\"lineNumber\":1,\"columnNumber\":4},"
+                "\"selfSize\":64,\"id\":2,\"children\":[]},"
+                "{\"callFrame\":{\"functionName\":\"b\",\"scriptId\":\"3\",\"url\":\"file.js\",\"lineNumber\":2,\"columnNumber\":4},"
+                "\"selfSize\":8,\"id\":3,\"children\":[]}"
+            "]},"
+        "\"samples\":[]}");
+}
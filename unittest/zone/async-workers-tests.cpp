@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <zone/async-workers.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace napa::zone;
+
+TEST_CASE("async workers run jobs on the configured number of threads", "[async-workers]") {
+    AsyncWorkers workers;
+    workers.Configure(AsyncWorkPool::CPU, 2);
+    REQUIRE(workers.GetWorkers(AsyncWorkPool::CPU) == 2);
+
+    const int JOBS = 100;
+    std::mutex lock;
+    std::set<std::thread::id> threads;
+    std::atomic<int> done(0);
+    std::promise<void> finished;
+
+    for (int i = 0; i < JOBS; ++i) {
+        workers.Execute(AsyncWorkPool::CPU, [&]() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                threads.insert(std::this_thread::get_id());
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            if (++done == JOBS) {
+                finished.set_value();
+            }
+        });
+    }
+
+    finished.get_future().wait();
+    REQUIRE(threads.size() <= 2);
+    REQUIRE(workers.GetQueueDepth(AsyncWorkPool::CPU) == 0);
+}
+
+TEST_CASE("async workers queue jobs beyond the number of threads", "[async-workers]") {
+    AsyncWorkers workers;
+    workers.Configure(AsyncWorkPool::IO, 1);
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> started;
+
+    workers.Execute(AsyncWorkPool::IO, [&started, released]() {
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+
+    workers.Execute(AsyncWorkPool::IO, []() {});
+    workers.Execute(AsyncWorkPool::IO, []() {});
+    REQUIRE(workers.GetQueueDepth(AsyncWorkPool::IO) == 2);
+    REQUIRE(workers.GetQueueDepth(AsyncWorkPool::CPU) == 0);
+
+    // The number of threads is fixed once the pool started.
+    workers.Configure(AsyncWorkPool::IO, 8);
+    REQUIRE(workers.GetWorkers(AsyncWorkPool::IO) == 1);
+
+    release.set_value();
+}
+
+TEST_CASE("async workers default to the number of processors for CPU work", "[async-workers]") {
+    AsyncWorkers workers;
+    REQUIRE(workers.GetWorkers(AsyncWorkPool::CPU) == std::max(std::thread::hardware_concurrency(), 1u));
+    REQUIRE(workers.GetWorkers(AsyncWorkPool::IO) == AsyncWorkers::DEFAULT_IO_WORKERS);
+
+    workers.Configure(AsyncWorkPool::IO, 4);
+    workers.Configure(AsyncWorkPool::IO, 0);
+    REQUIRE(workers.GetWorkers(AsyncWorkPool::IO) == AsyncWorkers::DEFAULT_IO_WORKERS);
+}
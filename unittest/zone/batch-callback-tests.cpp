@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/batch-callback.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+    struct BatchOutcome {
+        const napa_zone_result* results = nullptr;
+        size_t count = 0;
+        size_t calls = 0;
+    };
+
+    void OnBatch(const napa_zone_result* results, size_t count, void* context) {
+        auto outcome = static_cast<BatchOutcome*>(context);
+        outcome->results = results;
+        outcome->count = count;
+        outcome->calls++;
+    }
+
+    Result MakeResult(ResultCode code, const std::string& errorMessage, const std::string& returnValue) {
+        Result result;
+        result.code = code;
+        result.errorMessage = errorMessage;
+        result.returnValue = returnValue;
+        return result;
+    }
+
+    std::string ToString(napa_string_ref ref) {
+        return std::string(ref.data, ref.size);
+    }
+}
+
+TEST_CASE("arena batch callbacks copy results into the arena, in order of calls", "[batch-callback]") {
+    char buffer[64];
+    napa_result_arena arena { buffer, sizeof(buffer), 0 };
+    napa_zone_result results[2];
+    BatchOutcome outcome;
+
+    auto callbacks = CreateArenaBatchCallbacks(2, results, &arena, OnBatch, &outcome);
+    REQUIRE(callbacks.size() == 2);
+
+    callbacks[1](MakeResult(NAPA_RESULT_EXECUTE_FUNC_ERROR, "failed", ""));
+    REQUIRE(outcome.calls == 0);
+
+    auto result = MakeResult(NAPA_RESULT_SUCCESS, "", "\"hello\"");
+    result.cpuTime = 10;
+    callbacks[0](std::move(result));
+    REQUIRE(outcome.calls == 1);
+    REQUIRE(outcome.results == results);
+    REQUIRE(outcome.count == 2);
+
+    REQUIRE(results[0].code == NAPA_RESULT_SUCCESS);
+    REQUIRE(ToString(results[0].return_value) == "\"hello\"");
+    REQUIRE(results[0].cpu_time == 10);
+    REQUIRE(results[0].return_value_owner == nullptr);
+    REQUIRE(results[1].code == NAPA_RESULT_EXECUTE_FUNC_ERROR);
+    REQUIRE(ToString(results[1].error_message) == "failed");
+
+    REQUIRE(arena.used == 13);
+    REQUIRE(results[0].return_value.data >= buffer);
+    REQUIRE(results[0].return_value.data + results[0].return_value.size <= buffer + arena.used);
+}
+
+TEST_CASE("arena batch callbacks report results that don't fit, and keep room for the others", "[batch-callback]") {
+    char buffer[8];
+    napa_result_arena arena { buffer, sizeof(buffer), 0 };
+    napa_zone_result results[2];
+    BatchOutcome outcome;
+
+    auto callbacks = CreateArenaBatchCallbacks(2, results, &arena, OnBatch, &outcome);
+    callbacks[0](MakeResult(NAPA_RESULT_SUCCESS, "", "\"too long for arena\""));
+    callbacks[1](MakeResult(NAPA_RESULT_SUCCESS, "", "42"));
+    REQUIRE(outcome.calls == 1);
+
+    REQUIRE(results[0].code == NAPA_RESULT_RESULT_ARENA_EXHAUSTED);
+    REQUIRE(results[0].return_value.size == 0);
+    REQUIRE(results[1].code == NAPA_RESULT_SUCCESS);
+    REQUIRE(ToString(results[1].return_value) == "42");
+    REQUIRE(arena.used == 2);
+}
+
+TEST_CASE("arena batch callbacks of an empty batch trigger the callback immediately", "[batch-callback]") {
+    napa_result_arena arena { nullptr, 0, 5 };
+    BatchOutcome outcome;
+
+    auto callbacks = CreateArenaBatchCallbacks(0, nullptr, &arena, OnBatch, &outcome);
+    REQUIRE(callbacks.empty());
+    REQUIRE(outcome.calls == 1);
+    REQUIRE(outcome.count == 0);
+    REQUIRE(arena.used == 0);
+}
+
+TEST_CASE("arena batch callbacks share the arena between concurrent calls", "[batch-callback]") {
+    constexpr size_t count = 64;
+    std::vector<char> buffer(count * 4);
+    napa_result_arena arena { buffer.data(), buffer.size(), 0 };
+    std::vector<napa_zone_result> results(count);
+    BatchOutcome outcome;
+
+    auto callbacks = CreateArenaBatchCallbacks(count, results.data(), &arena, OnBatch, &outcome);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&callbacks, t]() {
+            for (size_t i = t; i < count; i += 4) {
+                callbacks[i](MakeResult(NAPA_RESULT_SUCCESS, "", std::to_string(1000 + i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(outcome.calls == 1);
+    REQUIRE(arena.used == buffer.size());
+    for (size_t i = 0; i < count; ++i) {
+        REQUIRE(ToString(results[i].return_value) == std::to_string(1000 + i));
+    }
+}
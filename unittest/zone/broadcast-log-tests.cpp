@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <zone/broadcast-log.h>
+
+using namespace napa::zone;
+
+namespace {
+    std::vector<std::string> Sources(const BroadcastLog& log) {
+        std::vector<std::string> sources;
+        for (const auto& entry : log.GetEntries()) {
+            sources.push_back(*entry.source);
+        }
+        return sources;
+    }
+}
+
+TEST_CASE("broadcast log keeps all broadcasts in order", "[broadcast-log]") {
+    BroadcastLog log(false, false);
+
+    log.Append("var a = 1;");
+    log.Append("a++;");
+    log.Append("a++;");
+
+    REQUIRE(log.GetSize() == 3);
+    REQUIRE(Sources(log) == std::vector<std::string>({ "var a = 1;", "a++;", "a++;" }));
+    REQUIRE(log.GetEntries()[0].codeCache == nullptr);
+}
+
+TEST_CASE("broadcast log compaction moves a repeated broadcast to the end", "[broadcast-log]") {
+    BroadcastLog log(true, true);
+
+    auto first = log.Append("function foo() {}");
+    log.Append("var b = 2;");
+    auto repeated = log.Append("function foo() {}");
+
+    REQUIRE(log.GetSize() == 2);
+    REQUIRE(Sources(log) == std::vector<std::string>({ "var b = 2;", "function foo() {}" }));
+
+    // Repeated source keeps its code cache.
+    REQUIRE(first.codeCache != nullptr);
+    REQUIRE(repeated.codeCache == first.codeCache);
+}
+
+TEST_CASE("code cache is set once and dropped when rejected", "[broadcast-log]") {
+    CodeCache cache;
+    REQUIRE(cache.Get() == nullptr);
+
+    REQUIRE(cache.Set({ 1, 2, 3 }));
+    REQUIRE(cache.Set({ 4, 5 }) == false);
+
+    auto data = cache.Get();
+    REQUIRE(*data == CodeCache::Data({ 1, 2, 3 }));
+
+    cache.Reject(data);
+    REQUIRE(cache.Get() == nullptr);
+    REQUIRE(cache.Set({ 4, 5 }));
+}
+
+TEST_CASE("code cache is warmed once and cold again when rejected", "[broadcast-log]") {
+    CodeCache cache;
+    REQUIRE(cache.Set({ 1, 2, 3 }));
+    REQUIRE(!cache.IsWarm());
+
+    REQUIRE(cache.Warm({ 4, 5 }));
+    REQUIRE(cache.IsWarm());
+    REQUIRE(cache.Warm({ 6 }) == false);
+
+    auto data = cache.Get();
+    REQUIRE(*data == CodeCache::Data({ 4, 5 }));
+
+    cache.Reject(data);
+    REQUIRE(!cache.IsWarm());
+    REQUIRE(cache.Set({ 1, 2, 3 }));
+}
+
+TEST_CASE("broadcast log numbers entries in log order", "[broadcast-log]") {
+    BroadcastLog log(true, false);
+
+    REQUIRE(log.Append("var a = 1;").sequence == 1);
+    REQUIRE(log.Append("var b = 2;").sequence == 2);
+    REQUIRE(log.Append("var a = 1;").sequence == 3);
+
+    auto entries = log.GetEntries();
+    REQUIRE(entries.size() == 2);
+    REQUIRE(entries[0].sequence == 2);
+    REQUIRE(entries[1].sequence == 3);
+}
+
+TEST_CASE("broadcast log shares sources with its snapshots", "[broadcast-log]") {
+    BroadcastLog log(false, false);
+
+    auto entry = log.Append("var config = {};");
+    REQUIRE(log.GetEntries()[0].source == entry.source);
+    REQUIRE(log.GetEntries()[0].source == log.GetEntries()[0].source);
+}
@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/call-coalescer.h"
+
+#include <string>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    ResultCache::Key MakeKey(const char* function) {
+        FunctionSpec spec;
+        spec.module = NAPA_STRING_REF("module");
+        spec.function = NAPA_STRING_REF(function);
+        return ResultCache::GetKey(spec);
+    }
+
+    Result MakeResult(const std::string& value) {
+        Result result;
+        result.code = NAPA_RESULT_SUCCESS;
+        result.returnValue = value;
+        return result;
+    }
+}
+
+TEST_CASE("call coalescer runs the first call and passes its result on", "[call-coalescer]") {
+    auto coalescer = std::make_shared<CallCoalescer>();
+    std::vector<std::string> results;
+
+    ExecuteCallback leader = [&results](Result result) { results.push_back("leader:" + result.returnValue); };
+    REQUIRE(!coalescer->Attach(MakeKey("f"), leader));
+
+    for (int i = 0; i < 3; i++) {
+        ExecuteCallback follower = [&results](Result result) { results.push_back("follower:" + result.returnValue); };
+        REQUIRE(coalescer->Attach(MakeKey("f"), follower));
+    }
+
+    // Other calls aren't attached.
+    ExecuteCallback other = [](Result) {};
+    REQUIRE(!coalescer->Attach(MakeKey("g"), other));
+    REQUIRE(coalescer->GetCount() == 2);
+
+    leader(MakeResult("42"));
+    REQUIRE(results == std::vector<std::string>({ "follower:42", "follower:42", "follower:42", "leader:42" }));
+
+    other(MakeResult(""));
+    REQUIRE(coalescer->GetCount() == 0);
+}
+
+TEST_CASE("call coalescer runs calls again once the first one finished", "[call-coalescer]") {
+    auto coalescer = std::make_shared<CallCoalescer>();
+    size_t called = 0;
+
+    ExecuteCallback first = [&called](Result) { called++; };
+    REQUIRE(!coalescer->Attach(MakeKey("f"), first));
+    first(MakeResult("1"));
+
+    ExecuteCallback second = [&called](Result) { called++; };
+    REQUIRE(!coalescer->Attach(MakeKey("f"), second));
+    second(MakeResult("2"));
+    REQUIRE(called == 2);
+}
@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/call-recorder.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace napa::zone;
+
+TEST_CASE("call recorder captures calls issued while it's on", "[call-recorder]") {
+    const std::string path = "call-recorder-test.napacap";
+
+    auto before = Clock::Now() - std::chrono::seconds(1);
+    REQUIRE(CallRecorder::Start(path));
+    REQUIRE(CallRecorder::IsEnabled());
+    auto start = Clock::Now();
+
+    // Issued before the capture started.
+    CallRecorder::Record("zone1", "module", "before", 10, before, std::chrono::microseconds(5));
+
+    CallRecorder::Record("zone1", "module", "f1", 100, start + std::chrono::milliseconds(2), std::chrono::microseconds(50));
+    CallRecorder::Record("zone2", "", "f2", 0, start + std::chrono::milliseconds(1), std::chrono::microseconds(7));
+    CallRecorder::Record("zone1", "module", "f1", 300, start + std::chrono::milliseconds(3), std::chrono::microseconds(60));
+
+    CallRecorder::Stop();
+    REQUIRE_FALSE(CallRecorder::IsEnabled());
+
+    // Ignored once stopped.
+    CallRecorder::Record("zone1", "module", "after", 10, start, std::chrono::microseconds(5));
+
+    std::vector<CallRecord> records;
+    REQUIRE(CallRecorder::Load(path, records));
+    REQUIRE(records.size() == 3);
+
+    REQUIRE(records[0].zoneId == "zone1");
+    REQUIRE(records[0].module == "module");
+    REQUIRE(records[0].function == "f1");
+    REQUIRE(records[0].payloadSize == 100);
+    REQUIRE(records[0].executionTime == 50000);
+    REQUIRE(records[0].arrival >= 2000000);
+
+    REQUIRE(records[1].zoneId == "zone2");
+    REQUIRE(records[1].module == "");
+    REQUIRE(records[1].function == "f2");
+    REQUIRE(records[1].arrival < records[0].arrival);
+
+    REQUIRE(records[2].function == "f1");
+    REQUIRE(records[2].payloadSize == 300);
+    REQUIRE(records[2].arrival - records[0].arrival == 1000000);
+
+    remove(path.c_str());
+}
+
+TEST_CASE("call recorder rejects files that aren't captures", "[call-recorder]") {
+    const std::string path = "call-recorder-invalid.napacap";
+    auto file = fopen(path.c_str(), "wb");
+    fputs("NOTACAPTURE", file);
+    fclose(file);
+
+    std::vector<CallRecord> records;
+    REQUIRE_FALSE(CallRecorder::Load(path, records));
+    REQUIRE_FALSE(CallRecorder::Load("call-recorder-missing.napacap", records));
+
+    remove(path.c_str());
+}
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/cancellation-token.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace napa::zone;
+
+TEST_CASE("cancellation token calls handlers once, in order of registration", "[cancellation-token]") {
+    CancellationToken token;
+    std::vector<int> calls;
+
+    auto first = token.Register([&calls]() { calls.push_back(1); });
+    auto second = token.Register([&calls]() { calls.push_back(2); });
+    REQUIRE(first != 0);
+    REQUIRE(second != first);
+    REQUIRE(!token.IsCancelled());
+
+    REQUIRE(token.Cancel());
+    REQUIRE(token.IsCancelled());
+    REQUIRE(calls == std::vector<int>({ 1, 2 }));
+
+    REQUIRE(!token.Cancel());
+    REQUIRE(calls.size() == 2);
+}
+
+TEST_CASE("cancellation token doesn't call unregistered handlers", "[cancellation-token]") {
+    CancellationToken token;
+    std::vector<int> calls;
+
+    auto first = token.Register([&calls]() { calls.push_back(1); });
+    auto second = token.Register([&calls]() { calls.push_back(2); });
+    auto third = token.Register([&calls]() { calls.push_back(3); });
+
+    token.Unregister(second);
+    token.Unregister(second);
+    token.Unregister(12345);
+    token.Cancel();
+    REQUIRE(calls == std::vector<int>({ 1, 3 }));
+
+    // Handlers which were called are gone.
+    token.Unregister(first);
+    token.Unregister(third);
+}
+
+TEST_CASE("cancellation token calls handlers registered after cancellation right away", "[cancellation-token]") {
+    CancellationToken token;
+    token.Cancel();
+
+    bool called = false;
+    auto id = token.Register([&called]() { called = true; });
+    REQUIRE(id == 0);
+    REQUIRE(called);
+}
+
+TEST_CASE("cancellation token handlers can register handlers on the same token", "[cancellation-token]") {
+    CancellationToken token;
+    bool nestedCalled = false;
+
+    token.Register([&token, &nestedCalled]() {
+        token.Register([&nestedCalled]() { nestedCalled = true; });
+    });
+    token.Cancel();
+    REQUIRE(nestedCalled);
+}
+
+TEST_CASE("cancellation token is cancelled once among threads", "[cancellation-token]") {
+    CancellationToken token;
+    std::atomic<int> handlerCalls(0);
+    std::atomic<int> cancels(0);
+
+    for (int i = 0; i < 100; ++i) {
+        token.Register([&handlerCalls]() { handlerCalls++; });
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&token, &cancels]() {
+            if (token.Cancel()) {
+                cancels++;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(cancels == 1);
+    REQUIRE(handlerCalls == 100);
+}
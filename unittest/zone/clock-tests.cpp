@@ -0,0 +1,61 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/clock.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace napa::zone;
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+TEST_CASE("coarse clock readings never run ahead of full resolution ones", "[clock]") {
+    auto resolution = Clock::GetCoarseResolution();
+    REQUIRE(resolution >= Clock::duration::zero());
+    REQUIRE(resolution < 100ms);
+
+    auto previous = Clock::CoarseNow();
+    for (int i = 0; i < 1000; ++i) {
+        auto coarse = Clock::CoarseNow();
+        auto now = Clock::Now();
+        REQUIRE(coarse >= previous);
+        REQUIRE(coarse <= now);
+
+        // Leave some slack for skipped ticks and the thread being preempted between the readings.
+        REQUIRE(now - coarse <= 2 * resolution + 10ms);
+        previous = coarse;
+    }
+}
+
+TEST_CASE("coarse clock advances", "[clock]") {
+    auto start = Clock::CoarseNow();
+    std::this_thread::sleep_for(Clock::GetCoarseResolution() + 20ms);
+    REQUIRE(Clock::CoarseNow() - start >= 20ms);
+}
+
+// Hidden benchmark of the clock reads a call with a timeout takes, run with: napa-unittest "[clock-benchmark]"
+// Numbers are only meaningful in an optimized build.
+TEST_CASE("clock benchmark", "[.][clock-benchmark]") {
+    const int reads = 10000000;
+
+    auto measure = [](const char* name, auto read) {
+        auto start = steady_clock::now();
+        Clock::rep sink = 0;
+        for (int i = 0; i < reads; ++i) {
+            sink += read().time_since_epoch().count();
+        }
+        auto nanosecondsPerRead = duration<double, std::nano>(steady_clock::now() - start).count() / reads;
+        WARN(name << ": " << nanosecondsPerRead << " ns per read (" << (sink != 0) << ")");
+        return nanosecondsPerRead;
+    };
+
+    auto highResolution = measure("high_resolution_clock::now", []() { return high_resolution_clock::now(); });
+    auto precise = measure("Clock::Now", []() { return Clock::Now(); });
+    auto coarse = measure("Clock::CoarseNow", []() { return Clock::CoarseNow(); });
+
+    WARN("Clock::Now is " << (precise / highResolution) << " and Clock::CoarseNow " << (coarse / highResolution)
+        << " times as costly as high_resolution_clock::now");
+}
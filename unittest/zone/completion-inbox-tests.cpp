@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <napa/zone/completion-inbox.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace napa::zone;
+
+namespace {
+
+    struct Item {
+        int producer = 0;
+        int sequence = 0;
+        Item* nextCompletion = nullptr;
+    };
+
+}
+
+TEST_CASE("completion inbox returns items in the order they were pushed", "[completion-inbox]") {
+    CompletionInbox<Item> inbox;
+    REQUIRE(inbox.IsEmpty());
+    REQUIRE(inbox.TakeAll() == nullptr);
+
+    Item items[3];
+    REQUIRE(inbox.Push(&items[0]));
+    REQUIRE(!inbox.Push(&items[1]));
+    REQUIRE(!inbox.Push(&items[2]));
+    REQUIRE(!inbox.IsEmpty());
+
+    auto first = inbox.TakeAll();
+    REQUIRE(first == &items[0]);
+    REQUIRE(first->nextCompletion == &items[1]);
+    REQUIRE(first->nextCompletion->nextCompletion == &items[2]);
+    REQUIRE(items[2].nextCompletion == nullptr);
+    REQUIRE(inbox.IsEmpty());
+
+    // The next push into the emptied inbox notifies the consumer again.
+    REQUIRE(inbox.Push(&items[0]));
+}
+
+TEST_CASE("completion inbox takes items of concurrent producers", "[completion-inbox]") {
+    const int PRODUCERS = 4;
+    const int ITEMS_PER_PRODUCER = 10000;
+
+    CompletionInbox<Item> inbox;
+    std::vector<Item> items(PRODUCERS * ITEMS_PER_PRODUCER);
+    std::atomic<int> notifications(0);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+                auto& item = items[p * ITEMS_PER_PRODUCER + i];
+                item.producer = p;
+                item.sequence = i;
+                if (inbox.Push(&item)) {
+                    notifications++;
+                }
+            }
+        });
+    }
+
+    int taken = 0;
+    int takes = 0;
+    std::vector<int> lastSequence(PRODUCERS, -1);
+    bool ordered = true;
+    while (taken < PRODUCERS * ITEMS_PER_PRODUCER) {
+        auto item = inbox.TakeAll();
+        if (item != nullptr) {
+            takes++;
+        }
+        for (; item != nullptr; item = item->nextCompletion) {
+            ordered = ordered && item->sequence == lastSequence[item->producer] + 1;
+            lastSequence[item->producer] = item->sequence;
+            taken++;
+        }
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    // Each producer's items come in its order, and each non-empty take follows one notification.
+    REQUIRE(ordered);
+    REQUIRE(inbox.IsEmpty());
+    REQUIRE(takes == notifications);
+}
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/cpu-governor.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Runs tasks of a share on a thread until stopped, counting them and the most running at once. </summary>
+    class Runner {
+    public:
+        Runner(CpuGovernor& governor, std::shared_ptr<CpuGovernor::Share> share, std::atomic<uint32_t>& running, std::atomic<uint32_t>& maxRunning) :
+            _thread([this, &governor, share, &running, &maxRunning]() {
+                while (!_stop) {
+                    governor.Acquire(*share);
+                    auto current = ++running;
+                    auto max = maxRunning.load();
+                    while (current > max && !maxRunning.compare_exchange_weak(max, current)) {}
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    tasks++;
+
+                    running--;
+                    governor.Release();
+                }
+            }) {}
+
+        void Stop() {
+            _stop = true;
+            _thread.join();
+        }
+
+        std::atomic<uint32_t> tasks { 0 };
+
+    private:
+        std::atomic<bool> _stop { false };
+        std::thread _thread;
+    };
+}
+
+TEST_CASE("cpu governor caps workers running at the same time", "[cpu-governor]") {
+    CpuGovernor governor(2);
+    auto share = governor.GetShare("zone", 1);
+    REQUIRE(governor.GetShare("zone", 4) == share);
+
+    std::atomic<uint32_t> running(0);
+    std::atomic<uint32_t> maxRunning(0);
+    std::vector<std::unique_ptr<Runner>> runners;
+    for (int i = 0; i < 6; i++) {
+        runners.emplace_back(std::make_unique<Runner>(governor, share, running, maxRunning));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (auto& runner : runners) {
+        runner->Stop();
+    }
+
+    REQUIRE(maxRunning == 2);
+    REQUIRE(governor.GetRunning() == 0);
+}
+
+TEST_CASE("cpu governor shares the budget between zones by weight", "[cpu-governor]") {
+    CpuGovernor governor(1);
+    auto heavy = governor.GetShare("heavy", 3);
+    auto light = governor.GetShare("light", 1);
+
+    std::atomic<uint32_t> running(0);
+    std::atomic<uint32_t> maxRunning(0);
+    std::vector<std::unique_ptr<Runner>> runners;
+    for (int i = 0; i < 2; i++) {
+        runners.emplace_back(std::make_unique<Runner>(governor, heavy, running, maxRunning));
+        runners.emplace_back(std::make_unique<Runner>(governor, light, running, maxRunning));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    for (auto& runner : runners) {
+        runner->Stop();
+    }
+
+    auto heavyTasks = runners[0]->tasks + runners[2]->tasks;
+    auto lightTasks = runners[1]->tasks + runners[3]->tasks;
+    REQUIRE(maxRunning == 1);
+    REQUIRE(lightTasks > 0);
+    REQUIRE(heavyTasks > 2 * lightTasks);
+}
+
+TEST_CASE("cpu governor doesn't limit workers without budget", "[cpu-governor]") {
+    CpuGovernor governor;
+    auto share = governor.GetShare("zone", 1);
+
+    governor.Acquire(*share);
+    governor.Acquire(*share);
+    REQUIRE(governor.GetRunning() == 0);
+    governor.Release();
+
+    // Waiting workers get the slots of a budget lifted.
+    governor.SetBudget(1);
+    governor.Acquire(*share);
+    std::thread waiter([&governor, &share]() {
+        governor.Acquire(*share);
+        governor.Release();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    governor.SetBudget(0);
+    waiter.join();
+    governor.Release();
+    REQUIRE(governor.GetRunning() == 0);
+}
+
+TEST_CASE("cpu governor releases the slot of a yielding worker", "[cpu-governor]") {
+    auto& governor = CpuGovernor::GetInstance();
+    governor.SetBudget(1);
+    auto share = governor.GetShare("yield", 1);
+
+    governor.Acquire(*share);
+    {
+        CpuGovernor::Yield yield;
+        REQUIRE(governor.GetRunning() == 0);
+
+        // Another worker runs meanwhile.
+        std::thread other([&governor, &share]() {
+            governor.Acquire(*share);
+            governor.Release();
+        });
+        other.join();
+    }
+    REQUIRE(governor.GetRunning() == 1);
+    governor.Release();
+    governor.SetBudget(0);
+}
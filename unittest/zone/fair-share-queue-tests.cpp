@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <zone/fair-share-queue.h>
+
+#include <vector>
+
+using namespace napa::zone;
+
+namespace {
+    class TenantTask : public Task {
+    public:
+        TenantTask(size_t tenant, size_t order) : tenant(tenant), order(order) {}
+
+        void Execute() override {}
+
+        size_t tenant;
+        size_t order;
+    };
+
+    /// <summary> Pops all tasks that can be popped, and returns their tenants. </summary>
+    std::vector<size_t> PopTenants(FairShareQueue& queue) {
+        std::vector<size_t> tenants;
+        size_t lane;
+        while (auto task = queue.Pop(lane)) {
+            tenants.push_back(std::static_pointer_cast<TenantTask>(task)->tenant);
+        }
+        return tenants;
+    }
+}
+
+TEST_CASE("fair share queue serves tasks of a tenant in FIFO order", "[fair-share-queue]") {
+    FairShareQueue queue(1);
+    size_t lane;
+    REQUIRE(queue.Pop(lane) == nullptr);
+
+    for (size_t i = 0; i < 3; ++i) {
+        queue.Push(0, 0, std::make_shared<TenantTask>(0, i));
+    }
+    REQUIRE(queue.GetSize() == 3);
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto task = queue.Pop(lane);
+        REQUIRE(lane == 0);
+        REQUIRE(std::static_pointer_cast<TenantTask>(task)->order == i);
+    }
+    REQUIRE(queue.Pop(lane) == nullptr);
+    REQUIRE(queue.GetSize() == 0);
+}
+
+TEST_CASE("fair share queue serves lanes in order", "[fair-share-queue]") {
+    FairShareQueue queue(3);
+    auto tenant = queue.AddTenant(1, 0);
+
+    queue.Push(2, 0, std::make_shared<TenantTask>(0, 0));
+    queue.Push(1, tenant, std::make_shared<TenantTask>(tenant, 1));
+    queue.Push(0, 0, std::make_shared<TenantTask>(0, 2));
+
+    size_t lane;
+    for (size_t expected = 0; expected < 3; ++expected) {
+        auto task = queue.Pop(lane);
+        REQUIRE(lane == expected);
+        REQUIRE(std::static_pointer_cast<TenantTask>(task)->order == 2 - expected);
+    }
+}
+
+TEST_CASE("fair share queue shares turns between tenants by weight", "[fair-share-queue]") {
+    FairShareQueue queue(1);
+    auto heavy = queue.AddTenant(3, 0);
+    auto light = queue.AddTenant(1, 0);
+    REQUIRE(queue.GetTenantCount() == 3);
+
+    for (size_t i = 0; i < 6; ++i) {
+        queue.Push(0, heavy, std::make_shared<TenantTask>(heavy, i));
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        queue.Push(0, light, std::make_shared<TenantTask>(light, i));
+    }
+
+    std::vector<size_t> expected = { heavy, heavy, heavy, light, heavy, heavy, heavy, light, light };
+    REQUIRE(PopTenants(queue) == expected);
+}
+
+TEST_CASE("fair share queue lets a newly active tenant in within a round", "[fair-share-queue]") {
+    FairShareQueue queue(1);
+    auto first = queue.AddTenant(1, 0);
+    auto second = queue.AddTenant(1, 0);
+
+    for (size_t i = 0; i < 4; ++i) {
+        queue.Push(0, first, std::make_shared<TenantTask>(first, i));
+    }
+
+    size_t lane;
+    queue.Pop(lane);
+
+    // The second tenant joins at the end of the current round, however many tasks the first one queued.
+    queue.Push(0, second, std::make_shared<TenantTask>(second, 0));
+    std::vector<size_t> expected = { first, second, first, first };
+    REQUIRE(PopTenants(queue) == expected);
+}
+
+TEST_CASE("fair share queue skips tenants at their concurrency cap", "[fair-share-queue]") {
+    FairShareQueue queue(2);
+    auto capped = queue.AddTenant(1, 2);
+
+    for (size_t i = 0; i < 3; ++i) {
+        queue.Push(1, capped, std::make_shared<TenantTask>(capped, i));
+    }
+    queue.Push(1, 0, std::make_shared<TenantTask>(0, 0));
+
+    // Two tasks of the capped tenant run, the third one waits while the other tenant goes on.
+    std::vector<size_t> expected = { capped, 0, capped };
+    REQUIRE(PopTenants(queue) == expected);
+    REQUIRE(queue.GetRunning(capped) == 2);
+    REQUIRE(queue.GetSize() == 1);
+
+    // The cap holds across lanes, and counts tasks that skipped the queue too.
+    REQUIRE(queue.TryAcquire(capped) == false);
+    queue.Release(capped);
+    REQUIRE(queue.TryAcquire(capped) == true);
+    REQUIRE(queue.TryAcquire(0) == true);
+    REQUIRE(PopTenants(queue).empty());
+
+    queue.Release(capped);
+    expected = { capped };
+    REQUIRE(PopTenants(queue) == expected);
+    REQUIRE(queue.GetRunning(capped) == 2);
+    REQUIRE(queue.GetSize() == 0);
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/flight-recorder.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace napa::zone;
+
+namespace {
+
+    const char* DUMP_FILE = "flight-recorder-tests.log";
+
+    /// <summary> Dumps the events of all threads, and reads the dump. </summary>
+    std::string DumpEvents() {
+        auto file = fopen(DUMP_FILE, "w");
+        REQUIRE(file != nullptr);
+        FlightRecorder::Dump("test", file);
+        fclose(file);
+
+        std::ifstream input(DUMP_FILE);
+        std::stringstream content;
+        content << input.rdbuf();
+        input.close();
+        std::remove(DUMP_FILE);
+        return content.str();
+    }
+}
+
+TEST_CASE("flight recorder dumps the events of threads", "[flight-recorder]") {
+    std::thread([]() {
+        {
+            FlightTaskScope task(3, "flight-module", "run");
+            FlightRecorder::Record(FlightEventType::GC_START, 0, "Scavenge");
+            FlightRecorder::Record(FlightEventType::GC_END, 4096, "Scavenge");
+        }
+        FlightRecorder::Record(FlightEventType::QUEUE_DEPTH, 7, "flight-zone", "normal");
+    }).join();
+
+    auto dump = DumpEvents();
+    REQUIRE(dump.find("napa flight recorder") == 0);
+
+    auto start = dump.find("flight-module:run");
+    REQUIRE(start != std::string::npos);
+    auto gcEnd = dump.find("gc-end       4096", start);
+    REQUIRE(gcEnd != std::string::npos);
+    auto taskEnd = dump.find("task-end     3", gcEnd);
+    REQUIRE(taskEnd != std::string::npos);
+    REQUIRE(dump.find("queue-depth  7                    flight-zone:normal", taskEnd) != std::string::npos);
+
+    // The thread exited, its ring is kept until another thread takes it over.
+    auto header = dump.rfind("thread ", start);
+    REQUIRE(dump.find("(exited)", header) < start);
+}
+
+TEST_CASE("flight recorder keeps the latest events of a thread", "[flight-recorder]") {
+    std::thread([]() {
+        for (size_t i = 0; i < FlightRecorder::RING_SIZE + 10; ++i) {
+            FlightRecorder::Record(FlightEventType::QUEUE_DEPTH, 1000000 + i, "flight-latest");
+        }
+    }).join();
+
+    auto dump = DumpEvents();
+    REQUIRE(dump.find("1000009 ") == std::string::npos);
+    REQUIRE(dump.find("1000010 ") != std::string::npos);
+    REQUIRE(dump.find(std::to_string(1000000 + FlightRecorder::RING_SIZE + 9) + " ") != std::string::npos);
+}
+
+TEST_CASE("flight recorder truncates long names", "[flight-recorder]") {
+    std::string function(100, 'f');
+    std::thread([&function]() {
+        FlightRecorder::Record(FlightEventType::TASK_START, 0, "flight-truncated", function.c_str());
+    }).join();
+
+    auto dump = DumpEvents();
+    auto name = "flight-truncated:" + std::string(FlightEvent::MAX_NAME_LENGTH - 17, 'f');
+    auto position = dump.find(name);
+    REQUIRE(position != std::string::npos);
+    REQUIRE(dump[position + name.size()] == '\n');
+}
+
+TEST_CASE("flight recorder dumps to a file of the dump directory", "[flight-recorder]") {
+    FlightRecorder::Record(FlightEventType::TASK_START, 0, "flight-file");
+
+    auto path = FlightRecorder::Dump("test");
+    REQUIRE(path.find("napa-flight-") == 0);
+
+    std::ifstream input(path);
+    std::stringstream content;
+    content << input.rdbuf();
+    input.close();
+    std::remove(path.c_str());
+    REQUIRE(content.str().find("napa flight recorder, pid ") == 0);
+    REQUIRE(content.str().find(": test\n") != std::string::npos);
+    REQUIRE(content.str().find("flight-file") != std::string::npos);
+
+    FlightRecorder::SetDirectory("no-such-directory");
+    REQUIRE(FlightRecorder::Dump("test").empty());
+    FlightRecorder::SetDirectory("");
+}
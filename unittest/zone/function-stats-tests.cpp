@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <zone/function-stats.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    const FunctionStats& FindStats(const std::vector<FunctionStats>& stats, const std::string& module, const std::string& function) {
+        for (const auto& entry : stats) {
+            if (entry.module == module && entry.function == function) {
+                return entry;
+            }
+        }
+        FAIL("no statistics of " << module << ":" << function);
+        return stats.front();
+    }
+}
+
+TEST_CASE("function stats count calls, times and outcomes", "[function-stats]") {
+    FunctionStatsTable table(2);
+
+    auto entry = table.GetEntry(0, "module", "f");
+    REQUIRE(entry != nullptr);
+    REQUIRE(table.GetEntry(0, "module", "f") == entry);
+    REQUIRE(table.GetEntry(0, "other-module", "f") != entry);
+
+    entry->RecordExecution(std::chrono::microseconds(5));
+    entry->RecordExecution(std::chrono::milliseconds(2));
+    entry->RecordExecution(std::chrono::seconds(3));
+    entry->RecordOutcome(NAPA_RESULT_SUCCESS);
+    entry->RecordOutcome(NAPA_RESULT_EXECUTE_FUNC_ERROR);
+    entry->RecordOutcome(NAPA_RESULT_TIMEOUT);
+
+    auto stats = table.GetStats();
+
+    // Entries with nothing counted yet are left out.
+    REQUIRE(stats.size() == 1);
+    const auto& f = FindStats(stats, "module", "f");
+    REQUIRE(f.calls == 3);
+    REQUIRE(f.errors == 1);
+    REQUIRE(f.timeouts == 1);
+    REQUIRE(f.totalTime == 3002005000u);
+    REQUIRE(f.maxTime == 3000000000u);
+    REQUIRE(f.histogram[0] == 1);
+    REQUIRE(f.histogram[3] == 1);
+    REQUIRE(f.histogram[NAPA_FUNCTION_STATS_BUCKETS - 1] == 1);
+}
+
+TEST_CASE("function stats merge the shards of workers", "[function-stats]") {
+    FunctionStatsTable table(4);
+
+    std::vector<std::thread> workers;
+    for (WorkerId workerId = 0; workerId < 4; ++workerId) {
+        workers.emplace_back([&table, workerId]() {
+            for (int i = 0; i < 1000; ++i) {
+                table.GetEntry(workerId, "module", i % 2 == 0 ? "even" : "odd")->RecordExecution(std::chrono::microseconds(workerId + 1));
+            }
+        });
+    }
+
+    // Reads while workers write see counts in progress.
+    for (int i = 0; i < 100; ++i) {
+        for (const auto& function : table.GetStats()) {
+            REQUIRE(function.calls <= 2000);
+        }
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto stats = table.GetStats();
+    REQUIRE(stats.size() == 2);
+    const auto& even = FindStats(stats, "module", "even");
+    REQUIRE(even.calls == 2000);
+    REQUIRE(even.totalTime == 500 * (1 + 2 + 3 + 4) * 1000u);
+    REQUIRE(even.maxTime == 4000);
+    REQUIRE(FindStats(stats, "module", "odd").calls == 2000);
+}
+
+TEST_CASE("function stats count functions beyond the capacity of a shard together", "[function-stats]") {
+    FunctionStatsTable table(1, 2);
+
+    table.GetEntry(0, "", "a")->RecordExecution(std::chrono::microseconds(1));
+    table.GetEntry(0, "", "b")->RecordExecution(std::chrono::microseconds(1));
+    auto other = table.GetEntry(0, "", "c");
+    REQUIRE(table.GetEntry(0, "", "d") == other);
+    other->RecordExecution(std::chrono::microseconds(1));
+    other->RecordExecution(std::chrono::microseconds(1));
+
+    // Known functions keep their entries once the shard is full.
+    table.GetEntry(0, "", "a")->RecordExecution(std::chrono::microseconds(1));
+
+    auto stats = table.GetStats();
+    REQUIRE(stats.size() == 3);
+    REQUIRE(FindStats(stats, "", "a").calls == 2);
+    REQUIRE(FindStats(stats, "", FunctionStatsTable::OTHER_FUNCTION).calls == 2);
+}
+
+TEST_CASE("function stats ignore workers beyond the capacity", "[function-stats]") {
+    FunctionStatsTable table(1);
+    REQUIRE(table.GetEntry(1, "module", "f") == nullptr);
+    REQUIRE(table.GetStats().empty());
+}
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/hedged-call.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Collects the result of a hedged call. </summary>
+    struct Outcome {
+        std::mutex lock;
+        std::condition_variable done;
+        std::vector<std::string> results;
+
+        ExecuteCallback GetCallback() {
+            return [this](Result result) {
+                std::lock_guard<std::mutex> guard(lock);
+                results.push_back(result.returnValue);
+                done.notify_all();
+            };
+        }
+    };
+
+    Result MakeResult(const std::string& value) {
+        Result result;
+        result.code = NAPA_RESULT_SUCCESS;
+        result.returnValue = value;
+        return result;
+    }
+}
+
+TEST_CASE("hedged call completes with the primary attempt that finishes in time", "[hedged-call]") {
+    Outcome outcome;
+    auto call = std::make_shared<HedgedCall>(outcome.GetCallback(), nullptr);
+    auto primary = call->GetCallback(HedgedCall::PRIMARY);
+
+    std::atomic<bool> started(false);
+    call->Arm(std::chrono::milliseconds(50), [&started]() { started = true; });
+
+    primary(MakeResult("primary"));
+    REQUIRE(outcome.results == std::vector<std::string>({ "primary" }));
+    REQUIRE(call->GetToken(HedgedCall::HEDGE)->IsCancelled());
+    REQUIRE(!call->GetToken(HedgedCall::PRIMARY)->IsCancelled());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(!started);
+    REQUIRE(!call->IsHedged());
+}
+
+TEST_CASE("hedged call starts the hedge after the delay and takes the first result", "[hedged-call]") {
+    Outcome outcome;
+    auto call = std::make_shared<HedgedCall>(outcome.GetCallback(), nullptr);
+    auto primary = call->GetCallback(HedgedCall::PRIMARY);
+    auto hedge = call->GetCallback(HedgedCall::HEDGE);
+
+    // The hedge finishes as soon as it starts, on its own thread as it would on a worker.
+    std::thread worker;
+    call->Arm(std::chrono::milliseconds(10), [&worker, hedge]() {
+        worker = std::thread([hedge]() { hedge(MakeResult("hedge")); });
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(outcome.lock);
+        auto finished = outcome.done.wait_for(lock, std::chrono::seconds(10), [&outcome]() { return !outcome.results.empty(); });
+        REQUIRE(finished);
+    }
+    worker.join();
+
+    REQUIRE(call->IsHedged());
+    REQUIRE(call->GetToken(HedgedCall::PRIMARY)->IsCancelled());
+
+    // The late primary result is dropped.
+    primary(MakeResult("primary"));
+    REQUIRE(outcome.results == std::vector<std::string>({ "hedge" }));
+}
+
+TEST_CASE("hedged call cancels both attempts with the token of the call", "[hedged-call]") {
+    Outcome outcome;
+    auto token = std::make_shared<CancellationToken>();
+    auto call = std::make_shared<HedgedCall>(outcome.GetCallback(), token.get());
+    auto primary = call->GetCallback(HedgedCall::PRIMARY);
+
+    call->Arm(std::chrono::milliseconds(10000), []() {});
+    token->Cancel();
+    REQUIRE(call->GetToken(HedgedCall::PRIMARY)->IsCancelled());
+    REQUIRE(call->GetToken(HedgedCall::HEDGE)->IsCancelled());
+
+    primary(MakeResult("cancelled"));
+    REQUIRE(outcome.results.size() == 1);
+}
+
+TEST_CASE("hedged call isn't armed once it finished", "[hedged-call]") {
+    Outcome outcome;
+    auto token = std::make_shared<CancellationToken>();
+    auto call = std::make_shared<HedgedCall>(outcome.GetCallback(), token.get());
+
+    // E.g. the primary attempt was rejected by an overloaded zone.
+    call->GetCallback(HedgedCall::PRIMARY)(MakeResult("rejected"));
+
+    std::atomic<bool> started(false);
+    call->Arm(std::chrono::milliseconds(1), [&started]() { started = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(!started);
+
+    // The handler of the token was unregistered.
+    token->Cancel();
+    REQUIRE(!call->GetToken(HedgedCall::PRIMARY)->IsCancelled());
+    REQUIRE(outcome.results == std::vector<std::string>({ "rejected" }));
+}
@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <zone/idle-gc-policy.h>
+
+using namespace napa;
+using namespace napa::zone;
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+TEST_CASE("idle GC is disabled by default", "[idle-gc-policy]") {
+    settings::ZoneSettings settings;
+    IdleGcPolicy policy(settings);
+
+    REQUIRE(policy.IsEnabled() == false);
+    REQUIRE(policy.GetStepBudget().count() == 0);
+    REQUIRE(policy.GetFullGcDelay().count() == 0);
+}
+
+TEST_CASE("idle GC steps are bounded by half of the expected idle time", "[idle-gc-policy]") {
+    settings::ZoneSettings settings;
+    settings.idleGcTime = 5;
+    IdleGcPolicy policy(settings);
+
+    REQUIRE(policy.IsEnabled());
+    REQUIRE(policy.GetStepBudget() == milliseconds(5));
+
+    // Long idle periods leave the full budget.
+    policy.EndIdlePeriod(milliseconds(100));
+    REQUIRE(policy.GetStepBudget() == milliseconds(5));
+
+    // The expected idle time follows shorter periods.
+    for (int i = 0; i < 20; i++) {
+        policy.EndIdlePeriod(milliseconds(4));
+    }
+    REQUIRE(policy.GetStepBudget() >= milliseconds(2));
+    REQUIRE(policy.GetStepBudget() < milliseconds(3));
+
+    // Too short to be worth a step.
+    for (int i = 0; i < 20; i++) {
+        policy.EndIdlePeriod(microseconds(500));
+    }
+    REQUIRE(policy.GetStepBudget().count() == 0);
+}
+
+TEST_CASE("idle full GC has its own delay", "[idle-gc-policy]") {
+    settings::ZoneSettings settings;
+    settings.idleGcFullTime = 10000;
+    IdleGcPolicy policy(settings);
+
+    REQUIRE(policy.IsEnabled());
+    REQUIRE(policy.GetStepBudget().count() == 0);
+    REQUIRE(policy.GetFullGcDelay() == milliseconds(10000));
+}
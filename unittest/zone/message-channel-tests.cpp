@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <zone/message-channel.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa::zone;
+
+namespace {
+
+    std::unique_ptr<MessageChannel::Message> MakeMessage(const std::string& payload) {
+        auto message = std::make_unique<MessageChannel::Message>();
+        message->payload = payload;
+        return message;
+    }
+
+    MessageChannel::SendStatus Send(MessageChannel& channel, const std::string& payload) {
+        auto message = MakeMessage(payload);
+        return channel.TrySend(message);
+    }
+}
+
+TEST_CASE("message channel queues messages in order up to its capacity", "[message-channel]") {
+    MessageChannel channel(3);
+    REQUIRE(channel.GetCapacity() == 4);
+    REQUIRE(channel.TryReceive() == nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        REQUIRE(Send(channel, std::to_string(i)) == MessageChannel::SendStatus::SENT);
+    }
+    REQUIRE(channel.GetSize() == 4);
+
+    // A message that doesn't fit is left to the sender.
+    auto message = MakeMessage("4");
+    REQUIRE(channel.TrySend(message) == MessageChannel::SendStatus::FULL);
+    REQUIRE(message != nullptr);
+
+    for (int i = 0; i < 4; ++i) {
+        auto received = channel.TryReceive();
+        REQUIRE(received != nullptr);
+        REQUIRE(received->payload == std::to_string(i));
+    }
+    REQUIRE(channel.GetSize() == 0);
+
+    // The ring wraps around.
+    REQUIRE(channel.TrySend(message) == MessageChannel::SendStatus::SENT);
+    REQUIRE(channel.TryReceive()->payload == "4");
+}
+
+TEST_CASE("message channel hands a message to a waiting receiver", "[message-channel]") {
+    MessageChannel channel(4);
+
+    std::vector<std::string> received;
+    channel.Receive([&received](std::unique_ptr<MessageChannel::Message> message) {
+        received.push_back(message->payload);
+    });
+    REQUIRE(received.empty());
+
+    REQUIRE(Send(channel, "a") == MessageChannel::SendStatus::SENT);
+    REQUIRE((received == std::vector<std::string>{ "a" }));
+    REQUIRE(channel.GetSize() == 0);
+
+    // A queued message is received inline.
+    REQUIRE(Send(channel, "b") == MessageChannel::SendStatus::SENT);
+    channel.Receive([&received](std::unique_ptr<MessageChannel::Message> message) {
+        received.push_back(message->payload);
+    });
+    REQUIRE((received == std::vector<std::string>{ "a", "b" }));
+}
+
+TEST_CASE("message channel notifies a waiting sender once a message is received", "[message-channel]") {
+    MessageChannel channel(2);
+    REQUIRE(Send(channel, "a") == MessageChannel::SendStatus::SENT);
+    REQUIRE(Send(channel, "b") == MessageChannel::SendStatus::SENT);
+
+    int calls = 0;
+    bool writable = false;
+    channel.WaitWritable([&](bool open) {
+        calls++;
+        writable = open;
+    });
+    REQUIRE(calls == 0);
+
+    REQUIRE(channel.TryReceive() != nullptr);
+    REQUIRE(calls == 1);
+    REQUIRE(writable);
+
+    // Waiting on a channel with room calls back right away.
+    channel.WaitWritable([&](bool /*open*/) {
+        calls++;
+    });
+    REQUIRE(calls == 2);
+}
+
+TEST_CASE("message channel delivers queued messages after it's closed", "[message-channel]") {
+    MessageChannel channel(4);
+    REQUIRE(Send(channel, "a") == MessageChannel::SendStatus::SENT);
+
+    channel.Close();
+    REQUIRE(channel.IsClosed());
+    REQUIRE(Send(channel, "b") == MessageChannel::SendStatus::CLOSED);
+
+    std::vector<std::string> received;
+    auto receive = [&received](std::unique_ptr<MessageChannel::Message> message) {
+        received.push_back(message != nullptr ? message->payload : "<end>");
+    };
+    channel.Receive(receive);
+    channel.Receive(receive);
+    REQUIRE((received == std::vector<std::string>{ "a", "<end>" }));
+
+    bool writable = true;
+    channel.WaitWritable([&writable](bool open) { writable = open; });
+    REQUIRE(!writable);
+}
+
+TEST_CASE("message channel ends waiting receivers and senders when it's closed", "[message-channel]") {
+    MessageChannel channel(2);
+
+    bool ended = false;
+    channel.Receive([&ended](std::unique_ptr<MessageChannel::Message> message) {
+        ended = message == nullptr;
+    });
+
+    channel.Close();
+    REQUIRE(ended);
+}
+
+TEST_CASE("message channel passes messages of concurrent senders to a receiver", "[message-channel]") {
+    const int SENDERS = 4;
+    const int MESSAGES_PER_SENDER = 20000;
+
+    MessageChannel channel(64);
+
+    std::vector<std::thread> senders;
+    for (int sender = 0; sender < SENDERS; ++sender) {
+        senders.emplace_back([&channel, sender]() {
+            for (int i = 0; i < MESSAGES_PER_SENDER; ++i) {
+                auto message = MakeMessage(std::to_string(sender) + ":" + std::to_string(i));
+                while (channel.TrySend(message) == MessageChannel::SendStatus::FULL) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    // Messages of a sender come in its order.
+    std::vector<int> next(SENDERS, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < SENDERS * MESSAGES_PER_SENDER) {
+        auto message = channel.TryReceive();
+        if (message == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        auto separator = message->payload.find(':');
+        auto sender = std::stoi(message->payload.substr(0, separator));
+        auto sequence = std::stoi(message->payload.substr(separator + 1));
+        ordered = ordered && sequence == next[sender];
+        next[sender] = sequence + 1;
+        received++;
+    }
+
+    for (auto& sender : senders) {
+        sender.join();
+    }
+    REQUIRE(ordered);
+    REQUIRE(channel.TryReceive() == nullptr);
+}
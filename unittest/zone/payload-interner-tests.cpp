@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <zone/payload-interner.h>
+
+using namespace napa::zone;
+
+namespace {
+    std::string MakePayload(char c, size_t size = PayloadInterner::MIN_PAYLOAD_SIZE) {
+        return std::string(size, c);
+    }
+}
+
+TEST_CASE("payload interner shares payloads with the same content", "[payload-interner]") {
+    PayloadInterner interner;
+
+    auto content = MakePayload('a');
+    auto first = interner.Intern(content.data(), content.size());
+    auto second = interner.Intern(content.data(), content.size());
+
+    REQUIRE(first == second);
+    REQUIRE(first->data == content);
+    REQUIRE(interner.GetSize() == 1);
+}
+
+TEST_CASE("payload interner keeps payloads with different content apart", "[payload-interner]") {
+    PayloadInterner interner;
+
+    auto a = MakePayload('a');
+    auto b = MakePayload('b');
+    auto longer = MakePayload('a', PayloadInterner::MIN_PAYLOAD_SIZE + 1);
+
+    auto first = interner.Intern(a.data(), a.size());
+    auto second = interner.Intern(b.data(), b.size());
+    auto third = interner.Intern(longer.data(), longer.size());
+
+    REQUIRE(first != second);
+    REQUIRE(first != third);
+    REQUIRE(second->data == b);
+    REQUIRE(third->data == longer);
+    REQUIRE(interner.GetSize() == 3);
+}
+
+TEST_CASE("payload interner removes a payload when its last reference is released", "[payload-interner]") {
+    PayloadInterner interner;
+
+    auto content = MakePayload('a');
+    auto first = interner.Intern(content.data(), content.size());
+    auto second = interner.Intern(content.data(), content.size());
+
+    first.reset();
+    REQUIRE(interner.GetSize() == 1);
+
+    second.reset();
+    REQUIRE(interner.GetSize() == 0);
+
+    // Interning the same content again creates a new payload.
+    auto third = interner.Intern(content.data(), content.size());
+    REQUIRE(third->data == content);
+    REQUIRE(interner.GetSize() == 1);
+}
+
+TEST_CASE("payload interner tells ASCII payloads", "[payload-interner]") {
+    PayloadInterner interner;
+
+    auto ascii = MakePayload('a');
+    auto utf8 = MakePayload('a');
+    utf8.replace(0, 2, "\xC3\xA9");
+
+    REQUIRE(interner.Intern(ascii.data(), ascii.size())->ascii);
+    REQUIRE_FALSE(interner.Intern(utf8.data(), utf8.size())->ascii);
+}
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <zone/recycle-policy.h>
+
+#include <set>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+    const size_t MB = 1024 * 1024;
+}
+
+TEST_CASE("recycle task count is disabled by default", "[recycle-policy]") {
+    settings::ZoneSettings settings;
+
+    REQUIRE(GetRecycleTaskCount(0, 0, settings) == 0);
+    REQUIRE(IsHeapRecycleNeeded({ 1024 * MB, 2048 * MB }, settings) == false);
+}
+
+TEST_CASE("recycle task count is staggered across workers and generations", "[recycle-policy]") {
+    settings::ZoneSettings settings;
+    settings.recycleTaskCount = 1000;
+
+    std::set<uint64_t> counts;
+    for (uint32_t workerId = 0; workerId < 8; workerId++) {
+        for (uint32_t generation = 0; generation < 4; generation++) {
+            auto count = GetRecycleTaskCount(workerId, generation, settings);
+            REQUIRE(count >= 1000);
+            REQUIRE(count < 1500);
+
+            // Stable for the same worker and generation.
+            REQUIRE(count == GetRecycleTaskCount(workerId, generation, settings));
+            counts.insert(count);
+        }
+    }
+    REQUIRE(counts.size() > 16);
+}
+
+TEST_CASE("isolate is recycled beyond the heap size", "[recycle-policy]") {
+    settings::ZoneSettings settings;
+    settings.recycleHeapSize = 256;
+
+    REQUIRE(IsHeapRecycleNeeded({ 255 * MB, 300 * MB }, settings) == false);
+    REQUIRE(IsHeapRecycleNeeded({ 256 * MB, 300 * MB }, settings));
+}
+
+TEST_CASE("isolate is recycled beyond the heap fragmentation", "[recycle-policy]") {
+    settings::ZoneSettings settings;
+    settings.recycleFragmentation = 50;
+
+    REQUIRE(IsHeapRecycleNeeded({ 60 * MB, 100 * MB }, settings) == false);
+    REQUIRE(IsHeapRecycleNeeded({ 50 * MB, 100 * MB }, settings));
+
+    // Small heaps are never considered fragmented.
+    REQUIRE(IsHeapRecycleNeeded({ 1 * MB, 16 * MB }, settings) == false);
+}
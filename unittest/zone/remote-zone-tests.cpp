@@ -0,0 +1,337 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/cancellation-token.h"
+#include "zone/remote-protocol.h"
+#include "zone/remote-zone.h"
+#include "zone/remote-zone-host.h"
+
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+using namespace napa::zone::remote;
+
+namespace {
+
+    /// <summary> A zone returning "module.function(arguments)", whose "wait" function finishes once cancelled. </summary>
+    class FakeZone : public Zone {
+    public:
+        FakeZone() : _id("fake") {}
+
+        const std::string& GetId() const override {
+            return _id;
+        }
+
+        void Broadcast(const std::string& source, BroadcastCallback callback) override {
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                broadcasts.push_back(source);
+            }
+            callback(NAPA_RESULT_SUCCESS);
+        }
+
+        void Execute(const FunctionSpec& spec, ExecuteCallback callback) override {
+            auto function = NAPA_STRING_REF_TO_STD_STRING(spec.function);
+            if (function == "wait") {
+                auto token = static_cast<CancellationToken*>(spec.options.cancellation_token)->shared_from_this();
+                std::lock_guard<std::mutex> lock(_lock);
+                _waiting.emplace_back(token);
+                token->Register([callback]() {
+                    Result result;
+                    result.code = NAPA_RESULT_CANCELLED;
+                    callback(std::move(result));
+                });
+                return;
+            }
+
+            Result result;
+            result.code = NAPA_RESULT_SUCCESS;
+            result.returnValue = NAPA_STRING_REF_TO_STD_STRING(spec.module) + "." + function + "(";
+            for (size_t i = 0; i < spec.arguments.size(); i++) {
+                result.returnValue += (i > 0 ? "," : "") + NAPA_STRING_REF_TO_STD_STRING(spec.arguments[i]);
+            }
+            result.returnValue += ")";
+            result.cpuTime = 42;
+            callback(std::move(result));
+        }
+
+        void ExecuteBatch(const std::vector<FunctionSpec>&, ExecuteBatchCallback) override {}
+        void ExecuteBatch(const std::vector<FunctionSpec>&, std::vector<ExecuteCallback>) override {}
+
+        float GetPressure() const override {
+            return 0.5f;
+        }
+
+        uint32_t GetWorkers() const override {
+            return 3;
+        }
+
+        void Resize(uint32_t, ResizeCallback) override {}
+        void Drain(uint32_t, DrainCallback) override {}
+        void GetMemoryUsage(MemoryUsageCallback) override {}
+        void StartProfiling(uint32_t, ProfilingCallback) override {}
+        void StopProfiling(CpuProfileCallback) override {}
+        void StartAllocationProfiling(uint32_t, ProfilingCallback) override {}
+        void StopAllocationProfiling(AllocationProfileCallback) override {}
+        void GetHeapStatistics(HeapStatisticsCallback) override {}
+        void WriteHeapSnapshot(uint32_t, const std::string&, HeapSnapshotCallback) override {}
+        std::vector<SlowCall> GetSlowCalls() const override { return {}; }
+        std::vector<FunctionStats> GetFunctionStats() const override { return {}; }
+
+        std::vector<std::string> broadcasts;
+
+    private:
+        std::string _id;
+        std::mutex _lock;
+        std::vector<std::shared_ptr<CancellationToken>> _waiting;
+    };
+
+    FunctionSpec MakeSpec(const char* module, const char* function, const std::vector<StringRef>& arguments) {
+        FunctionSpec spec;
+        spec.module = NAPA_STRING_REF(module);
+        spec.function = NAPA_STRING_REF(function);
+        spec.arguments = arguments;
+        return spec;
+    }
+
+    Result Wait(std::future<Result>& future) {
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        return future.get();
+    }
+}
+
+TEST_CASE("remote protocol frames round trip", "[remote-zone]") {
+    SECTION("execute request") {
+        auto spec = MakeSpec("./module", "func", { NAPA_STRING_REF("1"), NAPA_STRING_REF("\"two\"") });
+        spec.options.timeout = 100;
+        spec.options.cpu_timeout = 20;
+        spec.options.transport = TransportOption::BINARY;
+        spec.options.priority = CallPriority::HIGH;
+        spec.options.affinity_key = NAPA_STRING_REF("key");
+        spec.options.tenant = NAPA_STRING_REF("tenant");
+
+        std::string buffer;
+        WriteExecute(buffer, 7, spec);
+
+        FrameHeader header;
+        REQUIRE(ReadHeader(buffer.data(), header));
+        REQUIRE(header.type == FrameType::EXECUTE);
+        REQUIRE(header.id == 7);
+        REQUIRE(header.size == buffer.size() - HEADER_SIZE);
+
+        ExecuteRequest request;
+        FrameReader reader(buffer.data() + HEADER_SIZE, header.size);
+        REQUIRE(ReadExecute(reader, request));
+        REQUIRE(request.module == "./module");
+        REQUIRE(request.function == "func");
+        REQUIRE(request.arguments == std::vector<std::string>({ "1", "\"two\"" }));
+        REQUIRE(request.timeout == 100);
+        REQUIRE(request.cpuTimeout == 20);
+        REQUIRE(request.transport == TransportOption::BINARY);
+        REQUIRE(request.priority == CallPriority::HIGH);
+        REQUIRE(request.affinityKey == "key");
+        REQUIRE(request.tenant == "tenant");
+        REQUIRE(!request.cancellable);
+
+        auto decoded = request.ToSpec();
+        REQUIRE(NAPA_STRING_REF_TO_STD_STRING(decoded.arguments[1]) == "\"two\"");
+        REQUIRE(NAPA_STRING_REF_TO_STD_STRING(decoded.options.tenant) == "tenant");
+        REQUIRE(decoded.options.cpu_timeout == 20);
+    }
+
+    SECTION("result") {
+        Result result;
+        result.code = NAPA_RESULT_EXECUTE_FUNC_ERROR;
+        result.errorMessage = "failed";
+        result.cpuTime = 5;
+
+        std::string buffer;
+        WriteResult(buffer, 3, result, 0.25f);
+
+        FrameHeader header;
+        REQUIRE(ReadHeader(buffer.data(), header));
+        REQUIRE(header.type == FrameType::RESULT);
+
+        Result decoded;
+        float pressure;
+        FrameReader reader(buffer.data() + HEADER_SIZE, header.size);
+        REQUIRE(ReadResult(reader, decoded, pressure));
+        REQUIRE(decoded.code == NAPA_RESULT_EXECUTE_FUNC_ERROR);
+        REQUIRE(decoded.errorMessage == "failed");
+        REQUIRE(decoded.cpuTime == 5);
+        REQUIRE(pressure == 0.25f);
+    }
+
+    SECTION("large payloads are compressed") {
+        std::string argument;
+        while (argument.size() < 2 * COMPRESS_ABOVE) {
+            argument += "{\"name\":\"item\",\"value\":\"some text\"},";
+        }
+
+        std::string buffer;
+        WriteExecute(buffer, 2, MakeSpec("m", "f", { STD_STRING_TO_NAPA_STRING_REF(argument) }));
+
+        FrameHeader header;
+        REQUIRE(ReadHeader(buffer.data(), header));
+        REQUIRE(header.type == FrameType::EXECUTE);
+        REQUIRE(header.compressed);
+        REQUIRE(header.size == buffer.size() - HEADER_SIZE);
+        REQUIRE(header.size < argument.size() / 2);
+    }
+
+    SECTION("truncated frames are rejected") {
+        std::string buffer;
+        WriteExecute(buffer, 1, MakeSpec("m", "f", { NAPA_STRING_REF("argument") }));
+
+        ExecuteRequest request;
+        FrameReader reader(buffer.data() + HEADER_SIZE, buffer.size() - HEADER_SIZE - 10);
+        REQUIRE(!ReadExecute(reader, request));
+    }
+}
+
+TEST_CASE("remote protocol parses addresses", "[remote-zone]") {
+    std::string host;
+    uint16_t port;
+
+    REQUIRE(ParseAddress("localhost:8080", host, port));
+    REQUIRE(host == "localhost");
+    REQUIRE(port == 8080);
+
+    REQUIRE(ParseAddress("[::1]:0", host, port));
+    REQUIRE(host == "::1");
+    REQUIRE(port == 0);
+
+    REQUIRE(!ParseAddress("localhost", host, port));
+    REQUIRE(!ParseAddress("localhost:", host, port));
+    REQUIRE(!ParseAddress("localhost:http", host, port));
+    REQUIRE(!ParseAddress("localhost:65536", host, port));
+}
+
+TEST_CASE("remote zone calls a zone served by a host", "[remote-zone]") {
+    auto zone = std::make_shared<FakeZone>();
+    auto host = RemoteZoneHost::Start(zone, "127.0.0.1:0");
+    REQUIRE(host != nullptr);
+    REQUIRE(host->GetPort() != 0);
+
+    auto remote = RemoteZone::Connect("127.0.0.1:" + std::to_string(host->GetPort()));
+    REQUIRE(remote != nullptr);
+    REQUIRE(remote->GetId() == "fake");
+    REQUIRE(remote->GetWorkers() == 3);
+
+    SECTION("execute") {
+        std::promise<Result> promise;
+        auto future = promise.get_future();
+        remote->Execute(MakeSpec("m", "f", { NAPA_STRING_REF("1"), NAPA_STRING_REF("2") }), [&promise](Result result) {
+            promise.set_value(std::move(result));
+        });
+
+        auto result = Wait(future);
+        REQUIRE(result.code == NAPA_RESULT_SUCCESS);
+        REQUIRE(result.returnValue == "m.f(1,2)");
+        REQUIRE(result.cpuTime == 42);
+        REQUIRE(remote->GetPressure() == 0.5f);
+    }
+
+    SECTION("execute with payloads sent compressed") {
+        std::string argument;
+        while (argument.size() < 100 * 1024) {
+            argument += "{\"id\":" + std::to_string(argument.size()) + ",\"value\":\"some text\"},";
+        }
+
+        std::promise<Result> promise;
+        auto future = promise.get_future();
+        remote->Execute(MakeSpec("m", "f", { STD_STRING_TO_NAPA_STRING_REF(argument) }), [&promise](Result result) {
+            promise.set_value(std::move(result));
+        });
+
+        auto result = Wait(future);
+        REQUIRE(result.code == NAPA_RESULT_SUCCESS);
+        REQUIRE(result.returnValue == "m.f(" + argument + ")");
+    }
+
+    SECTION("execute batch") {
+        std::vector<FunctionSpec> specs;
+        specs.emplace_back(MakeSpec("m", "f", { NAPA_STRING_REF("1") }));
+        specs.emplace_back(MakeSpec("m", "g", { NAPA_STRING_REF("2") }));
+
+        std::promise<std::vector<Result>> promise;
+        auto future = promise.get_future();
+        remote->ExecuteBatch(specs, [&promise](std::vector<Result> results) {
+            promise.set_value(std::move(results));
+        });
+
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        auto results = future.get();
+        REQUIRE(results.size() == 2);
+        REQUIRE(results[0].returnValue == "m.f(1)");
+        REQUIRE(results[1].returnValue == "m.g(2)");
+    }
+
+    SECTION("broadcast") {
+        std::promise<ResultCode> promise;
+        auto future = promise.get_future();
+        remote->Broadcast("var x = 1;", [&promise](ResultCode code) {
+            promise.set_value(code);
+        });
+
+        REQUIRE(future.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        REQUIRE(future.get() == NAPA_RESULT_SUCCESS);
+        REQUIRE(zone->broadcasts == std::vector<std::string>({ "var x = 1;" }));
+    }
+
+    SECTION("cancel") {
+        auto token = std::make_shared<CancellationToken>();
+        auto spec = MakeSpec("m", "wait", {});
+        spec.options.cancellation_token = token.get();
+
+        std::promise<Result> promise;
+        auto future = promise.get_future();
+        remote->Execute(spec, [&promise](Result result) {
+            promise.set_value(std::move(result));
+        });
+
+        REQUIRE(future.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+        token->Cancel();
+        REQUIRE(Wait(future).code == NAPA_RESULT_CANCELLED);
+    }
+
+    SECTION("pending calls fail once the host stops") {
+        auto token = std::make_shared<CancellationToken>();
+        auto spec = MakeSpec("m", "wait", {});
+        spec.options.cancellation_token = token.get();
+
+        std::promise<Result> promise;
+        auto future = promise.get_future();
+        remote->Execute(spec, [&promise](Result result) {
+            promise.set_value(std::move(result));
+        });
+
+        // The host cancels the call it's running as the connection is closed, so it doesn't wait for it.
+        host.reset();
+        REQUIRE(Wait(future).code == NAPA_RESULT_ZONE_DISCONNECTED);
+
+        std::promise<Result> later;
+        auto laterFuture = later.get_future();
+        remote->Execute(MakeSpec("m", "f", {}), [&later](Result result) {
+            later.set_value(std::move(result));
+        });
+        REQUIRE(Wait(laterFuture).code == NAPA_RESULT_ZONE_DISCONNECTED);
+    }
+}
+
+TEST_CASE("remote zone fails to connect without a host", "[remote-zone]") {
+    uint16_t port;
+    auto listener = platform::Socket::Listen("127.0.0.1", 0, port);
+    REQUIRE(listener != nullptr);
+    listener.reset();
+
+    REQUIRE(RemoteZone::Connect("127.0.0.1:" + std::to_string(port)) == nullptr);
+    REQUIRE(RemoteZone::Connect("no-port") == nullptr);
+}
@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/result-cache.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    FunctionSpec MakeSpec(const char* function, const std::vector<std::string>& arguments) {
+        FunctionSpec spec;
+        spec.module = NAPA_STRING_REF("module");
+        spec.function = NAPA_STRING_REF(function);
+        for (const auto& argument : arguments) {
+            spec.arguments.push_back(STD_STRING_TO_NAPA_STRING_REF(argument));
+        }
+        return spec;
+    }
+
+    bool SameKey(const FunctionSpec& left, const FunctionSpec& right) {
+        return ResultCache::GetKey(left) == ResultCache::GetKey(right);
+    }
+}
+
+TEST_CASE("result cache keys calls by function and arguments", "[result-cache]") {
+    std::vector<std::string> ab = { "a", "b" };
+    std::vector<std::string> abJoined = { "ab" };
+    std::vector<std::string> ba = { "b", "a" };
+
+    REQUIRE(SameKey(MakeSpec("f", ab), MakeSpec("f", ab)));
+    REQUIRE(!SameKey(MakeSpec("f", ab), MakeSpec("g", ab)));
+    REQUIRE(!SameKey(MakeSpec("f", ab), MakeSpec("f", ba)));
+
+    // Boundaries of arguments count, not only their bytes.
+    REQUIRE(!SameKey(MakeSpec("f", ab), MakeSpec("f", abJoined)));
+
+    auto transported = MakeSpec("f", ab);
+    transported.options.transport = napa_transport_option::BINARY;
+    REQUIRE(!SameKey(MakeSpec("f", ab), transported));
+}
+
+TEST_CASE("result cache returns results it was put", "[result-cache]") {
+    ResultCache cache(1024 * 1024, std::chrono::milliseconds(0));
+    auto key = ResultCache::GetKey(MakeSpec("f", { "1" }));
+
+    std::string result;
+    REQUIRE(!cache.Get(key, result));
+
+    cache.Put(key, "42");
+    REQUIRE(cache.Get(key, result));
+    REQUIRE(result == "42");
+
+    cache.Put(key, "43");
+    REQUIRE(cache.Get(key, result));
+    REQUIRE(result == "43");
+    REQUIRE(cache.GetCount() == 1);
+    REQUIRE(cache.GetBytes() == 2 + ResultCache::ENTRY_OVERHEAD);
+}
+
+TEST_CASE("result cache expires results after their TTL", "[result-cache]") {
+    ResultCache cache(1024 * 1024, std::chrono::milliseconds(20));
+    auto key = ResultCache::GetKey(MakeSpec("f", { "1" }));
+
+    std::string result;
+    cache.Put(key, "42");
+    REQUIRE(cache.Get(key, result));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(!cache.Get(key, result));
+    REQUIRE(cache.GetCount() == 0);
+}
+
+TEST_CASE("result cache evicts least recently used results beyond its size", "[result-cache]") {
+    // 16 shards of a few entries each.
+    const size_t entryBytes = 100 + ResultCache::ENTRY_OVERHEAD;
+    const size_t maxBytes = 16 * 4 * entryBytes;
+    ResultCache cache(maxBytes, std::chrono::milliseconds(0));
+
+    std::string value(100, 'x');
+    auto first = ResultCache::GetKey(MakeSpec("f", { "first" }));
+    cache.Put(first, value);
+
+    std::string result;
+    for (int i = 0; i < 1000; i++) {
+        cache.Put(ResultCache::GetKey(MakeSpec("f", { std::to_string(i) })), value);
+
+        // Used all along, so it stays.
+        REQUIRE(cache.Get(first, result));
+    }
+    REQUIRE(cache.GetBytes() <= maxBytes);
+    REQUIRE(cache.GetCount() < 1000);
+
+    // Results larger than a shard aren't cached.
+    auto large = ResultCache::GetKey(MakeSpec("large", {}));
+    cache.Put(large, std::string(maxBytes, 'x'));
+    REQUIRE(!cache.Get(large, result));
+}
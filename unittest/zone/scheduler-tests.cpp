@@ -7,6 +7,9 @@
 #include <cstddef>
 #include <atomic>
 #include <future>
+#include <map>
+#include <mutex>
+#include <thread>
 
 using namespace napa;
 using namespace napa::zone;
@@ -29,8 +32,18 @@ public:
         _callback();
     }
 
+    virtual std::chrono::steady_clock::time_point GetDeadline() const override {
+        return deadline;
+    }
+
+    virtual void Cancel(ResultCode code, const std::string& /*reason*/) override {
+        cancelCode = code;
+    }
+
     std::atomic<uint32_t> numberOfExecutions;
     std::atomic<WorkerId> lastExecutedWorkerId;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    std::atomic<ResultCode> cancelCode { NAPA_RESULT_SUCCESS };
 
 private:
     std::function<void()> _callback;
@@ -44,42 +57,87 @@ public:
     TestWorker(WorkerId id,
                const ZoneSettings &settings,
                std::function<void(WorkerId)> setupCompleteCallback,
-               std::function<void(WorkerId)> idleCallback) : _id(id) {
+               std::function<void(WorkerId)> idleCallback,
+               std::function<bool(WorkerId)> = nullptr) :
+        _id(id),
+        _futuresLock(std::make_unique<std::mutex>()),
+        _pendingTasks(std::make_unique<std::atomic<size_t>>(0)) {
         
         numberOfWorkers++;
+        aliveWorkers++;
+        maxOldSpaceSizes[id] = settings.maxOldSpaceSize;
         _idleNotificationCallback = idleCallback;
         setupCompleteCallback(id);
     }
 
+    TestWorker(TestWorker&&) = default;
+
     ~TestWorker() {
-        for (auto& fut : _futures) {
+        if (_futuresLock == nullptr) {
+            return;
+        }
+        aliveWorkers--;
+
+        // Tasks may still be scheduled from other threads while draining.
+        std::unique_lock<std::mutex> lock(*_futuresLock);
+        for (size_t i = 0; i < _futures.size(); i++) {
+            auto fut = _futures[i];
+            lock.unlock();
             fut.get();
+            lock.lock();
         }
     }
 
     void Start() {}
 
     void Schedule(std::shared_ptr<Task> task) {
+        // Tasks of tenants are decorated by the scheduler.
         auto testTask = std::dynamic_pointer_cast<TestTask>(task);
-        testTask->SetCurrentWorkerId(_id);
+        if (testTask != nullptr) {
+            testTask->SetCurrentWorkerId(_id);
+        }
 
+        (*_pendingTasks)++;
+
+        std::lock_guard<std::mutex> lock(*_futuresLock);
         _futures.emplace_back(std::async(std::launch::async, [this, task]() {
             task->Execute();
+            (*_pendingTasks)--;
             _idleNotificationCallback(_id);
         }));
     }
 
+    size_t GetQueueLength() const {
+        return *_pendingTasks;
+    }
+
+    void Close() {}
+
+    void RequestInterrupt(InterruptCallback callback, void* data) {
+        callback(nullptr, data);
+    }
+
     static uint32_t numberOfWorkers;
+    static std::atomic<uint32_t> aliveWorkers;
+    static std::map<WorkerId, uint32_t> maxOldSpaceSizes;
 
 private:
     WorkerId _id;
     std::vector<std::shared_future<void>> _futures;
+    std::unique_ptr<std::mutex> _futuresLock;
+    std::unique_ptr<std::atomic<size_t>> _pendingTasks;
     std::function<void(WorkerId)> _idleNotificationCallback;
 };
 
 template <uint32_t I>
 uint32_t TestWorker<I>::numberOfWorkers = 0;
 
+template <uint32_t I>
+std::atomic<uint32_t> TestWorker<I>::aliveWorkers(0);
+
+template <uint32_t I>
+std::map<WorkerId, uint32_t> TestWorker<I>::maxOldSpaceSizes;
+
 
 TEST_CASE("scheduler creates correct number of worker", "[scheduler]") {
     ZoneSettings settings;
@@ -101,6 +159,70 @@ TEST_CASE("scheduler dispatches worker setup complete callback correctly", "[sch
     REQUIRE(idSum == settings.workers * (settings.workers - 1) / 2);
 }
 
+TEST_CASE("scheduler interrupts all workers", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 3;
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<1>>>(settings, [](WorkerId) {});
+
+    std::atomic<uint32_t> interrupts(0);
+    scheduler->InterruptAllWorkers([](v8::Isolate*, void* data) {
+        (*static_cast<std::atomic<uint32_t>*>(data))++;
+    }, &interrupts);
+
+    REQUIRE(interrupts == settings.workers);
+}
+
+TEST_CASE("scheduler shuts down workers before it's destroyed", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 3;
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<21>>>(settings, [](WorkerId) {});
+    auto task = std::make_shared<TestTask>();
+    scheduler->ScheduleOnAllWorkers(task);
+
+    scheduler->Shutdown();
+    REQUIRE(task->numberOfExecutions == settings.workers);
+    REQUIRE(TestWorker<21>::aliveWorkers == 0);
+
+    // Destruction after shutdown has nothing left to do.
+    scheduler = nullptr;
+    REQUIRE(TestWorker<21>::aliveWorkers == 0);
+}
+
+TEST_CASE("scheduler cancels tasks of asynchronous work that completes after shutdown", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 2;
+
+    SECTION("work-stealing scheduler") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    SECTION("synchronized scheduler") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    auto scheduler = std::make_shared<SchedulerImpl<TestWorker<22>>>(settings, [](WorkerId) {});
+
+    // Asynchronous work pins its worker and keeps the scheduler, the worker is shut down all the same.
+    scheduler->PinWorker(1);
+    scheduler->Shutdown();
+    REQUIRE(TestWorker<22>::aliveWorkers == 0);
+
+    auto completion = std::make_shared<TestTask>();
+    scheduler->ScheduleOnWorker(1, completion);
+    scheduler->UnpinWorker(1);
+    REQUIRE(completion->numberOfExecutions == 0);
+    REQUIRE(completion->cancelCode == NAPA_RESULT_CANCELLED);
+
+    auto task = std::make_shared<TestTask>();
+    scheduler->Schedule(task);
+    REQUIRE(task->cancelCode == NAPA_RESULT_CANCELLED);
+
+    scheduler->ScheduleOnAllWorkers(std::make_shared<TestTask>());
+    scheduler = nullptr;
+}
+
 TEST_CASE("scheduler assigns tasks correctly", "[scheduler]") {
     ZoneSettings settings;
     settings.workers = 3;
@@ -163,3 +285,728 @@ TEST_CASE("scheduler distributes and schedules all tasks", "[scheduler]") {
         REQUIRE(flag);
     }
 }
+
+TEST_CASE("work-stealing scheduler assigns tasks correctly", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 3;
+    settings.scheduler = SchedulerType::WORK_STEALING;
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<4>>>(settings, [](WorkerId) {});
+    auto task = std::make_shared<TestTask>();
+
+    SECTION("schedules on exactly one worker") {
+        scheduler->Schedule(task);
+        scheduler = nullptr; // force draining all scheduled tasks
+
+        REQUIRE(task->numberOfExecutions == 1);
+    }
+
+    SECTION("schedule on a specific worker") {
+        scheduler->ScheduleOnWorker(2, task);
+        scheduler = nullptr; // force draining all scheduled tasks
+
+        REQUIRE(task->numberOfExecutions == 1);
+        REQUIRE(task->lastExecutedWorkerId == 2);
+    }
+
+    SECTION("schedule on all workers") {
+        scheduler->ScheduleOnAllWorkers(task);
+        scheduler = nullptr; // force draining all scheduled tasks
+
+        REQUIRE(task->numberOfExecutions == settings.workers);
+    }
+}
+
+TEST_CASE("work-stealing scheduler distributes and schedules all tasks", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 4;
+    settings.scheduler = SchedulerType::WORK_STEALING;
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<5>>>(settings, [](WorkerId) {});
+
+    std::vector<std::shared_ptr<TestTask>> tasks;
+    for (size_t i = 0; i < 1000; i++) {
+        auto task = std::make_shared<TestTask>();
+        tasks.push_back(task);
+        scheduler->Schedule(task);
+    }
+
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    std::vector<bool> scheduledWorkersFlags = { false, false, false, false };
+    for (size_t i = 0; i < 1000; i++) {
+        // Make sure that each task was executed once
+        REQUIRE(tasks[i]->numberOfExecutions == 1);
+        scheduledWorkersFlags[tasks[i]->lastExecutedWorkerId] = true;
+    }
+
+    // Make sure that all workers were participating
+    for (auto flag: scheduledWorkersFlags) {
+        REQUIRE(flag);
+    }
+}
+
+TEST_CASE("scheduler serves queued tasks by priority", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 1;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<6>>>(settings, [](WorkerId) {});
+
+    // Keep the only worker busy, so all following tasks are queued.
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    scheduler->Schedule(std::make_shared<TestTask>([blocker]() { blocker.wait(); }));
+
+    std::mutex lock;
+    std::vector<CallPriority> order;
+    auto enqueue = [&](CallPriority priority) {
+        scheduler->Schedule(std::make_shared<TestTask>([&lock, &order, priority]() {
+            std::lock_guard<std::mutex> guard(lock);
+            order.push_back(priority);
+        }), priority);
+    };
+
+    enqueue(CallPriority::BACKGROUND);
+    enqueue(CallPriority::NORMAL);
+    enqueue(CallPriority::BACKGROUND);
+    enqueue(CallPriority::HIGH);
+
+    // Tasks are queued asynchronously in synchronized mode.
+    while (scheduler->GetQueueDepth(CallPriority::BACKGROUND) != 2
+        || scheduler->GetQueueDepth(CallPriority::NORMAL) != 1
+        || scheduler->GetQueueDepth(CallPriority::HIGH) != 1) {
+        std::this_thread::yield();
+    }
+
+    promise.set_value();
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    std::vector<CallPriority> expected = {
+        CallPriority::HIGH, CallPriority::NORMAL, CallPriority::BACKGROUND, CallPriority::BACKGROUND };
+    REQUIRE(order == expected);
+}
+
+TEST_CASE("scheduler spills tasks from an overloaded preferred worker", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 2;
+    settings.affinitySpillThreshold = 2;
+
+    // Work-stealing scheduler hands tasks to a specific worker synchronously, which makes queue length predictable.
+    settings.scheduler = SchedulerType::WORK_STEALING;
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<7>>>(settings, [](WorkerId) {});
+
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+
+    std::vector<std::shared_ptr<TestTask>> preferred;
+    for (size_t i = 0; i < 2; i++) {
+        auto task = std::make_shared<TestTask>([blocker]() { blocker.wait(); });
+        preferred.push_back(task);
+        scheduler->ScheduleOnPreferredWorker(1, task);
+    }
+
+    auto spilled = std::make_shared<TestTask>();
+    scheduler->ScheduleOnPreferredWorker(1, spilled);
+
+    promise.set_value();
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    for (auto& task : preferred) {
+        REQUIRE(task->numberOfExecutions == 1);
+        REQUIRE(task->lastExecutedWorkerId == 1);
+    }
+    REQUIRE(spilled->numberOfExecutions == 1);
+    REQUIRE(spilled->lastExecutedWorkerId == 0);
+}
+
+TEST_CASE("scheduler fills busy workers up to the worker queue depth", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 2;
+    settings.workerQueueDepth = 2;
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<17>>>(settings, [](WorkerId) {});
+
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+
+    std::vector<std::shared_ptr<TestTask>> tasks;
+    for (size_t i = 0; i < 5; i++) {
+        auto task = std::make_shared<TestTask>([blocker]() { blocker.wait(); });
+        tasks.push_back(task);
+        scheduler->Schedule(task);
+    }
+
+    // 2 tasks run and 2 are queued on the busy workers, only the last one waits in the scheduler.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(scheduler->GetQueueDepth(CallPriority::NORMAL) == 1);
+
+    promise.set_value();
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    std::map<WorkerId, uint32_t> tasksPerWorker;
+    for (auto& task : tasks) {
+        REQUIRE(task->numberOfExecutions == 1);
+        tasksPerWorker[task->lastExecutedWorkerId]++;
+    }
+    REQUIRE(tasksPerWorker[0] >= 2);
+    REQUIRE(tasksPerWorker[1] >= 2);
+}
+
+TEST_CASE("scheduler routes tasks for any worker around stuck workers", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 3;
+
+    WorkerClass pair;
+    pair.name = "pair";
+    pair.workers = 2;
+    settings.workerClasses = { pair };
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<18>>>(settings, [](WorkerId) {});
+
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    auto stuckTask = std::make_shared<TestTask>([blocker]() { blocker.wait(); });
+    scheduler->ScheduleOnWorker(1, stuckTask);
+    scheduler->SetWorkerStuck(1, true);
+    REQUIRE(scheduler->IsWorkerStuck(1));
+
+    std::vector<std::shared_ptr<TestTask>> classTasks;
+    for (size_t i = 0; i < 4; i++) {
+        auto task = std::make_shared<TestTask>();
+        classTasks.push_back(task);
+        scheduler->ScheduleOnWorkerClass(0, task);
+    }
+
+    auto preferred = std::make_shared<TestTask>();
+    scheduler->ScheduleOnPreferredWorker(1, preferred);
+
+    // Tasks for the worker itself still go to it.
+    auto explicitTask = std::make_shared<TestTask>();
+    scheduler->ScheduleOnWorker(1, explicitTask);
+
+    promise.set_value();
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    for (auto& task : classTasks) {
+        REQUIRE(task->numberOfExecutions == 1);
+        REQUIRE(task->lastExecutedWorkerId == 0);
+    }
+    REQUIRE(preferred->numberOfExecutions == 1);
+    REQUIRE(preferred->lastExecutedWorkerId != 1);
+    REQUIRE(explicitTask->lastExecutedWorkerId == 1);
+}
+
+TEST_CASE("scheduler routes tasks to worker classes", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 5;
+    settings.maxWorkers = 6;
+    settings.maxOldSpaceSize = 128;
+    settings.scheduler = SchedulerType::WORK_STEALING;
+
+    WorkerClass large;
+    large.name = "large";
+    large.workers = 2;
+    large.maxOldSpaceSize = 4096;
+    WorkerClass single;
+    single.name = "single";
+    single.maxOldSpaceSize = 1024;
+    settings.workerClasses = { large, single };
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<13>>>(settings, [](WorkerId) {});
+    REQUIRE(scheduler->GetWorkerClassWorkers() == 3);
+
+    // Class workers come first, with their own constraints.
+    REQUIRE(TestWorker<13>::maxOldSpaceSizes[0] == 4096);
+    REQUIRE(TestWorker<13>::maxOldSpaceSizes[1] == 4096);
+    REQUIRE(TestWorker<13>::maxOldSpaceSizes[2] == 1024);
+    REQUIRE(TestWorker<13>::maxOldSpaceSizes[3] == 128);
+    REQUIRE(TestWorker<13>::maxOldSpaceSizes[4] == 128);
+
+    REQUIRE(scheduler->FindWorkerClass("large", 5) == 0);
+    REQUIRE(scheduler->FindWorkerClass("single", 6) == 1);
+    REQUIRE(scheduler->FindWorkerClass("larger", 6) == -1);
+    REQUIRE(scheduler->FindWorkerClass("lar", 3) == -1);
+
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+
+    // A busy worker of a class makes the next task go to the other one.
+    auto first = std::make_shared<TestTask>([blocker]() { blocker.wait(); });
+    scheduler->ScheduleOnWorkerClass(0, first);
+    auto second = std::make_shared<TestTask>([blocker]() { blocker.wait(); });
+    scheduler->ScheduleOnWorkerClass(0, second);
+    auto third = std::make_shared<TestTask>();
+    scheduler->ScheduleOnWorkerClass(1, third);
+
+    promise.set_value();
+
+    // Resizing adds workers with the zone's constraints.
+    std::promise<void> resized;
+    scheduler->Resize(6, nullptr, [&resized]() { resized.set_value(); });
+    resized.get_future().wait();
+    REQUIRE(TestWorker<13>::maxOldSpaceSizes[5] == 128);
+
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    REQUIRE(first->numberOfExecutions == 1);
+    REQUIRE(second->numberOfExecutions == 1);
+    REQUIRE(first->lastExecutedWorkerId < 2);
+    REQUIRE(second->lastExecutedWorkerId < 2);
+    REQUIRE(first->lastExecutedWorkerId != second->lastExecutedWorkerId);
+    REQUIRE(third->lastExecutedWorkerId == 2);
+}
+
+TEST_CASE("earliest deadline scheduler serves queued tasks by deadline", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 1;
+    settings.scheduler = SchedulerType::EARLIEST_DEADLINE;
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<8>>>(settings, [](WorkerId) {});
+
+    // Keep the only worker busy, so all following tasks are queued.
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    scheduler->Schedule(std::make_shared<TestTask>([blocker]() { blocker.wait(); }));
+
+    std::mutex lock;
+    std::vector<int> order;
+    auto now = std::chrono::steady_clock::now();
+    auto enqueue = [&](int id, std::chrono::steady_clock::time_point deadline) {
+        auto task = std::make_shared<TestTask>([&lock, &order, id]() {
+            std::lock_guard<std::mutex> guard(lock);
+            order.push_back(id);
+        });
+        task->deadline = deadline;
+        scheduler->Schedule(task);
+        return task;
+    };
+
+    enqueue(0, std::chrono::steady_clock::time_point::max());
+    enqueue(3, now + std::chrono::hours(3));
+    enqueue(1, now + std::chrono::hours(1));
+    auto expired = enqueue(-1, now + std::chrono::milliseconds(1));
+    enqueue(2, now + std::chrono::hours(2));
+
+    // Tasks are queued asynchronously.
+    while (scheduler->GetQueueDepth(CallPriority::NORMAL) != 5) {
+        std::this_thread::yield();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    promise.set_value();
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    std::vector<int> expected = { 1, 2, 3, 0 };
+    REQUIRE(order == expected);
+    REQUIRE(expired->numberOfExecutions == 0);
+    REQUIRE(expired->cancelCode == NAPA_RESULT_TIMEOUT);
+}
+
+TEST_CASE("scheduler schedules a batch of tasks", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 3;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<9>>>(settings, [](WorkerId) {});
+
+    std::vector<std::shared_ptr<TestTask>> tasks;
+    std::vector<std::shared_ptr<Task>> batch;
+    for (size_t i = 0; i < 100; i++) {
+        auto task = std::make_shared<TestTask>();
+        tasks.push_back(task);
+        batch.push_back(task);
+    }
+
+    scheduler->ScheduleBatch(std::move(batch), CallPriority::BACKGROUND);
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    for (auto& task : tasks) {
+        REQUIRE(task->numberOfExecutions == 1);
+    }
+}
+
+TEST_CASE("scheduler grows and shrinks the number of workers", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 2;
+    settings.maxWorkers = 4;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<10>>>(settings, [](WorkerId) {});
+    REQUIRE(scheduler->GetWorkerCapacity() == 4);
+
+    auto resize = [&scheduler](uint32_t workers, std::vector<std::shared_ptr<TestTask>>* warmUpTasks) {
+        std::promise<void> promise;
+        scheduler->Resize(workers, [warmUpTasks](WorkerId) {
+            auto task = std::make_shared<TestTask>();
+            if (warmUpTasks != nullptr) {
+                warmUpTasks->push_back(task);
+            }
+            return std::vector<std::shared_ptr<Task>>{ task };
+        }, [&promise]() {
+            promise.set_value();
+        });
+        promise.get_future().wait();
+    };
+
+    auto runTasks = [&scheduler](size_t count) {
+        std::vector<std::shared_ptr<TestTask>> tasks;
+        std::atomic<size_t> finished(0);
+        for (size_t i = 0; i < count; i++) {
+            tasks.push_back(std::make_shared<TestTask>([&finished]() { finished++; }));
+            scheduler->Schedule(tasks.back());
+        }
+        while (finished < count) {
+            std::this_thread::yield();
+        }
+        return tasks;
+    };
+
+    std::vector<std::shared_ptr<TestTask>> warmUpTasks;
+    resize(4, &warmUpTasks);
+    REQUIRE(scheduler->GetWorkerCount() == 4);
+    REQUIRE(TestWorker<10>::aliveWorkers == 4);
+
+    // Each new worker ran its warm-up task.
+    REQUIRE(warmUpTasks.size() == 2);
+    while (warmUpTasks[0]->numberOfExecutions == 0 || warmUpTasks[1]->numberOfExecutions == 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(warmUpTasks[0]->lastExecutedWorkerId == 2);
+    REQUIRE(warmUpTasks[1]->lastExecutedWorkerId == 3);
+
+    runTasks(100);
+
+    resize(1, nullptr);
+    REQUIRE(scheduler->GetWorkerCount() == 1);
+    REQUIRE(TestWorker<10>::aliveWorkers == 1);
+
+    for (auto& task : runTasks(20)) {
+        REQUIRE(task->lastExecutedWorkerId == 0);
+    }
+
+    // Tasks scheduled on all workers go to the remaining ones only.
+    uint32_t workers = 0;
+    auto allWorkersTask = std::make_shared<TestTask>();
+    scheduler->ScheduleOnAllWorkers([&workers, &allWorkersTask](uint32_t count) {
+        workers = count;
+        return allWorkersTask;
+    });
+    REQUIRE(workers == 1);
+
+    resize(3, nullptr);
+    REQUIRE(scheduler->GetWorkerCount() == 3);
+    REQUIRE(TestWorker<10>::aliveWorkers == 3);
+    runTasks(50);
+
+    scheduler = nullptr;
+    REQUIRE(TestWorker<10>::aliveWorkers == 0);
+    REQUIRE(allWorkersTask->numberOfExecutions == 1);
+}
+
+TEST_CASE("scheduler keeps a pinned worker until it's unpinned", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 2;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<11>>>(settings, [](WorkerId) {});
+
+    scheduler->PinWorker(1);
+
+    std::promise<void> promise;
+    auto resized = promise.get_future();
+    scheduler->Resize(1, nullptr, [&promise]() {
+        promise.set_value();
+    });
+
+    REQUIRE(resized.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+    REQUIRE(scheduler->GetWorkerCount() == 1);
+    REQUIRE(TestWorker<11>::aliveWorkers == 2);
+
+    // A removed worker still takes tasks explicitly scheduled on it.
+    auto task = std::make_shared<TestTask>();
+    scheduler->ScheduleOnWorker(1, task);
+    scheduler->UnpinWorker(1);
+
+    resized.wait();
+    REQUIRE(task->numberOfExecutions == 1);
+    REQUIRE(task->lastExecutedWorkerId == 1);
+    REQUIRE(TestWorker<11>::aliveWorkers == 1);
+}
+
+TEST_CASE("scheduler rolls a task over all workers a few at a time", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 6;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<16>>>(settings, [](WorkerId) {});
+
+    std::atomic<uint32_t> running(0);
+    std::atomic<uint32_t> maxRunning(0);
+    auto task = std::make_shared<TestTask>([&running, &maxRunning]() {
+        auto current = ++running;
+        auto max = maxRunning.load();
+        while (current > max && !maxRunning.compare_exchange_weak(max, current)) {}
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        running--;
+    });
+
+    scheduler->ScheduleOnAllWorkers([&task](uint32_t) { return task; }, 2);
+
+    // Other workers keep running tasks meanwhile.
+    auto other = std::make_shared<TestTask>();
+    scheduler->Schedule(other);
+
+    // Draining waits for the task to reach all workers.
+    scheduler = nullptr;
+    REQUIRE(task->numberOfExecutions == settings.workers);
+    REQUIRE(maxRunning <= 2);
+    REQUIRE(other->numberOfExecutions == 1);
+}
+
+TEST_CASE("scheduler reports queue depth changes", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 1;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    std::mutex lock;
+    std::vector<size_t> depths;
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<12>>>(settings, [](WorkerId) {}, nullptr,
+        [&lock, &depths](CallPriority priority, size_t depth) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (priority == CallPriority::NORMAL) {
+                depths.push_back(depth);
+            }
+        });
+
+    // Keep the only worker busy, so the following tasks are queued.
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    scheduler->Schedule(std::make_shared<TestTask>([blocker]() { blocker.wait(); }), CallPriority::HIGH);
+    while (scheduler->GetIdleWorkerCount() != 0 || scheduler->GetQueueDepth(CallPriority::HIGH) != 0) {
+        std::this_thread::yield();
+    }
+
+    scheduler->Schedule(std::make_shared<TestTask>());
+    scheduler->Schedule(std::make_shared<TestTask>());
+    while (scheduler->GetQueueDepth(CallPriority::NORMAL) != 2) {
+        std::this_thread::yield();
+    }
+
+    promise.set_value();
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    std::vector<size_t> expected = { 1, 2, 1, 0 };
+    REQUIRE(depths == expected);
+}
+
+TEST_CASE("scheduler shares workers between tenants by weight", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 1;
+    settings.tenants = { Tenant{ "heavy", 2, 0 }, Tenant{ "light", 1, 0 } };
+
+    std::mutex lock;
+    std::map<std::string, size_t> queueTimes;
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<14>>>(settings, [](WorkerId) {}, nullptr, nullptr,
+        [&lock, &queueTimes](const std::string& tenant, std::chrono::nanoseconds) {
+            std::lock_guard<std::mutex> guard(lock);
+            queueTimes[tenant]++;
+        });
+
+    REQUIRE(scheduler->FindOrAddTenant("", 0) == 0);
+    REQUIRE(scheduler->FindOrAddTenant("heavy", 5) == 1);
+    REQUIRE(scheduler->FindOrAddTenant("light", 5) == 2);
+    REQUIRE(scheduler->FindOrAddTenant("other", 5) == 3);
+    REQUIRE(scheduler->FindOrAddTenant("other", 5) == 3);
+
+    // Keep the only worker busy, so all following tasks are queued.
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    scheduler->Schedule(std::make_shared<TestTask>([blocker]() { blocker.wait(); }));
+
+    std::vector<std::string> order;
+    auto enqueue = [&](const std::string& tenant) {
+        scheduler->Schedule(std::make_shared<TestTask>([&lock, &order, tenant]() {
+            std::lock_guard<std::mutex> guard(lock);
+            order.push_back(tenant);
+        }), CallPriority::NORMAL, scheduler->FindOrAddTenant(tenant.data(), tenant.size()));
+    };
+
+    // The heavy tenant floods the queue before the light one queues anything.
+    for (int i = 0; i < 4; i++) {
+        enqueue("heavy");
+    }
+    for (int i = 0; i < 3; i++) {
+        enqueue("light");
+    }
+    enqueue("other");
+
+    while (scheduler->GetQueueDepth(CallPriority::NORMAL) != 8) {
+        std::this_thread::yield();
+    }
+
+    promise.set_value();
+    scheduler = nullptr; // force draining all scheduled tasks
+
+    std::vector<std::string> expected = { "heavy", "heavy", "light", "other", "heavy", "heavy", "light", "light" };
+    REQUIRE(order == expected);
+    REQUIRE(queueTimes["heavy"] == 4);
+    REQUIRE(queueTimes["light"] == 3);
+    REQUIRE(queueTimes["other"] == 1);
+    REQUIRE(queueTimes.count("") == 0);
+}
+
+TEST_CASE("scheduler holds back tasks of a tenant at its concurrency cap", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 2;
+    settings.tenants = { Tenant{ "capped", 1, 1 } };
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<15>>>(settings, [](WorkerId) {});
+    auto tenant = scheduler->FindOrAddTenant("capped", 6);
+
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    scheduler->Schedule(std::make_shared<TestTask>([blocker]() { blocker.wait(); }), CallPriority::NORMAL, tenant);
+
+    // The second task of the tenant waits although a worker is idle, which runs a task without tenant meanwhile.
+    auto held = std::make_shared<TestTask>();
+    scheduler->Schedule(held, CallPriority::NORMAL, tenant);
+    auto other = std::make_shared<TestTask>();
+    scheduler->Schedule(other);
+
+    while (other->numberOfExecutions == 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(scheduler->GetQueueDepth(CallPriority::NORMAL) == 1);
+    REQUIRE(held->numberOfExecutions == 0);
+
+    // Finishing the running task of the tenant releases the held one.
+    promise.set_value();
+    while (held->numberOfExecutions == 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(scheduler->GetQueueDepth(CallPriority::NORMAL) == 0);
+}
+
+TEST_CASE("scheduler drains once queued and running tasks finished", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 1;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<19>>>(settings, [](WorkerId) {});
+
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    scheduler->Schedule(std::make_shared<TestTask>([blocker]() { blocker.wait(); }));
+    auto queued = std::make_shared<TestTask>();
+    scheduler->Schedule(queued);
+
+    std::promise<std::pair<bool, size_t>> drainPromise;
+    auto drained = drainPromise.get_future();
+    scheduler->Drain(std::chrono::steady_clock::time_point::max(), [&drainPromise](bool done, size_t cancelled) {
+        drainPromise.set_value(std::make_pair(done, cancelled));
+    });
+
+    REQUIRE(drained.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+
+    promise.set_value();
+    auto result = drained.get();
+    REQUIRE(result.first);
+    REQUIRE(result.second == 0);
+    REQUIRE(queued->numberOfExecutions == 1);
+}
+
+TEST_CASE("scheduler cancels tasks still queued when draining times out", "[scheduler]") {
+    ZoneSettings settings;
+    settings.workers = 1;
+
+    SECTION("synchronized") {
+        settings.scheduler = SchedulerType::SYNCHRONIZED;
+    }
+
+    SECTION("work-stealing") {
+        settings.scheduler = SchedulerType::WORK_STEALING;
+    }
+
+    auto scheduler = std::make_unique<SchedulerImpl<TestWorker<20>>>(settings, [](WorkerId) {});
+
+    std::promise<void> promise;
+    auto blocker = promise.get_future().share();
+    auto running = std::make_shared<TestTask>([blocker]() { blocker.wait(); });
+    scheduler->Schedule(running);
+    auto first = std::make_shared<TestTask>();
+    auto second = std::make_shared<TestTask>();
+    scheduler->Schedule(first);
+    scheduler->Schedule(second);
+
+    std::promise<std::pair<bool, size_t>> drainPromise;
+    auto drained = drainPromise.get_future();
+    scheduler->Drain(std::chrono::steady_clock::now() + std::chrono::milliseconds(20), [&drainPromise](bool done, size_t cancelled) {
+        drainPromise.set_value(std::make_pair(done, cancelled));
+    });
+
+    // The running task is not interrupted, only tasks waiting for a worker are cancelled.
+    auto result = drained.get();
+    REQUIRE(!result.first);
+    REQUIRE(result.second == 2);
+    REQUIRE(first->cancelCode == NAPA_RESULT_CANCELLED);
+    REQUIRE(second->cancelCode == NAPA_RESULT_CANCELLED);
+    REQUIRE(scheduler->GetQueueDepth(CallPriority::NORMAL) == 0);
+
+    promise.set_value();
+    scheduler = nullptr;
+    REQUIRE(running->numberOfExecutions == 1);
+    REQUIRE(first->numberOfExecutions == 0);
+    REQUIRE(second->numberOfExecutions == 0);
+}
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/scheduling-policy.h"
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+using namespace napa::settings;
+
+namespace {
+
+    const size_t LANES = 3;
+    const uint32_t CAPACITY = 4;
+
+    class TestTask : public Task {
+    public:
+        explicit TestTask(int id) : id(id) {}
+
+        void Execute() override {}
+
+        int id;
+    };
+
+    int Id(const std::shared_ptr<Task>& task) {
+        return std::static_pointer_cast<TestTask>(task)->id;
+    }
+
+    /// <summary> The policies that ship in-tree, each of which must pass the conformance tests. </summary>
+    std::vector<SchedulerType> AllPolicies() {
+        return { SchedulerType::SYNCHRONIZED, SchedulerType::WORK_STEALING, SchedulerType::EARLIEST_DEADLINE };
+    }
+}
+
+TEST_CASE("scheduling policies are created by scheduler type", "[scheduling-policy]") {
+    auto fifo = CreateSchedulingPolicy(SchedulerType::SYNCHRONIZED, LANES, CAPACITY);
+    REQUIRE(dynamic_cast<FifoPolicy*>(fifo.get()) != nullptr);
+    REQUIRE(fifo->IsSynchronized());
+    REQUIRE(fifo->SharesByTenant());
+
+    auto stealing = CreateSchedulingPolicy(SchedulerType::WORK_STEALING, LANES, CAPACITY);
+    REQUIRE(dynamic_cast<WorkStealingPolicy*>(stealing.get()) != nullptr);
+    REQUIRE_FALSE(stealing->IsSynchronized());
+
+    auto deadline = CreateSchedulingPolicy(SchedulerType::EARLIEST_DEADLINE, LANES, CAPACITY);
+    REQUIRE(dynamic_cast<DeadlinePolicy*>(deadline.get()) != nullptr);
+    REQUIRE(deadline->DropsExpiredTasks());
+}
+
+TEST_CASE("scheduling policies hand out each queued task exactly once", "[scheduling-policy]") {
+    for (auto type : AllPolicies()) {
+        INFO("scheduler type " << static_cast<int>(type));
+        auto policy = CreateSchedulingPolicy(type, LANES, CAPACITY);
+
+        size_t lane = LANES;
+        REQUIRE(policy->PickNext(0, CAPACITY, lane) == nullptr);
+
+        for (int i = 0; i < 40; i++) {
+            policy->Enqueue(i % LANES, 0, i % CAPACITY, std::make_shared<TestTask>(i));
+        }
+
+        std::set<int> picked;
+        for (int i = 0; i < 40; i++) {
+            auto task = policy->PickNext(i % CAPACITY, CAPACITY, lane);
+            REQUIRE(task != nullptr);
+            REQUIRE(lane == static_cast<size_t>(Id(task)) % LANES);
+            picked.insert(Id(task));
+        }
+        REQUIRE(picked.size() == 40);
+        REQUIRE(policy->PickNext(0, CAPACITY, lane) == nullptr);
+    }
+}
+
+TEST_CASE("scheduling policies hand out higher priority lanes first", "[scheduling-policy]") {
+    for (auto type : AllPolicies()) {
+        INFO("scheduler type " << static_cast<int>(type));
+        auto policy = CreateSchedulingPolicy(type, LANES, CAPACITY);
+
+        policy->Enqueue(2, 0, 0, std::make_shared<TestTask>(0));
+        policy->Enqueue(1, 0, 1, std::make_shared<TestTask>(1));
+        policy->Enqueue(0, 0, 2, std::make_shared<TestTask>(2));
+
+        // Higher priority tasks win even when they are queued on another worker.
+        size_t lane;
+        for (size_t expected = 0; expected < LANES; expected++) {
+            auto task = policy->PickNext(0, CAPACITY, lane);
+            REQUIRE(task != nullptr);
+            REQUIRE(lane == expected);
+        }
+    }
+}
+
+TEST_CASE("scheduling policies keep FIFO order of a worker's tasks of equal priority and deadline", "[scheduling-policy]") {
+    for (auto type : AllPolicies()) {
+        INFO("scheduler type " << static_cast<int>(type));
+        auto policy = CreateSchedulingPolicy(type, LANES, CAPACITY);
+
+        for (int i = 0; i < 10; i++) {
+            policy->Enqueue(1, 0, 0, std::make_shared<TestTask>(i));
+        }
+
+        size_t lane;
+        for (int i = 0; i < 10; i++) {
+            auto task = policy->PickNext(0, CAPACITY, lane);
+            REQUIRE(task != nullptr);
+            REQUIRE(Id(task) == i);
+        }
+    }
+}
+
+TEST_CASE("unsynchronized scheduling policies can be called from any thread", "[scheduling-policy]") {
+    for (auto type : AllPolicies()) {
+        auto policy = CreateSchedulingPolicy(type, LANES, CAPACITY);
+        if (policy->IsSynchronized()) {
+            continue;
+        }
+        INFO("scheduler type " << static_cast<int>(type));
+
+        const int tasksPerThread = 1000;
+        std::atomic<int> picked(0);
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < CAPACITY; t++) {
+            threads.emplace_back([&policy, &picked, t]() {
+                size_t lane;
+                for (int i = 0; i < tasksPerThread; i++) {
+                    policy->Enqueue(i % LANES, 0, t, std::make_shared<TestTask>(i));
+                    if (policy->PickNext(t, CAPACITY, lane) != nullptr) {
+                        picked++;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        size_t lane;
+        while (policy->PickNext(0, CAPACITY, lane) != nullptr) {
+            picked++;
+        }
+        REQUIRE(picked == tasksPerThread * static_cast<int>(CAPACITY));
+    }
+}
+
+TEST_CASE("work stealing policy steals from the back of a peer's queue", "[scheduling-policy]") {
+    WorkStealingPolicy policy(LANES, CAPACITY);
+    for (int i = 0; i < 3; i++) {
+        policy.Enqueue(1, 0, 2, std::make_shared<TestTask>(i));
+    }
+
+    size_t lane;
+    REQUIRE(Id(policy.PickNext(0, CAPACITY, lane)) == 2);
+    REQUIRE(Id(policy.PickNext(2, CAPACITY, lane)) == 0);
+}
+
+TEST_CASE("deadline policy hands out tasks by deadline", "[scheduling-policy]") {
+    class DeadlineTask : public TestTask {
+    public:
+        DeadlineTask(int id, std::chrono::steady_clock::time_point deadline) : TestTask(id), _deadline(deadline) {}
+
+        std::chrono::steady_clock::time_point GetDeadline() const override {
+            return _deadline;
+        }
+
+    private:
+        std::chrono::steady_clock::time_point _deadline;
+    };
+
+    DeadlinePolicy policy(LANES);
+    auto now = std::chrono::steady_clock::now();
+    policy.Enqueue(1, 0, 0, std::make_shared<TestTask>(0));
+    policy.Enqueue(1, 0, 0, std::make_shared<DeadlineTask>(1, now + std::chrono::seconds(2)));
+    policy.Enqueue(1, 0, 0, std::make_shared<DeadlineTask>(2, now + std::chrono::seconds(1)));
+
+    size_t lane;
+    REQUIRE(Id(policy.PickNext(0, CAPACITY, lane)) == 2);
+    REQUIRE(Id(policy.PickNext(0, CAPACITY, lane)) == 1);
+    REQUIRE(Id(policy.PickNext(0, CAPACITY, lane)) == 0);
+}
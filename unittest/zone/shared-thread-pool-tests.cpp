@@ -0,0 +1,178 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/shared-thread-pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Runs a function on each turn, counting turns and checking it never runs on two threads at once. </summary>
+    class TestRunnable : public SharedThreadPool::Runnable {
+    public:
+        explicit TestRunnable(std::function<bool()> turn = nullptr) : _turn(std::move(turn)) {}
+
+        bool Run() override {
+            if (running.exchange(true)) {
+                overlapped = true;
+            }
+            auto more = _turn ? _turn() : false;
+            turns++;
+            running = false;
+            return more;
+        }
+
+        std::atomic<uint32_t> turns { 0 };
+        std::atomic<bool> running { false };
+        std::atomic<bool> overlapped { false };
+
+    private:
+        std::function<bool()> _turn;
+    };
+
+    bool WaitFor(std::function<bool()> condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+TEST_CASE("shared thread pool runs more runnables than threads", "[shared-thread-pool]") {
+    SharedThreadPool pool(2, 0);
+    REQUIRE(pool.GetThreadCount() == 2);
+
+    std::atomic<uint32_t> running(0);
+    std::atomic<uint32_t> maxRunning(0);
+    std::vector<std::shared_ptr<TestRunnable>> runnables;
+    for (int i = 0; i < 16; i++) {
+        auto remaining = std::make_shared<std::atomic<int>>(10);
+        runnables.emplace_back(std::make_shared<TestRunnable>([&running, &maxRunning, remaining]() {
+            auto current = ++running;
+            auto max = maxRunning.load();
+            while (current > max && !maxRunning.compare_exchange_weak(max, current)) {}
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            running--;
+            return --*remaining > 0;
+        }));
+    }
+    for (auto& runnable : runnables) {
+        pool.Notify(runnable);
+    }
+
+    auto done = WaitFor([&runnables]() {
+        for (auto& runnable : runnables) {
+            if (runnable->turns < 10) {
+                return false;
+            }
+        }
+        return true;
+    });
+    REQUIRE(done);
+    REQUIRE(maxRunning <= 2);
+    for (auto& runnable : runnables) {
+        REQUIRE(runnable->turns == 10);
+        REQUIRE_FALSE(runnable->overlapped);
+    }
+}
+
+TEST_CASE("shared thread pool gives a runnable notified during its turn another turn", "[shared-thread-pool]") {
+    SharedThreadPool pool(2, 0);
+
+    std::promise<void> entered;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    auto first = true;
+    auto runnable = std::make_shared<TestRunnable>([&]() {
+        if (first) {
+            first = false;
+            entered.set_value();
+            released.wait();
+        }
+        return false;
+    });
+
+    pool.Notify(runnable);
+    entered.get_future().wait();
+
+    // Notified twice while running, which adds a single turn.
+    pool.Notify(runnable);
+    pool.Notify(runnable);
+    release.set_value();
+
+    auto done = WaitFor([&runnable]() { return runnable->turns == 2; });
+    REQUIRE(done);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(runnable->turns == 2);
+}
+
+TEST_CASE("shared thread pool runs a runnable on the thread of its last turn", "[shared-thread-pool]") {
+    SharedThreadPool pool(4, 0);
+
+    std::vector<std::thread::id> threads;
+    auto runnable = std::make_shared<TestRunnable>([&threads]() {
+        threads.push_back(std::this_thread::get_id());
+        return false;
+    });
+
+    for (uint32_t i = 0; i < 20; i++) {
+        pool.Notify(runnable);
+        auto done = WaitFor([&runnable, i]() { return runnable->turns == i + 1 && !runnable->running; });
+        REQUIRE(done);
+
+        // The thread goes idle after the turn, a busy one would have its runnables taken over.
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    REQUIRE(pool.GetMigrations() == 0);
+    for (auto& thread : threads) {
+        REQUIRE(thread == threads[0]);
+    }
+}
+
+TEST_CASE("shared thread pool moves a runnable off its busy thread to an idle one", "[shared-thread-pool]") {
+    SharedThreadPool pool(2, 0);
+
+    // Placed round-robin: blocker on thread 0, other on thread 1, moved on thread 0 which is busy.
+    std::promise<void> entered;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    auto blocker = std::make_shared<TestRunnable>([&]() {
+        entered.set_value();
+        released.wait();
+        return false;
+    });
+    auto other = std::make_shared<TestRunnable>();
+    auto moved = std::make_shared<TestRunnable>();
+
+    pool.Notify(blocker);
+    entered.get_future().wait();
+
+    pool.Notify(other);
+    auto ran = WaitFor([&other]() { return other->turns == 1 && !other->running; });
+    REQUIRE(ran);
+
+    pool.Notify(moved);
+    ran = WaitFor([&moved]() { return moved->turns == 1; });
+    REQUIRE(ran);
+    REQUIRE(blocker->turns == 0);
+    REQUIRE(pool.GetMigrations() == 1);
+
+    release.set_value();
+    ran = WaitFor([&blocker]() { return blocker->turns == 1; });
+    REQUIRE(ran);
+}
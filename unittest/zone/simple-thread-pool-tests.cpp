@@ -0,0 +1,181 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <zone/simple-thread-pool.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> The thread pool as it was before jobs were kept in a lock-free ring, as a baseline. </summary>
+    class LockedThreadPool {
+    public:
+        explicit LockedThreadPool(uint32_t numberOfWorkers) : _isStopped(false) {
+            for (uint32_t i = 0; i < numberOfWorkers; ++i) {
+                _workers.emplace_back([this]() {
+                    std::function<void()> job;
+                    while (true) {
+                        {
+                            std::unique_lock<std::mutex> lock(_queueLock);
+                            _queueCondition.wait(lock, [this]() { return _isStopped || !_queue.empty(); });
+                            if (_isStopped && _queue.empty()) {
+                                break;
+                            }
+                            job = std::move(_queue.front());
+                            _queue.pop();
+                        }
+                        job();
+                    }
+                });
+            }
+        }
+
+        ~LockedThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(_queueLock);
+                _isStopped = true;
+            }
+            _queueCondition.notify_all();
+            for (auto& thread : _workers) {
+                thread.join();
+            }
+        }
+
+        template <typename T, typename... Args>
+        void Execute(T&& function, Args&&... args) {
+            auto job = std::bind(std::forward<T>(function), std::forward<Args>(args)...);
+            {
+                std::lock_guard<std::mutex> lock(_queueLock);
+                _queue.emplace(job);
+            }
+            _queueCondition.notify_one();
+        }
+
+    private:
+        std::vector<std::thread> _workers;
+        std::queue<std::function<void()>> _queue;
+        std::mutex _queueLock;
+        std::condition_variable _queueCondition;
+        bool _isStopped;
+    };
+
+    /// <summary> Executes jobs capturing a shared_ptr from a few producers, like the scheduler does, and returns the time taken. </summary>
+    template <typename Pool>
+    std::chrono::microseconds RunJobs(Pool& pool, size_t producers, size_t jobsPerProducer) {
+        std::atomic<size_t> done(0);
+        std::promise<void> finished;
+        auto total = producers * jobsPerProducer;
+        auto payload = std::make_shared<int>(1);
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&]() {
+                for (size_t i = 0; i < jobsPerProducer; ++i) {
+                    pool.Execute([&done, &finished, total, payload]() {
+                        if (done.fetch_add(static_cast<size_t>(*payload)) + 1 == total) {
+                            finished.set_value();
+                        }
+                    });
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        finished.get_future().wait();
+
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    }
+}
+
+TEST_CASE("simple thread pool runs jobs in order with a single worker", "[simple-thread-pool]") {
+    std::vector<int> order;
+    std::promise<void> finished;
+    {
+        // A small ring, so jobs overflow and come back from the overflow queue in order.
+        SimpleThreadPool pool(1, 4);
+        for (int i = 0; i < 100; ++i) {
+            pool.Execute([&order, i]() { order.push_back(i); });
+        }
+        pool.Execute([&finished]() { finished.set_value(); });
+        finished.get_future().wait();
+    }
+
+    REQUIRE(order.size() == 100);
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(order[i] == i);
+    }
+}
+
+TEST_CASE("simple thread pool runs jobs from many producers on many workers", "[simple-thread-pool]") {
+    SimpleThreadPool pool(4, 16);
+    REQUIRE(RunJobs(pool, 4, 10000).count() >= 0);
+}
+
+TEST_CASE("simple thread pool runs move-only jobs", "[simple-thread-pool]") {
+    std::promise<int> result;
+    {
+        SimpleThreadPool pool(1);
+        auto value = std::make_unique<int>(42);
+        pool.Execute([value = std::move(value), &result]() { result.set_value(*value); });
+    }
+    REQUIRE(result.get_future().get() == 42);
+}
+
+TEST_CASE("simple thread pool drains jobs before it's destroyed", "[simple-thread-pool]") {
+    std::atomic<int> count(0);
+    {
+        SimpleThreadPool pool(2, 8);
+        for (int i = 0; i < 1000; ++i) {
+            pool.Execute([&count]() { count++; });
+        }
+    }
+    REQUIRE(count == 1000);
+}
+
+TEST_CASE("simple thread pool wakes up parked workers", "[simple-thread-pool]") {
+    SimpleThreadPool pool(2);
+    for (int i = 0; i < 3; ++i) {
+        // Let workers park before each job.
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        std::promise<void> done;
+        pool.Execute([&done]() { done.set_value(); });
+        REQUIRE(done.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    }
+}
+
+// Hidden microbenchmark, run with: napa-unittest "[simple-thread-pool-benchmark]"
+TEST_CASE("simple thread pool benchmark", "[.][simple-thread-pool-benchmark]") {
+    const size_t jobsPerProducer = 200000;
+
+    for (uint32_t workers : { 1u, 4u }) {
+        for (size_t producers : { static_cast<size_t>(1), static_cast<size_t>(4) }) {
+            LockedThreadPool baseline(workers);
+            auto baselineTime = RunJobs(baseline, producers, jobsPerProducer);
+
+            SimpleThreadPool pool(workers);
+            auto poolTime = RunJobs(pool, producers, jobsPerProducer);
+
+            auto jobs = producers * jobsPerProducer;
+            WARN(workers << " worker(s), " << producers << " producer(s): "
+                << "std::function and mutex " << baselineTime.count() * 1000 / jobs << " ns/job, "
+                << "ring of UniqueFunction " << poolTime.count() * 1000 / jobs << " ns/job");
+        }
+    }
+}
@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/slow-call-log.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Ends of phases in milliseconds, -1 for phases not reached. </summary>
+    PhaseEnds MakeEnds(std::initializer_list<int64_t> milliseconds) {
+        PhaseEnds ends;
+        size_t i = 0;
+        for (auto end : milliseconds) {
+            ends[i++] = end < 0 ? -1 : std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::milliseconds(end)).count();
+        }
+        return ends;
+    }
+
+    void Record(SlowCallLog& log, const char* function, const PhaseEnds& ends, bool sampled = false, const std::vector<StringRef>& arguments = {}) {
+        log.Record("module", function, 1, NAPA_RESULT_SUCCESS, sampled, Clock::Now(), ends, arguments);
+    }
+
+    const uint64_t MS = 1000000;
+}
+
+TEST_CASE("slow-call log keeps calls beyond the threshold with their phases", "[slow-call-log]") {
+    SlowCallLog log(std::chrono::milliseconds(10), 0, 10, 0);
+
+    Record(log, "fast", MakeEnds({ 1, 2, 3, 4, 5 }));
+    Record(log, "slow", MakeEnds({ 2, 3, 10, 11, 13 }));
+
+    auto calls = log.GetCalls();
+    REQUIRE(calls.size() == 1);
+    REQUIRE(calls[0].function == "slow");
+    REQUIRE(calls[0].workerId == 1);
+    REQUIRE(!calls[0].sampled);
+    REQUIRE(calls[0].queueTime == 2 * MS);
+    REQUIRE(calls[0].unmarshallTime == 1 * MS);
+    REQUIRE(calls[0].executionTime == 7 * MS);
+    REQUIRE(calls[0].marshallTime == 1 * MS);
+    REQUIRE(calls[0].completionTime == 2 * MS);
+
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    REQUIRE(calls[0].startTime <= static_cast<uint64_t>(now));
+    REQUIRE(calls[0].startTime + 1000000 > static_cast<uint64_t>(now));
+}
+
+TEST_CASE("slow-call log ends phases not reached with the next one", "[slow-call-log]") {
+    SlowCallLog log(std::chrono::milliseconds(1), 0, 10, 0);
+
+    // Marshalled in JavaScript, unmarshall and marshall are part of the execution.
+    Record(log, "javascript", MakeEnds({ 2, -1, -1, 10, 12 }));
+
+    // Timed out while queued.
+    Record(log, "queued", MakeEnds({ -1, -1, -1, 20, 21 }));
+
+    auto calls = log.GetCalls();
+    REQUIRE(calls.size() == 2);
+    REQUIRE(calls[0].queueTime == 2 * MS);
+    REQUIRE(calls[0].unmarshallTime == 0);
+    REQUIRE(calls[0].executionTime == 8 * MS);
+    REQUIRE(calls[0].marshallTime == 0);
+    REQUIRE(calls[0].completionTime == 2 * MS);
+
+    REQUIRE(calls[1].queueTime == 20 * MS);
+    REQUIRE(calls[1].executionTime == 0);
+    REQUIRE(calls[1].completionTime == 1 * MS);
+}
+
+TEST_CASE("slow-call log samples 1 in N calls", "[slow-call-log]") {
+    SlowCallLog log(std::chrono::milliseconds(0), 3, 10, 0);
+
+    std::vector<bool> sampled;
+    for (int i = 0; i < 6; ++i) {
+        sampled.push_back(log.Sample());
+    }
+    REQUIRE(sampled == std::vector<bool>({ true, false, false, true, false, false }));
+
+    Record(log, "unsampled", MakeEnds({ 1, 2, 300, 301, 302 }));
+    Record(log, "sampled", MakeEnds({ 1, 2, 3, 4, 5 }), true);
+    auto calls = log.GetCalls();
+    REQUIRE(calls.size() == 1);
+    REQUIRE(calls[0].function == "sampled");
+    REQUIRE(calls[0].sampled);
+
+    SlowCallLog disabled(std::chrono::milliseconds(10), 0, 10, 0);
+    REQUIRE(!disabled.Sample());
+}
+
+TEST_CASE("slow-call log keeps the most recent calls with the start of their arguments", "[slow-call-log]") {
+    SlowCallLog log(std::chrono::milliseconds(1), 0, 3, 5);
+
+    std::vector<StringRef> arguments = { NAPA_STRING_REF("\"abc\""), NAPA_STRING_REF("1234"), NAPA_STRING_REF("5") };
+    for (int i = 0; i < 5; ++i) {
+        Record(log, std::to_string(i).c_str(), MakeEnds({ 1, 2, 3, 4, 5 }), false, arguments);
+    }
+
+    auto calls = log.GetCalls();
+    REQUIRE(calls.size() == 3);
+    REQUIRE(calls[0].function == "2");
+    REQUIRE(calls[2].function == "4");
+    REQUIRE(calls[0].argumentSizes == std::vector<size_t>({ 5, 4, 1 }));
+    REQUIRE(calls[0].arguments == std::vector<std::string>({ "\"abc\"", "", "" }));
+
+    SlowCallLog sizesOnly(std::chrono::milliseconds(1), 0, 3, 0);
+    Record(sizesOnly, "f", MakeEnds({ 1, 2, 3, 4, 5 }), false, arguments);
+    REQUIRE(sizesOnly.GetCalls()[0].argumentSizes.size() == 3);
+    REQUIRE(sizesOnly.GetCalls()[0].arguments.empty());
+}
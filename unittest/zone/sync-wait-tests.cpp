@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/sync-wait.h"
+
+#include <memory>
+#include <thread>
+
+using namespace napa::zone;
+
+TEST_CASE("sync result is waited for until it's set from another thread", "[sync-wait]") {
+    auto syncResult = std::make_shared<SyncResult<int>>();
+    std::thread setter([syncResult]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        syncResult->Set(42);
+    });
+
+    int result = 0;
+    std::chrono::nanoseconds waitTime;
+    REQUIRE(syncResult->Wait(std::chrono::milliseconds(0), result, waitTime));
+    REQUIRE(result == 42);
+    REQUIRE(waitTime > std::chrono::milliseconds(0));
+
+    setter.join();
+}
+
+TEST_CASE("sync result times out when it's not set in time", "[sync-wait]") {
+    SyncResult<int> syncResult;
+
+    int result = 0;
+    std::chrono::nanoseconds waitTime;
+    REQUIRE(!syncResult.Wait(std::chrono::milliseconds(30), result, waitTime));
+    REQUIRE(result == 0);
+    REQUIRE(waitTime >= std::chrono::milliseconds(30));
+}
+
+TEST_CASE("sync result runs pending work of the waiting thread", "[sync-wait]") {
+    SyncResult<int> syncResult;
+
+    // The result is set by work posted to the waiting thread, which would deadlock a blocking wait.
+    int runs = 0;
+    SetPendingWork([&syncResult, &runs]() {
+        if (++runs == 3) {
+            syncResult.Set(42);
+        }
+    });
+
+    int result = 0;
+    std::chrono::nanoseconds waitTime;
+    auto done = syncResult.Wait(std::chrono::milliseconds(1000), result, waitTime);
+    SetPendingWork(nullptr);
+
+    REQUIRE(done);
+    REQUIRE(result == 42);
+    REQUIRE(runs == 3);
+}
@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/task-graph.h"
+
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> Outcome of a graph, waited on by the test. </summary>
+    struct Outcome {
+        std::promise<void> done;
+        std::vector<Result> results;
+        uint32_t failedNode = 0;
+
+        TaskGraph::CompletionCallback GetCallback() {
+            return [this](std::vector<Result> results, uint32_t failedNode) {
+                this->results = std::move(results);
+                this->failedNode = failedNode;
+                done.set_value();
+            };
+        }
+
+        void Wait() {
+            REQUIRE(done.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+        }
+    };
+
+    /// <summary> Each node returns its index followed by its inputs in parentheses, e.g. "3(1,2)". </summary>
+    Result Concatenate(uint32_t node, const TaskGraph::Inputs& inputs) {
+        Result result;
+        result.code = NAPA_RESULT_SUCCESS;
+        result.returnValue = std::to_string(node);
+        if (!inputs.empty()) {
+            result.returnValue += "(";
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                result.returnValue += (i == 0 ? "" : ",") + inputs[i]->returnValue;
+            }
+            result.returnValue += ")";
+        }
+        return result;
+    }
+}
+
+TEST_CASE("task graph validates edges", "[task-graph]") {
+    std::string error;
+    REQUIRE(TaskGraph::Validate(0, {}, error));
+    REQUIRE(TaskGraph::Validate(4, { { 0, 1 }, { 0, 2 }, { 1, 3 }, { 2, 3 } }, error));
+
+    REQUIRE(!TaskGraph::Validate(2, { { 0, 2 } }, error));
+    REQUIRE(error == "Edge [0, 2] refers to a node out of 2 nodes");
+
+    REQUIRE(!TaskGraph::Validate(4, { { 0, 1 }, { 1, 2 }, { 2, 1 }, { 2, 3 } }, error));
+    REQUIRE(error == "Node 1 depends on itself through a cycle of edges");
+
+    REQUIRE(!TaskGraph::Validate(1, { { 0, 0 } }, error));
+}
+
+TEST_CASE("task graph passes results along edges in order", "[task-graph]") {
+    Outcome outcome;
+    std::vector<uint32_t> started;
+    std::mutex lock;
+
+    // Nodes complete on threads of their own, like calls completing on zone workers.
+    std::vector<std::thread> threads;
+    auto graph = std::make_shared<TaskGraph>(5, std::vector<TaskGraph::Edge>({ { 0, 2 }, { 1, 2 }, { 2, 4 }, { 3, 4 }, { 0, 4 } }),
+        [&](uint32_t node, const TaskGraph::Inputs& inputs, ExecuteCallback callback) {
+            std::lock_guard<std::mutex> guard(lock);
+            started.push_back(node);
+            auto result = std::make_shared<Result>(Concatenate(node, inputs));
+            threads.emplace_back([result, callback]() {
+                callback(std::move(*result));
+            });
+        },
+        outcome.GetCallback());
+    graph->Run();
+    outcome.Wait();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    REQUIRE(outcome.failedNode == TaskGraph::NO_FAILURE);
+    REQUIRE(outcome.results.size() == 5);
+    REQUIRE(outcome.results[2].returnValue == "2(0,1)");
+    REQUIRE(outcome.results[4].returnValue == "4(2(0,1),3,0)");
+    REQUIRE(started.size() == 5);
+}
+
+TEST_CASE("task graph skips nodes after a failure", "[task-graph]") {
+    Outcome outcome;
+    std::vector<uint32_t> started;
+
+    // Node 1 fails, node 0 finishes after it, and nodes 2 and 3 depend on node 1.
+    ExecuteCallback finishRoot;
+    auto graph = std::make_shared<TaskGraph>(4, std::vector<TaskGraph::Edge>({ { 1, 2 }, { 2, 3 }, { 0, 3 } }),
+        [&](uint32_t node, const TaskGraph::Inputs& /*inputs*/, ExecuteCallback callback) {
+            started.push_back(node);
+            if (node == 0) {
+                finishRoot = std::move(callback);
+                return;
+            }
+            Result result;
+            result.code = NAPA_RESULT_EXECUTE_FUNC_ERROR;
+            result.errorMessage = "failed";
+            callback(std::move(result));
+        },
+        outcome.GetCallback());
+    graph->Run();
+
+    REQUIRE(started == std::vector<uint32_t>({ 0, 1 }));
+    finishRoot(Concatenate(0, {}));
+    outcome.Wait();
+
+    REQUIRE(outcome.failedNode == 1);
+    REQUIRE(outcome.results[0].code == NAPA_RESULT_SUCCESS);
+    REQUIRE(outcome.results[1].errorMessage == "failed");
+    REQUIRE(outcome.results[2].code == NAPA_RESULT_CANCELLED);
+    REQUIRE(outcome.results[3].errorMessage == "Skipped since node 1 failed");
+    REQUIRE(started.size() == 2);
+}
+
+TEST_CASE("task graph of no nodes completes right away", "[task-graph]") {
+    Outcome outcome;
+    auto graph = std::make_shared<TaskGraph>(0, std::vector<TaskGraph::Edge>(),
+        [](uint32_t, const TaskGraph::Inputs&, ExecuteCallback) {},
+        outcome.GetCallback());
+    graph->Run();
+    outcome.Wait();
+    REQUIRE(outcome.results.empty());
+    REQUIRE(outcome.failedNode == TaskGraph::NO_FAILURE);
+}
@@ -0,0 +1,214 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <zone/task-queue.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace napa::zone;
+
+namespace {
+    class OrderedTask : public Task {
+    public:
+        OrderedTask(size_t order = 0) : order(order) {}
+
+        void Execute() override {}
+
+        size_t order;
+    };
+
+    size_t OrderOf(const std::shared_ptr<Task>& task) {
+        return std::static_pointer_cast<OrderedTask>(task)->order;
+    }
+}
+
+TEST_CASE("task queue pops tasks in FIFO order", "[task-queue]") {
+    TaskQueue queue(4);
+    std::shared_ptr<Task> task;
+
+    REQUIRE(queue.TryPop(task) == false);
+
+    for (size_t i = 0; i < 3; ++i) {
+        queue.Push(std::make_shared<OrderedTask>(i));
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(queue.TryPop(task));
+        REQUIRE(OrderOf(task) == i);
+    }
+    REQUIRE(queue.TryPop(task) == false);
+}
+
+TEST_CASE("task queue keeps tasks that exceed ring capacity", "[task-queue]") {
+    TaskQueue queue(2);
+
+    for (size_t i = 0; i < 10; ++i) {
+        queue.Push(std::make_shared<OrderedTask>(i));
+    }
+
+    std::shared_ptr<Task> task;
+    size_t count = 0;
+    while (queue.TryPop(task)) {
+        ++count;
+    }
+    REQUIRE(count == 10);
+}
+
+TEST_CASE("task queue keeps FIFO order while tasks overflow", "[task-queue]") {
+    TaskQueue queue(2);
+    std::shared_ptr<Task> task;
+
+    // The third task overflows, the fourth must not take the slot freed in the ring ahead of it.
+    for (size_t i = 0; i < 3; ++i) {
+        queue.Push(std::make_shared<OrderedTask>(i));
+    }
+    REQUIRE(queue.TryPop(task));
+    REQUIRE(OrderOf(task) == 0);
+    queue.Push(std::make_shared<OrderedTask>(3));
+
+    for (size_t i = 1; i < 4; ++i) {
+        REQUIRE(queue.TryPop(task));
+        REQUIRE(OrderOf(task) == i);
+    }
+
+    // The ring is used again once the overflow drained.
+    queue.Push(std::make_shared<OrderedTask>(4));
+    queue.Push(std::make_shared<OrderedTask>(5));
+    std::vector<std::shared_ptr<Task>> tasks;
+    REQUIRE(queue.TryPopBatch(tasks, 16) == 2);
+    REQUIRE(OrderOf(tasks[0]) == 4);
+    REQUIRE(OrderOf(tasks[1]) == 5);
+    REQUIRE(queue.TryPop(task) == false);
+}
+
+TEST_CASE("task queue pops tasks in batches", "[task-queue]") {
+    TaskQueue queue(4);
+
+    // Tasks beyond the ring capacity overflow, a batch takes them after the ring.
+    for (size_t i = 0; i < 10; ++i) {
+        queue.Push(std::make_shared<OrderedTask>(i));
+    }
+
+    std::vector<std::shared_ptr<Task>> tasks;
+    REQUIRE(queue.TryPopBatch(tasks, 3) == 3);
+    REQUIRE(queue.TryPopBatch(tasks, 16) == 7);
+    REQUIRE(tasks.size() == 10);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        REQUIRE(OrderOf(tasks[i]) == i);
+    }
+
+    REQUIRE(queue.TryPopBatch(tasks, 16) == 0);
+    REQUIRE(queue.Size() == 0);
+}
+
+TEST_CASE("task queue accepts tasks from multiple producers", "[task-queue]") {
+    TaskQueue queue(64);
+    constexpr size_t producers = 4;
+    constexpr size_t tasksPerProducer = 10000;
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue]() {
+            for (size_t i = 0; i < tasksPerProducer; ++i) {
+                queue.Push(std::make_shared<OrderedTask>(i));
+            }
+        });
+    }
+
+    size_t count = 0;
+    while (count < producers * tasksPerProducer) {
+        auto task = queue.Pop();
+        REQUIRE(task != nullptr);
+        ++count;
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::shared_ptr<Task> task;
+    REQUIRE(queue.TryPop(task) == false);
+}
+
+TEST_CASE("task queue parks consumer until a task is pushed", "[task-queue]") {
+    TaskQueue queue;
+
+    auto consumer = std::async(std::launch::async, [&queue]() {
+        return queue.Pop();
+    });
+
+    REQUIRE(consumer.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+
+    queue.Push(std::make_shared<OrderedTask>(7));
+    auto task = consumer.get();
+    REQUIRE(task != nullptr);
+    REQUIRE(OrderOf(task) == 7);
+}
+
+TEST_CASE("task queue spins for a task before giving up", "[task-queue]") {
+    TaskQueue queue;
+    std::shared_ptr<Task> task;
+
+    REQUIRE(queue.TrySpinPop(task, std::chrono::microseconds(100)) == false);
+
+    auto producer = std::async(std::launch::async, [&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        queue.Push(std::make_shared<OrderedTask>(3));
+    });
+
+    REQUIRE(queue.TrySpinPop(task, std::chrono::seconds(10)));
+    REQUIRE(OrderOf(task) == 3);
+    producer.get();
+}
+
+TEST_CASE("task queue parks for a task until a timeout", "[task-queue]") {
+    TaskQueue queue;
+    std::shared_ptr<Task> task;
+
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE(queue.TryPopFor(task, std::chrono::milliseconds(20)) == false);
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+
+    auto producer = std::async(std::launch::async, [&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        queue.Push(std::make_shared<OrderedTask>(5));
+    });
+
+    REQUIRE(queue.TryPopFor(task, std::chrono::seconds(10)));
+    REQUIRE(OrderOf(task) == 5);
+    producer.get();
+
+    queue.Close();
+    REQUIRE(queue.TryPopFor(task, std::chrono::seconds(10)) == false);
+}
+
+TEST_CASE("task queue reports its size", "[task-queue]") {
+    TaskQueue queue(2);
+    std::shared_ptr<Task> task;
+
+    REQUIRE(queue.Size() == 0);
+    for (uint32_t i = 0; i < 5; i++) {
+        queue.Push(std::make_shared<OrderedTask>(i));
+    }
+
+    // Tasks beyond ring capacity are counted in overflow.
+    REQUIRE(queue.Size() == 5);
+    REQUIRE(queue.TryPop(task));
+    REQUIRE(queue.Size() == 4);
+}
+
+TEST_CASE("task queue drains remaining tasks after close", "[task-queue]") {
+    TaskQueue queue;
+    queue.Push(std::make_shared<OrderedTask>(1));
+    queue.Push(std::make_shared<OrderedTask>(2));
+    queue.Close();
+
+    REQUIRE(OrderOf(queue.Pop()) == 1);
+    REQUIRE(OrderOf(queue.Pop()) == 2);
+    REQUIRE(queue.Pop() == nullptr);
+}
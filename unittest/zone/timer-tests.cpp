@@ -7,6 +7,9 @@
 
 #include <atomic>
 #include <future>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include <iostream>
 
@@ -77,4 +80,176 @@ TEST_CASE("timers are called by order", "[timer]") {
     REQUIRE(future1.get() == 3);
     REQUIRE(future2.get() == 2);
     REQUIRE(future3.get() == 1);
-}
\ No newline at end of file
+}
+
+TEST_CASE("timer is triggered after a timeout spanning wheel levels", "[timer]") {
+    std::promise<steady_clock::time_point> promise;
+    auto future = promise.get_future();
+
+    Timer timer([&promise]() {
+        promise.set_value(steady_clock::now());
+    }, 300ms);
+
+    auto startTime = steady_clock::now();
+    timer.Start();
+
+    REQUIRE(future.wait_for(2s) != std::future_status::timeout);
+    REQUIRE(future.get() - startTime >= 300ms);
+}
+
+TEST_CASE("timer restarts when started again", "[timer]") {
+    std::atomic<int> calls(0);
+
+    Timer timer([&calls]() {
+        calls++;
+    }, 100ms);
+
+    auto startTime = steady_clock::now();
+    timer.Start();
+    std::this_thread::sleep_for(50ms);
+    timer.Start();
+
+    std::this_thread::sleep_for(300ms);
+    REQUIRE(calls == 1);
+    REQUIRE(steady_clock::now() - startTime >= 150ms);
+}
+
+TEST_CASE("timers are not limited in number", "[timer]") {
+    const size_t count = 70000;
+    std::atomic<size_t> calls(0);
+    std::promise<void> promise;
+    auto future = promise.get_future();
+
+    std::vector<std::unique_ptr<Timer>> timers;
+    timers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        timers.emplace_back(std::make_unique<Timer>([&calls, &promise, count]() {
+            if (++calls == count) {
+                promise.set_value();
+            }
+        }, milliseconds(20 + i % 100)));
+    }
+
+    // Start timers from several threads, which use different shards.
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&timers, t]() {
+            for (size_t i = t; i < timers.size(); i += 4) {
+                timers[i]->Start();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    REQUIRE(calls == count);
+}
+
+TEST_CASE("stopped timers are not called among many active ones", "[timer]") {
+    std::atomic<size_t> calls(0);
+    std::vector<std::unique_ptr<Timer>> timers;
+    for (size_t i = 0; i < 1000; ++i) {
+        timers.emplace_back(std::make_unique<Timer>([&calls]() { calls++; }, 50ms));
+        timers.back()->Start();
+    }
+
+    for (size_t i = 0; i < timers.size(); i += 2) {
+        timers[i]->Stop();
+    }
+
+    std::this_thread::sleep_for(200ms);
+    REQUIRE(calls == 500);
+}
+
+TEST_CASE("stopped and destroyed timers are reclaimed right away", "[timer]") {
+    auto baseline = Timer::GetActiveCount();
+    {
+        std::vector<std::unique_ptr<Timer>> timers;
+        for (size_t i = 0; i < 1000; ++i) {
+            timers.emplace_back(std::make_unique<Timer>([]() {}, 30s));
+            timers.back()->Start();
+        }
+        REQUIRE(Timer::GetActiveCount() == baseline + 1000);
+
+        for (size_t i = 0; i < timers.size(); i += 2) {
+            timers[i]->Stop();
+        }
+        REQUIRE(Timer::GetActiveCount() == baseline + 500);
+    }
+    REQUIRE(Timer::GetActiveCount() == baseline);
+}
+
+TEST_CASE("timer rearms until its callback returns zero", "[timer]") {
+    auto baseline = Timer::GetActiveCount();
+    std::atomic<int> calls(0);
+    std::promise<void> promise;
+    auto future = promise.get_future();
+
+    Timer timer(10ms, [&]() {
+        if (++calls < 3) {
+            return 10ms;
+        }
+        promise.set_value();
+        return 0ms;
+    });
+    timer.Start();
+
+    REQUIRE(future.wait_for(5s) == std::future_status::ready);
+    std::this_thread::sleep_for(50ms);
+    REQUIRE(calls == 3);
+    REQUIRE(Timer::GetActiveCount() == baseline);
+}
+
+// Hidden benchmark of calls that finish long before their timeout, run with: napa-unittest "[timer-benchmark]"
+TEST_CASE("timer churn benchmark", "[.][timer-benchmark]") {
+    const size_t threadCount = 4;
+    const size_t callsPerSecond = 100000;
+    const auto duration = 2s;
+
+    std::atomic<uint64_t> totalNanoseconds(0);
+    std::atomic<size_t> totalCalls(0);
+    std::atomic<size_t> peakActive(0);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&]() {
+            auto interval = duration_cast<nanoseconds>(1s) * threadCount / callsPerSecond;
+            auto start = steady_clock::now();
+            auto next = start;
+            size_t calls = 0;
+            nanoseconds elapsed(0);
+
+            while (steady_clock::now() - start < duration) {
+                // A call with a 30s timeout that completes right away.
+                auto callStart = steady_clock::now();
+                {
+                    Timer timer([]() {}, 30s);
+                    timer.Start();
+                }
+                elapsed += steady_clock::now() - callStart;
+                ++calls;
+
+                auto active = Timer::GetActiveCount();
+                auto peak = peakActive.load();
+                while (active > peak && !peakActive.compare_exchange_weak(peak, active)) {}
+
+                next += interval;
+                std::this_thread::sleep_until(next);
+            }
+
+            totalNanoseconds += elapsed.count();
+            totalCalls += calls;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    WARN(totalCalls.load() << " calls in " << duration.count() << "s from " << threadCount << " threads, "
+        << totalNanoseconds.load() / totalCalls.load() << " ns per timer created, started and destroyed, "
+        << "peak of " << peakActive.load() << " active timers");
+
+    REQUIRE(peakActive.load() <= threadCount);
+}
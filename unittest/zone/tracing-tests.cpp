@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <zone/tracing.h>
+
+#include <string>
+#include <thread>
+
+using namespace napa::zone;
+
+namespace {
+    size_t CountOf(const std::string& text, const std::string& pattern) {
+        size_t count = 0;
+        for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+            ++count;
+        }
+        return count;
+    }
+}
+
+TEST_CASE("tracing records nothing when it's off", "[tracing]") {
+    Tracing::Start();
+    Tracing::Stop();
+    REQUIRE(Tracing::IsEnabled() == false);
+
+    {
+        TraceScope scope("test", "Off");
+    }
+    Tracing::RecordAsyncSpan(true, "test", "OffQueued", 1, Tracing::Now());
+
+    auto trace = Tracing::ExportChromeJson();
+    REQUIRE(trace.find("\"Off") == std::string::npos);
+    REQUIRE(trace.find("{\"traceEvents\":[") == 0);
+}
+
+TEST_CASE("tracing records spans of threads with their names", "[tracing]") {
+    Tracing::Start();
+    REQUIRE(Tracing::IsEnabled());
+
+    std::thread worker([]() {
+        Tracing::SetThreadName("zone1/worker-0");
+        TraceScope scope("zone", "Execute", "request-1", "module:function");
+        Tracing::RecordAsyncSpan(false, "zone", "Queued", 0xab, Tracing::Now(), "request-1");
+    });
+    Tracing::RecordAsyncSpan(true, "zone", "Queued", 0xab, Tracing::Now(), "request-1");
+    worker.join();
+    Tracing::Stop();
+
+    auto trace = Tracing::ExportChromeJson();
+    REQUIRE(trace.find("\"name\":\"thread_name\",\"ph\":\"M\"") != std::string::npos);
+    REQUIRE(trace.find("\"args\":{\"name\":\"zone1/worker-0\"}") != std::string::npos);
+    REQUIRE(trace.find("{\"name\":\"Execute\",\"cat\":\"zone\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(trace.find("\"args\":{\"traceId\":\"request-1\",\"detail\":\"module:function\"}") != std::string::npos);
+    REQUIRE(CountOf(trace, "\"id\":\"0xab\"") == 2);
+    REQUIRE(trace.find("\"ph\":\"b\"") != std::string::npos);
+    REQUIRE(trace.find("\"ph\":\"e\"") != std::string::npos);
+}
+
+TEST_CASE("tracing keeps the latest events of a full buffer", "[tracing]") {
+    Tracing::Start(4);
+    for (int i = 0; i < 10; ++i) {
+        auto name = "Span" + std::to_string(i);
+        TraceScope scope("test", name.c_str());
+    }
+    Tracing::Stop();
+
+    auto trace = Tracing::ExportChromeJson();
+    REQUIRE(CountOf(trace, "\"cat\":\"test\"") == 4);
+    REQUIRE(trace.find("\"Span5\"") == std::string::npos);
+    REQUIRE(trace.find("\"Span6\"") < trace.find("\"Span9\""));
+
+    // A new trace drops the events of the earlier one.
+    Tracing::Start();
+    Tracing::Stop();
+    REQUIRE(Tracing::ExportChromeJson().find("\"Span9\"") == std::string::npos);
+}
+
+TEST_CASE("tracing escapes and truncates strings", "[tracing]") {
+    Tracing::Start();
+    auto now = Tracing::Now();
+    Tracing::RecordSpan("test", "quote\"back\\slash\nline", now, now + 1500, nullptr, "detail");
+    Tracing::RecordSpan("test", "a-name-longer-than-thirty-one-characters", now, now);
+    Tracing::Stop();
+
+    auto trace = Tracing::ExportChromeJson();
+    REQUIRE(trace.find("\"quote\\\"back\\\\slash\\u000aline\"") != std::string::npos);
+    REQUIRE(trace.find("\"dur\":1.500,") != std::string::npos);
+    REQUIRE(trace.find("\"args\":{\"detail\":\"detail\"}") != std::string::npos);
+    REQUIRE(trace.find("\"a-name-longer-than-thirty-one-c\"") != std::string::npos);
+}
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <providers/in-process-metric-provider.h>
+#include <zone/transport-accounting.h>
+
+using namespace napa;
+using namespace napa::providers;
+using namespace napa::zone;
+
+namespace {
+
+    const MetricSnapshot* FindSnapshot(const std::vector<MetricSnapshot>& snapshots, const std::string& name) {
+        for (const auto& snapshot : snapshots) {
+            if (snapshot.name == name) {
+                return &snapshot;
+            }
+        }
+        return nullptr;
+    }
+}
+
+TEST_CASE("transport accounting records nothing while it's off", "[transport-accounting]") {
+    InProcessMetricProvider provider;
+
+    REQUIRE(!TransportAccounting::IsEnabled());
+    TransportAccounting::Record(provider, "zone1", "f", "MarshallArguments", 100, 1, 5000);
+    REQUIRE(provider.GetSnapshots({}).empty());
+}
+
+TEST_CASE("transport accounting records bytes, time and shared pointers by zone, function and stage", "[transport-accounting]") {
+    InProcessMetricProvider provider;
+
+    TransportAccounting::Start();
+    TransportAccounting::Record(provider, "zone1", "m:f", "MarshallArguments", 100, 0, 5000);
+    TransportAccounting::Record(provider, "zone1", "m:f", "MarshallArguments", 300, 2, 15000);
+    TransportAccounting::Record(provider, "zone1", "m:f", "UnmarshallResult", 10, 1, 1000);
+    TransportAccounting::Record(provider, "zone2", "store:s", "StoreSet", 7, 0, 2000);
+    TransportAccounting::Stop();
+
+    auto snapshots = provider.GetSnapshots({ 100 });
+
+    auto payloadBytes = FindSnapshot(snapshots, "PayloadBytes");
+    REQUIRE(payloadBytes != nullptr);
+    REQUIRE(payloadBytes->section == "Transport");
+    REQUIRE((payloadBytes->dimensionNames == std::vector<std::string>{ "zone", "function", "stage" }));
+    REQUIRE(payloadBytes->series.size() == 3);
+
+    const auto& marshall = payloadBytes->series[0];
+    REQUIRE((marshall.dimensionValues == std::vector<std::string>{ "zone1", "m:f", "MarshallArguments" }));
+    REQUIRE(marshall.count == 2);
+    REQUIRE(marshall.value == 400);
+
+    auto time = FindSnapshot(snapshots, "TransportTime");
+    REQUIRE(time != nullptr);
+    REQUIRE(time->series[0].value == 20);
+
+    // Stages without shared pointers don't create their series.
+    auto sharedPointers = FindSnapshot(snapshots, "SharedPointers");
+    REQUIRE(sharedPointers != nullptr);
+    REQUIRE(sharedPointers->series.size() == 2);
+    REQUIRE(sharedPointers->series[0].value == 2);
+    REQUIRE(sharedPointers->series[1].value == 1);
+}
@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <zone/worker-placement.h>
+
+#include <algorithm>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+    // 2 nodes with 3 processors each.
+    const std::vector<platform::Processor> TOPOLOGY = {
+        { 0, 0 }, { 1, 0 }, { 2, 0 }, { 4, 1 }, { 5, 1 }, { 6, 1 }
+    };
+
+    std::vector<uint32_t> Placement(settings::WorkerPlacement placement, int32_t numaNode, uint32_t workers) {
+        settings::ZoneSettings settings;
+        settings.workerPlacement = placement;
+        settings.numaNode = numaNode;
+
+        std::vector<uint32_t> result;
+        for (uint32_t id = 0; id < workers; ++id) {
+            auto processors = GetWorkerProcessors(id, settings, TOPOLOGY);
+            REQUIRE(processors.size() == 1);
+            result.push_back(processors[0]);
+        }
+        return result;
+    }
+}
+
+TEST_CASE("worker placement pins workers by policy", "[worker-placement]") {
+
+    SECTION("none doesn't pin") {
+        settings::ZoneSettings settings;
+        REQUIRE(GetWorkerProcessors(0, settings, TOPOLOGY).empty());
+    }
+
+    SECTION("none with a NUMA node restricts workers to the node") {
+        settings::ZoneSettings settings;
+        settings.numaNode = 1;
+        REQUIRE(GetWorkerProcessors(0, settings, TOPOLOGY) == std::vector<uint32_t>({ 4, 5, 6 }));
+    }
+
+    SECTION("compact fills a node first") {
+        REQUIRE(Placement(settings::WorkerPlacement::COMPACT, -1, 4) == std::vector<uint32_t>({ 0, 1, 2, 4 }));
+    }
+
+    SECTION("spread alternates nodes") {
+        REQUIRE(Placement(settings::WorkerPlacement::SPREAD, -1, 4) == std::vector<uint32_t>({ 0, 4, 1, 5 }));
+    }
+
+    SECTION("workers wrap around when there are more workers than processors") {
+        REQUIRE(Placement(settings::WorkerPlacement::SPREAD, 1, 4) == std::vector<uint32_t>({ 4, 5, 6, 4 }));
+    }
+
+    SECTION("unknown NUMA node doesn't pin") {
+        settings::ZoneSettings settings;
+        settings.workerPlacement = settings::WorkerPlacement::COMPACT;
+        settings.numaNode = 7;
+        REQUIRE(GetWorkerProcessors(0, settings, TOPOLOGY).empty());
+    }
+}
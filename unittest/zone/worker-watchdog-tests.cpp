@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+#include <zone/worker-watchdog.h>
+
+#include <map>
+
+using namespace napa;
+using namespace napa::zone;
+
+using std::chrono::milliseconds;
+
+namespace {
+
+    /// <summary> Busy times of workers by worker id, workers not in the map are between tasks. </summary>
+    std::function<std::chrono::steady_clock::duration(WorkerId)> BusyTimes(const std::map<WorkerId, milliseconds>& busyTimes) {
+        return [busyTimes](WorkerId id) -> std::chrono::steady_clock::duration {
+            auto it = busyTimes.find(id);
+            return it == busyTimes.end() ? milliseconds(0) : it->second;
+        };
+    }
+}
+
+TEST_CASE("worker watchdog checks workers every half threshold", "[worker-watchdog]") {
+    REQUIRE(WorkerWatchdog(milliseconds(1000), 4).GetCheckInterval() == milliseconds(500));
+    REQUIRE(WorkerWatchdog(milliseconds(1), 4).GetCheckInterval() == milliseconds(1));
+}
+
+TEST_CASE("worker watchdog reports workers as they become stuck and recover", "[worker-watchdog]") {
+    WorkerWatchdog watchdog(milliseconds(100), 4);
+
+    REQUIRE(watchdog.Check(3, BusyTimes({ { 0, milliseconds(10) } })).empty());
+    REQUIRE(watchdog.GetStuckWorkerCount() == 0);
+
+    auto changes = watchdog.Check(3, BusyTimes({ { 0, milliseconds(10) }, { 2, milliseconds(150) } }));
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes[0].workerId == 2);
+    REQUIRE(changes[0].stuck);
+    REQUIRE(changes[0].busyTime == milliseconds(150));
+    REQUIRE(watchdog.GetStuckWorkerCount() == 1);
+
+    // A stuck worker is reported once.
+    REQUIRE(watchdog.Check(3, BusyTimes({ { 2, milliseconds(250) } })).empty());
+    REQUIRE(watchdog.GetStuckWorkerCount() == 1);
+
+    changes = watchdog.Check(3, BusyTimes({ { 1, milliseconds(100) } }));
+    REQUIRE(changes.size() == 2);
+    REQUIRE(changes[0].workerId == 1);
+    REQUIRE(changes[0].stuck);
+    REQUIRE(changes[1].workerId == 2);
+    REQUIRE_FALSE(changes[1].stuck);
+    REQUIRE(watchdog.GetStuckWorkerCount() == 1);
+}
+
+TEST_CASE("worker watchdog takes removed workers as recovered", "[worker-watchdog]") {
+    WorkerWatchdog watchdog(milliseconds(100), 4);
+
+    REQUIRE(watchdog.Check(4, BusyTimes({ { 3, milliseconds(200) } })).size() == 1);
+
+    // The busy time of a removed worker isn't asked for.
+    auto changes = watchdog.Check(3, [](WorkerId id) -> std::chrono::steady_clock::duration {
+        REQUIRE(id < 3);
+        return milliseconds(0);
+    });
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes[0].workerId == 3);
+    REQUIRE_FALSE(changes[0].stuck);
+    REQUIRE(watchdog.GetStuckWorkerCount() == 0);
+}
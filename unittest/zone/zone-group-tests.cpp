@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include "zone/zone-group.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace napa;
+using namespace napa::zone;
+
+namespace {
+
+    /// <summary> A zone holding calls until the test completes them. </summary>
+    class HoldingZone : public Zone {
+    public:
+        explicit HoldingZone(std::string id) : _id(std::move(id)) {}
+
+        const std::string& GetId() const override {
+            return _id;
+        }
+
+        void Broadcast(const std::string&, BroadcastCallback callback) override {
+            callback(broadcastResult);
+        }
+
+        void Execute(const FunctionSpec&, ExecuteCallback callback) override {
+            calls.emplace_back(std::move(callback));
+        }
+
+        void ExecuteBatch(const std::vector<FunctionSpec>& specs, ExecuteBatchCallback) override {
+            FAIL("unexpected batch of " << specs.size());
+        }
+
+        void ExecuteBatch(const std::vector<FunctionSpec>& specs, std::vector<ExecuteCallback> callbacks) override {
+            batchSizes.push_back(specs.size());
+            for (auto& callback : callbacks) {
+                calls.emplace_back(std::move(callback));
+            }
+        }
+
+        float GetPressure() const override {
+            return pressure;
+        }
+
+        uint32_t GetWorkers() const override {
+            return 1;
+        }
+
+        void Resize(uint32_t, ResizeCallback) override {}
+        void Drain(uint32_t, DrainCallback) override {}
+        void GetMemoryUsage(MemoryUsageCallback) override {}
+        void StartProfiling(uint32_t, ProfilingCallback) override {}
+        void StopProfiling(CpuProfileCallback) override {}
+        void StartAllocationProfiling(uint32_t, ProfilingCallback) override {}
+        void StopAllocationProfiling(AllocationProfileCallback) override {}
+        void GetHeapStatistics(HeapStatisticsCallback) override {}
+        void WriteHeapSnapshot(uint32_t, const std::string&, HeapSnapshotCallback) override {}
+        std::vector<SlowCall> GetSlowCalls() const override { return {}; }
+        std::vector<FunctionStats> GetFunctionStats() const override { return {}; }
+
+        /// <summary> Completes the oldest held call. </summary>
+        void Complete(ResultCode code = NAPA_RESULT_SUCCESS) {
+            REQUIRE(!calls.empty());
+            auto callback = std::move(calls.front());
+            calls.erase(calls.begin());
+
+            Result result;
+            result.code = code;
+            result.returnValue = _id;
+            callback(std::move(result));
+        }
+
+        std::vector<ExecuteCallback> calls;
+        std::vector<size_t> batchSizes;
+        float pressure = 0.0f;
+        ResultCode broadcastResult = NAPA_RESULT_SUCCESS;
+
+    private:
+        std::string _id;
+    };
+
+    FunctionSpec MakeSpec(const std::string& argument) {
+        FunctionSpec spec;
+        spec.module = NAPA_STRING_REF("m");
+        spec.function = NAPA_STRING_REF("f");
+        spec.arguments.push_back(STD_STRING_TO_NAPA_STRING_REF(argument));
+        return spec;
+    }
+
+    void Execute(ZoneGroup& group, const std::string& argument) {
+        group.Execute(MakeSpec(argument), [](Result) {});
+    }
+}
+
+TEST_CASE("zone group routes calls to the member with fewer pending calls", "[zone-group]") {
+    auto first = std::make_shared<HoldingZone>("first");
+    auto second = std::make_shared<HoldingZone>("second");
+    ZoneGroup group("group", { { first, false }, { second, false } }, ZoneGroupSettings());
+
+    // With two members, both are sampled, so calls alternate as they pile up.
+    for (int i = 0; i < 10; i++) {
+        Execute(group, "1");
+    }
+    REQUIRE(first->calls.size() == 5);
+    REQUIRE(second->calls.size() == 5);
+    REQUIRE(group.GetPendingCalls(0) == 5);
+
+    first->Complete();
+    first->Complete();
+    REQUIRE(group.GetPendingCalls(0) == 3);
+    REQUIRE(group.GetWorkers() == 2);
+}
+
+TEST_CASE("zone group weighs pending calls by pressure", "[zone-group]") {
+    auto first = std::make_shared<HoldingZone>("first");
+    auto second = std::make_shared<HoldingZone>("second");
+    ZoneGroup group("group", { { first, false }, { second, false } }, ZoneGroupSettings());
+
+    first->pressure = 0.9f;
+    for (int i = 0; i < 3; i++) {
+        Execute(group, "1");
+    }
+    REQUIRE(first->calls.size() == 1);
+    REQUIRE(second->calls.size() == 2);
+    REQUIRE(group.GetPressure() == 0.0f);
+}
+
+TEST_CASE("zone group sends small calls to local members", "[zone-group]") {
+    auto local = std::make_shared<HoldingZone>("local");
+    auto remote = std::make_shared<HoldingZone>("remote");
+    ZoneGroupSettings settings;
+    settings.localPayloadSize = 8;
+    ZoneGroup group("group", { { local, false }, { remote, true } }, settings);
+
+    SECTION("while local members have room") {
+        for (int i = 0; i < 4; i++) {
+            Execute(group, "small");
+        }
+        REQUIRE(local->calls.size() == 4);
+
+        // Large calls go by load.
+        Execute(group, "large payload");
+        REQUIRE(remote->calls.size() == 1);
+    }
+
+    SECTION("until local members are full") {
+        local->pressure = 1.0f;
+        Execute(group, "small");
+        REQUIRE(remote->calls.size() == 1);
+    }
+
+    SECTION("unless disabled") {
+        ZoneGroupSettings disabled;
+        disabled.localPayloadSize = 0;
+        ZoneGroup byLoad("group", { { local, false }, { remote, true } }, disabled);
+        Execute(byLoad, "small");
+        Execute(byLoad, "small");
+        REQUIRE(local->calls.size() == 1);
+        REQUIRE(remote->calls.size() == 1);
+    }
+}
+
+TEST_CASE("zone group skips members whose connection was lost", "[zone-group]") {
+    auto first = std::make_shared<HoldingZone>("first");
+    auto second = std::make_shared<HoldingZone>("second");
+    ZoneGroup group("group", { { first, true }, { second, true } }, ZoneGroupSettings());
+
+    Execute(group, "1");
+    Execute(group, "1");
+    first->Complete(NAPA_RESULT_ZONE_DISCONNECTED);
+    second->Complete();
+
+    for (int i = 0; i < 3; i++) {
+        Execute(group, "1");
+    }
+    REQUIRE(first->calls.empty());
+    REQUIRE(second->calls.size() == 3);
+}
+
+TEST_CASE("zone group sends calls of a batch per member, with results in order", "[zone-group]") {
+    auto first = std::make_shared<HoldingZone>("first");
+    auto second = std::make_shared<HoldingZone>("second");
+    ZoneGroup group("group", { { first, false }, { second, false } }, ZoneGroupSettings());
+
+    std::vector<FunctionSpec> specs;
+    for (int i = 0; i < 4; i++) {
+        specs.emplace_back(MakeSpec("1"));
+    }
+
+    std::vector<Result> results;
+    group.ExecuteBatch(specs, [&results](std::vector<Result> batchResults) {
+        results = std::move(batchResults);
+    });
+    REQUIRE(first->batchSizes == std::vector<size_t>({ 2 }));
+    REQUIRE(second->batchSizes == std::vector<size_t>({ 2 }));
+
+    second->Complete();
+    second->Complete();
+    first->Complete();
+    REQUIRE(results.empty());
+    first->Complete();
+
+    REQUIRE(results.size() == 4);
+    REQUIRE(group.GetPendingCalls(0) == 0);
+    REQUIRE(group.GetPendingCalls(1) == 0);
+}
+
+TEST_CASE("zone group broadcasts to all members", "[zone-group]") {
+    auto first = std::make_shared<HoldingZone>("first");
+    auto second = std::make_shared<HoldingZone>("second");
+    ZoneGroup group("group", { { first, false }, { second, true } }, ZoneGroupSettings());
+
+    ResultCode code = NAPA_RESULT_UNDEFINED;
+    group.Broadcast("var x = 1;", [&code](ResultCode result) { code = result; });
+    REQUIRE(code == NAPA_RESULT_SUCCESS);
+
+    second->broadcastResult = NAPA_RESULT_ZONE_DISCONNECTED;
+    group.Broadcast("var x = 1;", [&code](ResultCode result) { code = result; });
+    REQUIRE(code == NAPA_RESULT_ZONE_DISCONNECTED);
+}
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <catch/catch.hpp>
+
+#include <providers/in-process-metric-provider.h>
+#include <zone/zone-metrics.h>
+
+using namespace napa;
+using namespace napa::providers;
+using namespace napa::zone;
+
+namespace {
+
+    const MetricSnapshot& FindSnapshot(const std::vector<MetricSnapshot>& snapshots, const std::string& name) {
+        for (const auto& snapshot : snapshots) {
+            if (snapshot.name == name) {
+                return snapshot;
+            }
+        }
+        FAIL("no metric named " << name);
+        return snapshots.front();
+    }
+}
+
+TEST_CASE("zone metrics record calls by zone and worker", "[zone-metrics]") {
+    InProcessMetricProvider provider;
+    ZoneMetrics metrics(provider, "zone1", 2);
+
+    metrics.SetQueueDepth(CallPriority::HIGH, 3);
+    metrics.RecordQueueTime(1, std::chrono::microseconds(100));
+    metrics.RecordQueueTime(1, std::chrono::microseconds(300));
+    metrics.RecordExecutionTime(0, std::chrono::milliseconds(2));
+    metrics.RecordBootstrapTime(1, std::chrono::milliseconds(30));
+    metrics.RecordFailure(NAPA_RESULT_TIMEOUT);
+    metrics.RecordFailure(NAPA_RESULT_ZONE_OVERLOADED);
+    metrics.RecordFailure(NAPA_RESULT_ZONE_OVERLOADED);
+    metrics.RecordFailure(NAPA_RESULT_EXECUTE_FUNC_ERROR);
+
+    // Out of range workers are ignored.
+    metrics.RecordQueueTime(2, std::chrono::microseconds(100));
+
+    auto snapshots = provider.GetSnapshots({ 100 });
+
+    const auto& queueDepth = FindSnapshot(snapshots, "QueueDepth");
+    REQUIRE(queueDepth.section == "Zone");
+    REQUIRE((queueDepth.series[0].dimensionValues == std::vector<std::string>{ "zone1", "high" }));
+    REQUIRE(queueDepth.series[0].value == 3);
+
+    // Metrics are bound up front, so every worker has a series.
+    const auto& queueTime = FindSnapshot(snapshots, "CallQueueTime");
+    REQUIRE(queueTime.series.size() == 2);
+    REQUIRE(queueTime.series[0].count == 0);
+    REQUIRE((queueTime.series[1].dimensionValues == std::vector<std::string>{ "zone1", "1" }));
+    REQUIRE(queueTime.series[1].count == 2);
+    REQUIRE(queueTime.series[1].max == 300);
+
+    const auto& executionTime = FindSnapshot(snapshots, "CallExecutionTime");
+    REQUIRE((executionTime.series[0].dimensionValues == std::vector<std::string>{ "zone1", "0" }));
+    REQUIRE(executionTime.series[0].value == 2000);
+
+    const auto& bootstrapTime = FindSnapshot(snapshots, "WorkerBootstrapTime");
+    REQUIRE(bootstrapTime.series[0].count == 0);
+    REQUIRE(bootstrapTime.series[1].value == 30000);
+
+    REQUIRE(FindSnapshot(snapshots, "CallTimeouts").series[0].value == 1);
+    REQUIRE(FindSnapshot(snapshots, "CallRejects").series[0].value == 2);
+}